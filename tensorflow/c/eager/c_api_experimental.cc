@@ -48,6 +48,51 @@ void TFE_OpReset(TFE_Op* op_to_reset, const char* op_or_function_name,
   }
 }
 
+void TFE_OpClearInputs(TFE_Op* op) { tensorflow::unwrap(op)->ClearInputs(); }
+
+void TFE_ExecuteOps(TFE_Op** ops, int num_ops, TFE_TensorHandle** inputs,
+                    const int* input_indices, const int* num_inputs,
+                    TFE_TensorHandle** retvals, int* num_retvals,
+                    TF_Status* status) {
+  int num_input_indices = 0;
+  int num_outputs = 0;
+  for (int i = 0; i < num_ops; ++i) {
+    tensorflow::ImmediateExecutionOperation* op = tensorflow::unwrap(ops[i]);
+    tensorflow::Status s;
+    if (num_inputs != nullptr) {
+      op->ClearInputs();
+      for (int j = 0; s.ok() && j < num_inputs[i]; ++j) {
+        const int index = input_indices[num_input_indices++];
+        if (index >= 0) {
+          s = op->AddInput(tensorflow::unwrap(inputs[index]));
+        } else if (-1 - index < num_outputs) {
+          s = op->AddInput(tensorflow::unwrap(retvals[-1 - index]));
+        } else {
+          s = tensorflow::errors::InvalidArgument(
+              "Input ", j, " refers to output ", -1 - index,
+              ", which is not returned by an earlier op");
+        }
+      }
+    }
+    if (s.ok()) {
+      s = op->Execute(
+          absl::MakeSpan(reinterpret_cast<tensorflow::AbstractTensorHandle**>(
+                             tensorflow::unwrap(retvals + num_outputs)),
+                         num_retvals[i]),
+          &num_retvals[i]);
+    }
+    if (!s.ok()) {
+      for (int j = i; j < num_ops; ++j) num_retvals[j] = 0;
+      tensorflow::errors::AppendToMessage(&s, "while executing op ", i, " (",
+                                          op->Name(), ") of the sequence");
+      status->status = s;
+      return;
+    }
+    num_outputs += num_retvals[i];
+  }
+  status->status = tensorflow::Status::OK();
+}
+
 void TFE_ContextEnableGraphCollection(TFE_Context* ctx) {
   tensorflow::unwrap(ctx)->SetShouldStoreGraphs(true);
 }
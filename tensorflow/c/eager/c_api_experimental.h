@@ -34,6 +34,37 @@ TF_CAPI_EXPORT extern void TFE_OpReset(TFE_Op* op_to_reset,
                                        const char* raw_device_name,
                                        TF_Status* status);
 
+// Releases the inputs of `op`, so that it can be executed again with new
+// inputs. Unlike `TFE_OpReset`, the attributes and the requested device of
+// `op` are kept, so that language bindings can set them once and reuse the op
+// for every execution.
+TF_CAPI_EXPORT extern void TFE_OpClearInputs(TFE_Op* op);
+
+// Executes the `num_ops` operations of `ops` in order, as if `TFE_Execute` was
+// called on each of them, so that language bindings pay for a single call
+// into the library for a whole sequence of ops.
+//
+// If `num_inputs` is `NULL`, the ops are executed with the inputs they
+// already have. Otherwise the inputs of every op are cleared with
+// `TFE_OpClearInputs` and `ops[i]` gets `num_inputs[i]` new inputs, described
+// by the next `num_inputs[i]` entries of `input_indices`: a non-negative entry
+// `k` refers to `inputs[k]`, and a negative entry `-1 - k` refers to
+// `retvals[k]`, an output of an earlier op of the sequence. The same op may
+// appear several times in `ops`.
+//
+// On entry `num_retvals[i]` is the number of outputs that `ops[i]` may
+// return, and on exit it is the number of outputs it returned. The outputs
+// of every op are stored in `retvals` right after the outputs of the previous
+// op, and are owned by the caller. If an op fails, the ops after it are not
+// executed, their `num_retvals` are set to 0, and `status` names the failed
+// op.
+TF_CAPI_EXPORT extern void TFE_ExecuteOps(TFE_Op** ops, int num_ops,
+                                          TFE_TensorHandle** inputs,
+                                          const int* input_indices,
+                                          const int* num_inputs,
+                                          TFE_TensorHandle** retvals,
+                                          int* num_retvals, TF_Status* status);
+
 // Enables only graph collection in RunMetadata on the functions executed from
 // this context.
 TF_CAPI_EXPORT extern void TFE_ContextEnableGraphCollection(TFE_Context* ctx);
@@ -361,6 +361,55 @@ void Executor_MatMul_CPU(bool async) {
 TEST(CAPI, Executor_MatMul_CPU) { Executor_MatMul_CPU(false); }
 TEST(CAPI, Executor_MatMul_CPUAsync) { Executor_MatMul_CPU(true); }
 
+TEST(CAPI, ExecuteOps_ReusedMatMul) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  // Computes m * m * m with a single op, whose second execution consumes the
+  // output of the first one.
+  TFE_TensorHandle* m = TestMatrixTensorHandle(ctx);
+  TFE_Op* matmul = MatMulOp(ctx, m, m);
+  TFE_Op* ops[2] = {matmul, matmul};
+  const int input_indices[4] = {0, 0, -1, 0};
+  const int num_inputs[2] = {2, 2};
+  TFE_TensorHandle* retvals[2] = {nullptr, nullptr};
+  int num_retvals[2] = {1, 1};
+  TFE_ExecuteOps(ops, 2, &m, input_indices, num_inputs, retvals, num_retvals,
+                 status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(1, num_retvals[0]);
+  EXPECT_EQ(1, num_retvals[1]);
+
+  // An input may not refer to an output of the same or a later op.
+  const int bad_input_indices[2] = {0, -2};
+  TFE_TensorHandle* bad_retvals[1] = {nullptr};
+  int bad_num_retvals[1] = {1};
+  TFE_ExecuteOps(ops, 1, &m, bad_input_indices, num_inputs, bad_retvals,
+                 bad_num_retvals, status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(0, bad_num_retvals[0]);
+  TFE_DeleteOp(matmul);
+  TFE_DeleteTensorHandle(m);
+
+  TF_Tensor* t = TFE_TensorHandleResolve(retvals[1], status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteTensorHandle(retvals[0]);
+  TFE_DeleteTensorHandle(retvals[1]);
+  TFE_DeleteContext(ctx);
+  float product[4] = {0};
+  EXPECT_EQ(sizeof(product), TF_TensorByteSize(t));
+  memcpy(&product[0], TF_TensorData(t), TF_TensorByteSize(t));
+  TF_DeleteTensor(t);
+  EXPECT_EQ(37, product[0]);
+  EXPECT_EQ(54, product[1]);
+  EXPECT_EQ(81, product[2]);
+  EXPECT_EQ(118, product[3]);
+  TF_DeleteStatus(status);
+}
+
 void Deleter(void* data, size_t unused, void* tensor_handle) {
   TFE_DeleteTensorHandle(static_cast<TFE_TensorHandle*>(tensor_handle));
 }
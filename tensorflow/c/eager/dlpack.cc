@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/c/eager/dlpack.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "include/dlpack/dlpack.h"  // from @dlpack
 #include "tensorflow/c/eager/c_api.h"
 #include "tensorflow/c/eager/c_api_experimental.h"
@@ -29,6 +32,10 @@ namespace tensorflow {
 
 namespace {
 
+// Type code of complex numbers, which was added in DLPack 0.4 and is not
+// defined by the vendored header.
+constexpr uint8_t kDlComplexCode = 5;
+
 // Managing context for the DLManagedTensor, will manage the lifetime of
 // DLManagedTensor. When calling DLManagedTensor::deleter, it will notify the
 // original framework of destruction, and this context will be deleted also.
@@ -97,6 +104,10 @@ DLDataType GetDlDataType(TF_DataType data_type, TF_Status* status) {
     case TF_DataType::TF_BFLOAT16:
       dtype.code = DLDataTypeCode::kDLBfloat;
       break;
+    case TF_DataType::TF_COMPLEX64:
+    case TF_DataType::TF_COMPLEX128:
+      dtype.code = kDlComplexCode;
+      break;
     default:
       status->status = tensorflow::errors::InvalidArgument(
           DataType_Name(static_cast<DataType>(data_type)),
@@ -123,7 +134,11 @@ DLContext GetDlContext(TFE_TensorHandle* h, TF_Status* status) {
   if (device_type == "CPU") {
     ctx.device_type = DLDeviceType::kDLCPU;
   } else if (device_type == "GPU") {
+#if TENSORFLOW_USE_ROCM
+    ctx.device_type = DLDeviceType::kDLROCM;
+#else
     ctx.device_type = DLDeviceType::kDLGPU;
+#endif
   } else {
     status->status = tensorflow::errors::InvalidArgument(
         "Unsupported Device Type for dlpack");
@@ -137,8 +152,10 @@ absl::optional<std::string> DeviceNameFromDlContext(const DLContext& ctx,
                                                     TF_Status* status) {
   switch (ctx.device_type) {
     case DLDeviceType::kDLCPU:
+    case DLDeviceType::kDLCPUPinned:
       return "CPU:0";
     case DLDeviceType::kDLGPU:
+    case DLDeviceType::kDLROCM:
       return absl::StrCat("GPU:", ctx.device_id);
     default:
       return absl::nullopt;
@@ -148,6 +165,10 @@ absl::optional<std::string> DeviceNameFromDlContext(const DLContext& ctx,
 // Converts DLPack data type to TF_DATATYPE.
 Status TfDataTypeFormDlDataType(const DLDataType& dtype,
                                 TF_DataType* tf_dtype) {
+  if (dtype.lanes != 1) {
+    return tensorflow::errors::InvalidArgument("Unsupported lanes: ",
+                                               dtype.lanes);
+  }
   switch (dtype.code) {
     case DLDataTypeCode::kDLUInt:
       switch (dtype.bits) {
@@ -213,6 +234,19 @@ Status TfDataTypeFormDlDataType(const DLDataType& dtype,
               "Unsupported BFloat bits: ", dtype.bits);
       }
       break;
+    case kDlComplexCode:
+      switch (dtype.bits) {
+        case 64:
+          *tf_dtype = TF_DataType::TF_COMPLEX64;
+          return Status::OK();
+        case 128:
+          *tf_dtype = TF_DataType::TF_COMPLEX128;
+          return Status::OK();
+        default:
+          return tensorflow::errors::InvalidArgument(
+              "Unsupported Complex bits: ", dtype.bits);
+      }
+      break;
     default:
       return tensorflow::errors::InvalidArgument("Unsupported Type Codes: ",
                                                  dtype.code);
@@ -226,19 +260,48 @@ void DeallocatorWrapperFunc(void* data, size_t len, void* dlmt_vptr) {
 }
 
 // Checks whether the stride array matches the layout of compact, row-majored
-// data.
+// data. The strides of dimensions of size 1 are ignored since they never move
+// to another element, and empty tensors have no layout.
 bool IsValidStrideCompactRowMajorData(int64_t* shape_arr, int64_t* stride_arr,
                                       int ndim) {
-  if (ndim >= 1 && stride_arr[ndim - 1] != 1) {
-    return false;
+  if (std::find(shape_arr, shape_arr + ndim, 0) != shape_arr + ndim) {
+    return true;
   }
-  for (int i = ndim - 2; i >= 0; --i) {
-    if (stride_arr[i] != shape_arr[i + 1] * stride_arr[i + 1]) {
+  int64_t expected_stride = 1;
+  for (int i = ndim - 1; i >= 0; --i) {
+    if (shape_arr[i] != 1 && stride_arr[i] != expected_stride) {
       return false;
     }
+    expected_stride *= shape_arr[i];
   }
   return true;
 }
+
+// Copies the `num_elements` elements of the host tensor `dl_tensor`, laid out
+// as described by its strides, into the compact, row-majored buffer `dst`.
+void CopyToCompactRowMajorData(const DLTensor& dl_tensor, int64_t num_elements,
+                               char* dst) {
+  const size_t element_bytes = dl_tensor.dtype.bits / 8;
+  const char* src =
+      static_cast<const char*>(dl_tensor.data) + dl_tensor.byte_offset;
+  if (dl_tensor.strides == nullptr) {
+    std::memcpy(dst, src, num_elements * element_bytes);
+    return;
+  }
+  const int ndim = dl_tensor.ndim;
+  std::vector<int64_t> index(ndim, 0);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    int64_t offset = 0;
+    for (int d = 0; d < ndim; ++d) {
+      offset += index[d] * dl_tensor.strides[d];
+    }
+    std::memcpy(dst + i * element_bytes, src + offset * element_bytes,
+                element_bytes);
+    for (int d = ndim - 1; d >= 0 && ++index[d] == dl_tensor.shape[d]; --d) {
+      index[d] = 0;
+    }
+  }
+}
 }  // namespace
 
 void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
@@ -260,6 +323,9 @@ void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
   }
 
   const Tensor* tensor = GetTensorFromHandle(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
   TF_DataType data_type = static_cast<TF_DataType>(tensor->dtype());
 
   auto tf_dlm_type = GetDlDataType(data_type, status);
@@ -323,21 +389,41 @@ TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
   }
   int num_dims = dl_tensor->ndim;
   const int64_t* dims = dl_tensor->shape;
-  void* data = dl_tensor->data;
+  void* data = static_cast<char*>(dl_tensor->data) + dl_tensor->byte_offset;
 
-  size_t total_bytes = dl_tensor->dtype.bits / 8;
+  int64_t num_elements = 1;
   for (int i = 0; i < num_dims; i++) {
-    total_bytes *= dims[i];
+    num_elements *= dims[i];
   }
-
-  if (dl_tensor->strides != nullptr &&
-      !IsValidStrideCompactRowMajorData(dl_tensor->shape, dl_tensor->strides,
-                                        num_dims)) {
+  size_t total_bytes = num_elements * (dl_tensor->dtype.bits / 8);
+
+  const bool on_host = dl_tensor->ctx.device_type == DLDeviceType::kDLCPU ||
+                       dl_tensor->ctx.device_type == DLDeviceType::kDLCPUPinned;
+  const bool is_compact =
+      dl_tensor->strides == nullptr ||
+      IsValidStrideCompactRowMajorData(dl_tensor->shape, dl_tensor->strides,
+                                       num_dims);
+  if (!is_compact && !on_host) {
     status->status = tensorflow::errors::InvalidArgument(
         "Invalid strides array from DLPack");
     return nullptr;
   }
 
+  // The CPU kernels expect aligned buffers, so host tensors are only shared
+  // when they are aligned and compact, and copied otherwise.
+  const bool is_aligned = reinterpret_cast<intptr_t>(data) %
+                              std::max(1, EIGEN_MAX_ALIGN_BYTES) ==
+                          0;
+  if (on_host && (!is_compact || !is_aligned)) {
+    TF_Tensor* tensor = TF_AllocateTensor(dtype, dims, num_dims, total_bytes);
+    CopyToCompactRowMajorData(*dl_tensor, num_elements,
+                              static_cast<char*>(TF_TensorData(tensor)));
+    TFE_CallDLManagedTensorDeleter(dlmt);
+    TFE_TensorHandle* handle = TFE_NewTensorHandle(tensor, status);
+    TF_DeleteTensor(tensor);
+    return handle;
+  }
+
   TFE_TensorHandle* handle = TFE_NewTensorHandleFromDeviceMemory(
       ctx, device_name.value().c_str(), dtype, dims, num_dims, data,
       total_bytes, &DeallocatorWrapperFunc, dlmt, status);
@@ -28,7 +28,9 @@ const char* const kDlTensorCapsuleName = "dltensor";
 TF_CAPI_EXPORT extern void* TFE_HandleToDLPack(TFE_TensorHandle* h,
                                                TF_Status* status);
 
-// Converts DLPack (DLManagedTensor*) to eager tensor handle.
+// Converts DLPack (DLManagedTensor*) to eager tensor handle. The handle shares
+// the memory of the DLPack tensor, except for host tensors that are not
+// aligned or not compact and row-majored, which are copied.
 TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm,
                                                              TF_Status* status,
                                                              TFE_Context* ctx);
@@ -38,6 +38,11 @@ class ImmediateExecutionOperation : public AbstractOperation {
  public:
   virtual void Clear() = 0;
 
+  // Releases the inputs of this op, so that it can be executed again with new
+  // inputs. Unlike Clear(), the op keeps its attributes and the device that
+  // was last requested with SetDeviceName.
+  virtual void ClearInputs() = 0;
+
   // Returns the inputs of this op.
   virtual absl::Span<ImmediateExecutionTensorHandle* const> GetInputs()
       const = 0;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/flags.h"
 
+#include <algorithm>
 #include <mutex>  // NOLINT
 
 #include "absl/base/call_once.h"
@@ -129,7 +130,11 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags
                 ->tf_xla_disable_resource_variable_safety_checks_for_debugging,
            "Disable resource variables related safety checks when clustering "
-           "(this is unsound).")};
+           "(this is unsound)."),
+      Flag("tf_xla_cluster_churn_feedback",
+           &mark_for_compilation_flags->tf_xla_cluster_churn_feedback,
+           "Record the nodes of XLA clusters whose input shapes keep changing "
+           "at runtime, and keep them out of clusters in later graph builds.")};
   flag_list->insert(flag_list->end(), new_flags.begin(), new_flags.end());
 }
 
@@ -156,6 +161,7 @@ void AllocateAndParseFlags() {
       ->tf_xla_disable_deadness_safety_checks_for_debugging = false;
   mark_for_compilation_flags
       ->tf_xla_disable_resource_variable_safety_checks_for_debugging = false;
+  mark_for_compilation_flags->tf_xla_cluster_churn_feedback = false;
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -163,6 +169,7 @@ void AllocateAndParseFlags() {
 
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
+  ops_flags->tf_xla_async_compilation = false;
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -184,6 +191,21 @@ void AllocateAndParseFlags() {
     return true;
   };
 
+  auto setter_for_shape_buckets = [](string sequence) {
+    std::vector<int64> buckets;
+    for (absl::string_view bucket :
+         absl::StrSplit(sequence, ',', absl::SkipEmpty())) {
+      int64 size;
+      if (!absl::SimpleAtoi(bucket, &size) || size <= 0) {
+        return false;
+      }
+      buckets.push_back(size);
+    }
+    std::sort(buckets.begin(), buckets.end());
+    ops_flags->tf_xla_shape_buckets = std::move(buckets);
+    return true;
+  };
+
   flag_list = new std::vector<Flag>(
       {Flag("tf_xla_enable_lazy_compilation",
             &build_ops_flags->tf_xla_enable_lazy_compilation, ""),
@@ -216,6 +238,14 @@ void AllocateAndParseFlags() {
 
        Flag("tf_xla_always_defer_compilation",
             &ops_flags->tf_xla_always_defer_compilation, ""),
+       Flag("tf_xla_async_compilation", &ops_flags->tf_xla_async_compilation,
+            "When lazy compilation is enabled, compile XLA clusters on a "
+            "background thread and run them in the TF executor until the "
+            "compilation has finished."),
+       Flag("tf_xla_shape_buckets", setter_for_shape_buckets, "",
+            "Comma-separated sizes that the dimensions of XLA cluster inputs "
+            "are rounded up to, so that one compilation serves every shape in "
+            "a bucket. Empty disables bucketing."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
@@ -79,6 +79,11 @@ struct MarkForCompilationPassFlags {
   // variable concurrency semantics.  This is unsound in general, but can be
   // used as a debugging aid.
   bool tf_xla_disable_resource_variable_safety_checks_for_debugging;
+
+  // If true, the XLA compilation cache records the nodes of clusters whose
+  // input shapes keep changing at runtime, and later graph builds keep those
+  // nodes out of XLA clusters.  Stable parts of the clusters stay clustered.
+  bool tf_xla_cluster_churn_feedback;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
@@ -98,6 +103,18 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile always refuses to compile the cluster, which means the
   // XLA clusters always run in the TF executor.  Defaults to false.
   bool tf_xla_always_defer_compilation;
+
+  // If true, _XlaCompile compiles clusters on a background thread and runs
+  // them in the TF executor until the compilation has finished, instead of
+  // blocking on the compilation.  Only applies to lazily compiled clusters.
+  // Defaults to false.
+  bool tf_xla_async_compilation;
+
+  // If non-empty, the sorted sizes that the dimensions of XLA cluster inputs
+  // are rounded up to, so that inputs whose shapes fall into the same buckets
+  // share one compilation. Dimensions larger than the largest bucket are not
+  // rounded. Defaults to empty.
+  std::vector<int64> tf_xla_shape_buckets;
 };
 
 // Flags for the build_xla_ops pass.
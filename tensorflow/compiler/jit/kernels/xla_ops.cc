@@ -95,6 +95,9 @@ class XlaExecutableClosure {
   const ResourceVarsSnapshot& resource_var_snapshots() const {
     return resource_var_snapshots_;
   }
+  ResourceVarsSnapshot* mutable_resource_var_snapshots() {
+    return &resource_var_snapshots_;
+  }
   int num_constant_args() const { return num_constant_args_; }
 
  private:
@@ -166,7 +169,10 @@ static Status CompileToLocalExecutable(
     const XlaPlatformInfo& platform_info,
     absl::Span<const Tensor* const> inputs,
     absl::Span<VariableInfo const> variable_infos,
-    absl::Span<const int> constants, bool lazy, bool may_alias_resource_update,
+    absl::Span<const int> constants,
+    XlaCompilationCache::CompileMode compile_mode,
+    bool may_alias_resource_update,
+    XlaCompilationCache::LastUsedEntry* last_used_entry,
     xla::LocalClient** client,
     const XlaCompiler::CompilationResult** compilation_result,
     xla::LocalExecutable** executable) {
@@ -210,10 +216,14 @@ static Status CompileToLocalExecutable(
           constants, inputs, variable_infos,
           static_cast<Device*>(ctx->device()));
   TF_RETURN_IF_ERROR(args.status());
+  const std::vector<int64>& shape_buckets =
+      GetXlaOpsCommonFlags().tf_xla_shape_buckets;
+  if (!shape_buckets.empty()) {
+    BucketParameterShapes(shape_buckets, &*args);
+  }
   return cache->Compile(options, function, *args, compile_options,
-                        lazy ? XlaCompilationCache::CompileMode::kLazy
-                             : XlaCompilationCache::CompileMode::kStrict,
-                        compilation_result, executable);
+                        compile_mode, compilation_result, executable,
+                        last_used_entry);
 }
 
 void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
@@ -233,9 +243,9 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
     OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
     Status s = CompileToLocalExecutable(
         ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_, inputs,
-        variable_infos, constants_, /*lazy=*/false,
-        /*may_alias_resource_update=*/true, &client, &compilation_result,
-        &executable);
+        variable_infos, constants_, XlaCompilationCache::CompileMode::kStrict,
+        /*may_alias_resource_update=*/true, &last_used_entry_, &client,
+        &compilation_result, &executable);
     OP_REQUIRES_OK(ctx, s);
   }
 
@@ -392,13 +402,24 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
                                         inputs, resources_, &variable_infos));
     OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
 
-    // Do not alias resource updates as locking variables in XlaCompile and
-    // unlocking them in XlaRun may lead to deadlocks.
+    XlaCompilationCache::CompileMode compile_mode =
+        XlaCompilationCache::CompileMode::kStrict;
+    if (!must_compile_) {
+      compile_mode = GetXlaOpsCommonFlags().tf_xla_async_compilation
+                         ? XlaCompilationCache::CompileMode::kAsync
+                         : XlaCompilationCache::CompileMode::kLazy;
+    }
+
+    // Resource updates may alias their inputs: the aliasing is only a "may
+    // alias", so XlaRun donates a variable's buffer only when, with the
+    // variable locked, it still holds the snapshotted value and nothing else
+    // references it. Variables are never kept locked from XlaCompile to
+    // XlaRun as that may lead to deadlocks.
     Status status = CompileToLocalExecutable(
         ctx, function_, has_ref_vars_, platform_info_, inputs, variable_infos,
-        constants_,
-        /*lazy=*/!must_compile_,
-        /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+        constants_, compile_mode,
+        /*may_alias_resource_update=*/true, &last_used_entry_, &client,
+        &kernel, &executable);
     OP_REQUIRES_OK(ctx, SnapshotResourceVariables(ctx, resources_,
                                                   variable_infos, &variables));
     if (must_compile_ || status.code() != error::UNIMPLEMENTED) {
@@ -484,6 +505,13 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       closure.executable()->executable()->module().input_output_alias_config();
   xla::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs;
   std::map<int, const Tensor*> snapshot_ptrs;
+
+  // Lock the variables updated by the cluster for the duration of the
+  // execution so that their buffers can be donated to it.
+  xla::StatusOr<std::vector<VariableInfo>> variable_infos = GatherVariableInfo(
+      ctx, *closure.compilation_result(), closure.num_constant_args());
+  OP_REQUIRES_OK(ctx, variable_infos.status());
+  OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
   {
     tensorflow::profiler::TraceMe hlo_module_activity(
         [&] {
@@ -497,6 +525,26 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       snapshot_ptrs.emplace(p.first,
                             p.second.has_value() ? &p.second.value() : nullptr);
     }
+    // If an updated variable still holds the value snapshotted by XlaCompile,
+    // drop the snapshot's reference and read the variable directly: its
+    // buffer is then donated to the computation whenever the variable is its
+    // only owner, and the update happens in place.
+    ResourceVarsSnapshot* snapshots = closure.mutable_resource_var_snapshots();
+    for (const VariableInfo& info : *variable_infos) {
+      int arg_num = info.index() + closure.num_constant_args();
+      auto it = snapshots->find(arg_num);
+      if (it == snapshots->end() || !it->second.has_value()) {
+        continue;
+      }
+      Tensor* var_tensor = info.var()->tensor();
+      if (var_tensor->dtype() != it->second->dtype() ||
+          var_tensor->shape() != it->second->shape() ||
+          !var_tensor->SharesBufferWith(*it->second)) {
+        continue;
+      }
+      it->second.reset();
+      snapshot_ptrs[arg_num] = var_tensor;
+    }
     execution_inputs = launch_context.PopulateInputs(
         ctx, closure.compilation_result(), snapshot_ptrs,
         /*missing_ctx_input_prefix=*/closure.num_constant_args(),
@@ -532,10 +580,6 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       },
       tensorflow::profiler::TraceMeLevel::kInfo);
 
-  xla::StatusOr<std::vector<VariableInfo>> variable_infos = GatherVariableInfo(
-      ctx, *closure.compilation_result(), closure.num_constant_args());
-  OP_REQUIRES_OK(ctx, variable_infos.status());
-  OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
   OP_REQUIRES_OK(
       ctx,
       launch_context.PopulateOutputs(
@@ -66,6 +66,10 @@ class XlaLocalLaunchBase : public OpKernel {
   const XlaPlatformInfo platform_info_;
 
   bool has_ref_vars_;
+
+  // The compilation used by the most recent call, to skip the compilation
+  // cache lookup while the signature of the calls doesn't change.
+  XlaCompilationCache::LastUsedEntry last_used_entry_;
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
@@ -107,6 +111,10 @@ class XlaCompileOp : public OpKernel {
   // Whether the graph has TF reference variables.
   const bool has_ref_vars_;
 
+  // The compilation used by the most recent call, to skip the compilation
+  // cache lookup while the signature of the calls doesn't change.
+  XlaCompilationCache::LastUsedEntry last_used_entry_;
+
   // cannot_compile_cluster_ is set to true if XLA returns an Unimplemented
   // error when compiling the cluster this _XlaCompile is supposed to compile.
   // If `cannot_compile_cluster_` is true then we avoid compiling this cluster
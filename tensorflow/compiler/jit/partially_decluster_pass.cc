@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/compiler/jit/partially_decluster_pass.h"
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/device_util.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/xla_cluster_churn_profile.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -386,6 +389,61 @@ Status PartiallyDeclusterGraph(Graph* graph) {
   return Status::OK();
 }
 }  // namespace decluster_root_shape_consumers
+
+namespace decluster_high_churn_nodes {
+
+// Declusters the nodes that XlaClusterChurnProfile recorded as belonging to
+// clusters whose input shapes kept changing at runtime, so that only the stable
+// part of each cluster is compiled.
+//
+// Every clustered successor of a declustered node in the same cluster is
+// declustered as well.  Otherwise a value could leave the cluster and flow back
+// into it, creating a cycle once the cluster is encapsulated.  The profile
+// records dependent nodes as such closed sets already, but the graph may have
+// changed since it was recorded.
+Status PartiallyDeclusterGraph(Graph* graph) {
+  XlaClusterChurnProfile* profile = XlaClusterChurnProfile::Global();
+  if (profile->empty()) {
+    return Status::OK();
+  }
+
+  std::vector<Node*> reverse_post_order;
+  GetReversePostOrder(*graph, &reverse_post_order,
+                      /*stable_comparator=*/NodeComparatorName(),
+                      /*edge_filter=*/NotBackedge);
+
+  // Maps the declustered nodes to the clusters they were removed from.
+  absl::flat_hash_map<const Node*, std::string> declustered;
+  for (Node* n : reverse_post_order) {
+    absl::optional<absl::string_view> cluster = GetXlaClusterForNode(*n);
+    if (!cluster.has_value()) {
+      continue;
+    }
+
+    bool has_declustered_input =
+        absl::c_any_of(n->in_edges(), [&](const Edge* e) {
+          auto it = declustered.find(e->src());
+          return it != declustered.end() && it->second == *cluster;
+        });
+    if (!has_declustered_input && !profile->IsHighChurnNode(n->name())) {
+      continue;
+    }
+
+    bool must_compile_node;
+    TF_RETURN_IF_ERROR(reduce_recompilation::MustCompileNode(
+        n, &must_compile_node));
+    if (must_compile_node) {
+      continue;
+    }
+
+    VLOG(2) << "Declustering " << n->name()
+            << " because its cluster's input shapes change frequently";
+    declustered[n] = std::string(*cluster);
+    RemoveFromXlaCluster(n);
+  }
+  return Status::OK();
+}
+}  // namespace decluster_high_churn_nodes
 }  // namespace
 
 Status PartiallyDeclusterPass::Run(
@@ -416,6 +474,11 @@ Status PartiallyDeclusterPass::Run(
   TF_RETURN_IF_ERROR(
       decluster_root_shape_consumers::PartiallyDeclusterGraph(graph));
 
+  if (GetMarkForCompilationPassFlags()->tf_xla_cluster_churn_feedback) {
+    TF_RETURN_IF_ERROR(
+        decluster_high_churn_nodes::PartiallyDeclusterGraph(graph));
+  }
+
   return Status::OK();
 }
 }  // namespace tensorflow
@@ -23,7 +23,9 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/test_util.h"
+#include "tensorflow/compiler/jit/xla_cluster_churn_profile.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/cc/ops/xla_ops.h"
 #include "tensorflow/compiler/tf2xla/xla_op_kernel.h"
@@ -489,5 +491,43 @@ TEST(PartiallyDeclusterPassTest, MetaConsumersArentDeclustered) {
   EXPECT_EQ(GetXlaClusterForNode(*n_c), "cluster_0");
 }
 
+TEST(PartiallyDeclusterPassTest, DeclustersHighChurnNodes) {
+  tensorflow::Scope root = tensorflow::Scope::NewRootScope();
+  tensorflow::Scope in_cluster = root.WithXlaCluster("cluster_0");
+  std::unique_ptr<Graph> graph = absl::make_unique<Graph>(OpRegistry::Global());
+  Output stable_input = ops::Placeholder(root.WithOpName("stable_input"),
+                                         DT_FLOAT);
+  Output varying_input = ops::Placeholder(root.WithOpName("varying_input"),
+                                          DT_FLOAT);
+  Output stable = ops::Add(in_cluster.WithOpName("stable"), stable_input,
+                           stable_input);
+  Output varying = ops::Mul(in_cluster.WithOpName("varying"), varying_input,
+                            varying_input);
+  ops::Add(in_cluster.WithOpName("combined"), stable, varying);
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  bool old_churn_feedback = flags->tf_xla_cluster_churn_feedback;
+  flags->tf_xla_cluster_churn_feedback = true;
+  XlaClusterChurnProfile::Global()->AddHighChurnNodes({"varying"});
+  Status status = PartiallyDecluster(&graph);
+  XlaClusterChurnProfile::Global()->Clear();
+  flags->tf_xla_cluster_churn_feedback = old_churn_feedback;
+  TF_ASSERT_OK(status);
+
+  // `combined` depends on `varying`, so it has to leave the cluster too.
+  Node* n_stable = FindNodeByName(*graph, "stable");
+  ASSERT_NE(n_stable, nullptr);
+  EXPECT_EQ(GetXlaClusterForNode(*n_stable), "cluster_0");
+
+  Node* n_varying = FindNodeByName(*graph, "varying");
+  ASSERT_NE(n_varying, nullptr);
+  EXPECT_EQ(GetXlaClusterForNode(*n_varying), absl::nullopt);
+
+  Node* n_combined = FindNodeByName(*graph, "combined");
+  ASSERT_NE(n_combined, nullptr);
+  EXPECT_EQ(GetXlaClusterForNode(*n_combined), absl::nullopt);
+}
+
 }  // namespace
 }  // namespace tensorflow
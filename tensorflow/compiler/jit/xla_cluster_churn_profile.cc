@@ -0,0 +1,87 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_cluster_churn_profile.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+
+namespace tensorflow {
+
+/*static*/ XlaClusterChurnProfile* XlaClusterChurnProfile::Global() {
+  static XlaClusterChurnProfile* profile = new XlaClusterChurnProfile;
+  return profile;
+}
+
+void XlaClusterChurnProfile::AddHighChurnNodes(
+    absl::Span<const std::string> node_names) {
+  mutex_lock lock(mu_);
+  high_churn_nodes_.insert(node_names.begin(), node_names.end());
+}
+
+bool XlaClusterChurnProfile::IsHighChurnNode(
+    absl::string_view node_name) const {
+  mutex_lock lock(mu_);
+  return high_churn_nodes_.contains(node_name);
+}
+
+bool XlaClusterChurnProfile::empty() const {
+  mutex_lock lock(mu_);
+  return high_churn_nodes_.empty();
+}
+
+void XlaClusterChurnProfile::Clear() {
+  mutex_lock lock(mu_);
+  high_churn_nodes_.clear();
+}
+
+std::vector<std::string> NodesDependingOnInputs(
+    const FunctionDef& fdef, absl::Span<const int> input_indices) {
+  // Function inputs and body nodes share one namespace in the input strings of
+  // a FunctionDef ("x", "node:output:0" or "^node"), so a single set tracks
+  // both.
+  absl::flat_hash_set<absl::string_view> dependent;
+  for (int index : input_indices) {
+    if (index >= 0 && index < fdef.signature().input_arg_size()) {
+      dependent.insert(fdef.signature().input_arg(index).name());
+    }
+  }
+
+  // The body is not necessarily topologically sorted, so iterate to a fixed
+  // point.
+  std::vector<std::string> result;
+  bool changed = !dependent.empty();
+  while (changed) {
+    changed = false;
+    for (const NodeDef& node : fdef.node_def()) {
+      if (dependent.contains(node.name())) {
+        continue;
+      }
+      for (absl::string_view input : node.input()) {
+        absl::ConsumePrefix(&input, "^");
+        input = input.substr(0, input.find(':'));
+        if (dependent.contains(input)) {
+          dependent.insert(node.name());
+          result.push_back(node.name());
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,71 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_CHURN_PROFILE_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_CHURN_PROFILE_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Records which TensorFlow nodes were part of XLA clusters whose signatures
+// kept changing at runtime, so that the next graph build can keep them out of
+// clusters.
+//
+// XlaCompilationCache fills the profile in when
+// --tf_xla_cluster_churn_feedback is set and a cluster goes megamorphic, and
+// PartiallyDeclusterPass declusters the recorded nodes.  Nodes are identified
+// by name, which is preserved when a cluster is encapsulated into a function.
+//
+// This class is thread safe.
+class XlaClusterChurnProfile {
+ public:
+  // Returns the process-wide profile.
+  static XlaClusterChurnProfile* Global();
+
+  // Records `node_names` as belonging to high-churn regions.
+  void AddHighChurnNodes(absl::Span<const std::string> node_names);
+
+  // Returns true if `node_name` was recorded as belonging to a high-churn
+  // region.
+  bool IsHighChurnNode(absl::string_view node_name) const;
+
+  bool empty() const;
+
+  // Forgets all recorded nodes.
+  void Clear();
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_set<std::string> high_churn_nodes_ TF_GUARDED_BY(mu_);
+};
+
+// Returns the names of the nodes in the body of `fdef` that depend, directly or
+// transitively, on one of the function inputs at `input_indices`.  These are
+// the nodes whose compilation changes when only those inputs change.
+std::vector<std::string> NodesDependingOnInputs(
+    const FunctionDef& fdef, absl::Span<const int> input_indices);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_CLUSTER_CHURN_PROFILE_H_
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <atomic>
+#include <memory>
 #include <numeric>
 
 #include "tensorflow/compiler/mlir/mlir_bridge_rollout_policy.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/compiler/jit/xla_cluster_churn_profile.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/compile_mlir_util.h"
 #include "tensorflow/compiler/mlir/utils/array_container_utils.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
@@ -53,12 +56,29 @@ limitations under the License.
 namespace tensorflow {
 
 constexpr int64 XlaCompilationCache::kDefaultCompilationThreshold;
+constexpr int XlaCompilationCache::kNumAsyncCompilerThreads;
+
+static uint64 NextCacheId() {
+  static std::atomic<uint64> next_cache_id{0};
+  return next_cache_id.fetch_add(1, std::memory_order_relaxed);
+}
 
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
                                          DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+    : client_(client),
+      device_type_(std::move(device_type)),
+      id_(NextCacheId()) {}
 
 XlaCompilationCache::~XlaCompilationCache() {
+  // Wait for asynchronous compilations, which refer to this cache, to finish.
+  {
+    std::unique_ptr<thread::ThreadPool> async_compiler_threads;
+    {
+      mutex_lock lock(async_compilation_mu_);
+      async_compiler_threads = std::move(async_compiler_threads_);
+    }
+  }
+
   // Ensure any use of our programs have completed by waiting for all stream
   // executors to complete.
   for (auto* executor : client_->backend().stream_executors()) {
@@ -96,6 +116,7 @@ string XlaCompilationCache::Signature::HumanString() const {
 }
 
 bool XlaCompilationCache::Signature::operator==(const Signature& other) const {
+  if (hash != other.hash) return false;
   if (name != other.name) return false;
   if (arg_shapes != other.arg_shapes) return false;
 
@@ -112,48 +133,69 @@ bool XlaCompilationCache::Signature::operator==(const Signature& other) const {
 
 uint64 XlaCompilationCache::Signature::Hash::operator()(
     const XlaCompilationCache::Signature& signature) const {
-  uint64 h = std::hash<string>()(signature.name);
-  for (const auto& arg : signature.arg_shapes) {
-    h = Hash64Combine(h, std::hash<int>()(static_cast<int>(arg.first)));
-    h = Hash64Combine(h, std::hash<int>()(arg.second.size()));
-    for (int dim : arg.second) {
-      h = Hash64Combine(h, std::hash<int>()(dim));
-    }
-  }
-  for (const auto& arg : signature.arg_values) {
-    h = Hash64Combine(
-        h, Hash64(arg.tensor_data().data(), arg.tensor_data().size()));
-  }
-  return h;
+  return signature.hash;
 }
 
 xla::StatusOr<XlaCompilationCache::Signature>
 XlaCompilationCache::BuildSignature(
     const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args) {
+  return BuildSignature(
+      Canonicalize(function.name(), AttrSlice(&function.attr())), args);
+}
+
+xla::StatusOr<XlaCompilationCache::Signature>
+XlaCompilationCache::BuildSignature(
+    string canonical_name, absl::Span<const XlaCompiler::Argument> args) {
   Signature signature;
-  signature.name = Canonicalize(function.name(), AttrSlice(&function.attr()));
+  signature.name = std::move(canonical_name);
+  uint64 h = std::hash<string>()(signature.name);
 
   for (const XlaCompiler::Argument& arg : args) {
     switch (arg.kind) {
       case XlaCompiler::Argument::kConstant:
-      case XlaCompiler::Argument::kConstantResource:
+      case XlaCompiler::Argument::kConstantResource: {
         signature.arg_values.push_back(arg.constant_value);
+        absl::string_view data = arg.constant_value.tensor_data();
+        h = Hash64Combine(h, Hash64(data.data(), data.size()));
         break;
+      }
       case XlaCompiler::Argument::kParameter:
-      case XlaCompiler::Argument::kResource:
+      case XlaCompiler::Argument::kResource: {
         signature.arg_shapes.emplace_back(arg.type,
                                           arg.DimensionSizesAsInlinedVector());
+        const auto& dims = signature.arg_shapes.back().second;
+        h = Hash64Combine(h, std::hash<int>()(static_cast<int>(arg.type)));
+        h = Hash64Combine(h, std::hash<int>()(dims.size()));
+        for (int dim : dims) {
+          h = Hash64Combine(h, std::hash<int>()(dim));
+        }
         break;
+      }
       default:
         return errors::InvalidArgument(
             "Unhandled argument kind in XlaCompilationCache: ",
             arg.HumanString());
     }
   }
+  signature.hash = h;
   return std::move(signature);
 }
 
+bool XlaCompilationCache::LookupCompiledEntry(
+    const Entry& entry, const Signature& signature,
+    const XlaCompiler::CompilationResult** out_compilation_result,
+    xla::LocalExecutable** out_executable) const {
+  if (entry.cache_id != id_ ||
+      !entry.compiled_ok.load(std::memory_order_acquire) ||
+      !(entry.signature == signature)) {
+    return false;
+  }
+  *out_compilation_result = &entry.compilation_result;
+  *out_executable = entry.executable.get();
+  return true;
+}
+
 Status XlaCompilationCache::BuildExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& result,
@@ -182,6 +224,27 @@ Status XlaCompilationCache::BuildExecutable(
   return Status::OK();
 }
 
+/*static*/ XlaCompilationCache::CompileFn
+XlaCompilationCache::MakeFunctionCompileFn(
+    const XlaCompiler::CompileOptions& compile_options,
+    const NameAttrList& function, CompileMode compile_mode) {
+  if (compile_mode == CompileMode::kAsync) {
+    return [compile_options, function](
+               XlaCompiler* compiler,
+               absl::Span<const XlaCompiler::Argument> args,
+               XlaCompiler::CompilationResult* result) {
+      return compiler->CompileFunction(compile_options, function, args,
+                                       result);
+    };
+  }
+  return [&compile_options, &function](
+             XlaCompiler* compiler,
+             absl::Span<const XlaCompiler::Argument> args,
+             XlaCompiler::CompilationResult* result) {
+    return compiler->CompileFunction(compile_options, function, args, result);
+  };
+}
+
 Status XlaCompilationCache::Compile(
     const XlaCompiler::Options& options, const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args,
@@ -189,17 +252,25 @@ Status XlaCompilationCache::Compile(
     CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
-  absl::optional<int64> compile_threshold;
-  if (compile_mode == CompileMode::kLazy) {
-    compile_threshold = kDefaultCompilationThreshold;
-  }
-  auto compile_fn = [&](XlaCompiler* compiler,
-                        XlaCompiler::CompilationResult* result) {
-    return compiler->CompileFunction(compile_options, function, args, result);
-  };
-  return CompileImpl(options, function, args, compile_fn,
-                     /*compile_threshold=*/compile_threshold,
-                     out_compilation_result, out_executable);
+  return CompileImpl(
+      options, function, args,
+      MakeFunctionCompileFn(compile_options, function, compile_mode),
+      compile_mode, out_compilation_result, out_executable,
+      /*last_used=*/nullptr);
+}
+
+Status XlaCompilationCache::Compile(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    absl::Span<const XlaCompiler::Argument> args,
+    const XlaCompiler::CompileOptions& compile_options,
+    CompileMode compile_mode,
+    const XlaCompiler::CompilationResult** out_compilation_result,
+    xla::LocalExecutable** out_executable, LastUsedEntry* last_used) {
+  DCHECK_NE(last_used, nullptr);
+  return CompileImpl(
+      options, function, args,
+      MakeFunctionCompileFn(compile_options, function, compile_mode),
+      compile_mode, out_compilation_result, out_executable, last_used);
 }
 
 static bool ShouldBeMegamorphic(int64 compile_count, int64 execution_count) {
@@ -274,6 +345,7 @@ Status XlaCompilationCache::CompileSingleOp(
   // and causes false uniqueness between nodes.
   name.mutable_attr()->erase("_class");
   auto compile_op = [&](XlaCompiler* compiler,
+                        absl::Span<const XlaCompiler::Argument> args,
                         XlaCompiler::CompilationResult* result) {
     std::vector<DataType> result_dtypes(ctx->num_outputs());
     for (int i = 0, end = result_dtypes.size(); i < end; ++i) {
@@ -305,9 +377,9 @@ Status XlaCompilationCache::CompileSingleOp(
         options.device_type.type_string(), compile_options.use_tuple_arg,
         *options.flib_def, debug_info, options.shape_representation_fn, result);
   };
-  return CompileImpl(options, name, args, compile_op,
-                     /*compile_threshold=*/absl::nullopt,
-                     out_compilation_result, out_executable);
+  return CompileImpl(options, name, args, compile_op, CompileMode::kStrict,
+                     out_compilation_result, out_executable,
+                     /*last_used=*/nullptr);
 }
 
 namespace {
@@ -327,15 +399,35 @@ void LogOnceXlaCompiledFirstCluster() {
 Status XlaCompilationCache::CompileImpl(
     const XlaCompiler::Options& options, const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args,
-    const std::function<Status(XlaCompiler* compiler,
-                               XlaCompiler::CompilationResult*)>& compile_fn,
-    absl::optional<int64> compile_threshold,
+    const CompileFn& compile_fn, CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    xla::LocalExecutable** out_executable) {
+    xla::LocalExecutable** out_executable, LastUsedEntry* last_used) {
   if (FailOnXlaCompilation()) {
     return errors::Internal("XLA compilation disabled");
   }
 
+  // Fast path: the signature of this call matches the last compilation used
+  // by the caller, so return it without taking any lock.
+  Signature signature;
+  if (last_used != nullptr) {
+    absl::call_once(last_used->canonical_name_once_, [&] {
+      last_used->canonical_name_ =
+          Canonicalize(function.name(), AttrSlice(&function.attr()));
+    });
+    TF_ASSIGN_OR_RETURN(signature,
+                        BuildSignature(last_used->canonical_name_, args));
+    std::shared_ptr<Entry> last_entry = std::atomic_load(&last_used->entry_);
+    if (last_entry != nullptr &&
+        LookupCompiledEntry(*last_entry, signature, out_compilation_result,
+                            out_executable)) {
+      last_used->pending_execution_count_.fetch_add(1,
+                                                    std::memory_order_relaxed);
+      return Status::OK();
+    }
+  } else {
+    TF_ASSIGN_OR_RETURN(signature, BuildSignature(function, args));
+  }
+
   DCHECK_NE(out_executable, nullptr);
   VLOG(2) << "XlaCompilationCache::Compile " << DebugString();
 
@@ -346,20 +438,23 @@ Status XlaCompilationCache::CompileImpl(
     }
   }
 
-  TF_ASSIGN_OR_RETURN(Signature signature, BuildSignature(function, args));
   VLOG(2) << "Signature: " << signature.HumanString();
 
   // The outer lock protects the existence of the cache entry. It does not
   // protect the contents of the cache entry.
-  Entry* entry;
+  std::shared_ptr<Entry> entry;
+  bool is_new_signature = false;
   {
     mutex_lock lock(compile_cache_mu_);
     // Find or create a cache entry.
-    std::unique_ptr<Entry>& e = cache_[signature];
+    std::shared_ptr<Entry>& e = cache_[signature];
     if (!e) {
-      e.reset(new Entry);
+      is_new_signature = true;
+      e = std::make_shared<Entry>();
+      e->signature = signature;
+      e->cache_id = id_;
     }
-    entry = e.get();
+    entry = e;
   }
 
   // We always compile a cluster the very first time it is executed.  This is an
@@ -378,8 +473,18 @@ Status XlaCompilationCache::CompileImpl(
     auto it =
         cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
             .first;
+    if (last_used != nullptr) {
+      it->second.execution_count +=
+          last_used->pending_execution_count_.exchange(0);
+    }
     is_first_execution = it->second.execution_count++ == 0;
 
+    const bool churn_feedback =
+        GetMarkForCompilationPassFlags()->tf_xla_cluster_churn_feedback;
+    if (churn_feedback && is_new_signature) {
+      UpdateVaryingArgs(args, &it->second);
+    }
+
     // The is_megamorphic bit is "sticky".  We assume clusters that have been
     // observed to be megamorphic once stay megamorphic forever.
     if (!it->second.is_megamorphic &&
@@ -389,6 +494,9 @@ Status XlaCompilationCache::CompileImpl(
               << " as megamorphic, compile_count=" << it->second.compile_count
               << " execution_count=" << it->second.execution_count;
       it->second.is_megamorphic = true;
+      if (churn_feedback) {
+        RecordHighChurnNodes(options.flib_def, function.name(), it->second);
+      }
     }
 
     is_megamorphic = it->second.is_megamorphic;
@@ -399,14 +507,20 @@ Status XlaCompilationCache::CompileImpl(
   // cache eviction.
   mutex_lock entry_lock(entry->mu);
   int64 current_request_count = ++entry->request_count;
-  VLOG(2) << "Compilation cache entry hit: " << entry->compiled
+  VLOG(2) << "Compilation cache entry hit: "
+          << static_cast<int>(entry->compile_state)
           << " signature: " << signature.HumanString() << " with request count "
-          << current_request_count << " and compile threshold "
-          << compile_threshold.value_or(0);
-  if (!entry->compiled) {
-    XLA_SCOPED_LOGGING_TIMER("Compilation of XLA executable");
+          << current_request_count;
+  if (entry->compile_state == Entry::CompileState::kCompiling) {
+    VLOG(2) << "Asynchronous compilation in flight for signature: "
+            << signature.HumanString();
+    *out_compilation_result = nullptr;
+    *out_executable = nullptr;
+    return Status::OK();
+  }
+  if (entry->compile_state == Entry::CompileState::kUncompiled) {
     const bool should_compile = [&] {
-      if (!compile_threshold.has_value()) {
+      if (compile_mode == CompileMode::kStrict) {
         // Lazy compilation is disabled.
         return true;
       }
@@ -420,80 +534,212 @@ Status XlaCompilationCache::CompileImpl(
         return false;
       }
 
-      if (is_first_execution) {
+      // Asynchronous compilations don't block the caller, so they are started
+      // on the first request.
+      if (is_first_execution || compile_mode == CompileMode::kAsync) {
         return true;
       }
 
       bool reached_compile_threshold =
-          current_request_count >= *compile_threshold;
+          current_request_count >= kDefaultCompilationThreshold;
       if (!reached_compile_threshold) {
         VLOG(3)
             << "Not compiling cluster " << function.name()
             << " because it has not reached compile threshold; threshold is "
-            << *compile_threshold << " execution count "
+            << kDefaultCompilationThreshold << " execution count "
             << current_request_count << ".";
       }
       return reached_compile_threshold;
     }();
 
-    if (!should_compile) {
+    if (should_compile && compile_mode == CompileMode::kAsync &&
+        CompileAsynchronous(entry, options, function.name(), args,
+                            compile_fn)) {
+      entry->compile_state = Entry::CompileState::kCompiling;
+    }
+
+    if (!should_compile || compile_mode == CompileMode::kAsync) {
       VLOG(2) << "Not compiling for signature: " << signature.HumanString();
       *out_compilation_result = nullptr;
       *out_executable = nullptr;
       return Status::OK();
     }
 
+    XLA_SCOPED_LOGGING_TIMER("Compilation of XLA executable");
     tensorflow::Env* env = tensorflow::Env::Default();
     const uint64 compile_start_us = env->NowMicros();
-    // Do the actual JIT compilation without holding the lock (it can take
-    // a long time.)
 
     XlaCompiler compiler(options);
-    entry->compiled = true;
+    entry->compile_state = Entry::CompileState::kCompiled;
 
     entry->compilation_status =
-        compile_fn(&compiler, &entry->compilation_result);
+        compile_fn(&compiler, args, &entry->compilation_result);
     TF_RETURN_IF_ERROR(entry->compilation_status);
     CHECK_EQ(entry->executable.get(), nullptr);
     entry->compilation_status =
         BuildExecutable(options, entry->compilation_result, &entry->executable);
 
     const uint64 compile_end_us = env->NowMicros();
-    const uint64 compile_time_us = compile_end_us - compile_start_us;
-    metrics::UpdateXlaCompilationTime(compile_time_us);
-    {
-      mutex_lock lock(cluster_compile_stats_mu_);
-      auto it = cluster_compile_stats_.find(function.name());
-      it->second.compile_count++;
-      it->second.cumulative_compile_time_us += compile_time_us;
-      LogOnceXlaCompiledFirstCluster();
-      VLOG(1) << "compiled " << function.name() << " "
-              << it->second.compile_count
-              << " times, compile time: " << compile_time_us
-              << " us, cumulative: " << it->second.cumulative_compile_time_us
-              << " us ("
-              << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
-                                                               1.0e6)
-              << " / "
-              << tensorflow::strings::HumanReadableElapsedTime(
-                     it->second.cumulative_compile_time_us / 1.0e6)
-              << ")";
-
-      XlaJitCompilationActivity jit_compilation_activity;
-      jit_compilation_activity.set_cluster_name(function.name());
-      jit_compilation_activity.set_compile_count(it->second.compile_count);
-      jit_compilation_activity.set_compile_time_us(compile_time_us);
-      jit_compilation_activity.set_cumulative_compile_time_us(
-          it->second.cumulative_compile_time_us);
-
-      TF_RETURN_IF_ERROR(
-          BroadcastXlaActivity(std::move(jit_compilation_activity)));
-    }
+    TF_RETURN_IF_ERROR(
+        RecordCompilation(function.name(), compile_end_us - compile_start_us));
   }
   TF_RETURN_IF_ERROR(entry->compilation_status);
+  entry->compiled_ok.store(true, std::memory_order_release);
+  if (last_used != nullptr) {
+    std::atomic_store(&last_used->entry_, entry);
+  }
   *out_compilation_result = &entry->compilation_result;
   *out_executable = entry->executable.get();
   return Status::OK();
 }
 
+bool XlaCompilationCache::CompileAsynchronous(
+    std::shared_ptr<Entry> entry, const XlaCompiler::Options& options,
+    const string& function_name, absl::Span<const XlaCompiler::Argument> args,
+    const CompileFn& compile_fn) {
+  mutex_lock lock(async_compilation_mu_);
+  if (num_ongoing_async_compilations_ >= kNumAsyncCompilerThreads) {
+    VLOG(2) << "Not compiling " << function_name
+            << " asynchronously because " << num_ongoing_async_compilations_
+            << " compilations are in flight.";
+    return false;
+  }
+  if (async_compiler_threads_ == nullptr) {
+    async_compiler_threads_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "xla_async_compiler", kNumAsyncCompilerThreads);
+  }
+  ++num_ongoing_async_compilations_;
+
+  // The compilation outlives this call, so it works on copies of everything
+  // the caller owns. The device allocator may live in the caller's stack
+  // frame; without it the client allocates from its backend's allocator,
+  // which is only needed for autotuning.
+  XlaCompiler::Options async_options = options;
+  async_options.device_allocator = nullptr;
+  std::vector<XlaCompiler::Argument> async_args(args.begin(), args.end());
+
+  // The destructor waits for the pool, so `this` outlives the closure.
+  async_compiler_threads_->Schedule([this, entry, async_options, function_name,
+                                     async_args, compile_fn] {
+    VLOG(2) << "Starting asynchronous compilation of " << function_name;
+    tensorflow::Env* env = tensorflow::Env::Default();
+    const uint64 compile_start_us = env->NowMicros();
+
+    // Compile without holding the entry lock, so that callers keep falling
+    // back to TF instead of blocking on it.
+    XlaCompiler compiler(async_options);
+    XlaCompiler::CompilationResult compilation_result;
+    std::unique_ptr<xla::LocalExecutable> executable;
+    Status status = compile_fn(&compiler, async_args, &compilation_result);
+    if (status.ok()) {
+      status =
+          BuildExecutable(async_options, compilation_result, &executable);
+    }
+
+    const uint64 compile_end_us = env->NowMicros();
+    Status record_status =
+        RecordCompilation(function_name, compile_end_us - compile_start_us);
+    if (!record_status.ok()) {
+      LOG(WARNING) << "Failed to record the compilation of " << function_name
+                   << ": " << record_status;
+    }
+    VLOG(2) << "Finished asynchronous compilation of " << function_name
+            << ": " << status;
+
+    {
+      mutex_lock entry_lock(entry->mu);
+      entry->compilation_status = status;
+      entry->compilation_result = std::move(compilation_result);
+      entry->executable = std::move(executable);
+      entry->compile_state = Entry::CompileState::kCompiled;
+    }
+    mutex_lock lock(async_compilation_mu_);
+    --num_ongoing_async_compilations_;
+  });
+  return true;
+}
+
+/*static*/ void XlaCompilationCache::UpdateVaryingArgs(
+    absl::Span<const XlaCompiler::Argument> args, ClusterCompileStats* stats) {
+  std::vector<uint64> fingerprints;
+  fingerprints.reserve(args.size());
+  for (const XlaCompiler::Argument& arg : args) {
+    uint64 fingerprint = Hash64Combine(static_cast<uint64>(arg.kind),
+                                       static_cast<uint64>(arg.type));
+    fingerprint = Hash64Combine(fingerprint, Hash64(arg.ShapeHumanString()));
+    if (arg.kind == XlaCompiler::Argument::kConstant) {
+      StringPiece data = arg.constant_value.tensor_data();
+      fingerprint =
+          Hash64Combine(fingerprint, Hash64(data.data(), data.size()));
+    }
+    fingerprints.push_back(fingerprint);
+  }
+
+  if (stats->first_arg_fingerprints.empty()) {
+    stats->first_arg_fingerprints = std::move(fingerprints);
+    stats->varying_args.assign(args.size(), false);
+    return;
+  }
+  if (fingerprints.size() != stats->first_arg_fingerprints.size()) {
+    return;
+  }
+  for (int i = 0, end = fingerprints.size(); i < end; ++i) {
+    if (fingerprints[i] != stats->first_arg_fingerprints[i]) {
+      stats->varying_args[i] = true;
+    }
+  }
+}
+
+/*static*/ void XlaCompilationCache::RecordHighChurnNodes(
+    const FunctionLibraryDefinition* flib_def, const string& function,
+    const ClusterCompileStats& stats) {
+  const FunctionDef* fdef =
+      flib_def != nullptr ? flib_def->Find(function) : nullptr;
+  if (fdef == nullptr) {
+    VLOG(1) << "Not recording churn of " << function
+            << ": function definition not found.";
+    return;
+  }
+  std::vector<int> varying_args;
+  for (int i = 0, end = stats.varying_args.size(); i < end; ++i) {
+    if (stats.varying_args[i]) {
+      varying_args.push_back(i);
+    }
+  }
+  std::vector<std::string> nodes = NodesDependingOnInputs(*fdef, varying_args);
+  VLOG(1) << "Recording " << nodes.size() << " high-churn nodes of "
+          << function << " depending on " << varying_args.size()
+          << " varying arguments.";
+  XlaClusterChurnProfile::Global()->AddHighChurnNodes(nodes);
+}
+
+Status XlaCompilationCache::RecordCompilation(const string& function_name,
+                                              uint64 compile_time_us) {
+  metrics::UpdateXlaCompilationTime(compile_time_us);
+  mutex_lock lock(cluster_compile_stats_mu_);
+  auto it = cluster_compile_stats_.find(function_name);
+  it->second.compile_count++;
+  it->second.cumulative_compile_time_us += compile_time_us;
+  LogOnceXlaCompiledFirstCluster();
+  VLOG(1) << "compiled " << function_name << " " << it->second.compile_count
+          << " times, compile time: " << compile_time_us
+          << " us, cumulative: " << it->second.cumulative_compile_time_us
+          << " us ("
+          << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
+                                                           1.0e6)
+          << " / "
+          << tensorflow::strings::HumanReadableElapsedTime(
+                 it->second.cumulative_compile_time_us / 1.0e6)
+          << ")";
+
+  XlaJitCompilationActivity jit_compilation_activity;
+  jit_compilation_activity.set_cluster_name(function_name);
+  jit_compilation_activity.set_compile_count(it->second.compile_count);
+  jit_compilation_activity.set_compile_time_us(compile_time_us);
+  jit_compilation_activity.set_cumulative_compile_time_us(
+      it->second.cumulative_compile_time_us);
+
+  return BroadcastXlaActivity(std::move(jit_compilation_activity));
+}
+
 }  // namespace tensorflow
@@ -16,6 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
@@ -50,6 +55,7 @@ class XlaCompilationCache : public ResourceBase {
   enum class CompileMode {
     kLazy,
     kStrict,
+    kAsync,
   };
 
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
@@ -62,7 +68,9 @@ class XlaCompilationCache : public ResourceBase {
   // heuristics, the compilation cache may decide not to compile the cluster at
   // this time.  In this case it returns null into both `out_compilation_result`
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
-  // cache always attempts the compilation on a cache miss.
+  // cache always attempts the compilation on a cache miss.  If `compile_mode`
+  // is `kAsync` then a cache miss starts the compilation on a background
+  // thread and returns null, as in `kLazy` mode, until it has finished.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -77,6 +85,25 @@ class XlaCompilationCache : public ResourceBase {
                  const XlaCompiler::CompilationResult** out_compilation_result,
                  xla::LocalExecutable** out_executable);
 
+  // A single-entry cache of the most recently used compilation, kept by a
+  // caller that repeatedly compiles the same function (e.g. an XlaLaunch op
+  // kernel). See the overload of Compile below.
+  class LastUsedEntry;
+
+  // As above, but first checks whether the compilation recorded in
+  // `last_used` matches the signature of this call, in which case it is
+  // returned without taking any lock. Otherwise looks up the cache as above
+  // and records the compilation in `last_used`. `last_used` must only be used
+  // with a single `function` and must be non-null.
+  Status Compile(const XlaCompiler::Options& options,
+                 const NameAttrList& function,
+                 absl::Span<const XlaCompiler::Argument> args,
+                 const XlaCompiler::CompileOptions& compile_options,
+                 CompileMode compile_mode,
+                 const XlaCompiler::CompilationResult** out_compilation_result,
+                 xla::LocalExecutable** out_executable,
+                 LastUsedEntry* last_used);
+
   // As above, but calls XlaCompiler::CompileSingleOp instead of
   // XlaCompiler::CompileFunction. If MLIR bridge is enabled through ConfigProto
   // in OpKernelContext, then uses MLIR bridge for compilation instead of
@@ -107,6 +134,11 @@ class XlaCompilationCache : public ResourceBase {
     // compilation, ordered by argument number. Tensors must be in host memory.
     absl::InlinedVector<Tensor, 4> arg_values;
 
+    // Hash of the fields above. BuildSignature computes it incrementally while
+    // building the signature, so the constant argument values are hashed once
+    // per signature rather than on every lookup.
+    uint64 hash = 0;
+
     bool operator==(const Signature& other) const;
 
     struct Hash {
@@ -123,15 +155,54 @@ class XlaCompilationCache : public ResourceBase {
       absl::Span<const XlaCompiler::Argument> args);
 
  private:
+  struct Entry;
+
+  // As above, but for a function whose canonicalized name is already known.
+  static xla::StatusOr<Signature> BuildSignature(
+      string canonical_name, absl::Span<const XlaCompiler::Argument> args);
+
+  // Returns true and sets the outputs if `entry` belongs to this cache, was
+  // compiled successfully and matches `signature`. Doesn't lock `entry`; a
+  // successfully compiled entry is never modified again.
+  bool LookupCompiledEntry(
+      const Entry& entry, const Signature& signature,
+      const XlaCompiler::CompilationResult** out_compilation_result,
+      xla::LocalExecutable** out_executable) const
+      TF_NO_THREAD_SAFETY_ANALYSIS;
+
+  // Compiles the arguments it is given into a CompilationResult.
+  using CompileFn = std::function<Status(
+      XlaCompiler* compiler, absl::Span<const XlaCompiler::Argument> args,
+      XlaCompiler::CompilationResult* result)>;
+
+  // Returns the CompileFn used by Compile. In kAsync mode the function owns
+  // copies of `compile_options` and `function`, since the compilation may
+  // outlive the call.
+  static CompileFn MakeFunctionCompileFn(
+      const XlaCompiler::CompileOptions& compile_options,
+      const NameAttrList& function, CompileMode compile_mode);
+
   // Common implementation of Compile and CompileSingleOp.
   Status CompileImpl(
       const XlaCompiler::Options& options, const NameAttrList& function,
       absl::Span<const XlaCompiler::Argument> args,
-      const std::function<Status(XlaCompiler* compiler,
-                                 XlaCompiler::CompilationResult*)>& compile_fn,
-      absl::optional<int64> compile_threshold,
+      const CompileFn& compile_fn, CompileMode compile_mode,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      xla::LocalExecutable** out_executable);
+      xla::LocalExecutable** out_executable, LastUsedEntry* last_used);
+
+  // Starts compiling `entry` on async_compiler_threads_. The results are
+  // stored in `entry` once the compilation has finished. Returns false if too
+  // many compilations are in flight already, in which case nothing is started.
+  bool CompileAsynchronous(std::shared_ptr<Entry> entry,
+                           const XlaCompiler::Options& options,
+                           const string& function_name,
+                           absl::Span<const XlaCompiler::Argument> args,
+                           const CompileFn& compile_fn);
+
+  // Updates the compilation statistics of `function_name` after a compilation
+  // that took `compile_time_us` and broadcasts them as XLA activity.
+  Status RecordCompilation(const string& function_name,
+                           uint64 compile_time_us);
 
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
@@ -142,12 +213,27 @@ class XlaCompilationCache : public ResourceBase {
   xla::LocalClient* const client_;
   const DeviceType device_type_;
 
+  // Unique id of this cache, so that a LastUsedEntry filled in by another
+  // cache is never mistaken for one of ours.
+  const uint64 id_;
+
   // The value associated with a cache entry.
   struct Entry {
     mutex mu;
 
-    // Have we tried compiling this entry?
-    bool compiled = false;
+    // The signature and cache id of this entry. Never modified after the entry
+    // is created.
+    Signature signature;
+    uint64 cache_id = 0;
+
+    // Set once the entry has been compiled successfully. From then on the
+    // entry is never modified again, so it can be read without holding `mu`.
+    std::atomic<bool> compiled_ok{false};
+
+    // Have we tried compiling this entry? kCompiling means that an
+    // asynchronous compilation is in flight.
+    enum class CompileState { kUncompiled, kCompiling, kCompiled };
+    CompileState compile_state TF_GUARDED_BY(mu) = CompileState::kUncompiled;
 
     // The number of times a compilation with this signature has been requested.
     int64 request_count = 0;
@@ -164,7 +250,8 @@ class XlaCompilationCache : public ResourceBase {
   };
 
   mutex compile_cache_mu_;
-  absl::flat_hash_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
+  // Entries are shared with the LastUsedEntry objects that refer to them.
+  absl::flat_hash_map<Signature, std::shared_ptr<Entry>, Signature::Hash> cache_
       TF_GUARDED_BY(compile_cache_mu_);
 
   struct ClusterCompileStats {
@@ -181,8 +268,24 @@ class XlaCompilationCache : public ResourceBase {
     // change too frequently) to profitably JIT compile.  Once a cluster is
     // tagged megamorphic, it stays megamorphic forever.
     bool is_megamorphic = false;
+
+    // Only tracked with --tf_xla_cluster_churn_feedback: fingerprints of the
+    // arguments the cluster was first compiled for, and for each argument
+    // whether a later compilation saw it with a different shape or value.
+    std::vector<uint64> first_arg_fingerprints;
+    std::vector<bool> varying_args;
   };
 
+  // Updates `stats->varying_args` for a compilation of the cluster for `args`.
+  static void UpdateVaryingArgs(absl::Span<const XlaCompiler::Argument> args,
+                                ClusterCompileStats* stats);
+
+  // Records the nodes of `function` that depend on the varying arguments in
+  // `stats` in the XlaClusterChurnProfile.
+  static void RecordHighChurnNodes(const FunctionLibraryDefinition* flib_def,
+                                   const string& function,
+                                   const ClusterCompileStats& stats);
+
   mutex cluster_compile_stats_mu_;
 
   // Maps cluster names to compilation statistics for said cluster.
@@ -193,9 +296,45 @@ class XlaCompilationCache : public ResourceBase {
   // signature before  we attempt to compile it.
   static constexpr int64 kDefaultCompilationThreshold = 2;
 
+  // The number of threads used for asynchronous compilations, which is also
+  // the maximum number of asynchronous compilations in flight.
+  static constexpr int kNumAsyncCompilerThreads = 4;
+
+  mutex async_compilation_mu_;
+
+  // Created on the first asynchronous compilation.
+  std::unique_ptr<thread::ThreadPool> async_compiler_threads_
+      TF_GUARDED_BY(async_compilation_mu_);
+  int64 num_ongoing_async_compilations_ TF_GUARDED_BY(async_compilation_mu_) =
+      0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(XlaCompilationCache);
 };
 
+class XlaCompilationCache::LastUsedEntry {
+ public:
+  LastUsedEntry() = default;
+
+ private:
+  friend class XlaCompilationCache;
+
+  // The canonicalized name of the function compiled with this object, which
+  // is computed once instead of on every call.
+  absl::once_flag canonical_name_once_;
+  string canonical_name_;
+
+  // The most recently used entry. Only accessed through std::atomic_load and
+  // std::atomic_store, so that concurrent callers don't need a lock.
+  std::shared_ptr<Entry> entry_;
+
+  // The number of executions served from `entry_` that have not been added to
+  // the cluster's execution count yet. They are added on the next lookup in
+  // the cache, which is the only place where the count is used.
+  std::atomic<int64> pending_execution_count_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LastUsedEntry);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
 #include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/xla_launch_util.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/core/platform/test.h"
@@ -54,6 +55,57 @@ TEST(XlaCompilationCacheTest, SignatureEquality) {
   }
 }
 
+TEST(XlaCompilationCacheTest, SignatureHashIsComputedWhileBuilding) {
+  NameAttrList fn;
+  fn.set_name("afunction");
+  std::vector<XlaCompiler::Argument> args(2);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({2, 3});
+  args[1].kind = XlaCompiler::Argument::kConstant;
+  args[1].type = DT_INT32;
+  args[1].shape = TensorShape({});
+  args[1].constant_value = Tensor(DT_INT32, TensorShape({}));
+  args[1].constant_value.scalar<int32>()() = 1;
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s1,
+                          XlaCompilationCache::BuildSignature(fn, args));
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s2,
+                          XlaCompilationCache::BuildSignature(fn, args));
+  EXPECT_EQ(s1.hash, s2.hash);
+  EXPECT_EQ(XlaCompilationCache::Signature::Hash()(s1), s1.hash);
+
+  args[1].constant_value = Tensor(DT_INT32, TensorShape({}));
+  args[1].constant_value.scalar<int32>()() = 2;
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s3,
+                          XlaCompilationCache::BuildSignature(fn, args));
+  EXPECT_NE(s1.hash, s3.hash);
+  EXPECT_FALSE(s1 == s3);
+}
+
+TEST(XlaCompilationCacheTest, BucketedShapesShareSignature) {
+  NameAttrList fn;
+  fn.set_name("afunction");
+  const std::vector<int64> buckets = {4, 8};
+  auto bucketed_signature = [&](const TensorShape& shape) {
+    std::vector<XlaCompiler::Argument> args(1);
+    args[0].kind = XlaCompiler::Argument::kParameter;
+    args[0].type = DT_FLOAT;
+    args[0].shape = shape;
+    BucketParameterShapes(buckets, &args);
+    return XlaCompilationCache::BuildSignature(fn, args).ValueOrDie();
+  };
+
+  XlaCompilationCache::Signature s1 = bucketed_signature(TensorShape({3, 5}));
+  XlaCompilationCache::Signature s2 = bucketed_signature(TensorShape({4, 7}));
+  XlaCompilationCache::Signature s3 = bucketed_signature(TensorShape({5, 7}));
+  // Dimensions beyond the largest bucket are not rounded.
+  XlaCompilationCache::Signature s4 = bucketed_signature(TensorShape({3, 9}));
+  XlaCompilationCache::Signature s5 = bucketed_signature(TensorShape({3, 10}));
+  EXPECT_TRUE(s1 == s2);
+  EXPECT_FALSE(s1 == s3);
+  EXPECT_FALSE(s4 == s5);
+}
+
 TEST(XlaCompilationCacheTest, TestDisabledXlaCompilation) {
   NameAttrList fn;
   fn.set_name("afunction");
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -200,6 +201,41 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+// Copies `tensor` into a new buffer laid out for the bounded dynamic shape
+// `device_shape`: the tensor data comes first, followed by the int32 size of
+// each dimension at the offset reserved for the fully padded shape.
+static xla::StatusOr<se::OwningDeviceMemory> CopyToDynamicShapeBuffer(
+    se::Stream* stream, se::DeviceMemoryAllocator* allocator,
+    int device_ordinal, const xla::Compiler& compiler, const Tensor& tensor,
+    const xla::Shape& device_shape) {
+  auto shape_size_fn = compiler.ShapeSizeBytesFunction();
+  const int64 metadata_offset =
+      shape_size_fn(xla::ShapeUtil::MakeStaticShape(device_shape));
+  const int64 buffer_size = shape_size_fn(device_shape);
+  TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory buffer,
+                      allocator->Allocate(device_ordinal, buffer_size));
+
+  se::DeviceMemoryBase data = XlaTensor::DeviceMemoryFromTensor(tensor);
+  se::DeviceMemoryBase destination = *buffer;
+  stream->ThenMemcpyD2D(&destination, data, data.size());
+
+  auto dimension_sizes = std::make_shared<std::vector<int32>>();
+  for (int64 dim_size : tensor.shape().dim_sizes()) {
+    dimension_sizes->push_back(dim_size);
+  }
+  se::DeviceMemoryBase metadata(
+      static_cast<char*>(destination.opaque()) + metadata_offset,
+      buffer_size - metadata_offset);
+  stream->ThenMemcpy(&metadata, dimension_sizes->data(),
+                     dimension_sizes->size() * sizeof(int32));
+  // Keep the host-side sizes alive until the copy has been issued.
+  stream->ThenDoHostCallback([dimension_sizes]() {});
+  if (!stream->ok()) {
+    return errors::Internal("Failed to copy a bucketed XLA argument");
+  }
+  return std::move(buffer);
+}
+
 xla::StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
@@ -251,7 +287,23 @@ XlaComputationLaunchContext::PopulateInputs(
 
     arguments.emplace_back(device_shape, shape);
     xla::ExecutionInput& execution_input = arguments.back();
-    if (xla::Shape::Equal().MinorToMajorOnlyInLayout()(shape, device_shape)) {
+    if (device_shape.is_dynamic() && device_shape.IsArray()) {
+      // The computation was compiled for a bucket of shapes (see
+      // BucketParameterShapes); pass the real sizes as dynamic shape metadata.
+      se::Stream* stream = ctx->op_device_context()
+                               ? ctx->op_device_context()->stream()
+                               : nullptr;
+      if (!stream) {
+        return errors::Unimplemented(
+            "Bucketed XLA arguments require a device stream");
+      }
+      TF_ASSIGN_OR_RETURN(
+          se::OwningDeviceMemory buffer,
+          CopyToDynamicShapeBuffer(stream, xla_allocator_, device_ordinal_,
+                                   *client_->backend().compiler(), *t,
+                                   device_shape));
+      *execution_input.MutableBuffer({}) = std::move(buffer);
+    } else if (xla::Shape::Equal().MinorToMajorOnlyInLayout()(shape, device_shape)) {
       se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
       PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
                                    donate_buffer, device_ordinal_,
@@ -559,6 +611,35 @@ Status XlaComputationLaunchContext::PopulateOutputs(
   return Status::OK();
 }
 
+void BucketParameterShapes(absl::Span<const int64> buckets,
+                           std::vector<XlaCompiler::Argument>* args) {
+  DCHECK(absl::c_is_sorted(buckets));
+  for (XlaCompiler::Argument& arg : *args) {
+    if (arg.kind != XlaCompiler::Argument::kParameter ||
+        !absl::holds_alternative<TensorShape>(arg.shape)) {
+      continue;
+    }
+    const TensorShape& shape = absl::get<TensorShape>(arg.shape);
+    xla::Shape xla_shape;
+    if (!TensorShapeToXLAShape(arg.type, shape, &xla_shape).ok()) {
+      continue;
+    }
+    bool bucketed = false;
+    for (int i = 0; i < shape.dims(); ++i) {
+      auto bucket = absl::c_lower_bound(buckets, shape.dim_size(i));
+      if (bucket == buckets.end()) {
+        continue;
+      }
+      xla_shape.set_dimensions(i, *bucket);
+      xla_shape.set_dynamic_dimension(i, true);
+      bucketed = true;
+    }
+    if (bucketed) {
+      arg.shape = xla_shape;
+    }
+  }
+}
+
 xla::StatusOr<std::vector<XlaCompiler::Argument>>
 XlaComputationLaunchContext::BuildXlaCompilerArguments(
     absl::Span<int const> must_be_constant_idxs,
@@ -120,6 +120,15 @@ Status GetVariableInfosFromInputs(ResourceMgr* rm, DeviceBase* dev,
 // Returns pointers to inputs stored in `ctx`.
 std::vector<const Tensor*> InputsFromContext(OpKernelContext* ctx);
 
+// Rounds each dimension of the kParameter arguments in `args` up to the
+// smallest of the sorted `buckets` that can hold it and marks it dynamic, so
+// that all shapes falling into the same buckets share one compilation. XLA's
+// dynamic padder keeps the padded computation correct, and PopulateInputs
+// passes the real sizes at run time. Dimensions larger than the largest bucket
+// stay static.
+void BucketParameterShapes(absl::Span<const int64> buckets,
+                           std::vector<XlaCompiler::Argument>* args);
+
 // Helper class to perform the marshalling of TensorFlow inputs and outputs to
 // ShapedBuffers suitable for passing to an XLA computation.
 class XlaComputationLaunchContext {
@@ -0,0 +1,271 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2migraphx/convert/convert_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/tf2migraphx/convert/convert_nodes.h"
+#include "tensorflow/compiler/tf2tensorrt/segment/segment.h"
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph_to_functiondef.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+#if TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+namespace tensorflow {
+namespace tf2migraphx {
+namespace convert {
+
+namespace {
+
+using absl::StrCat;
+using tensorrt::segment::Segment;
+
+int64 GetNextGraphSequenceNumber() {
+  static std::atomic<int64> graph_sequence_num;
+  return graph_sequence_num++;
+}
+
+// Registers `segment_graph_def` as the function `function_name` in the
+// function library of `graph`.
+Status RegisterSegmentFunction(const GraphDef& segment_graph_def,
+                               const string& function_name, Graph* graph) {
+  Graph segment_graph(graph->flib_def());
+  TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(GraphConstructorOptions(),
+                                            segment_graph_def, &segment_graph));
+  FunctionDefLibrary library;
+  TF_RETURN_IF_ERROR(GraphToFunctionDef(segment_graph, function_name,
+                                        library.add_function()));
+  return graph->AddFunctionLibrary(library);
+}
+
+// Replaces the nodes of `segment` by a MIGraphXEngineOp named `engine_name`.
+// `topo_order` holds the nodes of the graph in topological order. The graph
+// is only modified if the segment is replaced.
+Status ReplaceSegment(const ConversionParams& params, const Segment& segment,
+                      const std::vector<Node*>& topo_order,
+                      const string& engine_name, Graph* graph) {
+  // Compare the nodes by address, since topo_order may hold nodes of the
+  // segments replaced before.
+  const std::unordered_set<const Node*> segment_nodes(segment.nodes.begin(),
+                                                      segment.nodes.end());
+  auto in_segment = [&segment_nodes](const Node* node) {
+    return segment_nodes.count(node) != 0;
+  };
+
+  // The body of the function of the segment, in topological order. Tensors
+  // produced outside of the segment become _Arg nodes and tensors consumed
+  // outside of the segment _Retval nodes.
+  GraphDef segment_graph_def;
+  std::vector<NodeDefBuilder::NodeOut> inputs;
+  std::vector<std::pair<Node*, int>> input_tensors;
+  std::map<std::pair<const Node*, int>, int> input_indices;
+  std::set<Node*> control_inputs;
+  DataTypeVector out_types;
+  std::map<std::pair<const Node*, int>, int> output_indices;
+  // The consumers of each output of the engine.
+  std::vector<std::vector<std::pair<Node*, int>>> output_consumers;
+  std::set<Node*> control_outputs;
+
+  for (Node* node : topo_order) {
+    if (!in_segment(node)) continue;
+    NodeDef node_def = node->def();
+    node_def.clear_input();
+
+    std::vector<const Edge*> data_edges(node->num_inputs());
+    std::vector<string> control_input_names;
+    for (const Edge* edge : node->in_edges()) {
+      if (!edge->IsControlEdge()) {
+        data_edges[edge->dst_input()] = edge;
+      } else if (in_segment(edge->src())) {
+        control_input_names.push_back(StrCat("^", edge->src()->name()));
+      } else if (!edge->src()->IsSource()) {
+        control_inputs.insert(edge->src());
+      }
+    }
+    for (const Edge* edge : data_edges) {
+      Node* src = edge->src();
+      if (in_segment(src)) {
+        node_def.add_input(StrCat(src->name(), ":", edge->src_output()));
+        continue;
+      }
+      auto inserted = input_indices.emplace(
+          std::make_pair(src, edge->src_output()), inputs.size());
+      const int index = inserted.first->second;
+      if (inserted.second) {
+        const DataType dtype = src->output_type(edge->src_output());
+        inputs.emplace_back(src->name(), edge->src_output(), dtype);
+        input_tensors.emplace_back(src, edge->src_output());
+        NodeDef* arg = segment_graph_def.add_node();
+        TF_RETURN_IF_ERROR(
+            NodeDefBuilder(StrCat("MIGraphXInput_", index), "_Arg")
+                .Attr("T", dtype)
+                .Attr("index", index)
+                .Finalize(arg));
+      }
+      node_def.add_input(StrCat("MIGraphXInput_", index));
+    }
+    std::sort(control_input_names.begin(), control_input_names.end());
+    for (const string& name : control_input_names) node_def.add_input(name);
+    *segment_graph_def.add_node() = std::move(node_def);
+
+    for (const Edge* edge : node->out_edges()) {
+      Node* dst = edge->dst();
+      if (in_segment(dst) || dst->IsSink()) continue;
+      if (edge->IsControlEdge()) {
+        control_outputs.insert(dst);
+        continue;
+      }
+      auto inserted = output_indices.emplace(
+          std::make_pair(node, edge->src_output()), out_types.size());
+      const int index = inserted.first->second;
+      if (inserted.second) {
+        const DataType dtype = node->output_type(edge->src_output());
+        out_types.push_back(dtype);
+        output_consumers.emplace_back();
+        NodeDef* retval = segment_graph_def.add_node();
+        TF_RETURN_IF_ERROR(
+            NodeDefBuilder(StrCat("MIGraphXOutput_", index), "_Retval")
+                .Input(node->name(), edge->src_output(), dtype)
+                .Attr("index", index)
+                .Finalize(retval));
+      }
+      output_consumers[index].emplace_back(dst, edge->dst_input());
+    }
+  }
+  // Segments without inputs should have been constant folded.
+  if (inputs.empty()) {
+    return errors::Internal("Segment has no inputs");
+  }
+  if (out_types.empty()) {
+    return errors::Internal("Segment has no outputs");
+  }
+
+  NameAttrList function;
+  function.set_name(StrCat(engine_name, "_native_segment"));
+  TF_RETURN_IF_ERROR(
+      RegisterSegmentFunction(segment_graph_def, function.name(), graph));
+
+  NodeDefBuilder builder(engine_name, "MIGraphXEngineOp");
+  const DeviceNameUtils::ParsedName device = segment.property.DeviceName();
+  if (device.has_type) {
+    builder.Device(DeviceNameUtils::ParsedNameToString(device));
+  }
+  builder.Input(inputs);
+  for (const Node* control_input : control_inputs) {
+    builder.ControlInput(control_input->name());
+  }
+  NodeDef engine_def;
+  TF_RETURN_IF_ERROR(
+      builder.Attr("segment_func", function)
+          .Attr("OutT", out_types)
+          .Attr("max_cached_engines_count", params.max_cached_engines)
+          .Attr("precision_mode", params.precision_mode)
+          .Finalize(&engine_def));
+  Status status;
+  Node* engine_node = graph->AddNode(engine_def, &status);
+  TF_RETURN_IF_ERROR(status);
+
+  // Up to this point the graph is unchanged, apart from the new function.
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    graph->AddEdge(input_tensors[i].first, input_tensors[i].second,
+                   engine_node, i);
+  }
+  for (Node* control_input : control_inputs) {
+    graph->AddControlEdge(control_input, engine_node);
+  }
+  for (int i = 0; i < output_consumers.size(); ++i) {
+    for (const auto& consumer : output_consumers[i]) {
+      TF_CHECK_OK(
+          graph->UpdateEdge(engine_node, i, consumer.first, consumer.second));
+    }
+  }
+  for (Node* control_output : control_outputs) {
+    graph->AddControlEdge(engine_node, control_output);
+  }
+  for (const Node* node : segment.nodes) {
+    graph->RemoveNode(const_cast<Node*>(node));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ConvertGraph(const ConversionParams& params) {
+  const GraphDef& graph_def = params.grappler_item->graph;
+  grappler::GraphProperties graph_properties(*params.grappler_item);
+  TF_RETURN_IF_ERROR(graph_properties.InferStatically(true));
+
+  FunctionLibraryDefinition flib(OpRegistry::Global(), graph_def.library());
+  Graph graph(flib);
+  TF_RETURN_IF_ERROR(
+      ConvertGraphDefToGraph(GraphConstructorOptions(), graph_def, &graph));
+
+  tensorrt::segment::SegmentOptions segment_options;
+  segment_options.exclude_node_list.insert(params.output_names->begin(),
+                                           params.output_names->end());
+  segment_options.minimum_segment_size = params.minimum_segment_size;
+  // Programs are compiled for the concrete input shapes of each run, so the
+  // segments may have dynamic dimensions.
+  segment_options.use_implicit_batch = false;
+  segment_options.allow_dynamic_non_batch_dim = true;
+  tensorrt::segment::SegmentVector segments;
+  TF_RETURN_IF_ERROR(tensorrt::segment::SegmentGraph(
+      &graph, &graph_properties, IsMIGraphXCandidate,
+      [](const Edge* edge) { return true; },
+      [](const Edge* edge) { return true; }, segment_options, &segments));
+  LOG(INFO) << "Number of MIGraphX candidate segments: " << segments.size();
+
+  std::vector<Node*> topo_order;
+  GetReversePostOrder(graph, &topo_order);
+  const string engine_name_prefix =
+      StrCat("MIGraphXEngineOp_", GetNextGraphSequenceNumber(), "_");
+  for (int i = 0; i < segments.size(); ++i) {
+    const string engine_name = StrCat(engine_name_prefix, i);
+    const int num_nodes = segments[i].nodes.size();
+    Status status =
+        ReplaceSegment(params, segments[i], topo_order, engine_name, &graph);
+    if (status.ok()) {
+      LOG(INFO) << "Replaced segment " << i << " consisting of " << num_nodes
+                << " nodes by " << engine_name << ".";
+    } else {
+      LOG(WARNING) << "Cannot replace segment " << i << " consisting of "
+                   << num_nodes << " nodes: " << status.error_message()
+                   << " (keeping original segment).";
+    }
+  }
+  graph.ToGraphDef(params.output_graph_def);
+  return Status::OK();
+}
+
+}  // namespace convert
+}  // namespace tf2migraphx
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
@@ -0,0 +1,58 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_CONVERT_GRAPH_H_
+#define TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_CONVERT_GRAPH_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+#if TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+namespace tensorflow {
+namespace tf2migraphx {
+namespace convert {
+
+struct ConversionParams {
+  const grappler::GrapplerItem* grappler_item = nullptr;
+  // Nodes that must stay in the graph, e.g. fetched nodes.
+  const std::vector<string>* output_names = nullptr;
+  GraphDef* output_graph_def = nullptr;
+  int minimum_segment_size = 3;
+  // Maximum number of programs cached by each MIGraphXEngineOp, one for each
+  // set of input shapes.
+  int max_cached_engines = 1;
+  // "FP32" or "FP16".
+  string precision_mode = "FP32";
+};
+
+// Replaces the segments of the graph of `params.grappler_item` that MIGraphX
+// can run by MIGraphXEngineOps, which compile their segment to a MIGraphX
+// program when they first run with new input shapes. The segments are found
+// by the same segmenter as TF-TRT's, and are kept in the function library so
+// that the engine ops can fall back to them.
+Status ConvertGraph(const ConversionParams& params);
+
+}  // namespace convert
+}  // namespace tf2migraphx
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+#endif  // TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_CONVERT_GRAPH_H_
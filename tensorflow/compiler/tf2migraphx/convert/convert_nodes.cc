@@ -0,0 +1,503 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2migraphx/convert/convert_nodes.h"
+
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/kernel_shape_util.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/padding.h"
+
+#if TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+namespace tensorflow {
+namespace tf2migraphx {
+namespace convert {
+
+namespace {
+
+using absl::StrCat;
+
+// A value computed by the program under construction. MIGraphX infers the
+// shapes of the instructions by itself, but the converters also need them to
+// compute the attributes of the instructions they add.
+struct Operand {
+  Operand(::migraphx::instruction instruction, DataType dtype,
+          TensorShape shape)
+      : instruction(std::move(instruction)),
+        dtype(dtype),
+        shape(std::move(shape)) {}
+
+  ::migraphx::instruction instruction;
+  DataType dtype;
+  TensorShape shape;
+};
+
+Status TfTypeToMIGraphXType(DataType dtype, migraphx_shape_datatype_t* type) {
+  switch (dtype) {
+    case DT_FLOAT:
+      *type = migraphx_shape_float_type;
+      return Status::OK();
+    case DT_HALF:
+      *type = migraphx_shape_half_type;
+      return Status::OK();
+    case DT_INT32:
+      *type = migraphx_shape_int32_type;
+      return Status::OK();
+    default:
+      return errors::Unimplemented("Data type ", DataTypeString(dtype),
+                                   " is not supported by MIGraphX");
+  }
+}
+
+// Returns the MIGraphX shape of tensors of the given type and shape. Scalars
+// are represented by one element vectors.
+Status MakeShape(DataType dtype, const TensorShape& shape,
+                 std::unique_ptr<::migraphx::shape>* migraphx_shape) {
+  migraphx_shape_datatype_t type;
+  TF_RETURN_IF_ERROR(TfTypeToMIGraphXType(dtype, &type));
+  std::vector<size_t> lens;
+  for (int64 dim : shape.dim_sizes()) lens.push_back(dim);
+  if (lens.empty()) lens.push_back(1);
+  *migraphx_shape = absl::make_unique<::migraphx::shape>(type, lens);
+  return Status::OK();
+}
+
+// Returns the attributes of a MIGraphX operation that takes a single list.
+string ListAttr(const string& name, absl::Span<const int64> values) {
+  return StrCat("{", name, ": [", absl::StrJoin(values, ", "), "]}");
+}
+
+// Adds the instructions for the nodes of the segment to a MIGraphX module.
+class Converter {
+ public:
+  explicit Converter(::migraphx::module* module) : module_(module) {}
+
+  // Adds an instruction computing `name` with the given attributes, which
+  // produces values of type `dtype` and shape `shape`.
+  Operand Add(const char* name, const string& attributes,
+              const std::vector<Operand>& args, DataType dtype,
+              const TensorShape& shape) {
+    ::migraphx::operation op(name, attributes.c_str());
+    return Operand(module_->add_instruction(op, Instructions(args)), dtype,
+                   shape);
+  }
+
+  // Returns `x` broadcasted to `shape`, following the numpy rules.
+  Operand Broadcast(const Operand& x, const TensorShape& shape) {
+    if (x.shape == shape) return x;
+    return Add("multibroadcast", ListAttr("out_lens", shape.dim_sizes()), {x},
+               x.dtype, shape);
+  }
+
+  // Returns a scalar constant broadcasted to `shape`.
+  Status Scalar(float value, DataType dtype, const TensorShape& shape,
+                std::vector<Operand>* outputs) {
+    Tensor tensor(dtype, TensorShape({}));
+    switch (dtype) {
+      case DT_FLOAT:
+        tensor.scalar<float>()() = value;
+        break;
+      case DT_HALF:
+        tensor.scalar<Eigen::half>()() = Eigen::half(value);
+        break;
+      default:
+        return errors::Unimplemented("Scalars of type ",
+                                     DataTypeString(dtype));
+    }
+    TF_RETURN_IF_ERROR(Literal(tensor, outputs));
+    outputs->back() = Broadcast(outputs->back(), shape);
+    return Status::OK();
+  }
+
+  // Adds the contents of `tensor` to the program.
+  Status Literal(const Tensor& tensor, std::vector<Operand>* outputs) {
+    std::unique_ptr<::migraphx::shape> shape;
+    TF_RETURN_IF_ERROR(MakeShape(tensor.dtype(), tensor.shape(), &shape));
+    outputs->emplace_back(
+        module_->add_literal(*shape, tensor.tensor_data().data()),
+        tensor.dtype(), tensor.shape());
+    return Status::OK();
+  }
+
+  Status Parameter(const string& name, DataType dtype,
+                   const TensorShape& shape, std::vector<Operand>* outputs) {
+    std::unique_ptr<::migraphx::shape> migraphx_shape;
+    TF_RETURN_IF_ERROR(MakeShape(dtype, shape, &migraphx_shape));
+    outputs->emplace_back(module_->add_parameter(name, *migraphx_shape),
+                          dtype, shape);
+    return Status::OK();
+  }
+
+  void Return(const std::vector<Operand>& values) {
+    module_->add_return(Instructions(values));
+  }
+
+ private:
+  static ::migraphx::instructions Instructions(
+      const std::vector<Operand>& operands) {
+    std::vector<const_migraphx_instruction_t> handles;
+    handles.reserve(operands.size());
+    for (const Operand& operand : operands) {
+      handles.push_back(operand.instruction.get_handle_ptr());
+    }
+    migraphx_instructions_t instructions;
+    CHECK_EQ(migraphx_instructions_create(&instructions, handles.data(),
+                                          handles.size()),
+             migraphx_status_success);
+    return ::migraphx::instructions(instructions, ::migraphx::own{});
+  }
+
+  ::migraphx::module* module_;
+};
+
+// Converts a node with the given inputs, and appends its outputs to
+// `outputs`.
+using ConverterFn =
+    std::function<Status(Converter*, const NodeDef&,
+                         const std::vector<Operand>&, std::vector<Operand>*)>;
+
+ConverterFn ConvertUnary(const char* name) {
+  return [name](Converter* converter, const NodeDef& node_def,
+                const std::vector<Operand>& inputs,
+                std::vector<Operand>* outputs) {
+    outputs->push_back(converter->Add(name, "{}", {inputs[0]},
+                                      inputs[0].dtype, inputs[0].shape));
+    return Status::OK();
+  };
+}
+
+ConverterFn ConvertBinary(const char* name) {
+  return [name](Converter* converter, const NodeDef& node_def,
+                const std::vector<Operand>& inputs,
+                std::vector<Operand>* outputs) {
+    BCast bcast(BCast::FromShape(inputs[0].shape),
+                BCast::FromShape(inputs[1].shape));
+    if (!bcast.IsValid()) {
+      return errors::InvalidArgument(
+          "Incompatible shapes: ", inputs[0].shape.DebugString(), " vs. ",
+          inputs[1].shape.DebugString());
+    }
+    const TensorShape shape = BCast::ToShape(bcast.output_shape());
+    outputs->push_back(converter->Add(
+        name, "{}",
+        {converter->Broadcast(inputs[0], shape),
+         converter->Broadcast(inputs[1], shape)},
+        inputs[0].dtype, shape));
+    return Status::OK();
+  };
+}
+
+Status ConvertIdentity(Converter* converter, const NodeDef& node_def,
+                       const std::vector<Operand>& inputs,
+                       std::vector<Operand>* outputs) {
+  outputs->push_back(inputs[0]);
+  return Status::OK();
+}
+
+Status ConvertConst(Converter* converter, const NodeDef& node_def,
+                    const std::vector<Operand>& inputs,
+                    std::vector<Operand>* outputs) {
+  const TensorProto* proto;
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "value", &proto));
+  Tensor tensor;
+  if (!tensor.FromProto(*proto)) {
+    return errors::InvalidArgument("Invalid value of ", node_def.name());
+  }
+  return converter->Literal(tensor, outputs);
+}
+
+Status ConvertRelu6(Converter* converter, const NodeDef& node_def,
+                    const std::vector<Operand>& inputs,
+                    std::vector<Operand>* outputs) {
+  const Operand& x = inputs[0];
+  TF_RETURN_IF_ERROR(converter->Scalar(6.0f, x.dtype, x.shape, outputs));
+  const Operand six = outputs->back();
+  outputs->back() = converter->Add(
+      "min", "{}", {converter->Add("relu", "{}", {x}, x.dtype, x.shape), six},
+      x.dtype, x.shape);
+  return Status::OK();
+}
+
+Status ConvertLeakyRelu(Converter* converter, const NodeDef& node_def,
+                        const std::vector<Operand>& inputs,
+                        std::vector<Operand>* outputs) {
+  float alpha;
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "alpha", &alpha));
+  outputs->push_back(converter->Add("leaky_relu",
+                                    StrCat("{alpha: ", alpha, "}"),
+                                    {inputs[0]}, inputs[0].dtype,
+                                    inputs[0].shape));
+  return Status::OK();
+}
+
+Status ConvertBiasAdd(Converter* converter, const NodeDef& node_def,
+                      const std::vector<Operand>& inputs,
+                      std::vector<Operand>* outputs) {
+  const Operand& value = inputs[0];
+  Operand bias = inputs[1];
+  string data_format;
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "data_format", &data_format));
+  if (data_format == "NCHW" && value.shape.dims() > 2) {
+    // Add trailing unit dimensions to the bias, so that it is broadcasted
+    // along the channel dimension.
+    TensorShape shape = bias.shape;
+    for (int i = 2; i < value.shape.dims(); ++i) shape.AddDim(1);
+    bias = converter->Add("reshape", ListAttr("dims", shape.dim_sizes()),
+                          {bias}, bias.dtype, shape);
+  }
+  return ConvertBinary("add")(converter, node_def, {value, bias}, outputs);
+}
+
+Status ConvertMatMul(Converter* converter, const NodeDef& node_def,
+                     const std::vector<Operand>& inputs,
+                     std::vector<Operand>* outputs) {
+  Operand a = inputs[0];
+  Operand b = inputs[1];
+  bool transpose_a, transpose_b;
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "transpose_a", &transpose_a));
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "transpose_b", &transpose_b));
+  auto transpose = [converter](const Operand& x) {
+    return converter->Add(
+        "transpose", ListAttr("permutation", {1, 0}), {x}, x.dtype,
+        TensorShape({x.shape.dim_size(1), x.shape.dim_size(0)}));
+  };
+  if (transpose_a) a = transpose(a);
+  if (transpose_b) b = transpose(b);
+  if (a.shape.dim_size(1) != b.shape.dim_size(0)) {
+    return errors::InvalidArgument(
+        "Matrix size-incompatible: In[0]: ", a.shape.DebugString(),
+        ", In[1]: ", b.shape.DebugString());
+  }
+  outputs->push_back(
+      converter->Add("dot", "{}", {a, b}, a.dtype,
+                     TensorShape({a.shape.dim_size(0), b.shape.dim_size(1)})));
+  return Status::OK();
+}
+
+Status ConvertSoftmax(Converter* converter, const NodeDef& node_def,
+                      const std::vector<Operand>& inputs,
+                      std::vector<Operand>* outputs) {
+  const Operand& logits = inputs[0];
+  outputs->push_back(converter->Add("softmax",
+                                    StrCat("{axis: ", logits.shape.dims() - 1,
+                                           "}"),
+                                    {logits}, logits.dtype, logits.shape));
+  return Status::OK();
+}
+
+// MIGraphX convolutions take NCHW inputs and OIHW filters, so NHWC Conv2Ds are
+// converted to a convolution between transposes, which MIGraphX fuses with
+// the neighbouring instructions when it can.
+Status ConvertConv2D(Converter* converter, const NodeDef& node_def,
+                     const std::vector<Operand>& inputs,
+                     std::vector<Operand>* outputs) {
+  const Operand& input = inputs[0];
+  const Operand& filter = inputs[1];
+  std::vector<int32> strides, dilations;
+  string padding_string;
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "strides", &strides));
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "dilations", &dilations));
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "padding", &padding_string));
+  Padding padding;
+  TF_RETURN_IF_ERROR(GetPaddingFromString(padding_string, &padding));
+  if (input.shape.dims() != 4 || filter.shape.dims() != 4) {
+    return errors::InvalidArgument("Conv2D inputs must be 4-dimensional");
+  }
+
+  std::vector<int64> output_size(2), padding_before(2), padding_after(2);
+  for (int i = 0; i < 2; ++i) {
+    TF_RETURN_IF_ERROR(GetWindowedOutputSizeVerboseV2(
+        input.shape.dim_size(i + 1), filter.shape.dim_size(i),
+        dilations[i + 1], strides[i + 1], padding, &output_size[i],
+        &padding_before[i], &padding_after[i]));
+  }
+  const int64 batch = input.shape.dim_size(0);
+  const int64 in_depth = input.shape.dim_size(3);
+  const int64 out_depth = filter.shape.dim_size(3);
+
+  const Operand nchw_input = converter->Add(
+      "transpose", ListAttr("permutation", {0, 3, 1, 2}), {input}, input.dtype,
+      TensorShape({batch, in_depth, input.shape.dim_size(1),
+                   input.shape.dim_size(2)}));
+  const Operand oihw_filter = converter->Add(
+      "transpose", ListAttr("permutation", {3, 2, 0, 1}), {filter},
+      filter.dtype,
+      TensorShape({out_depth, filter.shape.dim_size(2),
+                   filter.shape.dim_size(0), filter.shape.dim_size(1)}));
+  const string attributes = StrCat(
+      "{padding: [", padding_before[0], ", ", padding_before[1], ", ",
+      padding_after[0], ", ", padding_after[1], "], stride: [", strides[1],
+      ", ", strides[2], "], dilation: [", dilations[1], ", ", dilations[2],
+      "]}");
+  const Operand nchw_output = converter->Add(
+      "convolution", attributes, {nchw_input, oihw_filter}, input.dtype,
+      TensorShape({batch, out_depth, output_size[0], output_size[1]}));
+  outputs->push_back(converter->Add(
+      "transpose", ListAttr("permutation", {0, 2, 3, 1}), {nchw_output},
+      input.dtype,
+      TensorShape({batch, output_size[0], output_size[1], out_depth})));
+  return Status::OK();
+}
+
+const std::unordered_map<string, ConverterFn>& GetConverters() {
+  static const auto* converters = new std::unordered_map<string, ConverterFn>{
+      {"Abs", ConvertUnary("abs")},
+      {"Add", ConvertBinary("add")},
+      {"AddV2", ConvertBinary("add")},
+      {"BiasAdd", ConvertBiasAdd},
+      {"Ceil", ConvertUnary("ceil")},
+      {"Const", ConvertConst},
+      {"Conv2D", ConvertConv2D},
+      {"Erf", ConvertUnary("erf")},
+      {"Exp", ConvertUnary("exp")},
+      {"Floor", ConvertUnary("floor")},
+      {"Identity", ConvertIdentity},
+      {"LeakyRelu", ConvertLeakyRelu},
+      {"Log", ConvertUnary("log")},
+      {"MatMul", ConvertMatMul},
+      {"Maximum", ConvertBinary("max")},
+      {"Minimum", ConvertBinary("min")},
+      {"Mul", ConvertBinary("mul")},
+      {"Neg", ConvertUnary("neg")},
+      {"Pow", ConvertBinary("pow")},
+      {"RealDiv", ConvertBinary("div")},
+      {"Relu", ConvertUnary("relu")},
+      {"Relu6", ConvertRelu6},
+      {"Rsqrt", ConvertUnary("rsqrt")},
+      {"Sigmoid", ConvertUnary("sigmoid")},
+      {"Snapshot", ConvertIdentity},
+      {"Softmax", ConvertSoftmax},
+      {"Sqrt", ConvertUnary("sqrt")},
+      {"StopGradient", ConvertIdentity},
+      {"Sub", ConvertBinary("sub")},
+      {"Tanh", ConvertUnary("tanh")},
+  };
+  return *converters;
+}
+
+}  // namespace
+
+Status IsMIGraphXCandidate(const Node* node) {
+  if (GetConverters().count(node->type_string()) == 0) {
+    return errors::Unimplemented("Op type ", node->type_string(),
+                                 " is not supported");
+  }
+  DataType dtype;
+  const char* type_attr = node->IsConstant() ? "dtype" : "T";
+  TF_RETURN_IF_ERROR(GetNodeAttr(node->attrs(), type_attr, &dtype));
+  if (dtype != DT_FLOAT && dtype != DT_HALF) {
+    return errors::Unimplemented("Data type ", DataTypeString(dtype),
+                                 " is not supported");
+  }
+  if (node->type_string() == "Conv2D") {
+    string data_format, padding;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node->attrs(), "data_format", &data_format));
+    TF_RETURN_IF_ERROR(GetNodeAttr(node->attrs(), "padding", &padding));
+    if (data_format != "NHWC" || padding == "EXPLICIT") {
+      return errors::Unimplemented(
+          "Conv2D is only supported in NHWC format with SAME or VALID "
+          "padding");
+    }
+  }
+  return Status::OK();
+}
+
+Status ConvertGraphDefToProgram(const GraphDef& segment_graph_def,
+                                const std::vector<TensorShape>& input_shapes,
+                                ::migraphx::program* program,
+                                std::vector<TensorShape>* output_shapes) {
+  ::migraphx::module module = program->get_main_module();
+  Converter converter(&module);
+  // The outputs of the nodes converted so far.
+  std::unordered_map<string, std::vector<Operand>> node_outputs;
+  std::map<int, Operand> return_values;
+  // The nodes of the segment are sorted in topological order.
+  for (const NodeDef& node_def : segment_graph_def.node()) {
+    std::vector<Operand> inputs;
+    for (const string& input : node_def.input()) {
+      const TensorId tensor_id = ParseTensorName(input);
+      if (tensor_id.index() == Graph::kControlSlot) continue;
+      auto it = node_outputs.find(string(tensor_id.node()));
+      if (it == node_outputs.end() ||
+          tensor_id.index() >= it->second.size()) {
+        return errors::InvalidArgument("Input ", input, " of ",
+                                       node_def.name(), " is not converted");
+      }
+      inputs.push_back(it->second[tensor_id.index()]);
+    }
+
+    std::vector<Operand>& outputs = node_outputs[node_def.name()];
+    int index;
+    if (node_def.op() == "_Arg") {
+      DataType dtype;
+      TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "index", &index));
+      TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "T", &dtype));
+      if (index < 0 || index >= input_shapes.size()) {
+        return errors::InvalidArgument("Invalid index of ", node_def.name());
+      }
+      TF_RETURN_IF_ERROR(converter.Parameter(
+          StrCat("input_", index), dtype, input_shapes[index], &outputs));
+    } else if (node_def.op() == "_Retval") {
+      TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "index", &index));
+      return_values.emplace(index, inputs.at(0));
+    } else {
+      auto it = GetConverters().find(node_def.op());
+      if (it == GetConverters().end()) {
+        return errors::Unimplemented("Op type ", node_def.op(),
+                                     " is not supported");
+      }
+      Status status = it->second(&converter, node_def, inputs, &outputs);
+      if (!status.ok()) {
+        errors::AppendToMessage(&status, " while converting ",
+                                node_def.name());
+        return status;
+      }
+    }
+  }
+
+  std::vector<Operand> values;
+  output_shapes->clear();
+  for (const auto& return_value : return_values) {
+    if (return_value.first != values.size()) {
+      return errors::InvalidArgument("Missing output ", values.size());
+    }
+    values.push_back(return_value.second);
+    output_shapes->push_back(return_value.second.shape);
+  }
+  converter.Return(values);
+  VLOG(2) << "Converted segment to a MIGraphX program with "
+          << input_shapes.size() << " inputs and " << values.size()
+          << " outputs";
+  return Status::OK();
+}
+
+}  // namespace convert
+}  // namespace tf2migraphx
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
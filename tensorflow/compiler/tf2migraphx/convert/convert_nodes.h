@@ -0,0 +1,55 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_CONVERT_NODES_H_
+#define TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_CONVERT_NODES_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+#if TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+#include "migraphx/migraphx.hpp"
+
+namespace tensorflow {
+namespace tf2migraphx {
+namespace convert {
+
+// Returns OK if `node` can be converted to MIGraphX instructions, and thus be
+// put in the segment of a MIGraphXEngineOp. Otherwise returns the reason why
+// it can't.
+Status IsMIGraphXCandidate(const Node* node);
+
+// Converts the body of a MIGraphXEngineOp to a MIGraphX program for inputs of
+// the given shapes. The _Arg nodes of `segment_graph_def` become the
+// parameters "input_<index>" of the program and its _Retval nodes the values
+// returned by the program. On success, `output_shapes` holds the shapes of
+// the returned values.
+Status ConvertGraphDefToProgram(const GraphDef& segment_graph_def,
+                                const std::vector<TensorShape>& input_shapes,
+                                ::migraphx::program* program,
+                                std::vector<TensorShape>* output_shapes);
+
+}  // namespace convert
+}  // namespace tf2migraphx
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+#endif  // TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_CONVERT_NODES_H_
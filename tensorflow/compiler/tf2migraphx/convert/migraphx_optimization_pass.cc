@@ -0,0 +1,105 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2migraphx/convert/migraphx_optimization_pass.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/tf2migraphx/convert/convert_graph.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+
+#if TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+namespace tensorflow {
+namespace tf2migraphx {
+namespace convert {
+
+Status MIGraphXOptimizationPass::Init(
+    const RewriterConfig_CustomGraphOptimizer* config) {
+  if (config == nullptr) {
+    return Status::OK();
+  }
+  const auto params = config->parameter_map();
+  if (params.count("minimum_segment_size")) {
+    minimum_segment_size_ = params.at("minimum_segment_size").i();
+  }
+  if (params.count("maximum_cached_engines")) {
+    max_cached_engines_ = params.at("maximum_cached_engines").i();
+  }
+  if (params.count("precision_mode")) {
+    precision_mode_ = absl::AsciiStrToUpper(params.at("precision_mode").s());
+    if (precision_mode_ != "FP32" && precision_mode_ != "FP16") {
+      return errors::InvalidArgument("Invalid precision mode for MIGraphX: ",
+                                     precision_mode_);
+    }
+  }
+  return Status::OK();
+}
+
+Status MIGraphXOptimizationPass::Optimize(grappler::Cluster* cluster,
+                                          const grappler::GrapplerItem& item,
+                                          GraphDef* optimized_graph) {
+  // MetaOptimizer also runs the custom passes on the functions of the graph,
+  // which include the native segments created by this pass.
+  if (item.id != "tf_graph") {
+    VLOG(1) << "Skipping " << name_ << " on grappler item " << item.id
+            << ", which is probably a function";
+    *optimized_graph = item.graph;
+    return Status::OK();
+  }
+
+  // Strip the output ports of the nodes to preserve, keeping the colons that
+  // are part of the node names.
+  std::vector<string> nodes_to_preserve;
+  for (const auto& n : item.NodesToPreserve()) {
+    auto tokens = str_util::Split(n, ":");
+    string s = tokens.at(0);
+    for (int i = 1; i < tokens.size() - 1; ++i) {
+      absl::StrAppend(&s, ":", tokens.at(i));
+    }
+    int port = -1;
+    if (tokens.size() > 1 &&
+        !strings::safe_strto32(tokens.back(), &port)) {  // non-absl ok
+      absl::StrAppend(&s, ":", tokens.back());
+    }
+    nodes_to_preserve.push_back(s);
+  }
+
+  ConversionParams params;
+  params.grappler_item = &item;
+  params.output_names = &nodes_to_preserve;
+  params.output_graph_def = optimized_graph;
+  params.minimum_segment_size = minimum_segment_size_;
+  params.max_cached_engines = max_cached_engines_;
+  params.precision_mode = precision_mode_;
+  return ConvertGraph(params);
+}
+
+class MIGraphXOptimizer : public MIGraphXOptimizationPass {
+ public:
+  MIGraphXOptimizer() : MIGraphXOptimizationPass("MIGraphXOptimizer") {}
+};
+
+REGISTER_GRAPH_OPTIMIZER(MIGraphXOptimizer);
+
+}  // namespace convert
+}  // namespace tf2migraphx
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
@@ -0,0 +1,71 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_MIGRAPHX_OPTIMIZATION_PASS_H_
+#define TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_MIGRAPHX_OPTIMIZATION_PASS_H_
+
+#include <string>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+#include "tensorflow/core/platform/logging.h"
+
+#if TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+namespace tensorflow {
+namespace tf2migraphx {
+namespace convert {
+
+// Grappler pass that replaces the segments of the graph that MIGraphX can run
+// by MIGraphXEngineOps. It is the ROCm counterpart of the TensorRTOptimizer
+// pass, and is enabled as the custom optimizer "MIGraphXOptimizer", which
+// accepts the parameters "minimum_segment_size", "maximum_cached_engines" and
+// "precision_mode".
+class MIGraphXOptimizationPass : public grappler::CustomGraphOptimizer {
+ public:
+  MIGraphXOptimizationPass(const string& name = "MIGraphXOptimizationPass")
+      : name_(name),
+        minimum_segment_size_(3),
+        max_cached_engines_(1),
+        precision_mode_("FP32") {}
+
+  string name() const override { return name_; };
+
+  bool UsesFunctionLibrary() const override { return true; }
+
+  Status Init(
+      const RewriterConfig_CustomGraphOptimizer* config = nullptr) override;
+
+  Status Optimize(grappler::Cluster* cluster,
+                  const grappler::GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(grappler::Cluster* cluster, const grappler::GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override {}
+
+ private:
+  const string name_;
+  int minimum_segment_size_;
+  int max_cached_engines_;
+  string precision_mode_;
+};
+
+}  // namespace convert
+}  // namespace tf2migraphx
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+#endif  // TENSORFLOW_COMPILER_TF2MIGRAPHX_CONVERT_MIGRAPHX_OPTIMIZATION_PASS_H_
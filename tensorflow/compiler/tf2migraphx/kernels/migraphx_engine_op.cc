@@ -0,0 +1,322 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2migraphx/convert/convert_nodes.h"
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+#if TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
+
+#include "migraphx/migraphx.hpp"
+#include "rocm/include/hip/hip_runtime.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+
+namespace tensorflow {
+namespace tf2migraphx {
+
+using FunctionHandle = FunctionLibraryRuntime::Handle;
+
+// Runs a segment of the graph that was converted by the MIGraphX optimization
+// pass. MIGraphX programs are compiled for static shapes, so the op compiles
+// one program per set of input shapes it sees, the first time it sees it, and
+// keeps the `max_cached_engines_count` most recently used ones. Segments that
+// can't be compiled for some shapes are run natively, as TensorFlow functions.
+class MIGraphXEngineOp : public AsyncOpKernel {
+ public:
+  explicit MIGraphXEngineOp(OpKernelConstruction* context);
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override;
+
+ private:
+  struct Engine {
+    // Null if the program couldn't be built, in which case the native segment
+    // is run for these shapes.
+    std::unique_ptr<::migraphx::program> program;
+    std::vector<TensorShape> output_shapes;
+    int64 last_use = 0;
+    // A compiled program can only run one request at a time.
+    mutex run_mu;
+  };
+
+  // Instantiates the segment function and gets its body, sorted in
+  // topological order, for the conversion to MIGraphX.
+  Status ImportSegmentGraphDef(FunctionLibraryRuntime* lib,
+                               const string& device_name);
+
+  // Returns the engine for the input shapes, building it if it is not cached.
+  std::shared_ptr<Engine> GetEngine(
+      OpKernelContext* ctx, const std::vector<TensorShape>& input_shapes);
+
+  // Converts the segment and compiles it for the GPU of the op.
+  Status BuildEngine(OpKernelContext* ctx,
+                     const std::vector<TensorShape>& input_shapes,
+                     Engine* engine);
+
+  // Runs the program of `engine` on the stream of the op. The outputs are
+  // produced directly in the output tensors of the op.
+  Status ExecuteEngine(OpKernelContext* ctx, Engine* engine);
+
+  // Runs the segment as a TensorFlow function.
+  void ExecuteNativeSegment(OpKernelContext* ctx, DoneCallback done);
+
+  NameAttrList func_;
+  FunctionHandle func_handle_;
+  GraphDef segment_graph_def_;
+  int max_cached_engines_;
+  bool use_fp16_;
+
+  mutex mu_;
+  // Engines by the string of their input shapes.
+  std::map<string, std::shared_ptr<Engine>> engines_ TF_GUARDED_BY(mu_);
+  int64 use_count_ TF_GUARDED_BY(mu_) = 0;
+};
+
+MIGraphXEngineOp::MIGraphXEngineOp(OpKernelConstruction* context)
+    : AsyncOpKernel(context) {
+  OP_REQUIRES_OK(context, context->GetAttr("segment_func", &func_));
+  OP_REQUIRES_OK(context, context->GetAttr("max_cached_engines_count",
+                                           &max_cached_engines_));
+  OP_REQUIRES(context, max_cached_engines_ > 0,
+              errors::InvalidArgument(
+                  "max_cached_engines_count must be positive, got ",
+                  max_cached_engines_));
+  string precision_mode;
+  OP_REQUIRES_OK(context, context->GetAttr("precision_mode", &precision_mode));
+  use_fp16_ = precision_mode == "FP16";
+  OP_REQUIRES_OK(context, ImportSegmentGraphDef(context->function_library(),
+                                                context->device()->name()));
+}
+
+Status MIGraphXEngineOp::ImportSegmentGraphDef(FunctionLibraryRuntime* lib,
+                                               const string& device_name) {
+  if (lib == nullptr) {
+    return errors::Internal("Context function library is null");
+  }
+  FunctionLibraryRuntime::InstantiateOptions inst_ops;
+  inst_ops.target = device_name;
+  TF_RETURN_IF_ERROR(lib->Instantiate(func_.name(), AttrSlice(&func_.attr()),
+                                      inst_ops, &func_handle_));
+  const FunctionBody* fbody = lib->GetFunctionBody(func_handle_);
+  if (fbody == nullptr) {
+    return errors::Internal("Missing body of function ", func_.name());
+  }
+  std::vector<Node*> order;
+  GetReversePostOrder(*fbody->graph, &order);
+  for (const Node* node : order) {
+    if (node->IsOp()) *segment_graph_def_.add_node() = node->def();
+  }
+  return Status::OK();
+}
+
+void MIGraphXEngineOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
+  profiler::TraceMe activity("MIGraphXEngineOp::ComputeAsync",
+                             profiler::TraceMeLevel::kInfo);
+  std::vector<TensorShape> input_shapes;
+  input_shapes.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    input_shapes.push_back(ctx->input(i).shape());
+  }
+  std::shared_ptr<Engine> engine = GetEngine(ctx, input_shapes);
+  if (engine->program == nullptr) {
+    ExecuteNativeSegment(ctx, std::move(done));
+    return;
+  }
+  Status status = ExecuteEngine(ctx, engine.get());
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to run MIGraphX program of " << name()
+                 << ", running the native segment instead: " << status;
+    ExecuteNativeSegment(ctx, std::move(done));
+    return;
+  }
+  done();
+}
+
+std::shared_ptr<MIGraphXEngineOp::Engine> MIGraphXEngineOp::GetEngine(
+    OpKernelContext* ctx, const std::vector<TensorShape>& input_shapes) {
+  const string key = TensorShapeUtils::ShapeListString(input_shapes);
+  mutex_lock l(mu_);
+  auto it = engines_.find(key);
+  if (it != engines_.end()) {
+    it->second->last_use = ++use_count_;
+    return it->second;
+  }
+
+  // Failed builds are cached too, so that they are not retried on every run.
+  auto engine = std::make_shared<Engine>();
+  Status status = BuildEngine(ctx, input_shapes, engine.get());
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to build MIGraphX program of " << name()
+                 << " for input shapes " << key
+                 << ", running the native segment instead: " << status;
+  }
+  if (engines_.size() >= static_cast<size_t>(max_cached_engines_)) {
+    auto lru = engines_.begin();
+    for (auto e = engines_.begin(); e != engines_.end(); ++e) {
+      if (e->second->last_use < lru->second->last_use) lru = e;
+    }
+    VLOG(1) << "Evicting MIGraphX program of " << name() << " for input shapes "
+            << lru->first;
+    engines_.erase(lru);
+  }
+  engine->last_use = ++use_count_;
+  engines_.emplace(key, engine);
+  return engine;
+}
+
+Status MIGraphXEngineOp::BuildEngine(
+    OpKernelContext* ctx, const std::vector<TensorShape>& input_shapes,
+    Engine* engine) {
+  profiler::TraceMe activity("MIGraphXEngineOp::BuildEngine",
+                             profiler::TraceMeLevel::kInfo);
+  VLOG(1) << "Building MIGraphX program of " << name() << " for input shapes "
+          << TensorShapeUtils::ShapeListString(input_shapes);
+  // MIGraphX compiles for the current device of the thread.
+  const int gpu_id = ctx->device()->tensorflow_gpu_device_info()->gpu_id;
+  if (hipSetDevice(gpu_id) != hipSuccess) {
+    return errors::Internal("Failed to set the current device to ", gpu_id);
+  }
+  auto program = absl::make_unique<::migraphx::program>();
+  std::vector<TensorShape> output_shapes;
+  // The MIGraphX API reports errors with exceptions.
+  try {
+    TF_RETURN_IF_ERROR(convert::ConvertGraphDefToProgram(
+        segment_graph_def_, input_shapes, program.get(), &output_shapes));
+    if (use_fp16_) ::migraphx::quantize_fp16(*program);
+    ::migraphx::compile_options options;
+    // The inputs and outputs of the program are the device buffers of the
+    // tensors of the op, so MIGraphX must not copy them to or from the host.
+    options.set_offload_copy(false);
+    program->compile(::migraphx::target("gpu"), options);
+  } catch (const std::exception& e) {
+    return errors::Internal("MIGraphX error: ", e.what());
+  }
+  engine->program = std::move(program);
+  engine->output_shapes = std::move(output_shapes);
+  return Status::OK();
+}
+
+Status MIGraphXEngineOp::ExecuteEngine(OpKernelContext* ctx, Engine* engine) {
+  profiler::TraceMe activity("MIGraphXEngineOp::ExecuteEngine",
+                             profiler::TraceMeLevel::kInfo);
+  se::Stream* stream = ctx->op_device_context()->stream();
+  const int gpu_id = ctx->device()->tensorflow_gpu_device_info()->gpu_id;
+  if (hipSetDevice(gpu_id) != hipSuccess) {
+    return errors::Internal("Failed to set the current device to ", gpu_id);
+  }
+  mutex_lock l(engine->run_mu);
+  try {
+    ::migraphx::program_parameter_shapes shapes =
+        engine->program->get_parameter_shapes();
+    ::migraphx::program_parameters parameters;
+    std::vector<bool> allocated(ctx->num_outputs(), false);
+    for (const char* name : shapes.names()) {
+      absl::string_view suffix(name);
+      int index;
+      void* buffer;
+      if (absl::ConsumePrefix(&suffix, "input_") &&
+          absl::SimpleAtoi(suffix, &index) && index < ctx->num_inputs()) {
+        buffer = const_cast<char*>(ctx->input(index).tensor_data().data());
+      } else if (absl::ConsumePrefix(&suffix, "main:#output_") &&
+                 absl::SimpleAtoi(suffix, &index) &&
+                 index < ctx->num_outputs()) {
+        // The compiled program writes its results to these parameters.
+        Tensor* output;
+        TF_RETURN_IF_ERROR(ctx->allocate_output(
+            index, engine->output_shapes[index], &output));
+        buffer = const_cast<char*>(output->tensor_data().data());
+        allocated[index] = true;
+      } else {
+        return errors::Internal("Unexpected MIGraphX program parameter ",
+                                name);
+      }
+      parameters.add(name, ::migraphx::argument(shapes[name], buffer));
+    }
+    ::migraphx::arguments results = engine->program->run_async(
+        parameters, se::gpu::AsGpuStreamValue(stream));
+
+    // Results that are not computed by the program, e.g. inputs returned
+    // as-is, have no output parameter and are copied to the outputs.
+    for (int i = 0; i < ctx->num_outputs(); ++i) {
+      if (allocated[i]) continue;
+      Tensor* output;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output(i, engine->output_shapes[i], &output));
+      const uint64 size = output->TotalBytes();
+      if (size == 0) continue;
+      se::DeviceMemoryBase src(results[i].data(), size);
+      se::DeviceMemoryBase dst(const_cast<char*>(output->tensor_data().data()),
+                               size);
+      stream->ThenMemcpy(&dst, src, size);
+    }
+  } catch (const std::exception& e) {
+    return errors::Internal("MIGraphX error: ", e.what());
+  }
+  return Status::OK();
+}
+
+void MIGraphXEngineOp::ExecuteNativeSegment(OpKernelContext* ctx,
+                                            DoneCallback done) {
+  profiler::TraceMe activity("MIGraphXEngineOp::ExecuteNativeSegment",
+                             profiler::TraceMeLevel::kInfo);
+  FunctionLibraryRuntime* lib = ctx->function_library();
+  FunctionLibraryRuntime::Options opts;
+  opts.rendezvous = ctx->rendezvous();
+  opts.cancellation_manager = ctx->cancellation_manager();
+  opts.runner = ctx->runner();
+  std::vector<Tensor> inputs;
+  inputs.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    inputs.push_back(ctx->input(i));
+  }
+  auto* outputs = new std::vector<Tensor>();
+  VLOG(1) << "Executing native segment: " << name();
+  lib->Run(opts, func_handle_, inputs, outputs,
+           [ctx, outputs, done = std::move(done)](const Status& s) {
+             std::unique_ptr<std::vector<Tensor>> outputs_wrapper(outputs);
+             OP_REQUIRES_OK_ASYNC(ctx, s, done);
+             for (size_t i = 0; i < outputs->size(); ++i) {
+               ctx->set_output(i, outputs->at(i));
+             }
+             done();
+           });
+}
+
+REGISTER_KERNEL_BUILDER(Name("MIGraphXEngineOp").Device(DEVICE_GPU),
+                        MIGraphXEngineOp);
+
+}  // namespace tf2migraphx
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_ROCM && TENSORFLOW_USE_MIGRAPHX
@@ -0,0 +1,16 @@
+"""Build macros for the MIGraphX integration."""
+
+def if_migraphx(if_true, if_false = []):
+    """Shorthand for select()'ing on whether we're building with MIGraphX.
+
+    MIGraphX is opt-in on top of ROCm builds, with
+    --define=using_migraphx=true, since it is not part of every ROCm
+    installation.
+    """
+    return select({
+        "//tensorflow/compiler/tf2migraphx:using_migraphx": if_true,
+        "//conditions:default": if_false,
+    })
+
+def migraphx_copts():
+    return if_migraphx(["-DTENSORFLOW_USE_MIGRAPHX=1"])
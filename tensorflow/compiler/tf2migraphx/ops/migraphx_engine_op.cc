@@ -0,0 +1,37 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/shape_inference.h"
+
+namespace tensorflow {
+
+// NOTE: when making changes please follow
+// https://www.tensorflow.org/guide/extend/op#backwards_compatibility to not
+// break backward compatibility.
+REGISTER_OP("MIGraphXEngineOp")
+    .Attr("segment_func: func")
+    .Attr("InT: list({float16,float32})")
+    .Attr("OutT: list({float16,float32})")
+    .Attr("max_cached_engines_count: int = 1")
+    .Attr("precision_mode: {'FP32', 'FP16'} = 'FP32'")
+    .Input("in_tensor: InT")
+    .Output("out_tensor: OutT")
+    // The output shapes are only known once the segment is converted for the
+    // concrete input shapes.
+    .SetShapeFn(shape_inference::UnknownShape);
+
+}  // namespace tensorflow
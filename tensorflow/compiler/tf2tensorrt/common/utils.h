@@ -30,16 +30,21 @@ std::tuple<int, int, int> GetLoadedTensorRTVersion();
 }  // namespace tensorrt
 }  // namespace tensorflow
 
-#if GOOGLE_CUDA && GOOGLE_TENSORRT
+#if (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
 
 #include "tensorflow/core/platform/logging.h"
+
+#define LOG_WARNING_WITH_PREFIX LOG(WARNING) << "TF-TRT Warning: "
+
+#endif  // (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
+
+#if GOOGLE_CUDA && GOOGLE_TENSORRT
+
 #include "third_party/tensorrt/NvInfer.h"
 
 namespace tensorflow {
 namespace tensorrt {
 
-#define LOG_WARNING_WITH_PREFIX LOG(WARNING) << "TF-TRT Warning: "
-
 // Initializes the TensorRT plugin registry if this hasn't been done yet.
 void MaybeInitializeTrtPlugins(nvinfer1::ILogger* trt_logger);
 
@@ -20,9 +20,12 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 #include "third_party/tensorrt/NvInfer.h"
@@ -127,6 +130,8 @@ bool AreShapesCompatible(const std::vector<TensorShape>& actual_shapes,
 // of profiles times the number of engine inputs.
 int GetNumberOfEngineInputs(const nvinfer1::ICudaEngine* engine);
 
+#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
+
 // Returns the string representation for the assigned device or the requested
 // device of the given node.
 absl::string_view GetDeviceName(const Node* node);
@@ -146,8 +151,6 @@ absl::optional<DeviceNameUtils::ParsedName> MergeIfCompatible(
 absl::optional<DeviceNameUtils::ParsedName> MergeIfCompatible(
     const DeviceNameUtils::ParsedName& a, absl::string_view b);
 
-#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
-
 }  // namespace tensorrt
 }  // namespace tensorflow
 
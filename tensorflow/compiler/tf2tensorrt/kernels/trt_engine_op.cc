@@ -19,11 +19,13 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/convert_nodes.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
@@ -38,8 +40,12 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -144,6 +150,27 @@ class TRTEngineOp : public AsyncOpKernel {
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource);
 
+  // Returns the path of the file that caches the engine for the input shapes
+  // in the engine cache directory, or an empty string if engines of this op
+  // are not cached on disk. The file name is a fingerprint of everything the
+  // engine depends on, so that engines of other segments, shapes, TensorRT
+  // versions or GPUs are never loaded.
+  string GetEngineCacheFile(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      bool use_calibration, TRTEngineCacheResource* cache_resource);
+
+  // Loads the engine for the input shapes from `filename`. Returns nullptr if
+  // the file doesn't exist or can't be deserialized.
+  TrtUniquePtrType<nvinfer1::ICudaEngine> LoadEngineFromFile(
+      const string& filename,
+      const std::vector<TensorShape>& input_concrete_shapes,
+      TRTEngineCacheResource* cache_resource);
+
+  // Writes the engine for the input shapes to `filename`.
+  Status SaveEngineToFile(const string& filename,
+                          const std::vector<TensorShape>& input_concrete_shapes,
+                          nvinfer1::ICudaEngine* engine);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -159,6 +186,14 @@ class TRTEngineOp : public AsyncOpKernel {
   // GraphDef representation of the segment.
   GraphDef segment_graph_def_;
 
+  // Fingerprint of segment_graph_def_ and of the calibration data, which
+  // identifies the segment across replicas and processes. It is zero until
+  // segment_graph_def_ is imported.
+  uint64 segment_fingerprint_ = 0;
+
+  // Fingerprint of the calibration_data attribute.
+  uint64 calibration_data_fingerprint_ = 0;
+
   // Engine Precision mode.
   TrtPrecisionMode precision_mode_;
 
@@ -317,7 +352,16 @@ Status TRTEngineOp::ImportSegmentGraphDef(FunctionLibraryRuntime* lib,
                                           const string& device_name) {
   TF_ASSIGN_OR_RETURN(FunctionLibraryRuntime::Handle func_handle,
                       ConstructFunctionHandle(lib, device_name));
-  return FunctionDefToGraphDef(func_handle, lib, &segment_graph_def_);
+  TF_RETURN_IF_ERROR(
+      FunctionDefToGraphDef(func_handle, lib, &segment_graph_def_));
+  string serialized_graph_def;
+  if (!SerializeToStringDeterministic(segment_graph_def_,
+                                      &serialized_graph_def)) {
+    return errors::Internal("Failed to serialize the segment of ", name());
+  }
+  segment_fingerprint_ = FingerprintCat64(Fingerprint64(serialized_graph_def),
+                                          calibration_data_fingerprint_);
+  return Status::OK();
 }
 
 TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
@@ -364,6 +408,8 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
     OP_REQUIRES_OK(context, status);
   }
 
+  calibration_data_fingerprint_ = Fingerprint64(calibration_data);
+
   native_execution_func_handle_ = kInvalidHandle;
   if (!static_engine_) {
     OP_REQUIRES_OK(context, ImportSegmentGraphDef(context->function_library(),
@@ -507,12 +553,12 @@ void TRTEngineOp::ExecuteCalibration(OpKernelContext* ctx,
                                                 ->GpuStreamMemberHack()));
   // If calibrator is terminated before, it means an error has occurred.
   //
-  // Note: setBatch() will wait until TRTInt8Calibrator::getBatch() is called
-  // the first time before proceeding, so if buildCudaEngine() returns an error,
-  // it means getBatch() is never called, and the setBatch() here will hang
-  // until setDone() is called later by the calibration thread in
-  // AllocateCalibrationResources(). In that case, this setBatch() will always
-  // be able to detect the error and return false.
+  // Note: setBatch() only enqueues the copy of the batch on the stream, and
+  // waits while all the staging buffers hold batches that TRT hasn't consumed.
+  // If buildCudaEngine() returns an error, getBatch() is never called, and the
+  // setBatch() here waits until setDone() is called later by the calibration
+  // thread in AllocateCalibrationResources(). In that case, this setBatch()
+  // will always be able to detect the error and return false.
   OP_REQUIRES_ASYNC(ctx, calib_ctx->calibrator_->setBatch(input_data, *stream),
                     errors::Internal("Failed to feed calibration data"),
                     *helper);
@@ -588,6 +634,35 @@ Status TRTEngineOp::VerifyInputShapes(
   return Status::OK();
 }
 
+// Returns the directory where built engines are cached across processes, read
+// from the TF_TRT_ENGINE_CACHE_DIR environment variable. Engines are not
+// cached on disk if it is empty.
+static const string& GetEngineCacheDir() {
+  static const string* dir = [] {
+    string value;
+    Status status = ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR",
+                                         /*default_value=*/"", &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return new string(value);
+  }();
+  return *dir;
+}
+
+// Returns a string that identifies the model of the current GPU, since
+// TensorRT engines can only be deserialized on GPUs of the model they were
+// built for.
+static string GetCurrentGpuModel() {
+  int device;
+  cudaDeviceProp prop;
+  if (cudaGetDevice(&device) != cudaSuccess ||
+      cudaGetDeviceProperties(&prop, device) != cudaSuccess) {
+    return "";
+  }
+  return StrCat(prop.name, ";", prop.major, ".", prop.minor);
+}
+
 static bool AllowEngineNativeSegmentExecution() {
   bool value;
   Status status =
@@ -677,7 +752,14 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
       return;
     } else if (cache_res->profiles_.GetNumProfiles() == 0) {
       // Create profiles out of collected shapes during profile generation.
-      cache_res->profiles_.InitProfiles();
+      // The replicas of the op on other devices share the profiles, so that
+      // their engines are built for the same profiles.
+      if (segment_fingerprint_ != 0) {
+        cache_res->profiles_.InitSharedProfiles(
+            absl::StrCat(absl::Hex(segment_fingerprint_, absl::kZeroPad16)));
+      } else {
+        cache_res->profiles_.InitProfiles();
+      }
     }
   }
   StatusOr<std::pair<EngineContext*, int>> status =
@@ -807,6 +889,104 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
       }});
 }
 
+string TRTEngineOp::GetEngineCacheFile(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    bool use_calibration, TRTEngineCacheResource* cache_resource) {
+  const string& cache_dir = GetEngineCacheDir();
+  if (cache_dir.empty() || segment_fingerprint_ == 0) return "";
+  const string gpu_model = GetCurrentGpuModel();
+  if (gpu_model.empty()) return "";
+  // Implicit batch engines are built for the input shapes, and explicit batch
+  // engines for the input partial shapes and the optimization profiles.
+  const string key = StrCat(
+      segment_fingerprint_, ";", static_cast<int>(precision_mode_), ";",
+      use_calibration, ";", use_implicit_batch_, ";", workspace_size_, ";",
+      TensorShapeUtils::ShapeListString(input_concrete_shapes), ";",
+      PartialTensorShapeUtils::PartialShapeListString(input_partial_shapes_),
+      ";", cache_resource->profiles_.ProfilesDebugString(), ";",
+      absl::StrJoin(GetLoadedTensorRTVersion(), "."), ";", gpu_model);
+  return io::JoinPath(
+      cache_dir,
+      StrCat("trt_engine_", absl::Hex(Fingerprint64(key), absl::kZeroPad16)));
+}
+
+TrtUniquePtrType<nvinfer1::ICudaEngine> TRTEngineOp::LoadEngineFromFile(
+    const string& filename,
+    const std::vector<TensorShape>& input_concrete_shapes,
+    TRTEngineCacheResource* cache_resource) {
+  Env* env = Env::Default();
+  if (!env->FileExists(filename).ok()) return nullptr;
+  string contents;
+  TRTEngineInstance engine_instance;
+  Status status = ReadFileToString(env, filename, &contents);
+  if (status.ok() && !engine_instance.ParseFromString(contents)) {
+    status = errors::DataLoss("Failed to parse ", filename);
+  }
+  if (status.ok() &&
+      engine_instance.input_shapes_size() != input_concrete_shapes.size()) {
+    status = errors::DataLoss("Wrong number of input shapes in ", filename);
+  }
+  if (!status.ok()) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Not loading cached engine for "
+                                      << name() << ": " << status;
+    return nullptr;
+  }
+  for (int i = 0; i < input_concrete_shapes.size(); ++i) {
+    if (TensorShape(engine_instance.input_shapes(i)) !=
+        input_concrete_shapes[i]) {
+      return nullptr;
+    }
+  }
+
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(cache_resource->allocator_.get());
+  // Need to initialize plugins in order to deserialize engines that contain
+  // plugins.
+  MaybeInitializeTrtPlugins(&logger);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(infer->deserializeCudaEngine(
+      engine_instance.serialized_engine().c_str(),
+      engine_instance.serialized_engine().size(), nullptr));
+  if (engine) {
+    VLOG(1) << "Loaded TensorRT engine for " << name() << " from "
+            << filename;
+  }
+  return engine;
+}
+
+Status TRTEngineOp::SaveEngineToFile(
+    const string& filename,
+    const std::vector<TensorShape>& input_concrete_shapes,
+    nvinfer1::ICudaEngine* engine) {
+  TRTEngineInstance engine_instance;
+  for (const TensorShape& shape : input_concrete_shapes) {
+    shape.AsProto(engine_instance.add_input_shapes());
+  }
+  TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(engine->serialize());
+  if (!engine_data) {
+    return errors::Internal("Failed to serialize the engine of ", name());
+  }
+  engine_instance.set_serialized_engine(engine_data->data(),
+                                        engine_data->size());
+  // Write to a file of a unique name and rename it, so that other processes
+  // sharing the directory never read a partially written engine.
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(io::Dirname(filename)));
+  string tmp_filename = filename;
+  if (!env->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file for ",
+                            filename);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename,
+                                       engine_instance.SerializeAsString()));
+  Status status = env->RenameFile(tmp_filename, filename);
+  if (!status.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Saved TensorRT engine for " << name() << " to " << filename;
+  return Status::OK();
+}
+
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
@@ -822,6 +1002,15 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
           ? std::vector<PartialTensorShape>(input_concrete_shapes.begin(),
                                             input_concrete_shapes.end())
           : input_partial_shapes_;
+  const string cache_file = GetEngineCacheFile(
+      input_concrete_shapes, use_calibration && calibrator != nullptr,
+      cache_resource);
+  if (!cache_file.empty()) {
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine = LoadEngineFromFile(
+        cache_file, input_concrete_shapes, cache_resource);
+    if (engine) return engine;
+  }
+
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
   auto status = convert::ConvertGraphDefToEngine(
       segment_graph_def_, precision_mode_, batch_size, workspace_size_,
@@ -839,6 +1028,13 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
                                    absl::make_unique<EngineContext>());
     return status;
   }
+  if (!cache_file.empty()) {
+    status = SaveEngineToFile(cache_file, input_concrete_shapes, engine.get());
+    if (!status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Failed to cache the engine for "
+                                        << name() << ": " << status;
+    }
+  }
   return engine;
 }
 
@@ -999,24 +1195,32 @@ Status TRTEngineOp::AllocateCalibrationResources(
   const int batch_size = ctx->input(0).dim_size(0);
   const int num_inputs = ctx->num_inputs();
   std::vector<TensorShape> shapes;
-  cres->device_tensors_.resize(num_inputs);
-  VLOG(1) << "Constructing calibrator";
   for (int i = 0; i < num_inputs; i++) {
-    // allocate workspace on device for inputs
-    const Tensor& t = ctx->input(i);
-    shapes.emplace_back(t.shape());
-    Tensor* device_tensor;
-    TF_RETURN_IF_ERROR(ctx->allocate_persistent(
-        t.dtype(), t.shape(), &cres->device_tensors_.at(i), &device_tensor));
-    CHECK_EQ(t.TotalBytes(), device_tensor->TotalBytes());
-    void* device_address = GetTensorAddress(device_tensor);
-    if (device_address == nullptr) {
-      return errors::InvalidArgument(
-          "Unsupported data type encountered in input ", i);
+    shapes.emplace_back(ctx->input(i).shape());
+  }
+  const int num_buffers = CalibrationContext::kNumStagingBuffers;
+  cres->device_tensors_.resize(num_buffers * num_inputs);
+  cres->device_buffers_.resize(num_buffers);
+  VLOG(1) << "Constructing calibrator";
+  for (int b = 0; b < num_buffers; b++) {
+    for (int i = 0; i < num_inputs; i++) {
+      // allocate workspace on device for inputs
+      const Tensor& t = ctx->input(i);
+      Tensor* device_tensor;
+      TF_RETURN_IF_ERROR(ctx->allocate_persistent(
+          t.dtype(), t.shape(), &cres->device_tensors_.at(b * num_inputs + i),
+          &device_tensor));
+      CHECK_EQ(t.TotalBytes(), device_tensor->TotalBytes());
+      void* device_address = GetTensorAddress(device_tensor);
+      if (device_address == nullptr) {
+        return errors::InvalidArgument(
+            "Unsupported data type encountered in input ", i);
+      }
+      cres->device_buffers_[b].emplace(
+          StrCat(IONamePrefixes::kInputPHName, i),
+          std::pair<void*, size_t>(device_address,
+                                   device_tensor->TotalBytes()));
     }
-    cres->device_buffers_.emplace(
-        StrCat(IONamePrefixes::kInputPHName, i),
-        std::pair<void*, size_t>(device_address, device_tensor->TotalBytes()));
   }
   cres->calibrator_.reset(
       new TRTInt8Calibrator(cres->device_buffers_, batch_size, name()));
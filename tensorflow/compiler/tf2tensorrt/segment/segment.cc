@@ -35,7 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/env_var.h"
 
-#if GOOGLE_CUDA && GOOGLE_TENSORRT
+#if (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
 
 namespace tensorflow {
 namespace tensorrt {
@@ -1057,4 +1057,4 @@ Status SegmentGraph(const Graph* tf_graph,
 }  // namespace tensorrt
 }  // namespace tensorflow
 
-#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
+#endif  // (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
@@ -27,7 +27,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
 
-#if GOOGLE_CUDA && GOOGLE_TENSORRT
+// The segmenter is also used by the MIGraphX integration of ROCm builds, see
+// tensorflow/compiler/tf2migraphx.
+#if (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
 
 namespace tensorflow {
 namespace tensorrt {
@@ -89,6 +91,6 @@ Status SegmentGraph(const Graph* tf_graph,
 }  // namespace tensorrt
 }  // namespace tensorflow
 
-#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
+#endif  // (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
 
 #endif  // TENSORFLOW_COMPILER_TF2TENSORRT_SEGMENT_SEGMENT_H_
@@ -18,7 +18,7 @@ limitations under the License.
 #include "absl/strings/str_format.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 
-#if GOOGLE_CUDA && GOOGLE_TENSORRT
+#if (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
 
 namespace tensorflow {
 namespace tensorrt {
@@ -151,4 +151,4 @@ Status ClusterProperty::Merge(const ClusterProperty& other) {
 }  // namespace tensorrt
 }  // namespace tensorflow
 
-#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
+#endif  // (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
@@ -20,7 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/util/device_name_utils.h"
 
-#if GOOGLE_CUDA && GOOGLE_TENSORRT
+#if (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
 
 namespace tensorflow {
 namespace tensorrt {
@@ -213,6 +213,6 @@ UnionFind<T, P>* UnionFind<T, P>::FindRoot() {
 }  // namespace tensorrt
 }  // namespace tensorflow
 
-#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
+#endif  // (GOOGLE_CUDA && GOOGLE_TENSORRT) || TENSORFLOW_USE_ROCM
 
 #endif  // TENSORFLOW_COMPILER_TF2TENSORRT_SEGMENT_UNION_FIND_H_
@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_int8_calibrator.h"
 
+#include <algorithm>
 #include <atomic>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 
 #include "tensorflow/core/platform/logging.h"
 
@@ -30,44 +33,51 @@ namespace tensorrt {
 int TRTInt8Calibrator::getBatchSize() const { return batch_size_; }
 
 TRTInt8Calibrator::TRTInt8Calibrator(
-    const std::unordered_map<string, std::pair<void*, size_t>>& dev_buffers,
-    int batch_size, string engine_name)
+    const std::vector<DeviceBuffers>& dev_buffers, int batch_size,
+    string engine_name)
     : batch_size_(batch_size),
       done_(false),
       dev_buffers_(dev_buffers),
-      // Make sure setBatch() waits until getBatch() is called (the first time).
-      calib_running_(true),
-      batch_is_set_(false),
-      engine_name_(engine_name) {}
+      slot_states_(dev_buffers.size(), SlotState::kFree),
+      engine_name_(engine_name) {
+  CHECK(!dev_buffers_.empty());
+}
 
 TRTInt8Calibrator::TRTInt8Calibrator(const string& calib_data)
-    : batch_size_(0),
-      done_(true),
-      calib_running_(false),
-      batch_is_set_(false),
-      calibration_table_(calib_data) {}
+    : batch_size_(0), done_(true), calibration_table_(calib_data) {}
+
+bool TRTInt8Calibrator::AllBatchesConsumed() const {
+  for (SlotState state : slot_states_) {
+    if (state != SlotState::kFree) return false;
+  }
+  return true;
+}
 
 bool TRTInt8Calibrator::setBatch(const std::unordered_map<string, void*>& data,
                                  const cudaStream_t stream) {
-  mutex_lock lock(cond_mtx_);
-
-  // Wait while the queue is full or calibration is running.
-  while ((calib_running_ || batch_is_set_) && !done_) cond_.wait(lock);
-  if (done_) return false;
-  CHECK(!calib_running_ && !batch_is_set_);
+  int slot;
+  {
+    mutex_lock lock(cond_mtx_);
+    // Wait while all the staging buffers are full.
+    while (slot_states_[next_slot_] != SlotState::kFree && !done_) {
+      cond_.wait(lock);
+    }
+    if (done_) return false;
+    slot = next_slot_;
+    next_slot_ = (next_slot_ + 1) % slot_states_.size();
+    slot_states_[slot] = SlotState::kCopying;
+  }
   VLOG(1) << "Set Batch Waiting finished";
 
-  // Sets the batch.
+  // Sets the batch. The copies are ordered before the later uses of the
+  // inputs on the stream, so the inputs can't be freed before they are read.
   for (const auto& it : data) {
-    auto devptr = dev_buffers_.find(it.first);
-    if (devptr == dev_buffers_.end()) {
+    auto devptr = dev_buffers_[slot].find(it.first);
+    if (devptr == dev_buffers_[slot].end()) {
       LOG(FATAL) << "FATAL " << engine_name_ << " input name '" << it.first
                  << "' does not match with the buffer names";
     }
     const auto& d = devptr->second;
-
-    // TODO(sami,aaroey): Need to figure out a way to ensure synchronization
-    // between stream, perhaps using a tensor?
     auto status = cudaMemcpyAsync(d.first, it.second, d.second,
                                   cudaMemcpyDeviceToDevice, stream);
     if (status != cudaSuccess) {
@@ -76,48 +86,73 @@ bool TRTInt8Calibrator::setBatch(const std::unordered_map<string, void*>& data,
     }
   }
 
-  // TODO(Sami, aaorey): Find an alternative way!
-  // we have to wait for the stream before returning!
-  cudaStreamSynchronize(stream);
-  batch_is_set_ = true;
-  cond_.notify_all();
+  // Hand the batch to TRT once it is on the device, without blocking the op.
+  auto* callback_data = new std::pair<TRTInt8Calibrator*, int>(this, slot);
+  auto status = cudaLaunchHostFunc(stream, &TRTInt8Calibrator::BatchCopied,
+                                   callback_data);
+  if (status != cudaSuccess) {
+    LOG(WARNING) << "Failed to enqueue the calibration callback for "
+                 << engine_name_ << ", waiting for the copy instead: "
+                 << status;
+    delete callback_data;
+    cudaStreamSynchronize(stream);
+    SetSlotReady(slot);
+  }
   return true;
 }
 
+void TRTInt8Calibrator::BatchCopied(void* data) {
+  std::unique_ptr<std::pair<TRTInt8Calibrator*, int>> callback_data(
+      static_cast<std::pair<TRTInt8Calibrator*, int>*>(data));
+  callback_data->first->SetSlotReady(callback_data->second);
+}
+
+void TRTInt8Calibrator::SetSlotReady(int slot) {
+  mutex_lock lock(cond_mtx_);
+  slot_states_[slot] = SlotState::kReady;
+  cond_.notify_all();
+}
+
 bool TRTInt8Calibrator::getBatch(void** bindings, const char** names,
                                  int num_bindings) {
   mutex_lock lock(cond_mtx_);
   // Notify finish of last round of calibration.
-  calib_running_ = false;
-  cond_.notify_all();
+  if (slot_in_use_ >= 0) {
+    slot_states_[slot_in_use_] = SlotState::kFree;
+    slot_in_use_ = -1;
+    cond_.notify_all();
+  }
 
   // Wait until new batch arrives
-  while ((!batch_is_set_ && !done_)) cond_.wait(lock);
+  while (slot_states_[next_batch_] != SlotState::kReady && !done_) {
+    cond_.wait(lock);
+  }
   if (done_) return false;
 
   // Gets the batch
+  const int slot = next_batch_;
   for (int i = 0; i < num_bindings; i++) {
-    auto it = dev_buffers_.find(names[i]);
-    if (it == dev_buffers_.end()) {
+    auto it = dev_buffers_[slot].find(names[i]);
+    if (it == dev_buffers_[slot].end()) {
       LOG(FATAL) << "Calibration engine asked for unknown tensor name '"
                  << names[i] << "' at position " << i;
     }
     bindings[i] = it->second.first;
   }
-  batch_is_set_ = false;
-  calib_running_ = true;
+  slot_states_[slot] = SlotState::kInUse;
+  slot_in_use_ = slot;
+  next_batch_ = (next_batch_ + 1) % slot_states_.size();
   return true;
 }
 
 void TRTInt8Calibrator::waitAndSetDone() {
   mutex_lock lock(cond_mtx_);
-  // Wait while the queue is full or calibration is running, so we don't miss
+  // Wait while batches are queued or calibration is running, so we don't miss
   // the last batch.
-  while ((calib_running_ || batch_is_set_) && !done_) cond_.wait(lock);
+  while (!AllBatchesConsumed() && !done_) cond_.wait(lock);
   if (!done_) {
     done_ = true;
     cond_.notify_all();
-    dev_buffers_.clear();
   }
 }
 
@@ -141,6 +176,12 @@ void TRTInt8Calibrator::writeCalibrationCache(const void* ptr,
 }
 TRTInt8Calibrator::~TRTInt8Calibrator() {
   VLOG(1) << "Destroying calibrator for " << engine_name_;
+  // Pending copy callbacks still refer to the calibrator.
+  mutex_lock lock(cond_mtx_);
+  while (std::find(slot_states_.begin(), slot_states_.end(),
+                   SlotState::kCopying) != slot_states_.end()) {
+    cond_.wait(lock);
+  }
 }
 
 }  // namespace tensorrt
@@ -20,6 +20,8 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
+
 #include "tensorflow/core/platform/mutex.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
@@ -29,9 +31,14 @@ limitations under the License.
 
 namespace tensorflow {
 namespace tensorrt {
-// This class provides a 1 element queue to match TFs push model to
-// TRTs pull model for calibration. When TRT implements a means for
-// a push calibration This class should be updated accordingly
+// This class provides a queue to match TFs push model to TRTs pull model for
+// calibration. When TRT implements a means for a push calibration This class
+// should be updated accordingly
+//
+// Batches are staged in a ring of device buffers, so that TF can copy the next
+// batch while TRT calibrates on the previous one. setBatch() enqueues the copy
+// on the stream of the op and returns without waiting for it; the batch is
+// handed to TRT once the copy has completed on the device.
 
 // IInt8EntropyCalibrator2 is preferred for TRT 5.1+.
 #if NV_TENSORRT_MAJOR > 5 || (NV_TENSORRT_MAJOR == 5 && NV_TENSORRT_MINOR >= 1)
@@ -40,10 +47,13 @@ struct TRTInt8Calibrator : public nvinfer1::IInt8EntropyCalibrator2 {
 struct TRTInt8Calibrator : public nvinfer1::IInt8EntropyCalibrator {
 #endif
  public:
-  // Construct a calibrator for future calibration.
-  TRTInt8Calibrator(
-      const std::unordered_map<string, std::pair<void*, size_t>>& dev_buffers,
-      int batch_size, string engine_name);
+  // Map from input names to a device buffer and its size.
+  using DeviceBuffers = std::unordered_map<string, std::pair<void*, size_t>>;
+
+  // Construct a calibrator for future calibration, which stages batches in
+  // each of `dev_buffers` in turn.
+  TRTInt8Calibrator(const std::vector<DeviceBuffers>& dev_buffers,
+                    int batch_size, string engine_name);
 
   // Construct a finalized calibrator where we don't need to run calibration any
   // more, as the calibration data is provided.
@@ -57,11 +67,12 @@ struct TRTInt8Calibrator : public nvinfer1::IInt8EntropyCalibrator {
                 int num_bindings) override;
 
   // Feed calibration data to the calibrator, and return true if the data is
-  // accepted. Return false if the calibrator has been terminated.
+  // accepted. Return false if the calibrator has been terminated. Waits while
+  // all the staging buffers hold batches that TRT hasn't consumed yet.
   bool setBatch(const std::unordered_map<string, void*>& data,
                 const cudaStream_t stream);
 
-  // Wait until the last batch is consumed by the calibrator and set done.
+  // Wait until all the batches are consumed by the calibrator and set done.
   void waitAndSetDone();
 
   // Notify that calibration is done and future batches provided by setBatch()
@@ -76,6 +87,24 @@ struct TRTInt8Calibrator : public nvinfer1::IInt8EntropyCalibrator {
   const string& getCalibrationTableAsString() { return calibration_table_; }
 
  private:
+  enum class SlotState {
+    kFree,
+    // The batch is being copied to the slot on the stream of the op.
+    kCopying,
+    // The batch is in the slot, waiting to be consumed by TRT.
+    kReady,
+    // TRT is calibrating on the batch.
+    kInUse,
+  };
+
+  // Called on a CUDA callback thread once the copy of a batch to its slot is
+  // done.
+  static void BatchCopied(void* data);
+  void SetSlotReady(int slot);
+
+  // Returns whether all the batches fed to the calibrator have been consumed.
+  bool AllBatchesConsumed() const TF_EXCLUSIVE_LOCKS_REQUIRED(cond_mtx_);
+
   const int batch_size_;
 
   // mutex for condition_variable
@@ -87,11 +116,18 @@ struct TRTInt8Calibrator : public nvinfer1::IInt8EntropyCalibrator {
   // Is calibration finished?
   bool done_;
 
-  // Map to keep tensorrt input buffers and sizes keyed with buffer names
-  std::unordered_map<string, std::pair<void*, size_t>> dev_buffers_;
-
-  bool calib_running_;
-  bool batch_is_set_;
+  // Tensorrt input buffers and sizes keyed with buffer names, for each
+  // staging slot.
+  std::vector<DeviceBuffers> dev_buffers_;
+
+  std::vector<SlotState> slot_states_ TF_GUARDED_BY(cond_mtx_);
+  // The next slot filled by setBatch().
+  int next_slot_ TF_GUARDED_BY(cond_mtx_) = 0;
+  // The next slot consumed by getBatch(). Slots are filled and consumed in
+  // the same order, so batches are calibrated in the order they are fed.
+  int next_batch_ TF_GUARDED_BY(cond_mtx_) = 0;
+  // The slot TRT is calibrating on, or -1.
+  int slot_in_use_ TF_GUARDED_BY(cond_mtx_) = -1;
 
   string engine_name_;
   string calibration_table_;
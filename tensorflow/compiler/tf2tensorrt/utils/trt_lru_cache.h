@@ -159,10 +159,15 @@ class CalibrationContext {
  public:
   string TerminateCalibration();
 
-  // Lookup table for temporary staging areas of input tensors for calibration.
-  std::unordered_map<string, std::pair<void*, size_t>> device_buffers_;
+  // Number of batches that can be staged for calibration at once.
+  static constexpr int kNumStagingBuffers = 2;
 
-  // Temporary staging areas for calibration inputs.
+  // Lookup tables for temporary staging areas of input tensors for
+  // calibration, one per staged batch.
+  std::vector<TRTInt8Calibrator::DeviceBuffers> device_buffers_;
+
+  // Temporary staging areas for calibration inputs, for input i of staged
+  // batch b at index b * num_inputs + i.
   std::vector<PersistentTensor> device_tensors_;
 
   std::unique_ptr<TRTInt8Calibrator> calibrator_;
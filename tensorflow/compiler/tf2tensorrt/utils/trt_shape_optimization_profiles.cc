@@ -18,8 +18,12 @@ limitations under the License.
 #include <algorithm>
 #include <functional>
 
+#include <unordered_map>
+
 #include "absl/algorithm/container.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
+#include "tensorflow/core/platform/mutex.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 namespace tensorflow {
@@ -49,6 +53,34 @@ void TrtShapeOptimizationProfile::InitProfiles() {
   }
 }
 
+void TrtShapeOptimizationProfile::InitSharedProfiles(const string& key) {
+  static mutex mu(LINKER_INITIALIZED);
+  static auto* shared_profiles =
+      new std::unordered_map<string, std::vector<OptimizationProfileConfig>>();
+  mutex_lock l(mu);
+  auto it = shared_profiles->find(key);
+  if (it != shared_profiles->end()) {
+    const std::vector<OptimizationProfileConfig>& profiles = it->second;
+    const bool includes_all_shapes = absl::c_all_of(
+        input_shapes_, [&profiles](const std::vector<TensorShape>& shapes) {
+          return absl::c_any_of(
+              profiles, [&shapes](const OptimizationProfileConfig& profile) {
+                return profile.IncludesShapes(shapes);
+              });
+        });
+    if (includes_all_shapes) {
+      VLOG(1) << "Reusing " << profiles.size() << " profiles shared under "
+              << key;
+      profiles_ = profiles;
+      return;
+    }
+  }
+  InitProfiles();
+  if (it == shared_profiles->end() && !profiles_.empty()) {
+    shared_profiles->emplace(key, profiles_);
+  }
+}
+
 #if IS_TRT_VERSION_GE(6, 0, 0, 0)
 Status TrtShapeOptimizationProfile::AddProfiles(
     nvinfer1::IBuilder* builder, nvinfer1::IBuilderConfig* config,
@@ -183,6 +215,13 @@ int TrtShapeOptimizationProfile::GetNumProfiles() const {
   return profiles_.size();
 }
 
+string TrtShapeOptimizationProfile::ProfilesDebugString() const {
+  return absl::StrJoin(profiles_, ", ",
+                       [](string* out, const OptimizationProfileConfig& p) {
+                         out->append(p.DebugString());
+                       });
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
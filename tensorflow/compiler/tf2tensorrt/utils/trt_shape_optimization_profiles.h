@@ -147,9 +147,19 @@ class TrtShapeOptimizationProfile {
   // maps input_shapes_ to profiles_
   void InitProfiles();
 
+  // Like InitProfiles, but shares the profiles with the other objects that are
+  // initialized with the same `key`, e.g. the engine caches of the replicas of
+  // a TRTEngineOp on different devices. The first object initialized with a
+  // key creates the profiles from its collected shapes, and later objects
+  // reuse them as long as they include all the shapes those objects collected.
+  void InitSharedProfiles(const string& key);
+
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
+  // Returns a string that describes all the created profiles.
+  string ProfilesDebugString() const;
+
   // Restores profiles from the engine (used after deserialization)
   Status RestoreProfiles(const nvinfer1::ICudaEngine* engine);
 
@@ -151,6 +151,35 @@ TEST_F(TrtShapeOptimizationProfileTest, Static) {
   EXPECT_EQ(-1, profile.GetProfileNumber(shape_vec));
 }
 
+TEST(TrtShapeOptimizationProfileSharingTest, SharedProfiles) {
+  const std::vector<TensorShape> small = DimVecToShapeVec(
+      {nvinfer1::Dims3(2, 2, 10), nvinfer1::Dims3(2, 2, 10)});
+  const std::vector<TensorShape> large = DimVecToShapeVec(
+      {nvinfer1::Dims3(16, 16, 10), nvinfer1::Dims3(16, 16, 10)});
+
+  TrtShapeOptimizationProfile first;
+  first.AddShape(small);
+  first.AddShape(large);
+  first.InitSharedProfiles("SharedProfiles");
+  EXPECT_EQ(2, first.GetNumProfiles());
+
+  // A replica that collected no shapes, or a subset of them, reuses the
+  // profiles of the first one.
+  TrtShapeOptimizationProfile replica;
+  replica.AddShape(large);
+  replica.InitSharedProfiles("SharedProfiles");
+  EXPECT_EQ(first.ProfilesDebugString(), replica.ProfilesDebugString());
+  EXPECT_EQ(first.GetProfileNumber(small), replica.GetProfileNumber(small));
+
+  // Shapes outside of the shared profiles get profiles of their own.
+  TrtShapeOptimizationProfile other;
+  other.AddShape(DimVecToShapeVec(
+      {nvinfer1::Dims3(3, 3, 10), nvinfer1::Dims3(3, 3, 10)}));
+  other.InitSharedProfiles("SharedProfiles");
+  EXPECT_EQ(1, other.GetNumProfiles());
+  EXPECT_EQ(-1, other.GetProfileNumber(small));
+}
+
 #if IS_TRT_VERSION_GE(6, 0, 0, 0)
 TEST_F(TrtShapeOptimizationProfileTest, Dynamic) {
   // Network with dynamic input shapes
@@ -847,6 +847,18 @@ Status XlaCompiler::XLAShapeForArgument(
         TF_RETURN_IF_ERROR(RewriteLayoutWithShardedShape(
             arg_sharding, /*use_fast_memory=*/false,
             options_.shape_representation_fn, xla_shape));
+        if (absl::holds_alternative<xla::Shape>(arg.shape) &&
+            xla_shape->IsArray() &&
+            xla_shape->rank() == absl::get<xla::Shape>(arg.shape).rank()) {
+          // Keep the bounded dynamic dimensions of the argument, e.g. those
+          // introduced by shape bucketing.
+          const xla::Shape& arg_shape = absl::get<xla::Shape>(arg.shape);
+          for (int i = 0; i < arg_shape.rank(); ++i) {
+            if (arg_shape.is_dynamic_dimension(i)) {
+              xla_shape->set_dynamic_dimension(i, true);
+            }
+          }
+        }
       } else {
         if (absl::holds_alternative<xla::Shape>(arg.shape)) {
           *xla_shape = absl::get<xla::Shape>(arg.shape);
@@ -359,6 +359,24 @@ static void AllocateFlags() {
       bool_setter_for(&DebugOptions::set_xla_gpu_disable_multi_streaming),
       flag_values->xla_gpu_disable_multi_streaming(),
       "If true, multi-streaming in the GPU backend is disabled."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_max_concurrent_streams",
+      int32_setter_for(&DebugOptions::set_xla_gpu_max_concurrent_streams),
+      flag_values->xla_gpu_max_concurrent_streams(),
+      "If greater than 1, independent thunks of any kind are spread over up "
+      "to this many streams. Requires multi-streaming to be enabled."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_async_collectives",
+      bool_setter_for(&DebugOptions::set_xla_gpu_async_collectives),
+      flag_values->xla_gpu_async_collectives(),
+      "If true, NCCL collectives run on a dedicated stream and overlap with "
+      "independent compute. Requires multi-streaming to be enabled."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_host_offload_min_size_mb",
+      int32_setter_for(&DebugOptions::set_xla_gpu_host_offload_min_size_mb),
+      flag_values->xla_gpu_host_offload_min_size_mb(),
+      "If positive, long-lived values of at least this many MiB are kept in "
+      "pinned host memory between their producer and distant users."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_max_kernel_unroll_factor",
       int32_setter_for(&DebugOptions::set_xla_gpu_max_kernel_unroll_factor),
@@ -605,6 +623,16 @@ static void AllocateFlags() {
       bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_ops),
       flag_values->xla_gpu_deterministic_ops(),
       "Guarantees run-to-run determinism on GPU."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_persistent_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_persistent_cache_dir), "",
+      "If non-empty, specifies a directory in which compiled GPU kernel "
+      "binaries are cached across processes."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_autotune_results_path",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_results_path), "",
+      "If non-empty, conv and GEMM autotuning results are loaded from and "
+      "saved to this file, so that autotuning runs once per device model."));
 
   ParseFlagsFromEnvAndDieIfUnknown("XLA_FLAGS", *flag_objects);
 }
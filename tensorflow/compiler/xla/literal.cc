@@ -780,6 +780,53 @@ StatusOr<Literal> LiteralBase::Broadcast(
     result.SetDynamicSize(dimensions[i], dynamic_size);
   }
 
+  if (LayoutUtil::IsMonotonicWithDim0Major(shape().layout()) &&
+      LayoutUtil::IsMonotonicWithDim0Major(result_shape.layout()) &&
+      std::is_sorted(dimensions.begin(), dimensions.end())) {
+    // Fast path for broadcasts which do not transpose: walk the result in
+    // memory order and copy the largest block of elements which is contiguous
+    // in both the source and the result at once.
+    const int64 result_rank = result_shape.rank();
+    const int64 source_rank = shape().rank();
+    int64 block_rank = 0;
+    int64 block_size = 1;
+    while (block_rank < source_rank &&
+           dimensions[source_rank - 1 - block_rank] ==
+               result_rank - 1 - block_rank) {
+      block_size *= shape().dimensions(source_rank - 1 - block_rank);
+      ++block_rank;
+    }
+
+    // The stride in the source of every outer dimension of the result, zero
+    // for the dimensions being broadcast.
+    const int64 outer_rank = result_rank - block_rank;
+    std::vector<int64> source_strides(outer_rank, 0);
+    int64 stride = block_size;
+    for (int64 i = source_rank - 1 - block_rank; i >= 0; --i) {
+      source_strides[dimensions[i]] = stride;
+      stride *= shape().dimensions(i);
+    }
+
+    const int64 block_bytes = block_size * primitive_size;
+    const int64 num_blocks =
+        block_size == 0 ? 0 : ShapeUtil::ElementsIn(result_shape) / block_size;
+    std::vector<int64> outer_index(outer_rank, 0);
+    int64 source_offset = 0;
+    for (int64 block = 0; block < num_blocks; ++block) {
+      memcpy(dest_data + block * block_bytes,
+             source_data + source_offset * primitive_size, block_bytes);
+      for (int64 d = outer_rank - 1; d >= 0; --d) {
+        source_offset += source_strides[d];
+        if (++outer_index[d] < result_shape.dimensions(d)) {
+          break;
+        }
+        source_offset -= source_strides[d] * result_shape.dimensions(d);
+        outer_index[d] = 0;
+      }
+    }
+    return std::move(result);
+  }
+
   ShapeUtil::ForEachIndex(
       result_shape, [&](absl::Span<const int64> output_index) {
         for (int64 i = 0, end = dimensions.size(); i < end; ++i) {
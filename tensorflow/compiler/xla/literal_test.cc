@@ -2078,6 +2078,28 @@ TEST_F(LiteralUtilTest, BroadcastScalarToMatrix) {
             LiteralUtil::CreateR2<int32>({{9, 9}, {9, 9}}));
 }
 
+TEST_F(LiteralUtilTest, BroadcastMatrixToRank3) {
+  Literal literal = LiteralUtil::CreateR2<int32>({{1, 2, 3}, {4, 5, 6}});
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal broadcasted_literal,
+      literal.Broadcast(/*result_shape=*/ShapeUtil::MakeShape(S32, {2, 2, 3}),
+                        /*dimensions=*/{0, 2}));
+  EXPECT_EQ(broadcasted_literal, LiteralUtil::CreateR3<int32>(
+                                     {{{1, 2, 3}, {1, 2, 3}},
+                                      {{4, 5, 6}, {4, 5, 6}}}));
+}
+
+TEST_F(LiteralUtilTest, BroadcastColumnMajorMatrix) {
+  Literal literal = LiteralUtil::CreateR2WithLayout<int32>(
+      {{1, 2}, {3, 4}}, LayoutUtil::MakeLayout({0, 1}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal broadcasted_literal,
+      literal.Broadcast(/*result_shape=*/ShapeUtil::MakeShape(S32, {2, 2, 2}),
+                        /*dimensions=*/{1, 2}));
+  EXPECT_EQ(broadcasted_literal,
+            LiteralUtil::CreateR3<int32>({{{1, 2}, {3, 4}}, {{1, 2}, {3, 4}}}));
+}
+
 TEST_F(LiteralUtilTest, DynamicBroadcast) {
   Literal literal = LiteralUtil::CreateR1<int64>({1, 2});
   literal.SetDynamicSize(0, 1);
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/collective_ops_utils.h"
 
 #include "tensorflow/compiler/xla/service/global_device_id.h"
+#include "tensorflow/compiler/xla/service/hlo_casting_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_instructions.h"
 
 namespace xla {
 
@@ -105,4 +107,97 @@ StatusOr<std::vector<GlobalDeviceId>> GetParticipatingDevices(
   return participants;
 }
 
+StatusOr<CollectiveOpGroupMode> GetCollectiveOpGroupMode(
+    bool has_channel_id, absl::optional<bool> use_global_device_ids) {
+  if (!has_channel_id) {
+    if (use_global_device_ids.value_or(false)) {
+      return InvalidArgument(
+          "Invalid combination of has_channel_id and use_global_device_ids");
+    }
+    return CollectiveOpGroupMode::kCrossReplica;
+  }
+  if (!use_global_device_ids.has_value()) {
+    return CollectiveOpGroupMode::kCrossPartition;
+  }
+  return *use_global_device_ids
+             ? CollectiveOpGroupMode::kFlattenedID
+             : CollectiveOpGroupMode::kCrossReplicaAndPartition;
+}
+
+StatusOr<CollectiveOpGroupMode> GetCollectiveOpGroupMode(
+    const HloInstruction* hlo) {
+  absl::optional<bool> use_global_device_ids;
+  if (hlo->opcode() == HloOpcode::kAllReduce) {
+    use_global_device_ids =
+        Cast<HloAllReduceInstruction>(hlo)->use_global_device_ids();
+  } else if (hlo->opcode() == HloOpcode::kAllGather) {
+    use_global_device_ids =
+        Cast<HloAllGatherInstruction>(hlo)->use_global_device_ids();
+  }
+  return GetCollectiveOpGroupMode(hlo->channel_id().has_value(),
+                                  use_global_device_ids);
+}
+
+StatusOr<std::vector<GlobalDeviceId>> GetParticipatingDevices(
+    GlobalDeviceId device_id, const DeviceAssignment& device_assignment,
+    absl::Span<const ReplicaGroup> replica_groups,
+    CollectiveOpGroupMode group_mode) {
+  const int replica_count = device_assignment.replica_count();
+  const int partition_count = device_assignment.computation_count();
+  if (group_mode == CollectiveOpGroupMode::kCrossReplica) {
+    return GetParticipatingDevices(device_id, device_assignment, replica_count,
+                                   replica_groups);
+  }
+
+  std::pair<int, int> logical_ids;
+  TF_ASSIGN_OR_RETURN(logical_ids,
+                      device_assignment.LogicalIdsForDevice(device_id));
+  const int replica_id = logical_ids.first;
+  const int partition_id = logical_ids.second;
+
+  std::vector<GlobalDeviceId> participants;
+  switch (group_mode) {
+    case CollectiveOpGroupMode::kCrossPartition: {
+      // The groups hold partition ids, which GetParticipatingReplicas treats
+      // just like replica ids.
+      TF_ASSIGN_OR_RETURN(std::vector<int> participating_partitions,
+                          GetParticipatingReplicas(
+                              partition_id, partition_count, replica_groups));
+      for (int partition : participating_partitions) {
+        participants.emplace_back(device_assignment(replica_id, partition));
+      }
+      break;
+    }
+    case CollectiveOpGroupMode::kCrossReplicaAndPartition: {
+      TF_ASSIGN_OR_RETURN(std::vector<int> participating_replicas,
+                          GetParticipatingReplicas(replica_id, replica_count,
+                                                   replica_groups));
+      for (int replica : participating_replicas) {
+        for (int partition = 0; partition < partition_count; ++partition) {
+          participants.emplace_back(device_assignment(replica, partition));
+        }
+      }
+      break;
+    }
+    case CollectiveOpGroupMode::kFlattenedID: {
+      TF_RET_CHECK(!replica_groups.empty())
+          << "Replica groups must be specified with flattened ids";
+      TF_ASSIGN_OR_RETURN(
+          std::vector<int> participating_ids,
+          GetParticipatingReplicas(replica_id * partition_count + partition_id,
+                                   replica_count * partition_count,
+                                   replica_groups));
+      for (int flattened_id : participating_ids) {
+        participants.emplace_back(
+            device_assignment(flattened_id / partition_count,
+                              flattened_id % partition_count));
+      }
+      break;
+    }
+    case CollectiveOpGroupMode::kCrossReplica:
+      LOG(FATAL) << "Handled above";
+  }
+  return participants;
+}
+
 }  // end namespace xla
@@ -49,6 +49,39 @@ StatusOr<std::vector<GlobalDeviceId>> GetParticipatingDevices(
     GlobalDeviceId device_id, const DeviceAssignment& device_assignment,
     int total_replica_count, absl::Span<const ReplicaGroup> replica_groups);
 
+// How the ids in the replica groups of a collective op are interpreted.
+enum class CollectiveOpGroupMode {
+  // The ids are replica ids; the op runs among the replicas of a group which
+  // execute the same partition.
+  kCrossReplica,
+  // The ids are partition ids; the op runs among the partitions of a group
+  // which execute within the same replica.
+  kCrossPartition,
+  // The ids are replica ids; the op runs among all the partitions of all the
+  // replicas of a group.
+  kCrossReplicaAndPartition,
+  // The ids are flattened ids, replica_id * partition_count + partition_id.
+  kFlattenedID,
+};
+
+// Returns the group mode of a collective op with or without a channel id.
+// `use_global_device_ids` is empty for ops which do not have that attribute.
+StatusOr<CollectiveOpGroupMode> GetCollectiveOpGroupMode(
+    bool has_channel_id, absl::optional<bool> use_global_device_ids);
+
+// Returns the group mode of the given collective instruction.
+StatusOr<CollectiveOpGroupMode> GetCollectiveOpGroupMode(
+    const HloInstruction* hlo);
+
+// Figures out which devices are participating in the collective subgroup of
+// `device_id`, interpreting `replica_groups` according to `group_mode`. An
+// empty `replica_groups` indicates that all the replicas, respectively
+// partitions, are participating.
+StatusOr<std::vector<GlobalDeviceId>> GetParticipatingDevices(
+    GlobalDeviceId device_id, const DeviceAssignment& device_assignment,
+    absl::Span<const ReplicaGroup> replica_groups,
+    CollectiveOpGroupMode group_mode);
+
 // Key that identifies a particular Rendezvous object in our global hashtable.
 // This determines which calls to ExecuteOnStream communicate with each other.
 // The rules are as follows.
@@ -105,5 +105,83 @@ TEST(CollectiveOpsUtilsTest, GetParticipatingDevices_MultipleComputations) {
   EXPECT_EQ(actual, expected);
 }
 
+TEST(CollectiveOpsUtilsTest, GetCollectiveOpGroupMode) {
+  EXPECT_EQ(GetCollectiveOpGroupMode(/*has_channel_id=*/false, absl::nullopt)
+                .ValueOrDie(),
+            CollectiveOpGroupMode::kCrossReplica);
+  EXPECT_EQ(GetCollectiveOpGroupMode(/*has_channel_id=*/true, absl::nullopt)
+                .ValueOrDie(),
+            CollectiveOpGroupMode::kCrossPartition);
+  EXPECT_EQ(GetCollectiveOpGroupMode(/*has_channel_id=*/true, false)
+                .ValueOrDie(),
+            CollectiveOpGroupMode::kCrossReplicaAndPartition);
+  EXPECT_EQ(
+      GetCollectiveOpGroupMode(/*has_channel_id=*/true, true).ValueOrDie(),
+      CollectiveOpGroupMode::kFlattenedID);
+  EXPECT_FALSE(GetCollectiveOpGroupMode(/*has_channel_id=*/false, true).ok());
+}
+
+// Devices 42..49 run 2 replicas of 4 partitions each.
+DeviceAssignment MakeTwoByFourDeviceAssignment() {
+  DeviceAssignment device_assignment(/*replica_count=*/2,
+                                     /*computation_count=*/4);
+  for (int replica = 0; replica < 2; ++replica) {
+    for (int partition = 0; partition < 4; ++partition) {
+      device_assignment(replica, partition) = 42 + replica * 4 + partition;
+    }
+  }
+  return device_assignment;
+}
+
+TEST(CollectiveOpsUtilsTest, GetParticipatingDevices_CrossPartition) {
+  DeviceAssignment device_assignment = MakeTwoByFourDeviceAssignment();
+  std::vector<ReplicaGroup> replica_groups(2);
+  replica_groups[0].add_replica_ids(0);
+  replica_groups[0].add_replica_ids(2);
+  replica_groups[1].add_replica_ids(1);
+  replica_groups[1].add_replica_ids(3);
+
+  std::vector<GlobalDeviceId> actual =
+      GetParticipatingDevices(GlobalDeviceId(47), device_assignment,
+                              replica_groups,
+                              CollectiveOpGroupMode::kCrossPartition)
+          .ConsumeValueOrDie();
+  std::vector<GlobalDeviceId> expected = {GlobalDeviceId(47),
+                                          GlobalDeviceId(49)};
+  EXPECT_EQ(actual, expected);
+}
+
+TEST(CollectiveOpsUtilsTest, GetParticipatingDevices_CrossReplicaAndPartition) {
+  DeviceAssignment device_assignment = MakeTwoByFourDeviceAssignment();
+
+  std::vector<GlobalDeviceId> actual =
+      GetParticipatingDevices(GlobalDeviceId(43), device_assignment,
+                              /*replica_groups=*/{},
+                              CollectiveOpGroupMode::kCrossReplicaAndPartition)
+          .ConsumeValueOrDie();
+  EXPECT_EQ(actual.size(), 8);
+}
+
+TEST(CollectiveOpsUtilsTest, GetParticipatingDevices_FlattenedID) {
+  DeviceAssignment device_assignment = MakeTwoByFourDeviceAssignment();
+  std::vector<ReplicaGroup> replica_groups(2);
+  for (int id : {0, 1, 4, 5}) {
+    replica_groups[0].add_replica_ids(id);
+  }
+  for (int id : {2, 3, 6, 7}) {
+    replica_groups[1].add_replica_ids(id);
+  }
+
+  std::vector<GlobalDeviceId> actual =
+      GetParticipatingDevices(GlobalDeviceId(48), device_assignment,
+                              replica_groups,
+                              CollectiveOpGroupMode::kFlattenedID)
+          .ConsumeValueOrDie();
+  std::vector<GlobalDeviceId> expected = {
+      GlobalDeviceId(44), GlobalDeviceId(45), GlobalDeviceId(48),
+      GlobalDeviceId(49)};
+  EXPECT_EQ(actual, expected);
+}
+
 }  // namespace
 }  // namespace xla
@@ -31,9 +31,12 @@ class NoopStats : public CompilationStats {
  public:
   NoopStats() = default;
 
-  void StartPass(absl::string_view pass_name) override {}
+  void StartPass(absl::string_view pass_name,
+                 int64 instruction_count) override {}
 
-  void EndPass(absl::string_view pass_name) override {}
+  void EndPass(absl::string_view pass_name, int64 instruction_count) override {}
+
+  std::vector<PassReport> GetPassReports() override { return {}; }
 
   void CompilationReport() override {}
 };
@@ -42,20 +45,25 @@ class Stats : public CompilationStats {
  public:
   Stats() = default;
 
-  void StartPass(absl::string_view pass_name) override;
+  void StartPass(absl::string_view pass_name, int64 instruction_count) override;
+
+  void EndPass(absl::string_view pass_name, int64 instruction_count) override;
 
-  void EndPass(absl::string_view pass_name) override;
+  std::vector<PassReport> GetPassReports() override;
 
   void CompilationReport() override;
 
  private:
   struct PassInfo {
-    PassInfo(absl::string_view name, double duration)
-        : name(name), duration_ms(duration) {}
+    PassInfo(absl::string_view name, double duration,
+             int64 instruction_count_delta)
+        : name(name),
+          duration_ms(duration),
+          instruction_count_delta(instruction_count_delta) {}
 
     absl::string_view name;
-    int num_runs = 1;
     double duration_ms;
+    int64 instruction_count_delta;
   };
 
   // Info about the passes that have been run so far.
@@ -65,6 +73,8 @@ class Stats : public CompilationStats {
   absl::string_view current_pass_;
   // The start time of the currently running pass.
   uint64 start_micros_;
+  // The number of HLO instructions when the currently running pass started.
+  int64 start_instruction_count_;
 };
 
 /* static */
@@ -77,55 +87,60 @@ std::unique_ptr<CompilationStats> CompilationStats::MakeStats() {
   return absl::make_unique<Stats>();
 }
 
-void Stats::StartPass(absl::string_view pass_name) {
+void Stats::StartPass(absl::string_view pass_name, int64 instruction_count) {
   CHECK(!pass_running_) << "Can't start " << pass_name << " while running "
                         << current_pass_;
   pass_running_ = true;
   current_pass_ = pass_name;
+  start_instruction_count_ = instruction_count;
   start_micros_ = tensorflow::Env::Default()->NowMicros();
 }
 
-void Stats::EndPass(absl::string_view pass_name) {
+void Stats::EndPass(absl::string_view pass_name, int64 instruction_count) {
   CHECK(pass_running_);
   CHECK_EQ(current_pass_, pass_name);
   pass_running_ = false;
   uint64 end_micros = tensorflow::Env::Default()->NowMicros();
   double duration_ms = (end_micros - start_micros_) / 1000.0;
-  passes_.push_back(PassInfo(current_pass_, duration_ms));
+  passes_.push_back(PassInfo(current_pass_, duration_ms,
+                             instruction_count - start_instruction_count_));
 }
 
-void Stats::CompilationReport() {
+std::vector<CompilationStats::PassReport> Stats::GetPassReports() {
   CHECK(!pass_running_) << "EndPass never called for " << current_pass_;
-  absl::flat_hash_map<absl::string_view, PassInfo> summary;
-  double total_duration = 0;
-
+  absl::flat_hash_map<absl::string_view, PassReport> summary;
   for (auto& pass_run : passes_) {
-    auto pass_name = pass_run.name;
-    total_duration += pass_run.duration_ms;
-    auto it = summary.find(pass_name);
-    if (it == summary.end()) {
-      summary.insert(std::make_pair(pass_name, pass_run));
-    } else {
-      ++summary.at(pass_name).num_runs;
-      summary.at(pass_name).duration_ms += pass_run.duration_ms;
-    }
+    PassReport& report = summary[pass_run.name];
+    report.pass_name = std::string(pass_run.name);
+    ++report.num_runs;
+    report.duration_ms += pass_run.duration_ms;
+    report.instruction_count_delta += pass_run.instruction_count_delta;
   }
 
-  std::vector<PassInfo> sorted_summary;
+  std::vector<PassReport> sorted_summary;
   sorted_summary.reserve(summary.size());
   for (auto& it : summary) {
-    sorted_summary.push_back(it.second);
+    sorted_summary.push_back(std::move(it.second));
   }
-  absl::c_sort(sorted_summary, [](const PassInfo& a, const PassInfo& b) {
+  absl::c_sort(sorted_summary, [](const PassReport& a, const PassReport& b) {
     // Sort passes that take the longest first, break ties using pass names.
-    return std::make_pair(b.duration_ms, a.name) <
-           std::make_pair(a.duration_ms, b.name);
+    return std::make_pair(b.duration_ms, a.pass_name) <
+           std::make_pair(a.duration_ms, b.pass_name);
   });
+  return sorted_summary;
+}
+
+void Stats::CompilationReport() {
+  std::vector<PassReport> reports = GetPassReports();
+  double total_duration = 0;
+  for (const PassReport& report : reports) {
+    total_duration += report.duration_ms;
+  }
   LOG(INFO) << "Total runtime (ms) of HLO passes: " << total_duration;
-  LOG(INFO) << "Pass name, num runs, time (ms)";
-  for (auto& pass_info : sorted_summary) {
-    LOG(INFO) << pass_info.name << ", " << pass_info.num_runs << ", "
-              << pass_info.duration_ms;
+  LOG(INFO) << "Pass name, num runs, time (ms), instruction count delta";
+  for (const PassReport& report : reports) {
+    LOG(INFO) << report.pass_name << ", " << report.num_runs << ", "
+              << report.duration_ms << ", " << report.instruction_count_delta;
   }
 }
 
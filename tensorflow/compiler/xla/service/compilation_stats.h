@@ -18,27 +18,47 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/str_format.h"
+#include "tensorflow/compiler/xla/types.h"
 
 namespace xla {
 
 // This class is used to collect information about HLO passes and print some
 // statistics at the end of compilation. From HloPassPipeline, we call StartPass
-// before the execution of a pass, and EndPass after. Currently, we only collect
-// timing information and how many times each pass was run. In the future, we
-// can add more things, such as the size of the HLO graph after each pass.
+// before the execution of a pass, and EndPass after. We collect timing
+// information, how many times each pass was run and how much each pass grew or
+// shrank the HLO graph.
 class CompilationStats {
  public:
+  // Aggregated statistics of all the runs of one pass.
+  struct PassReport {
+    std::string pass_name;
+    int num_runs = 0;
+    // Total wall time spent in the pass.
+    double duration_ms = 0;
+    // Total change in the number of HLO instructions caused by the pass.
+    int64 instruction_count_delta = 0;
+  };
+
   virtual ~CompilationStats() = default;
 
   static std::unique_ptr<CompilationStats> MakeNoopStats();
 
   static std::unique_ptr<CompilationStats> MakeStats();
 
-  virtual void StartPass(absl::string_view pass_name) = 0;
+  // `instruction_count` is the number of HLO instructions before and after the
+  // pass respectively.
+  virtual void StartPass(absl::string_view pass_name,
+                         int64 instruction_count) = 0;
+
+  virtual void EndPass(absl::string_view pass_name,
+                       int64 instruction_count) = 0;
 
-  virtual void EndPass(absl::string_view pass_name) = 0;
+  // Returns the statistics of every pass run so far, the passes that took the
+  // longest first.
+  virtual std::vector<PassReport> GetPassReports() = 0;
 
   virtual void CompilationReport() = 0;
 };
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/hlo_ordering.h"
+#include "tensorflow/compiler/xla/service/hlo_reachability.h"
 #include "tensorflow/compiler/xla/service/logical_buffer.h"
 #include "tensorflow/compiler/xla/service/tuple_simplifier.h"
 #include "tensorflow/compiler/xla/status_macros.h"
@@ -41,6 +42,25 @@ namespace {
 
 using absl::StrAppend;
 
+// Why each copy was added, keyed by the unique id of the copy.
+using CopyReasons = absl::flat_hash_map<int, string>;
+
+// Records `reason` for each copy in `copies`, which may hold nullptr for the
+// elements that were not copied.
+void RecordCopyReasons(const ShapeTree<HloInstruction*>& copies,
+                       absl::string_view reason, CopyReasons* copy_reasons) {
+  for (const auto& pair : copies) {
+    const HloInstruction* copy = pair.second;
+    if (copy == nullptr || copy->opcode() != HloOpcode::kCopy) {
+      continue;
+    }
+    (*copy_reasons)[copy->unique_id()] =
+        copies.shape().IsTuple()
+            ? absl::StrCat(reason, " (index ", pair.first.ToString(), ")")
+            : string(reason);
+  }
+}
+
 bool IsReadonlyEntryParameterValue(const HloValue& value) {
   const HloComputation* computation = value.defining_instruction()->parent();
   return value.defining_instruction()->opcode() == HloOpcode::kParameter &&
@@ -125,29 +145,31 @@ bool ShouldCopyRootValue(const HloValue& value,
 //        \   /
 //        Tuple
 //
+// The kCopy instructions of the two deep copies are returned in
+// 'from_copy_tree' and 'to_copy_tree', which must have the shapes of 'from' and
+// 'to'.
 StatusOr<std::pair<HloInstruction*, HloInstruction*>>
 DeepCopyAndAddControlEdges(HloInstruction* from, HloInstruction* to,
-                           const ShapeTree<bool>& indices_to_copy) {
+                           const ShapeTree<bool>& indices_to_copy,
+                           ShapeTree<HloInstruction*>* from_copy_tree,
+                           ShapeTree<HloInstruction*>* to_copy_tree) {
   DCHECK(ShapeUtil::Compatible(from->shape(), to->shape()));
   // to/from_copy_tree hold the kCopy instruction produces by the deep
   // copies. Elements which are not copied (indices_to_copy.element(index) ==
   // false) have nullptr at that index.
-  ShapeTree<HloInstruction*> from_copy_tree(from->shape(),
-                                            /*init_value=*/nullptr);
   TF_ASSIGN_OR_RETURN(HloInstruction * from_deep_copy,
                       from->parent()->DeepCopyInstruction(
-                          from, &indices_to_copy, &from_copy_tree));
+                          from, &indices_to_copy, from_copy_tree));
 
-  ShapeTree<HloInstruction*> to_copy_tree(to->shape(), /*init_value=*/nullptr);
   TF_ASSIGN_OR_RETURN(
       HloInstruction * to_deep_copy,
-      to->parent()->DeepCopyInstruction(to, &indices_to_copy, &to_copy_tree));
+      to->parent()->DeepCopyInstruction(to, &indices_to_copy, to_copy_tree));
 
   // Add control edges between the respective kCopy instructions.
-  for (const auto& pair : from_copy_tree) {
+  for (const auto& pair : *from_copy_tree) {
     const ShapeIndex& index = pair.first;
     HloInstruction* from_copy = pair.second;
-    HloInstruction* to_copy = to_copy_tree.element(index);
+    HloInstruction* to_copy = to_copy_tree->element(index);
     if (from_copy == nullptr) {
       TF_RET_CHECK(to_copy == nullptr);
       continue;
@@ -277,7 +299,7 @@ bool IndicesToCopyForConditional(const HloDataflowAnalysis& dataflow,
 // copy constructed of kCopy, kGetTupleElement, and kTuple instruction as
 // constructed by HloInstruction::DeepCopyInstruction.
 Status AddCopiesForWhile(const HloAliasAnalysis& alias_analysis,
-                         HloInstruction* xla_while) {
+                         HloInstruction* xla_while, CopyReasons* copy_reasons) {
   VLOG(2) << "Adding copies for kWhile instruction " << xla_while->name();
   TF_RET_CHECK(xla_while->opcode() == HloOpcode::kWhile);
 
@@ -298,10 +320,16 @@ Status AddCopiesForWhile(const HloAliasAnalysis& alias_analysis,
 
   // Deep copy init.
   HloInstruction* while_init = xla_while->mutable_operand(0);
-  TF_ASSIGN_OR_RETURN(
-      HloInstruction * while_init_copy,
-      xla_while->parent()->DeepCopyInstruction(while_init, &indices_to_copy));
+  ShapeTree<HloInstruction*> init_copies(while_init->shape(),
+                                         /*init_value=*/nullptr);
+  TF_ASSIGN_OR_RETURN(HloInstruction * while_init_copy,
+                      xla_while->parent()->DeepCopyInstruction(
+                          while_init, &indices_to_copy, &init_copies));
   TF_RETURN_IF_ERROR(while_init->ReplaceUseWith(xla_while, while_init_copy));
+  RecordCopyReasons(init_copies,
+                    absl::StrCat("init of ", xla_while->name(),
+                                 ", whose body updates the loop state"),
+                    copy_reasons);
 
   // Deep copy the parameter and the root. Extend a control edge from the copy
   // of the parameter value to the corresponding copy value of the root.
@@ -318,11 +346,23 @@ Status AddCopiesForWhile(const HloAliasAnalysis& alias_analysis,
   // deep copy).
   std::vector<HloInstruction*> param_users = param->users();
 
+  ShapeTree<HloInstruction*> param_copies(param->shape(),
+                                          /*init_value=*/nullptr);
+  ShapeTree<HloInstruction*> root_copies(root->shape(), /*init_value=*/nullptr);
   TF_ASSIGN_OR_RETURN(auto pair,
-                      DeepCopyAndAddControlEdges(param, root, indices_to_copy));
+                      DeepCopyAndAddControlEdges(param, root, indices_to_copy,
+                                                 &param_copies, &root_copies));
 
   HloInstruction* param_copy = pair.first;
   HloInstruction* root_copy = pair.second;
+  RecordCopyReasons(param_copies,
+                    absl::StrCat("loop state read by the body of ",
+                                 xla_while->name(), ", which updates it"),
+                    copy_reasons);
+  RecordCopyReasons(root_copies,
+                    absl::StrCat("loop state written by the body of ",
+                                 xla_while->name()),
+                    copy_reasons);
 
   for (HloInstruction* user : param_users) {
     TF_RETURN_IF_ERROR(param->ReplaceUseWith(user, param_copy));
@@ -336,7 +376,8 @@ Status AddCopiesForWhile(const HloAliasAnalysis& alias_analysis,
 // roots, in order to resolve interference. We later rely on
 // RemoveUnnecessaryCopies to drop the unnecessary ones.
 Status AddCopiesForConditional(const HloAliasAnalysis& alias_analysis,
-                               HloInstruction* conditional) {
+                               HloInstruction* conditional,
+                               CopyReasons* copy_reasons) {
   VLOG(2) << "Adding copies for kConditional instruction "
           << conditional->name();
   ShapeTree<bool> indices_to_copy(conditional->shape());
@@ -350,27 +391,135 @@ Status AddCopiesForConditional(const HloAliasAnalysis& alias_analysis,
   for (HloComputation* computation : conditional->branch_computations()) {
     HloInstruction* root = computation->root_instruction();
     std::vector<HloInstruction*> users = root->users();
+    ShapeTree<HloInstruction*> copies(root->shape(), /*init_value=*/nullptr);
     TF_ASSIGN_OR_RETURN(
         HloInstruction * deep_copy,
-        computation->DeepCopyInstruction(root, &indices_to_copy));
+        computation->DeepCopyInstruction(root, &indices_to_copy, &copies));
     for (HloInstruction* user : users) {
       TF_RETURN_IF_ERROR(root->ReplaceUseWith(user, deep_copy));
     }
     computation->set_root_instruction(deep_copy);
+    RecordCopyReasons(copies,
+                      absl::StrCat("output of ", conditional->name(),
+                                   " that differs between branches"),
+                      copy_reasons);
   }
   return Status::OK();
 }
 
 // Add copies for the operands of in-place operations. RemoveUnnecessaryCopies
-// will remove the unnecessary copies.
+// will remove the unnecessary copies. 'reason' describes why the operation may
+// not be able to run in place, if known.
 Status AddCopiesForInPlaceOperation(const HloAliasAnalysis& alias_analysis,
                                     HloInstruction* in_place_op,
-                                    int64 operand_number) {
+                                    int64 operand_number,
+                                    absl::string_view reason,
+                                    CopyReasons* copy_reasons) {
   VLOG(2) << "Adding copies for in-place operation " << in_place_op->name();
   HloInstruction* operand = in_place_op->mutable_operand(operand_number);
+  ShapeTree<HloInstruction*> copies(operand->shape(), /*init_value=*/nullptr);
   TF_ASSIGN_OR_RETURN(HloInstruction * deep_copy,
-                      in_place_op->parent()->DeepCopyInstruction(operand));
+                      in_place_op->parent()->DeepCopyInstruction(
+                          operand, /*indices_to_copy=*/nullptr, &copies));
   TF_RETURN_IF_ERROR(operand->ReplaceUseWith(in_place_op, deep_copy));
+  RecordCopyReasons(copies,
+                    absl::StrCat("operand ", operand_number, " of in-place ",
+                                 in_place_op->name(),
+                                 reason.empty() ? "" : ": ", reason),
+                    copy_reasons);
+  return Status::OK();
+}
+
+// A while body can only update a loop-carried tuple element in place, e.g. a
+// cache with a kDynamicUpdateSlice, if all the other reads of the element
+// execute before the update. The dependency ordering used by copy removal
+// leaves reads that are independent of the update unordered with it, which
+// keeps the conservative copy of the whole element. This adds control edges
+// from such reads to the update, unless a read depends on the update or may
+// alias the element. For the updates whose reads could not be ordered, the
+// reason is returned in 'unordered_updates'.
+Status OrderReadsBeforeInPlaceUpdates(
+    HloComputation* body,
+    absl::flat_hash_map<const HloInstruction*, string>* unordered_updates) {
+  const HloInstruction* param = body->parameter_instruction(0);
+  std::unique_ptr<HloReachabilityMap> reachability;
+  for (HloInstruction* in_place_op : body->MakeInstructionPostOrder()) {
+    for (const auto& operand_and_output_index :
+         HloDataflowAnalysis::GetInPlaceInputOutputPairs(in_place_op)) {
+      const HloUse& operand = operand_and_output_index.first;
+      const HloInstruction* element =
+          in_place_op->operand(operand.operand_number);
+      if (!operand.operand_index.empty() ||
+          element->opcode() != HloOpcode::kGetTupleElement ||
+          element->operand(0) != param) {
+        continue;
+      }
+
+      // The element may be extracted by more than one kGetTupleElement.
+      std::vector<HloInstruction*> reads;
+      for (const HloInstruction* user : param->users()) {
+        if (user->opcode() != HloOpcode::kGetTupleElement ||
+            user->tuple_index() != element->tuple_index()) {
+          continue;
+        }
+        for (HloInstruction* read : user->users()) {
+          if (read != in_place_op) {
+            reads.push_back(read);
+          }
+        }
+      }
+      if (reads.empty()) {
+        continue;
+      }
+
+      if (reachability == nullptr) {
+        reachability = HloReachabilityMap::Build(body);
+      }
+      string unordered_reason;
+      for (HloInstruction* read : reads) {
+        if (reachability->IsReachable(in_place_op, read)) {
+          unordered_reason = absl::StrCat("the loop state is also read by ",
+                                          read->name(), " after the update");
+          break;
+        }
+        switch (read->opcode()) {
+          case HloOpcode::kAddDependency:
+          case HloOpcode::kBitcast:
+          case HloOpcode::kCall:
+          case HloOpcode::kConditional:
+          case HloOpcode::kTuple:
+          case HloOpcode::kWhile:
+            unordered_reason = absl::StrCat("the loop state may be aliased by ",
+                                            read->name());
+            break;
+          default:
+            if (!HloDataflowAnalysis::GetInPlaceInputOutputPairs(read)
+                     .empty()) {
+              unordered_reason = absl::StrCat(
+                  "the loop state is also used by in-place ", read->name());
+            }
+            break;
+        }
+        if (!unordered_reason.empty()) {
+          break;
+        }
+      }
+      if (!unordered_reason.empty()) {
+        VLOG(2) << "Cannot order the reads of " << element->name()
+                << " before " << in_place_op->name() << ": "
+                << unordered_reason;
+        (*unordered_updates)[in_place_op] = unordered_reason;
+        continue;
+      }
+
+      for (HloInstruction* read : reads) {
+        VLOG(2) << "Ordering " << read->name() << " before in-place "
+                << in_place_op->name();
+        TF_RETURN_IF_ERROR(read->AddControlDependencyTo(in_place_op));
+      }
+      reachability->UpdateReachabilityThroughInstruction(in_place_op);
+    }
+  }
   return Status::OK();
 }
 
@@ -378,7 +527,8 @@ Status AddCopiesForInPlaceOperation(const HloAliasAnalysis& alias_analysis,
 // each aliased parameter to resolve interference of aliased input and output
 // buffer. We later rely on RemoveUnnecessaryCopies to drop the unnecessary
 // ones.
-Status AddCopiesForAliasedInputOutputs(HloModule* module) {
+Status AddCopiesForAliasedInputOutputs(HloModule* module,
+                                       CopyReasons* copy_reasons) {
   HloComputation* entry = module->entry_computation();
   HloInstruction* root = entry->root_instruction();
 
@@ -420,6 +570,11 @@ Status AddCopiesForAliasedInputOutputs(HloModule* module) {
     for (HloInstruction* user : users) {
       TF_RETURN_IF_ERROR(param->ReplaceUseWith(user, copied));
     }
+    RecordCopyReasons(param_copy_tree,
+                      absl::StrCat("entry parameter ",
+                                   param->parameter_number(),
+                                   " aliased with an output"),
+                      copy_reasons);
 
     copied_parameters[param->parameter_number()] = param_copy_tree;
   }
@@ -435,6 +590,8 @@ Status AddCopiesForAliasedInputOutputs(HloModule* module) {
   TF_ASSIGN_OR_RETURN(HloInstruction * root_copied,
                       root->parent()->DeepCopyInstruction(
                           root, &output_indices_to_copy, &output_copy_tree));
+  RecordCopyReasons(output_copy_tree, "entry output aliased with a parameter",
+                    copy_reasons);
 
   // Add control dependencies between the input/output copies.
   TF_RETURN_IF_ERROR(module->input_output_alias_config().ForEachAliasWithStatus(
@@ -1003,6 +1160,18 @@ class CopyRemover {
 // live-range interference. Generally interference can only occur around kWhile
 // instructions which have update-in-place semantics.
 Status CopyInsertion::AddCopiesToResolveInterference(HloModule* module) {
+  // Order the reads of loop-carried elements before their in-place updates
+  // first, since this changes which copies are removable.
+  absl::flat_hash_map<const HloInstruction*, string> unordered_updates;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    for (HloInstruction* instruction : computation->instructions()) {
+      if (instruction->opcode() == HloOpcode::kWhile) {
+        TF_RETURN_IF_ERROR(OrderReadsBeforeInPlaceUpdates(
+            instruction->while_body(), &unordered_updates));
+      }
+    }
+  }
+
   TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
                       HloAliasAnalysis::Run(module, can_share_buffer_));
 
@@ -1010,24 +1179,28 @@ Status CopyInsertion::AddCopiesToResolveInterference(HloModule* module) {
     for (HloInstruction* instruction :
          computation->MakeInstructionPostOrder()) {
       if (instruction->opcode() == HloOpcode::kWhile) {
-        TF_RETURN_IF_ERROR(AddCopiesForWhile(*alias_analysis, instruction));
-      } else if (instruction->opcode() == HloOpcode::kConditional) {
         TF_RETURN_IF_ERROR(
-            AddCopiesForConditional(*alias_analysis, instruction));
+            AddCopiesForWhile(*alias_analysis, instruction, &copy_reasons_));
+      } else if (instruction->opcode() == HloOpcode::kConditional) {
+        TF_RETURN_IF_ERROR(AddCopiesForConditional(*alias_analysis, instruction,
+                                                   &copy_reasons_));
       } else {
         for (const auto& operand_and_output_index :
              HloDataflowAnalysis::GetInPlaceInputOutputPairs(instruction)) {
           const HloUse& operand = operand_and_output_index.first;
           CHECK_EQ(operand.operand_index, ShapeIndex{})
               << "Support for non-{} shape operand not currently implemented.";
+          auto it = unordered_updates.find(instruction);
           TF_RETURN_IF_ERROR(AddCopiesForInPlaceOperation(
-              *alias_analysis, instruction, operand.operand_number));
+              *alias_analysis, instruction, operand.operand_number,
+              it == unordered_updates.end() ? "" : it->second,
+              &copy_reasons_));
         }
       }
     }
   }
 
-  TF_RETURN_IF_ERROR(AddCopiesForAliasedInputOutputs(module));
+  TF_RETURN_IF_ERROR(AddCopiesForAliasedInputOutputs(module, &copy_reasons_));
   return Status::OK();
 }
 
@@ -1044,16 +1217,23 @@ Status CopyInsertion::AddSpecialCaseCopies(const CallGraph& call_graph,
   // Identify which shape indices of which instructions need to be copied. Store
   // these results in 'instructions_to_copy'.
   HloInstructionMap<ShapeTree<bool>> instructions_to_copy;
-  auto add_index_to_copy = [&instructions_to_copy](HloInstruction* instruction,
-                                                   const ShapeIndex& index) {
+  // Why the indices of each instruction in 'instructions_to_copy' are copied.
+  HloInstructionMap<ShapeTree<string>> reasons_to_copy;
+  auto add_index_to_copy = [&](HloInstruction* instruction,
+                               const ShapeIndex& index,
+                               absl::string_view reason) {
     auto it = instructions_to_copy.find(instruction);
     if (it == instructions_to_copy.end()) {
       auto it_added = instructions_to_copy.emplace(
           std::piecewise_construct, std::forward_as_tuple(instruction),
           std::forward_as_tuple(instruction->shape(), /*init_value=*/false));
       it = it_added.first;
+      reasons_to_copy.emplace(std::piecewise_construct,
+                              std::forward_as_tuple(instruction),
+                              std::forward_as_tuple(instruction->shape()));
     }
     *it->second.mutable_element(index) = true;
+    *reasons_to_copy.at(instruction).mutable_element(index) = string(reason);
   };
 
   // Iterate through values of all constants and entry parameters. These values
@@ -1067,7 +1247,8 @@ Status CopyInsertion::AddSpecialCaseCopies(const CallGraph& call_graph,
       VLOG(2) << "Value " << value->ToShortString()
               << " is read only, but its buffer contains more than one value. "
                  "Copying.";
-      add_index_to_copy(value->defining_instruction(), value->defining_index());
+      add_index_to_copy(value->defining_instruction(), value->defining_index(),
+                        "read-only value that shares a buffer");
     }
   }
 
@@ -1105,7 +1286,10 @@ Status CopyInsertion::AddSpecialCaseCopies(const CallGraph& call_graph,
             VLOG(2) << "Output indices " << index.ToString() << " and "
                     << other_index.ToString() << " are both aliased to "
                     << alias->parameter_number << " copying " << other_index;
-            add_index_to_copy(root, other_index);
+            add_index_to_copy(root, other_index,
+                              absl::StrCat("output aliased with parameter ",
+                                           alias->parameter_number,
+                                           " at more than one index"));
             return;
           }
 
@@ -1114,7 +1298,9 @@ Status CopyInsertion::AddSpecialCaseCopies(const CallGraph& call_graph,
             VLOG(2) << "Index " << index << " of computation "
                     << computation->name() << " (" << root->name()
                     << ") has ambiguous or non-distinct buffer. Copying.";
-            add_index_to_copy(root, index);
+            add_index_to_copy(root, index,
+                              absl::StrCat("ambiguous or non-distinct root of ",
+                                           computation->name()));
           }
         });
 
@@ -1128,7 +1314,9 @@ Status CopyInsertion::AddSpecialCaseCopies(const CallGraph& call_graph,
                   << computation->name()
                   << ") has constant or parameter value at index " << index
                   << ". Copying.";
-          add_index_to_copy(root, index);
+          add_index_to_copy(root, index,
+                            absl::StrCat("constant or parameter live out of ",
+                                         computation->name()));
         }
       }
     }
@@ -1150,6 +1338,12 @@ Status CopyInsertion::AddSpecialCaseCopies(const CallGraph& call_graph,
     if (instruction == instruction->parent()->root_instruction()) {
       instruction->parent()->set_root_instruction(deep_copy);
     }
+    const ShapeTree<string>& reasons = reasons_to_copy.at(instruction);
+    for (const auto& copy : copies_added) {
+      if (copy.second != nullptr && copy.second->opcode() == HloOpcode::kCopy) {
+        copy_reasons_[copy.second->unique_id()] = reasons.element(copy.first);
+      }
+    }
   }
   return Status::OK();
 }
@@ -1236,6 +1430,8 @@ StatusOr<bool> CopyInsertion::Run(HloModule* module) {
     return FailedPrecondition(
         "Call graph must be flattened before copy insertion.");
   }
+  copy_reasons_.clear();
+  remaining_copies_.clear();
 
   TF_RETURN_IF_ERROR(AddCopiesToResolveInterference(module));
 
@@ -1262,6 +1458,20 @@ StatusOr<bool> CopyInsertion::Run(HloModule* module) {
   TF_RETURN_IF_ERROR(tuple_simplifier.Run(module).status());
   TF_RETURN_IF_ERROR(dce.Run(module).status());
 
+  // Report the copies added by the pass that could not be removed, which are
+  // the ones worth eliminating in the HLO that is fed to copy insertion.
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    for (HloInstruction* instruction : computation->instructions()) {
+      auto it = copy_reasons_.find(instruction->unique_id());
+      if (instruction->opcode() == HloOpcode::kCopy &&
+          it != copy_reasons_.end()) {
+        VLOG(1) << "Copy " << instruction->name() << " in "
+                << computation->name() << " remains: " << it->second;
+        remaining_copies_.push_back({instruction->name(), it->second});
+      }
+    }
+  }
+
   if (VLOG_IS_ON(1)) {
     int64 num_total_copies = 0;
     for (HloComputation* computation : module->computations()) {
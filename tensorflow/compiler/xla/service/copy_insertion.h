@@ -17,6 +17,10 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_COPY_INSERTION_H_
 
 #include "tensorflow/compiler/xla/service/hlo_alias_analysis.h"
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -38,13 +42,24 @@ namespace xla {
 //       in-place and the update may clobber the value from the previous
 //       iteration before the previous value is dead. Computations called from
 //       kCall instructions do not need such copies because kCall has no update
-//       in-place semantics.
+//       in-place semantics. Within while bodies, the other reads of a
+//       loop-carried element are ordered before in-place updates of that
+//       element (e.g. kDynamicUpdateSlice) where possible, so that the update
+//       runs in place without copying the element.
 //
 //   (3) The buffer set of the root instruction of the entry computation must be
 //       unambiguous and distinct. That is, InstructionAliasSet::IsAmbiguous and
 //       InstructionAliasSet::IsDistinct return true.
 class CopyInsertion : public HloModulePass {
  public:
+  // A copy that the last Run added to the module and could not remove.
+  struct RemainingCopy {
+    string name;
+    // Why the copy was added, e.g. the in-place operation whose operand it
+    // copies and the read that prevented the operation from running in place.
+    string reason;
+  };
+
   absl::string_view name() const override { return "copy-insertion"; }
 
   // backend specific function that decides whether an instruction
@@ -60,6 +75,12 @@ class CopyInsertion : public HloModulePass {
   // (copies were inserted).
   StatusOr<bool> Run(HloModule* module) override;
 
+  // Returns the copies added by the last Run that are left in the module. The
+  // copies are also logged at VLOG level 1.
+  const std::vector<RemainingCopy>& remaining_copies() const {
+    return remaining_copies_;
+  }
+
   // Try to remove as many copies from the module as possible without
   // introducing live range interference. Only copy instructions that are
   // eligible for copy elision are considered for removal.
@@ -89,6 +110,11 @@ class CopyInsertion : public HloModulePass {
 
  private:
   Status AddCopiesToResolveInterference(HloModule* module);
+
+  // Why each copy added by the pass was added, keyed by the unique id of the
+  // copy.
+  absl::flat_hash_map<int, string> copy_reasons_;
+  std::vector<RemainingCopy> remaining_copies_;
 };
 
 }  // namespace xla
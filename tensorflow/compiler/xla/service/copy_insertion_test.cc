@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <set>
 
+#include "absl/strings/match.h"
 #include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
@@ -2782,5 +2783,115 @@ ENTRY main {
   EXPECT_EQ(CountCopies(*module), 1);
 }
 
+TEST_F(CopyInsertionTest, WhileDynamicUpdateSliceOfLoopStateNoCopy) {
+  // The cache is read by the add and updated in place by the
+  // dynamic-update-slice. Ordering the add before the update avoids copying
+  // the cache in every iteration.
+  absl::string_view hlo_string = R"(
+HloModule Module
+
+body {
+  state = (s32[], f32[8,4], f32[8,4]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  cache = f32[8,4] get-tuple-element(state), index=1
+  acc = f32[8,4] get-tuple-element(state), index=2
+  acc.1 = f32[8,4] add(acc, cache)
+  zero = s32[] constant(0)
+  value = f32[] convert(i)
+  update = f32[1,4] broadcast(value), dimensions={}
+  cache.1 = f32[8,4] dynamic-update-slice(cache, update, i, zero)
+  one = s32[] constant(1)
+  i.1 = s32[] add(i, one)
+  ROOT tuple = (s32[], f32[8,4], f32[8,4]) tuple(i.1, cache.1, acc.1)
+}
+
+cond {
+  state = (s32[], f32[8,4], f32[8,4]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(8)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+ENTRY main {
+  zero = s32[] constant(0)
+  cache = f32[8,4] parameter(0)
+  acc = f32[8,4] parameter(1)
+  init = (s32[], f32[8,4], f32[8,4]) tuple(zero, cache, acc)
+  ROOT while = (s32[], f32[8,4], f32[8,4]) while(init), condition=cond, body=body
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  CopyInsertion copy_insertion;
+  ASSERT_IS_OK(copy_insertion.Run(module.get()).status());
+
+  // Only the induction variable, which is read by the update while it is
+  // incremented, may still be copied.
+  const HloComputation* body = module->GetComputationWithName("body");
+  for (const HloInstruction* instruction : body->instructions()) {
+    if (instruction->opcode() == HloOpcode::kCopy) {
+      EXPECT_TRUE(ShapeUtil::IsScalar(instruction->shape()))
+          << instruction->ToString();
+    }
+  }
+  const HloInstruction* update = FindInstruction(module.get(), "cache.1");
+  EXPECT_THAT(update->control_predecessors(),
+              UnorderedElementsAre(FindInstruction(module.get(), "acc.1")));
+}
+
+TEST_F(CopyInsertionTest, WhileDynamicUpdateSliceReadAfterUpdateCopy) {
+  // The old cache is read together with the updated one, so the update cannot
+  // run in place.
+  absl::string_view hlo_string = R"(
+HloModule Module
+
+body {
+  state = (s32[], f32[8,4], f32[8,4]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  cache = f32[8,4] get-tuple-element(state), index=1
+  zero = s32[] constant(0)
+  value = f32[] convert(i)
+  update = f32[1,4] broadcast(value), dimensions={}
+  cache.1 = f32[8,4] dynamic-update-slice(cache, update, i, zero)
+  delta = f32[8,4] subtract(cache.1, cache)
+  one = s32[] constant(1)
+  i.1 = s32[] add(i, one)
+  ROOT tuple = (s32[], f32[8,4], f32[8,4]) tuple(i.1, cache.1, delta)
+}
+
+cond {
+  state = (s32[], f32[8,4], f32[8,4]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(8)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+ENTRY main {
+  zero = s32[] constant(0)
+  cache = f32[8,4] parameter(0)
+  delta = f32[8,4] parameter(1)
+  init = (s32[], f32[8,4], f32[8,4]) tuple(zero, cache, delta)
+  ROOT while = (s32[], f32[8,4], f32[8,4]) while(init), condition=cond, body=body
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  CopyInsertion copy_insertion;
+  ASSERT_IS_OK(copy_insertion.Run(module.get()).status());
+
+  HloComputation* body = module->GetComputationWithName("body");
+  EXPECT_TRUE(
+      FindInstruction(module.get(), "cache.1")->control_predecessors().empty());
+  bool reported = false;
+  for (const auto& copy : copy_insertion.remaining_copies()) {
+    if (body->GetInstructionWithName(copy.name) != nullptr &&
+        absl::StrContains(copy.reason, "in-place cache.1") &&
+        absl::StrContains(copy.reason, "read by delta after the update")) {
+      reported = true;
+    }
+  }
+  EXPECT_TRUE(reported);
+}
+
 }  // namespace
 }  // namespace xla
@@ -23,6 +23,8 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SmallVectorMemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -42,7 +45,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
 
 namespace xla {
 namespace cpu {
@@ -80,8 +87,93 @@ class FilteredPassManager : public llvm::legacy::PassManager {
 };
 }  // anonymous namespace
 
+std::string CompilerFunctor::ObjectCachePath(const llvm::Module& module) const {
+  // Everything that influences code generation besides the module itself has
+  // to be part of the key, so that a cache directory shared between hosts never
+  // serves an object file built for a different CPU.
+  const llvm::TargetOptions& target_options = target_machine_->Options;
+  std::string target_key = absl::StrCat(
+      target_machine_->getTargetTriple().str(), ";",
+      target_machine_->getTargetCPU().str(), ";",
+      target_machine_->getTargetFeatureString().str(), ";", opt_level_, ";",
+      optimize_for_size_, ";", disable_expensive_passes_, ";",
+      fast_math_flags_.allowReassoc(), fast_math_flags_.noNaNs(),
+      fast_math_flags_.noInfs(), fast_math_flags_.noSignedZeros(),
+      fast_math_flags_.allowReciprocal(), fast_math_flags_.allowContract(),
+      fast_math_flags_.approxFunc(), ";", target_options.UnsafeFPMath,
+      target_options.NoInfsFPMath, target_options.NoNaNsFPMath,
+      target_options.NoSignedZerosFPMath);
+  uint64 fingerprint = tensorflow::FingerprintCat64(
+      tensorflow::Fingerprint64(llvm_ir::DumpModuleToString(module)),
+      tensorflow::Fingerprint64(target_key));
+  return tensorflow::io::JoinPath(
+      object_cache_dir_,
+      absl::StrCat("xla_cpu_", absl::Hex(fingerprint, absl::kZeroPad16), ".o"));
+}
+
+void CompilerFunctor::RunPostCodegenHook(
+    const llvm::MemoryBuffer& memory_buffer) const {
+  if (!post_codegen_hook_) {
+    return;
+  }
+  llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
+      llvm::object::ObjectFile::createObjectFile(memory_buffer);
+  if (obj_file) {
+    post_codegen_hook_(*obj_file.get());
+  } else {
+    llvm::consumeError(obj_file.takeError());
+    LOG(WARNING) << "Could convert memory buffer to object file!";
+  }
+}
+
+namespace {
+
+// Writes `memory_buffer` to `path` through a temporary file, so that concurrent
+// readers never observe a partially written object file.  Failures only cost
+// the cache entry and are therefore not propagated.
+void WriteToObjectCache(const std::string& path,
+                        const llvm::MemoryBuffer& memory_buffer) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  std::string tmp_path = path;
+  tensorflow::Status status =
+      env->RecursivelyCreateDir(std::string(tensorflow::io::Dirname(path)));
+  if (status.ok() && !env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    status = tensorflow::errors::Internal(
+        "Unable to create a unique file name for ", path);
+  }
+  if (status.ok()) {
+    status = tensorflow::WriteStringToFile(
+        env, tmp_path,
+        absl::string_view(memory_buffer.getBufferStart(),
+                          memory_buffer.getBufferSize()));
+  }
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write XLA CPU object cache entry " << path
+                 << ": " << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
+}  // namespace
+
 llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
     llvm::Module& module) {
+  std::string object_cache_path;
+  if (!object_cache_dir_.empty()) {
+    object_cache_path = ObjectCachePath(module);
+    // Large files are memory-mapped rather than read.
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> cached_object =
+        llvm::MemoryBuffer::getFile(object_cache_path);
+    if (cached_object) {
+      VLOG(1) << "Loaded object file from " << object_cache_path;
+      RunPostCodegenHook(**cached_object);
+      return std::move(*cached_object);
+    }
+  }
+
   FilteredPassManager module_passes(disable_expensive_passes_);
   llvm::legacy::FunctionPassManager function_passes(&module);
 
@@ -145,14 +237,10 @@ llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompilerFunctor::operator()(
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer(
       new llvm::SmallVectorMemoryBuffer(std::move(stream_buffer)));
 
-  if (post_codegen_hook_) {
-    llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
-        llvm::object::ObjectFile::createObjectFile(*memory_buffer);
-    if (obj_file) {
-      post_codegen_hook_(*obj_file.get());
-    } else {
-      LOG(WARNING) << "Could convert memory buffer to object file!";
-    }
+  RunPostCodegenHook(*memory_buffer);
+
+  if (!object_cache_path.empty()) {
+    WriteToObjectCache(object_cache_path, *memory_buffer);
   }
 
   return std::move(memory_buffer);
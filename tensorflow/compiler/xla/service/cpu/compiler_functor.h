@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_COMPILER_FUNCTOR_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_COMPILER_FUNCTOR_H_
 
+#include <string>
+
 #include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
@@ -39,7 +41,8 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
       LLVMCompiler::ModuleHook pre_optimization_hook = nullptr,
       LLVMCompiler::ModuleHook post_optimization_hook = nullptr,
       std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook =
-          nullptr)
+          nullptr,
+      std::string object_cache_dir = "")
       : IRCompiler(llvm::orc::IRSymbolMapper::ManglingOptions()),
         target_machine_(target_machine),
         opt_level_(opt_level),
@@ -48,9 +51,15 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
         fast_math_flags_(fast_math_flags),
         pre_optimization_hook_(std::move(pre_optimization_hook)),
         post_optimization_hook_(std::move(post_optimization_hook)),
-        post_codegen_hook_(std::move(post_codegen_hook)) {}
+        post_codegen_hook_(std::move(post_codegen_hook)),
+        object_cache_dir_(std::move(object_cache_dir)) {}
 
   // Compile a Module to an ObjectFile.
+  //
+  // If an object cache directory was given, the object file is first looked up
+  // there under a key derived from the unoptimized module and the target, and
+  // freshly compiled object files are written back to it.  The optimization
+  // hooks are not run for modules served from the cache.
   llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> operator()(
       llvm::Module& module) override;
 
@@ -64,6 +73,12 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
                              llvm::legacy::FunctionPassManager* function_passes,
                              unsigned opt_level, unsigned size_level) const;
 
+  // Returns the path under object_cache_dir_ at which the object file for
+  // `module` is cached.
+  std::string ObjectCachePath(const llvm::Module& module) const;
+
+  void RunPostCodegenHook(const llvm::MemoryBuffer& memory_buffer) const;
+
   llvm::TargetMachine* target_machine_;
   const unsigned opt_level_;
   const bool optimize_for_size_;
@@ -72,6 +87,7 @@ class CompilerFunctor : public llvm::orc::IRCompileLayer::IRCompiler {
   LLVMCompiler::ModuleHook pre_optimization_hook_;
   LLVMCompiler::ModuleHook post_optimization_hook_;
   std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook_;
+  const std::string object_cache_dir_;
 };
 
 }  // namespace cpu
@@ -26,6 +26,7 @@ const char* const kLlvmIrDotTilingFactor = "xla_llvm_dot_tiling_factor";
 const char* const kXlaForceEnableExperimentalLlvmIrGemm =
     "xla_force_enable_experimental_llvm_ir_gemm";
 const char* const kLlvmIrGemmTileSize = "xla_llvm_ir_gemm_tile_size";
+const char* const kXlaCpuObjectCacheDir = "xla_cpu_object_cache_dir";
 
 }  // namespace
 
@@ -99,6 +100,16 @@ absl::optional<std::tuple<int64, int64, int64>> LlvmIrGemmTileSize(
                                          tile_size_n_in_vector_width);
 }
 
+absl::optional<string> ObjectCacheDir(const HloModuleConfig& config) {
+  const auto& extra_options_map =
+      config.debug_options().xla_backend_extra_options();
+  auto it = extra_options_map.find(kXlaCpuObjectCacheDir);
+  if (it == extra_options_map.end() || it->second.empty()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
 }  // namespace options
 }  // namespace cpu
 }  // namespace xla
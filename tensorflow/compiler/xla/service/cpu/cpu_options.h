@@ -31,6 +31,10 @@ absl::optional<int64> LlvmIrGemvTilingFactor(const HloModuleConfig& config);
 absl::optional<std::tuple<int64, int64, int64>> LlvmIrGemmTileSize(
     const HloModuleConfig& config);
 
+// Directory in which the JIT persists the object files it generates, keyed by
+// the LLVM module and target.  Returns nullopt if the object cache is disabled.
+absl::optional<string> ObjectCacheDir(const HloModuleConfig& config);
+
 }  // namespace options
 }  // namespace cpu
 }  // namespace xla
@@ -974,22 +974,23 @@ bool CanEmitTiledLlvmIrGemm(
     const TargetMachineFeatures& target_machine_features) {
   CHECK(IsAlignedGemm(dot_info, target_machine_features));
 
-  if (ShouldUseMultiThreadedEigen(config)) {
-    return false;
-  }
-
   int m = dot_info.result_shape.dimensions(0);
   int k = dot_info.lhs_shape.dimensions(
       dot_info.dim_nums.lhs_contracting_dimensions(0));
   int n = dot_info.result_shape.dimensions(1);
 
-  if (!options::ForceEnableExperimentalLlvmIrGemm(config)) {
-    // TODO(sanjoy):  We should make these numbers micro-arch specific.
-    bool small_gemm =
-        k <= 128 && ((m <= 32 && n <= 128) || (m <= 128 && n <= 32));
-    if (!small_gemm) {
-      return false;
-    }
+  // TODO(sanjoy):  We should make these numbers micro-arch specific.
+  bool small_gemm =
+      k <= 128 && ((m <= 32 && n <= 128) || (m <= 128 && n <= 32));
+
+  // Small GEMMs are emitted inline even if Eigen is allowed to use multiple
+  // threads: they take only a few microseconds, so the overhead of
+  // dispatching them to the Eigen thread pool outweighs the parallel speedup.
+  // The inline kernel is vectorized for the widest vector registers of the
+  // target (e.g. AVX-512), see GetMlirGemmTileSize.
+  if (!small_gemm && (ShouldUseMultiThreadedEigen(config) ||
+                      !options::ForceEnableExperimentalLlvmIrGemm(config))) {
+    return false;
   }
 
   bool lhs_canonical = dot_info.dim_nums.lhs_contracting_dimensions(0) == 1;
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
@@ -24,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace xla {
 namespace cpu {
@@ -49,61 +55,134 @@ class SimpleCostModel : public ParallelCostModel {
   const HloCostAnalysis::ShapeSizeFunction shape_size_;
 };
 
+namespace {
+
+// Single-core throughput of the host, used to convert the flops and bytes
+// computed by HloCostAnalysis into time.
+struct HostThroughput {
+  double flops_per_second;
+  double bytes_per_second;
+};
+
+// Measures the single-core throughput of the host with a microbenchmark that
+// takes a few milliseconds. The arithmetic throughput is that of scalar code,
+// so it underestimates vectorized loops; this is fine since it is only used to
+// decide whether an instruction is compute or memory bound and to estimate
+// its run time to within a small factor.
+HostThroughput MeasureHostThroughput() {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  HostThroughput throughput;
+
+  // Arithmetic throughput: independent chains of multiply-adds.
+  constexpr int kNumChains = 8;
+  constexpr int64 kIterations = 1 << 18;
+  float chains[kNumChains];
+  for (int i = 0; i < kNumChains; ++i) {
+    chains[i] = i;
+  }
+  uint64 start_ns = env->NowNanos();
+  for (int64 i = 0; i < kIterations; ++i) {
+    for (int j = 0; j < kNumChains; ++j) {
+      chains[j] = chains[j] * 0.999f + 0.001f;
+    }
+  }
+  uint64 elapsed_ns = std::max<uint64>(1, env->NowNanos() - start_ns);
+  throughput.flops_per_second = 2.0 * kNumChains * kIterations * 1e9 /
+                                static_cast<double>(elapsed_ns);
+
+  // Memory throughput: a sum over a buffer larger than typical L2 caches,
+  // again with independent chains so that it isn't latency bound.
+  std::vector<float> buffer(4 << 20, 1.0f);
+  start_ns = env->NowNanos();
+  for (int64 i = 0; i + kNumChains <= buffer.size(); i += kNumChains) {
+    for (int j = 0; j < kNumChains; ++j) {
+      chains[j] += buffer[i + j];
+    }
+  }
+  elapsed_ns = std::max<uint64>(1, env->NowNanos() - start_ns);
+  throughput.bytes_per_second = buffer.size() * sizeof(float) * 1e9 /
+                                static_cast<double>(elapsed_ns);
+
+  // Keep the compiler from optimizing the loops away.
+  volatile float sink = std::accumulate(chains, chains + kNumChains, 0.0f);
+  (void)sink;
+
+  // Guard against timer glitches on heavily loaded hosts.
+  throughput.flops_per_second =
+      std::min(std::max(throughput.flops_per_second, 1e8), 1e11);
+  throughput.bytes_per_second =
+      std::min(std::max(throughput.bytes_per_second, 1e9), 1e11);
+  VLOG(1) << "Host throughput: " << throughput.flops_per_second
+          << " flops/s, " << throughput.bytes_per_second << " bytes/s";
+  return throughput;
+}
+
+// Returns the throughput of the host, measured once per process.
+const HostThroughput& GetHostThroughput() {
+  static const HostThroughput* throughput =
+      new HostThroughput(MeasureHostThroughput());
+  return *throughput;
+}
+
+}  // namespace
+
 class DefaultCostModel : public ParallelCostModel {
  public:
   DefaultCostModel(const int64 max_parallelism,
                    const HloCostAnalysis::ShapeSizeFunction& shape_size,
-                   std::unique_ptr<HloCostAnalysis> cost_analysis)
+                   std::unique_ptr<HloCostAnalysis> cost_analysis,
+                   const HostThroughput& host_throughput)
       : max_parallelism_(max_parallelism),
         shape_size_(shape_size),
-        cost_analysis_(std::move(cost_analysis)) {}
+        cost_analysis_(std::move(cost_analysis)),
+        host_throughput_(host_throughput) {}
   ~DefaultCostModel() override {}
 
   int64 GetParallelTaskCount(HloInstruction* instruction) override {
-    // Parameters for parallel task count computation.
-    int64 instruction_cost;
-    int64 min_cost_per_thread;
-    int64 max_parallelism;
-    // Calculate flops-to-bytes-ratio for 'instruction'.
-    const int64 bytes_accessed =
-        std::max(int64{1}, cost_analysis_->bytes_accessed(*instruction));
-    const float flops_to_bytes_ratio =
-        cost_analysis_->flop_count(*instruction) /
-        static_cast<float>(bytes_accessed);
-    // Check for I/O bound instructions.
-    if (flops_to_bytes_ratio <= 1.0) {
+    // Rough number of flops a transcendental function takes.
+    constexpr double kFlopsPerTranscendental = 20;
+    // Overhead of each task dispatched by __xla_cpu_runtime_ParallelForkJoin:
+    // the tasks are enqueued one after another by the calling thread, and
+    // picked up by the (spinning) threads of the intra-op thread pool.
+    constexpr double kForkJoinOverheadSecondsPerTask = 1e-6;
+
+    // Estimate the single-threaded run time of 'instruction' with a roofline
+    // model of the host.
+    const double flops =
+        cost_analysis_->flop_count(*instruction) +
+        kFlopsPerTranscendental *
+            cost_analysis_->transcendental_count(*instruction);
+    const double bytes_accessed = cost_analysis_->bytes_accessed(*instruction);
+    const double compute_seconds = flops / host_throughput_.flops_per_second;
+    const double memory_seconds =
+        bytes_accessed / host_throughput_.bytes_per_second;
+
+    int64 max_parallelism = max_parallelism_;
+    if (memory_seconds >= compute_seconds) {
       // Limit max parallelism for I/O bound instructions by assuming a
       // sub-linear scaling function (fit based on empirical benchmark results).
       // TODO(b/29630486) Develop system bandwidth model.
       max_parallelism = std::min<int64>(
           max_parallelism_,
           std::ceil(std::sqrt(tensorflow::port::MaxParallelism())));
-      // Use shape size instruction cost and L2 cache size min per-thread cost.
-      instruction_cost = shape_size_(instruction->shape());
-      min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
-    } else {
-      // Use max parallelism for compute bound instructions.
-      max_parallelism = max_parallelism_;
-      // Calculate the instruction cost in cycles.
-      // TODO(b/29630486) Improve on this linear cost model.
-      // Consider making 'min_cost_per_thread' be a function of the target
-      // bandwidth limit for instructions with low arithmetic complexity.
-      instruction_cost =
-          1 * cost_analysis_->flop_count(*instruction) +
-          2 * cost_analysis_->transcendental_count(*instruction) +
-          10 * cost_analysis_->bytes_accessed(*instruction);
-      // Minimum per-thread cost is 100us of work on a 2GHz core.
-      min_cost_per_thread = 100000;
     }
-    // Return target parallel task count in [1, max_parallelism_].
-    return std::min(max_parallelism,
-                    std::max(int64{1}, instruction_cost / min_cost_per_thread));
+
+    // Running 'seconds' of work as n tasks takes about
+    //   seconds / n + n * kForkJoinOverheadSecondsPerTask,
+    // which is minimized by
+    //   n = sqrt(seconds / kForkJoinOverheadSecondsPerTask).
+    const double seconds = std::max(compute_seconds, memory_seconds);
+    const int64 task_count = static_cast<int64>(
+        std::sqrt(seconds / kForkJoinOverheadSecondsPerTask));
+    // Return target parallel task count in [1, max_parallelism].
+    return std::min(max_parallelism, std::max(int64{1}, task_count));
   }
 
  private:
   const int64 max_parallelism_;
   const HloCostAnalysis::ShapeSizeFunction shape_size_;
   const std::unique_ptr<HloCostAnalysis> cost_analysis_;
+  const HostThroughput host_throughput_;
 };
 
 ParallelTaskAssignment::ParallelTaskAssignment(
@@ -113,13 +192,22 @@ ParallelTaskAssignment::ParallelTaskAssignment(
     : target_machine_features_(*target_machine_features) {
   VLOG(1) << "ParallelTaskAssignment max_parallelism: " << max_parallelism;
   // Run cost analysis on 'module'.
+  // Analyze all non-fusion computations, so that instructions in while
+  // bodies and called computations (which AssignParallelTasks also visits)
+  // get costs too.
   auto cost_analysis = absl::make_unique<HloCostAnalysis>(shape_size);
-  HloComputation* computation = module->entry_computation();
-  Status status = computation->root_instruction()->Accept(cost_analysis.get());
+  Status status = Status::OK();
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    status = computation->Accept(cost_analysis.get());
+    if (!status.ok()) {
+      break;
+    }
+  }
   if (status.ok()) {
     // Set default cost model based on 'cost_analysis'.
     cost_model_.reset(new DefaultCostModel(max_parallelism, shape_size,
-                                           std::move(cost_analysis)));
+                                           std::move(cost_analysis),
+                                           GetHostThroughput()));
   } else {
     // Fall back to a simple cost model based on hlo size and L2 cache size.
     // Note that HloCostAnalysis can returns an error status (likely because
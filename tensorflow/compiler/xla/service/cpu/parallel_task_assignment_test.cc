@@ -205,5 +205,41 @@ TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest,
+       ComputeBoundOperationInWhileBodyParallelized) {
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_while
+    body {
+      body_param = (s32[], f32[2048,2048]) parameter(0)
+      counter = s32[] get-tuple-element(body_param), index=0
+      one = s32[] constant(1)
+      next_counter = s32[] add(counter, one)
+      data = f32[2048,2048] get-tuple-element(body_param), index=1
+      exp = f32[2048,2048] exponential(data)
+      ROOT tuple = (s32[], f32[2048,2048]) tuple(next_counter, exp)
+    }
+
+    condition {
+      condition_param = (s32[], f32[2048,2048]) parameter(0)
+      counter = s32[] get-tuple-element(condition_param), index=0
+      limit = s32[] constant(10)
+      ROOT less_than = pred[] compare(counter, limit), direction=LT
+    }
+
+    ENTRY entry {
+      zero = s32[] constant(0)
+      data = f32[2048,2048] parameter(0)
+      init = (s32[], f32[2048,2048]) tuple(zero, data)
+      ROOT while = (s32[], f32[2048,2048]) while(init), condition=condition,
+        body=body
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+}
+
 }  // namespace
 }  // namespace xla
@@ -92,7 +92,8 @@ SimpleOrcJIT::SimpleOrcJIT(
     bool disable_expensive_passes, llvm::FastMathFlags fast_math_flags,
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
-    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
+    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+    std::string object_cache_dir)
     : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       data_layout_(target_machine_->createDataLayout()),
       target_process_control_(std::move(target_process_control)),
@@ -108,7 +109,8 @@ SimpleOrcJIT::SimpleOrcJIT(
               target_machine_.get(), opt_level, optimize_for_size,
               disable_expensive_passes, fast_math_flags,
               std::move(pre_optimization_hook),
-              std::move(post_optimization_hook), std::move(post_codegen_hook))),
+              std::move(post_optimization_hook), std::move(post_codegen_hook),
+              std::move(object_cache_dir))),
       main_jit_dylib_(&execution_session_->createBareJITDylib("<main>")),
       gdb_jit_event_listener_(
           llvm::JITEventListener::createGDBRegistrationListener()) {
@@ -162,7 +164,8 @@ llvm::Expected<std::unique_ptr<SimpleOrcJIT>> SimpleOrcJIT::Create(
     bool disable_expensive_passes, llvm::FastMathFlags fast_math_flags,
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
-    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook) {
+    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+    std::string object_cache_dir) {
   auto SSP = std::make_shared<llvm::orc::SymbolStringPool>();
   auto target_process_control =
       llvm::orc::SelfTargetProcessControl::Create(std::move(SSP));
@@ -175,7 +178,8 @@ llvm::Expected<std::unique_ptr<SimpleOrcJIT>> SimpleOrcJIT::Create(
       std::move(*target_process_control), std::move(execution_session),
       target_options, opt_level, optimize_for_size, disable_expensive_passes,
       fast_math_flags, std::move(pre_optimization_hook),
-      std::move(post_optimization_hook), std::move(post_codegen_hook));
+      std::move(post_optimization_hook), std::move(post_codegen_hook),
+      std::move(object_cache_dir));
 }
 
 llvm::JITEvaluatedSymbol SimpleOrcJIT::ResolveRuntimeSymbol(
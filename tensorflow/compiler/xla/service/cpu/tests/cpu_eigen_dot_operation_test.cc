@@ -33,6 +33,8 @@ namespace {
 struct DotTestSpec {
   PrimitiveType primitive_type;
   string filecheck_lines;
+  // Expected IR for a dot small enough to be emitted inline.
+  string small_dot_filecheck_lines;
 };
 
 string DotTestSpecToString(const ::testing::TestParamInfo<DotTestSpec>& info) {
@@ -92,14 +94,35 @@ TEST_P(CpuEigenDotOperationTest, DotTransposeOp) {
   CompileAndCheck(builder.Build(), spec.filecheck_lines);
 }
 
+TEST_P(CpuEigenDotOperationTest, SmallDotOp) {
+  HloComputation::Builder builder(TestName());
+  DotTestSpec spec = GetParam();
+
+  auto lhs_shape = ShapeUtil::MakeShape(spec.primitive_type, {16, 64});
+  auto rhs_shape = ShapeUtil::MakeShape(spec.primitive_type, {64, 16});
+  auto result_shape = ShapeUtil::MakeShape(spec.primitive_type, {16, 16});
+
+  HloInstruction* lhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, lhs_shape, "input"));
+  HloInstruction* rhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, rhs_shape, "input"));
+
+  builder.AddInstruction(CreateCanonicalDot(result_shape, lhs, rhs));
+  CompileAndCheck(builder.Build(), spec.small_dot_filecheck_lines);
+}
+
 std::vector<DotTestSpec> GetDotTestCases() {
   std::vector<DotTestSpec> result;
+  // F16 dots are not emitted inline.
   result.push_back(
-      {F16, R"(CHECK: call void @__xla_cpu_runtime_EigenMatMulF16)"});
+      {F16, R"(CHECK: call void @__xla_cpu_runtime_EigenMatMulF16)",
+       R"(CHECK: call void @__xla_cpu_runtime_EigenMatMulF16)"});
   result.push_back(
-      {F32, R"(CHECK: call void @__xla_cpu_runtime_EigenMatMulF32)"});
+      {F32, R"(CHECK: call void @__xla_cpu_runtime_EigenMatMulF32)",
+       R"(CHECK-NOT: call void @__xla_cpu_runtime_EigenMatMulF32)"});
   result.push_back(
-      {F64, R"(CHECK: call void @__xla_cpu_runtime_EigenMatMulF64)"});
+      {F64, R"(CHECK: call void @__xla_cpu_runtime_EigenMatMulF64)",
+       R"(CHECK-NOT: call void @__xla_cpu_runtime_EigenMatMulF64)"});
   return result;
 }
 
@@ -0,0 +1,70 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuObjectCacheTest : public CpuCodegenTest {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    (*debug_options.mutable_xla_backend_extra_options())
+        ["xla_cpu_object_cache_dir"] = cache_dir_;
+    return debug_options;
+  }
+
+  const std::string cache_dir_ =
+      tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), "object_cache");
+};
+
+TEST_F(CpuObjectCacheTest, ReusesCachedObjectFile) {
+  const char* const hlo_text = R"(
+HloModule ObjectCache
+
+ENTRY main {
+  x = f32[128] parameter(0)
+  y = f32[128] parameter(1)
+  add = f32[128] add(x, y)
+  ROOT tanh = f32[128] tanh(add)
+}
+)";
+
+  // The second compilation of the same module is served from the cache
+  // populated by the first one and must still produce correct results.
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                            ParseAndReturnVerifiedModule(hlo_text));
+    EXPECT_TRUE(RunAndCompare(std::move(module), ErrorSpec{1e-5, 1e-5}));
+  }
+
+  std::vector<std::string> cached_objects;
+  TF_ASSERT_OK(
+      tensorflow::Env::Default()->GetChildren(cache_dir_, &cached_objects));
+  EXPECT_EQ(cached_objects.size(), 1);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/activation_offloader.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Returns whether the buffer defined by `hlo` may be moved to host memory.
+// Instructions that only forward their operands' buffers, parameters (whose
+// buffers belong to the caller) and constants are left alone.
+bool IsOffloadCandidate(const HloInstruction& hlo, int64 min_size_bytes) {
+  switch (hlo.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return false;
+    default:
+      break;
+  }
+  const Shape& shape = hlo.shape();
+  return shape.IsArray() && shape.has_layout() &&
+         shape.layout().memory_space() != kHostMemorySpace &&
+         ShapeUtil::ByteSizeOf(shape) >= min_size_bytes;
+}
+
+}  // namespace
+
+StatusOr<bool> ActivationOffloader::Run(HloModule* module) {
+  HloComputation* computation = module->entry_computation();
+  const std::vector<HloInstruction*> sequence =
+      computation->MakeInstructionPostOrder();
+  absl::flat_hash_map<const HloInstruction*, int64> position;
+  for (int64 i = 0; i < sequence.size(); ++i) {
+    position[sequence[i]] = i;
+  }
+
+  bool changed = false;
+  for (HloInstruction* producer : sequence) {
+    if (!IsOffloadCandidate(*producer, min_size_bytes_) ||
+        producer == computation->root_instruction()) {
+      continue;
+    }
+    const int64 producer_position = position.at(producer);
+    std::vector<HloInstruction*> far_users;
+    int64 first_far_position = sequence.size();
+    for (HloInstruction* user : producer->users()) {
+      auto it = position.find(user);
+      if (it != position.end() &&
+          it->second - producer_position >= min_distance_) {
+        far_users.push_back(user);
+        first_far_position = std::min(first_far_position, it->second);
+      }
+    }
+    if (far_users.empty()) {
+      continue;
+    }
+
+    Shape host_shape = producer->shape();
+    host_shape.mutable_layout()->set_memory_space(kHostMemorySpace);
+    HloInstruction* to_host = computation->AddInstruction(
+        HloInstruction::CreateUnary(host_shape, HloOpcode::kCopy, producer));
+    HloInstruction* to_device =
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            producer->shape(), HloOpcode::kCopy, to_host));
+    for (HloInstruction* user : far_users) {
+      TF_RETURN_IF_ERROR(producer->ReplaceUseWith(user, to_device));
+    }
+
+    // Every instruction before the first far user in the post order is
+    // independent of it, so this control edge cannot create a cycle.
+    HloInstruction* anchor = sequence[std::max(
+        producer_position, first_far_position - prefetch_distance_)];
+    if (anchor != producer) {
+      TF_RETURN_IF_ERROR(anchor->AddControlDependencyTo(to_device));
+    }
+    VLOG(2) << "Offloading " << producer->name() << " ("
+            << ShapeUtil::ByteSizeOf(producer->shape()) << " bytes) to host "
+            << "memory for " << far_users.size() << " distant user(s)";
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
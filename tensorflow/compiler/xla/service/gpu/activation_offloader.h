@@ -0,0 +1,56 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_ACTIVATION_OFFLOADER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_ACTIVATION_OFFLOADER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Moves large values of the entry computation that are idle for a long stretch
+// of the program, such as forward activations kept until backprop, to pinned
+// host memory. The value is copied to the host memory space right after it is
+// produced, and copied back shortly before its first distant user. Users that
+// are close to the producer keep reading the device buffer.
+//
+// Distances are measured in the post order of the entry computation, which is
+// a proxy for the launch order chosen later. The copy back is tied to the
+// instruction `prefetch_distance` steps before its first user by a control
+// dependency, so that it is not hoisted back next to the producer.
+class ActivationOffloader : public HloModulePass {
+ public:
+  explicit ActivationOffloader(int64 min_size_bytes, int64 min_distance = 64,
+                               int64 prefetch_distance = 4)
+      : min_size_bytes_(min_size_bytes),
+        min_distance_(min_distance),
+        prefetch_distance_(prefetch_distance) {}
+
+  absl::string_view name() const override { return "activation-offloader"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 min_size_bytes_;
+  const int64 min_distance_;
+  const int64 prefetch_distance_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_ACTIVATION_OFFLOADER_H_
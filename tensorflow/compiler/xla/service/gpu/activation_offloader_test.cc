@@ -0,0 +1,87 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/activation_offloader.h"
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+using ActivationOffloaderTest = HloTestBase;
+
+constexpr char kHloString[] = R"(
+HloModule Offload
+
+ENTRY main {
+  p0 = f32[1024]{0} parameter(0)
+  act = f32[1024]{0} exponential(p0)
+  n1 = f32[1024]{0} negate(act)
+  n2 = f32[1024]{0} negate(n1)
+  n3 = f32[1024]{0} negate(n2)
+  n4 = f32[1024]{0} negate(n3)
+  n5 = f32[1024]{0} negate(n4)
+  n6 = f32[1024]{0} negate(n5)
+  ROOT add = f32[1024]{0} add(act, n6)
+})";
+
+TEST_F(ActivationOffloaderTest, OffloadsValueWithDistantUser) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  ActivationOffloader offloader(/*min_size_bytes=*/1024, /*min_distance=*/4,
+                                /*prefetch_distance=*/1);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* act = FindInstruction(module.get(), "act");
+  HloInstruction* n1 = FindInstruction(module.get(), "n1");
+  HloInstruction* n6 = FindInstruction(module.get(), "n6");
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Add(op::Copy(op::Copy(act)), n6));
+  // The nearby user keeps reading the device buffer.
+  EXPECT_THAT(n1, op::Negate(act));
+
+  const HloInstruction* to_device = root->operand(0);
+  const HloInstruction* to_host = to_device->operand(0);
+  EXPECT_EQ(to_host->shape().layout().memory_space(), kHostMemorySpace);
+  EXPECT_EQ(to_device->shape().layout().memory_space(), 0);
+  // The copy back is not issued before the instruction preceding the user.
+  EXPECT_THAT(to_device->control_predecessors(), ::testing::ElementsAre(n6));
+}
+
+TEST_F(ActivationOffloaderTest, IgnoresSmallValues) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  ActivationOffloader offloader(/*min_size_bytes=*/1 << 20, /*min_distance=*/4);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(ActivationOffloaderTest, IgnoresNearbyUsers) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  ActivationOffloader offloader(/*min_size_bytes=*/1024, /*min_distance=*/16);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
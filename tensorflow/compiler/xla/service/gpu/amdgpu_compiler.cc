@@ -122,21 +122,26 @@ AMDGPUCompiler::CompileTargetBinary(const HloModuleConfig& module_config,
     rocdl_dir_ = GetROCDLDir(module_config);
   }
 
-  if (relocatable) {
-    return Unimplemented("relocatable target binary is not implemented");
-  }
-
   std::vector<uint8> hsaco;
   {
     XLA_SCOPED_LOGGING_TIMER(
         "AMDGPUCompiler::CompileTargetBinary - CompileToHsaco");
     TF_ASSIGN_OR_RETURN(
         hsaco, amdgpu::CompileToHsaco(llvm_module, gpu_version, module_config,
-                                      rocdl_dir_));
+                                      rocdl_dir_, relocatable));
   }
 
   return std::pair<std::string, std::vector<uint8>>("", std::move(hsaco));
 }
 
+StatusOr<std::vector<uint8>> AMDGPUCompiler::LinkModules(
+    se::StreamExecutor* stream_exec, std::vector<std::vector<uint8>> modules) {
+  if (modules.empty()) {
+    return std::vector<uint8>();
+  }
+  XLA_SCOPED_LOGGING_TIMER("AMDGPUCompiler::LinkModules");
+  return amdgpu::LinkHsacoObjects(modules);
+}
+
 }  // namespace gpu
 }  // namespace xla
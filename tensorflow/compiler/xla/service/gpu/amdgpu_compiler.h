@@ -45,6 +45,10 @@ class AMDGPUCompiler : public GpuCompiler {
       const HloModule* debug_module) override;
 
  private:
+  StatusOr<std::vector<uint8>> LinkModules(
+      se::StreamExecutor* stream_exec,
+      std::vector<std::vector<uint8>> modules) override;
+
   // The parent directory of ROCm-Device-Libs IR libraries.
   string rocdl_dir_;
 
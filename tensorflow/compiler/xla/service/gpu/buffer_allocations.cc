@@ -42,6 +42,11 @@ Status BufferAllocations::TearDown(
   for (BufferAllocation::Index i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = allocations[i];
     se::DeviceMemoryBase buffer_address = GetDeviceAddress(allocation.index());
+    // Host memory buffers are not owned by `memory_allocator_`; GpuExecutable
+    // releases them.
+    if (allocation.color() == kHostMemorySpace) {
+      continue;
+    }
     // Deallocate buffers marked "maybe_live_out" but aren't actually live out,
     // and temp buffers.
     if ((allocation.maybe_live_out() &&
@@ -68,7 +68,7 @@ class BufferAllocations {
       const BufferAllocation::Slice& buffer_slice) const;
 
   // Tears down all buffers allocated by this object that are not in
-  // `live_addresses`.
+  // `live_addresses`. Buffers in the host memory space are skipped.
   Status TearDown(const std::set<se::DeviceMemoryBase>& live_addresses,
                   absl::Span<const BufferAllocation> allocations);
 
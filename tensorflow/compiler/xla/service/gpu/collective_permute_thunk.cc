@@ -18,6 +18,7 @@ limitations under the License.
 #include <chrono>  // NOLINT (required by TF interfaces)
 #include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -63,23 +64,27 @@ void WaitAndLogIfStuck(tensorflow::BlockingCounter* counter,
 
 // Key for looking up a Rendezvous object in our global map.
 //
-// Morally, the key is just a RunId.  num_participants is in this struct only
-// because we use that information when constructing the Rendezvous.
+// Morally, the key is a RunId plus the group of devices permuting among
+// themselves: the replica for a cross-partition permute, or the partition for
+// a cross-replica one.  num_participants is in this struct only because we use
+// that information when constructing the Rendezvous.
 struct RendezvousKey {
   RunId run_id;
+  int64 group_id;
   int num_participants;  // int, not int64, to match BlockingCounter's counter.
 
   string ToString() const {
-    return absl::StrFormat("RendezvousKey{run_id=%s, num_participants=%d}",
-                           run_id.ToString(), num_participants);
+    return absl::StrFormat(
+        "RendezvousKey{run_id=%s, group_id=%d, num_participants=%d}",
+        run_id.ToString(), group_id, num_participants);
   }
 
   template <typename H>
   friend H AbslHashValue(H h, const RendezvousKey& k) {
-    return H::combine(std::move(h), k.run_id);
+    return H::combine(std::move(h), k.run_id, k.group_id);
   }
   friend bool operator==(const RendezvousKey& a, const RendezvousKey& b) {
-    return a.run_id == b.run_id;
+    return a.run_id == b.run_id && a.group_id == b.group_id;
   }
   friend bool operator!=(const RendezvousKey& a, const RendezvousKey& b) {
     return !(a == b);
@@ -89,14 +94,15 @@ struct RendezvousKey {
 // Information about a thread that's participating in a collective-permute
 // operation.
 struct ParticipantData {
-  int64 replica_id;
+  // Replica id, or partition id for a cross-partition permute.
+  int64 id;
   se::Stream* stream;
 
   se::DeviceMemoryBase src;
   se::DeviceMemoryBase dest;
 
-  // ReplicaIds to which we will copy the data in src.
-  std::vector<int64> dest_replicas;
+  // Ids to which we will copy the data in src.
+  std::vector<int64> dest_ids;
 };
 
 // The set of threads that want to do a collective permute together all pick the
@@ -161,7 +167,7 @@ StatusOr<std::shared_ptr<BlockingCounter>> Rendezvous::SubmitParticipant(
   bool primary;
   {
     tensorflow::mutex_lock lock(mu_);
-    CHECK(participants_.emplace(participant.replica_id, participant).second);
+    CHECK(participants_.emplace(participant.id, participant).second);
 
     // The first thread to acquire the lock is designated as the primary.
     primary = !initialized_;
@@ -180,9 +186,9 @@ StatusOr<std::shared_ptr<BlockingCounter>> Rendezvous::SubmitParticipant(
   all_arrived_.DecrementCount();
   WaitAndLogIfStuck(&all_arrived_, [&] {
     return absl::StrFormat(
-        "participant for replica %d (stream %p, device %d) waiting for all "
+        "participant %d (stream %p, device %d) waiting for all "
         "other participants to arrive: %s",
-        participant.replica_id, participant.stream,
+        participant.id, participant.stream,
         participant.stream->parent()->device_ordinal(), key_.ToString());
   });
 
@@ -193,9 +199,8 @@ StatusOr<std::shared_ptr<BlockingCounter>> Rendezvous::SubmitParticipant(
     tensorflow::mutex_lock lock(mu_);
     for (const auto& kv : participants_) {
       const ParticipantData& src_participant = kv.second;
-      for (int64 dest_replica : src_participant.dest_replicas) {
-        const ParticipantData& dest_participant =
-            participants_.at(dest_replica);
+      for (int64 dest_id : src_participant.dest_ids) {
+        const ParticipantData& dest_participant = participants_.at(dest_id);
         EnqueueCopy(src_participant.src, src_participant.stream,
                     dest_participant.dest, dest_participant.stream);
       }
@@ -223,6 +228,7 @@ CollectivePermuteConfig GetCollectivePermuteConfig(
   CollectivePermuteConfig config;
   auto* collective_permute = Cast<HloCollectivePermuteInstruction>(instr);
   config.source_target_pairs = collective_permute->source_target_pairs();
+  config.cross_partition = collective_permute->channel_id().has_value();
   return config;
 }
 
@@ -238,40 +244,53 @@ Status CollectivePermuteThunk::ExecuteOnStream(const ExecuteParams& params) {
   auto op_profiler =
       params.profiler->MakeScopedInstructionProfiler(profile_index());
 
+  // The rendezvous below only reaches devices driven by this process.
+  if (params.gpu_global_device_ids != nullptr) {
+    return Unimplemented(
+        "Collective-permute across hosts is not supported on GPU.");
+  }
+
+  TF_ASSIGN_OR_RETURN(GlobalDeviceId global_device_id,
+                      params.GetGlobalDeviceId());
+  TF_ASSIGN_OR_RETURN(
+      auto logical_ids,
+      params.device_assn->LogicalIdsForDevice(global_device_id));
+  int64 id = logical_ids.first;
+  int64 group_id = logical_ids.second;
+  int num_participants = params.device_assn->replica_count();
+  if (config_.cross_partition) {
+    std::swap(id, group_id);
+    num_participants = params.device_assn->computation_count();
+  }
+
   // Rendezvous with the threads for all other devices that are participating in
   // this CollectivePermute.
-  RendezvousKey key{params.run_id, params.device_assn->replica_count()};
+  RendezvousKey key{params.run_id, group_id, num_participants};
   auto rendezvous_factory = [](const RendezvousKey& key) {
     return absl::make_unique<Rendezvous>(key);
   };
   std::shared_ptr<Rendezvous> rendezvous =
       GlobalRendezvousMap().GetOrCreateIfAbsent(key, rendezvous_factory);
 
-  TF_ASSIGN_OR_RETURN(GlobalDeviceId global_device_id,
-                      params.GetGlobalDeviceId());
-  TF_ASSIGN_OR_RETURN(int64 replica_id,
-                      params.device_assn->ReplicaIdForDevice(global_device_id));
-
-  // Figure out which replicas our data is copied to.
-  std::vector<int64> dest_replicas;
+  // Figure out which replicas or partitions our data is copied to.
+  std::vector<int64> dest_ids;
   for (const auto& src_dest : config_.source_target_pairs) {
-    if (src_dest.first == replica_id) {
-      dest_replicas.push_back(src_dest.second);
+    if (src_dest.first == id) {
+      dest_ids.push_back(src_dest.second);
     }
   }
 
   auto src_addr = params.buffer_allocations->GetDeviceAddress(src_);
   auto dest_addr = params.buffer_allocations->GetDeviceAddress(dest_);
-  ParticipantData participant{replica_id, params.stream, src_addr, dest_addr,
-                              dest_replicas};
+  ParticipantData participant{id, params.stream, src_addr, dest_addr, dest_ids};
   TF_ASSIGN_OR_RETURN(std::shared_ptr<BlockingCounter> final_sync,
                       rendezvous->SubmitParticipant(participant));
 
-  // If no replica writes into us (i.e. we aren't the target of any copies), our
-  // contract is that we zero our output.
+  // If no participant writes into us (i.e. we aren't the target of any copies),
+  // our contract is that we zero our output.
   if (absl::c_none_of(config_.source_target_pairs,
                       [&](std::pair<int64, int64> src_dest) {
-                        return src_dest.second == replica_id;
+                        return src_dest.second == id;
                       })) {
     params.stream->ThenMemZero(&dest_addr, dest_addr.size());
   }
@@ -288,9 +307,9 @@ Status CollectivePermuteThunk::ExecuteOnStream(const ExecuteParams& params) {
   final_sync->DecrementCount();
   WaitAndLogIfStuck(final_sync.get(), [&] {
     return absl::StrFormat(
-        "participant for replica %d (stream %p, device ordinal %d) waiting for "
+        "participant %d (stream %p, device ordinal %d) waiting for "
         "all threads to drop their reference to the rendezvous: %s",
-        participant.replica_id, participant.stream,
+        participant.id, participant.stream,
         participant.stream->parent()->device_ordinal(), key.ToString());
   });
   return Status::OK();
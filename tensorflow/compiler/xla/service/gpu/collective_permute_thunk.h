@@ -25,7 +25,12 @@ namespace xla {
 namespace gpu {
 
 struct CollectivePermuteConfig {
+  // Pairs of replica ids, or of partition ids if cross_partition is set.
   std::vector<std::pair<int64, int64>> source_target_pairs;
+  // Whether the op has a channel id, in which case data moves between the
+  // partitions of each replica rather than between the replicas of each
+  // partition.
+  bool cross_partition = false;
 };
 
 CollectivePermuteConfig GetCollectivePermuteConfig(const HloInstruction* instr);
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
@@ -42,7 +43,8 @@ namespace gpu {
 using tensorflow::AutotuneResult;
 
 using GemmCacheKey =
-    std::tuple<se::StreamExecutor*, Shape, Shape, Shape, std::string>;
+    std::tuple</* AutotuneDeviceKey(stream_exec) */ std::string,
+               /* GemmCacheKeyFromInstruction() */ std::string>;
 
 static tensorflow::mutex autotune_cache_mu(tensorflow::LINKER_INITIALIZED);
 static auto& autotune_cache TF_GUARDED_BY(autotune_cache_mu) =
@@ -51,6 +53,14 @@ static auto& autotune_cache TF_GUARDED_BY(autotune_cache_mu) =
 static int64 cache_hits TF_GUARDED_BY(autotune_cache_mu) = 0;
 static int64 cache_misses TF_GUARDED_BY(autotune_cache_mu) = 0;
 
+static std::string GemmCacheKeyFromInstruction(
+    const HloInstruction* instr, const GemmBackendConfig& gemm_config) {
+  return absl::StrCat(instr->operand(0)->shape().ToString(true), ", ",
+                      instr->operand(1)->shape().ToString(true), " -> ",
+                      instr->shape().ToString(true), " ",
+                      gemm_config.ShortDebugString());
+}
+
 // Experimentally tries to pick the best algorithm for the given gemm.
 //
 // This may fail under perfectly normal circumstances.  In particular, it will
@@ -231,16 +241,12 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoUncachedGemmAutotune(
 static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
     const HloInstruction* instr, const GemmBackendConfig& gemm_config,
     se::DeviceMemoryAllocator* allocator, se::Stream* stream) {
-  const HloInstruction* lhs = instr->operand(0);
-  const HloInstruction* rhs = instr->operand(1);
-
   // Don't run autotuning concurrently on the same GPU.
   tensorflow::mutex_lock gpu_lock = LockGpu(stream->parent());
 
-
   GemmCacheKey key =
-      std::make_tuple(stream->parent(), lhs->shape(), rhs->shape(),
-                      instr->shape(), gemm_config.SerializeAsString());
+      std::make_tuple(AutotuneDeviceKey(stream->parent()),
+                      GemmCacheKeyFromInstruction(instr, gemm_config));
 
   tensorflow::mutex_lock cache_lock(autotune_cache_mu);
   auto it = autotune_cache.find(key);
@@ -313,6 +319,35 @@ static StatusOr<bool> RunOnComputation(HloComputation* computation,
   return changed;
 }
 
+/*static*/ Status GemmAlgorithmPicker::WriteAutotuneResults(
+    AutotuneResults* results) {
+  tensorflow::mutex_lock cache_lock(autotune_cache_mu);
+  for (const auto& it : autotune_cache) {
+    AutotuneResults::Entry* entry = results->add_gemms();
+    entry->set_device(std::get<0>(it.first));
+    entry->set_hlo(std::get<1>(it.first));
+    // A result without a gemm key records that the generic algorithm is used.
+    if (it.second.has_value()) {
+      entry->mutable_result()->mutable_gemm()->set_algorithm(*it.second);
+    }
+  }
+  return Status::OK();
+}
+
+/*static*/ Status GemmAlgorithmPicker::LoadAutotuneResults(
+    const AutotuneResults& results) {
+  tensorflow::mutex_lock cache_lock(autotune_cache_mu);
+  for (const AutotuneResults::Entry& entry : results.gemms()) {
+    absl::optional<se::blas::AlgorithmType> algorithm;
+    if (entry.result().has_gemm()) {
+      algorithm = entry.result().gemm().algorithm();
+    }
+    autotune_cache.emplace(std::make_tuple(entry.device(), entry.hlo()),
+                           algorithm);
+  }
+  return Status::OK();
+}
+
 StatusOr<bool> GemmAlgorithmPicker::Run(HloModule* module) {
   XLA_SCOPED_LOGGING_TIMER("GemmAlgorithmPicker");
 
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GEMM_ALGORITHM_PICKER_H_
 
 #include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_runner.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -37,6 +38,13 @@ class GemmAlgorithmPicker : public HloModulePass {
 
   StatusOr<bool> Run(HloModule* module) override;
 
+  // Appends the contents of the process-wide autotuning cache to `results`.
+  static Status WriteAutotuneResults(AutotuneResults* results);
+
+  // Adds previously written results to the process-wide autotuning cache.
+  // Entries that are already cached are left unchanged.
+  static Status LoadAutotuneResults(const AutotuneResults& results);
+
  private:
   se::StreamExecutor* stream_exec_;
   se::DeviceMemoryAllocator* allocator_;
@@ -21,7 +21,10 @@ limitations under the License.
 #include <functional>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "llvm/AsmParser/Parser.h"
@@ -52,6 +55,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/dynamic_padder.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
 #include "tensorflow/compiler/xla/service/gather_expander.h"
+#include "tensorflow/compiler/xla/service/gpu/activation_offloader.h"
 #include "tensorflow/compiler/xla/service/gpu/alias_passthrough_params.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_batchnorm_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/fusion_merger.h"
@@ -64,6 +68,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_layout_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
+#include "tensorflow/compiler/xla/service/gpu/hlo_execution_profiler.h"
+#include "tensorflow/compiler/xla/service/gpu/horizontal_dot_batching.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_input_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_loop_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
@@ -103,9 +109,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/reshape_mover.h"
 #include "tensorflow/compiler/xla/service/rng_bit_generator_expander.h"
 #include "tensorflow/compiler/xla/service/rng_expander.h"
+#include "tensorflow/compiler/xla/service/sharding_propagation.h"
 #include "tensorflow/compiler/xla/service/slice_sinker.h"
 #include "tensorflow/compiler/xla/service/slow_operation_alarm.h"
 #include "tensorflow/compiler/xla/service/sort_simplifier.h"
+#include "tensorflow/compiler/xla/service/spmd/spmd_partitioner.h"
 #include "tensorflow/compiler/xla/service/stable_sort_expander.h"
 #include "tensorflow/compiler/xla/service/transpose_folding.h"
 #include "tensorflow/compiler/xla/service/tuple_simplifier.h"
@@ -122,6 +130,7 @@ limitations under the License.
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/platform/subprocess.h"
@@ -145,6 +154,23 @@ GpuCompiler::GpuCompiler(se::Platform::Id platform_id,
 Status GpuCompiler::OptimizeHloModule(
     HloModule* hlo_module, se::StreamExecutor* stream_exec,
     se::DeviceMemoryAllocator* device_allocator) {
+  const int64 num_partitions = hlo_module->config().num_partitions();
+  if (hlo_module->config().use_spmd_partitioning() && num_partitions > 1) {
+    // Partition the sharded module into a per-device program before any of the
+    // backend passes run.  The resulting cross-partition collectives are
+    // lowered to NCCL thunks like their cross-replica counterparts.
+    HloPassPipeline spmd_pipeline("spmd-partitioner");
+    spmd_pipeline.AddInvariantChecker<HloVerifier>(
+        /*layout_sensitive=*/false, /*allow_mixed_precision=*/false);
+    spmd_pipeline.AddPass<CallInliner>();
+    spmd_pipeline.AddPass<ZeroSizedHloElimination>();
+    spmd_pipeline.AddPass<ShardingPropagation>(/*is_spmd=*/true);
+    spmd_pipeline.AddPass<spmd::SpmdPartitioner>(
+        num_partitions, hlo_module->config().replica_count(),
+        spmd::SpmdPartitionerOptions());
+    TF_RETURN_IF_ERROR(spmd_pipeline.Run(hlo_module).status());
+  }
+
   {
     HloPassPipeline pipeline("optimization");
     pipeline.AddInvariantChecker<HloVerifier>(/*layout_sensitive=*/false,
@@ -254,6 +280,9 @@ Status GpuCompiler::OptimizeHloModule(
                      ? candidate_operands
                      : TransposeFolding::OperandIndices{};
         });
+    // Batch small independent dots into batched gemms. This runs after
+    // TransposeFolding so that the dots have their final dimension numbers.
+    pipeline.AddPass<GpuHorizontalDotBatching>();
     pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/false);
     pipeline.AddPass<HloDCE>();
 
@@ -292,10 +321,22 @@ Status GpuCompiler::OptimizeHloModule(
     TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
   }
 
+  // Autotuning happens in the target-specific passes below; results from
+  // earlier processes let them skip the measurements.
+  const std::string& autotune_results_path =
+      hlo_module->config().debug_options().xla_gpu_autotune_results_path();
+  if (!autotune_results_path.empty()) {
+    TF_RETURN_IF_ERROR(LoadAutotuneResultsFromFile(autotune_results_path));
+  }
+
   // Run target-specific HLO optimization passes after layout assignment.
   TF_RETURN_IF_ERROR(OptimizeHloPostLayoutAssignment(hlo_module, stream_exec,
                                                      device_allocator));
 
+  if (!autotune_results_path.empty()) {
+    TF_RETURN_IF_ERROR(WriteAutotuneResultsToFile(autotune_results_path));
+  }
+
   {
     HloPassFix<HloPassPipeline> fusion("fusion");
     // We try to split variadic ops with many parameters into several such ops
@@ -370,6 +411,13 @@ Status GpuCompiler::PrepareHloModuleForIrEmitting(HloModule* hlo_module) {
   if (hlo_module->config().alias_passthrough_params()) {
     pipeline.AddPass<AliasPassthroughParams>();
   }
+  // Offloading must precede copy insertion, which resolves any interference
+  // between the users of the copied-back values.
+  const int64 host_offload_min_size_mb =
+      hlo_module->config().debug_options().xla_gpu_host_offload_min_size_mb();
+  if (host_offload_min_size_mb > 0) {
+    pipeline.AddPass<ActivationOffloader>(host_offload_min_size_mb << 20);
+  }
   pipeline.AddPass<LoopScheduleLinearizer>(GetCanShareBuffer());
   pipeline.AddPass<GpuCopyInsertion>(GetCanShareBuffer());
   pipeline.AddPass<GpuSanitizeConstantNames>();
@@ -476,6 +524,88 @@ Status GpuCompiler::OptimizeHloPostLayoutAssignment(
   return Status::OK();
 }
 
+Status GpuCompiler::WriteAutotuneResults(AutotuneResults* results) {
+  return GpuConvAlgorithmPicker::WriteAutotuneResults(results);
+}
+
+Status GpuCompiler::LoadAutotuneResults(const AutotuneResults& results) {
+  return GpuConvAlgorithmPicker::LoadAutotuneResults(results);
+}
+
+// Bump when the cache keys written by the autotuning passes change meaning.
+static constexpr int kAutotuneResultsVersion = 1;
+
+static tensorflow::mutex autotune_results_file_mu(
+    tensorflow::LINKER_INITIALIZED);
+static auto& autotune_results_loaded_paths TF_GUARDED_BY(
+    autotune_results_file_mu) = *new absl::flat_hash_set<std::string>();
+// Number of entries last written to each results file.
+static auto& autotune_results_written_entries TF_GUARDED_BY(
+    autotune_results_file_mu) = *new absl::flat_hash_map<std::string, int>();
+
+Status GpuCompiler::LoadAutotuneResultsFromFile(const std::string& path) {
+  tensorflow::mutex_lock lock(autotune_results_file_mu);
+  if (!autotune_results_loaded_paths.insert(path).second) {
+    return Status::OK();
+  }
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (!env->FileExists(path).ok()) {
+    VLOG(1) << "No autotuning results found at " << path;
+    return Status::OK();
+  }
+  AutotuneResults results;
+  Status status = absl::EndsWith(path, ".pbtxt")
+                      ? tensorflow::ReadTextProto(env, path, &results)
+                      : tensorflow::ReadBinaryProto(env, path, &results);
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring unreadable autotuning results in " << path
+                 << ": " << status;
+    return Status::OK();
+  }
+  if (results.version() != kAutotuneResultsVersion) {
+    LOG(WARNING) << "Ignoring autotuning results in " << path
+                 << " with version " << results.version() << ", expected "
+                 << kAutotuneResultsVersion;
+    return Status::OK();
+  }
+  VLOG(1) << "Loading " << results.convs_size() << " conv and "
+          << results.gemms_size() << " gemm autotuning results from " << path;
+  return LoadAutotuneResults(results);
+}
+
+Status GpuCompiler::WriteAutotuneResultsToFile(const std::string& path) {
+  AutotuneResults results;
+  results.set_version(kAutotuneResultsVersion);
+  TF_RETURN_IF_ERROR(WriteAutotuneResults(&results));
+  const int num_entries = results.convs_size() + results.gemms_size();
+
+  tensorflow::mutex_lock lock(autotune_results_file_mu);
+  auto it = autotune_results_written_entries.find(path);
+  if (it != autotune_results_written_entries.end() &&
+      it->second == num_entries) {
+    return Status::OK();
+  }
+  // Write to a temporary file and rename it into place, so that processes
+  // sharing `path` never read a partially written file.
+  tensorflow::Env* env = tensorflow::Env::Default();
+  std::string tmp_path =
+      absl::StrCat(path, ".tmp.", tensorflow::random::New64());
+  Status status = absl::EndsWith(path, ".pbtxt")
+                      ? tensorflow::WriteTextProto(env, tmp_path, results)
+                      : tensorflow::WriteBinaryProto(env, tmp_path, results);
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write autotuning results to " << path << ": "
+                 << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+    return Status::OK();
+  }
+  autotune_results_written_entries[path] = num_entries;
+  return Status::OK();
+}
+
 StatusOr<std::unique_ptr<HloModule>> GpuCompiler::RunHloPasses(
     std::unique_ptr<HloModule> module, se::StreamExecutor* stream_exec,
     const CompileOptions& options) {
@@ -873,7 +1003,9 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
             << tensorflow::strings::HumanReadableNumBytes(
                    cost_analysis.bytes_accessed());
     if (module->config().hlo_profiling_enabled()) {
-      profile_index_map = absl::make_unique<HloProfileIndexMap>(*module);
+      profile_index_map = absl::make_unique<HloProfileIndexMap>(
+          *module, std::vector<std::string>{kStreamsUsedMetric,
+                                            kCrossStreamWaitsMetric});
       profile_printer =
           CreateHloProfilePrinterData(*profile_index_map, cost_analysis,
                                       module->entry_computation()->name());
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
@@ -75,6 +76,13 @@ class GpuCompiler : public LLVMCompiler {
       HloModule* hlo_module, se::StreamExecutor* stream_exec,
       se::DeviceMemoryAllocator* device_allocator);
 
+  // Appends the results cached by this backend's autotuning passes to
+  // `results`.
+  virtual Status WriteAutotuneResults(AutotuneResults* results);
+
+  // Seeds the caches of this backend's autotuning passes from `results`.
+  virtual Status LoadAutotuneResults(const AutotuneResults& results);
+
   virtual HloDataflowAnalysis::CanShareBuffer GetCanShareBuffer() {
     return
         [](const HloInstruction*, const HloInstruction*,
@@ -126,6 +134,14 @@ class GpuCompiler : public LLVMCompiler {
   }
 
  private:
+  // Loads the autotuning results file at `path`, if it exists, the first time
+  // `path` is seen in this process.
+  Status LoadAutotuneResultsFromFile(const std::string& path);
+
+  // Writes all autotuning results known to this process to `path`, if there
+  // are new ones since the last write.
+  Status WriteAutotuneResultsToFile(const std::string& path);
+
   virtual StatusOr<std::vector<uint8>> LinkModules(
       se::StreamExecutor* stream_exec,
       std::vector<std::vector<uint8>> modules) {
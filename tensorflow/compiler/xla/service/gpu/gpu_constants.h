@@ -31,6 +31,10 @@ extern const int64 kXlaAllocatedBufferAlignBytes;
 // Minimum alignment for constant buffers.
 extern const int64 kConstantBufferAlignBytes;
 
+// Layout memory space (and buffer color) of buffers that live in pinned host
+// memory instead of device memory.
+extern const int64 kHostMemorySpace;
+
 }  // namespace gpu
 }  // namespace xla
 
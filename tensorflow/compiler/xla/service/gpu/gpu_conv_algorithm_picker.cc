@@ -252,7 +252,7 @@ StatusOr<bool> CheckRedzones(const se::RedzoneAllocator& allocator,
 #endif
 
 using ConvCacheKey =
-    std::tuple<se::StreamExecutor*,
+    std::tuple</* AutotuneDeviceKey(stream_exec) */ std::string,
                /* conv->ToString(HloPrintOptions::Canonical()) */ std::string>;
 
 struct ConvCacheStats {
@@ -269,7 +269,7 @@ ConvCacheKey AutotuneCacheKeyfromInstruction(
     const HloCustomCallInstruction* conv, se::StreamExecutor* se) {
   auto options = HloPrintOptions::Canonical();
   options.set_print_backend_config(true);
-  return std::make_tuple(se, conv->ToString(options));
+  return std::make_tuple(AutotuneDeviceKey(se), conv->ToString(options));
 }
 
 tensorflow::mutex autotune_cache_lock(tensorflow::LINKER_INITIALIZED);
@@ -340,11 +340,34 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
 
   if (result_or.ok()) {
     tensorflow::mutex_lock lock(autotune_cache_lock);
-    CHECK(autotune_cache.insert({key, result_or.ValueOrDie()}).second);
+    // Results loaded by LoadAutotuneResults() in the meantime take precedence.
+    autotune_cache.insert({key, result_or.ValueOrDie()});
   }
   return result_or;
 }
 
+/*static*/ Status GpuConvAlgorithmPicker::WriteAutotuneResults(
+    AutotuneResults* results) {
+  tensorflow::mutex_lock lock(autotune_cache_lock);
+  for (const auto& it : autotune_cache) {
+    AutotuneResults::Entry* entry = results->add_convs();
+    entry->set_device(std::get<0>(it.first));
+    entry->set_hlo(std::get<1>(it.first));
+    *entry->mutable_result() = it.second;
+  }
+  return Status::OK();
+}
+
+/*static*/ Status GpuConvAlgorithmPicker::LoadAutotuneResults(
+    const AutotuneResults& results) {
+  tensorflow::mutex_lock lock(autotune_cache_lock);
+  for (const AutotuneResults::Entry& entry : results.convs()) {
+    autotune_cache.emplace(std::make_tuple(entry.device(), entry.hlo()),
+                           entry.result());
+  }
+  return Status::OK();
+}
+
 // The following function allows deterministic ops to be implemented relatively
 // quickly using environment variables. It is intended to be temporary. The
 // longer-term intention is to enable deterministic ops via tf.config and
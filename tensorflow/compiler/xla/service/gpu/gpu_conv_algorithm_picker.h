@@ -19,6 +19,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/xla/service/compiler.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_runner.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -47,6 +48,13 @@ class GpuConvAlgorithmPicker : public HloModulePass {
 
   StatusOr<bool> Run(HloModule* module) override;
 
+  // Appends the contents of the process-wide autotuning cache to `results`.
+  static Status WriteAutotuneResults(AutotuneResults* results);
+
+  // Adds previously written results to the process-wide autotuning cache.
+  // Entries that are already cached are left unchanged.
+  static Status LoadAutotuneResults(const AutotuneResults& results);
+
  private:
   StatusOr<bool> RunOnComputation(HloComputation* computation);
   StatusOr<bool> RunOnInstruction(HloInstruction* instr);
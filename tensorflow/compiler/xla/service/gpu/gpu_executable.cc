@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
 
+#include <algorithm>
 #include <set>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/map_util.h"
@@ -176,6 +178,8 @@ Status GpuExecutable::ExecuteThunks(
 
   std::map<const Thunk*, std::unique_ptr<se::Event>> thunk_to_finish_event;
   std::vector<std::function<void()>> deferred_host_callbacks;
+  std::vector<bool> stream_used(thunk_schedule_->StreamCount(), false);
+  int64 cross_stream_waits = 0;
   for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
     // Annotate execution of this op if tracing was enabled when we started
     // running this module.  If tracing is enabled *while* we're running the
@@ -186,8 +190,10 @@ Status GpuExecutable::ExecuteThunks(
     se::Stream* stream =
         (stream_no == 0 ? main_stream : sub_streams[stream_no - 1].get());
 
+    stream_used[stream_no] = true;
     for (const Thunk* dependency : thunk_schedule_->DependsOn(thunk)) {
       stream->ThenWaitFor(FindOrDie(thunk_to_finish_event, dependency).get());
+      ++cross_stream_waits;
     }
 
     VLOG(2) << "Executing the thunk for " << thunk->profile_annotation()
@@ -217,6 +223,9 @@ Status GpuExecutable::ExecuteThunks(
   }
 
   main_stream->ThenWaitFor(&sub_streams);
+  profiler.RecordStreamUsage(
+      std::count(stream_used.begin(), stream_used.end(), true),
+      cross_stream_waits);
 
   std::mutex mx;
   std::condition_variable cond;
@@ -412,6 +421,24 @@ StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
   buffers.reserve(num_buffers);
   for (int64 i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = allocations_[i];
+    if (allocation.color() == kHostMemorySpace) {
+      // Offloaded values live in pinned host memory, which the device reads
+      // and writes through unified addressing.
+      if (!allocation.IsPreallocatedTempBuffer()) {
+        return InternalError(
+            "Host memory allocation %d must be a temporary buffer: %s", i,
+            allocation.ToString());
+      }
+      void* host_buffer = executor->HostMemoryAllocate(allocation.size());
+      if (host_buffer == nullptr && allocation.size() > 0) {
+        return ResourceExhausted(
+            "Failed to allocate %d bytes of pinned host memory for offloaded "
+            "buffers",
+            allocation.size());
+      }
+      buffers.push_back(se::DeviceMemoryBase(host_buffer, allocation.size()));
+      continue;
+    }
     TF_ASSIGN_OR_RETURN(
         se::DeviceMemoryBase buffer,
         BufferForAllocation(arguments, globals, allocation, memory_allocator,
@@ -446,9 +473,13 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   XLA_SCOPED_LOGGING_TIMER(absl::StrCat(
       "GpuExecutable::ExecuteAsyncOnStreamImpl(", module_name_, ")"));
   se::DeviceMemoryAllocator* const memory_allocator = run_options->allocator();
-  // Force synchronous execution if the allocator requires it.
+  // Force synchronous execution if the allocator requires it, or if pinned
+  // host buffers have to be released after the run.
   const bool block_host_until_done =
-      !memory_allocator->AllowsAsynchronousDeallocation();
+      !memory_allocator->AllowsAsynchronousDeallocation() ||
+      absl::c_any_of(allocations_, [](const BufferAllocation& allocation) {
+        return allocation.color() == kHostMemorySpace;
+      });
 
   const GpuExecutable::BufferAllocToDeviceMemoryMap* globals;
   {
@@ -583,6 +614,13 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   // Free all temporary allocations.
   TF_RETURN_IF_ERROR(
       buffer_allocations.TearDown(buffers_in_result, allocations_));
+  for (const BufferAllocation& allocation : allocations_) {
+    se::DeviceMemoryBase buffer =
+        buffer_allocations.GetDeviceAddress(allocation.index());
+    if (allocation.color() == kHostMemorySpace && !buffer.is_null()) {
+      executor->HostMemoryDeallocate(buffer.opaque());
+    }
+  }
 
   // Free allocations for arguments.
   if (auto args = absl::get_if<absl::Span<ExecutionInput>>(&arguments)) {
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include <deque>
 #include <memory>
+#include <set>
 #include <unordered_map>
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
@@ -149,36 +151,61 @@ GpuHloOrdering::GpuHloOrdering(
 // because C completes before D starts in stream 0, and E depends on D.
 // However, if the total order is A,B,D,C,E, then C and E can run
 // concurrently.
+//
+// Collectives that run on the dedicated collective stream are launched as soon
+// as they are ready, and their consumers are deferred until nothing else is
+// ready, so that as much independent compute as possible is launched between
+// a collective and the first instruction that waits for it.
 void BFSLaunchOrder(const HloComputation* computation,
                     std::vector<HloInstruction*>* launch_order) {
-  // This topological sort uses two data structures:
+  // This topological sort uses three data structures:
   // 1. `incoming_edge_count` which keeps track of the number of incoming
-  // edges to each HLO;
-  // 2. `queue` which contains all HLOs with no incoming edges.
+  // data and control edges to each HLO;
+  // 2. `queue` which contains all HLOs with no incoming edges;
+  // 3. `deferred` which contains HLOs with no incoming edges that consume the
+  // result of a collective.
   //
-  // The sorting algorithm repeatedly pops the top from the queue and deletes
-  // that HLO from the graph, making more HLOs incoming-edge free.
+  // The sorting algorithm repeatedly pops the top from the queue (or from
+  // `deferred` once the queue is empty) and deletes that HLO from the graph,
+  // making more HLOs incoming-edge free.
+  auto consumes_collective = [](const HloInstruction* hlo) {
+    return absl::c_any_of(hlo->operands(), [](const HloInstruction* operand) {
+      return RunsOnCollectiveStream(*operand);
+    });
+  };
   std::deque<HloInstruction*> queue;
+  std::deque<HloInstruction*> deferred;
   std::unordered_map<const HloInstruction*, int64> incoming_edge_count;
   for (auto* hlo : computation->instructions()) {
-    if (hlo->operand_count() == 0) {
+    std::set<HloInstruction*> predecessors(hlo->operands().begin(),
+                                           hlo->operands().end());
+    predecessors.insert(hlo->control_predecessors().begin(),
+                        hlo->control_predecessors().end());
+    if (predecessors.empty()) {
       queue.push_back(hlo);
     } else {
-      incoming_edge_count[hlo] =
-          std::set<HloInstruction*>(hlo->operands().begin(),
-                                    hlo->operands().end())
-              .size();
+      incoming_edge_count[hlo] = predecessors.size();
     }
   }
 
-  while (!queue.empty()) {
-    HloInstruction* x = queue.front();
-    queue.pop_front();
+  while (!queue.empty() || !deferred.empty()) {
+    std::deque<HloInstruction*>& source = queue.empty() ? deferred : queue;
+    HloInstruction* x = source.front();
+    source.pop_front();
     launch_order->push_back(x);
-    for (HloInstruction* y : x->users()) {
+    std::set<HloInstruction*> successors(x->users().begin(), x->users().end());
+    successors.insert(x->control_successors().begin(),
+                      x->control_successors().end());
+    for (HloInstruction* y : successors) {
       --incoming_edge_count[y];
       if (incoming_edge_count[y] == 0) {
-        queue.push_back(y);
+        if (RunsOnCollectiveStream(*y)) {
+          queue.push_front(y);
+        } else if (consumes_collective(y)) {
+          deferred.push_back(y);
+        } else {
+          queue.push_back(y);
+        }
       }
     }
   }
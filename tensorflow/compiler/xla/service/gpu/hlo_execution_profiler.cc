@@ -112,6 +112,14 @@ void HloExecutionProfiler::FinishHloInstruction(size_t index) {
   }
 }
 
+void HloExecutionProfiler::RecordStreamUsage(int64 streams_used,
+                                             int64 cross_stream_waits) {
+  if (do_profile_) {
+    profile_->set_extra_metrics(kStreamsUsedMetric, streams_used);
+    profile_->set_extra_metrics(kCrossStreamWaitsMetric, cross_stream_waits);
+  }
+}
+
 std::unique_ptr<ScopedInstructionProfiler>
 HloExecutionProfiler::MakeScopedInstructionProfiler(
     absl::optional<int64> index) {
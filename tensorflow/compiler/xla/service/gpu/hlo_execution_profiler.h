@@ -31,6 +31,11 @@ namespace gpu {
 
 class ScopedInstructionProfiler;
 
+// Extra profile metrics describing how thunks were spread over GPU streams.
+// They must be registered with the HloProfileIndexMap of profiled modules.
+constexpr char kStreamsUsedMetric[] = "streams used";
+constexpr char kCrossStreamWaitsMetric[] = "cross-stream waits";
+
 // A helper class for profiling HLO in the course of GPU program execution.
 // All of the profiling is guarded internally, to avoid the caller needing to
 // have lots of conditionals sprinkled around.
@@ -74,6 +79,12 @@ class HloExecutionProfiler {
   std::unique_ptr<ScopedInstructionProfiler> MakeScopedInstructionProfiler(
       absl::optional<int64> profile_index);
 
+  // If profiling is enabled, records the number of streams that executed at
+  // least one thunk and the number of waits one stream had to do on another.
+  // Per-operation timing serializes the streams, so these describe the
+  // concurrency available to an unprofiled run rather than measure overlap.
+  void RecordStreamUsage(int64 streams_used, int64 cross_stream_waits);
+
  private:
   const bool do_profile_;
   double clock_rate_ghz_;
@@ -0,0 +1,225 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/horizontal_dot_batching.h"
+
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/protobuf_util.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_creation_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Batching too many dots at a time increases the size of the concatenated
+// operands without saving much more launch overhead. Set a limit to it.
+constexpr int64 kMaxBatchSize = 32;
+
+// Dots whose operands or result have more elements than this are likely
+// compute-bound rather than launch-latency-bound, so batching them does not
+// pay for the extra concatenates.
+constexpr int64 kMaxElementsPerDot = 256 * 256;
+
+// Returns whether `instr` is a small matrix multiplication without batch
+// dimensions, i.e. a candidate to be batched with other dots.
+bool IsBatchingCandidate(const HloInstruction& instr) {
+  if (!IsMatrixMultiplication(instr)) {
+    return false;
+  }
+  const DotDimensionNumbers& dim_numbers = instr.dot_dimension_numbers();
+  if (dim_numbers.lhs_batch_dimensions_size() != 0 ||
+      instr.operand(0)->shape().rank() != 2 ||
+      instr.operand(1)->shape().rank() != 2) {
+    return false;
+  }
+  return ShapeUtil::ElementsIn(instr.operand(0)->shape()) <=
+             kMaxElementsPerDot &&
+         ShapeUtil::ElementsIn(instr.operand(1)->shape()) <=
+             kMaxElementsPerDot &&
+         ShapeUtil::ElementsIn(instr.shape()) <= kMaxElementsPerDot;
+}
+
+// Returns whether `a` and `b` compute the same kind of matrix multiplication,
+// so that they can be expressed as two batches of one batched dot.
+bool AreBatchable(const HloInstruction& a, const HloInstruction& b) {
+  return ShapeUtil::Equal(a.shape(), b.shape()) &&
+         ShapeUtil::Equal(a.operand(0)->shape(), b.operand(0)->shape()) &&
+         ShapeUtil::Equal(a.operand(1)->shape(), b.operand(1)->shape()) &&
+         protobuf_util::ProtobufEquals(a.dot_dimension_numbers(),
+                                       b.dot_dimension_numbers()) &&
+         protobuf_util::ProtobufEquals(a.precision_config(),
+                                       b.precision_config());
+}
+
+class HorizontalDotBatchingImpl {
+ public:
+  explicit HorizontalDotBatchingImpl(HloComputation* computation)
+      : computation_(computation) {}
+
+  ~HorizontalDotBatchingImpl() {}
+
+  StatusOr<bool> Run();
+
+ private:
+  // Finds the next group of mutually independent, batchable dots among
+  // `candidates`, removing them from `candidates`.
+  std::vector<HloInstruction*> GetNextGroup(
+      std::vector<HloInstruction*>* candidates);
+
+  // Replaces `dots` with slices of one batched dot.
+  Status BatchDots(absl::Span<HloInstruction* const> dots);
+
+  HloComputation* computation_;
+  std::unique_ptr<HloReachabilityMap> reachability_;
+};  // HorizontalDotBatchingImpl
+
+std::vector<HloInstruction*> HorizontalDotBatchingImpl::GetNextGroup(
+    std::vector<HloInstruction*>* candidates) {
+  std::vector<HloInstruction*> group;
+  std::vector<HloInstruction*> remaining;
+  for (HloInstruction* candidate : *candidates) {
+    bool can_join =
+        group.empty() ||
+        (group.size() < kMaxBatchSize && AreBatchable(*group[0], *candidate) &&
+         absl::c_none_of(group, [&](const HloInstruction* member) {
+           return reachability_->IsConnected(member, candidate);
+         }));
+    if (can_join) {
+      group.push_back(candidate);
+    } else {
+      remaining.push_back(candidate);
+    }
+  }
+  *candidates = std::move(remaining);
+  return group;
+}
+
+Status HorizontalDotBatchingImpl::BatchDots(
+    absl::Span<HloInstruction* const> dots) {
+  const HloInstruction* first_dot = dots[0];
+  const int64 batch_size = dots.size();
+
+  // Reshapes every operand to have a leading dimension of size 1 and
+  // concatenates them along that dimension.
+  auto make_batched_operand =
+      [&](int64 operand_index) -> StatusOr<HloInstruction*> {
+    std::vector<HloInstruction*> reshapes;
+    for (HloInstruction* dot : dots) {
+      HloInstruction* operand = dot->mutable_operand(operand_index);
+      std::vector<int64> dims = {1};
+      absl::c_copy(operand->shape().dimensions(), std::back_inserter(dims));
+      TF_ASSIGN_OR_RETURN(HloInstruction * reshape,
+                          MakeReshapeHlo(dims, operand));
+      reshapes.push_back(reshape);
+    }
+    return MakeConcatHlo(reshapes, 0);
+  };
+  TF_ASSIGN_OR_RETURN(HloInstruction * lhs, make_batched_operand(0));
+  TF_ASSIGN_OR_RETURN(HloInstruction * rhs, make_batched_operand(1));
+
+  const DotDimensionNumbers& old_dim_numbers =
+      first_dot->dot_dimension_numbers();
+  DotDimensionNumbers dim_numbers;
+  dim_numbers.add_lhs_batch_dimensions(0);
+  dim_numbers.add_rhs_batch_dimensions(0);
+  dim_numbers.add_lhs_contracting_dimensions(
+      old_dim_numbers.lhs_contracting_dimensions(0) + 1);
+  dim_numbers.add_rhs_contracting_dimensions(
+      old_dim_numbers.rhs_contracting_dimensions(0) + 1);
+  TF_ASSIGN_OR_RETURN(
+      HloInstruction * batched_dot,
+      MakeDotHlo(lhs, rhs, dim_numbers, first_dot->precision_config(),
+                 /*preferred_element_type=*/first_dot->shape().element_type()));
+
+  // The result of the batched dot is [batch_size, <result dims>]; slice out
+  // each batch and reshape it back to the result shape of the original dot.
+  const Shape& result_shape = first_dot->shape();
+  std::vector<int64> limit_indices = {0};
+  absl::c_copy(result_shape.dimensions(), std::back_inserter(limit_indices));
+  std::vector<int64> start_indices(limit_indices.size(), 0);
+  std::vector<int64> strides(limit_indices.size(), 1);
+  for (int64 i = 0; i < batch_size; ++i) {
+    start_indices[0] = i;
+    limit_indices[0] = i + 1;
+    TF_ASSIGN_OR_RETURN(
+        HloInstruction * slice,
+        MakeSliceHlo(batched_dot, start_indices, limit_indices, strides));
+    TF_ASSIGN_OR_RETURN(HloInstruction * reshape,
+                        MakeReshapeHlo(result_shape, slice));
+    VLOG(3) << "Batch " << dots[i]->ToString() << " into "
+            << batched_dot->ToString();
+    TF_RETURN_IF_ERROR(computation_->ReplaceInstruction(dots[i], reshape));
+  }
+  return Status::OK();
+}
+
+StatusOr<bool> HorizontalDotBatchingImpl::Run() {
+  bool changed = false;
+  XLA_VLOG_LINES(3, computation_->ToString());
+
+  std::vector<HloInstruction*> candidates;
+  for (HloInstruction* instr : computation_->MakeInstructionPostOrder()) {
+    if (IsBatchingCandidate(*instr)) {
+      candidates.push_back(instr);
+    }
+  }
+
+  while (candidates.size() > 1) {
+    // Batching a group merges the dependencies of its members, so the
+    // reachability has to be recomputed before the next group is formed.
+    reachability_ = HloReachabilityMap::Build(computation_);
+    std::vector<HloInstruction*> group = GetNextGroup(&candidates);
+    if (group.size() == 1) {
+      // Skip; there is no other dot to batch with.
+      continue;
+    }
+    TF_RETURN_IF_ERROR(BatchDots(group));
+    changed = true;
+  }
+
+  return changed;
+}
+
+}  // namespace
+
+StatusOr<bool> GpuHorizontalDotBatching::RunOnComputation(
+    HloComputation* computation) {
+  HorizontalDotBatchingImpl horizontal_dot_batching_impl(computation);
+  return horizontal_dot_batching_impl.Run();
+}
+
+StatusOr<bool> GpuHorizontalDotBatching::Run(HloModule* module) {
+  bool changed = false;
+  VLOG(2) << "Run horizontal dot batching.";
+  for (auto* comp : module->MakeNonfusionComputations()) {
+    TF_ASSIGN_OR_RETURN(bool comp_changed, RunOnComputation(comp));
+    changed |= comp_changed;
+  }
+
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,69 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_DOT_BATCHING_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_DOT_BATCHING_H_
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace xla {
+namespace gpu {
+
+// This optimization pass horizontally batches small, independent matrix
+// multiplications of the same shape into a single batched dot, so that they
+// are executed by one batched gemm call instead of one gemm call each. See
+// GpuHorizontalLoopFusion for the general motivation of horizontal fusion;
+// this pass applies the same idea to dots, which are not fused but emitted as
+// library calls.
+//
+// For example, the following dots
+//
+//   dot.1 = f32[64,32] dot(f32[64,16] a.1, f32[16,32] b.1)
+//   dot.2 = f32[64,32] dot(f32[64,16] a.2, f32[16,32] b.2)
+//
+// are rewritten into
+//
+//   lhs = f32[2,64,16] concatenate(reshape(a.1), reshape(a.2))
+//   rhs = f32[2,16,32] concatenate(reshape(b.1), reshape(b.2))
+//   dot = f32[2,64,32] dot(lhs, rhs), lhs_batch_dims={0}, rhs_batch_dims={0}
+//   dot.1 = f32[64,32] reshape(slice(dot)), dot.2 = ...
+//
+// Only dots without batch dimensions and whose operands and results are small
+// are batched, since the benefit comes from saving kernel launches and the
+// concatenates add memory traffic. Dots are batched only if none of them
+// depends on another, which guarantees that the rewrite does not create
+// cycles.
+class GpuHorizontalDotBatching : public HloModulePass {
+ public:
+  GpuHorizontalDotBatching() {}
+
+  absl::string_view name() const override {
+    return "gpu_horizontal_dot_batching";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  StatusOr<bool> RunOnComputation(HloComputation*);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_DOT_BATCHING_H_
@@ -0,0 +1,102 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/horizontal_dot_batching.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class HorizontalDotBatchingTest : public HloTestBase {};
+
+TEST_F(HorizontalDotBatchingTest, BatchesIndependentDots) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+ HloModule BatchesIndependentDots
+
+ ENTRY entry_computation {
+   a.1 = f32[64,16]{1,0} parameter(0)
+   b.1 = f32[16,32]{1,0} parameter(1)
+   a.2 = f32[64,16]{1,0} parameter(2)
+   b.2 = f32[16,32]{1,0} parameter(3)
+   dot.1 = f32[64,32]{1,0} dot(a.1, b.1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+   dot.2 = f32[64,32]{1,0} dot(a.2, b.2), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+   add.1 = f32[64,32]{1,0} add(dot.1, dot.1)
+   ROOT tuple.1 = (f32[64,32]{1,0}, f32[64,32]{1,0}) tuple(add.1, dot.2)
+ }
+)")
+                    .ValueOrDie();
+
+  EXPECT_TRUE(GpuHorizontalDotBatching().Run(module.get()).ValueOrDie());
+
+  const HloInstruction* entry_root =
+      module->entry_computation()->root_instruction();
+  EXPECT_THAT(entry_root,
+              op::Tuple(op::Add(op::Reshape(op::Slice(op::Dot())),
+                                op::Reshape(op::Slice(op::Dot()))),
+                        op::Reshape(op::Slice(op::Dot()))));
+
+  const HloInstruction* dot = entry_root->operand(1)->operand(0)->operand(0);
+  EXPECT_THAT(dot, op::Dot(op::Concatenate(op::Reshape(), op::Reshape()),
+                           op::Concatenate(op::Reshape(), op::Reshape())));
+  EXPECT_TRUE(ShapeUtil::Equal(dot->shape(),
+                               ShapeUtil::MakeShape(F32, {2, 64, 32})));
+}
+
+TEST_F(HorizontalDotBatchingTest, DoesNotBatchDependentDots) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+ HloModule DoesNotBatchDependentDots
+
+ ENTRY entry_computation {
+   a.1 = f32[32,32]{1,0} parameter(0)
+   b.1 = f32[32,32]{1,0} parameter(1)
+   dot.1 = f32[32,32]{1,0} dot(a.1, b.1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+   ROOT dot.2 = f32[32,32]{1,0} dot(dot.1, b.1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+ }
+)")
+                    .ValueOrDie();
+
+  EXPECT_FALSE(GpuHorizontalDotBatching().Run(module.get()).ValueOrDie());
+}
+
+TEST_F(HorizontalDotBatchingTest, DoesNotBatchDifferentShapes) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+ HloModule DoesNotBatchDifferentShapes
+
+ ENTRY entry_computation {
+   a.1 = f32[64,16]{1,0} parameter(0)
+   b.1 = f32[16,32]{1,0} parameter(1)
+   a.2 = f32[32,16]{1,0} parameter(2)
+   b.2 = f32[16,32]{1,0} parameter(3)
+   dot.1 = f32[64,32]{1,0} dot(a.1, b.1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+   dot.2 = f32[32,32]{1,0} dot(a.2, b.2), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+   ROOT tuple.1 = (f32[64,32]{1,0}, f32[32,32]{1,0}) tuple(dot.1, dot.2)
+ }
+)")
+                    .ValueOrDie();
+
+  EXPECT_FALSE(GpuHorizontalDotBatching().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -116,9 +116,32 @@ class HorizontalLoopFusionImpl {
   HloComputation* computation_;
 };  // HorizontalLoopFusionImpl
 
+// Returns whether `instr` is a kInput fusion of a single reduction which is
+// small enough to be emitted elementally, i.e. by having each thread reduce
+// all the elements of one output element serially. Such reductions (e.g. the
+// norms in optimizer updates of small parameters) are dominated by the kernel
+// launch overhead, so they are worth fusing horizontally with kLoop fusions.
+bool IsSmallReduceInputFusion(const HloInstruction& instr) {
+  // Reducing more elements than this serially per thread is likely slower
+  // than launching a separate reduction kernel.
+  constexpr int64 kMaxReducedElementsPerThread = 256;
+  if (!instr.IsInputFusion()) {
+    return false;
+  }
+  const HloInstruction* root = instr.fused_expression_root();
+  if (root->opcode() != HloOpcode::kReduce || root->shape().IsTuple()) {
+    return false;
+  }
+  int64 output_elements = ShapeUtil::ElementsIn(root->shape());
+  int64 input_elements = ShapeUtil::ElementsIn(root->operand(0)->shape());
+  return output_elements > 0 &&
+         input_elements / output_elements <= kMaxReducedElementsPerThread;
+}
+
 bool IsFusionSupported(const HloInstruction& instr) {
-  // Support only kLoop fusion now.
-  if (!instr.IsLoopFusion()) {
+  // Support kLoop fusions and small reductions which are emitted like kLoop
+  // fusions.
+  if (!instr.IsLoopFusion() && !IsSmallReduceInputFusion(instr)) {
     return false;
   }
 
@@ -94,6 +94,11 @@ namespace gpu {
 // output dims of the concatenate will be used as the kernel launch dims.
 // Instruction bitcasts can be used for Reshape2 and Reshape3 as long as the
 // outputs of Mul and Add are row-major.
+//
+// Besides kLoop fusions, kInput fusions of small reductions (e.g. the norms
+// of small parameters in the training optimizer phase) are also candidates.
+// They are emitted elementally inside the horizontal fusion, i.e. each thread
+// serially reduces the inputs of one output element.
 class GpuHorizontalLoopFusion : public HloModulePass {
  public:
   GpuHorizontalLoopFusion() {}
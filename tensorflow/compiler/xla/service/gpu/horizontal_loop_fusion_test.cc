@@ -403,6 +403,63 @@ TEST_F(HorizontalLoopFusionTest, NegativeTestForDynamicUpdateSlice) {
   EXPECT_FALSE(GpuHorizontalLoopFusion().Run(module.get()).ValueOrDie());
 }
 
+TEST_F(HorizontalLoopFusionTest, FusesSmallReductions) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule FusesSmallReductions
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  fused_computation.1 {
+    p.0 = f32[128]{0} parameter(0)
+    c.0 = f32[] constant(0)
+    ROOT reduce = f32[] reduce(p.0, c.0), dimensions={0}, to_apply=add
+  }
+
+  fused_computation.2 {
+    p.0 = f32[4,64]{1,0} parameter(0)
+    c.0 = f32[] constant(0)
+    ROOT reduce = f32[4]{0} reduce(p.0, c.0), dimensions={1}, to_apply=add
+  }
+
+  fused_computation.3 {
+    p.0 = f32[4096]{0} parameter(0)
+    c.0 = f32[] constant(0)
+    ROOT reduce = f32[] reduce(p.0, c.0), dimensions={0}, to_apply=add
+  }
+
+  ENTRY entry {
+    p.0 = f32[128]{0} parameter(0)
+    p.1 = f32[4,64]{1,0} parameter(1)
+    p.2 = f32[4096]{0} parameter(2)
+    f1 = f32[] fusion(p.0), kind=kInput, calls=fused_computation.1
+    f2 = f32[4]{0} fusion(p.1), kind=kInput, calls=fused_computation.2
+    f3 = f32[] fusion(p.2), kind=kInput, calls=fused_computation.3
+    ROOT tuple = (f32[], f32[4]{0}, f32[]) tuple(f1, f2, f3)
+  })")
+                    .ValueOrDie();
+
+  EXPECT_TRUE(GpuHorizontalLoopFusion().Run(module.get()).ValueOrDie());
+
+  // The reduction of 4096 elements is too large to be emitted serially per
+  // output element, so it is left alone.
+  const HloInstruction* entry_root =
+      module->entry_computation()->root_instruction();
+  EXPECT_THAT(entry_root,
+              op::Tuple(op::Bitcast(op::GetTupleElement(op::Fusion())),
+                        op::Bitcast(op::GetTupleElement(op::Fusion())),
+                        op::Fusion()));
+  const HloInstruction* fusion = entry_root->operand(0)->operand(0)->operand(0);
+  EXPECT_THAT(fusion->fused_expression_root(),
+              op::Tuple(op::Slice(op::Concatenate(op::Reshape(op::Reduce()),
+                                                  op::Reshape(op::Reduce()))),
+                        op::Slice(op::Concatenate(op::Reshape(op::Reduce()),
+                                                  op::Reshape(op::Reduce())))));
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
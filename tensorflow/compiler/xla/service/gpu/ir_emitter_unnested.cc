@@ -2944,9 +2944,10 @@ Status IrEmitterUnnested::HandleAllGather(HloInstruction* hlo) {
           << "; operand count: " << hlo->operand_count()
           << "; NCCL is enabled: " << NcclAllGatherThunk::NcclIsEnabled();
 
-  // Note the replica_count == 1 case is handled via device-to-device copy
-  // below.
-  bool should_use_nccl_thunk = hlo_module_config_.replica_count() > 1 &&
+  // Note the case of a single replica and partition is handled via
+  // device-to-device copy below.
+  bool should_use_nccl_thunk = (hlo_module_config_.replica_count() > 1 ||
+                                hlo_module_config_.num_partitions() > 1) &&
                                NcclAllGatherThunk::CanImplement(hlo);
 
   if (should_use_nccl_thunk) {
@@ -2986,7 +2987,8 @@ Status IrEmitterUnnested::HandleAllGather(HloInstruction* hlo) {
     return Status::OK();
   }
 
-  if (hlo_module_config_.replica_count() != 1) {
+  if (hlo_module_config_.replica_count() != 1 ||
+      hlo_module_config_.num_partitions() != 1) {
     string message = absl::StrFormat(
         "Requested AllGather not implemented on GPU; replica_count: %d; "
         "operand_count: %d; NCCL support: %d",
@@ -3041,9 +3043,10 @@ Status IrEmitterUnnested::HandleAllReduce(HloInstruction* crs) {
           << "; operand count: " << crs->operand_count()
           << "; NCCL is enabled: " << NcclAllReduceThunk::NcclIsEnabled();
 
-  // Note the replica_count == 1 case is handled via device-to-device copy
-  // below.
-  bool should_use_nccl_thunk = hlo_module_config_.replica_count() > 1 &&
+  // Note the case of a single replica and partition is handled via
+  // device-to-device copy below.
+  bool should_use_nccl_thunk = (hlo_module_config_.replica_count() > 1 ||
+                                hlo_module_config_.num_partitions() > 1) &&
                                NcclAllReduceThunk::CanImplement(crs);
 
   if (should_use_nccl_thunk) {
@@ -3083,7 +3086,8 @@ Status IrEmitterUnnested::HandleAllReduce(HloInstruction* crs) {
     return Status::OK();
   }
 
-  if (hlo_module_config_.replica_count() != 1) {
+  if (hlo_module_config_.replica_count() != 1 ||
+      hlo_module_config_.num_partitions() != 1) {
     // TODO(b/33011107): Support more AllReduce configurations on GPU.
     string message = absl::StrFormat(
         "Requested AllReduce not implemented on GPU; replica_count: %d; "
@@ -3144,9 +3148,10 @@ Status IrEmitterUnnested::HandleAllToAll(HloInstruction* hlo) {
           << "; operand count: " << hlo->operand_count()
           << "; NCCL is enabled: " << NcclAllToAllThunk::NcclIsEnabled();
 
-  // Note the replica_count == 1 case is handled via device-to-device copy
-  // below.
-  bool should_use_nccl_thunk = hlo_module_config_.replica_count() > 1 &&
+  // Note the case of a single replica and partition is handled via
+  // device-to-device copy below.
+  bool should_use_nccl_thunk = (hlo_module_config_.replica_count() > 1 ||
+                                hlo_module_config_.num_partitions() > 1) &&
                                NcclAllToAllThunk::CanImplement(hlo);
 
   if (should_use_nccl_thunk) {
@@ -3186,7 +3191,8 @@ Status IrEmitterUnnested::HandleAllToAll(HloInstruction* hlo) {
     return Status::OK();
   }
 
-  if (hlo_module_config_.replica_count() != 1) {
+  if (hlo_module_config_.replica_count() != 1 ||
+      hlo_module_config_.num_partitions() != 1) {
     string message = absl::StrFormat(
         "Requested AllToAll not implemented on GPU; replica_count: %d; "
         "operand_count: %d; NCCL support: %d",
@@ -4414,9 +4420,9 @@ void IrEmitterUnnested::EmitPrologueForReduction(
         reduce_inst_shape.element_type(), module_);
     llvm::Type* buffer_type = [&] {
       if (reduction_info->IsRowReduction()) {
-        // Allocate __shared__ cache[num_partial_results][kWarpSize].
+        // Allocate __shared__ cache[num_partial_results][warp_size].
         return llvm::ArrayType::get(
-            llvm::ArrayType::get(primitive_type, kWarpSize),
+            llvm::ArrayType::get(primitive_type, WarpSize()),
             num_partial_results);
       } else {
         // Allocate __shared__
@@ -4440,6 +4446,13 @@ void IrEmitterUnnested::EmitPrologueForReduction(
   CHECK(first_reduce);
 }
 
+int64 IrEmitterUnnested::WarpSize() const {
+  int64 threads_per_warp =
+      ir_emitter_context_->gpu_device_info().threads_per_warp;
+  // Fall back to the NVIDIA warp size if the device info wasn't populated.
+  return threads_per_warp > 0 ? threads_per_warp : kWarpSize;
+}
+
 void IrEmitterUnnested::EmitFullWarpShuffleDownLoopForAllReduces(
     absl::Span<HloComputation* const> reducers,
     absl::Span<llvm::AllocaInst* const> partial_result_addresses) {
@@ -4447,14 +4460,14 @@ void IrEmitterUnnested::EmitFullWarpShuffleDownLoopForAllReduces(
   for (int i = 0; i != reducers.size(); i++) {
     EmitFullWarpShuffleDownLoopForReduce(
         reducers[i], partial_result_addresses[i]->getType()->getElementType(),
-        partial_result_addresses[i]);
+        partial_result_addresses[i], WarpSize());
   }
 }
 
 void IrEmitterUnnested::EmitFullWarpShuffleDownLoopForReduce(
     HloComputation* reducer, llvm::Type* element_type,
-    llvm::Value* partial_result_address) {
-  for (int distance = 16; distance >= 1; distance /= 2) {
+    llvm::Value* partial_result_address, int64 num_lanes) {
+  for (int64 distance = num_lanes / 2; distance >= 1; distance /= 2) {
     int bit_width = llvm_ir::GetSizeInBits(element_type);
     llvm::Value* result_from_other_lane = llvm_ir::EmitAllocaAtFunctionEntry(
         element_type, "result_from_other_lane", &b_);
@@ -4600,9 +4613,9 @@ void IrEmitterUnnested::EmitEpilogueForReduction(
           partial_result_addresses[i]->getType()->getElementType();
       if (reduction_info.IsRowReduction()) {
         EmitFullWarpShuffleDownLoopForReduce(reducers[i], element_type,
-                                             current_output);
+                                             current_output, WarpSize());
         llvm::Value* warp_id =
-            b_.CreateUDiv(thread_id_info.thread_id_x, constant(kWarpSize));
+            b_.CreateUDiv(thread_id_info.thread_id_x, constant(WarpSize()));
         ksl.If("intra_warp_reduce_write", is_zero(thread_id_info.lane_id), [&] {
           llvm::Value* shmem_output_addr =
               shared_to_global(b_.CreateInBoundsGEP(
@@ -4623,14 +4636,14 @@ void IrEmitterUnnested::EmitEpilogueForReduction(
 
           llvm::Value* warp_exists = b_.CreateICmpULT(
               thread_id_info.thread_id_x,
-              constant(mapping_scheme.GetNumThreadsX() / kWarpSize));
+              constant(mapping_scheme.GetNumThreadsX() / WarpSize()));
 
           llvm::Value* selected_value = b_.CreateSelect(
               warp_exists, block_accum_addr, initial_value_addr);
 
           EmitFullWarpShuffleDownLoopForReduce(
               reducers[i], element_type,
-              /*block_accum_addr*/ selected_value);
+              /*block_accum_addr*/ selected_value, WarpSize());
           ksl.If("reduction_atomic_update", is_zero(thread_id_info.thread_id_x),
                  [&] {
                    TF_CHECK_OK(EmitAtomicOperationForNestedComputation(
@@ -4657,8 +4670,11 @@ void IrEmitterUnnested::EmitEpilogueForReduction(
                  thread_id_info.thread_id_x},
                 "shmem_transposed_addr"));
 
+        // The transposed tile is narrower than a 64-wide wavefront, so only
+        // shuffle across the threads of a row of the tile.
         EmitFullWarpShuffleDownLoopForReduce(reducers[i], element_type,
-                                             shmem_transposed_addr);
+                                             shmem_transposed_addr,
+                                             mapping_scheme.GetNumThreadsX());
 
         // Some threads in the block are completely outside of the bound of the
         // tensor, so they should not write any output at all.
@@ -4671,7 +4687,8 @@ void IrEmitterUnnested::EmitEpilogueForReduction(
                              tiling_kernel_info.output_tile_bounds[kDimY]));
 
         ksl.If("reduction_atomic_update",
-               b_.CreateAnd(has_output, is_zero(thread_id_info.lane_id)), [&] {
+               b_.CreateAnd(has_output, is_zero(thread_id_info.thread_id_x)),
+               [&] {
                  TF_CHECK_OK(EmitAtomicOperationForNestedComputation(
                      *reducers[i], output_address, shmem_transposed_addr));
                });
@@ -4807,7 +4824,7 @@ IrEmitterUnnested::ThreadIdInfo IrEmitterUnnested::EmitThreadIdInfo(
       /*thread_id=*/thread_id,
       /*thread_id_x=*/b_.CreateURem(thread_id, num_threads_x_v, "thread_id.x"),
       /*thread_id_y=*/b_.CreateUDiv(thread_id, num_threads_x_v, "thread_id.y"),
-      /*lane_id=*/b_.CreateURem(thread_id, constant(kWarpSize), "lane_id")};
+      /*lane_id=*/b_.CreateURem(thread_id, constant(WarpSize()), "lane_id")};
 }
 
 IrEmitterUnnested::TilingKernelInfo IrEmitterUnnested::EmitTilingKernel(
@@ -4927,8 +4944,9 @@ llvm::CallInst* IrEmitterUnnested::EmitSyncThreads() {
 // This is similar to the following CUDA algorithm in TensorFlow:
 // https://goo.gl/MStRV6.
 //
-// `kTileSize` should usually be same as warp size. We currently choose 32 for
-// `kTileSize` and 4 for `kNumRows`. The CUDA algorithm uses 8 for `kNumRows`.
+// `kTileSize` should usually be same as warp size. We choose the warp size of
+// the target for `kTileSize` (32 on NVIDIA GPUs, 64 on AMD GPUs) and 4 for
+// `kNumRows`. The CUDA algorithm uses 8 for `kNumRows`.
 //
 // TODO(b/33320379): Here each block transposes 1 tile. It may be more
 // efficient to launch fewer blocks so each transposes many tiles.
@@ -4939,13 +4957,14 @@ void IrEmitterUnnested::EmitHlo021Tile(
     absl::Span<const int64> reduced_output_dims,
     absl::Span<const int64> tiled_param_ids) {
   constexpr int kNumRows = 4;
+  const int64 kTileSize = WarpSize();
 
   std::string name = mlir::GetNameFromLoc(op->getLoc());
 
   KernelMappingScheme mapping_scheme(reduced_output_dims,
-                                     /*tile_sizes=*/{1, kWarpSize, kWarpSize},
+                                     /*tile_sizes=*/{1, kTileSize, kTileSize},
                                      /*num_threads_y=*/kNumRows,
-                                     /*num_threads_x=*/kWarpSize,
+                                     /*num_threads_x=*/kTileSize,
                                      /*indexing_order=*/kLinearIndexingX,
                                      /*vector_size=*/1,
                                      /*is_row_contiguous=*/false);
@@ -5269,13 +5288,20 @@ StatusOr<bool> IrEmitterUnnested::CheckAndEmitHloWithTile021(
   // This is only sound if tiled transposes are the only place where we use
   // shared memory in fusions.  If in the future other fusible ops use shared
   // memory, we'll have to adjust this heuristic.
+  //
+  // The shmem tiles are warp size x (warp size + 1) elements, so with 64-wide
+  // wavefronts they are four times as large.  Those GPUs also have more
+  // shared memory (LDS) per block, so use that as the budget if it's larger.
   constexpr int kMinBlocksPerCore = 3;
-  constexpr int64 kShmemPerCore = 48 * 1024;
+  const int64 kShmemPerCore =
+      std::max<int64>(48 * 1024, ir_emitter_context_->gpu_device_info()
+                                     .shared_memory_per_block);
+  const int64 kTileSize = WarpSize();
   int64 shmem_used = 0;
   for (int64 i = 0; i < params_012.size(); ++i) {
     const Shape& operand_shape = context.operand_shapes[params_012[i]];
     shmem_used +=
-        32 * 33 *
+        kTileSize * (kTileSize + 1) *
         ShapeUtil::ByteSizeOfPrimitiveType(operand_shape.element_type());
 
     if (kMinBlocksPerCore * shmem_used > kShmemPerCore) {
@@ -5451,8 +5477,11 @@ ReductionCodegenInfo IrEmitterUnnested::ComputeReductionCodegenInfo(
           max_block_size,
           RoundUpToNearest(CeilOfRatio(reduction_dimensions.dimensions[2],
                                        reduction_tiling[2]),
-                           kWarpSize));
+                           WarpSize()));
     }
+    // Column reductions transpose a num_threads_x x num_threads_x tile through
+    // shared memory, so a 64x64 tile would exceed the maximum block size.
+    // Keep 32 here even on GPUs with 64-wide wavefronts.
     return kWarpSize;
   }();
 
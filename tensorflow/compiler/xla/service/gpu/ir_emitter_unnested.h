@@ -613,10 +613,15 @@ class IrEmitterUnnested : public IrEmitter,
       absl::Span<llvm::AllocaInst* const> partial_result_addresses);
 
   // Emits shuffle-down reduction for the `partial_result_address` using the
-  // reduction computation `reducer` over types `element_type`.
+  // reduction computation `reducer` over types `element_type`, across the
+  // first `num_lanes` lanes of the warp.
   void EmitFullWarpShuffleDownLoopForReduce(
       HloComputation* reducer, llvm::Type* element_type,
-      llvm::Value* partial_result_address);
+      llvm::Value* partial_result_address, int64 num_lanes);
+
+  // Returns the number of threads in a warp (a wavefront on AMD GPUs) of the
+  // target device.
+  int64 WarpSize() const;
 
   std::unique_ptr<KernelThunk> BuildKernelThunkFromBufferSlices(
       absl::string_view name, Thunk::ThunkInfo thunk_info,
@@ -61,6 +61,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -652,24 +653,141 @@ void HsacoCache::Add(const std::string& ir, uint64_t hash,
   g_hsacoCache.cache.back().hsaco = hsaco;
 }
 
-// Emits the given module to HSA Code Object. target_machine is an initialized
-// TargetMachine for the AMDGPU target.
-StatusOr<std::vector<uint8>> EmitModuleToHsaco(
-    llvm::Module* module, llvm::TargetMachine* target_machine) {
+// Returns the path of the persistent cache entry for `ir`, which already has
+// the HLO module's compilation cache key appended, compiled for `gfx`.
+std::string HsacoDiskCachePath(const std::string& cache_dir,
+                               const std::string& ir, const std::string& gfx) {
+  // Binaries linked against different ROCm device libraries must not be mixed.
+  std::string key = ir;
+#ifdef TF_ROCM_VERSION
+  absl::StrAppend(&key, "rocm-", TF_ROCM_VERSION);
+#endif
+  tensorflow::Fprint128 fp = tensorflow::Fingerprint128(key);
+  return tensorflow::io::JoinPath(
+      cache_dir,
+      absl::StrCat(gfx, "-", absl::Hex(fp.high64, absl::kZeroPad16),
+                   absl::Hex(fp.low64, absl::kZeroPad16), ".hsaco"));
+}
+
+bool ReadHsacoFromDiskCache(const std::string& path,
+                            std::vector<uint8>* hsaco) {
+  auto* env = tensorflow::Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  std::string data;
+  tensorflow::Status status = tensorflow::ReadFileToString(env, path, &data);
+  if (!status.ok() || data.empty()) {
+    LOG(WARNING) << "Ignoring unreadable HSACO cache entry " << path << ": "
+                 << status;
+    return false;
+  }
+  hsaco->assign(data.begin(), data.end());
+  return true;
+}
+
+// The entry is written to a temporary file and renamed into place, so that
+// processes sharing the cache directory never read a partially written file.
+void WriteHsacoToDiskCache(const std::string& path,
+                           const std::vector<uint8>& hsaco) {
   auto* env = tensorflow::Env::Default();
+  std::string tmp_path =
+      absl::StrCat(path, ".tmp.", tensorflow::random::New64());
+  tensorflow::Status status =
+      env->RecursivelyCreateDir(std::string(tensorflow::io::Dirname(path)));
+  if (status.ok()) {
+    status = tensorflow::WriteStringToFile(
+        env, tmp_path,
+        absl::string_view(reinterpret_cast<const char*>(hsaco.data()),
+                          hsaco.size()));
+  }
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write HSACO cache entry " << path << ": "
+                 << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
+// Returns the directory in which intermediate AMDGPU compilation artifacts are
+// written.
+StatusOr<std::string> GetCompileTempDirectory() {
   std::vector<std::string> tempdir_vector;
-  env->GetLocalTempDirectories(&tempdir_vector);
+  tensorflow::Env::Default()->GetLocalTempDirectories(&tempdir_vector);
   if (tempdir_vector.empty()) {
     return xla::InternalError(
         "Unable to locate a temporary directory for compile-time artifacts.");
   }
-  std::string tempdir_name = tempdir_vector.front();
-  VLOG(1) << "Compile-time artifacts located at: " << tempdir_name;
+  VLOG(1) << "Compile-time artifacts located at: " << tempdir_vector.front();
+  return tempdir_vector.front();
+}
 
+bool KeepCompileTempFiles() {
   bool keep_tempfiles = false;
   TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar("TF_ROCM_KEEP_XLA_TEMPFILES",
                                              /*default_val=*/false,
                                              &keep_tempfiles));
+  return keep_tempfiles;
+}
+
+std::vector<uint8> ReadBinaryFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  std::ifstream::pos_type file_size = file.tellg();
+
+  std::vector<uint8> contents(file_size);
+  file.seekg(0, std::ios::beg);
+  file.read(reinterpret_cast<char*>(contents.data()), file_size);
+  file.close();
+  return contents;
+}
+
+// Links the given relocatable AMDGPU object files into a single HSA code
+// object at hsaco_path.
+Status LinkObjectsToHsaco(const std::vector<std::string>& isabin_paths,
+                          const std::string& hsaco_path) {
+  // Locate lld.
+  // TODO(whchung@gmail.com): change to tensorflow::ROCmRoot() after
+  // ROCm-Device-Libs PR.
+  std::string lld_path_1 = tensorflow::io::JoinPath("/opt/rocm", "hcc/bin");
+  std::string lld_path_2 = tensorflow::io::JoinPath("/opt/rocm", "llvm/bin");
+  auto lld_program =
+      llvm::sys::findProgramByName("ld.lld", {lld_path_1, lld_path_2});
+  if (!lld_program) {
+    return xla::InternalError("unable to find ld.lld in PATH: %s",
+                              lld_program.getError().message());
+  }
+  std::vector<llvm::StringRef> lld_args{
+      llvm_ir::AsStringRef("ld.lld"),
+      llvm_ir::AsStringRef("-flavor"),
+      llvm_ir::AsStringRef("gnu"),
+      llvm_ir::AsStringRef("-shared"),
+  };
+  for (const std::string& isabin_path : isabin_paths) {
+    lld_args.push_back(llvm_ir::AsStringRef(isabin_path));
+  }
+  lld_args.push_back(llvm_ir::AsStringRef("-o"));
+  lld_args.push_back(llvm_ir::AsStringRef(hsaco_path));
+
+  std::string error_message;
+  int lld_result =
+      llvm::sys::ExecuteAndWait(*lld_program, llvm_ir::AsArrayRef(lld_args),
+                                llvm::None, {}, 0, 0, &error_message);
+  if (lld_result) {
+    return xla::InternalError("ld.lld execute fail: %s, error code %d",
+                              error_message, lld_result);
+  }
+  return Status::OK();
+}
+
+// Emits the given module to HSA Code Object. target_machine is an initialized
+// TargetMachine for the AMDGPU target. If relocatable is true, the object file
+// is returned without linking, so that it can later be linked together with
+// other parts of the same program by LinkHsacoObjects().
+StatusOr<std::vector<uint8>> EmitModuleToHsaco(
+    llvm::Module* module, llvm::TargetMachine* target_machine,
+    bool relocatable) {
+  TF_ASSIGN_OR_RETURN(std::string tempdir_name, GetCompileTempDirectory());
+  const bool keep_tempfiles = KeepCompileTempFiles();
   // Prepare filenames for all stages of compilation:
   // IR, binary ISA, and HSACO.
   std::string random_number = std::to_string(tensorflow::random::New64());
@@ -726,44 +844,19 @@ StatusOr<std::vector<uint8>> EmitModuleToHsaco(
     module->print(*ir_fs, nullptr);
     ir_fs->flush();
   }
-  // Locate lld.
-  // TODO(whchung@gmail.com): change to tensorflow::ROCmRoot() after
-  // ROCm-Device-Libs PR.
-  std::string lld_path_1 = tensorflow::io::JoinPath("/opt/rocm", "hcc/bin");
-  std::string lld_path_2 = tensorflow::io::JoinPath("/opt/rocm", "llvm/bin");
-  auto lld_program =
-      llvm::sys::findProgramByName("ld.lld", {lld_path_1, lld_path_2});
-  if (!lld_program) {
-    return xla::InternalError("unable to find ld.lld in PATH: %s",
-                              lld_program.getError().message());
+  if (relocatable) {
+    std::vector<uint8> isabin = ReadBinaryFile(isabin_path);
+    if (!keep_tempfiles) {
+      remove(ir_path.c_str());
+      remove(isabin_path.c_str());
+    }
+    return isabin;
   }
-  std::vector<llvm::StringRef> lld_args{
-      llvm_ir::AsStringRef("ld.lld"),
-      llvm_ir::AsStringRef("-flavor"),
-      llvm_ir::AsStringRef("gnu"),
-      llvm_ir::AsStringRef("-shared"),
-      llvm_ir::AsStringRef(isabin_path),
-      llvm_ir::AsStringRef("-o"),
-      llvm_ir::AsStringRef(hsaco_path),
-  };
 
-  std::string error_message;
-  int lld_result =
-      llvm::sys::ExecuteAndWait(*lld_program, llvm_ir::AsArrayRef(lld_args),
-                                llvm::None, {}, 0, 0, &error_message);
-  if (lld_result) {
-    return xla::InternalError("ld.lld execute fail: %s, error code %d",
-                              error_message, lld_result);
-  }
+  TF_RETURN_IF_ERROR(LinkObjectsToHsaco({isabin_path}, hsaco_path));
 
   // Read HSACO.
-  std::ifstream hsaco_file(hsaco_path, std::ios::binary | std::ios::ate);
-  std::ifstream::pos_type hsaco_file_size = hsaco_file.tellg();
-
-  std::vector<uint8> hsaco(hsaco_file_size);
-  hsaco_file.seekg(0, std::ios::beg);
-  hsaco_file.read(reinterpret_cast<char*>(&hsaco[0]), hsaco_file_size);
-  hsaco_file.close();
+  std::vector<uint8> hsaco = ReadBinaryFile(hsaco_path);
   if (!keep_tempfiles) {
     remove(ir_path.c_str());
     remove(isabin_path.c_str());
@@ -899,7 +992,8 @@ void AMDGPUBackendInit(const HloModuleConfig& hlo_module_config) {
 namespace amdgpu {
 StatusOr<std::vector<uint8>> CompileToHsaco(
     llvm::Module* module, GpuVersion gpu_version,
-    const HloModuleConfig& hlo_module_config, const string& rocdl_dir_path) {
+    const HloModuleConfig& hlo_module_config, const string& rocdl_dir_path,
+    bool relocatable) {
   static absl::once_flag backend_init_flag;
   absl::call_once(backend_init_flag, AMDGPUBackendInit, hlo_module_config);
 
@@ -919,6 +1013,7 @@ StatusOr<std::vector<uint8>> CompileToHsaco(
     if (pos != std::string::npos) str = str.substr(pos + 1);
   }
   str += hlo_module_config.compilation_cache_key();
+  if (relocatable) str += "relocatable";
   {
     tensorflow::profiler::TraceMe activity(
         [&] { return absl::StrCat("Compiling IR", module->getName().str()); },
@@ -937,6 +1032,18 @@ StatusOr<std::vector<uint8>> CompileToHsaco(
       return hsaco;
     }
     VLOG(1) << "HSACO cache miss";
+    const std::string& disk_cache_dir =
+        hlo_module_config.debug_options().xla_gpu_persistent_cache_dir();
+    std::string disk_cache_path;
+    if (!disk_cache_dir.empty()) {
+      disk_cache_path =
+          HsacoDiskCachePath(disk_cache_dir, str, amdgpu_version->second);
+      if (ReadHsacoFromDiskCache(disk_cache_path, &hsaco)) {
+        VLOG(1) << "HSACO disk cache hit: " << disk_cache_path;
+        HsacoCache::Add(str, hash, amdgpu_version->second, hsaco);
+        return hsaco;
+      }
+    }
     bool dump_lls = false;
     if (dump_lls) {
       static int hsaco_count = 0;
@@ -960,9 +1067,49 @@ StatusOr<std::vector<uint8>> CompileToHsaco(
         kAMDGPUInlineThreshold));
 
     // Lower optimized LLVM module to HSA code object.
-    TF_ASSIGN_OR_RETURN(hsaco, EmitModuleToHsaco(module, target_machine.get()));
+    TF_ASSIGN_OR_RETURN(hsaco, EmitModuleToHsaco(module, target_machine.get(),
+                                                  relocatable));
     HsacoCache::Add(str, hash, amdgpu_version->second, hsaco);
+    if (!disk_cache_path.empty()) {
+      WriteHsacoToDiskCache(disk_cache_path, hsaco);
+    }
+  }
+  return hsaco;
+}
+
+StatusOr<std::vector<uint8>> LinkHsacoObjects(
+    const std::vector<std::vector<uint8>>& objects) {
+  TF_ASSIGN_OR_RETURN(std::string tempdir_name, GetCompileTempDirectory());
+  const bool keep_tempfiles = KeepCompileTempFiles();
+  std::string random_number = std::to_string(tensorflow::random::New64());
+
+  std::vector<std::string> isabin_paths;
+  isabin_paths.reserve(objects.size());
+  Status status;
+  for (int i = 0; i < objects.size() && status.ok(); ++i) {
+    isabin_paths.push_back(tensorflow::io::JoinPath(
+        tempdir_name, absl::StrCat("xla_link_", random_number, "_", i, ".o")));
+    status = tensorflow::WriteStringToFile(
+        tensorflow::Env::Default(), isabin_paths.back(),
+        absl::string_view(reinterpret_cast<const char*>(objects[i].data()),
+                          objects[i].size()));
+  }
+  std::string hsaco_path = tensorflow::io::JoinPath(
+      tempdir_name, absl::StrCat("xla_link_", random_number, ".hsaco"));
+  if (status.ok()) {
+    status = LinkObjectsToHsaco(isabin_paths, hsaco_path);
+  }
+  std::vector<uint8> hsaco;
+  if (status.ok()) {
+    hsaco = ReadBinaryFile(hsaco_path);
+  }
+  if (!keep_tempfiles) {
+    for (const std::string& isabin_path : isabin_paths) {
+      remove(isabin_path.c_str());
+    }
+    remove(hsaco_path.c_str());
   }
+  TF_RETURN_IF_ERROR(status);
   return hsaco;
 }
 
@@ -48,10 +48,18 @@ StatusOr<string> CompileToPtx(
 namespace amdgpu {
 // Compiles the argument module and returns it with LLVM AMDGPU backend.
 // rocdl_dir_path is the parent directory of ROCm-Device-Libs bitcode libraries.
-// The contents of the module may be changed.
+// The contents of the module may be changed. If relocatable is true, an
+// unlinked object file is returned instead of an HSA code object; it must be
+// passed to LinkHsacoObjects() before it can be loaded.
 StatusOr<std::vector<uint8>> CompileToHsaco(
     llvm::Module* module, GpuVersion gpu_version,
-    const HloModuleConfig& hlo_module_config, const string& rocdl_dir_path);
+    const HloModuleConfig& hlo_module_config, const string& rocdl_dir_path,
+    bool relocatable = false);
+
+// Links object files produced by CompileToHsaco(..., relocatable=true) into a
+// single HSA code object.
+StatusOr<std::vector<uint8>> LinkHsacoObjects(
+    const std::vector<std::vector<uint8>>& objects);
 }  // namespace amdgpu
 
 }  // namespace gpu
@@ -65,6 +65,9 @@ NcclCollectiveConfig GetNcclCollectiveConfig(const HloInstruction* hlo,
   }
   config.replica_count = replica_count;
   config.replica_groups = hlo->replica_groups();
+  // The combination of channel id and use_global_device_ids is checked by the
+  // HLO verifier.
+  config.group_mode = GetCollectiveOpGroupMode(hlo).ValueOrDie();
 
   if (hlo->channel_id().has_value()) {
     config.collective_op_kind = RendezvousKey::kCrossModule;
@@ -91,9 +94,11 @@ Status NcclCollectiveThunk::ExecuteOnStream(const ExecuteParams& params) {
   TF_ASSIGN_OR_RETURN(
       std::vector<GlobalDeviceId> participants,
       GetParticipatingDevices(global_device_id, *params.device_assn,
-                              config().replica_count, config().replica_groups));
+                              config().replica_groups, config().group_mode));
 
-  if (IsGlobalNcclConfig() && (participants.size() != config().replica_count)) {
+  if (IsGlobalNcclConfig() &&
+      (participants.size() != params.device_assn->replica_count() *
+                                  params.device_assn->computation_count())) {
     return InvalidArgument(
         "Partial replica groups are not allowed when using NCCL_COMM_ID "
         "environment configuration.");
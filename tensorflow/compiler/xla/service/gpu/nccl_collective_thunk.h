@@ -42,6 +42,7 @@ struct NcclCollectiveConfig {
   std::vector<PrimitiveType> operand_element_type;
   int64 replica_count;
   std::vector<ReplicaGroup> replica_groups;
+  CollectiveOpGroupMode group_mode;
   RendezvousKey::CollectiveOpKind collective_op_kind;
   int64 op_id;
 };
@@ -181,6 +181,16 @@ Status NVPTXCompiler::OptimizeHloPostLayoutAssignment(
   return Status::OK();
 }
 
+Status NVPTXCompiler::WriteAutotuneResults(AutotuneResults* results) {
+  TF_RETURN_IF_ERROR(GpuCompiler::WriteAutotuneResults(results));
+  return GemmAlgorithmPicker::WriteAutotuneResults(results);
+}
+
+Status NVPTXCompiler::LoadAutotuneResults(const AutotuneResults& results) {
+  TF_RETURN_IF_ERROR(GpuCompiler::LoadAutotuneResults(results));
+  return GemmAlgorithmPicker::LoadAutotuneResults(results);
+}
+
 namespace {
 absl::optional<bool> CanShareBufferHint(const HloInstruction* user,
                                         const HloInstruction* operand,
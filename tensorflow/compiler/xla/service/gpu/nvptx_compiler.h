@@ -46,6 +46,10 @@ class NVPTXCompiler : public GpuCompiler {
       HloModule* hlo_module, se::StreamExecutor* stream_exec,
       se::DeviceMemoryAllocator* device_allocator) override;
 
+  Status WriteAutotuneResults(AutotuneResults* results) override;
+
+  Status LoadAutotuneResults(const AutotuneResults& results) override;
+
   HloDataflowAnalysis::CanShareBuffer GetCanShareBuffer() override;
 
   GpuVersion GetGpuVersion(se::StreamExecutor* stream_exec) override;
@@ -122,14 +122,111 @@ int ComputeStreamToAssign(
   return stream_assignment.StreamCount();
 }
 
+// Returns whether `hlo` is worth running concurrently with other instructions
+// when streams are assigned with a stream budget. Instructions that only
+// forward or reinterpret buffers stay on the stream of their operands.
+bool IsConcurrencyCandidate(const HloInstruction& hlo) {
+  switch (hlo.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kTuple:
+      return false;
+    default:
+      return true;
+  }
+}
+
+// Returns the stream to assign to `hlo` when up to `max_streams` streams may be
+// used. `last_hlo_on_stream[i]` is the most recent candidate instruction that
+// was assigned stream i. A stream whose last instruction `hlo` depends on can
+// take `hlo` without serializing it behind unrelated work; the stream of the
+// operands is preferred among those to avoid cross-stream synchronization. If
+// there is no such stream, a new one is opened while the budget allows it.
+int ComputeStreamToAssignWithBudget(
+    const HloInstruction& hlo, const StreamAssignment& stream_assignment,
+    const HloReachabilityMap& reachability,
+    const std::vector<const HloInstruction*>& last_hlo_on_stream,
+    int max_streams) {
+  int operand_stream_num = kInvalidStreamNum;
+  for (const auto* operand : hlo.operands()) {
+    if (stream_assignment.HasStreamAssigned(*operand)) {
+      operand_stream_num = std::max(
+          operand_stream_num, stream_assignment.StreamNumberForHlo(*operand));
+    }
+  }
+  if (!IsConcurrencyCandidate(hlo)) {
+    return IsStreamNumValid(operand_stream_num) ? operand_stream_num : 0;
+  }
+
+  auto is_free = [&](int stream_num) {
+    return stream_num >= last_hlo_on_stream.size() ||
+           last_hlo_on_stream[stream_num] == nullptr ||
+           reachability.IsReachable(last_hlo_on_stream[stream_num], &hlo);
+  };
+  if (IsStreamNumValid(operand_stream_num) && is_free(operand_stream_num)) {
+    return operand_stream_num;
+  }
+  for (int stream_num = 0; stream_num < stream_assignment.StreamCount();
+       ++stream_num) {
+    if (is_free(stream_num)) {
+      return stream_num;
+    }
+  }
+  if (stream_assignment.StreamCount() < max_streams) {
+    return stream_assignment.StreamCount();
+  }
+  return IsStreamNumValid(operand_stream_num) ? operand_stream_num : 0;
+}
+
+// Returns the largest stream assigned to an operand of `hlo` other than
+// `excluded_stream_num`, or 0 if there is none.
+int OperandStreamExcluding(const HloInstruction& hlo,
+                           const StreamAssignment& stream_assignment,
+                           int excluded_stream_num) {
+  int stream_num = 0;
+  for (const auto* operand : hlo.operands()) {
+    if (stream_assignment.HasStreamAssigned(*operand)) {
+      int operand_stream_num = stream_assignment.StreamNumberForHlo(*operand);
+      if (operand_stream_num != excluded_stream_num) {
+        stream_num = std::max(stream_num, operand_stream_num);
+      }
+    }
+  }
+  return stream_num;
+}
+
 }  // namespace
 
+bool RunsOnCollectiveStream(const HloInstruction& hlo) {
+  const auto& debug_options = hlo.GetModule()->config().debug_options();
+  if (!debug_options.xla_gpu_async_collectives() ||
+      debug_options.xla_gpu_disable_multi_streaming() ||
+      debug_options.xla_gpu_use_random_streams()) {
+    return false;
+  }
+  switch (hlo.opcode()) {
+    case HloOpcode::kAllGather:
+    case HloOpcode::kAllReduce:
+    case HloOpcode::kAllToAll:
+      return true;
+    default:
+      return false;
+  }
+}
+
 std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
   auto stream_assignment = absl::make_unique<StreamAssignment>();
   const HloComputation& computation = *module.entry_computation();
   std::unique_ptr<HloReachabilityMap> reachability =
       HloReachabilityMap::Build(&computation);
   std::vector<const HloInstruction*> seen_gemms;
+  const auto& debug_options = module.config().debug_options();
+  const int max_streams =
+      debug_options.xla_gpu_disable_multi_streaming() ||
+              debug_options.xla_gpu_use_random_streams()
+          ? 0
+          : debug_options.xla_gpu_max_concurrent_streams();
+  std::vector<const HloInstruction*> last_hlo_on_stream;
   // The execution of different RNG Hlo instructions in the same module updates
   // a common global variable. To avoid a race condition, we simply assign all
   // RNG kernels to the same stream to make them run sequentially.
@@ -137,16 +234,46 @@ std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
   // TODO(b/111791052): If we remove such a common variable, we will need to
   // clean up the code here.
   int stream_num_for_rng = kInvalidStreamNum;
+  // NCCL collectives must be issued in the same order on every participant, so
+  // all of them share one stream. No other instruction is placed on it, which
+  // lets collectives run concurrently with independent compute; consumers wait
+  // for them through the usual cross-stream dependencies.
+  int stream_num_for_collectives = kInvalidStreamNum;
   for (const auto* hlo : computation.MakeInstructionPostOrder()) {
     // If we ever enable fusion of RNG instructions, we will need to extend this
     // code to look inside a fused instruction.
-    int stream_num = (hlo->opcode() == HloOpcode::kRng &&
-                      IsStreamNumValid(stream_num_for_rng))
-                         ? stream_num_for_rng
-                         : ComputeStreamToAssign(*hlo, *stream_assignment,
-                                                 *reachability, seen_gemms);
+    int stream_num;
+    if (RunsOnCollectiveStream(*hlo)) {
+      if (!IsStreamNumValid(stream_num_for_collectives)) {
+        stream_num_for_collectives = stream_assignment->StreamCount();
+      }
+      stream_num = stream_num_for_collectives;
+    } else if (hlo->opcode() == HloOpcode::kRng &&
+               IsStreamNumValid(stream_num_for_rng)) {
+      stream_num = stream_num_for_rng;
+    } else if (max_streams > 1 && hlo->opcode() != HloOpcode::kParameter &&
+               hlo->opcode() != HloOpcode::kConstant) {
+      stream_num = ComputeStreamToAssignWithBudget(
+          *hlo, *stream_assignment, *reachability, last_hlo_on_stream,
+          max_streams);
+    } else {
+      stream_num = ComputeStreamToAssign(*hlo, *stream_assignment,
+                                         *reachability, seen_gemms);
+    }
+    if (IsStreamNumValid(stream_num_for_collectives) &&
+        stream_num == stream_num_for_collectives &&
+        !RunsOnCollectiveStream(*hlo)) {
+      stream_num = OperandStreamExcluding(*hlo, *stream_assignment,
+                                          stream_num_for_collectives);
+    }
     if (IsStreamNumValid(stream_num)) {
       stream_assignment->AssignStreamToHlo(hlo, stream_num);
+      if (IsConcurrencyCandidate(*hlo)) {
+        if (stream_num >= last_hlo_on_stream.size()) {
+          last_hlo_on_stream.resize(stream_num + 1, nullptr);
+        }
+        last_hlo_on_stream[stream_num] = hlo;
+      }
       if (hlo->opcode() == HloOpcode::kRng &&
           !IsStreamNumValid(stream_num_for_rng)) {
         stream_num_for_rng = stream_num;
@@ -37,6 +37,10 @@ class StreamAssignment {
   absl::flat_hash_map<const HloInstruction*, int> hlo_to_stream_number_;
 };
 
+// Returns whether `hlo` is a collective that AssignStreams places on the
+// dedicated collective stream, so that it overlaps with independent compute.
+bool RunsOnCollectiveStream(const HloInstruction& hlo);
+
 // Assigns GPU streams to instructions in `module`.
 std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module);
 
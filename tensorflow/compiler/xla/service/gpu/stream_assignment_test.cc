@@ -139,5 +139,79 @@ TEST_F(StreamAssignmentTest, LatticeMatMul) {
             assignment->StreamNumberForHlo(*d31));
 }
 
+TEST_F(StreamAssignmentTest, ConcurrentElementwiseWithStreamBudget) {
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_2x2_, /*name=*/"x"));
+  HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, f32_2x2_, /*name=*/"y"));
+  HloInstruction* add = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kAdd, x, y));
+  HloInstruction* mul = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kMultiply, x, y));
+  HloInstruction* sub = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kSubtract, x, y));
+  HloInstruction* sum1 = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kAdd, add, mul));
+  HloInstruction* sum2 = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kAdd, sum1, sub));
+
+  HloModuleConfig config;
+  auto debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_disable_multi_streaming(false);
+  debug_options.set_xla_gpu_max_concurrent_streams(2);
+  config.set_debug_options(debug_options);
+  auto module = absl::make_unique<HloModule>("test_module", config);
+  module->AddEntryComputation(builder.Build(sum2));
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  // Independent elementwise ops are spread over streams, but never more than
+  // the budget allows.
+  EXPECT_NE(assignment->StreamNumberForHlo(*add),
+            assignment->StreamNumberForHlo(*mul));
+  EXPECT_EQ(assignment->StreamCount(), 2);
+}
+
+TEST_F(StreamAssignmentTest, AsyncCollectivesGetDedicatedStream) {
+  const char* const hlo_text = R"(
+HloModule AsyncCollectives
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY entry {
+  p0 = f32[2,2] parameter(0)
+  p1 = f32[2,2] parameter(1)
+  grad = f32[2,2] multiply(p0, p1)
+  all-reduce = f32[2,2] all-reduce(grad), to_apply=add
+  compute = f32[2,2] add(p0, p1)
+  ROOT result = f32[2,2] add(all-reduce, compute)
+}
+)";
+  HloModuleConfig config;
+  auto debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_disable_multi_streaming(false);
+  debug_options.set_xla_gpu_async_collectives(true);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text, config));
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  const HloInstruction* all_reduce =
+      FindInstruction(module.get(), "all-reduce");
+  int collective_stream = assignment->StreamNumberForHlo(*all_reduce);
+  // Neither the producer, an independent op nor the consumer of the
+  // all-reduce shares its stream.
+  for (absl::string_view name : {"grad", "compute", "result"}) {
+    EXPECT_NE(assignment->StreamNumberForHlo(
+                  *FindInstruction(module.get(), name)),
+              collective_stream)
+        << name;
+  }
+}
+
 }  // namespace gpu
 }  // namespace xla
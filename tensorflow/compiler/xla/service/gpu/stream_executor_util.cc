@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/util.h"
@@ -191,6 +192,23 @@ tensorflow::mutex_lock LockGpu(const se::StreamExecutor* stream_exec) {
   return tensorflow::mutex_lock{it->second};
 }
 
+std::string AutotuneDeviceKey(se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+  std::string key =
+      absl::StrCat(desc.name(), "; ", desc.platform_version(), "; ",
+                   desc.rocm_amdgpu_gcn_arch_name(), "; driver ",
+                   desc.driver_version(), "; runtime ", desc.runtime_version());
+  if (auto* dnn = stream_exec->AsDnn()) {
+    StatusOr<se::dnn::VersionInfo> version_or = dnn->GetVersion();
+    if (version_or.ok()) {
+      const se::dnn::VersionInfo& version = version_or.ValueOrDie();
+      absl::StrAppend(&key, "; dnn ", version.major_version(), ".",
+                      version.minor_version(), ".", version.patch());
+    }
+  }
+  return key;
+}
+
 StatusOr<std::unique_ptr<se::KernelBase>> CreateKernel(
     absl::string_view kernel_name, uint64 num_args, absl::string_view ptx,
     absl::Span<const uint8> cubin_data, se::StreamExecutor* stream_exec) {
@@ -60,6 +60,11 @@ XlaConvLayoutsToStreamExecutorLayouts(const ConvolutionDimensionNumbers& dnums,
 // device while another thread is using it.
 tensorflow::mutex_lock LockGpu(const se::StreamExecutor* stream_exec);
 
+// Returns a string identifying the device model of stream_exec together with
+// its driver, runtime and DNN library versions. Autotuning results measured on
+// devices with the same key are interchangeable, including across processes.
+std::string AutotuneDeviceKey(se::StreamExecutor* stream_exec);
+
 // Creates a kernel with a provided name, based from provided PTX in ptx.
 // The kernel should be executed using the provided executor.
 // The argument cubin_data represents compiled PTX and may be left empty.
@@ -106,8 +106,7 @@ HloInstruction* HloComputation::AddInstruction(
 HloInstruction* HloComputation::AddInstructionInternal(
     std::unique_ptr<HloInstruction> instruction) {
   if (parent() != nullptr) {
-    instruction->UniquifyName(&parent()->instruction_name_uniquer());
-    instruction->SetUniqueId(parent()->NewUniqueInstructionId());
+    parent()->UniquifyInstructionNameAndId(instruction.get());
   }
   instruction->set_parent(this);
   HloInstruction* pinst = instruction.get();
@@ -2349,6 +2349,40 @@ static StatusOr<bool> PerformReductionStep(
   return true;
 }
 
+// Adds to `sum` the elements of `arg` which reduce into one output element.
+// The first of them is at `linear_index` in the data of `arg`; the others are
+// reached by walking the reduced dimensions, whose sizes and strides are given
+// minor-most first, so that elements are added in the same order as
+// ShapeUtil::ForEachIndex visits them.
+template <typename NativeT>
+double SumReducedElements(const LiteralBase& arg, int64 linear_index,
+                          absl::Span<const int64> reduced_sizes,
+                          absl::Span<const int64> reduced_strides,
+                          double sum) {
+  absl::Span<const NativeT> data = arg.data<NativeT>();
+  for (const int64 size : reduced_sizes) {
+    if (size == 0) {
+      return sum;
+    }
+  }
+  DimensionVector reduced_index(reduced_sizes.size(), 0);
+  while (true) {
+    sum += static_cast<double>(data[linear_index]);
+    int64 d = 0;
+    for (; d < reduced_sizes.size(); ++d) {
+      linear_index += reduced_strides[d];
+      if (++reduced_index[d] < reduced_sizes[d]) {
+        break;
+      }
+      linear_index -= reduced_strides[d] * reduced_sizes[d];
+      reduced_index[d] = 0;
+    }
+    if (d == reduced_sizes.size()) {
+      return sum;
+    }
+  }
+}
+
 static StatusOr<bool> GenerateReduceOutputElement(
     bool is_tuple, absl::Span<const int64> output_index,
 
@@ -2377,14 +2411,42 @@ static StatusOr<bool> GenerateReduceOutputElement(
 
   if (use_fast_add) {
     double computed_result = *init_values[0]->GetAsDouble({});
-    auto reduction_step =
-        [&](absl::Span<const int64> input_index) -> StatusOr<bool> {
-      double argument = *input_args[0]->GetAsDouble(input_index);
-      computed_result += argument;
-      return true;
-    };
-    TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
-        arg_shape, base, arg_dim_counts, arg_dim_steps, reduction_step));
+    DimensionVector reduced_sizes;
+    DimensionVector reduced_strides;
+    for (const int64 dim : LayoutUtil::MinorToMajor(arg_shape)) {
+      if (arg_dim_steps[dim] != 0) {
+        reduced_sizes.push_back(arg_dimensions[dim]);
+        reduced_strides.push_back(
+            IndexUtil::GetDimensionStride(arg_shape, dim));
+      }
+    }
+    const int64 linear_index =
+        IndexUtil::MultidimensionalIndexToLinearIndex(arg_shape, base);
+    switch (arg_shape.element_type()) {
+      case F16:
+        computed_result = SumReducedElements<Eigen::half>(
+            *input_args[0], linear_index, reduced_sizes, reduced_strides,
+            computed_result);
+        break;
+      case BF16:
+        computed_result = SumReducedElements<bfloat16>(
+            *input_args[0], linear_index, reduced_sizes, reduced_strides,
+            computed_result);
+        break;
+      case F32:
+        computed_result = SumReducedElements<float>(
+            *input_args[0], linear_index, reduced_sizes, reduced_strides,
+            computed_result);
+        break;
+      case F64:
+        computed_result = SumReducedElements<double>(
+            *input_args[0], linear_index, reduced_sizes, reduced_strides,
+            computed_result);
+        break;
+      default:
+        return InternalError("Unexpected floating point type %s",
+                             PrimitiveType_Name(arg_shape.element_type()));
+    }
     TF_RETURN_IF_ERROR(results[0].SetFromDouble(output_index, computed_result));
     return true;
   }
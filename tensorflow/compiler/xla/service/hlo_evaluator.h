@@ -338,6 +338,17 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (LayoutUtil::Equal(operand_literal.shape().layout(),
+                          result.shape().layout())) {
+      // With equal layouts, elements at the same position in the underlying
+      // arrays have the same multi-dimensional index.
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = unary_op(operand_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
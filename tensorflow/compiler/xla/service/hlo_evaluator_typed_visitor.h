@@ -2981,12 +2981,24 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& rhs_literal = parent_->GetEvaluatedLiteralFor(rhs);
 
     Literal result(shape);
-
+    auto typed_binary_op = ConvertBinaryFunction(binary_op);
+
+    if (LayoutUtil::Equal(lhs_literal.shape().layout(),
+                          result.shape().layout()) &&
+        LayoutUtil::Equal(rhs_literal.shape().layout(),
+                          result.shape().layout())) {
+      absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+      absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = typed_binary_op(lhs_data[i], rhs_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
-          return ConvertBinaryFunction(binary_op)(
-              lhs_literal.Get<ReturnT>(multi_index),
-              rhs_literal.Get<ReturnT>(multi_index));
+          return typed_binary_op(lhs_literal.Get<ReturnT>(multi_index),
+                                 rhs_literal.Get<ReturnT>(multi_index));
         }));
     return std::move(result);
   }
@@ -3009,6 +3021,21 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
+    if (LayoutUtil::Equal(lhs_literal.shape().layout(),
+                          result.shape().layout()) &&
+        LayoutUtil::Equal(rhs_literal.shape().layout(),
+                          result.shape().layout()) &&
+        LayoutUtil::Equal(ehs_literal.shape().layout(),
+                          result.shape().layout())) {
+      absl::Span<const LhsType> lhs_data = lhs_literal.data<LhsType>();
+      absl::Span<const RhsType> rhs_data = rhs_literal.data<RhsType>();
+      absl::Span<const EhsType> ehs_data = ehs_literal.data<EhsType>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return ternary_op(lhs_literal.Get<LhsType>(multi_index),
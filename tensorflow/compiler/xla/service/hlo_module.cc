@@ -119,6 +119,12 @@ HloComputation* HloModule::AddComputationInternal(
   return computations_.back().get();
 }
 
+void HloModule::UniquifyInstructionNameAndId(HloInstruction* instruction) {
+  tensorflow::mutex_lock lock(instruction_identifiers_mutex_);
+  instruction->UniquifyName(&instruction_name_uniquer_);
+  instruction->SetUniqueId(NewUniqueInstructionId());
+}
+
 HloComputation* HloModule::AddEntryComputation(
     std::unique_ptr<HloComputation> computation) {
   return AddComputationInternal(std::move(computation), /*is_entry=*/true,
@@ -270,6 +270,11 @@ class HloModule {
   // Returns the NameUniquer for uniquing instruction names in this module.
   NameUniquer& instruction_name_uniquer() { return instruction_name_uniquer_; }
 
+  // Uniquifies the name of a newly added instruction and assigns it a new
+  // unique id. Unlike the two functions above, it is safe to call concurrently,
+  // e.g. from a pass running on several computations of the module at once.
+  void UniquifyInstructionNameAndId(HloInstruction* instruction);
+
   // Assign a new unique dense id for an instruction
   int NewUniqueInstructionId() {
     int result = next_unique_id_;
@@ -401,6 +406,8 @@ class HloModule {
   NameUniquer computation_name_uniquer_{/*separator=*/"."};
   NameUniquer instruction_name_uniquer_{/*separator=*/"."};
   int next_unique_id_ = 0;
+  // Serializes UniquifyInstructionNameAndId.
+  tensorflow::mutex instruction_identifiers_mutex_;
 
   // Used to keep track of the next unique module id that should be assigned.
   static std::atomic<int> next_unique_module_id_;
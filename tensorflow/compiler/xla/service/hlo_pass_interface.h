@@ -43,6 +43,10 @@ class HloPassInterface {
   virtual StatusOr<bool> RunOnModuleGroup(HloModuleGroup* module_group) = 0;
 
   virtual bool IsPassPipeline() { return false; }
+
+  // Returns true if this is an HloComputationPass, whose runs on different
+  // computations of a module are independent of each other.
+  virtual bool IsComputationLocal() { return false; }
 };
 
 // Base class for passes which are module-scoped.
@@ -68,6 +72,30 @@ class HloModulePass : public HloPassInterface {
   virtual void UpdateLayout(Shape* shape) {}
 };
 
+// Base class for module-scoped passes which transform each non-fusion
+// computation on its own: running the pass on a computation may only read and
+// modify that computation and the instructions in it, and must not add or
+// remove computations. HloPassPipeline may run such passes on the computations
+// of a module concurrently.
+class HloComputationPass : public HloModulePass {
+ public:
+  // Run the pass on the given computation. Returns whether it modified the
+  // computation.
+  virtual StatusOr<bool> RunOnComputation(HloComputation* computation) = 0;
+
+  StatusOr<bool> Run(HloModule* module) override {
+    bool changed = false;
+    for (HloComputation* computation : module->MakeNonfusionComputations()) {
+      TF_ASSIGN_OR_RETURN(bool computation_changed,
+                          RunOnComputation(computation));
+      changed |= computation_changed;
+    }
+    return changed;
+  }
+
+  bool IsComputationLocal() override { return true; }
+};
+
 // Base class for passes which are module-group scoped. These passes cannot run
 // on an HLO module.
 class HloModuleGroupPass : public HloPassInterface {
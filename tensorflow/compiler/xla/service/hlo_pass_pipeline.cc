@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -95,6 +96,18 @@ void RecordPassEndMetadata(HloModuleGroup& module_group,
   }
 }
 
+int64 InstructionCount(const HloModule& module) {
+  return module.instruction_count();
+}
+
+int64 InstructionCount(const HloModuleGroup& module_group) {
+  int64 count = 0;
+  for (const HloModule* module : module_group.modules()) {
+    count += module->instruction_count();
+  }
+  return count;
+}
+
 void SetInstructionMetadata(HloModule& module) {
   StatusOr<int64> pass_id = module.metadata()->current_pass_id();
   if (!pass_id.ok()) {
@@ -167,10 +180,23 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     VLOG(1) << "  HLO pass " << pass_name;
     VLOG(2) << "  Module hash " << hlo->Hash();
     if (!pass->IsPassPipeline()) {
-      compilation_stats_->StartPass(pass_name);
+      compilation_stats_->StartPass(pass_name, InstructionCount(*hlo));
+    } else if (thread_pool_ != nullptr) {
+      auto* nested_pipeline = static_cast<HloPassPipeline*>(pass);
+      if (nested_pipeline->thread_pool_ == nullptr) {
+        nested_pipeline->set_thread_pool(thread_pool_);
+      }
     }
     RecordPassStartMetadata(*hlo, pass_name, pipeline_name);
-    TF_ASSIGN_OR_RETURN(bool pass_changed, RunHelper(pass, hlo));
+    bool pass_changed;
+    if (thread_pool_ != nullptr && pass->IsComputationLocal()) {
+      TF_ASSIGN_OR_RETURN(
+          pass_changed,
+          RunComputationPassInParallel(static_cast<HloComputationPass*>(pass),
+                                       hlo));
+    } else {
+      TF_ASSIGN_OR_RETURN(pass_changed, RunHelper(pass, hlo));
+    }
     SetInstructionMetadata(*hlo);
     MaybeDumpHloAndSaveFilenames(*hlo,
                                  /*after_pass_name=*/pass_name,
@@ -184,12 +210,46 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     }
     TF_RETURN_IF_ERROR(RunInvariantCheckers(hlo, pass_name));
     if (!pass->IsPassPipeline()) {
-      compilation_stats_->EndPass(pass_name);
+      compilation_stats_->EndPass(pass_name, InstructionCount(*hlo));
     }
   }
   return changed;
 }
 
+StatusOr<bool> HloPassPipeline::RunComputationPassInParallel(
+    HloComputationPass* pass, HloModule* module) {
+  std::vector<HloComputation*> computations =
+      module->MakeNonfusionComputations();
+  std::vector<StatusOr<bool>> results(computations.size(), false);
+  tensorflow::BlockingCounter counter(computations.size());
+  for (int i = 0; i < computations.size(); ++i) {
+    thread_pool_->Schedule([&, i] {
+      results[i] = pass->RunOnComputation(computations[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  bool changed = false;
+  for (StatusOr<bool>& result : results) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed, std::move(result));
+    changed |= computation_changed;
+  }
+  module->Cleanup();
+  return changed;
+}
+
+StatusOr<bool> HloPassPipeline::RunComputationPassInParallel(
+    HloComputationPass* pass, HloModuleGroup* module_group) {
+  bool changed = false;
+  for (HloModule* module : module_group->modules()) {
+    TF_ASSIGN_OR_RETURN(bool module_changed,
+                        RunComputationPassInParallel(pass, module));
+    changed |= module_changed;
+  }
+  return changed;
+}
+
 std::vector<HloPassInterface*> HloPassPipeline::GetEnabledPasses(
     const DebugOptions& debug_options) {
   if (debug_options.xla_disable_all_hlo_passes()) {
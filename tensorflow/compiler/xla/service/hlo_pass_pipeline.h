@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 
@@ -78,6 +79,16 @@ class HloPassPipeline : public HloPassInterface {
 #endif  // NDEBUG
   }
 
+  // Opts into running computation-local passes (see HloComputationPass) on the
+  // computations of a module concurrently, using the given thread pool. The
+  // pool is also used by the pipelines nested in this one which do not have a
+  // pool of their own. It must outlive the pipeline and must not be the pool
+  // the pipeline itself runs on. Instruction names and ids created by such
+  // passes then depend on thread scheduling.
+  void set_thread_pool(tensorflow::thread::ThreadPool* thread_pool) {
+    thread_pool_ = thread_pool;
+  }
+
   StatusOr<bool> Run(HloModule* module) override;
   StatusOr<bool> RunOnModuleGroup(HloModuleGroup* module_group) override;
 
@@ -110,6 +121,13 @@ class HloPassPipeline : public HloPassInterface {
   StatusOr<bool> RunPassesInternal(HloT* hlo,
                                    absl::Span<HloPassInterface* const> passes);
 
+  // Runs the given computation-local pass on all the non-fusion computations of
+  // the given HLO concurrently on thread_pool_.
+  StatusOr<bool> RunComputationPassInParallel(HloComputationPass* pass,
+                                              HloModule* module);
+  StatusOr<bool> RunComputationPassInParallel(HloComputationPass* pass,
+                                              HloModuleGroup* module_group);
+
   // Helpers which run the given passes on the given HLO construct. These
   // helpers enable templating of the core of the pipeline logic by providing
   // HloModule and HloModuleGroup specific methods with the same name.
@@ -130,6 +148,8 @@ class HloPassPipeline : public HloPassInterface {
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
   bool run_called_ = false;
 
+  tensorflow::thread::ThreadPool* thread_pool_ = nullptr;
+
   CompilationStats* compilation_stats_;
   // Default stats instance for when one is not passed in the constructor.
   // Use via compilation_stats_, not directly.
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/compilation_stats.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -22,6 +24,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -82,6 +86,20 @@ class BazToQuxModuleGroupPass : public HloModuleGroupPass {
   }
 };
 
+// A computation pass which adds a negation of the root of every computation
+// and makes it the new root.
+class NegateRootComputationPass : public HloComputationPass {
+  absl::string_view name() const override { return "negate-root"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    HloInstruction* root = computation->root_instruction();
+    computation->set_root_instruction(
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            root->shape(), HloOpcode::kNegate, root)));
+    return true;
+  }
+};
+
 // An invariant checker pass which returns an error if there exists an
 // instruction named 'bar'.
 class BarBlowerUpper : public HloModulePass {
@@ -142,6 +160,52 @@ ENTRY main {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(HloPassPipelineTest, ComputationPassInParallel) {
+  const string module_str = R"(
+HloModule ComputationPassInParallel
+
+callee1 {
+  p = f32[] parameter(0)
+  ROOT a = f32[] add(p, p)
+}
+
+callee2 {
+  p = f32[] parameter(0)
+  ROOT m = f32[] multiply(p, p)
+}
+
+ENTRY main {
+  a = f32[] parameter(0)
+  c1 = f32[] call(a), to_apply=callee1
+  ROOT c2 = f32[] call(c1), to_apply=callee2
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  tensorflow::thread::ThreadPool thread_pool(tensorflow::Env::Default(),
+                                             TestName(), /*num_threads=*/4);
+  std::unique_ptr<CompilationStats> stats = CompilationStats::MakeStats();
+  HloPassPipeline pipeline(TestName(), stats.get());
+  pipeline.set_thread_pool(&thread_pool);
+  pipeline.AddPass<NegateRootComputationPass>();
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+  absl::flat_hash_set<int> unique_ids;
+  for (HloComputation* computation : module->computations()) {
+    EXPECT_EQ(computation->root_instruction()->opcode(), HloOpcode::kNegate);
+    for (HloInstruction* instruction : computation->instructions()) {
+      EXPECT_TRUE(unique_ids.insert(instruction->unique_id()).second);
+    }
+  }
+
+  std::vector<CompilationStats::PassReport> reports = stats->GetPassReports();
+  ASSERT_THAT(reports, SizeIs(1));
+  EXPECT_EQ(reports[0].pass_name, "negate-root");
+  EXPECT_EQ(reports[0].num_runs, 1);
+  EXPECT_EQ(reports[0].instruction_count_delta, 3);
+}
+
 TEST_F(HloPassPipelineTest, MixedPipeline) {
   // Test a pipeline with both a module pass and a module group pass.
   const string module_0_str = R"(
@@ -19,13 +19,66 @@ limitations under the License.
 
 namespace xla {
 
+void HloReachabilityMap::IntervalSet::Set(int index) {
+  // The first interval beginning after `index`.
+  auto next = absl::c_upper_bound(intervals_, index,
+                                  [](int value, const Interval& interval) {
+                                    return value < interval.begin;
+                                  });
+  if (next != intervals_.begin() && index < std::prev(next)->end) {
+    return;
+  }
+  bool extends_prev =
+      next != intervals_.begin() && std::prev(next)->end == index;
+  bool extends_next = next != intervals_.end() && next->begin == index + 1;
+  if (extends_prev && extends_next) {
+    std::prev(next)->end = next->end;
+    intervals_.erase(next);
+  } else if (extends_prev) {
+    std::prev(next)->end = index + 1;
+  } else if (extends_next) {
+    next->begin = index;
+  } else {
+    intervals_.insert(next, Interval{index, index + 1});
+  }
+}
+
+void HloReachabilityMap::IntervalSet::OrWith(const IntervalSet& other) {
+  if (other.intervals_.empty()) {
+    return;
+  }
+  if (intervals_.empty()) {
+    intervals_ = other.intervals_;
+    return;
+  }
+  std::vector<Interval> merged;
+  merged.reserve(intervals_.size() + other.intervals_.size());
+  auto it = intervals_.begin();
+  auto other_it = other.intervals_.begin();
+  while (it != intervals_.end() || other_it != other.intervals_.end()) {
+    const Interval& next =
+        other_it == other.intervals_.end() ||
+                (it != intervals_.end() && it->begin < other_it->begin)
+            ? *it++
+            : *other_it++;
+    // Intervals which overlap or touch are merged so that the representation
+    // of a set is unique.
+    if (!merged.empty() && next.begin <= merged.back().end) {
+      merged.back().end = std::max(merged.back().end, next.end);
+    } else {
+      merged.push_back(next);
+    }
+  }
+  intervals_ = std::move(merged);
+}
+
 HloReachabilityMap::HloReachabilityMap(
     absl::Span<const HloInstruction* const> instructions)
     : size_(instructions.size()) {
-  bit_vectors_.reserve(size_);
+  reachable_from_.resize(size_);
   for (const HloInstruction* hlo : instructions) {
-    indices_[GetKey(hlo)] = bit_vectors_.size();
-    bit_vectors_.emplace_back(size_);
+    int index = indices_.size();
+    indices_[GetKey(hlo)] = index;
   }
   CHECK_EQ(size_, indices_.size());  // instructions should be unique
 }
@@ -33,29 +86,30 @@ HloReachabilityMap::HloReachabilityMap(
 bool HloReachabilityMap::SetReachabilityToUnion(
     absl::Span<const HloInstruction* const> inputs,
     const HloInstruction* instruction) {
-  BitVector& bit_vector = GetBitVector(instruction);
-  tmp_bit_vector_ = bit_vector;
-  SetReachabilityToUnionHelper(inputs, instruction, &bit_vector);
-  return bit_vector != tmp_bit_vector_;
+  IntervalSet& reachable_from = GetReachableFrom(instruction);
+  tmp_interval_set_ = reachable_from;
+  SetReachabilityToUnionHelper(inputs, instruction, &reachable_from);
+  return reachable_from != tmp_interval_set_;
 }
 
 void HloReachabilityMap::FastSetReachabilityToUnion(
     absl::Span<const HloInstruction* const> inputs,
     const HloInstruction* instruction) {
-  SetReachabilityToUnionHelper(inputs, instruction, &GetBitVector(instruction));
+  SetReachabilityToUnionHelper(inputs, instruction,
+                               &GetReachableFrom(instruction));
 }
 
 void HloReachabilityMap::SetReachabilityToUnionHelper(
     absl::Span<const HloInstruction* const> inputs,
-    const HloInstruction* instruction, BitVector* bit_vector) {
-  // If instruction is part of inputs, don't reset the bit_vector.
+    const HloInstruction* instruction, IntervalSet* reachable_from) {
+  // If instruction is part of inputs, don't reset the reachable_from set.
   if (!absl::c_linear_search(inputs, instruction)) {
-    bit_vector->SetToZero();
+    reachable_from->SetToZero();
   }
-  bit_vector->Set(GetIndex(instruction).v);
+  reachable_from->Set(GetIndex(instruction).v);
   for (const HloInstruction* input : inputs) {
     if (input != instruction) {
-      bit_vector->OrWith(GetBitVector(input));
+      reachable_from->OrWith(GetReachableFrom(input));
     }
   }
 }
@@ -70,7 +124,7 @@ void HloReachabilityMap::Replace(const HloInstruction* original,
 }
 
 void HloReachabilityMap::SetReachable(Index a, Index b) {
-  GetBitVector(b).Set(a.v);
+  GetReachableFrom(b).Set(a.v);
 }
 
 std::unique_ptr<HloReachabilityMap> HloReachabilityMap::Build(
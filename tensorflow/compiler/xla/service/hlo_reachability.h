@@ -17,9 +17,11 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_REACHABILITY_H_
 
 #include <cstdio>
+#include <iterator>
 #include <list>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/types/span.h"
@@ -35,11 +37,11 @@ namespace xla {
 
 // A class for representing reachability between HloInstructions.
 //
-// It has an adjacency matrix and it is up to the user of the class to set the
-// adjacency matrix such that it represents reachability, i.e. such that it is
-// transitive. That the graph be transitive is thus not an invariant of this
-// class, but it is required for the name of the class and its methods to make
-// sense.
+// It has an adjacency matrix, stored as one interval set per instruction, and
+// it is up to the user of the class to set the adjacency matrix such that it
+// represents reachability, i.e. such that it is transitive. That the graph be
+// transitive is thus not an invariant of this class, but it is required for
+// the name of the class and its methods to make sense.
 class HloReachabilityMap {
  public:
   // Sets up a graph with no edges and where the nodes correspond to the given
@@ -83,7 +85,7 @@ class HloReachabilityMap {
     friend class HloReachabilityMap;
 
     // Index assigned for a particular instruction.  The value is used to index
-    // into the vector of BitVectors and the BitVectors themselves.
+    // into the vector of IntervalSets and the IntervalSets themselves.
     int v;
   };
   Index GetIndex(const HloInstruction* instruction) const {
@@ -114,7 +116,9 @@ class HloReachabilityMap {
   bool IsReachable(const HloInstruction* a, const HloInstruction* b) const {
     return IsReachable(GetIndex(a), GetIndex(b));
   }
-  bool IsReachable(Index a, Index b) const { return GetBitVector(b).Get(a.v); }
+  bool IsReachable(Index a, Index b) const {
+    return GetReachableFrom(b).Get(a.v);
+  }
 
   // Returns true if "b" is reachable from "a" or "a" is reachable from "b"
   //
@@ -138,70 +142,76 @@ class HloReachabilityMap {
                const HloInstruction* replacement);
 
  private:
-  // A bit-vector implementation specialized for this use case which provides a
-  // fast bitwise OR operation not available in tensorflow::gtl::BitMap.
-  class BitVector {
+  // A set of instruction indices stored as a sorted list of maximal disjoint
+  // half-open intervals. Build indexes instructions in post order, in which
+  // the instructions a given instruction is reachable from form few runs of
+  // consecutive indices. Compared to a dense bit vector of one bit per
+  // instruction, this keeps the memory use and the cost of unions close to
+  // linear in the number of instructions on large computations.
+  class IntervalSet {
    public:
-    BitVector() = default;
-    BitVector(size_t size)
-        : size_(size), vector_((size + kBits - 1) / kBits, 0) {}
-
-    // Return the bit at the given index.
-    bool Get(size_t index) const {
-      DCHECK(index >= 0 && index < size_);
-      return vector_[index / kBits] & (1ull << (index % kBits));
+    IntervalSet() = default;
+
+    // Returns whether the given index is in the set.
+    bool Get(int index) const {
+      // The first interval beginning after `index`; the one before it is the
+      // only one which may contain `index`.
+      auto it = absl::c_upper_bound(
+          intervals_, index,
+          [](int value, const Interval& interval) {
+            return value < interval.begin;
+          });
+      return it != intervals_.begin() && index < std::prev(it)->end;
     }
 
-    // Set the bit at the given index.
-    void Set(size_t index) {
-      DCHECK(index >= 0 && index < size_);
-      vector_[index / kBits] |= 1ull << (index % kBits);
-    }
+    // Adds the given index to the set.
+    void Set(int index);
 
-    // Set this bitvector to the Logical OR of this bitvector and 'other'.
-    void OrWith(const BitVector& other) {
-      for (size_t i = 0; i < vector_.size(); ++i) {
-        vector_[i] |= other.vector_[i];
-      }
-    }
+    // Sets this set to the union of this set and 'other'.
+    void OrWith(const IntervalSet& other);
 
-    // Set the bitvector to all zeros.
-    void SetToZero() { std::fill(vector_.begin(), vector_.end(), 0); }
+    // Removes all the indices from the set.
+    void SetToZero() { intervals_.clear(); }
 
-    bool operator==(const BitVector& other) const {
-      return vector_ == other.vector_;
+    bool operator==(const IntervalSet& other) const {
+      return intervals_ == other.intervals_;
     }
-    bool operator!=(const BitVector& other) const {
-      return vector_ != other.vector_;
+    bool operator!=(const IntervalSet& other) const {
+      return !(*this == other);
     }
 
    private:
-    using Word = uint64;
-    static constexpr size_t kBits = 64;
+    struct Interval {
+      int begin;
+      int end;
 
-    // Number of bits in the bitvector.
-    size_t size_;
+      bool operator==(const Interval& other) const {
+        return begin == other.begin && end == other.end;
+      }
+    };
 
-    std::vector<Word> vector_;
+    std::vector<Interval> intervals_;
   };
 
-  // Return the bitvector storing the reachability-to of the given instruction.
-  const BitVector& GetBitVector(const HloInstruction* instruction) const {
-    return GetBitVector(GetIndex(instruction));
+  // Return the set of instructions the given instruction is reachable from.
+  const IntervalSet& GetReachableFrom(const HloInstruction* instruction) const {
+    return GetReachableFrom(GetIndex(instruction));
   }
-  BitVector& GetBitVector(const HloInstruction* instruction) {
-    return GetBitVector(GetIndex(instruction));
+  IntervalSet& GetReachableFrom(const HloInstruction* instruction) {
+    return GetReachableFrom(GetIndex(instruction));
   }
 
-  const BitVector& GetBitVector(Index index) const {
-    return bit_vectors_[index.v];
+  const IntervalSet& GetReachableFrom(Index index) const {
+    return reachable_from_[index.v];
+  }
+  IntervalSet& GetReachableFrom(Index index) {
+    return reachable_from_[index.v];
   }
-  BitVector& GetBitVector(Index index) { return bit_vectors_[index.v]; }
 
   // Helper for SetReachabilityToUnion/FastSetReachabilityToUnion.
   void SetReachabilityToUnionHelper(
       absl::Span<const HloInstruction* const> inputs,
-      const HloInstruction* instruction, BitVector* bit_vector);
+      const HloInstruction* instruction, IntervalSet* reachable_from);
 
   uint64 GetKey(const HloInstruction* instruction) const {
     uint64 unique_id = absl::bit_cast<uint32>(instruction->unique_id());
@@ -218,16 +228,17 @@ class HloReachabilityMap {
   const size_t size_;
 
   // Dense assignment from HloInstruction::unique_id to number. These numbers
-  // index into the bit_vectors_ vector and into the bits within a BitVector.
+  // index into the reachable_from_ vector and are the elements of the
+  // IntervalSets.
   absl::flat_hash_map<uint64, int> indices_;
 
-  // Bitvectors holding the reachability to each instruction. The bit vector for
-  // instruction X includes ones for each instruction which X is reachable from.
-  std::vector<BitVector> bit_vectors_;
+  // Sets holding the reachability to each instruction. The set for instruction
+  // X includes each instruction which X is reachable from.
+  std::vector<IntervalSet> reachable_from_;
 
   // A temporary used by SetReachabilityToUnion to avoid an allocation with each
   // call to the method.
-  BitVector tmp_bit_vector_;
+  IntervalSet tmp_interval_set_;
 };
 
 }  // namespace xla
@@ -82,6 +82,40 @@ TEST_F(HloReachabilityTest, Reachability) {
   EXPECT_FALSE(reachability.SetReachabilityToUnion({b, c}, d));
 }
 
+TEST_F(HloReachabilityTest, SetReachableOutOfOrder) {
+  auto builder = HloComputation::Builder(TestName());
+  std::vector<HloInstruction*> constants;
+  for (int i = 0; i < 6; ++i) {
+    constants.push_back(builder.AddInstruction(
+        HloInstruction::CreateConstant(LiteralUtil::CreateR0<float>(i))));
+  }
+  auto module = CreateNewVerifiedModule();
+  module->AddEntryComputation(builder.Build());
+
+  HloReachabilityMap reachability(constants);
+  HloInstruction* sink = constants[5];
+  for (int i : {3, 0, 1, 4}) {
+    reachability.SetReachable(constants[i], sink);
+  }
+  EXPECT_TRUE(reachability.IsReachable(constants[0], sink));
+  EXPECT_TRUE(reachability.IsReachable(constants[1], sink));
+  EXPECT_FALSE(reachability.IsReachable(constants[2], sink));
+  EXPECT_TRUE(reachability.IsReachable(constants[3], sink));
+  EXPECT_TRUE(reachability.IsReachable(constants[4], sink));
+  EXPECT_FALSE(reachability.IsReachable(sink, sink));
+
+  // Filling the gap joins the intervals; the union must be unchanged when
+  // recomputed.
+  reachability.SetReachable(constants[2], sink);
+  EXPECT_TRUE(reachability.IsReachable(constants[2], sink));
+  EXPECT_TRUE(reachability.SetReachabilityToUnion({sink}, sink));
+  EXPECT_TRUE(reachability.IsReachable(sink, sink));
+  EXPECT_FALSE(reachability.SetReachabilityToUnion({sink}, sink));
+  for (HloInstruction* constant : constants) {
+    EXPECT_TRUE(reachability.IsReachable(constant, sink));
+  }
+}
+
 TEST_F(HloReachabilityTest, NonTrivialReachability) {
   // Test reachability of a non-trivial computation:
   //
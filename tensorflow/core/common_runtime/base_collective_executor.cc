@@ -18,6 +18,7 @@ limitations under the License.
 #include <functional>
 #include <utility>
 
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -39,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 
 #define VALUE_IN_DEBUG_STRING false
 
@@ -49,8 +51,79 @@ bool IsCancelled(CancellationManager* cancel_mgr) {
   return cancel_mgr != nullptr &&
          (cancel_mgr->IsCancelled() || cancel_mgr->IsCancelling());
 }
+
+// Reductions of at most this many bytes, over groups whose members all run
+// on this worker, are fused with the other such reductions of their group
+// into reductions of about this many bytes. This saves launching a reduction
+// per tensor, e.g. per gradient of a model with many small layers. Zero
+// disables the fusion.
+int64 CollectiveBucketBytes() {
+  static const int64 bucket_bytes = [] {
+    int64 value;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar("TF_COLLECTIVE_BUCKET_BYTES", 0, &value));
+    return value;
+  }();
+  return bucket_bytes;
+}
+
+// A bucket that is not full runs this many microseconds after its first
+// reduction is ready, so that it overlaps with the computation of the
+// tensors of the next buckets.
+int64 CollectiveBucketLingerMicros() {
+  static const int64 linger_micros = [] {
+    int64 value;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar("TF_COLLECTIVE_BUCKET_LINGER_US", 100, &value));
+    return value;
+  }();
+  return linger_micros;
+}
+
+// Copies `src` into `dst`, which has the same number of elements, and waits
+// for the copy to complete.
+Status CopyFlatTensor(OpKernelContext* src_ctx, OpKernelContext* dst_ctx,
+                      Device* device, const Tensor& src, Tensor* dst) {
+  Tensor flat_src;
+  if (!flat_src.CopyFrom(src, TensorShape({src.NumElements()}))) {
+    return errors::Internal("Failed to flatten tensor of shape ",
+                            src.shape().DebugString());
+  }
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      src_ctx->op_device_context(), dst_ctx->op_device_context(), device,
+      device, src_ctx->input_alloc_attr(0), dst_ctx->output_alloc_attr(0),
+      &flat_src, dst, 0 /*dev_to_dev_stream_index*/,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
 }  // namespace
 
+struct BaseCollectiveExecutor::BucketedRequest {
+  OpKernelContext* ctx;  // Not owned
+  CollectiveParams col_params;
+  string exec_key;
+  StatusCallback done;
+};
+
+struct BaseCollectiveExecutor::BucketedInstance {
+  // Indexed by default rank.
+  std::vector<std::unique_ptr<BucketedRequest>> requests;
+  int num_requests = 0;
+  int64 num_elements = 0;
+};
+
+struct BaseCollectiveExecutor::ReduceBucket {
+  int64 id = 0;
+  int64 bytes = 0;
+  std::vector<std::shared_ptr<BucketedInstance>> instances;
+};
+
 /*static*/
 int64 CollectiveAdapter::AlignedChunkElts(int64 elt_bytes, int64 total_elts,
                                           int64 num_chunks) {
@@ -246,6 +319,7 @@ void BaseCollectiveExecutor::StartAbort(const Status& s) {
   if (cem_->GetNcclCommunicator() != nullptr) {
     cem_->GetNcclCommunicator()->StartAbort(status);
   }
+  AbortBuckets(status);
 }
 
 Status BaseCollectiveExecutor::GetStatus(const Status& s) {
@@ -269,9 +343,11 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
                                           StatusCallback done) {
   // See CompleteParamsAsync() how done() and the timeout callback interacts.
   const auto is_callback_called = std::make_shared<std::atomic<bool>>(false);
+  pending_time_.Start();
   auto done_safe = [this, done, ctx, is_callback_called](const Status& s) {
     bool called = is_callback_called->exchange(true);
     if (!called) {
+      pending_time_.Stop();
       if (!s.ok() && !IsCancelled(ctx->cancellation_manager())) {
         // This is a collective error. Abort CollectiveExecutor so that this
         // error can propagate to other workers.
@@ -288,6 +364,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         timeout_microseconds, [this, is_callback_called, done] {
           bool called = is_callback_called->exchange(true);
           if (!called) {
+            pending_time_.Stop();
             Status status(error::DEADLINE_EXCEEDED,
                           "Collective has timed out during execution.");
             StartAbort(status);
@@ -296,6 +373,16 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         });
   }
 
+  if (MaybeBucketReduction(ctx, col_params, exec_key, done_safe)) {
+    return;
+  }
+  Execute(ctx, col_params, exec_key, done_safe);
+}
+
+void BaseCollectiveExecutor::Execute(OpKernelContext* ctx,
+                                     const CollectiveParams& col_params,
+                                     const string& exec_key,
+                                     const StatusCallback& done) {
   Tensor* output = ctx->mutable_output(0);
   const Tensor* input = (col_params.instance.type == REDUCTION_COLLECTIVE ||
                          col_params.instance.type == GATHER_COLLECTIVE ||
@@ -307,7 +394,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   CollectiveImplementationInterface* col_impl = nullptr;
   Status status = CreateCollective(col_params, &col_impl);
   if (!status.ok()) {
-    done_safe(status);
+    done(status);
     DCHECK_EQ(nullptr, col_impl);
     return;
   }
@@ -317,14 +404,14 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
       col_params, exec_key, step_id_, input, output);
   status = col_impl->InitializeCollectiveContext(col_ctx);
   if (!status.ok()) {
-    done_safe(status);
+    done(status);
     return;
   }
   // Run on an unbounded work queue that can handle blocking work so as to not
   // starve executor threads.
   col_impl->Ref();
   profiler::TraceMeProducer producer("BaseCollectiveExecutor::ExecuteAsync");
-  RunClosure([col_impl, col_ctx, done_safe, ctx,
+  RunClosure([col_impl, col_ctx, done, ctx,
               context_id = producer.GetContextId()]() {
     core::ScopedUnref unref(col_impl);
     profiler::TraceMeConsumer consumer(
@@ -336,13 +423,220 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         },
         context_id);
     col_impl->Ref();
-    col_impl->Run([col_impl, col_ctx, done_safe](const Status& s) {
+    col_impl->Run([col_impl, col_ctx, done](const Status& s) {
       core::ScopedUnref unref(col_impl);
-      done_safe(s);
+      done(s);
     });
   });
 }
 
+bool BaseCollectiveExecutor::MaybeBucketReduction(
+    OpKernelContext* ctx, const CollectiveParams& col_params,
+    const string& exec_key, const StatusCallback& done) {
+  // Reductions are only fused when this worker runs every member of the
+  // group, so that all the members fuse the same reductions.
+  const int64 bucket_bytes = CollectiveBucketBytes();
+  if (bucket_bytes <= 0 || col_params.instance.type != REDUCTION_COLLECTIVE ||
+      !col_params.instance.impl_details.dependencies.empty() ||
+      ctx->input(0).TotalBytes() > bucket_bytes ||
+      col_params.task.is_local.size() != col_params.group.group_size ||
+      col_params.default_rank < 0 ||
+      col_params.default_rank >= col_params.group.group_size) {
+    return false;
+  }
+  for (bool is_local : col_params.task.is_local) {
+    if (!is_local) return false;
+  }
+  const int group_size = col_params.group.group_size;
+  const string bucket_key = strings::StrCat(
+      col_params.group.group_key, ":", col_params.instance.data_type, ":",
+      col_params.merge_op->type_string(), ":",
+      col_params.final_op ? col_params.final_op->type_string() : "", ":",
+      col_params.instance.impl_details.collective_name);
+
+  std::shared_ptr<ReduceBucket> full_bucket;
+  bool schedule_flush = false;
+  int64 bucket_id;
+  {
+    mutex_lock l(bucket_mu_);
+    std::shared_ptr<BucketedInstance>& pending = pending_instances_[{
+        col_params.group.group_key, col_params.instance.instance_key}];
+    if (pending == nullptr) {
+      pending.reset(new BucketedInstance);
+      pending->requests.resize(group_size);
+      pending->num_elements = ctx->input(0).NumElements();
+    }
+    if (pending->requests[col_params.default_rank] != nullptr) {
+      // Leave a duplicate request to run on its own.
+      return false;
+    }
+    pending->requests[col_params.default_rank].reset(
+        new BucketedRequest{ctx, col_params, exec_key, done});
+    if (++pending->num_requests < group_size) return true;
+
+    // Every member has requested the reduction, which may join a bucket.
+    std::shared_ptr<BucketedInstance> instance = std::move(pending);
+    pending_instances_.erase(
+        {col_params.group.group_key, col_params.instance.instance_key});
+    std::shared_ptr<ReduceBucket>& bucket = open_buckets_[bucket_key];
+    if (bucket == nullptr) {
+      bucket = std::make_shared<ReduceBucket>();
+      bucket->id = next_bucket_id_++;
+      schedule_flush = true;
+    }
+    bucket_id = bucket->id;
+    bucket->bytes += ctx->input(0).TotalBytes();
+    bucket->instances.push_back(std::move(instance));
+    if (bucket->bytes >= bucket_bytes) {
+      full_bucket = std::move(bucket);
+      open_buckets_.erase(bucket_key);
+      schedule_flush = false;
+    }
+  }
+  if (full_bucket != nullptr) {
+    RunBucket(std::move(full_bucket));
+  } else if (schedule_flush) {
+    Ref();
+    SchedNonBlockingClosureAfter(CollectiveBucketLingerMicros(),
+                                 [this, bucket_key, bucket_id]() {
+                                   FlushBucket(bucket_key, bucket_id);
+                                   Unref();
+                                 });
+  }
+  return true;
+}
+
+void BaseCollectiveExecutor::FlushBucket(const string& bucket_key,
+                                         int64 bucket_id) {
+  std::shared_ptr<ReduceBucket> bucket;
+  {
+    mutex_lock l(bucket_mu_);
+    auto it = open_buckets_.find(bucket_key);
+    if (it == open_buckets_.end() || it->second->id != bucket_id) return;
+    bucket = std::move(it->second);
+    open_buckets_.erase(it);
+  }
+  RunBucket(std::move(bucket));
+}
+
+void BaseCollectiveExecutor::RunBucket(std::shared_ptr<ReduceBucket> bucket) {
+  if (bucket->instances.size() == 1) {
+    for (const auto& request : bucket->instances[0]->requests) {
+      Execute(request->ctx, request->col_params, request->exec_key,
+              request->done);
+    }
+    return;
+  }
+  VLOG(1) << "Fusing " << bucket->instances.size() << " reductions of "
+          << bucket->bytes << " bytes";
+  const int group_size = bucket->instances[0]->requests.size();
+  for (int rank = 0; rank < group_size; ++rank) {
+    Ref();
+    RunClosure([this, bucket, rank]() {
+      RunFusedReduction(bucket, rank);
+      Unref();
+    });
+  }
+}
+
+void BaseCollectiveExecutor::RunFusedReduction(
+    std::shared_ptr<ReduceBucket> bucket, int rank) {
+  profiler::TraceMe activity("BaseCollectiveExecutor::RunFusedReduction",
+                             profiler::TraceMeLevel::kInfo);
+  const BucketedRequest& first = *bucket->instances[0]->requests[rank];
+  OpKernelContext* ctx = first.ctx;
+  int64 num_elements = 0;
+  for (const auto& instance : bucket->instances) {
+    num_elements += instance->num_elements;
+  }
+  // The fused reduction runs in the context of the first reduction.
+  CollectiveParams col_params = first.col_params;
+  col_params.name = strings::StrCat(first.col_params.name, " (fused ",
+                                    bucket->instances.size(), " reductions)");
+  col_params.instance.shape = TensorShape({num_elements});
+  const string exec_key = strings::StrCat(first.exec_key, ":fused");
+  Tensor fused(ctx->device()->GetAllocator(ctx->output_alloc_attr(0)),
+               col_params.instance.data_type, col_params.instance.shape);
+
+  Device* device = nullptr;
+  Status status = dev_mgr_->LookupDevice(
+      col_params.group.device_names[col_params.default_rank], &device);
+  int64 offset = 0;
+  for (const auto& instance : bucket->instances) {
+    if (!status.ok()) break;
+    const BucketedRequest& request = *instance->requests[rank];
+    Tensor dst = fused.Slice(offset, offset + instance->num_elements);
+    status = CopyFlatTensor(request.ctx, ctx, device, request.ctx->input(0),
+                            &dst);
+    offset += instance->num_elements;
+  }
+
+  CollectiveImplementationInterface* col_impl = nullptr;
+  if (status.ok()) {
+    status = CreateCollective(col_params, &col_impl);
+  }
+  if (status.ok()) {
+    core::ScopedUnref unref(col_impl);
+    auto col_ctx = std::make_shared<CollectiveContext>(
+        this, cem_->GetNcclCommunicator(), dev_mgr_, ctx, CtxParams(ctx),
+        col_params, exec_key, step_id_, &fused, &fused);
+    status = col_impl->InitializeCollectiveContext(col_ctx);
+    if (status.ok()) {
+      // This runs on the work queue, which can handle blocking work.
+      Notification note;
+      col_impl->Run([&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+      note.WaitForNotification();
+    }
+  }
+
+  offset = 0;
+  for (const auto& instance : bucket->instances) {
+    const BucketedRequest& request = *instance->requests[rank];
+    Status s = status;
+    if (s.ok()) {
+      Tensor* output = request.ctx->mutable_output(0);
+      Tensor src = fused.Slice(offset, offset + instance->num_elements);
+      Tensor flat_output;
+      if (!flat_output.CopyFrom(*output,
+                                TensorShape({output->NumElements()}))) {
+        s = errors::Internal("Failed to flatten the output of ",
+                             request.col_params.name);
+      } else {
+        s = CopyFlatTensor(ctx, request.ctx, device, src, &flat_output);
+      }
+    }
+    offset += instance->num_elements;
+    request.done(s);
+  }
+}
+
+void BaseCollectiveExecutor::AbortBuckets(const Status& s) {
+  std::vector<StatusCallback> dones;
+  {
+    mutex_lock l(bucket_mu_);
+    for (const auto& it : pending_instances_) {
+      for (const auto& request : it.second->requests) {
+        if (request != nullptr) dones.push_back(request->done);
+      }
+    }
+    pending_instances_.clear();
+    for (const auto& it : open_buckets_) {
+      for (const auto& instance : it.second->instances) {
+        for (const auto& request : instance->requests) {
+          dones.push_back(request->done);
+        }
+      }
+    }
+    open_buckets_.clear();
+  }
+  for (const StatusCallback& done : dones) {
+    done(s);
+  }
+}
+
 void BaseCollectiveExecutor::CompleteParamsAsync(
     const DeviceAttributes& device, CollectiveParams* cp,
     CancellationManager* cancel_mgr, StatusCallback done) {
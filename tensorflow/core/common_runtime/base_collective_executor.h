@@ -15,10 +15,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
+#include "tensorflow/core/common_runtime/pending_time_tracker.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
@@ -110,6 +115,12 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
 
   void StartAbort(const Status& s) override TF_LOCKS_EXCLUDED(status_mu_);
 
+  int64 pending_micros() const override {
+    return pending_time_.pending_micros();
+  }
+
+  // Small reductions over groups whose members all run on this worker may be
+  // fused into one reduction, see TF_COLLECTIVE_BUCKET_BYTES.
   void ExecuteAsync(OpKernelContext* ctx, const CollectiveParams& col_params,
                     const string& exec_key, StatusCallback done) override;
 
@@ -150,8 +161,35 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   std::unordered_map<int32, int32> launched_ TF_GUARDED_BY(launch_mu_);
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
+  PendingTimeTracker pending_time_;
 
  private:
+  // A member's request for a reduction that is fused with others.
+  struct BucketedRequest;
+  // The requests of all the members for one reduction.
+  struct BucketedInstance;
+  // Complete reductions that run as one.
+  struct ReduceBucket;
+
+  // Runs the collective of `col_params` on its own.
+  void Execute(OpKernelContext* ctx, const CollectiveParams& col_params,
+               const string& exec_key, const StatusCallback& done);
+  // Returns true if the reduction of `col_params` is small enough to be
+  // fused with others of its group, in which case `done` is called once the
+  // fused reduction completes.
+  bool MaybeBucketReduction(OpKernelContext* ctx,
+                            const CollectiveParams& col_params,
+                            const string& exec_key, const StatusCallback& done)
+      TF_LOCKS_EXCLUDED(bucket_mu_);
+  // Runs the open bucket `bucket_key` if it is still the bucket `bucket_id`.
+  void FlushBucket(const string& bucket_key, int64 bucket_id)
+      TF_LOCKS_EXCLUDED(bucket_mu_);
+  void RunBucket(std::shared_ptr<ReduceBucket> bucket);
+  // Runs the fused reduction of `bucket` for the member of rank `rank`.
+  void RunFusedReduction(std::shared_ptr<ReduceBucket> bucket, int rank);
+  // Fails the requests that are waiting for a fused reduction.
+  void AbortBuckets(const Status& s) TF_LOCKS_EXCLUDED(bucket_mu_);
+
   Status CreateCollective(const CollectiveParams& col_params,
                           CollectiveImplementationInterface** col_impl);
   // Check if all ops on which this collective depends on have launched.
@@ -160,6 +198,16 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   // Tries to return the status that is the original error. It returns the
   // aborted status if the collective executor is aborted.
   Status GetStatus(const Status& s) TF_LOCKS_EXCLUDED(status_mu_);
+
+  mutex bucket_mu_;
+  // Reductions waiting for some of their members, keyed by group key and
+  // instance key.
+  std::map<std::pair<int32, int32>, std::shared_ptr<BucketedInstance>>
+      pending_instances_ TF_GUARDED_BY(bucket_mu_);
+  // Keyed by the parameters the fused reductions have in common.
+  std::unordered_map<string, std::shared_ptr<ReduceBucket>> open_buckets_
+      TF_GUARDED_BY(bucket_mu_);
+  int64 next_bucket_id_ TF_GUARDED_BY(bucket_mu_) = 0;
 };
 
 }  // namespace tensorflow
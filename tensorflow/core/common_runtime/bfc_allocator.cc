@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>  // NOLINT
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
@@ -42,6 +46,7 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
                            bool garbage_collection)
     : garbage_collection_(garbage_collection),
+      coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(sub_allocator),
       name_(name),
       free_chunks_list_(kInvalidChunkHandle),
@@ -59,6 +64,15 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
   memory_limit_ = total_memory;
   stats_.bytes_limit = static_cast<int64>(total_memory);
 
+#ifdef TENSORFLOW_MEM_DEBUG
+  track_allocations_ = true;
+#else
+  const char* track_allocations = std::getenv("TF_BFC_ALLOCATION_TRACKING");
+  track_allocations_ = track_allocations != nullptr &&
+                       (strcmp(track_allocations, "1") == 0 ||
+                        strcmp(track_allocations, "true") == 0);
+#endif
+
   // Create a bunch of bins of various good sizes.
 
   // We create bins to fit all possible ranges that cover the
@@ -159,7 +173,13 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   VLOG(1) << "Allocated memory at " << mem_addr << " to "
           << static_cast<void*>(static_cast<char*>(mem_addr) + bytes);
-  region_manager_.AddAllocationRegion(mem_addr, bytes_received);
+  AllocationRegion* extended_region = nullptr;
+  if (coalesce_regions_) {
+    extended_region =
+        region_manager_.AddOrExtendAllocationRegion(mem_addr, bytes_received);
+  } else {
+    region_manager_.AddAllocationRegion(mem_addr, bytes_received);
+  }
 
   // Create one large chunk for the whole memory space that will
   // be chunked later.
@@ -174,8 +194,23 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   region_manager_.set_handle(c->ptr, h);
 
-  // Insert the chunk into the right bin.
-  InsertFreeChunkIntoBin(h);
+  // If an existing region was extended, link the new chunk after its last
+  // chunk so that the two can be coalesced.
+  if (extended_region != nullptr) {
+    ChunkHandle prev = extended_region->get_handle(extended_region->ptr());
+    BFCAllocator::Chunk* prev_chunk = ChunkFromHandle(prev);
+    while (prev_chunk->next != kInvalidChunkHandle) {
+      prev = prev_chunk->next;
+      prev_chunk = ChunkFromHandle(prev);
+    }
+    c = ChunkFromHandle(h);
+    c->prev = prev;
+    prev_chunk->next = h;
+  }
+
+  // Maybe merge with a free preceding chunk and insert the chunk into the
+  // right bin.
+  InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
 
   return true;
 }
@@ -231,6 +266,15 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const bool use_chunk_cache =
+      num_bytes > 0 && UseChunkCache(RoundedBytes(num_bytes), allocation_attr);
+  if (use_chunk_cache) {
+    void* ptr = TryAllocateFromChunkCache(RoundedBytes(num_bytes));
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+  void* result = nullptr;
   if (!allocation_attr.retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -239,8 +283,8 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
     if (allocation_attr.freed_by_func != nullptr) {
       freed_by_count = (*allocation_attr.freed_by_func)();
     }
-    void* result = AllocateRawInternal(unused_alignment, num_bytes,
-                                       dump_log_on_failure, freed_by_count);
+    result = AllocateRawInternal(unused_alignment, num_bytes,
+                                 dump_log_on_failure, freed_by_count);
     if (result == nullptr) {
       static std::atomic<int32> log_counter{0};
       int32 counter_value = log_counter.load(std::memory_order_relaxed);
@@ -256,10 +300,139 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
             << " memory were available.";
       }
     }
-    return result;
   } else {
-    return AllocateRawInternalWithRetry(unused_alignment, num_bytes,
-                                        allocation_attr);
+    result = AllocateRawInternalWithRetry(unused_alignment, num_bytes,
+                                          allocation_attr);
+  }
+  if (use_chunk_cache && result != nullptr) {
+    RegisterChunkCachePtr(result, RoundedBytes(num_bytes));
+  }
+  return result;
+}
+
+void BFCAllocator::SetChunkCacheBytes(size_t max_cached_bytes) {
+  CHECK(chunk_cache_shards_ == nullptr)
+      << "The chunk cache of " << Name() << " is already enabled";
+  chunk_cache_shard_bytes_ = max_cached_bytes / kNumChunkCacheShards;
+  if (chunk_cache_shard_bytes_ < kMinAllocationSize) {
+    chunk_cache_shard_bytes_ = 0;
+    return;
+  }
+  VLOG(1) << "Enabling a chunk cache of "
+          << strings::HumanReadableNumBytes(max_cached_bytes) << " for "
+          << Name();
+  chunk_cache_shards_.reset(new ChunkCacheShard[kNumChunkCacheShards]);
+}
+
+BFCAllocator::ChunkCacheShard* BFCAllocator::ChunkCacheShardForThread() {
+  static thread_local const size_t thread_hash =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &chunk_cache_shards_[thread_hash % kNumChunkCacheShards];
+}
+
+BFCAllocator::ChunkCacheShard* BFCAllocator::ChunkCacheShardForPtr(
+    const void* ptr) {
+  const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ptr);
+  return &chunk_cache_shards_[(p >> kMinAllocationBits) %
+                              kNumChunkCacheShards];
+}
+
+void* BFCAllocator::TryAllocateFromChunkCache(size_t rounded_bytes) {
+  const int size_class = ChunkCacheClassForSize(rounded_bytes);
+  ChunkCacheShard* shard = ChunkCacheShardForThread();
+  {
+    mutex_lock l(shard->mu);
+    std::vector<void*>& ptrs = shard->free_ptrs[size_class];
+    if (!ptrs.empty()) {
+      void* ptr = ptrs.back();
+      ptrs.pop_back();
+      shard->bytes_cached -= ChunkCacheClassSize(size_class);
+      chunk_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+      return ptr;
+    }
+  }
+  chunk_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+void BFCAllocator::RegisterChunkCachePtr(void* ptr, size_t rounded_bytes) {
+  ChunkCacheShard* owner = ChunkCacheShardForPtr(ptr);
+  mutex_lock l(owner->mu);
+  owner->size_classes[ptr] = ChunkCacheClassForSize(rounded_bytes);
+}
+
+bool BFCAllocator::TryDeallocateToChunkCache(void* ptr) {
+  ChunkCacheShard* owner = ChunkCacheShardForPtr(ptr);
+  int size_class;
+  {
+    mutex_lock l(owner->mu);
+    auto it = owner->size_classes.find(ptr);
+    if (it == owner->size_classes.end()) {
+      return false;
+    }
+    size_class = it->second;
+  }
+  const size_t class_bytes = ChunkCacheClassSize(size_class);
+  ChunkCacheShard* shard = ChunkCacheShardForThread();
+  {
+    mutex_lock l(shard->mu);
+    if (shard->bytes_cached + class_bytes <= chunk_cache_shard_bytes_) {
+      shard->free_ptrs[size_class].push_back(ptr);
+      shard->bytes_cached += class_bytes;
+      return true;
+    }
+  }
+  // The shard is full, so the chunk goes back to the bins and stops being
+  // tracked by the cache.
+  mutex_lock l(owner->mu);
+  owner->size_classes.erase(ptr);
+  return false;
+}
+
+size_t BFCAllocator::FlushChunkCacheLocked() {
+  if (chunk_cache_shards_ == nullptr) {
+    return 0;
+  }
+  std::vector<void*> to_free;
+  for (int i = 0; i < kNumChunkCacheShards; ++i) {
+    ChunkCacheShard* shard = &chunk_cache_shards_[i];
+    mutex_lock l(shard->mu);
+    if (shard->bytes_cached == 0) continue;
+    for (std::vector<void*>& ptrs : shard->free_ptrs) {
+      to_free.insert(to_free.end(), ptrs.begin(), ptrs.end());
+      ptrs.clear();
+    }
+    shard->bytes_cached = 0;
+  }
+  size_t released_bytes = 0;
+  for (void* ptr : to_free) {
+    {
+      ChunkCacheShard* owner = ChunkCacheShardForPtr(ptr);
+      mutex_lock l(owner->mu);
+      owner->size_classes.erase(ptr);
+    }
+    BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
+    CHECK(h != kInvalidChunkHandle);
+    released_bytes += ChunkFromHandle(h)->size;
+    MarkFree(h);
+    InsertFreeChunkIntoBin(TryToCoalesce(h, false));
+  }
+  if (!to_free.empty()) {
+    VLOG(2) << "Flushed " << to_free.size() << " chunks ("
+            << strings::HumanReadableNumBytes(released_bytes)
+            << ") from the chunk cache of " << Name();
+  }
+  return released_bytes;
+}
+
+void BFCAllocator::FlushChunkCache() {
+  size_t released_bytes;
+  {
+    mutex_lock l(lock_);
+    released_bytes = FlushChunkCacheLocked();
+  }
+  if (released_bytes > 0) {
+    retry_helper_.NotifyDealloc();
   }
 }
 
@@ -363,6 +536,84 @@ void BFCAllocator::DeallocateRegions(
   }
 }
 
+size_t BFCAllocator::ReleaseFreeRegionTail(AllocationRegion* region) {
+  // Find the last chunk of the region.
+  ChunkHandle h = region->get_handle(region->ptr());
+  Chunk* c = ChunkFromHandle(h);
+  while (c->next != kInvalidChunkHandle) {
+    h = c->next;
+    c = ChunkFromHandle(h);
+  }
+  if (c->in_use() || c->freed_at_count > 0) {
+    return 0;
+  }
+
+  // Drop every trailing sub-allocation that lies entirely within the free
+  // chunk, but never the first one: a whole free region is handled by
+  // DeallocateRegions.
+  size_t released_bytes = 0;
+  const std::vector<size_t>& sizes = region->sub_allocation_sizes();
+  while (sizes.size() > 1 && sizes.back() <= c->size - released_bytes) {
+    released_bytes += sizes.back();
+    region->shrink();
+  }
+  if (released_bytes == 0) {
+    return 0;
+  }
+
+  RemoveFreeChunkFromBin(h);
+  void* tail = region->end_ptr();
+  if (released_bytes == c->size) {
+    ChunkHandle prev = c->prev;
+    DCHECK_NE(prev, kInvalidChunkHandle);
+    ChunkFromHandle(prev)->next = kInvalidChunkHandle;
+    // The chunk's start lies beyond the shrunken region, so it has no handle
+    // slot left to erase.
+    DeallocateChunk(h);
+  } else {
+    c->size -= released_bytes;
+    InsertFreeChunkIntoBin(h);
+  }
+  VLOG(1) << "Releasing " << strings::HumanReadableNumBytes(released_bytes)
+          << " at the end of region " << region->ptr();
+  sub_allocator_->Free(tail, released_bytes);
+  total_region_allocated_bytes_ -= released_bytes;
+  return released_bytes;
+}
+
+size_t BFCAllocator::Compact() {
+  mutex_lock l(lock_);
+  if (!timestamped_chunks_.empty()) {
+    MergeTimestampedChunks(0);
+  }
+  FlushChunkCacheLocked();
+
+  size_t released_bytes = 0;
+  absl::flat_hash_set<void*> free_region_ptrs;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    const Chunk* c = ChunkFromHandle(h);
+    if (!c->in_use() && c->freed_at_count == 0 &&
+        c->next == kInvalidChunkHandle) {
+      free_region_ptrs.insert(region.ptr());
+      released_bytes += region.memory_size();
+    }
+  }
+  if (!free_region_ptrs.empty()) {
+    DeallocateRegions(free_region_ptrs);
+  }
+  if (coalesce_regions_) {
+    for (AllocationRegion& region : *region_manager_.mutable_regions()) {
+      released_bytes += ReleaseFreeRegionTail(&region);
+    }
+  }
+  if (released_bytes > 0) {
+    VLOG(1) << "Compacted " << Name() << ", releasing "
+            << strings::HumanReadableNumBytes(released_bytes);
+  }
+  return released_bytes;
+}
+
 void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
                                         size_t num_bytes,
                                         bool dump_log_on_failure,
@@ -380,6 +631,13 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
   mutex_lock l(lock_);
+  if (replay_state_ != ReplayState::kDisabled) {
+    void* ptr = AllocateFromReplayPlan(rounded_bytes, num_bytes);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr, num_bytes, rounded_bytes);
+      return ptr;
+    }
+  }
   if (!timestamped_chunks_.empty()) {
     // Merge timestamped chunks whose counts have become safe for general use.
     MergeTimestampedChunks(0);
@@ -413,6 +671,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Return any chunks parked in the chunk cache to the bins before going on to
+  // the more expensive region deallocation below.
+  if (FlushChunkCacheLocked() > 0) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -544,22 +812,26 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
 
+        if (replay_state_ == ReplayState::kRecording) {
+          RecordReplayAllocation(chunk->ptr, rounded_bytes);
+        }
+
+        if (ShouldRecordOpName()) {
+          TrackAllocation(chunk);
+        }
+
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
-          const auto& annotation =
-              ScopedMemoryDebugAnnotation::CurrentAnnotation();
-          if (annotation.pending_op_name != nullptr) {
-            chunk->op_name = annotation.pending_op_name;
-          } else {
+          if (chunk->op_name == nullptr) {
+            const auto& annotation =
+                ScopedMemoryDebugAnnotation::CurrentAnnotation();
             LOG(INFO) << "missing pending_op_name for " << Name()
                       << " reading addr "
                       << static_cast<const void*>(&annotation.pending_op_name)
                       << "\n"
                       << CurrentStackTrace();
-            chunk->op_name = nullptr;
           }
           chunk->action_count = ++action_counter_;
-          chunk->step_id = annotation.pending_step_id;
           int slot = chunk->action_count % MEM_DEBUG_SIZE_HISTORY_SIZE;
           size_history_[slot] = stats_.bytes_in_use;
         }
@@ -618,6 +890,10 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (ptr != nullptr && chunk_cache_shards_ != nullptr &&
+      timing_counter_ == nullptr && TryDeallocateToChunkCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -629,6 +905,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   }
   mutex_lock l(lock_);
 
+  if (replay_state_ != ReplayState::kDisabled && DeallocateToReplayPlan(ptr)) {
+    return;
+  }
+
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -741,6 +1021,10 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
 
+  if (ShouldRecordOpName()) {
+    UntrackAllocation(c);
+  }
+
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
     c->action_count = ++action_counter_;
@@ -867,11 +1151,300 @@ bool BFCAllocator::MergeTimestampedChunks(size_t required_bytes) {
   return satisfied;
 }
 
+void BFCAllocator::SetAllocationReplay(bool enabled) {
+  mutex_lock l(lock_);
+  CHECK_EQ(stats_.num_allocs, 0)
+      << "Allocation replay must be configured before the first allocation";
+  allocation_replay_ = enabled;
+  replay_state_ = enabled ? ReplayState::kRecording : ReplayState::kDisabled;
+}
+
+void BFCAllocator::SetAllocationTracking(bool enabled) {
+  mutex_lock l(lock_);
+  CHECK_EQ(stats_.num_allocs, 0)
+      << "Allocation tracking must be configured before the first allocation";
+  track_allocations_ = enabled;
+}
+
+void BFCAllocator::TrackAllocation(Chunk* chunk) {
+  const MemoryDebugAnnotation& annotation =
+      ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  chunk->op_name = annotation.pending_op_name;
+  chunk->step_id = annotation.pending_step_id;
+  if (chunk->step_id > last_tracked_step_id_) {
+    // The first allocation of a step; the sample excludes it.
+    if (step_samples_.size() == kMaxStepSamples) {
+      step_samples_.pop_front();
+    }
+    const int64 bytes_in_use = stats_.bytes_in_use - chunk->size;
+    step_samples_.push_back(
+        {chunk->step_id, bytes_in_use, SafeFragmentation()});
+    last_tracked_step_id_ = chunk->step_id;
+  }
+  bytes_in_use_by_op_[chunk->op_name] += chunk->size;
+  if (stats_.bytes_in_use == stats_.peak_bytes_in_use) {
+    peak_bytes_in_use_by_op_ = bytes_in_use_by_op_;
+    peak_step_id_ = chunk->step_id;
+  }
+}
+
+void BFCAllocator::UntrackAllocation(const Chunk* chunk) {
+  auto it = bytes_in_use_by_op_.find(chunk->op_name);
+  if (it == bytes_in_use_by_op_.end()) return;
+  it->second -= chunk->size;
+  if (it->second <= 0) {
+    bytes_in_use_by_op_.erase(it);
+  }
+}
+
+double BFCAllocator::SafeFragmentation() {
+  if (total_region_allocated_bytes_ <= stats_.bytes_in_use) {
+    return 0;
+  }
+  return GetFragmentation();
+}
+
+std::vector<std::pair<string, int64>> BFCAllocator::SortedOpUsage(
+    const absl::flat_hash_map<const char*, int64>& bytes_by_op) {
+  absl::flat_hash_map<string, int64> merged;
+  for (const auto& op : bytes_by_op) {
+    merged[op.first != nullptr ? op.first : "UNKNOWN"] += op.second;
+  }
+  std::vector<std::pair<string, int64>> sorted(merged.begin(), merged.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<string, int64>& a,
+               const std::pair<string, int64>& b) {
+              return a.second > b.second ||
+                     (a.second == b.second && a.first < b.first);
+            });
+  return sorted;
+}
+
+BFCAllocator::ReplayKey BFCAllocator::NextReplayKey(const char* op_name,
+                                                    size_t rounded_bytes) {
+  int& occurrence = replay_occurrences_[std::make_pair(op_name, rounded_bytes)];
+  return ReplayKey(op_name, rounded_bytes, occurrence++);
+}
+
+void* BFCAllocator::AllocateFromReplayPlan(size_t rounded_bytes,
+                                           size_t num_bytes) {
+  if (timing_counter_ != nullptr || track_allocations_) {
+    return nullptr;
+  }
+  const MemoryDebugAnnotation& annotation =
+      ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  // Allocations made outside of an op of a step are never planned.
+  if (annotation.pending_step_id == 0 ||
+      annotation.pending_op_name == nullptr) {
+    return nullptr;
+  }
+  if (annotation.pending_step_id != replay_step_id_) {
+    if (replay_state_ == ReplayState::kRecording && replay_step_id_ != 0) {
+      BuildReplayPlan();
+    } else if (replay_state_ == ReplayState::kReplaying) {
+      VLOG(1) << "Allocation replay for " << Name() << " in step "
+              << replay_step_id_ << ": " << replay_hits_ << " planned, "
+              << replay_misses_ << " from bins";
+      replay_hits_ = 0;
+      replay_misses_ = 0;
+    }
+    replay_step_id_ = annotation.pending_step_id;
+    replay_occurrences_.clear();
+  }
+  if (replay_state_ != ReplayState::kReplaying) {
+    return nullptr;
+  }
+
+  auto it = replay_index_.find(
+      NextReplayKey(annotation.pending_op_name, rounded_bytes));
+  if (it == replay_index_.end()) {
+    ++replay_misses_;
+    return nullptr;
+  }
+  ReplayEntry& entry = replay_entries_[it->second];
+  // The plan assumed the lifetimes of the recorded step; if they diverged, the
+  // planned range may still be occupied.
+  bool occupied = entry.live;
+  for (int i = 0, end = entry.conflicts.size(); i < end && !occupied; ++i) {
+    occupied = replay_entries_[entry.conflicts[i]].live;
+  }
+  if (occupied) {
+    ++replay_misses_;
+    return nullptr;
+  }
+  ++replay_hits_;
+  entry.live = true;
+  entry.requested_size = num_bytes;
+  entry.allocation_id = next_allocation_id_++;
+  ++stats_.num_allocs;
+  void* ptr = replay_arena_ + entry.offset;
+  replay_live_ptrs_[ptr] = it->second;
+  return ptr;
+}
+
+void BFCAllocator::RecordReplayAllocation(void* ptr, size_t rounded_bytes) {
+  const MemoryDebugAnnotation& annotation =
+      ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  if (annotation.pending_step_id == 0 ||
+      annotation.pending_step_id != replay_step_id_ ||
+      annotation.pending_op_name == nullptr) {
+    return;
+  }
+  ReplayKey key = NextReplayKey(annotation.pending_op_name, rounded_bytes);
+  const int index = replay_entries_.size();
+  replay_entries_.emplace_back();
+  ReplayEntry& entry = replay_entries_.back();
+  entry.rounded_bytes = rounded_bytes;
+  entry.alloc_time = replay_clock_++;
+  replay_index_[key] = index;
+  replay_live_ptrs_[ptr] = index;
+}
+
+bool BFCAllocator::DeallocateToReplayPlan(void* ptr) {
+  auto it = replay_live_ptrs_.find(ptr);
+  if (it == replay_live_ptrs_.end()) {
+    return false;
+  }
+  ReplayEntry& entry = replay_entries_[it->second];
+  replay_live_ptrs_.erase(it);
+  if (replay_state_ == ReplayState::kRecording) {
+    // The chunk itself belongs to the bins.
+    entry.free_time = replay_clock_++;
+    return false;
+  }
+  entry.live = false;
+  AddTraceMe("MemoryDeallocation", ptr, entry.requested_size,
+             entry.rounded_bytes);
+  return true;
+}
+
+void BFCAllocator::BuildReplayPlan() {
+  // Greedy by size: place the largest allocations first, each at the lowest
+  // offset that does not overlap an already placed allocation whose lifetime
+  // intersects its own.
+  std::vector<int> order;
+  for (int i = 0, end = replay_entries_.size(); i < end; ++i) {
+    if (replay_entries_[i].free_time >= 0) {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(), [this](int a, int b) {
+    const ReplayEntry& ea = replay_entries_[a];
+    const ReplayEntry& eb = replay_entries_[b];
+    if (ea.rounded_bytes != eb.rounded_bytes) {
+      return ea.rounded_bytes > eb.rounded_bytes;
+    }
+    return ea.alloc_time < eb.alloc_time;
+  });
+
+  size_t arena_bytes = 0;
+  size_t recorded_bytes = 0;
+  std::vector<int> placed;
+  std::vector<int> overlapping;
+  for (int i : order) {
+    ReplayEntry& entry = replay_entries_[i];
+    overlapping.clear();
+    for (int j : placed) {
+      const ReplayEntry& other = replay_entries_[j];
+      if (other.alloc_time < entry.free_time &&
+          entry.alloc_time < other.free_time) {
+        overlapping.push_back(j);
+      }
+    }
+    std::sort(overlapping.begin(), overlapping.end(), [this](int a, int b) {
+      return replay_entries_[a].offset < replay_entries_[b].offset;
+    });
+    size_t offset = 0;
+    for (int j : overlapping) {
+      const ReplayEntry& other = replay_entries_[j];
+      if (offset + entry.rounded_bytes <= other.offset) break;
+      offset = std::max(offset, other.offset + other.rounded_bytes);
+    }
+    entry.offset = offset;
+    entry.planned = true;
+    placed.push_back(i);
+    arena_bytes = std::max(arena_bytes, offset + entry.rounded_bytes);
+    recorded_bytes += entry.rounded_bytes;
+  }
+  for (int a : placed) {
+    ReplayEntry& ea = replay_entries_[a];
+    for (int b : placed) {
+      const ReplayEntry& eb = replay_entries_[b];
+      if (a != b && ea.offset < eb.offset + eb.rounded_bytes &&
+          eb.offset < ea.offset + ea.rounded_bytes) {
+        ea.conflicts.push_back(b);
+      }
+    }
+  }
+  for (auto it = replay_index_.begin(); it != replay_index_.end();) {
+    if (!replay_entries_[it->second].planned) {
+      replay_index_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  replay_live_ptrs_.clear();
+
+  if (placed.empty()) {
+    VLOG(1) << "No allocations of step " << replay_step_id_
+            << " can be replayed by " << Name();
+    DisableReplay();
+    return;
+  }
+
+  // Leave the recording state before reserving the arena so that the arena
+  // itself is not recorded.
+  replay_state_ = ReplayState::kReplaying;
+  arena_bytes = RoundedBytes(arena_bytes);
+  BinNum bin_num = BinNumForSize(arena_bytes);
+  void* arena = FindChunkPtr(bin_num, arena_bytes, arena_bytes, 0);
+  if (arena == nullptr && Extend(kAllocatorAlignment, arena_bytes)) {
+    arena = FindChunkPtr(bin_num, arena_bytes, arena_bytes, 0);
+  }
+  if (arena == nullptr) {
+    LOG(WARNING) << "Allocator (" << Name() << ") could not reserve "
+                 << strings::HumanReadableNumBytes(arena_bytes)
+                 << " for allocation replay; falling back to the bins.";
+    DisableReplay();
+    return;
+  }
+  replay_arena_ = static_cast<char*>(arena);
+  replay_arena_bytes_ = arena_bytes;
+  VLOG(1) << "Planned " << placed.size() << " allocations of step "
+          << replay_step_id_ << " ("
+          << strings::HumanReadableNumBytes(recorded_bytes) << ") into a "
+          << strings::HumanReadableNumBytes(arena_bytes) << " arena for "
+          << Name();
+}
+
+void BFCAllocator::DisableReplay() {
+  replay_state_ = ReplayState::kDisabled;
+  replay_entries_.clear();
+  replay_index_.clear();
+  replay_occurrences_.clear();
+  replay_live_ptrs_.clear();
+}
+
+const BFCAllocator::ReplayEntry* BFCAllocator::ReplayEntryForPtr(
+    const void* ptr) const {
+  if (replay_arena_ == nullptr || ptr < replay_arena_ ||
+      ptr >= replay_arena_ + replay_arena_bytes_) {
+    return nullptr;
+  }
+  auto it = replay_live_ptrs_.find(ptr);
+  CHECK(it != replay_live_ptrs_.end())
+      << "Asked about a replay arena pointer that is not allocated: " << ptr;
+  return &replay_entries_[it->second];
+}
+
 bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
   mutex_lock l(lock_);
+  if (const ReplayEntry* entry = ReplayEntryForPtr(ptr)) {
+    return entry->requested_size;
+  }
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
       << "Asked for requested size of pointer we never allocated: " << ptr;
@@ -881,6 +1454,9 @@ size_t BFCAllocator::RequestedSize(const void* ptr) const {
 
 size_t BFCAllocator::AllocatedSize(const void* ptr) const {
   mutex_lock l(lock_);
+  if (const ReplayEntry* entry = ReplayEntryForPtr(ptr)) {
+    return entry->rounded_bytes;
+  }
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
       << "Asked for allocated size of pointer we never allocated: " << ptr;
@@ -890,6 +1466,9 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) const {
 
 int64 BFCAllocator::AllocationId(const void* ptr) const {
   mutex_lock l(lock_);
+  if (const ReplayEntry* entry = ReplayEntryForPtr(ptr)) {
+    return entry->allocation_id;
+  }
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
       << "Asked for allocation id of pointer we never allocated: " << ptr;
@@ -1016,11 +1595,12 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
       string buf = strings::StrCat(
           (c->in_use() ? "InUse" : "Free "), " at ",
           strings::Hex(reinterpret_cast<uint64>(c->ptr)), " of size ", c->size);
-#ifdef TENSORFLOW_MEM_DEBUG
       if (ShouldRecordOpName()) {
-        strings::StrAppend(&buf, " by op ", c->op_name, " action_count ",
-                           c->action_count, " step ", c->step_id);
+        strings::StrAppend(&buf, " by op ", c->op_name ? c->op_name : "UNKNOWN",
+                           " step ", c->step_id);
       }
+#ifdef TENSORFLOW_MEM_DEBUG
+      strings::StrAppend(&buf, " action_count ", c->action_count);
 #endif
       strings::StrAppend(&buf, " next ", c->next);
       if (timing_counter_) {
@@ -1047,6 +1627,22 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
             << " curr_region_allocation_bytes_: "
             << curr_region_allocation_bytes_;
   LOG(INFO) << "Stats: \n" << stats_.DebugString();
+
+  if (ShouldRecordOpName()) {
+    constexpr int kMaxLoggedOps = 10;
+    auto log_top_ops = [](const std::vector<std::pair<string, int64>>& ops) {
+      for (int i = 0; i < std::min<int>(ops.size(), kMaxLoggedOps); ++i) {
+        LOG(INFO) << "  " << strings::HumanReadableNumBytes(ops[i].second)
+                  << " by op " << ops[i].first;
+      }
+    };
+    LOG(INFO) << "Largest users of memory at the peak of "
+              << strings::HumanReadableNumBytes(stats_.peak_bytes_in_use)
+              << " in step " << peak_step_id_ << ":";
+    log_top_ops(SortedOpUsage(peak_bytes_in_use_by_op_));
+    LOG(INFO) << "Largest users of memory now:";
+    log_top_ops(SortedOpUsage(bytes_in_use_by_op_));
+  }
 }
 
 void BFCAllocator::MaybeWriteMemoryMap() {
@@ -1111,9 +1707,11 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
       mc->set_size(c->size);
       mc->set_requested_size(c->requested_size);
       mc->set_bin(c->bin_num);
+      if (ShouldRecordOpName()) {
+        mc->set_op_name(c->op_name ? string(c->op_name) : "UNKNOWN");
+        mc->set_step_id(c->step_id);
+      }
 #ifdef TENSORFLOW_MEM_DEBUG
-      mc->set_op_name(c->op_name ? string(c->op_name) : "UNKNOWN");
-      mc->set_step_id(c->step_id);
       mc->set_action_count(c->action_count);
 #endif
       if (timing_counter_) {
@@ -1125,6 +1723,21 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
   mas->set_fragmentation_metric(GetFragmentation());
 
+  if (ShouldRecordOpName()) {
+    for (const auto& op : SortedOpUsage(peak_bytes_in_use_by_op_)) {
+      OpMemoryUsage* usage = md.add_peak_op_usage();
+      usage->set_op_name(op.first);
+      usage->set_bytes_in_use(op.second);
+    }
+    md.set_peak_step_id(peak_step_id_);
+    for (const StepSample& sample : step_samples_) {
+      SnapShot* ss = md.add_step_snap_shot();
+      ss->set_step_id(sample.step_id);
+      ss->set_size(sample.bytes_in_use);
+      ss->set_fragmentation_metric(sample.fragmentation);
+    }
+  }
+
 #ifdef TENSORFLOW_MEM_DEBUG
   // Record the recent size history
   int history_len = static_cast<int>(std::min(
@@ -1142,11 +1755,23 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  if (chunk_cache_shards_ != nullptr) {
+    stats.num_cache_hits = chunk_cache_hits_.load(std::memory_order_relaxed);
+    stats.num_cache_misses =
+        chunk_cache_misses_.load(std::memory_order_relaxed);
+    for (int i = 0; i < kNumChunkCacheShards; ++i) {
+      mutex_lock shard_lock(chunk_cache_shards_[i].mu);
+      stats.bytes_cached += chunk_cache_shards_[i].bytes_cached;
+    }
+  }
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  chunk_cache_hits_.store(0, std::memory_order_relaxed);
+  chunk_cache_misses_.store(0, std::memory_order_relaxed);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
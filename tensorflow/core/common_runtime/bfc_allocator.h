@@ -17,12 +17,16 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -81,10 +85,59 @@ class BFCAllocator : public Allocator {
 
   void SetSafeFrontier(uint64 count) override;
 
-  bool ShouldRecordOpName() const { return true; }
+  // Enables a front-end cache of freed small chunks with a total capacity of
+  // 'max_cached_bytes' (0 disables it).  Allocations of at most
+  // kMaxCachedChunkSize bytes are then served from, and freed into, a set of
+  // independently locked shards without taking lock_ or touching the bins.
+  // Cached chunks still count as in use in bytes_in_use; their total size is
+  // reported separately as bytes_cached.  A chunk served from the cache keeps
+  // the requested size and allocation id of its first allocation.
+  //
+  // Must be called before the first allocation.  The cache is bypassed when a
+  // timing counter is set, since a cached chunk carries no freed_at_count.
+  void SetChunkCacheBytes(size_t max_cached_bytes);
+
+  // Returns every chunk parked in the chunk cache to the bins.  Cheap when the
+  // cache is empty; intended to be called at step boundaries.
+  void FlushChunkCache();
+
+  // Enables allocation replay.  The allocator records the allocations made
+  // during the first step it observes, keyed by the op name, the size and the
+  // occurrence count taken from the current ScopedMemoryDebugAnnotation, and
+  // plans a static layout inside a single arena chunk for those that were
+  // freed within that step.  Matching allocations of later steps are then
+  // served at their planned offsets without searching or splitting bins.  An
+  // allocation that is not in the plan, or whose planned range overlaps a
+  // still-live planned allocation, falls back to the bins.
+  //
+  // Must be called before the first allocation.  Replay is bypassed when a
+  // timing counter is set, and the chunk cache is bypassed while it is on.
+  void SetAllocationReplay(bool enabled);
+
+  // Enables allocation tracking.  Every chunk is then tagged with the op name
+  // and the step id of the current ScopedMemoryDebugAnnotation, the allocator
+  // keeps the bytes in use by each op at the peak of bytes_in_use, and it
+  // samples bytes_in_use and the fragmentation at the start of every step.
+  // RecordMemoryMap reports them, and so does the memory log written when an
+  // allocation fails.  Also enabled by setting TF_BFC_ALLOCATION_TRACKING=1.
+  //
+  // Must be called before the first allocation.  The chunk cache and
+  // allocation replay are bypassed while it is on, since their allocations do
+  // not go through the bins.
+  void SetAllocationTracking(bool enabled);
+
+  bool ShouldRecordOpName() const { return track_allocations_; }
 
   MemoryDump RecordMemoryMap();
 
+  // Returns memory that backs no allocation to the sub-allocator: every
+  // entirely free region and, if the sub-allocator supports coalescing, the
+  // whole sub-allocations covered by the free tail of each region.  Intended
+  // to be called between steps, e.g. to unmap the physical pages of a
+  // virtual-memory-backed sub-allocator.  Returns the number of bytes
+  // released.
+  size_t Compact();
+
  private:
   struct Bin;
 
@@ -98,6 +151,16 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Chunk cache helpers.  TryAllocateFromChunkCache returns nullptr on a miss;
+  // TryDeallocateToChunkCache returns false if 'ptr' was not cached.
+  void* TryAllocateFromChunkCache(size_t rounded_bytes);
+  void RegisterChunkCachePtr(void* ptr, size_t rounded_bytes);
+  bool TryDeallocateToChunkCache(void* ptr);
+
+  // Moves every cached chunk back to the bins and returns the number of bytes
+  // released.
+  size_t FlushChunkCacheLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -188,10 +251,12 @@ class BFCAllocator : public Allocator {
 
     bool in_use() const { return allocation_id != -1; }
 
-#ifdef TENSORFLOW_MEM_DEBUG
-    // optional debugging info
+    // The op and step that allocated the chunk, if allocations are tracked.
     const char* op_name = nullptr;
     uint64 step_id = 0;
+
+#ifdef TENSORFLOW_MEM_DEBUG
+    // optional debugging info
     int64 action_count = 0;
 #endif
 
@@ -210,10 +275,12 @@ class BFCAllocator : public Allocator {
         Chunk* n = a->ChunkFromHandle(next);
         strings::StrAppend(&dbg, ", next: ", n->DebugString(a, false));
       }
+      if (a->ShouldRecordOpName()) {
+        strings::StrAppend(&dbg, ", for: ", op_name ? op_name : "UNKNOWN",
+                           ", stepid: ", step_id);
+      }
 #ifdef TENSORFLOW_MEM_DEBUG
-      strings::StrAppend(&dbg, ", for: ", op_name ? op_name : "UNKNOWN",
-                         ", stepid: ", step_id,
-                         ", last_action: ", action_count);
+      strings::StrAppend(&dbg, ", last_action: ", action_count);
 #endif
       return dbg;
     }
@@ -272,7 +339,8 @@ class BFCAllocator : public Allocator {
         : ptr_(ptr),
           memory_size_(memory_size),
           end_ptr_(
-              static_cast<void*>(static_cast<char*>(ptr_) + memory_size_)) {
+              static_cast<void*>(static_cast<char*>(ptr_) + memory_size_)),
+          sub_allocation_sizes_({memory_size}) {
       DCHECK_EQ(0, memory_size % kMinAllocationSize);
       const size_t n_handles =
           (memory_size + kMinAllocationSize - 1) / kMinAllocationSize;
@@ -298,12 +366,44 @@ class BFCAllocator : public Allocator {
     void set_handle(const void* p, ChunkHandle h) { handles_[IndexFor(p)] = h; }
     void erase(const void* p) { set_handle(p, kInvalidChunkHandle); }
 
+    // Sizes of the SubAllocator::Alloc results making up this region, in
+    // address order.
+    const std::vector<size_t>& sub_allocation_sizes() const {
+      return sub_allocation_sizes_;
+    }
+
+    // Appends an adjacent sub-allocation of 'size' bytes to the region.
+    void extend(size_t size) {
+      DCHECK_EQ(0, size % kMinAllocationSize);
+      const size_t old_n_handles = memory_size_ / kMinAllocationSize;
+      memory_size_ += size;
+      end_ptr_ = static_cast<void*>(static_cast<char*>(end_ptr_) + size);
+      sub_allocation_sizes_.push_back(size);
+      const size_t n_handles = memory_size_ / kMinAllocationSize;
+      std::unique_ptr<ChunkHandle[]> new_handles(new ChunkHandle[n_handles]);
+      for (size_t i = 0; i < n_handles; i++) {
+        new_handles[i] = i < old_n_handles ? handles_[i] : kInvalidChunkHandle;
+      }
+      handles_ = std::move(new_handles);
+    }
+
+    // Drops the last sub-allocation from the region.  The caller must have
+    // removed every chunk handle in the dropped range.
+    void shrink() {
+      DCHECK_GT(sub_allocation_sizes_.size(), 1);
+      const size_t size = sub_allocation_sizes_.back();
+      sub_allocation_sizes_.pop_back();
+      memory_size_ -= size;
+      end_ptr_ = static_cast<void*>(static_cast<char*>(end_ptr_) - size);
+    }
+
    private:
     void Swap(AllocationRegion* other) {
       std::swap(ptr_, other->ptr_);
       std::swap(memory_size_, other->memory_size_);
       std::swap(end_ptr_, other->end_ptr_);
       std::swap(handles_, other->handles_);
+      std::swap(sub_allocation_sizes_, other->sub_allocation_sizes_);
     }
 
     size_t IndexFor(const void* p) const {
@@ -324,6 +424,8 @@ class BFCAllocator : public Allocator {
     // for the memory allocation represented by "p"
     std::unique_ptr<ChunkHandle[]> handles_;
 
+    std::vector<size_t> sub_allocation_sizes_;
+
     TF_DISALLOW_COPY_AND_ASSIGN(AllocationRegion);
   };
 
@@ -344,6 +446,26 @@ class BFCAllocator : public Allocator {
       regions_.insert(entry, AllocationRegion(ptr, memory_size));
     }
 
+    // Like AddAllocationRegion, but extends the preceding region instead if it
+    // ends exactly at 'ptr'.  Returns the extended region, or nullptr if a new
+    // region was inserted.
+    AllocationRegion* AddOrExtendAllocationRegion(void* ptr,
+                                                  size_t memory_size) {
+      auto entry =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      if (entry != regions_.begin()) {
+        auto preceding_region = entry - 1;
+        if (preceding_region->end_ptr() == ptr) {
+          VLOG(1) << "Extending region " << preceding_region->ptr() << " by "
+                  << strings::HumanReadableNumBytes(memory_size);
+          preceding_region->extend(memory_size);
+          return &*preceding_region;
+        }
+      }
+      regions_.insert(entry, AllocationRegion(ptr, memory_size));
+      return nullptr;
+    }
+
     std::vector<AllocationRegion>::iterator RemoveAllocationRegion(
         std::vector<AllocationRegion>::iterator it) {
       return regions_.erase(it);
@@ -359,6 +481,7 @@ class BFCAllocator : public Allocator {
     void erase(const void* p) { return MutableRegionFor(p)->erase(p); }
 
     const std::vector<AllocationRegion>& regions() const { return regions_; }
+    std::vector<AllocationRegion>* mutable_regions() { return &regions_; }
 
    private:
     static bool Comparator(const void* ptr, const AllocationRegion& other) {
@@ -406,6 +529,12 @@ class BFCAllocator : public Allocator {
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns the whole trailing sub-allocations that are covered by the free
+  // last chunk of 'region' to the sub-allocator.  Returns the number of bytes
+  // released.
+  size_t ReleaseFreeRegionTail(AllocationRegion* region)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns a pointer to an underlying allocated chunk of size
   // 'rounded_bytes'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
@@ -439,6 +568,18 @@ class BFCAllocator : public Allocator {
   string RenderOccupancy() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void DumpMemoryLog(size_t num_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   MemoryDump RecordMemoryMapInternal() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Allocation tracking.  TrackAllocation tags a newly allocated chunk and
+  // must be called after the stats are updated for it.
+  void TrackAllocation(Chunk* chunk) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void UntrackAllocation(const Chunk* chunk)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the fragmentation metric, or 0 if no byte is available.
+  double SafeFragmentation() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Merges the ops with the same name of `bytes_by_op`, sorted by decreasing
+  // bytes.
+  static std::vector<std::pair<string, int64>> SortedOpUsage(
+      const absl::flat_hash_map<const char*, int64>& bytes_by_op);
   void MaybeWriteMemoryMap() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   ChunkHandle AllocateChunk() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -527,6 +668,10 @@ class BFCAllocator : public Allocator {
   // memory fragmentation.
   bool garbage_collection_;
 
+  // Whether adjacent sub-allocations are merged into one AllocationRegion so
+  // that chunks can be coalesced across them.
+  const bool coalesce_regions_;
+
   std::unique_ptr<SubAllocator> sub_allocator_;
   string name_;
   SharedCounter* timing_counter_ = nullptr;
@@ -555,6 +700,132 @@ class BFCAllocator : public Allocator {
   int64 size_history_[MEM_DEBUG_SIZE_HISTORY_SIZE];
 #endif
 
+  // Allocation tracking state.  The maps are keyed by the op name pointers of
+  // the annotations, and only hold ops with bytes in use.
+  bool track_allocations_ = false;
+  absl::flat_hash_map<const char*, int64> bytes_in_use_by_op_
+      TF_GUARDED_BY(lock_);
+  absl::flat_hash_map<const char*, int64> peak_bytes_in_use_by_op_
+      TF_GUARDED_BY(lock_);
+  uint64 peak_step_id_ TF_GUARDED_BY(lock_) = 0;
+  uint64 last_tracked_step_id_ TF_GUARDED_BY(lock_) = 0;
+  struct StepSample {
+    uint64 step_id;
+    int64 bytes_in_use;
+    double fragmentation;
+  };
+  static constexpr int kMaxStepSamples = 1024;
+  std::deque<StepSample> step_samples_ TF_GUARDED_BY(lock_);
+
+  // Chunk cache state.  Freed pointers are parked in the shard of the freeing
+  // thread, while the size class of every pointer handed out by the cache path
+  // is recorded in the shard owning its address so that DeallocateRaw can
+  // classify a pointer without consulting region_manager_.  Lock order is
+  // lock_ before any shard mutex, and no shard mutex is held while calling
+  // into the bins.
+  static constexpr size_t kMaxCachedChunkSize = 64 << 10;
+  static constexpr int kNumChunkCacheClasses =
+      kMaxCachedChunkSize / kMinAllocationSize;
+  static constexpr int kNumChunkCacheShards = 16;
+
+  struct ChunkCacheShard {
+    mutex mu;
+    // Size class of cacheable pointers whose address maps to this shard.
+    absl::flat_hash_map<const void*, int> size_classes TF_GUARDED_BY(mu);
+    // Pointers parked by threads that map to this shard, per size class.
+    std::array<std::vector<void*>, kNumChunkCacheClasses> free_ptrs
+        TF_GUARDED_BY(mu);
+    size_t bytes_cached TF_GUARDED_BY(mu) = 0;
+  };
+
+  static int ChunkCacheClassForSize(size_t rounded_bytes) {
+    return static_cast<int>(rounded_bytes / kMinAllocationSize) - 1;
+  }
+  static size_t ChunkCacheClassSize(int size_class) {
+    return (static_cast<size_t>(size_class) + 1) * kMinAllocationSize;
+  }
+  ChunkCacheShard* ChunkCacheShardForThread();
+  ChunkCacheShard* ChunkCacheShardForPtr(const void* ptr);
+
+  bool UseChunkCache(size_t rounded_bytes,
+                     const AllocationAttributes& allocation_attr) const {
+    return chunk_cache_shards_ != nullptr && timing_counter_ == nullptr &&
+           !allocation_replay_ && !track_allocations_ &&
+           rounded_bytes <= kMaxCachedChunkSize &&
+           allocation_attr.freed_by_func == nullptr;
+  }
+
+  // Per-shard capacity; 0 when disabled.
+  size_t chunk_cache_shard_bytes_ = 0;
+  std::unique_ptr<ChunkCacheShard[]> chunk_cache_shards_;
+  std::atomic<int64> chunk_cache_hits_{0};
+  std::atomic<int64> chunk_cache_misses_{0};
+
+  // Allocation replay state; see SetAllocationReplay.
+  enum class ReplayState { kDisabled, kRecording, kReplaying };
+
+  // (op name, rounded size, occurrence of that pair within the step).  Op
+  // names are compared by address: they point into the owning OpKernel, which
+  // stays alive across the steps of an executor.
+  typedef std::tuple<const char*, size_t, int> ReplayKey;
+
+  struct ReplayEntry {
+    size_t rounded_bytes = 0;
+    // Logical times of the allocation and deallocation in the recorded step;
+    // free_time is -1 if the allocation outlived the step.
+    int64 alloc_time = 0;
+    int64 free_time = -1;
+    // Planned placement.  Only entries with planned set are ever served.
+    bool planned = false;
+    size_t offset = 0;
+    // Entries whose planned ranges overlap this one.
+    std::vector<int> conflicts;
+    // State of the allocation currently served at this entry, if any.
+    bool live = false;
+    size_t requested_size = 0;
+    int64 allocation_id = -1;
+  };
+
+  // Called under lock_ for every allocation when replay is enabled.  Tracks
+  // step boundaries and returns a planned arena pointer, or nullptr if the
+  // allocation must be served by the bins.
+  void* AllocateFromReplayPlan(size_t rounded_bytes, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Records an allocation served by the bins during the recorded step.
+  void RecordReplayAllocation(void* ptr, size_t rounded_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns true if 'ptr' was handed out by the replay arena, which it then
+  // takes back.  Records frees during the recorded step.
+  bool DeallocateToReplayPlan(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Plans the recorded step and reserves the arena; replay is disabled if
+  // nothing can be planned or the arena cannot be allocated.
+  void BuildReplayPlan() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void DisableReplay() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the live replay entry for an arena pointer, or nullptr if 'ptr'
+  // is not in the arena.
+  const ReplayEntry* ReplayEntryForPtr(const void* ptr) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  ReplayKey NextReplayKey(const char* op_name, size_t rounded_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  bool allocation_replay_ = false;
+  ReplayState replay_state_ TF_GUARDED_BY(lock_) = ReplayState::kDisabled;
+  // Step being recorded, or the most recent step seen while replaying.
+  int64 replay_step_id_ TF_GUARDED_BY(lock_) = 0;
+  int64 replay_clock_ TF_GUARDED_BY(lock_) = 0;
+  std::vector<ReplayEntry> replay_entries_ TF_GUARDED_BY(lock_);
+  absl::flat_hash_map<ReplayKey, int> replay_index_ TF_GUARDED_BY(lock_);
+  // Per-step occurrence counts of (op name, rounded size).
+  absl::flat_hash_map<std::pair<const char*, size_t>, int> replay_occurrences_
+      TF_GUARDED_BY(lock_);
+  // Maps live pointers to their entries: bin pointers while recording, arena
+  // pointers while replaying.
+  absl::flat_hash_map<const void*, int> replay_live_ptrs_ TF_GUARDED_BY(lock_);
+  char* replay_arena_ TF_GUARDED_BY(lock_) = nullptr;
+  size_t replay_arena_bytes_ TF_GUARDED_BY(lock_) = 0;
+  int64 replay_hits_ TF_GUARDED_BY(lock_) = 0;
+  int64 replay_misses_ TF_GUARDED_BY(lock_) = 0;
+
   friend class GPUBFCAllocatorPrivateMethodsTest;
   TF_DISALLOW_COPY_AND_ASSIGN(BFCAllocator);
 };
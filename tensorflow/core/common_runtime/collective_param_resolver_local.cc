@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_set>
 #include <utility>
 
+#include "tensorflow/core/common_runtime/collective_util.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -618,10 +619,15 @@ void CollectiveParamResolverLocal::CompleteInstanceAsync(
                        "intended only for non-distributed deployment."));
 }
 
-// TODO(b/111897089): we need a better way to pick the collective
-// implementation.  The ideal way would depend upon the topology and link
-// strength before picking a particular implementation.
-void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
+void CollectiveParamResolverLocal::AssignCollectiveType(InstanceRec* ir,
+                                                        CollectiveParams* cp) {
+  {
+    mutex_lock l(ir->mu);
+    if (!ir->collective_name.empty()) {
+      cp->instance.impl_details.collective_name = ir->collective_name;
+      return;
+    }
+  }
   // We use the NCCL implementation if this is an environment which supports
   // NCCL, i.e. `LookupParamResolverInstance` for `NcclReduce` returns OK, and
   // also if indicated either in `ConfigProto` or `communication_hint`.
@@ -633,9 +639,18 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       (nccl_ || cp->instance.impl_details.communication_hint == "nccl") &&
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
-  cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  if (cp->instance.type == REDUCTION_COLLECTIVE && !use_nccl) {
+    // Pick between ring and recursive doubling by tensor size and topology.
+    cp->instance.impl_details.collective_name =
+        collective_util::SelectReductionImplementation(*cp);
+  } else {
+    cp->instance.impl_details.collective_name =
+        GetCollectiveName(cp, use_nccl);
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
+  mutex_lock l(ir->mu);
+  ir->collective_name = cp->instance.impl_details.collective_name;
 }
 
 void CollectiveParamResolverLocal::CompleteInstanceLocal(
@@ -687,7 +702,7 @@ void CollectiveParamResolverLocal::CompleteInstanceFromInitializedIRec(
     return;
   }
   // Populate the fields common across task.
-  AssignCollectiveType(cp);
+  AssignCollectiveType(ir, cp);
   SetDefaultRank(device, cp);
   CompleteTaskIsLocal(task_name_, cp);
 
@@ -112,6 +112,8 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
     int known_count TF_GUARDED_BY(mu);
     std::vector<bool> known TF_GUARDED_BY(mu);
     std::vector<IRConsumer> known_waiters TF_GUARDED_BY(mu);
+    // The implementation chosen by the first member to resolve the instance.
+    string collective_name TF_GUARDED_BY(mu);
 
     InstanceRec() : source_rank(-1), known_count(0) {}
   };
@@ -175,7 +177,8 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
 
   // Sets cp->instance.type based on collective op type, and attempts to assign
   // best implementation.
-  void AssignCollectiveType(CollectiveParams* cp);
+  void AssignCollectiveType(InstanceRec* ir, CollectiveParams* cp)
+      TF_LOCKS_EXCLUDED(ir->mu);
 
   void StartAbortLocal(const Status& s)
       TF_LOCKS_EXCLUDED(status_mu_, group_mu_, instance_mu_);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/collective_util.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace collective_util {
@@ -79,6 +81,71 @@ string SubdivPermDebugString(const CollectiveParams& col_params) {
   return buf;
 }
 
+namespace {
+// The cost of sending a message over a link is latency_micros +
+// bytes / bytes_per_micro.
+struct LinkModel {
+  double latency_micros;
+  double bytes_per_micro;
+};
+
+LinkModel ReadLinkModel(const char* latency_var, int64 default_latency_micros,
+                        const char* bandwidth_var, int64 default_mbps) {
+  int64 latency_micros;
+  int64 mbps;
+  TF_CHECK_OK(ReadInt64FromEnvVar(latency_var, default_latency_micros,
+                                  &latency_micros));
+  TF_CHECK_OK(ReadInt64FromEnvVar(bandwidth_var, default_mbps, &mbps));
+  // A megabyte per second is a byte per microsecond.
+  return {static_cast<double>(std::max<int64>(latency_micros, 0)),
+          static_cast<double>(std::max<int64>(mbps, 1))};
+}
+
+const LinkModel& IntraTaskLink() {
+  static const LinkModel link = ReadLinkModel(
+      "TF_COLLECTIVE_INTRA_TASK_LATENCY_US", 10,
+      "TF_COLLECTIVE_INTRA_TASK_BANDWIDTH_MBPS", 10000);
+  return link;
+}
+
+const LinkModel& InterTaskLink() {
+  static const LinkModel link = ReadLinkModel(
+      "TF_COLLECTIVE_INTER_TASK_LATENCY_US", 100,
+      "TF_COLLECTIVE_INTER_TASK_BANDWIDTH_MBPS", 1250);
+  return link;
+}
+}  // namespace
+
+string SelectReductionImplementation(const CollectiveParams& col_params) {
+  const int group_size = col_params.group.group_size;
+  // Recursive doubling needs a group whose size is a power of two.  Only the
+  // ring knows how to compress chunks on the wire.
+  const string& hint = col_params.instance.impl_details.communication_hint;
+  if (hint == "ring" || hint == "ring_fp16" || hint == "ring_bf16" ||
+      group_size < 2 || (group_size & (group_size - 1)) != 0) {
+    return "RingReduce";
+  }
+  const LinkModel& link =
+      col_params.group.num_tasks > 1 ? InterTaskLink() : IntraTaskLink();
+  const double transfer_micros =
+      col_params.instance.shape.num_elements() *
+      DataTypeSize(col_params.instance.data_type) / link.bytes_per_micro;
+  int num_steps = 0;
+  while ((1 << num_steps) < group_size) ++num_steps;
+  // The ring sends 1 / group_size of the tensor in each of 2 * (group_size -
+  // 1) steps, recursive doubling the whole tensor in each of log2(group_size)
+  // steps.
+  const double ring_micros =
+      2 * (group_size - 1) *
+      (link.latency_micros + transfer_micros / group_size);
+  const double recursive_doubling_micros =
+      num_steps * (link.latency_micros + transfer_micros);
+  VLOG(2) << "SelectReductionImplementation ring_micros=" << ring_micros
+          << " recursive_doubling_micros=" << recursive_doubling_micros;
+  return recursive_doubling_micros < ring_micros ? "RecursiveDoublingReduce"
+                                                 : "RingReduce";
+}
+
 SubContext::SubContext(OpKernelContext* ctx, OpKernelContext::Params* params,
                        OpKernel* op, Tensor* output, Tensor* input)
     : sub_params_(*params),
@@ -32,6 +32,16 @@ Status InitializeDeviceAndLocality(const DeviceMgr* dev_mgr,
                                    DeviceLocality* device_locality);
 string SubdivPermDebugString(const CollectiveParams& col_params);
 
+// Returns the name of the all-reduce implementation, "RingReduce" or
+// "RecursiveDoublingReduce", that a latency-bandwidth model of the links
+// predicts to complete the reduction of `col_params` the fastest. The links
+// are those between tasks if the group spans several tasks, and those between
+// the devices of a task otherwise. Their latency and bandwidth are read from
+// the environment variables TF_COLLECTIVE_{INTRA,INTER}_TASK_LATENCY_US and
+// TF_COLLECTIVE_{INTRA,INTER}_TASK_BANDWIDTH_MBPS, in megabytes per second.
+// The result only depends on parameters every member of the group agrees on.
+string SelectReductionImplementation(const CollectiveParams& col_params);
+
 // Used for executing a sub-operation, e.g. a merge_op instance, with
 // an OpKernelContext based on the one passed into this Op.
 class SubContext {
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -22,12 +23,16 @@ limitations under the License.
 namespace tensorflow {
 
 namespace {
-// The EventMgr has 1 thread for the polling loop and one to execute
-// event callback functions. Issues for reconsideration:
+// By default the EventMgr has 1 thread for the polling loop and one to
+// execute event callback functions. Issues for reconsideration:
 //  - Is this the right number of threads?
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
-static const int kNumThreads = 2;
+static const int kDefaultNumCallbackThreads = 1;
+
+// With adaptive polling, the number of consecutive polls that retire nothing
+// before the polling loop starts sleeping between polls.
+static const int kAdaptivePollingSpinCount = 32;
 }  // namespace
 
 namespace device_event_mgr {
@@ -95,7 +100,13 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
-      threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
+      adaptive_polling_(gpu_options.experimental().event_mgr_adaptive_polling()),
+      num_callback_threads_(
+          gpu_options.experimental().event_mgr_callback_threads() > 0
+              ? gpu_options.experimental().event_mgr_callback_threads()
+              : kDefaultNumCallbackThreads),
+      threadpool_(Env::Default(), "Device_Event_Manager",
+                  1 + num_callback_threads_) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
 }
@@ -141,8 +152,14 @@ void EventMgr::StopPollingLoop() {
 //
 // While one or more events is outstanding, poll for completed events.  When no
 // events are outstanding, we sleep until one is enqueued.
+//
+// With adaptive polling the loop polls again immediately for as long as polls
+// keep retiring events, or for kAdaptivePollingSpinCount polls after the last
+// one that did, and then doubles its sleep after every unproductive poll, up
+// to polling_active_delay_usecs_.
 void EventMgr::PollLoop() {
   ToFreeVector to_free;
+  int idle_polls = 0;
   while (true) {
     bool events_still_pending;
     {
@@ -152,20 +169,60 @@ void EventMgr::PollLoop() {
       }
       if (used_events_.empty()) {
         events_pending_.wait(l);
+        idle_polls = 0;
       }
       PollEvents(true, &to_free);
       events_still_pending = !used_events_.empty();
     }
-    FreeMemory(to_free);
+    idle_polls = to_free.empty() ? idle_polls + 1 : 0;
+    FreeMemory(&to_free);
     to_free.clear();
 
-    if (events_still_pending) {
+    if (!events_still_pending) {
+      continue;
+    }
+    if (!adaptive_polling_) {
       Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+    } else if (idle_polls > kAdaptivePollingSpinCount) {
+      const int shift = std::min(idle_polls - kAdaptivePollingSpinCount, 30);
+      Env::Default()->SleepForMicroseconds(
+          std::min<int64>(int64{1} << (shift - 1), polling_active_delay_usecs_));
     }
   }
   polling_stopped_->Notify();
 }
 
+void EventMgr::FreeMemory(ToFreeVector* to_free) {
+  int num_funcs = 0;
+  for (const auto& iu : *to_free) {
+    if (iu.func != nullptr) ++num_funcs;
+  }
+  if (num_funcs == 0) return;
+  // The functions must be called in another thread.  Retired callbacks are
+  // dispatched in contiguous batches, one per callback thread at most, so
+  // that a burst of completions costs a few threadpool handoffs rather than
+  // one per callback.
+  const int num_batches = std::min(num_funcs, num_callback_threads_);
+  auto it = to_free->begin();
+  for (int b = 0; b < num_batches; ++b) {
+    const int batch_size =
+        num_funcs / num_batches + (b < num_funcs % num_batches ? 1 : 0);
+    std::vector<std::function<void()>> batch;
+    batch.reserve(batch_size);
+    while (static_cast<int>(batch.size()) < batch_size) {
+      if (it->func != nullptr) batch.push_back(std::move(it->func));
+      ++it;
+    }
+    if (batch_size == 1) {
+      threadpool_.Schedule(std::move(batch.front()));
+    } else {
+      threadpool_.Schedule([batch = std::move(batch)]() {
+        for (const auto& func : batch) func();
+      });
+    }
+  }
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
@@ -207,6 +264,8 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
                           gtl::InlinedVector<InUse, 4>* to_free) {
   VLOG(2) << "PollEvents  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
+  if (used_events_.empty()) return;
+  const uint64 now_usecs = Env::Default()->NowMicros();
   // Sweep the remaining events in order.  If this is the dedicated
   // polling thread, check the entire set.  Otherwise, just sweep up to
   // the first non-complete record that is still pending.
@@ -221,9 +280,14 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
         LOG(FATAL) << "Unexpected Event status: " << static_cast<int>(s);
         break;
       case se::Event::Status::kPending:
+        iu.last_pending_usecs = now_usecs;
         if (!is_dedicated_poller) return;  // quit processing queue
         break;
       case se::Event::Status::kComplete:
+        if (iu.last_pending_usecs > 0) {
+          metrics::RecordEventMgrNotificationDelay(now_usecs -
+                                                   iu.last_pending_usecs);
+        }
         // Make a copy of the InUse record so we can free it after releasing
         // the lock
         to_free->push_back(iu);
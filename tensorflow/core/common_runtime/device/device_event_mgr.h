@@ -68,8 +68,8 @@ class EventMgr {
   virtual ~EventMgr();
 
   // Execute func when all pending stream actions have completed.
-  // func must be brief and non-blocking since it executes in the one
-  // thread used for all such callbacks and also buffer deletions.
+  // func must be brief and non-blocking since it executes in one of the
+  // few threads used for all such callbacks and also buffer deletions.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
     ToFreeVector to_free;
     {
@@ -77,7 +77,7 @@ class EventMgr {
       QueueFunc(stream, std::move(func));
       PollEvents(false, &to_free);
     }
-    FreeMemory(to_free);
+    FreeMemory(&to_free);
   }
 
  private:
@@ -86,24 +86,32 @@ class EventMgr {
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // If true, the polling loop spins while events keep completing and backs
+  // off exponentially, up to polling_active_delay_usecs_, while they don't.
+  const bool adaptive_polling_;
+  // Number of threadpool_ threads that run callbacks, besides the one running
+  // the polling loop.
+  const int num_callback_threads_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
   struct InUse {
     se::Event* event;
     std::function<void()> func;
+    // The last time, in microseconds, a poll found event still pending, or 0
+    // if it has not been polled yet.  Bounds the delay between the completion
+    // of the event on the device and its notification on the host.
+    uint64 last_pending_usecs = 0;
   };
 
   typedef gtl::InlinedVector<InUse, 4> ToFreeVector;
 
   EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options);
 
-  void FreeMemory(const ToFreeVector& to_free) {
-    for (const auto& iu : to_free) {
-      // The function must be called in another thread.
-      if (iu.func != nullptr) threadpool_.Schedule(iu.func);
-    }
-  }
+  // Runs the callbacks of the retired InUse records in *to_free on
+  // threadpool_, in at most num_callback_threads_ batches.  The callbacks are
+  // moved out of *to_free.
+  void FreeMemory(ToFreeVector* to_free);
 
   // Stream-enqueue an unused Event and save with it a collection of
   // Tensors and/or a BufRec to be deleted only after the Event
@@ -119,7 +127,7 @@ class EventMgr {
   // This function should be called at roughly the same tempo as
   // QueueTensors() to check whether pending events have recorded,
   // and then retire them.  It appends InUse elements that need cleanup
-  // to "*to_free".  The caller should call FreeMemory(to_free)
+  // to "*to_free".  The caller should call FreeMemory(&to_free)
   // when this returns.
   void PollEvents(bool is_dedicated_poller, ToFreeVector* to_free)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -141,7 +149,8 @@ class EventMgr {
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
-  // The main PollLoop for the event manager runs in this threadpool.
+  // The main PollLoop for the event manager and the callbacks run in this
+  // threadpool.
   thread::ThreadPool threadpool_;
 };
 
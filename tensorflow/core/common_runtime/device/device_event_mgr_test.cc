@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -73,7 +74,7 @@ class TEST_EventMgrHelper {
         mutex_lock l(em_->mu_);
         em_->PollEvents(true, &to_free);
       }
-      em_->FreeMemory(to_free);
+      em_->FreeMemory(&to_free);
     }
   }
 
@@ -138,6 +139,25 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that batched callbacks on several threads with adaptive polling all
+// run.
+TEST(EventMgr, AdaptivePollingBatchedCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions options;
+  options.mutable_experimental()->set_event_mgr_adaptive_polling(true);
+  options.mutable_experimental()->set_event_mgr_callback_threads(4);
+  TEST_EventMgr em(stream_exec, options);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  const int kNumCallbacks = 100;
+  BlockingCounter counter(kNumCallbacks);
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [&counter]() { counter.DecrementCount(); });
+  }
+  counter.Wait();
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -18,11 +18,16 @@ limitations under the License.
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/stream_executor.h"
 
 namespace tensorflow {
 // Allocator for pinned CPU RAM that is made known to a StreamExecutor-based
 // device for the purpose of efficient DMA with the device.
+//
+// On multi-socket machines with NUMA support, memory for a specific numa_node
+// is allocated on that node and then registered with the device, so that
+// staging buffers live next to the PCIe root of the devices that use them.
 class DeviceHostAllocator : public SubAllocator {
  public:
   // Note: stream_exec cannot be null.
@@ -31,7 +36,9 @@ class DeviceHostAllocator : public SubAllocator {
                                const std::vector<Visitor>& free_visitors)
       : SubAllocator(alloc_visitors, free_visitors),
         stream_exec_(stream_exec),
-        numa_node_(numa_node) {
+        numa_node_(numa_node),
+        use_numa_malloc_(numa_node != port::kNUMANoAffinity &&
+                         port::NUMAEnabled() && port::NUMANumNodes() > 1) {
     CHECK(stream_exec_ != nullptr);
   }
   ~DeviceHostAllocator() override {}
@@ -41,7 +48,8 @@ class DeviceHostAllocator : public SubAllocator {
     void* ptr = nullptr;
     *bytes_received = num_bytes;
     if (num_bytes > 0) {
-      ptr = stream_exec_->HostMemoryAllocate(num_bytes);
+      ptr = use_numa_malloc_ ? NUMAHostMemoryAllocate(alignment, num_bytes)
+                             : stream_exec_->HostMemoryAllocate(num_bytes);
       if (ptr == nullptr) {
         LOG(WARNING) << "could not allocate pinned host memory of size: "
                      << num_bytes;
@@ -55,13 +63,34 @@ class DeviceHostAllocator : public SubAllocator {
   void Free(void* ptr, size_t num_bytes) override {
     if (ptr != nullptr) {
       VisitFree(ptr, numa_node_, num_bytes);
-      stream_exec_->HostMemoryDeallocate(ptr);
+      if (use_numa_malloc_) {
+        if (!stream_exec_->HostMemoryUnregister(ptr)) {
+          LOG(WARNING) << "could not unregister pinned host memory at " << ptr;
+        }
+        port::NUMAFree(ptr, num_bytes);
+      } else {
+        stream_exec_->HostMemoryDeallocate(ptr);
+      }
     }
   }
 
  private:
+  // Allocates num_bytes on numa_node_ and pins them for DMA with the device.
+  void* NUMAHostMemoryAllocate(size_t alignment, size_t num_bytes) {
+    void* ptr = port::NUMAMalloc(numa_node_, num_bytes, alignment);
+    if (ptr == nullptr) {
+      return nullptr;
+    }
+    if (!stream_exec_->HostMemoryRegister(ptr, num_bytes)) {
+      port::NUMAFree(ptr, num_bytes);
+      return nullptr;
+    }
+    return ptr;
+  }
+
   se::StreamExecutor* stream_exec_;  // not owned, non-null
   const int numa_node_;
+  const bool use_numa_malloc_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(DeviceHostAllocator);
 };
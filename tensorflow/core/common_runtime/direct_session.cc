@@ -63,11 +63,13 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/nccl/collective_communicator.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -78,6 +80,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/reffed_status_callback.h"
 
 namespace tensorflow {
 
@@ -153,6 +156,20 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Returns the OpSegment key under which a Const kernel is shared between the
+// executors of a session. Different callables may reuse a node name for
+// different values, so the key includes a fingerprint of the NodeDef (minus
+// its inputs, which are only control edges). '#' is not a legal character in
+// node names, so these keys never collide with a stateful kernel's key.
+string SharedConstantKernelKey(const NodeDef& node_def) {
+  NodeDef key_def(node_def);
+  key_def.clear_input();
+  string serialized;
+  SerializeToStringDeterministic(key_def, &serialized);
+  return strings::StrCat(node_def.name(), "#",
+                         strings::FpToString(Fingerprint64(serialized)));
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -648,7 +665,12 @@ Status DirectSession::RunInternal(
   args.session_handle = session_handle_;
   args.tensor_store = &run_state.tensor_store;
   args.step_container = &run_state.step_container;
-  args.sync_on_finish = sync_on_finish_;
+  // Callables that leave their fetches in device memory without
+  // synchronizing let the caller wait for the devices instead.
+  args.sync_on_finish =
+      sync_on_finish_ &&
+      !(executors_and_keys->callable_options.fetch_skip_sync() &&
+        !executors_and_keys->fetch_devices.empty());
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
   args.run_all_kernels_inline = pool == nullptr;
 
@@ -1314,6 +1336,14 @@ Status DirectSession::CreateExecutors(
   TF_RETURN_IF_ERROR(CreateGraphs(
       options, &graphs, &func_info->flib_def, run_state_args, &ek->input_types,
       &ek->output_types, &ek->collective_graph_key));
+  for (const auto& fetch_device : callable_options.fetch_devices()) {
+    Device* device;
+    TF_RETURN_IF_ERROR(device_mgr_->LookupDevice(fetch_device.second, &device));
+    if (std::find(ek->fetch_devices.begin(), ek->fetch_devices.end(),
+                  device) == ek->fetch_devices.end()) {
+      ek->fetch_devices.push_back(device);
+    }
+  }
 
   if (run_state_args->is_partial_run) {
     ek->graph = std::move(run_state_args->graph);
@@ -1373,9 +1403,23 @@ Status DirectSession::CreateExecutors(
     params.session_metadata = session_metadata;
     params.function_library = lib;
     auto opseg = device->op_segment();
+    const bool share_constant_kernels =
+        options_.config.experimental().share_constant_kernels();
     params.create_kernel =
-        [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
-                           OpKernel** kernel) {
+        [this, lib, opseg, share_constant_kernels](
+            const std::shared_ptr<const NodeProperties>& props,
+            OpKernel** kernel) {
+          // Constants that appear in several callables (e.g. the weights
+          // reachable from multiple SavedModel signatures) are stored once
+          // per device instead of once per executor.
+          if (share_constant_kernels && props->node_def.op() == "Const") {
+            auto create_fn = [lib, &props](OpKernel** kernel) {
+              return lib->CreateKernel(props, kernel);
+            };
+            return opseg->FindOrCreate(session_handle_,
+                                       SharedConstantKernelKey(props->node_def),
+                                       kernel, create_fn);
+          }
           // NOTE(mrry): We must not share function kernels (implemented
           // using `CallOp`) between subgraphs, because `CallOp::handle_`
           // is tied to a particular subgraph. Even if the function itself
@@ -1392,8 +1436,9 @@ Status DirectSession::CreateExecutors(
           return opseg->FindOrCreate(session_handle_, props->node_def.name(),
                                      kernel, create_fn);
         };
-    params.delete_kernel = [lib](OpKernel* kernel) {
-      if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
+    params.delete_kernel = [lib, share_constant_kernels](OpKernel* kernel) {
+      if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()) &&
+          !(share_constant_kernels && kernel->type_string() == "Const"))
         delete kernel;
     };
 
@@ -1992,6 +2037,16 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
       step_id, executors_and_keys->callable_options.run_options(), &call_frame,
       executors_and_keys.get(), run_metadata, threadpool_options));
 
+  // The executors only synchronize the devices when `sync_on_finish_` is set,
+  // but the tensors fetched into device memory must be produced before they
+  // are returned unless the caller asked not to.
+  if (!sync_on_finish_ &&
+      !executors_and_keys->callable_options.fetch_skip_sync()) {
+    for (Device* device : executors_and_keys->fetch_devices) {
+      TF_RETURN_IF_ERROR(device->Sync());
+    }
+  }
+
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
     for (auto& tensor : *fetch_tensors) {
@@ -2012,6 +2067,40 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   return Status::OK();
 }
 
+::tensorflow::Status DirectSession::NotifyWhenCallableFetchesReady(
+    CallableHandle handle, std::function<void(const Status&)> done) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
+  {
+    tf_shared_lock l(callables_lock_);
+    if (handle >= next_callable_handle_) {
+      return errors::InvalidArgument("No such callable handle: ", handle);
+    }
+    auto it = callables_.find(handle);
+    if (it != callables_.end()) {
+      executors_and_keys = it->second.executors_and_keys;
+    }
+  }
+  if (!executors_and_keys) {
+    return errors::InvalidArgument(
+        "Attempted to wait for callable after handle was released: ", handle);
+  }
+
+  // The kernels that produce the fetched tensors have been queued on their
+  // devices by the time RunCallable() returns, so the tensors are ready once
+  // the devices have run everything queued so far.
+  ReffedStatusCallback* ready = new ReffedStatusCallback(std::move(done));
+  core::ScopedUnref unref(ready);
+  for (Device* device : executors_and_keys->fetch_devices) {
+    ready->Ref();
+    device->Sync([ready](const Status& s) {
+      ready->UpdateStatus(s);
+      ready->Unref();
+    });
+  }
+  return Status::OK();
+}
+
 Status DirectSession::Finalize() {
   mutex_lock l(graph_state_lock_);
   if (finalized_) {
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DIRECT_SESSION_H_
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -133,6 +134,9 @@ class DirectSession : public Session {
 
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
+  ::tensorflow::Status NotifyWhenCallableFetchesReady(
+      CallableHandle handle, std::function<void(const Status&)> done) override;
+
   ::tensorflow::Status Finalize() override;
 
   const SessionOptions& options() const { return options_; }
@@ -174,6 +178,9 @@ class DirectSession : public Session {
     DataTypeVector output_types;
 
     CallableOptions callable_options;
+    // The devices named in `callable_options.fetch_devices()`, without
+    // duplicates.
+    std::vector<Device*> fetch_devices;
 
     int64 collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
   };
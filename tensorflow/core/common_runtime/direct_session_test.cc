@@ -266,6 +266,39 @@ TEST_F(DirectSessionMinusAXTest,
       absl::StrContains(s.error_message(), "disable_output_partition_graphs"));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_ShareConstantKernels) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_share_constant_kernels(true);
+  auto session = absl::WrapUnique(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // Two callables that both read `a_` should see the same constant buffer.
+  Session::CallableHandle a_handle;
+  TF_ASSERT_OK(session->MakeCallable(MakeCallableOptions({}, {a_ + ":0"}, {}),
+                                     &a_handle));
+  Session::CallableHandle a_y_handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({}, {a_ + ":0", y_ + ":0"}, {}), &a_y_handle));
+
+  std::vector<Tensor> a_outputs;
+  TF_ASSERT_OK(session->RunCallable(a_handle, {}, &a_outputs, nullptr));
+  std::vector<Tensor> a_y_outputs;
+  TF_ASSERT_OK(session->RunCallable(a_y_handle, {}, &a_y_outputs, nullptr));
+
+  ASSERT_EQ(1, a_outputs.size());
+  ASSERT_EQ(2, a_y_outputs.size());
+  test::ExpectTensorEqual<float>(a_outputs[0], a_y_outputs[0]);
+  EXPECT_EQ(a_outputs[0].tensor_data().data(),
+            a_y_outputs[0].tensor_data().data());
+  EXPECT_FLOAT_EQ(5.0, a_y_outputs[1].matrix<float>()(0, 0));
+
+  TF_ASSERT_OK(session->ReleaseCallable(a_handle));
+  TF_ASSERT_OK(session->ReleaseCallable(a_y_handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_FinalizeWithCallables) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -2398,6 +2431,91 @@ TEST(DirectSessionTest, FeedAndFetchTensorsInDeviceMemory) {
   }
 }
 
+// Waits for the fetches of the callable `handle` of `session`.
+Status WaitForCallableFetches(Session* session,
+                              Session::CallableHandle handle) {
+  Notification ready;
+  Status ready_status;
+  TF_RETURN_IF_ERROR(session->NotifyWhenCallableFetchesReady(
+      handle, [&ready, &ready_status](const Status& s) {
+        ready_status = s;
+        ready.Notify();
+      }));
+  ready.WaitForNotification();
+  return ready_status;
+}
+
+TEST(DirectSessionTest, ChainCallablesInDeviceMemory) {
+  std::unique_ptr<Session> producer(NewSession(SessionOptions()));
+  std::unique_ptr<Session> consumer(NewSession(SessionOptions()));
+  const string gpu_device_name = GPUDeviceName(producer.get());
+  if (gpu_device_name.empty()) {
+    LOG(INFO) << "Skipping test since no GPU is available";
+    return;
+  }
+  TF_ASSERT_OK(producer->Create(CreateGraphForYEqualsXSquared()));
+  TF_ASSERT_OK(consumer->Create(CreateGraphForYEqualsXSquared()));
+
+  // The output of `producer` stays in GPU memory and is fed to `consumer`
+  // without a copy or a synchronization of the GPU.
+  CallableOptions producer_opts;
+  producer_opts.add_feed("x:0");
+  producer_opts.add_fetch("y:0");
+  producer_opts.mutable_fetch_devices()->insert({"y:0", gpu_device_name});
+  producer_opts.set_fetch_skip_sync(true);
+  Session::CallableHandle produce;
+  TF_ASSERT_OK(producer->MakeCallable(producer_opts, &produce));
+
+  CallableOptions consumer_opts;
+  consumer_opts.add_feed("x:0");
+  consumer_opts.add_fetch("y:0");
+  consumer_opts.mutable_feed_devices()->insert({"x:0", gpu_device_name});
+  Session::CallableHandle consume;
+  TF_ASSERT_OK(consumer->MakeCallable(consumer_opts, &consume));
+
+  Tensor input(DT_FLOAT, {});
+  input.scalar<float>()() = 2.0f;
+  std::vector<Tensor> gpu_outputs;
+  TF_ASSERT_OK(producer->RunCallable(produce, {input}, &gpu_outputs, nullptr));
+  ASSERT_EQ(1, gpu_outputs.size());
+  ASSERT_TRUE(IsCUDATensor(gpu_outputs[0]));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(consumer->RunCallable(consume, gpu_outputs, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_EQ(16.0, outputs[0].scalar<float>()());
+  TF_EXPECT_OK(WaitForCallableFetches(producer.get(), produce));
+
+  TF_ASSERT_OK(producer->ReleaseCallable(produce));
+  TF_ASSERT_OK(consumer->ReleaseCallable(consume));
+}
+
+TEST(DirectSessionTest, NotifyWhenCallableFetchesReady) {
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_ASSERT_OK(session->Create(CreateGraphForYEqualsXSquared()));
+  std::vector<DeviceAttributes> devices;
+  TF_ASSERT_OK(session->ListDevices(&devices));
+  ASSERT_FALSE(devices.empty());
+
+  for (bool fetch_skip_sync : {false, true}) {
+    CallableOptions opts;
+    opts.add_feed("x:0");
+    opts.add_fetch("y:0");
+    opts.mutable_fetch_devices()->insert({"y:0", devices[0].name()});
+    opts.set_fetch_skip_sync(fetch_skip_sync);
+    Session::CallableHandle handle;
+    TF_ASSERT_OK(session->MakeCallable(opts, &handle));
+    Tensor input(DT_FLOAT, {});
+    input.scalar<float>()() = 3.0f;
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {input}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    TF_EXPECT_OK(WaitForCallableFetches(session.get(), handle));
+    TF_ASSERT_OK(session->ReleaseCallable(handle));
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        WaitForCallableFetches(session.get(), handle)));
+  }
+}
+
 GraphDef CreateIdentityGraphDef(DataType dtype) {
   GraphDef def;
 
@@ -282,17 +282,22 @@ inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
 
 tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
   if (!cached_cache_key_ || device != device_for_cached_cache_key_) {
-    cached_cache_key_ = BuildCacheKeyForDevice(device);
+    if (!op_and_device_key_ || device != device_for_op_and_device_key_) {
+      op_and_device_key_ =
+          tensorflow::FingerprintCat128(tensorflow::Fingerprint128(op_name()),
+                                        tensorflow::Fingerprint128(device));
+      device_for_op_and_device_key_ = string(device);
+    }
+    cached_cache_key_ = BuildCacheKey(*op_and_device_key_);
     device_for_cached_cache_key_ = string(device);
   }
 
   return *cached_cache_key_;
 }
 
-tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
-    const StringPiece device) const {
-  tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
-  f = tensorflow::FingerprintCat128(f, tensorflow::Fingerprint128(device));
+tensorflow::Fprint128 AttrBuilder::BuildCacheKey(
+    const tensorflow::Fprint128& op_and_device_key) const {
+  tensorflow::Fprint128 f = op_and_device_key;
   for (const auto& p : encoded_attrs_) {
     CombineUnordered(
         CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
@@ -94,7 +94,10 @@ class AttrBuilder {
   explicit AttrBuilder(const char* op) { Reset(op); }
 
   void Reset(const char* op) {
-    op_name_ = op;
+    if (op_name_ != op) {
+      op_and_device_key_ = absl::nullopt;
+      op_name_ = op;
+    }
     num_inputs_ = 0;
     encoded_attrs_.clear();
     node_def_initialized_ = false;
@@ -162,7 +165,9 @@ class AttrBuilder {
   void CopyAttributes(const AttrBuilder& other);
 
  private:
-  tensorflow::Fprint128 BuildCacheKeyForDevice(const StringPiece device) const;
+  // Combines `op_and_device_key` with the fingerprints of the attributes.
+  tensorflow::Fprint128 BuildCacheKey(
+      const tensorflow::Fprint128& op_and_device_key) const;
 
   // Initialize the node_def_ object.
   // REQUIRES: node_def_initialized_ = false
@@ -190,6 +195,10 @@ class AttrBuilder {
 
   absl::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
+  // The fingerprint of op_name_ and device_for_op_and_device_key_, which is
+  // kept across resets to the same op.
+  absl::optional<tensorflow::Fprint128> op_and_device_key_;
+  string device_for_op_and_device_key_;
 };
 
 template <>
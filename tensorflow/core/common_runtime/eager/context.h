@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/function.h"
@@ -308,6 +309,11 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   FunctionLibraryDefinition* FuncLibDef() { return &func_lib_def_; }
 
+  // Output shapes of the shape functions run for the ops of this context.
+  ShapeInferenceCache* GetShapeInferenceCache() {
+    return &shape_inference_cache_;
+  }
+
 #if !defined(IS_MOBILE_PLATFORM)
   // Assign the EagerClient pointer to `client` based on the given device / task
   // name, and increment the refcount of the client. The reference ownership is
@@ -559,6 +565,8 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   FunctionLibraryDefinition func_lib_def_{OpRegistry::Global(), {}};
 
+  ShapeInferenceCache shape_inference_cache_;
+
   std::unique_ptr<thread::ThreadPool> thread_pool_;
 
   // EagerContext owns the DistributedFunctionLibraryRuntime(
@@ -29,6 +29,13 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64 AsyncRunBatchSize() {
+  int64 batch_size;
+  TF_CHECK_OK(
+      ReadInt64FromEnvVar("TF_EAGER_ASYNC_RUN_BATCH_SIZE", 16, &batch_size));
+  return std::max<int64>(batch_size, 1);
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async)
@@ -40,7 +47,8 @@ EagerExecutor::EagerExecutor(bool async)
                     : nullptr),
       last_eager_client_(nullptr),
       enable_async_wait_for_remote_function_(
-          IsAsyncWaitForRemoteFunctionEnabled()) {}
+          IsAsyncWaitForRemoteFunctionEnabled()),
+      run_batch_size_(AsyncRunBatchSize()) {}
 
 EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -153,7 +161,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -235,7 +243,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -259,6 +267,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       need_notification = true;
       status_ = status;
       ok_ = false;
+      ++error_count_;
       if (Async()) {
         // We remove any pending ops so that we don't try to execute them if
         // ClearError is called.
@@ -269,7 +278,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -324,28 +333,43 @@ void EagerExecutor::NotifyWaiters(uint64 id) {
 void EagerExecutor::Run() {
   auto thread_exited_notifier =
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
+  std::vector<core::RefCountPtr<NodeItem>> batch;
   while (true) {
-    core::RefCountPtr<NodeItem> curr_item;
+    uint64 error_count;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
         if (state_ == ExecutorState::kShutDown) return;
         nodes_pending_.wait(l);
       }
-      // Obtain raw pointer since we don't want to remove from the queue until
-      // the node has been run. Otherwise, WaitForAllPendingNodes can return
-      // too early.
+      // Claim a run of nodes from the front of the queue, so that the queue
+      // lock is taken once per run rather than once per node.
+      // Obtain raw pointers since we don't want to remove the nodes from the
+      // queue until they have been run. Otherwise, WaitForAllPendingNodes can
+      // return too early.
       // Note, we don't std::move from the here because the front of the queue
       // will then contain a nullptr. This can be a problem in
       // WaitForAllPendingNodes where we get the top EagerNode pointer
       // and register a notification for its completion.
-      curr_item.reset(node_queue_.front().get());
-      curr_item->Ref();
+      for (const auto& queued : node_queue_) {
+        if (batch.size() == run_batch_size_) break;
+        batch.emplace_back(queued.get());
+        queued->Ref();
+      }
+      error_count = error_count_;
     }
-    Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
-    if (!status.ok()) {
-      VLOG(1) << "Failed to run item: " << status;
+    for (auto& curr_item : batch) {
+      // A failure aborts and removes all queued nodes, including the rest of
+      // this run.
+      if (error_count_ != error_count) break;
+      Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
+      if (!status.ok()) {
+        VLOG(1) << "Failed to run item: " << status;
+      }
     }
+    // The claimed nodes are released outside of node_queue_mutex_, since
+    // their destructors may enqueue more nodes.
+    batch.clear();
   }
 }
 
@@ -411,7 +435,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
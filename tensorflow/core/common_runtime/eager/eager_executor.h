@@ -19,7 +19,7 @@ limitations under the License.
 #include <cstddef>
 #include <map>
 #include <memory>
-#include <queue>
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -221,7 +221,7 @@ class EagerExecutor {
   condition_variable nodes_pending_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -232,6 +232,8 @@ class EagerExecutor {
   // EagerNode.  It remains set until ClearError is called.
   Status status_ TF_GUARDED_BY(node_queue_mutex_);
   std::atomic<bool> ok_ TF_GUARDED_BY(node_queue_mutex_);
+  // The number of failures that aborted the queued nodes.
+  std::atomic<uint64> error_count_{0};
 
   // Map from id of a EagerNode to condition_variables (not owned by the map).
   // These condition_variables are notified and removed when that EagerNode is
@@ -258,6 +260,10 @@ class EagerExecutor {
 
   const bool enable_async_wait_for_remote_function_;
 
+  // The maximum number of queued nodes that the async thread claims at once,
+  // from the TF_EAGER_ASYNC_RUN_BATCH_SIZE environment variable.
+  const size_t run_batch_size_;
+
   // Callbacks to run on destruction.
   std::unordered_map<intptr_t, std::vector<std::function<void()>>> cleanups_;
 };
@@ -40,6 +40,21 @@ void EagerOperation::Clear() {
   ClearInferenceState();
 }
 
+void EagerOperation::ClearInputs() {
+  for (ImmediateExecutionTensorHandle* h : inputs_) {
+    h->Unref();
+  }
+  inputs_.clear();
+  inputs_are_tensor_handles_ = true;
+  // Input list attributes stop the inference by dropping the OpDef, so it is
+  // restored for the next inputs.
+  op_def_ = is_function_ ? nullptr : last_primitive_op_def_;
+  inference_arg_idx_ = 0;
+  inference_attrs_.clear_no_resize();
+  // Execution may have placed the op, which must not stick to the next inputs.
+  SetDeviceName(requested_device_name_.c_str()).IgnoreError();
+}
+
 Status EagerOperation::SetAttrValue(const char* attr_name,
                                     const AttrValue& value) {
   MutableAttrs()->Set(attr_name, value);
@@ -297,7 +312,29 @@ Status EagerOperation::Reset(
   DCHECK(inputs_.empty());
   ClearInferenceState();
   bool is_function = false;
-  TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
+  if (!last_primitive_op_name_.empty() && last_primitive_op_name_ == op) {
+    // The registries never change the definition of a primitive op, so the
+    // lookups of the previous reset are still valid.
+    attr_types_ = last_primitive_attr_types_;
+    op_def_ = last_primitive_op_def_;
+    colocation_exempt_ = last_primitive_colocation_exempt_;
+  } else {
+    TF_RETURN_IF_ERROR(ResetOpInfo(op, remote, &is_function));
+  }
+  attrs_.Reset(op);
+  stack_trace_.reset();
+  is_function_ = is_function;
+  cancellation_manager_ = nullptr;
+  executor_ = executor ? executor : &ctx_.Executor();
+  remote_func_params_ = remote_func_params;
+  op_name_ = op;
+  return SetDeviceName(device_name);
+}
+
+Status EagerOperation::ResetOpInfo(const char* op, bool remote,
+                                   bool* is_function) {
+  last_primitive_op_name_.clear();
+  TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, is_function));
 
   // Don't update the device of direct function calls.
   // Particularly, if the user did not explicitly request any device for this
@@ -305,12 +342,16 @@ Status EagerOperation::Reset(
   // for nodes inside the function. This is undesirable for multi-device
   // functions since the not-explicitly-placed nodes inside the body will all
   // end up on this default device.
-  colocation_exempt_ = is_function;
-  if (!is_function) {
+  colocation_exempt_ = *is_function;
+  if (!*is_function) {
     const auto& exempt_ops = InputColocationExemptionRegistry::Global()->Get();
     colocation_exempt_ = exempt_ops.find(op) != exempt_ops.end();
 
     TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def_));
+    last_primitive_op_name_ = op;
+    last_primitive_attr_types_ = attr_types_;
+    last_primitive_op_def_ = op_def_;
+    last_primitive_colocation_exempt_ = colocation_exempt_;
   } else if (!remote && !ctx_.FindFunctionByName(op)) {
     return errors::NotFound(
         "'", op,
@@ -320,14 +361,7 @@ Status EagerOperation::Reset(
         ". Make sure the operation or function is "
         "registered in the binary running in this process.");
   }
-  attrs_.Reset(op);
-  stack_trace_.reset();
-  is_function_ = is_function;
-  cancellation_manager_ = nullptr;
-  executor_ = executor ? executor : &ctx_.Executor();
-  remote_func_params_ = remote_func_params;
-  op_name_ = op;
-  return SetDeviceName(device_name);
+  return Status::OK();
 }
 
 Status EagerOperation::MaybeInferSingleInputAttrs(
@@ -435,6 +469,7 @@ Status EagerOperation::SetDeviceName(const char* c_name) {
                                      "' in eager op: ", DebugString());
     }
     last_set_device_name_ = name;
+    requested_device_name_ = name;
     device_name_ = DeviceNameUtils::ParsedNameToString(device_parsed_name_);
     CustomDevice* custom_device;
     if (ctx_.FindCustomDeviceFromName(device_name_, &custom_device)) {
@@ -47,6 +47,7 @@ class EagerOperation : public ImmediateExecutionOperation {
   void Release() override { delete this; }
 
   void Clear() override;
+  void ClearInputs() override;
   Status Reset(const char* op, const char* raw_device_name) override {
     return Reset(op, raw_device_name, false, nullptr);
   }
@@ -193,6 +194,10 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   const tensorflow::OpDef* GetOpDef(Status* status);
 
+  // Looks up the attribute types, OpDef and colocation exemption of `op` for
+  // Reset.
+  Status ResetOpInfo(const char* op, bool remote, bool* is_function);
+
   void ClearInferenceState() {
     op_def_ = nullptr;
     inference_arg_idx_ = 0;
@@ -228,6 +233,11 @@ class EagerOperation : public ImmediateExecutionOperation {
   // calls to SetDeviceName.
   string last_set_device_name_;
 
+  // The device name that was given to SetDeviceName, unlike
+  // last_set_device_name_ this is kept when the device is set by placement.
+  // ClearInputs restores it, so that reused operations are placed again.
+  string requested_device_name_;
+
   // The operation's device name.
   // This contains the named passed to SetDeviceName until device_ is set,
   // at which point it contains the device_ name.
@@ -251,6 +261,14 @@ class EagerOperation : public ImmediateExecutionOperation {
   EagerExecutor* executor_;                              // Not owned.
   absl::optional<EagerRemoteFunctionParams> remote_func_params_;
 
+  // The lookups of ResetOpInfo for the last primitive op this operation was
+  // reset to.  Clients such as the Python fast path reuse one EagerOperation
+  // per thread, so repeated executions of an op skip the registries.
+  string last_primitive_op_name_;
+  const AttrTypeMap* last_primitive_attr_types_ = nullptr;
+  const tensorflow::OpDef* last_primitive_op_def_ = nullptr;
+  bool last_primitive_colocation_exempt_ = false;
+
   // Inference information
   const tensorflow::OpDef* op_def_;  // op definition from protobuf
   int inference_arg_idx_;  // arg definition index for the next input to be
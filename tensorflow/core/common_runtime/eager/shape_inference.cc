@@ -28,9 +28,9 @@ namespace eager {
 Status RunShapeInference(const NodeDef& ndef,
                          const FunctionLibraryDefinition& lib_def,
                          const gtl::InlinedVector<TensorHandle*, 4>& inputs,
-                         const gtl::InlinedVector<TensorHandle*, 2>& retvals) {
+                         const gtl::InlinedVector<TensorHandle*, 2>& retvals,
+                         ShapeInferenceCache* cache) {
   const tensorflow::OpRegistrationData* op_reg_data;
-  // TODO(b/141209983): Consider adding a shape inference cache.
   // FunctionLibraryDefinition::LookUp delegates to global OpRegistry
   // if op is not a function.
   TF_RETURN_IF_ERROR(lib_def.LookUp(ndef.op(), &op_reg_data));
@@ -45,7 +45,16 @@ Status RunShapeInference(const NodeDef& ndef,
     ic.SetInput(i, shape);
   }
 
-  TF_RETURN_IF_ERROR(ic.Run(op_reg_data->shape_inference_fn));
+  // The values of the inputs are never given to the shape function, so its
+  // outputs only depend on the input shapes and can always be cached.
+  Fprint128 cache_key;
+  const bool cacheable =
+      cache != nullptr && ShapeInferenceCache::ComputeKey(
+                              ndef, TF_GRAPH_DEF_VERSION, &ic, &cache_key);
+  if (!cacheable || !cache->Lookup(cache_key, &ic)) {
+    TF_RETURN_IF_ERROR(ic.Run(op_reg_data->shape_inference_fn));
+    if (cacheable) cache->Insert(cache_key, &ic);
+  }
   CHECK_EQ(ic.num_outputs(), retvals.size());
   for (int i = 0; i < ic.num_outputs(); i++) {
     shape_inference::ShapeHandle shape_handle = ic.output(i);
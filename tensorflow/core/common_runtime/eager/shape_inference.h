@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SHAPE_INFERENCE_H_
 
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -25,10 +26,14 @@ limitations under the License.
 namespace tensorflow {
 namespace eager {
 
+// Runs the shape function of `ndef` on the shapes of `inputs`, and sets the
+// inference shapes of `retvals`. If `cache` is not null, the output shapes are
+// looked up in and added to it.
 Status RunShapeInference(const NodeDef& ndef,
                          const FunctionLibraryDefinition& lib_def,
                          const gtl::InlinedVector<TensorHandle*, 4>& inputs,
-                         const gtl::InlinedVector<TensorHandle*, 2>& retvals);
+                         const gtl::InlinedVector<TensorHandle*, 2>& retvals,
+                         ShapeInferenceCache* cache = nullptr);
 
 }  // namespace eager
 }  // namespace tensorflow
@@ -54,6 +54,22 @@ struct Entry {
     }
   }
 
+  Entry(Entry&& other) : state(other.state), alloc_attr(other.alloc_attr) {
+    switch (state) {
+      case State::NO_VALUE:
+        break;
+      case State::HAS_VALUE:
+        val.Init(std::move(*other.val));
+        break;
+      case State::HAS_CONST_TENSOR:
+        const_tensor = other.const_tensor;
+        break;
+      case State::HAS_REF_TENSOR:
+        ref_tensor = other.ref_tensor;
+        break;
+    }
+  }
+
   ~Entry() {
     if (state == State::HAS_VALUE) val.Destroy();
   }
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -65,6 +66,7 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/cpu/op_latency_sampler.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
@@ -79,13 +81,25 @@ namespace {
 // 1-D, 0 element tensor.
 static const Tensor* const kEmptyTensor = new Tensor;
 
+// When more than this many inexpensive nodes are queued to run inline on one
+// thread, the newest half of them is handed to the inter-op thread pool as a
+// single closure. When called from one of its own threads, the pool pushes the
+// closure onto the local queue of that thread, where idle threads can steal
+// it, so that wide graphs of small ops do not serialize on one thread.
+constexpr size_t kMaxInlineReadyNodes = 64;
+
 // Helper routines for collecting step stats.
 namespace nodestats {
 inline int64 NowInNsec() { return EnvTime::NowNanos(); }
 
-void SetScheduled(NodeExecStatsInterface* stats, int64 micros) {
+void SetScheduled(NodeExecStatsInterface* stats, int64 nanos) {
+  if (!stats) return;
+  stats->SetScheduled(nanos);
+}
+
+void SetScheduledInline(NodeExecStatsInterface* stats, bool scheduled_inline) {
   if (!stats) return;
-  stats->SetScheduled(micros * EnvTime::kMicrosToNanos);
+  stats->SetScheduledInline(scheduled_inline);
 }
 
 void SetAllStart(NodeExecStatsInterface* stats) {
@@ -134,6 +148,33 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// The kernel parameters and scratch vectors used by `ProcessBatch()` on a
+// thread. They are kept across calls, so that the fields that are fixed for a
+// step are only set again when the thread moves on to the nodes of another
+// step, and so that the Eigen GPU device of the parameters is not allocated
+// again for every batch of nodes.
+struct ThreadKernelParams {
+  OpKernelContext::Params params;
+  TensorValueVec inputs;
+  AllocatorAttributeVec input_alloc_attrs;
+  EntryVector outputs;
+
+  // The id of the executor state whose step fields are set in `params`, or 0.
+  uint64 state_id = 0;
+  // The device for which `params.eigen_gpu_device` was made.
+  const Device* device = nullptr;
+  // True while a `ProcessBatch()` call on this thread uses these parameters.
+  // Kernels that run another executor inline, e.g. synchronous function calls,
+  // process nested batches on the same thread, which get their own parameters.
+  bool in_use = false;
+};
+
+// Returns a new id for an executor state, which is never 0.
+uint64 NewExecutorStateId() {
+  static std::atomic<uint64> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
 class ExecutorImpl : public Executor {
  public:
   explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
@@ -289,6 +330,15 @@ class ExecutorState {
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64 scheduled_nsec);
 
+  // Process a batch of ready nodes, in order, in current thread.
+  //
+  // REQUIRES: `!nodes.empty()`.
+  void ProcessBatch(const TaggedNodeSeq& nodes, int64 scheduled_nsec);
+
+  // Sets the fields of `kernel_params` that are the same for all the nodes of
+  // this step, unless they are already set for this step.
+  void InitKernelParams(ThreadKernelParams* kernel_params);
+
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
                      EntryVector* outputs, NodeExecStatsInterface* stats);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
@@ -340,6 +390,9 @@ class ExecutorState {
 
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
 
+  // Identifies this state in the kernel parameters cached by the threads.
+  const uint64 state_id_;
+
   // true if LogMemory::IsEnabled(). Used to check memory enabled cheaply.
   const bool log_memory_;
 
@@ -377,6 +430,10 @@ class ExecutorState {
 
   std::atomic_int_fast32_t num_outstanding_ops_;
 
+  // The memory of the outputs in the graph's static memory plan, if any.
+  core::RefCountPtr<StaticMemoryPlan::Arena> static_memory_arena_;
+  Allocator* const* static_memory_allocators_ = nullptr;
+
   // Available via OpKernelContext to every OpKernel invocation.
   mutex num_deferred_ops_mu_;
   int64 num_deferred_ops_ TF_GUARDED_BY(num_deferred_ops_mu_) = 0;
@@ -392,6 +449,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
     ExecutorImpl::KernelStats* kernel_stats)
     : vlog_(VLOG_IS_ON(1)),
+      state_id_(NewExecutorStateId()),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
       rendezvous_(args.rendezvous),
@@ -468,6 +526,18 @@ void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
     return;
   }
 
+  StaticMemoryPlan* static_memory_plan = immutable_state_.static_memory_plan();
+  if (static_memory_plan != nullptr) {
+    const Status arena_status =
+        static_memory_plan->AcquireArena(device, &static_memory_arena_);
+    if (!arena_status.ok()) {
+      delete this;
+      done(arena_status);
+      return;
+    }
+    static_memory_allocators_ = static_memory_arena_->allocators();
+  }
+
   // Initialize the ready queue.
   ready.reserve(immutable_state_.root_nodes().size());
   propagator_.ActivateRoots(immutable_state_.root_nodes(), &ready);
@@ -491,7 +561,7 @@ template <class PropagatorStateType>
 struct ExecutorState<PropagatorStateType>::AsyncState {
   AsyncState(const OpKernelContext::Params& p, const TaggedNode& _tagged_node,
              const NodeItem* _item, Entry* _first_input,
-             NodeExecStatsInterface* _stats)
+             NodeExecStatsInterface* _stats, uint64 _sample_start_time_ns)
       : saved_inputs(*p.inputs),
         saved_input_alloc_attrs(*p.input_alloc_attrs),
         params(p),
@@ -501,7 +571,8 @@ struct ExecutorState<PropagatorStateType>::AsyncState {
         // ParamsButClearingEigenGPUDevice does equivalent of
         //   params.eigen_gpu_device = nullptr;
         ctx(ParamsButClearingEigenGPUDevice(&params), item->num_outputs),
-        stats(_stats) {
+        stats(_stats),
+        sample_start_time_ns(_sample_start_time_ns) {
     params.inputs = &saved_inputs;
     params.input_alloc_attrs = &saved_input_alloc_attrs;
   }
@@ -514,6 +585,8 @@ struct ExecutorState<PropagatorStateType>::AsyncState {
   Entry* first_input;
   OpKernelContext ctx;
   NodeExecStatsInterface* stats;
+  // Start time of the kernel if its latency is sampled, 0 otherwise.
+  uint64 sample_start_time_ns;
 
  private:
   OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
@@ -556,6 +629,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const uint64 sample_start_time_ns = profiler::OpLatencySampler::MaybeStart();
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -581,6 +655,10 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (TF_PREDICT_FALSE(sample_start_time_ns != 0)) {
+    profiler::OpLatencySampler::Record(op_kernel->type_string_view(),
+                                       sample_start_time_ns);
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -596,13 +674,18 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
   AsyncOpKernel* async_kernel = item.kernel->AsAsync();
   DCHECK(async_kernel != nullptr);
   AsyncState* state =
-      new AsyncState(params, tagged_node, &item, first_input, stats);
+      new AsyncState(params, tagged_node, &item, first_input, stats,
+                     profiler::OpLatencySampler::MaybeStart());
 
   auto done = [this, state]() {
     Device* device = immutable_state_.params().device;
     NodeExecStatsInterface* stats = state->stats;  // Shorthand
     Entry* first_input = state->first_input;       // Shorthand
 
+    if (TF_PREDICT_FALSE(state->sample_start_time_ns != 0)) {
+      profiler::OpLatencySampler::Record(
+          state->item->kernel->type_string_view(), state->sample_start_time_ns);
+    }
     nodestats::SetOpEnd(stats);
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
@@ -663,32 +746,28 @@ void ExecutorState<PropagatorStateType>::ProcessConstTensor(
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
                                                  int64 scheduled_nsec) {
-  profiler::TraceMeConsumer activity(
-      // From TraceMeProducer in DirectSession::RunInternal,
-      // GraphMgr::ExecuteAsync, or FunctionLibraryRuntime::Run.
-      [&] {
-        // NOTE: This tracing uses the iteration number from the first tagged
-        // node that executes during this call to `Process()`. In principle,
-        // subsequent nodes could have different values of `iter_num` that
-        // will not be traced.
-        return profiler::TraceMeEncode(
-            "ExecutorState::Process",
-            {{"id", step_id_}, {"iter_num", tagged_node.get_iter_num()}});
-      },
-      profiler::ContextType::kTfExecutor, step_id_,
-      profiler::TraceMeLevel::kInfo);
-  WithContext wc(context_);
-  TaggedNodeSeq ready;
-  TaggedNodeReadyQueue inline_ready;
+  TaggedNodeSeq nodes;
+  nodes.push_back(tagged_node);
+  ProcessBatch(nodes, scheduled_nsec);
+}
 
-  // Parameters passed to OpKernel::Compute.
-  TensorValueVec inputs;
-  AllocatorAttributeVec input_alloc_attrs;
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::InitKernelParams(
+    ThreadKernelParams* kernel_params) {
+  if (kernel_params->state_id == state_id_) return;
+  kernel_params->state_id = state_id_;
+  Device* device = immutable_state_.params().device;
+  if (kernel_params->device != device) {
+    // The Eigen GPU device is made by, and only reinitialized for, one device.
+    delete kernel_params->params.eigen_gpu_device;
+    kernel_params->params.eigen_gpu_device = nullptr;
+    kernel_params->device = device;
+  }
+  if (kernel_params->outputs.empty()) kernel_params->outputs.resize(1);
 
-  OpKernelContext::Params params;
+  OpKernelContext::Params& params = kernel_params->params;
   params.step_id = step_id_;
   // Override device's threadpool if user provides an intra_op_threadpool
-  Device* device = immutable_state_.params().device;
   if (user_device_) {
     params.device = user_device_.get();
   } else {
@@ -707,8 +786,9 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   params.resource_manager = device->resource_manager();
   params.step_container = step_container_;
   params.slice_reader_cache = slice_reader_cache_;
-  params.inputs = &inputs;
-  params.input_alloc_attrs = &input_alloc_attrs;
+  params.static_memory_allocators = static_memory_allocators_;
+  params.inputs = &kernel_params->inputs;
+  params.input_alloc_attrs = &kernel_params->input_alloc_attrs;
   params.runner = &runner_;
   params.run_all_kernels_inline = run_all_kernels_inline_;
   params.stats_collector = stats_collector_;
@@ -730,25 +810,82 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
     // deferred ops, or in ScheduleFinish if there aren't any deferred ops.
     if (finish_when_deferred_ops_done) Finish();
   };
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ProcessBatch(
+    const TaggedNodeSeq& nodes, int64 scheduled_nsec) {
+  DCHECK(!nodes.empty());
+  if (scheduled_nsec != 0) {
+    metrics::UpdateGraphSchedulingLatency(
+        std::max<int64>(0, nodestats::NowInNsec() - scheduled_nsec) / 1000);
+  }
+  TaggedNode tagged_node = nodes.front();
+  profiler::TraceMeConsumer activity(
+      // From TraceMeProducer in DirectSession::RunInternal,
+      // GraphMgr::ExecuteAsync, or FunctionLibraryRuntime::Run.
+      [&] {
+        // NOTE: This tracing uses the iteration number from the first tagged
+        // node that executes during this call to `ProcessBatch()`. In principle,
+        // subsequent nodes could have different values of `iter_num` that
+        // will not be traced.
+        return profiler::TraceMeEncode(
+            "ExecutorState::Process",
+            {{"id", step_id_}, {"iter_num", tagged_node.get_iter_num()}});
+      },
+      profiler::ContextType::kTfExecutor, step_id_,
+      profiler::TraceMeLevel::kInfo);
+  WithContext wc(context_);
+  TaggedNodeSeq ready;
+  TaggedNodeReadyQueue inline_ready;
 
-  // Set the device_context for this device, if it exists.
-  params.op_device_context = device_context_;
+  // Parameters passed to OpKernel::Compute.
+  static thread_local ThreadKernelParams thread_kernel_params;
+  std::unique_ptr<ThreadKernelParams> nested_kernel_params;
+  ThreadKernelParams* kernel_params = &thread_kernel_params;
+  if (TF_PREDICT_FALSE(kernel_params->in_use)) {
+    nested_kernel_params = absl::make_unique<ThreadKernelParams>();
+    kernel_params = nested_kernel_params.get();
+  }
+  kernel_params->in_use = true;
+  InitKernelParams(kernel_params);
+  OpKernelContext::Params& params = kernel_params->params;
+  TensorValueVec& inputs = kernel_params->inputs;
+  AllocatorAttributeVec& input_alloc_attrs = kernel_params->input_alloc_attrs;
+  EntryVector& outputs = kernel_params->outputs;
+  Device* device = immutable_state_.params().device;
 
   Status s;
   NodeExecStatsInterface* stats = nullptr;
 
-  EntryVector outputs(1);
-
   bool completed = false;
-  inline_ready.push_back(tagged_node);
+  for (const TaggedNode& node : nodes) {
+    inline_ready.push_back(node);
+  }
+  // The first `num_dispatched` nodes taken from `inline_ready` were dispatched
+  // to this call; the ones after them were made ready by this thread.
+  size_t num_dispatched = nodes.size();
+  int64 num_inline = 0;
   while (!inline_ready.empty()) {
     tagged_node = inline_ready.front();
     inline_ready.pop_front();
     const NodeItem& item = tagged_node.get_node_item();
     const int id = item.node_id;
+    const bool scheduled_inline = num_dispatched == 0;
+    if (scheduled_inline) {
+      ++num_inline;
+    } else {
+      --num_dispatched;
+    }
 
     propagator_.MaybeMarkStarted(tagged_node);
 
+    // Use the device context that the device assigned to this node, if any.
+    DeviceContext* node_device_context = immutable_state_.device_context(item);
+    params.op_device_context =
+        node_device_context != nullptr ? node_device_context : device_context_;
+    params.input_device_contexts = immutable_state_.input_device_contexts(item);
+
     params.track_allocations = false;
     stats = nullptr;
     if (stats_collector_ && !tagged_node.get_is_dead()) {
@@ -757,6 +894,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       // `stats` object is expecting allocations to be tracked.
       params.track_allocations = stats ? stats->TrackAllocations() : false;
       nodestats::SetScheduled(stats, scheduled_nsec);
+      nodestats::SetScheduledInline(stats, scheduled_inline);
       nodestats::SetAllStart(stats);
     }
 
@@ -844,6 +982,8 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       completed = NodeDone(s, &ready, stats, &inline_ready);
     }
   }  // while !inline_ready.empty()
+  metrics::RecordGraphNodeDispatches(nodes.size(), num_inline);
+  kernel_params->in_use = false;
 
   // This thread of computation is done if completed = true.
   if (completed) ScheduleFinish();
@@ -1142,8 +1282,11 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready) {
   DCHECK(!ready->empty());
 
+  // The scheduling latency is measured on one in 16 calls, so that reading
+  // the clock is amortized, and on all calls when collecting stats.
+  static thread_local uint32 num_schedule_calls = 0;
   int64 scheduled_nsec = 0;
-  if (stats_collector_) {
+  if (stats_collector_ || num_schedule_calls++ % 16 == 0) {
     scheduled_nsec = nodestats::NowInNsec();
   }
 
@@ -1154,9 +1297,7 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       // sequentially on the same thread, and thread wakeup overhead and
       // executor mutex contention will be minimized.
       RunTask([this, ready = std::move(*ready), scheduled_nsec]() {
-        for (auto& tagged_node : ready) {
-          Process(tagged_node, scheduled_nsec);
-        }
+        ProcessBatch(ready, scheduled_nsec);
       });
     } else {
       for (auto& tagged_node : *ready) {
@@ -1166,9 +1307,23 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     if (inline_ready == nullptr) {
-      // Schedule to run all the ready ops in thread pool.
+      // Schedule to run all the ready ops in thread pool. The inexpensive ones
+      // share a single closure, since dispatching each of them separately
+      // would cost more than running it.
+      TaggedNodeSeq inexpensive_nodes;
       for (auto& tagged_node : *ready) {
-        RunTask([=]() { Process(tagged_node, scheduled_nsec); });
+        const NodeItem& item = *tagged_node.node_item;
+        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+          inexpensive_nodes.push_back(tagged_node);
+        } else {
+          RunTask([=]() { Process(tagged_node, scheduled_nsec); });
+        }
+      }
+      if (!inexpensive_nodes.empty()) {
+        RunTask([this, inexpensive_nodes = std::move(inexpensive_nodes),
+                 scheduled_nsec]() {
+          ProcessBatch(inexpensive_nodes, scheduled_nsec);
+        });
       }
     } else {
       for (auto& tagged_node : *ready) {
@@ -1197,6 +1352,15 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
                           scheduled_nsec));
       }
     }
+    if (inline_ready != nullptr &&
+        inline_ready->size() > kMaxInlineReadyNodes) {
+      // Share the surplus of inline work with the other threads.
+      TaggedNodeSeq surplus;
+      inline_ready->pop_back_n(inline_ready->size() / 2, &surplus);
+      RunTask([this, surplus = std::move(surplus), scheduled_nsec]() {
+        ProcessBatch(surplus, scheduled_nsec);
+      });
+    }
   }
   ready->clear();
 }
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -255,6 +256,65 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, WideFanOutSharesInlineWork) {
+  // A constant feeds 1024 inexpensive Identity nodes, which must all run
+  // before the constant is sent.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Constant(g.get(), V(1.0));
+  auto out = test::graph::Send(g.get(), in, "b", BOB, 1, ALICE);
+  for (int i = 0; i < 1024; ++i) {
+    g->AddControlEdge(test::graph::Identity(g.get(), in, 0), out);
+  }
+  Create(std::move(g));
+  std::atomic<int> num_closures{0};
+  runner_ = [this, &num_closures](std::function<void()> fn) {
+    ++num_closures;
+    thread_pool_->Schedule(fn);
+  };
+  TF_ASSERT_OK(Run(rendez_));
+  Rendezvous::Args args;
+  Tensor out_tensor = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args,
+                             &out_tensor, &is_dead));
+  EXPECT_EQ(1.0, V(out_tensor));
+  // The Identity nodes were not all left to the thread that ran the constant.
+  EXPECT_GT(num_closures, 1);
+}
+
+TEST_F(ExecutorTest, StepStatsRecordInlineScheduling) {
+  // c -> i0 -> i1 -> ... -> i9 -> send
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  Node* v = test::graph::Constant(g.get(), V(1.0));
+  std::vector<string> identities;
+  for (int i = 0; i < 10; ++i) {
+    v = test::graph::Identity(g.get(), v, 0);
+    identities.push_back(v->name());
+  }
+  test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  TF_ASSERT_OK(Run(rendez_));
+  step_stats_collector_.FinalizeAndSwap(&step_stats_);
+  int num_identities = 0;
+  for (const auto& dev_stats : step_stats_.dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      if (std::find(identities.begin(), identities.end(),
+                    node_stats.node_name()) != identities.end()) {
+        // Each Identity node is inexpensive and made ready by its input.
+        EXPECT_TRUE(node_stats.scheduled_inline()) << node_stats.node_name();
+        ++num_identities;
+      }
+    }
+  }
+  EXPECT_EQ(10, num_identities);
+  Rendezvous::Args args;
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(1.0, V(out));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -73,16 +73,23 @@ bool GPUBFCAllocator::GetGarbageCollectionValue() {
   return true;
 }
 
-GPUBFCAllocator::GPUBFCAllocator(DeviceMemAllocator* sub_allocator,
+GPUBFCAllocator::GPUBFCAllocator(SubAllocator* sub_allocator,
                                  size_t total_memory, const string& name)
     : GPUBFCAllocator(sub_allocator, total_memory, GPUOptions(), name) {}
 
-GPUBFCAllocator::GPUBFCAllocator(DeviceMemAllocator* sub_allocator,
+GPUBFCAllocator::GPUBFCAllocator(SubAllocator* sub_allocator,
                                  size_t total_memory,
                                  const GPUOptions& gpu_options,
                                  const string& name)
     : BFCAllocator(sub_allocator, total_memory,
                    GPUBFCAllocator::GetAllowGrowthValue(gpu_options), name,
-                   GPUBFCAllocator::GetGarbageCollectionValue()) {}
+                   GPUBFCAllocator::GetGarbageCollectionValue()) {
+  if (gpu_options.experimental().bfc_chunk_cache_bytes() > 0) {
+    SetChunkCacheBytes(gpu_options.experimental().bfc_chunk_cache_bytes());
+  }
+  if (gpu_options.experimental().bfc_allocation_replay()) {
+    SetAllocationReplay(true);
+  }
+}
 
 }  // namespace tensorflow
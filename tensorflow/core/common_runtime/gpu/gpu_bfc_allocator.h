@@ -33,9 +33,9 @@ namespace tensorflow {
 // algorithm.
 class GPUBFCAllocator : public BFCAllocator {
  public:
-  GPUBFCAllocator(DeviceMemAllocator* sub_allocator, size_t total_memory,
+  GPUBFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                   const string& name);
-  GPUBFCAllocator(DeviceMemAllocator* sub_allocator, size_t total_memory,
+  GPUBFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                   const GPUOptions& gpu_options, const string& name);
   ~GPUBFCAllocator() override {}
 
@@ -225,6 +225,213 @@ TEST(GPUBFCAllocatorTest, AllocatedVsRequested) {
   a.DeallocateRaw(t1);
 }
 
+TEST(GPUBFCAllocatorTest, ChunkCacheReusesSmallChunks) {
+  PlatformGpuId platform_gpu_id(0);
+  DeviceMemAllocator* sub_allocator = new DeviceMemAllocator(
+      ExecutorForPlatformGpuId(platform_gpu_id), platform_gpu_id,
+      false /*use_unified_memory*/, {}, {});
+  GPUOptions options;
+  options.mutable_experimental()->set_bfc_chunk_cache_bytes(1 << 20);
+  GPUBFCAllocator a(sub_allocator, 1 << 30, options, "GPU_0_bfc");
+
+  void* p1 = a.AllocateRaw(1, 1000);
+  a.DeallocateRaw(p1);
+  // The freed chunk is parked in the cache, not returned to the bins.
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(1024, stats->bytes_in_use);
+  EXPECT_EQ(1024, stats->bytes_cached);
+  EXPECT_EQ(0, stats->num_cache_hits);
+  EXPECT_EQ(1, stats->num_cache_misses);
+
+  // A request of the same size class is served from the cache.
+  void* p2 = a.AllocateRaw(1, 900);
+  EXPECT_EQ(p1, p2);
+  stats = a.GetStats();
+  EXPECT_EQ(1, stats->num_cache_hits);
+  EXPECT_EQ(0, stats->bytes_cached);
+
+  // Large requests bypass the cache.
+  void* large = a.AllocateRaw(1, 1 << 20);
+  a.DeallocateRaw(large);
+  stats = a.GetStats();
+  EXPECT_EQ(1, stats->num_cache_misses);
+
+  a.DeallocateRaw(p2);
+  a.FlushChunkCache();
+  stats = a.GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(0, stats->bytes_cached);
+}
+
+TEST(GPUBFCAllocatorTest, ChunkCacheFlushesUnderPressure) {
+  PlatformGpuId platform_gpu_id(0);
+  DeviceMemAllocator* sub_allocator = new DeviceMemAllocator(
+      ExecutorForPlatformGpuId(platform_gpu_id), platform_gpu_id,
+      false /*use_unified_memory*/, {}, {});
+  GPUOptions options;
+  options.mutable_experimental()->set_bfc_chunk_cache_bytes(1 << 20);
+  // Configure a 1MiB byte limit.
+  GPUBFCAllocator a(sub_allocator, 1 << 20, options, "GPU_0_bfc");
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 4096));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  // The whole region is needed, so the cached chunks must be coalesced back.
+  void* big = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(nullptr, big);
+  a.DeallocateRaw(big);
+}
+
+TEST(GPUBFCAllocatorTest, AllocationReplayServesPlannedSteps) {
+  PlatformGpuId platform_gpu_id(0);
+  DeviceMemAllocator* sub_allocator = new DeviceMemAllocator(
+      ExecutorForPlatformGpuId(platform_gpu_id), platform_gpu_id,
+      false /*use_unified_memory*/, {}, {});
+  GPUOptions options;
+  options.mutable_experimental()->set_bfc_allocation_replay(true);
+  GPUBFCAllocator a(sub_allocator, 1 << 30, options, "GPU_0_bfc");
+
+  static const char kOpA[] = "a";
+  static const char kOpB[] = "b";
+  auto run_step = [&a](int64 step_id) {
+    std::vector<void*> ptrs;
+    {
+      ScopedMemoryDebugAnnotation annotation(kOpA, step_id);
+      ptrs.push_back(a.AllocateRaw(1, 4096));
+      ptrs.push_back(a.AllocateRaw(1, 1 << 20));
+    }
+    a.DeallocateRaw(ptrs[0]);
+    {
+      ScopedMemoryDebugAnnotation annotation(kOpB, step_id);
+      ptrs.push_back(a.AllocateRaw(1, 4096));
+    }
+    a.DeallocateRaw(ptrs[1]);
+    a.DeallocateRaw(ptrs[2]);
+    return ptrs;
+  };
+
+  run_step(1);
+  // The second step triggers planning; both it and the third step are served
+  // from the arena at identical addresses.
+  std::vector<void*> second = run_step(2);
+  std::vector<void*> third = run_step(3);
+  EXPECT_EQ(second, third);
+  // The first and third allocations have disjoint lifetimes and share space.
+  EXPECT_EQ(second[0], second[2]);
+  EXPECT_NE(second[0], second[1]);
+
+  // Allocations outside of any step are still served by the bins.
+  void* unannotated = a.AllocateRaw(1, 4096);
+  EXPECT_NE(nullptr, unannotated);
+  EXPECT_EQ(4096, a.RequestedSize(unannotated));
+  a.DeallocateRaw(unannotated);
+
+  // A diverging step that keeps a planned allocation alive falls back to the
+  // bins for the conflicting allocation.
+  std::vector<void*> ptrs;
+  {
+    ScopedMemoryDebugAnnotation annotation(kOpA, 4);
+    ptrs.push_back(a.AllocateRaw(1, 4096));
+    ptrs.push_back(a.AllocateRaw(1, 1 << 20));
+  }
+  {
+    ScopedMemoryDebugAnnotation annotation(kOpB, 4);
+    ptrs.push_back(a.AllocateRaw(1, 4096));
+  }
+  EXPECT_EQ(second[0], ptrs[0]);
+  EXPECT_NE(ptrs[0], ptrs[2]);
+  EXPECT_EQ(4096, a.RequestedSize(ptrs[2]));
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+}
+
+TEST(GPUBFCAllocatorTest, AllocationTrackingRecordsPeakComposition) {
+  PlatformGpuId platform_gpu_id(0);
+  DeviceMemAllocator* sub_allocator = new DeviceMemAllocator(
+      ExecutorForPlatformGpuId(platform_gpu_id), platform_gpu_id,
+      false /*use_unified_memory*/, {}, {});
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  a.SetAllocationTracking(true);
+
+  static const char kOpA[] = "a";
+  static const char kOpB[] = "b";
+  void* a1;
+  void* b1;
+  {
+    ScopedMemoryDebugAnnotation annotation(kOpA, 1);
+    a1 = a.AllocateRaw(1, 1 << 20);
+  }
+  {
+    ScopedMemoryDebugAnnotation annotation(kOpB, 1);
+    b1 = a.AllocateRaw(1, 2 << 20);
+  }
+  a.DeallocateRaw(a1);
+  a.DeallocateRaw(b1);
+  void* a2;
+  {
+    ScopedMemoryDebugAnnotation annotation(kOpA, 2);
+    a2 = a.AllocateRaw(1, 512 << 10);
+  }
+
+  MemoryDump md = a.RecordMemoryMap();
+  EXPECT_EQ(1, md.peak_step_id());
+  ASSERT_EQ(2, md.peak_op_usage_size());
+  EXPECT_EQ("b", md.peak_op_usage(0).op_name());
+  EXPECT_EQ(2 << 20, md.peak_op_usage(0).bytes_in_use());
+  EXPECT_EQ("a", md.peak_op_usage(1).op_name());
+  EXPECT_EQ(1 << 20, md.peak_op_usage(1).bytes_in_use());
+  // Both steps started with nothing in use.
+  ASSERT_EQ(2, md.step_snap_shot_size());
+  EXPECT_EQ(1, md.step_snap_shot(0).step_id());
+  EXPECT_EQ(0, md.step_snap_shot(0).size());
+  EXPECT_EQ(2, md.step_snap_shot(1).step_id());
+  EXPECT_EQ(0, md.step_snap_shot(1).size());
+  bool found = false;
+  for (const MemChunk& chunk : md.chunk()) {
+    if (chunk.in_use()) {
+      EXPECT_EQ("a", chunk.op_name());
+      EXPECT_EQ(2, chunk.step_id());
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+  a.DeallocateRaw(a2);
+}
+
+TEST(GPUBFCAllocatorTest, CompactReleasesFreeRegions) {
+  PlatformGpuId platform_gpu_id(0);
+  DeviceMemAllocator* sub_allocator = new DeviceMemAllocator(
+      ExecutorForPlatformGpuId(platform_gpu_id), platform_gpu_id,
+      false /*use_unified_memory*/, {}, {});
+  GPUOptions options;
+  options.set_allow_growth(true);
+  GPUBFCAllocator a(sub_allocator, 1LL << 31, options, "GPU_0_bfc");
+
+  void* small = a.AllocateRaw(1, 1 << 10);
+  void* big = a.AllocateRaw(1, 256 << 20);
+  ASSERT_NE(nullptr, small);
+  ASSERT_NE(nullptr, big);
+
+  // Nothing can be released while every region holds a live allocation.
+  EXPECT_EQ(0, a.Compact());
+  a.DeallocateRaw(big);
+  a.DeallocateRaw(small);
+  EXPECT_GE(a.Compact(), 256 << 20);
+  EXPECT_EQ(0, a.Compact());
+
+  // The allocator keeps working after compaction.
+  void* p = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(nullptr, p);
+  a.DeallocateRaw(p);
+}
+
 TEST(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   PlatformGpuId platform_gpu_id(0);
   DeviceMemAllocator* sub_allocator = new DeviceMemAllocator(
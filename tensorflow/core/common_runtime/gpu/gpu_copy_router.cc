@@ -0,0 +1,141 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_copy_router.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Copies are split on this boundary, so that both parts stay aligned for the
+// DMA engines.
+constexpr int64 kSplitAlignment = 256;
+
+}  // namespace
+
+GpuCopyRouter::GpuCopyRouter(int64 min_routed_bytes)
+    : min_routed_bytes_(min_routed_bytes) {}
+
+GpuCopyRouter* GpuCopyRouter::Global() {
+  static GpuCopyRouter* router = [] {
+    int64 min_routed_bytes;
+    Status status = ReadInt64FromEnvVar("TF_GPU_ROUTED_COPY_MIN_BYTES",
+                                        16 << 20, &min_routed_bytes);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      min_routed_bytes = 16 << 20;
+    }
+    return new GpuCopyRouter(min_routed_bytes);
+  }();
+  return router;
+}
+
+void GpuCopyRouter::AddLink(PlatformGpuId src, PlatformGpuId dst,
+                            int32 strength) {
+  if (src == dst || strength <= 0) return;
+  mutex_lock l(mu_);
+  int32& link = links_[{src.value(), dst.value()}];
+  link = std::max(link, strength);
+}
+
+int32 GpuCopyRouter::LinkStrength(PlatformGpuId src, PlatformGpuId dst) const {
+  auto it = links_.find({src.value(), dst.value()});
+  return it == links_.end() ? 0 : it->second;
+}
+
+GpuCopyRouter::Route GpuCopyRouter::FindRoute(PlatformGpuId src,
+                                              PlatformGpuId dst,
+                                              int64 num_bytes) const {
+  Route route;
+  route.direct_bytes = num_bytes;
+  if (min_routed_bytes_ <= 0 || num_bytes < min_routed_bytes_ || src == dst) {
+    return route;
+  }
+
+  tf_shared_lock l(mu_);
+  const int32 direct = LinkStrength(src, dst);
+  // A staged copy is as fast as the slower of its two links, since the copies
+  // into and out of the staging GPU are pipelined.
+  int32 best_staged = 0;
+  for (const auto& link : links_) {
+    if (link.first.first != src.value() || link.first.second == dst.value()) {
+      continue;
+    }
+    const PlatformGpuId via(link.first.second);
+    const int32 staged = std::min(link.second, LinkStrength(via, dst));
+    if (staged > best_staged) {
+      best_staged = staged;
+      route.via = via;
+    }
+  }
+  if (best_staged <= direct) {
+    route.via = PlatformGpuId(-1);
+    return route;
+  }
+
+  // Both links carry a share of the copy proportional to their strength, so
+  // that they finish at the same time.
+  const double direct_fraction =
+      static_cast<double>(direct) / (direct + best_staged);
+  route.direct_bytes =
+      static_cast<int64>(num_bytes * direct_fraction) / kSplitAlignment *
+      kSplitAlignment;
+  return route;
+}
+
+se::DeviceMemoryBase GpuCopyRouter::AcquireStagingBuffer(
+    se::StreamExecutor* executor, uint64 num_bytes) {
+  mutex_lock l(mu_);
+  StagingBuffer& buffer = staging_buffers_[executor];
+  if (buffer.in_use) return se::DeviceMemoryBase();
+  if (buffer.memory.size() < num_bytes) {
+    if (!buffer.memory.is_null()) {
+      executor->Deallocate(&buffer.memory);
+    }
+    buffer.memory = executor->AllocateArray<uint8>(num_bytes);
+    if (buffer.memory.is_null()) {
+      LOG(WARNING) << "Failed to allocate a GPU copy staging buffer of "
+                   << num_bytes << " bytes";
+      return se::DeviceMemoryBase();
+    }
+  }
+  buffer.in_use = true;
+  return buffer.memory;
+}
+
+void GpuCopyRouter::ReleaseStagingBuffer(se::StreamExecutor* executor) {
+  mutex_lock l(mu_);
+  auto it = staging_buffers_.find(executor);
+  DCHECK(it != staging_buffers_.end() && it->second.in_use);
+  if (it != staging_buffers_.end()) it->second.in_use = false;
+}
+
+se::Stream* GpuCopyRouter::GetStagingStream(se::StreamExecutor* executor) {
+  mutex_lock l(mu_);
+  std::unique_ptr<se::Stream>& stream = staging_streams_[executor];
+  if (stream == nullptr) {
+    stream = absl::make_unique<se::Stream>(executor);
+    stream->Init();
+  }
+  return stream->ok() ? stream.get() : nullptr;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,109 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COPY_ROUTER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COPY_ROUTER_H_
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Chooses how large tensors are copied between two GPUs of the process, from
+// the strength of the direct links between every pair of GPUs.
+//
+// On machines whose GPUs are not all connected to each other by equally fast
+// links, e.g. xGMI hives where some pairs only talk over PCIe, a copy is
+// faster when it is staged through a GPU that has fast links to both ends.
+// When the two ends also have a direct link, the copy is split between the
+// direct link and the staged route so that both links are busy at once.
+class GpuCopyRouter {
+ public:
+  // How to copy a tensor from one GPU to another.  The first
+  // `direct_bytes` bytes of the tensor are copied directly, and the rest is
+  // copied through a staging buffer on `via`.  `via` is -1 when the whole
+  // tensor is copied directly.
+  struct Route {
+    PlatformGpuId via = PlatformGpuId(-1);
+    int64 direct_bytes = 0;
+  };
+
+  // Copies smaller than `min_routed_bytes` are always direct, since their
+  // time is dominated by the latency of the copies.  Routing is disabled if
+  // `min_routed_bytes` is not positive.
+  explicit GpuCopyRouter(int64 min_routed_bytes);
+
+  // Returns the router of the process, whose minimum routed copy size is read
+  // from the TF_GPU_ROUTED_COPY_MIN_BYTES environment variable (16MiB by
+  // default).
+  static GpuCopyRouter* Global();
+
+  // Records a direct link from `src` to `dst`.  If several links are
+  // recorded between the same GPUs, the strongest one is kept.  Strengths
+  // follow the conventions of the device interconnect maps: faster links have
+  // higher strengths, and GPUs without a recorded link have no peer access.
+  void AddLink(PlatformGpuId src, PlatformGpuId dst, int32 strength);
+
+  // Returns the route for a copy of `num_bytes` bytes from `src` to `dst`.
+  Route FindRoute(PlatformGpuId src, PlatformGpuId dst, int64 num_bytes) const;
+
+  // Returns a buffer of at least `num_bytes` bytes on the GPU of `executor`,
+  // or null memory if the staging buffer of that GPU is in use by another
+  // copy or cannot be allocated.  Staging buffers are allocated outside of the
+  // TensorFlow allocators, so that they are not shared with the ops of the
+  // staging GPU, and are kept for later copies.  The buffer must be returned
+  // with ReleaseStagingBuffer once the copies that use it are done.
+  se::DeviceMemoryBase AcquireStagingBuffer(se::StreamExecutor* executor,
+                                            uint64 num_bytes);
+  void ReleaseStagingBuffer(se::StreamExecutor* executor);
+
+  // Returns the stream of the GPU of `executor` that carries the copies into
+  // staging buffers, which run concurrently with the direct copies issued on
+  // the device-to-device streams of the GPU.  Returns null if the stream
+  // cannot be created.
+  se::Stream* GetStagingStream(se::StreamExecutor* executor);
+
+ private:
+  struct StagingBuffer {
+    se::DeviceMemoryBase memory;
+    bool in_use = false;
+  };
+
+  int32 LinkStrength(PlatformGpuId src, PlatformGpuId dst) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+
+  const int64 min_routed_bytes_;
+
+  mutable mutex mu_;
+  std::map<std::pair<int, int>, int32> links_ TF_GUARDED_BY(mu_);
+  std::map<se::StreamExecutor*, StagingBuffer> staging_buffers_
+      TF_GUARDED_BY(mu_);
+  std::map<se::StreamExecutor*, std::unique_ptr<se::Stream>> staging_streams_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuCopyRouter);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COPY_ROUTER_H_
@@ -0,0 +1,92 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_copy_router.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kMinRoutedBytes = 1 << 20;
+constexpr int64 kCopyBytes = 64 << 20;
+
+// Adds links in both directions between `a` and `b`.
+void Connect(GpuCopyRouter* router, int a, int b, int32 strength) {
+  router->AddLink(PlatformGpuId(a), PlatformGpuId(b), strength);
+  router->AddLink(PlatformGpuId(b), PlatformGpuId(a), strength);
+}
+
+TEST(GpuCopyRouterTest, DirectWhenNoFasterRoute) {
+  GpuCopyRouter router(kMinRoutedBytes);
+  Connect(&router, 0, 1, 50);
+  Connect(&router, 0, 2, 50);
+  Connect(&router, 2, 1, 50);
+  GpuCopyRouter::Route route =
+      router.FindRoute(PlatformGpuId(0), PlatformGpuId(1), kCopyBytes);
+  EXPECT_EQ(-1, route.via.value());
+  EXPECT_EQ(kCopyBytes, route.direct_bytes);
+}
+
+TEST(GpuCopyRouterTest, StagedWithoutDirectLink) {
+  GpuCopyRouter router(kMinRoutedBytes);
+  Connect(&router, 0, 2, 50);
+  Connect(&router, 2, 1, 50);
+  GpuCopyRouter::Route route =
+      router.FindRoute(PlatformGpuId(0), PlatformGpuId(1), kCopyBytes);
+  EXPECT_EQ(2, route.via.value());
+  EXPECT_EQ(0, route.direct_bytes);
+}
+
+TEST(GpuCopyRouterTest, SplitBetweenDirectAndStagedLinks) {
+  GpuCopyRouter router(kMinRoutedBytes);
+  // The GPUs are all connected over PCIe, and 0 and 1 are only connected
+  // through 3 over xGMI.
+  for (int a = 0; a < 4; ++a) {
+    for (int b = a + 1; b < 4; ++b) Connect(&router, a, b, 1);
+  }
+  Connect(&router, 0, 2, 50);
+  Connect(&router, 0, 3, 50);
+  Connect(&router, 3, 1, 50);
+  GpuCopyRouter::Route route =
+      router.FindRoute(PlatformGpuId(0), PlatformGpuId(1), kCopyBytes);
+  EXPECT_EQ(3, route.via.value());
+  EXPECT_GT(route.direct_bytes, 0);
+  EXPECT_LT(route.direct_bytes, kCopyBytes / 50);
+  EXPECT_EQ(0, route.direct_bytes % 256);
+}
+
+TEST(GpuCopyRouterTest, SmallCopiesAreDirect) {
+  GpuCopyRouter router(kMinRoutedBytes);
+  Connect(&router, 0, 2, 50);
+  Connect(&router, 2, 1, 50);
+  GpuCopyRouter::Route route = router.FindRoute(
+      PlatformGpuId(0), PlatformGpuId(1), kMinRoutedBytes - 1);
+  EXPECT_EQ(-1, route.via.value());
+  EXPECT_EQ(kMinRoutedBytes - 1, route.direct_bytes);
+}
+
+TEST(GpuCopyRouterTest, RoutingDisabled) {
+  GpuCopyRouter router(0);
+  Connect(&router, 0, 2, 50);
+  Connect(&router, 2, 1, 50);
+  GpuCopyRouter::Route route =
+      router.FindRoute(PlatformGpuId(0), PlatformGpuId(1), kCopyBytes);
+  EXPECT_EQ(-1, route.via.value());
+  EXPECT_EQ(kCopyBytes, route.direct_bytes);
+}
+
+}  // namespace
+}  // namespace tensorflow
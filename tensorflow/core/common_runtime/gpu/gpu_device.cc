@@ -28,8 +28,10 @@ limitations under the License.
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <map>
+#include <memory>
 #include <tuple>
 #include <vector>
 
@@ -37,11 +39,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_copy_router.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_swapping_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -72,6 +77,7 @@ limitations under the License.
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/reffed_status_callback.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 #include "tensorflow/stream_executor/gpu/gpu_stream.h"
 #include "tensorflow/stream_executor/platform/dso_loader.h"
@@ -104,13 +110,12 @@ using se::rocm::ScopedActivateExecutorContext;
 // during OpKernel::Compute().  The recommended way of allocating such
 // memory is via OpKernelContext::allocate_temp().  However, Eigen Ops
 // don't have access to OpKernelContext, instead they get access to
-// memory directly through the device allocator.  As an Open Source
-// project, Eigen assumes allocator semantics similar to those of the
-// CUDA or ROCm memory allocator, and may not work correctly due to race
-// conditions if used with some other allocator.  For safety, we need
-// to delay deallocation calls out of Eigen until all events on the
-// corresponding stream have completed.  The following two classes
-// serve this purpose in two different compilation environments.
+// memory directly through the device allocator.  Like the tensors of the
+// op, these buffers are only used by kernels on the stream of the op, so
+// they are returned to the allocator as soon as Eigen releases them: later
+// work on the same stream is ordered after the kernels that used them.
+// When several compute streams share the allocator, the allocator itself
+// defers reuse until the other streams are done, see MultiStreamAllocator.
 
 class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
  public:
@@ -164,17 +169,9 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
   void deallocate(void* buffer) const override {
     if (LogMemory::IsEnabled() && buffer != nullptr) {
       LogMemory::RecordRawDeallocation(operation_, step_id_, buffer, allocator_,
-                                       true);
+                                       false);
     }
-    AsyncFreeData* afData =
-        new AsyncFreeData(allocator_, buffer, operation_, step_id_);
-#if GOOGLE_CUDA
-    cudaError_t err = cudaStreamAddCallback(*stream_, asyncFree, afData, 0);
-    CHECK_EQ(err, cudaSuccess);
-#elif TENSORFLOW_USE_ROCM
-    hipError_t err = hipStreamAddCallback(*stream_, asyncFree, afData, 0);
-    CHECK_EQ(err, hipSuccess);
-#endif
+    allocator_->DeallocateRaw(buffer);
   }
 
   // Return a pointer to a per stream scratchpad of 1024 bytes residing
@@ -188,31 +185,6 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
   unsigned int* semaphore() const override { return semaphore_; }
 
  private:
-  struct AsyncFreeData {
-    AsyncFreeData(::tensorflow::Allocator* a, void* p, const string& o,
-                  const int64 s)
-        : allocator_(a), address_(p), operation_(o), step_id_(s) {}
-    ::tensorflow::Allocator* allocator_;
-    void* address_;
-    const string operation_;
-    const int64 step_id_;
-  };
-
-#if GOOGLE_CUDA
-  static void CUDART_CB asyncFree(gpuStream_t stream, cudaError_t status,
-                                  void* userData) {
-#elif TENSORFLOW_USE_ROCM
-  static void asyncFree(gpuStream_t stream, hipError_t status, void* userData) {
-#endif
-    AsyncFreeData* data = static_cast<AsyncFreeData*>(userData);
-    if (LogMemory::IsEnabled()) {
-      LogMemory::RecordRawDeallocation(data->operation_, data->step_id_,
-                                       data->address_, data->allocator_, false);
-    }
-    data->allocator_->DeallocateRaw(data->address_);
-    delete data;
-  }
-
   string operation_;
   int64 step_id_;
   const gpuStream_t* stream_;           // Not owned.
@@ -376,6 +348,117 @@ class BaseGPUDevice::StreamGroupFactory {
   TF_DISALLOW_COPY_AND_ASSIGN(StreamGroupFactory);
 };
 
+namespace {
+
+// Forwards to the device allocator, but only returns a buffer to it once every
+// compute stream has finished the work enqueued before the buffer was
+// released.  With a single compute stream, stream order guarantees that the
+// kernels of later ops only run once the kernels of the op that released a
+// buffer are done.  With several compute streams, the buffer may still be in
+// use by a kernel on another stream, e.g. one that read it as an input.
+//
+// Released buffers are batched behind a single fence, i.e. one event per
+// compute stream, so that the EventMgr traffic does not grow with the number
+// of deallocations.  Buffers released while a fence is in flight wait for the
+// next one, which is issued as soon as the current fence completes.
+//
+// Allocations that fail while buffers are pending are retried by the BFC
+// allocator until the deferred deallocations arrive.
+class MultiStreamAllocator : public Allocator {
+ public:
+  MultiStreamAllocator(Allocator* wrapped, EventMgr* em,
+                       gtl::InlinedVector<se::Stream*, 4> streams)
+      : wrapped_(wrapped),
+        fences_(std::make_shared<Fences>(wrapped, em, std::move(streams))) {}
+
+  string Name() override { return wrapped_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return wrapped_->AllocateRaw(alignment, num_bytes);
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    return wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  void DeallocateRaw(void* ptr) override {
+    if (ptr == nullptr) return;
+    {
+      mutex_lock l(fences_->mu);
+      fences_->pending.push_back(ptr);
+      if (fences_->in_flight) return;
+      fences_->in_flight = true;
+    }
+    IssueFence(fences_);
+  }
+  bool TracksAllocationSizes() const override {
+    return wrapped_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return wrapped_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return wrapped_->AllocatedSize(ptr);
+  }
+  int64 AllocationId(const void* ptr) const override {
+    return wrapped_->AllocationId(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped_->GetStats();
+  }
+  void ClearStats() override { wrapped_->ClearStats(); }
+
+ private:
+  // The state shared with the fence callbacks, which may outlive this
+  // allocator, but not the device allocator.
+  struct Fences {
+    Fences(Allocator* wrapped, EventMgr* em,
+           gtl::InlinedVector<se::Stream*, 4> streams)
+        : wrapped(wrapped), em(em), streams(std::move(streams)) {}
+
+    Allocator* const wrapped;  // not owned
+    EventMgr* const em;        // not owned
+    const gtl::InlinedVector<se::Stream*, 4> streams;
+
+    mutex mu;
+    // Buffers released since the fence in flight was issued.
+    std::vector<void*> pending TF_GUARDED_BY(mu);
+    bool in_flight TF_GUARDED_BY(mu) = false;
+  };
+
+  // Issues a fence for the pending buffers of `fences`, which must have a
+  // fence in flight.
+  static void IssueFence(std::shared_ptr<Fences> fences) {
+    auto batch = std::make_shared<std::vector<void*>>();
+    {
+      mutex_lock l(fences->mu);
+      batch->swap(fences->pending);
+    }
+    auto remaining = std::make_shared<std::atomic<int>>(fences->streams.size());
+    for (se::Stream* stream : fences->streams) {
+      fences->em->ThenExecute(stream, [fences, batch, remaining]() {
+        if (remaining->fetch_sub(1) != 1) return;
+        for (void* ptr : *batch) {
+          fences->wrapped->DeallocateRaw(ptr);
+        }
+        {
+          mutex_lock l(fences->mu);
+          if (fences->pending.empty()) {
+            fences->in_flight = false;
+            return;
+          }
+        }
+        IssueFence(fences);
+      });
+    }
+  }
+
+  Allocator* const wrapped_;  // not owned
+  const std::shared_ptr<Fences> fences_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MultiStreamAllocator);
+};
+
+}  // namespace
+
 BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
                              Bytes memory_limit, const DeviceLocality& locality,
                              TfGpuId tf_gpu_id,
@@ -395,28 +478,56 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 
 BaseGPUDevice::~BaseGPUDevice() {
   delete gpu_device_info_;
-  gpu_allocator_->DeallocateRaw(scratch_);
-  device_context_->Unref();
+  for (char* scratch : scratch_) {
+    gpu_allocator_->DeallocateRaw(scratch);
+  }
+  for (GPUDeviceContext* device_context : device_contexts_) {
+    device_context->Unref();
+  }
+}
+
+Status BaseGPUDevice::RunWithGraphCapture(
+    uint64 key, const std::function<Status()>& enqueue) {
+  if (graph_cache_ == nullptr) {
+    return enqueue();
+  }
+  return graph_cache_->Run(key, enqueue);
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
+  if (scratch_.empty()) {
     DCHECK(stream_);
-    size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
-    ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
-    void* scratch_buffer = gpu_allocator_->AllocateRaw(
-        Allocator::kAllocatorAlignment, scratch_buffer_size);
-    if (scratch_buffer == nullptr) {
-      return errors::FailedPrecondition(
-          "Failed to allocate scratch buffer for device ", tf_gpu_id_.value());
-    }
-    se::DeviceMemory<char> mem(
-        se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
-    TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
-        &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    // Every compute stream needs its own buffer, since Eigen kernels on
+    // different streams may run concurrently.
+    gtl::InlinedVector<char*, 4> scratch;
+    Status status;
+    while (status.ok() && scratch.size() < streams_.size()) {
+      size_t scratch_buffer_size =
+          Eigen::kGpuScratchSize + sizeof(unsigned int);
+      ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
+      void* scratch_buffer = gpu_allocator_->AllocateRaw(
+          Allocator::kAllocatorAlignment, scratch_buffer_size);
+      if (scratch_buffer == nullptr) {
+        status = errors::FailedPrecondition(
+            "Failed to allocate scratch buffer for device ",
+            tf_gpu_id_.value());
+        break;
+      }
+      scratch.push_back(static_cast<char*>(scratch_buffer));
+      se::DeviceMemory<char> mem(
+          se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
+      status = executor_->SynchronousMemZero(
+          &mem, Eigen::kGpuScratchSize + sizeof(unsigned int));
+    }
+    if (!status.ok()) {
+      for (char* buffer : scratch) {
+        gpu_allocator_->DeallocateRaw(buffer);
+      }
+      return status;
+    }
+    scratch_ = std::move(scratch);
   }
   return Status::OK();
 }
@@ -431,18 +542,44 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
 
   executor_ = executor_status.ValueOrDie();
 
-  stream_ = StreamGroupFactory::Global().GetOrCreate(
-      tf_gpu_id_, 0, executor_, options.config.gpu_options());
-  device_context_ =
-      new GPUDeviceContext(0, stream_->compute,
+  int num_compute_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+  if (num_compute_streams == 0) num_compute_streams = 1;
+  if (num_compute_streams < 1) {
+    LOG(ERROR) << "Illegal GPUOptions.experimental.num_compute_streams="
+               << num_compute_streams << " set to 1 instead.";
+    num_compute_streams = 1;
+  }
+  for (int i = 0; i < num_compute_streams; ++i) {
+    StreamGroup* group = StreamGroupFactory::Global().GetOrCreate(
+        tf_gpu_id_, i, executor_, options.config.gpu_options());
+    streams_.push_back(group);
+    device_contexts_.push_back(new GPUDeviceContext(
+        i, group->compute,
 #if TENSORFLOW_USE_ROCM
-                           stream_->nccl,
+        group->nccl,
 #endif
-                           stream_->host_to_device, stream_->device_to_host,
-                           stream_->device_to_device);
+        group->host_to_device, group->device_to_host,
+        group->device_to_device));
+  }
+  stream_ = streams_[0];
+  device_context_ = device_contexts_[0];
 
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
+  swapping_allocator_ =
+      GPUProcessState::singleton()->GetGPUSwappingAllocator(tf_gpu_id_);
+
+  if (num_compute_streams > 1) {
+    gtl::InlinedVector<se::Stream*, 4> compute_streams;
+    for (StreamGroup* group : streams_) {
+      compute_streams.push_back(group->compute);
+    }
+    multi_stream_allocator_ = absl::make_unique<MultiStreamAllocator>(
+        gpu_allocator_, em_, std::move(compute_streams));
+    VLOG(1) << "GPU " << tf_gpu_id_.value() << " uses " << num_compute_streams
+            << " compute streams";
+  }
 
   GPUKernelTracker::Params tracker_params(
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
@@ -469,6 +606,14 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
 
+  const int max_graphs = options.config.gpu_options()
+                             .experimental()
+                             .gpu_graph_capture_max_graphs();
+  if (max_graphs > 0) {
+    graph_cache_ = absl::make_unique<GpuGraphCache>(
+        stream_->compute, stream_allocator(), max_graphs);
+  }
+
   gpu_device_info_ = new GpuDeviceInfo;
   gpu_device_info_->stream = stream_->compute;
   gpu_device_info_->default_context = device_context_;
@@ -563,6 +708,13 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
       kernel_tracker_->PauseWhilePendingExceeds(pending_cap_);
     }
   }
+  if (streams_.size() > 1) {
+    WaitForInputStreams(context, stream);
+  }
+  if (swapping_allocator_ != nullptr) {
+    SwapInInputs(context, stream);
+  }
+
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
   ScopedMemoryDebugAnnotation op_annotation(op_kernel->name_view().data(),
                                             context->step_id());
@@ -605,11 +757,84 @@ Status BaseGPUDevice::Sync() {
 
   // Device::Sync is supposed to block until all operations queued on the device
   // at the time of the call have completed.  On GPUs, only operations enqueued
-  // on the compute stream can remain pending after the (Async)OpKernel that
+  // on the compute streams can remain pending after the (Async)OpKernel that
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  for (StreamGroup* group : streams_) {
+    TF_RETURN_IF_ERROR(group->compute->BlockHostUntilDone());
+  }
+  return Status::OK();
+}
+
+void BaseGPUDevice::Sync(const DoneCallback& done) {
+  DCHECK_NE(stream_, nullptr);
+  ReffedStatusCallback* synced = new ReffedStatusCallback(done);
+  core::ScopedUnref unref(synced);
+  for (StreamGroup* group : streams_) {
+    se::Stream* stream = group->compute;
+    if (!stream->ok()) {
+      synced->UpdateStatus(errors::Internal("GPU compute stream of ", name(),
+                                            " is in an error state"));
+      continue;
+    }
+    synced->Ref();
+    em_->ThenExecute(stream, [synced]() { synced->Unref(); });
+  }
+}
+
+Status BaseGPUDevice::FillContextMap(
+    const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+  if (streams_.size() <= 1) return Status::OK();
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = streams_.size();
+  std::vector<int> node_to_stream_id;
+  TF_RETURN_IF_ERROR(
+      gpu_stream_util::AssignStreams(graph, opts, &node_to_stream_id));
+  device_context_map->resize(node_to_stream_id.size());
+  for (size_t i = 0; i < node_to_stream_id.size(); ++i) {
+    GPUDeviceContext* device_context = device_contexts_[node_to_stream_id[i]];
+    device_context->Ref();
+    (*device_context_map)[i] = device_context;
+  }
+  return Status::OK();
+}
+
+void BaseGPUDevice::WaitForInputStreams(OpKernelContext* context,
+                                        se::Stream* stream) {
+  const auto* input_device_contexts = context->input_device_contexts();
+  if (input_device_contexts == nullptr) return;
+  gtl::InlinedVector<se::Stream*, 4> waited_for;
+  for (DeviceContext* input_device_context : *input_device_contexts) {
+    se::Stream* input_stream =
+        input_device_context != nullptr
+            ? static_cast<GPUDeviceContext*>(input_device_context)->stream()
+            : stream_->compute;
+    if (input_stream == stream ||
+        std::find(waited_for.begin(), waited_for.end(), input_stream) !=
+            waited_for.end()) {
+      continue;
+    }
+    // The producer has enqueued its work by now, so this orders the op after
+    // it.
+    stream->ThenWaitFor(input_stream);
+    waited_for.push_back(input_stream);
+  }
+}
+
+void BaseGPUDevice::SwapInInputs(OpKernelContext* context, se::Stream* stream) {
+  gtl::InlinedVector<const void*, 4> inputs;
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->has_input(i) || context->input_is_ref(i) ||
+        context->input_memory_type(i) != DEVICE_MEMORY) {
+      continue;
+    }
+    const Tensor& input = context->input(i);
+    if (input.IsInitialized()) {
+      inputs.push_back(DMAHelper::base(&input));
+    }
+  }
+  swapping_allocator_->PrepareForUse(inputs, stream);
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -627,6 +852,13 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
           << op_kernel->type_string() << " on GPU" << tf_gpu_id_ << " stream["
           << stream_id << "]";
 
+  if (streams_.size() > 1) {
+    WaitForInputStreams(context, stream);
+  }
+  if (swapping_allocator_ != nullptr) {
+    SwapInInputs(context, stream);
+  }
+
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
   op_kernel->ComputeAsync(context, std::move(done));
 }
@@ -1034,11 +1266,12 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  DCHECK_GE(stream_id, 0);
+  DCHECK_LT(stream_id, streams_.size());
   const gpuStream_t* gpu_stream = reinterpret_cast<const gpuStream_t*>(
-      stream_->compute->implementation()->GpuStreamMemberHack());
+      streams_[stream_id]->compute->implementation()->GpuStreamMemberHack());
   concrete_device->Reinitialize(context, gpu_stream, tf_gpu_id_, allocator,
-                                scratch_);
+                                scratch_[stream_id]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1055,7 +1288,6 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
@@ -1320,6 +1552,13 @@ Status BaseGPUDeviceFactory::CreateDevices(
     }
   }
 
+  // Let large GPU to GPU copies be routed along the strongest links.
+  for (const InterconnectMap& im : interconnect_maps) {
+    for (const auto& link : im.directed_links) {
+      GpuCopyRouter::Global()->AddLink(link.first, link.second, im.strength);
+    }
+  }
+
   const auto& virtual_devices = gpu_options.experimental().virtual_devices();
   if (!virtual_devices.empty()) {
     TF_RETURN_IF_ERROR(VerifyVirtualDeviceSettings(
@@ -1476,6 +1715,14 @@ GetPeerAccessMap(se::Platform* platform,
 
 }  // namespace
 
+#if TENSORFLOW_USE_ROCM
+// The HSA link type of xGMI links (HSA_AMD_LINK_INFO_TYPE_XGMI).
+constexpr uint32_t kHsaLinkTypeXgmi = 4;
+// Approximate bandwidth of a xGMI link in GB/sec, relative to the
+// StreamExecutor strength of any peer link.
+constexpr int32 kXgmiStrength = 50;
+#endif  // TENSORFLOW_USE_ROCM
+
 Status BaseGPUDeviceFactory::GetInterconnectMaps(
     const std::vector<PlatformGpuId>& visible_gpu_order,
     se::Platform* gpu_manager, std::vector<InterconnectMap>* maps) {
@@ -1493,6 +1740,30 @@ Status BaseGPUDeviceFactory::GetInterconnectMaps(
       }
     }
   }
+#if TENSORFLOW_USE_ROCM
+  // xGMI links between AMD GPUs are several times faster than PCIe, and in
+  // larger machines only some pairs of GPUs are directly connected by one.
+  InterconnectMap xgmi_map;
+  xgmi_map.name = "xGMI";
+  xgmi_map.strength = kXgmiStrength;
+  for (PlatformGpuId gpu_id_i : visible_gpu_order) {
+    for (PlatformGpuId gpu_id_j : visible_gpu_order) {
+      if (gpu_id_i == gpu_id_j || !(*access_map)[{gpu_id_i, gpu_id_j}]) {
+        continue;
+      }
+      uint32_t link_type = 0;
+      uint32_t hop_count = 0;
+      if (hipExtGetLinkTypeAndHopCount(gpu_id_i.value(), gpu_id_j.value(),
+                                       &link_type, &hop_count) == hipSuccess &&
+          link_type == kHsaLinkTypeXgmi && hop_count == 1) {
+        xgmi_map.directed_links.insert({gpu_id_i, gpu_id_j});
+      }
+    }
+  }
+  if (!xgmi_map.directed_links.empty()) {
+    maps->push_back(std::move(xgmi_map));
+  }
+#endif  // TENSORFLOW_USE_ROCM
   return Status::OK();
 }
 
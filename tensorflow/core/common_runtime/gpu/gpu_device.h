@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
@@ -48,6 +49,7 @@ limitations under the License.
 
 namespace tensorflow {
 class GPUKernelTracker;
+class GPUSwappingAllocator;
 
 class BaseGPUDevice : public LocalDevice {
  public:
@@ -66,6 +68,17 @@ class BaseGPUDevice : public LocalDevice {
 
   Status Sync() override;
 
+  // Like Sync(), but calls `done` from the event manager once the compute
+  // streams have reached the point of the call, instead of blocking.
+  void Sync(const DoneCallback& done) override;
+
+  // Assigns the nodes of `graph` to the compute streams of this device when
+  // GPUOptions.Experimental.num_compute_streams is greater than 1, and leaves
+  // `device_context_map` empty otherwise.
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override;
+
   void ComputeAsync(AsyncOpKernel* op_kernel, OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
@@ -116,6 +129,15 @@ class BaseGPUDevice : public LocalDevice {
 
   int priority() const { return stream_->priority; }
 
+  // Enqueues the device work of `enqueue` onto the compute stream.  If
+  // GPUOptions.Experimental.gpu_graph_capture_max_graphs is positive, the work
+  // of the first run of `key` is captured into a GPU graph, and later runs
+  // with the same key replay the graph instead of calling `enqueue`.  See
+  // GpuGraphCache for what `key` must identify.  `enqueue` must allocate
+  // device memory through GetAllocator() and must not wait for device work.
+  Status RunWithGraphCapture(uint64 key,
+                             const std::function<Status()>& enqueue);
+
   // Helper method for unit tests to reset the streams. Never use in production.
   static void TestOnlyReset();
 
@@ -126,6 +148,12 @@ class BaseGPUDevice : public LocalDevice {
   se::StreamExecutor* executor_;  // not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
 
+  // Returns the allocator for device memory, which is the allocator of the
+  // capture while GPU work is being captured into a graph.
+  Allocator* device_allocator() const {
+    return graph_cache_ ? graph_cache_->allocator() : stream_allocator();
+  }
+
  private:
   friend class GPUDeviceTestHelper;
   struct StreamGroup {
@@ -140,10 +168,21 @@ class BaseGPUDevice : public LocalDevice {
   };
   class StreamGroupFactory;
 
+  // The stream group and device context of the first compute stream, which
+  // runs every op unless several compute streams are used.
   StreamGroup* stream_;
+  // One stream group and device context per compute stream.
+  gtl::InlinedVector<StreamGroup*, 4> streams_;
+  gtl::InlinedVector<GPUDeviceContext*, 4> device_contexts_;
   mutex scratch_init_mutex_;
-  char* scratch_ = nullptr;
+  // The Eigen scratch buffer of each compute stream.
+  gtl::InlinedVector<char*, 4> scratch_;
   GPUDeviceContext* device_context_;
+  // Wraps gpu_allocator_ to defer deallocations until every compute stream is
+  // done with the memory, if several compute streams are used.
+  std::unique_ptr<Allocator> multi_stream_allocator_;
+  // Set if GPUOptions.Experimental.swap_resident_limit_mb is used.
+  GPUSwappingAllocator* swapping_allocator_ = nullptr;  // not owned
   GpuDeviceInfo* gpu_device_info_ = nullptr;
   mutex trace_mu_;
   TfGpuId tf_gpu_id_;
@@ -153,6 +192,21 @@ class BaseGPUDevice : public LocalDevice {
   std::unique_ptr<GPUKernelTracker> kernel_tracker_;
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
+  std::unique_ptr<GpuGraphCache> graph_cache_;
+
+  // Returns the allocator that is safe to use from all compute streams.
+  Allocator* stream_allocator() const {
+    return multi_stream_allocator_ ? multi_stream_allocator_.get()
+                                   : gpu_allocator_;
+  }
+
+  // Makes `stream` wait for the streams of the ops that the op of `context`
+  // depends on.
+  void WaitForInputStreams(OpKernelContext* context, se::Stream* stream);
+
+  // Brings the device inputs of the op of `context` back to the GPU on
+  // `stream` if they were swapped out by swapping_allocator_.
+  void SwapInInputs(OpKernelContext* context, se::Stream* stream);
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
@@ -46,12 +46,12 @@ class GPUDevice : public BaseGPUDevice {
     if (attr.on_host()) {
       if (attr.gpu_compatible() || force_gpu_compatible_) {
         GPUProcessState* ps = GPUProcessState::singleton();
-        return ps->GetGpuHostAllocator(0);
+        return ps->GetGpuHostAllocator(attributes().locality().numa_node());
       } else {
         return cpu_allocator_;
       }
     } else {
-      return gpu_allocator_;
+      return device_allocator();
     }
   }
 
@@ -0,0 +1,193 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+#include "tensorflow/stream_executor/gpu/gpu_types.h"
+#endif
+
+namespace tensorflow {
+
+GraphCaptureAllocator::~GraphCaptureAllocator() {
+  for (void* ptr : buffers_) {
+    wrapped_->DeallocateRaw(ptr);
+  }
+}
+
+void* GraphCaptureAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+}
+
+void* GraphCaptureAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    buffers_.push_back(ptr);
+  }
+  return ptr;
+}
+
+#if CUDA_VERSION >= 10000 || TF_ROCM_VERSION >= 40300
+
+using ::stream_executor::gpu::AsGpuStreamValue;
+using ::stream_executor::gpu::GpuContext;
+using ::stream_executor::gpu::GpuDriver;
+using ::stream_executor::gpu::GpuGraphExecHandle;
+
+struct GpuGraphCache::Graph {
+  GpuGraphExecHandle graph_exec;
+  std::unique_ptr<GraphCaptureAllocator> allocator;
+};
+
+GpuGraphCache::GpuGraphCache(se::Stream* stream, Allocator* device_allocator,
+                             int max_graphs)
+    : stream_(stream),
+      device_allocator_(device_allocator),
+      gpu_context_(static_cast<GpuContext*>(
+          stream->parent()->implementation()->GpuContextHack())),
+      max_graphs_(max_graphs),
+      current_allocator_(device_allocator) {}
+
+GpuGraphCache::~GpuGraphCache() {
+  // The buffers of the graphs may only be released once no replay is pending.
+  Status status = stream_->BlockHostUntilDone();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to wait for GPU graph replays: " << status;
+  }
+  for (auto& it : graphs_) {
+    if (it.second != nullptr) {
+      GpuDriver::DestroyGraphExec(gpu_context_, it.second->graph_exec);
+    }
+  }
+}
+
+int GpuGraphCache::num_graphs() {
+  mutex_lock l(mu_);
+  int num_graphs = 0;
+  for (const auto& it : graphs_) {
+    if (it.second != nullptr) ++num_graphs;
+  }
+  return num_graphs;
+}
+
+Status GpuGraphCache::Run(uint64 key,
+                          const std::function<Status()>& enqueue) {
+  mutex_lock l(mu_);
+  auto it = graphs_.find(key);
+  if (it == graphs_.end()) {
+    if (static_cast<int>(graphs_.size()) >= max_graphs_) {
+      return enqueue();
+    }
+    return CaptureAndLaunch(key, enqueue);
+  }
+  if (it->second == nullptr) {
+    return enqueue();
+  }
+  return GpuDriver::GraphLaunch(gpu_context_, it->second->graph_exec,
+                                AsGpuStreamValue(stream_));
+}
+
+Status GpuGraphCache::CaptureAndLaunch(
+    uint64 key, const std::function<Status()>& enqueue) {
+  Status status =
+      GpuDriver::StreamBeginCapture(gpu_context_, AsGpuStreamValue(stream_));
+  if (!status.ok()) {
+    VLOG(1) << "Failed to begin GPU graph capture for key " << key
+            << ", running without capture: " << status;
+    graphs_[key] = nullptr;
+    return enqueue();
+  }
+  auto allocator = absl::make_unique<GraphCaptureAllocator>(device_allocator_);
+  current_allocator_ = allocator.get();
+  Status enqueue_status = enqueue();
+  current_allocator_ = device_allocator_;
+  auto graph = GpuDriver::StreamEndCapture(gpu_context_,
+                                           AsGpuStreamValue(stream_));
+
+  if (!enqueue_status.ok()) {
+    // None of the captured work was run, so there is nothing to fall back to.
+    if (graph.ok()) {
+      GpuDriver::DestroyGraph(gpu_context_, graph.ValueOrDie());
+    }
+    failed_allocators_.push_back(std::move(allocator));
+    return enqueue_status;
+  }
+  status = graph.status();
+  GpuGraphExecHandle graph_exec = nullptr;
+  if (graph.ok()) {
+    auto instantiated =
+        GpuDriver::GraphInstantiate(gpu_context_, graph.ValueOrDie());
+    GpuDriver::DestroyGraph(gpu_context_, graph.ValueOrDie());
+    status = instantiated.status();
+    if (instantiated.ok()) {
+      graph_exec = instantiated.ValueOrDie();
+    }
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Failed to capture GPU graph for key " << key
+            << ", running without capture: " << status;
+    failed_allocators_.push_back(std::move(allocator));
+    graphs_[key] = nullptr;
+    return enqueue();
+  }
+
+  auto& entry = graphs_[key];
+  entry = absl::make_unique<Graph>();
+  entry->graph_exec = graph_exec;
+  entry->allocator = std::move(allocator);
+  VLOG(1) << "Captured GPU graph for key " << key;
+  // Captured work is not executed, so the graph also runs the first time.
+  return GpuDriver::GraphLaunch(gpu_context_, entry->graph_exec,
+                                AsGpuStreamValue(stream_));
+}
+
+#else  // CUDA_VERSION >= 10000 || TF_ROCM_VERSION >= 40300
+
+struct GpuGraphCache::Graph {};
+
+GpuGraphCache::GpuGraphCache(se::Stream* stream, Allocator* device_allocator,
+                             int max_graphs)
+    : stream_(stream),
+      device_allocator_(device_allocator),
+      gpu_context_(nullptr),
+      max_graphs_(max_graphs),
+      current_allocator_(device_allocator) {}
+
+GpuGraphCache::~GpuGraphCache() {}
+
+int GpuGraphCache::num_graphs() { return 0; }
+
+Status GpuGraphCache::Run(uint64 key,
+                          const std::function<Status()>& enqueue) {
+  return enqueue();
+}
+
+Status GpuGraphCache::CaptureAndLaunch(
+    uint64 key, const std::function<Status()>& enqueue) {
+  return enqueue();
+}
+
+#endif  // CUDA_VERSION >= 10000 || TF_ROCM_VERSION >= 40300
+
+}  // namespace tensorflow
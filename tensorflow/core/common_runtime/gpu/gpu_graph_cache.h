@@ -0,0 +1,147 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace stream_executor {
+namespace gpu {
+class GpuContext;
+}  // namespace gpu
+}  // namespace stream_executor
+
+namespace tensorflow {
+
+// An allocator that forwards to another one but defers every deallocation
+// until it is destroyed.  It is installed while device work is captured into
+// a graph: the graph reads and writes the buffers allocated during the
+// capture every time it is replayed, long after the captured run released
+// them, so they must not be handed out again.
+class GraphCaptureAllocator : public Allocator {
+ public:
+  explicit GraphCaptureAllocator(Allocator* wrapped) : wrapped_(wrapped) {}
+  // Returns every buffer to the wrapped allocator.  Buffers must no longer be
+  // in use by the device.
+  ~GraphCaptureAllocator() override;
+
+  string Name() override { return wrapped_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override {}
+  bool TracksAllocationSizes() const override {
+    return wrapped_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return wrapped_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return wrapped_->AllocatedSize(ptr);
+  }
+  int64 AllocationId(const void* ptr) const override {
+    return wrapped_->AllocationId(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped_->GetStats();
+  }
+
+ private:
+  Allocator* const wrapped_;  // not owned
+  mutex mu_;
+  std::vector<void*> buffers_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GraphCaptureAllocator);
+};
+
+// Captures the device work enqueued onto a stream by a callback into a GPU
+// graph, and replays the graph on later runs with the same key instead of
+// calling the callback, which saves the host cost of launching that work one
+// operation at a time.
+//
+// The key must identify everything the work depends on, in particular the
+// shapes and buffer addresses of its inputs and outputs: a replay repeats the
+// captured launches exactly.  While a capture is in progress, device memory
+// must be allocated from allocator(), which keeps it alive for as long as the
+// graph exists.
+//
+// Runs are serialized.  Nothing else may enqueue work onto the stream while a
+// capture is in progress, or that work becomes part of the graph.
+//
+// GPU graphs are only available in CUDA 10.0 and ROCm 4.3 or later.  On other
+// platforms Run() always calls its callback.
+class GpuGraphCache {
+ public:
+  // At most max_graphs graphs are kept.  Keys seen after that always run
+  // without capture.
+  GpuGraphCache(se::Stream* stream, Allocator* device_allocator,
+                int max_graphs);
+  ~GpuGraphCache();
+
+  // Enqueues the work of `enqueue` onto the stream, by capturing it on the
+  // first run of `key` and by replaying the captured graph on later runs.
+  // `enqueue` must not wait for device work, since captured work does not
+  // execute until the graph is launched.  If the capture fails, `enqueue` is
+  // called again without capture and `key` is never captured again.
+  Status Run(uint64 key, const std::function<Status()>& enqueue);
+
+  // Returns the allocator for device memory: the capture's
+  // GraphCaptureAllocator while a capture is in progress, and the device
+  // allocator otherwise.
+  Allocator* allocator() const { return current_allocator_.load(); }
+
+  // Returns the number of graphs captured so far.
+  int num_graphs();
+
+ private:
+  struct Graph;
+
+  // Captures the work of `enqueue` into a new graph for `key` and launches
+  // it.  Falls back to calling `enqueue` without capture on failure.
+  Status CaptureAndLaunch(uint64 key, const std::function<Status()>& enqueue)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  se::Stream* const stream_;                             // not owned
+  Allocator* const device_allocator_;                    // not owned
+  stream_executor::gpu::GpuContext* const gpu_context_;  // not owned
+  const int max_graphs_;
+  std::atomic<Allocator*> current_allocator_;
+
+  mutex mu_;
+  // A null entry marks a key whose capture failed.
+  absl::flat_hash_map<uint64, std::unique_ptr<Graph>> graphs_
+      TF_GUARDED_BY(mu_);
+  // The allocators of failed captures, whose buffers may still be referenced
+  // by the work enqueued during the failed attempt.
+  std::vector<std::unique_ptr<GraphCaptureAllocator>> failed_allocators_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuGraphCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
@@ -0,0 +1,126 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device/device_mem_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumElements = 1024;
+constexpr uint64 kNumBytes = kNumElements * sizeof(int32);
+
+class GpuGraphCacheTest : public ::testing::Test {
+ protected:
+  GpuGraphCacheTest()
+      : executor_(GPUMachineManager()->ExecutorForDevice(0).ValueOrDie()),
+        stream_(executor_),
+        allocator_(new DeviceMemAllocator(executor_, PlatformGpuId(0),
+                                          false /*use_unified_memory*/, {},
+                                          {}),
+                   1 << 20, "GPU_0_bfc") {
+    stream_.Init();
+    buffer_ = executor_->AllocateArray<int32>(kNumElements);
+  }
+
+  ~GpuGraphCacheTest() override { executor_->Deallocate(&buffer_); }
+
+  // Enqueues a fill of buffer_ with `value`.
+  Status EnqueueFill(int32 value) {
+    ++num_enqueues_;
+    stream_.ThenMemset32(&buffer_, static_cast<uint32>(value), kNumBytes);
+    return stream_.ok() ? Status::OK() : errors::Internal("Stream failed");
+  }
+
+  // Clears buffer_, runs `key` through `cache` and checks that buffer_ was
+  // filled with `value`.
+  void RunAndCheck(GpuGraphCache* cache, uint64 key, int32 value) {
+    stream_.ThenMemZero(&buffer_, kNumBytes);
+    TF_ASSERT_OK(
+        cache->Run(key, [this, value]() { return EnqueueFill(value); }));
+    std::vector<int32> host(kNumElements, 0);
+    stream_.ThenMemcpy(host.data(), buffer_, kNumBytes);
+    TF_ASSERT_OK(stream_.BlockHostUntilDone());
+    for (int i = 0; i < kNumElements; ++i) {
+      ASSERT_EQ(value, host[i]) << "at index " << i;
+    }
+  }
+
+  se::StreamExecutor* executor_;
+  se::Stream stream_;
+  GPUBFCAllocator allocator_;
+  se::DeviceMemory<int32> buffer_;
+  int num_enqueues_ = 0;
+};
+
+TEST_F(GpuGraphCacheTest, ReplaysCapturedWork) {
+  GpuGraphCache cache(&stream_, &allocator_, /*max_graphs=*/1);
+  for (int i = 0; i < 3; ++i) {
+    RunAndCheck(&cache, /*key=*/1, /*value=*/42);
+  }
+  if (cache.num_graphs() == 1) {
+    // The work was only enqueued to capture it.
+    EXPECT_EQ(1, num_enqueues_);
+  } else {
+    // Graphs are not supported and every run enqueued the work.
+    EXPECT_EQ(3, num_enqueues_);
+  }
+}
+
+TEST_F(GpuGraphCacheTest, RunsWithoutCaptureBeyondMaxGraphs) {
+  GpuGraphCache cache(&stream_, &allocator_, /*max_graphs=*/1);
+  RunAndCheck(&cache, /*key=*/1, /*value=*/1);
+  const int num_graphs = cache.num_graphs();
+  num_enqueues_ = 0;
+  RunAndCheck(&cache, /*key=*/2, /*value=*/2);
+  RunAndCheck(&cache, /*key=*/2, /*value=*/2);
+  EXPECT_EQ(2, num_enqueues_);
+  EXPECT_EQ(num_graphs, cache.num_graphs());
+}
+
+TEST_F(GpuGraphCacheTest, AllocatorRetainsCapturedBuffers) {
+  GpuGraphCache cache(&stream_, &allocator_, /*max_graphs=*/1);
+  EXPECT_EQ(&allocator_, cache.allocator());
+  void* captured = nullptr;
+  TF_ASSERT_OK(cache.Run(/*key=*/1, [&]() {
+    captured = cache.allocator()->AllocateRaw(64, kNumBytes);
+    cache.allocator()->DeallocateRaw(captured);
+    return EnqueueFill(7);
+  }));
+  EXPECT_EQ(&allocator_, cache.allocator());
+  if (cache.num_graphs() == 1) {
+    // The buffer released during the capture must not be handed out again.
+    void* ptr = allocator_.AllocateRaw(64, kNumBytes);
+    EXPECT_NE(captured, ptr);
+    allocator_.DeallocateRaw(ptr);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
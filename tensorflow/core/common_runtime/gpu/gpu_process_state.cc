@@ -26,6 +26,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_swapping_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -107,18 +109,62 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
     while (bus_id >= gpu_visitors_.size()) {
       gpu_visitors_.push_back({});
     }
-    DeviceMemAllocator* sub_allocator = new DeviceMemAllocator(
+    se::StreamExecutor* executor =
         DeviceIdUtil::ExecutorForPlatformDeviceId(GPUMachineManager(),
                                                   platform_gpu_id)
-            .ValueOrDie(),
-        platform_gpu_id,
-        (options.per_process_gpu_memory_fraction() > 1.0 ||
-         options.experimental().use_unified_memory()),
-        gpu_visitors_[bus_id], {});
+            .ValueOrDie();
+    SubAllocator* sub_allocator = nullptr;
+#if CUDA_VERSION >= 10020 || TF_ROCM_VERSION >= 50200
+    if (options.experimental().use_virtual_memory() &&
+        !options.experimental().use_unified_memory() &&
+        options.per_process_gpu_memory_fraction() <= 1.0) {
+      std::vector<PlatformGpuId> peer_gpu_ids;
+      for (int i = 0; i < GPUMachineManager()->VisibleDeviceCount(); ++i) {
+        if (i != platform_gpu_id.value()) {
+          peer_gpu_ids.push_back(PlatformGpuId(i));
+        }
+      }
+      auto* gpu_context = static_cast<se::gpu::GpuContext*>(
+          executor->implementation()->GpuContextHack());
+      // Reserve twice the device memory so that the address space is not the
+      // limiting factor when growing or after compaction.
+      auto virtual_mem_allocator = GpuVirtualMemAllocator::Create(
+          gpu_visitors_[bus_id], {}, *gpu_context, platform_gpu_id,
+          /*virtual_address_space_size=*/total_bytes * 2, peer_gpu_ids);
+      if (virtual_mem_allocator.ok()) {
+        sub_allocator = virtual_mem_allocator.ValueOrDie().release();
+      } else {
+        LOG(WARNING) << "Failed to create GPU virtual memory allocator, "
+                     << "falling back to the device allocator: "
+                     << virtual_mem_allocator.status();
+      }
+    }
+#endif  // CUDA_VERSION >= 10020 || TF_ROCM_VERSION >= 50200
+    if (sub_allocator == nullptr) {
+      sub_allocator = new DeviceMemAllocator(
+          executor, platform_gpu_id,
+          (options.per_process_gpu_memory_fraction() > 1.0 ||
+           options.experimental().use_unified_memory()),
+          gpu_visitors_[bus_id], {});
+    }
     GPUBFCAllocator* gpu_bfc_allocator =
         new GPUBFCAllocator(sub_allocator, total_bytes, options,
                             strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
     Allocator* gpu_allocator = gpu_bfc_allocator;
+    GPUSwappingAllocator* swapping_allocator = nullptr;
+    const int64 swap_resident_limit_mb =
+        options.experimental().swap_resident_limit_mb();
+    if (swap_resident_limit_mb > 0) {
+      if (options.per_process_gpu_memory_fraction() > 1.0 ||
+          options.experimental().use_unified_memory()) {
+        swapping_allocator = new GPUSwappingAllocator(
+            gpu_allocator, executor, swap_resident_limit_mb << 20);
+        gpu_allocator = swapping_allocator;
+      } else {
+        LOG(WARNING) << "Ignoring GPUOptions.experimental."
+                     << "swap_resident_limit_mb, which requires unified memory.";
+      }
+    }
     SharedCounter* timing_counter = nullptr;
     if (options.experimental().timestamped_allocator()) {
       timing_counter = new SharedCounter;
@@ -152,7 +198,7 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
     }
     allocator_parts = {std::unique_ptr<Allocator>(gpu_allocator),
                        std::unique_ptr<SharedCounter>(timing_counter),
-                       gpu_bfc_allocator, sub_allocator,
+                       gpu_bfc_allocator, sub_allocator, swapping_allocator,
                        std::unique_ptr<Allocator>(recording_allocator)};
   }
   if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
@@ -192,13 +238,23 @@ SharedCounter* GPUProcessState::GPUAllocatorCounter(TfGpuId tf_gpu_id) {
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+GPUSwappingAllocator* GPUProcessState::GetGPUSwappingAllocator(
+    TfGpuId tf_gpu_id) {
+  mutex_lock l(mu_);
+  if (tf_gpu_id.value() >= static_cast<int64>(gpu_allocators_.size())) {
+    return nullptr;
+  }
+  return gpu_allocators_[tf_gpu_id.value()].swapping_allocator;
+}
+
 Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
   CHECK(process_state_);
   if (!HasGPUDevice() ||
       !process_state_->ProcessState::FLAGS_brain_mem_reg_gpu_dma) {
     return process_state_->GetCPUAllocator(numa_node);
   }
-  if (numa_node == port::kNUMANoAffinity) {
+  // Without NUMA support every node shares the allocator of node 0.
+  if (numa_node == port::kNUMANoAffinity || numa_node >= port::NUMANumNodes()) {
     numa_node = 0;
   }
   {
@@ -208,13 +264,13 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     // we take a unique lock and populate these vectors.
     tf_shared_lock lock(mu_);
 
-    if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types &&
-        !gpu_host_allocators_.empty() &&
-        gpu_host_allocators_[0].recording_allocator != nullptr) {
-      return gpu_host_allocators_[0].recording_allocator.get();
-    }
     if (static_cast<int>(gpu_host_allocators_.size()) > numa_node) {
-      return gpu_host_allocators_[0].allocator.get();
+      const AllocatorParts& allocator_parts = gpu_host_allocators_[numa_node];
+      if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types &&
+          allocator_parts.recording_allocator != nullptr) {
+        return allocator_parts.recording_allocator.get();
+      }
+      return allocator_parts.allocator.get();
     }
   }
 
@@ -239,15 +295,16 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
   CHECK_NE(nullptr, se);
 
   while (static_cast<int>(gpu_host_allocators_.size()) <= numa_node) {
-    while (gpu_host_alloc_visitors_.size() <= numa_node) {
+    const int node = gpu_host_allocators_.size();
+    while (gpu_host_alloc_visitors_.size() <= node) {
       gpu_host_alloc_visitors_.push_back({});
     }
-    while (gpu_host_free_visitors_.size() <= numa_node) {
+    while (gpu_host_free_visitors_.size() <= node) {
       gpu_host_free_visitors_.push_back({});
     }
-    SubAllocator* sub_allocator = new DeviceHostAllocator(
-        se, numa_node, gpu_host_alloc_visitors_[numa_node],
-        gpu_host_free_visitors_[numa_node]);
+    SubAllocator* sub_allocator =
+        new DeviceHostAllocator(se, node, gpu_host_alloc_visitors_[node],
+                                gpu_host_free_visitors_[node]);
     // TODO(zheng-xq): evaluate whether 64GB by default is the best choice.
     int64 gpu_host_mem_limit_in_mb = -1;
     Status status = ReadInt64FromEnvVar("TF_GPU_HOST_MEM_LIMIT_IN_MB",
@@ -258,9 +315,10 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     }
     int64 gpu_host_mem_limit = gpu_host_mem_limit_in_mb * (1LL << 20);
 
-    Allocator* allocator =
-        new BFCAllocator(sub_allocator, gpu_host_mem_limit,
-                         true /*allow_growth*/, "gpu_host_bfc" /*name*/);
+    // The limit applies to each NUMA node separately.
+    Allocator* allocator = new BFCAllocator(
+        sub_allocator, gpu_host_mem_limit, true /*allow_growth*/,
+        node == 0 ? "gpu_host_bfc" : strings::StrCat("gpu_host_bfc_", node));
 
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
@@ -269,13 +327,13 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     }
     gpu_host_allocators_.push_back({std::unique_ptr<Allocator>(allocator),
                                     std::unique_ptr<SharedCounter>(nullptr),
-                                    nullptr, sub_allocator,
+                                    nullptr, sub_allocator, nullptr,
                                     std::unique_ptr<Allocator>(nullptr)});
     AllocatorParts& allocator_parts = gpu_host_allocators_.back();
     if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
       ProcessState::MemDesc md;
       md.loc = ProcessState::MemDesc::CPU;
-      md.dev_index = 0;
+      md.dev_index = node;
       md.gpu_registered = true;
       md.nic_registered = false;
       allocator_parts.recording_allocator.reset(
@@ -285,10 +343,21 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     }
   }
   if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
-    return gpu_host_allocators_[0].recording_allocator.get();
+    return gpu_host_allocators_[numa_node].recording_allocator.get();
   } else {
-    return gpu_host_allocators_[0].allocator.get();
+    return gpu_host_allocators_[numa_node].allocator.get();
+  }
+}
+
+std::vector<absl::optional<AllocatorStats>>
+GPUProcessState::GetGpuHostAllocatorStats() {
+  tf_shared_lock lock(mu_);
+  std::vector<absl::optional<AllocatorStats>> stats;
+  stats.reserve(gpu_host_allocators_.size());
+  for (const AllocatorParts& allocator_parts : gpu_host_allocators_) {
+    stats.push_back(allocator_parts.allocator->GetStats());
   }
+  return stats;
 }
 
 void GPUProcessState::AddGPUAllocVisitor(int bus_id,
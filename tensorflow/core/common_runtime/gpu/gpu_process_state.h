@@ -34,6 +34,7 @@ namespace tensorflow {
 
 class Allocator;
 class GPUBFCAllocator;
+class GPUSwappingAllocator;
 class PoolAllocator;
 class SharedCounter;
 
@@ -89,8 +90,16 @@ class GPUProcessState {
     return gpu_allocators_.size();
   }
 
+  // Returns the allocator for pinned host memory on the specified NUMA node,
+  // which should be the node closest to the PCIe root of the GPUs exchanging
+  // data through it.  Falls back to node 0 if numa_node is
+  // port::kNUMANoAffinity or NUMA is not supported.
   virtual Allocator* GetGpuHostAllocator(int numa_node);
 
+  // Returns the stats of the pinned host allocator of every NUMA node created
+  // so far, indexed by node.
+  std::vector<absl::optional<AllocatorStats>> GetGpuHostAllocatorStats();
+
   // Registers a Visitor to be invoked on new chunks of memory allocated by the
   // SubAllocator of every GPU proximate to the specified bus.  The AllocVisitor
   // is provided with a memory pointer, a GPU id, and the size of the area it
@@ -118,6 +127,10 @@ class GPUProcessState {
 
   SharedCounter* GPUAllocatorCounter(TfGpuId tf_gpu_id);
 
+  // Returns the swapping allocator of the GPU allocator for `tf_gpu_id`, or
+  // nullptr if GPUOptions.Experimental.swap_resident_limit_mb is not set.
+  GPUSwappingAllocator* GetGPUSwappingAllocator(TfGpuId tf_gpu_id);
+
  protected:
   // GPUProcessState is a singleton that should not normally be deleted except
   // at process shutdown.
@@ -145,6 +158,7 @@ class GPUProcessState {
     std::unique_ptr<SharedCounter> counter;
     GPUBFCAllocator* bfc_allocator;
     SubAllocator* sub_allocator;  // owned by allocator
+    GPUSwappingAllocator* swapping_allocator;  // owned by allocator
     std::unique_ptr<Allocator> recording_allocator;
   };
   std::vector<AllocatorParts> gpu_allocators_ TF_GUARDED_BY(mu_);
@@ -0,0 +1,79 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+namespace {
+
+// Returns the stream of the first predecessor of `n` along the edges accepted
+// by `use_edge` that has not passed its stream on yet, or -1 if there is none.
+template <typename Pred>
+int InheritStream(const Node* n, const Pred& use_edge,
+                  const std::vector<int>& node_to_stream_id,
+                  std::vector<bool>* passed_on) {
+  for (const Edge* e : n->in_edges()) {
+    const Node* src = e->src();
+    if (src->IsSource() || !use_edge(e) || (*passed_on)[src->id()]) continue;
+    (*passed_on)[src->id()] = true;
+    return node_to_stream_id[src->id()];
+  }
+  return -1;
+}
+
+}  // namespace
+
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* node_to_stream_id) {
+  if (opts.max_streams < 1) {
+    return errors::InvalidArgument("max_streams must be positive, got ",
+                                   opts.max_streams);
+  }
+  node_to_stream_id->assign(graph->num_node_ids(), 0);
+  if (opts.max_streams == 1) return Status::OK();
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  std::vector<bool> passed_on(graph->num_node_ids(), false);
+  int next_stream = 0;
+  for (const Node* n : order) {
+    if (n->IsSource() || n->IsSink()) continue;
+    // Prefer to follow data edges, which carry the tensors the node reads.
+    int stream_id = InheritStream(
+        n, [](const Edge* e) { return !e->IsControlEdge(); },
+        *node_to_stream_id, &passed_on);
+    if (stream_id < 0) {
+      stream_id = InheritStream(
+          n, [](const Edge* e) { return e->IsControlEdge(); },
+          *node_to_stream_id, &passed_on);
+    }
+    if (stream_id < 0) {
+      stream_id = next_stream;
+      next_stream = (next_stream + 1) % opts.max_streams;
+    }
+    (*node_to_stream_id)[n->id()] = stream_id;
+    VLOG(2) << "Assigned " << n->name() << " to stream " << stream_id;
+  }
+  return Status::OK();
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
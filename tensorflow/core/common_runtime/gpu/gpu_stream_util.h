@@ -0,0 +1,48 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+struct AssignStreamsOpts {
+  // The number of compute streams to spread the nodes over.
+  int32 max_streams = 1;
+};
+
+// Assigns each node of `graph` to one of `opts.max_streams` compute streams,
+// so that independent chains of computation can overlap on the device.
+//
+// Nodes are visited in topological order.  A node inherits the stream of its
+// first predecessor that has not yet passed its stream on to another node, so
+// a chain of dependent nodes stays on one stream and needs no cross-stream
+// synchronization; a node without such a predecessor, e.g. every branch after
+// the first one of a fork, starts on the next stream in round-robin order.
+//
+// On return `node_to_stream_id` is indexed by node id.
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* node_to_stream_id);
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
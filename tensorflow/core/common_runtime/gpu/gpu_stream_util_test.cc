@@ -0,0 +1,139 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/graph_def_builder_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+REGISTER_OP("TestParams").Output("o: float");
+REGISTER_OP("TestUnary").Input("a: float").Output("o: float");
+REGISTER_OP("TestBinary")
+    .Input("a: float")
+    .Input("b: float")
+    .Output("o: float");
+
+class GpuStreamUtilTest : public ::testing::Test {
+ protected:
+  GpuStreamUtilTest() : b_(GraphDefBuilder::kFailImmediately) {}
+
+  // Builds the graph and assigns its nodes to `max_streams` streams.
+  void AssignStreams(int max_streams) {
+    graph_ = absl::make_unique<Graph>(OpRegistry::Global());
+    TF_ASSERT_OK(GraphDefBuilderToGraph(b_, graph_.get()));
+    gpu_stream_util::AssignStreamsOpts opts;
+    opts.max_streams = max_streams;
+    TF_ASSERT_OK(
+        gpu_stream_util::AssignStreams(graph_.get(), opts, &node_to_stream_));
+    ASSERT_EQ(graph_->num_node_ids(), node_to_stream_.size());
+  }
+
+  // Returns the stream assigned to the node named `name`.
+  int StreamOf(const string& name) {
+    for (const Node* n : graph_->nodes()) {
+      if (n->name() == name) return node_to_stream_[n->id()];
+    }
+    ADD_FAILURE() << "No node named " << name;
+    return -1;
+  }
+
+  GraphDefBuilder b_;
+  std::unique_ptr<Graph> graph_;
+  std::vector<int> node_to_stream_;
+};
+
+TEST_F(GpuStreamUtilTest, SingleStream) {
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  Node* a = SourceOp("TestParams", b_.opts().WithName("a"));
+  Node* b = SourceOp("TestParams", b_.opts().WithName("b"));
+  BinaryOp("TestBinary", a, b, b_.opts().WithName("c"));
+  AssignStreams(1);
+  for (int stream_id : node_to_stream_) {
+    EXPECT_EQ(0, stream_id);
+  }
+}
+
+TEST_F(GpuStreamUtilTest, IndependentChainsUseDifferentStreams) {
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  Node* a0 = SourceOp("TestParams", b_.opts().WithName("a0"));
+  Node* a1 = UnaryOp("TestUnary", a0, b_.opts().WithName("a1"));
+  UnaryOp("TestUnary", a1, b_.opts().WithName("a2"));
+  Node* b0 = SourceOp("TestParams", b_.opts().WithName("b0"));
+  Node* b1 = UnaryOp("TestUnary", b0, b_.opts().WithName("b1"));
+  UnaryOp("TestUnary", b1, b_.opts().WithName("b2"));
+  AssignStreams(2);
+  EXPECT_EQ(StreamOf("a0"), StreamOf("a1"));
+  EXPECT_EQ(StreamOf("a0"), StreamOf("a2"));
+  EXPECT_EQ(StreamOf("b0"), StreamOf("b1"));
+  EXPECT_EQ(StreamOf("b0"), StreamOf("b2"));
+  EXPECT_NE(StreamOf("a0"), StreamOf("b0"));
+}
+
+TEST_F(GpuStreamUtilTest, ForkAndJoin) {
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  Node* input = SourceOp("TestParams", b_.opts().WithName("input"));
+  Node* left = UnaryOp("TestUnary", input, b_.opts().WithName("left"));
+  Node* right = UnaryOp("TestUnary", input, b_.opts().WithName("right"));
+  BinaryOp("TestBinary", left, right, b_.opts().WithName("join"));
+  AssignStreams(2);
+  // One branch continues on the stream of the input, the other one overlaps
+  // with it on the other stream.
+  EXPECT_NE(StreamOf("left"), StreamOf("right"));
+  EXPECT_TRUE(StreamOf("input") == StreamOf("left") ||
+              StreamOf("input") == StreamOf("right"));
+  // The join continues on the stream of one of its inputs.
+  EXPECT_TRUE(StreamOf("join") == StreamOf("left") ||
+              StreamOf("join") == StreamOf("right"));
+}
+
+TEST_F(GpuStreamUtilTest, StreamsAreReusedRoundRobin) {
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  for (int i = 0; i < 4; ++i) {
+    SourceOp("TestParams", b_.opts().WithName(strings::StrCat("p", i)));
+  }
+  AssignStreams(2);
+  std::vector<int> num_nodes_per_stream(2, 0);
+  for (int i = 0; i < 4; ++i) {
+    const int stream_id = StreamOf(strings::StrCat("p", i));
+    ASSERT_GE(stream_id, 0);
+    ASSERT_LT(stream_id, 2);
+    ++num_nodes_per_stream[stream_id];
+  }
+  EXPECT_EQ(2, num_nodes_per_stream[0]);
+  EXPECT_EQ(2, num_nodes_per_stream[1]);
+}
+
+TEST(GpuStreamUtilInvalidTest, RejectsNonPositiveMaxStreams) {
+  Graph graph(OpRegistry::Global());
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 0;
+  std::vector<int> node_to_stream;
+  EXPECT_FALSE(
+      gpu_stream_util::AssignStreams(&graph, opts, &node_to_stream).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,191 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_swapping_allocator.h"
+
+#include <algorithm>
+
+#include "absl/base/casts.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/logging.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+#include "tensorflow/stream_executor/gpu/gpu_types.h"
+#endif
+
+namespace tensorflow {
+
+GPUSwappingAllocator::GPUSwappingAllocator(Allocator* allocator,
+                                           se::StreamExecutor* stream_exec,
+                                           size_t resident_limit_bytes)
+    : base_allocator_(allocator),
+      stream_exec_(stream_exec),
+      resident_limit_bytes_(resident_limit_bytes) {}
+
+GPUSwappingAllocator::~GPUSwappingAllocator() { delete base_allocator_; }
+
+void* GPUSwappingAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+}
+
+void* GPUSwappingAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = base_allocator_->AllocateRaw(alignment, num_bytes,
+                                           allocation_attr);
+  if (ptr == nullptr || num_bytes == 0) return ptr;
+  mutex_lock l(mu_);
+  // New buffers are resident.  If they push the resident bytes over the limit,
+  // the next PrepareForUse() swaps out the coldest buffers.
+  lru_.push_front(ptr);
+  buffers_[ptr] = Buffer{num_bytes, /*resident=*/true, lru_.begin()};
+  resident_bytes_ += num_bytes;
+  return ptr;
+}
+
+void GPUSwappingAllocator::DeallocateRaw(void* ptr) {
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    auto it = buffers_.find(ptr);
+    if (it != buffers_.end()) {
+      if (it->second.resident) {
+        lru_.erase(it->second.lru_position);
+        resident_bytes_ -= it->second.size;
+      } else {
+        swapped_out_bytes_ -= it->second.size;
+      }
+      buffers_.erase(it);
+    }
+  }
+  base_allocator_->DeallocateRaw(ptr);
+}
+
+bool GPUSwappingAllocator::TracksAllocationSizes() const {
+  return base_allocator_->TracksAllocationSizes();
+}
+
+size_t GPUSwappingAllocator::RequestedSize(const void* ptr) const {
+  return base_allocator_->RequestedSize(ptr);
+}
+
+size_t GPUSwappingAllocator::AllocatedSize(const void* ptr) const {
+  return base_allocator_->AllocatedSize(ptr);
+}
+
+int64 GPUSwappingAllocator::AllocationId(const void* ptr) const {
+  return base_allocator_->AllocationId(ptr);
+}
+
+absl::optional<AllocatorStats> GPUSwappingAllocator::GetStats() {
+  return base_allocator_->GetStats();
+}
+
+void GPUSwappingAllocator::ClearStats() { base_allocator_->ClearStats(); }
+
+std::map<const void*, GPUSwappingAllocator::Buffer>::iterator
+GPUSwappingAllocator::FindBuffer(const void* ptr) {
+  auto it = buffers_.upper_bound(ptr);
+  if (it == buffers_.begin()) return buffers_.end();
+  --it;
+  const char* begin = static_cast<const char*>(it->first);
+  if (static_cast<const char*>(ptr) >= begin + it->second.size) {
+    return buffers_.end();
+  }
+  return it;
+}
+
+void GPUSwappingAllocator::PrepareForUse(absl::Span<const void* const> ptrs,
+                                         se::Stream* stream) {
+  struct Migration {
+    const void* ptr;
+    size_t size;
+    bool to_host;
+  };
+  gtl::InlinedVector<Migration, 4> swap_ins;
+  gtl::InlinedVector<Migration, 4> swap_outs;
+  {
+    mutex_lock l(mu_);
+    gtl::InlinedVector<const void*, 4> used;
+    for (const void* ptr : ptrs) {
+      auto it = FindBuffer(ptr);
+      if (it == buffers_.end()) continue;
+      Buffer& buffer = it->second;
+      if (buffer.resident) {
+        lru_.splice(lru_.begin(), lru_, buffer.lru_position);
+      } else {
+        lru_.push_front(it->first);
+        buffer.lru_position = lru_.begin();
+        buffer.resident = true;
+        resident_bytes_ += buffer.size;
+        swapped_out_bytes_ -= buffer.size;
+        swap_ins.push_back({it->first, buffer.size, /*to_host=*/false});
+      }
+      used.push_back(it->first);
+    }
+    // The used buffers are now at the front of `lru_`, so reaching one of them
+    // means only used buffers are left.
+    while (resident_bytes_ > resident_limit_bytes_ && !lru_.empty() &&
+           std::find(used.begin(), used.end(), lru_.back()) == used.end()) {
+      Buffer& buffer = buffers_[lru_.back()];
+      buffer.resident = false;
+      resident_bytes_ -= buffer.size;
+      swapped_out_bytes_ += buffer.size;
+      swap_outs.push_back({lru_.back(), buffer.size, /*to_host=*/true});
+      lru_.pop_back();
+    }
+  }
+  // Make room before bringing buffers back.
+  for (const Migration& migration : swap_outs) {
+    Migrate(migration.ptr, migration.size, migration.to_host, stream);
+  }
+  for (const Migration& migration : swap_ins) {
+    Migrate(migration.ptr, migration.size, migration.to_host, stream);
+  }
+  if (!swap_outs.empty() || !swap_ins.empty()) {
+    VLOG(2) << Name() << " swapped out " << swap_outs.size()
+            << " buffers and swapped in " << swap_ins.size() << " buffers";
+  }
+}
+
+size_t GPUSwappingAllocator::resident_bytes() {
+  mutex_lock l(mu_);
+  return resident_bytes_;
+}
+
+size_t GPUSwappingAllocator::swapped_out_bytes() {
+  mutex_lock l(mu_);
+  return swapped_out_bytes_;
+}
+
+void GPUSwappingAllocator::Migrate(const void* ptr, size_t size, bool to_host,
+                                   se::Stream* stream) {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto* gpu_context = static_cast<se::gpu::GpuContext*>(
+      stream_exec_->implementation()->GpuContextHack());
+  Status status = se::gpu::GpuDriver::MemPrefetchAsync(
+      gpu_context,
+      absl::bit_cast<se::gpu::GpuDevicePtr>(const_cast<void*>(ptr)), size,
+      to_host, se::gpu::AsGpuStreamValue(stream));
+  if (!status.ok()) {
+    // The data stays valid, it is only not where it is needed next.
+    LOG_EVERY_N(WARNING, 1000) << "Failed to migrate " << size
+                               << " bytes of unified memory: " << status;
+  }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_SWAPPING_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_SWAPPING_ALLOCATOR_H_
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that wraps a unified-memory GPU allocator and keeps the
+// buffers it hands out resident on the GPU within a limit, by migrating the
+// least recently used buffers to host memory and migrating buffers back to the
+// GPU before the ops that read them run.
+//
+// Unified memory stays valid wherever its pages reside, so the migrations are
+// only placement hints: a kernel that touches a buffer that was swapped out
+// still sees the right data, it just pays for the page faults.  This lets jobs
+// whose working set exceeds the GPU memory degrade gracefully, with the cold
+// tensors, e.g. forward activations pending backprop, moved out of the way
+// instead of thrashing the GPU memory.
+class GPUSwappingAllocator : public Allocator {
+ public:
+  // Takes ownership of `allocator`, which must hand out unified memory of the
+  // device of `stream_exec`.
+  GPUSwappingAllocator(Allocator* allocator, se::StreamExecutor* stream_exec,
+                       size_t resident_limit_bytes);
+  ~GPUSwappingAllocator() override;
+
+  string Name() override { return base_allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override;
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+  int64 AllocationId(const void* ptr) const override;
+  absl::optional<AllocatorStats> GetStats() override;
+  void ClearStats() override;
+
+  // Marks the buffers containing `ptrs` as the most recently used ones and
+  // enqueues onto `stream` the migration back to the GPU of those of them
+  // that were swapped out, followed by the migration to host memory of the
+  // least recently used other buffers while the resident bytes exceed the
+  // limit.  Pointers that were not allocated by this allocator are ignored.
+  void PrepareForUse(absl::Span<const void* const> ptrs, se::Stream* stream);
+
+  // Returns the number of bytes allocated by this allocator that are resident
+  // on the GPU, and the number of bytes that are swapped out.
+  size_t resident_bytes();
+  size_t swapped_out_bytes();
+
+ private:
+  struct Buffer {
+    size_t size;
+    bool resident;
+    // The position of the buffer in `lru_`, if resident.
+    std::list<const void*>::iterator lru_position;
+  };
+
+  // Returns the buffer containing `ptr`, or buffers_.end().
+  std::map<const void*, Buffer>::iterator FindBuffer(const void* ptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Enqueues the migration of `size` bytes at `ptr` onto `stream`.
+  void Migrate(const void* ptr, size_t size, bool to_host, se::Stream* stream);
+
+  Allocator* base_allocator_;  // owned
+  se::StreamExecutor* stream_exec_;  // not owned
+  const size_t resident_limit_bytes_;
+
+  mutex mu_;
+  // The live buffers by address.
+  std::map<const void*, Buffer> buffers_ TF_GUARDED_BY(mu_);
+  // The resident buffers, most recently used first.
+  std::list<const void*> lru_ TF_GUARDED_BY(mu_);
+  size_t resident_bytes_ TF_GUARDED_BY(mu_) = 0;
+  size_t swapped_out_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUSwappingAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_SWAPPING_ALLOCATOR_H_
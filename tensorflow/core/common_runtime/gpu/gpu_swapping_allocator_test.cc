@@ -0,0 +1,121 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/common_runtime/gpu/gpu_swapping_allocator.h"
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+
+#include "tensorflow/core/common_runtime/device/device_mem_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kBufferBytes = 1 << 20;
+
+class GPUSwappingAllocatorTest : public ::testing::Test {
+ protected:
+  GPUSwappingAllocatorTest()
+      : executor_(GPUMachineManager()->ExecutorForDevice(0).ValueOrDie()),
+        stream_(executor_) {
+    stream_.Init();
+  }
+
+  // Returns a swapping allocator over unified memory that keeps at most
+  // `resident_buffers` buffers resident.
+  std::unique_ptr<GPUSwappingAllocator> MakeAllocator(int resident_buffers) {
+    auto* bfc = new GPUBFCAllocator(
+        new DeviceMemAllocator(executor_, PlatformGpuId(0),
+                               /*use_unified_memory=*/true, {}, {}),
+        1 << 24, "GPU_0_bfc");
+    return absl::make_unique<GPUSwappingAllocator>(
+        bfc, executor_, resident_buffers * kBufferBytes);
+  }
+
+  se::StreamExecutor* executor_;
+  se::Stream stream_;
+};
+
+TEST_F(GPUSwappingAllocatorTest, SwapsOutLeastRecentlyUsed) {
+  auto allocator = MakeAllocator(/*resident_buffers=*/2);
+  void* a = allocator->AllocateRaw(64, kBufferBytes);
+  void* b = allocator->AllocateRaw(64, kBufferBytes);
+  void* c = allocator->AllocateRaw(64, kBufferBytes);
+  EXPECT_EQ(3 * kBufferBytes, allocator->resident_bytes());
+
+  // `a` is the coldest buffer.
+  allocator->PrepareForUse({c}, &stream_);
+  EXPECT_EQ(2 * kBufferBytes, allocator->resident_bytes());
+  EXPECT_EQ(kBufferBytes, allocator->swapped_out_bytes());
+
+  // Bringing `a` back swaps out `b`, which is now the coldest one.
+  allocator->PrepareForUse({a}, &stream_);
+  EXPECT_EQ(2 * kBufferBytes, allocator->resident_bytes());
+  EXPECT_EQ(kBufferBytes, allocator->swapped_out_bytes());
+  allocator->DeallocateRaw(b);
+  EXPECT_EQ(2 * kBufferBytes, allocator->resident_bytes());
+  EXPECT_EQ(0, allocator->swapped_out_bytes());
+
+  TF_ASSERT_OK(stream_.BlockHostUntilDone());
+  allocator->DeallocateRaw(a);
+  allocator->DeallocateRaw(c);
+  EXPECT_EQ(0, allocator->resident_bytes());
+}
+
+TEST_F(GPUSwappingAllocatorTest, NeverSwapsOutUsedBuffers) {
+  auto allocator = MakeAllocator(/*resident_buffers=*/0);
+  void* a = allocator->AllocateRaw(64, kBufferBytes);
+  void* b = allocator->AllocateRaw(64, kBufferBytes);
+  // Interior pointers, e.g. of slices, count as uses of their buffer.
+  allocator->PrepareForUse({static_cast<char*>(a) + 128, b}, &stream_);
+  EXPECT_EQ(2 * kBufferBytes, allocator->resident_bytes());
+  allocator->PrepareForUse({b}, &stream_);
+  EXPECT_EQ(kBufferBytes, allocator->resident_bytes());
+  TF_ASSERT_OK(stream_.BlockHostUntilDone());
+  allocator->DeallocateRaw(a);
+  allocator->DeallocateRaw(b);
+}
+
+TEST_F(GPUSwappingAllocatorTest, DataSurvivesSwapping) {
+  auto allocator = MakeAllocator(/*resident_buffers=*/0);
+  void* ptr = allocator->AllocateRaw(64, kBufferBytes);
+  se::DeviceMemoryBase mem(ptr, kBufferBytes);
+  stream_.ThenMemset32(&mem, 0x12345678, kBufferBytes);
+  // Swap the buffer out and bring it back before reading it.
+  allocator->PrepareForUse({}, &stream_);
+  EXPECT_EQ(kBufferBytes, allocator->swapped_out_bytes());
+  allocator->PrepareForUse({ptr}, &stream_);
+  std::vector<uint32> host(kBufferBytes / sizeof(uint32));
+  stream_.ThenMemcpy(host.data(), mem, kBufferBytes);
+  TF_ASSERT_OK(stream_.BlockHostUntilDone());
+  for (uint32 value : host) {
+    ASSERT_EQ(0x12345678, value);
+  }
+  allocator->DeallocateRaw(ptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
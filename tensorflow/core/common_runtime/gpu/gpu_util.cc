@@ -15,10 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_copy_router.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -109,6 +115,56 @@ void* GetBase(const Tensor* src) {
 
 void* GetBase(Tensor* dst) { return DMAHelper::base(dst); }
 
+// Returns the route of a copy of `num_bytes` bytes from the GPU `src` to the
+// GPU `dst`.
+GpuCopyRouter::Route FindDeviceToDeviceRoute(Device* src, Device* dst,
+                                             int64 num_bytes) {
+  GpuCopyRouter::Route route;
+  route.direct_bytes = num_bytes;
+  const DeviceBase::GpuDeviceInfo* src_info =
+      src->tensorflow_gpu_device_info();
+  const DeviceBase::GpuDeviceInfo* dst_info =
+      dst->tensorflow_gpu_device_info();
+  if (src_info == nullptr || dst_info == nullptr) return route;
+  // The GPU device info holds the platform GPU ids.
+  return GpuCopyRouter::Global()->FindRoute(PlatformGpuId(src_info->gpu_id),
+                                            PlatformGpuId(dst_info->gpu_id),
+                                            num_bytes);
+}
+
+// The part of a routed copy that goes through the staging GPU is copied in
+// chunks of this size, so that the copy into the staging buffer and the copy
+// out of it overlap.
+constexpr int64 kStagedCopyChunkBytes = 8 << 20;
+
+// Enqueues the copy of bytes [offset, total_bytes) of `src` into `dst` through
+// a staging buffer on the GPU of `staging_executor`.  The copies into the
+// staging buffer run on `send_stream` and the copies out of it on
+// `recv_stream`.  Returns the staging buffer, or null memory, without
+// enqueuing anything, if the staging buffer is not available.
+DeviceMemoryBase EnqueueStagedCopy(se::StreamExecutor* staging_executor,
+                                   se::Stream* send_stream,
+                                   se::Stream* recv_stream, void* src_ptr,
+                                   void* dst_ptr, int64 offset,
+                                   int64 total_bytes) {
+  GpuCopyRouter* router = GpuCopyRouter::Global();
+  DeviceMemoryBase staging =
+      router->AcquireStagingBuffer(staging_executor, total_bytes - offset);
+  if (staging.is_null()) return staging;
+  char* staging_base = static_cast<char*>(staging.opaque());
+  for (int64 begin = offset; begin < total_bytes;
+       begin += kStagedCopyChunkBytes) {
+    const int64 size = std::min(kStagedCopyChunkBytes, total_bytes - begin);
+    DeviceMemoryBase src_chunk(static_cast<char*>(src_ptr) + begin, size);
+    DeviceMemoryBase staging_chunk(staging_base + begin - offset, size);
+    DeviceMemoryBase dst_chunk(static_cast<char*>(dst_ptr) + begin, size);
+    send_stream->ThenMemcpy(&staging_chunk, src_chunk, size);
+    recv_stream->ThenWaitFor(send_stream);
+    recv_stream->ThenMemcpy(&dst_chunk, staging_chunk, size);
+  }
+  return staging;
+}
+
 /*static*/
 void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
                               const DeviceContext* device_context,
@@ -148,7 +204,8 @@ void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
   const int64 total_bytes = is_dead ? 0 : tensor.TotalBytes();
   if (total_bytes > 0) {
     profiler::ScopedAnnotation annotation("SetProtoFromGPU");
-    alloc = GPUProcessState::singleton()->GetGpuHostAllocator(0);
+    alloc = GPUProcessState::singleton()->GetGpuHostAllocator(
+        dev->attributes().locality().numa_node());
     buf = static_cast<char*>(
         alloc->AllocateRaw(Allocator::kAllocatorAlignment, total_bytes));
     if (LogMemory::IsEnabled()) {
@@ -208,6 +265,9 @@ void GPUUtil::DeviceToDeviceCopy(
   // available.
   send_device_to_device_stream->ThenWaitFor(send_stream);
 
+  // The GPU and the receiver stream of the staged part of the copy, if any.
+  se::StreamExecutor* staging_stream_executor = nullptr;
+  se::Stream* staged_recv_stream = nullptr;
   const int64 total_bytes = input->TotalBytes();
   if (total_bytes > 0) {
     void* src_ptr = GetBase(input);
@@ -228,19 +288,60 @@ void GPUUtil::DeviceToDeviceCopy(
     send_device_to_device_stream->ThenWaitFor(recv_stream);
 
     VLOG(2) << "src_ptr " << src_ptr << " dst_ptr " << dst_ptr;
-    send_device_to_device_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
-                                             total_bytes);
+    // Large copies may be staged through another GPU, or split between the
+    // direct link and a staged route, depending on the link topology.  The
+    // staged part is copied into the staging GPU on a stream of its own, so
+    // that it runs concurrently with the direct part, and out of it on the
+    // device-to-device stream of the receiver.
+    int64 direct_bytes = total_bytes;
+    const GpuCopyRouter::Route route =
+        FindDeviceToDeviceRoute(src, dst, total_bytes);
+    if (route.via.value() >= 0) {
+      se::Stream* staging_send_stream =
+          GpuCopyRouter::Global()->GetStagingStream(
+              send_device_to_device_stream->parent());
+      se::Stream* staging_recv_stream =
+          static_cast<const GPUDeviceContext*>(recv_dev_context)
+              ->device_to_device_stream(dev_to_dev_stream_index);
+      auto staging_executor = DeviceIdUtil::ExecutorForPlatformDeviceId(
+          GPUMachineManager(), route.via);
+      if (staging_send_stream != nullptr && staging_recv_stream != nullptr &&
+          staging_executor.ok()) {
+        staging_send_stream->ThenWaitFor(send_device_to_device_stream);
+        DeviceMemoryBase staging_memory = EnqueueStagedCopy(
+            staging_executor.ValueOrDie(), staging_send_stream,
+            staging_recv_stream, src_ptr, dst_ptr, route.direct_bytes,
+            total_bytes);
+        if (!staging_memory.is_null()) {
+          staging_stream_executor = staging_executor.ValueOrDie();
+          staged_recv_stream = staging_recv_stream;
+          direct_bytes = route.direct_bytes;
+        }
+      }
+    }
+    if (direct_bytes > 0) {
+      send_device_to_device_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
+                                               direct_bytes);
+    }
+    if (staged_recv_stream != nullptr) {
+      send_device_to_device_stream->ThenWaitFor(staged_recv_stream);
+    }
   }
 
   // Use of input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*input);
   dev_info->event_mgr->ThenExecute(
       send_device_to_device_stream,
-      [done, send_device_to_device_stream, input_ref]() {
+      [done, send_device_to_device_stream, input_ref,
+       staging_stream_executor]() {
         input_ref.Unref();
         if (!send_device_to_device_stream->ok()) {
           LOG(FATAL) << "GPU->GPU Memcpy failed";
         }
+        if (staging_stream_executor != nullptr) {
+          GpuCopyRouter::Global()->ReleaseStagingBuffer(
+              staging_stream_executor);
+        }
         done(Status::OK());
       });
   send_dev_context->MaintainLifetimeOnStream(input,
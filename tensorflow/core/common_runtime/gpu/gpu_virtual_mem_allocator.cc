@@ -15,9 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
+#include "absl/base/casts.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 
-#if CUDA_VERSION >= 10020
+#if CUDA_VERSION >= 10020 || TF_ROCM_VERSION >= 50200
 
 namespace tensorflow {
 namespace {
@@ -33,6 +34,15 @@ size_t AlignUp(size_t value, size_t alignment) {
   return (value + alignment - 1) & ~(alignment - 1);
 }
 
+// GpuDevicePtr is an integer on CUDA and a pointer on ROCm.
+GpuDevicePtr OffsetDevicePtr(GpuDevicePtr base, size_t offset) {
+  return absl::bit_cast<GpuDevicePtr>(absl::bit_cast<uintptr_t>(base) + offset);
+}
+
+size_t DevicePtrDistance(GpuDevicePtr from, GpuDevicePtr to) {
+  return absl::bit_cast<uintptr_t>(to) - absl::bit_cast<uintptr_t>(from);
+}
+
 }  // namespace
 
 /* static */ stream_executor::port::StatusOr<
@@ -99,12 +109,12 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
   if (num_bytes == 0) return nullptr;
   size_t padded_bytes = (num_bytes + granularity_ - 1) & ~(granularity_ - 1);
 
-  GpuDevicePtr next_va = vmem_.base + next_alloc_offset_;
+  GpuDevicePtr next_va = OffsetDevicePtr(vmem_.base, next_alloc_offset_);
 
   // TODO(imintz): Attempt to extend the vmem allocation by reserving additional
   // virtual memory at the specific address at the end of the initial vmem
   // reservation.
-  if (next_va + padded_bytes > vmem_.base + vmem_.size_bytes) {
+  if (next_alloc_offset_ + padded_bytes > vmem_.size_bytes) {
     LOG(ERROR) << "OOM in GPU virtual memory allocator when attempting to "
                   "allocate {request: "
                << strings::HumanReadableNumBytes(num_bytes)
@@ -152,7 +162,7 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   }
 
   int num_mappings_to_free = 0;
-  int total_bytes = 0;
+  size_t total_bytes = 0;
   for (auto it = mapping_it; it != mappings_.end() && total_bytes < num_bytes;
        ++it) {
     ++num_mappings_to_free;
@@ -174,7 +184,7 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
 
   // Move back the next_alloc_offset_ if this free was at the end.
   if (mapping_it + num_mappings_to_free == mappings_.end()) {
-    next_alloc_offset_ = mapping_it->va - vmem_.base;
+    next_alloc_offset_ = DevicePtrDistance(vmem_.base, mapping_it->va);
   }
 
   mappings_.erase(mapping_it, mapping_it + num_mappings_to_free);
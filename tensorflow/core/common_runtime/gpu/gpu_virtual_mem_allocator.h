@@ -13,7 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-// CUDA virtual memory API is only available in CUDA versions greater than 10.2.
+// The GPU virtual memory API is only available in CUDA 10.2 and ROCm 5.2 or
+// later.
 
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VMEM_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VMEM_ALLOCATOR_H_
@@ -23,12 +24,12 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/stream_executor/lib/statusor.h"
 
-#if GOOGLE_CUDA
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/stream_executor/gpu/gpu_driver.h"
 #include "tensorflow/stream_executor/gpu/gpu_types.h"
 #endif
 
-#if CUDA_VERSION >= 10020
+#if CUDA_VERSION >= 10020 || TF_ROCM_VERSION >= 50200
 
 namespace tensorflow {
 
@@ -68,6 +69,10 @@ class GpuVirtualMemAllocator : public SubAllocator {
   // this free function should never be invoked.
   void Free(void* ptr, size_t num_bytes) override;
 
+  // Successive allocations are contiguous, and any run of whole, adjacent
+  // mappings can be freed at once.
+  bool SupportsCoalescing() const override { return true; }
+
  private:
   GpuVirtualMemAllocator(const std::vector<Visitor>& alloc_visitors,
                          const std::vector<Visitor>& free_visitors,
@@ -108,6 +113,6 @@ class GpuVirtualMemAllocator : public SubAllocator {
 
 }  // namespace tensorflow
 
-#endif  // CUDA_VERSION >= 10200
+#endif  // CUDA_VERSION >= 10020 || TF_ROCM_VERSION >= 50200
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VMEM_ALLOCATOR_H_
@@ -15,8 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
-#if CUDA_VERSION >= 10020
+#if CUDA_VERSION >= 10020 || TF_ROCM_VERSION >= 50200
 
+#include "absl/base/casts.h"
 #include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
@@ -69,7 +70,8 @@ TEST(GpuVirtualMemAllocatorTest, SimpleAlloc) {
   std::memset(host_mem[0], 'z', kBufSize);
   std::memset(host_mem[1], 0, kBufSize);
 
-  GpuDevicePtr gpu_buf = reinterpret_cast<GpuDevicePtr>(gpu_block) + 2048;
+  GpuDevicePtr gpu_buf = absl::bit_cast<GpuDevicePtr>(
+      absl::bit_cast<uintptr_t>(gpu_block) + 2048);
   ASSERT_TRUE(GpuDriver::SynchronousMemcpyH2D(gpu_context, gpu_buf, host_mem[0],
                                               kBufSize)
                   .ok());
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "gpu_init.h"
 #include "tensorflow/core/common_runtime/device/device_host_allocator.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/test.h"
 namespace tensorflow {
@@ -235,6 +236,27 @@ TEST(PoolAllocatorTest, CudaHostAllocator) {
   EXPECT_EQ(16 + 4 + 2 + (free_count * kChunkPrefixSize), free_size);
 }
 
+TEST(PoolAllocatorTest, NumaNodeHostAllocator) {
+  se::Platform* platform =
+      se::MultiPlatformManager::PlatformWithName(GpuPlatformName())
+          .ValueOrDie();
+  se::StreamExecutor* executor =
+      platform->GetExecutor(se::StreamExecutorConfig(/*ordinal=*/0))
+          .ValueOrDie();
+  const bool numa_enabled = port::NUMAEnabled() && port::NUMANumNodes() > 1;
+  for (int node = 0; node < port::NUMANumNodes(); ++node) {
+    DeviceHostAllocator sub_allocator(executor, node, {}, {});
+    size_t bytes_received = 0;
+    void* p = sub_allocator.Alloc(64 /*alignment*/, 1 << 20, &bytes_received);
+    ASSERT_NE(nullptr, p);
+    EXPECT_EQ(1 << 20, bytes_received);
+    if (numa_enabled) {
+      EXPECT_EQ(node, port::NUMAGetMemAffinity(p));
+    }
+    sub_allocator.Free(p, bytes_received);
+  }
+}
+
 TEST(PoolAllocatorTest, Pow2Rounder) {
   Pow2Rounder rounder;
   EXPECT_EQ(1, rounder.RoundUp(1));
@@ -90,6 +90,8 @@ const char* kAttr_epsilon = "epsilon";
 const char* kAttr_is_training = "is_training";
 const char* kAttr_padding = "padding";
 const char* kAttr_strides = "strides";
+const char* kAttr_transpose_a = "transpose_a";
+const char* kAttr_transpose_b = "transpose_b";
 
 const char* kGPUDeviceStr = "GPU";
 
@@ -179,6 +181,9 @@ inline bool isOpConvolution(const Node* n) {
 // is this node an instance of a bias op for which we support fusion for?
 inline bool isOpBias(const Node* n) { return (n->type_string() == "BiasAdd"); }
 
+// is this node an instance of a matmul op for which we support fusion for?
+inline bool isOpMatMul(const Node* n) { return (n->type_string() == "MatMul"); }
+
 // is this node an instance of a activation op for which we support fusion for?
 inline bool isOpActivation(const Node* n) {
   return ((n->type_string() == "Sigmoid") || (n->type_string() == "Relu") ||
@@ -256,35 +261,32 @@ inline string getActivationOpType(const Node* n) {
 
 //----------------------------------------------------------------------
 
-class ROCmFusionOpBase;
-
 class ROCmFusionPassBase : public GraphOptimizationPass {
  public:
+  explicit ROCmFusionPassBase(ROCmFusionPassType type) : type_(type) {}
+
   // optimization pass entry point,
   // application code will call this routine to run the pass
   virtual Status Run(const GraphOptimizationPassOptions& options, int grouping);
-  virtual void InitializeFusions(
-      std::vector<std::unique_ptr<ROCmFusionOpBase> >& fusions, Graph* g) = 0;
 
  private:
   // helper function that does all the work for this pass
   bool RunPass(Graph* g);
+
+  // the fusions registered with this pass type are run by this pass
+  const ROCmFusionPassType type_;
 };
 
 class ROCmFusionPass : public ROCmFusionPassBase {
  public:
+  ROCmFusionPass() : ROCmFusionPassBase(ROCmFusionPassType::kFusion) {}
   Status Run(const GraphOptimizationPassOptions& options) override;
-  void InitializeFusions(
-      std::vector<std::unique_ptr<ROCmFusionOpBase> >& fusions,
-      Graph* g) override;
 };
 
 class ROCmFMAPass : public ROCmFusionPassBase {
  public:
+  ROCmFMAPass() : ROCmFusionPassBase(ROCmFusionPassType::kFMA) {}
   Status Run(const GraphOptimizationPassOptions& options) override;
-  void InitializeFusions(
-      std::vector<std::unique_ptr<ROCmFusionOpBase> >& fusions,
-      Graph* g) override;
 };
 
 // Register the ROCmFusionPass with the registry.
@@ -300,114 +302,6 @@ REGISTER_OPTIMIZATION(kROCmFMAPassGrouping,  // grouping
 
 //----------------------------------------------------------------------
 
-// absract base class for an individual fusion operation
-class ROCmFusionOpBase {
- public:
-  ROCmFusionOpBase(Graph* g) : graph_(g) {}
-
-  virtual ~ROCmFusionOpBase() {}
-
-  // routine to (maybe) do fusion on the given node (+ the nodes preceding
-  // it). will return true if fusion was done, false otherwise
-  virtual bool DoFusion(const Node* n, std::set<const Node*>& fused_nodes);
-
-  using NodeIndexPair = std::pair<Node*, int>;
-
-  using NodeIndexPairVec = std::vector<NodeIndexPair>;
-
- protected:
-  struct FusionOpData {
-    string op_type;  // fusion op type (_ROCmFused*)
-
-    string op_name;  // fusion op name ( unique name for this op instance )
-
-    string fusion_type;  // simple description, for eg: Add+Relu
-
-    std::vector<const Node*> nodes;  // all the nodes in the fusion
-
-    // map of input data connections
-    // key is input index
-    // val is vec of node-index pairs, that connect to the input index
-    std::map<int, NodeIndexPairVec> data_inputs;
-
-    // dont need node indices for control edges, so a vector suffices
-    std::vector<Node*> control_inputs;
-
-    // map of output data connections
-    // key is output index
-    // val is vec of node-index pairs, that the output index connects to
-    std::map<int, NodeIndexPairVec> data_outputs;
-
-    // dont need node indices for control edges, so a vector suffices
-    std::vector<Node*> control_outputs;
-
-    // map of atrribute name --> value
-    std::map<string, AttrValue> attributes;
-
-    // conveninece function to add a data input
-    void add_data_input(int dst_index, Node* src_node, int src_index) {
-      auto it = data_inputs.find(dst_index);
-      if (it == data_inputs.end()) {
-        NodeIndexPairVec inputs;
-        inputs.push_back(std::make_pair(src_node, src_index));
-        data_inputs[dst_index] = inputs;
-      } else {
-        it->second.push_back(std::make_pair(src_node, src_index));
-      }
-    }
-
-    // convenience function to add a data output
-    void add_data_output(int src_index, Node* dst_node, int dst_index) {
-      auto it = data_outputs.find(src_index);
-      if (it == data_outputs.end()) {
-        NodeIndexPairVec outputs;
-        outputs.push_back(std::make_pair(dst_node, dst_index));
-        data_outputs[src_index] = outputs;
-      } else {
-        it->second.push_back(std::make_pair(dst_node, dst_index));
-      }
-    }
-
-    void add_controls(const Node* node) {
-      for (const Edge* e : node->in_edges())
-        if (e->IsControlEdge() && !isConsumed(e->src()))
-          control_inputs.push_back(e->src());
-      for (const Edge* e : node->out_edges())
-        if (e->IsControlEdge() && !isConsumed(e->dst()))
-          control_outputs.push_back(e->dst());
-    }
-
-    // conveniece function to add an attribute
-    template <typename T>
-    void add_attribute(string name, T value) {
-      AttrValue attr_value;
-      SetAttrValue(value, &attr_value);
-      attributes[name] = attr_value;
-    }
-
-    bool isConsumed(const Node* p) const {
-      for (const auto x : nodes)
-        if (p == x) return true;
-      return false;
-    }
-  };
-
-  // abstract routine that must be implemented by the derived classes.
-  // this routine needs to do the following
-  // ++ determine if the node sequence *ending* at the given node is a
-  //    candidate for fusion
-  //    ++ if it is not,
-  //         return false
-  //    ++ else,
-  //         populate the FusionOpData details and return true
-  virtual bool IsFusionEligible(const Node* n, FusionOpData* d) = 0;
-
- private:
-  void CreateFusionOp(const FusionOpData& d,
-                      std::set<const Node*>& fused_nodes);
-
-  Graph* graph_;
-};
 
 //----------------------------------------------------------------------
 
@@ -477,6 +371,19 @@ class ROCmFusionOpAddNReluGrad : public ROCmFusionOpBase {
 
 //----------------------------------------------------------------------
 
+// MatMul-Bias-Add-Activation Fusion
+// the Add (of a residual, a tensor with the shape of the MatMul output) and
+// the Activation are both optional, but at least one of them must be present
+class ROCmFusionOpMatMulBiasAddActivation : public ROCmFusionOpBase {
+ public:
+  ROCmFusionOpMatMulBiasAddActivation(Graph* g) : ROCmFusionOpBase(g) {}
+
+ protected:
+  bool IsFusionEligible(const Node* n, FusionOpData* d) override;
+};
+
+//----------------------------------------------------------------------
+
 class ROCmFusionOpFMA : public ROCmFusionOpBase {
  public:
   ROCmFusionOpFMA(Graph* g) : ROCmFusionOpBase(g) {}
@@ -487,6 +394,43 @@ class ROCmFusionOpFMA : public ROCmFusionOpBase {
 
 //----------------------------------------------------------------------
 
+// Register the fusions with the passes that run them.
+// The fusion of a longer node sequence gets a lower priority (i.e. is run
+// before) the fusions of its subsequences, e.g. the MatMul fusion must run
+// before the one of its trailing Add and Relu nodes.
+
+REGISTER_ROCM_FUSION(ROCmFusionPassType::kFusion, 10,
+                     "TF_ROCM_FUSION_DISABLE_CBNA",
+                     ROCmFusionOpConvolutionBiasBatchNormActivation);
+
+REGISTER_ROCM_FUSION(ROCmFusionPassType::kFusion, 20,
+                     "TF_ROCM_FUSION_DISABLE_CBA",
+                     ROCmFusionOpConvolutionBiasActivation);
+
+REGISTER_ROCM_FUSION(ROCmFusionPassType::kFusion, 30,
+                     "TF_ROCM_FUSION_DISABLE_BNA",
+                     ROCmFusionOpBatchNormActivationInference);
+
+REGISTER_ROCM_FUSION(ROCmFusionPassType::kFusion, 30,
+                     "TF_ROCM_FUSION_DISABLE_BNA",
+                     ROCmFusionOpBatchNormActivationBackward);
+
+REGISTER_ROCM_FUSION(ROCmFusionPassType::kFusion, 35,
+                     "TF_ROCM_FUSION_DISABLE_MATMUL",
+                     ROCmFusionOpMatMulBiasAddActivation);
+
+REGISTER_ROCM_FUSION(ROCmFusionPassType::kFusion, 40,
+                     "TF_ROCM_FUSION_DISABLE_ADDRELU", ROCmFusionOpAddRelu);
+
+REGISTER_ROCM_FUSION(ROCmFusionPassType::kFusion, 50,
+                     "TF_ROCM_FUSION_DISABLE_ADDNRELUGRAD",
+                     ROCmFusionOpAddNReluGrad);
+
+// the FMA pass as a whole is disabled with TF_ROCM_FMA_DISABLE
+REGISTER_ROCM_FUSION(ROCmFusionPassType::kFMA, 0, "", ROCmFusionOpFMA);
+
+//----------------------------------------------------------------------
+
 Status ROCmFusionPass::Run(const GraphOptimizationPassOptions& options) {
   // enable the fusion pass if the env var TF_ROCM_FUSION_ENABLE is set
   if (ReadBoolFromEnvVar("TF_ROCM_FUSION_ENABLE")) {
@@ -540,10 +484,9 @@ bool ROCmFusionPassBase::RunPass(Graph* graph) {
     DumpGraph(kVlogLevel, "Before running ROCmFusionPass", &*graph);
   }
 
-  std::vector<std::unique_ptr<ROCmFusionOpBase> > fusions;
-
-  // Initialize a vector of all the fusion operations we currently support
-  InitializeFusions(fusions, graph);
+  // Initialize a vector of all the fusion operations registered for this pass
+  std::vector<std::unique_ptr<ROCmFusionOpBase> > fusions =
+      ROCmFusionRegistry::Global()->CreateFusions(type_, graph);
 
   for (auto& fusion : fusions) {
     std::vector<Node*> order;
@@ -572,33 +515,41 @@ bool ROCmFusionPassBase::RunPass(Graph* graph) {
   return true;
 }
 
-void ROCmFusionPass::InitializeFusions(
-    std::vector<std::unique_ptr<ROCmFusionOpBase> >& fusions, Graph* g) {
-  if (!ReadBoolFromEnvVar("TF_ROCM_FUSION_DISABLE_CBNA")) {
-    fusions.emplace_back(new ROCmFusionOpConvolutionBiasBatchNormActivation(g));
-  }
-
-  if (!ReadBoolFromEnvVar("TF_ROCM_FUSION_DISABLE_CBA")) {
-    fusions.emplace_back(new ROCmFusionOpConvolutionBiasActivation(g));
-  }
-
-  if (!ReadBoolFromEnvVar("TF_ROCM_FUSION_DISABLE_BNA")) {
-    fusions.emplace_back(new ROCmFusionOpBatchNormActivationInference(g));
-    fusions.emplace_back(new ROCmFusionOpBatchNormActivationBackward(g));
-  }
+//----------------------------------------------------------------------
 
-  if (!ReadBoolFromEnvVar("TF_ROCM_FUSION_DISABLE_ADDRELU")) {
-    fusions.emplace_back(new ROCmFusionOpAddRelu(g));
-  }
+// -------------------------------------------------------------
+// ROCmFusionRegistry implementation
+// -------------------------------------------------------------
+ROCmFusionRegistry* ROCmFusionRegistry::Global() {
+  static ROCmFusionRegistry* registry = new ROCmFusionRegistry;
+  return registry;
+}
 
-  if (!ReadBoolFromEnvVar("TF_ROCM_FUSION_DISABLE_ADDNRELUGRAD")) {
-    fusions.emplace_back(new ROCmFusionOpAddNReluGrad(g));
-  }
+void ROCmFusionRegistry::Register(ROCmFusionPassType pass, int priority,
+                                  const string& disable_env_var,
+                                  Factory factory) {
+  entries_.push_back({pass, priority, disable_env_var, std::move(factory)});
+  // keep the entries sorted by priority, in the order of registration for
+  // entries with the same priority
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Entry& a, const Entry& b) {
+                     return a.priority < b.priority;
+                   });
 }
 
-void ROCmFMAPass::InitializeFusions(
-    std::vector<std::unique_ptr<ROCmFusionOpBase> >& fusions, Graph* g) {
-  fusions.emplace_back(new ROCmFusionOpFMA(g));
+std::vector<std::unique_ptr<ROCmFusionOpBase> >
+ROCmFusionRegistry::CreateFusions(ROCmFusionPassType pass, Graph* g) const {
+  std::vector<std::unique_ptr<ROCmFusionOpBase> > fusions;
+  for (const Entry& entry : entries_) {
+    if (entry.pass != pass) continue;
+    if (!entry.disable_env_var.empty() &&
+        ReadBoolFromEnvVar(entry.disable_env_var.c_str())) {
+      VLOG(kVlogLevel) << "Fusion disabled by " << entry.disable_env_var;
+      continue;
+    }
+    fusions.push_back(entry.factory(g));
+  }
+  return fusions;
 }
 
 //----------------------------------------------------------------------
@@ -1568,6 +1519,167 @@ bool ROCmFusionOpAddRelu::IsFusionEligible(const Node* relu, FusionOpData* d) {
   return is_eligible;
 }
 
+// -------------------------------------------------------------
+// ROCmFusionOpMatMulBiasAddActivation implementation
+// -------------------------------------------------------------
+bool ROCmFusionOpMatMulBiasAddActivation::IsFusionEligible(const Node* n,
+                                                           FusionOpData* d) {
+  const Node* matmul = nullptr;
+  const Node* bias = nullptr;
+  const Node* add = nullptr;
+  const Node* actv = nullptr;
+  int side_input_index = -1;  // index of the add input that is not the bias
+
+  // First check whether we have the right sequence of ops, walking back from
+  // the last node of the sequence
+  const Node* node = n;
+  if (isOpActivation(node)) {  // optional activation node
+    actv = node;
+    TF_CHECK_OK(actv->input_node(0, &node));
+  }
+  if (isOpAddX(node)) {  // optional add node, preceded by a bias node
+    for (int i = 0; i < 2; i++) {
+      const Node* input = nullptr;
+      TF_CHECK_OK(node->input_node(i, &input));
+      if (isOpBias(input)) {
+        add = node;
+        bias = input;
+        side_input_index = 1 - i;
+        break;
+      }
+    }
+  } else if (isOpBias(node)) {
+    bias = node;
+  }
+  // fusing the bias alone would not save any memory traffic
+  if ((bias == nullptr) || ((add == nullptr) && (actv == nullptr))) {
+    return false;
+  }
+  TF_CHECK_OK(bias->input_node(0, &matmul));
+  if (!isOpMatMul(matmul)) {  // precedded by a matmul node
+    return false;
+  }
+
+  std::list<const Node*> nodes = {matmul, bias};
+  if (add != nullptr) nodes.push_back(add);
+  if (actv != nullptr) nodes.push_back(actv);
+  const Node* last = nodes.back();
+
+  d->op_type = (add != nullptr) ? "_ROCmFusedMatMulBiasAddActivation"
+                                : "_ROCmFusedMatMulBiasActivation";
+  d->op_name = matmul->name();
+  d->fusion_type = "MatMul+Bias";
+  for (const Node* x : nodes) {
+    if (x == matmul) continue;
+    d->op_name = strings::StrCat(d->op_name, x->name());
+    d->fusion_type = strings::StrCat(d->fusion_type, "+", x->type_string());
+  }
+  d->nodes.assign(nodes.begin(), nodes.end());
+
+  VLOG(kVlogLevel) << "===========";
+  DumpNodeList(kVlogLevel, "Found Fusion Candidate " + d->fusion_type + " : ",
+               nodes);
+
+  // ensure all the nodes are placed on the same GPU
+  if (!areAssignedToSameGpu(nodes)) {
+    return false;
+  }
+
+  // Next check that the output of every node but the last one only feeds the
+  // next node in the sequence
+  for (auto it = nodes.begin(); *it != last; ++it) {
+    const Node* src = *it;
+    const Node* dst = *std::next(it);
+    for (const Edge* e : src->out_edges()) {
+      if ((e->src_output() == 0) && (e->dst() != dst)) {
+        VLOG(kVlogLevel) << "\tSkipping Fusion : "
+                         << "Output from " << src->type_string()
+                         << " also feeds a node other then "
+                         << dst->type_string() << " : " << e->dst()->id()
+                         << ", " << e->dst()->name();
+        VLOG(kVlogLevel) << "===========";
+        return false;
+      }
+    }
+  }
+
+  const Edge* side_input_edge = nullptr;
+  if (add != nullptr) {
+    TF_CHECK_OK(add->input_edge(side_input_index, &side_input_edge));
+    if (side_input_edge->src() == bias) {  // i.e. bias + bias
+      VLOG(kVlogLevel) << "\tSkipping Fusion : "
+                       << "Add has the bias output as both of its inputs";
+      VLOG(kVlogLevel) << "===========";
+      return false;
+    }
+  }
+
+  // Next check if the datatype(s) are supported
+  DataType T_matmul;
+  TF_CHECK_OK(GetNodeAttr(matmul->def(), kAttr_T, &T_matmul));
+  if ((T_matmul != DT_FLOAT) && (T_matmul != DT_HALF)) {
+    VLOG(kVlogLevel) << "\tSkipping Fusion : "
+                     << " DataType not supported : " << DataType_Name(T_matmul);
+    VLOG(kVlogLevel) << "===========";
+    return false;
+  }
+  for (const Node* x : nodes) {
+    DataType T_x;
+    TF_CHECK_OK(GetNodeAttr(x->def(), kAttr_T, &T_x));
+    if (T_x != T_matmul) {
+      VLOG(kVlogLevel) << "\tSkipping Fusion : "
+                       << "\t DataTypes not matching : "
+                       << " " << DataType_Name(T_matmul) << " "
+                       << DataType_Name(T_x);
+      VLOG(kVlogLevel) << "===========";
+      return false;
+    }
+  }
+  d->add_attribute(kAttr_T, T_matmul);
+
+  // the bias of a 2D tensor is added to its last dimension in both the NHWC
+  // and the NCHW data formats, so the data format is not checked
+  bool transpose_a, transpose_b;
+  TF_CHECK_OK(GetNodeAttr(matmul->def(), kAttr_transpose_a, &transpose_a));
+  TF_CHECK_OK(GetNodeAttr(matmul->def(), kAttr_transpose_b, &transpose_b));
+  d->add_attribute(kAttr_transpose_a, transpose_a);
+  d->add_attribute(kAttr_transpose_b, transpose_b);
+  d->add_attribute(kAttr_activation_mode,
+                   (actv != nullptr) ? actv->type_string() : string("None"));
+
+  // populate input data edges
+  std::vector<const Edge*> matmul_input_edges;
+  TF_CHECK_OK(matmul->input_edges(&matmul_input_edges));
+  std::vector<const Edge*> bias_input_edges;
+  TF_CHECK_OK(bias->input_edges(&bias_input_edges));
+
+  d->add_data_input(0, matmul_input_edges[0]->src(),
+                    matmul_input_edges[0]->src_output());
+  d->add_data_input(1, matmul_input_edges[1]->src(),
+                    matmul_input_edges[1]->src_output());
+  d->add_data_input(2, bias_input_edges[1]->src(),
+                    bias_input_edges[1]->src_output());
+  if (side_input_edge != nullptr) {
+    d->add_data_input(3, side_input_edge->src(),
+                      side_input_edge->src_output());
+  }
+
+  // populate the input and output control edges
+  for (const Node* x : nodes) {
+    d->add_controls(x);
+  }
+
+  // populate output data edges
+  for (const Edge* e : last->out_edges()) {
+    if (!e->IsControlEdge()) {
+      CHECK_EQ(e->src_output(), 0);
+      d->add_data_output(0, e->dst(), e->dst_input());
+    }
+  }
+
+  return true;
+}
+
 bool ROCmFusionOpFMA::IsFusionEligible(const Node* node, FusionOpData* d) {
   bool add = isOpAddX(node);
   bool sub = isOpSub(node);
@@ -21,9 +21,203 @@ limitations under the License.
 #ifdef TENSORFLOW_USE_ROCM
 
 #include <sys/types.h>
+#include <functional>
+#include <map>
 #include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/graph/graph.h"
 
+namespace tensorflow {
+namespace gpu_fusion_pass {
+
+// absract base class for an individual fusion operation
+// new fusions derive from this class, and are added to one of the ROCm fusion
+// passes with REGISTER_ROCM_FUSION
+class ROCmFusionOpBase {
+ public:
+  ROCmFusionOpBase(Graph* g) : graph_(g) {}
+
+  virtual ~ROCmFusionOpBase() {}
+
+  // routine to (maybe) do fusion on the given node (+ the nodes preceding
+  // it). will return true if fusion was done, false otherwise
+  virtual bool DoFusion(const Node* n, std::set<const Node*>& fused_nodes);
+
+  using NodeIndexPair = std::pair<Node*, int>;
+
+  using NodeIndexPairVec = std::vector<NodeIndexPair>;
+
+ protected:
+  struct FusionOpData {
+    string op_type;  // fusion op type (_ROCmFused*)
+
+    string op_name;  // fusion op name ( unique name for this op instance )
+
+    string fusion_type;  // simple description, for eg: Add+Relu
+
+    std::vector<const Node*> nodes;  // all the nodes in the fusion
+
+    // map of input data connections
+    // key is input index
+    // val is vec of node-index pairs, that connect to the input index
+    std::map<int, NodeIndexPairVec> data_inputs;
+
+    // dont need node indices for control edges, so a vector suffices
+    std::vector<Node*> control_inputs;
+
+    // map of output data connections
+    // key is output index
+    // val is vec of node-index pairs, that the output index connects to
+    std::map<int, NodeIndexPairVec> data_outputs;
+
+    // dont need node indices for control edges, so a vector suffices
+    std::vector<Node*> control_outputs;
+
+    // map of atrribute name --> value
+    std::map<string, AttrValue> attributes;
+
+    // conveninece function to add a data input
+    void add_data_input(int dst_index, Node* src_node, int src_index) {
+      auto it = data_inputs.find(dst_index);
+      if (it == data_inputs.end()) {
+        NodeIndexPairVec inputs;
+        inputs.push_back(std::make_pair(src_node, src_index));
+        data_inputs[dst_index] = inputs;
+      } else {
+        it->second.push_back(std::make_pair(src_node, src_index));
+      }
+    }
+
+    // convenience function to add a data output
+    void add_data_output(int src_index, Node* dst_node, int dst_index) {
+      auto it = data_outputs.find(src_index);
+      if (it == data_outputs.end()) {
+        NodeIndexPairVec outputs;
+        outputs.push_back(std::make_pair(dst_node, dst_index));
+        data_outputs[src_index] = outputs;
+      } else {
+        it->second.push_back(std::make_pair(dst_node, dst_index));
+      }
+    }
+
+    void add_controls(const Node* node) {
+      for (const Edge* e : node->in_edges())
+        if (e->IsControlEdge() && !isConsumed(e->src()))
+          control_inputs.push_back(e->src());
+      for (const Edge* e : node->out_edges())
+        if (e->IsControlEdge() && !isConsumed(e->dst()))
+          control_outputs.push_back(e->dst());
+    }
+
+    // conveniece function to add an attribute
+    template <typename T>
+    void add_attribute(string name, T value) {
+      AttrValue attr_value;
+      SetAttrValue(value, &attr_value);
+      attributes[name] = attr_value;
+    }
+
+    bool isConsumed(const Node* p) const {
+      for (const auto x : nodes)
+        if (p == x) return true;
+      return false;
+    }
+  };
+
+  // abstract routine that must be implemented by the derived classes.
+  // this routine needs to do the following
+  // ++ determine if the node sequence *ending* at the given node is a
+  //    candidate for fusion
+  //    ++ if it is not,
+  //         return false
+  //    ++ else,
+  //         populate the FusionOpData details and return true
+  virtual bool IsFusionEligible(const Node* n, FusionOpData* d) = 0;
+
+ private:
+  void CreateFusionOp(const FusionOpData& d,
+                      std::set<const Node*>& fused_nodes);
+
+  Graph* graph_;
+};
+
+// the graph passes that run the registered fusions
+enum class ROCmFusionPassType {
+  kFusion,  // ROCmFusionPass, enabled with TF_ROCM_FUSION_ENABLE
+  kFMA,     // ROCmFMAPass, disabled with TF_ROCM_FMA_DISABLE
+};
+
+// registry of the fusions run by the ROCm fusion passes
+class ROCmFusionRegistry {
+ public:
+  using Factory = std::function<std::unique_ptr<ROCmFusionOpBase>(Graph*)>;
+
+  static ROCmFusionRegistry* Global();
+
+  // registers a fusion with the given pass. Each fusion is run over the
+  // entire graph, in increasing order of priority, so a fusion that matches a
+  // sequence of nodes needs a lower priority than the fusions that match a
+  // part of that sequence. The fusion is skipped if the env-var named
+  // disable_env_var (if non-empty) is set to 1/true
+  void Register(ROCmFusionPassType pass, int priority,
+                const string& disable_env_var, Factory factory);
+
+  // creates the fusions (that are not disabled) of the given pass for the
+  // graph, in the order in which they are to be run
+  std::vector<std::unique_ptr<ROCmFusionOpBase> > CreateFusions(
+      ROCmFusionPassType pass, Graph* g) const;
+
+ private:
+  struct Entry {
+    ROCmFusionPassType pass;
+    int priority;
+    string disable_env_var;
+    Factory factory;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+namespace registration {
+
+class ROCmFusionRegistration {
+ public:
+  ROCmFusionRegistration(ROCmFusionPassType pass, int priority,
+                         const string& disable_env_var,
+                         ROCmFusionRegistry::Factory factory) {
+    ROCmFusionRegistry::Global()->Register(pass, priority, disable_env_var,
+                                           std::move(factory));
+  }
+};
+
+}  // namespace registration
+
+}  // namespace gpu_fusion_pass
+}  // namespace tensorflow
+
+// registers the ROCmFusionOpBase subclass "fusion" (which must be
+// constructible from a Graph*) with the given pass
+#define REGISTER_ROCM_FUSION(pass, priority, disable_env_var, fusion)  \
+  REGISTER_ROCM_FUSION_UNIQ_HELPER(__COUNTER__, pass, priority,        \
+                                   disable_env_var, fusion)
+
+#define REGISTER_ROCM_FUSION_UNIQ_HELPER(ctr, pass, priority, \
+                                         disable_env_var, fusion) \
+  REGISTER_ROCM_FUSION_UNIQ(ctr, pass, priority, disable_env_var, fusion)
+
+#define REGISTER_ROCM_FUSION_UNIQ(ctr, pass, priority, disable_env_var,      \
+                                  fusion)                                    \
+  static ::tensorflow::gpu_fusion_pass::registration::ROCmFusionRegistration \
+      register_rocm_fusion_##ctr(                                            \
+          pass, priority, disable_env_var, [](::tensorflow::Graph* g) {      \
+            return std::unique_ptr<                                          \
+                ::tensorflow::gpu_fusion_pass::ROCmFusionOpBase>(            \
+                new fusion(g));                                              \
+          })
+
 #endif  // TENSORFLOW_USE_ROCM
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_FUSION_PASS_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 
 #include <algorithm>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -24,6 +25,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/function.h"
@@ -39,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -46,6 +49,8 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/public/version.h"
 
@@ -57,6 +62,10 @@ namespace {
 // can skip expensive duplicates check in 'AddControlEdge'.
 static constexpr const bool kDoNotCheckDuplicates = true;
 
+// The NodeDefs of graphs with at least this many nodes are prepared on
+// several threads before they are converted.
+static constexpr const int kMinNodesToPrepareInParallel = 4096;
+
 inline bool IsMerge(const NodeDef& node_def) {
   return node_def.op() == "Merge" || node_def.op() == "RefMerge" ||
          node_def.op() == "_XlaMerge";
@@ -229,7 +238,13 @@ class GraphConstructor {
   Status MakeNode(NodeDef&& node_def, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
-  Status ModifyNodeDefForImport(NodeDef* node_def);
+  // Looks up the op of `node_def`, adds its default attributes and validates
+  // it, as required by opts_.
+  Status PrepareNodeDef(NodeDef* node_def);
+  // Prepares the NodeDefs of large graphs on several threads, so that
+  // Convert() does not have to. The NodeDefs that fail are left to Convert(),
+  // which reports their errors in the order it converts the nodes.
+  void PrepareNodeDefsInParallel();
   // Modifies node_def's inputs according to opts_.input_map.
   // input_already_exists is a pre-initialized vector of length
   // node_def->input_size(). This function will mark inputs that are remapped to
@@ -283,6 +298,10 @@ class GraphConstructor {
   // possible. After calling this method, the result of get_node_def(i) is
   // undefined.
   virtual NodeDef consume_node_def(int i) = 0;
+  // Returns the i^th node in the graph for modification before it is
+  // consumed. The modifications are seen by later calls to get_node_def(i)
+  // and consume_node_def(i). Calls for different nodes may run concurrently.
+  virtual NodeDef* mutable_node_def(int i) = 0;
   // Returns the version information for the graph, or nullptr if none is
   // available.
   virtual const VersionDef* versions() const = 0;
@@ -326,10 +345,9 @@ class GraphConstructor {
   };
   gtl::FlatMap<StringPiece, NodeInfo, StringPieceHasher> gdef_nodes_;
 
-  // Storage for StringPiece keys in gdef_nodes_. Typically, the StringPiece key
-  // will refer to the string stored in `NodeDef::name()`. This intern table is
-  // only used when the original NodeDef's name is changed.
-  std::vector<string> string_intern_table_;
+  // True for the NodeDefs prepared by PrepareNodeDefsInParallel(). Not a
+  // vector<bool>, whose elements cannot be written from different threads.
+  std::vector<uint8> node_def_prepared_;
 
   // Prefixes already used in the GraphDef being imported.
   gtl::FlatSet<StringPiece, StringPieceHasher> gdef_prefixes_;
@@ -409,17 +427,34 @@ class NodeDefCopyingGraphConstructor : public GraphConstructor {
       : GraphConstructor(opts, g, refiner, return_tensors, return_nodes,
                          missing_unused_input_map_keys),
         node_defs_(node_defs),
+        node_def_copies_(node_defs.size()),
         versions_(versions),
         library_(library) {}
 
  private:
   size_t node_def_count() const override { return node_defs_.size(); }
-  const NodeDef& get_node_def(int i) const override { return *node_defs_[i]; }
-  NodeDef consume_node_def(int i) override { return *node_defs_[i]; }
+  const NodeDef& get_node_def(int i) const override {
+    return node_def_copies_[i] != nullptr ? *node_def_copies_[i]
+                                          : *node_defs_[i];
+  }
+  NodeDef consume_node_def(int i) override {
+    if (node_def_copies_[i] == nullptr) return *node_defs_[i];
+    NodeDef node_def = std::move(*node_def_copies_[i]);
+    node_def_copies_[i].reset();
+    return node_def;
+  }
+  NodeDef* mutable_node_def(int i) override {
+    if (node_def_copies_[i] == nullptr) {
+      node_def_copies_[i] = absl::make_unique<NodeDef>(*node_defs_[i]);
+    }
+    return node_def_copies_[i].get();
+  }
   const VersionDef* versions() const override { return versions_; }
   const FunctionDefLibrary* library() const override { return library_; }
 
   const NodeDefSlice node_defs_;
+  // The copies of the nodes modified before they are consumed.
+  std::vector<std::unique_ptr<NodeDef>> node_def_copies_;
   const VersionDef* const versions_;
   const FunctionDefLibrary* const library_;
 };
@@ -450,6 +485,11 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
     is_consumed_[i] = true;
     return std::move(*graph_def_.mutable_node(i));
   }
+  NodeDef* mutable_node_def(int i) override {
+    CHECK(!is_consumed_[i])
+        << "NodeDef " << i << " modified after it was consumed.";
+    return graph_def_.mutable_node(i);
+  }
   const VersionDef* versions() const override { return &graph_def_.versions(); }
   const FunctionDefLibrary* library() const override {
     return &graph_def_.library();
@@ -832,17 +872,41 @@ Status GraphConstructor::ValidateShape(Node* node) {
   return Status::OK();
 }
 
-Status GraphConstructor::ModifyNodeDefForImport(NodeDef* node_def) {
+Status GraphConstructor::PrepareNodeDef(NodeDef* node_def) {
   const OpDef* op_def;
   TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
-  AddDefaultsToNodeDef(*op_def, node_def);
-  TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
-  if (versions()) {
+  if (opts_.importing || opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, node_def);
+  }
+  if (opts_.importing || opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
+  }
+  if (opts_.importing && versions()) {
     TF_RETURN_IF_ERROR(CheckOpDeprecation(*op_def, versions()->producer()));
   }
   return Status::OK();
 }
 
+void GraphConstructor::PrepareNodeDefsInParallel() {
+  const int num_nodes = node_def_count();
+  const int num_threads = port::MaxParallelism();
+  if (num_nodes < kMinNodesToPrepareInParallel || num_threads <= 1) return;
+
+  // The changes that Convert() makes to the NodeDefs before preparing them
+  // (input remapping, prefixes and unique names) do not change their
+  // attributes or the number and order of their data and control inputs, so
+  // the NodeDefs can be prepared ahead of them.
+  node_def_prepared_.assign(num_nodes, 0);
+  thread::ThreadPool pool(Env::Default(), "graph_constructor", num_threads);
+  // Looking up, defaulting and validating a NodeDef takes a few microseconds.
+  const int64 kCostPerNode = 10000;
+  pool.ParallelFor(num_nodes, kCostPerNode, [this](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      node_def_prepared_[i] = PrepareNodeDef(mutable_node_def(i)).ok();
+    }
+  });
+}
+
 void RemoveInputs(const std::vector<int>& inputs_to_remove, NodeDef* node_def,
                   std::vector<bool>* input_already_exists) {
   // Remove 'inputs_to_remove' from 'node_def'
@@ -1114,6 +1178,10 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library()));
   }
 
+  // The NodeDefs may use the functions of the library, so they are prepared
+  // after it is added.
+  PrepareNodeDefsInParallel();
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1131,6 +1199,9 @@ Status GraphConstructor::Convert() {
     bool has_data_back_edge = false;
 
     NodeDef node_def = consume_node_def(o);
+    // The entry of the node in gdef_nodes_, which is looked up before
+    // node_def's name can be changed by the import options.
+    NodeInfo* node_info = &gdef_nodes_.find(node_def.name())->second;
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1139,14 +1210,7 @@ Status GraphConstructor::Convert() {
     input_already_exists.clear();
     input_already_exists.resize(node_def.input_size(), false);
 
-    ssize_t string_intern_table_index = -1;
-
     if (opts_.importing) {
-      // Intern the original node name, so that we can use a StringPiece of the
-      // name to index gdef_nodes_.
-      string_intern_table_index = string_intern_table_.size();
-      string_intern_table_.push_back(node_def.name());
-
       if (opts_.skip_mapped_nodes) {
         bool is_node_mapped = false;
         TF_RETURN_IF_ERROR(IsNodeFullyMapped(node_def, &is_node_mapped));
@@ -1229,30 +1293,12 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    if (opts_.importing) {
-      TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
-      if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
-      }
+    if (node_def_prepared_.empty() || !node_def_prepared_[o]) {
+      TF_RETURN_IF_ERROR(PrepareNodeDef(&node_def));
     }
 
     TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
-
-    if (opts_.importing) {
-      // Use interned original node name so StringPiece remains valid.
-      DCHECK_GE(string_intern_table_index, 0);
-      gdef_nodes_[string_intern_table_[string_intern_table_index]].node = node;
-    } else {
-      DCHECK_EQ(string_intern_table_index, -1);
-      gdef_nodes_[node->name()].node = node;
-    }
+    node_info->node = node;
 
     // Remove duplicate control inputs before adding edges to the graph. It
     // will allow us to skip expensive duplicates check in 'AddControlEdge'.
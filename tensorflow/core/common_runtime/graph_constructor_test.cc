@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -822,6 +823,47 @@ TEST_F(GraphConstructorTest, TypeMismatch) {
        "expected int32."});
 }
 
+// Graphs this large have their NodeDefs prepared on several threads.
+constexpr int kLargeGraphNodes = 5000;
+
+TEST_F(GraphConstructorTest, LargeGraph) {
+  GraphDef gdef;
+  for (int i = 0; i < kLargeGraphNodes; ++i) {
+    NodeDef* node = gdef.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestDefaultAttr");
+    if (i > 0) node->add_input(strings::StrCat("^n", i - 1));
+  }
+  TF_ASSERT_OK(
+      ConvertGraphDefToGraph(GraphConstructorOptions(), gdef, &graph_));
+  int num_nodes = 0;
+  for (Node* n : graph_.op_nodes()) {
+    int value = 0;
+    TF_ASSERT_OK(GetNodeAttr(n->attrs(), "default_int", &value));
+    EXPECT_EQ(31415, value);
+    ++num_nodes;
+  }
+  EXPECT_EQ(kLargeGraphNodes, num_nodes);
+  EXPECT_TRUE(HasControlEdge("n0", "n1"));
+}
+
+TEST_F(GraphConstructorTest, LargeGraphReportsFirstInvalidNode) {
+  GraphDef gdef;
+  for (int i = 0; i < kLargeGraphNodes; ++i) {
+    NodeDef* node = gdef.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestParams");
+  }
+  // Both nodes are invalid, but only the first one converted is reported.
+  gdef.mutable_node(4000)->set_op("TestMul");
+  gdef.mutable_node(4500)->set_op("DoesNotExist");
+  const string original_graph_description = GraphDebugString();
+  Status s = ConvertGraphDefToGraph(GraphConstructorOptions(), gdef, &graph_);
+  EXPECT_FALSE(s.ok());
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "n4000")) << s;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
 TEST_F(GraphConstructorTest, EmptyGraph) {
   ExpectOK("");
   ExpectVersions(0, 0);
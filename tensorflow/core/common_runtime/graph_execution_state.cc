@@ -511,14 +511,6 @@ Status GraphExecutionState::PruneGraph(
           new subgraph::ArgFeedRewrite(&feed, device_info, i));
       tensors_and_devices.push_back({ParseTensorName(feed), device_info});
     }
-    if (!options.callable_options.fetch_devices().empty() &&
-        !options.callable_options.fetch_skip_sync()) {
-      return errors::Unimplemented(
-          "CallableOptions.fetch_skip_sync = false is not yet implemented. You "
-          "can set it to true instead, but MUST ensure that Device::Sync() is "
-          "invoked on the Device corresponding to the fetched tensor before "
-          "dereferencing the Tensor's memory.");
-    }
     for (int i = 0; i < options.callable_options.fetch_size(); ++i) {
       // WARNING: fetch MUST be a reference, since RetvalFetchRewrite and
       // tensors_and_devices holds on to its address.
@@ -33,6 +33,7 @@ class Device;
 class Graph;
 class Node;
 class OpKernel;
+class StaticMemoryPlan;
 class Tensor;
 
 // Represents a single data edge in a `NodeItem`.
@@ -146,6 +147,7 @@ struct NodeItem {
 
  private:
   friend class GraphView;
+  friend class StaticMemoryPlan;
 
   NodeItem() {}
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -40,6 +41,9 @@ ImmutableExecutorState::~ImmutableExecutorState() {
       params_.delete_kernel(item->kernel);
     }
   }
+  for (DeviceContext* device_context : device_context_map_) {
+    if (device_context != nullptr) device_context->Unref();
+  }
 }
 
 namespace {
@@ -94,6 +98,35 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   }
   root_frame_info_ = frame_info_[""].get();
 
+  // Ask the device which nodes run with a context of their own, and record
+  // where the inputs of each node come from so that the device can
+  // synchronize with their producers.
+  TF_RETURN_IF_ERROR(
+      params_.device->FillContextMap(&graph, &device_context_map_));
+  if (!device_context_map_.empty()) {
+    if (static_cast<int32>(device_context_map_.size()) !=
+        gview_.num_nodes()) {
+      return errors::Internal("Device ", params_.device->name(),
+                              " assigned device contexts to ",
+                              device_context_map_.size(), " nodes, expected ",
+                              gview_.num_nodes());
+    }
+    input_device_contexts_.resize(gview_.num_nodes());
+    for (const Node* n : graph.nodes()) {
+      auto& input_contexts = input_device_contexts_[n->id()];
+      input_contexts.resize(n->num_inputs(), nullptr);
+      for (const Edge* e : n->in_edges()) {
+        if (e->src()->IsSource()) continue;
+        DeviceContext* src_context = device_context_map_[e->src()->id()];
+        if (e->IsControlEdge()) {
+          input_contexts.push_back(src_context);
+        } else {
+          input_contexts[e->dst_input()] = src_context;
+        }
+      }
+    }
+  }
+
   pending_ids_.resize(gview_.num_nodes());
 
   // Preprocess every node in the graph to create an instance of op
@@ -257,7 +290,16 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
-  return gview_.SetAllocAttrs(&graph, params_.device);
+  TF_RETURN_IF_ERROR(gview_.SetAllocAttrs(&graph, params_.device));
+
+  // Outputs produced in a loop are allocated once per iteration, and nodes
+  // running with contexts of their own may still use memory after their
+  // successors have run, so neither case gets a static memory plan.
+  if (!requires_control_flow_ && device_context_map_.empty()) {
+    TF_RETURN_IF_ERROR(
+        StaticMemoryPlan::Create(graph, &gview_, &static_memory_plan_));
+  }
+  return Status::OK();
 }
 
 namespace {
@@ -24,10 +24,13 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -101,6 +104,30 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // The offsets of the outputs planned into a static memory arena, or nullptr
+  // if the graph has none.
+  StaticMemoryPlan* static_memory_plan() const {
+    return static_memory_plan_.get();
+  }
+
+  // Returns the device context that the device assigned to `node_item` in
+  // Device::FillContextMap(), or nullptr if it runs with the default context.
+  DeviceContext* device_context(const NodeItem& node_item) const {
+    return device_context_map_.empty()
+               ? nullptr
+               : device_context_map_[node_item.node_id];
+  }
+
+  // Returns the device contexts of the producers of the inputs of
+  // `node_item`, followed by those of the sources of its control edges, or
+  // nullptr if the device did not assign any contexts.
+  const gtl::InlinedVector<DeviceContext*, 4>* input_device_contexts(
+      const NodeItem& node_item) const {
+    return input_device_contexts_.empty()
+               ? nullptr
+               : &input_device_contexts_[node_item.node_id];
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -155,6 +182,15 @@ class ImmutableExecutorState {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // The device contexts assigned by Device::FillContextMap(), indexed by node
+  // ID, and the contexts of the nodes that each node depends on.  Both are
+  // empty if the device did not assign any contexts.  Holds a reference on each
+  // non-null entry of `device_context_map_`.
+  std::vector<DeviceContext*> device_context_map_;
+  std::vector<gtl::InlinedVector<DeviceContext*, 4>> input_device_contexts_;
+
+  std::unique_ptr<StaticMemoryPlan> static_memory_plan_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ImmutableExecutorState);
 };
 
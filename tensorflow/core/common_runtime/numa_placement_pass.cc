@@ -0,0 +1,149 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/numa_placement_pass.h"
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns the representative of the component of `id`.
+int Find(std::vector<int>* parents, int id) {
+  while ((*parents)[id] != id) {
+    (*parents)[id] = (*parents)[(*parents)[id]];
+    id = (*parents)[id];
+  }
+  return id;
+}
+
+void Union(std::vector<int>* parents, int a, int b) {
+  a = Find(parents, a);
+  b = Find(parents, b);
+  if (a != b) (*parents)[std::max(a, b)] = std::min(a, b);
+}
+
+}  // namespace
+
+Status NumaPlacementPass::Run(const GraphOptimizationPassOptions& options) {
+  if (options.graph == nullptr || options.device_set == nullptr ||
+      options.session_options == nullptr || options.is_function_graph ||
+      !options.session_options->config.experimental().use_numa_affinity()) {
+    return Status::OK();
+  }
+
+  // The CPU device of every NUMA node. Sessions with other devices are left
+  // alone, since requesting CPU devices would keep ops off the accelerators.
+  std::vector<const Device*> cpu_devices;
+  std::set<int> numa_nodes;
+  for (const Device* device : options.device_set->devices()) {
+    if (device->device_type() != DEVICE_CPU) return Status::OK();
+    if (numa_nodes.insert(device->attributes().locality().numa_node())
+            .second) {
+      cpu_devices.push_back(device);
+    }
+  }
+  if (cpu_devices.size() < 2) return Status::OK();
+
+  Graph* graph = options.graph->get();
+  std::vector<int> parents(graph->num_node_ids());
+  std::iota(parents.begin(), parents.end(), 0);
+  std::unordered_map<string, int> ids_by_name;
+  for (const Node* node : graph->op_nodes()) {
+    ids_by_name[node->name()] = node->id();
+  }
+  for (const Edge* edge : graph->edges()) {
+    if (edge->src()->IsOp() && edge->dst()->IsOp()) {
+      Union(&parents, edge->src()->id(), edge->dst()->id());
+    }
+  }
+  for (const Node* node : graph->op_nodes()) {
+    std::vector<string> colocation_groups;
+    if (!TryGetNodeAttr(node->attrs(), kColocationAttrName,
+                        &colocation_groups)) {
+      continue;
+    }
+    for (const string& group : colocation_groups) {
+      absl::string_view colocated_name = group;
+      if (!absl::ConsumePrefix(&colocated_name, kColocationGroupPrefix)) {
+        continue;
+      }
+      auto it = ids_by_name.find(string(colocated_name));
+      if (it != ids_by_name.end()) Union(&parents, node->id(), it->second);
+    }
+  }
+
+  // The nodes of every component, and whether the placer is constrained.
+  struct Component {
+    std::vector<Node*> nodes;
+    bool has_requested_device = false;
+  };
+  std::unordered_map<int, Component> components;
+  for (Node* node : graph->op_nodes()) {
+    Component& component = components[Find(&parents, node->id())];
+    component.nodes.push_back(node);
+    component.has_requested_device |= !node->requested_device().empty() ||
+                                       !node->assigned_device_name().empty();
+  }
+  std::vector<Component*> free_components;
+  for (auto& component : components) {
+    if (!component.second.has_requested_device) {
+      free_components.push_back(&component.second);
+    }
+  }
+  if (free_components.size() < 2) return Status::OK();
+  std::sort(free_components.begin(), free_components.end(),
+            [](const Component* a, const Component* b) {
+              if (a->nodes.size() != b->nodes.size()) {
+                return a->nodes.size() > b->nodes.size();
+              }
+              return a->nodes[0]->id() < b->nodes[0]->id();
+            });
+
+  std::vector<int64> num_nodes_per_device(cpu_devices.size(), 0);
+  for (const Component* component : free_components) {
+    const int device = std::min_element(num_nodes_per_device.begin(),
+                                        num_nodes_per_device.end()) -
+                       num_nodes_per_device.begin();
+    num_nodes_per_device[device] += component->nodes.size();
+    for (Node* node : component->nodes) {
+      node->set_requested_device(cpu_devices[device]->name());
+    }
+  }
+  VLOG(1) << "Spread " << free_components.size()
+          << " independent subgraphs across " << cpu_devices.size()
+          << " NUMA nodes";
+  return Status::OK();
+}
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::PRE_PLACEMENT, 40,
+                      NumaPlacementPass);
+
+}  // namespace tensorflow
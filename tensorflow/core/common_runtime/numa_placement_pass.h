@@ -0,0 +1,41 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_NUMA_PLACEMENT_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_NUMA_PLACEMENT_PASS_H_
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+namespace tensorflow {
+
+// Spreads the independent subgraphs of a graph across the NUMA nodes of the
+// host, when the session runs with `use_numa_affinity` on CPU devices only.
+//
+// The pass requests a CPU device for every node of a weakly connected
+// component of the graph that has no requested device, and assigns the
+// components, largest first, to the CPU device of the least loaded NUMA node.
+// Colocated nodes are kept in the same component. Components that contain a
+// node with a requested device are left to the placer.
+//
+// Since the subgraphs do not exchange tensors, they run without any
+// cross-node traffic on the thread pools and memory of their nodes.
+class NumaPlacementPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_NUMA_PLACEMENT_PASS_H_
@@ -0,0 +1,164 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/numa_placement_pass.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::test::function::GDef;
+using ::tensorflow::test::function::NDef;
+
+class FakeDevice : public Device {
+ public:
+  explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
+  Status Sync() override { return Status::OK(); }
+  Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+};
+
+class NumaPlacementPassTest : public ::testing::Test {
+ protected:
+  void AddDevice(const string& type, const string& name, int numa_node) {
+    DeviceAttributes attr;
+    attr.set_name(name);
+    attr.set_device_type(type);
+    attr.mutable_locality()->set_numa_node(numa_node);
+    devices_.push_back(absl::make_unique<FakeDevice>(attr));
+    device_set_.AddDevice(devices_.back().get());
+  }
+
+  // Runs the pass on `graph_def` and returns the requested device of every
+  // node, by name.
+  std::map<string, string> RunPass(const GraphDef& graph_def,
+                                   bool use_numa_affinity) {
+    std::unique_ptr<Graph> graph =
+        absl::make_unique<Graph>(OpRegistry::Global());
+    TF_CHECK_OK(ConvertGraphDefToGraph(GraphConstructorOptions(), graph_def,
+                                       graph.get()));
+    SessionOptions session_options;
+    session_options.config.mutable_experimental()->set_use_numa_affinity(
+        use_numa_affinity);
+    GraphOptimizationPassOptions options;
+    options.session_options = &session_options;
+    options.device_set = &device_set_;
+    options.graph = &graph;
+    NumaPlacementPass pass;
+    TF_CHECK_OK(pass.Run(options));
+
+    std::map<string, string> devices;
+    for (const Node* node : graph->op_nodes()) {
+      devices[node->name()] = node->requested_device();
+    }
+    return devices;
+  }
+
+ private:
+  std::vector<std::unique_ptr<Device>> devices_;
+  DeviceSet device_set_;
+};
+
+constexpr char kCpu0[] = "/job:a/replica:0/task:0/device:CPU:0";
+constexpr char kCpu1[] = "/job:a/replica:0/task:0/device:CPU:1";
+
+GraphDef IndependentChains() {
+  return GDef({
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+      NDef("b", "Identity", {"a"}, {{"T", DT_FLOAT}}),
+      NDef("c", "Identity", {"b"}, {{"T", DT_FLOAT}}),
+      NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+      NDef("y", "Identity", {"x"}, {{"T", DT_FLOAT}}),
+      NDef("p", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kCpu0),
+      NDef("q", "Identity", {"p"}, {{"T", DT_FLOAT}}),
+  });
+}
+
+TEST_F(NumaPlacementPassTest, SpreadsIndependentSubgraphs) {
+  AddDevice(DEVICE_CPU, kCpu0, 0);
+  AddDevice(DEVICE_CPU, kCpu1, 1);
+  std::map<string, string> devices =
+      RunPass(IndependentChains(), /*use_numa_affinity=*/true);
+  // The largest subgraph goes first, and the pinned one is left alone.
+  EXPECT_EQ(kCpu0, devices["a"]);
+  EXPECT_EQ(kCpu0, devices["b"]);
+  EXPECT_EQ(kCpu0, devices["c"]);
+  EXPECT_EQ(kCpu1, devices["x"]);
+  EXPECT_EQ(kCpu1, devices["y"]);
+  EXPECT_EQ(kCpu0, devices["p"]);
+  EXPECT_EQ("", devices["q"]);
+}
+
+TEST_F(NumaPlacementPassTest, KeepsColocatedNodesTogether) {
+  AddDevice(DEVICE_CPU, kCpu0, 0);
+  AddDevice(DEVICE_CPU, kCpu1, 1);
+  GraphDef graph_def = GDef({
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+      NDef("b", "Identity", {"a"}, {{"T", DT_FLOAT}}),
+      NDef("x", "Placeholder", {},
+           {{"dtype", DT_FLOAT},
+            {"_class", gtl::ArraySlice<string>{"loc:@a"}}}),
+      NDef("y", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+  });
+  std::map<string, string> devices =
+      RunPass(graph_def, /*use_numa_affinity=*/true);
+  EXPECT_EQ(kCpu0, devices["a"]);
+  EXPECT_EQ(kCpu0, devices["b"]);
+  EXPECT_EQ(kCpu0, devices["x"]);
+  EXPECT_EQ(kCpu1, devices["y"]);
+}
+
+TEST_F(NumaPlacementPassTest, NoNumaAffinity) {
+  AddDevice(DEVICE_CPU, kCpu0, 0);
+  AddDevice(DEVICE_CPU, kCpu1, 1);
+  std::map<string, string> devices =
+      RunPass(IndependentChains(), /*use_numa_affinity=*/false);
+  EXPECT_EQ("", devices["a"]);
+  EXPECT_EQ("", devices["x"]);
+}
+
+TEST_F(NumaPlacementPassTest, SingleNumaNode) {
+  AddDevice(DEVICE_CPU, kCpu0, 0);
+  AddDevice(DEVICE_CPU, kCpu1, 0);
+  std::map<string, string> devices =
+      RunPass(IndependentChains(), /*use_numa_affinity=*/true);
+  EXPECT_EQ("", devices["a"]);
+  EXPECT_EQ("", devices["x"]);
+}
+
+TEST_F(NumaPlacementPassTest, SessionWithAccelerators) {
+  AddDevice(DEVICE_CPU, kCpu0, 0);
+  AddDevice(DEVICE_CPU, kCpu1, 1);
+  AddDevice(DEVICE_GPU, "/job:a/replica:0/task:0/device:GPU:0", 0);
+  std::map<string, string> devices =
+      RunPass(IndependentChains(), /*use_numa_affinity=*/true);
+  EXPECT_EQ("", devices["a"]);
+  EXPECT_EQ("", devices["x"]);
+}
+
+}  // namespace
+}  // namespace tensorflow
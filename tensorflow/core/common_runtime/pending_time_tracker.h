@@ -0,0 +1,63 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PENDING_TIME_TRACKER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_PENDING_TIME_TRACKER_H_
+
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Measures the wall time during which at least one of a set of asynchronous
+// operations, e.g. the remote tensor receives of a step, is pending.
+// Overlapping operations are only counted once, so that the pending time of
+// a step is never longer than the step.
+class PendingTimeTracker {
+ public:
+  // Records the start and the end of an operation.
+  void Start() {
+    mutex_lock l(mu_);
+    if (num_pending_++ == 0) pending_since_micros_ = EnvTime::NowMicros();
+  }
+  void Stop() {
+    mutex_lock l(mu_);
+    DCHECK_GT(num_pending_, 0);
+    if (--num_pending_ == 0) {
+      pending_micros_ += EnvTime::NowMicros() - pending_since_micros_;
+    }
+  }
+
+  // Returns the time during which at least one operation was pending, in
+  // microseconds, including the operations still pending.
+  int64 pending_micros() const {
+    tf_shared_lock l(mu_);
+    if (num_pending_ == 0) return pending_micros_;
+    return pending_micros_ + EnvTime::NowMicros() - pending_since_micros_;
+  }
+
+ private:
+  mutable mutex mu_;
+  int num_pending_ TF_GUARDED_BY(mu_) = 0;
+  uint64 pending_since_micros_ TF_GUARDED_BY(mu_) = 0;
+  int64 pending_micros_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PENDING_TIME_TRACKER_H_
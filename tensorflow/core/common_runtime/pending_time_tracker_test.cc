@@ -0,0 +1,49 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/pending_time_tracker.h"
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(PendingTimeTracker, NothingPending) {
+  PendingTimeTracker tracker;
+  EXPECT_EQ(0, tracker.pending_micros());
+}
+
+TEST(PendingTimeTracker, OverlappingOperationsAreCountedOnce) {
+  PendingTimeTracker tracker;
+  const uint64 start_micros = EnvTime::NowMicros();
+  tracker.Start();
+  tracker.Start();
+  Env::Default()->SleepForMicroseconds(10000);
+  tracker.Stop();
+  EXPECT_GE(tracker.pending_micros(), 10000);
+  Env::Default()->SleepForMicroseconds(10000);
+  tracker.Stop();
+  const int64 pending_micros = tracker.pending_micros();
+  EXPECT_GE(pending_micros, 20000);
+  EXPECT_LE(pending_micros, EnvTime::NowMicros() - start_micros);
+
+  // The pending time no longer grows once nothing is pending.
+  Env::Default()->SleepForMicroseconds(10000);
+  EXPECT_EQ(pending_micros, tracker.pending_micros());
+}
+
+}  // namespace
+}  // namespace tensorflow
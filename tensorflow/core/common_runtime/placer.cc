@@ -15,20 +15,25 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/placer.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/colocation_graph.h"
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/placer_cost_model.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/port.h"
 
 namespace tensorflow {
@@ -178,16 +183,40 @@ Status Placer::Run() {
 
   TF_RETURN_IF_ERROR(colocation_graph.Initialize());
 
+  // With cost-based placement, nodes that may run on several devices go to the
+  // one on which they are estimated to finish first, rather than to the
+  // preferred one.  The estimates need the nodes in topological order.
+  bool cost_based_placement;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_PLACER_COST_BASED_PLACEMENT",
+                                        false, &cost_based_placement));
+  std::unique_ptr<PlacerCostModel> cost_model;
+  std::vector<Node*> nodes;
+  if (cost_based_placement) {
+    cost_model = absl::make_unique<PlacerCostModel>(graph_);
+    cost_model->Initialize();
+    GetReversePostOrder(*graph_, &nodes);
+    nodes.erase(std::remove_if(nodes.begin(), nodes.end(),
+                               [](const Node* node) { return !node->IsOp(); }),
+                nodes.end());
+  } else {
+    nodes.assign(graph_->op_nodes().begin(), graph_->op_nodes().end());
+  }
+
   // For each node, assign a device based on the constraints in the disjoint
   // node set.
   std::vector<Node*> second_pass;
-  for (Node* node : graph_->op_nodes()) {
+  for (Node* node : nodes) {
     // The graph may have come pre-populated by the framework with assigned
     // devices (e.g., for stateful placements), so the placer should not try to
     // place nodes that are already placed.
     if (node->has_assigned_device_name()) {
       TF_RETURN_IF_ERROR(colocation_graph.LimitToAssignedDevice(*node));
       LogDeviceAssignment(node, log_device_placement_);
+      if (cost_model != nullptr) {
+        const Device* device =
+            devices_->FindDeviceByName(node->assigned_device_name());
+        if (device != nullptr) cost_model->RecordAssignment(node, device);
+      }
       continue;
     }
 
@@ -240,11 +269,18 @@ Status Placer::Run() {
 
     // Provide the default, if necessary.
     if (assigned_device == -1) {
-      assigned_device = graph_->InternDeviceName((*devices)[0]->name());
+      const Device* device = cost_model != nullptr
+                                 ? cost_model->SelectDevice(node, *devices)
+                                 : (*devices)[0];
+      assigned_device = graph_->InternDeviceName(device->name());
     }
 
     TF_RETURN_IF_ERROR(AssignAndLog(assigned_device, node, &colocation_graph,
                                     log_device_placement_));
+    if (cost_model != nullptr) {
+      cost_model->RecordAssignment(
+          node, devices_->FindDeviceByName(node->assigned_device_name()));
+    }
   }
 
   // Perform a second pass assignment for those nodes explicitly
@@ -45,7 +45,11 @@ namespace tensorflow {
 // is then assigned to a set of valid devices.
 //
 // Run() will finally assign the device to each node given the list of
-// possible devices.
+// possible devices.  By default, this is the first of the possible devices,
+// in priority order.  If the TF_PLACER_COST_BASED_PLACEMENT environment
+// variable is true, it is the device on which the node is estimated to finish
+// first instead (see PlacerCostModel), which spreads independent work over
+// several devices of the same type.
 //
 // TODO(mrry): "Soft" constraints, such as "place node 'x' as close as
 // possible to node 'y' while respecting the other constraints"?
@@ -0,0 +1,213 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/placer_cost_model.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Fixed cost of running any node, e.g. a kernel launch, which keeps long
+// chains of cheap nodes from being spread over devices.
+constexpr double kNodeOverheadUs = 1.0;
+
+// Copies between devices of the same process, e.g. over PCIe.
+constexpr double kLocalCopyBytesPerUs = 10000.0;
+constexpr double kLocalCopyLatencyUs = 5.0;
+
+// Copies between devices of different tasks.
+constexpr double kRemoteCopyBytesPerUs = 1000.0;
+constexpr double kRemoteCopyLatencyUs = 50.0;
+
+double CopyTime(int64 bytes, const Device* src, const Device* dst) {
+  if (src == dst) return 0;
+  if (DeviceNameUtils::IsSameAddressSpace(src->parsed_name(),
+                                          dst->parsed_name())) {
+    return kLocalCopyLatencyUs + bytes / kLocalCopyBytesPerUs;
+  }
+  return kRemoteCopyLatencyUs + bytes / kRemoteCopyBytesPerUs;
+}
+
+// Returns the memory limit of `device`, or -1 if it is not limited.  The
+// memory limit of CPU devices is not their actual capacity, so they are
+// treated as unlimited.
+int64 MemoryLimit(const Device* device) {
+  const int64 limit = device->attributes().memory_limit();
+  if (device->device_type() == DEVICE_CPU || limit <= 0) return -1;
+  return limit;
+}
+
+// Returns true if the op-level cost estimator knows the performance of
+// `device`.  Other devices, e.g. of types it does not know about, only pay
+// kNodeOverheadUs per node.
+bool CanEstimate(const DeviceProperties& device) {
+  if (device.type() == "CPU") {
+    return device.num_cores() > 0 && device.frequency() > 0;
+  }
+  if (device.type() == "GPU") {
+    return device.num_cores() > 0 && device.frequency() > 0 &&
+           device.environment().count("architecture") > 0;
+  }
+  return false;
+}
+
+}  // namespace
+
+PlacerCostModel::PlacerCostModel(const Graph* graph)
+    : graph_(graph),
+      shape_refiner_(graph->versions().producer(), graph->op_registry()),
+      node_device_(graph->num_node_ids(), nullptr),
+      node_finish_time_(graph->num_node_ids(), 0) {
+  shape_refiner_.set_require_shape_inference_fns(false);
+}
+
+void PlacerCostModel::Initialize() {
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph_, &order);
+  for (const Node* node : order) {
+    Status status = shape_refiner_.AddNode(node);
+    if (!status.ok()) {
+      VLOG(2) << "Cannot infer the shapes of " << node->name() << ": "
+              << status;
+    }
+  }
+}
+
+Device* PlacerCostModel::SelectDevice(const Node* node,
+                                      const std::vector<Device*>& devices) {
+  int64 output_bytes = 0;
+  for (int i = 0; i < node->num_outputs(); ++i) {
+    output_bytes += OutputBytes(node, i);
+  }
+
+  Device* best = nullptr;
+  double best_finish_time = std::numeric_limits<double>::infinity();
+  for (Device* device : devices) {
+    const int64 limit = MemoryLimit(device);
+    if (limit >= 0 && memory_used_[device] + output_bytes > limit) {
+      continue;
+    }
+    const double finish_time =
+        StartTime(node, device) + RunTime(node, device);
+    if (finish_time < best_finish_time) {
+      best = device;
+      best_finish_time = finish_time;
+    }
+  }
+  // If no device has enough memory left, the estimates are off anyway, so
+  // fall back to the preferred device.
+  return best != nullptr ? best : devices[0];
+}
+
+void PlacerCostModel::RecordAssignment(const Node* node,
+                                       const Device* device) {
+  const double finish_time = StartTime(node, device) + RunTime(node, device);
+  node_device_[node->id()] = device;
+  node_finish_time_[node->id()] = finish_time;
+  ready_time_[device] = finish_time;
+  for (int i = 0; i < node->num_outputs(); ++i) {
+    memory_used_[device] += OutputBytes(node, i);
+  }
+}
+
+double PlacerCostModel::StartTime(const Node* node,
+                                  const Device* device) const {
+  auto it = ready_time_.find(device);
+  double start_time = it == ready_time_.end() ? 0 : it->second;
+  for (const Edge* edge : node->in_edges()) {
+    const Node* src = edge->src();
+    const Device* src_device = node_device_[src->id()];
+    // Inputs from nodes that are not placed yet, e.g. generators that the
+    // Placer places with their consumers, or back edges of loops, are assumed
+    // to be available on `device`.
+    if (src_device == nullptr) continue;
+    double input_time = node_finish_time_[src->id()];
+    if (!edge->IsControlEdge()) {
+      input_time +=
+          CopyTime(OutputBytes(src, edge->src_output()), src_device, device);
+    }
+    start_time = std::max(start_time, input_time);
+  }
+  return start_time;
+}
+
+double PlacerCostModel::RunTime(const Node* node, const Device* device) {
+  const DeviceProperties& device_properties = GetDeviceProperties(device);
+  if (!CanEstimate(device_properties)) return kNodeOverheadUs;
+
+  grappler::OpContext op_context;
+  op_context.name = node->name();
+  op_context.device_name = device->name();
+  OpInfo& op_info = op_context.op_info;
+  op_info.set_op(node->type_string());
+  *op_info.mutable_attr() = node->def().attr();
+  *op_info.mutable_device() = device_properties;
+  for (const Edge* edge : node->in_edges()) {
+    if (edge->IsControlEdge()) continue;
+    GetOutputProperties(edge->src(), edge->src_output(),
+                        op_info.add_inputs());
+  }
+  for (int i = 0; i < node->num_outputs(); ++i) {
+    GetOutputProperties(node, i, op_info.add_outputs());
+  }
+  const grappler::Costs costs = estimator_.PredictCosts(op_context);
+  return kNodeOverheadUs +
+         std::max<double>(costs.execution_time.count(), 0) / 1000.0;
+}
+
+int64 PlacerCostModel::OutputBytes(const Node* node, int index) const {
+  OpInfo::TensorProperties properties;
+  GetOutputProperties(node, index, &properties);
+  int64 num_elements = 1;
+  for (const auto& dim : properties.shape().dim()) {
+    num_elements *= std::max<int64>(dim.size(), 1);
+  }
+  return num_elements * DataTypeSize(BaseType(properties.dtype()));
+}
+
+void PlacerCostModel::GetOutputProperties(
+    const Node* node, int index, OpInfo::TensorProperties* properties) const {
+  properties->set_dtype(BaseType(node->output_type(index)));
+  shape_inference::InferenceContext* context =
+      shape_refiner_.GetContext(node);
+  if (context == nullptr || index >= context->num_outputs()) {
+    properties->mutable_shape()->set_unknown_rank(true);
+    return;
+  }
+  context->ShapeHandleToProto(context->output(index),
+                              properties->mutable_shape());
+}
+
+const DeviceProperties& PlacerCostModel::GetDeviceProperties(
+    const Device* device) {
+  auto it = device_properties_.find(device);
+  if (it == device_properties_.end()) {
+    it = device_properties_
+             .emplace(device, grappler::GetDeviceInfo(device->parsed_name()))
+             .first;
+  }
+  return it->second;
+}
+
+}  // namespace tensorflow
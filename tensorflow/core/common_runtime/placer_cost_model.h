@@ -0,0 +1,99 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PLACER_COST_MODEL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_PLACER_COST_MODEL_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+
+// Chooses devices for the Placer by estimating when each node would finish on
+// each of its allowed devices, and picking the earliest.
+//
+// Nodes are expected in topological order.  The model simulates a list
+// schedule of the graph: a node starts once its device is done with the nodes
+// previously placed on it and its inputs have been copied from the devices of
+// their producers.  Run times are estimated by the grappler op-level cost
+// model from the inferred shapes of the graph, and copy times from the sizes
+// of the copied tensors.  Devices whose memory limit would be exceeded by the
+// outputs of the nodes placed on them are avoided.
+//
+// This spreads independent work over all the devices of the same type, and
+// keeps chains of nodes on one device unless moving them pays for the copies.
+class PlacerCostModel {
+ public:
+  // `graph` must outlive the model.
+  explicit PlacerCostModel(const Graph* graph);
+
+  // Infers the shapes of the graph.  Nodes whose shapes cannot be inferred are
+  // estimated as if their unknown dimensions were 1.
+  void Initialize();
+
+  // Returns the device of `devices` on which `node` is estimated to finish
+  // first.  Ties go to the earlier device in `devices`.
+  Device* SelectDevice(const Node* node, const std::vector<Device*>& devices);
+
+  // Records that `node` runs on `device`, which must be called for every
+  // placed node in topological order.
+  void RecordAssignment(const Node* node, const Device* device);
+
+ private:
+  // Estimated time at which `node` could start on `device`, in microseconds.
+  double StartTime(const Node* node, const Device* device) const;
+
+  // Estimated time to run `node` on `device`, in microseconds.
+  double RunTime(const Node* node, const Device* device);
+
+  // Estimated size of output `index` of `node`, in bytes.
+  int64 OutputBytes(const Node* node, int index) const;
+
+  // Fills `properties` with the inferred type and shape of output `index` of
+  // `node`.
+  void GetOutputProperties(const Node* node, int index,
+                           OpInfo::TensorProperties* properties) const;
+
+  const DeviceProperties& GetDeviceProperties(const Device* device);
+
+  const Graph* const graph_;  // Not owned.
+  ShapeRefiner shape_refiner_;
+  grappler::OpLevelCostEstimator estimator_;
+
+  absl::flat_hash_map<const Device*, DeviceProperties> device_properties_;
+  // Time at which each device is done with the nodes placed on it so far.
+  absl::flat_hash_map<const Device*, double> ready_time_;
+  // Memory taken by the outputs of the nodes placed on each device.
+  absl::flat_hash_map<const Device*, int64> memory_used_;
+
+  // Device and estimated finish time of each placed node, by node id.
+  std::vector<const Device*> node_device_;
+  std::vector<double> node_finish_time_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PlacerCostModel);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PLACER_COST_MODEL_H_
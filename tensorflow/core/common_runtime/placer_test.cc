@@ -418,6 +418,33 @@ TEST_F(PlacerTest, TestNoConstraints) {
   EXPECT_DEVICE_TYPE(g, "n2", "FakeGPU");
 }
 
+// Test that cost-based placement spreads independent chains of ops over the
+// devices, and keeps each chain on a single device.
+TEST_F(PlacerTest, TestCostBasedPlacement) {
+  Graph g(OpRegistry::Global());
+  {  // Scope for temporary variables used to construct g.
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* a = ops::SourceOp("TestCPUGPUOutput", b.opts().WithName("a"));
+    Node* a1 = ops::UnaryOp("TestRelu", a, b.opts().WithName("a1"));
+    ops::UnaryOp("TestRelu", a1, b.opts().WithName("a2"));
+    Node* b0 = ops::SourceOp("TestCPUGPUOutput", b.opts().WithName("b"));
+    Node* b1 = ops::UnaryOp("TestRelu", b0, b.opts().WithName("b1"));
+    ops::UnaryOp("TestRelu", b1, b.opts().WithName("b2"));
+    TF_EXPECT_OK(BuildGraph(b, &g));
+  }
+
+  setenv("TF_PLACER_COST_BASED_PLACEMENT", "true", 1);
+  TF_EXPECT_OK(Place(&g));
+  unsetenv("TF_PLACER_COST_BASED_PLACEMENT");
+  EXPECT_DEVICE_TYPE(g, "a1", "FakeGPU");
+  EXPECT_DEVICE_TYPE(g, "b1", "FakeGPU");
+  EXPECT_COLOCATED(g, "a", "a1");
+  EXPECT_COLOCATED(g, "a1", "a2");
+  EXPECT_COLOCATED(g, "b", "b1");
+  EXPECT_COLOCATED(g, "b1", "b2");
+  EXPECT_NOT_COLOCATED(g, "a1", "b1");
+}
+
 // Test that a graph with no constraints but using kernels that have a specified
 // device priority will successfully assign nodes to the device with higher
 // priority
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 
+#include <algorithm>
 #include <iterator>
+#include <memory>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
@@ -47,9 +49,13 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/reffed_status_callback.h"
 #if !defined(IS_MOBILE_PLATFORM)
@@ -608,8 +614,126 @@ Status ValidateMultiDeviceOptions(
   return Status::OK();
 }
 
+// Returns true if the runtimes of the process share the optimized graphs of
+// the multi-device functions they instantiate. Set the
+// TF_SHARE_OPTIMIZED_FUNCTION_GRAPHS environment variable to false to disable
+// sharing.
+bool ShareOptimizedFunctionGraphs() {
+  static const bool share = [] {
+    bool share;
+    Status status =
+        ReadBoolFromEnvVar("TF_SHARE_OPTIMIZED_FUNCTION_GRAPHS", true, &share);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      return true;
+    }
+    return share;
+  }();
+  return share;
+}
+
+// Returns the key of the optimized graph of a multi-device function. The
+// graph optimization passes and the placer only depend on the function and its
+// library, on the instantiation options and on the devices of the runtime, so
+// runtimes that agree on all of them get the same graph.
+uint64 OptimizedFunctionGraphKey(
+    const string& function_key, const FunctionLibraryDefinition& lib_def,
+    const DeviceSet& dev_set, const Device* default_device,
+    const FunctionLibraryRuntime::InstantiateOptions& options) {
+  // `function_key` holds the attributes and the options that can change the
+  // graph, including the config proto.
+  uint64 key = Fingerprint64(function_key);
+  key = FingerprintCat64(key, options.is_component_function);
+  key = FingerprintCat64(key, options.optimize_graph_fn != nullptr);
+  key = FingerprintCat64(
+      key,
+      Fingerprint64(default_device == nullptr ? "" : default_device->name()));
+
+  std::vector<string> function_names = lib_def.ListFunctionNames();
+  std::sort(function_names.begin(), function_names.end());
+  string serialized;
+  for (const string& name : function_names) {
+    key = FingerprintCat64(key, Fingerprint64(name));
+    SerializeToStringDeterministic(*lib_def.Find(name), &serialized);
+    key = FingerprintCat64(key, Fingerprint64(serialized));
+    key = FingerprintCat64(key, Fingerprint64(lib_def.FindGradient(name)));
+  }
+
+  std::vector<Device*> devices = dev_set.devices();
+  std::sort(devices.begin(), devices.end(),
+            [](const Device* a, const Device* b) {
+              return a->name() < b->name();
+            });
+  for (const Device* device : devices) {
+    // The incarnation is left out: it differs between runtimes that have the
+    // same devices, and it is only used from partitioning on.
+    const DeviceAttributes& attributes = device->attributes();
+    key = FingerprintCat64(key, Fingerprint64(attributes.name()));
+    key = FingerprintCat64(key, Fingerprint64(attributes.device_type()));
+    key = FingerprintCat64(key,
+                           Fingerprint64(attributes.physical_device_desc()));
+    key = FingerprintCat64(key, attributes.memory_limit());
+  }
+  return key;
+}
+
+// The optimized graphs of the multi-device functions instantiated in the
+// process. A graph stays in the cache while a function instantiated from it
+// holds it.
+class OptimizedFunctionGraphCache {
+ public:
+  static OptimizedFunctionGraphCache* Global() {
+    static OptimizedFunctionGraphCache* cache = new OptimizedFunctionGraphCache;
+    return cache;
+  }
+
+  std::shared_ptr<const OptimizedFunctionGraph> Lookup(uint64 key) {
+    mutex_lock l(mu_);
+    auto it = graphs_.find(key);
+    return it == graphs_.end() ? nullptr : it->second.lock();
+  }
+
+  void Insert(uint64 key,
+              const std::shared_ptr<const OptimizedFunctionGraph>& graph) {
+    mutex_lock l(mu_);
+    // Drop the graphs that are no longer held, so that they do not pile up.
+    for (auto it = graphs_.begin(); it != graphs_.end();) {
+      if (it->second.expired()) {
+        graphs_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    graphs_[key] = graph;
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<uint64, std::weak_ptr<const OptimizedFunctionGraph>>
+      graphs_ TF_GUARDED_BY(mu_);
+};
+
 }  // anonymous namespace
 
+// The graph of a multi-device function after the graph optimization passes
+// and the placer, along with the library they produced. Partitioning and the
+// steps after it bake device incarnations into the graphs, so they run in
+// each runtime.
+struct OptimizedFunctionGraph {
+  OptimizedFunctionGraph(
+      const Graph& graph, const FunctionLibraryDefinition& lib_def,
+      std::unordered_map<string, string> node_name_to_control_ret)
+      : graph(new Graph(graph.flib_def())),
+        lib_def(lib_def),
+        node_name_to_control_ret(std::move(node_name_to_control_ret)) {
+    CopyGraph(graph, this->graph.get());
+  }
+
+  std::unique_ptr<Graph> graph;
+  FunctionLibraryDefinition lib_def;
+  std::unordered_map<string, string> node_name_to_control_ret;
+};
+
 Status GetGraphAndArgRets(
     const string& function_name, AttrSlice attrs, const FunctionDef* fdef,
     const FunctionLibraryDefinition* lib_def, std::unique_ptr<Graph>* graph,
@@ -744,25 +868,6 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   // Mapping from a function body node name to the control output name.
   std::unordered_map<string, string> node_name_to_control_ret;
 
-  bool control_rets_updated = false;
-  if (should_run_optimization_passes) {
-    TF_RETURN_IF_ERROR(FunctionOptimizationPassRegistry::Global().Run(
-        *dev_set, options.config_proto, &graph, &data->lib_def_,
-        &control_ret_node_names, &control_rets_updated));
-  }
-
-  if (control_rets_updated) {
-    // Function graph pass may have resulted in different nodes/node names for
-    // control rets.
-    for (const auto& control_ret : control_ret_node_names) {
-      node_name_to_control_ret.emplace(control_ret, control_ret);
-    }
-  } else {
-    for (const auto& control_ret : fdef->control_ret()) {
-      node_name_to_control_ret.emplace(control_ret.second, control_ret.first);
-    }
-  }
-
   GraphOptimizationPassOptions optimization_options;
   // TODO(iga): Thread other relevant options from SessionOptions.
   SessionOptions session_options;
@@ -774,47 +879,98 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   optimization_options.device_set = dev_set.get();
   optimization_options.is_function_graph = true;
 
-  DumpGraph("Before running PRE_PLACEMENT passes", graph.get());
-  if (should_run_optimization_passes) {
-    TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
-        OptimizationPassRegistry::PRE_PLACEMENT, optimization_options));
-  }
+  // Another runtime of the process may already have optimized and placed this
+  // function on the same devices. Graph collectors expect to see every stage
+  // of the graph, so the optimized graph is not shared when there is one.
+  uint64 optimized_graph_key = 0;
+  std::shared_ptr<const OptimizedFunctionGraph> optimized_graph;
+  if (options.graph_collector == nullptr && ShareOptimizedFunctionGraphs()) {
+    optimized_graph_key = OptimizedFunctionGraphKey(
+        function_key, data->lib_def_, *dev_set, default_device, options);
+    optimized_graph =
+        OptimizedFunctionGraphCache::Global()->Lookup(optimized_graph_key);
+  }
+
+  if (optimized_graph != nullptr) {
+    VLOG(1) << "Reusing the optimized graph of function " << function_name;
+    graph = absl::make_unique<Graph>(optimized_graph->graph->flib_def());
+    CopyGraph(*optimized_graph->graph, graph.get());
+    data->lib_def_.Clear();
+    TF_RETURN_IF_ERROR(data->lib_def_.AddLibrary(optimized_graph->lib_def));
+    node_name_to_control_ret = optimized_graph->node_name_to_control_ret;
+  } else {
+    bool control_rets_updated = false;
+    if (should_run_optimization_passes) {
+      TF_RETURN_IF_ERROR(FunctionOptimizationPassRegistry::Global().Run(
+          *dev_set, options.config_proto, &graph, &data->lib_def_,
+          &control_ret_node_names, &control_rets_updated));
+    }
 
-  // TODO(b/124993244): Smartly merge options in nested defuns, and raise
-  // exceptions/warnings in case where nested function call options are ignored.
-  DumpGraph("Before calling Placer", graph.get());
-  Placer placer(graph.get(), function_name, optimization_options.flib_def,
-                dev_set.get(), default_device,
-                options.config_proto.allow_soft_placement(),
-                options.config_proto.log_device_placement());
-  TF_RETURN_IF_ERROR(placer.Run());
+    if (control_rets_updated) {
+      // Function graph pass may have resulted in different nodes/node names
+      // for control rets.
+      for (const auto& control_ret : control_ret_node_names) {
+        node_name_to_control_ret.emplace(control_ret, control_ret);
+      }
+    } else {
+      for (const auto& control_ret : fdef->control_ret()) {
+        node_name_to_control_ret.emplace(control_ret.second,
+                                         control_ret.first);
+      }
+    }
 
-  DumpGraph("Before running POST_PLACEMENT passes", graph.get());
-  if (should_run_optimization_passes) {
-    TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
-        OptimizationPassRegistry::POST_PLACEMENT, optimization_options));
-  }
+    DumpGraph("Before running PRE_PLACEMENT passes", graph.get());
+    if (should_run_optimization_passes) {
+      TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
+          OptimizationPassRegistry::PRE_PLACEMENT, optimization_options));
+    }
 
-  Device* cpu_device;
-  TF_RETURN_IF_ERROR(device_mgr_->LookupDevice("CPU:0", &cpu_device));
+    // TODO(b/124993244): Smartly merge options in nested defuns, and raise
+    // exceptions/warnings in case where nested function call options are
+    // ignored.
+    DumpGraph("Before calling Placer", graph.get());
+    Placer placer(graph.get(), function_name, optimization_options.flib_def,
+                  dev_set.get(), default_device,
+                  options.config_proto.allow_soft_placement(),
+                  options.config_proto.log_device_placement());
+    TF_RETURN_IF_ERROR(placer.Run());
+
+    DumpGraph("Before running POST_PLACEMENT passes", graph.get());
+    if (should_run_optimization_passes) {
+      TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
+          OptimizationPassRegistry::POST_PLACEMENT, optimization_options));
+    }
 
-  if (options.optimize_graph_fn) {
-    DumpGraph("Before running graph optimization fn", graph.get());
-    Status status = options.optimize_graph_fn(
-        std::move(ret_node_names), std::move(control_ret_node_names),
-        &data->lib_def_, *dev_set, cpu_device, &graph);
-    if (!status.ok()) {
-      LOG(WARNING) << "Ignoring multi-device function optimization failure: "
-                   << status.ToString();
+    Device* cpu_device;
+    TF_RETURN_IF_ERROR(device_mgr_->LookupDevice("CPU:0", &cpu_device));
+
+    if (options.optimize_graph_fn) {
+      DumpGraph("Before running graph optimization fn", graph.get());
+      Status status = options.optimize_graph_fn(
+          std::move(ret_node_names), std::move(control_ret_node_names),
+          &data->lib_def_, *dev_set, cpu_device, &graph);
+      if (!status.ok()) {
+        LOG(WARNING) << "Ignoring multi-device function optimization failure: "
+                     << status.ToString();
+      }
+      DumpGraph("After optimization", graph.get());
     }
-    DumpGraph("After optimization", graph.get());
-  }
 
-  DumpGraph("Before running POST_REWRITE_FOR_EXEC passes", graph.get());
-  if (should_run_optimization_passes) {
-    TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
-        OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, optimization_options));
+    DumpGraph("Before running POST_REWRITE_FOR_EXEC passes", graph.get());
+    if (should_run_optimization_passes) {
+      TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
+          OptimizationPassRegistry::POST_REWRITE_FOR_EXEC,
+          optimization_options));
+    }
+
+    if (optimized_graph_key != 0) {
+      optimized_graph = std::make_shared<const OptimizedFunctionGraph>(
+          *graph, data->lib_def_, node_name_to_control_ret);
+      OptimizedFunctionGraphCache::Global()->Insert(optimized_graph_key,
+                                                    optimized_graph);
+    }
   }
+  data->optimized_graph_ = std::move(optimized_graph);
 
   // Expand the nodes assigned to a CompositeDevice before graph partition to
   // avoid generating a subgraph on a virtual device for execution.
@@ -1086,6 +1242,21 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
     return;
   }
 
+  // Fast path for functions that were placed entirely on one local device,
+  // which is common for nested function calls. There are no other component
+  // functions to cancel or to wait for, so the call goes straight to the
+  // device's runtime without a local cancellation manager or a reference
+  // counted callback.
+  if (data->glue_.size() == 1) {
+    const string& target = data->glue_.begin()->first;
+    FunctionLibraryRuntime* flr = GetFLR(target);
+    if (flr != nullptr) {
+      RunSingleLocalComponent(opts, *data, flr, rets, std::move(done),
+                              get_component_args);
+      return;
+    }
+  }
+
   // A locally created cancellation manager, used only when the caller does not
   // provide one in argument.
   std::shared_ptr<CancellationManager> local_cm;
@@ -1179,6 +1350,60 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
   refcounted_done->Unref();
 }
 
+void ProcessFunctionLibraryRuntime::RunSingleLocalComponent(
+    const FunctionLibraryRuntime::Options& opts,
+    const MultiDeviceFunctionData& data, FunctionLibraryRuntime* flr,
+    std::vector<FunctionRet>* rets, FunctionLibraryRuntime::DoneCallback done,
+    const std::function<Status(const ComponentFunctionData& comp_data,
+                               InternalArgs* args)>& get_component_args)
+    const {
+  const ComponentFunctionData& comp_data = data.glue_.begin()->second;
+  FunctionLibraryRuntime::Handle handle = comp_data.handle;
+
+  InternalArgs comp_args;
+  Status s = get_component_args(comp_data, &comp_args);
+  if (!s.ok()) {
+    VLOG(2) << "Failed to get component function arguments: " << s;
+    done(s);
+    return;
+  }
+  rets->resize(data.num_outputs_);
+
+  FunctionLibraryRuntime::Options opts_copy = opts;
+  opts_copy.args_alloc_attrs = comp_data.arg_alloc_attrs;
+  opts_copy.rets_alloc_attrs = comp_data.ret_alloc_attrs;
+  opts_copy.remote_execution = false;
+  // When target device has private thread pool, use the target device runner
+  thread::ThreadPool* pool = flr->device()->tensorflow_device_thread_pool();
+  opts_copy.runner = (pool == nullptr) ? opts_copy.runner : flr->runner();
+
+  VLOG(1) << "Running component function on device " << flr->device()->name()
+          << " from " << data.function_name_ << " with handle " << handle;
+  VLOG(4) << "    with " << opts_copy.DebugString();
+
+  std::vector<Tensor>* comp_tensor_rets = new std::vector<Tensor>;
+  flr->Run(opts_copy, handle, GetLocalArgs(comp_args.args), comp_tensor_rets,
+           [comp_tensor_rets, rets, &comp_data, &data,
+            done = std::move(done)](const Status& status) {
+             if (!status.ok()) {
+               VLOG(2) << "Component function execution from "
+                       << data.function_name_ << " failed: " << status;
+               const string function_and_msg = strings::StrCat(
+                   errors::FormatFunctionForError(data.function_name_), " ",
+                   status.error_message());
+               delete comp_tensor_rets;
+               done(Status(status.code(), function_and_msg));
+               return;
+             }
+             for (int i = 0; i < comp_tensor_rets->size(); ++i) {
+               (*rets)[comp_data.ret_indices[i]] =
+                   std::move((*comp_tensor_rets)[i]);
+             }
+             delete comp_tensor_rets;
+             done(status);
+           });
+}
+
 Status ProcessFunctionLibraryRuntime::Instantiate(
     const string& function_name, AttrSlice attrs,
     const FunctionLibraryRuntime::InstantiateOptions& options,
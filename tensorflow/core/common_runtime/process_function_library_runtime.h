@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 
+#include <memory>
 #include <unordered_map>
 
 // clang-format off
@@ -37,6 +38,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+struct OptimizedFunctionGraph;
+
 class FunctionArgsInterface {
  public:
   virtual ~FunctionArgsInterface() {}
@@ -291,6 +294,11 @@ class ProcessFunctionLibraryRuntime {
     // Maps the device name to the information about the component function
     // be run on this device.
     std::unordered_map<string, ComponentFunctionData> glue_;
+
+    // The optimized function graph this function was partitioned from, which
+    // may be shared with the other runtimes of the process. Holding it keeps
+    // it cached for later instantiations.
+    std::shared_ptr<const OptimizedFunctionGraph> optimized_graph_;
   };
 
   struct CleanUpItem {
@@ -313,6 +321,17 @@ class ProcessFunctionLibraryRuntime {
                            InternalArgs* args)>
           get_component_args) const;
 
+  // Runs the multi-device function `data` whose only component function is
+  // local to `flr`.
+  void RunSingleLocalComponent(
+      const FunctionLibraryRuntime::Options& opts,
+      const MultiDeviceFunctionData& data, FunctionLibraryRuntime* flr,
+      std::vector<FunctionRet>* rets,
+      FunctionLibraryRuntime::DoneCallback done,
+      const std::function<Status(const ComponentFunctionData& comp_data,
+                                 InternalArgs* args)>& get_component_args)
+      const;
+
   Status CreateRendezvous(const FunctionLibraryRuntime::Options& opts,
                           Rendezvous** created_rendezvous) const;
 
@@ -1125,6 +1125,28 @@ x: int64
 y: string
 )doc");
 
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_SharedOptimizedGraph) {
+  // Instantiate the function in a first runtime and keep it alive, so that a
+  // second runtime with the same devices reuses its optimized graph.
+  Init({test::function::XTimesTwo()});
+  const auto inst_opts = MakeOptions("CPU:0", {"CPU:0"}, {"CPU:1"});
+  FunctionLibraryRuntime::Handle first_handle;
+  TF_CHECK_OK(
+      Instantiate("XTimesTwo", {{"T", DT_FLOAT}}, inst_opts, &first_handle));
+  std::unique_ptr<FunctionLibraryDefinition> first_lib_def =
+      std::move(lib_def_);
+  std::unique_ptr<TestClusterFLR> first_cluster_flr = std::move(cluster_flr_);
+  std::unique_ptr<ProcessFunctionLibraryRuntime> first_proc_flr =
+      std::move(proc_flr_);
+
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::Options opts;
+  Tensor y;
+  TF_CHECK_OK(Run("XTimesTwo", opts, {{"T", DT_FLOAT}}, inst_opts,
+                  {test::AsTensor<float>({1, 2, 3})}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6}));
+}
+
 class SessionMetadataReaderOp : public OpKernel {
  public:
   explicit SessionMetadataReaderOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
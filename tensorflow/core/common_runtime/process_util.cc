@@ -22,10 +22,16 @@ limitations under the License.
 #endif  // INTEL_MKL
 #include <string.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
@@ -163,6 +169,34 @@ thread::ThreadPool* NewThreadPoolFromSessionOptions(
       /*allocator=*/nullptr);
 }
 
+thread::ThreadPool* NumaComputePool(const SessionOptions& options,
+                                    int numa_node) {
+  static mutex* mu = new mutex;
+  static std::vector<thread::ThreadPool*>* pools =
+      new std::vector<thread::ThreadPool*>;
+  mutex_lock l(*mu);
+  if (numa_node < 0) numa_node = 0;
+  if (pools->size() <= static_cast<size_t>(numa_node)) {
+    pools->resize(numa_node + 1, nullptr);
+  }
+  thread::ThreadPool*& pool = (*pools)[numa_node];
+  if (pool == nullptr) {
+    const int32 num_threads =
+        std::max(1, NumInterOpThreadsFromSessionOptions(options) /
+                        std::max(1, port::NUMANumNodes()));
+    VLOG(1) << "NUMA node " << numa_node
+            << " inter op parallelism threads: " << num_threads;
+    ThreadOptions thread_opts;
+    thread_opts.numa_node = numa_node;
+    pool = new thread::ThreadPool(
+        Env::Default(), thread_opts,
+        strings::StrCat("numa_", numa_node, "_Compute"), num_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+  }
+  return pool;
+}
+
 void SchedClosure(std::function<void()> closure) {
   if (!tracing::EventCollector::IsEnabled()) {
     return Env::Default()->SchedClosure(std::move(closure));
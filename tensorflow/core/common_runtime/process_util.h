@@ -48,6 +48,13 @@ int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options);
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
     const SessionOptions& options);
 
+// Returns a process-wide ThreadPool for scheduling the ops of the CPU devices
+// bound to `numa_node`, whose threads are pinned to that node.  The inter op
+// threads of `options` are split evenly between the NUMA nodes.  Caller does
+// not take ownership over threadpool.
+thread::ThreadPool* NumaComputePool(const SessionOptions& options,
+                                    int numa_node);
+
 // Schedule "closure" in the default thread queue.
 void SchedClosure(std::function<void()> closure);
 
@@ -141,8 +141,11 @@ void PropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
       if (input_iter->iter_num == input_frame->iteration_count &&
           input_frame->num_outstanding_iterations ==
               input_frame->max_parallel_iterations) {
-        // Reached the maximum for parallel iterations.
-        input_frame->next_iter_roots.push_back({item, (*outputs)[0]});
+        // Reached the maximum for parallel iterations. The value is moved so
+        // that the deferred iteration holds the only reference to it, which
+        // lets ops such as TensorListSetItem update it in place.
+        input_frame->next_iter_roots.push_back(
+            {item, std::move((*outputs)[0])});
         output_frame = nullptr;
       } else {
         // If this is a new iteration, start it.
@@ -600,9 +603,10 @@ void PropagatorState::FrameState::ActivateNexts(IterationState* iter_state,
   // Propagate the deferred NextIteration nodes to the new iteration.
   for (auto& node_entry : next_iter_roots) {
     const NodeItem* item = node_entry.first;
-    const Entry& entry = node_entry.second;
+    Entry& entry = node_entry.second;
     const bool is_dead = entry.state == Entry::State::NO_VALUE;
-    EntryVector outputs{entry};
+    EntryVector outputs;
+    outputs.push_back(std::move(entry));
     activated +=
         ActivateNodesLocked(item, is_dead, iter_state, &outputs, ready);
   }
@@ -750,6 +754,17 @@ bool PropagatorState::FrameState::AdjustOutstandingOps(
   if (delta == 0) {
     return false;
   }
+  // An adjustment that leaves ops outstanding cannot complete the iteration,
+  // and the iteration is not deleted while it has outstanding ops, so it is
+  // applied without acquiring the lock. Only the adjustment that may bring the
+  // count to zero has to check (under the lock) whether the iteration is done.
+  size_t cur_val = iter_state->outstanding_ops.load(std::memory_order_relaxed);
+  while (cur_val + delta != 0) {
+    if (iter_state->outstanding_ops.compare_exchange_weak(cur_val,
+                                                          cur_val + delta)) {
+      return false;
+    }
+  }
   {
     tf_shared_lock sl(mu);
     if (TF_PREDICT_TRUE(!AdjustOutstandingOpsFastPath(iter_state, delta))) {
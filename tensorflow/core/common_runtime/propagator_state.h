@@ -79,6 +79,9 @@ class PropagatorState {
     int64 get_iter_num() const;
   };
 
+  // TODO(b/152925936): Re-evaluate this constant with current usage patterns.
+  typedef gtl::InlinedVector<TaggedNode, 8> TaggedNodeSeq;
+
   // A drop-in replacement for std::deque<TaggedNode>.  We typically don't
   // have that many nodes in the ready queue, so we just use a vector and
   // don't free up memory from the queue as we consume nodes.
@@ -106,6 +109,20 @@ class PropagatorState {
       }
     }
     bool empty() const { return ready_.empty(); }
+    size_t size() const { return ready_.size() - front_index_; }
+
+    // Moves the last `n` nodes of the queue to the end of `*nodes`.
+    //
+    // REQUIRES: `n <= size()`.
+    void pop_back_n(size_t n, TaggedNodeSeq* nodes) {
+      DCHECK_LE(n, size());
+      nodes->insert(nodes->end(), ready_.end() - n, ready_.end());
+      ready_.erase(ready_.end() - n, ready_.end());
+      if (front_index_ == ready_.size()) {
+        ready_.clear();
+        front_index_ = 0;
+      }
+    }
 
    private:
     // TODO(b/152925936): Re-evaluate these constants with current usage
@@ -115,9 +132,6 @@ class PropagatorState {
     int front_index_;
   };
 
-  // TODO(b/152925936): Re-evaluate this constant with current usage patterns.
-  typedef gtl::InlinedVector<TaggedNode, 8> TaggedNodeSeq;
-
  private:
   // The state of an iteration in a particular frame.
   struct IterationState {
@@ -302,7 +316,8 @@ class PropagatorState {
     // the frame if no more ops are oustanding. Return true iff the execution of
     // the frame is done.
     //
-    // Avoids acquiring the lock in the common case that the frame is not done.
+    // Avoids acquiring the lock in the common case that the adjustment leaves
+    // ops outstanding in the iteration.
     bool AdjustOutstandingOps(IterationState* iter_state, int delta,
                               TaggedNodeSeq* ready);
 
@@ -0,0 +1,221 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/recursive_doubling_reducer.h"
+
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+RecursiveDoublingReducer::RecursiveDoublingReducer()
+    : col_ctx_(nullptr), col_params_(nullptr) {}
+
+Status RecursiveDoublingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  const int group_size = col_params->group.group_size;
+  if (col_params->instance.type != REDUCTION_COLLECTIVE ||
+      group_size <= 0 || (group_size & (group_size - 1)) != 0) {
+    return errors::InvalidArgument(
+        "RecursiveDoublingReduce needs a reduction over a group whose size is "
+        "a power of two, got group size ",
+        group_size);
+  }
+  return Status::OK();
+}
+
+Status RecursiveDoublingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void RecursiveDoublingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this doesn't require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  OpKernelContext* op_ctx = col_ctx_->op_ctx;
+  Status status;
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        op_ctx->op_device_context(), op_ctx->op_device_context(),
+        col_ctx_->device, col_ctx_->device, op_ctx->input_alloc_attr(0),
+        op_ctx->output_alloc_attr(0), col_ctx_->input, col_ctx_->output,
+        0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+  }
+
+  Tensor peer_value(
+      col_ctx_->device->GetAllocator(op_ctx->output_alloc_attr(0)),
+      col_ctx_->output->dtype(), col_ctx_->output->shape());
+  const DeviceBase::GpuDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_gpu_device_info();
+  if (status.ok() && gpu_info) {
+    // As in `RingReducer`, the newly allocated buffer is not guaranteed to be
+    // valid for a peer to write until the queued events on the compute stream
+    // complete.
+    Notification note;
+    status = gpu_info->default_context->ThenExecute(
+        col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+    if (status.ok()) {
+      note.WaitForNotification();
+    }
+  }
+
+  const int group_size = col_params_->group.group_size;
+  const int rank = col_params_->default_rank;
+  for (int step = 0; status.ok() && (1 << step) < group_size; ++step) {
+    profiler::TraceMe activity(
+        [step] { return strings::StrCat("RecursiveDoublingStep:", step); },
+        profiler::TraceMeLevel::kInfo);
+    status = Exchange(step, rank ^ (1 << step), &peer_value);
+    if (status.ok()) {
+      status = collective_util::ComputeBinOp(
+          op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, col_ctx_->output, &peer_value);
+    }
+  }
+
+  if (status.ok() && col_params_->final_op) {
+    Tensor group_size_tensor;
+    status = MakeGroupSizeTensor(&group_size_tensor);
+    if (status.ok()) {
+      status = collective_util::ComputeBinOp(
+          op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->final_op, col_ctx_->output, &group_size_tensor);
+    }
+  }
+
+  if (!status.ok()) {
+    StartAbort(status);
+  }
+  done(status);
+}
+
+Status RecursiveDoublingReducer::Exchange(int step, int peer_rank,
+                                          Tensor* peer_value) {
+  const int rank = col_params_->default_rank;
+  const string send_buf_key =
+      strings::StrCat("RecursiveDoublingReduce:", col_ctx_->exec_key, ":",
+                      step, ":", rank);
+  const string recv_buf_key =
+      strings::StrCat("RecursiveDoublingReduce:", col_ctx_->exec_key, ":",
+                      step, ":", peer_rank);
+  VLOG(3) << "Exchange rank=" << rank << " peer_rank=" << peer_rank
+          << " step=" << step;
+  OpKernelContext* op_ctx = col_ctx_->op_ctx;
+  mutex mu;
+  Status status;
+  Notification send_note;
+  Notification recv_note;
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      col_params_->group.device_names[peer_rank],
+      col_params_->group.task_names[peer_rank], send_buf_key, col_ctx_->device,
+      op_ctx->op_device_context(), op_ctx->output_alloc_attr(0),
+      col_ctx_->output, col_ctx_->device_locality,
+      op_ctx->cancellation_manager(),
+      [&mu, &status, &send_note](const Status& s) {
+        {
+          mutex_lock l(mu);
+          status.Update(s);
+        }
+        send_note.Notify();
+      });
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      col_params_->group.device_names[peer_rank],
+      col_params_->group.task_names[peer_rank],
+      col_params_->task.is_local[peer_rank], recv_buf_key, col_ctx_->device,
+      op_ctx->op_device_context(), op_ctx->output_alloc_attr(0), peer_value,
+      col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+      op_ctx->cancellation_manager(),
+      [&mu, &status, &recv_note](const Status& s) {
+        {
+          mutex_lock l(mu);
+          status.Update(s);
+        }
+        recv_note.Notify();
+      });
+  // The output is merged in place once the peer has consumed it.
+  send_note.WaitForNotification();
+  recv_note.WaitForNotification();
+  mutex_lock l(mu);
+  return status;
+}
+
+Status RecursiveDoublingReducer::MakeGroupSizeTensor(
+    Tensor* group_size_tensor) {
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      col_ctx_->output, /*num_chunks=*/1,
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0))));
+  Tensor group_size_val = ca->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type == "CPU") {
+    *group_size_tensor = group_size_val;
+    return Status::OK();
+  }
+  *group_size_tensor = ca->Scalar(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      AllocationAttributes());
+  Notification note;
+  Status status;
+  col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, col_ctx_->device, group_size_tensor,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+void RecursiveDoublingReducer::StartAbort(const Status& s) {
+  LOG(ERROR) << "Aborting RecursiveDoublingReduce with " << s;
+  CancellationManager* cm = col_ctx_->op_ctx->cancellation_manager();
+  if (cm == nullptr || (!cm->IsCancelled() && !cm->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(RecursiveDoublingReduce, RecursiveDoublingReducer);
+}  // namespace
+
+}  // namespace tensorflow
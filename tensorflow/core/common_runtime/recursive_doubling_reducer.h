@@ -0,0 +1,73 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_DOUBLING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_DOUBLING_REDUCER_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+class Device;
+
+// Recursive-doubling implementation of collective all-reduce, for groups
+// whose size is a power of two.
+//
+// In step k every device exchanges its partial reduction with the device
+// whose rank differs in bit k, and merges the two. After log2(group_size)
+// steps every device holds the full reduction. Each step sends the whole
+// tensor, where each of the 2 * (group_size - 1) steps of RingReducer sends
+// 1 / group_size of it, so this is faster for tensors small enough that the
+// latency of a step dominates.
+class RecursiveDoublingReducer : public CollectiveImplementationInterface {
+ public:
+  RecursiveDoublingReducer();
+  ~RecursiveDoublingReducer() override = default;
+
+  // Begins execution of the all-reduce. Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+  // Checks that the group size is a power of two.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+ private:
+  // Sends the output to the device of rank `peer_rank` and receives its
+  // partial reduction into `peer_value`, for step `step`.
+  Status Exchange(int step, int peer_rank, Tensor* peer_value);
+
+  // Sets `*group_size_tensor` to a scalar holding the group size, on the
+  // device of the output.
+  Status MakeGroupSizeTensor(Tensor* group_size_tensor);
+
+  // Aborts the collective executor, unless the op is being cancelled.
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_DOUBLING_REDUCER_H_
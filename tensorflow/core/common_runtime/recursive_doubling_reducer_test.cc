@@ -0,0 +1,299 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/recursive_doubling_reducer.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/unbounded_work_queue.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+static int64 kStepId = 123;
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class RecursiveDoublingReducerTest : public ::testing::Test {
+ protected:
+  ~RecursiveDoublingReducerTest() override {
+    if (col_exec_) col_exec_->Unref();
+  }
+
+  void Init(int num_workers, int num_devices, DataType dtype) {
+    std::vector<std::unique_ptr<Device>> local_devices;
+    SessionOptions sess_opts;
+    sess_opts.env = Env::Default();
+    Bytes mem_limit(4 << 20);
+    DeviceLocality dev_locality;
+    col_params_.group.group_key = 5;
+    col_params_.group.device_type = DEVICE_CPU;
+    col_params_.group.group_size = num_workers * num_devices;
+    col_params_.group.num_tasks = num_workers;
+    col_params_.instance.instance_key = 17;
+    col_params_.instance.type = REDUCTION_COLLECTIVE;
+    col_params_.instance.impl_details.collective_name =
+        "RecursiveDoublingReduce";
+    col_params_.instance.data_type = dtype;
+    for (int wi = 0; wi < num_workers; ++wi) {
+      string task_name = strings::StrCat("/job:worker/replica:0/task:", wi);
+      col_params_.group.num_devices_per_task[task_name] = num_devices;
+      for (int di = 0; di < num_devices; ++di) {
+        string dev_name = strings::StrCat(task_name, "/cpu:", di);
+        local_devices.push_back(absl::make_unique<ThreadPoolDevice>(
+            sess_opts, dev_name, mem_limit, dev_locality, cpu_allocator()));
+        col_params_.group.device_names.push_back(dev_name);
+        col_params_.group.task_names.push_back(task_name);
+        // This test runs in a single process so is_local is always true.
+        col_params_.task.is_local.push_back(true);
+      }
+    }
+    dev_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(local_devices));
+    dev_resolver_ = absl::make_unique<DeviceResolverLocal>(dev_mgr_.get());
+    work_queue_ = std::make_shared<UnboundedWorkQueue>(Env::Default(), "test");
+    rma_ = new CollectiveRemoteAccessLocal(dev_mgr_.get(), dev_resolver_.get(),
+                                           kStepId);
+    col_exec_ = new BaseCollectiveExecutor(&col_exec_mgr_, rma_, kStepId,
+                                           dev_mgr_.get(), &gpu_ring_order_,
+                                           work_queue_);
+  }
+
+  // Reduces, with Add and Div, tensors of `tensor_len` elements where
+  // element i of the tensor of rank r is r * 10 + i.
+  template <typename T>
+  void RunTest(DataType dtype, int num_workers, int num_devices,
+               int tensor_len) {
+    Init(num_workers, num_devices, dtype);
+    const int group_size = num_workers * num_devices;
+    col_params_.instance.shape = TensorShape({tensor_len});
+    std::vector<Tensor> tensors(group_size);
+    std::vector<Status> statuses(group_size);
+    std::vector<T> expected(tensor_len, 0);
+    for (int rank = 0; rank < group_size; ++rank) {
+      tensors[rank] = Tensor(dtype, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        tensors[rank].flat<T>()(i) = static_cast<T>(rank * 10 + i);
+        expected[i] += static_cast<T>(rank * 10 + i);
+      }
+    }
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<T>(group_size);
+    }
+
+    BlockingCounter counter(group_size);
+    for (int rank = 0; rank < group_size; ++rank) {
+      SchedClosure([this, rank, &tensors, &statuses, &counter] {
+        statuses[rank] = DoReduce(rank, &tensors[rank]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+
+    for (int rank = 0; rank < group_size; ++rank) {
+      TF_EXPECT_OK(statuses[rank]);
+      for (int i = 0; i < tensor_len; ++i) {
+        EXPECT_EQ(expected[i], tensors[rank].flat<T>()(i))
+            << "Mismatch at rank " << rank << " index " << i;
+      }
+    }
+  }
+
+  Status DoReduce(int rank, Tensor* tensor) {
+    Device* device = nullptr;
+    TF_CHECK_OK(
+        dev_mgr_->LookupDevice(col_params_.group.device_names[rank], &device));
+    CollectiveParams col_params;
+    col_params.name = "test_collective";
+    col_params.group = col_params_.group;
+    col_params.instance = col_params_.instance;
+    col_params.task.is_local = col_params_.task.is_local;
+    col_params.default_rank = rank;
+    std::unique_ptr<OpKernel> merge_op =
+        GetKernel("Add", col_params.instance.data_type, device);
+    std::unique_ptr<OpKernel> final_op =
+        GetKernel("Div", col_params.instance.data_type, device);
+    col_params.merge_op = merge_op.get();
+    col_params.final_op = final_op.get();
+
+    // Prepare an OpKernelContext.
+    OpKernelContext::Params op_params;
+    op_params.step_id = kStepId;
+    op_params.device = device;
+    op_params.cancellation_manager = &cancellation_manager_;
+    gtl::InlinedVector<TensorValue, 4> inputs;
+    inputs.push_back(TensorValue(tensor));
+    op_params.inputs = &inputs;
+    gtl::InlinedVector<AllocatorAttributes, 4> input_aa(
+        {AllocatorAttributes()});
+    op_params.input_alloc_attrs = &input_aa;
+    DeviceContext* dev_ctx = new DeviceContext;
+    core::ScopedUnref unref_dev_ctx(dev_ctx);
+    op_params.op_device_context = dev_ctx;
+    int forward_from = 0;
+    op_params.forward_from_array = &forward_from;
+    AllocatorAttributes generic_alloc_attr;
+    op_params.output_attr_array = &generic_alloc_attr;
+    std::unique_ptr<OpKernel> op = GetCollectiveReduce(col_params, device);
+    op_params.op_kernel = op.get();
+    OpKernelContext ctx(&op_params, 1);
+
+    // We never actually execute the kernel, so we need to do the output
+    // allocation it would do, ourselves.
+    Tensor* output_tensor_ptr = nullptr;
+    TF_CHECK_OK(ctx.forward_input_or_allocate_output({0}, 0, tensor->shape(),
+                                                     &output_tensor_ptr));
+
+    string exec_key = strings::StrCat(col_params.instance.instance_key, ":0:0");
+    RecursiveDoublingReducer* reducer = new RecursiveDoublingReducer;
+    core::ScopedUnref unref(reducer);
+    TF_RETURN_IF_ERROR(reducer->InitializeCollectiveParams(&col_params));
+    auto col_ctx = std::make_shared<CollectiveContext>(
+        col_exec_, /*nccl_communicator*/ nullptr, dev_mgr_.get(), &ctx,
+        &op_params, col_params, exec_key, kStepId, tensor, tensor);
+    TF_RETURN_IF_ERROR(reducer->InitializeCollectiveContext(col_ctx));
+    Status status;
+    reducer->Run([&status](const Status& s) { status = s; });
+    return status;
+  }
+
+  std::unique_ptr<OpKernel> GetCollectiveReduce(const CollectiveParams& params,
+                                                DeviceBase* device) {
+    mutex_lock l(mu_);
+    NodeDef node_def;
+    TF_CHECK_OK(
+        NodeDefBuilder(strings::StrCat("collective_reduce_", reduce_counter_++),
+                       "CollectiveReduce")
+            .Attr("T", params.instance.data_type)
+            .Attr("merge_op", "Add")
+            .Attr("final_op", "Div")
+            .Attr("group_size", params.group.group_size)
+            .Attr("group_key", params.group.group_key)
+            .Attr("instance_key", params.instance.instance_key)
+            .Attr("subdiv_offsets", std::vector<int>())
+            .Input(FakeInput(params.instance.data_type))
+            .Finalize(&node_def));
+    Status status;
+    std::unique_ptr<OpKernel> k = CreateOpKernel(
+        DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+        node_def, TF_GRAPH_DEF_VERSION, &status);
+    TF_CHECK_OK(status);
+    return k;
+  }
+
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  CollectiveExecutor* col_exec_ = nullptr;
+  CollectiveRemoteAccessLocal* rma_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  std::shared_ptr<UnboundedWorkQueue> work_queue_;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  string gpu_ring_order_;
+  CollectiveParams col_params_;
+  CancellationManager cancellation_manager_;
+  mutex mu_;
+  int32 reduce_counter_ TF_GUARDED_BY(mu_) = 0;
+};
+
+TEST_F(RecursiveDoublingReducerTest, TwoDevices) {
+  RunTest<float>(DT_FLOAT, 1, 2, 1001);
+}
+
+TEST_F(RecursiveDoublingReducerTest, EightDevicesOnTwoWorkers) {
+  RunTest<float>(DT_FLOAT, 2, 4, 1001);
+}
+
+TEST_F(RecursiveDoublingReducerTest, Int64) {
+  RunTest<int64>(DT_INT64, 1, 4, 16);
+}
+
+TEST_F(RecursiveDoublingReducerTest, RejectsGroupSizeNotPowerOfTwo) {
+  CollectiveParams cp;
+  cp.instance.type = REDUCTION_COLLECTIVE;
+  cp.group.group_size = 6;
+  RecursiveDoublingReducer* reducer = new RecursiveDoublingReducer;
+  core::ScopedUnref unref(reducer);
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(reducer->InitializeCollectiveParams(&cp)));
+}
+
+CollectiveParams ReductionParams(int group_size, int num_tasks,
+                                 int64 num_elements) {
+  CollectiveParams cp;
+  cp.group.group_size = group_size;
+  cp.group.num_tasks = num_tasks;
+  cp.instance.type = REDUCTION_COLLECTIVE;
+  cp.instance.data_type = DT_FLOAT;
+  cp.instance.shape = TensorShape({num_elements});
+  return cp;
+}
+
+TEST(SelectReductionImplementationTest, SmallTensorsUseRecursiveDoubling) {
+  EXPECT_EQ("RecursiveDoublingReduce",
+            collective_util::SelectReductionImplementation(
+                ReductionParams(8, 2, 16)));
+  EXPECT_EQ("RecursiveDoublingReduce",
+            collective_util::SelectReductionImplementation(
+                ReductionParams(8, 1, 16)));
+}
+
+TEST(SelectReductionImplementationTest, LargeTensorsUseRing) {
+  EXPECT_EQ("RingReduce", collective_util::SelectReductionImplementation(
+                              ReductionParams(8, 2, 64 << 20)));
+}
+
+TEST(SelectReductionImplementationTest, GroupSizeNotPowerOfTwoUsesRing) {
+  EXPECT_EQ("RingReduce", collective_util::SelectReductionImplementation(
+                              ReductionParams(6, 2, 16)));
+}
+
+TEST(SelectReductionImplementationTest, RingHint) {
+  CollectiveParams cp = ReductionParams(8, 2, 16);
+  cp.instance.impl_details.communication_hint = "ring";
+  EXPECT_EQ("RingReduce", collective_util::SelectReductionImplementation(cp));
+}
+
+}  // namespace
+}  // namespace tensorflow
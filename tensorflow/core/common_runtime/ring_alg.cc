@@ -72,6 +72,29 @@ string RingAlgBufKey(const string& name, const string& exec_key, int pass,
   }
 }
 
+// Casts `src` into `dst`, which must have the same number of elements.  Only
+// the casts between float and the 16-bit wire types are supported.
+Status CastChunk(const Tensor& src, Tensor* dst) {
+  DCHECK_EQ(src.NumElements(), dst->NumElements());
+  if (src.dtype() == DT_FLOAT && dst->dtype() == DT_HALF) {
+    dst->unaligned_flat<Eigen::half>() =
+        src.unaligned_flat<float>().cast<Eigen::half>();
+  } else if (src.dtype() == DT_HALF && dst->dtype() == DT_FLOAT) {
+    dst->unaligned_flat<float>() =
+        src.unaligned_flat<Eigen::half>().cast<float>();
+  } else if (src.dtype() == DT_FLOAT && dst->dtype() == DT_BFLOAT16) {
+    dst->unaligned_flat<bfloat16>() =
+        src.unaligned_flat<float>().cast<bfloat16>();
+  } else if (src.dtype() == DT_BFLOAT16 && dst->dtype() == DT_FLOAT) {
+    dst->unaligned_flat<float>() = src.unaligned_flat<bfloat16>().cast<float>();
+  } else {
+    return errors::Internal("Unsupported chunk cast from ",
+                            DataTypeString(src.dtype()), " to ",
+                            DataTypeString(dst->dtype()));
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 void RingAlg::PCQueue::Enqueue(RingField* rf) {
@@ -103,7 +126,8 @@ RingAlg::RingAlg(CollectiveType type, const string& name)
       col_params_(nullptr),
       done_(nullptr),
       group_size_(-1),
-      num_subdivs_(-1) {}
+      num_subdivs_(-1),
+      wire_dtype_(DT_INVALID) {}
 
 namespace {
 Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
@@ -389,11 +413,23 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  Tensor* src_tensor = &rf->chunk;
+  if (rf->wire_chunk.IsInitialized()) {
+    Status s = CastChunk(rf->chunk, &rf->wire_chunk);
+    // In the second pass the chunk holds its final value.  Round it the way
+    // the receivers will, so that every rank ends with the same output.
+    if (s.ok() && rf->second_pass) s = CastChunk(rf->wire_chunk, &rf->chunk);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    src_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.device_names[send_to_dev_idx],
       col_params_->group.task_names[send_to_dev_idx], send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -409,6 +445,27 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (rf->wire_chunk.IsInitialized()) {
+    // Receive the compressed chunk and widen it into the destination, so that
+    // the reduction itself runs at full precision.
+    Tensor* wire_chunk = &rf->wire_chunk;
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        col_params_->group.device_names[rf->recv_dev_idx],
+        col_params_->group.task_names[rf->recv_dev_idx],
+        col_params_->task.is_local[rf->recv_dev_idx], recv_buf_key,
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), wire_chunk,
+        col_ctx_->device_locality, rf->subdiv_idx,
+        col_ctx_->op_ctx->cancellation_manager(),
+        [wire_chunk, dst_tensor, done](const Status& s) {
+          if (!s.ok()) {
+            done(s);
+            return;
+          }
+          done(CastChunk(*wire_chunk, dst_tensor));
+        });
+    return;
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.device_names[rf->recv_dev_idx],
       col_params_->group.task_names[rf->recv_dev_idx],
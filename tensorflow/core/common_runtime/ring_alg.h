@@ -81,6 +81,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire_chunk;      // chunk cast to wire_dtype_, if compressing
     Status status;
     string DebugString() const;
   };
@@ -114,6 +115,9 @@ class RingAlg : public CollectiveImplementationInterface {
   StatusCallback done_;
   int group_size_;
   int num_subdivs_;
+  // Type chunks are cast to before they are sent, or DT_INVALID to send them
+  // as they are.  Chunks are cast back to the tensor's type on receipt.
+  DataType wire_dtype_;
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
   std::unique_ptr<CollectiveAdapter> ca_;
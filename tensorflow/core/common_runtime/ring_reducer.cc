@@ -42,6 +42,25 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
+namespace {
+// Returns the type that chunks are cast to on the wire, as requested by the
+// `ring_fp16` and `ring_bf16` communication hints, or DT_INVALID if they are
+// sent uncompressed.  Compression is only done for float tensors on CPU; other
+// instances ignore the request.  The decision depends only on values that all
+// members of the group share, so they agree on the wire format.
+DataType RingWireDataType(const CollectiveParams& col_params) {
+  const string& hint = col_params.instance.impl_details.communication_hint;
+  if (hint != "ring_fp16" && hint != "ring_bf16") return DT_INVALID;
+  if (col_params.instance.data_type != DT_FLOAT ||
+      col_params.group.device_type != DEVICE_CPU) {
+    VLOG(1) << "Ignoring communication_hint " << hint << " for "
+            << DataTypeString(col_params.instance.data_type) << " on "
+            << col_params.group.device_type;
+    return DT_INVALID;
+  }
+  return hint == "ring_fp16" ? DT_HALF : DT_BFLOAT16;
+}
+}  // namespace
 
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
@@ -61,6 +80,7 @@ void RingReducer::Run(StatusCallback done) {
 
   done_ = std::move(done);
   group_size_ = col_params_->group.group_size;
+  wire_dtype_ = RingWireDataType(*col_params_);
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
@@ -167,6 +187,11 @@ void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
   if (rf->do_recv) {
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
   }
+  if (wire_dtype_ != DT_INVALID && (rf->do_send || rf->do_recv)) {
+    AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+    rf->wire_chunk = Tensor(col_ctx_->device->GetAllocator(attr), wire_dtype_,
+                            rf->chunk.shape());
+  }
 }
 
 // At the beginning of the algorithm initialize a RingField struct for
@@ -367,6 +367,40 @@ class RingReducerTest : public ::testing::Test {
     }
   }
 
+  // Runs a float reduction whose chunks are compressed as requested by
+  // `communication_hint`.  The result is only as precise as the wire type,
+  // but every device must end up with the same value.
+  void RunCompressedTest(const string& communication_hint, int num_workers,
+                         int num_devices, int num_subdivs, int tensor_len,
+                         float tolerance) {
+    col_params_.instance.impl_details.communication_hint = communication_hint;
+    Init(num_workers, num_devices, DT_FLOAT, DEVICE_CPU, num_subdivs, 0);
+    std::vector<float> expected(tensor_len, 0.0);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->InitTensor(
+          DT_FLOAT, TensorShape({tensor_len}), [&expected, di](Tensor* t) {
+            for (size_t i = 0; i < t->NumElements(); ++i) {
+              float value = 1.0f + 0.3f * di + 0.01f * (i % 100);
+              t->flat<float>()(i) = value;
+              expected[i] += value;
+            }
+          });
+    }
+    Reduce(0);
+    const Tensor& first = instances_[0]->tensor();
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      auto actual = instances_[di]->tensor().unaligned_flat<float>();
+      for (int i = 0; i < tensor_len; ++i) {
+        const float mean = expected[i] / (num_workers * num_devices);
+        EXPECT_NEAR(mean, actual(i), mean * tolerance)
+            << "Mismatch at device " << di << " index " << i;
+        EXPECT_EQ(first.unaligned_flat<float>()(i), actual(i))
+            << "Device " << di << " disagrees with device 0 at index " << i;
+      }
+    }
+  }
+
   std::unique_ptr<OpKernel> GetCollectiveReduce(const CollectiveParams& params,
                                                 Tensor* input,
                                                 const DeviceType& device_type,
@@ -709,6 +743,24 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+// Compressed chunk tests
+TEST_F(RingReducerTest, CompressFp16) {
+  RunCompressedTest("ring_fp16", 2, 4, 1, 1001, 1e-2);
+}
+
+TEST_F(RingReducerTest, CompressFp16WithSubdivs) {
+  RunCompressedTest("ring_fp16", 2, 8, 3, 4095, 1e-2);
+}
+
+TEST_F(RingReducerTest, CompressBf16) {
+  RunCompressedTest("ring_bf16", 2, 4, 1, 1001, 5e-2);
+}
+
+TEST_F(RingReducerTest, CompressionIgnoredForIntegers) {
+  col_params_.instance.impl_details.communication_hint = "ring_fp16";
+  RunTest<int32>(DT_INT32, DEVICE_CPU, 1, 2, 1, 1001, 0);
+}
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
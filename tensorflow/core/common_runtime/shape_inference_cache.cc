@@ -0,0 +1,125 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+
+namespace tensorflow {
+
+namespace {
+
+using shape_inference::InferenceContext;
+using shape_inference::ShapeHandle;
+
+inline Fprint128 FingerprintCat128(const Fprint128& a, const Fprint128& b) {
+  return {FingerprintCat64(a.low64, b.low64),
+          FingerprintCat64(a.high64, b.high64)};
+}
+
+inline Fprint128 FingerprintCat128(const Fprint128& a, const int64 b) {
+  auto x = FingerprintCat64(a.low64, b);
+  return {x, FingerprintCat64(a.high64, x)};
+}
+
+}  // namespace
+
+ShapeInferenceCache::ShapeInferenceCache(int64 max_entries)
+    : max_entries_(max_entries) {}
+
+bool ShapeInferenceCache::ComputeKey(const NodeDef& ndef,
+                                     int graph_def_version, InferenceContext* c,
+                                     Fprint128* key) {
+  if (c->num_inputs() == 0) return false;
+  Fprint128 fingerprint = FingerprintCat128(
+      Fingerprint128(ndef.op()), static_cast<int64>(graph_def_version));
+
+  // The attributes are combined in an order-independent way, since the order
+  // of iteration over the attribute map is unspecified.
+  Fprint128 attrs = {0, 0};
+  for (const auto& attr : ndef.attr()) {
+    const Fprint128 attr_fingerprint = FingerprintCat128(
+        Fingerprint128(attr.first),
+        static_cast<int64>(AttrValueHash(attr.second)));
+    attrs.low64 += attr_fingerprint.low64;
+    attrs.high64 += attr_fingerprint.high64;
+  }
+  fingerprint = FingerprintCat128(fingerprint, attrs);
+
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    const ShapeHandle input = c->input(i);
+    if (!c->FullyDefined(input) ||
+        c->input_handle_shapes_and_types(i) != nullptr) {
+      return false;
+    }
+    const int32 rank = c->Rank(input);
+    fingerprint = FingerprintCat128(fingerprint, rank);
+    for (int d = 0; d < rank; ++d) {
+      fingerprint = FingerprintCat128(fingerprint, c->Value(c->Dim(input, d)));
+    }
+  }
+  *key = fingerprint;
+  return true;
+}
+
+bool ShapeInferenceCache::Lookup(const Fprint128& key, InferenceContext* c) {
+  gtl::InlinedVector<PartialTensorShape, 4> shapes;
+  {
+    tf_shared_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.size() != c->num_outputs()) {
+      return false;
+    }
+    shapes.assign(it->second.begin(), it->second.end());
+  }
+  for (int i = 0; i < shapes.size(); ++i) {
+    ShapeHandle output;
+    if (!c->MakeShapeFromPartialTensorShape(shapes[i], &output).ok()) {
+      return false;
+    }
+    c->set_output(i, output);
+  }
+  return true;
+}
+
+void ShapeInferenceCache::Insert(const Fprint128& key, InferenceContext* c) {
+  std::vector<PartialTensorShape> shapes;
+  shapes.reserve(c->num_outputs());
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    if (c->output_handle_shapes_and_types(i) != nullptr) return;
+    const ShapeHandle output = c->output(i);
+    if (!c->RankKnown(output)) {
+      shapes.emplace_back();
+      continue;
+    }
+    gtl::InlinedVector<int64, 4> dims(c->Rank(output));
+    for (int d = 0; d < dims.size(); ++d) {
+      dims[d] = c->Value(c->Dim(output, d));
+    }
+    shapes.emplace_back(dims);
+  }
+
+  mutex_lock l(mu_);
+  if (entries_.size() >= max_entries_) entries_.clear();
+  entries_.emplace(key, std::move(shapes));
+}
+
+int64 ShapeInferenceCache::size() const {
+  tf_shared_lock l(mu_);
+  return entries_.size();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_INFERENCE_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_INFERENCE_CACHE_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Caches the output shapes computed by shape functions, so that nodes whose
+// op, attributes and input shapes were already seen do not run their shape
+// function again. A cache is shared by the shape refiners of a graph, or by
+// the ops of an eager context, and is thread-safe.
+//
+// Only the results for fully defined input shapes are cached, since the
+// outputs of a shape function may share the unknown dimensions of its inputs,
+// which the cached shapes could not express. The callers are responsible for
+// only inserting results that depend on nothing but the key, e.g. that were
+// not computed from the values of the input tensors.
+class ShapeInferenceCache {
+ public:
+  // The cache is cleared when it holds more than `max_entries` results.
+  static constexpr int64 kDefaultMaxEntries = 1 << 16;
+
+  explicit ShapeInferenceCache(int64 max_entries = kDefaultMaxEntries);
+
+  // Computes the key of the results of the shape function of `ndef` for the
+  // inputs of `c`. Returns false if the results must not be cached: when an
+  // input shape is not fully defined or carries the shapes and types of a
+  // resource or variant handle, or when `ndef` has no inputs, since the shape
+  // functions of such nodes only read attributes that are as costly to
+  // fingerprint.
+  static bool ComputeKey(const NodeDef& ndef, int graph_def_version,
+                         shape_inference::InferenceContext* c, Fprint128* key);
+
+  // Sets the outputs of `c` to the shapes cached for `key`, and returns true,
+  // if any.
+  bool Lookup(const Fprint128& key, shape_inference::InferenceContext* c);
+
+  // Caches the outputs of `c` for `key`. Does nothing if an output of `c`
+  // carries the shapes and types of a handle.
+  void Insert(const Fprint128& key, shape_inference::InferenceContext* c);
+
+  int64 size() const;
+
+ private:
+  const int64 max_entries_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<Fprint128, std::vector<PartialTensorShape>,
+                      Fprint128Hasher>
+      entries_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShapeInferenceCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_INFERENCE_CACHE_H_
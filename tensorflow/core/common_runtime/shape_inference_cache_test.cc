@@ -0,0 +1,111 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+using shape_inference::InferenceContext;
+
+NodeDef MatMulDef(bool transpose_a) {
+  NodeDef def;
+  TF_CHECK_OK(NodeDefBuilder("matmul", "MatMul")
+                  .Input("a", 0, DT_FLOAT)
+                  .Input("b", 0, DT_FLOAT)
+                  .Attr("transpose_a", transpose_a)
+                  .Finalize(&def));
+  return def;
+}
+
+std::unique_ptr<InferenceContext> MakeContext(
+    const NodeDef& def, const std::vector<PartialTensorShape>& inputs) {
+  const OpDef* op_def;
+  TF_CHECK_OK(OpRegistry::Global()->LookUpOpDef(def.op(), &op_def));
+  return std::unique_ptr<InferenceContext>(new InferenceContext(
+      TF_GRAPH_DEF_VERSION, def, *op_def, inputs, {}, {}, {}));
+}
+
+Fprint128 Key(const NodeDef& def,
+              const std::vector<PartialTensorShape>& inputs) {
+  Fprint128 key;
+  auto c = MakeContext(def, inputs);
+  EXPECT_TRUE(ShapeInferenceCache::ComputeKey(def, TF_GRAPH_DEF_VERSION,
+                                              c.get(), &key));
+  return key;
+}
+
+TEST(ShapeInferenceCacheTest, KeyDependsOnAttrsAndShapes) {
+  const NodeDef def = MatMulDef(false);
+  const Fprint128 key = Key(def, {{2, 3}, {3, 4}});
+  EXPECT_EQ(key, Key(def, {{2, 3}, {3, 4}}));
+  EXPECT_FALSE(key == Key(def, {{2, 3}, {3, 5}}));
+  EXPECT_FALSE(key == Key(MatMulDef(true), {{2, 3}, {3, 4}}));
+}
+
+TEST(ShapeInferenceCacheTest, PartialShapesAreNotCached) {
+  const NodeDef def = MatMulDef(false);
+  auto c = MakeContext(def, {{-1, 3}, {3, 4}});
+  Fprint128 key;
+  EXPECT_FALSE(ShapeInferenceCache::ComputeKey(def, TF_GRAPH_DEF_VERSION,
+                                               c.get(), &key));
+}
+
+TEST(ShapeInferenceCacheTest, LookupReturnsInsertedShapes) {
+  ShapeInferenceCache cache;
+  const NodeDef def = MatMulDef(false);
+  const Fprint128 key = Key(def, {{2, 3}, {3, 4}});
+
+  auto c = MakeContext(def, {{2, 3}, {3, 4}});
+  EXPECT_FALSE(cache.Lookup(key, c.get()));
+  TF_ASSERT_OK(c->Run(shape_inference::MatMulShape));
+  cache.Insert(key, c.get());
+  EXPECT_EQ(1, cache.size());
+
+  auto cached = MakeContext(def, {{2, 3}, {3, 4}});
+  ASSERT_TRUE(cache.Lookup(key, cached.get()));
+  EXPECT_EQ("[2,4]", cached->DebugString(cached->output(0)));
+}
+
+TEST(ShapeInferenceCacheTest, ClearedWhenFull) {
+  ShapeInferenceCache cache(/*max_entries=*/1);
+  const NodeDef def = MatMulDef(false);
+  const Fprint128 key0 = Key(def, {{2, 3}, {3, 4}});
+  const Fprint128 key1 = Key(def, {{2, 3}, {3, 5}});
+
+  auto c0 = MakeContext(def, {{2, 3}, {3, 4}});
+  TF_ASSERT_OK(c0->Run(shape_inference::MatMulShape));
+  cache.Insert(key0, c0.get());
+  auto c1 = MakeContext(def, {{2, 3}, {3, 5}});
+  TF_ASSERT_OK(c1->Run(shape_inference::MatMulShape));
+  cache.Insert(key1, c1.get());
+
+  EXPECT_EQ(1, cache.size());
+  EXPECT_FALSE(cache.Lookup(key0, c0.get()));
+  EXPECT_TRUE(cache.Lookup(key1, c1.get()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_set>
@@ -43,7 +44,8 @@ ShapeRefiner::ShapeRefiner(int graph_def_version,
                            const OpRegistryInterface* ops)
     : graph_def_version_(graph_def_version),
       ops_registry_(ops),
-      graph_runner_(Env::Default()) {}
+      graph_runner_(Env::Default()),
+      shape_inference_cache_(std::make_shared<ShapeInferenceCache>()) {}
 
 ShapeRefiner::ShapeRefiner(const VersionDef& versions,
                            const OpRegistryInterface* ops)
@@ -696,6 +698,21 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
     }
     return Status::OK();
   };
+
+  // Reuse the outputs of an earlier run of the shape function on the same
+  // inputs, if any. Function calls are not cached, since their shapes are
+  // inferred from the function bodies.
+  Fprint128 cache_key;
+  const bool cacheable =
+      shape_inference_cache_ != nullptr &&
+      op_reg_data->shape_inference_fn != nullptr &&
+      !(function_library_ && IsFunctionCall(*function_library_, *node)) &&
+      ShapeInferenceCache::ComputeKey(node->def(), graph_def_version_, c,
+                                      &cache_key);
+  if (cacheable && shape_inference_cache_->Lookup(cache_key, c)) {
+    return Status::OK();
+  }
+
   TF_RETURN_IF_ERROR(run_inference_lambda());
 
   // We must run the shape function repeatedly, in case users write
@@ -761,6 +778,16 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
     }
   } while (rerun_shape_fn);
 
+  // Results that used the values of input tensors depend on more than the
+  // input shapes, and are not cached.
+  if (cacheable &&
+      std::none_of(attempted_materialization.begin(),
+                   attempted_materialization.end(), [](bool b) { return b; }) &&
+      std::none_of(attempted_tensor_as_shape_conversion.begin(),
+                   attempted_tensor_as_shape_conversion.end(),
+                   [](bool b) { return b; })) {
+    shape_inference_cache_->Insert(cache_key, c);
+  }
   return Status::OK();
 }
 
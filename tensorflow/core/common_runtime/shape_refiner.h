@@ -15,10 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
+#include <memory>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
+#include "tensorflow/core/common_runtime/shape_inference_cache.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/graph/graph.h"
@@ -153,6 +155,16 @@ class ShapeRefiner {
     return function_library_ != nullptr;
   }
 
+  // Sets the cache of shape function results, so that it can be shared with
+  // the refiners of other graphs of a session. Each refiner starts with a
+  // cache of its own. Caching is disabled if `cache` is null.
+  void set_shape_inference_cache(std::shared_ptr<ShapeInferenceCache> cache) {
+    shape_inference_cache_ = std::move(cache);
+  }
+  const std::shared_ptr<ShapeInferenceCache>& shape_inference_cache() const {
+    return shape_inference_cache_;
+  }
+
  private:
   friend class ShapeRefinerTest;
   friend class ::tensorflow::grappler::GraphProperties;
@@ -316,6 +328,9 @@ class ShapeRefiner {
   bool require_shape_inference_fns_ = true;
   bool disable_constant_propagation_ = false;
 
+  // Output shapes of the shape functions run for earlier nodes.
+  std::shared_ptr<ShapeInferenceCache> shape_inference_cache_;
+
   // Function library is optional, but has to be set to enable function
   // shape inference.
   const tensorflow::FunctionLibraryDefinition* function_library_ = nullptr;
@@ -149,6 +149,30 @@ TEST_F(ShapeRefinerTest, MatMul) {
   EXPECT_SHAPE("[2,2]", m, mm, 0);
 }
 
+TEST_F(ShapeRefinerTest, CachedShapeFunctionResults) {
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+
+  Scope root = Scope::NewRootScope();
+  auto a = ops::Const(root, {{1.0f}, {2.0f}});
+  auto b = ops::Const(root, {{1.0f, 2.0f}});
+  auto mm0 = ops::MatMul(root, a, b);
+  auto mm1 = ops::MatMul(root, a, b);
+  auto mm2 = ops::MatMul(root, b, a);
+
+  TF_ASSERT_OK(m.AddNode(a.node()));
+  TF_ASSERT_OK(m.AddNode(b.node()));
+  TF_ASSERT_OK(m.AddNode(mm0.node()));
+  EXPECT_EQ(1, m.shape_inference_cache()->size());
+  TF_ASSERT_OK(m.AddNode(mm1.node()));
+  EXPECT_EQ(1, m.shape_inference_cache()->size());
+  TF_ASSERT_OK(m.AddNode(mm2.node()));
+  EXPECT_EQ(2, m.shape_inference_cache()->size());
+
+  EXPECT_SHAPE("[2,2]", m, mm0, 0);
+  EXPECT_SHAPE("[2,2]", m, mm1, 0);
+  EXPECT_SHAPE("[1,1]", m, mm2, 0);
+}
+
 TEST_F(ShapeRefinerTest, BadShapes) {
   ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
   Scope root = Scope::NewRootScope();
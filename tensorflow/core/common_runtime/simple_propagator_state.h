@@ -63,6 +63,9 @@ class SimplePropagatorState {
     int64 get_iter_num() const { return 0; }
   };
 
+  // TODO(b/152925936): Re-evaluate this constant with current usage patterns.
+  typedef gtl::InlinedVector<TaggedNode, 8> TaggedNodeSeq;
+
   // A drop-in replacement for std::deque<TaggedNode>.  We typically don't
   // have that many nodes in the ready queue, so we just use a vector and
   // don't free up memory from the queue as we consume nodes.
@@ -93,6 +96,20 @@ class SimplePropagatorState {
       }
     }
     bool empty() const { return ready_.empty(); }
+    size_t size() const { return ready_.size() - front_index_; }
+
+    // Moves the last `n` nodes of the queue to the end of `*nodes`.
+    //
+    // REQUIRES: `n <= size()`.
+    void pop_back_n(size_t n, TaggedNodeSeq* nodes) {
+      DCHECK_LE(n, size());
+      nodes->insert(nodes->end(), ready_.end() - n, ready_.end());
+      ready_.erase(ready_.end() - n, ready_.end());
+      if (front_index_ == ready_.size()) {
+        ready_.clear();
+        front_index_ = 0;
+      }
+    }
 
    private:
     // TODO(b/152925936): Re-evaluate these constants with current usage
@@ -102,9 +119,6 @@ class SimplePropagatorState {
     int front_index_;
   };
 
-  // TODO(b/152925936): Re-evaluate this constant with current usage patterns.
-  typedef gtl::InlinedVector<TaggedNode, 8> TaggedNodeSeq;
-
   // Creates and adds a `TaggedNode` for each node in `roots` to `*ready`.
   void ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
                      TaggedNodeSeq* ready);
@@ -0,0 +1,313 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+const char* const kStaticMemoryBytesAttr = "_static_memory_bytes";
+
+namespace {
+
+// The graphs are small enough for a bitset of the planned producers after
+// each node in practically all cases. Larger graphs are not planned.
+constexpr int64 kMaxReachabilityBits = int64{1} << 30;
+
+typedef std::vector<uint64> Bitset;
+
+inline bool TestBit(const Bitset& bits, int i) {
+  return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+inline void SetBit(int i, Bitset* bits) {
+  (*bits)[i / 64] |= uint64{1} << (i % 64);
+}
+
+int64 AlignedBytes(int64 bytes) {
+  constexpr int64 kAlignment = Allocator::kAllocatorAlignment;
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Returns true if a tensor read by `node` may outlive the step or be kept by
+// the node beyond its execution.
+bool MayEscape(const Node* node) {
+  return node->IsRetval() || node->IsSend() || node->op_def().is_stateful();
+}
+
+struct Candidate {
+  const Node* node;
+  int output_slot;
+  int64 bytes;
+  bool planned = true;
+  int64 offset = -1;
+  // The nodes that read the output, including its producer.
+  std::vector<const Node*> users;
+};
+
+}  // namespace
+
+// Serves one buffer of an arena. Requests of another size, which happen if
+// the shapes at run time differ from the shapes the graph was planned with,
+// are forwarded to the backing allocator.
+class StaticMemoryPlan::Arena::BufferAllocator : public Allocator {
+ public:
+  BufferAllocator(Arena* arena, void* ptr, int64 bytes)
+      : arena_(arena), ptr_(ptr), bytes_(bytes) {}
+
+  string Name() override { return "static_memory_arena"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    if (num_bytes != bytes_ ||
+        reinterpret_cast<uintptr_t>(ptr_) % alignment != 0) {
+      VLOG(1) << "Allocating " << num_bytes << " bytes outside of the static "
+              << "memory arena, " << bytes_ << " bytes were planned";
+      return arena_->backing_->AllocateRaw(alignment, num_bytes);
+    }
+    arena_->Ref();
+    return ptr_;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (ptr != ptr_) {
+      arena_->backing_->DeallocateRaw(ptr);
+      return;
+    }
+    arena_->Unref();
+  }
+
+ private:
+  Arena* const arena_;
+  void* const ptr_;
+  const size_t bytes_;
+};
+
+StaticMemoryPlan::Arena::Arena(const std::vector<Buffer>& buffers,
+                               Allocator* backing, void* base)
+    : backing_(backing), base_(base) {
+  buffer_allocators_.reserve(buffers.size());
+  allocators_.reserve(buffers.size());
+  for (const Buffer& buffer : buffers) {
+    buffer_allocators_.emplace_back(new BufferAllocator(
+        this, static_cast<char*>(base) + buffer.offset, buffer.bytes));
+    allocators_.push_back(buffer_allocators_.back().get());
+  }
+}
+
+StaticMemoryPlan::Arena::~Arena() { backing_->DeallocateRaw(base_); }
+
+StaticMemoryPlan::StaticMemoryPlan(std::vector<Buffer> buffers,
+                                   int64 arena_bytes)
+    : buffers_(std::move(buffers)), arena_bytes_(arena_bytes) {}
+
+StaticMemoryPlan::~StaticMemoryPlan() {
+  for (Arena* arena : arenas_) arena->Unref();
+}
+
+/* static */
+Status StaticMemoryPlan::Create(const Graph& graph, GraphView* gview,
+                                std::unique_ptr<StaticMemoryPlan>* plan) {
+  plan->reset();
+  const int num_nodes = graph.num_node_ids();
+
+  // Collect the annotated outputs that the executor allocates with default
+  // attributes.
+  std::vector<Candidate> candidates;
+  gtl::FlatMap<std::pair<int, int>, int> candidate_index;
+  std::vector<int> producer_index(num_nodes, -1);
+  int num_producers = 0;
+  for (const Node* n : graph.op_nodes()) {
+    std::vector<int64> bytes;
+    if (!TryGetNodeAttr(n->attrs(), kStaticMemoryBytesAttr, &bytes)) continue;
+    if (bytes.size() != static_cast<size_t>(n->num_outputs()) ||
+        n->op_def().is_stateful()) {
+      continue;
+    }
+    const NodeItem* item = gview->node(n->id());
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      const AllocatorAttributes& attr = item->output_attrs()[i];
+      if (bytes[i] <= 0 || attr.value != 0 || attr.scope_id != 0 ||
+          item->forward_from()[i] != OpKernelContext::Params::kNoReservation) {
+        continue;
+      }
+      candidate_index[{n->id(), i}] = candidates.size();
+      candidates.push_back({n, i, bytes[i]});
+      if (producer_index[n->id()] < 0) {
+        producer_index[n->id()] = num_producers++;
+      }
+    }
+  }
+  if (candidates.empty()) return Status::OK();
+  if (static_cast<int64>(num_nodes) * num_producers > kMaxReachabilityBits) {
+    LOG(WARNING) << "Not planning the memory of a graph with " << num_nodes
+                 << " nodes and " << num_producers << " planned producers";
+    return Status::OK();
+  }
+
+  // after[n] holds the producers that run strictly after node n.
+  const int num_words = (num_producers + 63) / 64;
+  std::vector<Bitset> after(num_nodes, Bitset(num_words, 0));
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    const Node* n = *it;
+    Bitset& bits = after[n->id()];
+    for (const Node* dst : n->out_nodes()) {
+      const Bitset& dst_bits = after[dst->id()];
+      for (int w = 0; w < num_words; ++w) bits[w] |= dst_bits[w];
+      if (producer_index[dst->id()] >= 0) {
+        SetBit(producer_index[dst->id()], &bits);
+      }
+    }
+  }
+
+  // Find the users of each output, following the outputs of the users that
+  // are not candidates since they may alias their inputs. Candidates are never
+  // forwarded to, including those that escape and are left to the device's
+  // allocator, so they do not alias the outputs they are computed from.
+  for (Candidate& candidate : candidates) {
+    gtl::FlatSet<const Node*> users = {candidate.node};
+    std::deque<std::pair<const Node*, int>> outputs = {
+        {candidate.node, candidate.output_slot}};
+    while (!outputs.empty() && candidate.planned) {
+      const Node* src = outputs.front().first;
+      const int src_slot = outputs.front().second;
+      outputs.pop_front();
+      for (const Edge* e : src->out_edges()) {
+        if (e->IsControlEdge() || e->src_output() != src_slot) continue;
+        const Node* user = e->dst();
+        if (MayEscape(user)) {
+          candidate.planned = false;
+          break;
+        }
+        if (!users.insert(user).second) continue;
+        for (int i = 0; i < user->num_outputs(); ++i) {
+          if (candidate_index.find({user->id(), i}) == candidate_index.end()) {
+            outputs.emplace_back(user, i);
+          }
+        }
+      }
+    }
+    if (candidate.planned) candidate.users.assign(users.begin(), users.end());
+  }
+
+  // The producers that run strictly after every user of each output.
+  std::vector<int> planned;
+  std::vector<Bitset> free_before(candidates.size());
+  for (int c = 0; c < candidates.size(); ++c) {
+    if (!candidates[c].planned) continue;
+    planned.push_back(c);
+    Bitset& bits = free_before[c];
+    bits.assign(num_words, ~uint64{0});
+    for (const Node* user : candidates[c].users) {
+      const Bitset& user_bits = after[user->id()];
+      for (int w = 0; w < num_words; ++w) bits[w] &= user_bits[w];
+    }
+  }
+  if (planned.empty()) return Status::OK();
+
+  // Place the largest outputs first, each at the lowest offset that does not
+  // overlap an output it may be live with.
+  std::sort(planned.begin(), planned.end(), [&candidates](int a, int b) {
+    const Candidate& ca = candidates[a];
+    const Candidate& cb = candidates[b];
+    if (ca.bytes != cb.bytes) return ca.bytes > cb.bytes;
+    if (ca.node->id() != cb.node->id()) return ca.node->id() < cb.node->id();
+    return ca.output_slot < cb.output_slot;
+  });
+  std::vector<int> placed;
+  std::vector<std::pair<int64, int64>> live;
+  int64 arena_bytes = 0;
+  int64 total_bytes = 0;
+  for (int c : planned) {
+    const int64 bytes = AlignedBytes(candidates[c].bytes);
+    const int producer_c = producer_index[candidates[c].node->id()];
+    live.clear();
+    for (int p : placed) {
+      const int producer_p = producer_index[candidates[p].node->id()];
+      if (TestBit(free_before[c], producer_p) ||
+          TestBit(free_before[p], producer_c)) {
+        continue;
+      }
+      const int64 start = candidates[p].offset;
+      live.emplace_back(start, start + AlignedBytes(candidates[p].bytes));
+    }
+    std::sort(live.begin(), live.end());
+    int64 offset = 0;
+    for (const auto& range : live) {
+      if (offset + bytes <= range.first) break;
+      offset = std::max(offset, range.second);
+    }
+    candidates[c].offset = offset;
+    placed.push_back(c);
+    arena_bytes = std::max(arena_bytes, offset + bytes);
+    total_bytes += bytes;
+  }
+
+  // Hand the buffers out in node order and route the outputs to them.
+  std::vector<Buffer> buffers;
+  buffers.reserve(planned.size());
+  for (const Candidate& candidate : candidates) {
+    NodeItem* item = gview->node(candidate.node->id());
+    item->forward_from_base()[candidate.output_slot] =
+        OpKernelContext::Params::kNeverForward;
+    if (!candidate.planned) continue;
+    item->output_attr_base()[candidate.output_slot].scope_id =
+        OpKernelContext::Params::kStaticMemoryScopeIdBase + buffers.size();
+    buffers.push_back({candidate.node->id(), candidate.output_slot,
+                       candidate.offset, candidate.bytes});
+  }
+  VLOG(1) << "Planned " << buffers.size() << " outputs of " << total_bytes
+          << " bytes into a static memory arena of " << arena_bytes
+          << " bytes";
+  plan->reset(new StaticMemoryPlan(std::move(buffers), arena_bytes));
+  return Status::OK();
+}
+
+Status StaticMemoryPlan::AcquireArena(DeviceBase* device,
+                                      core::RefCountPtr<Arena>* arena) {
+  mutex_lock l(mu_);
+  for (Arena* pooled : arenas_) {
+    if (pooled->RefCountIsOne()) {
+      pooled->Ref();
+      arena->reset(pooled);
+      return Status::OK();
+    }
+  }
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+  void* base =
+      allocator->AllocateRaw(Allocator::kAllocatorAlignment, arena_bytes_);
+  if (base == nullptr) {
+    return errors::ResourceExhausted("OOM when allocating the static memory "
+                                     "arena of ",
+                                     arena_bytes_, " bytes");
+  }
+  arenas_.push_back(new Arena(buffers_, allocator, base));
+  arenas_.back()->Ref();
+  arena->reset(arenas_.back());
+  return Status::OK();
+}
+
+}  // namespace tensorflow
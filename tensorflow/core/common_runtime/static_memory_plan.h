@@ -0,0 +1,112 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Node attribute set by the grappler StaticMemoryPlanner: the size in bytes
+// of each output of the node, or -1 for outputs that must not be planned.
+extern const char* const kStaticMemoryBytesAttr;
+
+// Assigns the outputs annotated with `kStaticMemoryBytesAttr` fixed offsets in
+// one arena for the executor of a graph, so that a step allocates a single
+// buffer instead of one per tensor.
+//
+// Two outputs share memory only if every node that reads one of them
+// (directly or through a tensor that may alias it) is an ancestor of the
+// producer of the other, so the plan holds for any order in which the
+// executor runs independent nodes. Outputs that may escape the step (those
+// read by stateful nodes, _Retval or _Send) are not planned.
+//
+// Each concurrent step uses an arena of its own, taken from a pool that grows
+// as needed. An arena returns to the pool once its step has finished and all
+// the tensors allocated in it have been freed.
+class StaticMemoryPlan {
+ public:
+  // An output assigned to the arena.
+  struct Buffer {
+    int32 node_id;
+    int32 output_slot;
+    int64 offset;
+    int64 bytes;
+  };
+
+  // The memory of one step.
+  class Arena : public core::RefCounted {
+   public:
+    Arena(const std::vector<Buffer>& buffers, Allocator* backing, void* base);
+    ~Arena() override;
+
+    // The allocators of the buffers, indexed like `buffers()`.
+    Allocator* const* allocators() const { return allocators_.data(); }
+
+   private:
+    class BufferAllocator;
+
+    Allocator* const backing_;  // Not owned.
+    void* const base_;
+    std::vector<std::unique_ptr<BufferAllocator>> buffer_allocators_;
+    std::vector<Allocator*> allocators_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(Arena);
+  };
+
+  // Plans the annotated outputs of `graph` and stores their scope ids in the
+  // AllocatorAttributes of `gview`, whose allocation attributes must have
+  // been set. Leaves `plan` empty if no output can be planned.
+  //
+  // REQUIRES: `graph` has no control flow frames.
+  static Status Create(const Graph& graph, GraphView* gview,
+                       std::unique_ptr<StaticMemoryPlan>* plan);
+
+  ~StaticMemoryPlan();
+
+  const std::vector<Buffer>& buffers() const { return buffers_; }
+  int64 arena_bytes() const { return arena_bytes_; }
+
+  // Returns in `arena` an arena that no other step uses, allocating it with
+  // the default allocator of `device` if all arenas in the pool are in use.
+  Status AcquireArena(DeviceBase* device, core::RefCountPtr<Arena>* arena);
+
+ private:
+  StaticMemoryPlan(std::vector<Buffer> buffers, int64 arena_bytes);
+
+  const std::vector<Buffer> buffers_;
+  const int64 arena_bytes_;
+
+  mutex mu_;
+  std::vector<Arena*> arenas_ TF_GUARDED_BY(mu_);  // One reference each.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlan);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
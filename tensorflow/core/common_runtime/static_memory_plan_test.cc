@@ -0,0 +1,150 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kBytes = 400;
+constexpr int64 kAlignedBytes = 448;
+
+class StaticMemoryPlanTest : public ::testing::Test {
+ protected:
+  StaticMemoryPlanTest() : graph_(OpRegistry::Global()) {
+    input_ = test::graph::Constant(&graph_, Tensor(DT_FLOAT, {100}));
+  }
+
+  Node* Planned(Node* n) {
+    n->AddAttr(kStaticMemoryBytesAttr, std::vector<int64>{kBytes});
+    return n;
+  }
+
+  Status Plan() {
+    TF_RETURN_IF_ERROR(gview_.Initialize(&graph_));
+    return StaticMemoryPlan::Create(graph_, &gview_, &plan_);
+  }
+
+  const StaticMemoryPlan::Buffer* FindBuffer(const Node* n) const {
+    for (const auto& buffer : plan_->buffers()) {
+      if (buffer.node_id == n->id()) return &buffer;
+    }
+    return nullptr;
+  }
+
+  Graph graph_;
+  Node* input_;
+  GraphView gview_;
+  std::unique_ptr<StaticMemoryPlan> plan_;
+};
+
+TEST_F(StaticMemoryPlanTest, ReusesMemoryOfDeadOutputs) {
+  Node* a = Planned(test::graph::Unary(&graph_, "Relu", input_));
+  Node* b = Planned(test::graph::Unary(&graph_, "Relu", a));
+  Node* c = Planned(test::graph::Unary(&graph_, "Relu", b));
+  Node* d = Planned(test::graph::Unary(&graph_, "Relu", c));
+  test::graph::Retval(&graph_, 0, test::graph::Unary(&graph_, "Relu", d));
+  TF_ASSERT_OK(Plan());
+
+  ASSERT_NE(plan_, nullptr);
+  ASSERT_EQ(plan_->buffers().size(), 3);
+  EXPECT_EQ(FindBuffer(a)->offset, FindBuffer(c)->offset);
+  EXPECT_NE(FindBuffer(a)->offset, FindBuffer(b)->offset);
+  EXPECT_EQ(plan_->arena_bytes(), 2 * kAlignedBytes);
+
+  const NodeItem* item = gview_.node(b->id());
+  EXPECT_GE(item->output_attrs()[0].scope_id,
+            OpKernelContext::Params::kStaticMemoryScopeIdBase);
+  EXPECT_EQ(item->forward_from()[0], OpKernelContext::Params::kNeverForward);
+
+  // The last output may be forwarded to the fetched tensor.
+  EXPECT_EQ(FindBuffer(d), nullptr);
+  item = gview_.node(d->id());
+  EXPECT_EQ(item->output_attrs()[0].scope_id, 0);
+  EXPECT_EQ(item->forward_from()[0], OpKernelContext::Params::kNeverForward);
+}
+
+TEST_F(StaticMemoryPlanTest, DoesNotPlanEscapingOutputs) {
+  Node* a = Planned(test::graph::Unary(&graph_, "Relu", input_));
+  Node* b = test::graph::Identity(&graph_, a);
+  test::graph::Retval(&graph_, 0, b);
+  TF_ASSERT_OK(Plan());
+
+  EXPECT_EQ(plan_, nullptr);
+  const NodeItem* item = gview_.node(a->id());
+  EXPECT_EQ(item->output_attrs()[0].scope_id, 0);
+  EXPECT_EQ(item->forward_from()[0], OpKernelContext::Params::kNoReservation);
+}
+
+TEST_F(StaticMemoryPlanTest, KeepsOutputsReadThroughAliasesLive) {
+  // `b` may alias `a`, which stays live until `e` has run.
+  Node* a = Planned(test::graph::Unary(&graph_, "Relu", input_));
+  Node* b = test::graph::Identity(&graph_, a);
+  Node* c = Planned(test::graph::Unary(&graph_, "Relu", b));
+  Node* d = Planned(test::graph::Unary(&graph_, "Relu", c));
+  Node* e = Planned(test::graph::Binary(&graph_, "Add", b, d));
+  Node* f = Planned(test::graph::Unary(&graph_, "Relu", e));
+  test::graph::Retval(&graph_, 0, test::graph::Unary(&graph_, "Relu", f));
+  TF_ASSERT_OK(Plan());
+
+  ASSERT_NE(plan_, nullptr);
+  ASSERT_EQ(plan_->buffers().size(), 4);
+  EXPECT_NE(FindBuffer(a)->offset, FindBuffer(c)->offset);
+  EXPECT_NE(FindBuffer(a)->offset, FindBuffer(d)->offset);
+  EXPECT_EQ(FindBuffer(c)->offset, FindBuffer(e)->offset);
+  EXPECT_EQ(plan_->arena_bytes(), 3 * kAlignedBytes);
+}
+
+TEST_F(StaticMemoryPlanTest, PoolsArenasAcrossSteps) {
+  Node* a = Planned(test::graph::Unary(&graph_, "Relu", input_));
+  Node* b = Planned(test::graph::Unary(&graph_, "Relu", a));
+  test::graph::Retval(&graph_, 0, test::graph::Unary(&graph_, "Relu", b));
+  TF_ASSERT_OK(Plan());
+  ASSERT_NE(plan_, nullptr);
+
+  std::unique_ptr<Device> device(
+      DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0"));
+  core::RefCountPtr<StaticMemoryPlan::Arena> first;
+  core::RefCountPtr<StaticMemoryPlan::Arena> second;
+  TF_ASSERT_OK(plan_->AcquireArena(device.get(), &first));
+  TF_ASSERT_OK(plan_->AcquireArena(device.get(), &second));
+  EXPECT_NE(first.get(), second.get());
+
+  // An arena stays in use while tensors allocated in it are alive.
+  Allocator* allocator = first->allocators()[0];
+  void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment, kBytes);
+  StaticMemoryPlan::Arena* first_arena = first.get();
+  first.reset();
+  core::RefCountPtr<StaticMemoryPlan::Arena> third;
+  TF_ASSERT_OK(plan_->AcquireArena(device.get(), &third));
+  EXPECT_NE(third.get(), first_arena);
+
+  allocator->DeallocateRaw(ptr);
+  core::RefCountPtr<StaticMemoryPlan::Arena> fourth;
+  TF_ASSERT_OK(plan_->AcquireArena(device.get(), &fourth));
+  EXPECT_EQ(fourth.get(), first_arena);
+}
+
+}  // namespace
+}  // namespace tensorflow
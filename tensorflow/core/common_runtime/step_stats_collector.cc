@@ -146,6 +146,10 @@ void NodeExecStatsWrapper::SetScheduled(int64 nanos) {
   stats_->set_scheduled_nanos(nanos);
 }
 
+void NodeExecStatsWrapper::SetScheduledInline(bool scheduled_inline) {
+  stats_->set_scheduled_inline(scheduled_inline);
+}
+
 void NodeExecStatsWrapper::SetMemory(OpKernelContext* ctx) {
   for (const auto& allocator_pair : ctx->ConsumeWrappedAllocators()) {
     AddAllocation(allocator_pair.first, allocator_pair.second);
@@ -83,6 +83,10 @@ class NodeExecStatsInterface {
   // Records the absolute time in nanoseconds at which this node became
   // runnable (i.e. was scheduled for execution).
   virtual void SetScheduled(int64 nanos) = 0;
+
+  // Records whether the executor ran this node on the thread that made it
+  // runnable, rather than dispatching it to the inter-op thread pool.
+  virtual void SetScheduledInline(bool scheduled_inline) = 0;
 };
 
 // Wraps NodeExecStats and adds allocation to it.
@@ -109,6 +113,7 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
   void SetMemory(OpKernelContext* ctx) override;
   void SetOutput(int slot, const Tensor* tensor) override;
   void SetScheduled(int64 nanos) override;
+  void SetScheduledInline(bool scheduled_inline) override;
 
  private:
   friend class StepStatsCollector;
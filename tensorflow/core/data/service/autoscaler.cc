@@ -0,0 +1,107 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/autoscaler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace tensorflow {
+namespace data {
+
+constexpr double Autoscaler::kScaleDownOccupancy;
+
+Autoscaler::Autoscaler(double target_stall_rate, int64 window_micros)
+    : target_stall_rate_(target_stall_rate), window_micros_(window_micros) {}
+
+void Autoscaler::RecordTaskStats(int64 job_id,
+                                 const std::string& worker_address,
+                                 const TaskRunnerStats& stats,
+                                 int64 now_micros) {
+  DropOldSamples(now_micros);
+  if (stats.num_requests() == 0) {
+    return;
+  }
+  samples_.push_back({now_micros, job_id, worker_address, stats});
+}
+
+void Autoscaler::GetRecommendation(
+    int64 num_workers, int64 now_micros,
+    GetWorkerCountRecommendationResponse& response) {
+  DropOldSamples(now_micros);
+  // Ordered maps keep the response deterministic.
+  std::map<int64, TaskRunnerStats> jobs;
+  std::map<std::string, TaskRunnerStats> workers;
+  for (const Sample& sample : samples_) {
+    for (TaskRunnerStats* stats :
+         {&jobs[sample.job_id], &workers[sample.worker_address]}) {
+      stats->set_num_requests(stats->num_requests() +
+                              sample.stats.num_requests());
+      stats->set_num_stalls(stats->num_stalls() + sample.stats.num_stalls());
+      stats->set_wait_time_micros(stats->wait_time_micros() +
+                                  sample.stats.wait_time_micros());
+      stats->set_buffer_occupancy_sum(stats->buffer_occupancy_sum() +
+                                      sample.stats.buffer_occupancy_sum());
+    }
+  }
+
+  double max_stall_rate = 0;
+  for (const auto& job : jobs) {
+    const TaskRunnerStats& stats = job.second;
+    JobAutoscalingStats* job_stats = response.add_jobs();
+    job_stats->set_job_id(job.first);
+    job_stats->set_stall_rate(static_cast<double>(stats.num_stalls()) /
+                              stats.num_requests());
+    job_stats->set_mean_wait_time_micros(
+        static_cast<double>(stats.wait_time_micros()) / stats.num_requests());
+    max_stall_rate = std::max(max_stall_rate, job_stats->stall_rate());
+  }
+  double occupancy_sum = 0;
+  int64 num_requests = 0;
+  for (const auto& worker : workers) {
+    const TaskRunnerStats& stats = worker.second;
+    WorkerAutoscalingStats* worker_stats = response.add_workers();
+    worker_stats->set_worker_address(worker.first);
+    worker_stats->set_buffer_occupancy(stats.buffer_occupancy_sum() /
+                                       stats.num_requests());
+    occupancy_sum += stats.buffer_occupancy_sum();
+    num_requests += stats.num_requests();
+  }
+
+  int64 recommended = num_workers;
+  if (num_requests > 0) {
+    if (max_stall_rate > target_stall_rate_) {
+      recommended = std::max<int64>(
+          num_workers + 1,
+          std::ceil(num_workers * (1 + max_stall_rate - target_stall_rate_)));
+    } else if (occupancy_sum / num_requests >= kScaleDownOccupancy) {
+      const int64 excess = std::max<int64>(1, num_workers / 10);
+      recommended = std::max<int64>(1, num_workers - excess);
+    }
+  }
+  response.set_recommended_num_workers(recommended);
+  response.set_current_num_workers(num_workers);
+  response.set_target_stall_rate(target_stall_rate_);
+}
+
+void Autoscaler::DropOldSamples(int64 now_micros) {
+  while (!samples_.empty() &&
+         samples_.front().time_micros < now_micros - window_micros_) {
+    samples_.pop_front();
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,79 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_AUTOSCALER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_AUTOSCALER_H_
+
+#include <deque>
+#include <string>
+
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/dispatcher.pb.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Recommends a number of tf.data service workers from the task statistics
+// that workers report in their heartbeats. Only the statistics of the last
+// `window_micros` are considered.
+//
+// The stall rate of a job is the fraction of its element requests which had to
+// wait for an element to be produced. If some job's stall rate exceeds
+// `target_stall_rate`, the recommendation grows the pool in proportion to the
+// excess, by at least one worker. Otherwise, if the workers' buffers were
+// almost always full when elements were requested, the workers are ahead of
+// their consumers and the recommendation shrinks the pool by a tenth, by at
+// least one worker. Else it keeps the current number of workers.
+//
+// This class is not thread-safe.
+class Autoscaler {
+ public:
+  // Mean buffer occupancy above which workers are considered idle.
+  static constexpr double kScaleDownOccupancy = 0.9;
+
+  Autoscaler(double target_stall_rate, int64 window_micros);
+  Autoscaler(const Autoscaler&) = delete;
+  Autoscaler& operator=(const Autoscaler&) = delete;
+
+  // Records the statistics reported at `now_micros` by the worker at
+  // `worker_address` for a task of job `job_id`.
+  void RecordTaskStats(int64 job_id, const std::string& worker_address,
+                       const TaskRunnerStats& stats, int64 now_micros);
+
+  // Fills `response` with a recommendation for a pool which currently has
+  // `num_workers` workers.
+  void GetRecommendation(int64 num_workers, int64 now_micros,
+                         GetWorkerCountRecommendationResponse& response);
+
+ private:
+  struct Sample {
+    int64 time_micros;
+    int64 job_id;
+    std::string worker_address;
+    TaskRunnerStats stats;
+  };
+
+  void DropOldSamples(int64 now_micros);
+
+  const double target_stall_rate_;
+  const int64 window_micros_;
+  // Samples in increasing order of time.
+  std::deque<Sample> samples_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_AUTOSCALER_H_
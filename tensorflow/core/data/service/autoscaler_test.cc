@@ -0,0 +1,106 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/autoscaler.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr double kTargetStallRate = 0.1;
+constexpr int64 kWindowMicros = 1000;
+
+TaskRunnerStats Stats(int64 num_requests, int64 num_stalls,
+                      double buffer_occupancy) {
+  TaskRunnerStats stats;
+  stats.set_num_requests(num_requests);
+  stats.set_num_stalls(num_stalls);
+  stats.set_wait_time_micros(10 * num_stalls);
+  stats.set_buffer_occupancy_sum(buffer_occupancy * num_requests);
+  return stats;
+}
+
+TEST(AutoscalerTest, NoStats) {
+  Autoscaler autoscaler(kTargetStallRate, kWindowMicros);
+  GetWorkerCountRecommendationResponse response;
+  autoscaler.GetRecommendation(/*num_workers=*/4, /*now_micros=*/0, response);
+  EXPECT_EQ(4, response.recommended_num_workers());
+  EXPECT_EQ(4, response.current_num_workers());
+  EXPECT_EQ(0, response.jobs_size());
+}
+
+TEST(AutoscalerTest, ScaleUpWhenJobsStall) {
+  Autoscaler autoscaler(kTargetStallRate, kWindowMicros);
+  autoscaler.RecordTaskStats(/*job_id=*/1, "w1", Stats(100, 10, 0.5), 0);
+  autoscaler.RecordTaskStats(/*job_id=*/2, "w1", Stats(100, 60, 0.1), 0);
+  autoscaler.RecordTaskStats(/*job_id=*/2, "w2", Stats(100, 60, 0.1), 0);
+  GetWorkerCountRecommendationResponse response;
+  autoscaler.GetRecommendation(/*num_workers=*/10, /*now_micros=*/0, response);
+  // The worst stall rate is 0.6, 0.5 above the target.
+  EXPECT_EQ(15, response.recommended_num_workers());
+  ASSERT_EQ(2, response.jobs_size());
+  EXPECT_EQ(1, response.jobs(0).job_id());
+  EXPECT_DOUBLE_EQ(0.1, response.jobs(0).stall_rate());
+  EXPECT_DOUBLE_EQ(1.0, response.jobs(0).mean_wait_time_micros());
+  EXPECT_DOUBLE_EQ(0.6, response.jobs(1).stall_rate());
+  ASSERT_EQ(2, response.workers_size());
+  EXPECT_EQ("w1", response.workers(0).worker_address());
+  EXPECT_DOUBLE_EQ(0.3, response.workers(0).buffer_occupancy());
+}
+
+TEST(AutoscalerTest, ScaleUpFromOneWorker) {
+  Autoscaler autoscaler(kTargetStallRate, kWindowMicros);
+  autoscaler.RecordTaskStats(/*job_id=*/1, "w1", Stats(100, 20, 0.5), 0);
+  GetWorkerCountRecommendationResponse response;
+  autoscaler.GetRecommendation(/*num_workers=*/1, /*now_micros=*/0, response);
+  EXPECT_EQ(2, response.recommended_num_workers());
+}
+
+TEST(AutoscalerTest, ScaleDownWhenBuffersAreFull) {
+  Autoscaler autoscaler(kTargetStallRate, kWindowMicros);
+  autoscaler.RecordTaskStats(/*job_id=*/1, "w1", Stats(100, 0, 1.0), 0);
+  GetWorkerCountRecommendationResponse response;
+  autoscaler.GetRecommendation(/*num_workers=*/20, /*now_micros=*/0, response);
+  EXPECT_EQ(18, response.recommended_num_workers());
+  response.Clear();
+  autoscaler.GetRecommendation(/*num_workers=*/1, /*now_micros=*/0, response);
+  EXPECT_EQ(1, response.recommended_num_workers());
+}
+
+TEST(AutoscalerTest, KeepWorkersWithinTarget) {
+  Autoscaler autoscaler(kTargetStallRate, kWindowMicros);
+  autoscaler.RecordTaskStats(/*job_id=*/1, "w1", Stats(100, 5, 0.5), 0);
+  GetWorkerCountRecommendationResponse response;
+  autoscaler.GetRecommendation(/*num_workers=*/8, /*now_micros=*/0, response);
+  EXPECT_EQ(8, response.recommended_num_workers());
+}
+
+TEST(AutoscalerTest, DropOldStats) {
+  Autoscaler autoscaler(kTargetStallRate, kWindowMicros);
+  autoscaler.RecordTaskStats(/*job_id=*/1, "w1", Stats(100, 100, 0.0), 0);
+  autoscaler.RecordTaskStats(/*job_id=*/1, "w1", Stats(100, 0, 0.5),
+                             kWindowMicros);
+  GetWorkerCountRecommendationResponse response;
+  autoscaler.GetRecommendation(/*num_workers=*/8,
+                               /*now_micros=*/kWindowMicros + 1, response);
+  EXPECT_EQ(8, response.recommended_num_workers());
+  ASSERT_EQ(1, response.jobs_size());
+  EXPECT_DOUBLE_EQ(0.0, response.jobs(0).stall_rate());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -55,14 +55,20 @@ std::string ProcessingModeToString(ProcessingMode mode) {
 }
 
 Status DataServiceDispatcherClient::WorkerHeartbeat(
-    const std::string& worker_address, const std::vector<int64>& current_tasks,
+    const std::string& worker_address, const Locality& worker_locality,
+    const std::vector<int64>& current_tasks,
+    const std::vector<TaskRunnerStats>& task_stats,
     std::vector<TaskDef>& new_tasks, std::vector<int64>& tasks_to_delete) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   WorkerHeartbeatRequest req;
   req.set_worker_address(worker_address);
+  *req.mutable_worker_locality() = worker_locality;
   for (int64 task : current_tasks) {
     req.add_current_tasks(task);
   }
+  for (const auto& stats : task_stats) {
+    *req.add_task_stats() = stats;
+  }
   WorkerHeartbeatResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->WorkerHeartbeat(&client_ctx, req, &resp);
@@ -150,7 +156,8 @@ Status DataServiceDispatcherClient::RegisterDataset(GraphDef dataset,
 
 Status DataServiceDispatcherClient::GetOrCreateJob(
     int64 dataset_id, ProcessingMode processing_mode,
-    const absl::optional<JobKey>& job_key, int64& job_client_id) {
+    const absl::optional<JobKey>& job_key, const Locality& client_locality,
+    int64& job_client_id) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetOrCreateJobRequest req;
   req.set_dataset_id(dataset_id);
@@ -158,6 +165,7 @@ Status DataServiceDispatcherClient::GetOrCreateJob(
   if (job_key.has_value()) {
     *req.mutable_job_key() = job_key.value();
   }
+  *req.mutable_client_locality() = client_locality;
   GetOrCreateJobResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->GetOrCreateJob(&client_ctx, req, &resp);
@@ -187,11 +195,13 @@ Status DataServiceDispatcherClient::ReleaseJobClient(int64 job_client_id) {
 }
 
 Status DataServiceDispatcherClient::GetTasks(int64 job_client_id,
+                                             const Locality& client_locality,
                                              std::vector<TaskInfo>& tasks,
                                              bool& job_finished) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetTasksRequest req;
   req.set_job_client_id(job_client_id);
+  *req.mutable_client_locality() = client_locality;
   GetTasksResponse resp;
   grpc::ClientContext ctx;
   grpc::Status s = stub_->GetTasks(&ctx, req, &resp);
@@ -223,6 +233,19 @@ Status DataServiceDispatcherClient::GetWorkers(
   return Status::OK();
 }
 
+Status DataServiceDispatcherClient::GetWorkerCountRecommendation(
+    GetWorkerCountRecommendationResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetWorkerCountRecommendationRequest req;
+  grpc::ClientContext ctx;
+  grpc::Status s = stub_->GetWorkerCountRecommendation(&ctx, req, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get worker count recommendation",
+                                s);
+  }
+  return Status::OK();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   mutex_lock l(mu_);
   if (stub_) {
@@ -239,11 +262,15 @@ Status DataServiceDispatcherClient::EnsureInitialized() {
 }
 
 Status DataServiceWorkerClient::GetElement(int64 task_id,
-                                           CompressedElement& element,
+                                           SharedMemoryRing* ring,
+                                           std::vector<Tensor>& element,
                                            bool& end_of_sequence) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetElementRequest req;
   req.set_task_id(task_id);
+  if (ring != nullptr) {
+    req.set_shared_memory_ring(ring->name());
+  }
   GetElementResponse resp;
   grpc::ClientContext ctx;
   grpc::Status s = stub_->GetElement(&ctx, req, &resp);
@@ -251,8 +278,43 @@ Status DataServiceWorkerClient::GetElement(int64 task_id,
     return grpc_util::WrapError("Failed to get element", s);
   }
   end_of_sequence = resp.end_of_sequence();
-  if (!end_of_sequence) {
-    element = std::move(*resp.mutable_compressed_element());
+  if (end_of_sequence) {
+    return Status::OK();
+  }
+  if (resp.in_shared_memory()) {
+    if (ring == nullptr) {
+      return errors::Internal(
+          "The worker handed an element through shared memory, but no "
+          "shared memory ring was requested");
+    }
+    bool popped = false;
+    TF_RETURN_IF_ERROR(ring->TryPop(&element, &popped));
+    if (!popped) {
+      return errors::Internal("The shared memory ring ", ring->name(),
+                              " does not hold the element pushed by the "
+                              "worker");
+    }
+    return Status::OK();
+  }
+  element.clear();
+  switch (resp.element_case()) {
+    case GetElementResponse::kCompressedElement: {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() =
+          std::move(*resp.mutable_compressed_element());
+      element.push_back(std::move(tensor));
+      break;
+    }
+    case GetElementResponse::kUncompressedElement:
+      for (const auto& component : resp.uncompressed_element().components()) {
+        element.emplace_back();
+        if (!element.back().FromProto(component)) {
+          return errors::DataLoss("Failed to parse an element component");
+        }
+      }
+      break;
+    default:
+      return errors::Internal("The worker response holds no element");
   }
   return Status::OK();
 }
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/shared_memory_ring.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op_kernel.h"
 
@@ -75,12 +76,14 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
       : DataServiceClientBase(address, protocol) {}
 
   // Sends a heartbeat to the dispatcher. If the worker wasn't already
-  // registered with the dispatcher, this will register the worker. The
-  // dispatcher will report which new tasks the worker should run, and which
-  // tasks it should delete. This is stored into `new_tasks` and
-  // `tasks_to_delete`.
+  // registered with the dispatcher, this will register the worker at
+  // `worker_locality`. The dispatcher will report which new tasks the worker
+  // should run, and which tasks it should delete. This is stored into
+  // `new_tasks` and `tasks_to_delete`.
   Status WorkerHeartbeat(const std::string& worker_address,
+                         const Locality& worker_locality,
                          const std::vector<int64>& current_tasks,
+                         const std::vector<TaskRunnerStats>& task_stats,
                          std::vector<TaskDef>& new_tasks,
                          std::vector<int64>& tasks_to_delete);
 
@@ -102,9 +105,11 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
 
   // Gets the job id for the job represented by the tuple
   // (job_name, job_name_index), and stores the id in `job_client_id`. If the
-  // job doesn't exist yet, it will be created.
+  // job doesn't exist yet, it will be created, starting with the workers
+  // closest to `client_locality`.
   Status GetOrCreateJob(int64 dataset_id, ProcessingMode processing_mode,
                         const absl::optional<JobKey>& job_key,
+                        const Locality& client_locality,
                         int64& job_client_id);
 
   // Releases a job client id, indicating that the id will no longer be used to
@@ -112,15 +117,21 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   Status ReleaseJobClient(int64 job_client_id);
 
   // Queries the dispatcher for the tasks associated with the specified job.
-  // The tasks will be stored in `tasks`, and whether the job is finished will
-  // be stored in `job_finished`.
-  Status GetTasks(int64 job_client_id, std::vector<TaskInfo>& tasks,
-                  bool& job_finished);
+  // The tasks will be stored in `tasks`, ordered from the closest to the
+  // farthest worker from `client_locality`, and whether the job is finished
+  // will be stored in `job_finished`.
+  Status GetTasks(int64 job_client_id, const Locality& client_locality,
+                  std::vector<TaskInfo>& tasks, bool& job_finished);
 
   // Queries the dispatcher for its registered workers. The worker info will be
   // stored in `workers`.
   Status GetWorkers(std::vector<WorkerInfo>& workers);
 
+  // Queries the dispatcher for a recommended number of workers, storing the
+  // recommendation and the statistics it is based on in `response`.
+  Status GetWorkerCountRecommendation(
+      GetWorkerCountRecommendationResponse& response);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -138,11 +149,15 @@ class DataServiceWorkerClient : public DataServiceClientBase {
                           const std::string& protocol)
       : DataServiceClientBase(address, protocol) {}
 
-  // Fetches the next element for the specified task_id. The element's
-  // compressed tensors will be stored in `element`. If no element is available,
-  // `end_of_sequence` will be `true`, and `element` will be left unchanged.
-  Status GetElement(int64 task_id, CompressedElement& element,
-                    bool& end_of_sequence);
+  // Fetches the next element for the specified task_id, and stores its
+  // components in `element`. Elements of datasets registered with compression
+  // are stored as a single scalar variant tensor holding the
+  // `CompressedElement`. If `ring` is not null, the worker may hand
+  // uncompressed elements through it instead of the response. If no element
+  // is available, `end_of_sequence` will be `true`, and `element` will be left
+  // unchanged.
+  Status GetElement(int64 task_id, SharedMemoryRing* ring,
+                    std::vector<Tensor>& element, bool& end_of_sequence);
 
  protected:
   Status EnsureInitialized() override;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/dispatcher_impl.h"
 
+#include <algorithm>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -34,8 +35,10 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/journal.h"
+#include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/hash_utils.h"
@@ -54,6 +57,11 @@ namespace {
 constexpr char kJournalDir[] = "tf_data_dispatcher_journal";
 // The name of the datasets directory inside the dispatcher's working directory.
 constexpr char kDatasetsDir[] = "datasets";
+// Defaults for the worker count recommendation.
+constexpr double kDefaultAutoscalingTargetStallRate = 0.05;
+constexpr int64 kDefaultAutoscalingWindowMs = 60 * 1000;  // 1 minute.
+// Default number of journaled updates between two state snapshots.
+constexpr int64 kDefaultJournalSnapshotInterval = 10000;
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -112,11 +120,27 @@ void PrepareGraph(GraphDef* graph) {
   }
   StripDevicePlacement(graph->mutable_library());
 }
+
+double AutoscalingTargetStallRate(
+    const experimental::DispatcherConfig& config) {
+  return config.autoscaling_target_stall_rate() > 0
+             ? config.autoscaling_target_stall_rate()
+             : kDefaultAutoscalingTargetStallRate;
+}
+
+int64 AutoscalingWindowMicros(const experimental::DispatcherConfig& config) {
+  return 1000 * (config.autoscaling_window_ms() > 0
+                     ? config.autoscaling_window_ms()
+                     : kDefaultAutoscalingWindowMs);
+}
 }  // namespace
 
 DataServiceDispatcherImpl::DataServiceDispatcherImpl(
     const experimental::DispatcherConfig& config)
-    : config_(config), env_(Env::Default()) {
+    : config_(config),
+      env_(Env::Default()),
+      autoscaler_(AutoscalingTargetStallRate(config),
+                  AutoscalingWindowMicros(config)) {
   if (config_.work_dir().empty()) {
     dataset_store_ = absl::make_unique<MemoryDatasetStore>();
   } else {
@@ -167,9 +191,16 @@ Status DataServiceDispatcherImpl::Start() {
     return s;
   } else {
     while (!end_of_journal) {
+      if (update.has_snapshot()) {
+        updates_since_snapshot_ = 0;
+      } else {
+        updates_since_snapshot_++;
+      }
       TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
       TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
     }
+    LOG(INFO) << "Restored dispatcher state from " << updates_since_snapshot_
+              << " journaled updates after the latest snapshot";
   }
   for (const auto& job : state_.ListJobs()) {
     if (job->processing_mode == ProcessingMode::DISTRIBUTED_EPOCH) {
@@ -180,6 +211,7 @@ Status DataServiceDispatcherImpl::Start() {
   // Initialize the journal writer in `Start` so that we fail fast in case it
   // can't be initialized.
   TF_RETURN_IF_ERROR(journal_writer_.value()->EnsureInitialized());
+  MaybeWriteSnapshot();
   started_ = true;
   return Status::OK();
 }
@@ -216,11 +248,14 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
       return s;
     }
     Update update;
-    update.mutable_register_worker()->set_worker_address(worker_address);
+    RegisterWorkerUpdate* register_worker = update.mutable_register_worker();
+    register_worker->set_worker_address(worker_address);
+    *register_worker->mutable_worker_locality() = request->worker_locality();
     TF_RETURN_IF_ERROR(Apply(update));
     TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
     TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, correct_tasks));
   }
+  RecordTaskStats(*request);
 
   absl::flat_hash_set<int64> current_tasks;
   current_tasks.insert(request->current_tasks().cbegin(),
@@ -450,7 +485,8 @@ Status DataServiceDispatcherImpl::GetOrCreateJob(
     int64 job_client_id;
     TF_RETURN_IF_ERROR(AcquireJobClientId(job, job_client_id));
     response->set_job_client_id(job_client_id);
-    TF_RETURN_IF_ERROR(CreateTasksForJob(job, tasks));
+    TF_RETURN_IF_ERROR(
+        CreateTasksForJob(job, request->client_locality(), tasks));
   }
   TF_RETURN_IF_ERROR(AssignTasks(tasks));
   VLOG(3) << "Created job " << job->job_id << " for CreateJob("
@@ -556,10 +592,18 @@ Status DataServiceDispatcherImpl::AcquireJobClientId(
 }
 
 Status DataServiceDispatcherImpl::CreateTasksForJob(
-    std::shared_ptr<const Job> job,
+    std::shared_ptr<const Job> job, const Locality& client_locality,
     std::vector<std::shared_ptr<const Task>>& tasks)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<std::shared_ptr<const Worker>> workers = state_.ListWorkers();
+  // Tasks are assigned in order, so the closest workers start producing
+  // elements first.
+  std::stable_sort(workers.begin(), workers.end(),
+                   [&client_locality](const std::shared_ptr<const Worker>& a,
+                                      const std::shared_ptr<const Worker>& b) {
+                     return LocalityDistance(a->locality, client_locality) <
+                            LocalityDistance(b->locality, client_locality);
+                   });
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
@@ -676,11 +720,29 @@ Status DataServiceDispatcherImpl::GetTasks(const GetTasksRequest* request,
   TF_RETURN_IF_ERROR(s);
   std::vector<std::shared_ptr<const Task>> tasks;
   TF_RETURN_IF_ERROR(state_.TasksForJob(job->job_id, tasks));
+  std::vector<TaskInfo> task_infos;
+  task_infos.reserve(tasks.size());
   for (const auto& task : tasks) {
-    TaskInfo* task_info = response->mutable_task_info()->Add();
-    task_info->set_worker_address(task->worker_address);
-    task_info->set_task_id(task->task_id);
-    task_info->set_job_id(job->job_id);
+    task_infos.emplace_back();
+    TaskInfo& task_info = task_infos.back();
+    task_info.set_worker_address(task->worker_address);
+    task_info.set_task_id(task->task_id);
+    task_info.set_job_id(job->job_id);
+    std::shared_ptr<const Worker> worker;
+    if (state_.WorkerFromAddress(task->worker_address, worker).ok()) {
+      *task_info.mutable_worker_locality() = worker->locality;
+    }
+  }
+  const Locality& client_locality = request->client_locality();
+  std::stable_sort(task_infos.begin(), task_infos.end(),
+                   [&client_locality](const TaskInfo& a, const TaskInfo& b) {
+                     return LocalityDistance(a.worker_locality(),
+                                             client_locality) <
+                            LocalityDistance(b.worker_locality(),
+                                             client_locality);
+                   });
+  for (auto& task_info : task_infos) {
+    *response->add_task_info() = std::move(task_info);
   }
   response->set_job_finished(job->finished);
   VLOG(3) << "Found " << response->task_info_size()
@@ -697,12 +759,45 @@ Status DataServiceDispatcherImpl::GetWorkers(const GetWorkersRequest* request,
   for (const auto& worker : workers) {
     WorkerInfo* info = response->add_workers();
     info->set_address(worker->address);
+    *info->mutable_locality() = worker->locality;
   }
   VLOG(3) << "Returning list of " << response->workers_size()
           << " workers from GetWorkers";
   return Status::OK();
 }
 
+Status DataServiceDispatcherImpl::GetWorkerCountRecommendation(
+    const GetWorkerCountRecommendationRequest* request,
+    GetWorkerCountRecommendationResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  autoscaler_.GetRecommendation(state_.ListWorkers().size(), env_->NowMicros(),
+                                *response);
+  VLOG(3) << "Recommending " << response->recommended_num_workers()
+          << " workers, currently " << response->current_num_workers();
+  return Status::OK();
+}
+
+void DataServiceDispatcherImpl::RecordTaskStats(
+    const WorkerHeartbeatRequest& request) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64 now_micros = env_->NowMicros();
+  for (const TaskRunnerStats& stats : request.task_stats()) {
+    if (stats.num_requests() == 0) {
+      continue;
+    }
+    std::shared_ptr<const Task> task;
+    if (!state_.TaskFromId(stats.task_id(), task).ok()) {
+      continue;
+    }
+    autoscaler_.RecordTaskStats(task->job->job_id, request.worker_address(),
+                                stats, now_micros);
+    metrics::RecordTFDataServiceTaskStats(
+        static_cast<double>(stats.num_stalls()) / stats.num_requests(),
+        static_cast<double>(stats.wait_time_micros()) / stats.num_requests(),
+        stats.buffer_occupancy_sum() / stats.num_requests());
+  }
+}
+
 Status DataServiceDispatcherImpl::CheckStarted() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   if (!started_) {
@@ -732,8 +827,34 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    updates_since_snapshot_++;
   }
-  return state_.Apply(update);
+  TF_RETURN_IF_ERROR(state_.Apply(update));
+  MaybeWriteSnapshot();
+  return Status::OK();
+}
+
+void DataServiceDispatcherImpl::MaybeWriteSnapshot()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64 interval = config_.journal_snapshot_interval() == 0
+                             ? kDefaultJournalSnapshotInterval
+                             : config_.journal_snapshot_interval();
+  if (!journal_writer_.has_value() || interval < 0 ||
+      updates_since_snapshot_ < interval) {
+    return;
+  }
+  Update update;
+  state_.Snapshot(*update.mutable_snapshot());
+  Status s = journal_writer_.value()->WriteSnapshot(update);
+  if (!s.ok()) {
+    // The journal stays valid without the snapshot; retry after another
+    // interval.
+    LOG(WARNING) << "Failed to write dispatcher state snapshot: " << s;
+  } else {
+    VLOG(1) << "Wrote dispatcher state snapshot replacing "
+            << updates_since_snapshot_ << " journaled updates";
+  }
+  updates_since_snapshot_ = 0;
 }
 
 void DataServiceDispatcherImpl::JobGcThread() {
@@ -752,6 +873,11 @@ void DataServiceDispatcherImpl::JobGcThread() {
     if (!s.ok()) {
       LOG(WARNING) << "Error garbage collecting old jobs: " << s;
     }
+    GetWorkerCountRecommendationResponse recommendation;
+    autoscaler_.GetRecommendation(state_.ListWorkers().size(),
+                                  env_->NowMicros(), recommendation);
+    metrics::RecordTFDataServiceRecommendedWorkers(
+        recommendation.recommended_num_workers());
     next_check_micros =
         env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
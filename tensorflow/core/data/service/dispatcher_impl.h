@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_IMPL_H_
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/service/autoscaler.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/dataset_store.h"
@@ -75,6 +76,9 @@ class DataServiceDispatcherImpl {
   Status GetTasks(const GetTasksRequest* request, GetTasksResponse* response);
   Status GetWorkers(const GetWorkersRequest* request,
                     GetWorkersResponse* response);
+  Status GetWorkerCountRecommendation(
+      const GetWorkerCountRecommendationRequest* request,
+      GetWorkerCountRecommendationResponse* response);
 
  private:
   // Restores a `SplitProvider` from the state in `job` and stores it in
@@ -112,10 +116,12 @@ class DataServiceDispatcherImpl {
       const std::shared_ptr<const DispatcherState::Job>& job,
       int64& job_client_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Creates one task for each worker, for the given job. The created tasks are
-  // stored in `tasks`. This method only updates dispatcher metadata with the
+  // stored in `tasks`, ordered from the closest to the farthest worker from
+  // `client_locality`. This method only updates dispatcher metadata with the
   // new tasks, but doesn't assign the tasks to the workers.
   Status CreateTasksForJob(
       std::shared_ptr<const DispatcherState::Job> job,
+      const Locality& client_locality,
       std::vector<std::shared_ptr<const DispatcherState::Task>>& tasks)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -151,6 +157,13 @@ class DataServiceDispatcherImpl {
   void JobGcThread();
   // Scans for old jobs and marks them as finished.
   Status GcOldJobs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Writes a snapshot of `state_` to the journal once
+  // `journal_snapshot_interval` updates have been journaled since the last
+  // one, which truncates the journal replayed on restart.
+  void MaybeWriteSnapshot() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Feeds the task statistics of a worker heartbeat to `autoscaler_`.
+  void RecordTaskStats(const WorkerHeartbeatRequest& request)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Gets a `DatasetDef` from `dataset_store_` for the given dataset id, and
   // stores it in `dataset_def`.
   Status GetDatasetDef(int64 dataset_id,
@@ -181,7 +194,12 @@ class DataServiceDispatcherImpl {
 
   absl::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // Number of updates in the journal since the last snapshot.
+  int64 updates_since_snapshot_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
+  // Recommends a number of workers from the workers' task statistics. Not
+  // journaled, since the statistics are only relevant for a short window.
+  Autoscaler autoscaler_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the job gc thread.
   condition_variable job_gc_thread_cv_;
   std::unique_ptr<Thread> job_gc_thread_;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/dispatcher_state.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "tensorflow/core/data/service/journal.h"
@@ -51,6 +52,9 @@ Status DispatcherState::Apply(const Update& update) {
     case Update::kFinishTask:
       FinishTask(update.finish_task());
       break;
+    case Update::kSnapshot:
+      RestoreSnapshot(update.snapshot());
+      break;
     case Update::UPDATE_TYPE_NOT_SET:
       return errors::Internal("Update type not set.");
   }
@@ -74,7 +78,8 @@ void DispatcherState::RegisterWorker(
     const RegisterWorkerUpdate& register_worker) {
   std::string address = register_worker.worker_address();
   DCHECK(!workers_.contains(address));
-  workers_[address] = std::make_shared<Worker>(address);
+  workers_[address] =
+      std::make_shared<Worker>(address, register_worker.worker_locality());
   tasks_by_worker_[address] =
       absl::flat_hash_map<int64, std::shared_ptr<Task>>();
 }
@@ -169,6 +174,122 @@ void DispatcherState::FinishTask(const FinishTaskUpdate& finish_task) {
   jobs_[task->job->job_id]->finished = all_finished;
 }
 
+void DispatcherState::Snapshot(DispatcherStateSnapshot& snapshot) const {
+  snapshot.Clear();
+  snapshot.set_next_available_dataset_id(next_available_dataset_id_);
+  snapshot.set_next_available_job_id(next_available_job_id_);
+  snapshot.set_next_available_job_client_id(next_available_job_client_id_);
+  snapshot.set_next_available_task_id(next_available_task_id_);
+  for (const auto& dataset : datasets_by_id_) {
+    RegisterDatasetUpdate* register_dataset = snapshot.add_datasets();
+    register_dataset->set_dataset_id(dataset.second->dataset_id);
+    register_dataset->set_fingerprint(dataset.second->fingerprint);
+  }
+  for (const auto& worker : workers_) {
+    RegisterWorkerUpdate* register_worker = snapshot.add_workers();
+    register_worker->set_worker_address(worker.second->address);
+    *register_worker->mutable_worker_locality() = worker.second->locality;
+  }
+  for (const auto& it : jobs_) {
+    const Job& job = *it.second;
+    DispatcherStateSnapshot::Job* job_snapshot = snapshot.add_jobs();
+    CreateJobUpdate* create_job = job_snapshot->mutable_create_job();
+    create_job->set_job_id(job.job_id);
+    create_job->set_dataset_id(job.dataset_id);
+    create_job->set_processing_mode(ProcessingModeDef(job.processing_mode));
+    if (job.named_job_key.has_value()) {
+      NamedJobKeyDef* key = create_job->mutable_named_job_key();
+      key->set_name(job.named_job_key->name);
+      key->set_index(job.named_job_key->index);
+    }
+    if (job.num_consumers.has_value()) {
+      create_job->set_num_consumers(job.num_consumers.value());
+    }
+    if (job.distributed_epoch_state.has_value()) {
+      job_snapshot->set_repetition(job.distributed_epoch_state->repetition);
+      job_snapshot->set_split_provider_index(
+          job.distributed_epoch_state->split_provider_index);
+    }
+    job_snapshot->set_num_clients(job.num_clients);
+    job_snapshot->set_last_client_released_micros(
+        job.last_client_released_micros);
+    job_snapshot->set_finished(job.finished);
+  }
+  std::vector<std::shared_ptr<Task>> tasks;
+  tasks.reserve(tasks_.size());
+  for (const auto& task : tasks_) {
+    tasks.push_back(task.second);
+  }
+  // Keeps the order of the tasks of each job.
+  std::sort(tasks.begin(), tasks.end(),
+            [](const std::shared_ptr<Task>& a, const std::shared_ptr<Task>& b) {
+              return a->task_id < b->task_id;
+            });
+  for (const auto& task : tasks) {
+    DispatcherStateSnapshot::Task* task_snapshot = snapshot.add_tasks();
+    CreateTaskUpdate* create_task = task_snapshot->mutable_create_task();
+    create_task->set_task_id(task->task_id);
+    create_task->set_job_id(task->job->job_id);
+    create_task->set_worker_address(task->worker_address);
+    task_snapshot->set_finished(task->finished);
+  }
+  for (const auto& job_client : jobs_for_client_ids_) {
+    AcquireJobClientUpdate* acquire_job_client = snapshot.add_job_clients();
+    acquire_job_client->set_job_client_id(job_client.first);
+    acquire_job_client->set_job_id(job_client.second->job_id);
+  }
+}
+
+void DispatcherState::RestoreSnapshot(const DispatcherStateSnapshot& snapshot) {
+  VLOG(1) << "Restoring dispatcher state snapshot with "
+          << snapshot.jobs_size() << " jobs and " << snapshot.tasks_size()
+          << " tasks";
+  datasets_by_id_.clear();
+  datasets_by_fingerprint_.clear();
+  workers_.clear();
+  jobs_.clear();
+  named_jobs_.clear();
+  jobs_for_client_ids_.clear();
+  tasks_.clear();
+  tasks_by_job_.clear();
+  tasks_by_worker_.clear();
+  for (const auto& register_dataset : snapshot.datasets()) {
+    RegisterDataset(register_dataset);
+  }
+  for (const auto& register_worker : snapshot.workers()) {
+    RegisterWorker(register_worker);
+  }
+  for (const auto& job_snapshot : snapshot.jobs()) {
+    CreateJob(job_snapshot.create_job());
+    Job& job = *jobs_[job_snapshot.create_job().job_id()];
+    if (job.distributed_epoch_state.has_value()) {
+      job.distributed_epoch_state->repetition = job_snapshot.repetition();
+      job.distributed_epoch_state->split_provider_index =
+          job_snapshot.split_provider_index();
+    }
+    job.num_clients = job_snapshot.num_clients();
+    job.last_client_released_micros =
+        job_snapshot.last_client_released_micros();
+    job.finished = job_snapshot.finished();
+  }
+  for (const auto& task_snapshot : snapshot.tasks()) {
+    CreateTask(task_snapshot.create_task());
+    if (task_snapshot.finished()) {
+      Task& task = *tasks_[task_snapshot.create_task().task_id()];
+      task.finished = true;
+      tasks_by_worker_[task.worker_address].erase(task.task_id);
+    }
+  }
+  for (const auto& job_client : snapshot.job_clients()) {
+    jobs_for_client_ids_[job_client.job_client_id()] =
+        jobs_[job_client.job_id()];
+  }
+  next_available_dataset_id_ = snapshot.next_available_dataset_id();
+  next_available_job_id_ = snapshot.next_available_job_id();
+  next_available_job_client_id_ = snapshot.next_available_job_client_id();
+  next_available_task_id_ = snapshot.next_available_task_id();
+}
+
 int64 DispatcherState::NextAvailableDatasetId() const {
   return next_available_dataset_id_;
 }
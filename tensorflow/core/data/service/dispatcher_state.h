@@ -58,6 +58,10 @@ class DispatcherState {
   // Applies the given update to the dispatcher's state.
   Status Apply(const Update& update);
 
+  // Stores the complete state in `snapshot`. Applying an update holding the
+  // snapshot to a new `DispatcherState` restores the same state.
+  void Snapshot(DispatcherStateSnapshot& snapshot) const;
+
   // A dataset registered with the dispatcher.
   struct Dataset {
     explicit Dataset(int64 dataset_id, int64 fingerprint)
@@ -69,9 +73,11 @@ class DispatcherState {
 
   // A worker registered with the dispatcher.
   struct Worker {
-    explicit Worker(const std::string& address) : address(address) {}
+    explicit Worker(const std::string& address, const Locality& locality)
+        : address(address), locality(locality) {}
 
     const std::string address;
+    const Locality locality;
   };
 
   // A key for identifying a named job. The key contains a user-specified name,
@@ -190,6 +196,7 @@ class DispatcherState {
   void ReleaseJobClient(const ReleaseJobClientUpdate& release_job_client);
   void CreateTask(const CreateTaskUpdate& create_task);
   void FinishTask(const FinishTaskUpdate& finish_task);
+  void RestoreSnapshot(const DispatcherStateSnapshot& snapshot);
 
   int64 next_available_dataset_id_ = 1000;
   // Registered datasets, keyed by dataset ids.
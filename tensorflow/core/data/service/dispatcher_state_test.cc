@@ -174,6 +174,22 @@ TEST(DispatcherState, RegisterWorker) {
   EXPECT_EQ(worker->address, address);
 }
 
+TEST(DispatcherState, RegisterWorkerWithLocality) {
+  DispatcherState state;
+  std::string address = "test_worker_address";
+  Update update;
+  RegisterWorkerUpdate* register_worker = update.mutable_register_worker();
+  register_worker->set_worker_address(address);
+  register_worker->mutable_worker_locality()->set_host("test_host");
+  register_worker->mutable_worker_locality()->set_rack("test_rack");
+  TF_EXPECT_OK(state.Apply(update));
+  std::shared_ptr<const Worker> worker;
+  TF_EXPECT_OK(state.WorkerFromAddress(address, worker));
+  EXPECT_EQ(worker->locality.host(), "test_host");
+  EXPECT_EQ(worker->locality.rack(), "test_rack");
+  EXPECT_EQ(worker->locality.zone(), "");
+}
+
 TEST(DispatcherState, ListWorkers) {
   DispatcherState state;
   std::string address_1 = "address_1";
@@ -473,5 +489,61 @@ TEST(DispatcherState, ReleaseJobClientId) {
   EXPECT_EQ(s.code(), error::NOT_FOUND);
 }
 
+TEST(DispatcherState, RestoreSnapshot) {
+  int64 dataset_id = 10;
+  int64 job_id_1 = 3;
+  int64 job_id_2 = 4;
+  int64 job_client_id = 6;
+  std::string worker_address = "test_worker_address";
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset(dataset_id, state));
+  TF_EXPECT_OK(RegisterWorker(worker_address, state));
+  TF_EXPECT_OK(CreateAnonymousJob(job_id_1, dataset_id, state));
+  TF_EXPECT_OK(CreateNamedJob(job_id_2, dataset_id, NamedJobKey("job", 1),
+                              state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/7, job_id_1, worker_address, state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/8, job_id_2, worker_address, state));
+  TF_EXPECT_OK(FinishTask(/*task_id=*/7, state));
+  TF_EXPECT_OK(AcquireJobClientId(job_id_2, job_client_id, state));
+
+  Update update;
+  state.Snapshot(*update.mutable_snapshot());
+  DispatcherState restored;
+  // Applying a snapshot replaces any previous state.
+  TF_EXPECT_OK(RegisterDataset(/*id=*/20, /*fingerprint=*/2, restored));
+  TF_EXPECT_OK(restored.Apply(update));
+
+  std::shared_ptr<const Dataset> dataset;
+  EXPECT_EQ(restored.DatasetFromId(20, dataset).code(), error::NOT_FOUND);
+  TF_EXPECT_OK(restored.DatasetFromId(dataset_id, dataset));
+  EXPECT_EQ(restored.NextAvailableDatasetId(), state.NextAvailableDatasetId());
+  EXPECT_EQ(restored.NextAvailableJobId(), state.NextAvailableJobId());
+  EXPECT_EQ(restored.NextAvailableJobClientId(),
+            state.NextAvailableJobClientId());
+  EXPECT_EQ(restored.NextAvailableTaskId(), state.NextAvailableTaskId());
+  std::shared_ptr<const Job> job;
+  TF_EXPECT_OK(restored.JobFromId(job_id_1, job));
+  EXPECT_TRUE(job->finished);
+  TF_EXPECT_OK(restored.NamedJobByKey(NamedJobKey("job", 1), job));
+  EXPECT_EQ(job->job_id, job_id_2);
+  EXPECT_EQ(job->num_clients, 1);
+  EXPECT_FALSE(job->finished);
+  TF_EXPECT_OK(restored.JobForJobClientId(job_client_id, job));
+  EXPECT_EQ(job->job_id, job_id_2);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_EXPECT_OK(restored.TasksForWorker(worker_address, tasks));
+  ASSERT_EQ(tasks.size(), 1);
+  EXPECT_EQ(tasks[0]->task_id, 8);
+
+  // Snapshotting the restored state gives the same snapshot.
+  Update restored_update;
+  restored.Snapshot(*restored_update.mutable_snapshot());
+  DispatcherState restored_twice;
+  TF_EXPECT_OK(restored_twice.Apply(restored_update));
+  std::shared_ptr<const Task> task;
+  TF_EXPECT_OK(restored_twice.TaskFromId(7, task));
+  EXPECT_TRUE(task->finished);
+}
+
 }  // namespace data
 }  // namespace tensorflow
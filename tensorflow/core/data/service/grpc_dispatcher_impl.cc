@@ -49,6 +49,7 @@ HANDLER(ReleaseJobClient);
 HANDLER(GetOrCreateJob);
 HANDLER(GetTasks);
 HANDLER(GetWorkers);
+HANDLER(GetWorkerCountRecommendation);
 #undef HANDLER
 
 }  // namespace data
@@ -48,6 +48,7 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(GetOrCreateJob);
   HANDLER(GetTasks);
   HANDLER(GetWorkers);
+  HANDLER(GetWorkerCountRecommendation);
 #undef HANDLER
 
  private:
@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/journal.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -29,6 +34,8 @@ namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+// Suffix of a snapshot journal file which is still being written.
+constexpr StringPiece kTempSuffix = ".tmp";
 
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64* sequence_number) {
@@ -38,6 +45,34 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return Status::OK();
 }
+
+// Stores the sequence numbers of the journal files in `journal_dir`, skipping
+// incomplete snapshots.
+Status ListSequenceNumbers(Env* env, const std::string& journal_dir,
+                           std::vector<int64>& sequence_numbers) {
+  std::vector<std::string> journal_files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &journal_files));
+  sequence_numbers.clear();
+  for (const auto& file : journal_files) {
+    if (absl::EndsWith(file, kTempSuffix)) {
+      continue;
+    }
+    int64 sequence_number;
+    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
+    sequence_numbers.push_back(sequence_number);
+  }
+  std::sort(sequence_numbers.begin(), sequence_numbers.end());
+  return Status::OK();
+}
+
+Status WriteRecord(const Update& update, io::RecordWriter& writer) {
+  std::string s = update.SerializeAsString();
+  if (s.empty()) {
+    return errors::Internal("Failed to serialize update ", update.DebugString(),
+                            " to string");
+  }
+  return writer.WriteRecord(s);
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -53,17 +88,17 @@ Status FileJournalWriter::EnsureInitialized() {
   if (writer_) {
     return Status::OK();
   }
-  std::vector<std::string> journal_files;
   TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(journal_dir_));
-  TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &journal_files));
-  int64 latest_sequence_number = -1;
-  for (const auto& file : journal_files) {
-    int64 sequence_number;
-    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
-    latest_sequence_number = std::max(latest_sequence_number, sequence_number);
-  }
+  std::vector<int64> sequence_numbers;
+  TF_RETURN_IF_ERROR(
+      ListSequenceNumbers(env_, journal_dir_, sequence_numbers));
+  int64 latest_sequence_number =
+      sequence_numbers.empty() ? -1 : sequence_numbers.back();
+  // Snapshots may have been written since the files were listed.
+  latest_sequence_number = std::max(latest_sequence_number, sequence_number_);
+  sequence_number_ = latest_sequence_number + 1;
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number_);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = absl::make_unique<io::RecordWriter>(file_.get());
   VLOG(1) << "Created journal writer to write to " << journal_file;
@@ -72,12 +107,7 @@ Status FileJournalWriter::EnsureInitialized() {
 
 Status FileJournalWriter::Write(const Update& update) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
-  std::string s = update.SerializeAsString();
-  if (s.empty()) {
-    return errors::Internal("Failed to serialize update ", update.DebugString(),
-                            " to string");
-  }
-  TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
+  TF_RETURN_IF_ERROR(WriteRecord(update, *writer_));
   TF_RETURN_IF_ERROR(writer_->Flush());
   TF_RETURN_IF_ERROR(file_->Sync());
   if (VLOG_IS_ON(4)) {
@@ -86,6 +116,51 @@ Status FileJournalWriter::Write(const Update& update) {
   return Status::OK();
 }
 
+Status FileJournalWriter::WriteSnapshot(const Update& snapshot) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_RETURN_IF_ERROR(Close());
+  const int64 snapshot_sequence_number = sequence_number_ + 1;
+  const std::string journal_file =
+      DataServiceJournalFile(journal_dir_, snapshot_sequence_number);
+  const std::string temp_file = absl::StrCat(journal_file, kTempSuffix);
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(temp_file, &file));
+    io::RecordWriter writer(file.get());
+    TF_RETURN_IF_ERROR(WriteRecord(snapshot, writer));
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Sync());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  TF_RETURN_IF_ERROR(env_->RenameFile(temp_file, journal_file));
+  sequence_number_ = snapshot_sequence_number;
+  std::vector<int64> sequence_numbers;
+  TF_RETURN_IF_ERROR(
+      ListSequenceNumbers(env_, journal_dir_, sequence_numbers));
+  for (int64 sequence_number : sequence_numbers) {
+    if (sequence_number < snapshot_sequence_number) {
+      TF_RETURN_IF_ERROR(env_->DeleteFile(
+          DataServiceJournalFile(journal_dir_, sequence_number)));
+    }
+  }
+  // Subsequent updates are appended to the snapshot file.
+  TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
+  writer_ = absl::make_unique<io::RecordWriter>(file_.get());
+  VLOG(1) << "Wrote dispatcher state snapshot to " << journal_file;
+  return Status::OK();
+}
+
+Status FileJournalWriter::Close() {
+  if (!writer_) {
+    return Status::OK();
+  }
+  Status s = writer_->Close();
+  writer_.reset();
+  s.Update(file_->Close());
+  file_.reset();
+  return s;
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -93,7 +168,14 @@ Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return Status::OK();
   }
-  return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  std::vector<int64> sequence_numbers;
+  TF_RETURN_IF_ERROR(
+      ListSequenceNumbers(env_, journal_dir_, sequence_numbers));
+  if (sequence_numbers.empty()) {
+    return errors::NotFound("No journal files found in ", journal_dir_);
+  }
+  sequence_number_ = sequence_numbers.front();
+  return UpdateFile(DataServiceJournalFile(journal_dir_, sequence_number_));
 }
 
 Status FileJournalReader::Read(Update& update, bool& end_of_journal) {
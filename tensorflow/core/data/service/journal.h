@@ -34,6 +34,9 @@ class JournalWriter {
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Writes `snapshot`, an update holding a `DispatcherStateSnapshot`, and
+  // discards the part of the journal written before it.
+  virtual Status WriteSnapshot(const Update& snapshot) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
@@ -54,6 +57,11 @@ class JournalWriter {
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
 // can be stored durably in case of machine failure.
+//
+// A snapshot starts a new journal file. It is first written to a temporary
+// file which is renamed once complete, after which the journal files before it
+// are deleted. If the writer fails in between, the reader still finds the old
+// files, followed by the snapshot which replaces the state they describe.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -64,11 +72,17 @@ class FileJournalWriter : public JournalWriter {
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
 
   Status Write(const Update& update) override;
+  Status WriteSnapshot(const Update& snapshot) override;
   Status EnsureInitialized() override;
 
  private:
+  // Closes the current journal file, so that the next write starts a new one.
+  Status Close();
+
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of the current journal file.
+  int64 sequence_number_ = -1;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -86,7 +100,8 @@ class JournalReader {
 // used by multiple threads.
 //
 // The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// directory, in order of their sequence numbers, starting from the oldest file
+// remaining after snapshots. See FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
   explicit FileJournalReader(Env* env, StringPiece journal_dir);
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/journal.h"
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -109,6 +110,45 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, WriteSnapshot) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeCreateJobUpdate()));
+  TF_EXPECT_OK(writer.Write(MakeRegisterDatasetUpdate()));
+  Update snapshot;
+  snapshot.mutable_snapshot()->set_next_available_job_id(9);
+  TF_EXPECT_OK(writer.WriteSnapshot(snapshot));
+  TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+
+  // The journal before the snapshot is deleted.
+  std::vector<std::string> journal_files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(journal_dir, &journal_files));
+  EXPECT_EQ(journal_files.size(), 1);
+  TF_EXPECT_OK(
+      CheckJournalContent(journal_dir, {snapshot, MakeFinishTaskUpdate()}));
+
+  // A new writer appends after the snapshot.
+  FileJournalWriter new_writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(new_writer.Write(MakeCreateJobUpdate()));
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir,
+      {snapshot, MakeFinishTaskUpdate(), MakeCreateJobUpdate()}));
+}
+
+TEST(Journal, IgnoreIncompleteSnapshot) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeCreateJobUpdate()));
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(),
+      absl::StrCat(DataServiceJournalFile(journal_dir, 1), ".tmp"),
+      "incomplete snapshot"));
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, {MakeCreateJobUpdate()}));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
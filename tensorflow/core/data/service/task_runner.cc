@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/task_runner.h"
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/errors.h"
@@ -45,14 +46,96 @@ Status TaskRunner::Create(const TaskDef& task_def,
   return Status::OK();
 }
 
+TaskRunnerStats TaskRunner::TakeStats() TF_LOCKS_EXCLUDED(stats_mu_) {
+  mutex_lock l(stats_mu_);
+  TaskRunnerStats stats = stats_;
+  stats_.Clear();
+  return stats;
+}
+
+void TaskRunner::RecordRequest(int64 wait_micros, bool stalled,
+                               double buffer_occupancy)
+    TF_LOCKS_EXCLUDED(stats_mu_) {
+  mutex_lock l(stats_mu_);
+  stats_.set_num_requests(stats_.num_requests() + 1);
+  if (stalled) {
+    stats_.set_num_stalls(stats_.num_stalls() + 1);
+  }
+  stats_.set_wait_time_micros(stats_.wait_time_micros() + wait_micros);
+  stats_.set_buffer_occupancy_sum(stats_.buffer_occupancy_sum() +
+                                  buffer_occupancy);
+}
+
+constexpr int64 FirstComeFirstServedTaskRunner::kPrefetchBufferSize;
+
 FirstComeFirstServedTaskRunner::FirstComeFirstServedTaskRunner(
     std::unique_ptr<TaskIterator> iterator)
     : iterator_(std::move(iterator)) {}
 
+FirstComeFirstServedTaskRunner::~FirstComeFirstServedTaskRunner() {
+  std::unique_ptr<Thread> prefetch_thread;
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cv_.notify_all();
+    prefetch_thread = std::move(prefetch_thread_);
+  }
+  // Joins the thread, which exits once its current `GetNext` call returns.
+  prefetch_thread.reset();
+}
+
 Status FirstComeFirstServedTaskRunner::GetNext(const Request& request,
                                                std::vector<Tensor>& element,
                                                bool& end_of_task) {
-  return iterator_->GetNext(element, end_of_task);
+  const uint64 start_micros = Env::Default()->NowMicros();
+  mutex_lock l(mu_);
+  if (!prefetch_thread_ && !end_of_task_) {
+    prefetch_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf-data-service-task-prefetch", [this] { PrefetchThread(); }));
+  }
+  const bool stalled = buffer_.empty() && !end_of_task_;
+  const double buffer_occupancy =
+      static_cast<double>(buffer_.size()) / kPrefetchBufferSize;
+  while (buffer_.empty() && !end_of_task_) {
+    cv_.wait(l);
+  }
+  RecordRequest(Env::Default()->NowMicros() - start_micros, stalled,
+                buffer_occupancy);
+  if (buffer_.empty()) {
+    end_of_task = true;
+    return status_;
+  }
+  element = std::move(buffer_.front());
+  buffer_.pop_front();
+  end_of_task = false;
+  cv_.notify_all();
+  return Status::OK();
+}
+
+void FirstComeFirstServedTaskRunner::PrefetchThread() TF_LOCKS_EXCLUDED(mu_) {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && buffer_.size() >= kPrefetchBufferSize) {
+        cv_.wait(l);
+      }
+      if (cancelled_) {
+        return;
+      }
+    }
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    Status s = iterator_->GetNext(element, end_of_sequence);
+    mutex_lock l(mu_);
+    if (!s.ok() || end_of_sequence) {
+      status_ = s;
+      end_of_task_ = true;
+      cv_.notify_all();
+      return;
+    }
+    buffer_.push_back(std::move(element));
+    cv_.notify_all();
+  }
 }
 
 RoundRobinTaskRunner::RoundRobinTaskRunner(
@@ -75,7 +158,14 @@ Status RoundRobinTaskRunner::GetNext(const Request& request,
         ", but the task is configured for only ", num_consumers_, " consumers");
   }
 
+  const uint64 start_micros = Env::Default()->NowMicros();
   mutex_lock l(mu_);
+  // The element is ready if its round has already been buffered.
+  const bool stalled = current_round_ < request.round_index;
+  auto record_request = gtl::MakeCleanup([&] {
+    RecordRequest(Env::Default()->NowMicros() - start_micros, stalled,
+                  stalled ? 0.0 : 1.0);
+  });
   absl::flat_hash_set<int64>& round = requests_[request.round_index];
   first_round_ = std::min(first_round_, request.round_index);
   round.insert(request.consumer_index);
@@ -15,9 +15,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 
+#include <deque>
+
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -73,19 +78,55 @@ class TaskRunner {
   // `element` and `end_of_task`.
   virtual Status GetNext(const Request& request, std::vector<Tensor>& element,
                          bool& end_of_task) = 0;
+
+  // Returns the statistics of the requests served since the last call to
+  // `TakeStats`, and resets them. Workers report them to the dispatcher in
+  // their heartbeats.
+  TaskRunnerStats TakeStats() TF_LOCKS_EXCLUDED(stats_mu_);
+
+ protected:
+  // Records a request which waited `wait_micros` for its element. `stalled`
+  // indicates that no element was ready when the request arrived, and
+  // `buffer_occupancy` is the fraction of the runner's buffer that was full.
+  void RecordRequest(int64 wait_micros, bool stalled, double buffer_occupancy)
+      TF_LOCKS_EXCLUDED(stats_mu_);
+
+ private:
+  mutex stats_mu_;
+  TaskRunnerStats stats_ TF_GUARDED_BY(stats_mu_);
 };
 
 // A task runner which provides elements on a first-come first-served basis.
 // It does not consider which consumer is making the request.
+//
+// Once the first element is requested, a background thread keeps a buffer of
+// up to `kPrefetchBufferSize` elements ahead of the consumers, so that the
+// buffer occupancy tells whether the worker keeps up with its consumers.
 class FirstComeFirstServedTaskRunner : public TaskRunner {
  public:
+  static constexpr int64 kPrefetchBufferSize = 2;
+
   explicit FirstComeFirstServedTaskRunner(
       std::unique_ptr<TaskIterator> iterator);
+  ~FirstComeFirstServedTaskRunner() override;
   Status GetNext(const Request& request, std::vector<Tensor>& element,
                  bool& end_of_task) override;
 
  private:
+  void PrefetchThread() TF_LOCKS_EXCLUDED(mu_);
+
   std::unique_ptr<TaskIterator> iterator_;
+  mutex mu_;
+  // Notified when an element is added to or removed from `buffer_`, and on
+  // cancellation.
+  condition_variable cv_;
+  std::deque<std::vector<Tensor>> buffer_ TF_GUARDED_BY(mu_);
+  // Set once the iterator returned end of sequence or an error, after which
+  // the prefetch thread exits.
+  bool end_of_task_ TF_GUARDED_BY(mu_) = false;
+  Status status_ TF_GUARDED_BY(mu_);
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(mu_);
 };
 
 // A task runner which enforces round-robin order for consuming a task's
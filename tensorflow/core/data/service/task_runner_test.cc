@@ -84,6 +84,30 @@ TEST(FirstComeFirstServedTaskRunner, GetNext) {
   }
 }
 
+TEST(FirstComeFirstServedTaskRunner, TakeStats) {
+  std::vector<std::vector<Tensor>> elements;
+  for (int64 i = 0; i < 3; ++i) {
+    std::vector<Tensor> element;
+    element.push_back(Tensor(i));
+    elements.push_back(element);
+  }
+  FirstComeFirstServedTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements));
+  TaskRunner::Request request;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(runner.GetNext(request, element, end_of_sequence));
+  }
+  TaskRunnerStats stats = runner.TakeStats();
+  EXPECT_EQ(stats.num_requests(), 4);
+  // The first request always waits for the prefetch thread.
+  EXPECT_GE(stats.num_stalls(), 1);
+  EXPECT_LE(stats.buffer_occupancy_sum(), stats.num_requests());
+  // Taking the stats resets them.
+  EXPECT_EQ(runner.TakeStats().num_requests(), 0);
+}
+
 class ConsumeParallelTest
     : public ::testing::Test,
       public ::testing::WithParamInterface<std::tuple<int64, int64>> {};
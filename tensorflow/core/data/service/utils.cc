@@ -20,7 +20,9 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -50,5 +52,36 @@ Status ReadDatasetDef(const std::string& path, DatasetDef& dataset_def) {
   return Status::OK();
 }
 
+Locality LocalLocality() {
+  Locality locality;
+  locality.set_host(port::Hostname());
+  std::string label;
+  Status s = ReadStringFromEnvVar("TF_DATA_SERVICE_RACK", "", &label);
+  if (s.ok()) {
+    locality.set_rack(label);
+  }
+  s = ReadStringFromEnvVar("TF_DATA_SERVICE_ZONE", "", &label);
+  if (s.ok()) {
+    locality.set_zone(label);
+  }
+  return locality;
+}
+
+int64 LocalityDistance(const Locality& a, const Locality& b) {
+  auto matches = [](const std::string& x, const std::string& y) {
+    return !x.empty() && x == y;
+  };
+  if (matches(a.host(), b.host())) {
+    return kSameHost;
+  }
+  if (matches(a.rack(), b.rack())) {
+    return kSameRack;
+  }
+  if (matches(a.zone(), b.zone())) {
+    return kSameZone;
+  }
+  return kRemote;
+}
+
 }  // namespace data
 }  // namespace tensorflow
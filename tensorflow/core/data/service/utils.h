@@ -32,6 +32,21 @@ Status WriteDatasetDef(const std::string& path, const DatasetDef& dataset_def);
 // `dataset_def`. Returns NOT_FOUND if the path cannot be found.
 Status ReadDatasetDef(const std::string& path, DatasetDef& dataset_def);
 
+// Distances between two localities, from the closest to the farthest.
+constexpr int64 kSameHost = 0;
+constexpr int64 kSameRack = 1;
+constexpr int64 kSameZone = 2;
+constexpr int64 kRemote = 3;
+
+// Returns the locality of this process. The host is the hostname of the
+// machine, and the rack and zone are read from the `TF_DATA_SERVICE_RACK` and
+// `TF_DATA_SERVICE_ZONE` environment variables.
+Locality LocalLocality();
+
+// Returns the distance between two localities. Labels that are unknown in
+// either locality never match.
+int64 LocalityDistance(const Locality& a, const Locality& b);
+
 }  // namespace data
 }  // namespace tensorflow
 
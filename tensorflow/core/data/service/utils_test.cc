@@ -66,5 +66,22 @@ TEST(Utils, ReadDatasetNotFound) {
   EXPECT_EQ(s.code(), error::NOT_FOUND);
 }
 
+TEST(Utils, LocalityDistance) {
+  Locality a;
+  a.set_host("host_a");
+  a.set_rack("rack_a");
+  a.set_zone("zone_a");
+  Locality b = a;
+  EXPECT_EQ(LocalityDistance(a, b), kSameHost);
+  b.set_host("host_b");
+  EXPECT_EQ(LocalityDistance(a, b), kSameRack);
+  b.set_rack("rack_b");
+  EXPECT_EQ(LocalityDistance(a, b), kSameZone);
+  b.set_zone("zone_b");
+  EXPECT_EQ(LocalityDistance(a, b), kRemote);
+  // Unknown labels never match.
+  EXPECT_EQ(LocalityDistance(Locality(), Locality()), kRemote);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -67,6 +67,13 @@ DataServiceWorkerImpl::~DataServiceWorkerImpl() {
 Status DataServiceWorkerImpl::Start(const std::string& worker_address) {
   VLOG(3) << "Starting tf.data service worker at address " << worker_address;
   worker_address_ = worker_address;
+  locality_ = LocalLocality();
+  if (!config_.rack().empty()) {
+    locality_.set_rack(config_.rack());
+  }
+  if (!config_.zone().empty()) {
+    locality_.set_zone(config_.zone());
+  }
 
   dispatcher_ = absl::make_unique<DataServiceDispatcherClient>(
       config_.dispatcher_address(), config_.protocol());
@@ -180,6 +187,7 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   VLOG(3) << "Received GetElement request for task " << request->task_id();
   bool end_of_sequence = false;
   std::vector<tensorflow::Tensor> outputs;
+  std::shared_ptr<SharedMemoryRing> ring;
   {
     mutex_lock l(mu_);
     if (!registered_) {
@@ -212,6 +220,9 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
         GetElementRequest::kRoundIndex) {
       get_next_request.round_index = request->round_index();
     }
+    if (!request->shared_memory_ring().empty()) {
+      ring = GetSharedMemoryRing(*task, request->shared_memory_ring());
+    }
     TF_RETURN_IF_ERROR(
         task->task_runner->GetNext(get_next_request, outputs, end_of_sequence));
     if (end_of_sequence) {
@@ -223,39 +234,65 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
 
   if (!end_of_sequence) {
     VLOG(3) << "Producing an element for task " << request->task_id();
-    if (outputs.size() != 1) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but the "
-          "dataset produced ",
-          outputs.size(), " outputs");
-    }
-    if (outputs[0].dtype() != DT_VARIANT) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but "
-          "the dataset produced a tensor with type ",
-          DataTypeString(outputs[0].dtype()));
+    // Datasets registered with compression produce a single scalar variant
+    // tensor holding a `CompressedElement`.
+    CompressedElement* compressed = nullptr;
+    if (outputs.size() == 1 && outputs[0].dtype() == DT_VARIANT &&
+        TensorShapeUtils::IsScalar(outputs[0].shape())) {
+      compressed = outputs[0].scalar<Variant>()().get<CompressedElement>();
     }
-    if (!TensorShapeUtils::IsScalar(outputs[0].shape())) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but "
-          "the dataset produced a tensor with shape ",
-          outputs[0].shape());
+    if (compressed != nullptr) {
+      compressed->Swap(response->mutable_compressed_element());
+    } else {
+      SetUncompressedElement(outputs, ring.get(), response);
     }
-    Variant& variant = outputs[0].scalar<Variant>()();
-    CompressedElement* compressed = variant.get<CompressedElement>();
-    if (compressed == nullptr) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a CompressedElement variant tensor, but "
-          "it produced ",
-          variant.TypeName());
-    }
-    compressed->Swap(response->mutable_compressed_element());
   }
   response->set_end_of_sequence(end_of_sequence);
 
   return Status::OK();
 }
 
+std::shared_ptr<SharedMemoryRing> DataServiceWorkerImpl::GetSharedMemoryRing(
+    Task& task, const std::string& name) TF_LOCKS_EXCLUDED(task.mu) {
+  mutex_lock l(task.mu);
+  auto it = task.shared_memory_rings.find(name);
+  if (it != task.shared_memory_rings.end()) {
+    return it->second;
+  }
+  std::unique_ptr<SharedMemoryRing> ring;
+  Status s = SharedMemoryRing::Open(name, &ring);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to open shared memory ring " << name
+                 << " for task " << task.task_def.task_id()
+                 << ". Elements will be sent over RPC instead: " << s;
+  }
+  std::shared_ptr<SharedMemoryRing> shared(std::move(ring));
+  task.shared_memory_rings[name] = shared;
+  return shared;
+}
+
+void DataServiceWorkerImpl::SetUncompressedElement(
+    std::vector<Tensor>& element, SharedMemoryRing* ring,
+    GetElementResponse* response) {
+  if (ring != nullptr) {
+    bool pushed = false;
+    // Elements that don't fit in the ring, or that have components which
+    // can't be copied with memcpy, are sent in the response.
+    Status s = ring->TryPush(element, &pushed);
+    if (s.ok() && pushed) {
+      response->set_in_shared_memory(true);
+      return;
+    }
+    VLOG(3) << "Sending an element over RPC instead of the shared memory ring "
+            << ring->name() << ": "
+            << (s.ok() ? "the ring is full" : s.ToString());
+  }
+  UncompressedElement* uncompressed = response->mutable_uncompressed_element();
+  for (const Tensor& component : element) {
+    component.AsProtoTensorContent(uncompressed->add_components());
+  }
+}
+
 Status DataServiceWorkerImpl::GetWorkerTasks(
     const GetWorkerTasksRequest* request, GetWorkerTasksResponse* response) {
   mutex_lock l(mu_);
@@ -347,16 +384,23 @@ void DataServiceWorkerImpl::HeartbeatThread() TF_LOCKS_EXCLUDED(mu_) {
 
 Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   std::vector<int64> current_tasks;
+  std::vector<TaskRunnerStats> task_stats;
   {
     mutex_lock l(mu_);
     for (const auto& task : tasks_) {
       current_tasks.push_back(task.first);
+      mutex_lock task_lock(task.second->mu);
+      if (task.second->initialized) {
+        task_stats.push_back(task.second->task_runner->TakeStats());
+        task_stats.back().set_task_id(task.first);
+      }
     }
   }
   std::vector<TaskDef> new_tasks;
   std::vector<int64> tasks_to_delete;
   TF_RETURN_IF_ERROR(dispatcher_->WorkerHeartbeat(
-      worker_address_, current_tasks, new_tasks, tasks_to_delete));
+      worker_address_, locality_, current_tasks, task_stats, new_tasks,
+      tasks_to_delete));
   mutex_lock l(mu_);
   for (const auto& task : new_tasks) {
     Status s = ProcessTaskInternal(task);
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/data/shared_memory_ring.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
@@ -63,6 +64,10 @@ class DataServiceWorkerImpl {
     mutex mu;
     bool initialized TF_GUARDED_BY(mu) = false;
     std::unique_ptr<TaskRunner> task_runner;
+    // Shared memory rings of same-host clients, keyed by name. A null ring
+    // means that the ring could not be opened.
+    absl::flat_hash_map<std::string, std::shared_ptr<SharedMemoryRing>>
+        shared_memory_rings TF_GUARDED_BY(mu);
   };
 
   // Sends task status to the dispatcher and checks for dispatcher commands.
@@ -71,6 +76,15 @@ class DataServiceWorkerImpl {
   Status ProcessTaskInternal(const TaskDef& task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status EnsureTaskInitialized(Task& task);
+  // Returns the shared memory ring `name` of `task`, opening it if needed, or
+  // null if it cannot be opened.
+  std::shared_ptr<SharedMemoryRing> GetSharedMemoryRing(
+      Task& task, const std::string& name) TF_LOCKS_EXCLUDED(task.mu);
+  // Stores the components of an uncompressed element in `response`, through
+  // `ring` if it is not null and has room for the element.
+  static void SetUncompressedElement(std::vector<Tensor>& element,
+                                     SharedMemoryRing* ring,
+                                     GetElementResponse* response);
   // A thread for notifying the dispatcher when tasks complete.
   void TaskCompletionThread() TF_LOCKS_EXCLUDED(mu_);
   // A thread for doing periodic heartbeats to the dispatcher.
@@ -81,6 +95,8 @@ class DataServiceWorkerImpl {
   const experimental::WorkerConfig config_;
   // The worker's own address.
   std::string worker_address_;
+  // Where the worker runs, reported to the dispatcher on registration.
+  Locality locality_;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
 
   mutex mu_;
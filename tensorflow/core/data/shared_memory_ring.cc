@@ -0,0 +1,330 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_memory_ring.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cstring>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr uint64 kMagic = 0x7466646174617368;  // "tfdatash"
+constexpr int64 kAlignment = 64;
+
+// The states of a slot.
+constexpr int32 kEmpty = 0;  // Owned by the producer.
+constexpr int32 kFull = 1;   // Holds an element that was not popped yet.
+constexpr int32 kInUse = 2;  // Holds an element whose tensors are alive.
+
+int64 RoundUp(int64 n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+
+struct SlotHeader {
+  std::atomic<int32> state;
+  int32 num_components;
+};
+
+// Precedes the dimensions and the data of each component in a slot.
+struct ComponentHeader {
+  int32 dtype;
+  int32 num_dims;
+  int64 num_bytes;
+};
+
+int64 SlotHeaderBytes() { return RoundUp(sizeof(SlotHeader)); }
+
+int64 ComponentHeaderBytes(int num_dims) {
+  return RoundUp(sizeof(ComponentHeader) + num_dims * sizeof(int64));
+}
+
+}  // namespace
+
+struct SharedMemoryRing::Header {
+  uint64 magic;
+  int64 num_slots;
+  int64 slot_bytes;
+  // Written by the producer only.
+  std::atomic<int64> write_index;
+  // Written by the consumer only.
+  std::atomic<int64> read_index;
+};
+
+// A mapping of the shared memory object of a ring.
+class SharedMemoryRing::Mapping {
+ public:
+  Mapping(const std::string& name, void* base, size_t size, bool owner)
+      : name_(name), base_(base), size_(size), owner_(owner) {}
+
+  ~Mapping() {
+#if !defined(PLATFORM_WINDOWS)
+    if (munmap(base_, size_) != 0) {
+      LOG(ERROR) << "Failed to unmap " << name_ << ": " << strerror(errno);
+    }
+#endif
+  }
+
+  // Removes the name of the shared memory object if this mapping created it.
+  void Unlink() {
+#if !defined(PLATFORM_WINDOWS)
+    if (owner_ && shm_unlink(name_.c_str()) != 0) {
+      LOG(ERROR) << "Failed to unlink " << name_ << ": " << strerror(errno);
+    }
+#endif
+  }
+
+  char* base() const { return static_cast<char*>(base_); }
+  const std::string& name() const { return name_; }
+
+ private:
+  const std::string name_;
+  void* const base_;
+  const size_t size_;
+  const bool owner_;
+};
+
+// The buffer of one component of a popped element. The last buffer of an
+// element to be destroyed hands the slot back to the producer.
+class SharedMemoryRing::SlotBuffer : public TensorBuffer {
+ public:
+  // Returns the slot to the producer when destroyed.
+  class Lease {
+   public:
+    Lease(std::shared_ptr<Mapping> mapping, SlotHeader* slot)
+        : mapping_(std::move(mapping)), slot_(slot) {}
+    ~Lease() { slot_->state.store(kEmpty, std::memory_order_release); }
+
+   private:
+    const std::shared_ptr<Mapping> mapping_;
+    SlotHeader* const slot_;
+  };
+
+  SlotBuffer(std::shared_ptr<Lease> lease, void* data, size_t size)
+      : TensorBuffer(data), lease_(std::move(lease)), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("shared_memory_ring");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<Lease> lease_;
+  const size_t size_;
+};
+
+SharedMemoryRing::SharedMemoryRing(std::shared_ptr<Mapping> mapping)
+    : mapping_(std::move(mapping)) {}
+
+SharedMemoryRing::~SharedMemoryRing() { mapping_->Unlink(); }
+
+SharedMemoryRing::Header* SharedMemoryRing::header() const {
+  return reinterpret_cast<Header*>(mapping_->base());
+}
+
+char* SharedMemoryRing::slot(int64 index) const {
+  return mapping_->base() + RoundUp(sizeof(Header)) +
+         index * RoundUp(header()->slot_bytes);
+}
+
+int64 SharedMemoryRing::num_slots() const { return header()->num_slots; }
+
+int64 SharedMemoryRing::slot_bytes() const { return header()->slot_bytes; }
+
+const std::string& SharedMemoryRing::name() const { return mapping_->name(); }
+
+Status SharedMemoryRing::Create(const std::string& name, int64 num_slots,
+                                int64 slot_bytes,
+                                std::unique_ptr<SharedMemoryRing>* out) {
+#if defined(PLATFORM_WINDOWS)
+  return errors::Unimplemented("Shared memory rings are not supported.");
+#else
+  if (num_slots <= 0 || slot_bytes <= SlotHeaderBytes()) {
+    return errors::InvalidArgument("Invalid ring of ", num_slots,
+                                   " slots of ", slot_bytes, " bytes.");
+  }
+  const size_t size =
+      RoundUp(sizeof(Header)) + num_slots * RoundUp(slot_bytes);
+  int fd = shm_open(name.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::Internal("Failed to create shared memory object ", name,
+                            ": ", strerror(errno));
+  }
+  void* base = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  const int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return errors::ResourceExhausted("Failed to map ", size,
+                                     " bytes of shared memory for ", name,
+                                     ": ", strerror(error));
+  }
+  auto mapping = std::make_shared<Mapping>(name, base, size, /*owner=*/true);
+  out->reset(new SharedMemoryRing(mapping));
+  // The object is zero-filled, so every slot starts out empty.
+  Header* header = (*out)->header();
+  header->num_slots = num_slots;
+  header->slot_bytes = slot_bytes;
+  header->write_index.store(0, std::memory_order_relaxed);
+  header->read_index.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+  return Status::OK();
+#endif
+}
+
+Status SharedMemoryRing::Open(const std::string& name,
+                              std::unique_ptr<SharedMemoryRing>* out) {
+#if defined(PLATFORM_WINDOWS)
+  return errors::Unimplemented("Shared memory rings are not supported.");
+#else
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::NotFound("Failed to open shared memory object ", name, ": ",
+                            strerror(errno));
+  }
+  struct stat st;
+  void* base = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= RoundUp(sizeof(Header))) {
+    base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) {
+    return errors::Internal("Failed to map shared memory object ", name);
+  }
+  auto mapping =
+      std::make_shared<Mapping>(name, base, st.st_size, /*owner=*/false);
+  const Header* header = reinterpret_cast<const Header*>(base);
+  if (header->magic != kMagic ||
+      RoundUp(sizeof(Header)) + header->num_slots * RoundUp(header->slot_bytes) >
+          st.st_size) {
+    return errors::InvalidArgument(name, " does not hold a ring.");
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  out->reset(new SharedMemoryRing(mapping));
+  return Status::OK();
+#endif
+}
+
+Status SharedMemoryRing::TryPush(const std::vector<Tensor>& element,
+                                 bool* pushed) {
+  int64 bytes = SlotHeaderBytes();
+  for (const Tensor& component : element) {
+    if (!DataTypeCanUseMemcpy(component.dtype())) {
+      return errors::InvalidArgument(
+          "Shared memory rings do not support components of type ",
+          DataTypeString(component.dtype()));
+    }
+    bytes += ComponentHeaderBytes(component.dims()) +
+             RoundUp(component.TotalBytes());
+  }
+  Header* header = this->header();
+  if (bytes > header->slot_bytes) {
+    return errors::InvalidArgument("An element of ", bytes,
+                                   " bytes does not fit in the slots of ",
+                                   header->slot_bytes, " bytes of the ring.");
+  }
+  const int64 index = header->write_index.load(std::memory_order_relaxed);
+  char* data = slot(index);
+  SlotHeader* slot_header = reinterpret_cast<SlotHeader*>(data);
+  if (slot_header->state.load(std::memory_order_acquire) != kEmpty) {
+    *pushed = false;
+    return Status::OK();
+  }
+  slot_header->num_components = element.size();
+  char* pos = data + SlotHeaderBytes();
+  for (const Tensor& component : element) {
+    ComponentHeader* component_header = reinterpret_cast<ComponentHeader*>(pos);
+    component_header->dtype = component.dtype();
+    component_header->num_dims = component.dims();
+    component_header->num_bytes = component.TotalBytes();
+    int64* dims = reinterpret_cast<int64*>(component_header + 1);
+    for (int i = 0; i < component.dims(); ++i) {
+      dims[i] = component.dim_size(i);
+    }
+    pos += ComponentHeaderBytes(component.dims());
+    const StringPiece component_data = component.tensor_data();
+    std::memcpy(pos, component_data.data(), component_data.size());
+    pos += RoundUp(component_data.size());
+  }
+  slot_header->state.store(kFull, std::memory_order_release);
+  header->write_index.store((index + 1) % header->num_slots,
+                            std::memory_order_relaxed);
+  *pushed = true;
+  return Status::OK();
+}
+
+Status SharedMemoryRing::TryPop(std::vector<Tensor>* element, bool* popped) {
+  Header* header = this->header();
+  const int64 index = header->read_index.load(std::memory_order_relaxed);
+  char* data = slot(index);
+  SlotHeader* slot_header = reinterpret_cast<SlotHeader*>(data);
+  if (slot_header->state.load(std::memory_order_acquire) != kFull) {
+    *popped = false;
+    return Status::OK();
+  }
+  slot_header->state.store(kInUse, std::memory_order_relaxed);
+  header->read_index.store((index + 1) % header->num_slots,
+                           std::memory_order_relaxed);
+  // The slot is handed back once the lease is released by `lease` and by
+  // the buffers of all components.
+  auto lease = std::make_shared<SlotBuffer::Lease>(mapping_, slot_header);
+
+  element->clear();
+  element->reserve(slot_header->num_components);
+  const char* const end = data + header->slot_bytes;
+  char* pos = data + SlotHeaderBytes();
+  for (int i = 0; i < slot_header->num_components; ++i) {
+    const ComponentHeader* component_header =
+        reinterpret_cast<const ComponentHeader*>(pos);
+    const int64* dims = reinterpret_cast<const int64*>(component_header + 1);
+    TensorShape shape;
+    for (int d = 0; d < component_header->num_dims; ++d) {
+      shape.AddDim(dims[d]);
+    }
+    pos += ComponentHeaderBytes(component_header->num_dims);
+    if (pos + component_header->num_bytes > end) {
+      return errors::DataLoss("Corrupted element in slot ", index,
+                              " of the ring.");
+    }
+    auto* buffer =
+        new SlotBuffer(lease, pos, component_header->num_bytes);
+    element->emplace_back(static_cast<DataType>(component_header->dtype),
+                          shape, buffer);
+    buffer->Unref();
+    pos += RoundUp(component_header->num_bytes);
+  }
+  *popped = true;
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
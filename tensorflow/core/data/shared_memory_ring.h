@@ -0,0 +1,97 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SHARED_MEMORY_RING_H_
+#define TENSORFLOW_CORE_DATA_SHARED_MEMORY_RING_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A ring of dataset elements in shared memory, through which one producer
+// hands elements to one consumer, typically in another process (e.g. a
+// preprocessing worker forked to run a Python map function outside of the
+// GIL of its parent).
+//
+// The producer copies the components of an element into a slot of the ring,
+// without serializing them. The consumer receives tensors that alias the
+// slot, and the slot is handed back to the producer once the last of those
+// tensors is destroyed. The ring lives in a POSIX shared memory object, so
+// both sides only need to agree on its name.
+//
+// Only components whose type can be copied with memcpy are supported.
+// Shared memory is not available on Windows, where `Create()` and `Open()`
+// return `Unimplemented`.
+class SharedMemoryRing {
+ public:
+  // Creates a ring with `num_slots` slots of `slot_bytes` bytes each, in the
+  // shared memory object `name` (which must start with a '/'). Any existing
+  // object of that name is replaced. The name is removed when the created
+  // ring is destroyed; processes that opened it keep their mapping.
+  static Status Create(const std::string& name, int64 num_slots,
+                       int64 slot_bytes, std::unique_ptr<SharedMemoryRing>* out);
+
+  // Opens the ring created under `name` by `Create()`.
+  static Status Open(const std::string& name,
+                     std::unique_ptr<SharedMemoryRing>* out);
+
+  ~SharedMemoryRing();
+
+  // Copies `element` into the next slot of the ring and sets `*pushed` to
+  // true, or sets `*pushed` to false if that slot is still in use. Returns
+  // an error if `element` does not fit in a slot or has a component that
+  // cannot be copied with memcpy.
+  //
+  // Must only be called by the producer.
+  Status TryPush(const std::vector<Tensor>& element, bool* pushed);
+
+  // Sets `*element` to the element in the next slot of the ring and
+  // `*popped` to true, or sets `*popped` to false if no element is ready.
+  // The tensors of `*element` alias the slot and keep the mapping of the
+  // ring alive, even after the ring is destroyed.
+  //
+  // Must only be called by the consumer.
+  Status TryPop(std::vector<Tensor>* element, bool* popped);
+
+  int64 num_slots() const;
+  int64 slot_bytes() const;
+  // The name of the shared memory object of the ring.
+  const std::string& name() const;
+
+ private:
+  class Mapping;
+  class SlotBuffer;
+  struct Header;
+
+  explicit SharedMemoryRing(std::shared_ptr<Mapping> mapping);
+
+  Header* header() const;
+  char* slot(int64 index) const;
+
+  const std::shared_ptr<Mapping> mapping_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryRing);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SHARED_MEMORY_RING_H_
@@ -0,0 +1,128 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_memory_ring.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+#if !defined(PLATFORM_WINDOWS)
+
+std::string RingName(const std::string& test) {
+  return strings::StrCat("/tf_data_ring_", Env::Default()->NowMicros(), "_",
+                         test);
+}
+
+TEST(SharedMemoryRingTest, RoundTrip) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  TF_ASSERT_OK(SharedMemoryRing::Create(RingName("round_trip"),
+                                        /*num_slots=*/2, /*slot_bytes=*/1024,
+                                        &ring));
+  std::vector<Tensor> element = {test::AsTensor<int64>({1, 2, 3, 4}, {2, 2}),
+                                 test::AsScalar<float>(0.5f)};
+  bool pushed;
+  TF_ASSERT_OK(ring->TryPush(element, &pushed));
+  EXPECT_TRUE(pushed);
+
+  std::vector<Tensor> popped_element;
+  bool popped;
+  TF_ASSERT_OK(ring->TryPop(&popped_element, &popped));
+  ASSERT_TRUE(popped);
+  ASSERT_EQ(2, popped_element.size());
+  test::ExpectTensorEqual<int64>(element[0], popped_element[0]);
+  test::ExpectTensorEqual<float>(element[1], popped_element[1]);
+
+  TF_ASSERT_OK(ring->TryPop(&popped_element, &popped));
+  EXPECT_FALSE(popped);
+}
+
+TEST(SharedMemoryRingTest, SlotsAreReusedOnceTensorsAreReleased) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  TF_ASSERT_OK(SharedMemoryRing::Create(RingName("reuse"), /*num_slots=*/1,
+                                        /*slot_bytes=*/1024, &ring));
+  bool pushed;
+  TF_ASSERT_OK(ring->TryPush({test::AsScalar<int32>(1)}, &pushed));
+  EXPECT_TRUE(pushed);
+  TF_ASSERT_OK(ring->TryPush({test::AsScalar<int32>(2)}, &pushed));
+  EXPECT_FALSE(pushed);
+
+  std::vector<Tensor> element;
+  bool popped;
+  TF_ASSERT_OK(ring->TryPop(&element, &popped));
+  ASSERT_TRUE(popped);
+  // The popped tensor still aliases the only slot.
+  TF_ASSERT_OK(ring->TryPush({test::AsScalar<int32>(2)}, &pushed));
+  EXPECT_FALSE(pushed);
+  EXPECT_EQ(1, element[0].scalar<int32>()());
+
+  element.clear();
+  TF_ASSERT_OK(ring->TryPush({test::AsScalar<int32>(2)}, &pushed));
+  EXPECT_TRUE(pushed);
+  TF_ASSERT_OK(ring->TryPop(&element, &popped));
+  ASSERT_TRUE(popped);
+  EXPECT_EQ(2, element[0].scalar<int32>()());
+}
+
+TEST(SharedMemoryRingTest, OpenSharesTheRing) {
+  const std::string name = RingName("open");
+  std::unique_ptr<SharedMemoryRing> producer;
+  TF_ASSERT_OK(SharedMemoryRing::Create(name, /*num_slots=*/4,
+                                        /*slot_bytes=*/512, &producer));
+  std::unique_ptr<SharedMemoryRing> consumer;
+  TF_ASSERT_OK(SharedMemoryRing::Open(name, &consumer));
+  EXPECT_EQ(4, consumer->num_slots());
+  EXPECT_EQ(512, consumer->slot_bytes());
+
+  bool pushed;
+  TF_ASSERT_OK(producer->TryPush({test::AsTensor<uint8>({7, 8, 9})}, &pushed));
+  EXPECT_TRUE(pushed);
+  std::vector<Tensor> element;
+  bool popped;
+  TF_ASSERT_OK(consumer->TryPop(&element, &popped));
+  ASSERT_TRUE(popped);
+  // The tensors keep the mapping alive.
+  consumer.reset();
+  test::ExpectTensorEqual<uint8>(test::AsTensor<uint8>({7, 8, 9}), element[0]);
+}
+
+TEST(SharedMemoryRingTest, RejectsUnsupportedElements) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  TF_ASSERT_OK(SharedMemoryRing::Create(RingName("unsupported"),
+                                        /*num_slots=*/1, /*slot_bytes=*/256,
+                                        &ring));
+  bool pushed;
+  Status s = ring->TryPush({test::AsScalar<tstring>("a")}, &pushed);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  s = ring->TryPush({Tensor(DT_FLOAT, TensorShape({1024}))}, &pushed);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST(SharedMemoryRingTest, OpenMissingRing) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  EXPECT_TRUE(
+      errors::IsNotFound(SharedMemoryRing::Open(RingName("missing"), &ring)));
+}
+
+#endif  // !defined(PLATFORM_WINDOWS)
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -336,7 +336,20 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
         });
     return;
   } else {
-    RecvFromRemoteAsync(parsed, recv_args, std::move(done));
+    remote_recv_time_.Start();
+    // Holds a ref until the receive is done, since it may be the last use of
+    // the rendezvous.
+    Ref();
+    RecvFromRemoteAsync(
+        parsed, recv_args,
+        [this, done = std::move(done)](
+            const Status& status, const Rendezvous::Args& send_args,
+            const Rendezvous::Args& recv_args, const Tensor& in,
+            bool is_dead) {
+          remote_recv_time_.Stop();
+          done(status, send_args, recv_args, in, is_dead);
+          Unref();
+        });
   }
 }
 
@@ -21,6 +21,7 @@ limitations under the License.
 #include <unordered_set>
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/pending_time_tracker.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -134,6 +135,10 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
 
   void StartAbort(const Status& status) override;
 
+  int64 remote_recv_micros() const override {
+    return remote_recv_time_.pending_micros();
+  }
+
   // This method is called only by the local Worker, forwarded through
   // the same method on RendezvousMgr.  This occurs when the Worker
   // has received a RecvTensor request, either locally or over the
@@ -174,6 +179,8 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
  private:
   Rendezvous* local_;  // Owns a Ref on this object.
 
+  PendingTimeTracker remote_recv_time_;
+
   mutable mutex mu_;
 
   // Status given by StartAbort() if any.
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_DESTROY_TENSOR_HANDLE_NODE_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_DESTROY_TENSOR_HANDLE_NODE_H_
 
+#include <functional>
+#include <memory>
+
 #include "tensorflow/core/common_runtime/eager/context.h"
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/distributed_runtime/eager/eager_client.h"
@@ -26,20 +29,30 @@ namespace tensorflow {
 namespace eager {
 
 // DestroyTensorHandleNode is an implementation of EagerNode which enqueues a
-// request to destroy a remote tensor handle.
+// request to destroy remote tensor handles.
+//
+// The request is only built by `take_request` when the node runs, so that it
+// carries every handle whose deletion was requested while the node was
+// queued. `take_request` is also called if the node is destroyed without
+// running, so that the pending deletions are dropped.
 class DestroyTensorHandleNode : public tensorflow::AsyncEagerNode {
  public:
-  DestroyTensorHandleNode(std::unique_ptr<EnqueueRequest> request,
-                          core::RefCountPtr<EagerClient> eager_client,
-                          bool ready)
+  DestroyTensorHandleNode(
+      std::function<std::unique_ptr<EnqueueRequest>()> take_request,
+      core::RefCountPtr<EagerClient> eager_client, bool ready)
       : tensorflow::AsyncEagerNode(),
-        request_(std::move(request)),
+        take_request_(std::move(take_request)),
         eager_client_(std::move(eager_client)),
         ready_(ready) {}
 
-  ~DestroyTensorHandleNode() override {}
+  ~DestroyTensorHandleNode() override {
+    if (take_request_) take_request_();
+  }
 
   void RunAsync(StatusCallback done) override {
+    request_ = take_request_();
+    take_request_ = nullptr;
+    VLOG(3) << "Sending request to delete " << request_->DebugString();
     EnqueueResponse* response = new EnqueueResponse;
     bool ready = ready_;
     // NOTE(fishx): Don't use StreamingEnqueueAsync here. When a
@@ -71,11 +84,14 @@ class DestroyTensorHandleNode : public tensorflow::AsyncEagerNode {
 
   string DebugString() const override {
     string out = "[DestroyTensorHandleNode]";
-    strings::StrAppend(&out, " request: ", request_->DebugString());
+    if (request_ != nullptr) {
+      strings::StrAppend(&out, " request: ", request_->DebugString());
+    }
     return out;
   }
 
  private:
+  std::function<std::unique_ptr<EnqueueRequest>()> take_request_;
   std::unique_ptr<EnqueueRequest> request_;
   core::RefCountPtr<EagerClient> eager_client_;
   const string remote_task_;
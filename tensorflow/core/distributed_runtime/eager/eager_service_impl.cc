@@ -565,6 +565,10 @@ Status EagerServiceImpl::Enqueue(CallOptions* call_opts,
           : context->Context()->RemoteMgr()->GetOrCreateExecutorForStream(
                 stream_id);
   Status s;
+  // Deletions of remote handles are best effort, and a request carries the
+  // deletions of many handles, so a failing deletion does not stop the rest of
+  // the request. Its error is returned once the request is done.
+  Status decref_status;
   for (const auto& item : request->queue()) {
     auto* queue_response = response->add_queue_response();
     if (item.has_operation()) {
@@ -575,7 +579,9 @@ Status EagerServiceImpl::Enqueue(CallOptions* call_opts,
           item.handle_to_decref());
       auto node = absl::make_unique<ClientTensorHandleDeleteNode>(
           context, std::move(handle_to_decref));
-      s = context->Context()->Executor().AddOrExecute(std::move(node));
+      decref_status.Update(
+          context->Context()->Executor().AddOrExecute(std::move(node)));
+      continue;
     } else if (item.has_send_tensor()) {
       s = SendTensor(item.send_tensor(), context->Context());
     } else if (item.has_send_packed_handle()) {
@@ -598,7 +604,7 @@ Status EagerServiceImpl::Enqueue(CallOptions* call_opts,
     }
   }
 
-  return Status::OK();
+  return decref_status;
 }
 
 Status EagerServiceImpl::WaitQueueDone(const WaitQueueDoneRequest* request,
@@ -1104,6 +1104,64 @@ TEST_F(EagerServiceImplTest, SendTensorTest) {
                                                &close_context_response));
 }
 
+// Test deletes several tensor handles with a single request, one of which
+// does not exist.
+TEST_F(EagerServiceImplTest, DeleteTensorHandlesTest) {
+  TestEagerServiceImpl eager_service_impl(&worker_env_);
+
+  uint64 context_id = random::New64();
+
+  CreateContextRequest request;
+  request.mutable_server_def()->set_job_name("localhost");
+  request.mutable_server_def()->set_task_index(0);
+  request.set_context_id(context_id);
+  CreateContextResponse response;
+
+  TF_ASSERT_OK(eager_service_impl.CreateContext(&request, &response));
+
+  EnqueueRequest remote_enqueue_request;
+  remote_enqueue_request.set_context_id(context_id);
+  EnqueueResponse remote_enqueue_response;
+  for (int op_id : {1, 2}) {
+    auto* send_tensor =
+        remote_enqueue_request.add_queue()->mutable_send_tensor();
+    send_tensor->set_op_id(op_id);
+    SetTensorProto(send_tensor->add_tensors());
+  }
+  TF_ASSERT_OK(eager_service_impl.Enqueue(nullptr, &remote_enqueue_request,
+                                          &remote_enqueue_response));
+
+  EnqueueRequest delete_request;
+  delete_request.set_context_id(context_id);
+  EnqueueResponse delete_response;
+  for (int op_id : {3, 1, 2}) {
+    auto* handle_to_decref =
+        delete_request.add_queue()->mutable_handle_to_decref();
+    handle_to_decref->set_op_id(op_id);
+    handle_to_decref->set_output_num(0);
+  }
+  Status status =
+      eager_service_impl.Enqueue(nullptr, &delete_request, &delete_response);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status.error_message();
+
+  // The handles that exist are deleted despite the failing deletion.
+  tensorflow::TensorHandle* tensor_handle;
+  for (int op_id : {1, 2}) {
+    EXPECT_FALSE(eager_service_impl
+                     .GetTensorHandle(context_id,
+                                      RemoteTensorHandleInternal(op_id, 0),
+                                      &tensor_handle)
+                     .ok());
+  }
+
+  CloseContextRequest close_context_request;
+  close_context_request.set_context_id(context_id);
+  close_context_request.set_context_view_id(0);
+  CloseContextResponse close_context_response;
+  TF_ASSERT_OK(eager_service_impl.CloseContext(&close_context_request,
+                                               &close_context_response));
+}
+
 // Test serializes and sends a pack TensorHandle.
 TEST_F(EagerServiceImplTest, SendPackedHandleTest) {
   TestEagerServiceImpl eager_service_impl(&worker_env_);
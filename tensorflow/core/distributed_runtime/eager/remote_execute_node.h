@@ -91,7 +91,8 @@ class RemoteExecuteNode : public AsyncRemoteExecuteNode {
   }
 
   Status Prepare() override {
-    return RunShapeInference(ndef_, *lib_def_, inputs_, retvals_);
+    return RunShapeInference(ndef_, *lib_def_, inputs_, retvals_,
+                             eager_context_->GetShapeInferenceCache());
   }
 
   void RunAsync(StatusCallback done) override;
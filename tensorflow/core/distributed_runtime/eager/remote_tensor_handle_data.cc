@@ -14,17 +14,39 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/distributed_runtime/eager/remote_tensor_handle_data.h"
 
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/distributed_runtime/eager/destroy_tensor_handle_node.h"
 #include "tensorflow/core/distributed_runtime/eager/eager_client.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Remote tensor handles whose deletion has been requested but not sent yet,
+// keyed by the client of their task and their context id. A key is present
+// exactly while a DestroyTensorHandleNode for it is alive, and that node holds
+// a reference to the client.
+struct PendingDeletes {
+  typedef std::pair<const eager::EagerClient*, uint64> Key;
+
+  mutex mu;
+  absl::flat_hash_map<Key, std::vector<std::pair<int64, int32>>> handles
+      TF_GUARDED_BY(mu);
+};
+
+PendingDeletes* GetPendingDeletes() {
+  static PendingDeletes* pending = new PendingDeletes;
+  return pending;
+}
+
 void DestroyRemoteTensorHandle(EagerContext* ctx, const string& remote_task,
                                uint64 context_id, uint64 op_id, int output_num,
                                bool ready) {
@@ -44,17 +66,36 @@ void DestroyRemoteTensorHandle(EagerContext* ctx, const string& remote_task,
     return;
   }
 
-  std::unique_ptr<eager::EnqueueRequest> request(new eager::EnqueueRequest);
-  request->set_context_id(context_id);
-
-  auto* handle_to_decref = request->add_queue()->mutable_handle_to_decref();
-  handle_to_decref->set_op_id(op_id);
-  handle_to_decref->set_output_num(output_num);
+  // Deletions are batched per client and context: only the first pending
+  // deletion schedules a node, which sends all the deletions that are pending
+  // by the time it runs.
+  PendingDeletes* pending = GetPendingDeletes();
+  const PendingDeletes::Key key(eager_client.get(), context_id);
+  {
+    mutex_lock l(pending->mu);
+    auto& handles = pending->handles[key];
+    handles.emplace_back(op_id, output_num);
+    if (handles.size() > 1) return;
+  }
 
-  VLOG(3) << "Sending request to delete " << request->DebugString();
+  auto take_request = [pending, key]() {
+    std::unique_ptr<eager::EnqueueRequest> request(new eager::EnqueueRequest);
+    request->set_context_id(key.second);
+    mutex_lock l(pending->mu);
+    auto it = pending->handles.find(key);
+    if (it == pending->handles.end()) return request;
+    for (const auto& handle : it->second) {
+      auto* handle_to_decref =
+          request->add_queue()->mutable_handle_to_decref();
+      handle_to_decref->set_op_id(handle.first);
+      handle_to_decref->set_output_num(handle.second);
+    }
+    pending->handles.erase(it);
+    return request;
+  };
   std::unique_ptr<EagerNode> node(
       absl::make_unique<eager::DestroyTensorHandleNode>(
-          std::move(request), std::move(eager_client), ready));
+          std::move(take_request), std::move(eager_client), ready));
   auto& executor = ctx->Executor();
   if (executor.Async()) {
     Status status = executor.AddOrExecute(std::move(node));
@@ -489,8 +489,8 @@ void GraphMgr::ExecuteAsync(const string& handle, const int64 step_id,
   StartParallelExecutors(
       handle, step_id, item, rendezvous, ce_handle, collector, cost_graph,
       cancellation_manager, session,
-      [item, rendezvous, ce_handle, done, start_time_usecs, input_size,
-       step_id](const Status& s) {
+      [item, rendezvous, ce_handle, response, done, start_time_usecs,
+       input_size, step_id](const Status& s) {
         profiler::TraceMeConsumer activity(
             // From TraceMeProducer in GraphMgr::ExecuteAsync.
             [step_id] {
@@ -498,10 +498,20 @@ void GraphMgr::ExecuteAsync(const string& handle, const int64 step_id,
             },
             profiler::ContextType::kTfExecutor, step_id,
             profiler::TraceMeLevel::kInfo);
+        const uint64 run_graph_micros =
+            Env::Default()->NowMicros() - start_time_usecs;
+        if (response != nullptr) {
+          RunGraphStepTimes* step_times = response->mutable_step_times();
+          step_times->set_run_graph_micros(run_graph_micros);
+          step_times->set_remote_recv_micros(rendezvous->remote_recv_micros());
+          if (ce_handle != nullptr) {
+            step_times->set_collective_micros(
+                ce_handle->get()->pending_micros());
+          }
+        }
         done(s);
         metrics::RecordGraphInputTensors(input_size);
-        metrics::UpdateGraphExecTime(Env::Default()->NowMicros() -
-                                     start_time_usecs);
+        metrics::UpdateGraphExecTime(run_graph_micros);
         rendezvous->Unref();
         item->Unref();
         delete ce_handle;
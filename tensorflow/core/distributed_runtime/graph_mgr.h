@@ -85,6 +85,9 @@ class GraphMgr {
   //
   // If "out" is not nullptr, "out" specifies all keys the execution
   // should receive upon finish.
+  //
+  // If "response" is not nullptr, the breakdown of the time spent running the
+  // step is stored in its step times before "done" is called.
   typedef std::map<string, Tensor> NamedTensors;
   typedef std::function<void(const Status&)> StatusCallback;
   void ExecuteAsync(const string& handle, const int64 step_id,
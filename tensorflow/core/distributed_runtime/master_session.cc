@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -572,6 +573,46 @@ class RunManyGraphs {
     pending_.Wait();
   }
 
+  // Exports the breakdown of the time that the workers spent running their
+  // partitions of step `step_id`. The workers that finish early wait for the
+  // slowest one, the straggler, before the step is done.
+  void RecordStepTimes(int64 step_id) {
+    int64 slowest_micros = 0;
+    const string* slowest_worker = nullptr;
+    for (Call& call : calls_) {
+      const int64 micros = call.resp->mutable_step_times()->run_graph_micros();
+      if (micros > slowest_micros) {
+        slowest_micros = micros;
+        slowest_worker = call.worker_name;
+      }
+    }
+    // Workers that do not report their step times leave them empty.
+    if (slowest_worker == nullptr) return;
+    for (Call& call : calls_) {
+      const RunGraphStepTimes& times = *call.resp->mutable_step_times();
+      const int64 wait_micros = times.remote_recv_micros() +
+                                times.collective_micros();
+      const int64 straggler_wait_micros =
+          slowest_micros - times.run_graph_micros();
+      metrics::RecordDistributedStepTime("run_graph", times.run_graph_micros());
+      metrics::RecordDistributedStepTime("remote_recv",
+                                         times.remote_recv_micros());
+      metrics::RecordDistributedStepTime("collective",
+                                         times.collective_micros());
+      metrics::RecordDistributedStepTime(
+          "compute",
+          std::max<int64>(0, times.run_graph_micros() - wait_micros));
+      metrics::RecordDistributedStepTime("straggler_wait",
+                                         straggler_wait_micros);
+      VLOG(2) << "Step " << step_id << " on " << *call.worker_name << ": "
+              << times.ShortDebugString()
+              << " straggler_wait_micros: " << straggler_wait_micros;
+    }
+    if (calls_.size() > 1) {
+      metrics::RecordDistributedStepStraggler(*slowest_worker);
+    }
+  }
+
   Status status() const {
     mutex_lock l(mu_);
     // Concat status objects in this StatusGroup to get the aggregated status,
@@ -762,6 +803,7 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     return errors::Cancelled("Step was cancelled");
   }
   TF_RETURN_IF_ERROR(calls.status());
+  calls.RecordStepTimes(step_id);
 
   // Collects fetches and metadata.
   Status status;
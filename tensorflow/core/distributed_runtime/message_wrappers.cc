@@ -670,6 +670,10 @@ void InMemoryRunGraphResponse::AddPartitionGraph(
   partition_graphs_.push_back(partition_graph);
 }
 
+RunGraphStepTimes* InMemoryRunGraphResponse::mutable_step_times() {
+  return &step_times_;
+}
+
 size_t OwnedProtoRunGraphResponse::num_recvs() const {
   return response_.recv_size();
 }
@@ -737,6 +741,10 @@ void OwnedProtoRunGraphResponse::AddPartitionGraph(
   *graph_def = partition_graph;
 }
 
+RunGraphStepTimes* OwnedProtoRunGraphResponse::mutable_step_times() {
+  return response_.mutable_step_times();
+}
+
 NonOwnedProtoRunGraphResponse::NonOwnedProtoRunGraphResponse(
     RunGraphResponse* response)
     : response_(response) {}
@@ -810,6 +818,10 @@ void NonOwnedProtoRunGraphResponse::AddPartitionGraph(
   *graph_def = partition_graph;
 }
 
+RunGraphStepTimes* NonOwnedProtoRunGraphResponse::mutable_step_times() {
+  return response_->mutable_step_times();
+}
+
 MutableRunStepResponseWrapper::~MutableRunStepResponseWrapper() {}
 
 size_t InMemoryRunStepResponse::num_tensors() const { return tensors_.size(); }
@@ -494,6 +494,9 @@ class MutableRunGraphResponseWrapper {
   virtual GraphDef* mutable_partition_graph(size_t i) = 0;
   virtual void AddPartitionGraph(const GraphDef& partition_graph) = 0;
 
+  // Breakdown of the time spent running the subgraph, always returned.
+  virtual RunGraphStepTimes* mutable_step_times() = 0;
+
   // Returned status if requested.
   virtual errors::Code status_code() const = 0;
   virtual const string& status_error_message() const = 0;
@@ -528,6 +531,7 @@ class InMemoryRunGraphResponse : public MutableRunGraphResponseWrapper {
   size_t num_partition_graphs() const override;
   GraphDef* mutable_partition_graph(size_t i) override;
   void AddPartitionGraph(const GraphDef& partition_graph) override;
+  RunGraphStepTimes* mutable_step_times() override;
   errors::Code status_code() const override;
   const string& status_error_message() const override;
   void set_status(const Status& status) override;
@@ -542,6 +546,7 @@ class InMemoryRunGraphResponse : public MutableRunGraphResponseWrapper {
   StepStats step_stats_;
   CostGraphDef cost_graph_;
   std::vector<GraphDef> partition_graphs_;
+  RunGraphStepTimes step_times_;
   // Store the code and message separately so that they can be updated
   // independently by setters.
   Status status_;
@@ -561,6 +566,7 @@ class OwnedProtoRunGraphResponse : public MutableRunGraphResponseWrapper {
   size_t num_partition_graphs() const override;
   GraphDef* mutable_partition_graph(size_t i) override;
   void AddPartitionGraph(const GraphDef& partition_graph) override;
+  RunGraphStepTimes* mutable_step_times() override;
   errors::Code status_code() const override;
   const string& status_error_message() const override;
   void set_status(const Status& status) override;
@@ -588,6 +594,7 @@ class NonOwnedProtoRunGraphResponse : public MutableRunGraphResponseWrapper {
   size_t num_partition_graphs() const override;
   GraphDef* mutable_partition_graph(size_t i) override;
   void AddPartitionGraph(const GraphDef& partition_graph) override;
+  RunGraphStepTimes* mutable_step_times() override;
   errors::Code status_code() const override;
   const string& status_error_message() const override;
   void set_status(const Status& status) override;
@@ -109,6 +109,7 @@ void BuildRunGraphResponse(MutableRunGraphResponseWrapper* run_graph_response) {
   graph_def.mutable_versions()->set_producer(1234);
   graph_def.mutable_versions()->set_min_consumer(1234);
   run_graph_response->AddPartitionGraph(graph_def);
+  run_graph_response->mutable_step_times()->set_run_graph_micros(5678);
 }
 
 void CheckRunGraphResponse(MutableRunGraphResponseWrapper* response) {
@@ -128,6 +129,7 @@ void CheckRunGraphResponse(MutableRunGraphResponseWrapper* response) {
   EXPECT_EQ(1234, response->mutable_partition_graph(0)->versions().producer());
   EXPECT_EQ(1234,
             response->mutable_partition_graph(0)->versions().min_consumer());
+  EXPECT_EQ(5678, response->mutable_step_times()->run_graph_micros());
 }
 
 void BuildRunStepResponse(MutableRunGraphResponseWrapper* run_graph_response,
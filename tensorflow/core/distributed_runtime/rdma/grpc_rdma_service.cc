@@ -0,0 +1,36 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rdma/grpc_rdma_service.h"
+
+#include "grpcpp/server_context.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+
+namespace tensorflow {
+
+using ::grpc::ServerContext;
+
+#define HANDLER(method)                                                  \
+  ::grpc::Status GrpcRdmaService::method(                                \
+      ServerContext* context, const Rdma##method##Request* request,      \
+      Rdma##method##Response* response) {                                \
+    return ToGrpcStatus(rdma_mgr_->method(request, response));           \
+  }
+HANDLER(Connect);
+HANDLER(RecvTensor);
+HANDLER(WriteTensor);
+HANDLER(ReleaseTensor);
+#undef HANDLER
+
+}  // namespace tensorflow
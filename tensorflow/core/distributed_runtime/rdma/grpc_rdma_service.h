@@ -0,0 +1,50 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_GRPC_RDMA_SERVICE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_GRPC_RDMA_SERVICE_H_
+
+#include "grpcpp/server_builder.h"
+#include "tensorflow/core/distributed_runtime/rdma/rdma_mgr.h"
+#include "tensorflow/core/distributed_runtime/rdma/rdma_service.grpc.pb.h"
+
+namespace tensorflow {
+
+// Implements the RDMA control service by forwarding the calls to an
+// `RdmaMgr`. `RecvTensor` blocks a server thread until the tensor is
+// produced, and `WriteTensor` until the write has completed.
+class GrpcRdmaService : public RdmaService::Service {
+ public:
+  explicit GrpcRdmaService(RdmaMgr* rdma_mgr) : rdma_mgr_(rdma_mgr) {}
+
+  GrpcRdmaService(const GrpcRdmaService&) = delete;
+  GrpcRdmaService& operator=(const GrpcRdmaService&) = delete;
+
+#define HANDLER(method)                                       \
+  ::grpc::Status method(::grpc::ServerContext* context,       \
+                        const Rdma##method##Request* request, \
+                        Rdma##method##Response* response) override;
+  HANDLER(Connect);
+  HANDLER(RecvTensor);
+  HANDLER(WriteTensor);
+  HANDLER(ReleaseTensor);
+#undef HANDLER
+
+ private:
+  RdmaMgr* const rdma_mgr_;  // Not owned.
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_GRPC_RDMA_SERVICE_H_
@@ -0,0 +1,335 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rdma/rdma.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kCompletionQueueSize = 4096;
+constexpr int kMaxCompletionsPerPoll = 32;
+constexpr int kPollTimeoutMs = 100;
+constexpr int kMaxSendWorkRequests = 1024;
+// Writes are split into work requests of at most this many bytes, which is
+// below the maximum message size of all the devices we know of.
+constexpr uint64 kMaxWriteBytes = 1ull << 30;
+
+Status ErrnoError(const char* what) {
+  return errors::Internal(what, ": ", strerror(errno));
+}
+
+}  // namespace
+
+/* static */
+Status RdmaAdapter::Create(std::unique_ptr<RdmaAdapter>* out) {
+  std::unique_ptr<RdmaAdapter> adapter(new RdmaAdapter);
+  TF_RETURN_IF_ERROR(adapter->Init());
+  *out = std::move(adapter);
+  return Status::OK();
+}
+
+Status RdmaAdapter::Init() {
+  string device_name;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_RDMA_DEVICE", "", &device_name));
+  int64 port;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_RDMA_PORT", 1, &port));
+  int64 gid_index;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_RDMA_GID_INDEX", 0, &gid_index));
+  port_ = port;
+  gid_index_ = gid_index;
+
+  int num_devices = 0;
+  ibv_device** devices = ibv_get_device_list(&num_devices);
+  if (devices == nullptr || num_devices == 0) {
+    if (devices != nullptr) {
+      ibv_free_device_list(devices);
+    }
+    return errors::Unavailable("No RDMA device found.");
+  }
+  ibv_device* device = nullptr;
+  for (int i = 0; i < num_devices; ++i) {
+    if (device_name.empty() || device_name == ibv_get_device_name(devices[i])) {
+      device = devices[i];
+      break;
+    }
+  }
+  if (device != nullptr) {
+    context_ = ibv_open_device(device);
+  }
+  ibv_free_device_list(devices);
+  if (device == nullptr) {
+    return errors::NotFound("RDMA device ", device_name, " not found.");
+  }
+  if (context_ == nullptr) {
+    return ErrnoError("Failed to open the RDMA device");
+  }
+
+  if (ibv_query_port(context_, port_, &port_attr_) != 0) {
+    return ErrnoError("Failed to query the RDMA port");
+  }
+  if (port_attr_.state != IBV_PORT_ACTIVE) {
+    return errors::Unavailable("RDMA port ", port_, " of ",
+                               ibv_get_device_name(context_->device),
+                               " is not active.");
+  }
+  if (ibv_query_gid(context_, port_, gid_index_, &gid_) != 0) {
+    return ErrnoError("Failed to query the RDMA port GID");
+  }
+  pd_ = ibv_alloc_pd(context_);
+  if (pd_ == nullptr) {
+    return ErrnoError("Failed to allocate an RDMA protection domain");
+  }
+  completion_channel_ = ibv_create_comp_channel(context_);
+  if (completion_channel_ == nullptr) {
+    return ErrnoError("Failed to create an RDMA completion channel");
+  }
+  // The completion channel is polled with a timeout so that the polling
+  // thread notices when the adapter is destroyed.
+  const int flags = fcntl(completion_channel_->fd, F_GETFL);
+  if (fcntl(completion_channel_->fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+    return ErrnoError("Failed to configure the RDMA completion channel");
+  }
+  cq_ = ibv_create_cq(context_, kCompletionQueueSize, /*cq_context=*/nullptr,
+                      completion_channel_, /*comp_vector=*/0);
+  if (cq_ == nullptr) {
+    return ErrnoError("Failed to create an RDMA completion queue");
+  }
+  if (ibv_req_notify_cq(cq_, /*solicited_only=*/0) != 0) {
+    return ErrnoError("Failed to arm the RDMA completion queue");
+  }
+  polling_thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "rdma_completions", [this]() { PollCompletions(); }));
+  LOG(INFO) << "Using RDMA device " << ibv_get_device_name(context_->device)
+            << " port " << static_cast<int>(port_);
+  return Status::OK();
+}
+
+RdmaAdapter::~RdmaAdapter() {
+  cancelled_ = true;
+  polling_thread_.reset();
+  if (cq_ != nullptr) {
+    ibv_destroy_cq(cq_);
+  }
+  if (completion_channel_ != nullptr) {
+    ibv_destroy_comp_channel(completion_channel_);
+  }
+  if (pd_ != nullptr) {
+    ibv_dealloc_pd(pd_);
+  }
+  if (context_ != nullptr) {
+    ibv_close_device(context_);
+  }
+}
+
+Status RdmaAdapter::CreateChannel(std::unique_ptr<RdmaChannel>* out) {
+  std::unique_ptr<RdmaChannel> channel(new RdmaChannel(this));
+  TF_RETURN_IF_ERROR(channel->Init());
+  *out = std::move(channel);
+  return Status::OK();
+}
+
+ibv_mr* RdmaAdapter::RegisterMemory(void* ptr, size_t size) {
+  return ibv_reg_mr(pd_, ptr, size,
+                    IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+}
+
+/* static */
+void RdmaAdapter::DeregisterMemory(ibv_mr* mr) {
+  if (ibv_dereg_mr(mr) != 0) {
+    LOG(WARNING) << ErrnoError("Failed to deregister RDMA memory");
+  }
+}
+
+void RdmaAdapter::PollCompletions() {
+  ibv_wc completions[kMaxCompletionsPerPoll];
+  while (!cancelled_) {
+    pollfd fd;
+    fd.fd = completion_channel_->fd;
+    fd.events = POLLIN;
+    fd.revents = 0;
+    if (poll(&fd, 1, kPollTimeoutMs) <= 0) {
+      continue;
+    }
+    ibv_cq* cq;
+    void* cq_context;
+    if (ibv_get_cq_event(completion_channel_, &cq, &cq_context) != 0) {
+      continue;
+    }
+    ibv_ack_cq_events(cq, 1);
+    if (ibv_req_notify_cq(cq, /*solicited_only=*/0) != 0) {
+      LOG(ERROR) << ErrnoError("Failed to arm the RDMA completion queue");
+    }
+    int num_completions;
+    while ((num_completions =
+                ibv_poll_cq(cq, kMaxCompletionsPerPoll, completions)) > 0) {
+      for (int i = 0; i < num_completions; ++i) {
+        const ibv_wc& wc = completions[i];
+        Status s;
+        if (wc.status != IBV_WC_SUCCESS) {
+          s = errors::Internal("RDMA write failed: ",
+                               ibv_wc_status_str(wc.status));
+        }
+        // Only the last work request of a write is signaled. The others
+        // complete silently unless they fail.
+        if (wc.wr_id == 0) {
+          LOG(WARNING) << s;
+          continue;
+        }
+        auto* done = reinterpret_cast<StatusCallback*>(wc.wr_id);
+        (*done)(s);
+        delete done;
+      }
+    }
+  }
+}
+
+RdmaChannel::~RdmaChannel() {
+  if (qp_ != nullptr) {
+    ibv_destroy_qp(qp_);
+  }
+}
+
+Status RdmaChannel::Init() {
+  ibv_qp_init_attr init_attr;
+  memset(&init_attr, 0, sizeof(init_attr));
+  init_attr.send_cq = adapter_->cq_;
+  init_attr.recv_cq = adapter_->cq_;
+  init_attr.qp_type = IBV_QPT_RC;
+  init_attr.cap.max_send_wr = kMaxSendWorkRequests;
+  init_attr.cap.max_recv_wr = 1;
+  init_attr.cap.max_send_sge = 1;
+  init_attr.cap.max_recv_sge = 1;
+  qp_ = ibv_create_qp(adapter_->pd_, &init_attr);
+  if (qp_ == nullptr) {
+    return ErrnoError("Failed to create an RDMA queue pair");
+  }
+
+  ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_INIT;
+  attr.pkey_index = 0;
+  attr.port_num = adapter_->port_;
+  attr.qp_access_flags = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE;
+  if (ibv_modify_qp(qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT |
+                        IBV_QP_ACCESS_FLAGS) != 0) {
+    return ErrnoError("Failed to initialize an RDMA queue pair");
+  }
+
+  local_endpoint_.set_lid(adapter_->port_attr_.lid);
+  local_endpoint_.set_qpn(qp_->qp_num);
+  local_endpoint_.set_psn(random::New64() & 0xffffff);
+  local_endpoint_.set_gid(adapter_->gid_.raw, sizeof(adapter_->gid_.raw));
+  return Status::OK();
+}
+
+Status RdmaChannel::Connect(const RdmaEndpoint& remote) {
+  ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTR;
+  attr.path_mtu = adapter_->port_attr_.active_mtu;
+  attr.dest_qp_num = remote.qpn();
+  attr.rq_psn = remote.psn();
+  attr.max_dest_rd_atomic = 1;
+  attr.min_rnr_timer = 12;
+  attr.ah_attr.dlid = remote.lid();
+  attr.ah_attr.sl = 0;
+  attr.ah_attr.src_path_bits = 0;
+  attr.ah_attr.port_num = adapter_->port_;
+  // RoCE fabrics have no local identifiers and route by GID.
+  if (adapter_->port_attr_.link_layer == IBV_LINK_LAYER_ETHERNET ||
+      remote.lid() == 0) {
+    if (remote.gid().size() != sizeof(attr.ah_attr.grh.dgid.raw)) {
+      return errors::InvalidArgument("Invalid RDMA endpoint GID of ",
+                                     remote.gid().size(), " bytes.");
+    }
+    attr.ah_attr.is_global = 1;
+    memcpy(attr.ah_attr.grh.dgid.raw, remote.gid().data(),
+           remote.gid().size());
+    attr.ah_attr.grh.sgid_index = adapter_->gid_index_;
+    attr.ah_attr.grh.hop_limit = 64;
+  }
+  if (ibv_modify_qp(qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU |
+                        IBV_QP_DEST_QPN | IBV_QP_RQ_PSN |
+                        IBV_QP_MAX_DEST_RD_ATOMIC |
+                        IBV_QP_MIN_RNR_TIMER) != 0) {
+    return ErrnoError("Failed to connect an RDMA queue pair");
+  }
+
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTS;
+  attr.timeout = 14;
+  attr.retry_cnt = 7;
+  attr.rnr_retry = 7;
+  attr.sq_psn = local_endpoint_.psn();
+  attr.max_rd_atomic = 1;
+  if (ibv_modify_qp(qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT |
+                        IBV_QP_RNR_RETRY | IBV_QP_SQ_PSN |
+                        IBV_QP_MAX_QP_RD_ATOMIC) != 0) {
+    return ErrnoError("Failed to activate an RDMA queue pair");
+  }
+  return Status::OK();
+}
+
+void RdmaChannel::Write(const void* local_addr, uint32 lkey,
+                        uint64 remote_addr, uint32 rkey, uint64 length,
+                        StatusCallback done) {
+  if (length == 0) {
+    done(Status::OK());
+    return;
+  }
+  const uint64 num_requests = (length + kMaxWriteBytes - 1) / kMaxWriteBytes;
+  std::vector<ibv_sge> sges(num_requests);
+  std::vector<ibv_send_wr> requests(num_requests);
+  const uint64 local_begin = reinterpret_cast<uint64>(local_addr);
+  for (uint64 i = 0; i < num_requests; ++i) {
+    const uint64 offset = i * kMaxWriteBytes;
+    sges[i].addr = local_begin + offset;
+    sges[i].length = std::min(kMaxWriteBytes, length - offset);
+    sges[i].lkey = lkey;
+    ibv_send_wr& request = requests[i];
+    memset(&request, 0, sizeof(request));
+    request.sg_list = &sges[i];
+    request.num_sge = 1;
+    request.opcode = IBV_WR_RDMA_WRITE;
+    request.wr.rdma.remote_addr = remote_addr + offset;
+    request.wr.rdma.rkey = rkey;
+    request.next = i + 1 < num_requests ? &requests[i + 1] : nullptr;
+  }
+  auto* callback = new StatusCallback(std::move(done));
+  requests.back().send_flags = IBV_SEND_SIGNALED;
+  requests.back().wr_id = reinterpret_cast<uint64>(callback);
+  ibv_send_wr* bad_request = nullptr;
+  if (ibv_post_send(qp_, requests.data(), &bad_request) != 0) {
+    Status s = ErrnoError("Failed to post an RDMA write");
+    (*callback)(s);
+    delete callback;
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,114 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_H_
+
+#include <infiniband/verbs.h>
+
+#include <atomic>
+#include <memory>
+
+#include "tensorflow/core/distributed_runtime/rdma/rdma_service.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class RdmaChannel;
+
+// An opened RDMA device port with the protection domain and completion queue
+// shared by all the channels of the process.
+//
+// The device is selected with TF_RDMA_DEVICE (by default the first device),
+// the port with TF_RDMA_PORT (by default 1), and the global identifier used
+// on RoCE fabrics with TF_RDMA_GID_INDEX (by default 0).
+class RdmaAdapter {
+ public:
+  static Status Create(std::unique_ptr<RdmaAdapter>* out);
+
+  ~RdmaAdapter();
+
+  RdmaAdapter(const RdmaAdapter&) = delete;
+  RdmaAdapter& operator=(const RdmaAdapter&) = delete;
+
+  // Creates a queue pair that still needs to be connected with
+  // `RdmaChannel::Connect`.
+  Status CreateChannel(std::unique_ptr<RdmaChannel>* out);
+
+  // Registers `size` bytes at `ptr` for local access and remote writes.
+  // Returns nullptr on failure.
+  ibv_mr* RegisterMemory(void* ptr, size_t size);
+  static void DeregisterMemory(ibv_mr* mr);
+
+ private:
+  friend class RdmaChannel;
+
+  RdmaAdapter() = default;
+
+  Status Init();
+
+  // Dispatches the work completions of `cq_` until `cancelled_` is set.
+  void PollCompletions();
+
+  ibv_context* context_ = nullptr;
+  ibv_pd* pd_ = nullptr;
+  ibv_comp_channel* completion_channel_ = nullptr;
+  ibv_cq* cq_ = nullptr;
+  uint8 port_ = 1;
+  int gid_index_ = 0;
+  ibv_port_attr port_attr_;
+  ibv_gid gid_;
+  std::atomic<bool> cancelled_{false};
+  std::unique_ptr<Thread> polling_thread_;
+};
+
+// One end of a reliable-connected queue pair. The tensors of a worker are
+// written into the memory of a peer over the channel connected to that
+// peer.
+class RdmaChannel {
+ public:
+  ~RdmaChannel();
+
+  RdmaChannel(const RdmaChannel&) = delete;
+  RdmaChannel& operator=(const RdmaChannel&) = delete;
+
+  const RdmaEndpoint& local_endpoint() const { return local_endpoint_; }
+
+  // Connects the queue pair to `remote`, after which it can be written to.
+  Status Connect(const RdmaEndpoint& remote);
+
+  // Writes `length` bytes at `local_addr`, which belong to a region
+  // registered with `lkey`, to `remote_addr` in a region of the peer
+  // registered with `rkey`. Calls `done` once the peer has acknowledged the
+  // write.
+  void Write(const void* local_addr, uint32 lkey, uint64 remote_addr,
+             uint32 rkey, uint64 length, StatusCallback done);
+
+ private:
+  friend class RdmaAdapter;
+
+  explicit RdmaChannel(RdmaAdapter* adapter) : adapter_(adapter) {}
+
+  Status Init();
+
+  RdmaAdapter* const adapter_;  // Not owned.
+  ibv_qp* qp_ = nullptr;
+  RdmaEndpoint local_endpoint_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_H_
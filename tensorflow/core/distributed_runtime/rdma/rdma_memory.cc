@@ -0,0 +1,166 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rdma/rdma_memory.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/process_state.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+#include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace tensorflow {
+
+RdmaMemoryRegistry::~RdmaMemoryRegistry() { Detach(); }
+
+/* static */
+RdmaMemoryRegistry* RdmaMemoryRegistry::Global() {
+  static RdmaMemoryRegistry* registry = new RdmaMemoryRegistry;
+  return registry;
+}
+
+void RdmaMemoryRegistry::AddRegion(void* ptr, size_t size, bool on_device) {
+  mutex_lock l(mu_);
+  const uintptr_t base = reinterpret_cast<uintptr_t>(ptr);
+  Region& region = regions_[base];
+  region.size = size;
+  region.on_device = on_device;
+  if (register_fn_) {
+    RegisterLocked(base, region);
+  }
+}
+
+void RdmaMemoryRegistry::RemoveRegion(void* ptr) {
+  mutex_lock l(mu_);
+  auto it = regions_.find(reinterpret_cast<uintptr_t>(ptr));
+  if (it == regions_.end()) {
+    return;
+  }
+  if (it->second.mr != nullptr) {
+    deregister_fn_(it->second.mr);
+    if (it->second.on_device) {
+      num_device_regions_--;
+    }
+  }
+  regions_.erase(it);
+}
+
+void RdmaMemoryRegistry::Attach(RegisterFn register_fn,
+                                DeregisterFn deregister_fn) {
+  mutex_lock l(mu_);
+  DCHECK(!register_fn_) << "RdmaMemoryRegistry is already attached.";
+  register_fn_ = std::move(register_fn);
+  deregister_fn_ = std::move(deregister_fn);
+  for (auto& entry : regions_) {
+    RegisterLocked(entry.first, entry.second);
+  }
+}
+
+void RdmaMemoryRegistry::Detach() {
+  mutex_lock l(mu_);
+  for (auto& entry : regions_) {
+    if (entry.second.mr != nullptr) {
+      deregister_fn_(entry.second.mr);
+      entry.second.mr = nullptr;
+    }
+  }
+  num_device_regions_ = 0;
+  register_fn_ = nullptr;
+  deregister_fn_ = nullptr;
+}
+
+ibv_mr* RdmaMemoryRegistry::Find(const void* ptr, size_t size) const {
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+  tf_shared_lock l(mu_);
+  auto it = regions_.upper_bound(begin);
+  if (it == regions_.begin()) {
+    return nullptr;
+  }
+  --it;
+  if (begin + size > it->first + it->second.size) {
+    return nullptr;
+  }
+  return it->second.mr;
+}
+
+bool RdmaMemoryRegistry::has_device_regions() const {
+  tf_shared_lock l(mu_);
+  return num_device_regions_ > 0;
+}
+
+void RdmaMemoryRegistry::RegisterLocked(uintptr_t base, Region& region) {
+  region.mr =
+      register_fn_(reinterpret_cast<void*>(base), region.size,
+                   region.on_device);
+  if (region.mr == nullptr) {
+    LOG(WARNING) << "Failed to register " << region.size << " bytes of "
+                 << (region.on_device ? "device" : "host")
+                 << " memory for RDMA. Transfers from this memory are "
+                 << (region.on_device ? "staged through host memory."
+                                      : "registered one by one.");
+  } else if (region.on_device) {
+    num_device_regions_++;
+  }
+}
+
+namespace {
+
+// Installs the allocator visitors feeding `RdmaMemoryRegistry::Global()`.
+// This runs before any allocator is created, as the process state requires.
+class RdmaAllocatorVisitorRegistrar {
+ public:
+  RdmaAllocatorVisitorRegistrar() {
+    RdmaMemoryRegistry* registry = RdmaMemoryRegistry::Global();
+    auto host_alloc = [registry](void* ptr, int index, size_t num_bytes) {
+      registry->AddRegion(ptr, num_bytes, /*on_device=*/false);
+    };
+    auto device_alloc = [registry](void* ptr, int index, size_t num_bytes) {
+      registry->AddRegion(ptr, num_bytes, /*on_device=*/true);
+    };
+    auto free = [registry](void* ptr, int index, size_t num_bytes) {
+      registry->RemoveRegion(ptr);
+    };
+    ProcessState::singleton()->AddCPUAllocVisitor(host_alloc);
+    ProcessState::singleton()->AddCPUFreeVisitor(free);
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+    bool gpu_direct = false;
+    Status s = ReadBoolFromEnvVar("TF_RDMA_GPU_DIRECT", false, &gpu_direct);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+    }
+    const int num_nodes = std::max(1, port::NUMANumNodes());
+    for (int node = 0; node < num_nodes; ++node) {
+      GPUProcessState::singleton()->AddGpuHostAllocVisitor(node, host_alloc);
+      GPUProcessState::singleton()->AddGpuHostFreeVisitor(node, free);
+      if (gpu_direct) {
+        GPUProcessState::singleton()->AddGPUAllocVisitor(node, device_alloc);
+      }
+    }
+#else
+    (void)device_alloc;
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  }
+};
+
+static RdmaAllocatorVisitorRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
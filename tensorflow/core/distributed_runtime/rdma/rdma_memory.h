@@ -0,0 +1,98 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_MEMORY_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_MEMORY_H_
+
+#include <infiniband/verbs.h>
+
+#include <functional>
+#include <map>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Tracks the memory regions of the process allocators and their registration
+// with an RDMA protection domain.
+//
+// Linking this library installs allocator visitors that record every region
+// the CPU and pinned host suballocators hand to their allocators, and, when
+// TF_RDMA_GPU_DIRECT is set, the regions of the GPU suballocators. Once an
+// RDMA device has been opened, `Attach` registers the regions recorded so
+// far and every region recorded afterwards, so tensors allocated from these
+// allocators can be read and written by RDMA operations without registering
+// their buffers one by one.
+class RdmaMemoryRegistry {
+ public:
+  // Registers `size` bytes at `ptr` and returns the registration, or nullptr
+  // if the memory cannot be registered.
+  using RegisterFn =
+      std::function<ibv_mr*(void* ptr, size_t size, bool on_device)>;
+  using DeregisterFn = std::function<void(ibv_mr* mr)>;
+
+  RdmaMemoryRegistry() = default;
+  ~RdmaMemoryRegistry();
+
+  RdmaMemoryRegistry(const RdmaMemoryRegistry&) = delete;
+  RdmaMemoryRegistry& operator=(const RdmaMemoryRegistry&) = delete;
+
+  // The registry fed by the allocator visitors.
+  static RdmaMemoryRegistry* Global();
+
+  // Records a region allocated by a suballocator. `on_device` is true for
+  // GPU memory.
+  void AddRegion(void* ptr, size_t size, bool on_device);
+
+  // Forgets the region starting at `ptr`, deregistering it if needed.
+  void RemoveRegion(void* ptr);
+
+  // Registers all recorded regions, and the regions recorded from now on,
+  // with `register_fn`. Regions that fail to register are skipped.
+  void Attach(RegisterFn register_fn, DeregisterFn deregister_fn);
+
+  // Deregisters all regions. Regions are recorded but no longer registered
+  // until the next call to `Attach`.
+  void Detach();
+
+  // Returns the registration of the region containing the `size` bytes at
+  // `ptr`, or nullptr if these bytes are not in a registered region.
+  ibv_mr* Find(const void* ptr, size_t size) const;
+
+  // Whether at least one region of GPU memory is registered.
+  bool has_device_regions() const;
+
+ private:
+  struct Region {
+    size_t size;
+    bool on_device;
+    ibv_mr* mr = nullptr;
+  };
+
+  void RegisterLocked(uintptr_t base, Region& region)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  // Maps the base address of every region to the region.
+  std::map<uintptr_t, Region> regions_ TF_GUARDED_BY(mu_);
+  RegisterFn register_fn_ TF_GUARDED_BY(mu_);
+  DeregisterFn deregister_fn_ TF_GUARDED_BY(mu_);
+  int64 num_device_regions_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_MEMORY_H_
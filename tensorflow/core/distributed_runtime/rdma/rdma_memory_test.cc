@@ -0,0 +1,125 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rdma/rdma_memory.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Hands out fake registrations and records which ones are live.
+class FakeRegistrar {
+ public:
+  RdmaMemoryRegistry::RegisterFn register_fn(bool fail_on_device = false) {
+    return [this, fail_on_device](void* ptr, size_t size,
+                                  bool on_device) -> ibv_mr* {
+      if (on_device && fail_on_device) {
+        return nullptr;
+      }
+      mrs_.push_back(absl::make_unique<ibv_mr>());
+      ibv_mr* mr = mrs_.back().get();
+      mr->addr = ptr;
+      mr->length = size;
+      mr->lkey = mrs_.size();
+      num_live_++;
+      return mr;
+    };
+  }
+
+  RdmaMemoryRegistry::DeregisterFn deregister_fn() {
+    return [this](ibv_mr* mr) { num_live_--; };
+  }
+
+  int num_live() const { return num_live_; }
+
+ private:
+  std::vector<std::unique_ptr<ibv_mr>> mrs_;
+  int num_live_ = 0;
+};
+
+TEST(RdmaMemoryRegistryTest, RegistersRegionsRecordedBeforeAttach) {
+  char buffer[256];
+  FakeRegistrar registrar;
+  RdmaMemoryRegistry registry;
+  registry.AddRegion(buffer, sizeof(buffer), /*on_device=*/false);
+  EXPECT_EQ(nullptr, registry.Find(buffer, 16));
+
+  registry.Attach(registrar.register_fn(), registrar.deregister_fn());
+  EXPECT_EQ(1, registrar.num_live());
+  ibv_mr* mr = registry.Find(buffer + 16, 64);
+  ASSERT_NE(nullptr, mr);
+  EXPECT_EQ(buffer, mr->addr);
+
+  registry.Detach();
+  EXPECT_EQ(0, registrar.num_live());
+  EXPECT_EQ(nullptr, registry.Find(buffer, 16));
+}
+
+TEST(RdmaMemoryRegistryTest, FindRequiresTheWholeRange) {
+  char buffer[256];
+  FakeRegistrar registrar;
+  RdmaMemoryRegistry registry;
+  registry.Attach(registrar.register_fn(), registrar.deregister_fn());
+  registry.AddRegion(buffer + 64, 128, /*on_device=*/false);
+
+  EXPECT_NE(nullptr, registry.Find(buffer + 64, 128));
+  EXPECT_NE(nullptr, registry.Find(buffer + 100, 92));
+  EXPECT_EQ(nullptr, registry.Find(buffer, 16));
+  EXPECT_EQ(nullptr, registry.Find(buffer + 32, 64));
+  EXPECT_EQ(nullptr, registry.Find(buffer + 128, 128));
+}
+
+TEST(RdmaMemoryRegistryTest, RemoveRegionDeregisters) {
+  char first[64];
+  char second[64];
+  FakeRegistrar registrar;
+  RdmaMemoryRegistry registry;
+  registry.Attach(registrar.register_fn(), registrar.deregister_fn());
+  registry.AddRegion(first, sizeof(first), /*on_device=*/false);
+  registry.AddRegion(second, sizeof(second), /*on_device=*/false);
+  EXPECT_EQ(2, registrar.num_live());
+
+  registry.RemoveRegion(first);
+  EXPECT_EQ(1, registrar.num_live());
+  EXPECT_EQ(nullptr, registry.Find(first, 8));
+  EXPECT_NE(nullptr, registry.Find(second, 8));
+}
+
+TEST(RdmaMemoryRegistryTest, DeviceRegions) {
+  char host[64];
+  char device[64];
+  FakeRegistrar registrar;
+  RdmaMemoryRegistry registry;
+  registry.AddRegion(host, sizeof(host), /*on_device=*/false);
+  registry.AddRegion(device, sizeof(device), /*on_device=*/true);
+
+  registry.Attach(registrar.register_fn(/*fail_on_device=*/true),
+                  registrar.deregister_fn());
+  EXPECT_FALSE(registry.has_device_regions());
+  EXPECT_NE(nullptr, registry.Find(host, 8));
+  EXPECT_EQ(nullptr, registry.Find(device, 8));
+  registry.Detach();
+
+  registry.Attach(registrar.register_fn(), registrar.deregister_fn());
+  EXPECT_TRUE(registry.has_device_regions());
+  EXPECT_NE(nullptr, registry.Find(device, 8));
+}
+
+}  // namespace
+}  // namespace tensorflow
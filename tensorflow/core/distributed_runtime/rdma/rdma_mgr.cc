@@ -0,0 +1,371 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rdma/rdma_mgr.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/rdma/rdma_memory.h"
+#include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kDefaultInlineBytes = 64 << 10;
+// Transfers not claimed by their receiver within this time are dropped. A
+// receiver claims its transfer right after the metadata of the tensor
+// arrives, so this only frees the tensors of receivers that went away.
+constexpr int64 kTransferTimeoutMicros = 10 * 60 * 1000 * 1000ll;
+
+}  // namespace
+
+RdmaMgr::RdmaMgr(const WorkerEnv* env, std::unique_ptr<RdmaAdapter> adapter)
+    : env_(env), adapter_(std::move(adapter)) {
+  Status s = ReadInt64FromEnvVar("TF_RDMA_INLINE_BYTES", kDefaultInlineBytes,
+                                 &inline_bytes_);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    inline_bytes_ = kDefaultInlineBytes;
+  }
+  RdmaAdapter* raw_adapter = adapter_.get();
+  RdmaMemoryRegistry::Global()->Attach(
+      [raw_adapter](void* ptr, size_t size, bool on_device) {
+        return raw_adapter->RegisterMemory(ptr, size);
+      },
+      RdmaAdapter::DeregisterMemory);
+}
+
+RdmaMgr::~RdmaMgr() {
+  RdmaMemoryRegistry::Global()->Detach();
+  mutex_lock l(mu_);
+  for (auto& entry : transfers_) {
+    if (entry.second->transient) {
+      RdmaAdapter::DeregisterMemory(entry.second->mr);
+    }
+  }
+}
+
+void RdmaMgr::Start(const string& local_worker,
+                    std::shared_ptr<GrpcChannelCache> channel_cache,
+                    ::grpc::CompletionQueue* cq,
+                    thread::ThreadPool* callback_threadpool) {
+  local_worker_ = local_worker;
+  channel_cache_ = std::move(channel_cache);
+  cq_ = cq;
+  callback_threadpool_ = callback_threadpool;
+}
+
+Status RdmaMgr::GetPeer(const string& name, Peer** peer) {
+  mutex_lock l(mu_);
+  std::unique_ptr<Peer>& entry = peers_[name];
+  if (entry == nullptr) {
+    SharedGrpcChannelPtr channel = channel_cache_->FindWorkerChannel(name);
+    if (channel == nullptr) {
+      peers_.erase(name);
+      return errors::Internal("No worker known as ", name);
+    }
+    entry = absl::make_unique<Peer>();
+    entry->name = name;
+    entry->stub = absl::make_unique<::grpc::GenericStub>(channel);
+  }
+  *peer = entry.get();
+  return Status::OK();
+}
+
+void RdmaMgr::ConnectAsync(const string& peer_name, StatusCallback done) {
+  Peer* peer;
+  Status s = GetPeer(peer_name, &peer);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  bool connected;
+  {
+    mutex_lock l(mu_);
+    connected = peer->connected;
+    if (!connected) {
+      peer->waiters.push_back(std::move(done));
+      if (peer->waiters.size() > 1) {
+        // Another receive is setting up the connection.
+        return;
+      }
+      s = adapter_->CreateChannel(&peer->channel);
+    }
+  }
+  if (connected) {
+    done(Status::OK());
+    return;
+  }
+  if (!s.ok()) {
+    FinishConnect(peer, s);
+    return;
+  }
+  auto request = std::make_shared<RdmaConnectRequest>();
+  auto response = std::make_shared<RdmaConnectResponse>();
+  request->set_source_worker(local_worker_);
+  *request->mutable_endpoint() = peer->channel->local_endpoint();
+  IssueRequest(peer_name, kRdmaConnectMethod, *request, response.get(),
+               [this, peer, request, response](const Status& s) {
+                 if (!s.ok()) {
+                   FinishConnect(peer, s);
+                   return;
+                 }
+                 FinishConnect(peer,
+                               peer->channel->Connect(response->endpoint()));
+               });
+}
+
+void RdmaMgr::FinishConnect(Peer* peer, const Status& status) {
+  std::vector<StatusCallback> waiters;
+  {
+    mutex_lock l(mu_);
+    peer->connected = status.ok();
+    if (!status.ok()) {
+      // The next receive retries with a new queue pair.
+      peer->channel.reset();
+    }
+    std::swap(waiters, peer->waiters);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to connect to " << peer->name
+                 << " over RDMA: " << status;
+  }
+  for (const auto& waiter : waiters) {
+    waiter(status);
+  }
+}
+
+void RdmaMgr::IssueRequest(const string& peer_name,
+                           const ::grpc::string& method,
+                           const protobuf::Message& request,
+                           protobuf::Message* response, StatusCallback done,
+                           CallOptions* call_opts) {
+  Peer* peer;
+  Status s = GetPeer(peer_name, &peer);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  new RPCState<protobuf::Message>(peer->stub.get(), cq_, method, request,
+                                  response, std::move(done), call_opts,
+                                  callback_threadpool_, /*max_retries=*/0,
+                                  /*fail_fast=*/true, &peer->name);
+}
+
+ibv_mr* RdmaMgr::FindOrRegister(const void* ptr, size_t size,
+                                bool* transient) {
+  ibv_mr* mr = RdmaMemoryRegistry::Global()->Find(ptr, size);
+  *transient = mr == nullptr;
+  if (mr == nullptr) {
+    mr = adapter_->RegisterMemory(const_cast<void*>(ptr), size);
+  }
+  return mr;
+}
+
+Status RdmaMgr::Connect(const RdmaConnectRequest* request,
+                        RdmaConnectResponse* response) {
+  std::unique_ptr<RdmaChannel> channel;
+  TF_RETURN_IF_ERROR(adapter_->CreateChannel(&channel));
+  TF_RETURN_IF_ERROR(channel->Connect(request->endpoint()));
+  *response->mutable_endpoint() = channel->local_endpoint();
+  mutex_lock l(mu_);
+  // A peer reconnects after it was restarted. Writes still in flight on the
+  // previous queue pair keep it alive until they complete.
+  remote_channels_[request->source_worker()] = std::move(channel);
+  VLOG(1) << "Connected to " << request->source_worker() << " over RDMA";
+  return Status::OK();
+}
+
+Status RdmaMgr::RecvTensor(const RdmaRecvTensorRequest* request,
+                           RdmaRecvTensorResponse* response) {
+  Rendezvous::ParsedKey parsed;
+  TF_RETURN_IF_ERROR(Rendezvous::ParseKey(request->rendezvous_key(), &parsed));
+  Device* src_dev;
+  TF_RETURN_IF_ERROR(env_->device_mgr->LookupDevice(
+      DeviceNameUtils::LocalName(parsed.src_device), &src_dev));
+  if (src_dev->attributes().incarnation() != parsed.src_incarnation) {
+    return errors::Aborted(
+        "RecvTensor expects a different device incarnation: ",
+        parsed.src_incarnation, " vs. ", src_dev->attributes().incarnation(),
+        ". The worker was probably restarted.");
+  }
+
+  Notification n;
+  Status status;
+  Rendezvous::Args send_args;
+  Tensor val;
+  bool is_dead = false;
+  env_->rendezvous_mgr->RecvLocalAsync(
+      request->step_id(), parsed,
+      [&](const Status& s, const Rendezvous::Args& args,
+          const Rendezvous::Args& recv_args, const Tensor& v, bool dead) {
+        status = s;
+        send_args = args;
+        val = v;
+        is_dead = dead;
+        n.Notify();
+      });
+  n.WaitForNotification();
+  TF_RETURN_IF_ERROR(status);
+  response->set_is_dead(is_dead);
+  if (is_dead) {
+    return Status::OK();
+  }
+
+  // Tensors in GPU memory are written directly when that memory is
+  // registered, and copied to pinned host memory otherwise.
+  if (src_dev->tensorflow_gpu_device_info() != nullptr &&
+      !send_args.alloc_attrs.on_host() &&
+      RdmaMemoryRegistry::Global()->Find(DMAHelper::base(&val),
+                                         val.TotalBytes()) == nullptr) {
+    AllocatorAttributes alloc_attrs;
+    alloc_attrs.set_gpu_compatible(true);
+    alloc_attrs.set_on_host(true);
+    Tensor copy(src_dev->GetAllocator(alloc_attrs), val.dtype(), val.shape());
+    CHECK(send_args.device_context)
+        << "send dev name: " << src_dev->name()
+        << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
+    TF_RETURN_IF_ERROR(send_args.device_context->CopyDeviceTensorToCPUSync(
+        &val, request->rendezvous_key(), src_dev, &copy));
+    val = std::move(copy);
+  }
+  PrepareResponse(val, response);
+  return Status::OK();
+}
+
+void RdmaMgr::PrepareResponse(const Tensor& tensor,
+                              RdmaRecvTensorResponse* response) {
+  if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+    tensor.AsProtoField(response->mutable_tensor());
+    return;
+  }
+  const int64 bytes = tensor.TotalBytes();
+  ibv_mr* mr = nullptr;
+  bool transient = false;
+  if (bytes >= inline_bytes_) {
+    mr = FindOrRegister(DMAHelper::base(&tensor), bytes, &transient);
+    if (mr == nullptr) {
+      VLOG(1) << "Failed to register " << bytes
+              << " bytes for RDMA, sending them over gRPC.";
+    }
+  }
+  if (mr == nullptr) {
+    tensor.AsProtoTensorContent(response->mutable_tensor());
+    return;
+  }
+  response->mutable_tensor()->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(response->mutable_tensor()->mutable_tensor_shape());
+  auto transfer = absl::make_unique<Transfer>();
+  transfer->tensor = tensor;
+  transfer->mr = mr;
+  transfer->transient = transient;
+  transfer->created_micros = env_->env->NowMicros();
+  const int64 transfer_id = next_transfer_id_++;
+  response->set_transfer_id(transfer_id);
+  mutex_lock l(mu_);
+  ReapTransfersLocked(transfer->created_micros);
+  transfers_[transfer_id] = std::move(transfer);
+}
+
+std::unique_ptr<RdmaMgr::Transfer> RdmaMgr::TakeTransfer(int64 transfer_id) {
+  mutex_lock l(mu_);
+  auto it = transfers_.find(transfer_id);
+  if (it == transfers_.end()) {
+    return nullptr;
+  }
+  std::unique_ptr<Transfer> transfer = std::move(it->second);
+  transfers_.erase(it);
+  return transfer;
+}
+
+void RdmaMgr::ReapTransfersLocked(int64 now_micros) {
+  if (now_micros - last_reap_micros_ < kTransferTimeoutMicros) {
+    return;
+  }
+  last_reap_micros_ = now_micros;
+  for (auto it = transfers_.begin(); it != transfers_.end();) {
+    if (now_micros - it->second->created_micros < kTransferTimeoutMicros) {
+      ++it;
+      continue;
+    }
+    LOG(WARNING) << "Dropping an RDMA transfer of "
+                 << it->second->tensor.TotalBytes()
+                 << " bytes that was never claimed.";
+    if (it->second->transient) {
+      RdmaAdapter::DeregisterMemory(it->second->mr);
+    }
+    transfers_.erase(it++);
+  }
+}
+
+Status RdmaMgr::WriteTensor(const RdmaWriteTensorRequest* request,
+                            RdmaWriteTensorResponse* response) {
+  std::unique_ptr<Transfer> transfer = TakeTransfer(request->transfer_id());
+  if (transfer == nullptr) {
+    return errors::NotFound("RDMA transfer ", request->transfer_id(),
+                            " not found. It may have timed out.");
+  }
+  std::shared_ptr<RdmaChannel> channel;
+  {
+    mutex_lock l(mu_);
+    auto it = remote_channels_.find(request->source_worker());
+    if (it != remote_channels_.end()) {
+      channel = it->second;
+    }
+  }
+  Status s;
+  if (channel == nullptr) {
+    s = errors::FailedPrecondition("No RDMA connection to ",
+                                   request->source_worker());
+  } else if (request->length() != transfer->tensor.TotalBytes()) {
+    s = errors::InvalidArgument("Expected a buffer of ",
+                                transfer->tensor.TotalBytes(),
+                                " bytes for the RDMA transfer but got ",
+                                request->length());
+  } else {
+    Notification n;
+    channel->Write(DMAHelper::base(&transfer->tensor), transfer->mr->lkey,
+                   request->remote_addr(), request->rkey(), request->length(),
+                   [&s, &n](const Status& write_status) {
+                     s = write_status;
+                     n.Notify();
+                   });
+    n.WaitForNotification();
+  }
+  if (transfer->transient) {
+    RdmaAdapter::DeregisterMemory(transfer->mr);
+  }
+  return s;
+}
+
+Status RdmaMgr::ReleaseTensor(const RdmaReleaseTensorRequest* request,
+                              RdmaReleaseTensorResponse* response) {
+  std::unique_ptr<Transfer> transfer = TakeTransfer(request->transfer_id());
+  if (transfer != nullptr && transfer->transient) {
+    RdmaAdapter::DeregisterMemory(transfer->mr);
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
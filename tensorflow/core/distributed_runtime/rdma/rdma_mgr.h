@@ -0,0 +1,156 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_MGR_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_MGR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "grpcpp/generic/generic_stub.h"
+#include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/rdma/rdma.h"
+#include "tensorflow/core/distributed_runtime/rdma/rdma_service.pb.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// The full names of the methods of the RDMA service, for
+// `RdmaMgr::IssueRequest`.
+constexpr char kRdmaConnectMethod[] = "/tensorflow.RdmaService/Connect";
+constexpr char kRdmaRecvTensorMethod[] = "/tensorflow.RdmaService/RecvTensor";
+constexpr char kRdmaWriteTensorMethod[] =
+    "/tensorflow.RdmaService/WriteTensor";
+constexpr char kRdmaReleaseTensorMethod[] =
+    "/tensorflow.RdmaService/ReleaseTensor";
+
+// The state shared by the receiving and the sending side of the RDMA
+// transport of a worker.
+//
+// A worker that receives a tensor from a peer asks the peer, over gRPC, for
+// the metadata of the tensor. Small tensors and tensors that cannot be
+// copied byte for byte come back inline. For the others, the receiver
+// allocates the destination in registered memory and asks the peer to write
+// the content there with a one-sided RDMA write on the queue pair connecting
+// the two workers. Queue pairs are connected lazily, by the receiving side,
+// through the `Connect` RPC.
+class RdmaMgr {
+ public:
+  RdmaMgr(const WorkerEnv* env, std::unique_ptr<RdmaAdapter> adapter);
+  ~RdmaMgr();
+
+  RdmaMgr(const RdmaMgr&) = delete;
+  RdmaMgr& operator=(const RdmaMgr&) = delete;
+
+  // Sets up the control channels to the peers. Must be called before this
+  // worker receives tensors. `cq` and `callback_threadpool` drive the
+  // control RPCs.
+  void Start(const string& local_worker,
+             std::shared_ptr<GrpcChannelCache> channel_cache,
+             ::grpc::CompletionQueue* cq,
+             thread::ThreadPool* callback_threadpool);
+
+  const string& local_worker() const { return local_worker_; }
+  RdmaAdapter* adapter() const { return adapter_.get(); }
+
+  // Receiving side.
+
+  // Calls `done` once the queue pair used by `peer` to write tensors to this
+  // worker is connected.
+  void ConnectAsync(const string& peer, StatusCallback done);
+
+  // Issues the control RPC `method` of the RDMA service of `peer`.
+  void IssueRequest(const string& peer, const ::grpc::string& method,
+                    const protobuf::Message& request,
+                    protobuf::Message* response, StatusCallback done,
+                    CallOptions* call_opts = nullptr);
+
+  // Returns the registration of the `size` bytes at `ptr`. If the memory is
+  // not in a region registered ahead of time, it is registered on the spot
+  // and `*transient` is set, in which case the caller must deregister it
+  // with `RdmaAdapter::DeregisterMemory` once done. Returns nullptr on
+  // failure.
+  ibv_mr* FindOrRegister(const void* ptr, size_t size, bool* transient);
+
+  // Sending side: the handlers of the RDMA service.
+
+  Status Connect(const RdmaConnectRequest* request,
+                 RdmaConnectResponse* response);
+  Status RecvTensor(const RdmaRecvTensorRequest* request,
+                    RdmaRecvTensorResponse* response);
+  Status WriteTensor(const RdmaWriteTensorRequest* request,
+                     RdmaWriteTensorResponse* response);
+  Status ReleaseTensor(const RdmaReleaseTensorRequest* request,
+                       RdmaReleaseTensorResponse* response);
+
+ private:
+  // A connection to a peer this worker receives tensors from.
+  struct Peer {
+    string name;
+    std::unique_ptr<::grpc::GenericStub> stub;
+    std::unique_ptr<RdmaChannel> channel;
+    bool connected = false;
+    // The callbacks waiting for the connection being set up, if any.
+    std::vector<StatusCallback> waiters;
+  };
+
+  // A tensor held by this worker until the peer asks it to be written.
+  struct Transfer {
+    Tensor tensor;
+    ibv_mr* mr;
+    bool transient;
+    int64 created_micros;
+  };
+
+  Status GetPeer(const string& name, Peer** peer);
+  void FinishConnect(Peer* peer, const Status& status);
+  // Either registers the content of `tensor` for a transfer and sets
+  // `response->transfer_id`, or encodes it inline in `response`.
+  void PrepareResponse(const Tensor& tensor, RdmaRecvTensorResponse* response);
+  std::unique_ptr<Transfer> TakeTransfer(int64 transfer_id);
+  // Drops the transfers the receivers have not claimed for a long time.
+  void ReapTransfersLocked(int64 now_micros) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const WorkerEnv* const env_;  // Not owned.
+  const std::unique_ptr<RdmaAdapter> adapter_;
+  // Tensors smaller than this are sent inline with their metadata.
+  int64 inline_bytes_;
+
+  string local_worker_;
+  std::shared_ptr<GrpcChannelCache> channel_cache_;
+  ::grpc::CompletionQueue* cq_ = nullptr;  // Not owned.
+  thread::ThreadPool* callback_threadpool_ = nullptr;  // Not owned.
+
+  mutex mu_;
+  std::unordered_map<string, std::unique_ptr<Peer>> peers_ TF_GUARDED_BY(mu_);
+  // The queue pairs used to write to the peers, keyed by peer. A channel may
+  // outlive its entry while a write on it is in flight.
+  std::unordered_map<string, std::shared_ptr<RdmaChannel>> remote_channels_
+      TF_GUARDED_BY(mu_);
+  std::unordered_map<int64, std::unique_ptr<Transfer>> transfers_
+      TF_GUARDED_BY(mu_);
+  int64 last_reap_micros_ TF_GUARDED_BY(mu_) = 0;
+  std::atomic<int64> next_transfer_id_{1};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_MGR_H_
@@ -0,0 +1,338 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rdma/rdma_rendezvous_mgr.h"
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/rdma/rdma_memory.h"
+#include "tensorflow/core/distributed_runtime/worker_session.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+class RdmaRemoteRendezvous : public BaseRemoteRendezvous {
+ public:
+  RdmaRemoteRendezvous(const WorkerEnv* env, int64 step_id, RdmaMgr* rdma_mgr)
+      : BaseRemoteRendezvous(env, step_id), rdma_mgr_(rdma_mgr) {}
+
+ protected:
+  void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                           const Rendezvous::Args& args,
+                           DoneCallback done) override;
+
+ private:
+  ~RdmaRemoteRendezvous() override {}
+
+  RdmaMgr* const rdma_mgr_;  // Not owned.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaRemoteRendezvous);
+};
+
+// Receives one tensor from a remote worker. The metadata comes first; the
+// content comes either inline or through an RDMA write into the buffer
+// allocated for the tensor.
+class RdmaRecvTensorCall : public BaseRecvTensorCall {
+ public:
+  RdmaRecvTensorCall(RdmaMgr* rdma_mgr, int64 step_id, StringPiece key,
+                     const string& src_worker, Device* dst_device,
+                     const Rendezvous::Args& recv_args)
+      : rdma_mgr_(rdma_mgr),
+        src_worker_(src_worker),
+        dst_device_(dst_device),
+        recv_args_(recv_args) {
+    request_.set_source_worker(rdma_mgr_->local_worker());
+    request_.set_step_id(step_id);
+    request_.set_rendezvous_key(key.data(), key.size());
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    recv_done_ = std::move(recv_done);
+    rdma_mgr_->ConnectAsync(src_worker_, [this](const Status& s) {
+      if (!s.ok()) {
+        Finish(s);
+        return;
+      }
+      RecvMetadata();
+    });
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  const Tensor& tensor() const { return tensor_; }
+  bool is_dead() const { return response_.is_dead(); }
+  const Rendezvous::Args& recv_args() const { return recv_args_; }
+
+ private:
+  bool on_host() const {
+    return recv_args_.alloc_attrs.on_host() ||
+           dst_device_->attributes().device_type() == "CPU";
+  }
+
+  // Waits for the tensor to be produced by the remote worker, checking for
+  // an async abort like `RpcRecvTensorCall`.
+  void RecvMetadata() {
+    auto abort_checked = std::make_shared<Notification>();
+    rdma_mgr_->IssueRequest(
+        src_worker_, kRdmaRecvTensorMethod, request_, &response_,
+        [this, abort_checked](const Status& s) {
+          abort_checked->WaitForNotification();
+          OnMetadata(s);
+        },
+        &opts_);
+    if (!status().ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void OnMetadata(Status s) {
+    if (s.ok()) {
+      s = status();
+    }
+    if (!s.ok()) {
+      Finish(s);
+      return;
+    }
+    if (response_.transfer_id() == 0) {
+      Finish(ParseInline());
+      return;
+    }
+    s = AllocateDestination();
+    if (s.ok()) {
+      // An abort past this point waits for the write to complete: the peer
+      // writes into `target_` until it replies.
+      s = status();
+    }
+    if (!s.ok()) {
+      ReleaseTransfer();
+      Finish(s);
+      return;
+    }
+    write_request_.set_source_worker(rdma_mgr_->local_worker());
+    write_request_.set_transfer_id(response_.transfer_id());
+    write_request_.set_remote_addr(
+        reinterpret_cast<uint64>(DMAHelper::base(target_)));
+    write_request_.set_rkey(mr_->rkey);
+    write_request_.set_length(target_->TotalBytes());
+    rdma_mgr_->IssueRequest(src_worker_, kRdmaWriteTensorMethod,
+                            write_request_, &write_response_,
+                            [this](const Status& s) { OnWritten(s); });
+  }
+
+  Status ParseInline() {
+    if (response_.is_dead()) {
+      return Status::OK();
+    }
+    if (on_host()) {
+      if (!tensor_.FromProto(dst_device_->GetAllocator(recv_args_.alloc_attrs),
+                             response_.tensor())) {
+        return errors::InvalidArgument("Cannot parse tensor from response");
+      }
+      return Status::OK();
+    }
+    return dst_device_->MakeTensorFromProto(
+        response_.tensor(), recv_args_.alloc_attrs, &tensor_);
+  }
+
+  // Allocates the tensor and the registered buffer the peer writes to, which
+  // is the tensor itself unless it is in GPU memory that is not registered.
+  Status AllocateDestination() {
+    TF_RETURN_IF_ERROR(
+        TensorShape::IsValidShape(response_.tensor().tensor_shape()));
+    const DataType dtype = response_.tensor().dtype();
+    const TensorShape shape(response_.tensor().tensor_shape());
+    tensor_ = Tensor(dst_device_->GetAllocator(recv_args_.alloc_attrs), dtype,
+                     shape);
+    if (!tensor_.IsInitialized()) {
+      return errors::ResourceExhausted("Failed to allocate a tensor of shape ",
+                                       shape.DebugString(), " on ",
+                                       dst_device_->name());
+    }
+    const size_t bytes = tensor_.TotalBytes();
+    target_ = &tensor_;
+    if (on_host()) {
+      mr_ = rdma_mgr_->FindOrRegister(DMAHelper::base(target_), bytes,
+                                      &transient_);
+    } else {
+      mr_ = RdmaMemoryRegistry::Global()->Find(DMAHelper::base(target_),
+                                               bytes);
+      if (mr_ == nullptr) {
+        AllocatorAttributes alloc_attrs;
+        alloc_attrs.set_gpu_compatible(true);
+        alloc_attrs.set_on_host(true);
+        staging_ = Tensor(dst_device_->GetAllocator(alloc_attrs), dtype, shape);
+        if (!staging_.IsInitialized()) {
+          return errors::ResourceExhausted(
+              "Failed to allocate a host tensor of shape ", shape.DebugString(),
+              " to receive a tensor for ", dst_device_->name());
+        }
+        target_ = &staging_;
+        mr_ = rdma_mgr_->FindOrRegister(DMAHelper::base(target_), bytes,
+                                        &transient_);
+      }
+    }
+    if (mr_ == nullptr) {
+      return errors::Internal("Failed to register ", bytes,
+                              " bytes of memory for RDMA.");
+    }
+    return Status::OK();
+  }
+
+  void OnWritten(const Status& s) {
+    if (transient_) {
+      RdmaAdapter::DeregisterMemory(mr_);
+    }
+    if (!s.ok() || target_ == &tensor_) {
+      Finish(s);
+      return;
+    }
+    const DeviceContext* device_context =
+        recv_args_.device_context != nullptr
+            ? recv_args_.device_context
+            : dst_device_->tensorflow_gpu_device_info()->default_context;
+    device_context->CopyCPUTensorToDevice(
+        &staging_, dst_device_, &tensor_,
+        [this](const Status& s) { Finish(s); }, /*sync_dst_compute=*/true);
+  }
+
+  // Lets the peer drop the tensor it holds for this call.
+  void ReleaseTransfer() {
+    auto request = std::make_shared<RdmaReleaseTensorRequest>();
+    auto response = std::make_shared<RdmaReleaseTensorResponse>();
+    request->set_transfer_id(response_.transfer_id());
+    rdma_mgr_->IssueRequest(src_worker_, kRdmaReleaseTensorMethod, *request,
+                            response.get(),
+                            [request, response](const Status& s) {
+                              if (!s.ok()) {
+                                VLOG(1) << "Failed to release an RDMA "
+                                        << "transfer: " << s;
+                              }
+                            });
+  }
+
+  void Finish(const Status& s) {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    recv_done_();
+  }
+
+  RdmaMgr* const rdma_mgr_;  // Not owned.
+  const string src_worker_;
+  Device* const dst_device_;
+  const Rendezvous::Args recv_args_;
+  std::function<void()> recv_done_;
+  CallOptions opts_;
+  RdmaRecvTensorRequest request_;
+  RdmaRecvTensorResponse response_;
+  RdmaWriteTensorRequest write_request_;
+  RdmaWriteTensorResponse write_response_;
+  Tensor tensor_;
+  // The host copy of `tensor_` the peer writes to, if any.
+  Tensor staging_;
+  Tensor* target_ = nullptr;
+  ibv_mr* mr_ = nullptr;
+  bool transient_ = false;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaRecvTensorCall);
+};
+
+void RdmaRemoteRendezvous::RecvFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  CHECK(is_initialized());
+
+  // key.src_device identifies a remote device.
+  string src_worker;
+  string src_rel_device;
+  Status s;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    s = errors::Internal(parsed.src_device,
+                         " is invalid remote source device.");
+  }
+  Device* dst_device;
+  if (s.ok()) {
+    s = session()->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+  }
+  if (!s.ok()) {
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+
+  auto* call = new RdmaRecvTensorCall(rdma_mgr_, step_id_, parsed.FullKey(),
+                                      src_worker, dst_device, recv_args);
+
+  // Record "call" in active_ so that it can be aborted cleanly.
+  RegisterCall(call, recv_args);
+
+  // RendezvousMgr already aborted, shouldn't send RPC call any more
+  if (!call->status().ok()) {
+    DeregisterCall(call);
+    done(call->status(), Args(), Args(), Tensor(), false);
+    delete call;
+    return;
+  }
+
+  // Start "call".
+  Ref();
+  call->Start([this, call, done = std::move(done)]() {
+    // Removes "call" from active_. Prevent StartAbort().
+    DeregisterCall(call);
+    // If StartAbort was called prior to DeregisterCall, then the
+    // current status should be bad.
+    Status s = call->status();
+    done(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
+    delete call;
+    Unref();
+  });
+}
+
+}  // namespace
+
+RdmaRendezvousMgr::RdmaRendezvousMgr(const WorkerEnv* env, RdmaMgr* rdma_mgr)
+    : BaseRendezvousMgr(env), rdma_mgr_(rdma_mgr) {}
+
+BaseRemoteRendezvous* RdmaRendezvousMgr::Create(int64 step_id,
+                                                const WorkerEnv* worker_env) {
+  return new RdmaRemoteRendezvous(worker_env, step_id, rdma_mgr_);
+}
+
+}  // end namespace tensorflow
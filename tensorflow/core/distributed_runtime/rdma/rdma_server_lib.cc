@@ -0,0 +1,108 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rdma/rdma_server_lib.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/distributed_runtime/rdma/rdma_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/session_mgr.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+RdmaServer::RdmaServer(const ServerDef& server_def, Env* env)
+    : GrpcServer(server_def, env) {}
+
+Status RdmaServer::Init(const DeviceMgr* local_device_mgr) {
+  GrpcServerOptions opts;
+  opts.local_device_mgr = local_device_mgr;
+  std::unique_ptr<RdmaAdapter> adapter;
+  Status s = RdmaAdapter::Create(&adapter);
+  if (!s.ok()) {
+    LOG(WARNING) << "RDMA is unavailable, tensors are sent over gRPC: " << s;
+    opts.rendezvous_mgr_func = [](const WorkerEnv* env) {
+      return new RpcRendezvousMgr(env);
+    };
+    return GrpcServer::Init(opts);
+  }
+
+  opts.rendezvous_mgr_func = [this, &adapter](const WorkerEnv* env) {
+    rdma_mgr_ = absl::make_unique<RdmaMgr>(env, std::move(adapter));
+    return new RdmaRendezvousMgr(env, rdma_mgr_.get());
+  };
+  opts.service_func = [this](const WorkerEnv* env,
+                             ::grpc::ServerBuilder* builder) {
+    rdma_service_ = absl::make_unique<GrpcRdmaService>(rdma_mgr_.get());
+    builder->RegisterService(rdma_service_.get());
+  };
+  TF_RETURN_IF_ERROR(GrpcServer::Init(opts));
+
+  // The channels to the peers are created once the server is bound to its
+  // port, in case that port was chosen by gRPC.
+  WorkerCacheFactoryOptions options(server_def());
+  GrpcChannelSpec channel_spec;
+  if (options.cluster_def != nullptr) {
+    TF_RETURN_IF_ERROR(ParseChannelSpec(options, &channel_spec));
+  }
+  std::shared_ptr<GrpcChannelCache> channel_cache(
+      NewGrpcChannelCache(channel_spec, GetChannelCreationFunction()));
+  rdma_mgr_->Start(SessionMgr::WorkerNameFromServerDef(server_def()),
+                   std::move(channel_cache),
+                   grpc_worker_env()->GetCompletionQueue(0),
+                   grpc_worker_env()->GetThreadPool());
+  return Status::OK();
+}
+
+/* static */
+Status RdmaServer::Create(const ServerDef& server_def, Env* env,
+                          const DeviceMgr* local_device_mgr,
+                          std::unique_ptr<ServerInterface>* out_server) {
+  std::unique_ptr<RdmaServer> ret(
+      new RdmaServer(server_def, env == nullptr ? Env::Default() : env));
+  Status s = ret->Init(local_device_mgr);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return s;
+  }
+  *out_server = std::move(ret);
+  return Status::OK();
+}
+
+namespace {
+
+class RdmaServerFactory : public ServerFactory {
+ public:
+  bool AcceptsOptions(const ServerDef& server_def) override {
+    return server_def.protocol() == "grpc+verbs";
+  }
+
+  Status NewServer(const ServerDef& server_def, const Options& options,
+                   std::unique_ptr<ServerInterface>* out_server) override {
+    return RdmaServer::Create(server_def, Env::Default(),
+                              options.local_device_mgr, out_server);
+  }
+};
+
+// Registers a `ServerFactory` for `RdmaServer` instances.
+class RdmaServerRegistrar {
+ public:
+  RdmaServerRegistrar() {
+    ServerFactory::Register("RDMA_SERVER", new RdmaServerFactory());
+  }
+};
+static RdmaServerRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,47 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_SERVER_LIB_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_SERVER_LIB_H_
+
+#include <memory>
+
+#include "tensorflow/core/distributed_runtime/rdma/grpc_rdma_service.h"
+#include "tensorflow/core/distributed_runtime/rdma/rdma_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
+
+namespace tensorflow {
+
+// A GrpcServer whose workers exchange tensors over RDMA. It serves the
+// protocol "grpc+verbs". If no RDMA device is usable, the server logs a
+// warning and exchanges tensors over gRPC like a "grpc" server.
+class RdmaServer : public GrpcServer {
+ public:
+  static Status Create(const ServerDef& server_def, Env* env,
+                       const DeviceMgr* local_device_mgr,
+                       std::unique_ptr<ServerInterface>* out_server);
+
+ protected:
+  RdmaServer(const ServerDef& server_def, Env* env);
+
+  Status Init(const DeviceMgr* local_device_mgr);
+
+ private:
+  std::unique_ptr<RdmaMgr> rdma_mgr_;
+  std::unique_ptr<GrpcRdmaService> rdma_service_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RDMA_RDMA_SERVER_LIB_H_
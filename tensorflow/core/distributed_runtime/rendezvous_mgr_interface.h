@@ -41,6 +41,10 @@ class RemoteRendezvous : public Rendezvous {
   // Fully construct the RemoteRendezvous.
   virtual Status Initialize(WorkerSession* session) = 0;
 
+  // Returns the wall time, in microseconds, during which at least one
+  // receive of a tensor from another worker was pending.
+  virtual int64 remote_recv_micros() const { return 0; }
+
  protected:
   bool is_cross_process() override { return true; }
 };
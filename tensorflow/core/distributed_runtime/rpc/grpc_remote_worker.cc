@@ -66,6 +66,8 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorchunk_(Method(GrpcWorkerMethod::kRecvTensorChunk)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         logger_(logger),
         target_(target) {}
 
@@ -255,6 +257,24 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void RecvTensorChunkAsync(CallOptions* call_opts,
+                            const RecvTensorChunkRequest* request,
+                            TensorChunkResponse* response,
+                            StatusCallback done) override {
+    new RPCState<TensorChunkResponse>(&stub_, cq_, recvtensorchunk_, *request,
+                                      response, std::move(done), call_opts,
+                                      callback_threadpool_, MaxRetries(),
+                                      /*fail_fast=*/true, &target_);
+  }
+
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    IssueRequest(request, response, recvtensorbatch_, std::move(done),
+                 call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -328,6 +348,8 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorchunk_;
+  const ::grpc::string recvtensorbatch_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -254,5 +254,43 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+void EncodeChunkedTensorToByteBuffer(const Tensor& val, bool require_ack,
+                                     ::grpc::ByteBuffer* result) {
+  RecvTensorResponse response;
+  response.set_require_ack(require_ack);
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  TensorProto* skeleton = response.mutable_chunked_tensor();
+  skeleton->set_dtype(val.dtype());
+  val.shape().AsProto(skeleton->mutable_tensor_shape());
+  EncodeRecvTensorResponseToByteBuffer(response, result);
+}
+
+// A RecvTensorChunkResponse is hand-encoded as the offset field, the tag and
+// varint32 length of the data field, and the data itself. The data is a
+// second grpc::Slice that shares the backing store of "chunk".
+void EncodeTensorChunkToByteBuffer(int64 offset, const Tensor& chunk,
+                                   ::grpc::ByteBuffer* result) {
+  StringPiece tdata = chunk.tensor_data();
+  static const int kVarintMax64 = 10;  // Max length of varint64 encoding
+  gtl::InlinedVector<char, 32> space(2 * (1 + kVarintMax64));
+  io::ProtoEncodeHelper e(space.data(), space.size());
+  if (offset != 0) {
+    e.WriteUint64(RecvTensorChunkResponse::kOffsetFieldNumber, offset);
+  }
+  e.WriteVarlengthBeginning(RecvTensorChunkResponse::kDataFieldNumber,
+                            tdata.size());
+
+  ::grpc::Slice slices[2];
+  slices[0] = ::grpc::Slice(e.data(), e.size());
+  const TensorBuffer* buf = DMAHelper::buffer(&chunk);
+  buf->Ref();
+  slices[1] = ::grpc::Slice(
+      const_cast<void*>(static_cast<const void*>(tdata.data())), tdata.size(),
+      [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+      const_cast<TensorBuffer*>(buf));
+  ::grpc::ByteBuffer tmp(&slices[0], 2);
+  result->Swap(&tmp);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
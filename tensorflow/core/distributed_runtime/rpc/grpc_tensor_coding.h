@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
 #include "grpcpp/impl/codegen/byte_buffer.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 class Tensor;
@@ -49,6 +50,24 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// Encode the dtype and shape of "val" into a byte buffer in a format that is
+// parseable as a RecvTensorResponse protocol buffer whose "chunked_tensor"
+// holds them. The content of "val" is not encoded; it is sent as
+// RecvTensorChunkResponses (see EncodeTensorChunkToByteBuffer).
+//
+// Discards original contents of *result.
+void EncodeChunkedTensorToByteBuffer(const Tensor& val, bool require_ack,
+                                     ::grpc::ByteBuffer* result);
+
+// Encode "chunk", a host tensor that holds the bytes at "offset" in the
+// content of a chunked tensor, into a byte buffer in a format that is
+// parseable as a RecvTensorChunkResponse protocol buffer. The backing store
+// of "chunk" is shared rather than copied.
+//
+// Discards original contents of *result.
+void EncodeTensorChunkToByteBuffer(int64 offset, const Tensor& chunk,
+                                   ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -17,8 +17,10 @@ limitations under the License.
 
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
@@ -100,4 +102,46 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, ChunkedTensor) {
+  Tensor t(DT_FLOAT, TensorShape({10, 100}));
+  test::FillIota<float>(&t, 0.0f);
+
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeChunkedTensorToByteBuffer(t, true, &buf);
+  RecvTensorResponse response;
+  ASSERT_TRUE(GrpcMaybeParseProto(&buf, &response));
+  EXPECT_TRUE(response.require_ack());
+  EXPECT_FALSE(response.has_tensor());
+  EXPECT_EQ(DT_FLOAT, response.chunked_tensor().dtype());
+  EXPECT_EQ(t.shape(), TensorShape(response.chunked_tensor().tensor_shape()));
+
+  // Reassemble the content from chunks of 1024 bytes.
+  Tensor flat;
+  TF_ASSERT_OK(
+      flat.BitcastFrom(t, DT_INT8, TensorShape({int64{10 * 100 * 4}})));
+  Tensor result(DT_FLOAT, t.shape());
+  char* dst = const_cast<char*>(result.tensor_data().data());
+  const int64 kChunkBytes = 1024;
+  for (int64 offset = 0; offset < flat.NumElements(); offset += kChunkBytes) {
+    const int64 size = std::min(kChunkBytes, flat.NumElements() - offset);
+    grpc::EncodeTensorChunkToByteBuffer(
+        offset, flat.Slice(offset, offset + size), &buf);
+    TensorChunkResponse chunk;
+    chunk.Init(dst + offset, size);
+    ASSERT_TRUE(GrpcMaybeParseProto(&buf, &chunk));
+    EXPECT_EQ(offset, chunk.offset());
+  }
+  test::ExpectTensorEqual<float>(t, result);
+}
+
+TEST_F(GrpcTensorCodingTest, TensorChunkSizeMismatch) {
+  Tensor t(DT_INT8, TensorShape({16}));
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorChunkToByteBuffer(0, t, &buf);
+  char dst[8];
+  TensorChunkResponse chunk;
+  chunk.Init(dst, sizeof(dst));
+  EXPECT_FALSE(GrpcMaybeParseProto(&buf, &chunk));
+}
+
 }  // namespace tensorflow
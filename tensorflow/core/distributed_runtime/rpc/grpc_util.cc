@@ -100,6 +100,14 @@ bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, TensorResponse* dst) {
   return s.ok();
 }
 
+// Overload of GrpcParseProto so we can decode a TensorChunkResponse directly
+// into the destination tensor.
+bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, TensorChunkResponse* dst) {
+  ::tensorflow::GrpcByteSource byte_source(src);
+  auto s = dst->ParseFrom(&byte_source);
+  return s.ok();
+}
+
 // GrpcMaybeParseProto simply copies bytes into the string.
 bool GrpcMaybeParseProto(grpc::ByteBuffer* src, string* dst) {
   dst->clear();
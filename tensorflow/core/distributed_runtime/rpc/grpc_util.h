@@ -124,6 +124,9 @@ bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, protobuf::Message* dst);
 // Specialization for TensorResponse
 bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, TensorResponse* dst);
 
+// Specialization for TensorChunkResponse
+bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, TensorChunkResponse* dst);
+
 // Copy string src to grpc buffer *dst.
 ::grpc::Status GrpcMaybeUnparseProto(const string& src,
                                      ::grpc::ByteBuffer* dst);
@@ -147,6 +147,15 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, false);
+
+    for (int i = 0; i < gtl::FindWithDefault(
+                        queue_depth_,
+                        static_cast<int>(GrpcWorkerMethod::kRecvTensorChunk),
+                        100);
+         ++i) {
+      EnqueueRecvTensorChunkRequestRaw();
+    }
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -218,6 +227,21 @@ class GrpcWorkerServiceThread {
 
 #undef HANDLE_CALL
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      worker_->RecvTensorBatchAsync(
+          /*opts=*/nullptr, &call->request, &call->response,
+          [call](const Status& s) {
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, false);
+  }
+
   void GetStepSequenceHandler(
       WorkerCall<GetStepSequenceRequest, GetStepSequenceResponse>* call) {
     Schedule([this, call]() {
@@ -283,6 +307,20 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorChunkHandlerRaw(
+      WorkerCall<RecvTensorChunkRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      worker_->GrpcRecvTensorChunkAsync(
+          &call->request, &call->response, [call](const Status& s) {
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorChunk:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    EnqueueRecvTensorChunkRequestRaw();
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -352,6 +390,19 @@ class GrpcWorkerServiceThread {
     }
   }
 
+  void EnqueueRecvTensorChunkRequestRaw() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
+           RecvTensorChunkRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              worker_service_, cq_.get(),
+              static_cast<int>(GrpcWorkerMethod::kRecvTensorChunk),
+              &GrpcWorkerServiceThread::RecvTensorChunkHandlerRaw,
+              false /* supports cancel*/);
+    }
+  }
+
   GrpcWorker* const worker_ = nullptr;  // Not owned.
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
   std::unique_ptr<Thread> thread_;
@@ -434,6 +485,15 @@ void GrpcWorker::EnableResponseCache() {
   response_cache_ = absl::make_unique<GrpcResponseCache>();
 }
 
+namespace {
+// Whether the content of "val" is sent in RecvTensorChunk calls of at most
+// "chunk_bytes" bytes rather than in the RecvTensor response.
+bool SendInChunks(const Tensor& val, bool is_dead, int64 chunk_bytes) {
+  return chunk_bytes > 0 && !is_dead && DataTypeCanUseMemcpy(val.dtype()) &&
+         val.TotalBytes() > chunk_bytes;
+}
+}  // namespace
+
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
 // buffers for a response object, to avoid extra protocol buffer serialization
 // overhead we generate our response directly into a ::grpc::ByteBuffer object
@@ -446,12 +506,19 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   const int64 step_id = request->step_id();
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
+  // Chunks are requested by request_id, so they need a unique one.
+  const int64 chunk_bytes = request_id != 0 ? request->chunk_bytes() : 0;
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [response, done, cache_enabled, chunk_bytes](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      if (SendInChunks(tensor, is_dead, chunk_bytes)) {
+        grpc::EncodeChunkedTensorToByteBuffer(tensor, cache_enabled, response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -480,11 +547,17 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     rendezvous_done(Tensor(), false, status);
   };
 
-  Status s = recent_request_ids_.TrackUnique(
-      request_id, "RecvTensor (GrpcWorker)", *request);
-  if (!s.ok()) {
-    fail(s);
-    return;
+  // A RecvTensorBatch call that deferred this tensor has already requested it
+  // from the rendezvous under the same request_id.
+  std::shared_ptr<DeferredRecv> deferred = TakeDeferredRecv(request_id);
+  Status s;
+  if (deferred == nullptr) {
+    s = recent_request_ids_.TrackUnique(request_id, "RecvTensor (GrpcWorker)",
+                                        *request);
+    if (!s.ok()) {
+      fail(s);
+      return;
+    }
   }
 
   const string& key = request->rendezvous_key();
@@ -508,12 +581,12 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   // the client.
   opts->SetCancelCallback(
       [step_id]() { LOG(WARNING) << "RecvTensor cancelled for " << step_id; });
-  env_->rendezvous_mgr->RecvLocalAsync(
-      step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
-          const Status& status, const Rendezvous::Args& send_args,
-          const Rendezvous::Args& recv_args, const Tensor& val,
-          const bool is_dead) {
+  RecvLocalOrDeferredAsync(
+      std::move(deferred), step_id, parsed,
+      [this, opts, rendezvous_done, src_dev, request, request_id, step_id,
+       chunk_bytes](const Status& status, const Rendezvous::Args& send_args,
+                    const Rendezvous::Args& recv_args, const Tensor& val,
+                    const bool is_dead) {
         opts->ClearCancelCallback();
         if (status.ok()) {
           // DMA can only be used for Tensors that do not fall into
@@ -523,6 +596,18 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
           // i.e. it's in CPU RAM *independent of its assigned
           // device type*.
           const bool on_host = send_args.alloc_attrs.on_host();
+          if (SendInChunks(val, is_dead, chunk_bytes)) {
+            // The content stays on the device until each chunk is requested,
+            // so the copies to the host overlap with sending earlier chunks.
+            const bool on_device =
+                src_dev->tensorflow_gpu_device_info() && (!on_host);
+            CHECK(!on_device || send_args.device_context)
+                << "send dev name: " << src_dev->name();
+            AddChunkedTensor(request_id, step_id, val, src_dev,
+                             on_device ? send_args.device_context : nullptr);
+            rendezvous_done(val, is_dead, status);
+            return;
+          }
           {
             // Non-DMA cases.
             if (src_dev->tensorflow_gpu_device_info() && (!on_host)) {
@@ -700,6 +785,334 @@ void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
       /*cancellation_manager=*/nullptr);
 }
 
+class GrpcWorker::DeferredRecv {
+ public:
+  explicit DeferredRecv(int64 step_id) : step_id_(step_id) {}
+
+  ~DeferredRecv() {
+    if (send_args_.device_context != nullptr) {
+      send_args_.device_context->Unref();
+    }
+  }
+
+  int64 step_id() const { return step_id_; }
+
+  // Records the result of RecvLocalAsync, or passes it to the waiter.
+  void Finish(const Status& status, const Rendezvous::Args& send_args,
+              const Rendezvous::Args& recv_args, const Tensor& val,
+              bool is_dead) {
+    Rendezvous::DoneCallback waiter;
+    {
+      mutex_lock l(mu_);
+      if (waiter_ == nullptr) {
+        finished_ = true;
+        status_ = status;
+        send_args_ = send_args;
+        if (send_args_.device_context != nullptr) {
+          send_args_.device_context->Ref();
+        }
+        recv_args_ = recv_args;
+        val_ = val;
+        is_dead_ = is_dead;
+        return;
+      }
+      waiter = std::move(waiter_);
+    }
+    waiter(status, send_args, recv_args, val, is_dead);
+  }
+
+  // Runs `done` with the result once it is recorded.
+  void Wait(Rendezvous::DoneCallback done) {
+    {
+      mutex_lock l(mu_);
+      if (!finished_) {
+        waiter_ = std::move(done);
+        return;
+      }
+    }
+    done(status_, send_args_, recv_args_, val_, is_dead_);
+  }
+
+ private:
+  const int64 step_id_;
+  mutex mu_;
+  bool finished_ TF_GUARDED_BY(mu_) = false;
+  Rendezvous::DoneCallback waiter_ TF_GUARDED_BY(mu_);
+  // Immutable once `finished_` is set.
+  Status status_;
+  Rendezvous::Args send_args_;  // Owns a reference on `device_context`.
+  Rendezvous::Args recv_args_;
+  Tensor val_;
+  bool is_dead_ = false;
+};
+
+std::shared_ptr<GrpcWorker::DeferredRecv> GrpcWorker::TakeDeferredRecv(
+    int64 request_id) {
+  if (request_id == 0) return nullptr;
+  mutex_lock l(deferred_recvs_mu_);
+  auto it = deferred_recvs_.find(request_id);
+  if (it == deferred_recvs_.end()) return nullptr;
+  std::shared_ptr<DeferredRecv> deferred = std::move(it->second);
+  deferred_recvs_.erase(it);
+  return deferred;
+}
+
+void GrpcWorker::RecvLocalOrDeferredAsync(
+    std::shared_ptr<DeferredRecv> deferred, int64 step_id,
+    const Rendezvous::ParsedKey& parsed, Rendezvous::DoneCallback done) {
+  if (deferred != nullptr) {
+    deferred->Wait(std::move(done));
+    return;
+  }
+  env_->rendezvous_mgr->RecvLocalAsync(step_id, parsed, std::move(done));
+}
+
+namespace {
+// Collects the tensors of a RecvTensorBatch call. The response is sent once
+// every tensor is resolved, or `linger_micros` after the first one is. This
+// way a tensor that is produced late, possibly only after the receiver
+// consumed another tensor of the batch, does not hold back the others.
+class RecvTensorBatchCollector
+    : public std::enable_shared_from_this<RecvTensorBatchCollector> {
+ public:
+  RecvTensorBatchCollector(Env* env, int num_tensors, int64 linger_micros,
+                           RecvTensorBatchResponse* response,
+                           StatusCallback done)
+      : env_(env),
+        linger_micros_(linger_micros),
+        response_(response),
+        done_(std::move(done)),
+        tensors_(num_tensors),
+        inline_(num_tensors, false),
+        num_unresolved_(num_tensors) {}
+
+  // Offers the tensor for request `index`. Returns true if it is returned
+  // inline, and false if the caller must defer it.
+  bool Offer(int index, bool can_inline, const Tensor& val) {
+    bool accepted = false;
+    bool respond = false;
+    bool schedule_linger = false;
+    {
+      mutex_lock l(mu_);
+      if (responded_) return false;
+      if (can_inline) {
+        tensors_[index] = val;
+        inline_[index] = true;
+        accepted = true;
+      }
+      --num_unresolved_;
+      if (num_unresolved_ == 0) {
+        respond = true;
+      } else if (!linger_scheduled_) {
+        linger_scheduled_ = true;
+        schedule_linger = true;
+      }
+    }
+    if (respond) {
+      Respond();
+    } else if (schedule_linger) {
+      auto self = shared_from_this();
+      env_->SchedClosureAfter(linger_micros_, [self]() { self->Respond(); });
+    }
+    return accepted;
+  }
+
+ private:
+  void Respond() {
+    {
+      mutex_lock l(mu_);
+      if (responded_) return;
+      responded_ = true;
+    }
+    const int64 now = env_->NowMicros();
+    for (int i = 0; i < tensors_.size(); ++i) {
+      RecvTensorResponse* response = response_->add_response();
+      if (inline_[i]) {
+        tensors_[i].AsProtoTensorContent(response->mutable_tensor());
+        response->set_send_start_micros(now);
+        tensors_[i] = Tensor();
+      }
+      response_->add_deferred(!inline_[i]);
+    }
+    done_(Status::OK());
+  }
+
+  Env* const env_;
+  const int64 linger_micros_;
+  RecvTensorBatchResponse* const response_;
+  const StatusCallback done_;
+
+  mutex mu_;
+  // Written only until `responded_` is set.
+  std::vector<Tensor> tensors_;
+  std::vector<bool> inline_;
+  int num_unresolved_ TF_GUARDED_BY(mu_);
+  bool linger_scheduled_ TF_GUARDED_BY(mu_) = false;
+  bool responded_ TF_GUARDED_BY(mu_) = false;
+};
+}  // namespace
+
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  const int num_tensors = request->request_size();
+  if (num_tensors == 0) {
+    done(Status::OK());
+    return;
+  }
+  for (const RecvTensorRequest& req : request->request()) {
+    if (req.request_id() == 0) {
+      done(errors::InvalidArgument(
+          "Every request of a RecvTensorBatch call needs a request_id"));
+      return;
+    }
+  }
+
+  // Every tensor is registered as deferred up front, so that its RecvTensor
+  // request finds it whenever the response arrives. Once the response is
+  // filled, inline tensors are unregistered.
+  std::vector<std::shared_ptr<DeferredRecv>> deferred(num_tensors);
+  {
+    mutex_lock l(deferred_recvs_mu_);
+    for (int i = 0; i < num_tensors; ++i) {
+      const RecvTensorRequest& req = request->request(i);
+      deferred[i] = std::make_shared<DeferredRecv>(req.step_id());
+      deferred_recvs_[req.request_id()] = deferred[i];
+    }
+  }
+  auto collector = std::make_shared<RecvTensorBatchCollector>(
+      env_->env, num_tensors, request->linger_micros(), response,
+      [this, request, response, done](const Status& s) {
+        {
+          mutex_lock l(deferred_recvs_mu_);
+          for (int i = 0; i < response->deferred_size(); ++i) {
+            if (!response->deferred(i)) {
+              deferred_recvs_.erase(request->request(i).request_id());
+            }
+          }
+        }
+        done(s);
+      });
+
+  const int64 max_inline_bytes = request->max_inline_bytes();
+  for (int i = 0; i < num_tensors; ++i) {
+    const RecvTensorRequest& req = request->request(i);
+    Status s = recent_request_ids_.TrackUnique(
+        req.request_id(), "RecvTensorBatch (GrpcWorker)", req);
+    Rendezvous::ParsedKey parsed;
+    Device* src_dev = nullptr;
+    if (s.ok()) {
+      s = Rendezvous::ParseKey(req.rendezvous_key(), &parsed);
+    }
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed, &src_dev);
+    }
+    Rendezvous::DoneCallback recv_done =
+        [collector, i, deferred = deferred[i], src_dev, max_inline_bytes](
+            const Status& status, const Rendezvous::Args& send_args,
+            const Rendezvous::Args& recv_args, const Tensor& val,
+            const bool is_dead) {
+          const bool can_inline =
+              status.ok() && !is_dead &&
+              (!src_dev->tensorflow_gpu_device_info() ||
+               send_args.alloc_attrs.on_host()) &&
+              val.TotalBytes() <= max_inline_bytes;
+          if (!collector->Offer(i, can_inline, val)) {
+            deferred->Finish(status, send_args, recv_args, val, is_dead);
+          }
+        };
+    if (!s.ok()) {
+      recv_done(s, Rendezvous::Args(), Rendezvous::Args(), Tensor(), false);
+      continue;
+    }
+    env_->rendezvous_mgr->RecvLocalAsync(req.step_id(), parsed,
+                                         std::move(recv_done));
+  }
+}
+
+void GrpcWorker::AddChunkedTensor(int64 request_id, int64 step_id,
+                                  const Tensor& tensor, Device* device,
+                                  DeviceContext* device_context) {
+  if (device_context != nullptr) {
+    device_context->Ref();
+  }
+  ChunkedTensor chunked{tensor, device,
+                        core::RefCountPtr<DeviceContext>(device_context),
+                        step_id, static_cast<int64>(tensor.TotalBytes())};
+  mutex_lock l(chunked_tensors_mu_);
+  chunked_tensors_.emplace(request_id, std::move(chunked));
+}
+
+Status GrpcWorker::TakeTensorChunk(const RecvTensorChunkRequest& request,
+                                   Tensor* chunk, Device** device,
+                                   DeviceContext** device_context) {
+  mutex_lock l(chunked_tensors_mu_);
+  auto it = chunked_tensors_.find(request.request_id());
+  if (it == chunked_tensors_.end()) {
+    return errors::NotFound("No chunked tensor for RecvTensor request ",
+                            request.request_id());
+  }
+  ChunkedTensor& chunked = it->second;
+  const int64 total_bytes = chunked.tensor.TotalBytes();
+  if (request.offset() < 0 || request.size() <= 0 ||
+      request.offset() + request.size() > total_bytes) {
+    return errors::InvalidArgument(
+        "Chunk [", request.offset(), ", ", request.offset() + request.size(),
+        ") is out of range for a tensor of ", total_bytes, " bytes");
+  }
+  Tensor flat;
+  TF_RETURN_IF_ERROR(
+      flat.BitcastFrom(chunked.tensor, DT_INT8, TensorShape({total_bytes})));
+  *chunk = flat.Slice(request.offset(), request.offset() + request.size());
+  *device = chunked.device;
+  *device_context = chunked.device_context.get();
+  if (*device_context != nullptr) {
+    (*device_context)->Ref();
+  }
+  chunked.bytes_left -= request.size();
+  if (chunked.bytes_left <= 0) {
+    chunked_tensors_.erase(it);
+  }
+  return Status::OK();
+}
+
+void GrpcWorker::GrpcRecvTensorChunkAsync(
+    const RecvTensorChunkRequest* request, ::grpc::ByteBuffer* response,
+    StatusCallback done) {
+  const int64 offset = request->offset();
+  Tensor chunk;
+  Device* device = nullptr;
+  DeviceContext* device_context = nullptr;
+  Status s = TakeTensorChunk(*request, &chunk, &device, &device_context);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  if (device_context == nullptr) {
+    grpc::EncodeTensorChunkToByteBuffer(offset, chunk, response);
+    done(Status::OK());
+    return;
+  }
+
+  AllocatorAttributes alloc_attrs;
+  alloc_attrs.set_gpu_compatible(true);
+  alloc_attrs.set_on_host(true);
+  Tensor* copy =
+      new Tensor(device->GetAllocator(alloc_attrs), DT_INT8, chunk.shape());
+  // `chunk` is captured to keep the device memory alive during the copy.
+  device_context->CopyDeviceTensorToCPU(
+      &chunk, "RecvTensorChunk", device, copy,
+      [chunk, copy, device_context, offset, response, done](const Status& s) {
+        if (s.ok()) {
+          grpc::EncodeTensorChunkToByteBuffer(offset, *copy, response);
+        }
+        delete copy;
+        device_context->Unref();
+        done(s);
+      });
+}
+
 void GrpcWorker::LoggingAsync(const LoggingRequest* request,
                               LoggingResponse* response, StatusCallback done) {
   auto env = this->env();
@@ -735,6 +1148,29 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  {
+    // Release chunked tensors whose receiver failed before requesting all
+    // the chunks.
+    mutex_lock l(chunked_tensors_mu_);
+    for (auto it = chunked_tensors_.begin(); it != chunked_tensors_.end();) {
+      if (it->second.step_id == request->step_id()) {
+        chunked_tensors_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+  {
+    // Release deferred tensors that were never requested.
+    mutex_lock l(deferred_recvs_mu_);
+    for (auto it = deferred_recvs_.begin(); it != deferred_recvs_.end();) {
+      if (it->second->step_id() == request->step_id()) {
+        deferred_recvs_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
   Worker::CleanupGraphAsync(request, response, done);
 }
 
@@ -19,9 +19,15 @@ limitations under the License.
 #include <memory>
 #include <unordered_map>
 #include "grpcpp/server_builder.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace grpc {
@@ -32,6 +38,7 @@ namespace tensorflow {
 
 class AsyncServiceInterface;
 class ConfigProto;
+class Device;
 struct WorkerEnv;
 class WorkerSession;
 class GrpcResponseCache;
@@ -46,6 +53,21 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Returns a chunk of the content of a tensor that GrpcRecvTensorAsync sent
+  // as `RecvTensorResponse.chunked_tensor`. Tensors on a GPU are copied to
+  // the host one chunk at a time.
+  virtual void GrpcRecvTensorChunkAsync(const RecvTensorChunkRequest* request,
+                                        ::grpc::ByteBuffer* response,
+                                        StatusCallback done);
+
+  // Returns the requested tensors that are small, in host memory and
+  // available soon enough inline, and defers the others. A deferred tensor
+  // is returned by GrpcRecvTensorAsync for a request with its request_id.
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -63,8 +85,53 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64 request_id);
 
  private:
+  // A tensor whose content is sent in chunks.
+  struct ChunkedTensor {
+    Tensor tensor;
+    Device* device;  // Not owned.
+    // Set if `tensor` is in device memory.
+    core::RefCountPtr<DeviceContext> device_context;
+    int64 step_id;
+    // The number of bytes of the content that have not been requested yet.
+    int64 bytes_left;
+  };
+
+  // Keeps `tensor` until its content has been requested in chunks.
+  void AddChunkedTensor(int64 request_id, int64 step_id, const Tensor& tensor,
+                        Device* device, DeviceContext* device_context);
+
+  // Returns in `*chunk` the requested part of a chunked tensor, and in
+  // `*device_context` a new reference to its device context, or nullptr if
+  // the tensor is on the host.
+  Status TakeTensorChunk(const RecvTensorChunkRequest& request, Tensor* chunk,
+                         Device** device, DeviceContext** device_context);
+
+  // The result of retrieving from the rendezvous a tensor that
+  // RecvTensorBatchAsync deferred, until its RecvTensor request arrives.
+  class DeferredRecv;
+
+  // Removes and returns the deferred tensor for `request_id`, if any.
+  std::shared_ptr<DeferredRecv> TakeDeferredRecv(int64 request_id);
+
+  // Runs `done` with the result of `deferred` if it is set, or else
+  // retrieves the tensor for `parsed` from the rendezvous.
+  void RecvLocalOrDeferredAsync(std::shared_ptr<DeferredRecv> deferred,
+                                int64 step_id,
+                                const Rendezvous::ParsedKey& parsed,
+                                Rendezvous::DoneCallback done);
+
   std::unique_ptr<GrpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+
+  mutex deferred_recvs_mu_;
+  // Keyed by the request_id of the deferred RecvTensorRequest.
+  absl::flat_hash_map<int64, std::shared_ptr<DeferredRecv>> deferred_recvs_
+      TF_GUARDED_BY(deferred_recvs_mu_);
+
+  mutex chunked_tensors_mu_;
+  // Keyed by the request_id of the RecvTensorRequest that returned the tensor.
+  absl::flat_hash_map<int64, ChunkedTensor> chunked_tensors_
+      TF_GUARDED_BY(chunked_tensors_mu_);
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
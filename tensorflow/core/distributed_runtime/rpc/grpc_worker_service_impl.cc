@@ -60,6 +60,10 @@ const char* GrpcWorkerMethodName(GrpcWorkerMethod id) {
       return "/tensorflow.WorkerService/GetStepSequence";
     case GrpcWorkerMethod::kMarkRecvFinished:
       return "/tensorflow.WorkerService/MarkRecvFinished";
+    case GrpcWorkerMethod::kRecvTensorChunk:
+      return "/tensorflow.WorkerService/RecvTensorChunk";
+    case GrpcWorkerMethod::kRecvTensorBatch:
+      return "/tensorflow.WorkerService/RecvTensorBatch";
   }
   // Shouldn't be reached.
   LOG(FATAL) << "Invalid id: this line shouldn't be reached.";
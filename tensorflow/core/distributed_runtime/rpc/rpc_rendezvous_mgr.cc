@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -33,11 +36,67 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Tensors of more than this many bytes are received in chunks of this size,
+// so that several chunks are in flight at once and the copies from and to
+// GPUs overlap with the network transfer. Zero disables chunking.
+int64 RecvTensorChunkBytes() {
+  static const int64 chunk_bytes = [] {
+    int64 value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_CHUNK_BYTES",
+                                    16 << 20, &value));
+    return value;
+  }();
+  return chunk_bytes;
+}
+
+// The maximum number of chunks of a tensor that are requested at once.
+int64 RecvTensorChunksInFlight() {
+  static const int64 chunks_in_flight = [] {
+    int64 value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_CHUNKS_IN_FLIGHT", 4,
+                                    &value));
+    return std::max<int64>(value, 1);
+  }();
+  return chunks_in_flight;
+}
+
+// If positive, the RecvTensor calls of a step to the same worker that start
+// within this many microseconds are sent as one RecvTensorBatch call. The
+// worker returns the small tensors that are ready inline and defers the
+// others to individual RecvTensor calls. Zero disables batching.
+int64 RecvTensorBatchWindowMicros() {
+  static const int64 window_micros = [] {
+    int64 value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_BATCH_WINDOW_US", 0,
+                                    &value));
+    return value;
+  }();
+  return window_micros;
+}
+
+// The maximum number of RecvTensor calls in one RecvTensorBatch call.
+int64 RecvTensorBatchSize() {
+  static const int64 batch_size = [] {
+    int64 value;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_BATCH_SIZE", 128, &value));
+    return std::max<int64>(value, 1);
+  }();
+  return batch_size;
+}
+
+// Tensors larger than this are not returned inline by RecvTensorBatch.
+constexpr int64 kRecvTensorBatchMaxInlineBytes = 64 << 10;
+
+class RpcRecvTensorCall;
+class RpcRecvTensorBatchCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
@@ -49,8 +108,39 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
+  // The calls waiting to be sent to a worker in a RecvTensorBatch call.
+  struct PendingBatch {
+    int64 id = 0;
+    std::shared_ptr<WorkerCacheInterface> worker_cache;
+    std::vector<RpcRecvTensorCall*> calls;
+  };
+
   ~RpcRemoteRendezvous() override {}
 
+  // Sends the RecvTensor request of the registered `call`.
+  void StartCall(RpcRecvTensorCall* call,
+                 std::shared_ptr<WorkerCacheInterface> worker_cache);
+  // Deregisters `call`, runs its done callback and releases it.
+  void FinishCall(RpcRecvTensorCall* call);
+
+  // Queues the registered `call` for the next RecvTensorBatch call to its
+  // worker, which is sent when full or RecvTensorBatchWindowMicros() after
+  // its first call was queued.
+  void AddToBatch(RpcRecvTensorCall* call,
+                  std::shared_ptr<WorkerCacheInterface> worker_cache);
+  // Sends the calls queued for `src_worker` if they are still those of the
+  // batch `batch_id`.
+  void FlushBatch(const string& src_worker, int64 batch_id);
+  void SendBatch(PendingBatch batch);
+  void BatchDone(RpcRecvTensorBatchCall* batch,
+                 std::shared_ptr<WorkerCacheInterface> worker_cache);
+
+  mutex batch_mu_;
+  // Keyed by source worker.
+  std::unordered_map<string, PendingBatch> pending_batches_
+      TF_GUARDED_BY(batch_mu_);
+  int64 next_batch_id_ TF_GUARDED_BY(batch_mu_) = 0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -70,6 +160,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    req_.set_chunk_bytes(RecvTensorChunkBytes());
   }
 
   void Reset() {
@@ -84,9 +175,14 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     // opts_ appropriately.
     req_.Clear();
     resp_.Clear();
+    chunked_tensor_ = Tensor();
+    chunked_content_ = Tensor();
     {
       mutex_lock l(mu_);
       status_ = Status::OK();
+      next_chunk_offset_ = 0;
+      chunks_in_flight_ = 0;
+      chunked_done_ = nullptr;
     }
     done_ = nullptr;
   }
@@ -123,10 +219,23 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     wi_ = nullptr;
   }
 
-  const Tensor& tensor() const { return resp_.tensor(); }
+  const Tensor& tensor() const {
+    return resp_.metadata().has_chunked_tensor() ? chunked_tensor_
+                                                 : resp_.tensor();
+  }
 
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
+  // Takes the tensor from a response returned inline by RecvTensorBatch.
+  void InitFromBatch(RecvTensorResponse* response) {
+    resp_.InitAlloc(dst_device_, alloc_attrs_);
+    Status s = resp_.InitFrom(response);
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+  }
+
   Device* dst_device() const { return dst_device_; }
   const Rendezvous::Args& recv_args() const { return recv_args_; }
   const Rendezvous::DoneCallback& done() const { return done_; }
@@ -146,6 +255,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       if (!s.ok()) {
         mutex_lock l(mu_);
         status_.Update(s);
+      } else if (resp_.metadata().has_chunked_tensor()) {
+        StartChunkedRecv(recv_done);
+        return;
       }
       recv_done();
     };
@@ -168,6 +280,134 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // The state of one RecvTensorChunk call.
+  struct Chunk {
+    RecvTensorChunkRequest req;
+    TensorChunkResponse resp;
+    // Where the chunk is received if the destination is a GPU.
+    Tensor staging;
+    // The part of the destination tensor that holds the chunk.
+    Tensor dst;
+  };
+
+  // Allocates the tensor described by `resp_.metadata().chunked_tensor()` and
+  // receives its content with up to RecvTensorChunksInFlight() RecvTensorChunk
+  // calls at once. Each chunk is decoded straight into the destination tensor,
+  // or into a host staging buffer that is copied to the GPU as soon as the
+  // chunk arrives. An aborted call requests no further chunks and waits for
+  // those in flight.
+  void StartChunkedRecv(std::function<void()> recv_done) {
+    const TensorProto& meta = resp_.metadata().chunked_tensor();
+    Status s;
+    if (!DataTypeCanUseMemcpy(meta.dtype()) ||
+        !TensorShape::IsValid(meta.tensor_shape())) {
+      s = errors::InvalidArgument("Invalid chunked tensor in response: ",
+                                  meta.ShortDebugString());
+    }
+    chunks_on_host_ = alloc_attrs_.on_host() ||
+                      dst_device_->attributes().device_type() == "CPU";
+    if (s.ok() && !chunks_on_host_ && recv_args_.device_context == nullptr) {
+      s = errors::Internal("No device context to receive a chunked tensor on ",
+                           dst_device_->name());
+    }
+    if (s.ok()) {
+      chunked_tensor_ = Tensor(dst_device_->GetAllocator(alloc_attrs_),
+                               meta.dtype(), TensorShape(meta.tensor_shape()));
+      if (!chunked_tensor_.IsInitialized()) {
+        s = errors::ResourceExhausted(
+            "Failed to allocate a chunked tensor of shape ",
+            chunked_tensor_.shape().DebugString(), " on ", dst_device_->name());
+      }
+    }
+    if (s.ok()) {
+      s = chunked_content_.BitcastFrom(
+          chunked_tensor_, DT_INT8,
+          TensorShape({static_cast<int64>(chunked_tensor_.TotalBytes())}));
+    }
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+      chunked_done_ = std::move(recv_done);
+    }
+    MaybeIssueChunks();
+  }
+
+  // Requests the next chunks, or calls `chunked_done_` once every chunk has
+  // been received or the call has failed and no chunks are in flight.
+  void MaybeIssueChunks() {
+    std::vector<Chunk*> chunks;
+    std::function<void()> done;
+    {
+      mutex_lock l(mu_);
+      const int64 total_bytes = chunked_content_.NumElements();
+      const int64 chunk_bytes = req_.chunk_bytes();
+      while (status_.ok() && chunks_in_flight_ < RecvTensorChunksInFlight() &&
+             next_chunk_offset_ < total_bytes) {
+        const int64 offset = next_chunk_offset_;
+        const int64 size = std::min(chunk_bytes, total_bytes - offset);
+        Chunk* chunk = new Chunk;
+        chunk->req.set_request_id(req_.request_id());
+        chunk->req.set_offset(offset);
+        chunk->req.set_size(size);
+        chunk->dst = chunked_content_.Slice(offset, offset + size);
+        if (chunks_on_host_) {
+          chunk->resp.Init(const_cast<char*>(chunk->dst.tensor_data().data()),
+                           size);
+        } else {
+          AllocatorAttributes host_attrs;
+          host_attrs.set_on_host(true);
+          host_attrs.set_gpu_compatible(true);
+          chunk->staging = Tensor(dst_device_->GetAllocator(host_attrs),
+                                  DT_INT8, TensorShape({size}));
+          chunk->resp.Init(
+              const_cast<char*>(chunk->staging.tensor_data().data()), size);
+        }
+        next_chunk_offset_ += size;
+        ++chunks_in_flight_;
+        chunks.push_back(chunk);
+      }
+      if (chunks_in_flight_ == 0 &&
+          (!status_.ok() || next_chunk_offset_ == total_bytes)) {
+        done = std::move(chunked_done_);
+        chunked_done_ = nullptr;
+      }
+    }
+    for (Chunk* chunk : chunks) {
+      wi_->RecvTensorChunkAsync(
+          /*opts=*/nullptr, &chunk->req, &chunk->resp,
+          [this, chunk](const Status& s) { ChunkReceived(chunk, s); });
+    }
+    if (done) {
+      done();
+    }
+  }
+
+  void ChunkReceived(Chunk* chunk, Status s) {
+    if (s.ok() && chunk->resp.offset() != chunk->req.offset()) {
+      s = errors::Internal("Received the tensor chunk at offset ",
+                           chunk->resp.offset(), " instead of ",
+                           chunk->req.offset());
+    }
+    if (!s.ok() || chunks_on_host_) {
+      ChunkDone(chunk, s);
+      return;
+    }
+    recv_args_.device_context->CopyCPUTensorToDevice(
+        &chunk->staging, dst_device_, &chunk->dst,
+        [this, chunk](const Status& s) { ChunkDone(chunk, s); },
+        /*sync_dst_compute=*/true);
+  }
+
+  void ChunkDone(Chunk* chunk, const Status& s) {
+    delete chunk;
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+      --chunks_in_flight_;
+    }
+    MaybeIssueChunks();
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
@@ -179,12 +419,85 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
 
+  // Set if the tensor is received in chunks.
+  Tensor chunked_tensor_;
+  // A flat DT_INT8 view of the content of `chunked_tensor_`.
+  Tensor chunked_content_;
+  bool chunks_on_host_ = true;
+
   mutable mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  int64 next_chunk_offset_ TF_GUARDED_BY(mu_) = 0;
+  int64 chunks_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  std::function<void()> chunked_done_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorCall);
 };
 
+// Retrieves the tensors of several RpcRecvTensorCalls to the same worker with
+// one RecvTensorBatch call. The calls are finished by the
+// RpcRemoteRendezvous once this call is done.
+class RpcRecvTensorBatchCall : public BaseRecvTensorCall {
+ public:
+  RpcRecvTensorBatchCall(WorkerInterface* wi,
+                         std::vector<RpcRecvTensorCall*> calls)
+      : wi_(wi), calls_(std::move(calls)) {}
+
+  void Start(std::function<void()> recv_done) override {
+    auto abort_checked = std::make_shared<Notification>();
+    auto cb = [this, abort_checked,
+               recv_done = std::move(recv_done)](const Status& s) {
+      abort_checked->WaitForNotification();
+      if (!s.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+    };
+    wi_->RecvTensorBatchAsync(&opts_, &req_, &resp_, std::move(cb));
+
+    // See RpcRecvTensorCall::StartRTCall().
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  const std::vector<RpcRecvTensorCall*>& calls() const { return calls_; }
+  RecvTensorBatchRequest* mutable_request() { return &req_; }
+  RecvTensorBatchResponse* mutable_response() { return &resp_; }
+
+ private:
+  WorkerInterface* const wi_;  // Not owned; that of calls_[0].
+  const std::vector<RpcRecvTensorCall*> calls_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  RecvTensorBatchResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorBatchCall);
+};
+
 class RpcRecvTensorFreeList {
  public:
   RpcRecvTensorFreeList() {}
@@ -287,24 +600,146 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
-  // Start "call".
+  if (RecvTensorBatchWindowMicros() > 0) {
+    AddToBatch(call, std::move(worker_cache));
+  } else {
+    StartCall(call, std::move(worker_cache));
+  }
+}
+
+void RpcRemoteRendezvous::StartCall(
+    RpcRecvTensorCall* call,
+    std::shared_ptr<WorkerCacheInterface> worker_cache) {
   Ref();
   call->Start([this, call, worker_cache]() {
-    // Removes "call" from active_. Prevent StartAbort().
-    DeregisterCall(call);
-    // If StartAbort was called prior to DeregisterCall, then the
-    // current status should be bad.
-    Status s = call->status();
-    // NOTE: `*session()` can potentially be deleted before we return from
-    // `call->done()(...)`, so we must release the worker before calling the
-    // callback.
-    call->ReleaseWorker(session()->worker_cache());
-    call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
-    get_call_freelist()->Release(call);
+    FinishCall(call);
     Unref();
   });
 }
 
+void RpcRemoteRendezvous::FinishCall(RpcRecvTensorCall* call) {
+  // Removes "call" from active_. Prevent StartAbort().
+  DeregisterCall(call);
+  // If StartAbort was called prior to DeregisterCall, then the
+  // current status should be bad.
+  Status s = call->status();
+  // NOTE: `*session()` can potentially be deleted before we return from
+  // `call->done()(...)`, so we must release the worker before calling the
+  // callback.
+  call->ReleaseWorker(session()->worker_cache());
+  call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
+  get_call_freelist()->Release(call);
+}
+
+void RpcRemoteRendezvous::AddToBatch(
+    RpcRecvTensorCall* call,
+    std::shared_ptr<WorkerCacheInterface> worker_cache) {
+  // `call` may finish as soon as another thread flushes its batch.
+  const string src_worker = call->src_worker_;
+  PendingBatch full;
+  bool schedule_flush = false;
+  int64 batch_id;
+  {
+    mutex_lock l(batch_mu_);
+    PendingBatch& pending = pending_batches_[src_worker];
+    if (pending.calls.empty()) {
+      pending.id = next_batch_id_++;
+      pending.worker_cache = std::move(worker_cache);
+      schedule_flush = true;
+    }
+    batch_id = pending.id;
+    pending.calls.push_back(call);
+    if (pending.calls.size() >= RecvTensorBatchSize()) {
+      full = std::move(pending);
+      pending_batches_.erase(src_worker);
+      schedule_flush = false;
+    }
+  }
+  if (!full.calls.empty()) {
+    SendBatch(std::move(full));
+  } else if (schedule_flush) {
+    Ref();
+    env_->env->SchedClosureAfter(RecvTensorBatchWindowMicros(),
+                                 [this, src_worker, batch_id]() {
+                                   FlushBatch(src_worker, batch_id);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker,
+                                     int64 batch_id) {
+  PendingBatch batch;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    if (it == pending_batches_.end() || it->second.id != batch_id) return;
+    batch = std::move(it->second);
+    pending_batches_.erase(it);
+  }
+  SendBatch(std::move(batch));
+}
+
+void RpcRemoteRendezvous::SendBatch(PendingBatch batch) {
+  if (batch.calls.size() == 1) {
+    StartCall(batch.calls[0], std::move(batch.worker_cache));
+    return;
+  }
+  WorkerInterface* wi = batch.calls[0]->wi_;
+  RpcRecvTensorBatchCall* batch_call =
+      new RpcRecvTensorBatchCall(wi, std::move(batch.calls));
+  RecvTensorBatchRequest* req = batch_call->mutable_request();
+  for (RpcRecvTensorCall* call : batch_call->calls()) {
+    *req->add_request() = call->req_;
+  }
+  req->set_max_inline_bytes(kRecvTensorBatchMaxInlineBytes);
+  req->set_linger_micros(RecvTensorBatchWindowMicros());
+
+  // The batch is aborted with the rendezvous. A cancelled call is finished
+  // with its own status once the batch is done.
+  RegisterCall(batch_call, Args());
+  Ref();
+  batch_call->Start(
+      [this, batch_call, worker_cache = std::move(batch.worker_cache)]() {
+        BatchDone(batch_call, worker_cache);
+        Unref();
+      });
+}
+
+void RpcRemoteRendezvous::BatchDone(
+    RpcRecvTensorBatchCall* batch,
+    std::shared_ptr<WorkerCacheInterface> worker_cache) {
+  DeregisterCall(batch);
+  std::unique_ptr<RpcRecvTensorBatchCall> batch_deleter(batch);
+  Status s = batch->status();
+  const std::vector<RpcRecvTensorCall*>& calls = batch->calls();
+  if (errors::IsUnimplemented(s)) {
+    // The worker predates RecvTensorBatch.
+    for (RpcRecvTensorCall* call : calls) {
+      StartCall(call, worker_cache);
+    }
+    return;
+  }
+  RecvTensorBatchResponse* resp = batch->mutable_response();
+  if (s.ok() && (resp->response_size() != calls.size() ||
+                 resp->deferred_size() != calls.size())) {
+    s = errors::Internal("RecvTensorBatch returned ", resp->response_size(),
+                         " responses for ", calls.size(), " requests");
+  }
+  for (int i = 0; i < calls.size(); ++i) {
+    RpcRecvTensorCall* call = calls[i];
+    if (!s.ok()) {
+      call->StartAbort(s);
+      FinishCall(call);
+    } else if (resp->deferred(i)) {
+      StartCall(call, worker_cache);
+    } else {
+      call->InitFromBatch(resp->mutable_response(i));
+      FinishCall(call);
+    }
+  }
+}
+
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
@@ -88,6 +88,7 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    if (meta_.has_chunked_tensor()) return Status::OK();
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -267,6 +268,12 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kChunkedTensorFieldNumber: {
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadNestedMessage(&input, meta_.mutable_chunked_tensor()))
+          return false;
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -281,6 +288,7 @@ bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
   }
+  if (meta_.has_chunked_tensor()) return true;
 
   Tensor parsed(meta_.tensor().dtype());
   if (!parsed.FromProto(allocator_, meta_.tensor())) {
@@ -298,4 +306,51 @@ bool TensorResponse::ParseSlow(Source* source) {
   return true;
 }
 
+Status TensorChunkResponse::ParseFrom(TensorResponse::Source* source) {
+  const Status parse_error =
+      errors::InvalidArgument("Cannot parse tensor chunk from response");
+  protobuf::io::CodedInputStream input(source->contents());
+  input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
+  bool seen_data = false;
+  while (true) {
+    auto p = input.ReadTagWithCutoff(127);
+    int tag = GetTagFieldNumber(p.first);
+    WireType wt = GetTagWireType(p.first);
+    if (!p.second) {
+      if (tag != 0) return parse_error;
+      if (!seen_data && size_ != 0) {
+        return errors::InvalidArgument("Tensor chunk has no data");
+      }
+      return Status::OK();
+    }
+    switch (tag) {
+      case RecvTensorChunkResponse::kOffsetFieldNumber: {
+        protobuf_uint64 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint64(&v)) {
+          return parse_error;
+        }
+        offset_ = static_cast<int64>(v);
+        break;
+      }
+      case RecvTensorChunkResponse::kDataFieldNumber: {
+        int num_bytes;
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) || seen_data ||
+            !ReadVarintSizeAsInt(&input, &num_bytes)) {
+          return parse_error;
+        }
+        if (num_bytes != size_) {
+          return errors::InvalidArgument("Expected a tensor chunk of ", size_,
+                                         " bytes but got ", num_bytes);
+        }
+        // The data is copied straight into the destination buffer.
+        if (!input.ReadRaw(dst_, num_bytes)) return parse_error;
+        seen_data = true;
+        break;
+      }
+      default:
+        return parse_error;
+    }
+  }
+}
+
 }  // namespace tensorflow
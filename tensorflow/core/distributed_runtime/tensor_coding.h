@@ -81,6 +81,9 @@ class TensorResponse {
 
   // Return a reference to the parsed tensor.  The tensor will remain
   // live only until *this is destroyed or modified.
+  //
+  // If metadata().has_chunked_tensor(), the content is sent separately and
+  // the returned tensor is empty.
   const Tensor& tensor() const { return tensor_; }
 
   // Return a reference to the parsed tensor metadata (no contents).
@@ -106,6 +109,34 @@ class TensorResponse {
   RecvTensorResponse meta_;
 };
 
+// TensorChunkResponse can be used as the destination of an RPC that returns
+// a RecvTensorChunkResponse.  It decodes the chunk data directly into a
+// buffer provided by the caller, usually a part of the destination tensor.
+class TensorChunkResponse {
+ public:
+  TensorChunkResponse() {}
+
+  // Decode the data of a chunk of exactly `size` bytes into `dst`, which
+  // must remain valid until the response is parsed.
+  void Init(char* dst, int64 size) {
+    dst_ = dst;
+    size_ = size;
+    offset_ = 0;
+  }
+
+  // Parse the RecvTensorChunkResponse encoded in the data yielded by
+  // source->contents() into *this.
+  Status ParseFrom(TensorResponse::Source* source);
+
+  // The offset of the chunk in the tensor content, as sent by the peer.
+  int64 offset() const { return offset_; }
+
+ private:
+  char* dst_ = nullptr;
+  int64 size_ = 0;
+  int64 offset_ = 0;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODING_H_
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +157,45 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, ChunkedTensor) {
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  proto.mutable_chunked_tensor()->set_dtype(DT_FLOAT);
+  TensorShape({1000, 1000}).AsProto(
+      proto.mutable_chunked_tensor()->mutable_tensor_shape());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 1024);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_EXPECT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+  EXPECT_EQ(response.metadata().chunked_tensor().dtype(), DT_FLOAT);
+  // The content is sent in chunks, so nothing is allocated for it.
+  EXPECT_EQ(response.tensor().NumElements(), 0);
+}
+
+TEST(TensorChunkResponseTest, Simple) {
+  RecvTensorChunkResponse proto;
+  proto.set_offset(4096);
+  proto.set_data("0123456789");
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 4);
+  char dst[10];
+  TensorChunkResponse response;
+  response.Init(dst, sizeof(dst));
+  TF_EXPECT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(response.offset(), 4096);
+  EXPECT_EQ(string(dst, sizeof(dst)), "0123456789");
+
+  response.Init(dst, 4);
+  EXPECT_FALSE(response.ParseFrom(&source).ok());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
@@ -33,6 +34,9 @@ typedef std::function<void(const Status&)> StatusCallback;
 // Custom decoder for a response to RecvTensorAsync.
 class TensorResponse;
 
+// Custom decoder for a response to RecvTensorChunkAsync.
+class TensorChunkResponse;
+
 // Interface for talking with the TensorFlow Worker service.
 class WorkerInterface {
  public:
@@ -106,6 +110,25 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Fetches part of the content of a tensor whose RecvTensorResponse set
+  // `chunked_tensor`. Only transports whose RecvTensorRequests set
+  // `chunk_bytes` need to implement this.
+  virtual void RecvTensorChunkAsync(CallOptions* opts,
+                                    const RecvTensorChunkRequest* request,
+                                    TensorChunkResponse* response,
+                                    StatusCallback done) {
+    done(errors::Unimplemented("RecvTensorChunkAsync"));
+  }
+
+  // Retrieves several tensors in one call. Tensors that the worker defers
+  // are then fetched with RecvTensorAsync.
+  virtual void RecvTensorBatchAsync(CallOptions* opts,
+                                    const RecvTensorBatchRequest* request,
+                                    RecvTensorBatchResponse* response,
+                                    StatusCallback done) {
+    done(errors::Unimplemented("RecvTensorBatchAsync"));
+  }
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -38,7 +38,10 @@ string AllocatorStats::DebugString() const {
       "MaxAllocSize:     %20lld\n"
       "Reserved:         %20lld\n"
       "PeakReserved:     %20lld\n"
-      "LargestFreeBlock: %20lld\n",
+      "LargestFreeBlock: %20lld\n"
+      "CacheHits:        %20lld\n"
+      "CacheMisses:      %20lld\n"
+      "Cached:           %20lld\n",
       static_cast<long long>(this->bytes_limit ? *this->bytes_limit : 0),
       static_cast<long long>(this->bytes_in_use),
       static_cast<long long>(this->peak_bytes_in_use),
@@ -46,7 +49,10 @@ string AllocatorStats::DebugString() const {
       static_cast<long long>(this->largest_alloc_size),
       static_cast<long long>(this->bytes_reserved),
       static_cast<long long>(this->peak_bytes_reserved),
-      static_cast<long long>(this->largest_free_block_bytes));
+      static_cast<long long>(this->largest_free_block_bytes),
+      static_cast<long long>(this->num_cache_hits),
+      static_cast<long long>(this->num_cache_misses),
+      static_cast<long long>(this->bytes_cached));
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -164,6 +164,12 @@ struct AllocatorStats {
 
   int64 largest_free_block_bytes;  // Largest free block's size in heap.
 
+  // Stats for allocators that serve small requests from a front-end cache of
+  // recently freed chunks.
+  int64 num_cache_hits;    // Allocations served from the cache.
+  int64 num_cache_misses;  // Cacheable allocations that missed the cache.
+  int64 bytes_cached;      // Bytes currently parked in the cache.
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -171,7 +177,10 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        num_cache_hits(0),
+        num_cache_misses(0),
+        bytes_cached(0) {}
 
   std::string DebugString() const;
 };
@@ -446,6 +455,11 @@ class SubAllocator {
                       size_t* bytes_received) = 0;
   virtual void Free(void* ptr, size_t num_bytes) = 0;
 
+  // Returns true if successive calls to Alloc may return adjacent memory that
+  // can be treated as one contiguous range, and if Free accepts any range made
+  // up of whole, adjacent allocations.
+  virtual bool SupportsCoalescing() const { return false; }
+
  protected:
   // Implementation of Alloc() method must call this on newly allocated
   // value.
@@ -319,6 +319,10 @@ class CollectiveExecutor : public core::RefCounted {
 
   virtual CollectiveRemoteAccess* remote_access() { return nullptr; }
 
+  // Returns the wall time, in microseconds, during which at least one
+  // collective executed by this object was pending.
+  virtual int64 pending_micros() const { return 0; }
+
   // `WaitForDependencies` and `Launched` are used for fine-grained control of
   // execution order between collective instances.  These functions are intended
   // to be called in `Run` function of collective implementations, and may be
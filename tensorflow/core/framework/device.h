@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -151,6 +152,20 @@ class Device : public DeviceBase {
     return Status::OK();
   }
 
+  // Assigns a DeviceContext to each node of `graph` that should not run with
+  // the context from TryGetDeviceContext(), e.g. to spread independent
+  // computations over several streams.  On return `device_context_map` is
+  // either empty or indexed by node id, holding nullptr for the nodes that use
+  // the default context.
+  //
+  // The caller takes ownership of one reference on each non-null entry, and
+  // should call Unref() on them.
+  virtual Status FillContextMap(
+      const Graph* /*graph*/,
+      std::vector<DeviceContext*>* /*device_context_map*/) {
+    return Status::OK();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
@@ -0,0 +1,228 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/dtype_conversion.h"
+
+#include <string.h>
+
+#include "tensorflow/core/platform/cpu_info.h"
+
+// The vector loops are compiled for AVX2 and F16C regardless of the flags of
+// the build, and are only called if the CPU supports them.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TF_CONVERSION_USE_AVX2 1
+#define TF_CONVERSION_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#endif
+
+namespace tensorflow {
+
+namespace {
+
+#ifdef TF_CONVERSION_USE_AVX2
+
+bool HasAvx2AndF16C() {
+  static const bool result = port::TestCPUFeature(port::CPUFeature::AVX2) &&
+                             port::TestCPUFeature(port::CPUFeature::F16C);
+  return result;
+}
+
+// Packs the 32-bit lanes of `lo` and then `hi`, which must all be below 2^16,
+// into 16-bit lanes.
+TF_CONVERSION_TARGET_AVX2 inline __m256i Pack32To16(__m256i lo, __m256i hi) {
+  // packus interleaves the 128-bit halves of its operands.
+  return _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xd8);
+}
+
+// Returns the bfloat16 bits of the floats of `x`, rounded to nearest even.
+TF_CONVERSION_TARGET_AVX2 inline __m256i RoundToBFloat16(__m256i x) {
+  const __m256i high = _mm256_srli_epi32(x, 16);
+  const __m256i lsb = _mm256_and_si256(high, _mm256_set1_epi32(1));
+  const __m256i bias = _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7fff));
+  const __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(x, bias), 16);
+  // NaNs become quiet NaNs of the same sign, since rounding them could turn
+  // them into infinities.
+  const __m256i abs = _mm256_and_si256(x, _mm256_set1_epi32(0x7fffffff));
+  const __m256i is_nan =
+      _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x7f800000));
+  const __m256i nan = _mm256_or_si256(
+      _mm256_and_si256(high, _mm256_set1_epi32(0x8000)),
+      _mm256_set1_epi32(0x7fc0));
+  return _mm256_blendv_epi8(rounded, nan, is_nan);
+}
+
+// The loops below convert a multiple of the vector width and return how many
+// elements they converted.  The rest is converted by the scalar loops.
+
+template <bool kRound>
+TF_CONVERSION_TARGET_AVX2 int64 FloatToBFloat16Avx2(const float* src,
+                                                    bfloat16* dst,
+                                                    int64 size) {
+  int64 i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i hi =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8));
+    if (kRound) {
+      lo = RoundToBFloat16(lo);
+      hi = RoundToBFloat16(hi);
+    } else {
+      lo = _mm256_srli_epi32(lo, 16);
+      hi = _mm256_srli_epi32(hi, 16);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        Pack32To16(lo, hi));
+  }
+  return i;
+}
+
+TF_CONVERSION_TARGET_AVX2 int64 BFloat16ToFloatAvx2(const bfloat16* src,
+                                                    float* dst, int64 size) {
+  int64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i x =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_slli_epi32(_mm256_cvtepu16_epi32(x), 16));
+  }
+  return i;
+}
+
+TF_CONVERSION_TARGET_AVX2 int64 FloatToHalfAvx2(const float* src,
+                                                Eigen::half* dst, int64 size) {
+  int64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 x = _mm256_loadu_ps(src + i);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT));
+  }
+  return i;
+}
+
+TF_CONVERSION_TARGET_AVX2 int64 HalfToFloatAvx2(const Eigen::half* src,
+                                                float* dst, int64 size) {
+  int64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i x =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(x));
+  }
+  return i;
+}
+
+TF_CONVERSION_TARGET_AVX2 int64 Int8ToFloatAvx2(const int8* src, float* dst,
+                                                int64 size) {
+  int64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i x =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(x)));
+  }
+  return i;
+}
+
+TF_CONVERSION_TARGET_AVX2 int64 Uint8ToFloatAvx2(const uint8* src, float* dst,
+                                                 int64 size) {
+  int64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m128i x =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(x)));
+  }
+  return i;
+}
+
+#endif  // TF_CONVERSION_USE_AVX2
+
+}  // namespace
+
+void ConvertFloatToBFloat16(const float* src, bfloat16* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_CONVERSION_USE_AVX2
+  if (HasAvx2AndF16C()) i = FloatToBFloat16Avx2<true>(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+    dst[i] = static_cast<bfloat16>(src[i]);
+  }
+}
+
+void TruncateFloatToBFloat16(const float* src, bfloat16* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_CONVERSION_USE_AVX2
+  if (HasAvx2AndF16C()) i = FloatToBFloat16Avx2<false>(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    memcpy(dst + i, src + i, sizeof(bfloat16));
+#else
+    memcpy(dst + i,
+           reinterpret_cast<const char*>(src + i) + sizeof(float) -
+               sizeof(bfloat16),
+           sizeof(bfloat16));
+#endif
+  }
+}
+
+void ConvertBFloat16ToFloat(const bfloat16* src, float* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_CONVERSION_USE_AVX2
+  if (HasAvx2AndF16C()) i = BFloat16ToFloatAvx2(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+void ConvertFloatToHalf(const float* src, Eigen::half* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_CONVERSION_USE_AVX2
+  if (HasAvx2AndF16C()) i = FloatToHalfAvx2(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+    dst[i] = static_cast<Eigen::half>(src[i]);
+  }
+}
+
+void ConvertHalfToFloat(const Eigen::half* src, float* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_CONVERSION_USE_AVX2
+  if (HasAvx2AndF16C()) i = HalfToFloatAvx2(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+void ConvertInt8ToFloat(const int8* src, float* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_CONVERSION_USE_AVX2
+  if (HasAvx2AndF16C()) i = Int8ToFloatAvx2(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+void ConvertUint8ToFloat(const uint8* src, float* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_CONVERSION_USE_AVX2
+  if (HasAvx2AndF16C()) i = Uint8ToFloatAvx2(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+}  // namespace tensorflow
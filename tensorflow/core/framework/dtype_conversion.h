@@ -0,0 +1,45 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_DTYPE_CONVERSION_H_
+#define TENSORFLOW_CORE_FRAMEWORK_DTYPE_CONVERSION_H_
+
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/platform/types.h"
+
+// Bulk conversions between float and the narrow types used by mixed-precision
+// models.  They produce the same values as a static_cast of every element, but
+// use the vector conversion instructions of the CPU when it has them (AVX2 and
+// F16C on x86), which is checked at runtime.
+
+namespace tensorflow {
+
+// Convert from float to bfloat16 with rounding-to-nearest-even.
+void ConvertFloatToBFloat16(const float* src, bfloat16* dst, int64 size);
+// Convert from float to bfloat16 by keeping the 16 most significant bits of
+// each float.
+void TruncateFloatToBFloat16(const float* src, bfloat16* dst, int64 size);
+void ConvertBFloat16ToFloat(const bfloat16* src, float* dst, int64 size);
+
+// Convert from float to half with rounding-to-nearest-even.
+void ConvertFloatToHalf(const float* src, Eigen::half* dst, int64 size);
+void ConvertHalfToFloat(const Eigen::half* src, float* dst, int64 size);
+
+void ConvertInt8ToFloat(const int8* src, float* dst, int64 size);
+void ConvertUint8ToFloat(const uint8* src, float* dst, int64 size);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_DTYPE_CONVERSION_H_
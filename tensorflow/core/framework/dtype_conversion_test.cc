@@ -0,0 +1,139 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/dtype_conversion.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "absl/base/casts.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Not a multiple of the vector widths, so that the scalar loops run too.
+constexpr int kSize = 1021;
+
+// Returns floats with random bits, including NaNs, infinities, denormals, and
+// values that are halfway between two bfloat16s.
+std::vector<float> RandomFloats() {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<float> values(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    uint32 bits = rnd.Rand32();
+    if (i % 3 == 0) bits = (bits & 0xffff0000) | 0x8000;
+    values[i] = absl::bit_cast<float>(bits);
+  }
+  values[0] = std::numeric_limits<float>::infinity();
+  values[1] = -std::numeric_limits<float>::quiet_NaN();
+  values[2] = std::numeric_limits<float>::max();
+  values[3] = std::numeric_limits<float>::denorm_min();
+  values[4] = 65504.0f;
+  values[5] = 65520.0f;
+  return values;
+}
+
+template <typename T>
+uint16 Bits(T value) {
+  return absl::bit_cast<uint16>(value);
+}
+
+TEST(DtypeConversionTest, FloatToBFloat16) {
+  const std::vector<float> src = RandomFloats();
+  std::vector<bfloat16> dst(kSize);
+  ConvertFloatToBFloat16(src.data(), dst.data(), kSize);
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(Bits(static_cast<bfloat16>(src[i])), Bits(dst[i])) << src[i];
+  }
+}
+
+TEST(DtypeConversionTest, TruncateFloatToBFloat16) {
+  const std::vector<float> src = RandomFloats();
+  std::vector<bfloat16> dst(kSize);
+  TruncateFloatToBFloat16(src.data(), dst.data(), kSize);
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(absl::bit_cast<uint32>(src[i]) >> 16, Bits(dst[i])) << src[i];
+  }
+}
+
+TEST(DtypeConversionTest, BFloat16ToFloat) {
+  const std::vector<float> values = RandomFloats();
+  std::vector<bfloat16> src(kSize);
+  TruncateFloatToBFloat16(values.data(), src.data(), kSize);
+  std::vector<float> dst(kSize);
+  ConvertBFloat16ToFloat(src.data(), dst.data(), kSize);
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(absl::bit_cast<uint32>(values[i]) & 0xffff0000,
+              absl::bit_cast<uint32>(dst[i]));
+  }
+}
+
+TEST(DtypeConversionTest, FloatToHalf) {
+  std::vector<float> src = RandomFloats();
+  // Most random floats are out of the range of half.
+  for (int i = 6; i < kSize; i += 2) src[i] = std::ldexp(src[i], -100);
+  std::vector<Eigen::half> dst(kSize);
+  ConvertFloatToHalf(src.data(), dst.data(), kSize);
+  for (int i = 0; i < kSize; ++i) {
+    const Eigen::half expected = static_cast<Eigen::half>(src[i]);
+    if (std::isnan(src[i])) {
+      EXPECT_TRUE(Eigen::numext::isnan(dst[i]));
+    } else {
+      EXPECT_EQ(Bits(expected), Bits(dst[i])) << src[i];
+    }
+  }
+}
+
+TEST(DtypeConversionTest, HalfToFloat) {
+  std::vector<Eigen::half> src(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    src[i] = absl::bit_cast<Eigen::half>(static_cast<uint16>(i * 64 + i));
+  }
+  std::vector<float> dst(kSize);
+  ConvertHalfToFloat(src.data(), dst.data(), kSize);
+  for (int i = 0; i < kSize; ++i) {
+    const float expected = static_cast<float>(src[i]);
+    if (std::isnan(expected)) {
+      EXPECT_TRUE(std::isnan(dst[i]));
+    } else {
+      EXPECT_EQ(expected, dst[i]);
+    }
+  }
+}
+
+TEST(DtypeConversionTest, Int8ToFloat) {
+  std::vector<int8> src(kSize);
+  std::vector<uint8> usrc(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    src[i] = static_cast<int8>(i * 7);
+    usrc[i] = static_cast<uint8>(i * 7);
+  }
+  std::vector<float> dst(kSize);
+  std::vector<float> udst(kSize);
+  ConvertInt8ToFloat(src.data(), dst.data(), kSize);
+  ConvertUint8ToFloat(usrc.data(), udst.data(), kSize);
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(static_cast<float>(src[i]), dst[i]);
+    EXPECT_EQ(static_cast<float>(usrc[i]), udst[i]);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <vector>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -29,6 +31,50 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// Keeps the storage of recently deleted rendezvous items of a thread, for
+// reuse by later items, so that Send and Recv don't allocate in steady state.
+// Items are often created and deleted by different threads, so the number of
+// kept blocks is bounded.
+class ItemStoragePool {
+ public:
+  ~ItemStoragePool() {
+    for (void* p : free_) port::Free(p);
+  }
+
+  void* Allocate(size_t size) {
+    if (size == size_ && !free_.empty()) {
+      void* p = free_.back();
+      free_.pop_back();
+      return p;
+    }
+    return port::Malloc(size);
+  }
+
+  void Free(void* p, size_t size) {
+    if (free_.size() < kMaxFreeBlocks && (size_ == 0 || size == size_)) {
+      size_ = size;
+      free_.push_back(p);
+    } else {
+      port::Free(p);
+    }
+  }
+
+  static ItemStoragePool* Get() {
+    static thread_local ItemStoragePool pool;
+    return &pool;
+  }
+
+ private:
+  static constexpr int kMaxFreeBlocks = 64;
+
+  size_t size_ = 0;
+  std::vector<void*> free_;
+};
+
+}  // namespace
+
 // Represents a blocked Send() or Recv() call in the rendezvous.
 struct LocalRendezvous::Item {
   enum Type { kSend = 0, kRecv = 1 };
@@ -57,6 +103,13 @@ struct LocalRendezvous::Item {
     }
   }
 
+  static void* operator new(size_t size) {
+    return ItemStoragePool::Get()->Allocate(size);
+  }
+  static void operator delete(void* p, size_t size) {
+    ItemStoragePool::Get()->Free(p, size);
+  }
+
   const Rendezvous::Args args;
   const Type type;
 
@@ -97,19 +150,20 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
 }
 
 LocalRendezvous::~LocalRendezvous() {
-  if (!table_.empty()) {
+  bool empty = true;
+  for (Shard& shard : shards_) {
+    mutex_lock l(shard.mu);
+    empty &= shard.table.empty();
+  }
+  if (!empty) {
     StartAbort(errors::Cancelled("LocalRendezvous deleted"));
   }
 }
 
-namespace {
-uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
-}  // namespace
-
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
-  uint64 key_hash = KeyHash(key.FullKey());
+  const uint64 key_hash = key.Hash();
   DVLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
 
   if (is_dead) {
@@ -122,39 +176,45 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
-  mu_.lock();
-  if (!status_.ok()) {
+  Shard& shard = ShardFor(key_hash);
+  shard.mu.lock();
+  if (!shard.status.ok()) {
     // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
+    Status s = shard.status;
+    shard.mu.unlock();
     return s;
   }
 
-  ItemQueue* queue = &table_[key_hash];
-  if (queue->head == nullptr || queue->head->type == Item::kSend) {
+  auto it = shard.table.find(key_hash);
+  if (it == shard.table.end() || it->second.head->type == Item::kSend) {
     // There is no waiter for this message. Append the message
     // into the queue. The waiter will pick it up when arrives.
     // Only send-related fields need to be filled.
-    // TODO(b/143786186): Investigate moving the allocation of `Item` outside
-    // the lock.
     DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
-    queue->push_back(new Item(send_args, val, is_dead));
-    mu_.unlock();
+    Item* item = new Item(send_args, val, is_dead);
+    if (it == shard.table.end()) {
+      shard.table.emplace(key_hash, ItemQueue{item, item});
+    } else {
+      it->second.push_back(item);
+    }
+    shard.mu.unlock();
     return Status::OK();
   }
 
   DVLOG(2) << "Consume Recv Item (key:" << key.FullKey() << "). ";
   // There is an earliest waiter to consume this message.
+  ItemQueue* queue = &it->second;
   Item* item = queue->head;
 
-  // Delete the queue when the last element has been consumed.
+  // Delete the queue when the last element has been consumed. This is the
+  // common case, where a single send is matched by a single recv.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    shard.table.erase(it);
   } else {
     queue->head = item->next;
   }
-  mu_.unlock();
+  shard.mu.unlock();
 
   // Notify the waiter by invoking its done closure, outside the
   // lock.
@@ -167,20 +227,21 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                                 const Rendezvous::Args& recv_args,
                                 Rendezvous::DoneCallback done) {
-  uint64 key_hash = KeyHash(key.FullKey());
+  const uint64 key_hash = key.Hash();
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-  mu_.lock();
-  if (!status_.ok()) {
+  Shard& shard = ShardFor(key_hash);
+  shard.mu.lock();
+  if (!shard.status.ok()) {
     // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
+    Status s = shard.status;
+    shard.mu.unlock();
     done(s, Rendezvous::Args(), recv_args, Tensor(), false);
     return;
   }
 
-  ItemQueue* queue = &table_[key_hash];
-  if (queue->head == nullptr || queue->head->type == Item::kRecv) {
+  auto it = shard.table.find(key_hash);
+  if (it == shard.table.end() || it->second.head->type == Item::kRecv) {
     // There is no message to pick up.
     // Only recv-related fields need to be filled.
     CancellationManager* cm = recv_args.cancellation_manager;
@@ -205,11 +266,13 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       already_cancelled = !cm->RegisterCallback(token, [this, token, key_hash] {
         Item* item = nullptr;
         {
-          mutex_lock l(mu_);
-          ItemQueue* queue = &table_[key_hash];
+          Shard& shard = ShardFor(key_hash);
+          mutex_lock l(shard.mu);
+          auto it = shard.table.find(key_hash);
           // Find an item in the queue with a cancellation token that matches
           // `token`, and remove it.
-          if (queue->head != nullptr && queue->head->type == Item::kRecv) {
+          if (it != shard.table.end() && it->second.head->type == Item::kRecv) {
+            ItemQueue* queue = &it->second;
             for (Item *prev = nullptr, *curr = queue->head; curr != nullptr;
                  prev = curr, curr = curr->next) {
               if (curr->recv_state.cancellation_token == token) {
@@ -217,7 +280,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                 if (queue->head->next == nullptr) {
                   // We have a single-element queue, so we can erase it from
                   // the table.
-                  table_.erase(key_hash);
+                  shard.table.erase(it);
                 } else {
                   // Remove the current item from the queue.
                   if (curr == queue->head) {
@@ -249,7 +312,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       });
     }
     if (already_cancelled) {
-      mu_.unlock();
+      shard.mu.unlock();
       // Unref case (2)
       if (rc_owner_) rc_owner_->Unref();
       done(StatusGroup::MakeDerived(
@@ -260,13 +323,12 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
 
     DVLOG(2) << "Enqueue Recv Item (key:" << key.FullKey() << "). ";
 
-    // TODO(b/143786186): Investigate moving the allocation of `Item` outside
-    // the lock.
+    Item* item;
     if (cm != nullptr) {
       // NOTE(mrry): We must wrap `done` with code that deregisters the
       // cancellation callback before calling the `done` callback, because the
       // cancellation manager may no longer be live after `done` is called.
-      queue->push_back(new Item(
+      item = new Item(
           recv_args,
           [this, cm, token, done = std::move(done)](
               const Status& s, const Rendezvous::Args& send_args,
@@ -281,28 +343,37 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
             }
             done(s, send_args, recv_args, v, dead);
           },
-          token));
+          token);
+    } else {
+      item = new Item(recv_args, std::move(done), token);
+    }
+    // The cancellation callback can't have run, since it needs the lock of
+    // the shard, so `it` is still valid.
+    if (it == shard.table.end()) {
+      shard.table.emplace(key_hash, ItemQueue{item, item});
     } else {
-      queue->push_back(new Item(recv_args, std::move(done), token));
+      it->second.push_back(item);
     }
 
-    mu_.unlock();
+    shard.mu.unlock();
     return;
   }
 
   DVLOG(2) << "Consume Send Item (key:" << key.FullKey() << "). ";
   // A message has already arrived and is queued in the table under
   // this key.  Consumes the message and invokes the done closure.
+  ItemQueue* queue = &it->second;
   Item* item = queue->head;
 
-  // Delete the queue when the last element has been consumed.
+  // Delete the queue when the last element has been consumed. This is the
+  // common case, where a single send is matched by a single recv.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    shard.table.erase(it);
   } else {
     queue->head = item->next;
   }
-  mu_.unlock();
+  shard.mu.unlock();
 
   // Invoke done() without holding the table lock.
   DCHECK_EQ(item->type, Item::kSend);
@@ -313,22 +384,24 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
 
 void LocalRendezvous::StartAbort(const Status& status) {
   CHECK(!status.ok());
-  Table table;
-  {
-    mutex_lock l(mu_);
-    status_.Update(status);
-    table_.swap(table);
-  }
-  for (auto& p : table) {
-    Item* item = p.second.head;
-    while (item != nullptr) {
-      if (item->type == Item::kRecv) {
-        (*item->recv_state.waiter)(status, Rendezvous::Args(),
-                                   Rendezvous::Args(), Tensor(), false);
+  for (Shard& shard : shards_) {
+    Table table;
+    {
+      mutex_lock l(shard.mu);
+      shard.status.Update(status);
+      shard.table.swap(table);
+    }
+    for (auto& p : table) {
+      Item* item = p.second.head;
+      while (item != nullptr) {
+        if (item->type == Item::kRecv) {
+          (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                     Rendezvous::Args(), Tensor(), false);
+        }
+        Item* to_delete = item;
+        item = item->next;
+        delete to_delete;
       }
-      Item* to_delete = item;
-      item = item->next;
-      delete to_delete;
     }
   }
 }
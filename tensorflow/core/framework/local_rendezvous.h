@@ -16,10 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -29,6 +29,10 @@ namespace tensorflow {
 // Implements the basic logic of matching Send and Recv operations. See
 // RendezvousInterface for more details.
 //
+// Pending sends and receives are kept in tables sharded by the hash of their
+// key, each with its own lock, so that the Send/Recv pairs of unrelated edges
+// don't contend with each other.
+//
 // NOTE: Most users will use a class that wraps LocalRendezvous, such as
 // IntraProcessRendezvous or RemoteRendezvous. This class does not implement
 // RendezvousInterface because virtual dispatch to LocalRendezvous methods
@@ -64,15 +68,27 @@ class LocalRendezvous {
     Item* tail = nullptr;
   };
 
-  typedef gtl::FlatMap<uint64, ItemQueue> Table;
+  // Keyed by Rendezvous::ParsedKey::Hash(). A flat_hash_map doesn't allocate
+  // until its first insertion, so that the tables of the shards that are
+  // never used, e.g. by short-lived per-step rendezvous, cost nothing.
+  typedef absl::flat_hash_map<uint64, ItemQueue> Table;
+
+  struct Shard {
+    mutex mu;
+    Table table TF_GUARDED_BY(mu);
+    // Every shard has a copy of the abort status, so that Send and Recv only
+    // lock the shard of their key.
+    Status status TF_GUARDED_BY(mu);
+  };
+
+  static constexpr int kNumShards = 16;
+
+  Shard& ShardFor(uint64 key_hash) { return shards_[key_hash % kNumShards]; }
 
   // Pointer to the owner class of this LocalRendezvous if it is refcounted.
   const Rendezvous* rc_owner_;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ TF_GUARDED_BY(mu_);
-  Status status_ TF_GUARDED_BY(mu_);
+  Shard shards_[kNumShards];
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalRendezvous);
 };
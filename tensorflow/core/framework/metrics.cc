@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
 
 namespace tensorflow {
@@ -48,6 +49,35 @@ auto* graph_pending_queue_length_histogram = monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* graph_scheduling_latency_usecs_histogram = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/graph_scheduling_latency_usecs_histogram",
+     "The time, in microseconds, between a node of a graph becoming ready "
+     "and an executor thread starting to process it, for a sample of the "
+     "nodes dispatched through the inter-op thread pool."},
+    // Power of 2 with bucket count 20 (> 1 second)
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+auto* distributed_step_time_usecs_histogram = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/distributed_step_time_usecs_histogram",
+     "The time, in microseconds, that each worker spent running its "
+     "partitions of a distributed step, broken down by component.",
+     "component"},
+    // Power of 2 with bucket count 30 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1, 2, 30)});
+
+auto* distributed_step_stragglers = monitoring::Counter<1>::New(
+    "/tensorflow/core/distributed_step_stragglers",
+    "The number of distributed steps in which each worker was the last to "
+    "finish.",
+    "worker");
+
+auto* graph_node_dispatches = monitoring::Counter<1>::New(
+    "/tensorflow/core/graph_node_dispatches",
+    "The number of graph nodes run by the executors, by whether they were "
+    "dispatched through the inter-op thread pool or run inline by the thread "
+    "that made them ready.",
+    "dispatch");
+
 auto* graph_run_input_tensor_bytes = monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -86,6 +116,34 @@ auto* tf_data_bytes_fetched_counter = monitoring::Counter<0>::New(
 auto* tf_data_elements_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/elements", "tf.data elements", "name");
 
+auto* tf_data_processing_time_counter = monitoring::Counter<1>::New(
+    "/tensorflow/data/processing_time",
+    "The time (in microseconds) spent by a tf.data Dataset producing "
+    "elements.",
+    "name");
+
+auto* tf_data_wait_time_counter = monitoring::Counter<1>::New(
+    "/tensorflow/data/wait_time",
+    "The time (in microseconds) that the consumers of a tf.data Dataset "
+    "waited for it to produce elements.",
+    "name");
+
+auto* tf_data_wait_fraction_histogram = monitoring::Sampler<1>::New(
+    {"/tensorflow/data/wait_fraction",
+     "Fraction of time that the consumers of a tf.data Dataset waited for it "
+     "to produce elements, per autotuning period.",
+     "name"},
+    {monitoring::Buckets::Explicit(
+        {0.01, 0.02, 0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9})});
+
+auto* tf_data_buffer_utilization_histogram = monitoring::Sampler<1>::New(
+    {"/tensorflow/data/buffer_utilization",
+     "Fraction of the buffer of a tf.data Dataset which was full, per "
+     "autotuning period.",
+     "name"},
+    {monitoring::Buckets::Explicit(
+        {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9})});
+
 auto* tf_data_experiment_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/experiment",
     "The number of times tf.data experiment is applied to input pipelines.",
@@ -115,6 +173,33 @@ auto* tf_data_iterator_lifetime_counter = monitoring::Counter<0>::New(
 auto* tf_data_optimization_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/optimization", "tf.data optimization", "name");
 
+auto* tf_data_service_stall_rate_histogram = monitoring::Sampler<0>::New(
+    {"/tensorflow/data/service/stall_rate",
+     "Fraction of the element requests of a tf.data service task which waited "
+     "for an element, per worker heartbeat."},
+    {monitoring::Buckets::Explicit(
+        {0.01, 0.02, 0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9})});
+
+auto* tf_data_service_wait_time_usecs_histogram = monitoring::Sampler<0>::New(
+    {"/tensorflow/data/service/wait_time",
+     "Average microseconds that the element requests of a tf.data service "
+     "task waited for an element, per worker heartbeat."},
+    // Power of 2 with bucket count 20 (about 1 second).
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+auto* tf_data_service_buffer_occupancy_histogram = monitoring::Sampler<0>::New(
+    {"/tensorflow/data/service/buffer_occupancy",
+     "Average fraction of the buffer of a tf.data service task which was full "
+     "when an element was requested, per worker heartbeat."},
+    {monitoring::Buckets::Explicit(
+        {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9})});
+
+auto* tf_data_service_recommended_workers_gauge =
+    monitoring::Gauge<int64, 0>::New(
+        "/tensorflow/data/service/recommended_workers",
+        "The number of workers recommended by the tf.data service "
+        "dispatcher.");
+
 auto* parse_dense_feature_counter = monitoring::Counter<0>::New(
     "/tensorflow/data/dense_feature",
     "The number of dense features parsed by ops for parsing tf.Example.");
@@ -162,6 +247,14 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* event_mgr_notification_delay_usecs_histogram =
+    monitoring::Sampler<0>::New(
+        {"/tensorflow/core/event_mgr_notification_delay_usecs_histogram",
+         "The upper bound, in microseconds, on the time between the "
+         "completion of a device event and its notification by EventMgr."},
+        // Power of 2 with bucket count 20 (> 1 second)
+        {monitoring::Buckets::Exponential(1, 2, 20)});
+
 }  // namespace
 
 void RecordTFDataAutotune(const string& name) {
@@ -184,6 +277,22 @@ monitoring::CounterCell* GetTFDataElementsCounter(const string& name) {
   return tf_data_elements_counter->GetCell(name);
 }
 
+monitoring::CounterCell* GetTFDataProcessingTimeCounter(const string& name) {
+  return tf_data_processing_time_counter->GetCell(name);
+}
+
+monitoring::CounterCell* GetTFDataWaitTimeCounter(const string& name) {
+  return tf_data_wait_time_counter->GetCell(name);
+}
+
+void RecordTFDataWaitFraction(const string& name, double fraction) {
+  tf_data_wait_fraction_histogram->GetCell(name)->Add(fraction);
+}
+
+void RecordTFDataBufferUtilization(const string& name, double utilization) {
+  tf_data_buffer_utilization_histogram->GetCell(name)->Add(utilization);
+}
+
 void RecordTFDataBytesFetched(int64 num_bytes) {
   tf_data_bytes_fetched_counter->GetCell()->IncrementBy(num_bytes);
 }
@@ -218,6 +327,25 @@ void RecordTFDataOptimization(const string& name, int64 num_changes) {
   tf_data_optimization_counter->GetCell(name)->IncrementBy(num_changes);
 }
 
+void RecordTFDataServiceTaskStats(double stall_rate, double mean_wait_time_us,
+                                  double buffer_occupancy) {
+  static auto* stall_rate_cell =
+      tf_data_service_stall_rate_histogram->GetCell();
+  static auto* wait_time_cell =
+      tf_data_service_wait_time_usecs_histogram->GetCell();
+  static auto* buffer_occupancy_cell =
+      tf_data_service_buffer_occupancy_histogram->GetCell();
+  stall_rate_cell->Add(stall_rate);
+  wait_time_cell->Add(mean_wait_time_us);
+  buffer_occupancy_cell->Add(buffer_occupancy);
+}
+
+void RecordTFDataServiceRecommendedWorkers(int64 num_workers) {
+  static auto* recommended_workers_cell =
+      tf_data_service_recommended_workers_gauge->GetCell();
+  recommended_workers_cell->Set(num_workers);
+}
+
 void RecordParseDenseFeature(int64 num_features) {
   static auto* parse_dense_feature_counter_cell =
       parse_dense_feature_counter->GetCell();
@@ -266,6 +394,27 @@ void UpdateGraphPendingQueueLength(uint64 len) {
   graph_pending_queue_length_cell->Add(len);
 }
 
+void RecordDistributedStepTime(const string& component, const uint64 usecs) {
+  distributed_step_time_usecs_histogram->GetCell(component)->Add(usecs);
+}
+
+void RecordDistributedStepStraggler(const string& worker) {
+  distributed_step_stragglers->GetCell(worker)->IncrementBy(1);
+}
+
+void UpdateGraphSchedulingLatency(const uint64 latency_usecs) {
+  static auto* graph_scheduling_latency_cell =
+      graph_scheduling_latency_usecs_histogram->GetCell();
+  graph_scheduling_latency_cell->Add(latency_usecs);
+}
+
+void RecordGraphNodeDispatches(int64 num_threadpool, int64 num_inline) {
+  static auto* threadpool_cell = graph_node_dispatches->GetCell("threadpool");
+  static auto* inline_cell = graph_node_dispatches->GetCell("inline");
+  if (num_threadpool > 0) threadpool_cell->IncrementBy(num_threadpool);
+  if (num_inline > 0) inline_cell->IncrementBy(num_inline);
+}
+
 void UpdateGraphOptimizationPassTime(const string& pass_name,
                                      const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
@@ -309,6 +458,12 @@ void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   }
 }
 
+void RecordEventMgrNotificationDelay(const uint64 delay_usecs) {
+  static auto* event_mgr_notification_delay_cell =
+      event_mgr_notification_delay_usecs_histogram->GetCell();
+  event_mgr_notification_delay_cell->Add(delay_usecs);
+}
+
 void IncrementMLIRImportFailureCount() {
   static auto* mlir_import_failure_count_cell =
       mlir_import_failure_count->GetCell();
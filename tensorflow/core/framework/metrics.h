@@ -53,6 +53,32 @@ monitoring::CounterCell* GetTFDataBytesReadCounter(const string& name);
 // The `name` argument identifies the Dataset type (e.g. "Batch" or "Map").
 monitoring::CounterCell* GetTFDataElementsCounter(const string& name);
 
+// Returns a counter that can be used to record the time (in microseconds)
+// spent by a tf.data.Dataset producing elements.
+//
+// The `name` argument identifies the Dataset type (e.g. "Batch" or "Map").
+monitoring::CounterCell* GetTFDataProcessingTimeCounter(const string& name);
+
+// Returns a counter that can be used to record the time (in microseconds)
+// that the consumers of a tf.data.Dataset waited for it to produce elements.
+//
+// The `name` argument identifies the Dataset type (e.g. "Prefetch" or
+// "ParallelMap").
+monitoring::CounterCell* GetTFDataWaitTimeCounter(const string& name);
+
+// Records the fraction of time that the consumers of a tf.data.Dataset waited
+// for it to produce elements, over the period since the last record.
+//
+// The `name` argument identifies the Dataset type (e.g. "Prefetch" or
+// "ParallelMap").
+void RecordTFDataWaitFraction(const string& name, double fraction);
+
+// Records the fraction of the buffer of a tf.data.Dataset that is full.
+//
+// The `name` argument identifies the Dataset type (e.g. "Prefetch" or
+// "ParallelMap").
+void RecordTFDataBufferUtilization(const string& name, double utilization);
+
 // Records the number of bytes fetched from tf.data.Dataset iterator.
 void RecordTFDataBytesFetched(int64 num_bytes);
 
@@ -78,6 +104,17 @@ void RecordTFDataIteratorBusy(uint64 duration_us);
 // first `GetNext()` request and responding to the last `GetNext()` request.
 void RecordTFDataIteratorLifetime(uint64 duration_us);
 
+// Records the statistics that a tf.data service worker reported for a task in
+// a heartbeat: the fraction of element requests that waited for an element,
+// their average wait time (in microseconds), and the average fraction of the
+// task's buffer that was full.
+void RecordTFDataServiceTaskStats(double stall_rate, double mean_wait_time_us,
+                                  double buffer_occupancy);
+
+// Records the number of workers recommended by the tf.data service
+// dispatcher.
+void RecordTFDataServiceRecommendedWorkers(int64 num_workers);
+
 // Records the number of independent graph changes resulting from the
 // application of a tf.data optimization.
 //
@@ -100,6 +137,26 @@ void RecordGraphOutputTensors(const size_t size);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records one component of the time that a worker spent running its
+// partitions of a distributed step, as reported to the master: "run_graph"
+// for the whole RunGraph call, "remote_recv" and "collective" for the time
+// with tensors from other workers or collectives pending, "compute" for the
+// rest, and "straggler_wait" for the time until the slowest worker was done.
+void RecordDistributedStepTime(const string& component, const uint64 usecs);
+
+// Records that `worker` was the last worker to finish a distributed step.
+void RecordDistributedStepStraggler(const string& worker);
+
+// Records the time between a node becoming ready and an executor thread
+// starting to process it, for a sample of the nodes that were dispatched
+// through the inter-op thread pool.
+void UpdateGraphSchedulingLatency(const uint64 latency_usecs);
+
+// Records the number of nodes that an executor thread ran after they were
+// dispatched to it through the inter-op thread pool, and the number of nodes
+// that it ran inline after making them ready itself.
+void RecordGraphNodeDispatches(int64 num_threadpool, int64 num_inline);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -130,6 +187,11 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs);
 
+// Records the delay between the completion of a device event and the moment
+// the EventMgr notices it, as bounded by the time of the last poll that found
+// the event still pending.
+void RecordEventMgrNotificationDelay(const uint64 delay_usecs);
+
 // Increment the number of jobs that failed during import to mlir.
 void IncrementMLIRImportFailureCount();
 
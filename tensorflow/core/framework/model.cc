@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <limits>
 #include <memory>
 
 #include "absl/time/clock.h"
@@ -104,6 +105,18 @@ inline void UpdateParameterValues(
   }
 }
 
+// Returns the sum of the values of the given parallelism parameters.
+inline int64 TotalParallelism(
+    const absl::flat_hash_map<string, std::shared_ptr<Parameter>>& parameters) {
+  int64 parallelism = 0;
+  for (auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      parallelism += std::round(pair.second->value);
+    }
+  }
+  return parallelism;
+}
+
 // Copies the parameter values (which are for optimization tuning) and updates
 // the state values (which are for the input pipeline to follow).
 inline void UpdateStateValues(
@@ -863,6 +876,7 @@ class Unknown : public Node {
 }  // namespace
 
 thread_local int64 Node::work_start_;
+thread_local int64 Node::wait_start_;
 
 std::shared_ptr<Parameter> MakeParameter(const string& name,
                                          std::shared_ptr<SharedState> state,
@@ -1076,6 +1090,55 @@ void Node::FlushMetrics() {
   metrics_.record_bytes_consumed(bytes_consumed_);
   metrics_.record_bytes_produced(bytes_produced_);
   metrics_.record_num_elements(num_elements_);
+  metrics_.record_processing_time(processing_time_);
+  metrics_.record_wait_time(wait_time_, EnvTime::NowNanos());
+  tf_shared_lock l(mu_);
+  auto* parameter = gtl::FindOrNull(parameters_, kBufferSize);
+  if (!parameter) {
+    parameter = gtl::FindOrNull(parameters_, kParallelism);
+  }
+  if (parameter && (*parameter)->state->value > 0) {
+    metrics_.record_buffer_utilization(
+        std::min(1.0, buffered_elements_ / (*parameter)->state->value));
+  }
+}
+
+void Node::CollectTunableParameterValues(
+    absl::flat_hash_map<string, double>* values) const {
+  tf_shared_lock l(mu_);
+  for (const auto& pair : parameters_) {
+    const auto& state = pair.second->state;
+    if (!state->tunable) {
+      continue;
+    }
+    mutex_lock state_lock(*state->mu);
+    if (state->value != kAutotune) {
+      (*values)[strings::StrCat(long_name(), ":", pair.first)] = state->value;
+    }
+  }
+}
+
+void Node::SetTunableParameterValues(
+    const absl::flat_hash_map<string, double>& values) {
+  tf_shared_lock l(mu_);
+  for (const auto& pair : parameters_) {
+    Parameter* parameter = pair.second.get();
+    if (!parameter->state->tunable) {
+      continue;
+    }
+    auto* value = gtl::FindOrNull(
+        values, strings::StrCat(long_name(), ":", pair.first));
+    if (value == nullptr) {
+      continue;
+    }
+    parameter->value =
+        std::min(std::max(*value, parameter->min), parameter->max);
+    VLOG(2) << "Restoring tunable parameter " << long_name() << ":"
+            << pair.first << " to " << parameter->value;
+    mutex_lock state_lock(*parameter->state->mu);
+    parameter->state->value = parameter->value;
+    parameter->state->cond_var->notify_all();
+  }
 }
 
 double Node::OutputTime(absl::flat_hash_map<string, double>* input_times,
@@ -1430,6 +1493,9 @@ void Model::AddNode(Node::Factory factory, const string& name,
   auto node_name = str_util::Split(name, ':', str_util::SkipEmpty()).back();
   mutex_lock l(mu_);
   std::shared_ptr<Node> node = factory({id_counter_++, node_name, parent});
+  if (!initial_parameter_values_.empty()) {
+    node->SetTunableParameterValues(initial_parameter_values_);
+  }
   if (!output_) {
     output_ = node;
   }
@@ -1462,17 +1528,64 @@ void Model::FlushMetrics() {
 }
 
 void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
-                     int64 ram_budget, double model_input_time) {
+                     int64 ram_budget, double model_input_time,
+                     bool enforce_budgets) {
   switch (algorithm) {
     case AutotuneAlgorithm::HILL_CLIMB:
-      OptimizeHillClimb(cpu_budget, ram_budget, model_input_time);
+      OptimizeHillClimb(cpu_budget, ram_budget, model_input_time,
+                        enforce_budgets);
       break;
     case AutotuneAlgorithm::GRADIENT_DESCENT:
-      OptimizeGradientDescent(cpu_budget, ram_budget, model_input_time);
+      OptimizeGradientDescent(cpu_budget, ram_budget, model_input_time,
+                              enforce_budgets);
       break;
   }
 }
 
+absl::flat_hash_map<string, double> Model::TunableParameterValues() {
+  absl::flat_hash_map<string, double> values;
+  std::deque<std::shared_ptr<Node>> queue;
+  {
+    tf_shared_lock l(mu_);
+    if (output_) queue.push_back(output_);
+  }
+  while (!queue.empty()) {
+    auto node = queue.front();
+    queue.pop_front();
+    node->CollectTunableParameterValues(&values);
+    for (auto input : node->inputs()) {
+      queue.push_back(input);
+    }
+  }
+  return values;
+}
+
+void Model::SetTunableParameterValues(
+    absl::flat_hash_map<string, double> values) {
+  std::deque<std::shared_ptr<Node>> queue;
+  {
+    mutex_lock l(mu_);
+    initial_parameter_values_ = std::move(values);
+    if (output_) queue.push_back(output_);
+  }
+  while (!queue.empty()) {
+    auto node = queue.front();
+    queue.pop_front();
+    {
+      tf_shared_lock l(mu_);
+      node->SetTunableParameterValues(initial_parameter_values_);
+    }
+    for (auto input : node->inputs()) {
+      queue.push_back(input);
+    }
+  }
+}
+
+Model::OptimizationStats Model::optimization_stats() {
+  mutex_lock l(stats_mu_);
+  return optimization_stats_;
+}
+
 void Model::RemoveNode(std::shared_ptr<Node> node) {
   mutex_lock l(mu_);
   if (node) {
@@ -1524,7 +1637,8 @@ bool Model::ShouldStop(
 }
 
 void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
-                                    double model_input_time) {
+                                    double model_input_time,
+                                    bool enforce_budgets) {
   std::shared_ptr<Node> snapshot;
   {
     tf_shared_lock lock(mu_);
@@ -1585,11 +1699,16 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
   for (auto& pair : parameters) {
     pair.second->value = std::round(pair.second->value);
   }
+  if (enforce_budgets) {
+    EnforceBudgets(cpu_budget, ram_budget, model_input_time, parameters,
+                   snapshot);
+  }
+  RecordOptimizationStats(model_input_time, parameters, snapshot);
   UpdateStateValues(&parameters);
 }
 
 void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
-                              double model_input_time) {
+                              double model_input_time, bool enforce_budgets) {
   std::shared_ptr<Node> snapshot;
   {
     tf_shared_lock lock(mu_);
@@ -1652,9 +1771,75 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
     }
     best_parameter->value++;
   }
+  if (enforce_budgets) {
+    EnforceBudgets(cpu_budget, ram_budget, model_input_time, parameters,
+                   snapshot);
+  }
+  RecordOptimizationStats(model_input_time, parameters, snapshot);
   UpdateStateValues(&parameters);
 }
 
+void Model::EnforceBudgets(
+    int64 cpu_budget, int64 ram_budget, double model_input_time,
+    const absl::flat_hash_map<string, std::shared_ptr<Parameter>>& parameters,
+    std::shared_ptr<Node> snapshot) {
+  while (true) {
+    const int64 parallelism = TotalParallelism(parameters);
+    const double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+    const bool over_cpu_budget = parallelism > cpu_budget;
+    const bool over_ram_budget = buffered_bytes > ram_budget;
+    if (!over_cpu_budget && !over_ram_budget) {
+      return;
+    }
+    double best_output_time = std::numeric_limits<double>::infinity();
+    Parameter* best_parameter = nullptr;
+    for (auto& pair : parameters) {
+      Parameter* parameter = pair.second.get();
+      if (parameter->value - 1 < parameter->min) {
+        continue;
+      }
+      parameter->value--;
+      // Only consider decreases that bring an exceeded budget closer.
+      const bool helps =
+          (over_cpu_budget && parameter->name == kParallelism) ||
+          (over_ram_budget && TotalMaximumBufferedBytes(snapshot) <
+                                  buffered_bytes);
+      if (helps) {
+        const double output_time =
+            OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+        if (best_parameter == nullptr || output_time < best_output_time) {
+          best_output_time = output_time;
+          best_parameter = parameter;
+        }
+      }
+      parameter->value++;
+    }
+    if (!best_parameter) {
+      VLOG(2) << "Failed to bring the tunable parameters within the CPU budget "
+              << cpu_budget << " and RAM budget " << ram_budget
+              << "B; their minimum values exceed it.";
+      return;
+    }
+    best_parameter->value--;
+  }
+}
+
+void Model::RecordOptimizationStats(
+    double model_input_time,
+    const absl::flat_hash_map<string, std::shared_ptr<Parameter>>& parameters,
+    std::shared_ptr<Node> snapshot) {
+  OptimizationStats stats;
+  stats.output_time =
+      OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+  stats.parallelism = TotalParallelism(parameters);
+  stats.maximum_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  VLOG(2) << "Projected output time " << stats.output_time
+          << "ns with total parallelism " << stats.parallelism << " and "
+          << stats.maximum_buffered_bytes << "B of buffers.";
+  mutex_lock l(stats_mu_);
+  optimization_stats_ = stats;
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          absl::flat_hash_map<string, double>* gradients) {
   // To store the input time for each node.
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 #define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 
+#include <algorithm>
 #include <list>
 #include <memory>
 #include <string>
@@ -153,6 +154,7 @@ class Node {
         bytes_produced_(0),
         num_elements_(0),
         processing_time_(0),
+        wait_time_(0),
         record_metrics_(true),
         metrics_(name_),
         output_(args.output.get()) {}
@@ -262,6 +264,10 @@ class Node {
     return processing_time_;
   }
 
+  // Returns the aggregate time that consumers of the node waited for it to
+  // produce an element.
+  int64 wait_time() const TF_LOCKS_EXCLUDED(mu_) { return wait_time_; }
+
   // Records that the node consumed the given number of bytes.
   void record_bytes_consumed(int64 num_bytes) { bytes_consumed_ += num_bytes; }
 
@@ -300,6 +306,21 @@ class Node {
   // currently between a `record_start` and a `record_stop`.
   bool is_recording() TF_LOCKS_EXCLUDED(mu_) { return work_start_ > 0; }
 
+  // Records that a consumer of the node started waiting for the node to
+  // produce an element.
+  void record_wait_start(int64 time_nanos) TF_LOCKS_EXCLUDED(mu_) {
+    wait_start_ = time_nanos;
+  }
+
+  // Records that a consumer of the node stopped waiting for the node to
+  // produce an element.
+  void record_wait_stop(int64 time_nanos) TF_LOCKS_EXCLUDED(mu_) {
+    if (wait_start_ != 0) {
+      wait_time_ += time_nanos - wait_start_;
+      wait_start_ = 0;
+    }
+  }
+
   // Removes an input.
   void remove_input(std::shared_ptr<Node> input) TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
@@ -344,6 +365,17 @@ class Node {
   // Flushes the metrics recorded by this node.
   void FlushMetrics() TF_LOCKS_EXCLUDED(mu_);
 
+  // Adds the values of the tunable parameters of this node that have been
+  // tuned to `values`, keyed by "<long name>:<parameter name>".
+  void CollectTunableParameterValues(
+      absl::flat_hash_map<string, double>* values) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the tunable parameters of this node that have a value in `values`,
+  // keyed as by `CollectTunableParameterValues()`.
+  void SetTunableParameterValues(
+      const absl::flat_hash_map<string, double>& values)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the per-element output time for this node and if `gradients` is not
   // `nullptr`, collects the output time gradient w.r.t. tunable parameters of
   // the subtree rooted in this node.
@@ -385,9 +417,16 @@ class Node {
         : bytes_consumed_counter_(metrics::GetTFDataBytesConsumedCounter(name)),
           bytes_produced_counter_(metrics::GetTFDataBytesProducedCounter(name)),
           num_elements_counter_(metrics::GetTFDataElementsCounter(name)),
+          processing_time_counter_(
+              metrics::GetTFDataProcessingTimeCounter(name)),
+          wait_time_counter_(metrics::GetTFDataWaitTimeCounter(name)),
+          name_(name),
           recorded_bytes_consumed_(0),
           recorded_bytes_produced_(0),
-          recorded_num_elements_(0) {}
+          recorded_num_elements_(0),
+          recorded_processing_time_(0),
+          recorded_wait_time_(0),
+          recorded_time_(EnvTime::NowNanos()) {}
 
     // Expects the total number of bytes consumed and records the delta since
     // last invocation.
@@ -413,13 +452,45 @@ class Node {
       num_elements_counter_->IncrementBy(delta);
     }
 
+    // Expects the total processing time (in nanoseconds) and records the delta
+    // since last invocation.
+    void record_processing_time(int64 total_nanos) {
+      int64 delta =
+          total_nanos - recorded_processing_time_.exchange(total_nanos);
+      processing_time_counter_->IncrementBy(delta / EnvTime::kMicrosToNanos);
+    }
+
+    // Expects the total time (in nanoseconds) that consumers waited for the
+    // node and records the delta since last invocation, as well as the
+    // fraction of the time since last invocation that they spent waiting.
+    void record_wait_time(int64 total_nanos, int64 now_nanos) {
+      int64 delta = total_nanos - recorded_wait_time_.exchange(total_nanos);
+      int64 elapsed = now_nanos - recorded_time_.exchange(now_nanos);
+      wait_time_counter_->IncrementBy(delta / EnvTime::kMicrosToNanos);
+      if (elapsed > 0) {
+        metrics::RecordTFDataWaitFraction(
+            name_, std::min(1.0, static_cast<double>(delta) / elapsed));
+      }
+    }
+
+    // Records the fraction of the buffer of the node that is full.
+    void record_buffer_utilization(double utilization) {
+      metrics::RecordTFDataBufferUtilization(name_, utilization);
+    }
+
    private:
     monitoring::CounterCell* const bytes_consumed_counter_;
     monitoring::CounterCell* const bytes_produced_counter_;
     monitoring::CounterCell* const num_elements_counter_;
+    monitoring::CounterCell* const processing_time_counter_;
+    monitoring::CounterCell* const wait_time_counter_;
+    const string name_;
     std::atomic<int64> recorded_bytes_consumed_;
     std::atomic<int64> recorded_bytes_produced_;
     std::atomic<int64> recorded_num_elements_;
+    std::atomic<int64> recorded_processing_time_;
+    std::atomic<int64> recorded_wait_time_;
+    std::atomic<int64> recorded_time_;
   };
 
   // Returns the number of inputs.
@@ -544,6 +615,10 @@ class Node {
   // to `Node::record_start()` (for any node).
   static thread_local int64 work_start_;  // Will be initialized to zero.
 
+  // Stores the time passed to the last call to `Node::record_wait_start()` on
+  // the current thread. A consumer waits for at most one `Node` at a time.
+  static thread_local int64 wait_start_;  // Will be initialized to zero.
+
   mutable mutex mu_;
   const int64 id_;
   const string name_;
@@ -558,6 +633,7 @@ class Node {
   std::atomic<int64> bytes_produced_;
   std::atomic<int64> num_elements_;
   std::atomic<int64> processing_time_;
+  std::atomic<int64> wait_time_;
   std::atomic<bool> record_metrics_;
   Metrics metrics_;
   absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters_
@@ -635,9 +711,43 @@ class Model {
   // Flushes metrics record by the model.
   void FlushMetrics() TF_LOCKS_EXCLUDED(mu_);
 
+  // The outcome of an autotuning optimization.
+  struct OptimizationStats {
+    // The projected time to produce an element, in nanoseconds.
+    double output_time = 0;
+    // The sum of the tuned parallelism values.
+    int64 parallelism = 0;
+    // The memory taken by the buffers of the tuned nodes when they are full,
+    // in bytes.
+    double maximum_buffered_bytes = 0;
+  };
+
   // Uses the given algorithm to perform the autotuning optimization.
+  //
+  // The algorithms stop increasing parameters once the CPU or RAM budget is
+  // reached, but may overshoot it by a step. If `enforce_budgets` is set, the
+  // tuned parameters are then lowered until the sum of the parallelism values
+  // is within `cpu_budget` and the full buffers fit in `ram_budget`, giving up
+  // as little of the projected throughput as possible.
   void Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget,
-                double model_input_time) TF_LOCKS_EXCLUDED(mu_);
+                double model_input_time, bool enforce_budgets = false)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the outcome of the latest optimization.
+  OptimizationStats optimization_stats() TF_LOCKS_EXCLUDED(stats_mu_);
+
+  // Returns the values of the tunable parameters of the model that have been
+  // tuned, keyed by "<node long name>:<parameter name>".
+  absl::flat_hash_map<string, double> TunableParameterValues()
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the tunable parameters of the nodes of the model, including the nodes
+  // added later on, to their value in `values`, as returned by
+  // `TunableParameterValues()`. This lets an input pipeline start out with
+  // the values tuned by an earlier run of the same pipeline, whose nodes have
+  // the same long names.
+  void SetTunableParameterValues(absl::flat_hash_map<string, double> values)
+      TF_LOCKS_EXCLUDED(mu_);
 
   // Removes the given node.
   void RemoveNode(std::shared_ptr<Node> node) TF_LOCKS_EXCLUDED(mu_);
@@ -667,7 +777,7 @@ class Model {
   // the projected output time is less than or equal to the processing time
   // needed to produce an element divided by CPU budget.
   void OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
-                         double model_input_time);
+                         double model_input_time, bool enforce_budgets);
 
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then improves current parameters by
@@ -677,7 +787,21 @@ class Model {
   // value or the output time is less than the processing time needed to produce
   // an element divided by CPU budget.
   void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
-                               double model_input_time);
+                               double model_input_time, bool enforce_budgets);
+
+  // Repeatedly decrements the tuned parameter whose decrease raises the output
+  // time the least, until the sum of the parallelism values is within
+  // `cpu_budget` and the maximum buffered bytes are within `ram_budget`.
+  void EnforceBudgets(
+      int64 cpu_budget, int64 ram_budget, double model_input_time,
+      const absl::flat_hash_map<string, std::shared_ptr<Parameter>>& parameters,
+      std::shared_ptr<Node> snapshot);
+
+  // Records the outcome of an optimization of the given parameters.
+  void RecordOptimizationStats(
+      double model_input_time,
+      const absl::flat_hash_map<string, std::shared_ptr<Parameter>>& parameters,
+      std::shared_ptr<Node> snapshot) TF_LOCKS_EXCLUDED(stats_mu_);
 
   // Collects the output time and if `gradients` is not `nullptr`, the output
   // time gradient w.r.t. tunable parameters of the subtree rooted in the given
@@ -704,6 +828,9 @@ class Model {
   mutex mu_;
   int64 id_counter_ TF_GUARDED_BY(mu_) = 1;
   std::shared_ptr<Node> output_ TF_GUARDED_BY(mu_);
+  // The parameter values that nodes take on when they are added.
+  absl::flat_hash_map<string, double> initial_parameter_values_
+      TF_GUARDED_BY(mu_);
 
   // Indicates whether the modeling framework should collect resource usage
   // (e.g. CPU, memory). The logic for collecting this information assumes that
@@ -712,6 +839,9 @@ class Model {
   // tunable parameter (because the information is used for tuning the value of
   // the parameter) and never stops.
   std::atomic<bool> collect_resource_usage_;
+
+  mutex stats_mu_;
+  OptimizationStats optimization_stats_ TF_GUARDED_BY(stats_mu_);
 };
 
 }  // namespace model
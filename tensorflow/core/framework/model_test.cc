@@ -1034,6 +1034,93 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1));
 
+class OptimizeEnforceBudgetsTest
+    : public ::testing::TestWithParam<model::AutotuneAlgorithm> {};
+
+TEST_P(OptimizeEnforceBudgetsTest, Model) {
+  const model::AutotuneAlgorithm algorithm = GetParam();
+
+  std::shared_ptr<mutex> mutex1 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv1 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex1, cv1),
+                            /*min=*/1, /*max=*/8)});
+  node1->record_buffer_event(100, 1);
+  node1->record_element();
+  node1->add_processing_time(1000);
+
+  std::shared_ptr<mutex> mutex2 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv2 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node2 = model::MakeAsyncKnownRatioNode(
+      {2, "2", node1}, 1,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex2, cv2),
+                            /*min=*/1, /*max=*/8)});
+  node2->record_buffer_event(100, 1);
+  node2->record_element();
+  node2->add_processing_time(4000);
+
+  model::Model model;
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+
+  model.Optimize(algorithm, /*cpu_budget=*/3, /*ram_budget=*/1000000,
+                 /*model_input_time=*/0, /*enforce_budgets=*/true);
+  const double parallelism = node1->parameter_value("parallelism") +
+                             node2->parameter_value("parallelism");
+  EXPECT_LE(parallelism, 3);
+  EXPECT_EQ(parallelism, model.optimization_stats().parallelism);
+
+  model.Optimize(algorithm, /*cpu_budget=*/16, /*ram_budget=*/300,
+                 /*model_input_time=*/0, /*enforce_budgets=*/true);
+  EXPECT_LE(model.optimization_stats().maximum_buffered_bytes, 300);
+  EXPECT_GE(node1->parameter_value("parallelism"), 1);
+  EXPECT_GE(node2->parameter_value("parallelism"), 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, OptimizeEnforceBudgetsTest,
+                         ::testing::Values(0, 1));
+
+TEST(TunableParameterValuesTest, RestoredByNodesWithSameNames) {
+  auto make_node = [](model::Node::Args args) {
+    auto state = std::make_shared<SharedState>(
+        /*value=*/model::kAutotune, std::make_shared<mutex>(),
+        std::make_shared<condition_variable>());
+    return model::MakeAsyncKnownRatioNode(
+        std::move(args), 1,
+        {model::MakeParameter("parallelism", state, /*min=*/1, /*max=*/16)});
+  };
+
+  model::Model model;
+  std::shared_ptr<Node> node;
+  model.AddNode(make_node, "ParallelMap", nullptr, &node);
+  // Parameters that were not tuned yet are left out.
+  EXPECT_TRUE(model.TunableParameterValues().empty());
+  node->SetTunableParameterValues({{node->long_name() + ":parallelism", 6}});
+  const auto values = model.TunableParameterValues();
+  ASSERT_EQ(1, values.size());
+  EXPECT_EQ(6, values.at(node->long_name() + ":parallelism"));
+
+  model::Model restored_model;
+  restored_model.SetTunableParameterValues(values);
+  std::shared_ptr<Node> restored_node;
+  restored_model.AddNode(make_node, "ParallelMap", nullptr, &restored_node);
+  EXPECT_EQ(6, restored_node->parameter_value("parallelism"));
+
+  // Values are clamped to the range of the parameter.
+  restored_model.SetTunableParameterValues(
+      {{restored_node->long_name() + ":parallelism", 100}});
+  EXPECT_EQ(16, restored_node->parameter_value("parallelism"));
+}
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -1043,6 +1130,28 @@ TEST(RecordTimeTest, RecordTimeTest) {
   EXPECT_FALSE(source->is_recording());
 }
 
+TEST(RecordTimeTest, RecordWaitTime) {
+  std::shared_ptr<Node> prefetch = model::MakeAsyncKnownRatioNode(
+      {0, "prefetch", nullptr}, 1,
+      {model::MakeParameter(
+          "buffer_size",
+          std::make_shared<SharedState>(/*value=*/4, nullptr, nullptr),
+          /*min=*/1, /*max=*/8)});
+  prefetch->record_start(100);
+  prefetch->record_stop(200);
+  prefetch->record_wait_start(200);
+  prefetch->record_wait_stop(500);
+  prefetch->record_start(500);
+  prefetch->record_stop(550);
+  EXPECT_EQ(150, prefetch->processing_time());
+  EXPECT_EQ(300, prefetch->wait_time());
+  // A wait stop without a matching start is ignored.
+  prefetch->record_wait_stop(600);
+  EXPECT_EQ(300, prefetch->wait_time());
+  prefetch->record_buffer_event(/*bytes_delta=*/10, /*elements_delta=*/2);
+  prefetch->FlushMetrics();
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
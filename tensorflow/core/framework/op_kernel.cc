@@ -321,6 +321,7 @@ Status OpKernelConstruction::allocate_persistent(
 
 const int OpKernelContext::Params::kNeverForward;
 const int OpKernelContext::Params::kNoReservation;
+const int32 OpKernelContext::Params::kStaticMemoryScopeIdBase;
 
 OpKernelContext::OpKernelContext(Params* params)
     : OpKernelContext(
@@ -363,7 +364,13 @@ OpKernelContext::~OpKernelContext() {
 Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   Allocator* allocator = nullptr;
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
-    allocator = params_->device->GetScopedAllocator(attr, step_id());
+    if (attr.scope_id >= Params::kStaticMemoryScopeIdBase &&
+        params_->static_memory_allocators != nullptr) {
+      allocator = params_->static_memory_allocators
+          [attr.scope_id - Params::kStaticMemoryScopeIdBase];
+    } else {
+      allocator = params_->device->GetScopedAllocator(attr, step_id());
+    }
     CHECK(allocator);
   } else {
     allocator = params_->device->GetAllocator(attr);
@@ -706,6 +713,16 @@ Status OpKernelContext::allocate_output(StringPiece name,
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
+  // Small tensors in host memory skip the allocator, which would cost a second
+  // heap allocation and often a lock, unless the allocations are observed.
+  if (Tensor::CanMakeInlineHostTensor(type, shape) && attr.scope_id == 0 &&
+      !attr.gpu_compatible() && allocation_attr.freed_by_func == nullptr &&
+      !params_->log_memory && !track_allocations() &&
+      (attr.on_host() ||
+       params_->device->attributes().device_type() == DEVICE_CPU)) {
+    *out_tensor = Tensor::MakeInlineHostTensor(type, shape);
+    return Status::OK();
+  }
   Allocator* a = get_allocator(attr);
   Tensor new_tensor(
       a, type, shape,
@@ -676,6 +676,13 @@ class OpKernelContext {
     // Device context.
     DeviceContext* op_device_context = nullptr;
 
+    // The device contexts with which the producers of the inputs of this node
+    // ran, indexed by input number and followed by those of the sources of its
+    // control edges, with nullptr for the default context.  Only set when the
+    // device assigned contexts to nodes in Device::FillContextMap().
+    const gtl::InlinedVector<DeviceContext*, 4>* input_device_contexts =
+        nullptr;
+
     // Control-flow op supports.
     FrameAndIter frame_iter;
 
@@ -697,6 +704,13 @@ class OpKernelContext {
     // Values in [0,...) represent reservations for the indexed output.
     const int* forward_from_array = nullptr;
 
+    // Allocators serving the outputs that the executor planned into a static
+    // memory arena (see common_runtime/static_memory_plan.h), indexed by
+    // `AllocatorAttributes::scope_id - kStaticMemoryScopeIdBase`. Smaller
+    // scope ids belong to the device's ScopedAllocatorMgr.
+    static constexpr int32 kStaticMemoryScopeIdBase = 1 << 30;
+    Allocator* const* static_memory_allocators = nullptr;
+
     // For tracking actively running deferred ops.
     std::function<void()> inc_num_deferred_ops_function;
     std::function<void()> dec_num_deferred_ops_function;
@@ -1065,6 +1079,14 @@ class OpKernelContext {
     return ret;
   }
 
+  // Returns the DeviceContexts with which the nodes this op depends on ran:
+  // the producers of its inputs, indexed by input number, followed by the
+  // sources of its control edges.  Returns nullptr if the device did not
+  // assign contexts to nodes.
+  const gtl::InlinedVector<DeviceContext*, 4>* input_device_contexts() const {
+    return params_->input_device_contexts;
+  }
+
   AllocatorAttributes input_alloc_attr(int index) const {
     if (params_->input_alloc_attrs == nullptr) {
       return AllocatorAttributes();
@@ -70,11 +70,15 @@ class RendezvousInterface {
     ParsedKey& operator=(const ParsedKey& b);
     StringPiece FullKey() const { return buf_; }
 
+    // Returns a hash of FullKey(), computed once by ParseKey().
+    uint64 Hash() const { return hash_; }
+
    private:
     friend class Rendezvous;
     friend class SendOp;
     friend class RecvOp;
     std::string buf_;
+    uint64 hash_ = 0;
   };
 
   // The caller is a tensor producer and it sends a message (a tensor
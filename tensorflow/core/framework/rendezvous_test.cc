@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <atomic>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -55,6 +58,9 @@ TEST(RendezvousTest, Key) {
   EXPECT_EQ(parsed.src.type, "CPU");
   EXPECT_EQ(parsed.dst_device, "/job:mnist/replica:1/task:2/device:GPU:0");
   EXPECT_EQ(parsed.dst.type, "GPU");
+  EXPECT_EQ(parsed.Hash(), Hash64(key));
+  Rendezvous::ParsedKey copy(parsed);
+  EXPECT_EQ(copy.Hash(), parsed.Hash());
 
   EXPECT_FALSE(Rendezvous::ParseKey("foo;bar;baz", &parsed).ok());
   EXPECT_FALSE(Rendezvous::ParseKey("/job:mnist/replica:1/task:2/CPU:0;"
@@ -394,6 +400,22 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
       errors::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+TEST_F(LocalRendezvousTest, AbortWithPendingRecvs) {
+  // The keys are spread over all the shards of the rendezvous.
+  static const int N = 100;
+  std::atomic<int> num_aborted(0);
+  for (int i = 0; i < N; ++i) {
+    rendez_->RecvAsync(
+        MakeKey(strings::StrCat(i)), Rendezvous::Args(),
+        [&num_aborted](const Status& status, const Rendezvous::Args&,
+                       const Rendezvous::Args&, const Tensor&, const bool) {
+          if (errors::IsAborted(status)) ++num_aborted;
+        });
+  }
+  rendez_->StartAbort(errors::Aborted(""));
+  EXPECT_EQ(N, num_aborted);
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
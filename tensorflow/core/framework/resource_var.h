@@ -35,7 +35,11 @@ namespace tensorflow {
 // outstanding aliases. Sparse operations are not supported in copy-on-write
 // mode.
 //
-// When a variable is accessed sparsely it switches to copy-on-read mode. To
+// Sparse reads (gathers) hold the shared lock for as long as they read the
+// buffer and never alias it, so they can run in either mode and leave the
+// variable in copy-on-write mode, where dense reads don't copy.
+//
+// When a variable is written sparsely it switches to copy-on-read mode. To
 // switch we need to grab an exclusive lock and might (if there are aliases)
 // need to copy the entire tensor. Once copy-on-read mode is enabled, no tensor
 // is allowed to alias the variable's internal tensor. This means dense reads
@@ -81,7 +85,7 @@ class Var : public ResourceBase {
                                 // like it.
 
   // Also fake-guarded by mu_. Should be set to True whenever any sparse
-  // operation uses the variable. Once this is true no tensor is allowed to
+  // write uses the variable. Once this is true no tensor is allowed to
   // alias the memory of the variable, and we always copy the variable on
   // reads. This allows sparse operations to happen with only a shared lock if
   // so desired.
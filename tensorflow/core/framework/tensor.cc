@@ -50,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -140,6 +141,49 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Ref-counted buffer of a few bytes, whose data is stored right after it in
+// the same host allocation.
+class InlineBuffer : public TensorBuffer {
+ public:
+  static InlineBuffer* New(size_t num_bytes) {
+    void* ptr = port::AlignedMalloc(DataOffset() + num_bytes,
+                                    EIGEN_MAX_ALIGN_BYTES);
+    return new (ptr) InlineBuffer(static_cast<char*>(ptr) + DataOffset(),
+                                  num_bytes);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("InlineTensorBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // Frees the whole allocation when `core::RefCounted::Unref()` deletes the
+  // buffer.
+  static void operator delete(void* ptr) { port::AlignedFree(ptr); }
+  static void operator delete(void*, void*) {}
+
+ private:
+  InlineBuffer(void* data, size_t size) : TensorBuffer(data), size_(size) {}
+  ~InlineBuffer() override {}
+
+  // Offset of the data from the start of the allocation, which keeps the data
+  // aligned like the buffers of the allocators.
+  static constexpr size_t DataOffset() {
+    return (sizeof(InlineBuffer) + EIGEN_MAX_ALIGN_BYTES - 1) /
+           EIGEN_MAX_ALIGN_BYTES * EIGEN_MAX_ALIGN_BYTES;
+  }
+
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -800,6 +844,24 @@ static Allocator* get_default_cpu_allocator() {
 Tensor::Tensor(DataType type, const TensorShape& shape)
     : Tensor(get_default_cpu_allocator(), type, shape) {}
 
+constexpr int64 Tensor::kMaxInlineBytes;
+
+/* static */
+bool Tensor::CanMakeInlineHostTensor(DataType type, const TensorShape& shape) {
+  return DataTypeCanUseMemcpy(type) && shape.num_elements() > 0 &&
+         shape.num_elements() * DataTypeSize(type) <= kMaxInlineBytes;
+}
+
+/* static */
+Tensor Tensor::MakeInlineHostTensor(DataType type, const TensorShape& shape) {
+  DCHECK(CanMakeInlineHostTensor(type, shape));
+  TensorBuffer* buf =
+      InlineBuffer::New(shape.num_elements() * DataTypeSize(type));
+  Tensor t(type, shape, buf);
+  buf->Unref();
+  return t;
+}
+
 bool Tensor::HostScalarTensorBufferBase::GetAllocatedBytes(
     size_t* out_bytes) const {
   // `this->FillAllocationDescription()` never sets allocated bytes information,
@@ -164,6 +164,24 @@ class Tensor {
   /// for details.
   explicit Tensor(DataType type);
 
+  /// Maximum size in bytes of the tensors created by MakeInlineHostTensor().
+  static constexpr int64 kMaxInlineBytes = 64;
+
+  /// \brief Returns true iff a tensor of the given `type` and `shape` can be
+  /// created by MakeInlineHostTensor(): it has at least one element, at most
+  /// `kMaxInlineBytes` bytes, and a type that can be copied with memcpy.
+  static bool CanMakeInlineHostTensor(DataType type, const TensorShape& shape);
+
+  /// \brief Creates an uninitialized tensor of the given `type` and `shape`,
+  /// whose data is stored in host memory in the same heap allocation as its
+  /// buffer rather than obtained from an `Allocator`.
+  ///
+  /// This saves an allocator round trip for the scalars and small shape
+  /// vectors that control-flow heavy graphs create at high rates. The data is
+  /// not accounted to any allocator. Requires
+  /// `CanMakeInlineHostTensor(type, shape)`.
+  static Tensor MakeInlineHostTensor(DataType type, const TensorShape& shape);
+
  private:
   // A tag type for selecting the `Tensor` constructor overload that creates a
   // scalar tensor in host memory.
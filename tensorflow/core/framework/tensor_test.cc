@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
@@ -902,6 +903,57 @@ TEST(Tensor_HostScalar, Basics) {
   }
 }
 
+TEST(Tensor_InlineHost, CanMake) {
+  EXPECT_TRUE(Tensor::CanMakeInlineHostTensor(DT_INT32, TensorShape({})));
+  EXPECT_TRUE(Tensor::CanMakeInlineHostTensor(DT_FLOAT, TensorShape({16})));
+  EXPECT_FALSE(Tensor::CanMakeInlineHostTensor(DT_FLOAT, TensorShape({17})));
+  EXPECT_FALSE(Tensor::CanMakeInlineHostTensor(DT_FLOAT, TensorShape({0})));
+  EXPECT_FALSE(Tensor::CanMakeInlineHostTensor(DT_STRING, TensorShape({})));
+  EXPECT_FALSE(Tensor::CanMakeInlineHostTensor(DT_RESOURCE, TensorShape({})));
+  EXPECT_FALSE(Tensor::CanMakeInlineHostTensor(DT_VARIANT, TensorShape({})));
+}
+
+TEST(Tensor_InlineHost, Basics) {
+  Tensor t = Tensor::MakeInlineHostTensor(DT_INT64, TensorShape({2, 3}));
+  EXPECT_EQ(DT_INT64, t.dtype());
+  EXPECT_EQ(6, t.NumElements());
+  EXPECT_EQ(6 * sizeof(int64), t.TotalBytes());
+  EXPECT_TRUE(t.IsInitialized());
+  EXPECT_TRUE(t.IsAligned());
+  auto m = t.matrix<int64>();
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      m(i, j) = i * 3 + j;
+    }
+  }
+  test::ExpectTensorEqual<int64>(
+      t, test::AsTensor<int64>({0, 1, 2, 3, 4, 5}, TensorShape({2, 3})));
+
+  TensorDescription description;
+  t.FillDescription(&description);
+  EXPECT_EQ("InlineTensorBuffer",
+            description.allocation_description().allocator_name());
+  EXPECT_EQ(6 * sizeof(int64),
+            description.allocation_description().requested_bytes());
+
+  // Slices and copies share the buffer, and keep it alive.
+  Tensor slice = t.Slice(1, 2);
+  Tensor copy = t;
+  t = Tensor();
+  EXPECT_TRUE(slice.SharesBufferWith(copy));
+  test::ExpectTensorEqual<int64>(
+      slice, test::AsTensor<int64>({3, 4, 5}, TensorShape({1, 3})));
+  copy = Tensor();
+  test::ExpectTensorEqual<int64>(
+      slice, test::AsTensor<int64>({3, 4, 5}, TensorShape({1, 3})));
+
+  TensorProto proto;
+  slice.AsProtoTensorContent(&proto);
+  Tensor parsed;
+  ASSERT_TRUE(parsed.FromProto(proto));
+  test::ExpectTensorEqual<int64>(slice, parsed);
+}
+
 TEST(Tensor_Float, Reshape_And_Slice_Assignment) {
   // A test to experiment with a way to assign to a subset of a tensor
   Tensor t(DT_FLOAT, TensorShape({10, 4, 3, 2}));
@@ -1552,6 +1604,17 @@ void BM_CreateAndDestroyHostScalarOptimized(
 }
 BENCHMARK(BM_CreateAndDestroyHostScalarOptimized);
 
+// Benchmark creating and destroy a small host tensor stored inline with its
+// buffer.
+void BM_CreateAndDestroyInlineHostTensor(::testing::benchmark::State& state) {
+  TensorShape shape({4});
+  for (auto s : state) {
+    Tensor a = Tensor::MakeInlineHostTensor(DT_INT32, shape);
+    a.vec<int32>()(0) = 37;
+  }
+}
+BENCHMARK(BM_CreateAndDestroyInlineHostTensor);
+
 void BM_FromProto(::testing::benchmark::State& state) {
   const int size = state.range(0);
 
@@ -16,8 +16,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 
 #include <cmath>
+#include <limits>
 #include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/type_traits.h"
@@ -30,6 +33,49 @@ limitations under the License.
 namespace tensorflow {
 namespace tensor {
 
+namespace {
+
+// Buffer of a string tensor whose elements are followed by the characters
+// they refer to.
+class StringArenaBuffer : public TensorBuffer {
+ public:
+  StringArenaBuffer(Allocator* allocator, void* data, int64 num_elements)
+      : TensorBuffer(data),
+        allocator_(allocator),
+        num_elements_(num_elements) {
+    tstring* strings = base<tstring>();
+    for (int64 i = 0; i < num_elements_; ++i) {
+      new (strings + i) tstring();
+    }
+  }
+
+  size_t size() const override { return sizeof(tstring) * num_elements_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name(allocator_->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+ private:
+  ~StringArenaBuffer() override {
+    tstring* strings = base<tstring>();
+    for (int64 i = 0; i < num_elements_; ++i) {
+      strings[i].~tstring();
+    }
+    allocator_->DeallocateRaw(data());
+  }
+
+  Allocator* const allocator_;
+  const int64 num_elements_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StringArenaBuffer);
+};
+
+}  // namespace
+
 Tensor DeepCopy(const Tensor& other) {
   Tensor tmp = Tensor(other.dtype(), other.shape());
   DeepCopy(other, &tmp);
@@ -386,5 +432,25 @@ Status MakeShape(const Tensor& shape, TensorShape* out) {
   }
 }
 
+bool AllocateStringTensorWithArena(Allocator* allocator,
+                                   const TensorShape& shape, int64 arena_bytes,
+                                   Tensor* tensor, char** arena) {
+  const int64 strings_bytes = sizeof(tstring) * shape.num_elements();
+  const int64 total_bytes = strings_bytes + arena_bytes;
+  // Offset strings refer to their characters with 32-bit offsets.
+  if (arena_bytes < 0 || total_bytes > std::numeric_limits<uint32>::max()) {
+    return false;
+  }
+  void* data = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                      std::max<int64>(total_bytes, 1));
+  if (data == nullptr) return false;
+  StringArenaBuffer* buffer =
+      new StringArenaBuffer(allocator, data, shape.num_elements());
+  *tensor = Tensor(DT_STRING, shape, buffer);
+  buffer->Unref();
+  *arena = static_cast<char*>(data) + strings_bytes;
+  return true;
+}
+
 }  // namespace tensor
 }  // namespace tensorflow
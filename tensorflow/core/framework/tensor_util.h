@@ -65,6 +65,23 @@ Status Concat(const gtl::ArraySlice<Tensor>& tensors,
 Status Split(const Tensor& tensor, const gtl::ArraySlice<int64>& sizes,
              std::vector<Tensor>* result) TF_MUST_USE_RESULT;
 
+// Allocates in '*tensor' a DT_STRING tensor of 'shape' whose buffer also holds
+// 'arena_bytes' bytes for the characters of its elements, after the elements,
+// so that the strings of a whole batch take a single allocation. '*arena' is
+// set to the first of those bytes. The elements are initially empty; element
+// 'i' is set to 'len' characters written at 'chars' in the arena with
+// 'tensor->flat<tstring>()(i).assign_as_offset(chars, len)'. Null-terminating
+// the characters in the arena keeps 'c_str()' valid. Copies of the elements
+// are owned strings, so they don't refer to the arena.
+//
+// Returns false, leaving '*tensor' unchanged, if the buffer is too large for
+// offset strings or can't be allocated.
+//
+// REQUIRES: 'allocator' must allocate CPU memory.
+bool AllocateStringTensorWithArena(Allocator* allocator,
+                                   const TensorShape& shape, int64 arena_bytes,
+                                   Tensor* tensor, char** arena);
+
 namespace internal {
 void SetTensorProtoShape(std::vector<size_t> shape,
                          TensorShapeProto* shape_proto);
@@ -179,6 +179,37 @@ TEST(TensorUtil, DeepCopySliceString) {
   }
 }
 
+TEST(TensorUtil, StringTensorWithArena) {
+  const std::vector<string> values = {"hello", "",
+                                      "a string longer than a small tstring"};
+  int64 arena_bytes = 0;
+  for (const string& value : values) arena_bytes += value.size() + 1;
+  Tensor x;
+  char* arena = nullptr;
+  ASSERT_TRUE(tensor::AllocateStringTensorWithArena(
+      cpu_allocator(), TensorShape({3}), arena_bytes, &x, &arena));
+  auto x_flat = x.flat<tstring>();
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(x_flat(i).empty());
+    memcpy(arena, values[i].c_str(), values[i].size() + 1);
+    x_flat(i).assign_as_offset(arena, values[i].size());
+    arena += values[i].size() + 1;
+  }
+
+  // Slices share the arena, while deep copies own their strings.
+  Tensor y = x.Slice(1, 3);
+  Tensor z = tensor::DeepCopy(x);
+  x = Tensor();
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(values[i], z.flat<tstring>()(i));
+    EXPECT_NE(tstring::Type::OFFSET, z.flat<tstring>()(i).type());
+  }
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(values[i + 1], y.flat<tstring>()(i));
+    EXPECT_STREQ(values[i + 1].c_str(), y.flat<tstring>()(i).c_str());
+  }
+}
+
 TEST(TensorUtil, DeepCopySliceVariant) {
   Tensor x(DT_VARIANT, TensorShape({10}));
   x.flat<Variant>().setConstant(Tensor(42.0f));
@@ -0,0 +1,112 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Measures the peak arithmetic throughput, the memory bandwidth, the launch
+// latency and the host to device bandwidth of local devices, and writes them
+// to a device profile in text format. Grappler uses the measured properties
+// instead of the nominal ones when the TF_GRAPPLER_DEVICE_PROFILE environment
+// variable names the profile.
+//
+// Usage:
+//   calibrate_device --devices=/device:GPU:0,/device:CPU:0 \
+//     --output=/path/to/device_profile.pbtxt
+//
+// Devices of the same type and model that are already in the output profile
+// are replaced, and the other devices are kept.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/grappler/clusters/device_calibration.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+Status Calibrate(const std::vector<string>& devices,
+                 const DeviceCalibrationOptions& options,
+                 const string& output) {
+  DeviceProfile profile;
+  Env* env = Env::Default();
+  if (env->FileExists(output).ok()) {
+    TF_RETURN_IF_ERROR(ReadTextProto(env, output, &profile));
+  }
+  for (const string& device : devices) {
+    DeviceProperties measured;
+    TF_RETURN_IF_ERROR(CalibrateDevice(device, options, &measured));
+    LOG(INFO) << device << " (" << measured.model()
+              << "): peak_gflops=" << measured.peak_gflops()
+              << " bandwidth=" << measured.bandwidth()
+              << "KB/s launch_latency_us=" << measured.launch_latency_us()
+              << " host_bandwidth=" << measured.host_bandwidth() << "KB/s";
+
+    auto* profiled = profile.mutable_devices();
+    for (auto it = profiled->begin(); it != profiled->end();) {
+      if (it->type() == measured.type() && it->model() == measured.model()) {
+        it = profiled->erase(it);
+      } else {
+        ++it;
+      }
+    }
+    *profile.add_devices() = measured;
+  }
+  return WriteTextProto(env, output, profile);
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+int main(int argc, char** argv) {
+  tensorflow::string devices = "/device:GPU:0";
+  tensorflow::string output;
+  tensorflow::grappler::DeviceCalibrationOptions options;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("devices", &devices,
+                       "comma separated names of the devices to calibrate"),
+      tensorflow::Flag("output", &output, "path of the device profile"),
+      tensorflow::Flag("matmul_size", &options.matmul_size,
+                       "dimension of the multiplied square matrices"),
+      tensorflow::Flag("copy_bytes", &options.copy_bytes,
+                       "size of the tensors used to measure bandwidths"),
+      tensorflow::Flag("chain_length", &options.chain_length,
+                       "number of ops of the timed chains"),
+      tensorflow::Flag("num_runs", &options.num_runs,
+                       "number of runs of every measurement"),
+  };
+  const tensorflow::string usage =
+      tensorflow::Flags::Usage(argv[0], flag_list);
+  const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || output.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+
+  const tensorflow::Status status = tensorflow::grappler::Calibrate(
+      absl::StrSplit(devices, ',', absl::SkipEmpty()), options, output);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return -1;
+  }
+  return 0;
+}
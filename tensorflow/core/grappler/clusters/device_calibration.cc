@@ -0,0 +1,193 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/clusters/device_calibration.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+constexpr char kInputName[] = "input";
+constexpr char kOutputName[] = "output";
+
+Node* Const(const Tensor& value, const GraphDefBuilder::Options& opts) {
+  return ops::SourceOp("Const", opts.WithAttr("dtype", value.dtype())
+                                    .WithAttr("value", value));
+}
+
+// Returns in `seconds` the run time of a graph that applies `length` times
+// `op` (MatMul, or an elementwise op) to a float tensor of `shape` on
+// `device`. The input is filled on `device`, or fed from the host memory if
+// `feed_input` is true. The time is the fastest of `num_runs` runs.
+Status TimeChain(const string& device, const TensorShape& shape,
+                 const string& op, int length, bool feed_input, int num_runs,
+                 double* seconds) {
+  // Matrices filled with 1/n stay the same when they are squared.
+  const float fill_value = shape.dims() > 0 ? 1.0f / shape.dim_size(0) : 1.0f;
+  GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+  const GraphDefBuilder::Options opts = builder.opts().WithDevice(device);
+  Tensor input(DT_FLOAT, shape);
+  Node* x;
+  if (feed_input) {
+    input.flat<float>().setConstant(fill_value);
+    x = ops::SourceOp("Placeholder", builder.opts()
+                                         .WithName(kInputName)
+                                         .WithDevice("/device:CPU:0")
+                                         .WithAttr("dtype", DT_FLOAT));
+  } else {
+    Tensor dims(DT_INT32, TensorShape({shape.dims()}));
+    for (int i = 0; i < shape.dims(); ++i) {
+      dims.vec<int32>()(i) = shape.dim_size(i);
+    }
+    Tensor value(DT_FLOAT, TensorShape({}));
+    value.scalar<float>()() = fill_value;
+    x = ops::BinaryOp("Fill", Const(dims, opts), Const(value, opts), opts);
+  }
+  for (int i = 0; i < length; ++i) {
+    const GraphDefBuilder::Options op_opts =
+        i + 1 < length ? opts : opts.WithName(kOutputName);
+    x = op == "MatMul" ? ops::BinaryOp(op, x, x, op_opts)
+                       : ops::UnaryOp(op, x, op_opts);
+  }
+  GraphDef graph_def;
+  TF_RETURN_IF_ERROR(builder.ToGraphDef(&graph_def));
+
+  SessionOptions session_options;
+  GraphOptions* graph_options = session_options.config.mutable_graph_options();
+  // Constant folding would compute the chain once, when the graph is created.
+  graph_options->mutable_optimizer_options()->set_opt_level(
+      OptimizerOptions::L0);
+  graph_options->mutable_rewrite_options()->set_disable_meta_optimizer(true);
+  Session* raw_session;
+  TF_RETURN_IF_ERROR(NewSession(session_options, &raw_session));
+  std::unique_ptr<Session> session(raw_session);
+  TF_RETURN_IF_ERROR(session->Create(graph_def));
+
+  std::vector<std::pair<string, Tensor>> feeds;
+  if (feed_input) {
+    feeds.emplace_back(kInputName, input);
+  }
+  std::vector<Tensor> outputs;
+  *seconds = std::numeric_limits<double>::infinity();
+  // The first run also creates the kernels and allocates the memory, so it is
+  // not timed.
+  for (int i = 0; i <= num_runs; ++i) {
+    const uint64 start_us = Env::Default()->NowMicros();
+    TF_RETURN_IF_ERROR(session->Run(feeds, {}, {kOutputName}, &outputs));
+    const uint64 end_us = Env::Default()->NowMicros();
+    if (i > 0) {
+      *seconds = std::min(*seconds, (end_us - start_us) * 1e-6);
+    }
+  }
+  return session->Close();
+}
+
+// Returns in `seconds` the run time of one `op` on a tensor of `shape`.
+Status TimeOp(const string& device, const TensorShape& shape, const string& op,
+              const DeviceCalibrationOptions& options, double* seconds) {
+  double single_seconds;
+  TF_RETURN_IF_ERROR(TimeChain(device, shape, op, 1, /*feed_input=*/false,
+                               options.num_runs, &single_seconds));
+  double chain_seconds;
+  TF_RETURN_IF_ERROR(TimeChain(device, shape, op, 1 + options.chain_length,
+                               /*feed_input=*/false, options.num_runs,
+                               &chain_seconds));
+  if (chain_seconds <= single_seconds) {
+    return errors::Internal("The run time of ", op, " on ", device,
+                            " is too noisy to be measured");
+  }
+  *seconds = (chain_seconds - single_seconds) / options.chain_length;
+  return Status::OK();
+}
+
+}  // namespace
+
+Status CalibrateDevice(const string& device,
+                       const DeviceCalibrationOptions& options,
+                       DeviceProperties* properties) {
+  DeviceNameUtils::ParsedName parsed_name;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed_name) ||
+      !parsed_name.has_type) {
+    return errors::InvalidArgument("Invalid device name: ", device);
+  }
+
+  const int64 n = options.matmul_size;
+  double matmul_seconds;
+  TF_RETURN_IF_ERROR(
+      TimeOp(device, TensorShape({n, n}), "MatMul", options, &matmul_seconds));
+
+  const int64 num_elements = options.copy_bytes / sizeof(float);
+  const int64 num_bytes = num_elements * sizeof(float);
+  double neg_seconds;
+  TF_RETURN_IF_ERROR(TimeOp(device, TensorShape({num_elements}), "Neg",
+                            options, &neg_seconds));
+
+  double launch_seconds;
+  TF_RETURN_IF_ERROR(
+      TimeOp(device, TensorShape({}), "Neg", options, &launch_seconds));
+
+  // The devices were created by the sessions above, so that GPU ids can now be
+  // mapped to the GPUs of the platform.
+  *properties = GetDeviceInfo(parsed_name);
+  if (properties->type() == "UNKNOWN") {
+    return errors::InvalidArgument("Unknown device: ", device);
+  }
+  properties->set_peak_gflops(2.0 * n * n * n / matmul_seconds * 1e-9);
+  // Every Neg reads and writes the whole tensor.
+  properties->set_bandwidth(
+      static_cast<int64>(2.0 * num_bytes / neg_seconds * 1e-3));
+  properties->set_launch_latency_us(launch_seconds * 1e6);
+
+  if (properties->type() != "CPU") {
+    // The fed input is copied from the host before the first Neg runs. The
+    // time to fill the input on the device, which is small next to the copy,
+    // is not accounted for.
+    double fed_seconds;
+    TF_RETURN_IF_ERROR(TimeChain(device, TensorShape({num_elements}), "Neg", 1,
+                                 /*feed_input=*/true, options.num_runs,
+                                 &fed_seconds));
+    double filled_seconds;
+    TF_RETURN_IF_ERROR(TimeChain(device, TensorShape({num_elements}), "Neg", 1,
+                                 /*feed_input=*/false, options.num_runs,
+                                 &filled_seconds));
+    if (fed_seconds <= filled_seconds) {
+      return errors::Internal("The host to device copies of ", device,
+                              " are too noisy to be measured");
+    }
+    properties->set_host_bandwidth(
+        static_cast<int64>(num_bytes / (fed_seconds - filled_seconds) * 1e-3));
+  }
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,52 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_CLUSTERS_DEVICE_CALIBRATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_CLUSTERS_DEVICE_CALIBRATION_H_
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Sizes of the microbenchmarks run by CalibrateDevice.
+struct DeviceCalibrationOptions {
+  // Dimension of the square float matrices multiplied to measure the peak
+  // arithmetic throughput.
+  int64 matmul_size = 4096;
+  // Size of the float tensors used to measure the memory and host bandwidths.
+  int64 copy_bytes = 256 << 20;
+  // Number of ops of the chains whose run time is measured. The time of an op
+  // is the difference between the time of a chain and the time of a single
+  // op, which cancels the fixed cost of every run.
+  int chain_length = 16;
+  // Every measurement is the fastest of this many runs.
+  int num_runs = 5;
+};
+
+// Runs microbenchmarks on the local `device`, e.g. "/device:GPU:0", and
+// returns its properties, as detected by GetDeviceInfo, with peak_gflops,
+// bandwidth, launch_latency_us and host_bandwidth set to the measured values.
+// host_bandwidth is only measured for devices other than CPUs.
+Status CalibrateDevice(const string& device,
+                       const DeviceCalibrationOptions& options,
+                       DeviceProperties* properties);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_CLUSTERS_DEVICE_CALIBRATION_H_
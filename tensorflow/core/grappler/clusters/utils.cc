@@ -38,11 +38,35 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace grappler {
 
+namespace {
+
+// Returns the profile named by TF_GRAPPLER_DEVICE_PROFILE, which is read once.
+const DeviceProfile& DefaultDeviceProfile() {
+  static const DeviceProfile* profile = [] {
+    DeviceProfile* profile = new DeviceProfile;
+    string path;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_DEVICE_PROFILE", "", &path));
+    if (!path.empty()) {
+      Status s = ReadTextProto(Env::Default(), path, profile);
+      if (!s.ok()) {
+        LOG(ERROR) << "Failed to read the device profile " << path << ": " << s;
+        profile->Clear();
+      }
+    }
+    return profile;
+  }();
+  return *profile;
+}
+
+}  // namespace
+
 DeviceProperties GetLocalCPUInfo() {
   DeviceProperties device;
   device.set_type("CPU");
@@ -71,6 +95,7 @@ DeviceProperties GetLocalCPUInfo() {
   (*device.mutable_environment())["libxsmm"] = LIBXSMM_VERSION;
 #endif
 
+  ApplyDeviceProfile(DefaultDeviceProfile(), &device);
   return device;
 }
 
@@ -145,6 +170,7 @@ DeviceProperties GetLocalGPUInfo(PlatformGpuId platform_gpu_id) {
       strings::StrCat("gfx", properties.gcnArch);
 #endif
 
+  ApplyDeviceProfile(DefaultDeviceProfile(), &device);
   return device;
 }
 
@@ -171,5 +197,29 @@ DeviceProperties GetDeviceInfo(const DeviceNameUtils::ParsedName& device) {
   return unknown;
 }
 
+bool ApplyDeviceProfile(const DeviceProfile& profile,
+                        DeviceProperties* device) {
+  for (const DeviceProperties& measured : profile.devices()) {
+    if (measured.type() != device->type() ||
+        measured.model() != device->model()) {
+      continue;
+    }
+    if (measured.peak_gflops() > 0) {
+      device->set_peak_gflops(measured.peak_gflops());
+    }
+    if (measured.bandwidth() > 0) {
+      device->set_bandwidth(measured.bandwidth());
+    }
+    if (measured.launch_latency_us() > 0) {
+      device->set_launch_latency_us(measured.launch_latency_us());
+    }
+    if (measured.host_bandwidth() > 0) {
+      device->set_host_bandwidth(measured.host_bandwidth());
+    }
+    return true;
+  }
+  return false;
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -33,6 +33,16 @@ DeviceProperties GetLocalGPUInfo(PlatformGpuId platform_gpu_id);
 // Returns the DeviceProperties of the specified device
 DeviceProperties GetDeviceInfo(const DeviceNameUtils::ParsedName& device);
 
+// Overwrites the measured properties of `device` (peak_gflops, bandwidth,
+// launch_latency_us and host_bandwidth) with the ones set on the device of the
+// same type and model in `profile`. Returns false if `profile` has no such
+// device.
+//
+// GetLocalCPUInfo and GetLocalGPUInfo apply the profile stored in text format
+// at the path named by the TF_GRAPPLER_DEVICE_PROFILE environment variable, if
+// any.
+bool ApplyDeviceProfile(const DeviceProfile& profile, DeviceProperties* device);
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
@@ -116,6 +116,36 @@ TEST(UtilsTest, GetDeviceInfo) {
 #endif
 }
 
+TEST(UtilsTest, ApplyDeviceProfile) {
+  DeviceProfile profile;
+  DeviceProperties* measured = profile.add_devices();
+  measured->set_type("GPU");
+  measured->set_model("gfx908");
+  measured->set_peak_gflops(20000);
+  measured->set_launch_latency_us(6.5);
+  measured->set_host_bandwidth(24000000);
+
+  DeviceProperties device;
+  device.set_type("GPU");
+  device.set_model("gfx906");
+  device.set_bandwidth(1000000000);
+  EXPECT_FALSE(ApplyDeviceProfile(profile, &device));
+  EXPECT_EQ(0, device.peak_gflops());
+
+  device.set_model("gfx908");
+  EXPECT_TRUE(ApplyDeviceProfile(profile, &device));
+  EXPECT_EQ(20000, device.peak_gflops());
+  EXPECT_EQ(6.5, device.launch_latency_us());
+  EXPECT_EQ(24000000, device.host_bandwidth());
+  // Properties that were not measured are kept.
+  EXPECT_EQ(1000000000, device.bandwidth());
+
+  device.set_type("CPU");
+  device.clear_peak_gflops();
+  EXPECT_FALSE(ApplyDeviceProfile(profile, &device));
+  EXPECT_EQ(0, device.peak_gflops());
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
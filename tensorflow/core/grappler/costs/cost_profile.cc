@@ -0,0 +1,115 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/cost_profile.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Returns the op of the node in a timeline label like "node = Op(a, b)", or
+// an empty string if the label has another format.
+string OpFromTimelineLabel(const string& label) {
+  const size_t op_begin = label.find(" = ");
+  if (op_begin == string::npos) return "";
+  const size_t op_end = label.find('(', op_begin);
+  if (op_end == string::npos) return "";
+  return label.substr(op_begin + 3, op_end - op_begin - 3);
+}
+
+}  // namespace
+
+Status CostProfile::AddRunMetadataFile(const string& path) {
+  RunMetadata run_metadata;
+  TF_RETURN_IF_ERROR(
+      ReadTextOrBinaryProto(Env::Default(), path, &run_metadata));
+  AddRunMetadata(run_metadata);
+  return Status::OK();
+}
+
+void CostProfile::AddRunMetadata(const RunMetadata& run_metadata) {
+  AddStepStats(run_metadata.step_stats());
+}
+
+void CostProfile::AddStepStats(const StepStats& step_stats) {
+  struct Times {
+    string op;
+    int64 op_micros = 0;
+    int64 kernel_micros = 0;
+  };
+  absl::flat_hash_map<string, Times> times;
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    // Device tracers record every kernel twice, on its own stream and on
+    // "stream:all".
+    const bool is_stream = absl::StrContains(dev_stats.device(), "/stream:");
+    if (is_stream && !absl::EndsWith(dev_stats.device(), "/stream:all")) {
+      continue;
+    }
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      // Kernels are recorded as "node:Op".
+      std::vector<string> name_and_op =
+          absl::StrSplit(node_stats.node_name(), absl::MaxSplits(':', 1));
+      Times& node_times = times[name_and_op[0]];
+      if (node_times.op.empty()) {
+        node_times.op = OpFromTimelineLabel(node_stats.timeline_label());
+      }
+      if (node_times.op.empty() && name_and_op.size() > 1) {
+        node_times.op = name_and_op[1];
+      }
+      int64 micros =
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+      if (micros <= 0) micros = node_stats.all_end_rel_micros();
+      if (is_stream) {
+        node_times.kernel_micros += micros;
+      } else {
+        node_times.op_micros += micros;
+      }
+    }
+  }
+
+  RunCosts run;
+  for (const auto& node_times : times) {
+    if (node_times.second.op.empty()) continue;
+    NodeCost& cost = run[node_times.first];
+    cost.op = node_times.second.op;
+    cost.compute_micros = node_times.second.kernel_micros > 0
+                              ? node_times.second.kernel_micros
+                              : node_times.second.op_micros;
+  }
+  if (!run.empty()) runs_.push_back(std::move(run));
+}
+
+bool CostProfile::GetNodeTime(const string& node_name, const string& op,
+                              int64* compute_micros) const {
+  int64 total_micros = 0;
+  int num_runs = 0;
+  for (const RunCosts& run : runs_) {
+    const auto it = run.find(node_name);
+    if (it == run.end() || it->second.op != op) continue;
+    total_micros += it->second.compute_micros;
+    ++num_runs;
+  }
+  if (num_runs == 0) return false;
+  *compute_micros = total_micros / num_runs;
+  return true;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,69 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_COST_PROFILE_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_COST_PROFILE_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Execution times of the nodes of a graph, measured in earlier runs and
+// recorded in their RunMetadata. Optimizers consult a profile to choose
+// between rewrites by how fast they actually ran.
+class CostProfile {
+ public:
+  struct NodeCost {
+    // The op the node ran as, e.g. "_FusedConv2D" once it was fused.
+    string op;
+    // Kernel time on the device if it was traced, otherwise the time the op
+    // took to run on its device.
+    int64 compute_micros = 0;
+  };
+
+  // The costs measured in one run, keyed by node name.
+  using RunCosts = absl::flat_hash_map<string, NodeCost>;
+
+  CostProfile() = default;
+
+  // Adds the run recorded in the RunMetadata proto, in text or binary format,
+  // at `path`.
+  Status AddRunMetadataFile(const string& path);
+
+  void AddRunMetadata(const RunMetadata& run_metadata);
+  void AddStepStats(const StepStats& step_stats);
+
+  const std::vector<RunCosts>& runs() const { return runs_; }
+
+  // Sets `compute_micros` to the mean time of `node_name` over the runs in
+  // which it ran as `op`, and returns false if it never did.
+  bool GetNodeTime(const string& node_name, const string& op,
+                   int64* compute_micros) const;
+
+ private:
+  std::vector<RunCosts> runs_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_COST_PROFILE_H_
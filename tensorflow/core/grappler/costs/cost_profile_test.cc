@@ -0,0 +1,119 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/cost_profile.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void AddNodeStats(DeviceStepStats* dev_stats, const string& node_name,
+                  const string& timeline_label, int64 micros) {
+  NodeExecStats* node_stats = dev_stats->add_node_stats();
+  node_stats->set_node_name(node_name);
+  node_stats->set_timeline_label(timeline_label);
+  node_stats->set_op_start_rel_micros(1);
+  node_stats->set_op_end_rel_micros(1 + micros);
+  node_stats->set_all_end_rel_micros(2 + micros);
+}
+
+TEST(CostProfileTest, UsesOpTimesWithoutKernelTraces) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  AddNodeStats(dev_stats, "conv", "conv = Conv2D(x, filter)", 30);
+  AddNodeStats(dev_stats, "relu", "relu = Relu(conv)", 5);
+
+  CostProfile profile;
+  profile.AddStepStats(step_stats);
+  ASSERT_EQ(1, profile.runs().size());
+
+  int64 micros;
+  ASSERT_TRUE(profile.GetNodeTime("conv", "Conv2D", &micros));
+  EXPECT_EQ(30, micros);
+  ASSERT_TRUE(profile.GetNodeTime("relu", "Relu", &micros));
+  EXPECT_EQ(5, micros);
+  EXPECT_FALSE(profile.GetNodeTime("relu", "_FusedConv2D", &micros));
+  EXPECT_FALSE(profile.GetNodeTime("bias", "BiasAdd", &micros));
+}
+
+TEST(CostProfileTest, PrefersKernelTimes) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device("/job:localhost/replica:0/task:0/device:GPU:0");
+  AddNodeStats(dev_stats, "conv", "conv = Conv2D(x, filter)", 3);
+  DeviceStepStats* all_stream = step_stats.add_dev_stats();
+  all_stream->set_device("/device:GPU:0/stream:all");
+  AddNodeStats(all_stream, "conv:Conv2D", "implicit_convolve_sgemm", 40);
+  AddNodeStats(all_stream, "conv:Conv2D", "scal_kernel", 2);
+  // The same kernels on their own stream are not counted twice.
+  DeviceStepStats* stream = step_stats.add_dev_stats();
+  stream->set_device("/device:GPU:0/stream:7");
+  AddNodeStats(stream, "conv:Conv2D", "implicit_convolve_sgemm", 40);
+
+  CostProfile profile;
+  profile.AddStepStats(step_stats);
+  int64 micros;
+  ASSERT_TRUE(profile.GetNodeTime("conv", "Conv2D", &micros));
+  EXPECT_EQ(42, micros);
+}
+
+TEST(CostProfileTest, AveragesOverRunsOfTheSameOp) {
+  CostProfile profile;
+  for (const auto& run : std::vector<std::pair<string, int64>>{
+           {"bias = BiasAdd(conv, b)", 10},
+           {"bias = BiasAdd(conv, b)", 20},
+           {"bias = _FusedConv2D(x, filter, b)", 25}}) {
+    StepStats step_stats;
+    DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+    dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+    AddNodeStats(dev_stats, "bias", run.first, run.second);
+    profile.AddStepStats(step_stats);
+  }
+  EXPECT_EQ(3, profile.runs().size());
+  int64 micros;
+  ASSERT_TRUE(profile.GetNodeTime("bias", "BiasAdd", &micros));
+  EXPECT_EQ(15, micros);
+  ASSERT_TRUE(profile.GetNodeTime("bias", "_FusedConv2D", &micros));
+  EXPECT_EQ(25, micros);
+}
+
+TEST(CostProfileTest, ReadsRunMetadataFile) {
+  RunMetadata run_metadata;
+  DeviceStepStats* dev_stats =
+      run_metadata.mutable_step_stats()->add_dev_stats();
+  dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  AddNodeStats(dev_stats, "matmul", "matmul = MatMul(a, b)", 12);
+  const string path = io::JoinPath(testing::TmpDir(), "run_metadata.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, run_metadata));
+
+  CostProfile profile;
+  TF_ASSERT_OK(profile.AddRunMetadataFile(path));
+  int64 micros;
+  ASSERT_TRUE(profile.GetNodeTime("matmul", "MatMul", &micros));
+  EXPECT_EQ(12, micros);
+  EXPECT_FALSE(
+      profile.AddRunMetadataFile(io::JoinPath(testing::TmpDir(), "missing"))
+          .ok());
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -756,6 +756,12 @@ DeviceInfo OpLevelCostEstimator::GetDeviceInfo(
       gb_per_sec = 100;
     }
   }
+  // The nominal peak is often far from what the device sustains, e.g. for
+  // GPUs whose cores per multiprocessor are not in the table above, so prefer
+  // a measured peak when there is one.
+  if (device.peak_gflops() > 0) {
+    gflops = device.peak_gflops();
+  }
   VLOG(1) << "Device: " << device.type() << " gflops: " << gflops
           << " gb_per_sec: " << gb_per_sec;
 
@@ -872,6 +878,12 @@ Costs OpLevelCostEstimator::PredictOpCountBasedCost(
   costs.intermediate_memory_write_time =
       Costs::NanoSeconds(intermediate_write_time);
   CombineCostsAndUpdateExecutionTime(compute_memory_overlap_, &costs);
+  // No op runs faster than it takes to launch it on the device.
+  const Costs::NanoSeconds launch_latency(
+      std::ceil(op_info.device().launch_latency_us() * 1e3));
+  if (costs.execution_time < launch_latency) {
+    costs.execution_time = launch_latency;
+  }
   return costs;
 }
 
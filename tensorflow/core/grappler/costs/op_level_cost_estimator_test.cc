@@ -2031,6 +2031,36 @@ TEST_F(OpLevelCostEstimatorTest, AddNExecutionTime) {
   EXPECT_EQ(cost.persistent_memory, 0);
 }
 
+TEST_F(OpLevelCostEstimatorTest, MeasuredPeakGflops) {
+  OpContext op_context;
+  SetCpuDevice(&op_context.op_info);
+  // 10 cores at 1 GHz.
+  EXPECT_EQ(10, estimator_.GetDeviceInfo(op_context.op_info.device()).gigaops);
+
+  op_context.op_info.mutable_device()->set_peak_gflops(40);
+  EXPECT_EQ(40, estimator_.GetDeviceInfo(op_context.op_info.device()).gigaops);
+}
+
+TEST_F(OpLevelCostEstimatorTest, LaunchLatencyBoundsExecutionTime) {
+  OpContext op_context;
+  SetCpuDevice(&op_context.op_info);
+  op_context.op_info.set_op("AddN");
+
+  DescribeTensor4D(1, 10, 10, 10, op_context.op_info.add_inputs());
+  DescribeTensor4D(1, 10, 10, 10, op_context.op_info.add_inputs());
+  DescribeTensor4D(1, 10, 10, 10, op_context.op_info.add_inputs());
+
+  op_context.op_info.mutable_device()->set_launch_latency_us(1);
+  auto cost = PredictCosts(op_context);
+  EXPECT_EQ(Costs::Duration(1400), cost.execution_time);
+
+  op_context.op_info.mutable_device()->set_launch_latency_us(5);
+  cost = PredictCosts(op_context);
+  EXPECT_EQ(Costs::Duration(1200), cost.memory_time);
+  EXPECT_EQ(Costs::Duration(200), cost.compute_time);
+  EXPECT_EQ(Costs::Duration(5000), cost.execution_time);
+}
+
 TEST_F(OpLevelCostEstimatorTest, IdentityOpExecutionTime) {
   std::vector<std::string> identity_ops = {
       "_Recv",         "_Send",        "BitCast",         "Identity",
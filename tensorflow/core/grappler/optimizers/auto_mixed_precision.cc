@@ -53,6 +53,18 @@ bool HasEnhancedFP16ComputeSupport(std::pair<int, int> gpu_arch){
                      std::end(FP16SupportedDevices), arch)
            != std::end(FP16SupportedDevices); 
 }
+
+// gfx908 and gfx94x. gfx90a is missing because its architecture string does not
+// parse as a number in GetDeviceGPUArch.
+const std::array<std::string, 4> BF16SupportedDevices = {"908", "940", "941",
+                                                         "942"};
+
+bool HasEnhancedBF16ComputeSupport(std::pair<int, int> gpu_arch) {
+  std::string arch = std::to_string(gpu_arch.first);
+  return std::find(std::begin(BF16SupportedDevices),
+                   std::end(BF16SupportedDevices),
+                   arch) != std::end(BF16SupportedDevices);
+}
 #endif
 
 namespace {
@@ -969,6 +981,8 @@ class AutoMixedPrecisionImpl {
                                                              cudnn_version_);
       case AutoMixedPrecisionMode::MKL:
         return std::make_unique<AutoMixedPrecisionListsMkl>();
+      case AutoMixedPrecisionMode::ROCM_BF16:
+        return std::make_unique<AutoMixedPrecisionListsRocmBf16>();
     }
   }
   Status PrintDebugLogs(bool preop, size_t timestamp);
@@ -1179,6 +1193,10 @@ bool AutoMixedPrecisionImpl::IsOnSuitableGPUArch(const NodeDef& node) const {
 #ifndef TENSORFLOW_USE_ROCM
   return GetDeviceGPUArch(virtual_placer_.get_device(node)) >= kMinGPUArch;
 #else
+  if (mode_ == AutoMixedPrecisionMode::ROCM_BF16) {
+    return HasEnhancedBF16ComputeSupport(
+        GetDeviceGPUArch(virtual_placer_.get_device(node)));
+  }
   return HasEnhancedFP16ComputeSupport(GetDeviceGPUArch(virtual_placer_.get_device(node)));
 #endif
 }
@@ -1282,6 +1300,12 @@ Status AutoMixedPrecisionImpl::Optimize() {
         "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL cannot be set to "
         "UNSAFE_FORCE_ALL when MKL is used");
   }
+  if (force_all_fp16_ && mode_ == AutoMixedPrecisionMode::ROCM_BF16) {
+    // Likewise, few ops have bfloat16 GPU kernels.
+    return errors::InvalidArgument(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL cannot be set to "
+        "UNSAFE_FORCE_ALL when ROCm bfloat16 is used");
+  }
 
   std::unique_ptr<AutoMixedPrecisionLists> mp_lists =
       get_mixed_precision_lists();
@@ -1300,6 +1324,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
     bool should_process;
     switch (mode_) {
       case AutoMixedPrecisionMode::CUDA:
+      case AutoMixedPrecisionMode::ROCM_BF16:
         should_process =
             !MustPreserve(node) && IsOnDevice(node, DEVICE_GPU) &&
             (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node));
@@ -1561,6 +1586,15 @@ void AutoMixedPrecisionImpl::AddAllowlistOps(
     if (!ShouldProcess(*root.node)) continue;
     bool force_allow = force_all_fp16_ && CanForceFP16(*root.node);
     if (f16_allowlist_.count(root.node->op()) || force_allow) {
+      // Few ops have bfloat16 GPU kernels. Converting one that has none would
+      // only surround it with casts back to float32.
+      if (mode_ == AutoMixedPrecisionMode::ROCM_BF16 && !SupportsF16(root)) {
+        VLOG(2) << "Not painting type " << root.type_attr.DebugString()
+                << " of node " << root.node->name() << " ALLOW because its op "
+                << root.node->op() << " has no "
+                << DataTypeString(target_dtype_) << " kernel";
+        continue;
+      }
       bool inserted = allow_set->insert(root_idx).second;
       if (VLOG_IS_ON(2) && inserted) {
         VLOG(2) << "Painting type " << root.type_attr.DebugString()
@@ -1998,6 +2032,20 @@ int GetNumGPUs(const Cluster& cluster,
   return num_gpus;
 }
 
+#if TENSORFLOW_USE_ROCM
+int GetNumBF16GPUs(const Cluster& cluster) {
+  int num_gpus = 0;
+  for (const auto& device : cluster.GetDevices()) {
+    const DeviceProperties& device_properties = device.second;
+    if (device_properties.type() == "GPU" &&
+        HasEnhancedBF16ComputeSupport(GetDeviceGPUArch(device_properties))) {
+      num_gpus++;
+    }
+  }
+  return num_gpus;
+}
+#endif
+
 }  // end namespace
 
 Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -2018,12 +2066,26 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
 #endif
 
+#if !TENSORFLOW_USE_ROCM
+  if (mode_ == AutoMixedPrecisionMode::ROCM_BF16) {
+    return errors::Unimplemented(
+        "The auto_mixed_precision_rocm_bf16 optimizer cannot be used since "
+        "this build of TensorFlow is not compiled with ROCm support.");
+  }
+#endif
+
   // Start by copying input graph to output.
   *output = item.graph;
 
   int num_gpus = ShouldIgnorePerformance() ? GetNumGPUs(*cluster)
                                            : GetNumGPUs(*cluster, kMinGPUArch);
-  if (num_gpus < 1 && mode_ == AutoMixedPrecisionMode::CUDA) {
+#if TENSORFLOW_USE_ROCM
+  if (mode_ == AutoMixedPrecisionMode::ROCM_BF16 &&
+      !ShouldIgnorePerformance()) {
+    num_gpus = GetNumBF16GPUs(*cluster);
+  }
+#endif
+  if (num_gpus < 1 && mode_ != AutoMixedPrecisionMode::MKL) {
     // AutoMixedPrecision is currently only tuned for GPU.
     LOG(WARNING) << "No (suitable) GPUs detected, skipping " << name()
                  << " graph optimizer";
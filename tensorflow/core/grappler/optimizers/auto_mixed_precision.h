@@ -22,11 +22,13 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
-enum class AutoMixedPrecisionMode { CUDA, MKL };
+enum class AutoMixedPrecisionMode { CUDA, MKL, ROCM_BF16 };
 
 //Getting FP16 supported devices for ROCm
 #if TENSORFLOW_USE_ROCM
 bool HasEnhancedFP16ComputeSupport(std::pair<int, int> gpu_arch);
+// Returns true for AMD GPUs that run bfloat16 at the full fp16 rate.
+bool HasEnhancedBF16ComputeSupport(std::pair<int, int> gpu_arch);
 #endif
 
 // Convert data types to float16 or bfloat16 where appropriate to improve
@@ -35,7 +37,8 @@ class AutoMixedPrecision : public GraphOptimizer {
  public:
   // If 'mode' is CUDA, converts nodes to float16 on Nvidia GPUs. If MKL,
   // converts nodes to bfloat16 on CPUs in order to take advantage of MKL
-  // performance improvements with bfloat16.
+  // performance improvements with bfloat16. If ROCM_BF16, converts nodes to
+  // bfloat16 on AMD GPUs that have fast bfloat16 support.
   explicit AutoMixedPrecision(
       AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA)
       : mode_(mode) {}
@@ -43,8 +46,14 @@ class AutoMixedPrecision : public GraphOptimizer {
   ~AutoMixedPrecision() override {}
 
   string name() const override {
-    return mode_ == AutoMixedPrecisionMode::CUDA ? "auto_mixed_precision_cuda"
-                                                 : "auto_mixed_precision_mkl";
+    switch (mode_) {
+      case AutoMixedPrecisionMode::CUDA:
+        return "auto_mixed_precision_cuda";
+      case AutoMixedPrecisionMode::MKL:
+        return "auto_mixed_precision_mkl";
+      case AutoMixedPrecisionMode::ROCM_BF16:
+        return "auto_mixed_precision_rocm_bf16";
+    }
   };
 
   bool UsesFunctionLibrary() const override { return false; }
@@ -368,6 +368,175 @@ class AutoMixedPrecisionListsCuda : public AutoMixedPrecisionLists {
   int cudnn_version_;
 };
 
+// Lists for bfloat16 on AMD GPUs. Unlike float16, bfloat16 has the range of
+// float32, so only ops that need the extra mantissa bits are denied. Ops are
+// only converted if they have a bfloat16 GPU kernel, so listing an op that has
+// none in this build has no effect.
+class AutoMixedPrecisionListsRocmBf16 : public AutoMixedPrecisionLists {
+ public:
+  AutoMixedPrecisionListsRocmBf16() {}
+
+  gtl::FlatSet<string> AllowList() override {
+    auto list = gtl::FlatSet<string>{
+        "BatchMatMul",
+        "BatchMatMulV2",
+        "Conv2D",
+        "Conv2DBackpropFilter",
+        "Conv2DBackpropInput",
+        "Conv3D",
+        "Conv3DBackpropFilterV2",
+        "Conv3DBackpropInputV2",
+        "Einsum",
+        "MatMul",
+        "_ROCmFusedConvolutionBiasActivation",
+        "_ROCmFusedMatMulBiasActivation",
+        "_ROCmFusedMatMulBiasAddActivation",
+    };
+    UpdateList("ALLOWLIST", &list);
+    // For backwards compatibility, keeping the original env variable here.
+    // TODO(reedwm): This should be removed if we don't have active users.
+    UpdateList("WHITELIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> InferList() override {
+    auto list = gtl::FlatSet<string>{
+        "Add",
+        "AddN",
+        "AddV2",
+        "AvgPool",
+        "AvgPool3D",
+        "AvgPool3DGrad",
+        "AvgPoolGrad",
+        "BiasAdd",
+        "BiasAddGrad",
+        "BiasAddV1",
+        "Elu",
+        "EluGrad",
+        "FusedBatchNormV2",
+        "FusedBatchNormGradV2",
+        "FusedBatchNormV3",
+        "FusedBatchNormGradV3",
+        "_FusedBatchNormEx",
+        "LeakyRelu",
+        "LeakyReluGrad",
+        "Mul",
+        "RealDiv",
+        "Selu",
+        "SeluGrad",
+        "Sigmoid",
+        "SigmoidGrad",
+        "Sub",
+        "Tanh",
+        "TanhGrad",
+        "_FusedMulAdd",
+        "_FusedMulAdd2",
+        "_FusedMulSub",
+        "_FusedMulSub2",
+        "_FusedMulSubRev",
+        "_ROCmFusedAddRelu",
+        "_ROCmFusedAddNReluGrad",
+        "_ROCmFusedBatchNormActivationForward",
+        "_ROCmFusedBatchNormActivationInference",
+        "_ROCmFusedBatchNormActivationBackward",
+    };
+    UpdateList("INFERLIST", &list);
+    // For backwards compatibility, keeping the original env variable here.
+    // TODO(reedwm): This should be removed if we don't have active users.
+    UpdateList("GRAYLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> DenyList() override {
+    auto list = gtl::FlatSet<string>{
+        "Exp",
+        "Expm1",
+        "L2Loss",
+        "Log",
+        "Log1p",
+        "LogSoftmax",
+        "Mean",
+        "Pow",
+        "SaveV2",
+        "Softmax",
+        "SoftmaxCrossEntropyWithLogits",
+        "SparseSoftmaxCrossEntropyWithLogits",
+        "Sum",
+    };
+    UpdateList("DENYLIST", &list);
+    // For backwards compatibility, keeping the original env variable here.
+    // TODO(reedwm): This should be removed if we don't have active users.
+    UpdateList("BLACKLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> ClearList() override {
+    auto list = gtl::FlatSet<string>{
+        "Abs",
+        "BatchToSpaceND",
+        "BroadcastTo",
+        "Concat",
+        "ConcatV2",
+        "DepthToSpace",
+        "Enter",
+        "EnsureShape",
+        "Equal",
+        "Exit",
+        "ExpandDims",
+        "Fill",
+        "Gather",
+        "GatherNd",
+        "GatherV2",
+        "Identity",
+        "IdentityN",
+        "Max",
+        "MaxPool",
+        "MaxPool3D",
+        "MaxPool3DGrad",
+        "MaxPoolGrad",
+        "MaxPoolV2",
+        "Maximum",
+        "Merge",
+        "Min",
+        "Minimum",
+        "Neg",
+        "NextIteration",
+        "OnesLike",
+        "Pack",
+        "Pad",
+        "PadV2",
+        "PreventGradient",
+        "Relu",
+        "Relu6",
+        "Relu6Grad",
+        "ReluGrad",
+        "Reshape",
+        "ReverseV2",
+        "Select",
+        "SelectV2",
+        "Shape",
+        "ShapeN",
+        "Slice",
+        "Snapshot",
+        "SpaceToBatchND",
+        "SpaceToDepth",
+        "Split",
+        "SplitV",
+        "Squeeze",
+        "StopGradient",
+        "StridedSlice",
+        "StridedSliceGrad",
+        "Switch",
+        "Tile",
+        "Transpose",
+        "ZerosLike",
+    };
+    AddTensorListOps(&list);
+    UpdateList("CLEARLIST", &list);
+    return list;
+  }
+};
+
 class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
  public:
   AutoMixedPrecisionListsMkl() {}
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/clusters/single_machine.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
@@ -1218,6 +1219,91 @@ TEST_F(AutoMixedPrecisionTest, TanhOp) {
       });
 }
 
+#if TENSORFLOW_USE_ROCM
+
+class AutoMixedPrecisionRocmBf16Test : public GrapplerTest {
+ protected:
+  void SetUp() override {
+    DeviceProperties device_properties;
+    device_properties.set_type("GPU");
+    device_properties.mutable_environment()->insert({"architecture", "908"});
+    virtual_cluster_.reset(new VirtualCluster({{"/GPU:1", device_properties}}));
+    TF_CHECK_OK(virtual_cluster_->Provision());
+  }
+  void TearDown() override { TF_CHECK_OK(virtual_cluster_->Shutdown()); }
+
+  static bool HasBf16GpuKernel(const NodeDef& node) {
+    NodeDef node_copy(node);
+    node_copy.set_device("/GPU:1");
+    (*node_copy.mutable_attr())["T"].set_type(DT_BFLOAT16);
+    return FindKernelDef(DeviceType(DEVICE_GPU), node_copy, nullptr, nullptr)
+        .ok();
+  }
+
+  std::unique_ptr<Cluster> virtual_cluster_;
+};
+
+TEST_F(AutoMixedPrecisionRocmBf16Test, Simple) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {32, 32});
+  Output deny1 = ops::Exp(s.WithOpName("deny1"), input);
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), deny1, deny1);
+  Output clr1 = ops::Relu(s.WithOpName("clr1"), allow1);
+  Output deny2 = ops::Log(s.WithOpName("deny2"), clr1);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), deny2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::ROCM_BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("deny1")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("deny2")->attr().at("T").type(), DT_FLOAT);
+  if (HasBf16GpuKernel(*output_view.GetNode("allow1"))) {
+    EXPECT_EQ(output.node_size(), item.graph.node_size() + 2);
+    EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(),
+              DT_BFLOAT16);
+  } else {
+    // Without a bfloat16 kernel the MatMul must not be wrapped in casts.
+    VerifyGraphsEquivalent(item.graph, output, __FUNCTION__);
+    EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_FLOAT);
+    EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_FLOAT);
+  }
+}
+
+TEST_F(AutoMixedPrecisionRocmBf16Test, UnsuitableArch) {
+  DeviceProperties device_properties;
+  device_properties.set_type("GPU");
+  device_properties.mutable_environment()->insert({"architecture", "906"});
+  virtual_cluster_.reset(new VirtualCluster({{"/GPU:1", device_properties}}));
+  TF_CHECK_OK(virtual_cluster_->Provision());
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {32, 32});
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), input, input);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), allow1);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::ROCM_BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  VerifyGraphsEquivalent(item.graph, output, __FUNCTION__);
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_FLOAT);
+}
+
+#endif  // TENSORFLOW_USE_ROCM
+
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 #if INTEL_MKL
@@ -62,6 +62,11 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 // We only fold/materialize constants smaller than 100kB.
 const int64 kMaxConstantSize = 100 * 1024;
 
+// Outputs up to 10MB are evaluated even if they exceed kMaxConstantSize, since
+// their encoded size (checked in CreateNodeDef()) may still be small when the
+// values compress well, e.g. when they end in a long run of repeated values.
+const int64 kMaxFoldableOutputSize = 100 * kMaxConstantSize;
+
 namespace {
 template <typename T>
 bool AllValuesAre(const TensorProto& proto, const T& value) {
@@ -1008,10 +1013,11 @@ bool ConstantFolding::IsFoldableUncached(
       if (output_shape.IsFullyDefined()) {
         const int64 num_bytes =
             output_shape.num_elements() * DataTypeSize(output_prop.dtype());
-        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize) {
-          // Do not fold nodes if the in-memory size of output is too large.
-          // Notice that this is not exactly the same check used in
-          // CreateNodeDef() where the actual encoded size is checked.
+        if (num_bytes > input_size_bytes &&
+            num_bytes > kMaxFoldableOutputSize) {
+          // Do not fold nodes if the in-memory size of output is too large to
+          // evaluate. The encoded size, which is what ends up in the graph, is
+          // bounded by kMaxConstantSize in CreateNodeDef().
           return false;
         }
       }
@@ -1288,6 +1294,11 @@ Status ConstantFolding::CreateNodeDef(const string& name,
     // DT_QUINT8
     tensor->AsProtoTensorContent(t);
     encoded_size = t->tensor_content().size();
+    // Fall back to the repeated field representation with a truncated tail if
+    // it is substantially smaller than the raw bytes.
+    if (tensor::CompressTensorProtoInPlace(t)) {
+      encoded_size = t->ByteSizeLong();
+    }
   }
   node->mutable_attr()->insert({"value", attr_tensor});
 
@@ -3029,6 +3029,41 @@ TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   EXPECT_LT(output.ByteSizeLong(), sizeof(float) * large_constant_size + 500);
 }
 
+TEST_F(ConstantFoldingTest, LargeCompressibleOutput) {
+  // The output of the cast is larger than both its input and kMaxConstantSize
+  // in memory, but its values are all equal, so it is folded into a constant
+  // with a compressed encoding.
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  const int64 large_constant_size = kMaxConstantSize + 1;
+  Output a_const =
+      ops::Const(scope.WithOpName("a_const"), true, {1, large_constant_size});
+  Output b = ops::Cast(scope.WithOpName("b"), a_const, DT_HALF);
+  Output c = ops::Identity(scope.WithOpName("c"), b);
+
+  GrapplerItem item;
+  item.fetch.push_back("c");
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  Status status = optimizer.Optimize(/*cluster=*/nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  for (const auto& node : output.node()) {
+    if (node.name() == "c") {
+      EXPECT_EQ("Const", node.op());
+      EXPECT_TRUE(node.attr().at("value").tensor().tensor_content().empty());
+    }
+  }
+  EXPECT_LT(output.ByteSizeLong(), 1000);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<Eigen::half>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(ConstantFoldingTest, MaterializeBroadcastGradientArgs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a =
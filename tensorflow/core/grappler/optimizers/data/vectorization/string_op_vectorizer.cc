@@ -0,0 +1,87 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Vectorizer for ops that transform or decode each string of their first
+// input independently, and whose other inputs, if any, are scalars that apply
+// to all the strings, e.g. the pattern of RegexReplace. These ops are the
+// vectorized versions of themselves, as long as the scalar inputs are the same
+// for all the elements.
+class StringOpVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const Node& node, Graph* outer_scope,
+                   VectorizerInput&& inputs,
+                   VectorizerOutput* outputs) override {
+    NodeBuilder::NodeOut input;
+    TF_RETURN_IF_ERROR(inputs.stacked(0, &input));
+
+    std::vector<NodeBuilder::NodeOut> args(inputs.size() - 1);
+    for (size_t i = 1; i < inputs.size(); ++i) {
+      TF_RETURN_IF_ERROR(inputs.unstacked(i, &args[i - 1]));
+    }
+
+    Node* new_node;
+    auto node_builder = NodeBuilder(strings::StrCat("vectorized/", node.name()),
+                                    node.type_string())
+                            .Input(input);
+    for (const auto& arg : args) {
+      node_builder = node_builder.Input(arg);
+    }
+    for (const auto& attr : node.attrs()) {
+      node_builder = node_builder.Attr(attr.first, attr.second);
+    }
+    TF_RETURN_IF_ERROR(node_builder.Finalize(outer_scope, &new_node));
+
+    // Add output mappings
+    for (int i = 0; i < node.num_outputs(); ++i) {
+      outputs->emplace_back(new_node, i, true);
+    }
+    return Status::OK();
+  }
+};
+
+// String transformations
+REGISTER_VECTORIZER("AsString", StringOpVectorizer);
+REGISTER_VECTORIZER("DecodeBase64", StringOpVectorizer);
+REGISTER_VECTORIZER("EncodeBase64", StringOpVectorizer);
+REGISTER_VECTORIZER("RegexFullMatch", StringOpVectorizer);
+REGISTER_VECTORIZER("RegexReplace", StringOpVectorizer);
+REGISTER_VECTORIZER("StaticRegexFullMatch", StringOpVectorizer);
+REGISTER_VECTORIZER("StaticRegexReplace", StringOpVectorizer);
+REGISTER_VECTORIZER("StringLength", StringOpVectorizer);
+REGISTER_VECTORIZER("StringLower", StringOpVectorizer);
+REGISTER_VECTORIZER("StringStrip", StringOpVectorizer);
+REGISTER_VECTORIZER("StringToHashBucket", StringOpVectorizer);
+REGISTER_VECTORIZER("StringToHashBucketFast", StringOpVectorizer);
+REGISTER_VECTORIZER("StringToHashBucketStrong", StringOpVectorizer);
+REGISTER_VECTORIZER("StringToNumber", StringOpVectorizer);
+REGISTER_VECTORIZER("StringUpper", StringOpVectorizer);
+
+// Decoding. The decoded values of each string are added as a trailing
+// dimension, so the stacked dimension stays first.
+REGISTER_VECTORIZER("DecodeCompressed", StringOpVectorizer);
+REGISTER_VECTORIZER("DecodePaddedRaw", StringOpVectorizer);
+REGISTER_VECTORIZER("DecodeRaw", StringOpVectorizer);
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
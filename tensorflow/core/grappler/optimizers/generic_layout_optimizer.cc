@@ -39,6 +39,8 @@ constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
 constexpr float kVoltaGPURatioThreshold = 0.5;
 constexpr float kConvGPUFP16Threshold = 0.5;
+// Suffix of the names of the nodes added by the layout conversion.
+constexpr char kLayoutOptimizerSuffix[] = "-LayoutOptimizer";
 
 struct MutableNodeViewFormatter {
   void operator()(std::string* out, utils::MutableNodeView* node_view) const {
@@ -117,6 +119,79 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
   return {src_format, dst_format};
 }
 
+enum class ProfiledLayoutDecision { kUnknown, kConvert, kKeep };
+
+// Decides from the runs in `cost_profile` whether converting the layout of
+// the GPU nodes pays off. A run in which the graph was converted pays for the
+// layout sensitive nodes in the new format plus the nodes added by the
+// conversion, other runs for the layout sensitive nodes in the original
+// format. Runs without any of the layout sensitive nodes are of another graph
+// and are ignored. Returns kUnknown unless there are runs of both kinds, and
+// describes the measurements in `explanation`.
+ProfiledLayoutDecision DecideLayoutFromProfile(const CostProfile& cost_profile,
+                                               const TransposeContext& context,
+                                               string* explanation) {
+  std::vector<string> sensitive_nodes;
+  for (const auto& node : context.graph_view->GetNodes()) {
+    const NodeDef& node_def = *node.node();
+    if (!IsLayoutSensitiveOp(node_def)) continue;
+    const string& device_name =
+        GetDeviceName(context.virtual_placer.get(), node_def);
+    string device_type;
+    string task;
+    if (DeviceNameUtils::SplitDeviceName(device_name, &task, &device_type) &&
+        absl::StrContains(absl::AsciiStrToLower(device_type),
+                          absl::AsciiStrToLower(kGPU))) {
+      sensitive_nodes.push_back(node_def.name());
+    }
+  }
+
+  int64 converted_micros = 0;
+  int64 unconverted_micros = 0;
+  int num_converted_runs = 0;
+  int num_unconverted_runs = 0;
+  for (const CostProfile::RunCosts& run : cost_profile.runs()) {
+    int64 run_micros = 0;
+    int num_found = 0;
+    for (const string& node_name : sensitive_nodes) {
+      const auto it = run.find(node_name);
+      if (it == run.end()) continue;
+      run_micros += it->second.compute_micros;
+      ++num_found;
+    }
+    if (num_found == 0) continue;
+    bool converted = false;
+    for (const auto& node_cost : run) {
+      if (absl::EndsWith(node_cost.first, kLayoutOptimizerSuffix)) {
+        converted = true;
+        run_micros += node_cost.second.compute_micros;
+      }
+    }
+    if (converted) {
+      converted_micros += run_micros;
+      ++num_converted_runs;
+    } else {
+      unconverted_micros += run_micros;
+      ++num_unconverted_runs;
+    }
+  }
+  if (num_converted_runs == 0 || num_unconverted_runs == 0) {
+    *explanation = absl::StrCat("the cost profile has ", num_converted_runs,
+                                " converted and ", num_unconverted_runs,
+                                " unconverted runs of the graph");
+    return ProfiledLayoutDecision::kUnknown;
+  }
+  converted_micros /= num_converted_runs;
+  unconverted_micros /= num_unconverted_runs;
+  *explanation =
+      absl::StrCat("layout sensitive GPU nodes took ", converted_micros,
+                   "us with the conversion and ", unconverted_micros,
+                   "us without it in the cost profile");
+  return converted_micros < unconverted_micros
+             ? ProfiledLayoutDecision::kConvert
+             : ProfiledLayoutDecision::kKeep;
+}
+
 Status ExpandLayoutSensitiveOp(TransposeContext* context,
                                TransposerFactory* transposer_factory) {
   const int num_nodes = context->num_nodes;
@@ -420,6 +495,27 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
 
     const auto src_dst_formats = GetSrcAndDstDataFormats(
         context, num_gpus, num_gpus_and_num_volta.second);
+    if (cost_profile_ != nullptr) {
+      string explanation;
+      const ProfiledLayoutDecision decision =
+          DecideLayoutFromProfile(*cost_profile_, context, &explanation);
+      if (decision == ProfiledLayoutDecision::kUnknown) {
+        VLOG(1) << "Converting the layout of " << item.id << " from "
+                << src_dst_formats.first << " to " << src_dst_formats.second
+                << " by heuristics: " << explanation;
+      } else {
+        LOG(INFO) << (decision == ProfiledLayoutDecision::kConvert
+                          ? "Converting"
+                          : "Not converting")
+                  << " the layout of " << item.id << " from "
+                  << src_dst_formats.first << " to " << src_dst_formats.second
+                  << ": " << explanation;
+      }
+      if (decision == ProfiledLayoutDecision::kKeep) {
+        *output = item.graph;
+        return Status::OK();
+      }
+    }
     context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
                                        src_dst_formats.second);
   } else {
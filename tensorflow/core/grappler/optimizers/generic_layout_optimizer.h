@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GENERIC_LAYOUT_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GENERIC_LAYOUT_OPTIMIZER_H_
 
+#include <memory>
+
+#include "tensorflow/core/grappler/costs/cost_profile.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
@@ -33,7 +36,15 @@ class GenericLayoutOptimizer : public GraphOptimizer {
                                RewriterConfig::NO_CONVERSION_ON_CPU) {}
   explicit GenericLayoutOptimizer(RewriterConfig::Toggle opt_level,
                                   RewriterConfig::CpuLayout layout_conversion)
-      : opt_level_(opt_level), cpu_layout_conversion_(layout_conversion) {}
+      : GenericLayoutOptimizer(opt_level, layout_conversion, nullptr) {}
+  // If `cost_profile` has runs of the graph both with and without the layout
+  // conversion on GPU, the faster of the two is chosen. May be null.
+  GenericLayoutOptimizer(RewriterConfig::Toggle opt_level,
+                         RewriterConfig::CpuLayout layout_conversion,
+                         std::shared_ptr<const CostProfile> cost_profile)
+      : opt_level_(opt_level),
+        cpu_layout_conversion_(layout_conversion),
+        cost_profile_(std::move(cost_profile)) {}
   ~GenericLayoutOptimizer() override = default;
 
   string name() const override { return "layout"; };
@@ -49,6 +60,7 @@ class GenericLayoutOptimizer : public GraphOptimizer {
  private:
   RewriterConfig::Toggle opt_level_;
   RewriterConfig::CpuLayout cpu_layout_conversion_;
+  std::shared_ptr<const CostProfile> cost_profile_;
 };
 
 }  // namespace grappler
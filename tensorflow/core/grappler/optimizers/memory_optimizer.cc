@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <map>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -977,6 +978,45 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Simulates `item` on a virtual cluster with the devices of `cluster`, and
+// records when each node completes and, if `op_run_times` is not null, how long
+// the cost model expects it to run.
+static bool EstimateOpTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times,
+    std::unordered_map<string, Costs::NanoSeconds>* op_run_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+      if (op_run_times != nullptr) {
+        op_run_times->emplace(
+            node_stats.node_name(),
+            Costs::NanoSeconds(1) +
+                Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                                    node_stats.op_start_rel_micros()));
+      }
+    }
+  }
+  return true;
+}
+
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
@@ -1012,29 +1052,9 @@ static bool IdentifySwappingCandidates(
     int64 required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateOpTimes(cluster, *item, &op_completion_times,
+                         /*op_run_times=*/nullptr)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1270,6 +1290,241 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+struct RematInfo {
+  const NodeDef* node;
+  std::vector<NodeDef*> uses_left;
+  int64 memory_used;
+  // Bytes freed at the peak per nanosecond spent recomputing the tensor.
+  double fitness;
+
+  bool operator<(const RematInfo& other) const {
+    return fitness > other.fitness;
+  }
+};
+
+// Returns true if recomputing `node` after the peak reuses tensors that are
+// live at that time anyway, i.e. every regular input of `node` is persistent or
+// has another use completing after `peak_time`.
+static bool InputsLiveAfterPeak(
+    const MutableGraphView& graph, const NodeDef& node,
+    const std::unordered_map<string, Costs::NanoSeconds>& op_completion_times,
+    Costs::Duration peak_time) {
+  for (int i = 0; i < node.input_size(); ++i) {
+    if (IsControlInput(node.input(i))) {
+      break;
+    }
+    MutableGraphView::OutputPort fanin = graph.GetRegularFanin(
+        MutableGraphView::InputPort(const_cast<NodeDef*>(&node), i));
+    if (fanin.node == nullptr) {
+      return false;
+    }
+    if (IsPersistent(*fanin.node)) {
+      continue;
+    }
+    bool live_after_peak = false;
+    for (const MutableGraphView::InputPort& use : graph.GetFanout(fanin)) {
+      if (use.node == &node) {
+        continue;
+      }
+      auto it = op_completion_times.find(use.node->name());
+      if (it != op_completion_times.end() && it->second > peak_time) {
+        live_after_peak = true;
+        break;
+      }
+    }
+    if (!live_after_peak) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Rematerializes activations until the estimated peak memory usage of every
+// device fits in `memory_budget` bytes. Tensors that are live at the peak and
+// still have uses after it are recomputed for those uses instead of being kept
+// alive. Tensors are picked greedily by the memory they free per unit of
+// recomputation time, as estimated by the grappler cost model, so the target is
+// reached with little extra compute. Unlike RecomputationRewritingPass, this
+// does not rely on the names of the gradient nodes.
+bool BudgetedRecomputationPass(int64 memory_budget, Cluster* cluster,
+                               std::unique_ptr<GraphMemory>* memory_ptr,
+                               GrapplerItem* item,
+                               std::unordered_set<string>* skip_list) {
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+      return false;
+    }
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unordered_map<string, Costs::NanoSeconds> op_run_times;
+  // Maps the name of each node to recompute to the names of its uses that
+  // should read the recomputed tensor.
+  std::map<string, std::vector<string>> nodes_to_recompute;
+  MutableGraphView graph(&item->graph);
+  for (const auto& device : cluster->GetDevices()) {
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (mem_usage.used_memory <= memory_budget) {
+      continue;
+    }
+    int64 required_savings = mem_usage.used_memory - memory_budget;
+    if (op_completion_times.empty() &&
+        !EstimateOpTimes(cluster, *item, &op_completion_times,
+                         &op_run_times)) {
+      return false;
+    }
+
+    Costs::Duration peak_time = -1;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.allocation_time > peak_time) {
+        peak_time = live_tensor.allocation_time;
+      }
+    }
+
+    std::vector<RematInfo> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      // RecomputeSubgraph only rewires uses of the first output.
+      if (live_tensor.memory_used <= 1024 || live_tensor.output_id != 0) {
+        continue;
+      }
+      if (skip_list->find(live_tensor.node) != skip_list->end() ||
+          feeds.count(live_tensor.node) > 0) {
+        continue;
+      }
+      const NodeDef* node = graph.GetNode(live_tensor.node);
+      if (node == nullptr || IsPersistent(*node) || IsControlFlow(*node) ||
+          NumNonControlInputs(*node) == 0 || !IsFreeOfSideEffect(*node)) {
+        continue;
+      }
+      auto run_time = op_run_times.find(node->name());
+      if (run_time == op_run_times.end()) {
+        continue;
+      }
+
+      RematInfo info;
+      info.node = node;
+      info.memory_used = live_tensor.memory_used;
+      bool valid = true;
+      for (const MutableGraphView::InputPort& use :
+           graph.GetFanout(graph.GetOutputPort(node->name(), 0))) {
+        auto it = op_completion_times.find(use.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        // The recomputation is delayed by the other inputs of its uses. A use
+        // without any would recompute the tensor right away.
+        bool has_other_input = false;
+        for (const string& input : use.node->input()) {
+          if (NodeName(input) != node->name()) {
+            has_other_input = true;
+            break;
+          }
+        }
+        if (!has_other_input) {
+          valid = false;
+          break;
+        }
+        if (std::find(info.uses_left.begin(), info.uses_left.end(),
+                      use.node) == info.uses_left.end()) {
+          info.uses_left.push_back(use.node);
+        }
+      }
+      if (!valid || info.uses_left.empty() ||
+          !InputsLiveAfterPeak(graph, *node, op_completion_times, peak_time)) {
+        continue;
+      }
+      info.fitness = static_cast<double>(info.memory_used) /
+                     static_cast<double>(run_time->second.count());
+      candidates.push_back(std::move(info));
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // A recomputed node must not read a tensor that is itself recomputed,
+    // since that would keep the original alive past the peak.
+    std::unordered_set<const NodeDef*> recomputed_inputs;
+    for (const RematInfo& info : candidates) {
+      if (required_savings < 0) {
+        break;
+      }
+      const string& name = info.node->name();
+      if (nodes_to_recompute.count(name) > 0 ||
+          recomputed_inputs.count(info.node) > 0) {
+        continue;
+      }
+      bool reads_recomputed = false;
+      for (const string& input : info.node->input()) {
+        if (nodes_to_recompute.count(NodeName(input)) > 0) {
+          reads_recomputed = true;
+          break;
+        }
+      }
+      if (reads_recomputed) {
+        continue;
+      }
+      for (int i = 0; i < info.node->input_size(); ++i) {
+        if (!IsControlInput(info.node->input(i))) {
+          recomputed_inputs.insert(graph.GetNode(NodeName(info.node->input(i))));
+        }
+      }
+      std::vector<string>& uses = nodes_to_recompute[name];
+      for (const NodeDef* use : info.uses_left) {
+        uses.push_back(use->name());
+      }
+      VLOG(1) << "Will recompute " << name << " of size " << info.memory_used
+              << " for " << uses.size() << " uses after the peak on "
+              << device.first;
+      required_savings -= info.memory_used;
+    }
+  }
+  if (nodes_to_recompute.empty()) {
+    return false;
+  }
+
+  // Same bookkeeping as in RecomputationRewritingPass: sorting invalidates the
+  // NodeDef pointers, so nodes are looked up again by name afterwards.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return false;
+  }
+  NodeMap node_map(&item->graph);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < item->graph.node_size();
+       ++node_number) {
+    topological_numbering[item->graph.mutable_node(node_number)] =
+        item->graph.node_size() - node_number - 1;
+  }
+  for (const auto& recompute : nodes_to_recompute) {
+    std::unordered_set<const NodeDef*> recomputed_source_nodes = {
+        node_map.GetNode(recompute.first)};
+    std::unordered_set<NodeDef*> target_nodes;
+    for (const string& use : recompute.second) {
+      target_nodes.insert(node_map.GetNode(use));
+    }
+    RecomputeSubgraph(recomputed_source_nodes, target_nodes, node_map,
+                      topological_numbering, &item->graph);
+    // Make sure we won't try to recompute the same tensor in subsequent
+    // passes.
+    skip_list->insert(recompute.first);
+    skip_list->insert(
+        AddPrefixToNodeName(recompute.first, kRecomputedNodePrefix));
+  }
+  return true;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1422,6 +1677,18 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
         }
       }
 
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if ((optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
+           optimization_level_ == RewriterConfig::HEURISTICS) &&
+          recomputation_memory_budget_ > 0) {
+        if (BudgetedRecomputationPass(recomputation_memory_budget_, cluster,
+                                      &memory, &optimized_item, &skip_list)) {
+          // Reset the inferred memory usage since the graph changed.
+          memory.reset();
+          updated_graph = true;
+        }
+      }
+
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
@@ -33,11 +33,17 @@ class MemoryOptimizer : public GraphOptimizer {
   // recomputation_targets_name_scope: Name scope for potential outputs of
   //   recomputations. See
   //   RewriterConfig::memory_optimizer_target_node_name_scope.
+  // recomputation_memory_budget: Peak memory usage in bytes that the
+  //   recomputation heuristics try to reach, or 0 to only recompute nodes
+  //   feeding recomputation_targets_name_scope. See
+  //   RewriterConfig::memory_optimizer_recomputation_budget_bytes.
   explicit MemoryOptimizer(
       RewriterConfig::MemOptType optimization_level,
-      const string& recomputation_targets_name_scope = "gradients/")
+      const string& recomputation_targets_name_scope = "gradients/",
+      int64 recomputation_memory_budget = 0)
       : optimization_level_(optimization_level),
-        recomputation_targets_name_scope_(recomputation_targets_name_scope) {}
+        recomputation_targets_name_scope_(recomputation_targets_name_scope),
+        recomputation_memory_budget_(recomputation_memory_budget) {}
   ~MemoryOptimizer() override {}
 
   string name() const override { return "memory_optimizer"; };
@@ -53,6 +59,7 @@ class MemoryOptimizer : public GraphOptimizer {
  private:
   RewriterConfig::MemOptType optimization_level_;
   string recomputation_targets_name_scope_;
+  int64 recomputation_memory_budget_;
 };
 
 }  // end namespace grappler
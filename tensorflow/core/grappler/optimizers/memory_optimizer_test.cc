@@ -393,6 +393,56 @@ TEST_F(MemoryOptimizerTest, UnswappableInputs) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, BudgetedRecomputation) {
+  // "a" is used right away by "b" and again by "e" at the end of the chain, so
+  // it is live at the peak. None of the nodes are in a gradients/ scope.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/cpu:0"), {128, 128},
+                           DT_FLOAT);
+  Output a = ops::Sqrt(s.WithOpName("a").WithDevice("/cpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/cpu:0"), a);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/cpu:0"), b);
+  Output d = ops::Log(s.WithOpName("d").WithDevice("/cpu:0"), c);
+  Output e = ops::Mul(s.WithOpName("e").WithDevice("/cpu:0"), a, d);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 1.0f, {128, 128});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // Each activation takes 64KB, so the three live at the peak don't fit.
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                            "gradients/", 2 * 128 * 128 * 4);
+  GraphDef output;
+  Status status = optimizer.Optimize(cluster.get(), item, &output);
+  TF_EXPECT_OK(status);
+
+  NodeMap node_map(&output);
+  const NodeDef* recomputed_a = node_map.GetNode("Recomputed/a");
+  ASSERT_NE(nullptr, recomputed_a);
+  EXPECT_EQ("Sqrt", recomputed_a->op());
+  EXPECT_EQ("v", recomputed_a->input(0));
+  EXPECT_EQ("^RecomputeTrigger/a", recomputed_a->input(1));
+  const NodeDef* recompute_trigger_a = node_map.GetNode("RecomputeTrigger/a");
+  ASSERT_NE(nullptr, recompute_trigger_a);
+  EXPECT_EQ("^d", recompute_trigger_a->input(0));
+  const NodeDef* new_e = node_map.GetNode("e");
+  EXPECT_EQ("Recomputed/a", new_e->input(0));
+  EXPECT_EQ("d", new_e->input(1));
+  // The early use keeps reading the original tensor.
+  EXPECT_EQ("a", node_map.GetNode("b")->input(0));
+
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
 TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
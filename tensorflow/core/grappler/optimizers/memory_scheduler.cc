@@ -0,0 +1,327 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/memory_scheduler.h"
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/ascii.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Node-to-node edges of a graph, without duplicates.
+struct NodeEdges {
+  std::vector<int> data_fanins;
+  std::vector<int> data_fanouts;
+  // Data and control edges.
+  std::vector<int> fanins;
+  std::vector<int> fanouts;
+};
+
+void SortAndDeduplicate(std::vector<int>* nodes) {
+  std::sort(nodes->begin(), nodes->end());
+  nodes->erase(std::unique(nodes->begin(), nodes->end()), nodes->end());
+}
+
+Status BuildNodeEdges(const GraphDef& graph, std::vector<NodeEdges>* edges) {
+  absl::flat_hash_map<absl::string_view, int> node_index;
+  for (int i = 0; i < graph.node_size(); ++i) {
+    node_index[graph.node(i).name()] = i;
+  }
+  edges->assign(graph.node_size(), NodeEdges());
+  for (int i = 0; i < graph.node_size(); ++i) {
+    const NodeDef& node = graph.node(i);
+    NodeEdges& node_edges = (*edges)[i];
+    for (const string& input : node.input()) {
+      const TensorId tensor = ParseTensorName(input);
+      auto it = node_index.find(tensor.node());
+      if (it == node_index.end()) {
+        return errors::InvalidArgument("Node ", node.name(),
+                                       " has an unknown input ", input);
+      }
+      node_edges.fanins.push_back(it->second);
+      if (!IsControlInput(tensor)) {
+        node_edges.data_fanins.push_back(it->second);
+      }
+    }
+    SortAndDeduplicate(&node_edges.fanins);
+    SortAndDeduplicate(&node_edges.data_fanins);
+  }
+  for (int i = 0; i < graph.node_size(); ++i) {
+    for (int fanin : (*edges)[i].fanins) {
+      (*edges)[fanin].fanouts.push_back(i);
+    }
+    for (int fanin : (*edges)[i].data_fanins) {
+      (*edges)[fanin].data_fanouts.push_back(i);
+    }
+  }
+  return Status::OK();
+}
+
+// Returns the peak memory usage of running the nodes in `order` one at a time.
+int64 SimulatePeakBytes(const std::vector<int>& order,
+                        const std::vector<NodeEdges>& edges,
+                        const std::vector<int64>& output_bytes,
+                        const std::vector<bool>& persistent) {
+  std::vector<int> remaining_uses(edges.size());
+  for (int i = 0; i < edges.size(); ++i) {
+    remaining_uses[i] = edges[i].data_fanouts.size();
+  }
+  int64 live_bytes = 0;
+  int64 peak_bytes = 0;
+  for (int node : order) {
+    live_bytes += output_bytes[node];
+    peak_bytes = std::max(peak_bytes, live_bytes);
+    if (remaining_uses[node] == 0 && !persistent[node]) {
+      live_bytes -= output_bytes[node];
+    }
+    for (int fanin : edges[node].data_fanins) {
+      if (--remaining_uses[fanin] == 0 && !persistent[fanin]) {
+        live_bytes -= output_bytes[fanin];
+      }
+    }
+  }
+  return peak_bytes;
+}
+
+// Returns the order in which an executor running one node at a time would run
+// the nodes if it ran the ready nodes first in, first out.
+std::vector<int> DataflowOrder(const std::vector<NodeEdges>& edges) {
+  std::vector<int> pending_fanins(edges.size());
+  std::deque<int> ready;
+  for (int i = 0; i < edges.size(); ++i) {
+    pending_fanins[i] = edges[i].fanins.size();
+    if (pending_fanins[i] == 0) ready.push_back(i);
+  }
+  std::vector<int> order;
+  order.reserve(edges.size());
+  while (!ready.empty()) {
+    const int node = ready.front();
+    ready.pop_front();
+    order.push_back(node);
+    for (int fanout : edges[node].fanouts) {
+      if (--pending_fanins[fanout] == 0) ready.push_back(fanout);
+    }
+  }
+  return order;
+}
+
+// Returns the total size of the outputs of `node`, counting outputs of unknown
+// size as empty.
+int64 OutputBytes(const GraphProperties& properties, const NodeDef& node) {
+  if (!properties.HasOutputProperties(node.name())) return 0;
+  int64 bytes = 0;
+  for (const auto& output : properties.GetOutputProperties(node.name())) {
+    const PartialTensorShape shape(output.shape());
+    if (!shape.IsFullyDefined() || !DataTypeCanUseMemcpy(output.dtype())) {
+      continue;
+    }
+    bytes += shape.num_elements() * DataTypeSize(output.dtype());
+  }
+  return bytes;
+}
+
+bool IsOnGPU(const NodeDef& node) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(node.device(), &parsed) &&
+         parsed.has_type && absl::AsciiStrToUpper(parsed.type) == DEVICE_GPU;
+}
+
+bool HasFanin(const NodeDef& node, const string& fanin) {
+  for (const string& input : node.input()) {
+    if (NodeName(input) == fanin) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+Status ComputeMemoryMinimizingSchedule(const GraphDef& graph,
+                                       const std::vector<int64>& output_bytes,
+                                       const std::vector<bool>& persistent,
+                                       std::vector<int>* schedule,
+                                       int64* peak_bytes) {
+  std::vector<NodeEdges> edges;
+  TF_RETURN_IF_ERROR(BuildNodeEdges(graph, &edges));
+  const int num_nodes = graph.node_size();
+
+  std::vector<int> pending_fanins(num_nodes);
+  std::vector<int> remaining_uses(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    pending_fanins[i] = edges[i].fanins.size();
+    remaining_uses[i] = edges[i].data_fanouts.size();
+  }
+  std::vector<bool> scheduled(num_nodes, false);
+
+  // Bytes freed by running a node, net of the bytes it allocates: its inputs
+  // whose last use it is, and its own outputs if nothing reads them.
+  auto net_freed_bytes = [&](int node) {
+    int64 freed = -output_bytes[node];
+    if (remaining_uses[node] == 0 && !persistent[node]) {
+      freed += output_bytes[node];
+    }
+    for (int fanin : edges[node].data_fanins) {
+      if (remaining_uses[fanin] == 1 && !persistent[fanin]) {
+        freed += output_bytes[fanin];
+      }
+    }
+    return freed;
+  };
+
+  // Ready nodes keyed by (-net freed bytes, node index), so that the first
+  // entry frees the most memory, and ties keep the order of `graph`.
+  std::vector<int64> priority(num_nodes, 0);
+  std::set<std::pair<int64, int>> ready;
+  auto make_ready = [&](int node) {
+    priority[node] = net_freed_bytes(node);
+    ready.emplace(-priority[node], node);
+  };
+  for (int i = 0; i < num_nodes; ++i) {
+    if (pending_fanins[i] == 0) make_ready(i);
+  }
+
+  schedule->clear();
+  schedule->reserve(num_nodes);
+  while (!ready.empty()) {
+    const int node = ready.begin()->second;
+    ready.erase(ready.begin());
+    scheduled[node] = true;
+    schedule->push_back(node);
+
+    for (int fanin : edges[node].data_fanins) {
+      if (--remaining_uses[fanin] != 1 || persistent[fanin]) continue;
+      // The one remaining use of `fanin` now frees it.
+      for (int use : edges[fanin].data_fanouts) {
+        if (scheduled[use] || pending_fanins[use] > 0) continue;
+        ready.erase({-priority[use], use});
+        make_ready(use);
+      }
+    }
+    for (int fanout : edges[node].fanouts) {
+      if (--pending_fanins[fanout] == 0) make_ready(fanout);
+    }
+  }
+  if (static_cast<int>(schedule->size()) != num_nodes) {
+    return errors::InvalidArgument(
+        "The graph couldn't be sorted in topological order.");
+  }
+  *peak_bytes = SimulatePeakBytes(*schedule, edges, output_bytes, persistent);
+  return Status::OK();
+}
+
+Status MemoryMinimizingScheduler::Optimize(Cluster* cluster,
+                                           const GrapplerItem& item,
+                                           GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  bool has_gpu_nodes = false;
+  for (const NodeDef& node : item.graph.node()) {
+    // Nodes in loops run once per iteration, which a single schedule of the
+    // graph doesn't describe.
+    if (IsControlFlow(node)) {
+      return errors::Aborted("Graphs with control flow are not scheduled.");
+    }
+    has_gpu_nodes |= IsOnGPU(node);
+  }
+  if (!has_gpu_nodes) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/true, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+
+  std::unordered_set<string> fetches;
+  for (const string& fetch : item.fetch) {
+    fetches.insert(NodeName(fetch));
+  }
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item.feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  const int num_nodes = item.graph.node_size();
+  std::vector<int64> output_bytes(num_nodes);
+  std::vector<bool> persistent(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = item.graph.node(i);
+    output_bytes[i] = OutputBytes(properties, node);
+    persistent[i] = IsPersistent(node) || fetches.count(node.name()) > 0;
+  }
+
+  std::vector<NodeEdges> edges;
+  TF_RETURN_IF_ERROR(BuildNodeEdges(item.graph, &edges));
+  const int64 current_peak_bytes = SimulatePeakBytes(
+      DataflowOrder(edges), edges, output_bytes, persistent);
+
+  std::vector<int> schedule;
+  int64 peak_bytes;
+  TF_RETURN_IF_ERROR(ComputeMemoryMinimizingSchedule(
+      item.graph, output_bytes, persistent, &schedule, &peak_bytes));
+  if (peak_bytes >= current_peak_bytes) {
+    VLOG(1) << "The memory minimizing schedule doesn't lower the estimated "
+            << "peak of " << current_peak_bytes << " bytes";
+    return errors::Aborted("Nothing to do.");
+  }
+
+  // Chain consecutive nodes of each GPU. Fed nodes are left alone, since they
+  // are replaced when the graph is run.
+  std::unordered_map<string, int> last_node_on_device;
+  int num_edges_added = 0;
+  for (int node_index : schedule) {
+    NodeDef* node = optimized_graph->mutable_node(node_index);
+    if (!IsOnGPU(*node) || feeds.count(node->name()) > 0) continue;
+    auto it = last_node_on_device.find(node->device());
+    if (it != last_node_on_device.end()) {
+      const string& previous = optimized_graph->node(it->second).name();
+      if (!HasFanin(*node, previous)) {
+        node->add_input(AsControlDependency(previous));
+        ++num_edges_added;
+      }
+    }
+    last_node_on_device[node->device()] = node_index;
+  }
+  VLOG(1) << "Added " << num_edges_added << " control edges to lower the "
+          << "estimated peak memory usage from " << current_peak_bytes
+          << " to " << peak_bytes << " bytes";
+  return Status::OK();
+}
+
+void MemoryMinimizingScheduler::Feedback(Cluster* cluster,
+                                         const GrapplerItem& item,
+                                         const GraphDef& optimized_graph,
+                                         double result) {
+  // Nothing to do for MemoryMinimizingScheduler.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,64 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_SCHEDULER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_SCHEDULER_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Returns a topological order of `graph` that keeps the estimated peak memory
+// usage low, and sets `*peak_bytes` to that peak. `output_bytes[i]` is the
+// total size of the outputs of node i, which stay allocated until their last
+// data consumer has run. Nodes in `persistent` are never freed. The order is a
+// greedy list schedule in the style of XLA's: among the ready nodes it runs
+// the one that frees the most memory net of what it allocates, preferring the
+// earlier node in `graph` on ties.
+Status ComputeMemoryMinimizingSchedule(const GraphDef& graph,
+                                       const std::vector<int64>& output_bytes,
+                                       const std::vector<bool>& persistent,
+                                       std::vector<int>* schedule,
+                                       int64* peak_bytes);
+
+// Reorders the nodes placed on GPUs to reduce the peak memory usage of the
+// graph, by computing a schedule with ComputeMemoryMinimizingSchedule and
+// chaining consecutive nodes of each GPU with control edges. Kernels of a GPU
+// run on one compute stream, so this costs little parallelism there. CPU nodes
+// are left unconstrained. The graph is only changed if the new schedule has a
+// lower estimated peak than the current node order.
+class MemoryMinimizingScheduler : public GraphOptimizer {
+ public:
+  MemoryMinimizingScheduler() {}
+  ~MemoryMinimizingScheduler() override {}
+
+  string name() const override { return "memory_minimizing_scheduler"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_SCHEDULER_H_
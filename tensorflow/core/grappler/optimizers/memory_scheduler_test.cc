@@ -0,0 +1,105 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/memory_scheduler.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class MemoryMinimizingSchedulerTest : public GrapplerTest {
+ protected:
+  // Two independent branches that each expand `x` into a large tensor and
+  // reduce it again. Running them one after the other keeps two large
+  // tensors alive at a time, interleaving them keeps three.
+  static GrapplerItem TwoBranchItem(const string& device) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(device);
+    Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                                ops::Placeholder::Shape({16}));
+    Output a1 = ops::Tile(s.WithOpName("a1"), x, {1 << 16});
+    Output b1 = ops::Tile(s.WithOpName("b1"), x, {1 << 16});
+    Output a2 = ops::Exp(s.WithOpName("a2"), a1);
+    Output b2 = ops::Exp(s.WithOpName("b2"), b1);
+    Output ra = ops::Sum(s.WithOpName("ra"), a2, {0});
+    Output rb = ops::Sum(s.WithOpName("rb"), b2, {0});
+    Output fetch = ops::Add(s.WithOpName("fetch"), ra, rb);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+};
+
+TEST_F(MemoryMinimizingSchedulerTest, ComputesDepthFirstSchedule) {
+  GrapplerItem item = TwoBranchItem("/device:GPU:0");
+  std::vector<int64> output_bytes(item.graph.node_size(), 0);
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    const string& name = item.graph.node(i).name();
+    if (name == "a1" || name == "a2" || name == "b1" || name == "b2") {
+      output_bytes[i] = 1 << 20;
+    }
+  }
+  std::vector<int> schedule;
+  int64 peak_bytes;
+  TF_ASSERT_OK(ComputeMemoryMinimizingSchedule(
+      item.graph, output_bytes,
+      std::vector<bool>(item.graph.node_size(), false), &schedule,
+      &peak_bytes));
+  EXPECT_EQ(peak_bytes, 2 << 20);
+
+  std::unordered_map<string, int> position;
+  for (int i = 0; i < schedule.size(); ++i) {
+    position[item.graph.node(schedule[i]).name()] = i;
+  }
+  EXPECT_LT(position["a2"], position["b1"]);
+  EXPECT_LT(position["ra"], position["b1"]);
+}
+
+TEST_F(MemoryMinimizingSchedulerTest, ChainsGpuNodes) {
+  GrapplerItem item = TwoBranchItem("/device:GPU:0");
+
+  MemoryMinimizingScheduler optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* b1 = node_map.GetNode("b1");
+  ASSERT_NE(b1, nullptr);
+  EXPECT_EQ(b1->input(b1->input_size() - 1), "^ra");
+  // Data inputs are unchanged.
+  EXPECT_EQ(b1->input(0), "x");
+  EXPECT_EQ(node_map.GetNode("a2")->input(0), "a1");
+}
+
+TEST_F(MemoryMinimizingSchedulerTest, LeavesCpuNodesAlone) {
+  GrapplerItem item =
+      TwoBranchItem("/job:localhost/replica:0/task:0/device:CPU:0");
+
+  MemoryMinimizingScheduler optimizer;
+  GraphDef output;
+  EXPECT_EQ(optimizer.Optimize(nullptr, item, &output),
+            errors::Aborted("Nothing to do."));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
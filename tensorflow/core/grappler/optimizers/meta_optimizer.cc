@@ -40,10 +40,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/memory_scheduler.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/static_memory_planner.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
 #include "tensorflow/core/grappler/utils/canonicalizer.h"
 #include "tensorflow/core/grappler/utils/colocation.h"
@@ -53,6 +55,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -90,7 +99,9 @@ int NumIterations(const RewriterConfig& cfg) {
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
          name == "loop_optimizer" || name == "auto_mixed_precision" ||
-         name == "auto_mixed_precision_mkl";
+         name == "auto_mixed_precision_mkl" ||
+         name == "auto_mixed_precision_rocm_bf16" ||
+         name == "memory_minimizing_scheduler";
 }
 
 // Creates a function library stub from a real function library: copy only
@@ -165,6 +176,90 @@ bool MemoryOptimizerEnabled(
   return mem_opt_type != RewriterConfig::NO_MEM_OPT;
 }
 
+// Returns the path under `cache_dir` of the optimized graph for `item`. The
+// name is a fingerprint of everything the optimized graph depends on.
+string OptimizedGraphCachePath(const string& cache_dir,
+                               const GrapplerItem& item, const Cluster* cluster,
+                               ConfigProto config) {
+  // Moving the cache doesn't invalidate it.
+  config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_optimized_graph_cache_dir();
+  string key = strings::StrCat(TF_VERSION_STRING, ";", TF_GRAPH_DEF_VERSION);
+  string serialized;
+  SerializeToStringDeterministic(config, &serialized);
+  strings::StrAppend(&key, ";", serialized.size(), ":", serialized);
+  SerializeToStringDeterministic(item.graph, &serialized);
+  strings::StrAppend(&key, ";", serialized.size(), ":", serialized);
+  const auto append_names = [&key](const string& label,
+                                   std::vector<string> names) {
+    std::sort(names.begin(), names.end());
+    strings::StrAppend(&key, ";", label, ":", names.size());
+    for (const string& name : names) {
+      strings::StrAppend(&key, ",", name.size(), ":", name);
+    }
+  };
+  std::vector<string> feed_names;
+  for (const auto& feed : item.feed) feed_names.push_back(feed.first);
+  append_names("feed", std::move(feed_names));
+  // The order of the fetches matters to the optimizers that preserve them.
+  strings::StrAppend(&key, ";fetch:", absl::StrJoin(item.fetch, ","));
+  append_names("init_ops", item.init_ops);
+  append_names("keep_ops", item.keep_ops);
+  append_names("devices", {item.devices().begin(), item.devices().end()});
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  strings::StrAppend(&key, ";options:",
+                     options.allow_non_differentiable_rewrites,
+                     options.allow_pruning_stateful_and_dataset_ops,
+                     options.optimize_function_library, options.is_eager_mode);
+  if (cluster != nullptr) {
+    std::map<string, DeviceProperties> devices(cluster->GetDevices().begin(),
+                                               cluster->GetDevices().end());
+    for (const auto& device : devices) {
+      SerializeToStringDeterministic(device.second, &serialized);
+      strings::StrAppend(&key, ";", device.first, ":", serialized.size(), ":",
+                         serialized);
+    }
+  }
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return io::JoinPath(
+      cache_dir, strings::StrCat(strings::Hex(fingerprint.high64,
+                                              strings::kZeroPad16),
+                                 strings::Hex(fingerprint.low64,
+                                              strings::kZeroPad16),
+                                 ".pb"));
+}
+
+// Reads the optimized graph cached at `path`. Returns false if there is none
+// or it can't be read.
+bool ReadCachedOptimizedGraph(const string& path, GraphDef* optimized_graph) {
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  Status s = ReadBinaryProto(env, path, optimized_graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring unreadable cached optimized graph " << path
+                 << ": " << s;
+    optimized_graph->Clear();
+    return false;
+  }
+  return true;
+}
+
+// Stores `optimized_graph` at `path`. The graph is written to a temporary file
+// first, so that concurrent readers never see a partial graph.
+Status WriteCachedOptimizedGraph(const string& path,
+                                 const GraphDef& optimized_graph) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(string(io::Dirname(path))));
+  const string tmp_path =
+      strings::StrCat(path, ".tmp", strings::Hex(random::New64()));
+  Status s = WriteBinaryProto(env, tmp_path, optimized_graph);
+  if (s.ok()) s = env->RenameFile(tmp_path, path);
+  if (!s.ok()) env->DeleteFile(tmp_path).IgnoreError();
+  return s;
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, VALUE) \
@@ -191,14 +286,17 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
              cpu_device_,
              cfg_.experimental_disable_compressed_tensor_optimization()));
   MK_OPT("shape", new ShapeOptimizer());
-  MK_OPT("remap", new Remapper(cfg_.remapping()));
+  MK_OPT("remap", new Remapper(cfg_.remapping(), cost_profile_));
   MK_OPT("layout", new GenericLayoutOptimizer(
                        /*optimization level*/ cfg_.layout_optimizer(),
-                       /*CPU layout conversion*/ cfg_.cpu_layout_conversion()));
+                       /*CPU layout conversion*/ cfg_.cpu_layout_conversion(),
+                       cost_profile_));
   MK_OPT("auto_mixed_precision",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CUDA));
   MK_OPT("auto_mixed_precision_mkl",
          new AutoMixedPrecision(AutoMixedPrecisionMode::MKL));
+  MK_OPT("auto_mixed_precision_rocm_bf16",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::ROCM_BF16));
   MK_OPT("memory", new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination",
          new CommonSubgraphElimination(cfg_.common_subgraph_elimination()));
@@ -210,6 +308,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("scoped_allocator",
          new ScopedAllocatorOptimizer(cfg_.scoped_allocator_optimization(),
                                       cfg_.scoped_allocator_opts()));
+  MK_OPT("static_memory", new StaticMemoryPlanner());
+  MK_OPT("memory_schedule", new MemoryMinimizingScheduler());
   MK_OPT("pin_to_host",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
 
@@ -224,6 +324,16 @@ MetaOptimizer::MetaOptimizer(DeviceBase* cpu_device, const ConfigProto& cfg)
       cfg_(*config_proto_.mutable_graph_options()->mutable_rewrite_options()) {
   DCHECK(cpu_device_ == nullptr ||
          cpu_device_->attributes().device_type() == "CPU");
+  if (!cfg_.cost_profile_paths().empty()) {
+    auto cost_profile = std::make_shared<CostProfile>();
+    for (const string& path : cfg_.cost_profile_paths()) {
+      Status s = cost_profile->AddRunMetadataFile(path);
+      if (!s.ok()) {
+        LOG(WARNING) << "Ignoring cost profile " << path << ": " << s;
+      }
+    }
+    if (!cost_profile->runs().empty()) cost_profile_ = std::move(cost_profile);
+  }
 }
 
 Status MetaOptimizer::InitializeOptimizers(
@@ -266,11 +376,16 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::MKL));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_rocm_bf16())) {
+    optimizers->push_back(
+        MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::ROCM_BF16));
+  }
   if (cfg_.pin_to_host_optimization() == RewriterConfig::ON) {
     optimizers->push_back(MakeUnique<PinToHostOptimizer>());
   }
   if (cfg_.remapping() != RewriterConfig::OFF) {
-    optimizers->push_back(MakeUnique<Remapper>(cfg_.remapping()));
+    optimizers->push_back(
+        MakeUnique<Remapper>(cfg_.remapping(), cost_profile_));
   }
   if (cfg_.arithmetic_optimization() != RewriterConfig::OFF) {
     optimizers->push_back(
@@ -279,7 +394,7 @@ Status MetaOptimizer::InitializeOptimizers(
   if (cfg_.layout_optimizer() != RewriterConfig::OFF) {
     optimizers->push_back(MakeUnique<GenericLayoutOptimizer>(
         /*optimization level*/ cfg_.layout_optimizer(),
-        /*CPU layout conversion*/ cfg_.cpu_layout_conversion()));
+        /*CPU layout conversion*/ cfg_.cpu_layout_conversion(), cost_profile_));
   }
   if (cfg_.loop_optimization() != RewriterConfig::OFF) {
     optimizers->push_back(
@@ -292,24 +407,29 @@ Status MetaOptimizer::InitializeOptimizers(
   auto global_jit_level =
       config_proto_.graph_options().optimizer_options().global_jit_level();
   if (MemoryOptimizerEnabled(cfg_.memory_optimization(), global_jit_level)) {
-    if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
-          // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
-    } else {
-      optimizers->push_back(MakeUnique<MemoryOptimizer>(
-          cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
-    }
+    // Use the default target node name prefix "gradients/" unless set.
+    const string target_node_name_scope =
+        cfg_.memory_optimizer_target_node_name_scope().empty()
+            ? "gradients/"
+            : cfg_.memory_optimizer_target_node_name_scope();
+    optimizers->push_back(MakeUnique<MemoryOptimizer>(
+        cfg_.memory_optimization(), target_node_name_scope,
+        cfg_.memory_optimizer_recomputation_budget_bytes()));
   }
   if (cfg_.auto_parallel().enable()) {
     optimizers->push_back(
         MakeUnique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
   }
+  if (cfg_.memory_minimizing_schedule() == RewriterConfig::ON) {
+    optimizers->push_back(MakeUnique<MemoryMinimizingScheduler>());
+  }
   if (cfg_.scoped_allocator_optimization()) {
     optimizers->push_back(MakeUnique<ScopedAllocatorOptimizer>(
         cfg_.scoped_allocator_optimization(), cfg_.scoped_allocator_opts()));
   }
+  if (cfg_.static_memory_planning() == RewriterConfig::ON) {
+    optimizers->push_back(MakeUnique<StaticMemoryPlanner>());
+  }
   return InitializeCustomGraphOptimizers(std::set<string>(), optimizers);
 }
 
@@ -455,6 +575,7 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
 
   GraphOptimizationResult optimization_result(item.id);
   GraphOptimizer* sa_optimizer = nullptr;
+  GraphOptimizer* memory_planner = nullptr;
 
   // Constants in the graph are normally compressed after model_pruner.
   // Do it here if model pruner is disabled.
@@ -488,6 +609,10 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
         if (sa_optimizer == nullptr) sa_optimizer = optimizer.get();
         continue;
       }
+      if (optimizer->name() == "static_memory_planner") {
+        if (memory_planner == nullptr) memory_planner = optimizer.get();
+        continue;
+      }
 
       TF_RETURN_IF_ERROR(RunOptimizer(optimizer.get(), cluster, &item,
                                       optimized_graph, &optimization_result));
@@ -527,6 +652,14 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
   }
 
+  // StaticMemoryPlanner records the final shapes, and leaves the outputs that
+  // ScopedAllocatorOptimizer claimed alone.
+  if (memory_planner != nullptr) {
+    TF_RETURN_IF_ERROR(RunOptimizer(memory_planner, cluster, &item,
+                                    optimized_graph, &optimization_result));
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+  }
+
   bool is_optimized = std::find_if(optimization_result.results.begin(),
                                    optimization_result.results.end(),
                                    [](const OptimizerResult& result) {
@@ -534,7 +667,10 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -702,6 +838,18 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  // Reuse the result of optimizing the same graph before, if it was cached.
+  string cache_path;
+  if (!cfg_.optimized_graph_cache_dir().empty()) {
+    cache_path = OptimizedGraphCachePath(cfg_.optimized_graph_cache_dir(),
+                                         item, cluster, config_proto_);
+    if (ReadCachedOptimizedGraph(cache_path, optimized_graph)) {
+      VLOG(1) << "Using cached optimized graph " << cache_path
+              << " for grappler item: " << item.id;
+      return Status::OK();
+    }
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
@@ -783,12 +931,99 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // Propagate `_tf_data_function` attributes from functions to their callees.
   PropagateTFDataAttrs(flib, *optimized_graph->mutable_library());
 
+  // Optimizes the body of `func` into `optimized_func_graph`.
+  const auto optimize_function =
+      [&](const FunctionDef& func, GrapplerFunctionItem* func_item,
+          GraphDef* optimized_func_graph) -> Status {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    if (IsTPUGraphDef(*optimized_graph)) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      FunctionDefLibrary func_item_function_library;
+      func_item_function_library.Swap(func_item->graph.mutable_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, *func_item,
+                                              optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = *func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         optimized_func_graph);
+  };
+
+  // Replaces the function with its optimized body in `flib`.
+  const auto replace_function =
+      [&](const string& func_name, GrapplerFunctionItem* func_item,
+          GraphDef* optimized_func_graph) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    for (const FunctionDef& func_def :
+         optimized_func_graph->library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    func_item->SwapFunctionBody(std::move(*optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(*func_item, flib, &optimized_func));
+
+    // Replace optimized function with a new FunctionDef.
+    return flib.ReplaceFunction(func_name, optimized_func);
+  };
+
+  const int num_threads = cfg_.function_optimization_threads();
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    // Functions to optimize in this pass over the library. The library of
+    // the optimized graph is only updated at the end of the pass.
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
@@ -812,86 +1047,52 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       if (data::IsTFDataFunction(func)) continue;
 
       VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
+              << funcs.size() << " of "
               << optimized_graph->library().function_size() << "]";
 
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    if (num_threads > 1 && funcs.size() > 1) {
+      // Optimize the functions concurrently. Each one is optimized against
+      // the library as of the start of this pass, and the results are put
+      // back in the library in order afterwards.
+      std::vector<GrapplerFunctionItem> func_items(funcs.size());
+      std::vector<GraphDef> optimized_func_graphs(funcs.size());
+      std::vector<Status> statuses(funcs.size());
+      {
+        thread::ThreadPool pool(
+            Env::Default(), "grappler_function_optimization",
+            std::min<int>(num_threads, static_cast<int>(funcs.size())));
+        BlockingCounter counter(static_cast<int>(funcs.size()));
+        for (int i = 0; i < funcs.size(); ++i) {
+          pool.Schedule([&, i]() {
+            statuses[i] = optimize_function(*funcs[i], &func_items[i],
+                                            &optimized_func_graphs[i]);
+            counter.DecrementCount();
+          });
+        }
+        counter.Wait();
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (IsTPUGraphDef(*optimized_graph)) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        FunctionDefLibrary func_item_function_library;
-        func_item_function_library.Swap(func_item.graph.mutable_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+      for (int i = 0; i < funcs.size(); ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        TF_RETURN_IF_ERROR(replace_function(funcs[i]->signature().name(),
+                                            &func_items[i],
+                                            &optimized_func_graphs[i]));
       }
-
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
-        }
+    } else {
+      for (const FunctionDef* func : funcs) {
+        GrapplerFunctionItem func_item;
+        GraphDef optimized_func_graph;
+        TF_RETURN_IF_ERROR(
+            optimize_function(*func, &func_item, &optimized_func_graph));
+        TF_RETURN_IF_ERROR(replace_function(func->signature().name(),
+                                            &func_item, &optimized_func_graph));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -910,6 +1111,14 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
         *optimized_graph);
   }
 
+  if (!cache_path.empty()) {
+    Status s = WriteCachedOptimizedGraph(cache_path, *optimized_graph);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to cache optimized graph at " << cache_path
+                   << ": " << s;
+    }
+  }
+
   const uint64 end_us = Env::Default()->NowMicros();
   metrics::UpdateGrapplerPassTime("*", end_us - start_us);
 
@@ -952,8 +1161,12 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.debug_stripper() == RewriterConfig::ON ||
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.static_memory_planning() == RewriterConfig::ON ||
+         rewrite_cfg.memory_minimizing_schedule() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
+         AutoMixedPrecisionEnabled(
+             rewrite_cfg.auto_mixed_precision_rocm_bf16()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
@@ -20,10 +20,12 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/grappler/costs/cost_profile.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -109,6 +111,12 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
+  // Kernel times measured in earlier runs, read from
+  // `cfg_.cost_profile_paths()`. Null if no profile was given.
+  std::shared_ptr<const CostProfile> cost_profile_;
+
+  // Functions of the library may be optimized concurrently.
+  mutex optimization_results_mu_;
   std::vector<GraphOptimizationResult> optimization_results_;
 };
 
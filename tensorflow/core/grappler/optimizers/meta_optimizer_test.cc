@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -156,6 +157,52 @@ TEST_F(MetaOptimizerTest, RunsCustomOptimizer) {
   EXPECT_TRUE(TestOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, ReusesCachedOptimizedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "reuses_cached_optimized_graph");
+  int64 undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_optimized_graph_cache_dir(cache_dir);
+
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  // A new optimizer, e.g. in a restarted process, finds the cached graph.
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer cached_optimizer(nullptr, config_proto);
+  GraphDef cached_output;
+  TF_EXPECT_OK(cached_optimizer.Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // Changing what the graph is optimized for misses the cache.
+  item.fetch.push_back(item.graph.node(0).name());
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer fetch_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(fetch_optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  rewriter_config.set_min_graph_nodes(-2);
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer config_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(config_optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+}
+
 TEST_F(MetaOptimizerTest, RunsCustomOptimizerWithParams) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
   GrapplerItem item;
@@ -402,6 +449,94 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  using test::function::NDef;
+
+  // Define function library:
+  //
+  //   MyMul(x, y)    = x * y
+  //  *MySquare(x)    = MyMul(x, x)
+  //  *MyQuadratic(x) = MySquare(MySquare(x))
+  //
+  //  * - marked as noinline
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "my_mul:z:0"}});
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef quadratic_func = FunctionDefHelper::Create(
+      "MyQuadratic", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"square"}, "MySquare", {"x"}, {{"T", "$T"}}},
+       {{"quadratic"}, "MySquare", {"square:z"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "quadratic:z:0"}});
+  (*quadratic_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("b", "Placeholder", {}, {{"dtype", DT_INT32}}, kDevice),
+       NDef("square", "MySquare", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("quadratic", "MyQuadratic", {"b"}, {{"T", DT_INT32}}, kDevice),
+       NDef("out_s", "Identity", {"square:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_q", "Identity", {"quadratic:0"}, {{"T", DT_INT32}}, kDevice)},
+      /*funcs=*/
+      {mul_func, square_func, quadratic_func});
+
+  // Enable only function optimization.
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_function_optimization(RewriterConfig::ON);
+  rewriter_config.add_optimizers("function");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  MetaOptimizer sequential_optimizer(nullptr, config_proto);
+  GraphDef expected;
+  TF_EXPECT_OK(sequential_optimizer.Optimize(nullptr, item, &expected));
+
+  rewriter_config.set_function_optimization_threads(4);
+  MetaOptimizer parallel_optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(parallel_optimizer.Optimize(nullptr, item, &output));
+
+  // The same functions are specialized and optimized the same way.
+  FunctionLibraryDefinition expected_flib(OpRegistry::Global(),
+                                          expected.library());
+  FunctionLibraryDefinition optimized_flib(OpRegistry::Global(),
+                                           output.library());
+  EXPECT_EQ(5, optimized_flib.num_functions());
+  EXPECT_EQ(expected_flib.num_functions(), optimized_flib.num_functions());
+  for (const FunctionDef& func : expected.library().function()) {
+    const FunctionDef* optimized_func =
+        optimized_flib.Find(func.signature().name());
+    ASSERT_NE(optimized_func, nullptr) << func.signature().name();
+    EXPECT_TRUE(FunctionDefsEqual(func, *optimized_func))
+        << func.signature().name();
+  }
+
+  item.fetch = {"out_s", "out_q"};
+  item.feed.emplace_back("a", test::AsScalar<float>(2.0f));
+  item.feed.emplace_back("b", test::AsScalar<int>(4));
+  auto tensors_expected = EvaluateFetchNodes(item);
+
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
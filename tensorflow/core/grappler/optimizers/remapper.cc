@@ -59,6 +59,13 @@ namespace grappler {
 //   (1) FusedBatchNorm + <Activation>
 //   (2) FusedBatchNorm + SideInput + <Activation>
 //
+// BatchMatMul + ... -> FusedAttention (on GPU):
+//   (1) BatchMatMul + <Mul> + <Add> + Softmax + BatchMatMul
+//
+// Chains of elementwise ops -> _FusedElementwise (on GPU, with MLIR-generated
+// kernels):
+//   (1) Mul + Add + Tanh
+//
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
 // Both Conv2D and MatMul implemented as Tensor contraction (on CPU), so all the
@@ -69,6 +76,8 @@ constexpr char kFusedConv2D[] = "_FusedConv2D";
 constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
+constexpr char kFusedAttention[] = "FusedAttention";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
@@ -108,6 +117,32 @@ struct FusedBatchNormEx {
   int invalidated = kMissingIndex;
 };
 
+// Scaled dot-product attention: BatchMatMul(query, key^T), optionally scaled by
+// a constant and biased, followed by a Softmax and a BatchMatMul with values.
+struct Attention {
+  Attention() = default;
+
+  int qk_matmul = kMissingIndex;
+  int scale = kMissingIndex;
+  int bias_add = kMissingIndex;
+  int softmax = kMissingIndex;
+  int output_matmul = kMissingIndex;
+  // Input port of the bias in the `bias_add` node.
+  int bias_port = 0;
+  float scale_value = 1.0f;
+};
+
+// Tanh(Add(Mul(a, b), c)) without broadcasting.
+struct MulAddTanh {
+  MulAddTanh() = default;
+
+  int mul = kMissingIndex;
+  int add = kMissingIndex;
+  int tanh = kMissingIndex;
+  // Input port of the Mul in the `add` node.
+  int mul_port = 0;
+};
+
 // Contraction node followed by a BiasAdd.
 struct ContractionWithBiasAdd {
   ContractionWithBiasAdd() = default;
@@ -253,7 +288,7 @@ bool IsCpuCompatibleDataType(const NodeDef* contraction,
 bool IsGpuCompatibleDataType(const NodeDef* contraction,
                              const string& type_attr = "T") {
   DataType dtype = GetDataTypeFromAttr(*contraction, type_attr);
-  if (IsConv2D(*contraction)) {
+  if (IsConv2D(*contraction) || IsMatMul(*contraction)) {
     return dtype == DT_FLOAT;
   } else {
     return false;
@@ -293,6 +328,11 @@ bool IsCpuCompatibleMatMul(const NodeDef* matmul) {
   return NodeIsOnCpu(matmul) && IsCpuCompatibleDataType(matmul);
 }
 
+bool IsGpuCompatibleMatMul(const NodeDef* matmul) {
+  DCHECK(IsMatMul(*matmul)) << "Expected MatMul op";
+  return NodeIsOnGpu(matmul) && IsGpuCompatibleDataType(matmul);
+}
+
 bool IsCpuCompatibleDepthwiseConv2dNative(const NodeDef* dw_conv2d) {
   DCHECK(IsDepthwiseConv2dNative(*dw_conv2d))
       << "Expected DepthwiseConv2dNative op";
@@ -321,15 +361,21 @@ bool IsCpuCompatible(const RemapperContext& ctx, const Pattern& matched) {
   }
 }
 
-// Checks if we can rewrite a pattern to the `_FusedConv2D` on GPU device.
+// Checks if we can rewrite a pattern to the `_Fused{Conv2D,MatMul}` on GPU
+// device.
 bool IsGpuCompatible(const RemapperContext& ctx,
                      const ContractionWithBiasAddAndActivation& matched) {
+  const GraphDef* graph = ctx.graph_view.graph();
+  const NodeDef& contraction_node = graph->node(matched.contraction);
+  // _FusedMatMul applies the bias and any supported activation in a single
+  // epilogue kernel after the GEMM.
+  if (IsMatMul(contraction_node)) {
+    return IsGpuCompatibleMatMul(&contraction_node);
+  }
 #if TENSORFLOW_USE_ROCM
   // ROCm does not support _FusedConv2D
   return false;
 #endif
-  const GraphDef* graph = ctx.graph_view.graph();
-  const NodeDef& contraction_node = graph->node(matched.contraction);
   if (!IsConv2D(contraction_node)) return false;
 
   const std::vector<OpInfo::TensorProperties>& input_props =
@@ -355,7 +401,9 @@ bool IsGpuCompatible(const RemapperContext& ctx,
 }
 bool IsGpuCompatible(const RemapperContext& ctx,
                      const ContractionWithBiasAdd& matched) {
-  return false;
+  const NodeDef& contraction_node =
+      ctx.graph_view.graph()->node(matched.contraction);
+  return IsMatMul(contraction_node) && IsGpuCompatibleMatMul(&contraction_node);
 }
 bool IsGpuCompatible(const RemapperContext& ctx,
                      const ContractionWithSqueezeAndBiasAdd& matched) {
@@ -377,6 +425,10 @@ bool IsSupportedActivation(const NodeDef& node) {
 #endif
 }
 
+bool IsBatchMatMul(const NodeDef& node) {
+  return node.op() == "BatchMatMul" || node.op() == "BatchMatMulV2";
+}
+
 inline bool HasControlFaninOrFanout(const utils::MutableNodeView& node_view) {
   return node_view.NumControllingFanins() > 0 ||
          node_view.NumControlledFanouts() > 0;
@@ -811,6 +863,221 @@ bool FindFusedBatchNorm(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Returns the value of the boolean attribute `attr_name`, or false if the node
+// does not have it.
+bool GetBoolAttrOrFalse(const NodeDef& node, const string& attr_name) {
+  bool value = false;
+  return TryGetNodeAttr(node, attr_name, &value) && value;
+}
+
+// Returns true if `node` is a Const with a scalar float or double value, and
+// stores the value in `scalar`.
+bool GetScalarConstant(const NodeDef& node, float* scalar) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) return false;
+  Tensor value;
+  if (!value.FromProto(node.attr().at("value").tensor())) return false;
+  if (value.dims() != 0) return false;
+  if (value.dtype() == DT_FLOAT) {
+    *scalar = value.scalar<float>()();
+  } else if (value.dtype() == DT_DOUBLE) {
+    *scalar = static_cast<float>(value.scalar<double>()());
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool FindAttention(const RemapperContext& ctx, int node_index,
+                   Attention* matched) {
+  // Root of the pattern must be the BatchMatMul with the values.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsBatchMatMul(*node_def) || HasControlFaninOrFanout(*node_view))
+    return false;
+  if (GetBoolAttrOrFalse(*node_def, "adj_x") ||
+      GetBoolAttrOrFalse(*node_def, "adj_y"))
+    return false;
+
+  // FusedAttention only has a tiled kernel on GPU. On CPU the unfused
+  // BatchMatMuls are as fast for the sequence lengths seen in practice.
+  if (!NodeIsOnGpu(node_def)) return false;
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+
+  // Every node between the two BatchMatMuls must be consumed only by the next
+  // node of the pattern.
+  const auto is_fusable = [&](const utils::MutableNodeView& view) -> bool {
+    return !HasControlFaninOrFanout(view) && HasAtMostOneFanoutAtPort0(view) &&
+           !IsInPreserveSet(ctx, view.node()) &&
+           HaveSameDataType(node_def, view.node());
+  };
+
+  if (node_view->NumRegularFanins() != 2) return false;
+  const auto* softmax = node_view->GetRegularFanin(0).node_view();
+  if (!IsSoftmax(*softmax->node()) || !is_fusable(*softmax)) return false;
+
+  Attention pattern;
+  pattern.output_matmul = node_index;
+  pattern.softmax = softmax->node_index();
+
+  const auto* scores = softmax->GetRegularFanin(0).node_view();
+  if (IsAdd(*scores->node())) {
+    if (!is_fusable(*scores) || scores->NumRegularFanins() != 2) return false;
+    // The bias can be on either side of the Add.
+    const auto* lhs = scores->GetRegularFanin(0).node_view()->node();
+    const int scores_port = IsMul(*lhs) || IsBatchMatMul(*lhs) ? 0 : 1;
+    pattern.bias_add = scores->node_index();
+    pattern.bias_port = 1 - scores_port;
+    scores = scores->GetRegularFanin(scores_port).node_view();
+  }
+
+  if (IsMul(*scores->node())) {
+    if (!is_fusable(*scores) || scores->NumRegularFanins() != 2) return false;
+    for (int port = 0; port < 2; ++port) {
+      const auto* factor = scores->GetRegularFanin(port).node_view()->node();
+      if (GetScalarConstant(*factor, &pattern.scale_value)) {
+        pattern.scale = scores->node_index();
+        scores = scores->GetRegularFanin(1 - port).node_view();
+        break;
+      }
+    }
+    if (pattern.scale == kMissingIndex) return false;
+  }
+
+  const auto* qk_matmul = scores;
+  if (!IsBatchMatMul(*qk_matmul->node()) || !is_fusable(*qk_matmul)) {
+    return false;
+  }
+  if (GetBoolAttrOrFalse(*qk_matmul->node(), "adj_x") ||
+      !GetBoolAttrOrFalse(*qk_matmul->node(), "adj_y"))
+    return false;
+  pattern.qk_matmul = qk_matmul->node_index();
+
+  // FusedAttention needs 4-D query, key and value with the same batch and head
+  // dimensions, i.e. BatchMatMul must not broadcast.
+  const auto& qk_props =
+      ctx.graph_properties.GetInputProperties(qk_matmul->GetName());
+  const auto& output_props =
+      ctx.graph_properties.GetInputProperties(node_def->name());
+  if (qk_props.size() != 2 || output_props.size() != 2) return false;
+  const TensorShapeProto& query = qk_props[0].shape();
+  const TensorShapeProto& key = qk_props[1].shape();
+  const TensorShapeProto& value = output_props[1].shape();
+  if (Rank(query) != 4 || Rank(key) != 4 || Rank(value) != 4) return false;
+
+  const auto same_dim = [](const TensorShapeProto::Dim& lhs,
+                           const TensorShapeProto::Dim& rhs) -> bool {
+    return IsKnownSymbolically(lhs) && lhs.size() == rhs.size();
+  };
+  for (int i = 0; i < 2; ++i) {
+    if (!same_dim(query.dim(i), key.dim(i)) ||
+        !same_dim(query.dim(i), value.dim(i)))
+      return false;
+  }
+
+  // The bias may only broadcast over batch, heads and query rows, and must not
+  // broadcast the attention logits.
+  if (pattern.bias_add != kMissingIndex) {
+    const auto& bias_props = ctx.graph_properties.GetInputProperties(
+        ctx.graph_view.GetNode(pattern.bias_add)->GetName());
+    if (bias_props.size() != 2) return false;
+    const TensorShapeProto& bias = bias_props[pattern.bias_port].shape();
+    if (Rank(bias) != 4) return false;
+    for (int i = 0; i < 3; ++i) {
+      const bool broadcast = IsKnown(bias.dim(i)) && bias.dim(i).size() == 1;
+      if (!broadcast && !same_dim(bias.dim(i), query.dim(i))) return false;
+    }
+    if (!same_dim(bias.dim(3), key.dim(2))) return false;
+  }
+
+  *matched = pattern;
+  return true;
+}
+
+// Builds the _FusedElementwise node that replaces the matched Mul+Add+Tanh.
+void BuildMulAddTanhNode(const GraphDef& graph, const MulAddTanh& matched,
+                         NodeDef* fused_op) {
+  const NodeDef& mul = graph.node(matched.mul);
+  const NodeDef& add = graph.node(matched.add);
+  const NodeDef& tanh = graph.node(matched.tanh);
+
+  fused_op->set_op(kFusedElementwise);
+  fused_op->set_name(tanh.name());
+  fused_op->set_device(tanh.device());
+
+  fused_op->add_input(mul.input(0));
+  fused_op->add_input(mul.input(1));
+  fused_op->add_input(add.input(1 - matched.mul_port));
+
+  auto* attrs = fused_op->mutable_attr();
+  (*attrs)["T"] = tanh.attr().at("T");
+  SetAttrValue(3, &(*attrs)["num_args"]);
+  SetAttrValue(absl::Span<const string>({"Mul", "AddV2", "Tanh"}),
+               &(*attrs)["fused_ops"]);
+}
+
+bool FindMulAddTanh(const RemapperContext& ctx, int node_index,
+                    MulAddTanh* matched) {
+  // Root of the pattern must be a Tanh.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsTanh(*node_def) || HasControlFaninOrFanout(*node_view)) return false;
+
+  // Only the GPU has generated kernels for chains of elementwise ops. On CPU
+  // Eigen already evaluates each op in a single pass over the inputs.
+  if (!NodeIsOnGpu(node_def)) return false;
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_HALF && dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+
+  const auto is_fusable = [&](const utils::MutableNodeView& view) -> bool {
+    return !HasControlFaninOrFanout(view) && HasAtMostOneFanoutAtPort0(view) &&
+           !IsInPreserveSet(ctx, view.node()) &&
+           HaveSameDataType(node_def, view.node()) &&
+           view.NumRegularFanins() == 2;
+  };
+
+  if (node_view->NumRegularFanins() != 1) return false;
+  const auto* add = node_view->GetRegularFanin(0).node_view();
+  if (!IsAdd(*add->node()) || !is_fusable(*add)) return false;
+
+  MulAddTanh pattern;
+  pattern.tanh = node_index;
+  pattern.add = add->node_index();
+
+  // The Mul can be on either side of the Add.
+  const utils::MutableNodeView* mul = nullptr;
+  for (int port = 0; port < 2 && mul == nullptr; ++port) {
+    const auto* fanin = add->GetRegularFanin(port).node_view();
+    if (IsMul(*fanin->node()) && is_fusable(*fanin)) {
+      mul = fanin;
+      pattern.mul_port = port;
+    }
+  }
+  if (mul == nullptr) return false;
+  pattern.mul = mul->node_index();
+
+  // The generated kernel does not broadcast, so all three operands must have
+  // the same shape.
+  const auto& mul_props =
+      ctx.graph_properties.GetInputProperties(mul->GetName());
+  const auto& add_props =
+      ctx.graph_properties.GetInputProperties(add->GetName());
+  if (mul_props.size() != 2 || add_props.size() != 2) return false;
+  if (!ShapesSymbolicallyEqual(mul_props[0], mul_props[1]) ||
+      !ShapesSymbolicallyEqual(mul_props[0],
+                               add_props[1 - pattern.mul_port]))
+    return false;
+
+  // The kernels are only linked in when TensorFlow is built with the MLIR
+  // generated GPU kernels.
+  NodeDef fused_op;
+  BuildMulAddTanhNode(*ctx.graph_view.graph(), pattern, &fused_op);
+  if (!IsKernelRegisteredForNode(fused_op).ok()) return false;
+
+  *matched = pattern;
+  return true;
+}
+
 // NOTE(ezhulenev): See `BatchnormSpatialPersistentEnabled` documentation in the
 // `tensorflow/stream_executor/cuda/cuda_dnn.cc` for details.
 bool BatchnormSpatialPersistentEnabled() {
@@ -1441,6 +1708,88 @@ Status AddFusedBatchNormExNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddFusedAttentionNode(RemapperContext* ctx, const Attention& matched,
+                             std::vector<bool>* invalidated_nodes,
+                             std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& qk_matmul = graph->node(matched.qk_matmul);
+  const NodeDef& output_matmul = graph->node(matched.output_matmul);
+
+  VLOG(2) << "Fuse attention:"
+          << " qk_matmul=" << qk_matmul.name() << " bias_add="
+          << (matched.bias_add != kMissingIndex
+                  ? graph->node(matched.bias_add).name()
+                  : "<none>")
+          << " scale=" << matched.scale_value
+          << " output_matmul=" << output_matmul.name();
+
+  NodeDef fused_op;
+  fused_op.set_op(kFusedAttention);
+  fused_op.set_name(output_matmul.name());
+  fused_op.set_device(output_matmul.device());
+
+  fused_op.add_input(qk_matmul.input(0));      // 0: query
+  fused_op.add_input(qk_matmul.input(1));      // 1: key
+  fused_op.add_input(output_matmul.input(1));  // 2: value
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)["T"] = output_matmul.attr().at("T");
+  if (matched.bias_add != kMissingIndex) {
+    const NodeDef& bias_add = graph->node(matched.bias_add);
+    fused_op.add_input(bias_add.input(matched.bias_port));  // 3: bias
+    SetAttrValue(1, &(*attrs)["num_bias"]);
+  } else {
+    SetAttrValue(0, &(*attrs)["num_bias"]);
+  }
+  SetAttrValue(matched.scale_value, &(*attrs)["scale"]);
+  SetAttrValue(0.0f, &(*attrs)["dropout_rate"]);
+  SetAttrValue(0, &(*attrs)["seed"]);
+  SetAttrValue(0, &(*attrs)["seed2"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output_matmul] = true;
+  (*nodes_to_delete)[matched.softmax] = true;
+  (*nodes_to_delete)[matched.qk_matmul] = true;
+  if (matched.scale != kMissingIndex) {
+    (*nodes_to_delete)[matched.scale] = true;
+  }
+  if (matched.bias_add != kMissingIndex) {
+    (*nodes_to_delete)[matched.bias_add] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddFusedElementwiseNode(RemapperContext* ctx, const MulAddTanh& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  VLOG(2) << "Fuse elementwise Mul+Add+Tanh:"
+          << " mul=" << graph->node(matched.mul).name()
+          << " add=" << graph->node(matched.add).name()
+          << " tanh=" << graph->node(matched.tanh).name();
+
+  NodeDef fused_op;
+  BuildMulAddTanhNode(*graph, matched, &fused_op);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.tanh] = true;
+  (*nodes_to_delete)[matched.add] = true;
+  (*nodes_to_delete)[matched.mul] = true;
+
+  return Status::OK();
+}
+
 Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
   const GraphDef* graph = ctx->graph_view.graph();
   const NodeDef& fused_node = graph->node(matched.fused_batch_norm);
@@ -1688,6 +2037,8 @@ bool IsContractionWithAdd(const RemapperContext& ctx, int node_index) {
 //   (2) Fusing side input and/or activation into FusedBatchNorm.
 //   (3) Fusing Conv2D biasadd and relu on GPU
 //   (4) INTEL_MKL specific: Conv2D -> Add or Conv2D -> BiasAdd -> Add.
+//   (5) Fusing scaled dot-product attention into FusedAttention.
+//   (6) Fusing Mul+Add+Tanh into _FusedElementwise.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -1758,13 +2109,29 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for an attention fusion.
+  const auto is_attention_candidate = [&]() -> bool {
+    if (!IsBatchMatMul(*node_def)) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    return IsSoftmax(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
+  // Candidate for an elementwise fusion.
+  const auto is_mul_add_tanh_candidate = [&]() -> bool {
+    if (!IsTanh(*node_def)) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    return IsAdd(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
 #ifdef INTEL_MKL
   (void)is_relu_biasadd_conv2d_candidate;  // To fix unused variable error.
   return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
+         is_attention_candidate() || is_mul_add_tanh_candidate() ||
          IsContractionWithAdd(ctx, node_index);
 #else
   return is_relu_biasadd_conv2d_candidate() || is_batch_norm_candidate() ||
-         is_batch_norm_fusion_candidate();
+         is_batch_norm_fusion_candidate() || is_attention_candidate() ||
+         is_mul_add_tanh_candidate();
 #endif  // INTEL_MKL
 }
 
@@ -1792,6 +2159,42 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool allow_non_differentiable_rewrites =
       item.optimization_options().allow_non_differentiable_rewrites;
 
+  // Returns true if the cost profile measured the `fused_op` that takes the
+  // name of `named_node` to be slower than the `nodes` it replaces. Fusions
+  // are applied unless the profile has all of them.
+  const auto profile_rejects_fusion =
+      [&](int named_node, const string& fused_op,
+          std::initializer_list<int> nodes) -> bool {
+    if (cost_profile_ == nullptr) return false;
+    const string& fused_name = ctx.graph_view.GetNode(named_node)->GetName();
+    int64 fused_micros;
+    if (!cost_profile_->GetNodeTime(fused_name, fused_op, &fused_micros)) {
+      return false;
+    }
+    int64 unfused_micros = 0;
+    for (int node : nodes) {
+      if (node == kMissingIndex) continue;
+      const NodeDef* node_def = ctx.graph_view.GetNode(node)->node();
+      int64 node_micros;
+      if (!cost_profile_->GetNodeTime(node_def->name(), node_def->op(),
+                                      &node_micros)) {
+        return false;
+      }
+      unfused_micros += node_micros;
+    }
+    const bool rejected = fused_micros > unfused_micros;
+    LOG(INFO) << (rejected ? "Skipping" : "Applying") << " the fusion into "
+              << fused_op << " at " << fused_name << ": it took "
+              << fused_micros << "us fused and " << unfused_micros
+              << "us unfused in the cost profile";
+    return rejected;
+  };
+  // Name of the fused op the `contraction` node is remapped to.
+  const auto fused_contraction_op = [&ctx](int contraction) {
+    return strings::StrCat("_Fused",
+                           ctx.graph_view.GetNode(contraction)->GetOp());
+  };
+
   for (int i = num_nodes - 1; i >= 0; --i) {
     // Check if node was invalidated by one of the previous remaps.
     if (invalidated_nodes[i] || nodes_to_delete[i]) {
@@ -1849,7 +2252,11 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     // _Fused{Conv2D,DepthwiseConv2dNative,MatMul}
     ContractionWithBiasAdd contract_with_bias;
     if (allow_non_differentiable_rewrites &&
-        FindContractionWithBias(ctx, i, &contract_with_bias)) {
+        FindContractionWithBias(ctx, i, &contract_with_bias) &&
+        !profile_rejects_fusion(
+            contract_with_bias.bias_add,
+            fused_contraction_op(contract_with_bias.contraction),
+            {contract_with_bias.contraction, contract_with_bias.bias_add})) {
       TF_RETURN_IF_ERROR(AddFusedContractionNode(
           &ctx, contract_with_bias, &invalidated_nodes, &nodes_to_delete));
       continue;
@@ -1860,7 +2267,13 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     ContractionWithBiasAddAndActivation contract_with_bias_and_activation;
     if (allow_non_differentiable_rewrites &&
         FindContractionWithBiasAndActivation(
-            ctx, i, &contract_with_bias_and_activation)) {
+            ctx, i, &contract_with_bias_and_activation) &&
+        !profile_rejects_fusion(
+            contract_with_bias_and_activation.activation,
+            fused_contraction_op(contract_with_bias_and_activation.contraction),
+            {contract_with_bias_and_activation.contraction,
+             contract_with_bias_and_activation.bias_add,
+             contract_with_bias_and_activation.activation})) {
       TF_RETURN_IF_ERROR(
           AddFusedContractionNode(&ctx, contract_with_bias_and_activation,
                                   &invalidated_nodes, &nodes_to_delete));
@@ -1887,7 +2300,12 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     // Remap Conv2D+FusedBatchNorm into the _FusedConv2D;
     ContractionWithBatchNorm contract_with_batch_norm;
     if (allow_non_differentiable_rewrites &&
-        FindConv2DWithBatchNorm(ctx, i, &contract_with_batch_norm)) {
+        FindConv2DWithBatchNorm(ctx, i, &contract_with_batch_norm) &&
+        !profile_rejects_fusion(
+            contract_with_batch_norm.fused_batch_norm,
+            fused_contraction_op(contract_with_batch_norm.contraction),
+            {contract_with_batch_norm.contraction,
+             contract_with_batch_norm.fused_batch_norm})) {
       TF_RETURN_IF_ERROR(AddFusedConv2DNode(&ctx, contract_with_batch_norm,
                                             &invalidated_nodes,
                                             &nodes_to_delete));
@@ -1899,7 +2317,14 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
         contract_with_batch_norm_and_activation;
     if (allow_non_differentiable_rewrites &&
         FindConv2DWithBatchNormAndActivation(
-            ctx, i, &contract_with_batch_norm_and_activation)) {
+            ctx, i, &contract_with_batch_norm_and_activation) &&
+        !profile_rejects_fusion(
+            contract_with_batch_norm_and_activation.activation,
+            fused_contraction_op(
+                contract_with_batch_norm_and_activation.contraction),
+            {contract_with_batch_norm_and_activation.contraction,
+             contract_with_batch_norm_and_activation.fused_batch_norm,
+             contract_with_batch_norm_and_activation.activation})) {
       TF_RETURN_IF_ERROR(
           AddFusedConv2DNode(&ctx, contract_with_batch_norm_and_activation,
                              &invalidated_nodes, &nodes_to_delete));
@@ -1910,12 +2335,49 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     // Remap FusedBatchNorm+<SideInput>+<Activation> into the _FusedBatchNormEx.
     FusedBatchNormEx fused_batch_norm_ex;
     if (allow_non_differentiable_rewrites &&
-        FindFusedBatchNormEx(ctx, i, &fused_batch_norm_ex)) {
+        FindFusedBatchNormEx(ctx, i, &fused_batch_norm_ex) &&
+        !profile_rejects_fusion(fused_batch_norm_ex.fused_batch_norm,
+                                "_FusedBatchNormEx",
+                                {fused_batch_norm_ex.fused_batch_norm,
+                                 fused_batch_norm_ex.invalidated,
+                                 fused_batch_norm_ex.activation})) {
       TF_RETURN_IF_ERROR(AddFusedBatchNormExNode(
           &ctx, fused_batch_norm_ex, &invalidated_nodes, &nodes_to_delete));
       continue;
     }
 
+    // Remap BatchMatMul+<Mul>+<Add>+Softmax+BatchMatMul into FusedAttention.
+    // Like the other fusions, this is only safe if the graph is not
+    // differentiated later: the gradients of the unfused ops read the Softmax
+    // output that the fusion removes.
+    Attention attention;
+    if (allow_non_differentiable_rewrites &&
+        FindAttention(ctx, i, &attention) &&
+        !profile_rejects_fusion(
+            attention.output_matmul, kFusedAttention,
+            {attention.qk_matmul, attention.scale, attention.bias_add,
+             attention.softmax, attention.output_matmul})) {
+      TF_RETURN_IF_ERROR(AddFusedAttentionNode(&ctx, attention,
+                                               &invalidated_nodes,
+                                               &nodes_to_delete));
+      continue;
+    }
+
+    // Remap Mul+Add+Tanh into _FusedElementwise, which runs the chain as a
+    // single generated kernel. _FusedElementwise has no gradient, so this is
+    // only safe if the graph is not differentiated later.
+    MulAddTanh mul_add_tanh;
+    if (allow_non_differentiable_rewrites &&
+        FindMulAddTanh(ctx, i, &mul_add_tanh) &&
+        !profile_rejects_fusion(
+            mul_add_tanh.tanh, kFusedElementwise,
+            {mul_add_tanh.mul, mul_add_tanh.add, mul_add_tanh.tanh})) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(&ctx, mul_add_tanh,
+                                                 &invalidated_nodes,
+                                                 &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_H_
 
+#include <memory>
+
+#include "tensorflow/core/grappler/costs/cost_profile.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
@@ -27,6 +30,11 @@ namespace grappler {
 class Remapper : public GraphOptimizer {
  public:
   explicit Remapper(RewriterConfig::Toggle opt_level) : opt_level_(opt_level) {}
+  // Fusions that `cost_profile` measured to be slower than the nodes they
+  // replace are skipped. May be null.
+  Remapper(RewriterConfig::Toggle opt_level,
+           std::shared_ptr<const CostProfile> cost_profile)
+      : opt_level_(opt_level), cost_profile_(std::move(cost_profile)) {}
 
   ~Remapper() override {}
 
@@ -42,6 +50,7 @@ class Remapper : public GraphOptimizer {
 
  private:
   RewriterConfig::Toggle opt_level_;
+  std::shared_ptr<const CostProfile> cost_profile_;
 };
 
 }  // end namespace grappler
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -390,6 +391,79 @@ TEST_F(RemapperTest, FuseConv2DWithBias) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+// Returns a profile of two runs: one of the unfused `conv` and `bias_add`,
+// and one where `bias_add` ran as the fused `fused_op`.
+std::shared_ptr<const CostProfile> ConvBiasAddProfile(int64 conv_micros,
+                                                      int64 bias_add_micros,
+                                                      int64 fused_micros) {
+  const auto add_node_stats = [](StepStats* step_stats, const string& name,
+                                 const string& op, int64 micros) {
+    DeviceStepStats* dev_stats = step_stats->add_dev_stats();
+    dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+    NodeExecStats* node_stats = dev_stats->add_node_stats();
+    node_stats->set_node_name(name);
+    node_stats->set_timeline_label(strings::StrCat(name, " = ", op, "()"));
+    node_stats->set_op_start_rel_micros(0);
+    node_stats->set_op_end_rel_micros(micros);
+  };
+  auto profile = std::make_shared<CostProfile>();
+  StepStats unfused;
+  add_node_stats(&unfused, "conv", "Conv2D", conv_micros);
+  add_node_stats(&unfused, "bias_add", "BiasAdd", bias_add_micros);
+  profile->AddStepStats(unfused);
+  StepStats fused;
+  add_node_stats(&fused, "bias_add", "_FusedConv2D", fused_micros);
+  profile->AddStepStats(fused);
+  return profile;
+}
+
+TEST_F(RemapperTest, FuseConv2DWithBiasFollowsCostProfile) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({8, 32, 32, 3});
+  auto filter_shape = ops::Placeholder::Shape({1, 1, 3, 128});
+  auto bias_shape = ops::Placeholder::Shape({128});
+
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT, input_shape);
+  auto filter = Placeholder(s.WithOpName("filter"), DT_FLOAT, filter_shape);
+  auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT, bias_shape);
+
+  std::vector<int> strides = {1, 1, 1, 1};
+  auto conv = ops::Conv2D(s.WithOpName("conv"), input, filter, strides, "SAME");
+  auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), bias_add);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  const auto fused_op = [&item](
+                            std::shared_ptr<const CostProfile> profile) {
+    Remapper optimizer(RewriterConfig::ON, std::move(profile));
+    GraphDef output;
+    TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+    for (const NodeDef& node : output.node()) {
+      if (node.name() == "bias_add") return node.op();
+    }
+    return string();
+  };
+
+  // The fusion is skipped only when it was measured to be slower.
+  EXPECT_EQ(fused_op(ConvBiasAddProfile(30, 10, 50)), "BiasAdd");
+  EXPECT_EQ(fused_op(ConvBiasAddProfile(30, 10, 35)), "_FusedConv2D");
+  // Without a measurement of the fused op it is applied.
+  auto unfused_only = std::make_shared<CostProfile>();
+  unfused_only->AddStepStats(StepStats());
+  EXPECT_EQ(fused_op(unfused_only), "_FusedConv2D");
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -1005,5 +1079,228 @@ TEST_F(RemapperTest, FuseConv2DWithSqueezeAndBias) {
 }
 #endif  // !INTEL_MKL
 
+TEST_F(RemapperTest, FuseAttention) {
+  using ::tensorflow::ops::Placeholder;
+
+  for (bool with_bias : {false, true}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    TensorShape qkv_shape({2, 4, 16, 8});
+    TensorShape bias_shape({2, 1, 1, 16});
+
+    auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                             ops::Placeholder::Shape(qkv_shape));
+    auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                           ops::Placeholder::Shape(qkv_shape));
+    auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                             ops::Placeholder::Shape(qkv_shape));
+    auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT,
+                            ops::Placeholder::Shape(bias_shape));
+
+    auto qk = ops::BatchMatMulV2(s.WithOpName("qk"), query, key,
+                                 ops::BatchMatMulV2::AdjY(true));
+    auto scale = ops::Const(s.WithOpName("scale"), 0.125f);
+    Output scores = ops::Mul(s.WithOpName("scaled"), qk, scale);
+    if (with_bias) scores = ops::Add(s.WithOpName("biased"), bias, scores);
+    auto probs = ops::Softmax(s.WithOpName("probs"), scores);
+    auto attention =
+        ops::BatchMatMulV2(s.WithOpName("attention"), probs, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    auto query_t = GenerateRandomTensor<DT_FLOAT>(qkv_shape);
+    auto key_t = GenerateRandomTensor<DT_FLOAT>(qkv_shape);
+    auto value_t = GenerateRandomTensor<DT_FLOAT>(qkv_shape);
+    auto bias_t = GenerateRandomTensor<DT_FLOAT>(bias_shape);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", query_t}, {"key", key_t}, {"value", value_t}};
+    if (with_bias) item.feed.emplace_back("bias", bias_t);
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on GPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:GPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::AGGRESSIVE);  // trust placeholders shape
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "qk");
+      EXPECT_NE(node.name(), "probs");
+      if (node.name() == "attention") {
+        EXPECT_EQ(node.op(), "FusedAttention");
+        ASSERT_EQ(node.input_size(), with_bias ? 4 : 3);
+        EXPECT_EQ(node.input(0), "query");
+        EXPECT_EQ(node.input(1), "key");
+        EXPECT_EQ(node.input(2), "value");
+        if (with_bias) EXPECT_EQ(node.input(3), "bias");
+
+        auto attr = node.attr();
+        EXPECT_EQ(attr["num_bias"].i(), with_bias ? 1 : 0);
+        EXPECT_FLOAT_EQ(attr["scale"].f(), 0.125f);
+        EXPECT_EQ(attr["dropout_rate"].f(), 0.0f);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    if (GetNumAvailableGPUs() > 0) {
+      auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+      ASSERT_EQ(tensors_expected.size(), 1);
+      auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+      ASSERT_EQ(tensors.size(), 1);
+      test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+    }
+  }
+}
+
+TEST_F(RemapperTest, DoNotFuseBroadcastingAttention) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // Key and value are shared by all heads, so BatchMatMul broadcasts them.
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 16, 8}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 1, 16, 8}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 1, 16, 8}));
+
+  auto qk = ops::BatchMatMulV2(s.WithOpName("qk"), query, key,
+                               ops::BatchMatMulV2::AdjY(true));
+  auto probs = ops::Softmax(s.WithOpName("probs"), qk);
+  auto attention = ops::BatchMatMulV2(s.WithOpName("attention"), probs, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::AGGRESSIVE);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "FusedAttention");
+  }
+}
+
+TEST_F(RemapperTest, FuseMulAddTanh) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  TensorShape shape({8, 32});
+  auto a = Placeholder(s.WithOpName("a"), DT_FLOAT,
+                       ops::Placeholder::Shape(shape));
+  auto b = Placeholder(s.WithOpName("b"), DT_FLOAT,
+                       ops::Placeholder::Shape(shape));
+  auto c = Placeholder(s.WithOpName("c"), DT_FLOAT,
+                       ops::Placeholder::Shape(shape));
+  auto mul = ops::Mul(s.WithOpName("mul"), a, b);
+  auto add = ops::AddV2(s.WithOpName("add"), c, mul);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), tanh);
+
+  auto a_t = GenerateRandomTensor<DT_FLOAT>(shape);
+  auto b_t = GenerateRandomTensor<DT_FLOAT>(shape);
+  auto c_t = GenerateRandomTensor<DT_FLOAT>(shape);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"a", a_t}, {"b", b_t}, {"c", c_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::AGGRESSIVE);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The fusion only happens when the generated kernels are linked in.
+  NodeDef probe;
+  probe.set_name("probe");
+  probe.set_op("_FusedElementwise");
+  probe.set_device("/device:GPU:0");
+  (*probe.mutable_attr())["T"].set_type(DT_FLOAT);
+  if (!IsKernelRegisteredForNode(probe).ok()) {
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.op(), "_FusedElementwise");
+    }
+    return;
+  }
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "add");
+    if (node.name() == "tanh") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "a");
+      EXPECT_EQ(node.input(1), "b");
+      EXPECT_EQ(node.input(2), "c");
+
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 3);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "AddV2");
+      EXPECT_EQ(fused_ops[2], "Tanh");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  if (GetNumAvailableGPUs() > 0) {
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+}
+
+TEST_F(RemapperTest, DoNotFuseBroadcastingMulAddTanh) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The addend is broadcast over the rows.
+  auto a = Placeholder(s.WithOpName("a"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 32}));
+  auto b = Placeholder(s.WithOpName("b"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 32}));
+  auto c = Placeholder(s.WithOpName("c"), DT_FLOAT,
+                       ops::Placeholder::Shape({1, 32}));
+  auto mul = ops::Mul(s.WithOpName("mul"), a, b);
+  auto add = ops::AddV2(s.WithOpName("add"), mul, c);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), tanh);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::AGGRESSIVE);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedElementwise");
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -0,0 +1,109 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/static_memory_planner.h"
+
+#include <unordered_set>
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Returns true for the ops whose kernels usually return (a view of) an input.
+// The executor never forwards inputs to planned outputs, so planning these
+// would copy their input instead.
+bool MayAliasInput(const NodeDef& node) {
+  return IsValuePreserving(node) || IsSlice(node) || IsStridedSlice(node) ||
+         IsSplit(node) || IsSplitV(node) || IsUnpack(node) || IsConcat(node) ||
+         IsPack(node) || IsTile(node) || IsBroadcastTo(node) || IsCast(node) ||
+         IsBitcast(node) || IsPad(node) || IsMirrorPad(node) ||
+         IsReduction(node) || IsConjugateTranspose(node) ||
+         IsIdentityN(node) || node.op() == "Einsum";
+}
+
+bool IsPlannable(const NodeDef& node,
+                 const std::unordered_set<string>& nodes_to_preserve) {
+  return !node.device().empty() && nodes_to_preserve.count(node.name()) == 0 &&
+         node.attr().count("_scoped_allocator") == 0 && !IsConstant(node) &&
+         !IsPlaceholder(node) && !IsArg(node) && !IsRetval(node) &&
+         !IsRecv(node) && !IsSend(node) && !IsVariable(node) &&
+         !IsControlFlow(node) && !IsStateful(node) &&
+         !ModifiesInputsInPlace(node) && !MayAliasInput(node);
+}
+
+// Returns the size of a tensor with the given properties, or -1 if it is not
+// known statically.
+int64 StaticBytes(const OpInfo::TensorProperties& properties) {
+  const DataType dtype = properties.dtype();
+  if (!DataTypeCanUseMemcpy(dtype) || IsRefType(dtype)) return -1;
+  const PartialTensorShape shape(properties.shape());
+  if (!shape.IsFullyDefined() || shape.num_elements() == 0) return -1;
+  return shape.num_elements() * DataTypeSize(dtype);
+}
+
+}  // namespace
+
+Status StaticMemoryPlanner::Optimize(Cluster* cluster,
+                                     const GrapplerItem& item,
+                                     GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/true, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  int num_annotated = 0;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (!IsPlannable(node, nodes_to_preserve) ||
+        !properties.HasOutputProperties(node.name())) {
+      continue;
+    }
+    AttrValue bytes;
+    bool any_static = false;
+    for (const auto& output : properties.GetOutputProperties(node.name())) {
+      const int64 output_bytes = StaticBytes(output);
+      bytes.mutable_list()->add_i(output_bytes);
+      any_static |= output_bytes > 0;
+    }
+    if (!any_static) continue;
+    (*node.mutable_attr())[kStaticMemoryBytesAttr] = std::move(bytes);
+    ++num_annotated;
+  }
+  if (num_annotated == 0) {
+    return errors::Aborted("Nothing to do.");
+  }
+  VLOG(1) << "Annotated the output sizes of " << num_annotated << " nodes";
+  return Status::OK();
+}
+
+void StaticMemoryPlanner::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                   const GraphDef& optimized_graph,
+                                   double result) {
+  // Nothing to do for StaticMemoryPlanner.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_MEMORY_PLANNER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Annotates the nodes whose outputs have static shapes with the size of each
+// output, so that the executor can place all of them at fixed offsets in one
+// arena per step (see common_runtime/static_memory_plan.h). Outputs that
+// usually alias an input, feeds, fetches and the outputs of stateful nodes
+// are not annotated. Meant for inference graphs and runs after all the other
+// optimizers, which may still change the graph.
+class StaticMemoryPlanner : public GraphOptimizer {
+ public:
+  StaticMemoryPlanner() {}
+  ~StaticMemoryPlanner() override {}
+
+  string name() const override { return "static_memory_planner"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_MEMORY_PLANNER_H_
@@ -0,0 +1,84 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/static_memory_planner.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class StaticMemoryPlannerTest : public GrapplerTest {};
+
+TEST_F(StaticMemoryPlannerTest, AnnotatesStaticOutputs) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 8}));
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 8}));
+  Output relu = ops::Relu(s.WithOpName("relu"), x);
+  Output reshape = ops::Reshape(s.WithOpName("reshape"), relu, {16});
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), reshape);
+  Output dynamic = ops::Relu(s.WithOpName("dynamic"), y);
+  Output fetch = ops::Sigmoid(s.WithOpName("fetch"), tanh);
+
+  GrapplerItem item;
+  item.fetch = {"fetch", "dynamic"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  StaticMemoryPlanner optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  std::unordered_map<string, std::vector<int64>> bytes;
+  for (const NodeDef& node : output.node()) {
+    std::vector<int64> node_bytes;
+    if (TryGetNodeAttr(node, kStaticMemoryBytesAttr, &node_bytes)) {
+      bytes[node.name()] = node_bytes;
+    }
+  }
+  EXPECT_EQ(bytes.size(), 2);
+  EXPECT_EQ(bytes["relu"], std::vector<int64>({2 * 8 * 4}));
+  EXPECT_EQ(bytes["tanh"], std::vector<int64>({16 * 4}));
+}
+
+TEST_F(StaticMemoryPlannerTest, NothingToDoWithoutStaticShapes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 8}));
+  Output relu = ops::Relu(s.WithOpName("relu"), x);
+  Output fetch = ops::Tanh(s.WithOpName("fetch"), relu);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  StaticMemoryPlanner optimizer;
+  GraphDef output;
+  EXPECT_EQ(optimizer.Optimize(nullptr, item, &output),
+            errors::Aborted("Nothing to do."));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace {
@@ -40,6 +41,23 @@ constexpr int64 kMinInflightBatchesLimit = 16;
 constexpr double kInitialInflightBatchesLimit = 64;
 constexpr int64 kBatchesToAverageOver = 10;
 constexpr int64 kMaxInflightBatchesLimit = 128;
+
+// Returns the p99 latency target of the queues of the adaptive shared batch
+// scheduler, read from the TF_BATCH_LATENCY_TARGET_MICROS environment
+// variable.  Zero, the default, keeps the fixed batch timeouts.
+int64 AdaptiveBatchLatencyTargetMicros() {
+  static const int64 latency_target_micros = [] {
+    int64 value;
+    Status status =
+        ReadInt64FromEnvVar("TF_BATCH_LATENCY_TARGET_MICROS", 0, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      value = 0;
+    }
+    return value;
+  }();
+  return latency_target_micros;
+}
 }  // namespace
 
 auto* batch_op_split_usage = monitoring::Gauge<string, 1>::New(
@@ -114,11 +132,14 @@ class BatchResource : public serving::BatchResourceBase {
     TF_RETURN_IF_ERROR(AdaptiveBatcherT::Create(
         adaptive_shared_batch_scheduler_options, &batcher));
 
-    resource->reset(new BatchResource(
-        fhandle, std::move(batcher),
+    AdaptiveBatcherT::QueueOptions batcher_queue_options =
         GetAdaptiveBatcherQueueOptions(max_batch_size, batch_timeout_micros,
-                                       max_enqueued_batches, true),
-        allowed_batch_sizes));
+                                       max_enqueued_batches, true);
+    batcher_queue_options.latency_target_micros =
+        AdaptiveBatchLatencyTargetMicros();
+    resource->reset(new BatchResource(fhandle, std::move(batcher),
+                                      batcher_queue_options,
+                                      allowed_batch_sizes));
     return Status::OK();
   }
 
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <functional>
 #include <memory>
 #include <random>
@@ -45,6 +46,8 @@ class ASBSBatch;
 
 template <typename TaskType>
 class ASBSQueue;
+
+class ASBSLatencyModel;
 }  // namespace internal
 
 // Shared batch scheduler designed to minimize latency. The scheduler keeps
@@ -72,6 +75,12 @@ class ASBSQueue;
 // CPU utilization - If the batch processing is cpu dominated, you can reap
 //   latency gains when underutilized by increasing the processing rate, but
 //   back the rate off when the load increases to avoid overload.
+//
+// Queues can also be given a latency target instead of a fixed batch timeout
+// (see QueueOptions::latency_target_micros).  Such a queue learns the
+// processing latency of its batches as a function of their size, and picks
+// the size and timeout of every new batch so that batches are as large as
+// possible, for throughput, while their tail latency stays within the target.
 
 template <typename TaskType>
 class AdaptiveSharedBatchScheduler
@@ -147,6 +156,13 @@ class AdaptiveSharedBatchScheduler
                          int max_size,
                          std::vector<std::unique_ptr<TaskType>>* output_tasks)>
         split_input_task_func;
+    // If positive, the target for the 99th percentile latency of the tasks of
+    // the queue, from their enqueueing to the end of the processing of their
+    // batch.  The size limit and timeout of each batch are then chosen from
+    // the processing latencies observed for earlier batches, instead of
+    // max_batch_size (which still bounds the batch size) and
+    // batch_timeout_micros.
+    int64 latency_target_micros = 0;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -245,6 +261,53 @@ class AdaptiveSharedBatchScheduler
 // Implementation details follow. API users need not read.
 
 namespace internal {
+// Learns the processing latency of the batches of a queue as a function of
+// their size, and chooses the size limit and timeout of its new batches to
+// meet a latency target.  Batch sizes are grouped in power-of-two buckets,
+// whose latency distribution is tracked with exponentially weighted moving
+// averages.  Thread-safe.
+class ASBSLatencyModel {
+ public:
+  ASBSLatencyModel(int max_batch_size, int64 latency_target_micros);
+
+  // Records that a batch of `batch_size` tasks took `latency_micros` to
+  // process.
+  void RecordBatch(int batch_size, int64 latency_micros);
+
+  // Returns the largest batch size whose estimated 99th percentile processing
+  // latency fits in the processing share of the latency target.  The size
+  // after the largest one known to fit is returned until it is measured, so
+  // that larger batches get explored as long as they could fit.
+  int BatchSize();
+
+  // Returns how long a batch limited to `batch_size` tasks may wait for more
+  // tasks, so that it still finishes processing within the latency target.
+  int64 BatchTimeoutMicros(int batch_size);
+
+ private:
+  struct Bucket {
+    int64 num_batches = 0;
+    double mean_micros = 0;
+    double mean_square_micros = 0;
+  };
+
+  // Returns the index of the bucket of batches of `batch_size` tasks.
+  int BucketIndex(int batch_size) const;
+
+  // Returns the largest batch size of `bucket_index`.
+  int BucketMaxBatchSize(int bucket_index) const;
+
+  // Returns the estimated 99th percentile processing latency of the batches
+  // of `bucket`, assuming they are roughly normally distributed.
+  static double P99Micros(const Bucket& bucket);
+
+  const int max_batch_size_;
+  const int64 latency_target_micros_;
+  mutex mu_;
+  std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+  TF_DISALLOW_COPY_AND_ASSIGN(ASBSLatencyModel);
+};
+
 // Consolidates tasks into batches, passing them off to the
 // AdaptiveSharedBatchScheduler for processing.
 template <typename TaskType>
@@ -283,10 +346,18 @@ class ASBSQueue : public BatchScheduler<TaskType> {
   // Context id is reused after std::numeric_limits<uint64>::max is exhausted.
   static uint64 NewTraceMeContextIdForBatch();
 
+  // Returns the size limit of the next batch.
+  int NextBatchMaxSize() const;
+
   std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler_;
   const QueueOptions options_;
+  // Null unless options_.latency_target_micros is positive.  Shared with the
+  // batches of the queue, since they can outlive it.
+  const std::shared_ptr<ASBSLatencyModel> latency_model_;
   // Owned by scheduler_.
   ASBSBatch<TaskType>* current_batch_ TF_GUARDED_BY(mu_) = nullptr;
+  // Size limit of current_batch_.
+  int current_batch_max_size_ TF_GUARDED_BY(mu_) = 0;
   int64 num_enqueued_batches_ TF_GUARDED_BY(mu_) = 0;
   int64 num_enqueued_tasks_ TF_GUARDED_BY(mu_) = 0;
   mutable mutex mu_;
@@ -298,11 +369,13 @@ template <typename TaskType>
 class ASBSBatch : public Batch<TaskType> {
  public:
   ASBSBatch(ASBSQueue<TaskType>* queue, int64 creation_time_micros,
-            int64 batch_timeout_micros, uint64 traceme_context_id)
+            int64 batch_timeout_micros, uint64 traceme_context_id,
+            std::shared_ptr<ASBSLatencyModel> latency_model = nullptr)
       : queue_(queue),
         creation_time_micros_(creation_time_micros),
         schedulable_time_micros_(creation_time_micros + batch_timeout_micros),
-        traceme_context_id_(traceme_context_id) {}
+        traceme_context_id_(traceme_context_id),
+        latency_model_(std::move(latency_model)) {}
 
   ~ASBSBatch() override {}
 
@@ -314,11 +387,18 @@ class ASBSBatch : public Batch<TaskType> {
 
   uint64 traceme_context_id() const { return traceme_context_id_; }
 
+  // The model to which the processing latency of the batch is reported, or
+  // null.
+  const std::shared_ptr<ASBSLatencyModel>& latency_model() const {
+    return latency_model_;
+  }
+
  private:
   ASBSQueue<TaskType>* queue_;
   const int64 creation_time_micros_;
   const int64 schedulable_time_micros_;
   const uint64 traceme_context_id_;
+  const std::shared_ptr<ASBSLatencyModel> latency_model_;
   TF_DISALLOW_COPY_AND_ASSIGN(ASBSBatch);
 };
 }  // namespace internal
@@ -407,6 +487,11 @@ Status AdaptiveSharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.latency_target_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_target_micros can't be negative; was ",
+        options.latency_target_micros);
+  }
   internal::ASBSQueue<TaskType>* asbs_queue_raw;
   queue->reset(asbs_queue_raw = new internal::ASBSQueue<TaskType>(
                    this->shared_from_this(), options));
@@ -523,9 +608,18 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       profiler::ContextType::kAdaptiveSharedBatchScheduler,
       batch->traceme_context_id());
   int64 start_time = batch->creation_time_micros();
+  // The batch is destroyed by the callback.
+  const int batch_size = batch->size();
+  std::shared_ptr<internal::ASBSLatencyModel> latency_model =
+      batch->latency_model();
+  const int64 processing_start_time =
+      latency_model ? GetEnv()->NowMicros() : 0;
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64 end_time = GetEnv()->NowMicros();
+  if (latency_model) {
+    latency_model->RecordBatch(batch_size, end_time - processing_start_time);
+  }
   mutex_lock l(mu_);
   if (is_express) {
     in_flight_express_batches_--;
@@ -574,14 +668,90 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
   MaybeScheduleNextBatch();
 }
 
-// ---------------- ASBSQueue ----------------
+// ---------------- ASBSLatencyModel ----------------
 
 namespace internal {
+inline ASBSLatencyModel::ASBSLatencyModel(int max_batch_size,
+                                          int64 latency_target_micros)
+    : max_batch_size_(max_batch_size),
+      latency_target_micros_(latency_target_micros),
+      buckets_(BucketIndex(max_batch_size) + 1) {}
+
+inline int ASBSLatencyModel::BucketIndex(int batch_size) const {
+  int index = 0;
+  while ((1 << index) < batch_size) ++index;
+  return index;
+}
+
+inline int ASBSLatencyModel::BucketMaxBatchSize(int bucket_index) const {
+  return std::min(1 << bucket_index, max_batch_size_);
+}
+
+inline double ASBSLatencyModel::P99Micros(const Bucket& bucket) {
+  const double variance = std::max(
+      0.0, bucket.mean_square_micros - bucket.mean_micros * bucket.mean_micros);
+  return bucket.mean_micros + 2.33 * std::sqrt(variance);
+}
+
+inline void ASBSLatencyModel::RecordBatch(int batch_size,
+                                          int64 latency_micros) {
+  // Weight of the latest batch in the moving averages.
+  constexpr double kDecay = 0.05;
+  mutex_lock l(mu_);
+  Bucket& bucket =
+      buckets_[BucketIndex(std::min(std::max(batch_size, 1), max_batch_size_))];
+  const double latency = latency_micros;
+  if (bucket.num_batches == 0) {
+    bucket.mean_micros = latency;
+    bucket.mean_square_micros = latency * latency;
+  } else {
+    bucket.mean_micros += kDecay * (latency - bucket.mean_micros);
+    bucket.mean_square_micros +=
+        kDecay * (latency * latency - bucket.mean_square_micros);
+  }
+  ++bucket.num_batches;
+}
+
+inline int ASBSLatencyModel::BatchSize() {
+  // Half of the latency target is left for the batch to fill up and to wait
+  // for a batch thread.
+  const double processing_target_micros = latency_target_micros_ / 2.0;
+  mutex_lock l(mu_);
+  int best_bucket = 0;
+  for (int i = 0; i < static_cast<int>(buckets_.size()); ++i) {
+    if (buckets_[i].num_batches == 0) {
+      best_bucket = i;
+      break;
+    }
+    if (i > 0 && P99Micros(buckets_[i]) > processing_target_micros) break;
+    best_bucket = i;
+  }
+  return BucketMaxBatchSize(best_bucket);
+}
+
+inline int64 ASBSLatencyModel::BatchTimeoutMicros(int batch_size) {
+  mutex_lock l(mu_);
+  const Bucket& bucket = buckets_[BucketIndex(batch_size)];
+  // Batches of unmeasured sizes get the processing share of the target.
+  const double processing_micros = bucket.num_batches == 0
+                                       ? latency_target_micros_ / 2.0
+                                       : P99Micros(bucket);
+  return std::max<int64>(0, latency_target_micros_ - processing_micros);
+}
+
+// ---------------- ASBSQueue ----------------
+
 template <typename TaskType>
 ASBSQueue<TaskType>::ASBSQueue(
     std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler,
     const QueueOptions& options)
-    : scheduler_(scheduler), options_(options) {}
+    : scheduler_(scheduler),
+      options_(options),
+      latency_model_(options.latency_target_micros > 0
+                         ? std::make_shared<ASBSLatencyModel>(
+                               options.max_batch_size,
+                               options.latency_target_micros)
+                         : nullptr) {}
 
 template <typename TaskType>
 ASBSQueue<TaskType>::~ASBSQueue() {
@@ -617,10 +787,11 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       return errors::Unavailable("The batch scheduling queue is full");
     }
 
+    const int next_batch_max_size = NextBatchMaxSize();
     int remaining_batch_size =
         current_batch_ == nullptr
-            ? options_.max_batch_size
-            : options_.max_batch_size - current_batch_->size();
+            ? next_batch_max_size
+            : current_batch_max_size_ - current_batch_->size();
     if (options_.split_input_task_func == nullptr ||
         size <= remaining_batch_size) {
       // Either we don't allow task splitting or task fits within the current
@@ -631,13 +802,13 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       // Beyond this point Schedule should not fail, as the caller has been
       // promised that all of the split tasks will be scheduled.
       TF_RETURN_IF_ERROR(options_.split_input_task_func(
-          task, remaining_batch_size, options_.max_batch_size,
+          task, remaining_batch_size, next_batch_max_size,
           &tasks_to_schedule));
     }
     for (auto& task : tasks_to_schedule) {
       // Can't fit within current batch, close it off and try to create another.
       if (current_batch_ &&
-          current_batch_->size() + task->size() > options_.max_batch_size) {
+          current_batch_->size() + task->size() > current_batch_max_size_) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -648,9 +819,13 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         // TraceMeConsumer.
         // When multiple calls to "ASBS::Schedule" accumulate to one batch, they
         // are processed in the same batch and should share traceme_context_id.
+        current_batch_max_size_ = next_batch_max_size;
         current_batch_ = new ASBSBatch<TaskType>(
             this, scheduler_->GetEnv()->NowMicros(),
-            options_.batch_timeout_micros, NewTraceMeContextIdForBatch());
+            latency_model_ ? latency_model_->BatchTimeoutMicros(
+                                 current_batch_max_size_)
+                           : options_.batch_timeout_micros,
+            NewTraceMeContextIdForBatch(), latency_model_);
         new_batches.push_back(current_batch_);
       }
 
@@ -667,7 +842,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       current_batch_->AddTask(std::move(task));
       num_enqueued_tasks_++;
       // If current_batch_ is now full, allow it to be processed immediately.
-      if (current_batch_->size() == options_.max_batch_size) {
+      if (current_batch_->size() >= current_batch_max_size_) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -696,6 +871,11 @@ void ASBSQueue<TaskType>::ReleaseBatch(const ASBSBatch<TaskType>* batch) {
   }
 }
 
+template <typename TaskType>
+int ASBSQueue<TaskType>::NextBatchMaxSize() const {
+  return latency_model_ ? latency_model_->BatchSize() : options_.max_batch_size;
+}
+
 template <typename TaskType>
 size_t ASBSQueue<TaskType>::NumEnqueuedTasks() const {
   mutex_lock l(mu_);
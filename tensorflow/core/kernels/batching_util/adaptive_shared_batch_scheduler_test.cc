@@ -411,6 +411,65 @@ TEST(AdaptiveSharedBatchSchedulerTest, TruncateBatches) {
     if (processed_batches == 4) break;
   }
 }
+
+TEST(AdaptiveSharedBatchSchedulerTest, LatencyTargetBadOptions) {
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(AdaptiveSharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.latency_target_micros = -1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_FALSE(
+      scheduler
+          ->AddQueue(queue_options,
+                     [](std::unique_ptr<Batch<FakeTask>> batch) {}, &queue)
+          .ok());
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, LatencyTargetBatchSizes) {
+  mutex mu;
+  std::vector<int> batch_sizes;
+  auto queue_callback = [&mu,
+                         &batch_sizes](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    mutex_lock l(mu);
+    batch_sizes.push_back(batch->size());
+  };
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(AdaptiveSharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 100;
+  queue_options.latency_target_micros = 1000000;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+  // Without latency measurements the first batch is limited to a single task,
+  // so it is closed and processed without waiting for its timeout.
+  TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+  while (true) {
+    mutex_lock l(mu);
+    if (!batch_sizes.empty()) break;
+  }
+  mutex_lock l(mu);
+  EXPECT_EQ(1, batch_sizes[0]);
+}
+
+TEST(ASBSLatencyModelTest, BatchSizeAndTimeout) {
+  internal::ASBSLatencyModel model(/*max_batch_size=*/64,
+                                   /*latency_target_micros=*/1000);
+  // Unmeasured sizes get explored one bucket at a time.
+  EXPECT_EQ(1, model.BatchSize());
+  model.RecordBatch(1, 100);
+  EXPECT_EQ(2, model.BatchSize());
+  model.RecordBatch(2, 150);
+  model.RecordBatch(3, 200);
+  model.RecordBatch(8, 300);
+  model.RecordBatch(16, 450);
+  EXPECT_EQ(32, model.BatchSize());
+  // Batches of 32 tasks take longer than the processing share of the target.
+  model.RecordBatch(32, 800);
+  EXPECT_EQ(16, model.BatchSize());
+  EXPECT_EQ(550, model.BatchTimeoutMicros(16));
+  EXPECT_EQ(500, model.BatchTimeoutMicros(64));
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
@@ -15,8 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
+#include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/ops_util.h"
-#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
@@ -235,10 +235,31 @@ BatchResourceBase::GetBatcherQueueOptions(
           *allowed_batch_sizes.rbegin();
     }
   }
+  batcher_queue_options.drop_task_func = DropIfCancelled;
 
   return batcher_queue_options;
 }
 
+/*static*/ bool BatchResourceBase::DropIfCancelled(BatchTask* task) {
+  // The step of a task is cancelled e.g. when its client times out, in which
+  // case there is no point in spending a batch slot on it.
+  CancellationManager* cancellation_manager =
+      task->context->cancellation_manager();
+  if (cancellation_manager == nullptr ||
+      !cancellation_manager->IsCancelled()) {
+    return false;
+  }
+  const Status status =
+      errors::Cancelled("Batched request was cancelled before it ran");
+  if (task->is_partial) {
+    task->status->Update(status);
+  } else {
+    task->context->SetStatus(status);
+  }
+  task->done_callback();
+  return true;
+}
+
 /*static*/ BatchResourceBase::AdaptiveBatcherT::QueueOptions
 BatchResourceBase::GetAdaptiveBatcherQueueOptions(
     int32 max_batch_size, int32 batch_timeout_micros,
@@ -477,6 +498,9 @@ Status BatchResourceBase::SplitOutputTensors(
     return errors::Internal("Wrong number of batched output tensors");
   }
 
+  // Used to allocate the outputs that can't be slices of the batch outputs.
+  OpKernelContext* context = batch->task(batch->num_tasks() - 1).context;
+
   // Generate 'split_tensors' and populate the context outputs.
   for (int i = 0, iter_limit = combined_outputs.size(); i < iter_limit; ++i) {
     const Tensor& output_tensor = combined_outputs[i];
@@ -491,9 +515,12 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
+    // The outputs of the tasks are slices of the batch output when they stay
+    // aligned, and copies otherwise.
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+    const Status split_status =
+        Split(context, output_tensor, task_sizes_plus_optional_padding,
+              &split_tensor);
     DCHECK(split_status.ok()) << split_status.ToString();
     if (!split_status.ok()) {
       return errors::Internal("Tensor split operation failed: ",
@@ -138,6 +138,10 @@ class BatchResourceBase : public ResourceBase {
       int32 max_enqueued_batches, const std::vector<int32>& allowed_batch_sizes,
       bool enable_large_batch_splitting);
 
+  // Fails and drops `task` if its step has been cancelled by the time its
+  // batch is about to be processed.
+  static bool DropIfCancelled(BatchTask* task);
+
   static AdaptiveBatcherT::QueueOptions GetAdaptiveBatcherQueueOptions(
       int32 max_batch_size, int32 batch_timeout_micros,
       int32 max_enqueued_batches, bool enable_large_batch_splitting);
@@ -37,6 +37,12 @@ typedef Eigen::GpuDevice GPUDevice;
 template <typename T>
 Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor> inputs,
               Tensor* output) {
+  // A single input is the concatenation, and shares its buffer.
+  if (inputs.size() == 1) {
+    *output = inputs[0];
+    return Status::OK();
+  }
+
   const int input_dims = inputs[0].dims();
   const TensorShape& input_shape = inputs[0].shape();
 
@@ -73,6 +79,8 @@ Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor> inputs,
   output_shape.set_dim(0, output_dim0);
   AllocatorAttributes attr;
   attr.set_on_host(true);
+  // Pinned if there are GPUs, so that the batch is copied to them directly.
+  attr.set_gpu_compatible(true);
   TF_RETURN_IF_ERROR(context->allocate_temp(DataTypeToEnum<T>::value,
                                             output_shape, output, attr));
   if (output->NumElements() > 0) {
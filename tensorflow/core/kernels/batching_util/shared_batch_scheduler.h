@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -194,6 +195,22 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // Batch threads serve the queues with a schedulable batch in decreasing
+    // order of priority, and take turns among the queues of equal priority.
+    // Requests of different priority classes can thus share the batch threads
+    // by going to different queues, without the low-priority ones delaying the
+    // others.
+    int priority = 0;
+
+    // If set, called for each task of a batch right before the batch is
+    // processed, to drop the tasks whose results are no longer needed, e.g.
+    // because their deadline has passed or their client went away. Returns
+    // true if `task` is to be dropped, in which case it must also have
+    // completed `task` (e.g. with a cancellation error) since the task is
+    // removed from the batch and destroyed. Batches whose tasks are all dropped
+    // are not processed.
+    std::function<bool(TaskType* task)> drop_task_func;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -207,6 +224,8 @@ class SharedBatchScheduler
   // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
   // queue declines to provide a batch to process, moves onto the next queue. If
   // no queues provide a batch to process, just sleeps briefly and exits.
+  // Queues of lower priority than another queue with a schedulable batch are
+  // skipped.
   void ThreadLogic();
 
   const Options options_;
@@ -227,6 +246,10 @@ class SharedBatchScheduler
   // available batch thread should grab work.
   typename QueueList::iterator next_queue_to_schedule_ TF_GUARDED_BY(mu_);
 
+  // Whether a queue with a non-default priority was ever added. If not, the
+  // batch threads need not look for the highest priority schedulable batch.
+  bool has_prioritized_queues_ TF_GUARDED_BY(mu_) = false;
+
   // Used by idle batch threads to wait for work to enter the system. Notified
   // whenever a batch becomes schedulable.
   condition_variable schedulable_batch_cv_;
@@ -315,9 +338,15 @@ class Queue {
   // returns a batch, the batch is guaranteed to be closed.
   std::unique_ptr<Batch<TaskType>> ScheduleBatch();
 
-  // Processes a batch that has been returned earlier by ScheduleBatch().
+  // Processes a batch that has been returned earlier by ScheduleBatch(),
+  // after dropping its tasks selected by 'options_.drop_task_func'.
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch);
 
+  // Determines whether ScheduleBatch() would currently return a batch.
+  bool HasSchedulableBatch() const;
+
+  int priority() const { return options_.priority; }
+
   // Determines whether the queue is empty, i.e. has no tasks waiting or being
   // processed.
   bool IsEmpty() const;
@@ -345,6 +374,11 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Removes from 'batch' the tasks that 'options_.drop_task_func' drops.
+  // Returns null if all of them are dropped.
+  std::unique_ptr<Batch<TaskType>> DropTasks(
+      std::unique_ptr<Batch<TaskType>> batch);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -509,6 +543,9 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
     if (next_queue_to_schedule_ == queues_.end()) {
       next_queue_to_schedule_ = queues_.begin();
     }
+    if (options.priority != 0) {
+      has_prioritized_queues_ = true;
+    }
   }
   *queue = std::move(handle);
   return Status::OK();
@@ -538,6 +575,17 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   {
     mutex_lock l(mu_);
 
+    // Only the queues of the highest priority among those with a schedulable
+    // batch are asked for one.
+    int min_priority = std::numeric_limits<int>::min();
+    if (has_prioritized_queues_) {
+      for (const auto& queue : queues_) {
+        if (queue->priority() > min_priority && queue->HasSchedulableBatch()) {
+          min_priority = queue->priority();
+        }
+      }
+    }
+
     const int num_queues = queues_.size();
     for (int num_queues_tried = 0;
          batch_to_process == nullptr && num_queues_tried < num_queues;
@@ -551,9 +599,11 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
       const bool queue_closed = (*next_queue_to_schedule_)->closed();
 
       // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
-      if (batch_to_process != nullptr) {
-        queue_for_batch = next_queue_to_schedule_->get();
+      if ((*next_queue_to_schedule_)->priority() >= min_priority) {
+        batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
+        if (batch_to_process != nullptr) {
+          queue_for_batch = next_queue_to_schedule_->get();
+        }
       }
 
       // Advance 'next_queue_to_schedule_'.
@@ -814,7 +864,12 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
-  process_batch_callback_(std::move(batch));
+  if (options_.drop_task_func != nullptr) {
+    batch = DropTasks(std::move(batch));
+  }
+  if (batch != nullptr) {
+    process_batch_callback_(std::move(batch));
+  }
 
   {
     mutex_lock l(mu_);
@@ -825,6 +880,45 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
   }
 }
 
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::DropTasks(
+    std::unique_ptr<Batch<TaskType>> batch) {
+  std::vector<bool> dropped(batch->num_tasks());
+  bool any_dropped = false;
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    dropped[i] = options_.drop_task_func(batch->mutable_task(i));
+    any_dropped |= dropped[i];
+  }
+  if (!any_dropped) {
+    return batch;
+  }
+
+  // Closed batches cannot be modified, so the remaining tasks are moved to a
+  // new batch, in their original order.
+  std::vector<std::unique_ptr<TaskType>> tasks(batch->num_tasks());
+  for (int i = batch->num_tasks() - 1; i >= 0; --i) {
+    tasks[i] = batch->RemoveTask();
+  }
+  std::unique_ptr<Batch<TaskType>> remaining(
+      new Batch<TaskType>(batch->traceme_context_id()));
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (!dropped[i]) {
+      remaining->AddTask(std::move(tasks[i]));
+    }
+  }
+  remaining->Close();
+  if (remaining->empty()) {
+    return nullptr;
+  }
+  return remaining;
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::HasSchedulableBatch() const {
+  mutex_lock l(mu_);
+  return batches_.size() >= 2 || IsOpenBatchSchedulable();
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsEmpty() const {
   mutex_lock l(mu_);
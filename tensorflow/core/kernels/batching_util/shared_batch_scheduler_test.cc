@@ -591,6 +591,92 @@ TEST(SharedBatchSchedulerTest, QueueDestructorBlocksUntilAllTasksProcessed) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, HigherPriorityQueuesGoFirst) {
+  mutex mu;
+  std::vector<int> processed_priorities;
+  Notification first_batch_started;
+  Notification proceed;
+  auto make_callback = [&](int priority) {
+    return [&, priority](std::unique_ptr<Batch<FakeTask>> batch) {
+      if (!first_batch_started.HasBeenNotified()) {
+        first_batch_started.Notify();
+        proceed.WaitForNotification();
+      }
+      mutex_lock l(mu);
+      processed_priorities.push_back(priority);
+    };
+  };
+  {
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.input_batch_size_limit = 10;
+    queue_options.batch_timeout_micros = 0;
+    std::unique_ptr<BatchScheduler<FakeTask>> low_queue;
+    TF_ASSERT_OK(
+        scheduler->AddQueue(queue_options, make_callback(0), &low_queue));
+    queue_options.priority = 1;
+    std::unique_ptr<BatchScheduler<FakeTask>> high_queue;
+    TF_ASSERT_OK(
+        scheduler->AddQueue(queue_options, make_callback(1), &high_queue));
+
+    // Keep the batch thread busy while both queues get a batch, the
+    // low-priority one first.
+    TF_ASSERT_OK(ScheduleTask(1, low_queue.get()));
+    first_batch_started.WaitForNotification();
+    TF_ASSERT_OK(ScheduleTask(1, low_queue.get()));
+    TF_ASSERT_OK(ScheduleTask(1, high_queue.get()));
+    proceed.Notify();
+  }
+  EXPECT_EQ(std::vector<int>({0, 1, 0}), processed_priorities);
+}
+
+TEST(SharedBatchSchedulerTest, DropTasks) {
+  mutex mu;
+  std::vector<std::vector<size_t>> processed_task_sizes;
+  int num_dropped = 0;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    std::vector<size_t> task_sizes;
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      task_sizes.push_back(batch->task(i).size());
+    }
+    mutex_lock l(mu);
+    processed_task_sizes.push_back(task_sizes);
+  };
+  {
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.input_batch_size_limit = 6;
+    queue_options.batch_timeout_micros = 10 * 1000 * 1000;  // 10 seconds
+    queue_options.drop_task_func = [&](FakeTask* task) {
+      if (task->size() != 2) return false;
+      mutex_lock l(mu);
+      ++num_dropped;
+      return true;
+    };
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // The first batch keeps its first and last tasks, and the second one is
+    // not processed at all.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+  }
+  ASSERT_EQ(1, processed_task_sizes.size());
+  EXPECT_EQ(std::vector<size_t>({1, 3}), processed_task_sizes[0]);
+  EXPECT_EQ(4, num_dropped);
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -0,0 +1,248 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/sparse_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/block_sparse_matmul_op.h"
+
+#include <algorithm>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/fill_functor.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+template <typename Device, typename T, typename Tindices>
+class BlockSparseMatMulOp : public OpKernel {
+ public:
+  explicit BlockSparseMatMulOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& a_block_values = ctx->input(0);
+    const Tensor& a_block_col_indices = ctx->input(1);
+    const Tensor& a_block_row_ptr = ctx->input(2);
+    const Tensor& b = ctx->input(3);
+
+    OP_REQUIRES(ctx, a_block_values.dims() == 3,
+                errors::InvalidArgument(
+                    "Tensor 'a_block_values' must be 3-D, got shape ",
+                    a_block_values.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(a_block_col_indices.shape()),
+                errors::InvalidArgument(
+                    "Tensor 'a_block_col_indices' is not a vector"));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsVector(a_block_row_ptr.shape()),
+        errors::InvalidArgument("Tensor 'a_block_row_ptr' is not a vector"));
+    OP_REQUIRES(ctx, a_block_row_ptr.NumElements() > 0,
+                errors::InvalidArgument(
+                    "Tensor 'a_block_row_ptr' must have at least one element"));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("Tensor 'b' is not a matrix"));
+
+    const int64 num_blocks = a_block_values.dim_size(0);
+    const int64 block_rows = a_block_values.dim_size(1);
+    const int64 block_cols = a_block_values.dim_size(2);
+    OP_REQUIRES(ctx, a_block_col_indices.NumElements() == num_blocks,
+                errors::InvalidArgument(
+                    "Number of entries in a_block_col_indices (",
+                    a_block_col_indices.NumElements(),
+                    ") does not match number of blocks in a_block_values (",
+                    num_blocks, ")"));
+
+    const int64 inner_dim = b.dim_size(0);
+    const int64 num_block_cols = block_cols > 0 ? inner_dim / block_cols : 0;
+    OP_REQUIRES(
+        ctx, num_block_cols * block_cols == inner_dim,
+        errors::InvalidArgument(
+            "Cannot multiply A and B because the number of rows of B (",
+            inner_dim, ") is not a multiple of the block width of A (",
+            block_cols, ")"));
+
+    const int64 num_block_rows = a_block_row_ptr.NumElements() - 1;
+    TensorShape out_shape({num_block_rows * block_rows, b.dim_size(1)});
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, out_shape, &out));
+
+    if (out->NumElements() == 0) {
+      return;
+    }
+
+    if (num_blocks == 0 || inner_dim == 0) {
+      // No blocks contribute to the product.
+      functor::SetZeroFunctor<Device, T> f;
+      f(ctx->eigen_device<Device>(), out->flat<T>());
+      return;
+    }
+
+    OP_REQUIRES_OK(
+        ctx, functor::BlockSparseMatMulFunctor<Device, T, Tindices>::Compute(
+                 ctx->eigen_device<Device>(), out->matrix<T>(),
+                 a_block_values.tensor<T, 3>(),
+                 a_block_col_indices.vec<Tindices>(),
+                 a_block_row_ptr.vec<Tindices>(), b.matrix<T>()));
+  }
+};
+
+#define REGISTER_CPU(TypeT, TypeIndex)                   \
+  REGISTER_KERNEL_BUILDER(                               \
+      Name("BlockSparseMatMul")                          \
+          .Device(DEVICE_CPU)                            \
+          .TypeConstraint<TypeT>("T")                    \
+          .TypeConstraint<TypeIndex>("Tindices"),        \
+      BlockSparseMatMulOp<CPUDevice, TypeT, TypeIndex>);
+
+#define REGISTER_KERNELS_CPU(T) \
+  REGISTER_CPU(T, int64);       \
+  REGISTER_CPU(T, int32)
+
+REGISTER_KERNELS_CPU(float);
+REGISTER_KERNELS_CPU(double);
+#undef REGISTER_KERNELS_CPU
+#undef REGISTER_CPU
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace functor {
+#define DECLARE_GPU_SPEC(T, Tindices)                                      \
+  template <>                                                              \
+  Status BlockSparseMatMulFunctor<GPUDevice, T, Tindices>::Compute(        \
+      const GPUDevice& d, typename TTypes<T>::Matrix out,                  \
+      typename TTypes<T, 3>::ConstTensor a_block_values,                   \
+      TTypes<Tindices>::ConstVec a_block_col_indices,                      \
+      TTypes<Tindices>::ConstVec a_block_row_ptr,                          \
+      typename TTypes<T>::ConstMatrix b);                                  \
+  extern template struct BlockSparseMatMulFunctor<GPUDevice, T, Tindices>;
+
+#define DECLARE_GPU_SPECS(T)  \
+  DECLARE_GPU_SPEC(T, int32); \
+  DECLARE_GPU_SPEC(T, int64)
+
+DECLARE_GPU_SPECS(float);
+DECLARE_GPU_SPECS(double);
+#undef DECLARE_GPU_SPECS
+#undef DECLARE_GPU_SPEC
+
+}  // namespace functor
+
+#define REGISTER_GPU(TypeT, TypeIndex)                   \
+  REGISTER_KERNEL_BUILDER(                               \
+      Name("BlockSparseMatMul")                          \
+          .Device(DEVICE_GPU)                            \
+          .TypeConstraint<TypeT>("T")                    \
+          .TypeConstraint<TypeIndex>("Tindices"),        \
+      BlockSparseMatMulOp<GPUDevice, TypeT, TypeIndex>);
+
+#define REGISTER_KERNELS_GPU(T) \
+  REGISTER_GPU(T, int64);       \
+  REGISTER_GPU(T, int32)
+
+REGISTER_KERNELS_GPU(float);
+REGISTER_KERNELS_GPU(double);
+#undef REGISTER_KERNELS_GPU
+#undef REGISTER_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace functor {
+
+template <typename T, typename Tindices>
+struct BlockSparseMatMulFunctor<CPUDevice, T, Tindices> {
+  using Matrix =
+      Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  using MatrixMap = Eigen::Map<Matrix>;
+  using ConstMatrixMap = Eigen::Map<const Matrix>;
+
+  static Status Compute(const CPUDevice& d, typename TTypes<T>::Matrix out,
+                        typename TTypes<T, 3>::ConstTensor a_block_values,
+                        typename TTypes<Tindices>::ConstVec a_block_col_indices,
+                        typename TTypes<Tindices>::ConstVec a_block_row_ptr,
+                        typename TTypes<T>::ConstMatrix b) {
+    const int64 num_blocks = a_block_values.dimension(0);
+    const int64 block_rows = a_block_values.dimension(1);
+    const int64 block_cols = a_block_values.dimension(2);
+    const int64 num_block_rows = a_block_row_ptr.size() - 1;
+    const int64 num_block_cols = b.dimension(0) / block_cols;
+    const int64 n = b.dimension(1);
+
+    // Validate all indices up front so that the workers below cannot fail.
+    if (internal::SubtleMustCopy(a_block_row_ptr(0)) != 0 ||
+        internal::SubtleMustCopy(a_block_row_ptr(num_block_rows)) !=
+            num_blocks) {
+      return errors::InvalidArgument(
+          "a_block_row_ptr must start at 0 and end at the number of blocks (",
+          num_blocks, "), got ", a_block_row_ptr(0), " and ",
+          a_block_row_ptr(num_block_rows));
+    }
+    for (int64 i = 0; i < num_block_rows; ++i) {
+      if (a_block_row_ptr(i) > a_block_row_ptr(i + 1)) {
+        return errors::InvalidArgument("a_block_row_ptr is not sorted at ", i);
+      }
+    }
+    for (int64 i = 0; i < num_blocks; ++i) {
+      const Tindices col = internal::SubtleMustCopy(a_block_col_indices(i));
+      if (!FastBoundsCheck(col, num_block_cols)) {
+        return errors::InvalidArgument("a_block_col_indices[", i, "] = ", col,
+                                       " is not in [0, ", num_block_cols, ")");
+      }
+    }
+
+    // Every block row of the output is written by exactly one worker, as the
+    // sum of a dense block-times-rows product per stored block. The products
+    // use Eigen's vectorized GEMM kernels.
+    const T* a_data = a_block_values.data();
+    const T* b_data = b.data();
+    T* out_data = out.data();
+    auto work = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        MatrixMap out_rows(out_data + i * block_rows * n, block_rows, n);
+        out_rows.setZero();
+        const int64 first = a_block_row_ptr(i);
+        const int64 last = a_block_row_ptr(i + 1);
+        for (int64 k = first; k < last; ++k) {
+          const int64 col = a_block_col_indices(k);
+          ConstMatrixMap a_block(a_data + k * block_rows * block_cols,
+                                 block_rows, block_cols);
+          ConstMatrixMap b_rows(b_data + col * block_cols * n, block_cols, n);
+          out_rows.noalias() += a_block * b_rows;
+        }
+      }
+    };
+
+    const double blocks_per_row =
+        static_cast<double>(num_blocks) / std::max<int64>(num_block_rows, 1);
+    const double bytes_loaded =
+        blocks_per_row * block_cols * (block_rows + n) * sizeof(T);
+    const double bytes_stored = block_rows * n * sizeof(T);
+    const double compute_cycles =
+        blocks_per_row * block_rows * block_cols * n *
+        (Eigen::TensorOpCost::AddCost<T>() + Eigen::TensorOpCost::MulCost<T>());
+    d.parallelFor(num_block_rows,
+                  Eigen::TensorOpCost(bytes_loaded, bytes_stored,
+                                      compute_cycles),
+                  work);
+    return Status::OK();
+  }
+};
+
+}  // namespace functor
+
+}  // namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BLOCK_SPARSE_MATMUL_OP_H_
+#define TENSORFLOW_CORE_KERNELS_BLOCK_SPARSE_MATMUL_OP_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+namespace functor {
+
+// Computes out = A * b, where A is a block-sparse matrix in BSR format. Every
+// stored block is a dense [block_rows, block_cols] tile of A, and
+// a_block_col_indices holds its block column. The blocks of block row i are
+// the entries a_block_row_ptr(i) through a_block_row_ptr(i + 1) - 1 of
+// a_block_values. Block rows without blocks produce zero rows of 'out'.
+//
+// The CPU implementation returns InvalidArgument for malformed indices. The GPU
+// implementation cannot signal errors and ignores blocks whose indices are out
+// of range instead.
+template <typename Device, typename T, typename Tindices>
+struct BlockSparseMatMulFunctor {
+  static Status Compute(const Device& d, typename TTypes<T>::Matrix out,
+                        typename TTypes<T, 3>::ConstTensor a_block_values,
+                        typename TTypes<Tindices>::ConstVec a_block_col_indices,
+                        typename TTypes<Tindices>::ConstVec a_block_row_ptr,
+                        typename TTypes<T>::ConstMatrix b);
+};
+
+}  // end namespace functor
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BLOCK_SPARSE_MATMUL_OP_H_
@@ -0,0 +1,101 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/kernels/block_sparse_matmul_op.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Each thread computes one element of the output by walking the blocks of its
+// block row. Consecutive threads handle consecutive columns of the same row,
+// so they read the same elements of A and coalesced rows of B. Since every
+// output element has a single writer, no atomics are needed.
+template <typename T, typename Tindices>
+__global__ void BlockSparseMatMulKernel(
+    int64 output_size, int64 n, int64 block_rows, int64 block_cols,
+    int64 num_blocks, int64 num_block_cols,
+    const T* __restrict__ a_block_values,
+    const Tindices* __restrict__ a_block_col_indices,
+    const Tindices* __restrict__ a_block_row_ptr, const T* __restrict__ b,
+    T* __restrict__ out) {
+  for (int64 index : GpuGridRangeX(output_size)) {
+    const int64 row = index / n;
+    const int64 col = index % n;
+    const int64 block_row = row / block_rows;
+    const int64 row_in_block = row % block_rows;
+    // Out-of-range row pointers are clamped; there is nowhere to signal an
+    // error.
+    int64 first = ldg(a_block_row_ptr + block_row);
+    int64 last = ldg(a_block_row_ptr + block_row + 1);
+    if (first < 0) first = 0;
+    if (last > num_blocks) last = num_blocks;
+    T sum(0);
+    for (int64 k = first; k < last; ++k) {
+      const int64 block_col = ldg(a_block_col_indices + k);
+      if (!FastBoundsCheck(block_col, num_block_cols)) continue;
+      const T* a_row =
+          a_block_values + (k * block_rows + row_in_block) * block_cols;
+      const T* b_col = b + block_col * block_cols * n + col;
+      for (int64 j = 0; j < block_cols; ++j) {
+        sum += ldg(a_row + j) * ldg(b_col + j * n);
+      }
+    }
+    out[index] = sum;
+  }
+}
+
+namespace functor {
+
+template <typename T, typename Tindices>
+struct BlockSparseMatMulFunctor<GPUDevice, T, Tindices> {
+  static Status Compute(const GPUDevice& d, typename TTypes<T>::Matrix out,
+                        typename TTypes<T, 3>::ConstTensor a_block_values,
+                        typename TTypes<Tindices>::ConstVec a_block_col_indices,
+                        typename TTypes<Tindices>::ConstVec a_block_row_ptr,
+                        typename TTypes<T>::ConstMatrix b) {
+    const int64 output_size = out.size();
+    const int64 block_cols = a_block_values.dimension(2);
+    GpuLaunchConfig config = GetGpuLaunchConfig(output_size, d);
+    TF_CHECK_OK(GpuLaunchKernel(
+        BlockSparseMatMulKernel<T, Tindices>, config.block_count,
+        config.thread_per_block, 0, d.stream(), output_size, out.dimension(1),
+        a_block_values.dimension(1), block_cols, a_block_values.dimension(0),
+        b.dimension(0) / block_cols, a_block_values.data(),
+        a_block_col_indices.data(), a_block_row_ptr.data(), b.data(),
+        out.data()));
+    return Status::OK();
+  }
+};
+
+}  // namespace functor
+
+#define DEFINE(T)                                                         \
+  template struct functor::BlockSparseMatMulFunctor<GPUDevice, T, int32>; \
+  template struct functor::BlockSparseMatMulFunctor<GPUDevice, T, int64>;
+
+DEFINE(float);
+DEFINE(double);
+#undef DEFINE
+
+}  // end namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
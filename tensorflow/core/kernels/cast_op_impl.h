@@ -18,8 +18,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include "tensorflow/core/framework/dtype_conversion.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/cast_op.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -63,6 +65,37 @@ CAST_FUNCTORS(Eigen::ThreadPoolDevice);
     };                                                                    \
   }
 
+// Casts `inp` into `out` with `convert`, one of the bulk conversions of
+// framework/dtype_conversion.h, in parallel on the CPU worker threads.
+template <typename IN, typename OUT>
+void BulkCastOnCpu(OpKernelContext* ctx, const Tensor& inp, Tensor* out,
+                   void (*convert)(const IN*, OUT*, int64)) {
+  const IN* src = inp.flat<IN>().data();
+  OUT* dst = out->flat<OUT>().data();
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        inp.NumElements(), /*cost_per_unit=*/1,
+        [src, dst, convert](int64 begin, int64 end) {
+          convert(src + begin, dst + begin, end - begin);
+        });
+}
+
+// Same as CAST_CASE for the CPU, but with a bulk conversion.  Truncating
+// casts still use the Eigen functor.
+#define BULK_CAST_CASE(IN, OUT, CONVERT)                              \
+  if (DataTypeToEnum<OUT>::value == dst_dtype) {                      \
+    return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out,   \
+              bool truncate) {                                        \
+      if (truncate) {                                                 \
+        functor::CastFunctor<Eigen::ThreadPoolDevice, OUT, IN> func;  \
+        func(ctx->eigen_device<Eigen::ThreadPoolDevice>(),            \
+             out->flat<OUT>(), inp.flat<IN>(), truncate);             \
+      } else {                                                        \
+        BulkCastOnCpu<IN, OUT>(ctx, inp, out, CONVERT);               \
+      }                                                               \
+    };                                                                \
+  }
+
 // The functions below are implemented in the cast_op_impl_*.cc files.
 CastFunctorType GetCpuCastFromBool(DataType dst_dtype);
 
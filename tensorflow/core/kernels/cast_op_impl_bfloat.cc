@@ -23,6 +23,7 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromBfloat(DataType dst_dtype) {
+  BULK_CAST_CASE(bfloat16, float, ConvertBFloat16ToFloat);
   CURRY_TYPES3(CAST_CASE, CPUDevice, bfloat16);
   return nullptr;
 }
@@ -23,6 +23,8 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromFloat(DataType dst_dtype) {
+  BULK_CAST_CASE(float, bfloat16, ConvertFloatToBFloat16);
+  BULK_CAST_CASE(float, Eigen::half, ConvertFloatToHalf);
   CURRY_TYPES3(CAST_CASE, CPUDevice, float);
   return nullptr;
 }
@@ -21,6 +21,7 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromHalf(DataType dst_dtype) {
+  BULK_CAST_CASE(Eigen::half, float, ConvertHalfToFloat);
   CURRY_TYPES3(CAST_CASE, CPUDevice, Eigen::half);
   return nullptr;
 }
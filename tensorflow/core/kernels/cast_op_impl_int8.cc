@@ -21,6 +21,7 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromInt8(DataType dst_dtype) {
+  BULK_CAST_CASE(int8, float, ConvertInt8ToFloat);
   CURRY_TYPES3(CAST_CASE, CPUDevice, int8);
   return nullptr;
 }
@@ -21,6 +21,7 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 CastFunctorType GetCpuCastFromUint8(DataType dst_dtype) {
+  BULK_CAST_CASE(uint8, float, ConvertUint8ToFloat);
   CURRY_TYPES3(CAST_CASE, CPUDevice, uint8);
   return nullptr;
 }
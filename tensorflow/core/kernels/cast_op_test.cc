@@ -73,6 +73,22 @@ class CastOpTest : public OpsTestBase {
                              {OUTPUT(1), OUTPUT(2), OUTPUT(3), OUTPUT(4)});
     test::ExpectTensorEqual<OUTPUT>(expected, *GetOutput(0));
   }
+
+  // Casts enough values to be converted in several shards, and not a multiple
+  // of the vector widths of the bulk conversions.
+  template <typename OUTPUT>
+  void CheckLargeCastFromFloat() {
+    const int64 n = 100003;
+    std::vector<float> values(n);
+    for (int64 i = 0; i < n; ++i) values[i] = (i - n / 2) * 0.37f;
+    MakeOp(DT_FLOAT, DataTypeToEnum<OUTPUT>::v(), false);
+    AddInputFromArray<float>(TensorShape({n}), values);
+    TF_ASSERT_OK(RunOpKernel());
+    Tensor expected(allocator(), DataTypeToEnum<OUTPUT>::v(), TensorShape({n}));
+    expected.flat<OUTPUT>() =
+        test::AsTensor<float>(values).flat<float>().template cast<OUTPUT>();
+    test::ExpectTensorEqual<OUTPUT>(expected, *GetOutput(0));
+  }
 };
 
 #define TEST_CAST(in, out)                                                   \
@@ -119,6 +135,14 @@ TEST_ALL_CASTS_FROM(quint16)
 #undef TEST_ALL_CASTS_FROM
 #undef TEST_CAST
 
+TEST_F(CastOpTest, LargeFloatToBFloat16) {
+  CheckLargeCastFromFloat<bfloat16>();
+}
+
+TEST_F(CastOpTest, LargeFloatToHalf) {
+  CheckLargeCastFromFloat<Eigen::half>();
+}
+
 // TODO(wicke): check conversions from/to bool, and bfloat16
 
 static void BM_cpu_float_int64(::testing::benchmark::State& state) {
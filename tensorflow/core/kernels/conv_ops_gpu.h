@@ -18,6 +18,7 @@ limitations under the License.
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <algorithm>
 #include <tuple>
 #include <unordered_map>
 
@@ -52,7 +53,18 @@ class DnnScratchAllocator : public se::ScratchAllocator {
  public:
   virtual ~DnnScratchAllocator() {}
   DnnScratchAllocator(int64 memory_limit, OpKernelContext* context)
-      : memory_limit_(memory_limit), total_byte_size_(0), context_(context) {}
+      : memory_limit_(memory_limit), total_byte_size_(0), context_(context) {
+    if (ConvWorkspaceSlowdown() > 0) {
+      // Let autotuning pass over the algorithms that need more scratch memory
+      // than the device has free, instead of failing to allocate it.
+      auto stats =
+          context->device()->GetAllocator(AllocatorAttributes())->GetStats();
+      if (stats && stats->bytes_limit) {
+        memory_limit_ = std::min(memory_limit_,
+                                 *stats->bytes_limit - stats->bytes_in_use);
+      }
+    }
+  }
   int64 GetMemoryLimitInBytes() override { return memory_limit_; }
   se::port::StatusOr<se::DeviceMemory<uint8>> AllocateBytes(
       int64 byte_size) override {
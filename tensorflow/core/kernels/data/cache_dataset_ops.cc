@@ -14,16 +14,22 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_replace.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/hash_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/serialization_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -45,9 +51,12 @@ constexpr char kPaddingSizeStrFormat[] = "%zu";
 constexpr char kFileDatasetPrefix[] = "File";
 constexpr char kMode[] = "Mode";
 constexpr char kLockFileSuffix[] = ".lockfile";
+constexpr char kPublishedSuffix[] = ".published";
+constexpr char kFingerprintPlaceholder[] = "{fingerprint}";
 constexpr char kIterationCompleted[] = "iteration_completed";
 constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
+constexpr char kCachePrefix[] = "cache_prefix";
 constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
 constexpr char kMemoryCache[] = "MemoryCache";
@@ -70,11 +79,15 @@ constexpr char kIncompleteCacheErrorMessage[] =
 
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
+  // `cache_prefix` is the prefix of the cache files, which is `filename` with
+  // the fingerprint of `input` substituted for `kFingerprintPlaceholder`.
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                  string filename, Env* env)
+                  string filename, string cache_prefix, Env* env)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
+        cache_prefix_(std::move(cache_prefix)),
+        shared_(absl::StrContains(filename_, kFingerprintPlaceholder)),
         env_(env),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
@@ -126,6 +139,30 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   const tstring filename_;
 
  private:
+  // Returns whether the cache has been completely written, and if so stores
+  // the prefix of its tensor bundle in `prefix`.
+  //
+  // A shared cache (one whose filename contains `kFingerprintPlaceholder`) can
+  // be filled by several jobs at the same time. Each of them writes a bundle
+  // of its own, and the first one to finish publishes it by atomically
+  // creating `<cache_prefix_>.published`, which names the bundle.
+  bool FindCompleteCache(string* prefix) const {
+    if (!shared_) {
+      *prefix = cache_prefix_;
+      return env_->FileExists(MetaFilename(*prefix)).ok();
+    }
+    string bundle;
+    if (!ReadFileToString(env_, PublishedFilename(), &bundle).ok()) {
+      return false;
+    }
+    *prefix = io::JoinPath(io::Dirname(cache_prefix_), bundle);
+    return env_->FileExists(MetaFilename(*prefix)).ok();
+  }
+
+  string PublishedFilename() const {
+    return strings::StrCat(cache_prefix_, kPublishedSuffix);
+  }
+
   static size_t StringPaddingSize(size_t num_tensors) {
     return strings::Printf(kPaddingSizeStrFormat, num_tensors - 1).size();
   }
@@ -139,9 +176,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
    public:
     explicit FileIterator(const Params& params)
         : DatasetIterator<FileDatasetBase>(params) {
-      if (params.dataset->env_
-              ->FileExists(MetaFilename(params.dataset->filename_))
-              .ok()) {
+      if (params.dataset->FindCompleteCache(&complete_cache_prefix_)) {
         mode_ = Mode::read;
       } else {
         mode_ = Mode::write;
@@ -182,14 +217,12 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         mode_ = static_cast<Mode>(temp);
       }
       if (mode_ == Mode::write &&
-          dataset()
-              ->env_->FileExists(MetaFilename(dataset()->filename_))
-              .ok()) {
+          dataset()->FindCompleteCache(&complete_cache_prefix_)) {
         // This could happen if the cache was completely written after the
         // checkpoint was saved.
         LOG(WARNING)
             << "It looks like the cache was already completely written("
-            << MetaFilename(dataset()->filename_)
+            << MetaFilename(complete_cache_prefix_)
             << ") after the last checkpoint was saved. Attempting to read "
             << "the cache instead of continuing to write. If this is a "
             << "mistake, please remove the above file and try running again.";
@@ -216,14 +249,25 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     // partial cache gets flushed to disk in files with prefix
     // <filename>_<shard_id> where shard_id is unique for each checkpoint.
     // When all elements have been produced, these shards get coalesced.
+    //
+    // Each writer of a shared cache writes to a bundle with the prefix
+    // <cache_prefix>_<writer id>, and publishes it if no other writer has
+    // published its bundle by the time all elements have been produced.
+    // Otherwise, the bundle is deleted.
     class FileWriterIterator : public DatasetIterator<FileDatasetBase> {
      public:
       explicit FileWriterIterator(const Params& params)
           : DatasetIterator<FileDatasetBase>(params),
             cur_index_(0),
             shard_id_(0),
-            filename_(
-                strings::StrCat(params.dataset->filename_, "_", shard_id_)),
+            cache_prefix_(params.dataset->shared_
+                              ? strings::Printf(
+                                    "%s_%016llx",
+                                    params.dataset->cache_prefix_.c_str(),
+                                    static_cast<unsigned long long>(
+                                        random::New64()))
+                              : params.dataset->cache_prefix_),
+            filename_(strings::StrCat(cache_prefix_, "_", shard_id_)),
             lockfile_(strings::StrCat(filename_, kLockFileSuffix)),
             lockfile_created_(false),
             iteration_completed_(false) {}
@@ -334,12 +378,16 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
 
           // Start caching to a new shard.
           shard_id_++;
-          filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
+          filename_ = strings::StrCat(cache_prefix_, "_", shard_id_);
           lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
           lockfile_created_ = false;
         }
         TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kShardId), shard_id_));
+        if (dataset()->shared_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kCachePrefix), cache_prefix_));
+        }
         return Status::OK();
       }
 
@@ -373,7 +421,13 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
             return errors::Internal("Invalid value for shard_id ", temp);
           }
         }
-        filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
+        if (dataset()->shared_) {
+          tstring cache_prefix;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name(kCachePrefix), &cache_prefix));
+          cache_prefix_ = cache_prefix;
+        }
+        filename_ = strings::StrCat(cache_prefix_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
         writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
         return Status::OK();
@@ -457,28 +511,58 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           std::vector<tstring> prefixes;
           prefixes.reserve(shard_id_ + 1);
           for (size_t i = 0; i <= shard_id_; ++i) {
-            prefixes.emplace_back(
-                strings::StrCat(dataset()->filename_, "_", i));
+            prefixes.emplace_back(strings::StrCat(cache_prefix_, "_", i));
           }
           TF_RETURN_IF_ERROR(
-              MergeBundles(dataset()->env_, prefixes, dataset()->filename_));
+              MergeBundles(dataset()->env_, prefixes, cache_prefix_));
         }
         // Delete all lockfiles.
         for (size_t i = 0; i <= shard_id_; ++i) {
           TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(
-              strings::StrCat(dataset()->filename_, "_", i, kLockFileSuffix)));
+              strings::StrCat(cache_prefix_, "_", i, kLockFileSuffix)));
+        }
+        if (dataset()->shared_) {
+          return Publish();
         }
         return Status::OK();
       }
 
+      // Publishes the bundle of this writer as the shared cache, unless
+      // another writer has already published its bundle.
+      Status Publish() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Env* env = dataset()->env_;
+        const string published = dataset()->PublishedFilename();
+        if (env->FileExists(published).ok()) {
+          VLOG(1) << "Discarding " << cache_prefix_
+                  << " since the cache has already been published to "
+                  << published;
+          std::vector<string> cache_files;
+          TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+              strings::StrCat(cache_prefix_, "*"), &cache_files));
+          for (const string& path : cache_files) {
+            TF_RETURN_IF_ERROR(env->DeleteFile(path));
+          }
+          return Status::OK();
+        }
+        // Readers only see the bundle once it has been completely written,
+        // since the rename is atomic.
+        const string tmp = strings::StrCat(cache_prefix_, kPublishedSuffix);
+        TF_RETURN_IF_ERROR(WriteStringToFile(
+            env, tmp, io::Basename(cache_prefix_)));
+        return env->RenameFile(tmp, published);
+      }
+
       mutex mu_;
       size_t cur_index_ TF_GUARDED_BY(mu_);
       // Index of the current shard. This gets incremented whenever a new
       // cache shard is saved.
       size_t shard_id_ TF_GUARDED_BY(mu_);
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+      // The prefix of the bundle written by this iterator. This is
+      // `dataset()->cache_prefix_` unless the cache is shared.
+      string cache_prefix_ TF_GUARDED_BY(mu_);
       // The current prefix for the cache file. This is equal to
-      // `StrCat(dataset()->filename_, "_", shard_id_)`.
+      // `StrCat(cache_prefix_, "_", shard_id_)`.
       string filename_;
       std::unique_ptr<BundleWriter> writer_ TF_GUARDED_BY(mu_);
       string lockfile_ TF_GUARDED_BY(mu_);
@@ -488,10 +572,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
 
     class FileReaderIterator : public DatasetIterator<FileDatasetBase> {
      public:
-      explicit FileReaderIterator(const Params& params)
+      FileReaderIterator(const Params& params, const string& cache_prefix)
           : DatasetIterator<FileDatasetBase>(params),
             cur_index_(0),
-            reader_(dataset()->env_, dataset()->filename_),
+            reader_(dataset()->env_, cache_prefix),
             iterator_restored_(false) {}
 
       Status GetNextInternal(IteratorContext* ctx,
@@ -588,8 +672,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       switch (mode_) {
         case Mode::read:
           iterator_ =
-              absl::make_unique<FileReaderIterator>(FileReaderIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+              absl::make_unique<FileReaderIterator>(
+                  FileReaderIterator::Params{
+                      dataset(), strings::StrCat(prefix(), kImpl)},
+                  complete_cache_prefix_);
           break;
         case Mode::write:
           iterator_ =
@@ -603,9 +689,13 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     mutex mu_;
     enum Mode { read, write };
     Mode mode_ TF_GUARDED_BY(mu_);
+    // The prefix of the completely written cache that is read in read mode.
+    string complete_cache_prefix_ TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> iterator_ TF_GUARDED_BY(mu_);
   };  // FileIterator
 
+  const string cache_prefix_;
+  const bool shared_;
   Env* const env_;
   const size_t num_tensors_;
   const size_t tensor_index_padding_size_;
@@ -634,9 +724,10 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
  public:
   explicit FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
-                         string filename, Env* env,
+                         string filename, string cache_prefix, Env* env,
                          const Tensor& resource_handle)
-      : FileDatasetBase(ctx, input, filename, env),
+      : FileDatasetBase(ctx, input, std::move(filename),
+                        std::move(cache_prefix), env),
         resource_handle_(resource_handle) {}
 
  protected:
@@ -1066,11 +1157,29 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       *output = new MemoryDataset(ctx, input, manager, std::move(handle));
     }
   } else {
+    string cache_prefix = filename;
+    if (absl::StrContains(filename, kFingerprintPlaceholder)) {
+      // Caches of datasets with the same graph share their files.
+      GraphDef graph_def;
+      SerializationContext::Params params;
+      std::vector<std::pair<string, Tensor>> input_list;
+      params.input_list = &input_list;
+      params.external_state_policy =
+          SerializationContext::ExternalStatePolicy::kIgnore;
+      OP_REQUIRES_OK(ctx, AsGraphDef(ctx, input, SerializationContext(params),
+                                     &graph_def));
+      uint64 hash;
+      OP_REQUIRES_OK(ctx, HashGraph(graph_def, &hash));
+      cache_prefix = absl::StrReplaceAll(
+          filename, {{kFingerprintPlaceholder,
+                      strings::Printf("%016llx",
+                                      static_cast<unsigned long long>(hash))}});
+    }
     if (op_version_ == 2) {
-      *output =
-          new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
+      *output = new FileDatasetV2(ctx, input, filename, cache_prefix,
+                                  ctx->env(), ctx->input(2));
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, cache_prefix, ctx->env());
     }
   }
 }
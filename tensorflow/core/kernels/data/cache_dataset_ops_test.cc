@@ -199,6 +199,61 @@ TEST_P(ParameterizedGetNextTest, GetNext) {
 INSTANTIATE_TEST_SUITE_P(CacheDatasetOpTest, ParameterizedGetNextTest,
                          ::testing::ValuesIn(GetNextTestCases()));
 
+TEST_F(CacheDatasetOpTest, SharedCacheWithConcurrentWriters) {
+  const string cache_dir = io::JoinPath(testing::TmpDir(), "shared_cache");
+  auto dataset_params = CacheDatasetParams(
+      TensorSliceDatasetParams(
+          /*components=*/{CreateTensor<int64>(TensorShape{3, 1}, {0, 1, 2})},
+          /*node_name=*/"tensor_slice"),
+      /*filename=*/io::JoinPath(cache_dir, "{fingerprint}"),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})}, kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs =
+      CreateTensors<int64>(TensorShape({1}), {{0}, {1}, {2}});
+
+  // Both iterators fill the cache since neither finds a published cache.
+  std::unique_ptr<IteratorBase> other_iterator;
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &other_iterator));
+  for (IteratorBase* iterator : {iterator_.get(), other_iterator.get()}) {
+    bool end_of_sequence = false;
+    std::vector<Tensor> out_tensors;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    }
+    TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                             /*compare_order=*/true));
+  }
+  std::vector<string> published;
+  TF_ASSERT_OK(device_->env()->GetMatchingPaths(
+      io::JoinPath(cache_dir, "*.published"), &published));
+  EXPECT_EQ(1, published.size());
+
+  // The cache is read from the bundle of the writer that finished first.
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_EXPECT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/true));
+
+  int64 undeleted_files, undeleted_dirs;
+  TF_EXPECT_OK(device_->env()->DeleteRecursively(cache_dir, &undeleted_files,
+                                                 &undeleted_dirs));
+}
+
 TEST_F(CacheDatasetOpTest, DatasetNodeName) {
   auto dataset_params = CacheDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
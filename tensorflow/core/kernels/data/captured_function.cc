@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/stats_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/optional.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -100,6 +101,8 @@ class SimpleStepStatsCollector : public StepStatsCollectorInterface {
 
     void SetScheduled(int64 nanos) override {}
 
+    void SetScheduledInline(bool scheduled_inline) override {}
+
    private:
     int64 start_time_ns_ = 0;
     int64 end_time_ns_ = 0;
@@ -317,7 +320,9 @@ class CallFrameBase : public CallFrameInterface {
 
  private:
   DataTypeSlice ret_types_;
-  std::vector<gtl::optional<Tensor>> retvals_;
+  // Inlined, so that frames of functions with few return values do not
+  // allocate on every element.
+  gtl::InlinedVector<gtl::optional<Tensor>, 4> retvals_;
   TF_DISALLOW_COPY_AND_ASSIGN(CallFrameBase);
 };
 
@@ -849,13 +854,13 @@ Status InstantiatedCapturedFunction::Run(
   CancellationManager cancellation_manager(ctx->cancellation_manager());
   f_opts.cancellation_manager = &cancellation_manager;
 
-  std::shared_ptr<SimpleStepStatsCollector> stats_collector;
+  // The function runs synchronously, so the collector can live on the stack.
+  SimpleStepStatsCollector stats_collector;
   if (node || ctx->stats_aggregator()) {
-    stats_collector = std::make_shared<SimpleStepStatsCollector>();
+    f_opts.stats_collector = &stats_collector;
   }
   const bool collect_usage =
       node && ctx->model() && ctx->model()->collect_resource_usage();
-  f_opts.stats_collector = stats_collector.get();
 
   OwnedArgsCallFrame frame(std::move(args), &captured_func_->captured_inputs(),
                            ret_types_);
@@ -876,10 +881,10 @@ Status InstantiatedCapturedFunction::Run(
           node->name(), stats_utils::kDelimiter, captured_func_->func().name());
       ctx->stats_aggregator()->AddToHistogram(
           stats_utils::ExecutionTimeHistogramName(prefix_with_func_name),
-          {static_cast<float>(stats_collector->processing_time())},
+          {static_cast<float>(stats_collector.processing_time())},
           node->num_elements());
     }
-    node->add_processing_time(stats_collector->processing_time());
+    node->add_processing_time(stats_collector.processing_time());
     if (collect_usage) node->record_start(EnvTime::NowNanos());
   } else {
     TF_RETURN_IF_ERROR(lib_->RunSync(std::move(f_opts), f_handle_, &frame));
@@ -912,13 +917,13 @@ Status InstantiatedCapturedFunction::RunWithBorrowedArgs(
   CancellationManager cancellation_manager(ctx->cancellation_manager());
   f_opts.cancellation_manager = &cancellation_manager;
 
-  std::shared_ptr<SimpleStepStatsCollector> stats_collector;
+  // The function runs synchronously, so the collector can live on the stack.
+  SimpleStepStatsCollector stats_collector;
   if (node || ctx->stats_aggregator()) {
-    stats_collector = std::make_shared<SimpleStepStatsCollector>();
+    f_opts.stats_collector = &stats_collector;
   }
   const bool collect_usage =
       node && ctx->model() && ctx->model()->collect_resource_usage();
-  f_opts.stats_collector = stats_collector.get();
 
   BorrowedArgsCallFrame frame(args, &captured_func_->captured_inputs(),
                               ret_types_);
@@ -938,10 +943,10 @@ Status InstantiatedCapturedFunction::RunWithBorrowedArgs(
           node->name(), stats_utils::kDelimiter, captured_func_->func().name());
       ctx->stats_aggregator()->AddToHistogram(
           stats_utils::ExecutionTimeHistogramName(prefix_with_func_name),
-          {static_cast<float>(stats_collector->processing_time())},
+          {static_cast<float>(stats_collector.processing_time())},
           node->num_elements());
     }
-    node->add_processing_time(stats_collector->processing_time());
+    node->add_processing_time(stats_collector.processing_time());
     if (collect_usage) node->record_start(EnvTime::NowNanos());
   } else {
     TF_RETURN_IF_ERROR(lib_->RunSync(std::move(f_opts), f_handle_, &frame));
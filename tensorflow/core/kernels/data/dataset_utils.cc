@@ -33,7 +33,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/regexp.h"
+#include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -43,22 +47,60 @@ constexpr char kDelimiter[] = "@@";
 constexpr char kComponent[] = "component";
 constexpr char kNumElements[] = "num_elements";
 constexpr char kNumComponents[] = "num_components";
+
+// cgroup v1 reports the absence of a memory limit as a very large limit.
+constexpr int64 kCgroupV1UnlimitedRam = int64{1} << 62;
+
+// Reads the integer in the cgroup file `path`. Returns false if the file does
+// not exist or does not hold an integer (e.g. "max").
+bool ReadCgroupValue(const string& path, int64* value) {
+  string contents;
+  if (!ReadFileToString(Env::Default(), path, &contents).ok()) {
+    return false;
+  }
+  return strings::safe_strto64(str_util::StripSuffix(contents, "\n"), value);
+}
 }  // namespace
 
+Status WriteElementToCheckpoint(IteratorStateWriter* writer,
+                                StringPiece key_prefix, int64 index,
+                                const std::vector<Tensor>& element) {
+  std::string element_prefix = absl::StrCat(key_prefix, "::", index);
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(element_prefix, kNumComponents, element.size()));
+  for (int j = 0; j < element.size(); ++j) {
+    TF_RETURN_IF_ERROR(writer->WriteTensor(
+        element_prefix, absl::StrCat(kComponent, "[", j, "]"), element[j]));
+  }
+  return Status::OK();
+}
+
+Status ReadElementFromCheckpoint(IteratorStateReader* reader,
+                                 StringPiece key_prefix, int64 index,
+                                 std::vector<Tensor>* element) {
+  std::string element_prefix = absl::StrCat(key_prefix, "::", index);
+  int64 num_components;
+  TF_RETURN_IF_ERROR(
+      reader->ReadScalar(element_prefix, kNumComponents, &num_components));
+  element->clear();
+  element->reserve(num_components);
+  for (int j = 0; j < num_components; ++j) {
+    element->emplace_back();
+    TF_RETURN_IF_ERROR(reader->ReadTensor(
+        element_prefix, absl::StrCat(kComponent, "[", j, "]"),
+        &element->back()));
+  }
+  return Status::OK();
+}
+
 Status WriteElementsToCheckpoint(
     IteratorStateWriter* writer, StringPiece key_prefix,
     const std::vector<std::vector<Tensor>>& elements) {
   TF_RETURN_IF_ERROR(
       writer->WriteScalar(key_prefix, kNumElements, elements.size()));
   for (int i = 0; i < elements.size(); ++i) {
-    const std::vector<Tensor>& element = elements[i];
-    std::string element_prefix = absl::StrCat(key_prefix, "::", i);
     TF_RETURN_IF_ERROR(
-        writer->WriteScalar(element_prefix, kNumComponents, element.size()));
-    for (int j = 0; j < elements[i].size(); ++j) {
-      TF_RETURN_IF_ERROR(writer->WriteTensor(
-          element_prefix, absl::StrCat(kComponent, "[", j, "]"), element[j]));
-    }
+        WriteElementToCheckpoint(writer, key_prefix, i, elements[i]));
   }
   return Status::OK();
 }
@@ -71,19 +113,9 @@ Status ReadElementsFromCheckpoint(IteratorStateReader* reader,
       reader->ReadScalar(key_prefix, kNumElements, &num_elements));
   elements->reserve(num_elements);
   for (int i = 0; i < num_elements; ++i) {
-    std::string element_prefix = absl::StrCat(key_prefix, "::", i);
-    int64 num_components;
-    TF_RETURN_IF_ERROR(
-        reader->ReadScalar(element_prefix, kNumComponents, &num_components));
     elements->emplace_back();
-    std::vector<Tensor>& element = elements->at(i);
-    element.reserve(num_components);
-    for (int j = 0; j < num_components; ++j) {
-      element.emplace_back();
-      TF_RETURN_IF_ERROR(reader->ReadTensor(
-          element_prefix, absl::StrCat(kComponent, "[", j, "]"),
-          &element.back()));
-    }
+    TF_RETURN_IF_ERROR(
+        ReadElementFromCheckpoint(reader, key_prefix, i, &elements->at(i)));
   }
   return Status::OK();
 }
@@ -699,5 +731,59 @@ void StripDevicePlacement(FunctionDefLibrary* library) {
   }
 }
 
+int64 CgroupCpuLimit(const string& cgroup_root) {
+  int64 quota, period;
+  string cpu_max;
+  if (ReadFileToString(Env::Default(), io::JoinPath(cgroup_root, "cpu.max"),
+                       &cpu_max)
+          .ok()) {
+    // cgroup v2: "<quota> <period>", where the quota may be "max".
+    std::vector<string> fields =
+        str_util::Split(cpu_max, " \n", str_util::SkipEmpty());
+    if (fields.size() != 2 || !strings::safe_strto64(fields[0], &quota) ||
+        !strings::safe_strto64(fields[1], &period)) {
+      return 0;
+    }
+  } else {
+    // cgroup v1, where a quota of -1 means that there is none.
+    bool found = false;
+    for (const char* controller : {"cpu", "cpu,cpuacct"}) {
+      const string dir = io::JoinPath(cgroup_root, controller);
+      if (ReadCgroupValue(io::JoinPath(dir, "cpu.cfs_quota_us"), &quota) &&
+          ReadCgroupValue(io::JoinPath(dir, "cpu.cfs_period_us"), &period)) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) return 0;
+  }
+  if (quota <= 0 || period <= 0) {
+    return 0;
+  }
+  return (quota + period - 1) / period;
+}
+
+int64 CgroupAvailableRam(const string& cgroup_root) {
+  int64 limit, usage;
+  if (ReadCgroupValue(io::JoinPath(cgroup_root, "memory.max"), &limit)) {
+    // cgroup v2.
+    if (!ReadCgroupValue(io::JoinPath(cgroup_root, "memory.current"),
+                         &usage)) {
+      usage = 0;
+    }
+  } else {
+    // cgroup v1.
+    const string dir = io::JoinPath(cgroup_root, "memory");
+    if (!ReadCgroupValue(io::JoinPath(dir, "memory.limit_in_bytes"), &limit) ||
+        limit >= kCgroupV1UnlimitedRam) {
+      return -1;
+    }
+    if (!ReadCgroupValue(io::JoinPath(dir, "memory.usage_in_bytes"), &usage)) {
+      usage = 0;
+    }
+  }
+  return std::max(limit - usage, int64{0});
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -118,6 +118,20 @@ Status ReadElementsFromCheckpoint(IteratorStateReader* reader,
                                   StringPiece key_prefix,
                                   std::vector<std::vector<Tensor>>* elements);
 
+// Writes the `index`-th element of a list of elements to the checkpoint writer
+// using the given key prefix. This lets callers that do not hold the whole list
+// in memory write it one element at a time, using the same keys as
+// WriteElementsToCheckpoint.
+Status WriteElementToCheckpoint(IteratorStateWriter* writer,
+                                StringPiece key_prefix, int64 index,
+                                const std::vector<Tensor>& element);
+
+// Reads the `index`-th element of a list of elements from the checkpoint reader
+// using the given key prefix.
+Status ReadElementFromCheckpoint(IteratorStateReader* reader,
+                                 StringPiece key_prefix, int64 index,
+                                 std::vector<Tensor>* element);
+
 // Dataset op level determinism policy.
 class DeterminismPolicy {
  public:
@@ -302,6 +316,19 @@ std::vector<tstring> SelectOptimizations(
 // Removes device placements from the ops of all functions in `library`.
 void StripDevicePlacement(FunctionDefLibrary* library);
 
+// The mount point of the cgroup file system.
+constexpr char kCgroupRoot[] = "/sys/fs/cgroup";
+
+// Returns the number of CPUs that the CPU quota of the cgroup mounted at
+// `cgroup_root` grants, rounded up, or 0 if the cgroup has no CPU quota. Both
+// cgroup v1 and v2 are supported.
+int64 CgroupCpuLimit(const string& cgroup_root);
+
+// Returns the number of bytes that the cgroup mounted at `cgroup_root` may
+// still allocate before it reaches its memory limit, or -1 if the cgroup has
+// no memory limit. Both cgroup v1 and v2 are supported.
+int64 CgroupAvailableRam(const string& cgroup_root);
+
 }  // namespace data
 }  // namespace tensorflow
 
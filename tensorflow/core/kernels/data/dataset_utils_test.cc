@@ -23,6 +23,8 @@ limitations under the License.
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/work_sharder.h"
@@ -288,6 +290,56 @@ TEST(DatasetUtilsTest, DeterminismString) {
   }
 }
 
+// Writes `files`, given as paths relative to a new cgroup root and their
+// contents, and returns the root.
+string MakeCgroupRoot(
+    const string& name, const std::vector<std::pair<string, string>>& files) {
+  const string root = io::JoinPath(testing::TmpDir(), "cgroup_" + name);
+  TF_CHECK_OK(Env::Default()->RecursivelyCreateDir(root));
+  for (const auto& file : files) {
+    const string path = io::JoinPath(root, file.first);
+    TF_CHECK_OK(
+        Env::Default()->RecursivelyCreateDir(string(io::Dirname(path))));
+    TF_CHECK_OK(WriteStringToFile(Env::Default(), path, file.second));
+  }
+  return root;
+}
+
+TEST(DatasetUtilsTest, CgroupCpuLimit) {
+  string root = MakeCgroupRoot("cpu_v2", {{"cpu.max", "250000 100000\n"}});
+  EXPECT_EQ(3, CgroupCpuLimit(root));
+  root = MakeCgroupRoot("cpu_v2_max", {{"cpu.max", "max 100000\n"}});
+  EXPECT_EQ(0, CgroupCpuLimit(root));
+  root = MakeCgroupRoot("cpu_v1",
+                        {{"cpu,cpuacct/cpu.cfs_quota_us", "200000\n"},
+                         {"cpu,cpuacct/cpu.cfs_period_us", "100000\n"}});
+  EXPECT_EQ(2, CgroupCpuLimit(root));
+  root = MakeCgroupRoot("cpu_v1_unlimited",
+                        {{"cpu/cpu.cfs_quota_us", "-1\n"},
+                         {"cpu/cpu.cfs_period_us", "100000\n"}});
+  EXPECT_EQ(0, CgroupCpuLimit(root));
+  root = MakeCgroupRoot("cpu_none", {});
+  EXPECT_EQ(0, CgroupCpuLimit(root));
+}
+
+TEST(DatasetUtilsTest, CgroupAvailableRam) {
+  string root = MakeCgroupRoot(
+      "ram_v2", {{"memory.max", "1000\n"}, {"memory.current", "400\n"}});
+  EXPECT_EQ(600, CgroupAvailableRam(root));
+  root = MakeCgroupRoot("ram_v2_max", {{"memory.max", "max\n"}});
+  EXPECT_EQ(-1, CgroupAvailableRam(root));
+  root = MakeCgroupRoot("ram_v1",
+                        {{"memory/memory.limit_in_bytes", "1500\n"},
+                         {"memory/memory.usage_in_bytes", "500\n"}});
+  EXPECT_EQ(1000, CgroupAvailableRam(root));
+  root = MakeCgroupRoot(
+      "ram_v1_unlimited",
+      {{"memory/memory.limit_in_bytes", "9223372036854771712\n"}});
+  EXPECT_EQ(-1, CgroupAvailableRam(root));
+  root = MakeCgroupRoot("ram_none", {});
+  EXPECT_EQ(-1, CgroupAvailableRam(root));
+}
+
 TEST(DatasetUtilsTest, BoolConstructor) {
   EXPECT_TRUE(DeterminismPolicy(true).IsDeterministic());
   EXPECT_FALSE(DeterminismPolicy(true).IsNondeterministic());
@@ -0,0 +1,451 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/util/batch_util.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterMin;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFilterMax;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kNumRowGroups;
+
+namespace {
+
+constexpr char kCurrentFileIndex[] = "current_file_index";
+constexpr char kCurrentRowGroup[] = "current_row_group";
+
+// Converts the values of a filter column to `double`.
+template <typename T>
+void AppendValues(const Tensor& t, std::vector<double>* values) {
+  auto flat = t.flat<T>();
+  for (int64 i = 0; i < flat.size(); ++i) {
+    values->push_back(static_cast<double>(flat(i)));
+  }
+}
+
+Status FilterValues(const Tensor& t, StringPiece column,
+                    std::vector<double>* values) {
+  if (t.dims() != 1) {
+    return errors::InvalidArgument("Filter column ", column,
+                                   " must hold one value per row, but has "
+                                   "shape ",
+                                   t.shape().DebugString());
+  }
+  values->clear();
+  values->reserve(t.NumElements());
+  switch (t.dtype()) {
+    case DT_FLOAT:
+      AppendValues<float>(t, values);
+      break;
+    case DT_DOUBLE:
+      AppendValues<double>(t, values);
+      break;
+    case DT_INT32:
+      AppendValues<int32>(t, values);
+      break;
+    case DT_INT64:
+      AppendValues<int64>(t, values);
+      break;
+    default:
+      return errors::InvalidArgument("Filter column ", column,
+                                     " has unsupported type ",
+                                     DataTypeString(t.dtype()));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+/* static */ std::string ColumnarDatasetOp::ColumnKey(StringPiece column,
+                                                      int64 row_group) {
+  return strings::StrCat(column, "/", row_group);
+}
+
+/* static */ std::string ColumnarDatasetOp::MinKey(StringPiece column,
+                                                   int64 row_group) {
+  return strings::StrCat(ColumnKey(column, row_group), "/min");
+}
+
+/* static */ std::string ColumnarDatasetOp::MaxKey(StringPiece column,
+                                                   int64 row_group) {
+  return strings::StrCat(ColumnKey(column, row_group), "/max");
+}
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<tstring> filenames,
+          std::vector<tstring> columns, std::vector<tstring> filter_columns,
+          std::vector<double> filter_min, std::vector<double> filter_max,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        filter_columns_(std::move(filter_columns)),
+        filter_min_(std::move(filter_min)),
+        filter_max_(std::move(filter_max)),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override { return Status::OK(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* columns = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+    Node* filter_columns = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filter_columns_, &filter_columns));
+    Node* filter_min = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filter_min_, &filter_min));
+    Node* filter_max = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filter_max_, &filter_max));
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {filenames, columns, filter_columns, filter_min, filter_max},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (true) {
+        if (reader_) {
+          if (current_row_group_ < num_row_groups_) {
+            bool skipped = false;
+            TF_RETURN_IF_ERROR(ReadRowGroupLocked(ctx, current_row_group_++,
+                                                  out_tensors, &skipped));
+            if (!skipped) {
+              *end_of_sequence = false;
+              return Status::OK();
+            }
+            continue;
+          }
+          ResetStreamsLocked();
+          ++current_file_index_;
+          current_row_group_ = 0;
+        }
+        if (current_file_index_ == dataset()->filenames_.size()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
+                                             current_file_index_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentRowGroup),
+                                             current_row_group_));
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      ResetStreamsLocked();
+      int64 current_file_index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
+                                            &current_file_index));
+      current_file_index_ = static_cast<size_t>(current_file_index);
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentRowGroup),
+                                            &current_row_group_));
+      if (current_file_index_ < dataset()->filenames_.size()) {
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+      }
+      return Status::OK();
+    }
+
+   private:
+    // Reads the selected columns of `row_group` into `out_tensors`, keeping
+    // the rows that pass the filters. Sets `skipped` if no row passes them.
+    Status ReadRowGroupLocked(IteratorContext* ctx, int64 row_group,
+                              std::vector<Tensor>* out_tensors, bool* skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const Dataset* d = dataset();
+      // Prunes the row group using the statistics, if present.
+      for (size_t i = 0; i < d->filter_columns_.size(); ++i) {
+        const tstring& column = d->filter_columns_[i];
+        const std::string min_key = MinKey(column, row_group);
+        const std::string max_key = MaxKey(column, row_group);
+        if (!reader_->Contains(min_key) || !reader_->Contains(max_key)) {
+          continue;
+        }
+        Tensor min, max;
+        TF_RETURN_IF_ERROR(reader_->Lookup(min_key, &min));
+        TF_RETURN_IF_ERROR(reader_->Lookup(max_key, &max));
+        if (min.dtype() != DT_DOUBLE || max.dtype() != DT_DOUBLE ||
+            min.NumElements() != 1 || max.NumElements() != 1) {
+          return errors::DataLoss("Statistics of column ", column,
+                                  " in row group ", row_group,
+                                  " must be float64 scalars.");
+        }
+        if (max.flat<double>()(0) < d->filter_min_[i] ||
+            min.flat<double>()(0) > d->filter_max_[i]) {
+          *skipped = true;
+          return Status::OK();
+        }
+      }
+
+      // Evaluates the filters row by row. The filter columns are kept so that
+      // columns that are also selected are only read once.
+      absl::flat_hash_map<std::string, Tensor> columns;
+      std::vector<bool> keep;
+      int64 num_kept = -1;
+      std::vector<double> values;
+      for (size_t i = 0; i < d->filter_columns_.size(); ++i) {
+        const tstring& column = d->filter_columns_[i];
+        Tensor& t = columns[column];
+        if (!t.IsInitialized()) {
+          TF_RETURN_IF_ERROR(reader_->Lookup(ColumnKey(column, row_group), &t));
+        }
+        TF_RETURN_IF_ERROR(FilterValues(t, column, &values));
+        if (keep.empty()) {
+          keep.resize(values.size(), true);
+        } else if (keep.size() != values.size()) {
+          return errors::DataLoss("Column ", column, " in row group ",
+                                  row_group, " has ", values.size(),
+                                  " rows, expected ", keep.size());
+        }
+        num_kept = 0;
+        for (size_t row = 0; row < values.size(); ++row) {
+          keep[row] = keep[row] && values[row] >= d->filter_min_[i] &&
+                      values[row] <= d->filter_max_[i];
+          num_kept += keep[row];
+        }
+      }
+      if (num_kept == 0) {
+        *skipped = true;
+        return Status::OK();
+      }
+
+      const int64 num_rows = keep.size();
+      std::vector<Tensor> outputs;
+      outputs.reserve(d->columns_.size());
+      for (size_t i = 0; i < d->columns_.size(); ++i) {
+        const tstring& column = d->columns_[i];
+        Tensor t;
+        auto it = columns.find(column);
+        if (it != columns.end()) {
+          t = it->second;
+        } else {
+          TF_RETURN_IF_ERROR(reader_->Lookup(ColumnKey(column, row_group), &t));
+        }
+        if (t.dtype() != d->output_types_[i]) {
+          return errors::InvalidArgument(
+              "Column ", column, " has type ", DataTypeString(t.dtype()),
+              ", expected ", DataTypeString(d->output_types_[i]));
+        }
+        if (t.dims() == 0 ||
+            (!keep.empty() && t.dim_size(0) != num_rows)) {
+          return errors::DataLoss("Column ", column, " in row group ",
+                                  row_group, " has shape ",
+                                  t.shape().DebugString(), ", expected ",
+                                  num_rows, " rows");
+        }
+        if (num_kept > 0 && num_kept < t.dim_size(0)) {
+          TF_RETURN_IF_ERROR(SelectRows(ctx, t, keep, num_kept, &t));
+        }
+        if (!d->output_shapes_[i].IsCompatibleWith(t.shape())) {
+          return errors::InvalidArgument(
+              "Column ", column, " has shape ", t.shape().DebugString(),
+              ", which is incompatible with the output shape ",
+              d->output_shapes_[i].DebugString());
+        }
+        outputs.push_back(std::move(t));
+      }
+      *out_tensors = std::move(outputs);
+      return Status::OK();
+    }
+
+    // Copies the rows of `input` for which `keep` is set to `output`, one run
+    // of consecutive rows at a time.
+    static Status SelectRows(IteratorContext* ctx, const Tensor& input,
+                             const std::vector<bool>& keep, int64 num_kept,
+                             Tensor* output) {
+      TensorShape shape = input.shape();
+      shape.set_dim(0, num_kept);
+      Tensor selected(ctx->allocator({}), input.dtype(), shape);
+      const int64 num_rows = keep.size();
+      int64 dst_offset = 0;
+      for (int64 row = 0; row < num_rows;) {
+        if (!keep[row]) {
+          ++row;
+          continue;
+        }
+        int64 end = row;
+        while (end < num_rows && keep[end]) ++end;
+        TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+            input, row, dst_offset, end - row, &selected));
+        dst_offset += end - row;
+        row = end;
+      }
+      *output = std::move(selected);
+      return Status::OK();
+    }
+
+    Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (current_file_index_ >= dataset()->filenames_.size()) {
+        return errors::InvalidArgument(
+            "current_file_index_:", current_file_index_,
+            " >= filenames_.size():", dataset()->filenames_.size());
+      }
+      const string filename = dataset()->filenames_[current_file_index_];
+      auto reader = absl::make_unique<BundleReader>(env, filename);
+      TF_RETURN_IF_ERROR(reader->status());
+      Tensor num_row_groups;
+      TF_RETURN_IF_ERROR(reader->Lookup(kNumRowGroups, &num_row_groups));
+      if (num_row_groups.dtype() != DT_INT64 ||
+          num_row_groups.NumElements() != 1) {
+        return errors::DataLoss("The entry ", kNumRowGroups, " of ", filename,
+                                " must be an int64 scalar.");
+      }
+      num_row_groups_ = num_row_groups.flat<int64>()(0);
+      reader_ = std::move(reader);
+      return Status::OK();
+    }
+
+    void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      reader_.reset();
+      num_row_groups_ = 0;
+    }
+
+    mutex mu_;
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    int64 current_row_group_ TF_GUARDED_BY(mu_) = 0;
+    int64 num_row_groups_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<BundleReader> reader_ TF_GUARDED_BY(mu_);
+  };
+
+  const std::vector<tstring> filenames_;
+  const std::vector<tstring> columns_;
+  const std::vector<tstring> filter_columns_;
+  const std::vector<double> filter_min_;
+  const std::vector<double> filter_max_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  std::vector<tstring> filenames;
+  OP_REQUIRES_OK(ctx,
+                 ParseVectorArgument<tstring>(ctx, kFileNames, &filenames));
+  std::vector<tstring> columns;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<tstring>(ctx, kColumns, &columns));
+  std::vector<tstring> filter_columns;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<tstring>(ctx, kFilterColumns,
+                                                   &filter_columns));
+  std::vector<double> filter_min;
+  OP_REQUIRES_OK(ctx,
+                 ParseVectorArgument<double>(ctx, kFilterMin, &filter_min));
+  std::vector<double> filter_max;
+  OP_REQUIRES_OK(ctx,
+                 ParseVectorArgument<double>(ctx, kFilterMax, &filter_max));
+
+  OP_REQUIRES(ctx, !columns.empty(),
+              errors::InvalidArgument("At least one column must be selected."));
+  OP_REQUIRES(ctx,
+              columns.size() == output_types_.size() &&
+                  columns.size() == output_shapes_.size(),
+              errors::InvalidArgument(
+                  "`columns` must have one entry per output, but got ",
+                  columns.size(), " columns and ", output_types_.size(),
+                  " outputs."));
+  OP_REQUIRES(ctx,
+              filter_columns.size() == filter_min.size() &&
+                  filter_columns.size() == filter_max.size(),
+              errors::InvalidArgument(
+                  "`filter_columns`, `filter_min` and `filter_max` must have "
+                  "the same size."));
+
+  *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                        std::move(filter_columns), std::move(filter_min),
+                        std::move(filter_max), output_types_, output_shapes_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,67 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_DATASET_OP_H_
+
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Reads columnar files stored as tensor bundles. A file holds the scalar
+// `int64` entry `ColumnarDatasetOp::kNumRowGroups`, and for every row group
+// `i` and column `c` an entry `ColumnKey(c, i)` whose 0th dimension is the
+// number of rows of the group. Numeric columns may also store `float64`
+// scalar statistics under `MinKey(c, i)` and `MaxKey(c, i)`.
+//
+// Each row group is produced as one element that contains the selected
+// columns. Only the selected and filtered columns are read, and row groups
+// whose statistics show that no row matches the filters are skipped without
+// reading them.
+class ColumnarDatasetOp : public DatasetOpKernel {
+ public:
+  static constexpr const char* const kDatasetType = "Columnar";
+  static constexpr const char* const kFileNames = "filenames";
+  static constexpr const char* const kColumns = "columns";
+  static constexpr const char* const kFilterColumns = "filter_columns";
+  static constexpr const char* const kFilterMin = "filter_min";
+  static constexpr const char* const kFilterMax = "filter_max";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+
+  static constexpr const char* const kNumRowGroups = "num_row_groups";
+
+  static std::string ColumnKey(StringPiece column, int64 row_group);
+  static std::string MinKey(StringPiece column, int64 row_group);
+  static std::string MaxKey(StringPiece column, int64 row_group);
+
+  explicit ColumnarDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_DATASET_OP_H_
@@ -0,0 +1,246 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "columnar_dataset";
+constexpr int64 kNumRowGroups = 3;
+constexpr int64 kRowsPerGroup = 4;
+
+class ColumnarDatasetParams : public DatasetParams {
+ public:
+  ColumnarDatasetParams(std::vector<tstring> filenames,
+                        std::vector<tstring> columns,
+                        std::vector<tstring> filter_columns,
+                        std::vector<double> filter_min,
+                        std::vector<double> filter_max,
+                        DataTypeVector output_dtypes,
+                        std::vector<PartialTensorShape> output_shapes,
+                        string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        filter_columns_(std::move(filter_columns)),
+        filter_min_(std::move(filter_min)),
+        filter_max_(std::move(filter_max)) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {VectorTensor(filenames_), VectorTensor(columns_),
+            VectorTensor(filter_columns_), VectorTensor(filter_min_),
+            VectorTensor(filter_max_)};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ColumnarDatasetOp::kFileNames, ColumnarDatasetOp::kColumns,
+                    ColumnarDatasetOp::kFilterColumns,
+                    ColumnarDatasetOp::kFilterMin,
+                    ColumnarDatasetOp::kFilterMax};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attributes) const override {
+    *attributes = {{ColumnarDatasetOp::kOutputTypes, output_dtypes_},
+                   {ColumnarDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return ColumnarDatasetOp::kDatasetType;
+  }
+
+ private:
+  template <typename T>
+  static Tensor VectorTensor(const std::vector<T>& values) {
+    return CreateTensor<T>(TensorShape({static_cast<int64>(values.size())}),
+                           values);
+  }
+
+  std::vector<tstring> filenames_;
+  std::vector<tstring> columns_;
+  std::vector<tstring> filter_columns_;
+  std::vector<double> filter_min_;
+  std::vector<double> filter_max_;
+};
+
+class ColumnarDatasetOpTest : public DatasetOpsTestBase {};
+
+// Writes a file of `kNumRowGroups` row groups with the columns "id" (with
+// statistics) and "name", where "id" numbers the rows of the file from 0.
+// The column data of the row groups in `omitted_row_groups` is left out.
+tstring WriteColumnarFile(const string& name,
+                          const std::vector<int64>& omitted_row_groups = {}) {
+  const string prefix = io::JoinPath(testing::TmpDir(), name);
+  BundleWriter writer(Env::Default(), prefix);
+  TF_CHECK_OK(writer.Add(ColumnarDatasetOp::kNumRowGroups,
+                         CreateTensor<int64>(TensorShape({}),
+                                             {kNumRowGroups})));
+  for (int64 group = 0; group < kNumRowGroups; ++group) {
+    std::vector<int64> ids;
+    std::vector<tstring> names;
+    for (int64 row = 0; row < kRowsPerGroup; ++row) {
+      ids.push_back(group * kRowsPerGroup + row);
+      names.push_back(strings::StrCat("row_", ids.back()));
+    }
+    TF_CHECK_OK(writer.Add(
+        ColumnarDatasetOp::MinKey("id", group),
+        CreateTensor<double>(TensorShape({}), {static_cast<double>(ids[0])})));
+    TF_CHECK_OK(writer.Add(ColumnarDatasetOp::MaxKey("id", group),
+                           CreateTensor<double>(
+                               TensorShape({}),
+                               {static_cast<double>(ids.back())})));
+    if (std::find(omitted_row_groups.begin(), omitted_row_groups.end(),
+                  group) != omitted_row_groups.end()) {
+      continue;
+    }
+    TF_CHECK_OK(writer.Add(ColumnarDatasetOp::ColumnKey("id", group),
+                           CreateTensor<int64>(TensorShape({kRowsPerGroup}),
+                                               ids)));
+    TF_CHECK_OK(writer.Add(
+        ColumnarDatasetOp::ColumnKey("name", group),
+        CreateTensor<tstring>(TensorShape({kRowsPerGroup}), names)));
+  }
+  TF_CHECK_OK(writer.Finish());
+  return prefix;
+}
+
+// Reads the "id" column of every row group.
+ColumnarDatasetParams ProjectionParams() {
+  return {/*filenames=*/{WriteColumnarFile("projection")},
+          /*columns=*/{"id"},
+          /*filter_columns=*/{},
+          /*filter_min=*/{},
+          /*filter_max=*/{},
+          /*output_dtypes=*/{DT_INT64},
+          /*output_shapes=*/{PartialTensorShape({-1})},
+          /*node_name=*/kNodeName};
+}
+
+// Reads the rows with ids in [5, 9]. The first row group is pruned using the
+// statistics: its column data is missing from the file, so reading it would
+// fail.
+ColumnarDatasetParams FilterParams() {
+  return {/*filenames=*/{WriteColumnarFile("filter",
+                                           /*omitted_row_groups=*/{0})},
+          /*columns=*/{"name", "id"},
+          /*filter_columns=*/{"id"},
+          /*filter_min=*/{5},
+          /*filter_max=*/{9},
+          /*output_dtypes=*/{DT_STRING, DT_INT64},
+          /*output_shapes=*/
+          {PartialTensorShape({-1}), PartialTensorShape({-1})},
+          /*node_name=*/kNodeName};
+}
+
+ColumnarDatasetParams TwoFilesParams() {
+  return {/*filenames=*/{WriteColumnarFile("first"),
+                         WriteColumnarFile("second")},
+          /*columns=*/{"id"},
+          /*filter_columns=*/{"id"},
+          /*filter_min=*/{10},
+          /*filter_max=*/{100},
+          /*output_dtypes=*/{DT_INT64},
+          /*output_shapes=*/{PartialTensorShape({-1})},
+          /*node_name=*/kNodeName};
+}
+
+ColumnarDatasetParams WrongTypeParams() {
+  return {/*filenames=*/{WriteColumnarFile("wrong_type")},
+          /*columns=*/{"id"},
+          /*filter_columns=*/{},
+          /*filter_min=*/{},
+          /*filter_max=*/{},
+          /*output_dtypes=*/{DT_FLOAT},
+          /*output_shapes=*/{PartialTensorShape({-1})},
+          /*node_name=*/kNodeName};
+}
+
+std::vector<Tensor> ProjectionOutputs() {
+  return {CreateTensor<int64>(TensorShape({4}), {0, 1, 2, 3}),
+          CreateTensor<int64>(TensorShape({4}), {4, 5, 6, 7}),
+          CreateTensor<int64>(TensorShape({4}), {8, 9, 10, 11})};
+}
+
+std::vector<Tensor> FilterOutputs() {
+  return {CreateTensor<tstring>(TensorShape({3}), {"row_5", "row_6", "row_7"}),
+          CreateTensor<int64>(TensorShape({3}), {5, 6, 7}),
+          CreateTensor<tstring>(TensorShape({2}), {"row_8", "row_9"}),
+          CreateTensor<int64>(TensorShape({2}), {8, 9})};
+}
+
+std::vector<Tensor> TwoFilesOutputs() {
+  return {CreateTensor<int64>(TensorShape({2}), {10, 11}),
+          CreateTensor<int64>(TensorShape({2}), {10, 11})};
+}
+
+std::vector<GetNextTestCase<ColumnarDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/ProjectionParams(),
+           /*expected_outputs=*/ProjectionOutputs()},
+          {/*dataset_params=*/FilterParams(),
+           /*expected_outputs=*/FilterOutputs()},
+          {/*dataset_params=*/TwoFilesParams(),
+           /*expected_outputs=*/TwoFilesOutputs()}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                         GetNextTestCases());
+
+std::vector<IteratorSaveAndRestoreTestCase<ColumnarDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/ProjectionParams(),
+           /*breakpoints=*/{0, 1, 3},
+           /*expected_outputs=*/ProjectionOutputs()},
+          {/*dataset_params=*/FilterParams(),
+           /*breakpoints=*/{0, 1, 2},
+           /*expected_outputs=*/FilterOutputs()},
+          {/*dataset_params=*/TwoFilesParams(),
+           /*breakpoints=*/{0, 1, 2},
+           /*expected_outputs=*/TwoFilesOutputs()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                                 IteratorSaveAndRestoreTestCases());
+
+TEST_F(ColumnarDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = ProjectionParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ColumnarDatasetOp::kDatasetType)));
+}
+
+TEST_F(ColumnarDatasetOpTest, WrongColumnType) {
+  auto dataset_params = WrongTypeParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> next;
+  EXPECT_EQ(iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence)
+                .code(),
+            error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
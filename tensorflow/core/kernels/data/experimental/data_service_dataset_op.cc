@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/utils.h"
+#include "tensorflow/core/data/shared_memory_ring.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
@@ -35,12 +37,14 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/serialization_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -63,6 +67,40 @@ namespace data {
 namespace {
 // Default interval between task list refreshes.
 const int64 kDefaultTaskRefreshIntervalMs = 1000;  // 1 second.
+// Number of slots of the shared memory ring used to read from a worker on the
+// same host.
+const int64 kSharedMemoryRingSlots = 8;
+// Default size of a shared memory ring slot. Elements that don't fit in a slot
+// are sent over RPC.
+const int64 kDefaultSharedMemorySlotBytes = 4 << 20;  // 4MB.
+
+// Creates a shared memory ring through which a worker on the same host can
+// hand elements to this client without serializing them. Returns nullptr if
+// shared memory is disabled or not available, in which case elements are read
+// over RPC.
+std::unique_ptr<SharedMemoryRing> MaybeCreateSharedMemoryRing() {
+  int64 slot_bytes;
+  Status s = ReadInt64FromEnvVar("TF_DATA_SERVICE_SHARED_MEMORY_SLOT_BYTES",
+                                 kDefaultSharedMemorySlotBytes, &slot_bytes);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read TF_DATA_SERVICE_SHARED_MEMORY_SLOT_BYTES: "
+                 << s;
+    return nullptr;
+  }
+  if (slot_bytes <= 0) {
+    return nullptr;
+  }
+  const std::string name =
+      absl::StrCat("/tf_data_service_", absl::Hex(random::New64()));
+  std::unique_ptr<SharedMemoryRing> ring;
+  s = SharedMemoryRing::Create(name, kSharedMemoryRingSlots, slot_bytes, &ring);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to create shared memory ring " << name
+            << ", reading over RPC instead: " << s;
+    return nullptr;
+  }
+  return ring;
+}
 }  // namespace
 
 // Dataset for reading data from the tf.data service non-deterministically.
@@ -220,6 +258,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           &deregister_fn_));
       dispatcher_ = absl::make_unique<DataServiceDispatcherClient>(
           dataset()->address_, dataset()->protocol_);
+      locality_ = LocalLocality();
       int64 deadline_micros = kint64max;
       absl::optional<JobKey> key;
       if (!dataset()->job_name_.empty()) {
@@ -229,9 +268,9 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       }
       TF_RETURN_IF_ERROR(grpc_util::Retry(
           [&]() {
-            return dispatcher_->GetOrCreateJob(dataset()->dataset_id_,
-                                               dataset()->processing_mode_, key,
-                                               job_client_id_);
+            return dispatcher_->GetOrCreateJob(
+                dataset()->dataset_id_, dataset()->processing_mode_, key,
+                locality_, job_client_id_);
           },
           /*description=*/
           strings::StrCat("get or create job with dispatcher at ",
@@ -317,15 +356,25 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
 
    private:
     struct Task {
-      Task(int64 task_id, const std::string& address,
-           std::unique_ptr<DataServiceWorkerClient> worker)
-          : task_id(task_id), address(address), worker(std::move(worker)) {}
+      Task(int64 task_id, const std::string& address, int64 distance,
+           std::unique_ptr<DataServiceWorkerClient> worker,
+           std::unique_ptr<SharedMemoryRing> ring)
+          : task_id(task_id),
+            address(address),
+            distance(distance),
+            worker(std::move(worker)),
+            ring(std::move(ring)) {}
 
       const int64 task_id;
       // Address of the tf.data service worker for task `task_id`.
       const std::string address;
+      // Distance between this client and the worker, see `LocalityDistance`.
+      const int64 distance;
       // Client for fetching task elements from the tf.data service worker.
       const std::unique_ptr<DataServiceWorkerClient> worker;
+      // Ring through which the worker hands elements when it runs on the same
+      // host, or nullptr.
+      const std::unique_ptr<SharedMemoryRing> ring;
       // Indicates whether a worker thread is currently processing the task.
       bool in_use TF_GUARDED_BY(&Iterator::mu_) = false;
       // Indicates whether the worker has returned end_of_sequence for the task.
@@ -368,7 +417,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       VLOG(3) << "Updating tasks";
       std::vector<TaskInfo> tasks;
       bool job_finished;
-      Status s = dispatcher_->GetTasks(job_client_id_, tasks, job_finished);
+      Status s = dispatcher_->GetTasks(job_client_id_, locality_, tasks,
+                                       job_finished);
       if (!s.ok()) {
         LOG(WARNING) << "Failed to get task info for job client id "
                      << job_client_id_ << ": " << s;
@@ -410,9 +460,15 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           get_next_cv_.notify_all();
           continue;
         }
-        tasks_.push_back(std::make_shared<Task>(task_info.task_id(),
-                                                task_info.worker_address(),
-                                                std::move(worker)));
+        const int64 distance =
+            LocalityDistance(locality_, task_info.worker_locality());
+        std::unique_ptr<SharedMemoryRing> ring;
+        if (distance == kSameHost) {
+          ring = MaybeCreateSharedMemoryRing();
+        }
+        tasks_.push_back(std::make_shared<Task>(
+            task_info.task_id(), task_info.worker_address(), distance,
+            std::move(worker), std::move(ring)));
       }
       if (dataset()->max_outstanding_requests_ == model::kAutotune) {
         // Adjust max_outstanding_requests to account for newly added tasks.
@@ -470,19 +526,26 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           if (cancelled_ || job_finished_) {
             return;
           }
-          // Search for a task to update.
+          // Search for a task to update, preferring the closest workers and
+          // going round-robin among workers at the same distance.
           int num_tasks = tasks_.size();
           for (int i = 0; i < num_tasks; ++i) {
             int index = (next_task_index_ + i) % num_tasks;
             std::shared_ptr<Task>& task = tasks_[index];
-            if (!task->in_use && !task->end_of_sequence) {
-              task->in_use = true;
+            if (!task->in_use && !task->end_of_sequence &&
+                (!task_to_process ||
+                 task->distance < task_to_process->distance)) {
               task_to_process = task;
-              next_task_index_ = (index + 1) % num_tasks;
-              break;
             }
           }
           DCHECK(task_to_process != nullptr);
+          task_to_process->in_use = true;
+          for (int i = 0; i < num_tasks; ++i) {
+            if (tasks_[i] == task_to_process) {
+              next_task_index_ = (i + 1) % num_tasks;
+              break;
+            }
+          }
           VLOG(3) << "Processing task " << task_to_process->task_id;
         }
         int64 deadline_micros = kint64max;
@@ -512,11 +575,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       VLOG(3) << "Getting an element for task id " << task->task_id;
       tensorflow::profiler::TraceMe activity(
           "GetDataServiceElement", tensorflow::profiler::TraceMeLevel::kInfo);
-      CompressedElement compressed;
+      std::vector<Tensor> element;
       bool end_of_sequence;
       for (int num_retries = 0;; ++num_retries) {
-        Status s = task->worker->GetElement(task->task_id, compressed,
-                                            end_of_sequence);
+        Status s = task->worker->GetElement(task->task_id, task->ring.get(),
+                                            element, end_of_sequence);
         if (s.ok()) {
           break;
         }
@@ -552,12 +615,6 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         Env::Default()->SleepForMicroseconds(backoff_until - now_micros);
       }
 
-      std::vector<Tensor> element;
-      if (!end_of_sequence) {
-        Tensor tensor(DT_VARIANT, TensorShape{});
-        tensor.scalar<Variant>()() = std::move(compressed);
-        element.push_back(tensor);
-      }
       mutex_lock l(mu_);
       if (end_of_sequence) {
         task->end_of_sequence = true;
@@ -615,6 +672,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     bool initialized_ = false;
     // Set once in Initialize().
     int64 job_client_id_;
+    // Where this client runs. Set once in Initialize().
+    Locality locality_;
     std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
 
     bool job_finished_ = false;
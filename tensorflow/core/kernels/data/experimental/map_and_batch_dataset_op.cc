@@ -237,9 +237,9 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
         while (!cancelled_ && (batch_results_.empty() ||
                                batch_results_.front()->num_calls > 0)) {
           ++waiting_;
-          RecordStop(ctx);
+          RecordWaitStart(ctx);
           cond_var_->wait(l);
-          RecordStart(ctx);
+          RecordWaitStop(ctx);
           --waiting_;
         }
         if (cancelled_) {
@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/snapshot_util.h"
 
+#include <deque>
 #include <queue>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
@@ -343,6 +345,17 @@ Status Reader::Create(Env* env, const std::string& filename,
   return (*out_reader)->Initialize(env);
 }
 
+Status Reader::ReadUndecodedTensors(
+    std::function<Status(std::vector<Tensor>*)>* decode) {
+  auto tensors = std::make_shared<std::vector<Tensor>>();
+  TF_RETURN_IF_ERROR(ReadTensors(tensors.get()));
+  *decode = [tensors](std::vector<Tensor>* read_tensors) {
+    *read_tensors = std::move(*tensors);
+    return Status::OK();
+  };
+  return Status::OK();
+}
+
 Status Reader::SkipRecords(int64 num_records) {
   // TODO(frankchn): Optimize to not parse the entire Tensor and actually skip.
   for (int i = 0; i < num_records; ++i) {
@@ -398,12 +411,39 @@ class Reader::Dataset : public DatasetBase {
   }
 
  private:
+  // Reads the snapshot files of a shard in order. A background thread reads
+  // ahead across files and hands the undecoded elements to the runner thread
+  // pool, which decodes up to `parallelism` of them at a time. Elements are
+  // produced in the order in which they were written.
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params), current_checkpoint_id_(0) {}
+        : DatasetIterator<Dataset>(params),
+          mu_(std::make_shared<mutex>()),
+          cond_var_(std::make_shared<condition_variable>()),
+          parallelism_(std::make_shared<model::SharedState>(
+              model::kAutotune, mu_, cond_var_)),
+          current_checkpoint_id_(0) {}
+
+    ~Iterator() override {
+      {
+        mutex_lock l(*mu_);
+        cancelled_ = true;
+        cond_var_->notify_all();
+        while (num_decoding_ > 0) {
+          cond_var_->wait(l);
+        }
+      }
+      reader_thread_.reset();
+    }
 
     Status Initialize(IteratorContext* ctx) override {
+      {
+        mutex_lock l(*mu_);
+        if (parallelism_->value == model::kAutotune) {
+          parallelism_->value = 1;
+        }
+      }
       TF_RETURN_IF_ERROR(Reader::Create(
           ctx->env(), GetCurrentFilename(), dataset()->compression_,
           dataset()->version_, dataset()->dtypes_, &reader_));
@@ -420,18 +460,42 @@ class Reader::Dataset : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
-      *end_of_sequence = false;
-      Status s = reader_->ReadTensors(out_tensors);
-      if (!errors::IsOutOfRange(s)) {
-        return s;
+      std::shared_ptr<Result> result;
+      {
+        mutex_lock l(*mu_);
+        EnsureReaderThreadStarted(ctx);
+        while (!cancelled_ && (buffer_.empty() || !buffer_.front()->done)) {
+          RecordStop(ctx);
+          cond_var_->wait(l);
+          RecordStart(ctx);
+        }
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        result = buffer_.front();
+        // The last result stays at the front of the buffer, since no other
+        // results follow it.
+        if (!result->last) {
+          buffer_.pop_front();
+          cond_var_->notify_all();
+        }
       }
-      Status status = AdvanceToNextFile(ctx->env());
-      if (errors::IsNotFound(status)) {
-        *end_of_sequence = true;
-        return Status::OK();
-      } else {
-        return status;
+      *end_of_sequence = result->end_of_sequence;
+      if (!result->status.ok() || result->end_of_sequence) {
+        return result->status;
       }
+      RecordBufferDequeue(ctx, result->tensors);
+      *out_tensors = std::move(result->tensors);
+      return Status::OK();
+    }
+
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeAsyncKnownRatioNode(
+          std::move(args),
+          /*ratio=*/1,
+          {model::MakeParameter("parallelism", parallelism_, /*min=*/1,
+                                /*max=*/ctx->runner_threadpool_size())});
     }
 
     Status SaveInternal(SerializationContext* ctx,
@@ -451,6 +515,84 @@ class Reader::Dataset : public DatasetBase {
     }
 
    private:
+    // An element that is being read or decoded.
+    struct Result {
+      bool done = false;
+      // Whether the reader thread exited after producing this result.
+      bool last = false;
+      bool end_of_sequence = false;
+      Status status;
+      std::vector<Tensor> tensors;
+    };
+
+    // The number of undecoded elements that are read ahead for each element
+    // that can be decoded in parallel.
+    static constexpr int64 kReadaheadPerDecode = 2;
+
+    void EnsureReaderThreadStarted(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      if (!reader_thread_) {
+        auto ctx_copy = std::make_shared<IteratorContext>(*ctx);
+        reader_thread_ =
+            ctx->StartThread("tf_data_snapshot_reader",
+                             [this, ctx_copy]() { ReaderThread(ctx_copy); });
+      }
+    }
+
+    void ReaderThread(const std::shared_ptr<IteratorContext>& ctx) {
+      while (true) {
+        {
+          mutex_lock l(*mu_);
+          while (!cancelled_ && (num_decoding_ >= parallelism_->value ||
+                                 buffer_.size() >= kReadaheadPerDecode *
+                                                       parallelism_->value)) {
+            cond_var_->wait(l);
+          }
+          if (cancelled_) {
+            return;
+          }
+        }
+        // `reader_` is only used by this thread once it has been started.
+        std::function<Status(std::vector<Tensor>*)> decode;
+        Status s = reader_->ReadUndecodedTensors(&decode);
+        if (errors::IsOutOfRange(s)) {
+          s = AdvanceToNextFile(ctx->env());
+          if (s.ok()) {
+            continue;
+          }
+        }
+        auto result = std::make_shared<Result>();
+        {
+          mutex_lock l(*mu_);
+          buffer_.push_back(result);
+          if (!s.ok()) {
+            result->done = true;
+            result->last = true;
+            if (errors::IsNotFound(s)) {
+              result->end_of_sequence = true;
+            } else {
+              result->status = s;
+            }
+            cond_var_->notify_all();
+            return;
+          }
+          num_decoding_++;
+        }
+        // The lock is not held since the runner may run the function inline.
+        (*ctx->runner())([this, ctx, result, decode = std::move(decode)]() {
+          std::vector<Tensor> tensors;
+          Status s = decode(&tensors);
+          RecordBufferEnqueue(ctx.get(), tensors);
+          mutex_lock l(*mu_);
+          result->status = s;
+          result->tensors = std::move(tensors);
+          result->done = true;
+          num_decoding_--;
+          cond_var_->notify_all();
+        });
+      }
+    }
+
     std::string GetCurrentFilename() {
       return GetCheckpointFileName(dataset()->shard_dir_,
                                    current_checkpoint_id_);
@@ -463,6 +605,16 @@ class Reader::Dataset : public DatasetBase {
                             dataset()->version_, dataset()->dtypes_, &reader_);
     }
 
+    const std::shared_ptr<mutex> mu_;
+    const std::shared_ptr<condition_variable> cond_var_;
+    // The number of elements decoded in parallel.
+    const std::shared_ptr<model::SharedState> parallelism_;
+    std::unique_ptr<Thread> reader_thread_ TF_GUARDED_BY(*mu_);
+    // Elements in the order in which they are produced.
+    std::deque<std::shared_ptr<Result>> buffer_ TF_GUARDED_BY(*mu_);
+    int64 num_decoding_ TF_GUARDED_BY(*mu_) = 0;
+    bool cancelled_ TF_GUARDED_BY(*mu_) = false;
+
     std::unique_ptr<Reader> reader_;
 
     // Stores the id current checkpoint file that we are in the process of
@@ -683,13 +835,7 @@ Status CustomReader::Initialize(Env* env) {
 #endif  // IS_SLIM_BUILD
   simple_tensor_mask_.reserve(dtypes_.size());
   for (const auto& dtype : dtypes_) {
-    if (DataTypeCanUseMemcpy(dtype)) {
-      simple_tensor_mask_.push_back(true);
-      num_simple_++;
-    } else {
-      simple_tensor_mask_.push_back(false);
-      num_complex_++;
-    }
+    simple_tensor_mask_.push_back(DataTypeCanUseMemcpy(dtype));
   }
 
   return Status::OK();
@@ -710,25 +856,58 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
                                    " is not supported.");
   }
 
-  experimental::SnapshotTensorMetadata metadata;
   tstring metadata_str;
   TF_RETURN_IF_ERROR(ReadRecord(&metadata_str));
+  tstring compressed;
+  TF_RETURN_IF_ERROR(ReadRecord(&compressed));
+  return DecodeTensors(dtypes_, simple_tensor_mask_, metadata_str, compressed,
+                       read_tensors);
+}
+
+Status CustomReader::ReadUndecodedTensors(
+    std::function<Status(std::vector<Tensor>*)>* decode) {
+  if (version_ != 1 || compression_type_ != io::compression::kSnappy) {
+    return Reader::ReadUndecodedTensors(decode);
+  }
+  auto records = std::make_shared<std::pair<tstring, tstring>>();
+  TF_RETURN_IF_ERROR(ReadRecord(&records->first));
+  TF_RETURN_IF_ERROR(ReadRecord(&records->second));
+  *decode = [dtypes = dtypes_, simple_tensor_mask = simple_tensor_mask_,
+             records](std::vector<Tensor>* read_tensors) {
+    return DecodeTensors(dtypes, simple_tensor_mask, records->first,
+                         records->second, read_tensors);
+  };
+  return Status::OK();
+}
+
+Status CustomReader::DecodeTensors(const DataTypeVector& dtypes,
+                                   const std::vector<bool>& simple_tensor_mask,
+                                   const tstring& metadata_str,
+                                   const tstring& compressed,
+                                   std::vector<Tensor>* read_tensors) {
+  profiler::TraceMe activity(
+      [&]() { return absl::StrCat(kClassName, kSeparator, "DecodeTensors"); },
+      profiler::TraceMeLevel::kInfo);
+  experimental::SnapshotTensorMetadata metadata;
   if (!metadata.ParseFromArray(metadata_str.data(), metadata_str.size())) {
     return errors::DataLoss("Could not parse SnapshotTensorMetadata");
   }
   read_tensors->reserve(metadata.tensor_metadata_size());
 
+  const int num_simple =
+      std::count(simple_tensor_mask.begin(), simple_tensor_mask.end(), true);
   std::vector<Tensor> simple_tensors;
-  simple_tensors.reserve(num_simple_);
+  simple_tensors.reserve(num_simple);
   std::vector<std::pair<std::unique_ptr<char[]>, size_t>> tensor_proto_strs;
-  tensor_proto_strs.reserve(num_complex_);
-  TF_RETURN_IF_ERROR(
-      SnappyUncompress(&metadata, &simple_tensors, &tensor_proto_strs));
+  tensor_proto_strs.reserve(simple_tensor_mask.size() - num_simple);
+  TF_RETURN_IF_ERROR(SnappyUncompress(dtypes, simple_tensor_mask, &metadata,
+                                      compressed, &simple_tensors,
+                                      &tensor_proto_strs));
 
   int simple_index = 0;
   int complex_index = 0;
-  for (int i = 0, end = simple_tensor_mask_.size(); i < end; ++i) {
-    if (simple_tensor_mask_[i]) {
+  for (int i = 0, end = simple_tensor_mask.size(); i < end; ++i) {
+    if (simple_tensor_mask[i]) {
       read_tensors->push_back(std::move(simple_tensors[simple_index]));
       simple_index++;
     } else {
@@ -771,12 +950,11 @@ Status CustomReader::ReadTensorsV0(std::vector<Tensor>* read_tensors) {
 }
 
 Status CustomReader::SnappyUncompress(
+    const DataTypeVector& dtypes, const std::vector<bool>& simple_tensor_mask,
     const experimental::SnapshotTensorMetadata* metadata,
-    std::vector<Tensor>* simple_tensors,
+    const tstring& compressed, std::vector<Tensor>* simple_tensors,
     std::vector<std::pair<std::unique_ptr<char[]>, size_t>>*
         tensor_proto_strs) {
-  tstring compressed;
-  TF_RETURN_IF_ERROR(ReadRecord(&compressed));
   size_t size;
   if (!port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(),
                                           &size)) {
@@ -787,11 +965,11 @@ Status CustomReader::SnappyUncompress(
   std::vector<struct iovec> iov(num_tensors);
   int index = 0;
   int64 total_size = 0;
-  for (int i = 0, end = simple_tensor_mask_.size(); i < end; ++i) {
+  for (int i = 0, end = simple_tensor_mask.size(); i < end; ++i) {
     const auto& tensor_metadata = metadata->tensor_metadata(i);
-    if (simple_tensor_mask_[i]) {
+    if (simple_tensor_mask[i]) {
       TensorShape shape(tensor_metadata.tensor_shape());
-      Tensor simple_tensor(dtypes_[i], shape);
+      Tensor simple_tensor(dtypes[i], shape);
       TensorBuffer* buffer = DMAHelper::buffer(&simple_tensor);
       iov[index].iov_base = buffer->data();
       iov[index].iov_len = buffer->size();
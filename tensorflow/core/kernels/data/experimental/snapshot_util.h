@@ -190,6 +190,14 @@ class Reader {
   // Reads a vector of Tensors from the snapshot file.
   virtual Status ReadTensors(std::vector<Tensor>* read_tensors) = 0;
 
+  // Reads the next vector of Tensors from the snapshot file without decoding
+  // it, and stores a function that decodes it in `decode`. `decode` may be
+  // called from any thread, including after this reader has been destroyed,
+  // which lets callers read ahead and decode elements in parallel. The default
+  // implementation reads and decodes the element on the calling thread.
+  virtual Status ReadUndecodedTensors(
+      std::function<Status(std::vector<Tensor>*)>* decode);
+
   // Skips `num_records`. Equivalent to calling `ReadTensors` `num_records`
   // times then discarding the results.
   virtual Status SkipRecords(int64 num_records);
@@ -249,6 +257,9 @@ class CustomReader : public Reader {
 
   Status ReadTensors(std::vector<Tensor>* read_tensors) override;
 
+  Status ReadUndecodedTensors(
+      std::function<Status(std::vector<Tensor>*)>* decode) override;
+
   ~CustomReader() override {}
 
  protected:
@@ -257,9 +268,18 @@ class CustomReader : public Reader {
  private:
   Status ReadTensorsV0(std::vector<Tensor>* read_tensors);
 
-  Status SnappyUncompress(
+  // Decodes the metadata and snappy compressed records of an element written
+  // by a version 1 `CustomWriter`.
+  static Status DecodeTensors(const DataTypeVector& dtypes,
+                              const std::vector<bool>& simple_tensor_mask,
+                              const tstring& metadata_str,
+                              const tstring& compressed,
+                              std::vector<Tensor>* read_tensors);
+
+  static Status SnappyUncompress(
+      const DataTypeVector& dtypes, const std::vector<bool>& simple_tensor_mask,
       const experimental::SnapshotTensorMetadata* metadata,
-      std::vector<Tensor>* simple_tensors,
+      const tstring& compressed, std::vector<Tensor>* simple_tensors,
       std::vector<std::pair<std::unique_ptr<char[]>, size_t>>*
           tensor_proto_strs);
 
@@ -275,8 +295,6 @@ class CustomReader : public Reader {
   const string compression_type_;
   const int version_;
   const DataTypeVector dtypes_;
-  int num_simple_ = 0;
-  int num_complex_ = 0;
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
 };
 
@@ -91,6 +91,50 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+void SnapshotUndecodedRoundTrip(std::string compression_type, int version) {
+  std::vector<Tensor> tensors;
+  tensorflow::DataTypeVector dtypes;
+  GenerateTensorVector(dtypes, tensors);
+
+  std::string filename;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&filename));
+
+  std::unique_ptr<Writer> writer;
+  TF_ASSERT_OK(Writer::Create(tensorflow::Env::Default(), filename,
+                              compression_type, version, dtypes, &writer));
+  for (int i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(writer->WriteTensors(tensors));
+  }
+  TF_ASSERT_OK(writer->Close());
+
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Create(Env::Default(), filename, compression_type,
+                              version, dtypes, &reader));
+  std::vector<std::function<Status(std::vector<Tensor>*)>> decoders(10);
+  for (int i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(reader->ReadUndecodedTensors(&decoders[i]));
+  }
+  // Elements can be decoded in any order once the reader is gone.
+  reader.reset();
+  for (int i = 9; i >= 0; --i) {
+    std::vector<Tensor> read_tensors;
+    TF_ASSERT_OK(decoders[i](&read_tensors));
+    ASSERT_EQ(tensors.size(), read_tensors.size());
+    for (int j = 0; j < read_tensors.size(); ++j) {
+      EXPECT_EQ(tensors[j].scalar<tstring>()(),
+                read_tensors[j].scalar<tstring>()());
+    }
+  }
+
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+TEST(SnapshotUtilTest, UndecodedRoundTripTest) {
+  SnapshotUndecodedRoundTrip(io::compression::kNone, 1);
+  SnapshotUndecodedRoundTrip(io::compression::kSnappy, 1);
+  SnapshotUndecodedRoundTrip(io::compression::kSnappy, 2);
+}
+
 void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
                                  int version) {
   tensorflow::testing::StopTiming();
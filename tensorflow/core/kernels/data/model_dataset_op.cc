@@ -23,9 +23,16 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/hash_utils.h"
+#include "tensorflow/core/kernels/data/serialization_utils.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
@@ -37,6 +44,88 @@ constexpr int64 kOptimizationPeriodThresholdMs = 60 * EnvTime::kSecondsToMillis;
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
+constexpr char kTunableParameters[] = "tunable_parameters";
+constexpr char kSizeSuffix[] = ".size";
+constexpr char kNameSuffix[] = ".name";
+constexpr char kValueSuffix[] = ".value";
+
+// The directory in which the tuned parameter values of input pipelines are
+// kept across runs, in a file named after the fingerprint of the pipeline.
+string AutotuneStateDir() {
+  string dir;
+  Status s = ReadStringFromEnvVar("TF_DATA_AUTOTUNE_STATE_DIR",
+                                  /*default_val=*/"", &dir);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return "";
+  }
+  return dir;
+}
+
+// Serializes tuned parameter values as one "<key>\t<value>" line each.
+string SerializeParameterValues(
+    const absl::flat_hash_map<string, double>& values) {
+  string result;
+  for (const auto& pair : values) {
+    strings::StrAppend(&result, pair.first, "\t",
+                       static_cast<int64>(std::round(pair.second)), "\n");
+  }
+  return result;
+}
+
+Status ParseParameterValues(const string& serialized,
+                            absl::flat_hash_map<string, double>* values) {
+  for (const string& line :
+       str_util::Split(serialized, '\n', str_util::SkipEmpty())) {
+    std::vector<string> fields = str_util::Split(line, '\t');
+    int64 value;
+    if (fields.size() != 2 || !strings::safe_strto64(fields[1], &value)) {
+      return errors::DataLoss("Invalid tuned parameter value: ", line);
+    }
+    (*values)[fields[0]] = value;
+  }
+  return Status::OK();
+}
+
+// Whether the tuned parameters must stay within the CPU and RAM budgets, whose
+// defaults then also account for the CPU quota and memory limit of the cgroup
+// of the process.
+bool ResourceConstrained() {
+  static const bool resource_constrained = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_DATA_AUTOTUNE_RESOURCE_CONSTRAINED",
+                                  /*default_val=*/false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return false;
+    }
+    return value;
+  }();
+  return resource_constrained;
+}
+
+int64 DefaultCpuBudget(bool resource_constrained) {
+  int64 cpu_budget = port::NumSchedulableCPUs();
+  if (resource_constrained) {
+    const int64 cgroup_cpus = CgroupCpuLimit(kCgroupRoot);
+    if (cgroup_cpus > 0) {
+      cpu_budget = std::min(cpu_budget, cgroup_cpus);
+    }
+  }
+  return cpu_budget;
+}
+
+int64 DefaultRamBudget(bool resource_constrained) {
+  int64 available_ram = port::AvailableRam();
+  if (resource_constrained) {
+    const int64 cgroup_ram = CgroupAvailableRam(kCgroupRoot);
+    if (cgroup_ram >= 0) {
+      available_ram = std::min(available_ram, cgroup_ram);
+    }
+  }
+  return kRamBudgetShare * available_ram;
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const ModelDatasetOp::kAlgorithm;
@@ -47,12 +136,13 @@ class ModelDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
           model::AutotuneAlgorithm algorithm, int64 cpu_budget,
-          int64 ram_budget)
+          int64 ram_budget, const string& autotune_state_file)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         algorithm_(algorithm),
         cpu_budget_(cpu_budget),
         ram_budget_(ram_budget),
+        autotune_state_file_(autotune_state_file),
         traceme_metadata_(
             {{"algorithm", algorithm == model::AutotuneAlgorithm::HILL_CLIMB
                                ? "hill climb"
@@ -120,10 +210,12 @@ class ModelDatasetOp::Dataset : public DatasetBase {
    public:
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params),
-          cpu_budget_(dataset()->cpu_budget_ == 0 ? port::NumSchedulableCPUs()
-                                                  : dataset()->cpu_budget_),
+          resource_constrained_(ResourceConstrained()),
+          cpu_budget_(dataset()->cpu_budget_ == 0
+                          ? DefaultCpuBudget(resource_constrained_)
+                          : dataset()->cpu_budget_),
           ram_budget_(dataset()->ram_budget_ == 0
-                          ? kRamBudgetShare * port::AvailableRam()
+                          ? DefaultRamBudget(resource_constrained_)
                           : dataset()->ram_budget_) {
       model_ = std::make_shared<model::Model>();
     }
@@ -137,6 +229,22 @@ class ModelDatasetOp::Dataset : public DatasetBase {
     }
 
     Status Initialize(IteratorContext* ctx) override {
+      const string& state_file = dataset()->autotune_state_file_;
+      if (!state_file.empty() && ctx->env()->FileExists(state_file).ok()) {
+        // Start out with the values tuned by an earlier run of this pipeline.
+        string serialized;
+        absl::flat_hash_map<string, double> values;
+        Status s = ReadFileToString(ctx->env(), state_file, &serialized);
+        if (s.ok()) s = ParseParameterValues(serialized, &values);
+        if (s.ok()) {
+          VLOG(1) << "Restored " << values.size()
+                  << " tuned parameter values from " << state_file;
+          RestoreTunableParameterValues(std::move(values));
+        } else {
+          LOG(WARNING) << "Failed to restore tuned parameter values from "
+                       << state_file << ": " << s;
+        }
+      }
       IteratorContext::Params params(ctx);
       params.model = model_;
       return dataset()->input_->MakeIterator(IteratorContext(std::move(params)),
@@ -173,18 +281,83 @@ class ModelDatasetOp::Dataset : public DatasetBase {
                         IteratorStateWriter* writer) override {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      // The tuned parameter values let the restored pipeline skip the ramp
+      // up of autotuning.
+      const absl::flat_hash_map<string, double> values =
+          model_->TunableParameterValues();
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          full_name(strings::StrCat(kTunableParameters, kSizeSuffix)),
+          values.size()));
+      int64 i = 0;
+      for (const auto& pair : values) {
+        const string prefix = strings::StrCat(kTunableParameters, "[", i, "]");
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(strings::StrCat(prefix, kNameSuffix)), pair.first));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(strings::StrCat(prefix, kValueSuffix)),
+            static_cast<int64>(std::round(pair.second))));
+        ++i;
+      }
       return Status::OK();
     }
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      // Checkpoints written before the tuned parameter values were saved do
+      // not have them.
+      const string size_key =
+          full_name(strings::StrCat(kTunableParameters, kSizeSuffix));
+      if (reader->Contains(size_key)) {
+        int64 size;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(size_key, &size));
+        absl::flat_hash_map<string, double> values;
+        for (int64 i = 0; i < size; ++i) {
+          const string prefix =
+              strings::StrCat(kTunableParameters, "[", i, "]");
+          tstring name;
+          int64 value;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name(strings::StrCat(prefix, kNameSuffix)), &name));
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name(strings::StrCat(prefix, kValueSuffix)), &value));
+          values[name] = value;
+        }
+        RestoreTunableParameterValues(std::move(values));
+      }
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
       return Status::OK();
     }
 
     TraceMeMetadata GetTraceMeMetadata() const override {
-      return dataset()->traceme_metadata_;
+      TraceMeMetadata result = dataset()->traceme_metadata_;
+      if (resource_constrained_) {
+        result.push_back(std::make_pair(
+            "cpu_budget",
+            strings::Printf("%lld", static_cast<long long>(cpu_budget_))));
+        result.push_back(std::make_pair(
+            "ram_budget",
+            strings::Printf("%lldB", static_cast<long long>(ram_budget_))));
+      }
+      const model::Model::OptimizationStats stats =
+          model_->optimization_stats();
+      result.push_back(std::make_pair(
+          "parallelism",
+          strings::Printf("%lld", static_cast<long long>(stats.parallelism))));
+      result.push_back(std::make_pair(
+          "cpu_utilization",
+          strings::Printf("%.2f", static_cast<double>(stats.parallelism) /
+                                      std::max<int64>(cpu_budget_, 1))));
+      result.push_back(std::make_pair(
+          "buffered_bytes",
+          strings::Printf("%.0fB", stats.maximum_buffered_bytes)));
+      result.push_back(std::make_pair(
+          "ram_utilization",
+          strings::Printf("%.2f", stats.maximum_buffered_bytes /
+                                      std::max<int64>(ram_budget_, 1))));
+      result.push_back(std::make_pair(
+          "output_time", strings::Printf("%.0fns", stats.output_time)));
+      return result;
     }
 
    private:
@@ -197,9 +370,49 @@ class ModelDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    // Applies the tuned parameter values of an earlier run of this pipeline to
+    // the model.
+    void RestoreTunableParameterValues(
+        absl::flat_hash_map<string, double> values) TF_LOCKS_EXCLUDED(mu_) {
+      if (values.empty()) return;
+      model_->SetTunableParameterValues(std::move(values));
+      mutex_lock l(mu_);
+      warm_start_ = true;
+    }
+
+    // Records the tuned parameter values for later runs of this pipeline.
+    void SaveAutotuneState() {
+      const string& state_file = dataset()->autotune_state_file_;
+      const absl::flat_hash_map<string, double> values =
+          model_->TunableParameterValues();
+      if (values.empty()) return;
+      // Written to a temporary file first so that readers never see a partial
+      // file.
+      const string tmp_file = strings::StrCat(
+          state_file, ".tmp.", random::New64());
+      Status s = WriteStringToFile(Env::Default(), tmp_file,
+                                   SerializeParameterValues(values));
+      if (s.ok()) s = Env::Default()->RenameFile(tmp_file, state_file);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to save tuned parameter values to "
+                     << state_file << ": " << s;
+        Env::Default()->DeleteFile(tmp_file).IgnoreError();
+      }
+    }
+
     void ModelThread() {
       int64 last_optimization_ms = 0;
       int64 optimization_period_ms = 10;
+      {
+        tf_shared_lock l(mu_);
+        // The restored values are kept until autotuning has observed the
+        // pipeline for a full optimization period.
+        if (warm_start_) {
+          optimization_period_ms = kOptimizationPeriodThresholdMs;
+          last_optimization_ms =
+              EnvTime::NowMicros() / EnvTime::kMillisToMicros;
+        }
+      }
       int64 current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
       while (true) {
         {
@@ -222,7 +435,8 @@ class ModelDatasetOp::Dataset : public DatasetBase {
 
         int64 optimization_start_us = EnvTime::NowMicros();
         model_->Optimize(dataset()->algorithm_, cpu_budget_, ram_budget_,
-                         /*model_input_time=*/0);
+                         /*model_input_time=*/0,
+                         /*enforce_budgets=*/resource_constrained_);
         VLOG(2) << "Optimized for "
                 << (EnvTime::NowMicros() - optimization_start_us) << " us.";
 
@@ -235,6 +449,9 @@ class ModelDatasetOp::Dataset : public DatasetBase {
         current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
         last_optimization_ms = current_time_ms;
         model_->FlushMetrics();
+        if (!dataset()->autotune_state_file_.empty()) {
+          SaveAutotuneState();
+        }
       }
     }
 
@@ -267,6 +484,9 @@ class ModelDatasetOp::Dataset : public DatasetBase {
     int64 num_input_events_ TF_GUARDED_BY(mu_) = 0;
     int64 input_time_ TF_GUARDED_BY(mu_) = 0;
     int64 last_output_time_ TF_GUARDED_BY(mu_) = 0;
+    // Whether the model starts out with restored parameter values.
+    bool warm_start_ TF_GUARDED_BY(mu_) = false;
+    const bool resource_constrained_;
     const int64 cpu_budget_;
     const int64 ram_budget_;
   };
@@ -275,6 +495,8 @@ class ModelDatasetOp::Dataset : public DatasetBase {
   const model::AutotuneAlgorithm algorithm_;
   const int64 cpu_budget_;
   const int64 ram_budget_;
+  // The file in which tuned parameter values are kept across runs, if any.
+  const string autotune_state_file_;
   const TraceMeMetadata traceme_metadata_;
 };
 
@@ -303,8 +525,30 @@ ModelDatasetOp::ModelDatasetOp(OpKernelConstruction* ctx)
 
 void ModelDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
+  string autotune_state_file;
+  const string autotune_state_dir = AutotuneStateDir();
+  if (!autotune_state_dir.empty()) {
+    // Tuned values are only reused by pipelines with the same fingerprint.
+    GraphDef graph_def;
+    SerializationContext::Params params;
+    std::vector<std::pair<string, Tensor>> input_list;
+    params.input_list = &input_list;
+    params.external_state_policy =
+        SerializationContext::ExternalStatePolicy::kIgnore;
+    uint64 hash;
+    Status s = AsGraphDef(ctx, input, SerializationContext(params), &graph_def);
+    if (s.ok()) s = HashGraph(graph_def, &hash);
+    if (s.ok()) s = ctx->env()->RecursivelyCreateDir(autotune_state_dir);
+    if (s.ok()) {
+      autotune_state_file = io::JoinPath(
+          autotune_state_dir, strings::StrCat("autotune_", hash, ".txt"));
+    } else {
+      LOG(WARNING) << "Tuned parameter values will not be kept in "
+                   << autotune_state_dir << ": " << s;
+    }
+  }
   *output = new ModelDatasetOp::Dataset(ctx, input, algorithm_, cpu_budget_,
-                                        ram_budget_);
+                                        ram_budget_, autotune_state_file);
 }
 
 namespace {
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
 #include <deque>
 
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
@@ -49,6 +50,14 @@ struct HostBufferElement {
 using MultiDeviceIteratorCallback =
     std::function<void(const HostBufferElement&)>;
 
+// Returns whether the elements for `device` are copied to it from host memory
+// by DMA, and thus are faster to copy from pinned memory.
+bool IsDmaDevice(const string& device) {
+  DeviceNameUtils::ParsedName parsed_name;
+  return DeviceNameUtils::ParseFullName(device, &parsed_name) &&
+         parsed_name.has_type && parsed_name.type == DEVICE_GPU;
+}
+
 class MultiDeviceIterator : public ResourceBase {
  public:
   MultiDeviceIterator(
@@ -92,9 +101,14 @@ class MultiDeviceIterator : public ResourceBase {
     ++incarnation_id_;
     *incarnation_id = incarnation_id_;
 
+    std::vector<bool> pin_elements;
+    pin_elements.reserve(devices_.size());
+    for (const string& device : devices_) {
+      pin_elements.push_back(IsDmaDevice(device));
+    }
     multi_device_buffer_ = absl::make_unique<MultiDeviceBuffer>(
         devices_.size(), max_buffer_size, incarnation_id_, std::move(iterator),
-        this);
+        std::move(pin_elements), this);
     return Status::OK();
   }
 
@@ -149,16 +163,23 @@ class MultiDeviceIterator : public ResourceBase {
  private:
   // A private class that uses a background thread to keep a per device buffer
   // full.
+  //
+  // The elements buffered for GPUs are moved to pinned host memory by the
+  // background thread. Otherwise the copies from pageable memory to the GPUs,
+  // which happen when the per device datasets fetch the elements, have to
+  // stage them through pinned memory themselves, synchronously.
   class MultiDeviceBuffer {
    public:
     MultiDeviceBuffer(size_t size, int64 max_buffer_size, int64 incarnation_id,
                       std::unique_ptr<IteratorBase> host_iterator,
+                      std::vector<bool> pin_elements,
                       MultiDeviceIterator* parent)
         : buffer_(size),
           size_(size),
           max_buffer_size_(max_buffer_size),
           incarnation_id_(incarnation_id),
           host_iterator_(std::move(host_iterator)),
+          pin_elements_(std::move(pin_elements)),
           parent_(parent) {}
 
     ~MultiDeviceBuffer() {
@@ -314,6 +335,10 @@ class MultiDeviceIterator : public ResourceBase {
         if (elem.status.ok() && elem.end_of_sequence) {
           end_of_iterator = true;
         }
+        if (elem.status.ok() && !elem.end_of_sequence &&
+            pin_elements_[shard_to_fetch]) {
+          PinElement(ctx.get(), &elem.value);
+        }
 
         {
           mutex_lock l(mu_);
@@ -347,6 +372,26 @@ class MultiDeviceIterator : public ResourceBase {
       }
     }
 
+    // Replaces the tensors of `value` by copies in pinned host memory. Tensors
+    // that can't be copied with memcpy are left as they are.
+    static void PinElement(IteratorContext* ctx, std::vector<Tensor>* value) {
+      AllocatorAttributes attrs;
+      attrs.set_on_host(true);
+      attrs.set_gpu_compatible(true);
+      Allocator* allocator = ctx->allocator(attrs);
+      for (Tensor& t : *value) {
+        if (!DataTypeCanUseMemcpy(t.dtype()) || t.NumElements() == 0) {
+          continue;
+        }
+        Tensor pinned(allocator, t.dtype(), t.shape());
+        if (!pinned.IsInitialized()) return;
+        StringPiece src = t.tensor_data();
+        std::memcpy(const_cast<char*>(pinned.tensor_data().data()),
+                    src.data(), src.size());
+        t = std::move(pinned);
+      }
+    }
+
     struct HostBuffer {
       condition_variable cond_var;
       std::deque<HostBufferElement> data;
@@ -367,6 +412,8 @@ class MultiDeviceIterator : public ResourceBase {
     const int64 max_buffer_size_;
     const int64 incarnation_id_;
     const std::unique_ptr<IteratorBase> host_iterator_;
+    // Whether the elements of each shard are moved to pinned memory.
+    const std::vector<bool> pin_elements_;
     MultiDeviceIterator* const parent_;  // Not owned.
   };
 
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_interleave_dataset_op.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <deque>
 #include <memory>
 #include <utility>
@@ -41,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -115,6 +118,22 @@ constexpr double kDefaultCyclePrefetchFactor = 2.0L;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// When `buffer_output_elements` is autotuned, the results buffer of an input
+// whose results take longer to produce than the average is grown in
+// proportion, up to `kMaxPerIteratorPrefetchFactor` times its default size, so
+// that slow inputs have results buffered when the cycle reaches them.
+constexpr int64 kMaxPerIteratorPrefetchFactor = 4;
+
+// Weight of the latest observation in the moving averages of the time to
+// produce a result.
+constexpr double kResultTimeSmoothing = 0.2L;
+
+// When determinism is not required, an input of the cycle which has no
+// results and has been busy producing one for more than `kSlowInputFactor`
+// times the average time to produce a result is swapped with a future cycle
+// element that has results ready.
+constexpr double kSlowInputFactor = 4.0L;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -171,6 +190,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         block_length_(block_length),
         buffer_output_elements_(
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
+        autotune_buffer_output_elements_(buffer_output_elements ==
+                                         model::kAutotune),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length)),
         num_parallel_calls_(num_parallel_calls),
@@ -362,7 +383,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         EnsureInitialElementsCreated();
         EnsureThreadsStarted();
         while (!cancelled_ && !Consume(&result)) {
-          RecordStop(ctx);
+          RecordWaitStart(ctx);
           if (deterministic_) {
             VLOG(3) << "Blocked waiting for element "
                     << current_elements_[cycle_index_]->id;
@@ -370,7 +391,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           } else {
             any_element_available_cond_var_.wait(l);
           }
-          RecordStart(ctx);
+          RecordWaitStop(ctx);
         }
         if (cancelled_) {
           return errors::Cancelled("Iterator was cancelled");
@@ -543,6 +564,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // Whether we tried to initialize the element, but the input iterator
       // was exhausted so we could produce no inputs.
       bool no_input TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = false;
+      // Moving average of the time `iterator` takes to produce a result.
+      double average_result_micros
+          TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = 0;
+      // Time at which the element last produced a result or joined the
+      // current cycle.
+      uint64 last_progress_micros
+          TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = 0;
       // Condition variable for communicating between current worker threads
       // and GetNext.
       condition_variable cond_var;
@@ -641,9 +669,73 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         AdvanceToNextInCycle();
       }
+      // Rather than waiting on inputs that are temporarily slow, e.g. because
+      // they are stored on a slower tier, take results from a future element.
+      if (SwapSlowElement()) {
+        return ConsumeHelper(result);
+      }
       return false;
     }
 
+    // Swaps the slowest element of the current cycle that has no results with
+    // the first future element that has results, and moves the cycle position
+    // to it. The slow element keeps its place in the future elements, so its
+    // results are consumed later. Returns whether an element was swapped.
+    bool SwapSlowElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (average_result_micros_ <= 0) {
+        return false;
+      }
+      auto future_it = std::find_if(
+          future_elements_.begin(), future_elements_.end(),
+          [](const std::shared_ptr<Element>& element)
+              TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+                return !element->results.empty();
+              });
+      if (future_it == future_elements_.end()) {
+        return false;
+      }
+      const uint64 now = EnvTime::NowMicros();
+      uint64 slowest_busy_micros = kSlowInputFactor * average_result_micros_;
+      int64 slowest_index = -1;
+      for (int64 i = 0; i <= last_valid_current_element_; ++i) {
+        const std::shared_ptr<Element>& element = current_elements_[i];
+        if (!element || !element->active || !element->iterator ||
+            !element->results.empty()) {
+          continue;
+        }
+        const uint64 busy_micros = now - element->last_progress_micros;
+        if (busy_micros > slowest_busy_micros) {
+          slowest_busy_micros = busy_micros;
+          slowest_index = i;
+        }
+      }
+      if (slowest_index == -1) {
+        return false;
+      }
+      std::shared_ptr<Element> future_element = std::move(*future_it);
+      future_elements_.erase(future_it);
+      std::shared_ptr<Element> slow_element =
+          std::move(current_elements_[slowest_index]);
+      VLOG(2) << "Swapping slow element " << slow_element->id
+              << " with future element " << future_element->id;
+      slow_element->cycle_index = -1;
+      DisableAutotune(ctx_.get(), slow_element->iterator.get());
+      future_elements_.push_back(std::move(slow_element));
+      if (future_element->iterator) {
+        EnableAutotune(ctx_.get(), future_element->iterator.get());
+      }
+      future_element->cycle_index = slowest_index;
+      future_element->last_progress_micros = now;
+      if (!future_element->active) {
+        elements_to_process_.push_back(slowest_index);
+        current_workers_cond_var_.notify_one();
+      }
+      current_elements_[slowest_index] = std::move(future_element);
+      cycle_index_ = slowest_index;
+      block_index_ = 0;
+      return true;
+    }
+
     // Consumes a result (if available), returning an indication of whether
     // a result is available. If `true` is returned, `result` either
     // points to a valid result or is null if end of input has been reached.
@@ -692,6 +784,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             EnableAutotune(ctx_.get(), future_element->iterator.get());
           }
           future_element->cycle_index = cycle_index_;
+          future_element->last_progress_micros = EnvTime::NowMicros();
           current_elements_[cycle_index_] = std::move(future_element);
           future_workers_cond_var_.notify_one();
           if (!current_elements_[cycle_index_]->active) {
@@ -728,6 +821,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
       auto element = std::make_shared<Element>();
       element->id = element_id_counter_++;
+      element->last_progress_micros = EnvTime::NowMicros();
       uninitialized_elements_.push_back(element);
       return element;
     }
@@ -949,8 +1043,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                {"element_id", result->id}});
         });
         bool end_of_input = false;
+        const uint64 start_micros = EnvTime::NowMicros();
         result->status = iterator->GetNext(ctx_.get(), &result->return_values,
                                            &end_of_input);
+        const uint64 end_micros = EnvTime::NowMicros();
         if (end_of_input) {
           mutex_lock l(*mu_);
           element->iterator.reset();
@@ -960,9 +1056,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         RecordBufferEnqueue(ctx_.get(), result->return_values);
         mutex_lock l(*mu_);
+        RecordResultTime(element.get(), end_micros - start_micros, end_micros);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= BufferOutputElements(*element)) {
           break;
         }
       }
@@ -1061,7 +1158,39 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < BufferOutputElements(*element);
+    }
+
+    // Updates the moving averages of the time to produce a result after
+    // `element` produced a result in `result_micros`.
+    void RecordResultTime(Element* element, uint64 result_micros,
+                          uint64 now_micros) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto update = [result_micros](double* average) {
+        *average = *average <= 0
+                       ? result_micros
+                       : (1 - kResultTimeSmoothing) * *average +
+                             kResultTimeSmoothing * result_micros;
+      };
+      update(&element->average_result_micros);
+      update(&average_result_micros_);
+      element->last_progress_micros = now_micros;
+    }
+
+    // Returns the number of results to buffer for `element`. When autotuned,
+    // inputs that are slower than average buffer more results.
+    int64 BufferOutputElements(const Element& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64 buffer_output_elements = dataset()->buffer_output_elements_;
+      if (!dataset()->autotune_buffer_output_elements_ ||
+          average_result_micros_ <= 0) {
+        return buffer_output_elements;
+      }
+      const int64 scaled = std::llround(buffer_output_elements *
+                                        element.average_result_micros /
+                                        average_result_micros_);
+      return std::min(
+          std::max(scaled, buffer_output_elements),
+          kMaxPerIteratorPrefetchFactor * buffer_output_elements);
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1494,6 +1623,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Determines whether outputs can be produced in deterministic order.
     const bool deterministic_;
 
+    // Moving average of the time the inputs take to produce a result.
+    double average_result_micros_ TF_GUARDED_BY(mu_) = 0;
+
     // Iterator for input elements.
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
 
@@ -1551,6 +1683,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64 cycle_length_;
   const int64 block_length_;
   const int64 buffer_output_elements_;
+  // Whether the results buffer of each input adapts to the input's throughput.
+  const bool autotune_buffer_output_elements_;
   const int64 prefetch_input_elements_;
   const int64 num_parallel_calls_;
   const DeterminismPolicy deterministic_;
@@ -238,17 +238,17 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         EnsureThreadsStarted(ctx);
         while (ShouldWait(&result)) {
-          RecordStop(ctx);
+          RecordWaitStart(ctx);
           cond_var_->wait(l);
-          RecordStart(ctx);
+          RecordWaitStop(ctx);
         }
         if (cancelled_) {
           return errors::Cancelled("Iterator was cancelled");
         }
       }
-      RecordStop(ctx);
+      RecordWaitStart(ctx);
       result->notification.WaitForNotification();
-      RecordStart(ctx);
+      RecordWaitStop(ctx);
       profiler::TraceMe traceme([&] {
         return profiler::TraceMeEncode("ParallelMapConsume",
                                        {{"element_id", result->id}});
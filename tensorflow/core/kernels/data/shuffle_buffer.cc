@@ -0,0 +1,225 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/shuffle_buffer.h"
+
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/dataset.pb.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kNumElements[] = "num_elements";
+
+}  // namespace
+
+ShuffleBuffer::ShuffleBuffer(int64 capacity)
+    : ShuffleBuffer(capacity, /*memory_budget_bytes=*/-1, /*spill_dir=*/"",
+                    /*block_bytes=*/0) {}
+
+ShuffleBuffer::ShuffleBuffer(int64 capacity, int64 memory_budget_bytes,
+                             const std::string& spill_dir, int64 block_bytes)
+    : env_(Env::Default()),
+      memory_budget_bytes_(memory_budget_bytes),
+      spill_dir_(spill_dir),
+      block_bytes_(block_bytes),
+      id_(random::New64()),
+      elements_(capacity) {}
+
+ShuffleBuffer::~ShuffleBuffer() { Clear(); }
+
+Status ShuffleBuffer::Put(int64 index, std::vector<Tensor> element) {
+  DCHECK(elements_[index].empty() && !spilled_.contains(index));
+  const int64 bytes = GetTotalBytes(element);
+  if (spill_dir_.empty() || memory_bytes_ + bytes <= memory_budget_bytes_) {
+    memory_bytes_ += bytes;
+    elements_[index] = std::move(element);
+    return Status::OK();
+  }
+  return Spill(index, element);
+}
+
+Status ShuffleBuffer::Take(int64 index, std::vector<Tensor>* element) {
+  auto it = spilled_.find(index);
+  if (it == spilled_.end()) {
+    memory_bytes_ -= GetTotalBytes(elements_[index]);
+    *element = std::move(elements_[index]);
+    elements_[index].clear();
+    return Status::OK();
+  }
+  const SpillLocation location = it->second;
+  spilled_.erase(it);
+  Status s = ReadSpilled(location, element);
+  Block& block = blocks_[location.block];
+  if (--block.num_elements == 0) {
+    ReleaseBlock(location.block);
+  }
+  return s;
+}
+
+void ShuffleBuffer::Move(int64 from, int64 to) {
+  DCHECK(elements_[to].empty() && !spilled_.contains(to));
+  auto it = spilled_.find(from);
+  if (it == spilled_.end()) {
+    elements_[to] = std::move(elements_[from]);
+    elements_[from].clear();
+    return;
+  }
+  const SpillLocation location = it->second;
+  spilled_.erase(it);
+  spilled_[to] = location;
+}
+
+Status ShuffleBuffer::Save(IteratorStateWriter* writer,
+                           StringPiece key_prefix) {
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(key_prefix, kNumElements, capacity()));
+  std::vector<Tensor> element;
+  for (int64 i = 0; i < capacity(); ++i) {
+    auto it = spilled_.find(i);
+    if (it == spilled_.end()) {
+      TF_RETURN_IF_ERROR(
+          WriteElementToCheckpoint(writer, key_prefix, i, elements_[i]));
+      continue;
+    }
+    TF_RETURN_IF_ERROR(ReadSpilled(it->second, &element));
+    TF_RETURN_IF_ERROR(
+        WriteElementToCheckpoint(writer, key_prefix, i, element));
+  }
+  return Status::OK();
+}
+
+Status ShuffleBuffer::Restore(IteratorStateReader* reader,
+                              StringPiece key_prefix) {
+  Clear();
+  int64 num_elements;
+  TF_RETURN_IF_ERROR(
+      reader->ReadScalar(key_prefix, kNumElements, &num_elements));
+  std::vector<Tensor> element;
+  for (int64 i = 0; i < num_elements; ++i) {
+    TF_RETURN_IF_ERROR(ReadElementFromCheckpoint(reader, key_prefix, i,
+                                                 &element));
+    // Empty slots are skipped. Earlier versions could save trailing empty
+    // slots past the capacity of the buffer.
+    if (element.empty()) {
+      continue;
+    }
+    if (i >= capacity()) {
+      return errors::FailedPrecondition(
+          "Attempted to restore element ", i,
+          " into a shuffle buffer of capacity ", capacity());
+    }
+    TF_RETURN_IF_ERROR(Put(i, std::move(element)));
+    element.clear();
+  }
+  return Status::OK();
+}
+
+Status ShuffleBuffer::Spill(int64 index, const std::vector<Tensor>& element) {
+  CompressedElement compressed;
+  TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+  if (current_block_ < 0) {
+    current_block_ = next_block_++;
+  }
+  Block& block = blocks_[current_block_];
+  SpillLocation location;
+  location.block = current_block_;
+  location.offset = block.data.size();
+  if (!compressed.AppendToString(&block.data)) {
+    return errors::Internal("Failed to serialize a spilled shuffle element.");
+  }
+  location.length = block.data.size() - location.offset;
+  block.num_elements++;
+  spilled_[index] = location;
+  if (block.data.size() >= block_bytes_) {
+    TF_RETURN_IF_ERROR(FlushBlock(current_block_, &block));
+    current_block_ = -1;
+  }
+  return Status::OK();
+}
+
+Status ShuffleBuffer::ReadSpilled(const SpillLocation& location,
+                                  std::vector<Tensor>* element) {
+  const Block& block = blocks_[location.block];
+  CompressedElement compressed;
+  bool parsed;
+  if (block.file == nullptr) {
+    parsed = compressed.ParseFromArray(block.data.data() + location.offset,
+                                       location.length);
+  } else {
+    std::string scratch(location.length, '\0');
+    StringPiece data;
+    TF_RETURN_IF_ERROR(block.file->Read(location.offset, location.length,
+                                        &data, &scratch[0]));
+    parsed = data.size() == location.length &&
+             compressed.ParseFromArray(data.data(), data.size());
+  }
+  if (!parsed) {
+    return errors::DataLoss("Failed to read a spilled shuffle element from ",
+                            block.filename);
+  }
+  return UncompressElement(compressed, element);
+}
+
+Status ShuffleBuffer::FlushBlock(int64 block_id, Block* block) {
+  if (!spill_dir_created_) {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(spill_dir_));
+    spill_dir_created_ = true;
+  }
+  block->filename = io::JoinPath(
+      spill_dir_, strings::StrCat("shuffle_", id_, "_", block_id, ".spill"));
+  TF_RETURN_IF_ERROR(WriteStringToFile(env_, block->filename, block->data));
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(block->filename, &block->file));
+  std::string().swap(block->data);
+  VLOG(2) << "Spilled " << block->num_elements << " shuffle elements to "
+          << block->filename;
+  return Status::OK();
+}
+
+void ShuffleBuffer::ReleaseBlock(int64 block_id) {
+  auto it = blocks_.find(block_id);
+  if (it->second.file != nullptr) {
+    it->second.file.reset();
+    Status s = env_->DeleteFile(it->second.filename);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete shuffle spill file "
+                   << it->second.filename << ": " << s;
+    }
+  }
+  blocks_.erase(it);
+  if (current_block_ == block_id) {
+    current_block_ = -1;
+  }
+}
+
+void ShuffleBuffer::Clear() {
+  while (!blocks_.empty()) {
+    ReleaseBlock(blocks_.begin()->first);
+  }
+  spilled_.clear();
+  for (auto& element : elements_) {
+    element.clear();
+  }
+  memory_bytes_ = 0;
+}
+
+}  // namespace data
+}  // namespace tensorflow
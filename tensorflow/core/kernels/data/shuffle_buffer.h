@@ -0,0 +1,130 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_BUFFER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// The slots backing the window of a shuffle transformation.
+//
+// By default all elements are kept in memory. When constructed with a spill
+// directory, the buffer keeps at most `memory_budget_bytes` of elements in
+// memory and writes the remaining ones, compressed, to blocks of about
+// `block_bytes` bytes in that directory. An index maps every spilled slot to
+// its location within a block, so elements are sampled exactly as they are
+// from memory and the order of the produced elements does not depend on where
+// they are stored. A block file is deleted once all of its elements have been
+// taken.
+//
+// This class is not thread-safe.
+class ShuffleBuffer {
+ public:
+  // Creates a buffer of `capacity` slots that keeps all elements in memory.
+  explicit ShuffleBuffer(int64 capacity);
+
+  // Creates a buffer of `capacity` slots that keeps at most
+  // `memory_budget_bytes` of elements in memory and spills the others to files
+  // in `spill_dir`.
+  ShuffleBuffer(int64 capacity, int64 memory_budget_bytes,
+                const std::string& spill_dir, int64 block_bytes);
+
+  ~ShuffleBuffer();
+
+  ShuffleBuffer(const ShuffleBuffer&) = delete;
+  ShuffleBuffer& operator=(const ShuffleBuffer&) = delete;
+
+  int64 capacity() const { return elements_.size(); }
+
+  // The number of bytes of the elements held in memory.
+  int64 memory_bytes() const { return memory_bytes_; }
+
+  // The number of elements held on disk.
+  int64 num_spilled() const { return spilled_.size(); }
+
+  // Stores `element` in the empty slot `index`.
+  Status Put(int64 index, std::vector<Tensor> element);
+
+  // Removes the element in the slot `index` and stores it in `element`. The
+  // slot becomes empty.
+  Status Take(int64 index, std::vector<Tensor>* element);
+
+  // Moves the element in the slot `from` to the empty slot `to` without
+  // reading it.
+  void Move(int64 from, int64 to);
+
+  // Saves the elements using the keys of `WriteElementsToCheckpoint`, reading
+  // the spilled elements back one at a time.
+  Status Save(IteratorStateWriter* writer, StringPiece key_prefix);
+
+  // Replaces the contents of the buffer with the elements saved by `Save` or
+  // by `WriteElementsToCheckpoint`.
+  Status Restore(IteratorStateReader* reader, StringPiece key_prefix);
+
+ private:
+  // The location of a spilled element.
+  struct SpillLocation {
+    int64 block;
+    int64 offset;
+    int64 length;
+  };
+
+  // A group of spilled elements. The block that receives new elements is kept
+  // in memory until it reaches `block_bytes_`, at which point it is written
+  // to `filename`.
+  struct Block {
+    std::string filename;
+    std::string data;
+    std::unique_ptr<RandomAccessFile> file;
+    int64 num_elements = 0;
+  };
+
+  Status Spill(int64 index, const std::vector<Tensor>& element);
+  Status ReadSpilled(const SpillLocation& location,
+                     std::vector<Tensor>* element);
+  Status FlushBlock(int64 block_id, Block* block);
+  void ReleaseBlock(int64 block_id);
+  void Clear();
+
+  Env* const env_;
+  const int64 memory_budget_bytes_;
+  const std::string spill_dir_;
+  const int64 block_bytes_;
+  // Distinguishes the block files of different buffers in `spill_dir_`.
+  const uint64 id_;
+  std::vector<std::vector<Tensor>> elements_;
+  int64 memory_bytes_ = 0;
+  absl::flat_hash_map<int64, SpillLocation> spilled_;
+  absl::flat_hash_map<int64, Block> blocks_;
+  // The block that receives new elements, or -1 if none.
+  int64 current_block_ = -1;
+  int64 next_block_ = 0;
+  bool spill_dir_created_ = false;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_BUFFER_H_
@@ -0,0 +1,132 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/shuffle_buffer.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64 kCapacity = 64;
+
+std::vector<Tensor> MakeElement(int64 i) {
+  return {test::AsTensor<int64>({i, i + 1, i + 2, i + 3}),
+          test::AsScalar<tstring>(strings::StrCat("element_", i))};
+}
+
+void ExpectElement(int64 i, const std::vector<Tensor>& element) {
+  ASSERT_EQ(2, element.size());
+  test::ExpectTensorEqual<int64>(MakeElement(i)[0], element[0]);
+  test::ExpectTensorEqual<tstring>(MakeElement(i)[1], element[1]);
+}
+
+std::string SpillDir(const std::string& test) {
+  return io::JoinPath(testing::TmpDir(), "shuffle_buffer_test", test);
+}
+
+int64 NumFiles(const std::string& dir) {
+  std::vector<string> children;
+  if (!Env::Default()->GetChildren(dir, &children).ok()) {
+    return 0;
+  }
+  return children.size();
+}
+
+TEST(ShuffleBufferTest, InMemory) {
+  ShuffleBuffer buffer(kCapacity);
+  for (int64 i = 0; i < kCapacity; ++i) {
+    TF_ASSERT_OK(buffer.Put(i, MakeElement(i)));
+  }
+  EXPECT_EQ(0, buffer.num_spilled());
+  EXPECT_EQ(kCapacity * GetTotalBytes(MakeElement(0)), buffer.memory_bytes());
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(buffer.Take(3, &element));
+  ExpectElement(3, element);
+  buffer.Move(0, 3);
+  TF_ASSERT_OK(buffer.Take(3, &element));
+  ExpectElement(0, element);
+}
+
+TEST(ShuffleBufferTest, SpillsBeyondTheMemoryBudget) {
+  const std::string dir = SpillDir("spill");
+  const int64 element_bytes = GetTotalBytes(MakeElement(0));
+  ShuffleBuffer buffer(kCapacity, /*memory_budget_bytes=*/4 * element_bytes,
+                       dir, /*block_bytes=*/256);
+  for (int64 i = 0; i < kCapacity; ++i) {
+    TF_ASSERT_OK(buffer.Put(i, MakeElement(i)));
+  }
+  EXPECT_EQ(4 * element_bytes, buffer.memory_bytes());
+  EXPECT_EQ(kCapacity - 4, buffer.num_spilled());
+  EXPECT_GT(NumFiles(dir), 0);
+
+  // Moving a spilled element only updates the index.
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(buffer.Take(10, &element));
+  ExpectElement(10, element);
+  buffer.Move(20, 10);
+  TF_ASSERT_OK(buffer.Take(10, &element));
+  ExpectElement(20, element);
+  for (int64 i = 0; i < kCapacity; ++i) {
+    if (i == 10 || i == 20) continue;
+    TF_ASSERT_OK(buffer.Take(i, &element));
+    ExpectElement(i, element);
+  }
+  EXPECT_EQ(0, buffer.num_spilled());
+  EXPECT_EQ(0, buffer.memory_bytes());
+  // Block files are deleted once all of their elements were taken.
+  EXPECT_EQ(0, NumFiles(dir));
+}
+
+TEST(ShuffleBufferTest, SaveAndRestore) {
+  const int64 element_bytes = GetTotalBytes(MakeElement(0));
+  ShuffleBuffer buffer(kCapacity, /*memory_budget_bytes=*/element_bytes,
+                       SpillDir("save"), /*block_bytes=*/256);
+  for (int64 i = 0; i < kCapacity; i += 2) {
+    TF_ASSERT_OK(buffer.Put(i, MakeElement(i)));
+  }
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(buffer.Save(&writer, "buffer"));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+
+  // Spilled elements are saved in the format of `WriteElementsToCheckpoint`.
+  VariantTensorDataReader reader(data);
+  std::vector<std::vector<Tensor>> elements;
+  TF_ASSERT_OK(ReadElementsFromCheckpoint(&reader, "buffer", &elements));
+  ASSERT_EQ(kCapacity, elements.size());
+  ShuffleBuffer restored(kCapacity);
+  TF_ASSERT_OK(restored.Restore(&reader, "buffer"));
+  for (int64 i = 0; i < kCapacity; ++i) {
+    if (i % 2) {
+      EXPECT_TRUE(elements[i].empty());
+      continue;
+    }
+    ExpectElement(i, elements[i]);
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(restored.Take(i, &element));
+    ExpectElement(i, element);
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -25,12 +25,14 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/data/shuffle_buffer.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -55,6 +57,11 @@ namespace data {
 
 const int64 kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 const int64 kMaxEpochsInBuffer = 3;
+// The default number of bytes of shuffle buffer elements kept in memory when
+// spilling to disk is enabled.
+const int64 kDefaultSpillMemoryBudgetBytes = 1LL << 30;  // 1 GB.
+// The approximate size of the files that spilled elements are written to.
+const int64 kSpillBlockBytes = 16LL << 20;  // 16 MB.
 
 constexpr char kNumRandomSamples[] = "num_random_samples";
 constexpr char kDataProduced[] = "data_produced";
@@ -75,6 +82,30 @@ constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
 constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
+// Creates the buffer of a shuffle iterator. If the `TF_DATA_SHUFFLE_SPILL_DIR`
+// environment variable names a directory, elements that do not fit in the
+// memory budget given by `TF_DATA_SHUFFLE_MEMORY_BUDGET_BYTES` are spilled to
+// it.
+std::unique_ptr<ShuffleBuffer> MakeShuffleBuffer(int64 capacity) {
+  string spill_dir;
+  Status s = ReadStringFromEnvVar("TF_DATA_SHUFFLE_SPILL_DIR", "", &spill_dir);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+  }
+  if (spill_dir.empty()) {
+    return absl::make_unique<ShuffleBuffer>(capacity);
+  }
+  int64 memory_budget_bytes;
+  s = ReadInt64FromEnvVar("TF_DATA_SHUFFLE_MEMORY_BUDGET_BYTES",
+                          kDefaultSpillMemoryBudgetBytes, &memory_budget_bytes);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    memory_budget_bytes = kDefaultSpillMemoryBudgetBytes;
+  }
+  return absl::make_unique<ShuffleBuffer>(capacity, memory_budget_bytes,
+                                          spill_dir, kSpillBlockBytes);
+}
+
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {}
 
@@ -148,8 +179,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           seed_generator_(seed_generator),
           parent_generator_(seed_generator->seed(), seed_generator->seed2()),
           generator_(&parent_generator_) {
-      buffer_ = absl::make_unique<std::vector<std::vector<Tensor>>>(
-          params.dataset->buffer_size_);
+      buffer_ = MakeShuffleBuffer(params.dataset->buffer_size_);
       slices_.push_back(absl::make_unique<Slice>(0, 0));
     }
 
@@ -210,8 +240,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
                     << this->dataset()->buffer_size_;
           }
           this->RecordBufferEnqueue(ctx, input_element);
-          buffer_->at(slices_.back()->end % this->dataset()->buffer_size_) =
-              std::move(input_element);
+          TF_RETURN_IF_ERROR(buffer_->Put(
+              slices_.back()->end % this->dataset()->buffer_size_,
+              std::move(input_element)));
           num_elements_++;
           slices_.back()->end++;
         } else {
@@ -248,11 +279,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             Random() % (slices_.front()->end - slices_.front()->start);
         int64 index =
             (slices_.front()->start + offset) % this->dataset()->buffer_size_;
-        *out_tensors = std::move(buffer_->at(index));
+        TF_RETURN_IF_ERROR(buffer_->Take(index, out_tensors));
         this->RecordBufferDequeue(ctx, *out_tensors);
-        std::swap(buffer_->at(index),
-                  buffer_->at(slices_.front()->start %
-                              this->dataset()->buffer_size_));
+        int64 start_index =
+            slices_.front()->start % this->dataset()->buffer_size_;
+        if (start_index != index) {
+          buffer_->Move(start_index, index);
+        }
         slices_.front()->start++;
         num_elements_--;
       } else {
@@ -302,7 +335,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kEpoch), epoch_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kNumElements), num_elements_));
-      TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      TF_RETURN_IF_ERROR(buffer_->Save(writer, prefix()));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kSlicesSize), slices_.size()));
       for (size_t i = 0; i < slices_.size(); ++i) {
@@ -357,10 +390,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             reader->ReadScalar(this->full_name(kSlicesSize), &temp));
         slices_size = static_cast<size_t>(temp);
       }
-      buffer_ = absl::make_unique<std::vector<std::vector<Tensor>>>(
-          this->dataset()->buffer_size_);
-      TF_RETURN_IF_ERROR(
-          ReadElementsFromCheckpoint(reader, prefix(), buffer_.get()));
+      TF_RETURN_IF_ERROR(buffer_->Restore(reader, prefix()));
       slices_.clear();
       for (size_t i = 0; i < slices_size; ++i) {
         int64 start;
@@ -405,8 +435,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
     mutex mu_;
     SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
-    std::unique_ptr<std::vector<std::vector<Tensor>>> buffer_
-        TF_GUARDED_BY(mu_);
+    std::unique_ptr<ShuffleBuffer> buffer_ TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
     int64 epoch_ TF_GUARDED_BY(mu_) = 0;
     int64 num_elements_ TF_GUARDED_BY(mu_) = 0;
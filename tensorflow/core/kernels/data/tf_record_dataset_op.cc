@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -50,10 +52,32 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+// The buffer of a scalar string tensor whose string is a view of a record in a
+// memory-mapped file. Keeps the mapping alive for as long as the tensor is.
+class MappedRecordBuffer : public TensorBuffer {
+ public:
+  MappedRecordBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const tstring& record)
+      : TensorBuffer(&record_), region_(std::move(region)), record_(record) {}
+
+  size_t size() const override { return sizeof(tstring); }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(record_.size());
+    proto->set_allocator_name("mmap");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  tstring record_;
+};
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   bool use_mmap, int64 checksum_sample_period)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
@@ -62,6 +86,9 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    options_.checksum_sample_period = checksum_sample_period;
+    use_mmap_ =
+        use_mmap && options_.compression_type == io::RecordReaderOptions::NONE;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -120,10 +147,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       do {
         // We are currently processing a file, so try to read the next record.
         if (reader_) {
-          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
-                                    TensorShape({}));
-          Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+          Status s = ReadRecordLocked(ctx, out_tensors);
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -132,7 +156,6 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
             *end_of_sequence = false;
             return Status::OK();
           }
-          out_tensors->pop_back();
           if (!errors::IsOutOfRange(s)) {
             // In case of other errors e.g., DataLoss, we still move forward
             // the file index so that it works with ignore_errors.
@@ -195,6 +218,28 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Reads the next record of the current file into a new tensor at the end
+    // of `*out_tensors`.
+    Status ReadRecordLocked(IteratorContext* ctx,
+                            std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (region_) {
+        tstring record;
+        TF_RETURN_IF_ERROR(reader_->ReadRecord(&record));
+        auto* buffer = new MappedRecordBuffer(region_, record);
+        out_tensors->emplace_back(DT_STRING, TensorShape({}), buffer);
+        buffer->Unref();
+        return Status::OK();
+      }
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      Status s = reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+      if (!s.ok()) {
+        out_tensors->pop_back();
+      }
+      return s;
+    }
+
     // Sets up reader streams to read from the file at `current_file_index_`.
     Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (current_file_index_ >= dataset()->filenames_.size()) {
@@ -205,6 +250,18 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
       // Actually move on to next file.
       const string& next_filename = dataset()->filenames_[current_file_index_];
+      if (dataset()->use_mmap_) {
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        Status s = env->NewReadOnlyMemoryRegionFromFile(next_filename, &region);
+        if (s.ok() && region != nullptr) {
+          region_ = std::move(region);
+          reader_ = absl::make_unique<io::SequentialRecordReader>(
+              region_.get(), dataset()->options_);
+          return Status::OK();
+        }
+        VLOG(1) << "Failed to map " << next_filename
+                << " into memory, reading it instead: " << s;
+      }
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
       reader_ = absl::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
@@ -215,6 +272,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      region_.reset();
     }
 
     mutex mu_;
@@ -223,12 +281,16 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // `reader_` will borrow the object that `file_` points to, so
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
+    // When the file is memory-mapped, `reader_` reads from `region_` instead,
+    // which is shared with the tensors returned by the iterator.
+    std::shared_ptr<ReadOnlyMemoryRegion> region_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  bool use_mmap_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
@@ -279,8 +341,18 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  // Uncompressed files on local file systems can be memory-mapped, in which
+  // case the records are returned without copying them.
+  bool use_mmap = false;
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_DATA_TFRECORD_USE_MMAP",
+                                         /*default_val=*/false, &use_mmap));
+  int64 checksum_sample_period = 1;
+  OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar("TF_DATA_TFRECORD_CHECKSUM_PERIOD",
+                                          /*default_val=*/1,
+                                          &checksum_sample_period));
+
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, use_mmap, checksum_sample_period);
 }
 
 namespace {
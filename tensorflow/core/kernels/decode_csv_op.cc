@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -76,7 +77,17 @@ class DecodeCSVOp : public OpKernel {
     OpOutputList output;
     OP_REQUIRES_OK(ctx, ctx->output_list("output", &output));
 
+    // String columns are gathered into one character buffer per column, and
+    // are only allocated once all the records have been parsed.  Each value
+    // is followed by a '\0', and `string_ends` holds the offset of the
+    // terminator of every value.
+    std::vector<string> string_chars(out_type_.size());
+    std::vector<std::vector<int64>> string_ends(out_type_.size());
     for (int i = 0; i < static_cast<int>(out_type_.size()); ++i) {
+      if (out_type_[i] == DT_STRING) {
+        string_ends[i].reserve(records_size);
+        continue;
+      }
       Tensor* out = nullptr;
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
@@ -181,11 +192,13 @@ class DecodeCSVOp : public OpKernel {
                           errors::InvalidArgument(
                               "Field ", f,
                               " is required but missing in record ", i, "!"));
-              output[f]->flat<tstring>()(i) =
-                  record_defaults[f].flat<tstring>()(0);
+              const tstring& value = record_defaults[f].flat<tstring>()(0);
+              string_chars[f].append(value.data(), value.size());
             } else {
-              output[f]->flat<tstring>()(i) = std::move(fields[f]);
+              string_chars[f].append(fields[f]);
             }
+            string_ends[f].push_back(string_chars[f].size());
+            string_chars[f].push_back('\0');
             break;
           }
           default:
@@ -195,9 +208,49 @@ class DecodeCSVOp : public OpKernel {
         }
       }
     }
+
+    for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
+      if (out_type_[f] == DT_STRING) {
+        OP_REQUIRES_OK(ctx, SetStringOutput(ctx, &output, f, records->shape(),
+                                            string_chars[f], string_ends[f]));
+      }
+    }
   }
 
  private:
+  // Sets output `f` to the strings of `chars` that end at `ends`.  The values
+  // are offsets into a single arena allocated with the tensor, rather than
+  // separate heap allocations, unless the arena cannot be allocated.
+  Status SetStringOutput(OpKernelContext* ctx, OpOutputList* output, int f,
+                         const TensorShape& shape, const string& chars,
+                         const std::vector<int64>& ends) {
+    Tensor out;
+    char* arena = nullptr;
+    if (tensor::AllocateStringTensorWithArena(
+            ctx->get_allocator(AllocatorAttributes()), shape, chars.size(),
+            &out, &arena)) {
+      memcpy(arena, chars.data(), chars.size());
+      auto out_t = out.flat<tstring>();
+      int64 begin = 0;
+      for (int64 i = 0; i < out_t.size(); ++i) {
+        out_t(i).assign_as_offset(arena + begin, ends[i] - begin);
+        begin = ends[i] + 1;
+      }
+      output->set(f, out);
+      return Status::OK();
+    }
+
+    Tensor* out_ptr = nullptr;
+    TF_RETURN_IF_ERROR(output->allocate(f, shape, &out_ptr));
+    auto out_t = out_ptr->flat<tstring>();
+    int64 begin = 0;
+    for (int64 i = 0; i < out_t.size(); ++i) {
+      out_t(i).assign(chars.data() + begin, ends[i] - begin);
+      begin = ends[i] + 1;
+    }
+    return Status::OK();
+  }
+
   std::vector<DataType> out_type_;
   std::vector<int64> select_cols_;
   char delim_;
@@ -0,0 +1,503 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fused_attention_op.h"
+
+#include <algorithm>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/guarded_philox_random.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// Validates the shapes of the attention inputs and fills in the dimensions of
+// 'params'.
+Status GetFusedAttentionParams(const Tensor& query, const Tensor& key,
+                               const Tensor& value, const OpInputList& bias,
+                               FusedAttentionParams* params) {
+  if (query.dims() != 4 || key.dims() != 4 || value.dims() != 4) {
+    return errors::InvalidArgument(
+        "query, key and value must be 4-D, got shapes ",
+        query.shape().DebugString(), ", ", key.shape().DebugString(), " and ",
+        value.shape().DebugString());
+  }
+  params->batch = query.dim_size(0);
+  params->heads = query.dim_size(1);
+  params->query_len = query.dim_size(2);
+  params->depth = query.dim_size(3);
+  params->key_len = key.dim_size(2);
+  params->value_depth = value.dim_size(3);
+  if (key.dim_size(0) != params->batch || key.dim_size(1) != params->heads ||
+      key.dim_size(3) != params->depth) {
+    return errors::InvalidArgument(
+        "key must be [batch, heads, key_len, depth] with the batch, heads and "
+        "depth of query ",
+        query.shape().DebugString(), ", got ", key.shape().DebugString());
+  }
+  if (value.dim_size(0) != params->batch ||
+      value.dim_size(1) != params->heads ||
+      value.dim_size(2) != params->key_len) {
+    return errors::InvalidArgument(
+        "value must be [batch, heads, key_len, value_depth] with the batch, "
+        "heads and key_len of key ",
+        key.shape().DebugString(), ", got ", value.shape().DebugString());
+  }
+  if (params->key_len == 0 && params->query_len > 0) {
+    return errors::InvalidArgument("key and value must not be empty");
+  }
+
+  params->bias_batch_stride = 0;
+  params->bias_head_stride = 0;
+  params->bias_query_stride = 0;
+  if (bias.size() > 0) {
+    const Tensor& b = bias[0];
+    if (b.dims() != 4 ||
+        (b.dim_size(0) != 1 && b.dim_size(0) != params->batch) ||
+        (b.dim_size(1) != 1 && b.dim_size(1) != params->heads) ||
+        (b.dim_size(2) != 1 && b.dim_size(2) != params->query_len) ||
+        b.dim_size(3) != params->key_len) {
+      return errors::InvalidArgument(
+          "bias must be [batch or 1, heads or 1, query_len or 1, key_len] = [",
+          params->batch, " or 1, ", params->heads, " or 1, ",
+          params->query_len, " or 1, ", params->key_len, "], got ",
+          b.shape().DebugString());
+    }
+    const int64 matrix_size = b.dim_size(2) * params->key_len;
+    if (b.dim_size(2) != 1) params->bias_query_stride = params->key_len;
+    if (b.dim_size(1) != 1) params->bias_head_stride = matrix_size;
+    if (b.dim_size(0) != 1) {
+      params->bias_batch_stride = matrix_size * b.dim_size(1);
+    }
+  }
+  return Status::OK();
+}
+
+Status GetFusedAttentionAttrs(OpKernelConstruction* ctx,
+                              FusedAttentionParams* params) {
+  TF_RETURN_IF_ERROR(ctx->GetAttr("scale", &params->scale));
+  TF_RETURN_IF_ERROR(ctx->GetAttr("dropout_rate", &params->dropout_rate));
+  if (!(params->dropout_rate >= 0.0f && params->dropout_rate < 1.0f)) {
+    return errors::InvalidArgument("dropout_rate must be in [0, 1), got ",
+                                   params->dropout_rate);
+  }
+  int num_bias;
+  TF_RETURN_IF_ERROR(ctx->GetAttr("num_bias", &num_bias));
+  if (num_bias > 1) {
+    return errors::InvalidArgument("At most one bias is supported, got ",
+                                   num_bias);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedAttentionOp : public OpKernel {
+ public:
+  explicit FusedAttentionOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, GetFusedAttentionAttrs(ctx, &attrs_));
+    OP_REQUIRES_OK(ctx, generator_.Init(ctx));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& query = ctx->input(0);
+    const Tensor& key = ctx->input(1);
+    const Tensor& value = ctx->input(2);
+    OpInputList bias;
+    OP_REQUIRES_OK(ctx, ctx->input_list("bias", &bias));
+
+    FusedAttentionParams params = attrs_;
+    OP_REQUIRES_OK(
+        ctx, GetFusedAttentionParams(query, key, value, bias, &params));
+
+    Tensor* output = nullptr;
+    Tensor* logsumexp = nullptr;
+    Tensor* dropout_seed = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            0,
+                            TensorShape({params.batch, params.heads,
+                                         params.query_len, params.value_depth}),
+                            &output));
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(1,
+                                  TensorShape({params.batch, params.heads,
+                                               params.query_len}),
+                                  &logsumexp));
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(2, TensorShape({}), &dropout_seed));
+
+    // Every call draws a fresh dropout seed, which FusedAttentionGrad takes to
+    // regenerate the same mask.
+    if (params.dropout_rate > 0.0f) {
+      random::PhiloxRandom gen = generator_.ReserveSamples128(1);
+      const random::PhiloxRandom::ResultType sample = gen();
+      params.dropout_seed = (static_cast<uint64>(sample[0]) << 32) | sample[1];
+    }
+    dropout_seed->scalar<int64>()() = static_cast<int64>(params.dropout_seed);
+
+    if (logsumexp->NumElements() == 0) return;
+
+    OP_REQUIRES_OK(
+        ctx, functor::FusedAttentionForward<Device, T>()(
+                 ctx->eigen_device<Device>(), params, query.flat<T>().data(),
+                 key.flat<T>().data(), value.flat<T>().data(),
+                 bias.size() > 0 ? bias[0].flat<T>().data() : nullptr,
+                 output->flat<T>().data(), logsumexp->flat<T>().data()));
+  }
+
+ private:
+  FusedAttentionParams attrs_;
+  GuardedPhiloxRandom generator_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedAttentionOp);
+};
+
+template <typename Device, typename T>
+class FusedAttentionGradOp : public OpKernel {
+ public:
+  explicit FusedAttentionGradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, GetFusedAttentionAttrs(ctx, &attrs_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& query = ctx->input(0);
+    const Tensor& key = ctx->input(1);
+    const Tensor& value = ctx->input(2);
+    OpInputList bias;
+    OP_REQUIRES_OK(ctx, ctx->input_list("bias", &bias));
+    const Tensor* output;
+    const Tensor* logsumexp;
+    const Tensor* dropout_seed;
+    const Tensor* output_backprop;
+    OP_REQUIRES_OK(ctx, ctx->input("output", &output));
+    OP_REQUIRES_OK(ctx, ctx->input("logsumexp", &logsumexp));
+    OP_REQUIRES_OK(ctx, ctx->input("dropout_seed", &dropout_seed));
+    OP_REQUIRES_OK(ctx, ctx->input("output_backprop", &output_backprop));
+
+    FusedAttentionParams params = attrs_;
+    OP_REQUIRES_OK(
+        ctx, GetFusedAttentionParams(query, key, value, bias, &params));
+
+    const TensorShape output_shape({params.batch, params.heads,
+                                    params.query_len, params.value_depth});
+    const TensorShape logsumexp_shape(
+        {params.batch, params.heads, params.query_len});
+    OP_REQUIRES(ctx,
+                output->shape() == output_shape &&
+                    output_backprop->shape() == output_shape,
+                errors::InvalidArgument(
+                    "output and output_backprop must have shape ",
+                    output_shape.DebugString(), ", got ",
+                    output->shape().DebugString(), " and ",
+                    output_backprop->shape().DebugString()));
+    OP_REQUIRES(ctx, logsumexp->shape() == logsumexp_shape,
+                errors::InvalidArgument("logsumexp must have shape ",
+                                        logsumexp_shape.DebugString(), ", got ",
+                                        logsumexp->shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(dropout_seed->shape()),
+                errors::InvalidArgument("dropout_seed must be a scalar, got ",
+                                        dropout_seed->shape().DebugString()));
+    params.dropout_seed = static_cast<uint64>(dropout_seed->scalar<int64>()());
+
+    Tensor* query_backprop = nullptr;
+    Tensor* key_backprop = nullptr;
+    Tensor* value_backprop = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(0, query.shape(), &query_backprop));
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, key.shape(), &key_backprop));
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(2, value.shape(), &value_backprop));
+    Tensor delta;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                           logsumexp_shape, &delta));
+
+    if (params.batch * params.heads == 0) return;
+
+    OP_REQUIRES_OK(
+        ctx, functor::FusedAttentionBackward<Device, T>()(
+                 ctx->eigen_device<Device>(), params, query.flat<T>().data(),
+                 key.flat<T>().data(), value.flat<T>().data(),
+                 bias.size() > 0 ? bias[0].flat<T>().data() : nullptr,
+                 output->flat<T>().data(), logsumexp->flat<T>().data(),
+                 output_backprop->flat<T>().data(), delta.flat<T>().data(),
+                 query_backprop->flat<T>().data(),
+                 key_backprop->flat<T>().data(),
+                 value_backprop->flat<T>().data()));
+  }
+
+ private:
+  FusedAttentionParams attrs_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedAttentionGradOp);
+};
+
+#define REGISTER_CPU(T)                                                     \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("FusedAttention").Device(DEVICE_CPU).TypeConstraint<T>("T"),     \
+      FusedAttentionOp<CPUDevice, T>);                                      \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("FusedAttentionGrad").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedAttentionGradOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_double(REGISTER_CPU);
+#undef REGISTER_CPU
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                   \
+  extern template struct FusedAttentionForward<GPUDevice, T>; \
+  extern template struct FusedAttentionBackward<GPUDevice, T>;
+
+TF_CALL_float(DECLARE_GPU_SPEC);
+TF_CALL_double(DECLARE_GPU_SPEC);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU(T)                                    \
+  REGISTER_KERNEL_BUILDER(Name("FusedAttention")           \
+                              .Device(DEVICE_GPU)          \
+                              .TypeConstraint<T>("T")      \
+                              .HostMemory("dropout_seed"), \
+                          FusedAttentionOp<GPUDevice, T>); \
+  REGISTER_KERNEL_BUILDER(Name("FusedAttentionGrad")       \
+                              .Device(DEVICE_GPU)          \
+                              .TypeConstraint<T>("T")      \
+                              .HostMemory("dropout_seed"), \
+                          FusedAttentionGradOp<GPUDevice, T>);
+
+TF_CALL_float(REGISTER_GPU);
+TF_CALL_double(REGISTER_GPU);
+#undef REGISTER_GPU
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace functor {
+
+namespace {
+
+// Number of query rows the CPU kernels process at a time. The attention
+// scores of one tile, [kQueryTile, key_len], are the only intermediate.
+constexpr int64 kQueryTile = 64;
+
+template <typename T>
+using RowMajorMatrix =
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+template <typename T>
+using Vector = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+template <typename T>
+using MatrixMap = Eigen::Map<RowMajorMatrix<T>>;
+template <typename T>
+using ConstMatrixMap = Eigen::Map<const RowMajorMatrix<T>>;
+template <typename T>
+using VectorMap = Eigen::Map<Vector<T>>;
+template <typename T>
+using ConstVectorMap = Eigen::Map<const Vector<T>>;
+
+// Sets 'scores' to the scaled and biased attention logits of 'rows' query rows
+// of (batch, head) pair 'bh', starting at 'row_begin'.
+template <typename T>
+void ComputeScores(const FusedAttentionParams& p, const T* query,
+                   const T* key, const T* bias, int64 bh, int64 row_begin,
+                   int64 rows, RowMajorMatrix<T>* scores) {
+  ConstMatrixMap<T> q(query + (bh * p.query_len + row_begin) * p.depth, rows,
+                      p.depth);
+  ConstMatrixMap<T> k(key + bh * p.key_len * p.depth, p.key_len, p.depth);
+  scores->noalias() = static_cast<T>(p.scale) * (q * k.transpose());
+  if (bias != nullptr) {
+    const int64 b = bh / p.heads;
+    const int64 h = bh % p.heads;
+    const T* bias_rows = bias + b * p.bias_batch_stride +
+                         h * p.bias_head_stride +
+                         row_begin * p.bias_query_stride;
+    if (p.bias_query_stride == 0) {
+      scores->rowwise() +=
+          ConstMatrixMap<T>(bias_rows, 1, p.key_len).row(0);
+    } else {
+      *scores += ConstMatrixMap<T>(bias_rows, rows, p.key_len);
+    }
+  }
+}
+
+// Multiplies the probabilities of 'rows' query rows starting at 'row_begin'
+// by the dropout mask, scaled by 1 / (1 - rate).
+template <typename T>
+void ApplyDropoutMask(const FusedAttentionParams& p, int64 bh,
+                      int64 row_begin, int64 rows, RowMajorMatrix<T>* probs) {
+  const T keep_scale = static_cast<T>(1.0 / (1.0 - p.dropout_rate));
+  for (int64 r = 0; r < rows; ++r) {
+    const int64 base = (bh * p.query_len + row_begin + r) * p.key_len;
+    for (int64 j = 0; j < p.key_len; ++j) {
+      (*probs)(r, j) =
+          FusedAttentionKeep(p.dropout_seed, base + j, p.dropout_rate)
+              ? (*probs)(r, j) * keep_scale
+              : T(0);
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+struct FusedAttentionForward<CPUDevice, T> {
+  Status operator()(const CPUDevice& d, const FusedAttentionParams& p,
+                    const T* query, const T* key, const T* value,
+                    const T* bias, T* output, T* logsumexp) {
+    const int64 num_tiles = (p.query_len + kQueryTile - 1) / kQueryTile;
+    auto work = [&](int64 begin, int64 end) {
+      RowMajorMatrix<T> scores;
+      for (int64 unit = begin; unit < end; ++unit) {
+        const int64 bh = unit / num_tiles;
+        const int64 row_begin = (unit % num_tiles) * kQueryTile;
+        const int64 rows = std::min(kQueryTile, p.query_len - row_begin);
+        ComputeScores(p, query, key, bias, bh, row_begin, rows, &scores);
+
+        // Numerically stable softmax over every row.
+        const Vector<T> row_max = scores.rowwise().maxCoeff();
+        scores.colwise() -= row_max;
+        scores = scores.array().exp().matrix();
+        const Vector<T> row_sum = scores.rowwise().sum();
+        VectorMap<T> lse(logsumexp + bh * p.query_len + row_begin, rows);
+        lse.array() = row_max.array() + row_sum.array().log();
+        scores.array().colwise() /= row_sum.array();
+        if (p.dropout_rate > 0.0f) {
+          ApplyDropoutMask(p, bh, row_begin, rows, &scores);
+        }
+
+        ConstMatrixMap<T> v(value + bh * p.key_len * p.value_depth, p.key_len,
+                            p.value_depth);
+        MatrixMap<T> out(
+            output + (bh * p.query_len + row_begin) * p.value_depth, rows,
+            p.value_depth);
+        out.noalias() = scores * v;
+      }
+    };
+    const double tile_flops = static_cast<double>(kQueryTile) * p.key_len *
+                              (p.depth + p.value_depth) * 2;
+    d.parallelFor(p.batch * p.heads * num_tiles,
+                  Eigen::TensorOpCost(
+                      sizeof(T) * p.key_len * (p.depth + p.value_depth),
+                      sizeof(T) * kQueryTile * p.value_depth, tile_flops),
+                  work);
+    return Status::OK();
+  }
+};
+
+template <typename T>
+struct FusedAttentionBackward<CPUDevice, T> {
+  Status operator()(const CPUDevice& d, const FusedAttentionParams& p,
+                    const T* query, const T* key, const T* value,
+                    const T* bias, const T* output, const T* logsumexp,
+                    const T* output_backprop, T* delta, T* query_backprop,
+                    T* key_backprop, T* value_backprop) {
+    const T scale = static_cast<T>(p.scale);
+    const T keep_scale = static_cast<T>(1.0 / (1.0 - p.dropout_rate));
+    // The key and value gradients sum over all query rows, so every worker
+    // owns whole (batch, head) pairs.
+    auto work = [&](int64 begin, int64 end) {
+      RowMajorMatrix<T> probs;
+      RowMajorMatrix<T> dropped_probs;
+      RowMajorMatrix<T> grad_probs;
+      for (int64 bh = begin; bh < end; ++bh) {
+        ConstMatrixMap<T> k(key + bh * p.key_len * p.depth, p.key_len,
+                            p.depth);
+        ConstMatrixMap<T> v(value + bh * p.key_len * p.value_depth, p.key_len,
+                            p.value_depth);
+        MatrixMap<T> dk(key_backprop + bh * p.key_len * p.depth, p.key_len,
+                        p.depth);
+        MatrixMap<T> dv(value_backprop + bh * p.key_len * p.value_depth,
+                        p.key_len, p.value_depth);
+        dk.setZero();
+        dv.setZero();
+        for (int64 row_begin = 0; row_begin < p.query_len;
+             row_begin += kQueryTile) {
+          const int64 rows = std::min(kQueryTile, p.query_len - row_begin);
+          const int64 row_offset = bh * p.query_len + row_begin;
+          ConstMatrixMap<T> q(query + row_offset * p.depth, rows, p.depth);
+          ConstMatrixMap<T> out(output + row_offset * p.value_depth, rows,
+                                p.value_depth);
+          ConstMatrixMap<T> dout(output_backprop + row_offset * p.value_depth,
+                                 rows, p.value_depth);
+          ConstVectorMap<T> lse(logsumexp + row_offset, rows);
+          VectorMap<T> row_delta(delta + row_offset, rows);
+
+          // Recompute the softmax probabilities from the saved log-sum-exp.
+          ComputeScores(p, query, key, bias, bh, row_begin, rows, &probs);
+          probs.colwise() -= lse;
+          probs = probs.array().exp().matrix();
+
+          grad_probs.noalias() = dout * v.transpose();
+          if (p.dropout_rate > 0.0f) {
+            dropped_probs = probs;
+            for (int64 r = 0; r < rows; ++r) {
+              const int64 base = (row_offset + r) * p.key_len;
+              for (int64 j = 0; j < p.key_len; ++j) {
+                if (FusedAttentionKeep(p.dropout_seed, base + j,
+                                       p.dropout_rate)) {
+                  dropped_probs(r, j) *= keep_scale;
+                  grad_probs(r, j) *= keep_scale;
+                } else {
+                  dropped_probs(r, j) = T(0);
+                  grad_probs(r, j) = T(0);
+                }
+              }
+            }
+            dv.noalias() += dropped_probs.transpose() * dout;
+          } else {
+            dv.noalias() += probs.transpose() * dout;
+          }
+
+          // Softmax backprop: dS = P * (dP - rowsum(dO * O)).
+          row_delta = (dout.array() * out.array()).rowwise().sum().matrix();
+          grad_probs.colwise() -= row_delta;
+          probs.array() *= grad_probs.array();
+
+          MatrixMap<T> dq(query_backprop + row_offset * p.depth, rows,
+                          p.depth);
+          dq.noalias() = scale * (probs * k);
+          dk.noalias() += scale * (probs.transpose() * q);
+        }
+      }
+    };
+    const double bh_flops = static_cast<double>(p.query_len) * p.key_len *
+                            (p.depth + p.value_depth) * 5;
+    d.parallelFor(
+        p.batch * p.heads,
+        Eigen::TensorOpCost(
+            sizeof(T) * (p.query_len + p.key_len) * (p.depth + p.value_depth),
+            sizeof(T) * (p.query_len + p.key_len) * (p.depth + p.value_depth),
+            bh_flops),
+        work);
+    return Status::OK();
+  }
+};
+
+}  // namespace functor
+
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Shapes and attributes of one FusedAttention computation. 'query' is
+// [batch, heads, query_len, depth], 'key' is [batch, heads, key_len, depth],
+// 'value' is [batch, heads, key_len, value_depth] and the optional 'bias' is
+// [batch or 1, heads or 1, query_len or 1, key_len]. A bias batch, head or
+// query stride of zero broadcasts the bias over that dimension.
+struct FusedAttentionParams {
+  int64 batch = 0;
+  int64 heads = 0;
+  int64 query_len = 0;
+  int64 key_len = 0;
+  int64 depth = 0;
+  int64 value_depth = 0;
+  int64 bias_batch_stride = 0;
+  int64 bias_head_stride = 0;
+  int64 bias_query_stride = 0;
+  float scale = 1.0f;
+  float dropout_rate = 0.0f;
+  uint64 dropout_seed = 0;
+};
+
+// Returns true if dropout keeps the attention probability at 'index' of the
+// flattened [batch, heads, query_len, key_len] attention matrix. The decision
+// only depends on the seed and the index, so the backward pass regenerates the
+// mask of the forward pass instead of storing it.
+EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE bool FusedAttentionKeep(uint64 seed,
+                                                             int64 index,
+                                                             float rate) {
+  random::PhiloxRandom gen(seed);
+  gen.Skip(index / 4);
+  const random::PhiloxRandom::ResultType sample = gen();
+  return random::Uint32ToFloat(sample[index % 4]) >= rate;
+}
+
+namespace functor {
+
+// Computes output = dropout(softmax(scale * query * key^T + bias)) * value
+// without materializing the attention matrix, and the log-sum-exp of every
+// softmax row, which is [batch, heads, query_len].
+template <typename Device, typename T>
+struct FusedAttentionForward {
+  Status operator()(const Device& d, const FusedAttentionParams& params,
+                    const T* query, const T* key, const T* value,
+                    const T* bias, T* output, T* logsumexp);
+};
+
+// Computes the gradients of FusedAttentionForward with respect to query, key
+// and value from the forward output, its log-sum-exp and 'output_backprop'.
+// 'delta' is [batch, heads, query_len] scratch memory.
+template <typename Device, typename T>
+struct FusedAttentionBackward {
+  Status operator()(const Device& d, const FusedAttentionParams& params,
+                    const T* query, const T* key, const T* value,
+                    const T* bias, const T* output, const T* logsumexp,
+                    const T* output_backprop, T* delta, T* query_backprop,
+                    T* key_backprop, T* value_backprop);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
@@ -0,0 +1,377 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/fused_attention_op.h"
+
+#include <limits>
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/gpu_prim.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// Threads per block, which is also the number of keys (or queries) scored per
+// tile. Each block keeps one tile of probabilities in shared memory and never
+// materializes more of the attention matrix.
+constexpr int kTileSize = 128;
+
+// Dynamic shared memory is limited to the 48KB every device supports.
+constexpr int64 kMaxSharedMemoryBytes = 48 * 1024;
+
+template <typename T>
+__device__ EIGEN_STRONG_INLINE T Dot(const T* a, const T* b, int64 n) {
+  T sum(0);
+  for (int64 i = 0; i < n; ++i) sum += a[i] * ldg(b + i);
+  return sum;
+}
+
+// Returns the scaled and biased logit of query row 'i' against key row 'j' of
+// (batch, head) pair 'bh'. 'q' is the query row, in shared memory.
+template <typename T>
+__device__ EIGEN_STRONG_INLINE T Score(const FusedAttentionParams& p,
+                                       const T* q, const T* key,
+                                       const T* bias, int64 bh, int64 i,
+                                       int64 j) {
+  T s = static_cast<T>(p.scale) * Dot(q, key + (bh * p.key_len + j) * p.depth,
+                                      p.depth);
+  if (bias != nullptr) {
+    const int64 b = bh / p.heads;
+    const int64 h = bh % p.heads;
+    s += ldg(bias + b * p.bias_batch_stride + h * p.bias_head_stride +
+             i * p.bias_query_stride + j);
+  }
+  return s;
+}
+
+// Returns the dropout factor of attention probability (i, j) of 'bh'.
+template <typename T>
+__device__ EIGEN_STRONG_INLINE T DropoutFactor(const FusedAttentionParams& p,
+                                               int64 bh, int64 i, int64 j) {
+  if (p.dropout_rate == 0.0f) return T(1);
+  const int64 index = (bh * p.query_len + i) * p.key_len + j;
+  return FusedAttentionKeep(p.dropout_seed, index, p.dropout_rate)
+             ? static_cast<T>(1.0 / (1.0 - p.dropout_rate))
+             : T(0);
+}
+
+// Reduces 'value' over the block and returns the result to all threads.
+template <typename T, typename ReduceOp>
+__device__ EIGEN_STRONG_INLINE T BlockAllReduce(T value, ReduceOp op,
+                                                T* broadcast) {
+  typedef gpuprim::BlockReduce<T, kTileSize> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  const T result = BlockReduce(temp_storage).Reduce(value, op);
+  if (threadIdx.x == 0) *broadcast = result;
+  __syncthreads();
+  const T broadcast_result = *broadcast;
+  __syncthreads();
+  return broadcast_result;
+}
+
+// One block per query row. The keys are scored one tile at a time and folded
+// into the output with an online softmax: the running maximum and sum of the
+// exponentials are updated per tile, and the partial output is rescaled
+// whenever the maximum grows.
+template <typename T>
+__global__ __launch_bounds__(kTileSize) void FusedAttentionForwardKernel(
+    FusedAttentionParams p, const T* __restrict__ query,
+    const T* __restrict__ key, const T* __restrict__ value,
+    const T* __restrict__ bias, T* __restrict__ output,
+    T* __restrict__ logsumexp) {
+  GPU_DYNAMIC_SHARED_MEM_DECL(sizeof(T), unsigned char, smem);
+  T* q = reinterpret_cast<T*>(smem);  // [depth]
+  T* acc = q + p.depth;               // [value_depth]
+  T* probs = acc + p.value_depth;     // [kTileSize]
+  __shared__ T broadcast;
+
+  const int64 row = blockIdx.x;  // bh * query_len + i
+  const int64 bh = row / p.query_len;
+  const int64 i = row % p.query_len;
+  const int tid = threadIdx.x;
+  for (int64 d = tid; d < p.depth; d += kTileSize) {
+    q[d] = ldg(query + row * p.depth + d);
+  }
+  for (int64 d = tid; d < p.value_depth; d += kTileSize) acc[d] = T(0);
+  __syncthreads();
+
+  const T kNegInf = -std::numeric_limits<T>::infinity();
+  T running_max = kNegInf;
+  T running_sum(0);
+  for (int64 tile = 0; tile < p.key_len; tile += kTileSize) {
+    const int64 j = tile + tid;
+    const T s = j < p.key_len ? Score(p, q, key, bias, bh, i, j) : kNegInf;
+    const T new_max =
+        max(running_max, BlockAllReduce(s, gpuprim::Max(), &broadcast));
+    // Rows whose logits are all -inf so far contribute nothing yet.
+    const T shift = new_max == kNegInf ? T(0) : new_max;
+    const T prob = j < p.key_len ? exp(s - shift) : T(0);
+    const T tile_sum = BlockAllReduce(prob, gpuprim::Sum(), &broadcast);
+    const T correction = exp(running_max - shift);
+    running_sum = running_sum * correction + tile_sum;
+    running_max = new_max;
+    probs[tid] = j < p.key_len ? prob * DropoutFactor<T>(p, bh, i, j) : T(0);
+    __syncthreads();
+
+    const int64 tile_len = min(int64{kTileSize}, p.key_len - tile);
+    for (int64 d = tid; d < p.value_depth; d += kTileSize) {
+      const T* v = value + (bh * p.key_len + tile) * p.value_depth + d;
+      T sum = acc[d] * correction;
+      for (int64 t = 0; t < tile_len; ++t) {
+        sum += probs[t] * ldg(v + t * p.value_depth);
+      }
+      acc[d] = sum;
+    }
+    __syncthreads();
+  }
+
+  for (int64 d = tid; d < p.value_depth; d += kTileSize) {
+    output[row * p.value_depth + d] = acc[d] / running_sum;
+  }
+  if (tid == 0) logsumexp[row] = running_max + log(running_sum);
+}
+
+// One block per query row: computes delta = rowsum(dO * O) and the query
+// gradient dQ = scale * dS * K, where dS = P * (dP - delta) is produced one
+// tile of keys at a time.
+template <typename T>
+__global__ __launch_bounds__(kTileSize) void FusedAttentionQueryGradKernel(
+    FusedAttentionParams p, const T* __restrict__ query,
+    const T* __restrict__ key, const T* __restrict__ value,
+    const T* __restrict__ bias, const T* __restrict__ output,
+    const T* __restrict__ logsumexp, const T* __restrict__ output_backprop,
+    T* __restrict__ delta, T* __restrict__ query_backprop) {
+  GPU_DYNAMIC_SHARED_MEM_DECL(sizeof(T), unsigned char, smem);
+  T* q = reinterpret_cast<T*>(smem);  // [depth]
+  T* dout = q + p.depth;              // [value_depth]
+  T* dq = dout + p.value_depth;       // [depth]
+  T* grad_scores = dq + p.depth;      // [kTileSize]
+  __shared__ T broadcast;
+
+  const int64 row = blockIdx.x;
+  const int64 bh = row / p.query_len;
+  const int64 i = row % p.query_len;
+  const int tid = threadIdx.x;
+  for (int64 d = tid; d < p.depth; d += kTileSize) {
+    q[d] = ldg(query + row * p.depth + d);
+    dq[d] = T(0);
+  }
+  T partial_delta(0);
+  for (int64 d = tid; d < p.value_depth; d += kTileSize) {
+    dout[d] = ldg(output_backprop + row * p.value_depth + d);
+    partial_delta += dout[d] * ldg(output + row * p.value_depth + d);
+  }
+  const T row_delta =
+      BlockAllReduce(partial_delta, gpuprim::Sum(), &broadcast);
+  if (tid == 0) delta[row] = row_delta;
+  const T lse = ldg(logsumexp + row);
+
+  for (int64 tile = 0; tile < p.key_len; tile += kTileSize) {
+    const int64 j = tile + tid;
+    T grad_score(0);
+    if (j < p.key_len) {
+      const T prob = exp(Score(p, q, key, bias, bh, i, j) - lse);
+      const T grad_prob =
+          Dot(dout, value + (bh * p.key_len + j) * p.value_depth,
+              p.value_depth) *
+          DropoutFactor<T>(p, bh, i, j);
+      grad_score = prob * (grad_prob - row_delta);
+    }
+    grad_scores[tid] = grad_score;
+    __syncthreads();
+
+    const int64 tile_len = min(int64{kTileSize}, p.key_len - tile);
+    for (int64 d = tid; d < p.depth; d += kTileSize) {
+      const T* k = key + (bh * p.key_len + tile) * p.depth + d;
+      T sum = dq[d];
+      for (int64 t = 0; t < tile_len; ++t) {
+        sum += grad_scores[t] * ldg(k + t * p.depth);
+      }
+      dq[d] = sum;
+    }
+    __syncthreads();
+  }
+
+  for (int64 d = tid; d < p.depth; d += kTileSize) {
+    query_backprop[row * p.depth + d] = static_cast<T>(p.scale) * dq[d];
+  }
+}
+
+// One block per key row: accumulates dV = P'^T * dO and dK = scale * dS^T * Q
+// one tile of queries at a time, where P' is the dropped out probability. Each
+// block owns its rows of dK and dV, so no atomics are needed.
+template <typename T>
+__global__ __launch_bounds__(kTileSize) void FusedAttentionKeyValueGradKernel(
+    FusedAttentionParams p, const T* __restrict__ query,
+    const T* __restrict__ key, const T* __restrict__ value,
+    const T* __restrict__ bias, const T* __restrict__ logsumexp,
+    const T* __restrict__ output_backprop, const T* __restrict__ delta,
+    T* __restrict__ key_backprop, T* __restrict__ value_backprop) {
+  GPU_DYNAMIC_SHARED_MEM_DECL(sizeof(T), unsigned char, smem);
+  T* k = reinterpret_cast<T*>(smem);   // [depth]
+  T* v = k + p.depth;                  // [value_depth]
+  T* dk = v + p.value_depth;           // [depth]
+  T* dv = dk + p.depth;                // [value_depth]
+  T* probs = dv + p.value_depth;       // [kTileSize]
+  T* grad_scores = probs + kTileSize;  // [kTileSize]
+
+  const int64 row = blockIdx.x;  // bh * key_len + j
+  const int64 bh = row / p.key_len;
+  const int64 j = row % p.key_len;
+  const int tid = threadIdx.x;
+  for (int64 d = tid; d < p.depth; d += kTileSize) {
+    k[d] = ldg(key + row * p.depth + d);
+    dk[d] = T(0);
+  }
+  for (int64 d = tid; d < p.value_depth; d += kTileSize) {
+    v[d] = ldg(value + row * p.value_depth + d);
+    dv[d] = T(0);
+  }
+  __syncthreads();
+
+  for (int64 tile = 0; tile < p.query_len; tile += kTileSize) {
+    const int64 i = tile + tid;
+    T dropped_prob(0);
+    T grad_score(0);
+    if (i < p.query_len) {
+      const int64 query_row = bh * p.query_len + i;
+      // Same as Score(), but with the key row in shared memory.
+      T s = static_cast<T>(p.scale) *
+            Dot(k, query + query_row * p.depth, p.depth);
+      if (bias != nullptr) {
+        const int64 b = bh / p.heads;
+        const int64 h = bh % p.heads;
+        s += ldg(bias + b * p.bias_batch_stride + h * p.bias_head_stride +
+                 i * p.bias_query_stride + j);
+      }
+      const T prob = exp(s - ldg(logsumexp + query_row));
+      const T factor = DropoutFactor<T>(p, bh, i, j);
+      const T grad_prob =
+          Dot(v, output_backprop + query_row * p.value_depth, p.value_depth) *
+          factor;
+      dropped_prob = prob * factor;
+      grad_score = prob * (grad_prob - ldg(delta + query_row));
+    }
+    probs[tid] = dropped_prob;
+    grad_scores[tid] = grad_score;
+    __syncthreads();
+
+    const int64 tile_len = min(int64{kTileSize}, p.query_len - tile);
+    const int64 tile_row = bh * p.query_len + tile;
+    for (int64 d = tid; d < p.value_depth; d += kTileSize) {
+      const T* dout = output_backprop + tile_row * p.value_depth + d;
+      T sum = dv[d];
+      for (int64 t = 0; t < tile_len; ++t) {
+        sum += probs[t] * ldg(dout + t * p.value_depth);
+      }
+      dv[d] = sum;
+    }
+    for (int64 d = tid; d < p.depth; d += kTileSize) {
+      const T* q = query + tile_row * p.depth + d;
+      T sum = dk[d];
+      for (int64 t = 0; t < tile_len; ++t) {
+        sum += grad_scores[t] * ldg(q + t * p.depth);
+      }
+      dk[d] = sum;
+    }
+    __syncthreads();
+  }
+
+  for (int64 d = tid; d < p.depth; d += kTileSize) {
+    key_backprop[row * p.depth + d] = static_cast<T>(p.scale) * dk[d];
+  }
+  for (int64 d = tid; d < p.value_depth; d += kTileSize) {
+    value_backprop[row * p.value_depth + d] = dv[d];
+  }
+}
+
+Status CheckSharedMemory(int64 num_elements, int64 element_size) {
+  if (num_elements * element_size > kMaxSharedMemoryBytes) {
+    return errors::InvalidArgument(
+        "depth and value_depth are too large for FusedAttention on GPU");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T>
+struct FusedAttentionForward<GPUDevice, T> {
+  Status operator()(const GPUDevice& d, const FusedAttentionParams& p,
+                    const T* query, const T* key, const T* value,
+                    const T* bias, T* output, T* logsumexp) {
+    const int64 shared_elements = p.depth + p.value_depth + kTileSize;
+    TF_RETURN_IF_ERROR(CheckSharedMemory(shared_elements, sizeof(T)));
+    return GpuLaunchKernel(FusedAttentionForwardKernel<T>,
+                           p.batch * p.heads * p.query_len, kTileSize,
+                           shared_elements * sizeof(T), d.stream(), p, query,
+                           key, value, bias, output, logsumexp);
+  }
+};
+
+template <typename T>
+struct FusedAttentionBackward<GPUDevice, T> {
+  Status operator()(const GPUDevice& d, const FusedAttentionParams& p,
+                    const T* query, const T* key, const T* value,
+                    const T* bias, const T* output, const T* logsumexp,
+                    const T* output_backprop, T* delta, T* query_backprop,
+                    T* key_backprop, T* value_backprop) {
+    const int64 query_shared = 2 * p.depth + p.value_depth + kTileSize;
+    const int64 key_value_shared =
+        2 * p.depth + 2 * p.value_depth + 2 * kTileSize;
+    TF_RETURN_IF_ERROR(CheckSharedMemory(key_value_shared, sizeof(T)));
+    const int64 num_queries = p.batch * p.heads * p.query_len;
+    const int64 num_keys = p.batch * p.heads * p.key_len;
+    if (num_queries > 0) {
+      TF_RETURN_IF_ERROR(GpuLaunchKernel(
+          FusedAttentionQueryGradKernel<T>, num_queries, kTileSize,
+          query_shared * sizeof(T), d.stream(), p, query, key, value, bias,
+          output, logsumexp, output_backprop, delta, query_backprop));
+    }
+    if (num_keys > 0) {
+      // Runs after the query kernel on the same stream, which wrote 'delta'.
+      TF_RETURN_IF_ERROR(GpuLaunchKernel(
+          FusedAttentionKeyValueGradKernel<T>, num_keys, kTileSize,
+          key_value_shared * sizeof(T), d.stream(), p, query, key, value,
+          bias, logsumexp, output_backprop, delta, key_backprop,
+          value_backprop));
+    }
+    return Status::OK();
+  }
+};
+
+#define DEFINE_GPU_SPECS(T)                            \
+  template struct FusedAttentionForward<GPUDevice, T>; \
+  template struct FusedAttentionBackward<GPUDevice, T>;
+
+TF_CALL_float(DEFINE_GPU_SPECS);
+TF_CALL_double(DEFINE_GPU_SPECS);
+#undef DEFINE_GPU_SPECS
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
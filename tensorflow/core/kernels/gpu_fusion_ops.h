@@ -49,6 +49,15 @@ void FusionAddNReluGrad(OpKernelContext* ctx, const Eigen::half* in0,
                         const Eigen::half* in1, const Eigen::half* in2,
                         Eigen::half* out, unsigned N);
 
+// in-place epilogue of the fused matmul: adds the bias (of M elements) to each
+// row of the N elements of out, and applies the activation to the sum
+void FusionBiasActivation(OpKernelContext* ctx, const float* bias, float* out,
+                          unsigned N, unsigned M, ActivationMode mode);
+
+void FusionBiasActivation(OpKernelContext* ctx, const Eigen::half* bias,
+                          Eigen::half* out, unsigned N, unsigned M,
+                          ActivationMode mode);
+
 }  // namespace rocm_kernels
 
 }  // namespace tensorflow
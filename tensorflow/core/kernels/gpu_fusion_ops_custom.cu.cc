@@ -169,6 +169,55 @@ void FusionAddNReluGrad(OpKernelContext* ctx, const Eigen::half* in0,
 
 //-------------------------------------------------------------------
 
+template <typename T>
+__global__ void BiasActivationKernel(int nthreads, unsigned M, const T* bias,
+                                     T* out, ActivationMode mode) {
+  GPU_1D_KERNEL_LOOP(index, nthreads) {
+    float x =
+        static_cast<float>(out[index]) + static_cast<float>(bias[index % M]);
+    switch (mode) {
+      case ActivationMode::SIGMOID:
+        x = 1.0f / (1.0f + expf(-x));
+        break;
+      case ActivationMode::RELU:
+        x = fmaxf(0.0f, x);
+        break;
+      case ActivationMode::RELU6:
+        x = fminf(6.0f, fmaxf(0.0f, x));
+        break;
+      case ActivationMode::TANH:
+        x = tanhf(x);
+        break;
+      default:
+        break;
+    }
+    out[index] = static_cast<T>(x);
+  }
+}
+
+template <typename T>
+void LaunchBiasActivation(OpKernelContext* ctx, const T* bias, T* out,
+                          unsigned N, unsigned M, ActivationMode mode) {
+  GPUDevice d = ctx->eigen_device<GPUDevice>();
+  GpuLaunchConfig config = GetGpuLaunchConfig(N, d);
+  TF_CHECK_OK(GpuLaunchKernel(BiasActivationKernel<T>, config.block_count,
+                              config.thread_per_block, 0, d.stream(),
+                              config.virtual_thread_count, M, bias, out, mode));
+}
+
+void FusionBiasActivation(OpKernelContext* ctx, const float* bias, float* out,
+                          unsigned N, unsigned M, ActivationMode mode) {
+  LaunchBiasActivation(ctx, bias, out, N, M, mode);
+}
+
+void FusionBiasActivation(OpKernelContext* ctx, const Eigen::half* bias,
+                          Eigen::half* out, unsigned N, unsigned M,
+                          ActivationMode mode) {
+  LaunchBiasActivation(ctx, bias, out, N, M, mode);
+}
+
+//-------------------------------------------------------------------
+
 }  // namespace rocm_kernels
 
 }  // namespace tensorflow
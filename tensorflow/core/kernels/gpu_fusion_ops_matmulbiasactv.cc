@@ -0,0 +1,189 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifdef TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+
+#include "tensorflow/core/kernels/conv_ops_gpu.h"
+#include "tensorflow/core/kernels/gpu_fusion_ops.h"
+
+#include "tensorflow/core/util/activation_mode.h"
+
+#include "tensorflow/core/platform/stream_executor.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+//-------------------------------------------------------------------
+
+// The MatMul is computed by rocBLAS, which accumulates it onto the side input
+// (if present), and the bias and the activation are applied by an epilogue
+// kernel in a single pass over the product, in place.
+template <typename Device, typename T, bool HasSideInput>
+class ROCmFusionKernelMatMulBiasActivation : public OpKernel {
+ public:
+  explicit ROCmFusionKernelMatMulBiasActivation(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("transpose_b", &transpose_b_));
+
+    string activation_mode_str;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("activation_mode", &activation_mode_str));
+    OP_REQUIRES_OK(ctx, GetActivationModeFromString(activation_mode_str,
+                                                    &activation_mode_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& a = ctx->input(0);
+    const Tensor& b = ctx->input(1);
+    const Tensor& bias = ctx->input(2);
+
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix: ",
+                                        a.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix: ",
+                                        b.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(bias.shape()),
+                errors::InvalidArgument("Bias is not a vector: ",
+                                        bias.shape().DebugString()));
+
+    const int64 m = a.dim_size(transpose_a_ ? 1 : 0);
+    const int64 k = a.dim_size(transpose_a_ ? 0 : 1);
+    const int64 n = b.dim_size(transpose_b_ ? 0 : 1);
+    OP_REQUIRES(ctx, k == b.dim_size(transpose_b_ ? 1 : 0),
+                errors::InvalidArgument("Matrix size-incompatible: In[0]: ",
+                                        a.shape().DebugString(), ", In[1]: ",
+                                        b.shape().DebugString()));
+    OP_REQUIRES(ctx, bias.dim_size(0) == n,
+                errors::InvalidArgument("Bias size (", bias.dim_size(0),
+                                        ") does not match the product's ", n,
+                                        " columns"));
+
+    const TensorShape output_shape({m, n});
+    Tensor* output = nullptr;
+    float beta = 0.0f;
+    if (HasSideInput) {
+      const Tensor& side_input = ctx->input(3);
+      OP_REQUIRES(
+          ctx, side_input.shape() == output_shape,
+          errors::InvalidArgument(
+              "Side input shape ", side_input.shape().DebugString(),
+              " does not match the product shape ",
+              output_shape.DebugString(),
+              ", set TF_ROCM_FUSION_DISABLE_MATMUL=1 to disable this fusion"));
+      // the product is accumulated onto the side input, in its buffer if no
+      // other op needs it
+      OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                              {3}, 0, output_shape, &output));
+      beta = 1.0f;
+    } else {
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output));
+    }
+    if (output->NumElements() == 0) return;
+
+    auto* stream = ctx->op_device_context()->stream();
+    OP_REQUIRES(ctx, stream, errors::Internal("No GPU stream available."));
+
+    auto output_data = AsDeviceMemory(output->template flat<T>().data(),
+                                      output->template flat<T>().size());
+    const uint64 output_bytes = output->TotalBytes();
+    if (HasSideInput) {
+      const Tensor& side_input = ctx->input(3);
+      if (output->data() != side_input.data()) {
+        auto side_input_data =
+            AsDeviceMemory(side_input.template flat<T>().data(),
+                           side_input.template flat<T>().size());
+        OP_REQUIRES(ctx,
+                    stream
+                        ->ThenMemcpyD2D(&output_data, side_input_data,
+                                        output_bytes)
+                        .ok(),
+                    errors::Internal("Side input copy failed"));
+      }
+    }
+
+    if (k == 0) {
+      // the product is all zeros
+      if (!HasSideInput) {
+        OP_REQUIRES(ctx, stream->ThenMemZero(&output_data, output_bytes).ok(),
+                    errors::Internal("Product initialization failed"));
+      }
+    } else {
+      auto a_data = AsDeviceMemory(a.template flat<T>().data(),
+                                   a.template flat<T>().size());
+      auto b_data = AsDeviceMemory(b.template flat<T>().data(),
+                                   b.template flat<T>().size());
+      const se::blas::Transpose blas_transpose_a =
+          transpose_a_ ? se::blas::Transpose::kTranspose
+                       : se::blas::Transpose::kNoTranspose;
+      const se::blas::Transpose blas_transpose_b =
+          transpose_b_ ? se::blas::Transpose::kTranspose
+                       : se::blas::Transpose::kNoTranspose;
+      // rocBLAS is column-major, so the (row-major) product a * b is computed
+      // as its transpose, b' * a'
+      bool blas_launch_status =
+          stream
+              ->ThenBlasGemm(blas_transpose_b, blas_transpose_a, n, m, k, 1.0f,
+                             b_data, transpose_b_ ? k : n, a_data,
+                             transpose_a_ ? m : k, beta, &output_data, n)
+              .ok();
+      OP_REQUIRES(ctx, blas_launch_status,
+                  errors::Internal("rocBLAS xGEMM launch failed : a.shape=",
+                                   a.shape().DebugString(),
+                                   ", b.shape=", b.shape().DebugString(),
+                                   ", m=", m, ", n=", n, ", k=", k));
+    }
+
+    rocm_kernels::FusionBiasActivation(
+        ctx, bias.template flat<T>().data(), output->template flat<T>().data(),
+        output->NumElements(), n, activation_mode_);
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+  ActivationMode activation_mode_;
+};
+
+#define REGISTER_GPU_KERNELS(T)                                              \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("_ROCmFusedMatMulBiasActivation")                                 \
+          .Device(DEVICE_GPU)                                                \
+          .TypeConstraint<T>("T"),                                           \
+      ROCmFusionKernelMatMulBiasActivation<GPUDevice, T, false>);            \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("_ROCmFusedMatMulBiasAddActivation")                              \
+          .Device(DEVICE_GPU)                                                \
+          .TypeConstraint<T>("T"),                                           \
+      ROCmFusionKernelMatMulBiasActivation<GPUDevice, T, true>);
+
+REGISTER_GPU_KERNELS(float);
+REGISTER_GPU_KERNELS(Eigen::half);
+
+#undef REGISTER_GPU_KERNELS
+
+//-------------------------------------------------------------------
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_ROCM
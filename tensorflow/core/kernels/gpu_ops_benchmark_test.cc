@@ -0,0 +1,286 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the ops that dominate the step time of common models, on GPU,
+// over realistic shapes and the floating point types used in training.
+//
+// Items are FLOPs for MatMul and Conv2D and elements for the other ops, so the
+// `items_per_second` metric of the benchmark reports is the achieved FLOP rate
+// of the compute bound ops. The `bytes_per_second` metric is the achieved
+// memory bandwidth, counting every byte that the op must read or write once.
+//
+// To get one JSON report per benchmark, for regression tracking:
+//
+//   TEST_REPORT_FILE_PREFIX=/tmp/gpu_ops_ TEST_REPORT_FILE_FORMAT=json \
+//     bazel run -c opt --config=rocm \
+//     //tensorflow/core/kernels:gpu_ops_benchmark_test_gpu -- --benchmarks=all
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+using half = Eigen::half;
+
+template <typename T>
+Tensor RandomTensor(const TensorShape& shape) {
+  Tensor tensor(DataTypeToEnum<T>::value, shape);
+  tensor.flat<T>().setRandom();
+  return tensor;
+}
+
+// Returns `num_indices` random row indices in [0, num_rows), of shape
+// `[num_indices]`, or `[num_indices, 1]` if `index_depth` is set.
+Tensor RandomIndices(int64 num_rows, int64 num_indices, bool index_depth) {
+  Tensor indices(DT_INT32, index_depth ? TensorShape({num_indices, 1})
+                                       : TensorShape({num_indices}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  auto flat = indices.flat<int32>();
+  for (int64 i = 0; i < num_indices; ++i) {
+    flat(i) = rnd.Uniform(num_rows);
+  }
+  return indices;
+}
+
+void RunOnGpu(::testing::benchmark::State& state, Graph* graph, double items,
+              double bytes, const string& label) {
+  test::Benchmark("gpu", graph, /*old_benchmark_api=*/false).Run(state);
+  const int64 iterations = static_cast<int64>(state.iterations());
+  state.SetItemsProcessed(static_cast<int64>(items * iterations));
+  state.SetBytesProcessed(static_cast<int64>(bytes * iterations));
+  state.SetLabel(label);
+}
+
+// Every op has the same number of shapes, so that all of them can be
+// registered by the same macro.
+constexpr int kNumShapes = 4;
+
+struct MatMulShape {
+  int64 m, k, n;
+};
+constexpr MatMulShape kMatMulShapes[kNumShapes] = {
+    {1024, 1024, 1024},
+    {4096, 4096, 4096},
+    {8192, 1024, 4096},
+    {32, 4096, 4096},  // Small batch inference.
+};
+
+template <typename T>
+void MatMul(::testing::benchmark::State& state) {
+  const MatMulShape& s = kMatMulShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(g, test::graph::Constant(g, RandomTensor<T>({s.m, s.k})),
+                      test::graph::Constant(g, RandomTensor<T>({s.k, s.n})),
+                      /*transpose_a=*/false, /*transpose_b=*/false);
+  RunOnGpu(state, g, 2.0 * s.m * s.k * s.n,
+           (s.m * s.k + s.k * s.n + s.m * s.n) * sizeof(T),
+           absl::StrCat("m=", s.m, " k=", s.k, " n=", s.n));
+}
+
+// NHWC convolutions with "SAME" padding and unit strides, from ResNet-50.
+struct Conv2DShape {
+  int64 batch, height, width, in_depth, filter_size, out_depth;
+};
+constexpr Conv2DShape kConv2DShapes[kNumShapes] = {
+    {32, 56, 56, 64, 3, 64},
+    {32, 28, 28, 128, 3, 128},
+    {32, 14, 14, 256, 3, 256},
+    {32, 56, 56, 64, 1, 256},
+};
+
+template <typename T>
+void Conv2D(::testing::benchmark::State& state) {
+  const Conv2DShape& s = kConv2DShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* input = test::graph::Constant(
+      g, RandomTensor<T>({s.batch, s.height, s.width, s.in_depth}));
+  Node* filter = test::graph::Constant(
+      g,
+      RandomTensor<T>({s.filter_size, s.filter_size, s.in_depth, s.out_depth}));
+  Node* conv;
+  TF_CHECK_OK(NodeBuilder(g->NewName("conv"), "Conv2D")
+                  .Input(input)
+                  .Input(filter)
+                  .Attr("strides", {1, 1, 1, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(g, &conv));
+  const int64 output_size = s.batch * s.height * s.width * s.out_depth;
+  RunOnGpu(
+      state, g,
+      2.0 * output_size * s.filter_size * s.filter_size * s.in_depth,
+      (s.batch * s.height * s.width * s.in_depth +
+       s.filter_size * s.filter_size * s.in_depth * s.out_depth + output_size) *
+          sizeof(T),
+      absl::StrCat("input=", s.batch, "x", s.height, "x", s.width, "x",
+                   s.in_depth, " filter=", s.filter_size, "x", s.filter_size,
+                   "x", s.out_depth));
+}
+
+struct ReductionShape {
+  int64 rows, cols;
+  int axis;
+};
+constexpr ReductionShape kReductionShapes[kNumShapes] = {
+    {8192, 8192, 1},
+    {8192, 8192, 0},
+    {65536, 256, 1},
+    {256, 65536, 0},
+};
+
+template <typename T>
+void Sum(::testing::benchmark::State& state) {
+  const ReductionShape& s = kReductionShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Reduce(
+      g, "Sum", test::graph::Constant(g, RandomTensor<T>({s.rows, s.cols})),
+      test::graph::Constant(g, test::AsScalar<int32>(s.axis)),
+      /*keep_dims=*/false);
+  RunOnGpu(state, g, s.rows * s.cols,
+           (s.rows * s.cols + (s.axis == 0 ? s.cols : s.rows)) * sizeof(T),
+           absl::StrCat(s.rows, "x", s.cols, " axis=", s.axis));
+}
+
+// Gathers or scatters `num_indices` rows of a `[rows, cols]` tensor.
+struct GatherShape {
+  int64 rows, cols, num_indices;
+};
+constexpr GatherShape kGatherShapes[kNumShapes] = {
+    {1 << 20, 64, 65536},  // Embedding lookup.
+    {65536, 128, 65536},
+    {32768, 1024, 8192},
+    {4096, 4096, 4096},
+};
+
+template <typename T>
+void Gather(::testing::benchmark::State& state) {
+  const GatherShape& s = kGatherShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Gather(
+      g, test::graph::Constant(g, RandomTensor<T>({s.rows, s.cols})),
+      test::graph::Constant(
+          g, RandomIndices(s.rows, s.num_indices, /*index_depth=*/false)),
+      test::graph::Constant(g, test::AsScalar<int32>(0)));
+  RunOnGpu(state, g, s.num_indices * s.cols,
+           2 * s.num_indices * s.cols * sizeof(T) +
+               s.num_indices * sizeof(int32),
+           absl::StrCat(s.rows, "x", s.cols, " indices=", s.num_indices));
+}
+
+template <typename T>
+void ScatterNd(::testing::benchmark::State& state) {
+  const GatherShape& s = kGatherShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* indices = test::graph::Constant(
+      g, RandomIndices(s.rows, s.num_indices, /*index_depth=*/true));
+  Node* updates =
+      test::graph::Constant(g, RandomTensor<T>({s.num_indices, s.cols}));
+  Node* shape = test::graph::Constant(
+      g, test::AsTensor<int32>({static_cast<int32>(s.rows),
+                                static_cast<int32>(s.cols)}));
+  Node* scatter;
+  TF_CHECK_OK(NodeBuilder(g->NewName("scatter"), "ScatterNd")
+                  .Input(indices)
+                  .Input(updates)
+                  .Input(shape)
+                  .Finalize(g, &scatter));
+  // The output is zeroed before the updates are added to it.
+  RunOnGpu(state, g, s.num_indices * s.cols,
+           (s.rows * s.cols + 2 * s.num_indices * s.cols) * sizeof(T) +
+               s.num_indices * sizeof(int32),
+           absl::StrCat(s.rows, "x", s.cols, " indices=", s.num_indices));
+}
+
+// Normalizes the rows of a `[rows, cols]` tensor.
+struct NormalizationShape {
+  int64 rows, cols;
+};
+constexpr NormalizationShape kNormalizationShapes[kNumShapes] = {
+    {512, 1000},   // ImageNet classes.
+    {8192, 512},   // Attention scores.
+    {128, 32768},  // Language model vocabulary.
+    {32768, 768},  // BERT-base hidden states.
+};
+
+template <typename T>
+void Softmax(::testing::benchmark::State& state) {
+  const NormalizationShape& s = kNormalizationShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* logits = test::graph::Constant(g, RandomTensor<T>({s.rows, s.cols}));
+  test::graph::Unary(g, "Softmax", logits);
+  RunOnGpu(state, g, s.rows * s.cols, 2 * s.rows * s.cols * sizeof(T),
+           absl::StrCat(s.rows, "x", s.cols));
+}
+
+// TensorFlow has no layer normalization kernel, so this benchmarks the graph
+// that Keras builds for it, without the scale and offset.
+template <typename T>
+void LayerNorm(::testing::benchmark::State& state) {
+  const NormalizationShape& s = kNormalizationShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* x = test::graph::Constant(g, RandomTensor<T>({s.rows, s.cols}));
+  Node* axis = test::graph::Constant(g, test::AsScalar<int32>(1));
+  Node* mean = test::graph::Reduce(g, "Mean", x, axis, /*keep_dims=*/true);
+  Node* centered = test::graph::Binary(g, "Sub", x, mean);
+  Node* variance = test::graph::Reduce(
+      g, "Mean", test::graph::Unary(g, "Square", centered), axis,
+      /*keep_dims=*/true);
+  Node* epsilon = test::graph::Constant(g, test::AsScalar<T>(T(1e-5f)));
+  Node* inv_stddev = test::graph::Unary(
+      g, "Rsqrt", test::graph::Binary(g, "Add", variance, epsilon));
+  test::graph::Binary(g, "Mul", centered, inv_stddev);
+  RunOnGpu(state, g, s.rows * s.cols, 2 * s.rows * s.cols * sizeof(T),
+           absl::StrCat(s.rows, "x", s.cols));
+}
+
+static_assert(kNumShapes == 4, "BM_GPU_OP must register every shape.");
+
+#define BM_GPU_OP(OP, T)                                          \
+  static void BM_##OP##_##T(::testing::benchmark::State& state) { \
+    OP<T>(state);                                                 \
+  }                                                               \
+  BENCHMARK(BM_##OP##_##T)->Arg(0)->Arg(1)->Arg(2)->Arg(3)
+
+#define BM_GPU_OPS(T)      \
+  BM_GPU_OP(MatMul, T);    \
+  BM_GPU_OP(Conv2D, T);    \
+  BM_GPU_OP(Sum, T);       \
+  BM_GPU_OP(Gather, T);    \
+  BM_GPU_OP(ScatterNd, T); \
+  BM_GPU_OP(Softmax, T);   \
+  BM_GPU_OP(LayerNorm, T)
+
+BM_GPU_OPS(float);
+BM_GPU_OPS(half);
+
+#undef BM_GPU_OPS
+#undef BM_GPU_OP
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -243,6 +243,16 @@ bool RequireCudnnDeterminism() {
   return require_cudnn_determinism;
 }
 
+float ConvWorkspaceSlowdown() {
+  static float slowdown = [] {
+    float slowdown = 0;
+    TF_CHECK_OK(tensorflow::ReadFloatFromEnvVar("TF_CONV_WORKSPACE_SLOWDOWN",
+                                                /*default_val=*/0, &slowdown));
+    return slowdown;
+  }();
+  return slowdown;
+}
+
 Status BestCudnnConvAlgorithm(absl::Span<const AutotuneResult> results,
                               se::dnn::AlgorithmConfig* algo) {
   std::vector<AutotuneResult> filtered_results;
@@ -268,6 +278,22 @@ Status BestCudnnConvAlgorithm(absl::Span<const AutotuneResult> results,
     selected_result = absl::c_min_element(filtered_results, compare_run_times);
     selected_result_no_scratch =
         absl::c_min_element(filtered_results_no_scratch, compare_run_times);
+
+    const float slowdown = ConvWorkspaceSlowdown();
+    if (slowdown > 0) {
+      // Pick the algorithm with the least scratch memory among those close
+      // enough to the fastest one.
+      const absl::Duration max_run_time =
+          proto_utils::FromDurationProto(selected_result->run_time()) *
+          (1.0 + slowdown);
+      for (auto it = filtered_results.begin(); it != filtered_results.end();
+           ++it) {
+        if (it->scratch_bytes() < selected_result->scratch_bytes() &&
+            proto_utils::FromDurationProto(it->run_time()) <= max_run_time) {
+          selected_result = it;
+        }
+      }
+    }
   }
 
   algo->set_algorithm({selected_result->conv().algorithm(),
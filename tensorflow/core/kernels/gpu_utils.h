@@ -238,6 +238,13 @@ void LogFusedConvForwardAutotuneResults(
     double side_value_scale, se::dnn::ActivationMode activation_mode,
     se::StreamExecutor* stream_exec, absl::Span<const AutotuneResult> results);
 
+// Returns how much slower than the fastest convolution algorithm, as a
+// fraction, the algorithm picked by autotuning may be if it needs less scratch
+// memory. Read from the env var TF_CONV_WORKSPACE_SLOWDOWN; the default of 0
+// picks the fastest algorithm. When it is positive, the scratch memory of
+// convolutions is also limited to the free memory of the device allocator.
+float ConvWorkspaceSlowdown();
+
 // Returns the best algorithms for the config, one is the fastest, the other is
 // other is fastest with 0 scratch space. Unsuccessful autotuning results are
 // allowed and ignored.
@@ -0,0 +1,238 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// The two input pixels an output pixel interpolates between along one axis,
+// and the weight of the upper one.
+struct Interpolation {
+  int64 lower;
+  int64 upper;
+  float lerp;
+};
+
+// Computes the bilinear interpolation of every output coordinate, with half
+// pixel centers, like ResizeBilinear with half_pixel_centers=true.
+void ComputeInterpolation(int64 out_size, int64 in_size,
+                          std::vector<Interpolation>* interpolation) {
+  interpolation->resize(out_size);
+  const float scale = static_cast<float>(in_size) / out_size;
+  for (int64 i = 0; i < out_size; ++i) {
+    const float in = std::max(0.0f, (i + 0.5f) * scale - 0.5f);
+    const int64 lower = std::min(static_cast<int64>(in), in_size - 1);
+    (*interpolation)[i] = {lower, std::min(lower + 1, in_size - 1),
+                           in - lower};
+  }
+}
+
+// Decodes the `box` window of the JPEG image `contents` and resizes it to
+// `out_height` x `out_width` pixels, written to `output`.
+Status DecodeCropAndResize(StringPiece contents, const float* box,
+                           jpeg::UncompressFlags flags, int64 out_height,
+                           int64 out_width, float* output) {
+  if (contents.size() > std::numeric_limits<int>::max()) {
+    return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                   contents.size());
+  }
+  int height, width, components;
+  if (!jpeg::GetImageInfo(contents.data(), contents.size(), &width, &height,
+                          &components)) {
+    return errors::InvalidArgument("Invalid JPEG data, size ",
+                                   contents.size());
+  }
+
+  const float y_min = box[0];
+  const float x_min = box[1];
+  const float y_max = box[2];
+  const float x_max = box[3];
+  if (!(0 <= y_min && y_min < y_max && y_max <= 1 && 0 <= x_min &&
+        x_min < x_max && x_max <= 1)) {
+    return errors::InvalidArgument("Invalid crop box [", y_min, ", ", x_min,
+                                   ", ", y_max, ", ", x_max, "]");
+  }
+  // The crop window in pixels of the full resolution image.
+  const int crop_y = std::min(static_cast<int>(y_min * height), height - 1);
+  const int crop_x = std::min(static_cast<int>(x_min * width), width - 1);
+  const int crop_height = std::max(
+      1, std::min(static_cast<int>(std::ceil(y_max * height)), height) -
+             crop_y);
+  const int crop_width = std::max(
+      1, std::min(static_cast<int>(std::ceil(x_max * width)), width) - crop_x);
+
+  // Let libjpeg downscale by a power of two during the inverse DCT, as long
+  // as the crop stays at least as large as the output.
+  int ratio = 1;
+  while (ratio < 8 && crop_height / (2 * ratio) >= out_height &&
+         crop_width / (2 * ratio) >= out_width) {
+    ratio *= 2;
+  }
+  // libjpeg rounds the size of the downscaled image up, and takes the crop
+  // window in downscaled pixels.
+  const int scaled_height = (height + ratio - 1) / ratio;
+  const int scaled_width = (width + ratio - 1) / ratio;
+  flags.ratio = ratio;
+  flags.crop = true;
+  flags.crop_y = crop_y / ratio;
+  flags.crop_x = crop_x / ratio;
+  flags.crop_height =
+      std::min((crop_height + ratio - 1) / ratio, scaled_height - flags.crop_y);
+  flags.crop_width =
+      std::min((crop_width + ratio - 1) / ratio, scaled_width - flags.crop_x);
+
+  int64 nwarn;
+  int decoded_height, decoded_width, decoded_components;
+  std::unique_ptr<uint8[]> decoded(
+      jpeg::Uncompress(contents.data(), contents.size(), flags, &decoded_width,
+                       &decoded_height, &decoded_components, &nwarn));
+  if (decoded == nullptr) {
+    return errors::InvalidArgument("Invalid JPEG data or crop window, size ",
+                                   contents.size());
+  }
+
+  std::vector<Interpolation> ys;
+  std::vector<Interpolation> xs;
+  ComputeInterpolation(out_height, decoded_height, &ys);
+  ComputeInterpolation(out_width, decoded_width, &xs);
+  const int64 channels = decoded_components;
+  const int64 row_size = decoded_width * channels;
+  for (int64 y = 0; y < out_height; ++y) {
+    const uint8* top = decoded.get() + ys[y].lower * row_size;
+    const uint8* bottom = decoded.get() + ys[y].upper * row_size;
+    const float y_lerp = ys[y].lerp;
+    for (int64 x = 0; x < out_width; ++x) {
+      const int64 left = xs[x].lower * channels;
+      const int64 right = xs[x].upper * channels;
+      const float x_lerp = xs[x].lerp;
+      for (int64 c = 0; c < channels; ++c) {
+        const float top_value =
+            top[left + c] + (top[right + c] - top[left + c]) * x_lerp;
+        const float bottom_value =
+            bottom[left + c] + (bottom[right + c] - bottom[left + c]) * x_lerp;
+        *output++ = top_value + (bottom_value - top_value) * y_lerp;
+      }
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+class BatchDecodeAndCropResizeJpegOp : public OpKernel {
+ public:
+  explicit BatchDecodeAndCropResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(
+        context, context->GetAttr("fancy_upscaling", &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    const Tensor& boxes = context->input(1);
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents.shape().DebugString()));
+    const int64 batch = contents.NumElements();
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsMatrix(boxes.shape()) &&
+                    boxes.dim_size(0) == batch && boxes.dim_size(1) == 4,
+                errors::InvalidArgument("boxes must be [", batch,
+                                        ", 4], got shape ",
+                                        boxes.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument("size must be a 1-D tensor of 2 "
+                                        "elements, got shape ",
+                                        size.shape().DebugString()));
+    const int64 out_height = size.vec<int32>()(0);
+    const int64 out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        out_height, ", ", out_width, "]"));
+
+    Tensor* images = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0,
+                                TensorShape({batch, out_height, out_width,
+                                             static_cast<int64>(channels_)}),
+                                &images));
+
+    const auto contents_vec = contents.vec<tstring>();
+    const auto boxes_mat = boxes.matrix<float>();
+    float* images_data = images->flat<float>().data();
+    const int64 image_size = out_height * out_width * channels_;
+    std::vector<Status> statuses(batch);
+    auto work = [&](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        statuses[i] = DecodeCropAndResize(contents_vec(i), &boxes_mat(i, 0),
+                                          flags_, out_height, out_width,
+                                          images_data + i * image_size);
+      }
+    };
+    // Decoding an image takes far longer than scheduling a shard, so every
+    // image may be decoded by a different thread.
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, batch,
+          kCostPerImage, work);
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(context, status);
+    }
+  }
+
+ private:
+  static constexpr int64 kCostPerImage = 1000000;
+
+  int32 channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("BatchDecodeAndCropResizeJpeg").Device(DEVICE_CPU),
+    BatchDecodeAndCropResizeJpegOp);
+
+}  // namespace tensorflow
@@ -19,8 +19,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/image/crop_and_resize_op.h"
 
+#include <algorithm>
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -109,6 +112,31 @@ inline void RunIfBoxIndexIsValid<CPUDevice>(
   }
 }
 
+// The input rows or columns that a crop coordinate samples from, and the
+// weight of the upper one.
+struct CropInterpolation {
+  bool valid;
+  int lower;
+  int upper;
+  float lerp;
+};
+
+// Computes where the input coordinate `in` of an axis of `size` pixels is
+// sampled from, following the CropAndResize kernel. Coordinates outside the
+// image are not valid, and take the extrapolation value.
+inline CropInterpolation ComputeCropInterpolation(float in, int size,
+                                                  bool bilinear) {
+  if (in < 0 || in > size - 1) {
+    return {false, 0, 0, 0};
+  }
+  if (bilinear) {
+    const int lower = floorf(in);
+    return {true, lower, static_cast<int>(ceilf(in)), in - lower};
+  }
+  const int closest = roundf(in);
+  return {true, closest, closest, 0};
+}
+
 }  // namespace
 
 template <typename Device, typename T>
@@ -348,6 +376,292 @@ struct CropAndResize<CPUDevice, T> {
 
 }  // namespace functor
 
+template <typename Device, typename T, typename U>
+class CropAndResizeNormalizeOp : public AsyncOpKernel {
+ public:
+  explicit CropAndResizeNormalizeOp(OpKernelConstruction* context)
+      : AsyncOpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("method", &method_));
+    OP_REQUIRES(context, method_ == "bilinear" || method_ == "nearest",
+                errors::InvalidArgument(
+                    "method must be 'bilinear' or 'nearest'", method_));
+    OP_REQUIRES_OK(context, context->GetAttr("extrapolation_value",
+                                             &extrapolation_value_));
+    string data_format;
+    OP_REQUIRES_OK(context, context->GetAttr("data_format", &data_format));
+    OP_REQUIRES(context,
+                FormatFromString(data_format, &data_format_) &&
+                    (data_format_ == FORMAT_NHWC ||
+                     data_format_ == FORMAT_NCHW),
+                errors::InvalidArgument(
+                    "data_format must be 'NHWC' or 'NCHW'", data_format));
+  }
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    // The shape of 'image' is [batch_size, image_height, image_width,
+    // channels].
+    const Tensor& image = context->input(0);
+    // The shape of 'boxes' is [num_boxes, 4].
+    const Tensor& boxes = context->input(1);
+    // The shape of 'box_index' is [num_boxes].
+    const Tensor& box_index = context->input(2);
+    // The shape of 'crop_size' is [2].
+    const Tensor& crop_size = context->input(3);
+    // The shapes of 'mean' and 'scale' are [channels].
+    const Tensor& mean = context->input(4);
+    const Tensor& scale = context->input(5);
+
+    // Validate inputs dimensions.
+    OP_REQUIRES_ASYNC(context, image.dims() == 4,
+                      errors::InvalidArgument("input image must be 4-D",
+                                              image.shape().DebugString()),
+                      done);
+    const int batch_size = image.dim_size(0);
+    const int image_height = image.dim_size(1);
+    const int image_width = image.dim_size(2);
+    const int depth = image.dim_size(3);
+    OP_REQUIRES_ASYNC(
+        context, image_height > 0 && image_width > 0,
+        errors::InvalidArgument("image dimensions must be positive"), done);
+    int num_boxes = 0;
+    OP_REQUIRES_OK_ASYNC(
+        context, ParseAndCheckBoxSizes(boxes, box_index, &num_boxes), done);
+
+    OP_REQUIRES_ASYNC(context, crop_size.dims() == 1,
+                      errors::InvalidArgument("crop_size must be 1-D",
+                                              crop_size.shape().DebugString()),
+                      done);
+    OP_REQUIRES_ASYNC(
+        context, crop_size.dim_size(0) == 2,
+        errors::InvalidArgument("crop_size must have two elements",
+                                crop_size.shape().DebugString()),
+        done);
+    OP_REQUIRES_ASYNC(
+        context, mean.dims() == 1 && mean.dim_size(0) == depth,
+        errors::InvalidArgument("mean must be 1-D with ", depth,
+                                " elements: ", mean.shape().DebugString()),
+        done);
+    OP_REQUIRES_ASYNC(
+        context, scale.dims() == 1 && scale.dim_size(0) == depth,
+        errors::InvalidArgument("scale must be 1-D with ", depth,
+                                " elements: ", scale.shape().DebugString()),
+        done);
+
+    // Copy and validate crop sizes.
+    auto crop_size_vec = crop_size.vec<int32>();
+    const int crop_height = internal::SubtleMustCopy(crop_size_vec(0));
+    const int crop_width = internal::SubtleMustCopy(crop_size_vec(1));
+    OP_REQUIRES_ASYNC(
+        context, crop_height > 0 && crop_width > 0,
+        errors::InvalidArgument("crop dimensions must be positive"), done);
+
+    // Allocate output tensor.
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        context->allocate_output(0,
+                                 ShapeFromFormat(data_format_, num_boxes,
+                                                 crop_height, crop_width,
+                                                 depth),
+                                 &output),
+        done);
+
+    auto compute_callback = [this, context, output]() {
+      const Tensor& image = context->input(0);
+      const Tensor& boxes = context->input(1);
+      const Tensor& box_index = context->input(2);
+      const Tensor& mean = context->input(4);
+      const Tensor& scale = context->input(5);
+      const bool status = functor::CropAndResizeNormalize<Device, T, U>()(
+          context, image.tensor<T, 4>(), boxes.tensor<float, 2>(),
+          box_index.tensor<int32, 1>(), method_, extrapolation_value_,
+          mean.vec<float>(), scale.vec<float>(), data_format_,
+          output->tensor<U, 4>());
+
+      if (!status) {
+        context->SetStatus(
+            errors::Internal("Failed launch CropAndResizeNormalizeKernel."));
+      }
+    };
+
+    RunIfBoxIndexIsValid<Device>(context, box_index.tensor<int32, 1>(),
+                                 batch_size, std::move(compute_callback),
+                                 std::move(done));
+  }
+
+ private:
+  float extrapolation_value_;
+  string method_;
+  TensorFormat data_format_;
+};
+
+// Partial specialization of CropAndResizeNormalize functor for a CPUDevice.
+namespace functor {
+template <typename T, typename U>
+struct CropAndResizeNormalize<CPUDevice, T, U> {
+  bool operator()(OpKernelContext* context,
+                  typename TTypes<T, 4>::ConstTensor image,
+                  typename TTypes<float, 2>::ConstTensor boxes,
+                  typename TTypes<int32, 1>::ConstTensor box_index,
+                  const string& method_name, float extrapolation_value,
+                  typename TTypes<float, 1>::ConstTensor mean,
+                  typename TTypes<float, 1>::ConstTensor scale,
+                  TensorFormat data_format,
+                  typename TTypes<U, 4>::Tensor crops) {
+    const int batch_size = image.dimension(0);
+    const int image_height = image.dimension(1);
+    const int image_width = image.dimension(2);
+    const int depth = image.dimension(3);
+
+    const bool nchw = data_format == FORMAT_NCHW;
+    const int num_boxes = crops.dimension(0);
+    const int crop_height = crops.dimension(nchw ? 2 : 1);
+    const int crop_width = crops.dimension(nchw ? 3 : 2);
+    const int row_size = crop_width * depth;
+
+    const Eigen::Tensor<bool, 0, Eigen::RowMajor> only_finite_elements =
+        boxes.isfinite().all();
+    if (!only_finite_elements()) {
+      context->SetStatus(errors::InvalidArgument(
+          "Boxes contains at least one element that is not finite"));
+      return false;
+    }
+
+    // mean and scale repeated for every pixel of an NHWC row, so that a whole
+    // row is normalized by a single vectorizable loop.
+    std::vector<float> row_mean(row_size);
+    std::vector<float> row_scale(row_size);
+    for (int i = 0; i < row_size; ++i) {
+      row_mean[i] = mean(i % depth);
+      row_scale[i] = scale(i % depth);
+    }
+
+    const bool bilinear = method_name == "bilinear";
+    // Sharding across boxes.
+    auto CropAndResizeNormalizePerBox = [&](int64 start_box,
+                                            int64 limit_box) {
+      // The interpolated values of one output row, in NHWC order.
+      std::vector<float> row(row_size);
+      std::vector<CropInterpolation> xs(crop_width);
+      for (int b = start_box; b < limit_box; ++b) {
+        const float y1 = boxes(b, 0);
+        const float x1 = boxes(b, 1);
+        const float y2 = boxes(b, 2);
+        const float x2 = boxes(b, 3);
+
+        const int32 b_in = box_index(b);
+        if (!FastBoundsCheck(b_in, batch_size)) {
+          continue;
+        }
+        const T* image_data = image.data() + static_cast<int64>(b_in) *
+                                                 image_height * image_width *
+                                                 depth;
+
+        const float height_scale =
+            (crop_height > 1)
+                ? (y2 - y1) * (image_height - 1) / (crop_height - 1)
+                : 0;
+        const float width_scale =
+            (crop_width > 1) ? (x2 - x1) * (image_width - 1) / (crop_width - 1)
+                             : 0;
+
+        // The input columns are the same for every row of the crop.
+        for (int x = 0; x < crop_width; ++x) {
+          const float in_x = (crop_width > 1)
+                                 ? x1 * (image_width - 1) + x * width_scale
+                                 : 0.5 * (x1 + x2) * (image_width - 1);
+          xs[x] = ComputeCropInterpolation(in_x, image_width, bilinear);
+        }
+
+        for (int y = 0; y < crop_height; ++y) {
+          const float in_y = (crop_height > 1)
+                                 ? y1 * (image_height - 1) + y * height_scale
+                                 : 0.5 * (y1 + y2) * (image_height - 1);
+          const CropInterpolation ys =
+              ComputeCropInterpolation(in_y, image_height, bilinear);
+          if (!ys.valid) {
+            std::fill(row.begin(), row.end(), extrapolation_value);
+          } else {
+            const T* top =
+                image_data + static_cast<int64>(ys.lower) * image_width * depth;
+            const T* bottom =
+                image_data + static_cast<int64>(ys.upper) * image_width * depth;
+            for (int x = 0; x < crop_width; ++x) {
+              float* out = row.data() + x * depth;
+              if (!xs[x].valid) {
+                std::fill(out, out + depth, extrapolation_value);
+                continue;
+              }
+              const int left = xs[x].lower * depth;
+              const int right = xs[x].upper * depth;
+              if (bilinear) {
+                const float x_lerp = xs[x].lerp;
+                for (int d = 0; d < depth; ++d) {
+                  const float top_left(static_cast<float>(top[left + d]));
+                  const float top_right(static_cast<float>(top[right + d]));
+                  const float bottom_left(
+                      static_cast<float>(bottom[left + d]));
+                  const float bottom_right(
+                      static_cast<float>(bottom[right + d]));
+                  const float top_value =
+                      top_left + (top_right - top_left) * x_lerp;
+                  const float bottom_value =
+                      bottom_left + (bottom_right - bottom_left) * x_lerp;
+                  out[d] = top_value + (bottom_value - top_value) * ys.lerp;
+                }
+              } else {
+                for (int d = 0; d < depth; ++d) {
+                  out[d] = static_cast<float>(top[left + d]);
+                }
+              }
+            }
+          }
+
+          // Normalize the row and write it in the output layout.
+          if (nchw) {
+            for (int d = 0; d < depth; ++d) {
+              U* dst = &crops(b, d, y, 0);
+              const float m = mean(d);
+              const float s = scale(d);
+              for (int x = 0; x < crop_width; ++x) {
+                dst[x] = static_cast<U>((row[x * depth + d] - m) * s);
+              }
+            }
+          } else {
+            U* dst = &crops(b, y, 0, 0);
+            for (int i = 0; i < row_size; ++i) {
+              dst[i] = static_cast<U>((row[i] - row_mean[i]) * row_scale[i]);
+            }
+          }
+        }
+      }
+    };
+
+    // A rough estimation of the cost for each cropped box.
+    double cost_per_pixel =
+        depth * (Eigen::TensorOpCost::AddCost<float>() * 7 +
+                 Eigen::TensorOpCost::MulCost<float>() * 4 +
+                 Eigen::TensorOpCost::CastCost<T, float>() * 4 +
+                 Eigen::TensorOpCost::CastCost<float, U>());
+    if (!bilinear) {
+      cost_per_pixel = depth * (Eigen::TensorOpCost::AddCost<float>() +
+                                Eigen::TensorOpCost::MulCost<float>() +
+                                Eigen::TensorOpCost::CastCost<T, float>() +
+                                Eigen::TensorOpCost::CastCost<float, U>());
+    }
+    const double cost_per_box = crop_height * crop_width * cost_per_pixel;
+
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_boxes,
+          cost_per_box, CropAndResizeNormalizePerBox);
+
+    return true;
+  }
+};
+
+}  // namespace functor
+
 template <typename Device, typename T>
 class CropAndResizeGradImageOp : public AsyncOpKernel {
  public:
@@ -767,6 +1081,22 @@ TF_CALL_REAL_NUMBER_TYPES(REGISTER_KERNEL);
 
 #undef REGISTER_KERNEL
 
+#define REGISTER_KERNEL(T, U)                                   \
+  REGISTER_KERNEL_BUILDER(Name("CropAndResizeNormalize")        \
+                              .Device(DEVICE_CPU)               \
+                              .TypeConstraint<T>("T")           \
+                              .TypeConstraint<U>("out_type")    \
+                              .HostMemory("crop_size"),         \
+                          CropAndResizeNormalizeOp<CPUDevice, T, U>);
+#define REGISTER_KERNEL_ALL_OUT_TYPES(T) \
+  REGISTER_KERNEL(T, Eigen::half)        \
+  REGISTER_KERNEL(T, float)
+
+TF_CALL_REAL_NUMBER_TYPES(REGISTER_KERNEL_ALL_OUT_TYPES);
+
+#undef REGISTER_KERNEL_ALL_OUT_TYPES
+#undef REGISTER_KERNEL
+
 #define REGISTER_KERNEL(T)                               \
   REGISTER_KERNEL_BUILDER(Name("CropAndResizeGradImage") \
                               .Device(DEVICE_CPU)        \
@@ -890,6 +1220,23 @@ TF_CALL_GPU_NUMBER_TYPES(REGISTER_KERNEL);
 
 #undef REGISTER_KERNEL
 
+#define REGISTER_KERNEL(T, U)                                   \
+  REGISTER_KERNEL_BUILDER(Name("CropAndResizeNormalize")        \
+                              .Device(DEVICE_GPU)               \
+                              .TypeConstraint<T>("T")           \
+                              .TypeConstraint<U>("out_type")    \
+                              .HostMemory("crop_size"),         \
+                          CropAndResizeNormalizeOp<GPUDevice, T, U>);
+#define REGISTER_KERNEL_ALL_OUT_TYPES(T) \
+  REGISTER_KERNEL(T, Eigen::half)        \
+  REGISTER_KERNEL(T, float)
+
+TF_CALL_uint8(REGISTER_KERNEL_ALL_OUT_TYPES);
+TF_CALL_GPU_NUMBER_TYPES(REGISTER_KERNEL_ALL_OUT_TYPES);
+
+#undef REGISTER_KERNEL_ALL_OUT_TYPES
+#undef REGISTER_KERNEL
+
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 }  // namespace tensorflow
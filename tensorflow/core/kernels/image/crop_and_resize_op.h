@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/util/tensor_format.h"
 
 namespace tensorflow {
 namespace functor {
@@ -35,6 +36,21 @@ struct CropAndResize {
                   typename TTypes<float, 4>::Tensor crops);
 };
 
+template <typename Device, typename T, typename U>
+struct CropAndResizeNormalize {
+  // Computes (CropAndResize(image) - mean) * scale, cast to U and written in
+  // `data_format`. We assume that the tensor sizes are correct.
+  bool operator()(OpKernelContext* context,
+                  typename TTypes<T, 4>::ConstTensor image,
+                  typename TTypes<float, 2>::ConstTensor boxes,
+                  typename TTypes<int32, 1>::ConstTensor box_ind,
+                  const std::string& method_name, float extrapolation_value,
+                  typename TTypes<float, 1>::ConstTensor mean,
+                  typename TTypes<float, 1>::ConstTensor scale,
+                  TensorFormat data_format,
+                  typename TTypes<U, 4>::Tensor crops);
+};
+
 template <typename Device, typename T>
 struct CropAndResizeBackpropImage {
   // We assume that the tensor sizes are correct.
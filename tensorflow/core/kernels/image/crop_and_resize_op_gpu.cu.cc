@@ -129,6 +129,102 @@ __global__ void CropAndResizeKernel(
   }
 }
 
+template <typename T, typename U>
+__global__ void CropAndResizeNormalizeKernel(
+    const int32 nthreads, const T* __restrict__ image_ptr,
+    const float* __restrict__ boxes_ptr, const int32* __restrict__ box_ind_ptr,
+    int num_boxes, int batch, int image_height, int image_width,
+    int crop_height, int crop_width, int depth, int method_id,
+    float extrapolation_value, const float* __restrict__ mean_ptr,
+    const float* __restrict__ scale_ptr, bool nchw,
+    U* __restrict__ crops_ptr) {
+  GPU_1D_KERNEL_LOOP(out_idx, nthreads) {
+    int idx = out_idx;
+    int b, y, x, d;
+    if (nchw) {
+      // out_idx = w + crop_width * (h + crop_height * (d + depth * b))
+      x = idx % crop_width;
+      idx /= crop_width;
+      y = idx % crop_height;
+      idx /= crop_height;
+      d = idx % depth;
+      b = idx / depth;
+    } else {
+      // out_idx = d + depth * (w + crop_width * (h + crop_height * b))
+      d = idx % depth;
+      idx /= depth;
+      x = idx % crop_width;
+      idx /= crop_width;
+      y = idx % crop_height;
+      b = idx / crop_height;
+    }
+
+    const float y1 = boxes_ptr[b * 4];
+    const float x1 = boxes_ptr[b * 4 + 1];
+    const float y2 = boxes_ptr[b * 4 + 2];
+    const float x2 = boxes_ptr[b * 4 + 3];
+
+    const int32 b_in = box_ind_ptr[b];
+    if (b_in < 0 || b_in >= batch) {
+      continue;
+    }
+
+    const float height_scale =
+        (crop_height > 1) ? (y2 - y1) * (image_height - 1) / (crop_height - 1)
+                          : 0;
+    const float width_scale =
+        (crop_width > 1) ? (x2 - x1) * (image_width - 1) / (crop_width - 1) : 0;
+
+    const float in_y = (crop_height > 1)
+                           ? y1 * (image_height - 1) + y * height_scale
+                           : 0.5 * (y1 + y2) * (image_height - 1);
+    const float in_x = (crop_width > 1)
+                           ? x1 * (image_width - 1) + x * width_scale
+                           : 0.5 * (x1 + x2) * (image_width - 1);
+
+    float value;
+    if (in_y < 0 || in_y > image_height - 1 || in_x < 0 ||
+        in_x > image_width - 1) {
+      value = extrapolation_value;
+    } else if (method_id == BILINEAR) {
+      const int top_y_index = floorf(in_y);
+      const int bottom_y_index = ceilf(in_y);
+      const float y_lerp = in_y - top_y_index;
+
+      const int left_x_index = floorf(in_x);
+      const int right_x_index = ceilf(in_x);
+      const float x_lerp = in_x - left_x_index;
+
+      const T* top_ptr =
+          image_ptr + (b_in * image_height + top_y_index) * image_width * depth;
+      const T* bottom_ptr =
+          image_ptr +
+          (b_in * image_height + bottom_y_index) * image_width * depth;
+      const float top_left(
+          static_cast<float>(top_ptr[left_x_index * depth + d]));
+      const float top_right(
+          static_cast<float>(top_ptr[right_x_index * depth + d]));
+      const float bottom_left(
+          static_cast<float>(bottom_ptr[left_x_index * depth + d]));
+      const float bottom_right(
+          static_cast<float>(bottom_ptr[right_x_index * depth + d]));
+      const float top = top_left + (top_right - top_left) * x_lerp;
+      const float bottom = bottom_left + (bottom_right - bottom_left) * x_lerp;
+      value = top + (bottom - top) * y_lerp;
+    } else {  // method_id == NEAREST
+      const int closest_x_index = roundf(in_x);
+      const int closest_y_index = roundf(in_y);
+      value = static_cast<float>(
+          image_ptr[((b_in * image_height + closest_y_index) * image_width +
+                     closest_x_index) *
+                        depth +
+                    d]);
+    }
+    crops_ptr[out_idx] =
+        static_cast<U>((value - ldg(mean_ptr + d)) * ldg(scale_ptr + d));
+  }
+}
+
 template <typename T>
 __global__ void CropAndResizeBackpropImageKernel(
     const int32 nthreads, const float* __restrict__ grads_ptr,
@@ -384,6 +480,49 @@ struct CropAndResize<GPUDevice, T> {
   }
 };
 
+template <typename T, typename U>
+struct CropAndResizeNormalize<GPUDevice, T, U> {
+  bool operator()(OpKernelContext* context,
+                  typename TTypes<T, 4>::ConstTensor image,
+                  typename TTypes<float, 2>::ConstTensor boxes,
+                  typename TTypes<int32, 1>::ConstTensor box_ind,
+                  const std::string& method_name, float extrapolation_value,
+                  typename TTypes<float, 1>::ConstTensor mean,
+                  typename TTypes<float, 1>::ConstTensor scale,
+                  TensorFormat data_format,
+                  typename TTypes<U, 4>::Tensor crops) {
+    const int batch = image.dimension(0);
+    const int image_height = image.dimension(1);
+    const int image_width = image.dimension(2);
+    const int depth = image.dimension(3);
+
+    const bool nchw = data_format == FORMAT_NCHW;
+    const int num_boxes = crops.dimension(0);
+    const int crop_height = crops.dimension(nchw ? 2 : 1);
+    const int crop_width = crops.dimension(nchw ? 3 : 2);
+
+    const int total_count = num_boxes * crop_height * crop_width * depth;
+    const GPUDevice& d = context->eigen_device<GPUDevice>();
+
+    InterpolationMethod method = BILINEAR;
+    if (method_name == "nearest") {
+      method = NEAREST;
+    }
+
+    if (total_count > 0) {
+      GpuLaunchConfig config = GetGpuLaunchConfig(total_count, d);
+      TF_CHECK_OK(GpuLaunchKernel(
+          CropAndResizeNormalizeKernel<T, U>, config.block_count,
+          config.thread_per_block, 0, d.stream(), config.virtual_thread_count,
+          image.data(), boxes.data(), box_ind.data(), num_boxes, batch,
+          image_height, image_width, crop_height, crop_width, depth, method,
+          extrapolation_value, mean.data(), scale.data(), nchw,
+          crops.data()));
+    }
+    return d.ok();
+  }
+};
+
 template <typename T>
 struct CropAndResizeBackpropImage<GPUDevice, T> {
   bool operator()(const OpKernelContext* context,
@@ -488,6 +627,15 @@ TF_CALL_GPU_NUMBER_TYPES(DEFINE_GPU_SPECS);
 
 #undef DEFINE_GPU_SPECS
 
+#define DEFINE_GPU_SPECS(T)                                          \
+  template struct CropAndResizeNormalize<GPUDevice, T, Eigen::half>; \
+  template struct CropAndResizeNormalize<GPUDevice, T, float>;
+
+TF_CALL_uint8(DEFINE_GPU_SPECS);
+TF_CALL_GPU_NUMBER_TYPES(DEFINE_GPU_SPECS);
+
+#undef DEFINE_GPU_SPECS
+
 template struct CheckValidBoxIndexHelper<GPUDevice>;
 
 }  // namespace functor
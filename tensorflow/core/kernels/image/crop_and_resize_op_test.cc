@@ -454,4 +454,120 @@ TEST_F(CropAndResizeOpTest, TestWithSharding) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+class CropAndResizeNormalizeOpTest : public OpsTestBase {
+ protected:
+  template <typename T>
+  void MakeOp(DataType out_type, float extrapolation_value,
+              const string& method, const string& data_format) {
+    TF_EXPECT_OK(NodeDefBuilder("crop_and_resize_normalize_op",
+                                "CropAndResizeNormalize")
+                     .Input(FakeInput(DataTypeToEnum<T>::value))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("out_type", out_type)
+                     .Attr("extrapolation_value", extrapolation_value)
+                     .Attr("method", method)
+                     .Attr("data_format", data_format)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+
+  // Adds a 2x2 image with two channels, {1, 2, 3, 4} and {10, 20, 30, 40}.
+  void AddTwoChannelImage() {
+    AddInputFromArray<uint8>(TensorShape({1, 2, 2, 2}),
+                             {1, 10, 2, 20, 3, 30, 4, 40});
+  }
+};
+
+TEST_F(CropAndResizeNormalizeOpTest, TestNHWC) {
+  MakeOp<uint8>(DT_FLOAT, 0, "bilinear", "NHWC");
+  AddTwoChannelImage();
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 3});
+  AddInputFromArray<float>(TensorShape({2}), {1, 10});
+  AddInputFromArray<float>(TensorShape({2}), {2, 0.1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 3, 3, 2}));
+  // clang-format off
+  test::FillValues<float>(&expected,
+    {0, 0,    1, 0.5,  2, 1,
+     2, 1,    3, 1.5,  4, 2,
+     4, 2,    5, 2.5,  6, 3});
+  // clang-format on
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(CropAndResizeNormalizeOpTest, TestNCHW) {
+  MakeOp<uint8>(DT_FLOAT, 0, "bilinear", "NCHW");
+  AddTwoChannelImage();
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 3});
+  AddInputFromArray<float>(TensorShape({2}), {1, 10});
+  AddInputFromArray<float>(TensorShape({2}), {2, 0.1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 2, 3, 3}));
+  // clang-format off
+  test::FillValues<float>(&expected,
+    {0, 1,   2,
+     2, 3,   4,
+     4, 5,   6,
+     0, 0.5, 1,
+     1, 1.5, 2,
+     2, 2.5, 3});
+  // clang-format on
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(CropAndResizeNormalizeOpTest, TestNearestHalfOutput) {
+  MakeOp<uint8>(DT_HALF, 0, "nearest", "NHWC");
+  AddTwoChannelImage();
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 1});
+  AddInputFromArray<float>(TensorShape({2}), {0, 20});
+  AddInputFromArray<float>(TensorShape({2}), {1, 0.5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_HALF, TensorShape({1, 1, 1, 2}));
+  test::FillValues<Eigen::half>(&expected,
+                                {Eigen::half(4.0f), Eigen::half(10.0f)});
+  test::ExpectTensorEqual<Eigen::half>(expected, *GetOutput(0));
+}
+
+TEST_F(CropAndResizeNormalizeOpTest, TestExtrapolationIsNormalized) {
+  MakeOp<float>(DT_FLOAT, 5, "bilinear", "NHWC");
+  AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 2, 2});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({2}), {2, 2});
+  AddInputFromArray<float>(TensorShape({1}), {1});
+  AddInputFromArray<float>(TensorShape({1}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 2, 2, 1}));
+  test::FillValues<float>(&expected, {0, 8, 8, 8});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(CropAndResizeNormalizeOpTest, TestInvalidMean) {
+  MakeOp<uint8>(DT_FLOAT, 0, "bilinear", "NHWC");
+  AddTwoChannelImage();
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 3});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<float>(TensorShape({2}), {1, 1});
+  Status s = RunOpKernel();
+  ASSERT_FALSE(s.ok());
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "mean must be 1-D with 2"))
+      << s;
+}
+
 }  // namespace tensorflow
@@ -16,9 +16,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <array>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -27,6 +29,11 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/kernels/lookup_table_op_gpu.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 namespace lookup {
 
@@ -35,6 +42,10 @@ namespace lookup {
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The keys are striped across kNumShards independently locked maps, so
+// concurrent Find and Insert calls only contend when they touch the same
+// shard. Each batch is bucketed by shard first so that every shard lock is
+// taken at most once per call.
 //
 // Sample use case:
 //
@@ -50,8 +61,12 @@ class MutableHashTableOfScalars final : public LookupInterface {
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
   size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
+    size_t ret = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      ret += shard.table.size();
+    }
+    return ret;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -64,17 +79,26 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64 default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      // is_full_size_default is true:
-      //   Each key has an independent default value, key_values(i)
-      //   corresponding uses default_flat(i) as its default value.
-      //
-      // is_full_size_default is false:
-      //   All keys will share the default_flat(0) as default value.
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
+    std::vector<K> shard_keys;
+    std::vector<int64> shard_positions;
+    ShardStarts shard_starts;
+    GroupByShard(key_values, &shard_keys, &shard_positions, &shard_starts);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (shard_starts[s] == shard_starts[s + 1]) continue;
+      const Shard& shard = shards_[s];
+      tf_shared_lock l(shard.mu);
+      for (int64 j = shard_starts[s]; j < shard_starts[s + 1]; ++j) {
+        const int64 i = shard_positions[j];
+        // is_full_size_default is true:
+        //   Each key has an independent default value, key_values(i)
+        //   corresponding uses default_flat(i) as its default value.
+        //
+        // is_full_size_default is false:
+        //   All keys will share the default_flat(0) as default value.
+        value_values(i) = gtl::FindWithDefault(
+            shard.table, shard_keys[j],
+            is_full_size_default ? default_flat(i) : default_flat(0));
+      }
     }
 
     return Status::OK();
@@ -84,13 +108,26 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
     if (clear) {
-      table_.clear();
+      ReplaceAll(key_values, value_values);
+      return Status::OK();
     }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+
+    std::vector<K> shard_keys;
+    std::vector<int64> shard_positions;
+    ShardStarts shard_starts;
+    GroupByShard(key_values, &shard_keys, &shard_positions, &shard_starts);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (shard_starts[s] == shard_starts[s + 1]) continue;
+      Shard& shard = shards_[s];
+      mutex_lock l(shard.mu);
+      // Positions within a shard keep their input order, so the last of
+      // several duplicate keys still wins.
+      for (int64 j = shard_starts[s]; j < shard_starts[s + 1]; ++j) {
+        gtl::InsertOrUpdate(
+            &shard.table, shard_keys[j],
+            SubtleMustCopyIfIntegral(value_values(shard_positions[j])));
+      }
     }
     return Status::OK();
   }
@@ -103,9 +140,17 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
+    std::vector<K> shard_keys;
+    std::vector<int64> shard_positions;
+    ShardStarts shard_starts;
+    GroupByShard(key_values, &shard_keys, &shard_positions, &shard_starts);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (shard_starts[s] == shard_starts[s + 1]) continue;
+      Shard& shard = shards_[s];
+      mutex_lock l(shard.mu);
+      for (int64 j = shard_starts[s]; j < shard_starts[s + 1]; ++j) {
+        shard.table.erase(shard_keys[j]);
+      }
     }
     return Status::OK();
   }
@@ -115,25 +160,36 @@ class MutableHashTableOfScalars final : public LookupInterface {
     return DoInsert(true, keys, values);
   }
 
-  Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64 size = table_.size();
+  Status ExportValues(OpKernelContext* ctx)
+      override TF_NO_THREAD_SAFETY_ANALYSIS {
+    // Hold every shard so that the exported keys and values form a consistent
+    // snapshot of the table.
+    LockAllShardsShared();
+    int64 size = 0;
+    for (const Shard& shard : shards_) {
+      size += shard.table.size();
+    }
 
     Tensor* keys;
     Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->flat<V>();
-    int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    Status s = ctx->allocate_output("keys", TensorShape({size}), &keys);
+    if (s.ok()) {
+      s = ctx->allocate_output("values", TensorShape({size}), &values);
     }
-    return Status::OK();
+    if (s.ok()) {
+      auto keys_data = keys->flat<K>();
+      auto values_data = values->flat<V>();
+      int64 i = 0;
+      for (const Shard& shard : shards_) {
+        for (auto it = shard.table.begin(); it != shard.table.end();
+             ++it, ++i) {
+          keys_data(i) = it->first;
+          values_data(i) = it->second;
+        }
+      }
+    }
+    UnlockAllShardsShared();
+    return s;
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -146,21 +202,98 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64 MemoryUsed() const override {
     int64 ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      for (unsigned i = 0; i < shard.table.bucket_count(); ++i) {
+        size_t bucket_size = shard.table.bucket_size(i);
+        if (bucket_size == 0) {
+          ret++;
+        } else {
+          ret += bucket_size;
+        }
       }
     }
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
  private:
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  static constexpr int kNumShardBits = 4;
+  static constexpr int kNumShards = 1 << kNumShardBits;
+
+  struct Shard {
+    mutable mutex mu;
+    std::unordered_map<K, V> table TF_GUARDED_BY(mu);
+  };
+
+  typedef std::array<int64, kNumShards + 1> ShardStarts;
+
+  // Picks the shard from the high bits of a multiplicative remix of the key
+  // hash, so that it stays independent of the bucket the shard's own map
+  // derives from the low bits.
+  static int ShardOf(const K& key) {
+    const uint64 hash = static_cast<uint64>(std::hash<K>()(key));
+    return static_cast<int>((hash * 0x9E3779B97F4A7C15ULL) >>
+                            (64 - kNumShardBits));
+  }
+
+  // Counting-sorts the positions of 'key_values' by shard. On return the
+  // keys and positions belonging to shard s are at
+  // [(*shard_starts)[s], (*shard_starts)[s + 1]) of 'shard_keys' and
+  // 'shard_positions', in their original relative order.
+  static void GroupByShard(typename TTypes<K>::ConstFlat key_values,
+                           std::vector<K>* shard_keys,
+                           std::vector<int64>* shard_positions,
+                           ShardStarts* shard_starts) {
+    const int64 num_keys = key_values.size();
+    // Each key is read from the tensor once, so the shard it is bucketed into
+    // always matches the key that is looked up.
+    std::vector<K> keys(num_keys);
+    std::vector<int> shard_of(num_keys);
+    shard_starts->fill(0);
+    for (int64 i = 0; i < num_keys; ++i) {
+      keys[i] = SubtleMustCopyIfIntegral(key_values(i));
+      shard_of[i] = ShardOf(keys[i]);
+      ++(*shard_starts)[shard_of[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      (*shard_starts)[s + 1] += (*shard_starts)[s];
+    }
+    ShardStarts next = *shard_starts;
+    shard_keys->resize(num_keys);
+    shard_positions->resize(num_keys);
+    for (int64 i = 0; i < num_keys; ++i) {
+      const int64 j = next[shard_of[i]]++;
+      (*shard_keys)[j] = std::move(keys[i]);
+      (*shard_positions)[j] = i;
+    }
+  }
+
+  // Replaces the contents of the table with 'key_values' and 'value_values'.
+  // Importing has to be atomic with respect to every shard, so all of them
+  // are held for the duration.
+  void ReplaceAll(typename TTypes<K>::ConstFlat key_values,
+                  typename TTypes<V>::ConstFlat value_values)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Shard& shard : shards_) shard.mu.lock();
+    for (Shard& shard : shards_) {
+      shard.table.clear();
+    }
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      gtl::InsertOrUpdate(&shards_[ShardOf(key)].table, key,
+                          SubtleMustCopyIfIntegral(value_values(i)));
+    }
+    for (Shard& shard : shards_) shard.mu.unlock();
+  }
+
+  void LockAllShardsShared() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (const Shard& shard : shards_) shard.mu.lock_shared();
+  }
+  void UnlockAllShardsShared() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (const Shard& shard : shards_) shard.mu.unlock_shared();
+  }
+
+  std::array<Shard, kNumShards> shards_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -798,6 +931,300 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 deleted_key_hash_;
 };
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// GPU counterpart of MutableDenseHashTable for scalar int32 and int64 keys.
+// The buckets live in device memory and every Find, Insert and Remove runs as
+// a single kernel over the whole batch, so the keys never leave the device.
+// Buckets are hashed and probed exactly like MutableDenseHashTable, which keeps
+// the exported tensors interchangeable between the two tables.
+//
+// Find and ExportValues are asynchronous. Insert, Remove and ImportValues wait
+// for their kernel to finish so that size() stays exact.
+//
+// Unlike the CPU table, looking up the empty or deleted key returns the default
+// value instead of an error. If one Insert batch holds the same key more than
+// once, it is unspecified which of its values is kept.
+template <class K, class V>
+class GpuDenseHashTable final : public LookupInterface {
+ public:
+  GpuDenseHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "max_load_factor", &max_load_factor_));
+    OP_REQUIRES(ctx, max_load_factor_ > 0 && max_load_factor_ < 1,
+                errors::InvalidArgument(
+                    "max_load_factor must be between 0 and 1, got: ",
+                    max_load_factor_));
+
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(value_shape_) ||
+                    TensorShapeUtils::IsVector(value_shape_),
+                errors::InvalidArgument(
+                    "Empty value must be a scalar or a vector, got shape ",
+                    value_shape_.DebugString()));
+
+    const Tensor* empty_key_input;
+    OP_REQUIRES_OK(ctx, ctx->input("empty_key", &empty_key_input));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(empty_key_input->shape()),
+                errors::InvalidArgument(
+                    "Empty key must be a scalar on GPU, got shape ",
+                    empty_key_input->shape().DebugString()));
+    empty_key_ = empty_key_input->scalar<K>()();
+
+    const Tensor* deleted_key_input;
+    OP_REQUIRES_OK(ctx, ctx->input("deleted_key", &deleted_key_input));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(deleted_key_input->shape()),
+                errors::InvalidArgument(
+                    "Empty and deleted keys must have same shape, got shapes: ",
+                    empty_key_input->shape().DebugString(), " and ",
+                    deleted_key_input->shape().DebugString()));
+    deleted_key_ = deleted_key_input->scalar<K>()();
+    OP_REQUIRES(
+        ctx, empty_key_ != deleted_key_,
+        errors::InvalidArgument("Empty and deleted keys cannot be equal"));
+
+    int64 initial_num_buckets;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
+                                    &initial_num_buckets));
+    mutex_lock l(mu_);
+    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
+  }
+
+  size_t size() const override TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return num_entries_;
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override TF_LOCKS_EXCLUDED(mu_) {
+    const int64 num_elements = key.NumElements();
+    const int64 value_size = value_shape_.num_elements();
+    if (num_elements == 0 || value_size == 0) {
+      return Status::OK();
+    }
+    const auto default_matrix = default_value.shaped<V, 2>(
+        {default_value.NumElements() / value_size, value_size});
+    auto value_matrix = value->shaped<V, 2>({num_elements, value_size});
+
+    tf_shared_lock l(mu_);
+    const Tensor& key_buckets = *key_buckets_.AccessTensor(ctx);
+    const Tensor& value_buckets = *value_buckets_.AccessTensor(ctx);
+    functor::DenseHashTableFind<K, V>()(
+        ctx->eigen_device<GPUDevice>(), empty_key_, deleted_key_,
+        key_buckets.flat<K>(), value_buckets.matrix<V>(), key.flat<K>(),
+        default_matrix, value_matrix);
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& key,
+                const Tensor& value) override TF_LOCKS_EXCLUDED(mu_) {
+    const int64 batch_size = key.NumElements();
+    mutex_lock l(mu_);
+    // As in MutableDenseHashTable we assume that every key in the input is
+    // new. Tombstones count against the load factor too, since inserts never
+    // reuse them; rebucketing drops them.
+    if (num_occupied_ + batch_size > num_buckets_ * max_load_factor_) {
+      int64 new_num_buckets = num_buckets_;
+      while (num_entries_ + batch_size > new_num_buckets * max_load_factor_) {
+        new_num_buckets <<= 1;
+      }
+      TF_RETURN_IF_ERROR(Rebucket(ctx, new_num_buckets));
+    }
+    int64 counters[2];
+    TF_RETURN_IF_ERROR(DoInsert(ctx, key, value, counters));
+    num_entries_ += counters[0];
+    num_occupied_ += counters[0];
+    if (counters[1] > 0) {
+      return errors::InvalidArgument(
+          "Using the empty_key or deleted_key as a table key is not allowed");
+    }
+    return Status::OK();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& key) override
+      TF_LOCKS_EXCLUDED(mu_) {
+    Tensor counters_tensor;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DT_INT64, TensorShape({2}), &counters_tensor));
+    int64 counters[2];
+    mutex_lock l(mu_);
+    functor::DenseHashTableRemove<K>()(
+        ctx->eigen_device<GPUDevice>(), empty_key_, deleted_key_,
+        key_buckets_.AccessTensor(ctx)->template flat<K>(), key.flat<K>(),
+        counters_tensor.flat<int64>());
+    TF_RETURN_IF_ERROR(ReadCounters(ctx, counters_tensor, counters));
+    num_entries_ -= counters[0];
+    if (counters[1] > 0) {
+      return errors::InvalidArgument(
+          "Using the empty_key or deleted_key as a table key is not allowed");
+    }
+    return Status::OK();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override TF_LOCKS_EXCLUDED(mu_) {
+    const int64 num_buckets = keys.dim_size(0);
+    if (num_buckets < 4 || (num_buckets & (num_buckets - 1)) != 0) {
+      return errors::InvalidArgument(
+          "Number of buckets must be at least 4 and a power of 2, got: ",
+          num_buckets);
+    }
+    Tensor counters_tensor;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DT_INT64, TensorShape({2}), &counters_tensor));
+    int64 counters[2];
+    mutex_lock l(mu_);
+    num_buckets_ = num_buckets;
+    key_buckets_ = PersistentTensor(keys);
+    value_buckets_ = PersistentTensor(values);
+    functor::DenseHashTableCount<K>()(ctx->eigen_device<GPUDevice>(),
+                                      empty_key_, deleted_key_,
+                                      keys.flat<K>(),
+                                      counters_tensor.flat<int64>());
+    TF_RETURN_IF_ERROR(ReadCounters(ctx, counters_tensor, counters));
+    num_entries_ = counters[0];
+    num_occupied_ = counters[1];
+    return Status::OK();
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    TF_RETURN_IF_ERROR(
+        ctx->set_output("keys", *key_buckets_.AccessTensor(ctx)));
+    TF_RETURN_IF_ERROR(
+        ctx->set_output("values", *value_buckets_.AccessTensor(ctx)));
+    return Status::OK();
+  }
+
+  Status CheckKeyAndValueTensorsForImport(const Tensor& keys,
+                                          const Tensor& values) override {
+    TF_RETURN_IF_ERROR(CheckKeyAndValueTypes(keys, values));
+    TF_RETURN_IF_ERROR(CheckKeyShape(keys.shape()));
+
+    // Buckets are stored in the same vectorized format as in
+    // MutableDenseHashTable.
+    TensorShape key_shape = MaybeVectorizeShape(key_shape());
+    TensorShape value_shape = MaybeVectorizeShape(value_shape_);
+    TensorShape expected_value_shape = keys.shape();
+    expected_value_shape.RemoveLastDims(key_shape.dims());
+    expected_value_shape.AppendShape(value_shape);
+    if (values.shape() != expected_value_shape) {
+      return errors::InvalidArgument(
+          "Expected shape ", expected_value_shape.DebugString(),
+          " for value, got ", values.shape().DebugString());
+    }
+    return Status::OK();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64 MemoryUsed() const override TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return sizeof(GpuDenseHashTable) + key_buckets_.AllocatedBytes() +
+           value_buckets_.AllocatedBytes();
+  }
+
+ private:
+  typedef Eigen::GpuDevice GPUDevice;
+
+  // Inserts 'key' and 'value' with a single kernel and returns the kernel
+  // counters of DenseHashTableInsert in 'counters'.
+  Status DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value,
+                  int64* counters) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64 num_elements = key.NumElements();
+    const int64 value_size = value_shape_.num_elements();
+    Tensor counters_tensor;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DT_INT64, TensorShape({2}), &counters_tensor));
+    functor::DenseHashTableInsert<K, V>()(
+        ctx->eigen_device<GPUDevice>(), empty_key_, deleted_key_,
+        key_buckets_.AccessTensor(ctx)->template flat<K>(),
+        value_buckets_.AccessTensor(ctx)->template matrix<V>(), key.flat<K>(),
+        value.shaped<V, 2>({num_elements, value_size}),
+        counters_tensor.flat<int64>());
+    return ReadCounters(ctx, counters_tensor, counters);
+  }
+
+  Status AllocateBuckets(OpKernelContext* ctx, int64 new_num_buckets)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (new_num_buckets < 4 ||
+        ((new_num_buckets & (new_num_buckets - 1)) != 0)) {
+      return errors::InvalidArgument(
+          "Number of buckets must be at least 4 and a power of 2, got: ",
+          new_num_buckets);
+    }
+    num_buckets_ = new_num_buckets;
+    num_entries_ = 0;
+    num_occupied_ = 0;
+
+    Tensor* key_buckets_tensor;
+    TF_RETURN_IF_ERROR(ctx->allocate_persistent(
+        key_dtype(), TensorShape({num_buckets_, 1}), &key_buckets_,
+        &key_buckets_tensor));
+    Tensor* value_buckets_tensor;
+    TF_RETURN_IF_ERROR(ctx->allocate_persistent(
+        value_dtype(),
+        TensorShape({num_buckets_, value_shape_.num_elements()}),
+        &value_buckets_, &value_buckets_tensor));
+    functor::DenseHashTableInitBuckets<K, V>()(
+        ctx->eigen_device<GPUDevice>(), empty_key_,
+        key_buckets_tensor->flat<K>(), value_buckets_tensor->matrix<V>());
+    return Status::OK();
+  }
+
+  Status Rebucket(OpKernelContext* ctx, int64 num_new_buckets)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Tensor old_key_buckets = *key_buckets_.AccessTensor(ctx);
+    Tensor old_value_buckets = *value_buckets_.AccessTensor(ctx);
+    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, num_new_buckets));
+    // The free buckets and tombstones of the old table are skipped as empty
+    // and deleted keys.
+    int64 counters[2];
+    TF_RETURN_IF_ERROR(
+        DoInsert(ctx, old_key_buckets, old_value_buckets, counters));
+    num_entries_ = counters[0];
+    num_occupied_ = counters[0];
+    return Status::OK();
+  }
+
+  // Copies the two kernel counters in 'counters_tensor' to 'counters',
+  // blocking until the kernels that produce them have finished.
+  static Status ReadCounters(OpKernelContext* ctx,
+                             const Tensor& counters_tensor, int64* counters) {
+    se::Stream* stream = ctx->op_device_context()->stream();
+    if (stream == nullptr) {
+      return errors::Internal("No GPU stream available.");
+    }
+    se::DeviceMemoryBase counters_ptr(
+        const_cast<char*>(counters_tensor.tensor_data().data()),
+        counters_tensor.TotalBytes());
+    stream->ThenMemcpy(counters, counters_ptr, counters_tensor.TotalBytes());
+    return stream->BlockHostUntilDone();
+  }
+
+  TensorShape value_shape_;
+  float max_load_factor_;
+  K empty_key_;
+  K deleted_key_;
+  mutable mutex mu_;
+  int64 num_entries_ TF_GUARDED_BY(mu_);
+  // Number of buckets that are not free, i.e. entries plus tombstones.
+  int64 num_occupied_ TF_GUARDED_BY(mu_);
+  int64 num_buckets_ TF_GUARDED_BY(mu_);
+  PersistentTensor key_buckets_ TF_GUARDED_BY(mu_);
+  PersistentTensor value_buckets_ TF_GUARDED_BY(mu_);
+};
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace lookup
 
 // Base class for kernels that take a LookupTable handle as the 0th input.
@@ -1133,4 +1560,68 @@ REGISTER_KERNEL(tstring, ResourceHandle);
 
 #undef REGISTER_KERNEL
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Register the GPU MutableDenseHashTable op and the table ops that access it.
+// The GPU table only supports scalar keys, so it has a lower priority than the
+// CPU one and must be placed on a GPU explicitly. The placer keeps the table
+// ops on the device of their table, so these kernels only ever see a
+// GpuDenseHashTable.
+#define REGISTER_GPU_KERNEL(key_dtype, value_dtype)                        \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("MutableDenseHashTableV2")                                      \
+          .Device(DEVICE_GPU)                                              \
+          .HostMemory("empty_key")                                         \
+          .HostMemory("deleted_key")                                       \
+          .TypeConstraint<key_dtype>("key_dtype")                          \
+          .TypeConstraint<value_dtype>("value_dtype")                      \
+          .Priority(-1),                                                   \
+      LookupTableOp<lookup::GpuDenseHashTable<key_dtype, value_dtype>,     \
+                    key_dtype, value_dtype>)                               \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableFindV2")                        \
+                              .Device(DEVICE_GPU)                          \
+                              .TypeConstraint<key_dtype>("Tin")            \
+                              .TypeConstraint<value_dtype>("Tout"),        \
+                          LookupTableFindOp);                              \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableInsertV2")                      \
+                              .Device(DEVICE_GPU)                          \
+                              .TypeConstraint<key_dtype>("Tin")            \
+                              .TypeConstraint<value_dtype>("Tout"),        \
+                          LookupTableInsertOp);                            \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableExportV2")                      \
+                              .Device(DEVICE_GPU)                          \
+                              .TypeConstraint<key_dtype>("Tkeys")          \
+                              .TypeConstraint<value_dtype>("Tvalues"),     \
+                          LookupTableExportOp);                            \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableImportV2")                      \
+                              .Device(DEVICE_GPU)                          \
+                              .TypeConstraint<key_dtype>("Tin")            \
+                              .TypeConstraint<value_dtype>("Tout"),        \
+                          LookupTableImportOp)
+
+REGISTER_GPU_KERNEL(int32, double);
+REGISTER_GPU_KERNEL(int32, float);
+REGISTER_GPU_KERNEL(int32, int32);
+REGISTER_GPU_KERNEL(int32, int64);
+REGISTER_GPU_KERNEL(int64, double);
+REGISTER_GPU_KERNEL(int64, float);
+REGISTER_GPU_KERNEL(int64, int32);
+REGISTER_GPU_KERNEL(int64, int64);
+
+#undef REGISTER_GPU_KERNEL
+
+REGISTER_KERNEL_BUILDER(Name("LookupTableRemoveV2")
+                            .Device(DEVICE_GPU)
+                            .TypeConstraint<int32>("Tin"),
+                        LookupTableRemoveOp);
+REGISTER_KERNEL_BUILDER(Name("LookupTableRemoveV2")
+                            .Device(DEVICE_GPU)
+                            .TypeConstraint<int64>("Tin"),
+                        LookupTableRemoveOp);
+REGISTER_KERNEL_BUILDER(
+    Name("LookupTableSizeV2").Device(DEVICE_GPU).HostMemory("size"),
+    LookupTableSizeOp);
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace tensorflow
@@ -42,15 +42,21 @@ class LookupTableOp : public OpKernel {
   // ctx is not owned by this class.
   explicit LookupTableOp(OpKernelConstruction* ctx)
       : OpKernel(ctx), table_handle_set_(false) {
+    // The handle is written on the host, also when the table itself is placed
+    // on a GPU.
+    AllocatorAttributes attr;
+    attr.set_on_host(true);
+    Tensor table_handle;
     if (ctx->output_type(0) == DT_RESOURCE) {
-      OP_REQUIRES_OK(ctx, ctx->allocate_persistent(tensorflow::DT_RESOURCE,
-                                                   tensorflow::TensorShape({}),
-                                                   &table_handle_, nullptr));
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(tensorflow::DT_RESOURCE,
+                                             tensorflow::TensorShape({}),
+                                             &table_handle, attr));
     } else {
-      OP_REQUIRES_OK(ctx, ctx->allocate_persistent(tensorflow::DT_STRING,
-                                                   tensorflow::TensorShape({2}),
-                                                   &table_handle_, nullptr));
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(tensorflow::DT_STRING,
+                                             tensorflow::TensorShape({2}),
+                                             &table_handle, attr));
     }
+    table_handle_ = PersistentTensor(table_handle);
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr("use_node_name_sharing", &use_node_name_sharing_));
   }
@@ -0,0 +1,282 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/lookup_table_op_gpu.h"
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/util/gpu_device_functions.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+namespace functor {
+
+namespace {
+
+// Same hash and probe sequence as the CPU MutableDenseHashTable, so that
+// exported buckets can be imported into either table.
+template <typename K>
+__device__ EIGEN_STRONG_INLINE int64 HashBucket(K key, int64 bit_mask) {
+  return static_cast<uint64>(key) & bit_mask;
+}
+
+__device__ EIGEN_STRONG_INLINE int32 AtomicCasKey(int32* ptr, int32 compare,
+                                                  int32 value) {
+  return atomicCAS(ptr, compare, value);
+}
+
+__device__ EIGEN_STRONG_INLINE int64 AtomicCasKey(int64* ptr, int64 compare,
+                                                  int64 value) {
+  return static_cast<int64>(
+      atomicCAS(reinterpret_cast<unsigned long long*>(ptr),
+                static_cast<unsigned long long>(compare),
+                static_cast<unsigned long long>(value)));
+}
+
+template <typename K, typename V>
+__global__ void DenseHashTableFindKernel(
+    int64 num_keys, int64 value_size, int64 num_buckets, K empty_key,
+    K deleted_key, const K* __restrict__ key_buckets,
+    const V* __restrict__ value_buckets, const K* __restrict__ keys,
+    int64 num_default_rows, const V* __restrict__ default_values,
+    V* __restrict__ values) {
+  const int64 bit_mask = num_buckets - 1;
+  for (int64 i : GpuGridRangeX(num_keys)) {
+    const K key = ldg(keys + i);
+    const V* row = num_default_rows == 1 ? default_values
+                                         : default_values + i * value_size;
+    if (key != empty_key && key != deleted_key) {
+      int64 bucket = HashBucket(key, bit_mask);
+      for (int64 num_probes = 0; num_probes < num_buckets;) {
+        const K bucket_key = ldg(key_buckets + bucket);
+        if (bucket_key == key) {
+          row = value_buckets + bucket * value_size;
+          break;
+        }
+        if (bucket_key == empty_key) break;
+        ++num_probes;
+        bucket = (bucket + num_probes) & bit_mask;  // quadratic probing
+      }
+    }
+    for (int64 j = 0; j < value_size; ++j) {
+      values[i * value_size + j] = ldg(row + j);
+    }
+  }
+}
+
+template <typename K, typename V>
+__global__ void DenseHashTableInsertKernel(
+    int64 num_keys, int64 value_size, int64 num_buckets, K empty_key,
+    K deleted_key, K* __restrict__ key_buckets, V* __restrict__ value_buckets,
+    const K* __restrict__ keys, const V* __restrict__ values,
+    int64* __restrict__ counters) {
+  const int64 bit_mask = num_buckets - 1;
+  for (int64 i : GpuGridRangeX(num_keys)) {
+    const K key = ldg(keys + i);
+    if (key == empty_key || key == deleted_key) {
+      GpuAtomicAdd(counters + 1, int64{1});
+      continue;
+    }
+    int64 bucket = HashBucket(key, bit_mask);
+    for (int64 num_probes = 0; num_probes < num_buckets;) {
+      K bucket_key = key_buckets[bucket];
+      if (bucket_key == empty_key) {
+        // Buckets only ever go from free to taken while inserting, so a
+        // failed claim means another thread took the bucket first, possibly
+        // for the same key.
+        bucket_key = AtomicCasKey(key_buckets + bucket, empty_key, key);
+        if (bucket_key == empty_key) {
+          GpuAtomicAdd(counters, int64{1});
+          bucket_key = key;
+        }
+      }
+      if (bucket_key == key) {
+        for (int64 j = 0; j < value_size; ++j) {
+          value_buckets[bucket * value_size + j] =
+              ldg(values + i * value_size + j);
+        }
+        break;
+      }
+      ++num_probes;
+      bucket = (bucket + num_probes) & bit_mask;  // quadratic probing
+    }
+  }
+}
+
+template <typename K>
+__global__ void DenseHashTableRemoveKernel(int64 num_keys, int64 num_buckets,
+                                           K empty_key, K deleted_key,
+                                           K* __restrict__ key_buckets,
+                                           const K* __restrict__ keys,
+                                           int64* __restrict__ counters) {
+  const int64 bit_mask = num_buckets - 1;
+  for (int64 i : GpuGridRangeX(num_keys)) {
+    const K key = ldg(keys + i);
+    if (key == empty_key || key == deleted_key) {
+      GpuAtomicAdd(counters + 1, int64{1});
+      continue;
+    }
+    int64 bucket = HashBucket(key, bit_mask);
+    for (int64 num_probes = 0; num_probes < num_buckets;) {
+      const K bucket_key = key_buckets[bucket];
+      if (bucket_key == key) {
+        // The same key may appear several times in 'keys'; only one of the
+        // threads gets to remove it.
+        if (AtomicCasKey(key_buckets + bucket, key, deleted_key) == key) {
+          GpuAtomicAdd(counters, int64{1});
+        }
+        break;
+      }
+      if (bucket_key == empty_key) break;
+      ++num_probes;
+      bucket = (bucket + num_probes) & bit_mask;  // quadratic probing
+    }
+  }
+}
+
+template <typename K>
+__global__ void DenseHashTableCountKernel(int64 num_buckets, K empty_key,
+                                          K deleted_key,
+                                          const K* __restrict__ key_buckets,
+                                          int64* __restrict__ counters) {
+  for (int64 i : GpuGridRangeX(num_buckets)) {
+    const K key = ldg(key_buckets + i);
+    if (key != empty_key) {
+      GpuAtomicAdd(counters + 1, int64{1});
+      if (key != deleted_key) {
+        GpuAtomicAdd(counters, int64{1});
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <typename K, typename V>
+void DenseHashTableInitBuckets<K, V>::operator()(
+    const GPUDevice& d, K empty_key, typename TTypes<K>::Flat key_buckets,
+    typename TTypes<V>::Matrix value_buckets) {
+  if (key_buckets.size() > 0) {
+    GpuLaunchConfig config = GetGpuLaunchConfig(key_buckets.size(), d);
+    TF_CHECK_OK(GpuLaunchKernel(SetToValue<K>, config.block_count,
+                                config.thread_per_block, 0, d.stream(),
+                                key_buckets.size(), key_buckets.data(),
+                                empty_key));
+  }
+  if (value_buckets.size() > 0) {
+    // Zero the values so that ExportValues() never exposes uninitialized
+    // memory.
+    GpuLaunchConfig config = GetGpuLaunchConfig(value_buckets.size(), d);
+    TF_CHECK_OK(GpuLaunchKernel(SetZero<V>, config.block_count,
+                                config.thread_per_block, 0, d.stream(),
+                                value_buckets.size(), value_buckets.data()));
+  }
+}
+
+template <typename K, typename V>
+void DenseHashTableFind<K, V>::operator()(
+    const GPUDevice& d, K empty_key, K deleted_key,
+    typename TTypes<K>::ConstFlat key_buckets,
+    typename TTypes<V>::ConstMatrix value_buckets,
+    typename TTypes<K>::ConstFlat keys,
+    typename TTypes<V>::ConstMatrix default_values,
+    typename TTypes<V>::Matrix values) {
+  const int64 num_keys = keys.size();
+  if (num_keys == 0 || values.dimension(1) == 0) return;
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_keys, d);
+  TF_CHECK_OK(GpuLaunchKernel(
+      DenseHashTableFindKernel<K, V>, config.block_count,
+      config.thread_per_block, 0, d.stream(), num_keys, values.dimension(1),
+      key_buckets.size(), empty_key, deleted_key, key_buckets.data(),
+      value_buckets.data(), keys.data(), default_values.dimension(0),
+      default_values.data(), values.data()));
+}
+
+template <typename K, typename V>
+void DenseHashTableInsert<K, V>::operator()(
+    const GPUDevice& d, K empty_key, K deleted_key,
+    typename TTypes<K>::Flat key_buckets,
+    typename TTypes<V>::Matrix value_buckets,
+    typename TTypes<K>::ConstFlat keys, typename TTypes<V>::ConstMatrix values,
+    typename TTypes<int64>::Flat counters) {
+  counters.device(d) = counters.constant(int64{0});
+  const int64 num_keys = keys.size();
+  if (num_keys == 0) return;
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_keys, d);
+  TF_CHECK_OK(GpuLaunchKernel(
+      DenseHashTableInsertKernel<K, V>, config.block_count,
+      config.thread_per_block, 0, d.stream(), num_keys,
+      value_buckets.dimension(1), key_buckets.size(), empty_key, deleted_key,
+      key_buckets.data(), value_buckets.data(), keys.data(), values.data(),
+      counters.data()));
+}
+
+template <typename K>
+void DenseHashTableRemove<K>::operator()(
+    const GPUDevice& d, K empty_key, K deleted_key,
+    typename TTypes<K>::Flat key_buckets, typename TTypes<K>::ConstFlat keys,
+    typename TTypes<int64>::Flat counters) {
+  counters.device(d) = counters.constant(int64{0});
+  const int64 num_keys = keys.size();
+  if (num_keys == 0) return;
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_keys, d);
+  TF_CHECK_OK(GpuLaunchKernel(DenseHashTableRemoveKernel<K>,
+                              config.block_count, config.thread_per_block, 0,
+                              d.stream(), num_keys, key_buckets.size(),
+                              empty_key, deleted_key, key_buckets.data(),
+                              keys.data(), counters.data()));
+}
+
+template <typename K>
+void DenseHashTableCount<K>::operator()(
+    const GPUDevice& d, K empty_key, K deleted_key,
+    typename TTypes<K>::ConstFlat key_buckets,
+    typename TTypes<int64>::Flat counters) {
+  counters.device(d) = counters.constant(int64{0});
+  const int64 num_buckets = key_buckets.size();
+  if (num_buckets == 0) return;
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_buckets, d);
+  TF_CHECK_OK(GpuLaunchKernel(DenseHashTableCountKernel<K>,
+                              config.block_count, config.thread_per_block, 0,
+                              d.stream(), num_buckets, empty_key, deleted_key,
+                              key_buckets.data(), counters.data()));
+}
+
+#define DEFINE_GPU_SPECS_KEY_VALUE(K, V)           \
+  template struct DenseHashTableInitBuckets<K, V>; \
+  template struct DenseHashTableFind<K, V>;        \
+  template struct DenseHashTableInsert<K, V>
+
+#define DEFINE_GPU_SPECS_KEY(K)            \
+  DEFINE_GPU_SPECS_KEY_VALUE(K, int32);    \
+  DEFINE_GPU_SPECS_KEY_VALUE(K, int64);    \
+  DEFINE_GPU_SPECS_KEY_VALUE(K, float);    \
+  DEFINE_GPU_SPECS_KEY_VALUE(K, double);   \
+  template struct DenseHashTableRemove<K>; \
+  template struct DenseHashTableCount<K>
+
+DEFINE_GPU_SPECS_KEY(int32);
+DEFINE_GPU_SPECS_KEY(int64);
+
+#undef DEFINE_GPU_SPECS_KEY
+#undef DEFINE_GPU_SPECS_KEY_VALUE
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
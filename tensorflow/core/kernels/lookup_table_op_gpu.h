@@ -0,0 +1,97 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
+#define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace functor {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Functors for the device-memory open-addressed hash table behind the GPU
+// MutableDenseHashTable kernels. Keys are scalars; 'key_buckets' holds one key
+// per bucket and 'value_buckets' one row of values per bucket. The number of
+// buckets must be a power of two. A bucket holding 'empty_key' is free, one
+// holding 'deleted_key' is a tombstone left behind by a removal.
+
+// Sets every key bucket to 'empty_key' and every value bucket to zero.
+template <typename K, typename V>
+struct DenseHashTableInitBuckets {
+  void operator()(const GPUDevice& d, K empty_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<V>::Matrix value_buckets);
+};
+
+// Looks up every key in 'keys' and writes its row of values to 'values'. Keys
+// that are not in the table, including the empty and deleted keys, get row i
+// of 'default_values' if it has one row per key and row 0 otherwise.
+template <typename K, typename V>
+struct DenseHashTableFind {
+  void operator()(const GPUDevice& d, K empty_key, K deleted_key,
+                  typename TTypes<K>::ConstFlat key_buckets,
+                  typename TTypes<V>::ConstMatrix value_buckets,
+                  typename TTypes<K>::ConstFlat keys,
+                  typename TTypes<V>::ConstMatrix default_values,
+                  typename TTypes<V>::Matrix values);
+};
+
+// Inserts or updates every key of 'keys' with the matching row of 'values'.
+// New keys only ever claim free buckets, never tombstones, so the caller must
+// make sure that enough free buckets are left for the whole batch. On return
+// counters(0) holds the number of keys that were not in the table before and
+// counters(1) the number of empty or deleted keys that were skipped.
+template <typename K, typename V>
+struct DenseHashTableInsert {
+  void operator()(const GPUDevice& d, K empty_key, K deleted_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<V>::Matrix value_buckets,
+                  typename TTypes<K>::ConstFlat keys,
+                  typename TTypes<V>::ConstMatrix values,
+                  typename TTypes<int64>::Flat counters);
+};
+
+// Replaces every key of 'keys' that is in the table with a tombstone. On
+// return counters(0) holds the number of keys removed and counters(1) the
+// number of empty or deleted keys that were skipped.
+template <typename K>
+struct DenseHashTableRemove {
+  void operator()(const GPUDevice& d, K empty_key, K deleted_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<K>::ConstFlat keys,
+                  typename TTypes<int64>::Flat counters);
+};
+
+// Counts the buckets of 'key_buckets'. On return counters(0) holds the number
+// of live entries and counters(1) the number of buckets that are not free.
+template <typename K>
+struct DenseHashTableCount {
+  void operator()(const GPUDevice& d, K empty_key, K deleted_key,
+                  typename TTypes<K>::ConstFlat key_buckets,
+                  typename TTypes<int64>::Flat counters);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#endif  // TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
@@ -20,7 +20,9 @@ limitations under the License.
 //
 // Activation: Relu, Relu6, Elu, etc...
 //
-// Currently supported only on CPU device.
+// On GPU only MatMul + BiasAdd + <Activation> is supported: the GEMM runs
+// through StreamExecutor BLAS, and the bias and activation are applied by a
+// single elementwise epilogue kernel on the GEMM output.
 
 #ifndef TENSORFLOW_CORE_KERNELS_MATMUL_OP_FUSED_H_
 #define TENSORFLOW_CORE_KERNELS_MATMUL_OP_FUSED_H_
@@ -28,6 +30,7 @@ limitations under the License.
 #define USE_EIGEN_TENSOR
 #define EIGEN_USE_THREADS
 
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -44,9 +47,15 @@ limitations under the License.
 #include "tensorflow/core/kernels/eigen_contraction_kernel.h"
 #endif
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/kernels/matmul_op_fused_gpu.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
 
 template <typename Device, typename T>
 struct LaunchFusedMatMulOp {
@@ -145,6 +154,98 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
   };
 };
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+template <typename T>
+struct LaunchFusedMatMulOp<GPUDevice, T> {
+  void operator()(
+      OpKernelContext* context, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      FusedComputationType fusion, const FusedComputationArgs& fusion_args,
+      Tensor* output) {
+    FusedMatMulActivation activation;
+    switch (fusion) {
+      case FusedComputationType::kBiasAdd:
+        activation = FusedMatMulActivation::kNone;
+        break;
+      case FusedComputationType::kBiasAddWithRelu:
+        activation = FusedMatMulActivation::kRelu;
+        break;
+      case FusedComputationType::kBiasAddWithRelu6:
+        activation = FusedMatMulActivation::kRelu6;
+        break;
+      case FusedComputationType::kBiasAddWithElu:
+        activation = FusedMatMulActivation::kElu;
+        break;
+      case FusedComputationType::kBiasAddWithLeakyRelu:
+        activation = FusedMatMulActivation::kLeakyRelu;
+        break;
+      case FusedComputationType::kUndefined:
+        OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
+        return;
+      default:
+        OP_REQUIRES_OK(context,
+                       errors::Internal("Fusion type is not supported"));
+        return;
+    }
+
+    const bool transpose_a = dim_pair[0].first == 0;
+    const bool transpose_b = dim_pair[0].second == 1;
+    const int64 m = output->dim_size(0);
+    const int64 n = output->dim_size(1);
+    const int64 k = a.dim_size(dim_pair[0].first);
+
+    const Tensor& bias = context->input(2);
+    OP_REQUIRES(context, bias.dims() == 1 && bias.dim_size(0) == n,
+                errors::InvalidArgument("bias must be a vector of ", n,
+                                        " elements, got shape ",
+                                        bias.shape().DebugString()));
+    OP_REQUIRES(
+        context,
+        output->NumElements() <= std::numeric_limits<int32>::max(),
+        errors::InvalidArgument("Output is too large for the GPU epilogue: ",
+                                output->shape().DebugString()));
+
+    auto* stream = context->op_device_context()->stream();
+    OP_REQUIRES(context, stream, errors::Internal("No GPU stream available."));
+
+    // Blas assumes column major matrices, so the row-major C = A x B is
+    // computed as the column-major C' = B' x A'.
+    const se::blas::Transpose blas_transpose_a =
+        transpose_a ? se::blas::Transpose::kTranspose
+                    : se::blas::Transpose::kNoTranspose;
+    const se::blas::Transpose blas_transpose_b =
+        transpose_b ? se::blas::Transpose::kTranspose
+                    : se::blas::Transpose::kNoTranspose;
+    auto a_ptr = AsDeviceMemory(a.template flat<T>().data());
+    auto b_ptr = AsDeviceMemory(b.template flat<T>().data());
+    auto c_ptr = AsDeviceMemory(output->template flat<T>().data());
+    bool blas_launch_status =
+        stream
+            ->ThenBlasGemm(blas_transpose_b, blas_transpose_a, n, m, k, 1.0f,
+                           b_ptr, transpose_b ? k : n, a_ptr,
+                           transpose_a ? m : k, 0.0f, &c_ptr, n)
+            .ok();
+    OP_REQUIRES(context, blas_launch_status,
+                errors::Internal("Blas GEMM launch failed: m=", m, ", n=", n,
+                                 ", k=", k));
+
+    functor::FusedMatMulBiasActivation<T>::Compute(
+        context->eigen_device<GPUDevice>(), bias.template flat<T>().data(),
+        output->template flat<T>().data(), m, n, activation,
+        fusion_args.leakyrelu_alpha);
+  }
+
+ private:
+  static se::DeviceMemory<T> AsDeviceMemory(const T* gpu_memory) {
+    se::DeviceMemoryBase wrapped(const_cast<T*>(gpu_memory));
+    se::DeviceMemory<T> typed(wrapped);
+    return typed;
+  }
+};
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 template <typename Device, typename T>
 class FusedMatMulOp : public OpKernel {
  public:
@@ -163,6 +264,14 @@ class FusedMatMulOp : public OpKernel {
           {FCT::kBiasAddWithElu, {"BiasAdd", "Elu"}},
           {FCT::kBiasAddWithLeakyRelu, {"BiasAdd", "LeakyRelu"}},
       };
+    } else if (std::is_same<Device, GPUDevice>::value) {
+      patterns = {
+          {FCT::kBiasAdd, {"BiasAdd"}},
+          {FCT::kBiasAddWithRelu, {"BiasAdd", "Relu"}},
+          {FCT::kBiasAddWithRelu6, {"BiasAdd", "Relu6"}},
+          {FCT::kBiasAddWithElu, {"BiasAdd", "Elu"}},
+          {FCT::kBiasAddWithLeakyRelu, {"BiasAdd", "LeakyRelu"}},
+      };
     }
 
     OP_REQUIRES_OK(context, InitializeFusedComputation(
@@ -239,5 +348,17 @@ TF_CALL_float(REGISTER_FUSED_CPU_MATMUL);
 
 #undef REGISTER_FUSED_CPU_MATMUL
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Registration of the GPU implementations.
+#define REGISTER_FUSED_GPU_MATMUL(T)                                  \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("_FusedMatMul").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      FusedMatMulOp<GPUDevice, T>);
+
+TF_CALL_float(REGISTER_FUSED_GPU_MATMUL);
+
+#undef REGISTER_FUSED_GPU_MATMUL
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace tensorflow
 #endif  // TENSORFLOW_CORE_KERNELS_MATMUL_OP_FUSED_H_
@@ -0,0 +1,131 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/matmul_op_fused_gpu.h"
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+namespace {
+
+template <typename T, FusedMatMulActivation kActivation>
+struct Activate {
+  __device__ static T Apply(T x, float alpha) { return x; }
+};
+
+template <typename T>
+struct Activate<T, FusedMatMulActivation::kRelu> {
+  __device__ static T Apply(T x, float alpha) {
+    return x > T(0) ? x : T(0);
+  }
+};
+
+template <typename T>
+struct Activate<T, FusedMatMulActivation::kRelu6> {
+  __device__ static T Apply(T x, float alpha) {
+    return x > T(0) ? (x < T(6) ? x : T(6)) : T(0);
+  }
+};
+
+template <typename T>
+struct Activate<T, FusedMatMulActivation::kElu> {
+  __device__ static T Apply(T x, float alpha) {
+    return x < T(0) ? Eigen::numext::expm1(x) : x;
+  }
+};
+
+template <typename T>
+struct Activate<T, FusedMatMulActivation::kLeakyRelu> {
+  __device__ static T Apply(T x, float alpha) {
+    return x < T(0) ? static_cast<T>(alpha) * x : x;
+  }
+};
+
+// The GEMM has already written the matrix product to `output`, so the epilogue
+// reads and writes every element exactly once.
+template <typename T, FusedMatMulActivation kActivation>
+__global__ void BiasActivationKernel(int32 nthreads, const T* __restrict__ bias,
+                                     T* __restrict__ output, int32 cols,
+                                     float leakyrelu_alpha) {
+  GPU_1D_KERNEL_LOOP(index, nthreads) {
+    const T value = output[index] + ldg(bias + index % cols);
+    output[index] = Activate<T, kActivation>::Apply(value, leakyrelu_alpha);
+  }
+}
+
+template <typename T, FusedMatMulActivation kActivation>
+void LaunchBiasActivation(const GPUDevice& d, const T* bias, T* output,
+                          int32 total_count, int32 cols,
+                          float leakyrelu_alpha) {
+  GpuLaunchConfig config = GetGpuLaunchConfig(total_count, d);
+  TF_CHECK_OK(GpuLaunchKernel(BiasActivationKernel<T, kActivation>,
+                              config.block_count, config.thread_per_block, 0,
+                              d.stream(), config.virtual_thread_count, bias,
+                              output, cols, leakyrelu_alpha));
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T>
+void FusedMatMulBiasActivation<T>::Compute(const GPUDevice& d, const T* bias,
+                                           T* output, int32 rows, int32 cols,
+                                           FusedMatMulActivation activation,
+                                           float leakyrelu_alpha) {
+  const int32 total_count = rows * cols;
+  if (total_count == 0) {
+    return;
+  }
+  using FMA = FusedMatMulActivation;
+  switch (activation) {
+    case FMA::kNone:
+      LaunchBiasActivation<T, FMA::kNone>(d, bias, output, total_count, cols,
+                                          leakyrelu_alpha);
+      break;
+    case FMA::kRelu:
+      LaunchBiasActivation<T, FMA::kRelu>(d, bias, output, total_count, cols,
+                                          leakyrelu_alpha);
+      break;
+    case FMA::kRelu6:
+      LaunchBiasActivation<T, FMA::kRelu6>(d, bias, output, total_count, cols,
+                                           leakyrelu_alpha);
+      break;
+    case FMA::kElu:
+      LaunchBiasActivation<T, FMA::kElu>(d, bias, output, total_count, cols,
+                                         leakyrelu_alpha);
+      break;
+    case FMA::kLeakyRelu:
+      LaunchBiasActivation<T, FMA::kLeakyRelu>(d, bias, output, total_count,
+                                               cols, leakyrelu_alpha);
+      break;
+  }
+}
+
+#define DEFINE_GPU_SPECS(T) template struct FusedMatMulBiasActivation<T>;
+
+TF_CALL_GPU_NUMBER_TYPES(DEFINE_GPU_SPECS);
+
+#undef DEFINE_GPU_SPECS
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
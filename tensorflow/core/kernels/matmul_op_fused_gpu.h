@@ -0,0 +1,55 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MATMUL_OP_FUSED_GPU_H_
+#define TENSORFLOW_CORE_KERNELS_MATMUL_OP_FUSED_GPU_H_
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Activation applied by the epilogue of the GPU _FusedMatMul.
+enum class FusedMatMulActivation {
+  kNone = 0,
+  kRelu = 1,
+  kRelu6 = 2,
+  kElu = 3,
+  kLeakyRelu = 4,
+};
+
+namespace functor {
+
+// Adds `bias` to every row of the row-major [rows, cols] matrix `output` and
+// applies `activation`, in place and in a single pass over the matrix.
+template <typename T>
+struct FusedMatMulBiasActivation {
+  static void Compute(const GPUDevice& d, const T* bias, T* output, int32 rows,
+                      int32 cols, FusedMatMulActivation activation,
+                      float leakyrelu_alpha);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#endif  // TENSORFLOW_CORE_KERNELS_MATMUL_OP_FUSED_GPU_H_
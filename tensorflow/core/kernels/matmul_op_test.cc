@@ -239,9 +239,12 @@ class FusedMatMulOpTest : public OpsTestBase {
 
   // Verifies that computing MatMul+BiasAdd+{Activation} in a graph is identical
   // to FusedMatMul.
+  // If `allow_gpu_device` is true, FusedMatMul runs on GPU when one is
+  // available, and is compared against the unfused graph on CPU.
   void VerifyConv2DWithBiasAndActivation(int m, int k, int n, bool transpose_a,
                                          bool transpose_b,
-                                         const string& activation) {
+                                         const string& activation,
+                                         bool allow_gpu_device = false) {
     const BiasAddGraphRunner run_default = [&](const Tensor& input_data,
                                                const Tensor& filter_data,
                                                const Tensor& bias_data,
@@ -255,7 +258,8 @@ class FusedMatMulOpTest : public OpsTestBase {
                                              const Tensor& bias_data,
                                              Tensor* out) {
       RunFusedMatMulOp(input_data, filter_data, {bias_data},
-                       {"BiasAdd", activation}, transpose_a, transpose_b, out);
+                       {"BiasAdd", activation}, transpose_a, transpose_b, out,
+                       allow_gpu_device);
     };
 
     VerifyBiasAddTensorsNear(m, k, n, run_default, run_fused);
@@ -327,6 +331,17 @@ TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul1x256x1WithActivation) {
   }
 }
 
+TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul256x16x64OnGpu) {
+  for (const string& activation : {"Relu", "Relu6", "Elu", "LeakyRelu"}) {
+    this->VerifyConv2DWithBiasAndActivation(256, 16, 64, false, false,
+                                            activation,
+                                            /*allow_gpu_device=*/true);
+    this->VerifyConv2DWithBiasAndActivation(256, 16, 64, true, true,
+                                            activation,
+                                            /*allow_gpu_device=*/true);
+  }
+}
+
 REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,        //
                             MatMul256x256x256,                //
                             MatMul1x256x256,                  //
@@ -335,7 +350,8 @@ REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,        //
                             MatMul256x256x256WithActivation,  //
                             MatMul1x256x256WithActivation,    //
                             MatMul256x256x1WithActivation,    //
-                            MatMul1x256x1WithActivation);
+                            MatMul1x256x1WithActivation,      //
+                            MatMul256x16x64OnGpu);
 
 // TODO(ezhulenev): Add support for more data types.
 using FusedBiasAddDataTypes = ::testing::Types<float>;
@@ -36,6 +36,59 @@ type_to_mlir = {
     "c128": "complex<f64>",
 }
 
+type_to_bytes = {
+    "i1": 1,
+    "i8": 1,
+    "ui8": 1,
+    "i16": 2,
+    "ui16": 2,
+    "f16": 2,
+    "i32": 4,
+    "ui32": 4,
+    "f32": 4,
+    "i64": 8,
+    "ui64": 8,
+    "f64": 8,
+    "c64": 8,
+    "c128": 16,
+}
+
+# AMD GPUs run 64-wide wavefronts, and their widest global memory instructions
+# load or store 16 bytes per lane.
+_ROCM_WAVEFRONT_SIZE = 64
+_ROCM_VECTOR_BYTES = 16
+_ROCM_MAX_UNROLL_FACTOR = 8
+
+def _rocm_tile_size(tile_size):
+    """Grows the innermost tile size until tiles fill whole wavefronts."""
+    separator = "x" if "x" in tile_size else ","
+    sizes = [int(size) for size in tile_size.split(separator)]
+    outer = 1
+    for size in sizes[1:]:
+        outer *= size
+
+    # Starlark has no while loops, but at most a wavefront of steps is needed.
+    inner = sizes[0]
+    for _ in range(_ROCM_WAVEFRONT_SIZE):
+        if inner * outer % _ROCM_WAVEFRONT_SIZE == 0:
+            break
+        inner += 1
+    return separator.join([str(size) for size in [inner] + sizes[1:]])
+
+def _rocm_unroll_factors(unroll_factors, type):
+    """Unrolls the innermost loop so that every lane moves a full vector.
+
+    The unrolled loads and stores are vectorized, so this picks the widest
+    memory instructions for the element type. Kernels that are not unrolled
+    are left alone.
+    """
+    if not unroll_factors:
+        return unroll_factors
+    factors = unroll_factors.split(",")
+    vector_width = _ROCM_VECTOR_BYTES // type_to_bytes.get(type, _ROCM_VECTOR_BYTES)
+    inner = max(int(factors[0]), min(vector_width, _ROCM_MAX_UNROLL_FACTOR))
+    return ",".join([str(inner)] + factors[1:])
+
 def _gen_mlir_op_impl(ctx):
     # Map attr.type to MLIR type.
     mlir_type = ctx.attr.type
@@ -161,14 +214,22 @@ def gen_kernel_library(name, types, tile_size, tags = [], unroll_factors = None,
     Args:
       name: The name of the tensorflow op.
       types: The types ("f16", "f32", "f64") for which a kernel should be generated.
-      tile_size: The tiling specification, e.g. "16x16".
-      unroll_factors: The unrolling specification, e.g. "4,4"
+      tile_size: The tiling specification, e.g. "16x16". On ROCm, the innermost
+        tile size is grown until a tile is made of whole wavefronts.
+      unroll_factors: The unrolling specification, e.g. "4,4". On ROCm, the
+        innermost factor is raised so that every lane loads 16 bytes at once.
       tags: The tags which should be added to the library.
       extra_args: Extra arguments to pass to the generator tool.
     """
 
     if cuda_gpu_architectures() or rocm_gpu_architectures():
+        gpu_archs = rocm_gpu_architectures() if rocm_is_configured() else cuda_gpu_architectures()
         for type in types:
+            type_tile_size = tile_size
+            type_unroll_factors = unroll_factors
+            if rocm_is_configured():
+                type_tile_size = _rocm_tile_size(tile_size)
+                type_unroll_factors = _rocm_unroll_factors(unroll_factors, type)
             _gen_mlir_op(
                 name = name,
                 type = type,
@@ -177,9 +238,9 @@ def gen_kernel_library(name, types, tile_size, tags = [], unroll_factors = None,
                 name = "{name}_{type}_kernel_generator".format(name = name, type = type),
                 mlir_op = "{name}_{type}.mlir".format(name = name, type = type),
                 data_type = type,
-                gpu_archs = rocm_gpu_architectures() if rocm_is_configured() else cuda_gpu_architectures(),
-                tile_size = tile_size,
-                unroll_factors = unroll_factors,
+                gpu_archs = gpu_archs,
+                tile_size = type_tile_size,
+                unroll_factors = type_unroll_factors,
                 extra_args = extra_args,
             )
 
@@ -187,10 +248,10 @@ def gen_kernel_library(name, types, tile_size, tags = [], unroll_factors = None,
             native.sh_test(
                 name = "{name}_{type}_gen_test".format(name = name, type = type),
                 srcs = ["build_test.sh"],
-                tags = ["no_rocm"],
                 args = [
                     "$(location //tensorflow/compiler/mlir/tools/kernel_gen:tf_to_kernel)",
                     "$(location {name}_{type}.mlir)".format(name = name, type = type),
+                    "--arch=%s" % ",".join(gpu_archs),
                 ],
                 size = "medium",
                 data = [
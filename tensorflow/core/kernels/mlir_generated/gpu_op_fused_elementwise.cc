@@ -0,0 +1,115 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/kernels/mlir_generated/gpu_ops_base.h"
+
+namespace tensorflow {
+
+#define GENERATE_TERNARY_FUNCTION(fused_op, mlir_type, data_type)          \
+  extern "C" UntypedUnrankedMemRefType MLIR_FUNCTION(fused_op, mlir_type)( \
+      tensorflow::OpKernelContext * ctx,                                  \
+      const ::UnrankedMemRefType<data_type>* arg1,                        \
+      const ::UnrankedMemRefType<data_type>* arg2,                        \
+      const ::UnrankedMemRefType<data_type>* arg3);
+
+GENERATE_TERNARY_FUNCTION(FusedMulAddTanh, f16, Eigen::half)
+GENERATE_TERNARY_FUNCTION(FusedMulAddTanh, f32, float)
+GENERATE_TERNARY_FUNCTION(FusedMulAddTanh, f64, double)
+
+#undef GENERATE_TERNARY_FUNCTION
+
+namespace {
+
+template <typename T>
+using TernaryFunction = UntypedUnrankedMemRefType (*)(
+    OpKernelContext*, const ::UnrankedMemRefType<T>*,
+    const ::UnrankedMemRefType<T>*, const ::UnrankedMemRefType<T>*);
+
+// The chains of elementwise ops that have a generated kernel. Every chain
+// needs a gen_kernel_library in the BUILD file and an entry below, and is
+// fused by the remapper once its kernel is registered.
+template <typename T>
+struct FusedElementwiseFunctions;
+
+#define DEFINE_FUSED_ELEMENTWISE_FUNCTIONS(mlir_type, data_type)        \
+  template <>                                                           \
+  struct FusedElementwiseFunctions<data_type> {                         \
+    static TernaryFunction<data_type> Find(                             \
+        const std::vector<string>& fused_ops) {                         \
+      if (fused_ops == std::vector<string>{"Mul", "AddV2", "Tanh"}) {   \
+        return &MLIR_FUNCTION(FusedMulAddTanh, mlir_type);              \
+      }                                                                 \
+      return nullptr;                                                   \
+    }                                                                   \
+  };
+
+DEFINE_FUSED_ELEMENTWISE_FUNCTIONS(f16, Eigen::half)
+DEFINE_FUSED_ELEMENTWISE_FUNCTIONS(f32, float)
+DEFINE_FUSED_ELEMENTWISE_FUNCTIONS(f64, double)
+
+#undef DEFINE_FUSED_ELEMENTWISE_FUNCTIONS
+
+// Runs the generated kernel of the chain of elementwise ops in `fused_ops`, so
+// that the intermediate results never leave the registers of the GPU.
+template <DataType TfDataType, typename T>
+class MlirFusedElementwiseOp
+    : public MlirUnrankedOp<TfDataType, T,
+                            MlirFusedElementwiseOp<TfDataType, T>> {
+ public:
+  explicit MlirFusedElementwiseOp(OpKernelConstruction* ctx)
+      : MlirUnrankedOp<TfDataType, T, MlirFusedElementwiseOp>(ctx) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("fused_ops", &fused_ops));
+    function_ = FusedElementwiseFunctions<T>::Find(fused_ops);
+    OP_REQUIRES(ctx, function_ != nullptr,
+                errors::Unimplemented(
+                    "No generated GPU kernel for the fused elementwise ops [",
+                    absl::StrJoin(fused_ops, ", "), "]"));
+    OP_REQUIRES(ctx, ctx->num_inputs() == 3,
+                errors::InvalidArgument(
+                    "The fused elementwise ops [",
+                    absl::StrJoin(fused_ops, ", "), "] take 3 inputs, got ",
+                    ctx->num_inputs()));
+  }
+
+  ::UnrankedMemRefType<T> Invoke(
+      OpKernelContext* ctx, llvm::ArrayRef<::UnrankedMemRefType<T>> args) {
+    return ConvertToTyped<T>(function_(ctx, &args[0], &args[1], &args[2]));
+  }
+
+ private:
+  TernaryFunction<T> function_ = nullptr;
+};
+
+}  // namespace
+
+#define REGISTER_FUSED_ELEMENTWISE_KERNEL(tf_data_type, data_type)          \
+  REGISTER_KERNEL_BUILDER(Name("_FusedElementwise")                         \
+                              .Device(DEVICE_GPU)                           \
+                              .TypeConstraint<data_type>("T"),              \
+                          MlirFusedElementwiseOp<tf_data_type, data_type>);
+
+REGISTER_FUSED_ELEMENTWISE_KERNEL(DT_HALF, Eigen::half)
+REGISTER_FUSED_ELEMENTWISE_KERNEL(DT_FLOAT, float)
+REGISTER_FUSED_ELEMENTWISE_KERNEL(DT_DOUBLE, double)
+
+#undef REGISTER_FUSED_ELEMENTWISE_KERNEL
+
+}  // namespace tensorflow
@@ -95,6 +95,10 @@ Tensor ConvertDescriptorToTensor(
   return tensor;
 }
 
+// Base class of the kernels that call an mlir-generated unranked kernel.
+// `Kernel` derives from this class and provides an `Invoke` function, either
+// static or a member function when the called kernel depends on the attributes
+// of the node.
 template <DataType TfDataType, typename OutputDataType, typename Kernel,
           typename InputDataType = OutputDataType>
 class MlirUnrankedOp : public OpKernel {
@@ -107,7 +111,7 @@ class MlirUnrankedOp : public OpKernel {
       input_descs.push_back(
           std::move(ConvertTensorToDescriptor<InputDataType>(ctx->input(i))));
     }
-    auto result_desc = Kernel::Invoke(ctx, input_descs);
+    auto result_desc = static_cast<Kernel*>(this)->Invoke(ctx, input_descs);
     for (const auto& input_desc : input_descs) {
       free(input_desc.descriptor);
     }
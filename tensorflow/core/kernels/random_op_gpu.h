@@ -135,6 +135,79 @@ class SampleCopier<int64, 2> {
   }
 };
 
+template <>
+class SampleCopier<uint32, 4> {
+ public:
+  // Copies the elements from the array to buf. buf must be 128-bit aligned,
+  // which is true for tensor data, and all offsets that are a multiple of the
+  // vector size (because the vectors are 128 bits long).
+  inline __device__ void operator()(
+      uint32* __restrict__ buf,
+      const tensorflow::random::Array<uint32, 4>& array) const {
+    uint4 vec;
+    vec.x = array[0];
+    vec.y = array[1];
+    vec.z = array[2];
+    vec.w = array[3];
+    uint4* buf_vector = reinterpret_cast<uint4*>(buf);
+    *buf_vector = vec;
+  }
+};
+
+template <>
+class SampleCopier<uint64, 2> {
+ public:
+  // Copies the elements from the array to buf. buf must be 128-bit aligned,
+  // which is true for tensor data, and all offsets that are a multiple of the
+  // vector size (because the vectors are 128 bits long).
+  inline __device__ void operator()(
+      uint64* __restrict__ buf,
+      const tensorflow::random::Array<uint64, 2>& array) const {
+    ulonglong2 vec;
+    vec.x = array[0];
+    vec.y = array[1];
+    ulonglong2* buf_vector = reinterpret_cast<ulonglong2*>(buf);
+    *buf_vector = vec;
+  }
+};
+
+template <>
+class SampleCopier<Eigen::half, 8> {
+ public:
+  // Copies the elements from the array to buf. buf must be 128-bit aligned,
+  // which is true for tensor data, and all offsets that are a multiple of the
+  // vector size (because the vectors are 128 bits long).
+  inline __device__ void operator()(
+      Eigen::half* __restrict__ buf,
+      const tensorflow::random::Array<Eigen::half, 8>& array) const {
+    uint4 vec;
+    vec.x = Pack(array[0], array[1]);
+    vec.y = Pack(array[2], array[3]);
+    vec.z = Pack(array[4], array[5]);
+    vec.w = Pack(array[6], array[7]);
+    uint4* buf_vector = reinterpret_cast<uint4*>(buf);
+    *buf_vector = vec;
+  }
+
+ private:
+  static inline __device__ uint32 Pack(Eigen::half low, Eigen::half high) {
+    return static_cast<uint32>(low.x) | (static_cast<uint32>(high.x) << 16);
+  }
+};
+
+// The number of consecutive sample groups that a thread of
+// FillPhiloxRandomKernel generates before writing them, so that groups smaller
+// than 128 bits are still written with a single vector store.
+template <typename T, int ElementCount>
+struct SampleGroupsPerStore {
+  static constexpr int kValue = 1;
+};
+
+template <>
+struct SampleGroupsPerStore<Eigen::half, 4> {
+  static constexpr int kValue = 2;
+};
+
 // A cuda kernel to fill the data with random numbers from the specified
 // distribution. Each output takes a fixed number of samples.
 template <class Distribution>
@@ -142,31 +215,45 @@ PHILOX_DEVICE_INLINE void FillPhiloxRandomKernel<Distribution, false>::Run(
     const uint64* key, const uint64* counter, random::PhiloxRandom gen, T* data,
     int64 size, Distribution dist) {
   const int kGroupSize = Distribution::kResultElementCount;
+  const int kGroupsPerStore = SampleGroupsPerStore<T, kGroupSize>::kValue;
+  const int kStoreSize = kGroupSize * kGroupsPerStore;
 
   const int32 thread_id = blockIdx.x * blockDim.x + threadIdx.x;
   const int32 total_thread_count = gridDim.x * blockDim.x;
-  int32 offset = thread_id * kGroupSize;
+  int64 offset = static_cast<int64>(thread_id) * kStoreSize;
   if (key != nullptr && counter != nullptr) {
     gen = GetPhiloxRandomFromCounterKeyMem(counter, key);
   }
-  gen.Skip(thread_id);
+  // Group i of the output always uses the i-th output of the generator, so the
+  // result does not depend on the launch configuration.
+  gen.Skip(static_cast<uint64>(thread_id) * kGroupsPerStore);
 
-  const SampleCopier<T, kGroupSize> copier;
-  while (offset + kGroupSize <= size) {
-    const typename Distribution::ResultType samples = dist(&gen);
+  const SampleCopier<T, kStoreSize> copier;
+  while (offset + kStoreSize <= size) {
+    random::Array<T, kStoreSize> samples;
+#pragma unroll
+    for (int group = 0; group < kGroupsPerStore; ++group) {
+      const typename Distribution::ResultType group_samples = dist(&gen);
+#pragma unroll
+      for (int i = 0; i < kGroupSize; ++i) {
+        samples[group * kGroupSize + i] = group_samples[i];
+      }
+    }
     copier(&data[offset], samples);
 
-    offset += total_thread_count * kGroupSize;
-    gen.Skip(total_thread_count - 1);
+    offset += static_cast<int64>(total_thread_count) * kStoreSize;
+    gen.Skip(static_cast<uint64>(total_thread_count - 1) * kGroupsPerStore);
   }
 
-  typename Distribution::ResultType samples = dist(&gen);
-  for (int i = 0; i < kGroupSize; ++i) {
-    if (offset >= size) {
-      return;
+  for (int group = 0; group < kGroupsPerStore; ++group) {
+    typename Distribution::ResultType samples = dist(&gen);
+    for (int i = 0; i < kGroupSize; ++i) {
+      if (offset >= size) {
+        return;
+      }
+      data[offset] = samples[i];
+      ++offset;
     }
-    data[offset] = samples[i];
-    ++offset;
   }
 }
 
@@ -193,6 +280,7 @@ PHILOX_DEVICE_INLINE void FillPhiloxRandomKernel<Distribution, true>::Run(
   if (key != nullptr && counter != nullptr) {
     base_gen = GetPhiloxRandomFromCounterKeyMem(counter, key);
   }
+  const SampleCopier<T, kGroupSize> copier;
   while (offset < size) {
     // Since each output takes a variable number of samples, we need to
     // realign the generator to the beginning for the current output group
@@ -202,12 +290,17 @@ PHILOX_DEVICE_INLINE void FillPhiloxRandomKernel<Distribution, true>::Run(
 
     typename Distribution::ResultType samples = dist(&single_samples);
 
-    for (int i = 0; i < kGroupSize; ++i) {
-      if (offset >= size) {
-        return;
+    if (offset + kGroupSize <= size) {
+      copier(&data[offset], samples);
+      offset += kGroupSize;
+    } else {
+      for (int i = 0; i < kGroupSize; ++i) {
+        if (offset >= size) {
+          return;
+        }
+        data[offset] = samples[i];
+        ++offset;
       }
-      data[offset] = samples[i];
-      ++offset;
     }
 
     offset += (total_thread_count - 1) * kGroupSize;
@@ -215,9 +308,17 @@ PHILOX_DEVICE_INLINE void FillPhiloxRandomKernel<Distribution, true>::Run(
   }
 }
 
+#if TENSORFLOW_USE_ROCM
+// Blocks of 1024 threads limit each thread to a quarter of the vector
+// registers of a SIMD on AMD GPUs, which makes the Philox rounds spill.
+constexpr int kFillPhiloxRandomMaxBlockSize = 256;
+#else
+constexpr int kFillPhiloxRandomMaxBlockSize = 1024;
+#endif
+
 // A simple launch pad to call the correct function templates to fill the data
 template <class Distribution>
-__global__ void __launch_bounds__(1024)
+__global__ void __launch_bounds__(kFillPhiloxRandomMaxBlockSize)
     FillPhiloxRandomKernelLaunch(const uint64* key, const uint64* counter,
                                  random::PhiloxRandom base_gen,
                                  typename Distribution::ResultElementType* data,
@@ -235,7 +336,8 @@ void FillPhiloxRandom<GPUDevice, Distribution>::operator()(
     typename Distribution::ResultElementType* data, int64 size,
     Distribution dist) {
   if (size == 0) return;
-  const int32 block_size = d.maxGpuThreadsPerBlock();
+  const int32 block_size =
+      std::min(d.maxGpuThreadsPerBlock(), kFillPhiloxRandomMaxBlockSize);
   const int32 num_blocks =
       std::min<int64>(
           d.getNumGpuMultiProcessors() * d.maxGpuThreadsPerMultiProcessor(),
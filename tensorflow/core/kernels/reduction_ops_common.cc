@@ -57,6 +57,31 @@ gtl::InlinedVector<int32, 8> ReductionHelper::permutation() {
   return perm;
 }
 
+bool ReductionHelper::OuterReduceInner(int64* outer, int64* reduce,
+                                       int64* inner) const {
+  const int dims = data_reshape_.size();
+  if (dims == 1 && reduce_first_axis_) {
+    *outer = 1;
+    *reduce = data_reshape_[0];
+    *inner = 1;
+  } else if (dims == 2 && reduce_first_axis_) {
+    *outer = 1;
+    *reduce = data_reshape_[0];
+    *inner = data_reshape_[1];
+  } else if (dims == 2) {
+    *outer = data_reshape_[0];
+    *reduce = data_reshape_[1];
+    *inner = 1;
+  } else if (dims == 3 && !reduce_first_axis_) {
+    *outer = data_reshape_[0];
+    *reduce = data_reshape_[1];
+    *inner = data_reshape_[2];
+  } else {
+    return false;
+  }
+  return true;
+}
+
 template <typename Tperm>
 Status SimplifyHelper(const Tensor& data, const Tensor& axis,
                       gtl::InlinedVector<bool, 4>& bitmap) {
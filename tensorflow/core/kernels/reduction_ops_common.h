@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -118,6 +119,11 @@ class ReductionHelper {
   // Permutation of reduced dims needed to put reduction dimensions at the end
   gtl::InlinedVector<int32, 8> permutation();
 
+  // Views the reduction as one of a [outer, reduce, inner] tensor along its
+  // middle dimension. Returns false if the reshaped input has more runs of
+  // reduced and unreduced dimensions than that.
+  bool OuterReduceInner(int64* outer, int64* reduce, int64* inner) const;
+
  private:
   bool reduce_first_axis_;  // True if need to reduce the 0-th dimension.
   gtl::InlinedVector<int64, 4> data_reshape_;  // Reshape data before reduction.
@@ -125,6 +131,218 @@ class ReductionHelper {
   gtl::InlinedVector<int64, 4> out_reshape_;   // Reshape output for reduction.
 };
 
+namespace functor {
+
+// Describes how the CPU reduction engine computes Reducer: the inputs are cast
+// to Accum and combined with the Eigen reducer BaseReducer, and Finalize turns
+// the combination of `count` inputs into the output.
+template <typename Reducer>
+struct CpuReductionTraits {
+  static constexpr bool kSupported = false;
+};
+
+template <typename T, typename AccumT, typename BaseReducerT>
+struct CpuReductionTraitsBase {
+  static constexpr bool kSupported = true;
+  typedef AccumT Accum;
+  typedef BaseReducerT BaseReducer;
+  static T Finalize(Accum accum, int64 count) {
+    return static_cast<T>(accum);
+  }
+};
+
+template <typename T, typename AccumT>
+struct CpuMeanReductionTraits
+    : CpuReductionTraitsBase<T, AccumT, Eigen::internal::SumReducer<AccumT>> {
+  static T Finalize(AccumT accum, int64 count) {
+    return static_cast<T>(accum / static_cast<AccumT>(count));
+  }
+};
+
+#define CPU_REDUCTION_TRAITS(T, AccumT)                                     \
+  template <>                                                               \
+  struct CpuReductionTraits<Eigen::internal::SumReducer<T>>                 \
+      : CpuReductionTraitsBase<T, T, Eigen::internal::SumReducer<T>> {};    \
+  template <>                                                               \
+  struct CpuReductionTraits<                                                \
+      Eigen::internal::MaxReducer<T, Eigen::PropagateNaN>>                  \
+      : CpuReductionTraitsBase<                                             \
+            T, T, Eigen::internal::MaxReducer<T, Eigen::PropagateNaN>> {};  \
+  template <>                                                               \
+  struct CpuReductionTraits<MeanReducer<T>>                                 \
+      : CpuMeanReductionTraits<T, AccumT> {};
+
+CPU_REDUCTION_TRAITS(float, float);
+CPU_REDUCTION_TRAITS(double, double);
+CPU_REDUCTION_TRAITS(int32, int64);
+CPU_REDUCTION_TRAITS(int64, int64);
+#undef CPU_REDUCTION_TRAITS
+
+template <>
+struct CpuReductionTraits<Eigen::internal::AndReducer>
+    : CpuReductionTraitsBase<bool, bool, Eigen::internal::AndReducer> {};
+template <>
+struct CpuReductionTraits<Eigen::internal::OrReducer>
+    : CpuReductionTraitsBase<bool, bool, Eigen::internal::OrReducer> {};
+
+// Reduces the `size` contiguous values at `in` with Eigen's vectorized full
+// reduction, on the calling thread.
+template <typename T, typename Accum, typename BaseReducer>
+Accum ReduceContiguous(const T* in, int64 size) {
+  typename TTypes<T, 1>::UnalignedConstTensor values(in, size);
+  Accum result;
+  typename TTypes<Accum, 0>::UnalignedTensor result_tensor(&result);
+  Constants<Eigen::DefaultDevice> constants;
+  result_tensor = values.template cast<Accum>().reduce(constants.kZero,
+                                                        BaseReducer());
+  return result;
+}
+
+// Reduces the `size` contiguous values at `in` into the `size` accumulators
+// at `accum`, elementwise. The specialization below uses the packet
+// operations of the reducer when the inputs need no cast.
+template <typename T, typename Accum, typename BaseReducer,
+          bool kVectorize = std::is_same<T, Accum>::value &&
+                            Eigen::internal::reducer_traits<
+                                BaseReducer,
+                                Eigen::DefaultDevice>::PacketAccess>
+struct AccumulateRow {
+  static void Run(const BaseReducer& reducer, const T* in, int64 size,
+                  Accum* accum) {
+    for (int64 i = 0; i < size; ++i) {
+      reducer.reduce(static_cast<Accum>(in[i]), &accum[i]);
+    }
+  }
+};
+
+template <typename T, typename BaseReducer>
+struct AccumulateRow<T, T, BaseReducer, true> {
+  static void Run(const BaseReducer& reducer, const T* in, int64 size,
+                  T* accum) {
+    typedef typename Eigen::internal::packet_traits<T>::type Packet;
+    constexpr int64 kPacketSize =
+        Eigen::internal::unpacket_traits<Packet>::size;
+    int64 i = 0;
+    for (; i + kPacketSize <= size; i += kPacketSize) {
+      Packet packet = Eigen::internal::ploadu<Packet>(accum + i);
+      reducer.reducePacket(Eigen::internal::ploadu<Packet>(in + i), &packet);
+      Eigen::internal::pstoreu(accum + i, packet);
+    }
+    for (; i < size; ++i) {
+      reducer.reduce(in[i], &accum[i]);
+    }
+  }
+};
+
+// Reduces `in`, viewed as a [outer, reduce, inner] tensor, along its middle
+// dimension into `out`, viewed as [outer, inner], on the CPU worker threads.
+//
+// The units of work are blocks of up to kInnerBlock adjacent outputs. Rows
+// (inner == 1) are reduced with Eigen's vectorized full reduction, and
+// columns by accumulating whole input rows of the block at once. When there
+// are fewer units than threads, e.g. for a global sum, the reduced dimension
+// is also split into chunks whose partial results are combined at the end.
+template <typename T, typename Reducer>
+void ReduceOuterReduceInner(OpKernelContext* ctx, const T* in, int64 outer,
+                            int64 reduce, int64 inner, T* out) {
+  typedef CpuReductionTraits<Reducer> Traits;
+  typedef typename Traits::Accum Accum;
+  typedef typename Traits::BaseReducer BaseReducer;
+  static constexpr int64 kInnerBlock = 256;
+  static constexpr int64 kMinChunkSize = 16384;
+
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *(ctx->device()->tensorflow_cpu_worker_threads());
+  const int64 block = std::min(inner, kInnerBlock);
+  const int64 num_blocks = (inner + block - 1) / block;
+  const int64 num_units = outer * num_blocks;
+  int64 num_chunks = 1;
+  if (num_units < worker_threads.num_threads) {
+    num_chunks = std::min(
+        (2 * worker_threads.num_threads + num_units - 1) / num_units,
+        std::max<int64>(1, reduce * block / kMinChunkSize));
+  }
+  const int64 chunk_size = (reduce + num_chunks - 1) / num_chunks;
+  num_chunks = (reduce + chunk_size - 1) / chunk_size;
+  const int64 num_outputs = outer * inner;
+  std::vector<Accum> partials(num_chunks > 1 ? num_chunks * num_outputs : 0);
+
+  auto work = [&](int64 begin, int64 end) {
+    BaseReducer reducer;
+    Accum accum[kInnerBlock];
+    for (int64 unit = begin; unit < end; ++unit) {
+      const int64 chunk = unit / num_units;
+      const int64 o = (unit % num_units) / num_blocks;
+      const int64 i_begin = (unit % num_blocks) * block;
+      const int64 width = std::min(block, inner - i_begin);
+      const int64 r_begin = chunk * chunk_size;
+      const int64 r_end = std::min(reduce, r_begin + chunk_size);
+      const T* values = in + (o * reduce + r_begin) * inner + i_begin;
+      if (inner == 1) {
+        accum[0] = ReduceContiguous<T, Accum, BaseReducer>(values,
+                                                           r_end - r_begin);
+      } else {
+        std::fill(accum, accum + width, reducer.initialize());
+        for (int64 r = r_begin; r < r_end; ++r, values += inner) {
+          AccumulateRow<T, Accum, BaseReducer>::Run(reducer, values, width,
+                                                    accum);
+        }
+      }
+      const int64 out_begin = o * inner + i_begin;
+      if (num_chunks == 1) {
+        for (int64 i = 0; i < width; ++i) {
+          out[out_begin + i] =
+              Traits::Finalize(reducer.finalize(accum[i]), reduce);
+        }
+      } else {
+        std::copy(accum, accum + width,
+                  partials.begin() + chunk * num_outputs + out_begin);
+      }
+    }
+  };
+  const double cost_per_unit =
+      chunk_size * block *
+      (Eigen::TensorOpCost::AddCost<Accum>() + sizeof(T));
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        num_chunks * num_units, cost_per_unit, work);
+
+  if (num_chunks > 1) {
+    // There are fewer outputs than threads, so combining the partial results
+    // of the chunks is cheap.
+    BaseReducer reducer;
+    for (int64 j = 0; j < num_outputs; ++j) {
+      Accum accum = partials[j];
+      for (int64 chunk = 1; chunk < num_chunks; ++chunk) {
+        reducer.reduce(partials[chunk * num_outputs + j], &accum);
+      }
+      out[j] = Traits::Finalize(reducer.finalize(accum), reduce);
+    }
+  }
+}
+
+// Runs the CPU reduction engine where it supports the device and the reducer,
+// and returns false elsewhere.
+template <typename Device, typename T, typename Reducer, typename Enable = void>
+struct ReduceOuterReduceInnerFunctor {
+  static bool Run(OpKernelContext* ctx, const T* in, int64 outer, int64 reduce,
+                  int64 inner, T* out) {
+    return false;
+  }
+};
+
+template <typename T, typename Reducer>
+struct ReduceOuterReduceInnerFunctor<
+    CPUDevice, T, Reducer,
+    typename std::enable_if<CpuReductionTraits<Reducer>::kSupported>::type> {
+  static bool Run(OpKernelContext* ctx, const T* in, int64 outer, int64 reduce,
+                  int64 inner, T* out) {
+    ReduceOuterReduceInner<T, Reducer>(ctx, in, outer, reduce, inner, out);
+    return true;
+  }
+};
+
+}  // namespace functor
+
 // For operations where the output is a reduction function along some
 // dimensions of the input.
 template <typename Device, class T, typename Tperm, typename Reducer>
@@ -167,6 +385,9 @@ class ReductionOp : public OpKernel {
 
     Tensor tmp_out;
     typedef functor::ReduceFunctor<Device, Reducer> Functor;
+    typedef functor::ReduceOuterReduceInnerFunctor<Device, T, Reducer>
+        OuterReduceInnerFunctor;
+    int64 outer, reduce, inner;
     Constants<Device> constants;
     const Device& d = ctx->eigen_device<Device>();
     Reducer reducer;
@@ -194,6 +415,11 @@ class ReductionOp : public OpKernel {
         // 3)), [0]). Eigen sometimes crashes in this case, so we do it
         // manually.
         Functor::FillIdentity(d, tmp_out.flat<T>(), reducer);
+      } else if (helper.OuterReduceInner(&outer, &reduce, &inner) &&
+                 OuterReduceInnerFunctor::Run(ctx, data.flat<T>().data(),
+                                              outer, reduce, inner,
+                                              tmp_out.flat<T>().data())) {
+        // Reduced by the CPU reduction engine.
       } else if ((helper.ndims() == 1) && helper.reduce_first_axis()) {
         // Reduce to a scalar.
         Functor::Reduce(ctx, helper.out<T, 0>(&tmp_out), helper.in<T, 1>(data),
@@ -230,9 +456,13 @@ class ReductionOp : public OpKernel {
         const int64 unreduced = tmp_out.NumElements();
         const int64 reduced = shuffled.NumElements() / unreduced;
         const Tensor& const_shuffled = shuffled;
-        Functor::Reduce(ctx, tmp_out.flat<T>(),
-                        const_shuffled.shaped<T, 2>({unreduced, reduced}),
-                        constants.kOne, reducer);
+        if (!OuterReduceInnerFunctor::Run(ctx, const_shuffled.flat<T>().data(),
+                                          unreduced, reduced, 1,
+                                          tmp_out.flat<T>().data())) {
+          Functor::Reduce(ctx, tmp_out.flat<T>(),
+                          const_shuffled.shaped<T, 2>({unreduced, reduced}),
+                          constants.kOne, reducer);
+        }
       }
     }
 
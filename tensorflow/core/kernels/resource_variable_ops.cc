@@ -630,12 +630,14 @@ class ResourceGatherOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
     // reference count greater than one and make a copy of the
-    // (potentially very large) tensor buffer.
+    // (potentially very large) tensor buffer. Since the gather does not
+    // alias the buffer, it is safe in both access modes and does not switch
+    // the variable to copy-on-read mode, which would make every later dense
+    // read copy the whole variable.
     tf_shared_lock ml(*v->mu());
     const Tensor& params = *v->tensor();
     const Tensor& indices = c->input(1);
@@ -796,12 +798,14 @@ class ResourceGatherNdOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
     // reference count greater than one and make a copy of the
-    // (potentially very large) tensor buffer.
+    // (potentially very large) tensor buffer. Since the gather does not
+    // alias the buffer, it is safe in both access modes and does not switch
+    // the variable to copy-on-read mode, which would make every later dense
+    // read copy the whole variable.
     tf_shared_lock ml(*v->mu());
     const Tensor& params = *v->tensor();
     const Tensor& indices = c->input(1);
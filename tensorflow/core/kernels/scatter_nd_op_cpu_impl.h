@@ -20,7 +20,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
+#include <functional>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -102,6 +105,10 @@ class UpdateExecutor<T, Input, Update, Output, scatter_nd_op::UpdateOp::MAX> {
 
 namespace functor {
 
+// Scatters that update at least this many elements in total are applied by
+// all the threads of the device.
+constexpr int64 kParallelScatterNdMinElements = 1 << 15;
+
 // Implementation of update functor for CPU.
 template <typename T, typename Index, scatter_nd_op::UpdateOp OP, int IXDIM>
 struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
@@ -112,10 +119,6 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
       typename TTypes<Index, 2>::ConstTensor Tindices,
       typename TTypes<T, 2>::ConstTensor Tupdates,
       typename TTypes<T, 2>::Tensor Toutput) {
-    // error_loc is -1 if there's no out-of-bounds index,
-    // otherwise it is the location of an OOB index in Tindices.
-    Index error_loc = -1;
-
     const Eigen::DenseIndex batch_size = Tindices.dimension(0);
 
     Index batch_strides[IXDIM];
@@ -128,7 +131,28 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
       }
     }
 
-    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+    if (batch_size > 1 && d.numThreads() > 1 &&
+        Toutput.dimension(0) > 1 &&
+        batch_size * slice_size >= kParallelScatterNdMinElements) {
+      return ParallelExecute(d, output_shape_prefix, batch_strides, Tindices,
+                             Tupdates, Toutput);
+    }
+    return SerialExecute(d, batch_size, output_shape_prefix, batch_strides,
+                         Tindices, Tupdates, Toutput);
+  }
+
+ private:
+  // Applies the first `num_updates` updates in order. Returns -1 if there's
+  // no out-of-bounds index, otherwise the location of the first OOB index in
+  // Tindices, in which case only the updates before it are applied.
+  static Index SerialExecute(
+      const CPUDevice& d, const Eigen::DenseIndex num_updates,
+      const Eigen::array<Eigen::DenseIndex, IXDIM>& output_shape_prefix,
+      const Index* batch_strides,
+      typename TTypes<Index, 2>::ConstTensor Tindices,
+      typename TTypes<T, 2>::ConstTensor Tupdates,
+      typename TTypes<T, 2>::Tensor Toutput) {
+    for (Eigen::DenseIndex loc = 0; loc < num_updates; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
       for (int dim = 0; dim < IXDIM; ++dim) {
@@ -137,20 +161,128 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
         i += ix_d * batch_strides[dim];
       }
       if (TF_PREDICT_FALSE(out_of_bounds)) {
-        error_loc = loc;
-        break;
-      } else {
-        auto input_chip = Toutput.template chip<0>(i);
+        return loc;
+      }
+      auto input_chip = Toutput.template chip<0>(i);
+      auto output_chip = input_chip;
+      auto update_chip = Tupdates.template chip<0>(loc);
+      update_executor::UpdateExecutor<
+          CPUDevice, decltype(input_chip), decltype(update_chip),
+          decltype(output_chip), OP>::Execute(d, input_chip, update_chip,
+                                              output_chip);
+    }
+    return -1;
+  }
+
+  // Applies the updates with all the threads of `d`, with the same result as
+  // SerialExecute. The slices of the output are split into one contiguous
+  // range per thread, and the updates are bucketed by the range they target,
+  // keeping their order. Every thread then applies the updates of its range
+  // in order, so no two threads write the same slice and repeated indices
+  // are applied in the same order as in the serial path, which matters for
+  // non-commutative updates such as ASSIGN.
+  static Index ParallelExecute(
+      const CPUDevice& d,
+      const Eigen::array<Eigen::DenseIndex, IXDIM>& output_shape_prefix,
+      const Index* batch_strides,
+      typename TTypes<Index, 2>::ConstTensor Tindices,
+      typename TTypes<T, 2>::ConstTensor Tupdates,
+      typename TTypes<T, 2>::Tensor Toutput) {
+    const Eigen::DenseIndex batch_size = Tindices.dimension(0);
+    const Eigen::DenseIndex slice_size = Tupdates.dimension(1);
+    const Eigen::DenseIndex num_slices = Toutput.dimension(0);
+    const int num_ranges = static_cast<int>(
+        std::min<Eigen::DenseIndex>(d.numThreads(), num_slices));
+    const Eigen::DenseIndex slices_per_range =
+        (num_slices + num_ranges - 1) / num_ranges;
+    // The updates are split into as many contiguous chunks as there are
+    // ranges for bucketing.
+    const Eigen::DenseIndex chunk_size =
+        (batch_size + num_ranges - 1) / num_ranges;
+    auto for_each_chunk = [&d, num_ranges](
+                              double cost_per_chunk,
+                              const std::function<void(int)>& fn) {
+      d.parallelFor(num_ranges,
+                    Eigen::TensorOpCost(0, 0, cost_per_chunk),
+                    [&fn](Eigen::Index begin, Eigen::Index end) {
+                      for (Eigen::Index i = begin; i < end; ++i) fn(i);
+                    });
+    };
+
+    // Flatten the indices, reading each of them only once, and count the
+    // updates of every chunk that target every range.
+    std::vector<Index> slices(batch_size);
+    std::vector<Eigen::DenseIndex> offsets(num_ranges * num_ranges, 0);
+    std::atomic<Eigen::DenseIndex> error_loc(batch_size);
+    for_each_chunk(chunk_size * IXDIM * 4, [&](int chunk) {
+      const Eigen::DenseIndex begin = chunk * chunk_size;
+      const Eigen::DenseIndex end = std::min(batch_size, begin + chunk_size);
+      Eigen::DenseIndex* counts = &offsets[chunk * num_ranges];
+      for (Eigen::DenseIndex loc = begin; loc < end; ++loc) {
+        Index i = 0;
+        bool out_of_bounds = false;
+        for (int dim = 0; dim < IXDIM; ++dim) {
+          const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+          out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+          i += ix_d * batch_strides[dim];
+        }
+        if (TF_PREDICT_FALSE(out_of_bounds)) {
+          Eigen::DenseIndex current = error_loc.load();
+          while (loc < current &&
+                 !error_loc.compare_exchange_weak(current, loc)) {
+          }
+          return;
+        }
+        slices[loc] = i;
+        ++counts[i / slices_per_range];
+      }
+    });
+    if (TF_PREDICT_FALSE(error_loc.load() < batch_size)) {
+      // Like the serial path, apply the updates before the first OOB index.
+      return SerialExecute(d, error_loc.load(), output_shape_prefix,
+                           batch_strides, Tindices, Tupdates, Toutput);
+    }
+
+    // Bucket the updates by range, in order.
+    std::vector<Eigen::DenseIndex> range_starts(num_ranges + 1);
+    Eigen::DenseIndex offset = 0;
+    for (int range = 0; range < num_ranges; ++range) {
+      range_starts[range] = offset;
+      for (int chunk = 0; chunk < num_ranges; ++chunk) {
+        Eigen::DenseIndex& chunk_offset = offsets[chunk * num_ranges + range];
+        const Eigen::DenseIndex count = chunk_offset;
+        chunk_offset = offset;
+        offset += count;
+      }
+    }
+    range_starts[num_ranges] = batch_size;
+    std::vector<Eigen::DenseIndex> order(batch_size);
+    for_each_chunk(chunk_size * 2, [&](int chunk) {
+      const Eigen::DenseIndex begin = chunk * chunk_size;
+      const Eigen::DenseIndex end = std::min(batch_size, begin + chunk_size);
+      Eigen::DenseIndex* next = &offsets[chunk * num_ranges];
+      for (Eigen::DenseIndex loc = begin; loc < end; ++loc) {
+        order[next[slices[loc] / slices_per_range]++] = loc;
+      }
+    });
+
+    // Apply the updates of every range. The slices are updated on the
+    // calling thread of each range, rather than through `d`.
+    for_each_chunk(chunk_size * slice_size * 2, [&](int range) {
+      const Eigen::DefaultDevice device;
+      for (Eigen::DenseIndex k = range_starts[range];
+           k < range_starts[range + 1]; ++k) {
+        const Eigen::DenseIndex loc = order[k];
+        auto input_chip = Toutput.template chip<0>(slices[loc]);
         auto output_chip = input_chip;
         auto update_chip = Tupdates.template chip<0>(loc);
         update_executor::UpdateExecutor<
-            CPUDevice, decltype(input_chip), decltype(update_chip),
-            decltype(output_chip), OP>::Execute(d, input_chip, update_chip,
-                                                output_chip);
+            Eigen::DefaultDevice, decltype(input_chip), decltype(update_chip),
+            decltype(output_chip), OP>::Execute(device, input_chip,
+                                                update_chip, output_chip);
       }
-    }
-
-    return error_loc;
+    });
+    return -1;
   }
 };
 
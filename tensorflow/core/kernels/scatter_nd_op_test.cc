@@ -174,6 +174,60 @@ TEST_F(ScatterNdUpdateOpTest, HigherRank) {
   test::ExpectTensorEqual<float>(expected, params_tensor);
 }
 
+TEST_F(ScatterNdUpdateOpTest, LargeWithRepeatedIndices) {
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+
+  // Large enough to be applied in parallel. Every row is updated several
+  // times, and the last update must win as in the serial path.
+  const int kRows = 1000;
+  const int kCols = 64;
+  const int kNumUpdates = 4096;
+  std::vector<float> params(kRows * kCols, 0);
+  std::vector<int32> indices(kNumUpdates);
+  std::vector<float> updates(kNumUpdates * kCols);
+  std::vector<float> expected_values(kRows * kCols, 0);
+  for (int k = 0; k < kNumUpdates; ++k) {
+    indices[k] = (k * 7) % kRows;
+    for (int j = 0; j < kCols; ++j) {
+      updates[k * kCols + j] = k;
+      expected_values[indices[k] * kCols + j] = k;
+    }
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), params);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates, 1}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor params_tensor = *mutable_input(0).tensor;
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, params_tensor);
+}
+
+TEST_F(ScatterNdUpdateOpTest, Error_LargeIndexOutOfRange) {
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+
+  // The first out-of-bounds index is reported, as in the serial path.
+  const int kRows = 1000;
+  const int kCols = 64;
+  const int kNumUpdates = 4096;
+  std::vector<int32> indices(kNumUpdates);
+  for (int k = 0; k < kNumUpdates; ++k) {
+    indices[k] = k % kRows;
+  }
+  indices[3000] = 1234;
+  indices[2000] = 1001;
+  AddInputFromArray<float>(TensorShape({kRows, kCols}),
+                           std::vector<float>(kRows * kCols, 0));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates, 1}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}),
+                           std::vector<float>(kNumUpdates * kCols, 1));
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(
+      s.ToString(), "indices[2000] = [1001] does not index into shape"))
+      << s;
+}
+
 TEST_F(ScatterNdUpdateOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/status.h"
 
 namespace tensorflow {
 
@@ -56,6 +57,41 @@ struct SegmentReductionFunctor {
                   typename TTypes<T, 2>::Tensor output);
 };
 
+// Functor for the GPU SparseSegmentSum, SparseSegmentMean and
+// SparseSegmentSqrtN ops. The rows of 'input' selected by 'indices' are
+// gathered and reduced into their segments in a single pass, so the gathered
+// rows are never materialized.
+// is_mean: whether to divide each segment by the number of its rows.
+// is_sqrtn: whether to divide each segment by the square root of the number of
+//           its rows.
+// input: input data reshaped to {input_rows, cols}.
+// indices: rows of 'input' to reduce.
+// segment_ids: sorted map from 'indices' to output segments.
+// output: output reshaped to {output_rows, cols}. Segments that no index maps
+//         to are set to zero.
+template <typename T, typename Index, typename SegmentId>
+struct SparseSegmentReductionFunctor {
+  Status operator()(OpKernelContext* context, bool is_mean, bool is_sqrtn,
+                    typename TTypes<T, 2>::ConstTensor input,
+                    typename TTypes<Index>::ConstVec indices,
+                    typename TTypes<SegmentId>::ConstVec segment_ids,
+                    typename TTypes<T, 2>::Tensor output);
+};
+
+// Functor for the GPU SparseSegmentMeanGrad and SparseSegmentSqrtNGrad ops.
+// Scatters each segment of 'input', scaled by the inverse of the segment size
+// (or its square root), into the rows of 'output' selected by 'indices'.
+// input: incoming gradient reshaped to {num_segments, cols}.
+// output: gradient reshaped to {output_dim0, cols}.
+template <typename T, typename Index, typename SegmentId>
+struct SparseSegmentGradFunctor {
+  Status operator()(OpKernelContext* context, bool is_sqrtn,
+                    typename TTypes<T, 2>::ConstTensor input,
+                    typename TTypes<Index>::ConstVec indices,
+                    typename TTypes<SegmentId>::ConstVec segment_ids,
+                    typename TTypes<T, 2>::Tensor output);
+};
+
 #endif
 
 template <typename Device, typename T, typename Index, typename InitialValueF,
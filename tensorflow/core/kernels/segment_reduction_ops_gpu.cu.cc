@@ -24,6 +24,8 @@ limitations under the License.
 // clang-format on
 
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/util/gpu_device_functions.h"
 
@@ -126,6 +128,120 @@ __global__ void UnsortedSegmentCustomKernel(
   }
 }
 
+// SparseSegmentSumKernel reduces the rows of 'input' selected by 'indices'
+// into the segments given by the sorted 'segment_ids'. It partitions the work
+// into stripes like SortedSegmentReductionCustomKernel, except that each input
+// row is read through 'indices', so the gathered rows are never written to
+// global memory. Out-of-range indices contribute nothing and out-of-range
+// segment ids are dropped.
+template <typename T, typename Index, typename SegmentId, int OuterDimTileSize>
+__global__ void SparseSegmentSumKernel(
+    const Index input_outer_dim_size, const int64 inner_dim_size,
+    const int64 num_indices, const SegmentId output_outer_dim_size,
+    const Index* __restrict__ indices,
+    const SegmentId* __restrict__ segment_ids, const T* __restrict__ input,
+    T* __restrict__ output, const int64 total_stripe_count) {
+  for (int64 stripe_index : GpuGridRangeX(total_stripe_count)) {
+    const int64 segment_offset = stripe_index % inner_dim_size;
+    const int64 indices_base =
+        stripe_index / inner_dim_size * int64(OuterDimTileSize);
+    const int64 actual_stripe_height =
+        min(int64(OuterDimTileSize), num_indices - indices_base);
+
+    T reduce_res = T(0);
+    const SegmentId first_segment_id = ldg(segment_ids + indices_base);
+    SegmentId last_segment_id = first_segment_id;
+    for (int64 j = 0; j < actual_stripe_height; j++) {
+      const SegmentId segment_id = ldg(segment_ids + indices_base + j);
+      // Only the first and the last segment of a stripe can be shared with
+      // other stripes, so the segments in between are written without atomics.
+      if (segment_id != last_segment_id) {
+        if (FastBoundsCheck(last_segment_id, output_outer_dim_size)) {
+          T* dest = output + last_segment_id * inner_dim_size + segment_offset;
+          if (last_segment_id == first_segment_id) {
+            GpuAtomicAdd(dest, reduce_res);
+          } else {
+            *dest += reduce_res;
+          }
+        }
+        reduce_res = T(0);
+        last_segment_id = segment_id;
+      }
+      const Index input_row = ldg(indices + indices_base + j);
+      if (FastBoundsCheck(input_row, input_outer_dim_size)) {
+        reduce_res += ldg(input + input_row * inner_dim_size + segment_offset);
+      }
+    }
+    if (FastBoundsCheck(last_segment_id, output_outer_dim_size)) {
+      GpuAtomicAdd(output + last_segment_id * inner_dim_size + segment_offset,
+                   reduce_res);
+    }
+  }
+}
+
+// Divides each non-empty output segment by its size, or by the square root of
+// its size if 'is_sqrtn' is set. Segment sizes are found by binary search in
+// the sorted 'segment_ids'.
+template <typename T, typename SegmentId>
+__global__ void SparseSegmentNormalizeKernel(
+    const SegmentId output_outer_dim_size, const int64 inner_dim_size,
+    const int64 num_indices, const SegmentId* __restrict__ segment_ids,
+    const bool is_sqrtn, T* __restrict__ output) {
+  for (int64 index : GpuGridRangeX(output_outer_dim_size * inner_dim_size)) {
+    const SegmentId segment_id = index / inner_dim_size;
+    const int64 segment_size =
+        gpu_helper::upper_bound(segment_ids, num_indices, segment_id) -
+        gpu_helper::lower_bound(segment_ids, num_indices, segment_id);
+    if (segment_size > 1) {
+      output[index] /= is_sqrtn ? T(sqrt(static_cast<double>(segment_size)))
+                                : T(static_cast<double>(segment_size));
+    }
+  }
+}
+
+// Computes the factor by which the gradient of each segment is scaled: the
+// inverse of the segment size, or of its square root if 'is_sqrtn' is set.
+template <typename T, typename SegmentId>
+__global__ void SparseSegmentGradScalesKernel(
+    const SegmentId num_segments, const int64 num_indices,
+    const SegmentId* __restrict__ segment_ids, const bool is_sqrtn,
+    T* __restrict__ scales) {
+  for (SegmentId segment_id : GpuGridRangeX(num_segments)) {
+    const int64 segment_size = max(
+        gpu_helper::upper_bound(segment_ids, num_indices, segment_id) -
+            gpu_helper::lower_bound(segment_ids, num_indices, segment_id),
+        int64(1));
+    scales[segment_id] =
+        is_sqrtn ? T(1.0 / sqrt(static_cast<double>(segment_size)))
+                 : T(1.0 / static_cast<double>(segment_size));
+  }
+}
+
+// Adds each scaled segment of the incoming gradient to the rows of 'output'
+// selected by 'indices'. Pairs with an out-of-range index or segment id are
+// skipped.
+template <typename T, typename Index, typename SegmentId>
+__global__ void SparseSegmentGradKernel(
+    const SegmentId num_segments, const int64 inner_dim_size,
+    const int64 num_indices, const Index output_outer_dim_size,
+    const Index* __restrict__ indices,
+    const SegmentId* __restrict__ segment_ids, const T* __restrict__ scales,
+    const T* __restrict__ input, T* __restrict__ output) {
+  for (int64 index : GpuGridRangeX(num_indices * inner_dim_size)) {
+    const int64 indices_index = index / inner_dim_size;
+    const int64 segment_offset = index % inner_dim_size;
+    const Index output_row = ldg(indices + indices_index);
+    const SegmentId segment_id = ldg(segment_ids + indices_index);
+    if (!FastBoundsCheck(output_row, output_outer_dim_size) ||
+        !FastBoundsCheck(segment_id, num_segments)) {
+      continue;
+    }
+    GpuAtomicAdd(output + output_row * inner_dim_size + segment_offset,
+                 ldg(input + segment_id * inner_dim_size + segment_offset) *
+                     ldg(scales + segment_id));
+  }
+}
+
 namespace functor {
 
 template <typename T, typename Index, typename InitialValueF,
@@ -216,6 +332,86 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
   }
 };
 
+template <typename T, typename Index, typename SegmentId>
+Status SparseSegmentReductionFunctor<T, Index, SegmentId>::operator()(
+    OpKernelContext* context, bool is_mean, bool is_sqrtn,
+    typename TTypes<T, 2>::ConstTensor input,
+    typename TTypes<Index>::ConstVec indices,
+    typename TTypes<SegmentId>::ConstVec segment_ids,
+    typename TTypes<T, 2>::Tensor output) {
+  if (output.size() == 0) {
+    return Status::OK();
+  }
+  const GPUDevice& d = context->eigen_device<GPUDevice>();
+  GpuLaunchConfig config = GetGpuLaunchConfig(output.size(), d);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      SetToValue<T>, config.block_count, config.thread_per_block, 0,
+      d.stream(), output.size(), output.data(), T(0)));
+  const int64 num_indices = indices.size();
+  const int64 inner_dim_size = output.dimension(1);
+  const SegmentId output_rows = output.dimension(0);
+  if (num_indices > 0 && inner_dim_size > 0) {
+    const int OuterDimTileSize = 8;
+    const int64 total_stripe_count =
+        inner_dim_size * Eigen::divup(num_indices, int64(OuterDimTileSize));
+    config = GetGpuLaunchConfig(total_stripe_count, d);
+    TF_RETURN_IF_ERROR(GpuLaunchKernel(
+        SparseSegmentSumKernel<T, Index, SegmentId, OuterDimTileSize>,
+        config.block_count, config.thread_per_block, 0, d.stream(),
+        static_cast<Index>(input.dimension(0)), inner_dim_size, num_indices,
+        output_rows, indices.data(), segment_ids.data(), input.data(),
+        output.data(), total_stripe_count));
+    if (is_mean || is_sqrtn) {
+      config = GetGpuLaunchConfig(output.size(), d);
+      TF_RETURN_IF_ERROR(GpuLaunchKernel(
+          SparseSegmentNormalizeKernel<T, SegmentId>, config.block_count,
+          config.thread_per_block, 0, d.stream(), output_rows, inner_dim_size,
+          num_indices, segment_ids.data(), is_sqrtn, output.data()));
+    }
+  }
+  return Status::OK();
+}
+
+template <typename T, typename Index, typename SegmentId>
+Status SparseSegmentGradFunctor<T, Index, SegmentId>::operator()(
+    OpKernelContext* context, bool is_sqrtn,
+    typename TTypes<T, 2>::ConstTensor input,
+    typename TTypes<Index>::ConstVec indices,
+    typename TTypes<SegmentId>::ConstVec segment_ids,
+    typename TTypes<T, 2>::Tensor output) {
+  if (output.size() == 0) {
+    return Status::OK();
+  }
+  const GPUDevice& d = context->eigen_device<GPUDevice>();
+  GpuLaunchConfig config = GetGpuLaunchConfig(output.size(), d);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      SetToValue<T>, config.block_count, config.thread_per_block, 0,
+      d.stream(), output.size(), output.data(), T(0)));
+  const int64 num_indices = indices.size();
+  const int64 inner_dim_size = output.dimension(1);
+  const SegmentId num_segments = input.dimension(0);
+  if (num_indices == 0 || num_segments == 0 || inner_dim_size == 0) {
+    return Status::OK();
+  }
+
+  Tensor scales;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataTypeToEnum<T>::value, TensorShape({num_segments}), &scales));
+  config = GetGpuLaunchConfig(num_segments, d);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      SparseSegmentGradScalesKernel<T, SegmentId>, config.block_count,
+      config.thread_per_block, 0, d.stream(), num_segments, num_indices,
+      segment_ids.data(), is_sqrtn, scales.flat<T>().data()));
+
+  config = GetGpuLaunchConfig(num_indices * inner_dim_size, d);
+  return GpuLaunchKernel(
+      SparseSegmentGradKernel<T, Index, SegmentId>, config.block_count,
+      config.thread_per_block, 0, d.stream(), num_segments, inner_dim_size,
+      num_indices, static_cast<Index>(output.dimension(0)), indices.data(),
+      segment_ids.data(), scales.flat<T>().data(), input.data(),
+      output.data());
+}
+
 #define DEFINE_SORTED_GPU_SPECS_INDEX(T, Index)                           \
   template struct SegmentReductionFunctor<T, Index, functor::Zero<T>,     \
                                           functor::NonAtomicSumOpGpu<T>,  \
@@ -267,12 +463,26 @@ TF_CALL_int32(DEFINE_SUM_GPU_SPECS);
 TF_CALL_COMPLEX_TYPES(DEFINE_SUM_GPU_SPECS);
 #endif
 
+#define DEFINE_SPARSE_GPU_SPECS_INDEX(T, Index)                   \
+  template struct SparseSegmentReductionFunctor<T, Index, int32>; \
+  template struct SparseSegmentReductionFunctor<T, Index, int64>; \
+  template struct SparseSegmentGradFunctor<T, Index, int32>;      \
+  template struct SparseSegmentGradFunctor<T, Index, int64>;
+
+#define DEFINE_SPARSE_GPU_SPECS(T)         \
+  DEFINE_SPARSE_GPU_SPECS_INDEX(T, int32); \
+  DEFINE_SPARSE_GPU_SPECS_INDEX(T, int64);
+
+TF_CALL_GPU_NUMBER_TYPES(DEFINE_SPARSE_GPU_SPECS);
+
 #undef DEFINE_SORTED_GPU_SPECS_INDEX
 #undef DEFINE_SORTED_GPU_SPECS
 #undef DEFINE_REAL_UNSORTED_GPU_SPECS_INDEX
 #undef DEFINE_SUM_UNSORTED_GPU_SPECS_INDEX
 #undef DEFINE_REAL_GPU_SPECS
 #undef DEFINE_SUM_GPU_SPECS
+#undef DEFINE_SPARSE_GPU_SPECS_INDEX
+#undef DEFINE_SPARSE_GPU_SPECS
 
 }  // namespace functor
 }  // namespace tensorflow
@@ -765,6 +765,129 @@ class SparseSegmentReductionOpBase : public OpKernel {
   const T default_value_;
 };
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// GPU implementation of the sparse segment reduction ops, which gathers and
+// reduces the selected rows in a single pass. Unless the op takes
+// num_segments, the number of output rows depends on the last segment id,
+// which first has to be copied back to the host, so the kernel is asynchronous
+// like SegmentReductionGPUOp. Indices are not bounds-checked on the device:
+// rows with out-of-range indices contribute nothing to their segment. Empty
+// segments are set to zero, which is the default value of every op registered
+// on GPU.
+template <class T, typename Index, typename SegmentId>
+class SparseSegmentReductionOpBase<GPUDevice, T, Index, SegmentId>
+    : public AsyncOpKernel {
+ public:
+  explicit SparseSegmentReductionOpBase(OpKernelConstruction* context,
+                                        bool is_mean, bool is_sqrtn,
+                                        bool has_num_segments, T default_value)
+      : AsyncOpKernel(context),
+        is_mean_(is_mean),
+        is_sqrtn_(is_sqrtn),
+        has_num_segments_(has_num_segments) {}
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    const Tensor& indices = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+
+    OP_REQUIRES_ASYNC(context, TensorShapeUtils::IsVector(indices.shape()),
+                      errors::InvalidArgument("indices should be a vector."),
+                      done);
+    OP_REQUIRES_ASYNC(
+        context, TensorShapeUtils::IsVector(segment_ids.shape()),
+        errors::InvalidArgument("segment_ids should be a vector."), done);
+
+    const int64 num_indices = indices.NumElements();
+    OP_REQUIRES_ASYNC(context, num_indices == segment_ids.NumElements(),
+                      errors::InvalidArgument(
+                          "segment_ids and indices should have same size."),
+                      done);
+
+    if (has_num_segments_) {
+      const Tensor& num_segments = context->input(3);
+      OP_REQUIRES_ASYNC(
+          context, num_segments.shape().dims() == 0,
+          errors::InvalidArgument("num_segments should be a scalar, not shape ",
+                                  num_segments.shape().DebugString()),
+          done);
+      const SegmentId output_rows = internal::SubtleMustCopy(
+          num_segments.dtype() == DT_INT32 ? num_segments.scalar<int32>()()
+                                           : num_segments.scalar<int64>()());
+      OP_REQUIRES_ASYNC(context, output_rows >= 0,
+                        errors::InvalidArgument("segment ids must be >= 0"),
+                        done);
+      ComputeWithOutputRows(context, output_rows);
+      done();
+      return;
+    }
+
+    if (num_indices == 0) {
+      ComputeWithOutputRows(context, 0);
+      done();
+      return;
+    }
+
+    se::DeviceMemoryBase last_segment_id_device(
+        const_cast<Tensor&>(segment_ids).template flat<SegmentId>().data() +
+        (num_indices - 1));
+    ScratchSpace<SegmentId> last_segment_id_host(context, 1,
+                                                 /* on_host */ true);
+
+    auto stream = context->op_device_context()->stream();
+    OP_REQUIRES_ASYNC(
+        context,
+        stream
+            ->ThenMemcpy(last_segment_id_host.mutable_data(),
+                         last_segment_id_device, sizeof(SegmentId))
+            .ok(),
+        errors::Internal(type_string() +
+                         ": failed to copy last segment id from device"),
+        done);
+
+    auto compute_with_output_rows = [this, context, last_segment_id_host,
+                                     done]() {
+      // Ensure that within the callback, the proper GPU settings are
+      // configured.
+      auto stream = context->op_device_context()->stream();
+      ScopedActivateExecutorContext scoped_activation{stream->parent()};
+
+      const SegmentId output_rows = *last_segment_id_host.data() + 1;
+      OP_REQUIRES_ASYNC(context, output_rows > 0,
+                        errors::InvalidArgument("segment ids must be >= 0"),
+                        done);
+      ComputeWithOutputRows(context, output_rows);
+      done();
+    };
+
+    context->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        stream, compute_with_output_rows);
+  }
+
+ private:
+  void ComputeWithOutputRows(OpKernelContext* context, SegmentId output_rows) {
+    const Tensor& input = context->input(0);
+    const Tensor& indices = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+
+    TensorShape output_shape = input.shape();
+    output_shape.set_dim(0, output_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+
+    functor::SparseSegmentReductionFunctor<T, Index, SegmentId> functor;
+    OP_REQUIRES_OK(context, functor(context, is_mean_, is_sqrtn_,
+                                    input.flat_outer_dims<T>(),
+                                    indices.vec<Index>(),
+                                    segment_ids.vec<SegmentId>(),
+                                    output->flat_outer_dims<T>()));
+  }
+
+  const bool is_mean_;
+  const bool is_sqrtn_;
+  const bool has_num_segments_;
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 template <typename Device, class T, typename Index, typename SegmentId>
 class SparseSegmentReductionMeanOp
     : public SparseSegmentReductionOpBase<Device, T, Index, SegmentId> {
@@ -836,7 +959,7 @@ class SparseSegmentReductionSumWithNumSegmentsOp
 // * T: The value type.
 // * Index: The element type of the indices tensor (int32 or int64).
 // * SegmentId: The element type of the segment_ids tensor (int32 or int64).
-template <class T, typename Index, typename SegmentId>
+template <typename Device, class T, typename Index, typename SegmentId>
 class SparseSegmentGradOpBase : public OpKernel {
  public:
   explicit SparseSegmentGradOpBase(OpKernelConstruction* context, bool is_sqrtn)
@@ -939,22 +1062,70 @@ class SparseSegmentGradOpBase : public OpKernel {
   const bool is_sqrtn_;
 };
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// GPU implementation of the gradients of SparseSegmentMean and
+// SparseSegmentSqrtN. Like the forward GPU ops, indices and segment ids are not
+// bounds-checked on the device; pairs that are out of range are skipped.
 template <class T, typename Index, typename SegmentId>
+class SparseSegmentGradOpBase<GPUDevice, T, Index, SegmentId>
+    : public OpKernel {
+ public:
+  explicit SparseSegmentGradOpBase(OpKernelConstruction* context, bool is_sqrtn)
+      : OpKernel(context), is_sqrtn_(is_sqrtn) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    const Tensor& indices = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& output_dim0 = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(segment_ids.shape()),
+                errors::InvalidArgument("segment_ids should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(output_dim0.shape()),
+                errors::InvalidArgument("output_dim0 should be a scalar."));
+    OP_REQUIRES(context, indices.NumElements() == segment_ids.NumElements(),
+                errors::InvalidArgument(
+                    "segment_ids and indices should have same size."));
+    const Index M = internal::SubtleMustCopy(output_dim0.scalar<int32>()());
+    OP_REQUIRES(context, M >= 0,
+                errors::InvalidArgument("output_dim0 must be >= 0"));
+
+    TensorShape output_shape = input.shape();
+    output_shape.set_dim(0, M);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+
+    functor::SparseSegmentGradFunctor<T, Index, SegmentId> functor;
+    OP_REQUIRES_OK(context, functor(context, is_sqrtn_,
+                                    input.flat_outer_dims<T>(),
+                                    indices.vec<Index>(),
+                                    segment_ids.vec<SegmentId>(),
+                                    output->flat_outer_dims<T>()));
+  }
+
+ private:
+  const bool is_sqrtn_;
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+template <typename Device, class T, typename Index, typename SegmentId>
 class SparseSegmentMeanGradOp
-    : public SparseSegmentGradOpBase<T, Index, SegmentId> {
+    : public SparseSegmentGradOpBase<Device, T, Index, SegmentId> {
  public:
   explicit SparseSegmentMeanGradOp(OpKernelConstruction* context)
-      : SparseSegmentGradOpBase<T, Index, SegmentId>(context,
-                                                     false /*is_sqrtn*/) {}
+      : SparseSegmentGradOpBase<Device, T, Index, SegmentId>(
+            context, false /*is_sqrtn*/) {}
 };
 
-template <class T, typename Index, typename SegmentId>
+template <typename Device, class T, typename Index, typename SegmentId>
 class SparseSegmentSqrtNGradOp
-    : public SparseSegmentGradOpBase<T, Index, SegmentId> {
+    : public SparseSegmentGradOpBase<Device, T, Index, SegmentId> {
  public:
   explicit SparseSegmentSqrtNGradOp(OpKernelConstruction* context)
-      : SparseSegmentGradOpBase<T, Index, SegmentId>(context,
-                                                     true /*is_sqrtn*/) {}
+      : SparseSegmentGradOpBase<Device, T, Index, SegmentId>(
+            context, true /*is_sqrtn*/) {}
 };
 
 }  // namespace tensorflow
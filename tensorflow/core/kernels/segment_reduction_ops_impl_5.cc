@@ -96,7 +96,7 @@ REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(bfloat16);
           .TypeConstraint<type>("T")                                    \
           .TypeConstraint<index_type>("Tidx")                           \
           .TypeConstraint<segment_ids_type>("Tsegmentids"),             \
-      SparseSegmentMeanGradOp<type, index_type, segment_ids_type>);
+      SparseSegmentMeanGradOp<CPUDevice, type, index_type, segment_ids_type>);
 REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(float);
 REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(double);
 #undef REGISTER_CPU_SPARSE_KERNELS
@@ -108,7 +108,7 @@ REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(double);
           .TypeConstraint<type>("T")                                    \
           .TypeConstraint<index_type>("Tidx")                           \
           .TypeConstraint<segment_ids_type>("Tsegmentids"),             \
-      SparseSegmentSqrtNGradOp<type, index_type, segment_ids_type>);
+      SparseSegmentSqrtNGradOp<CPUDevice, type, index_type, segment_ids_type>);
 REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(float);
 REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(double);
 #undef REGISTER_CPU_SPARSE_KERNELS
@@ -116,4 +116,92 @@ REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(double);
 #undef REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE
 #undef REGISTER_CPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, index_type) \
+  REGISTER_GPU_SPARSE_KERNELS(type, index_type, int32)                         \
+  REGISTER_GPU_SPARSE_KERNELS(type, index_type, int64)
+#define REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(type)       \
+  REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int32) \
+  REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int64)
+
+#define REGISTER_GPU_SPARSE_KERNELS(type, index_type, segment_ids_type)       \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("SparseSegmentSum")                                                \
+          .Device(DEVICE_GPU)                                                 \
+          .TypeConstraint<type>("T")                                          \
+          .TypeConstraint<index_type>("Tidx")                                 \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                   \
+      SparseSegmentReductionSumOp<GPUDevice, type, index_type,                \
+                                  segment_ids_type>);                         \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("SparseSegmentSumWithNumSegments")                                 \
+          .Device(DEVICE_GPU)                                                 \
+          .HostMemory("num_segments")                                         \
+          .TypeConstraint<type>("T")                                          \
+          .TypeConstraint<index_type>("Tidx")                                 \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                   \
+      SparseSegmentReductionSumWithNumSegmentsOp<GPUDevice, type, index_type, \
+                                                 segment_ids_type>);
+TF_CALL_GPU_NUMBER_TYPES(REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE);
+#undef REGISTER_GPU_SPARSE_KERNELS
+
+#define REGISTER_GPU_SPARSE_KERNELS(type, index_type, segment_ids_type)        \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("SparseSegmentMean")                                                \
+          .Device(DEVICE_GPU)                                                  \
+          .TypeConstraint<type>("T")                                           \
+          .TypeConstraint<index_type>("Tidx")                                  \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                    \
+      SparseSegmentReductionMeanOp<GPUDevice, type, index_type,                \
+                                   segment_ids_type>);                         \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("SparseSegmentMeanWithNumSegments")                                 \
+          .Device(DEVICE_GPU)                                                  \
+          .HostMemory("num_segments")                                          \
+          .TypeConstraint<type>("T")                                           \
+          .TypeConstraint<index_type>("Tidx")                                  \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                    \
+      SparseSegmentReductionMeanWithNumSegmentsOp<GPUDevice, type, index_type, \
+                                                  segment_ids_type>);          \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("SparseSegmentSqrtN")                                               \
+          .Device(DEVICE_GPU)                                                  \
+          .TypeConstraint<type>("T")                                           \
+          .TypeConstraint<index_type>("Tidx")                                  \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                    \
+      SparseSegmentReductionSqrtNOp<GPUDevice, type, index_type,               \
+                                    segment_ids_type>);                        \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("SparseSegmentSqrtNWithNumSegments")                                \
+          .Device(DEVICE_GPU)                                                  \
+          .HostMemory("num_segments")                                          \
+          .TypeConstraint<type>("T")                                           \
+          .TypeConstraint<index_type>("Tidx")                                  \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                    \
+      SparseSegmentReductionSqrtNWithNumSegmentsOp<                            \
+          GPUDevice, type, index_type, segment_ids_type>);                     \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("SparseSegmentMeanGrad")                                            \
+          .Device(DEVICE_GPU)                                                  \
+          .HostMemory("output_dim0")                                           \
+          .TypeConstraint<type>("T")                                           \
+          .TypeConstraint<index_type>("Tidx")                                  \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                    \
+      SparseSegmentMeanGradOp<GPUDevice, type, index_type, segment_ids_type>); \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("SparseSegmentSqrtNGrad")                                           \
+          .Device(DEVICE_GPU)                                                  \
+          .HostMemory("output_dim0")                                           \
+          .TypeConstraint<type>("T")                                           \
+          .TypeConstraint<index_type>("Tidx")                                  \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                    \
+      SparseSegmentSqrtNGradOp<GPUDevice, type, index_type, segment_ids_type>);
+REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(float);
+REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE(double);
+#undef REGISTER_GPU_SPARSE_KERNELS
+
+#undef REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_INDEX_TYPE
+#undef REGISTER_GPU_SPARSE_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace tensorflow
@@ -102,39 +102,37 @@ class SparseConcatOp : public OpKernel {
     }
 
     // The input and output sparse tensors are assumed to be ordered along
-    // increasing dimension number. But in order for concat to work properly,
-    // order[0] must be concat_dim. So we will reorder the inputs to the
-    // concat ordering, concatenate, then reorder back to the standard order.
-    // We make a deep copy of the input tensors to ensure that the in-place
-    // reorder doesn't create race conditions for other ops that may be
-    // concurrently reading the indices and values tensors.
+    // increasing dimension number. Inputs that are not are reordered, after
+    // making a deep copy of them to ensure that the in-place reorder doesn't
+    // create race conditions for other ops that may be concurrently reading
+    // the indices and values tensors. The ordered inputs are then merged, so
+    // that the output is ordered without being reordered.
 
     gtl::InlinedVector<int64, 8> std_order(input_rank);
     std::iota(std_order.begin(), std_order.end(), 0);
 
-    std::vector<int64> concat_order;
-    concat_order.reserve(input_rank);
-    concat_order.push_back(concat_dim);
-    for (int j = 0; j < input_rank; ++j) {
-      if (j != concat_dim) {
-        concat_order.push_back(j);
-      }
-    }
-
+    thread::ThreadPool* pool =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
     std::vector<sparse::SparseTensor> sp_inputs;
     for (int i = 0; i < N; ++i) {
       const TensorShape current_shape(shapes[i].vec<int64>());
       sparse::SparseTensor tensor;
       OP_REQUIRES_OK(context,
-                     sparse::SparseTensor::Create(
-                         tensor::DeepCopy(inds[i]), tensor::DeepCopy(vals[i]),
-                         current_shape, std_order, &tensor));
+                     sparse::SparseTensor::Create(inds[i], vals[i],
+                                                  current_shape, std_order,
+                                                  &tensor));
+      if (!tensor.IndicesValid().ok()) {
+        OP_REQUIRES_OK(context,
+                       sparse::SparseTensor::Create(
+                           tensor::DeepCopy(inds[i]), tensor::DeepCopy(vals[i]),
+                           current_shape, std_order, &tensor));
+        tensor.Reorder<T>(std_order, pool);
+      }
       sp_inputs.push_back(std::move(tensor));
-      sp_inputs[i].Reorder<T>(concat_order);
     }
 
-    sparse::SparseTensor concat = sparse::SparseTensor::Concat<T>(sp_inputs);
-    concat.Reorder<T>(std_order);
+    sparse::SparseTensor concat =
+        sparse::SparseTensor::MergeConcat<T>(sp_inputs, concat_dim);
 
     context->set_output(0, concat.indices());
     context->set_output(1, concat.values());
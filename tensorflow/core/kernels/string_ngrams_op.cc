@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace text {
@@ -109,36 +110,58 @@ class StringNGramsOp : public tensorflow::OpKernel {
             0, TensorShape({ngrams_splits_data[num_batch_items]}), &ngrams));
     auto ngrams_data = ngrams->flat<tstring>().data();
 
-    for (int i = 0; i < num_batch_items; ++i) {
-      auto data_start = &input_data[splits_vec(i)];
-      int output_start_idx = ngrams_splits_data[i];
-      for (int ngram_width : ngram_widths_) {
-        auto output_start = &ngrams_data[output_start_idx];
-        int length = splits_vec(i + 1) - splits_vec(i);
-        int num_ngrams = get_num_ngrams(length, ngram_width);
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
-        output_start_idx += num_ngrams;
+    // Every batch item writes its own range of the preallocated output, so
+    // the items are processed in parallel.
+    auto work = [&](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        CreateBatchItemNgrams(input_data, splits_vec(i), splits_vec(i + 1),
+                              ngrams_splits_data[i], ngrams_data);
       }
-      // If we're preserving short sequences, check to see if no sequence was
-      // generated by comparing the current output start idx to the original
-      // one (ngram_splits_data). If no ngrams were generated, then they will
-      // be equal (since we increment output_start_idx by num_ngrams every
-      // time we create a set of ngrams.)
-      if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
-        int data_length = splits_vec(i + 1) - splits_vec(i);
-        // One legitimate reason to not have any ngrams when preserve_short_
-        // is true is if the sequence itself is empty. In that case, move on.
-        if (data_length == 0) {
-          continue;
-        }
-        // We don't have to worry about dynamic padding sizes here: if padding
-        // was dynamic, every sequence would have had sufficient padding to
-        // generate at least one ngram.
-        int ngram_width = data_length + 2 * pad_width_;
-        auto output_start = &ngrams_data[output_start_idx];
-        int num_ngrams = 1;
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+    };
+    const int64 num_ngrams = ngrams_splits_data[num_batch_items];
+    int max_ngram_width = 1;
+    for (int ngram_width : ngram_widths_) {
+      max_ngram_width = std::max(max_ngram_width, ngram_width);
+    }
+    const int64 cost_per_item = kCostPerToken * max_ngram_width *
+                                (1 + num_ngrams / std::max(1, num_batch_items));
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_batch_items, cost_per_item, work);
+  }
+
+  // Writes the ngrams of the batch item with tokens [data_begin, data_end) to
+  // `ngrams_data`, starting at `output_begin`.
+  void CreateBatchItemNgrams(const tstring* input_data, int64 data_begin,
+                             int64 data_end, int64 output_begin,
+                             tstring* ngrams_data) const {
+    auto data_start = &input_data[data_begin];
+    const int data_length = data_end - data_begin;
+    int64 output_start_idx = output_begin;
+    for (int ngram_width : ngram_widths_) {
+      auto output_start = &ngrams_data[output_start_idx];
+      int num_ngrams = get_num_ngrams(data_length, ngram_width);
+      CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+      output_start_idx += num_ngrams;
+    }
+    // If we're preserving short sequences, check to see if no sequence was
+    // generated by comparing the current output start idx to the original
+    // one (output_begin). If no ngrams were generated, then they will be
+    // equal (since we increment output_start_idx by num_ngrams every time we
+    // create a set of ngrams.)
+    if (preserve_short_ && output_start_idx == output_begin) {
+      // One legitimate reason to not have any ngrams when preserve_short_ is
+      // true is if the sequence itself is empty. In that case, move on.
+      if (data_length == 0) {
+        return;
       }
+      // We don't have to worry about dynamic padding sizes here: if padding
+      // was dynamic, every sequence would have had sufficient padding to
+      // generate at least one ngram.
+      int ngram_width = data_length + 2 * pad_width_;
+      auto output_start = &ngrams_data[output_start_idx];
+      int num_ngrams = 1;
+      CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
     }
   }
 
@@ -190,6 +213,9 @@ class StringNGramsOp : public tensorflow::OpKernel {
     }
   }
 
+  // Rough cycle count of appending one token to an ngram.
+  static constexpr int64 kCostPerToken = 100;
+
   string separator_;
   string left_pad_;
   string right_pad_;
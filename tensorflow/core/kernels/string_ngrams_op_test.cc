@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/shape_inference.h"
@@ -542,6 +543,36 @@ TEST_F(NgramKernelTest, TestEmptyInput) {
   assert_int64_equal(expected_splits, *GetOutput(1));
 }
 
+TEST_F(NgramKernelTest, TestManyBatchItems) {
+  MakeOp("|", {2}, "LP", "RP", -1, false);
+  // Enough batch items to be processed by several threads. Item i has i % 3
+  // tokens, all equal to the item index.
+  const int num_items = 3000;
+  std::vector<tstring> data;
+  std::vector<int64> splits({0});
+  std::vector<tstring> expected_values;
+  std::vector<int64> expected_splits({0});
+  for (int i = 0; i < num_items; ++i) {
+    const tstring token = absl::StrCat(i);
+    const int length = i % 3;
+    for (int j = 0; j < length; ++j) data.push_back(token);
+    splits.push_back(data.size());
+    if (length > 0) {
+      expected_values.push_back(absl::StrCat("LP|", i));
+      if (length == 2) expected_values.push_back(absl::StrCat(i, "|", i));
+      expected_values.push_back(absl::StrCat(i, "|RP"));
+    }
+    expected_splits.push_back(expected_values.size());
+  }
+  AddInputFromArray<tstring>(TensorShape({static_cast<int64>(data.size())}),
+                             data);
+  AddInputFromArray<int64>(TensorShape({num_items + 1}), splits);
+  TF_ASSERT_OK(RunOpKernel());
+
+  assert_string_equal(expected_values, *GetOutput(0));
+  assert_int64_equal(expected_splits, *GetOutput(1));
+}
+
 TEST_F(NgramKernelTest, ShapeFn) {
   ShapeInferenceTestOp op("StringNGrams");
   INFER_OK(op, "?;?", "[?];[?]");
@@ -15,6 +15,7 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <cstring>
 #include <string>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
@@ -99,8 +100,27 @@ std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
   return SplitOnCharSet(str, delimiter, predicate);
 }
 
-std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
-                                 int maxsplit) {
+// Returns the offset of the first occurrence of the non-empty `sep` in `text`,
+// or StringPiece::npos. Candidates are found with memchr, which the C library
+// vectorizes, instead of comparing `text` byte by byte with std::search.
+size_t FindSeparator(StringPiece text, StringPiece sep) {
+  const char* begin = text.data();
+  const char* end = begin + text.size();
+  const size_t tail = sep.size() - 1;
+  const char* p = begin;
+  while (static_cast<size_t>(end - p) >= sep.size()) {
+    p = static_cast<const char*>(memchr(p, sep[0], (end - p) - tail));
+    if (p == nullptr) break;
+    if (memcmp(p + 1, sep.data() + 1, tail) == 0) return p - begin;
+    ++p;
+  }
+  return StringPiece::npos;
+}
+
+// Appends the tokens of `str` to `result` and returns the number of appended
+// tokens.
+int64 SplitV2(const tstring& str, StringPiece sep, int maxsplit,
+              std::vector<StringPiece>* result) {
   // This SplitV2 method matches the behavior of python's str.split:
   //   If sep is given, consecutive delimiters are not grouped together
   //   and are deemed to delimit empty strings (for example, '1,,2'.split(',')
@@ -115,12 +135,12 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   //   splitting an empty string or a string consisting of just whitespace
   //   with a None separator returns [].
 
-  std::vector<StringPiece> result;
+  const size_t start = result->size();
 
   StringPiece text(str);
   if (maxsplit == 0) {
-    result.emplace_back(text);
-    return result;
+    result->emplace_back(text);
+    return 1;
   }
 
   if (sep.empty()) {
@@ -129,32 +149,27 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
     str_util::RemoveLeadingWhitespace(&text);
     int split = 0;
     while (str_util::ConsumeNonWhitespace(&text, &token)) {
-      result.push_back(token);
+      result->push_back(token);
       str_util::RemoveLeadingWhitespace(&text);
       ++split;
       if (maxsplit > 0 && split == maxsplit) {
-        result.push_back(text);
-        return result;
+        result->push_back(text);
+        break;
       }
     }
-    return result;
+    return result->size() - start;
   }
-  auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   int split = 0;
-  while (p != text.end()) {
-    StringPiece token = text.substr(0, p - text.begin());
-    result.push_back(token);
-    text.remove_prefix(token.size());
-    text.remove_prefix(sep.size());
+  size_t pos = FindSeparator(text, sep);
+  while (pos != StringPiece::npos) {
+    result->push_back(text.substr(0, pos));
+    text.remove_prefix(pos + sep.size());
     ++split;
-    if (maxsplit > 0 && split == maxsplit) {
-      result.push_back(StringPiece(text));
-      return result;
-    }
-    p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+    if (maxsplit > 0 && split == maxsplit) break;
+    pos = FindSeparator(text, sep);
   }
-  result.push_back(text);
-  return result;
+  result->push_back(text);
+  return result->size() - start;
 }
 
 }  // namespace
@@ -272,12 +287,12 @@ class StringSplitV2Op : public OpKernel {
     int64 max_num_entries = 0;
     std::vector<int64> num_indices(batch_size);
     for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64 n_entries = parts.size();
+      // Tokens of all the strings go straight into `tokens`, without a
+      // temporary vector per string.
+      const int64 n_entries = SplitV2(input_vec(i), sep, maxsplit_, &tokens);
       num_indices[i] = n_entries;
       output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
 
     Tensor* sp_indices_t;
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -44,18 +47,36 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const uint64 num_buckets = num_buckets_;
+    auto work = [&input_flat, &output_flat, num_buckets](int64 start,
+                                                         int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        const uint64 input_hash = hash(input_flat(i));
+        const uint64 bucket_id = input_hash % num_buckets;
+        // The number of buckets is always in the positive range of int64 so is
+        // the resulting bucket_id. Casting the bucket_id from uint64 to int64
+        // is safe.
+        output_flat(i) = static_cast<int64>(bucket_id);
+      }
+    };
+    // Hashing a string is cheap, so Shard only splits large batches across
+    // the worker threads.
+    const int64 total_bytes = std::accumulate(
+        input_flat.data(), input_flat.data() + input_flat.size(), int64{0},
+        [](int64 sum, const tstring& s) { return sum + s.size(); });
+    const int64 cost_per_string =
+        kCostPerString +
+        kCostPerByte * total_bytes / std::max<int64>(1, input_flat.size());
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          input_flat.size(), cost_per_string, work);
   }
 
  private:
+  // Rough cycle counts of a Fingerprint64 call and of hashing one byte.
+  static constexpr int64 kCostPerString = 50;
+  static constexpr int64 kCostPerByte = 2;
+
   int64 num_buckets_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(StringToHashBucketOp);
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <cmath>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -447,55 +448,29 @@ struct ColumnIndexCreator {
   int num_cols_;
 };
 
+// Sorts each row of the 'num_rows' x 'num_cols' matrix 'keys_in' in
+// descending order into 'keys_out', and permutes the matching row of
+// 'values_in' along with it into 'values_out'. The sort is stable.
 template <typename T>
-Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
-                        int num_cols, int k,
-                        typename TTypes<T, 2>::Tensor values,
-                        TTypes<int, 2>::Tensor indices) {
-  const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+Status SegmentedSortPairsDescending(OpKernelContext* ctx, const T* keys_in,
+                                    T* keys_out, const int* values_in,
+                                    int* values_out, int num_rows,
+                                    int num_cols) {
   const auto& cu_stream = GetGpuStream(ctx);
   size_t temp_storage_bytes = -1;
 
-  // TODO(ebrevdo): Once gpuprim supports iterators for ValueT replace that
-  // tensor with an iterator that directly returns the correct value.
-  Tensor input_indices;
-  TF_RETURN_IF_ERROR(ctx->allocate_temp(
-      DT_INT32, TensorShape({num_rows, num_cols}), &input_indices));
-  auto input_indices_t = To32Bit(input_indices.flat<int32>());
-  input_indices_t.device(d) =
-      input_indices_t.generate(ColumnIndexCreator(num_cols));
-
   gpuprim::CountingInputIterator<int> counting_iter(0);
   gpuprim::TransformInputIterator<int, SegmentOffsetCreator,
                                   gpuprim::CountingInputIterator<int>>
       segment_offsets_t(counting_iter, SegmentOffsetCreator(num_cols));
 
-  Tensor temp_values;
-  Tensor temp_indices;
-  T* sorted_values_ptr;
-  int* sorted_indices_ptr;
-  if (k == num_cols) {
-    // Doing a full sort, no intermediate values needed.
-    sorted_values_ptr = values.data();
-    sorted_indices_ptr = indices.data();
-  } else {
-    // Need to create intermediate values for sorting.
-    TF_RETURN_IF_ERROR(ctx->allocate_temp(
-        DT_INT32, TensorShape({num_rows, num_cols}), &temp_indices));
-    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
-                                          TensorShape({num_rows, num_cols}),
-                                          &temp_values));
-    sorted_indices_ptr = temp_indices.flat<int32>().data();
-    sorted_values_ptr = temp_values.flat<T>().data();
-  }
-
   auto err = gpuprim::DeviceSegmentedRadixSort::SortPairsDescending(
       /* d_temp_storage */ nullptr,
       /* temp_storage_bytes */ temp_storage_bytes,
-      /* d_keys_in */ input,
-      /* d_keys_out */ sorted_values_ptr,
-      /* d_values_in */ input_indices_t.data(),
-      /* d_values_out */ sorted_indices_ptr,
+      /* d_keys_in */ keys_in,
+      /* d_keys_out */ keys_out,
+      /* d_values_in */ values_in,
+      /* d_values_out */ values_out,
       /* num_items */ num_cols * num_rows,
       /* num_segments */ num_rows,
       /* d_begin_offsets */ segment_offsets_t,
@@ -517,10 +492,10 @@ Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
   err = gpuprim::DeviceSegmentedRadixSort::SortPairsDescending(
       /* d_temp_storage */ temp_storage.flat<int8>().data(),
       /* temp_storage_bytes */ temp_storage_bytes,
-      /* d_keys_in */ input,
-      /* d_keys_out */ sorted_values_ptr,
-      /* d_values_in */ input_indices_t.data(),
-      /* d_values_out */ sorted_indices_ptr,
+      /* d_keys_in */ keys_in,
+      /* d_keys_out */ keys_out,
+      /* d_values_in */ values_in,
+      /* d_values_out */ values_out,
       /* num_items */ num_cols * num_rows,
       /* num_segments */ num_rows,
       /* d_begin_offsets */ segment_offsets_t,
@@ -535,6 +510,47 @@ Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
         "temp_storage_bytes: ",
         temp_storage_bytes, ", status: ", cudaGetErrorString(err));
   }
+  return Status::OK();
+}
+
+template <typename T>
+Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
+                        int num_cols, int k,
+                        typename TTypes<T, 2>::Tensor values,
+                        TTypes<int, 2>::Tensor indices) {
+  const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+
+  // TODO(ebrevdo): Once gpuprim supports iterators for ValueT replace that
+  // tensor with an iterator that directly returns the correct value.
+  Tensor input_indices;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT32, TensorShape({num_rows, num_cols}), &input_indices));
+  auto input_indices_t = To32Bit(input_indices.flat<int32>());
+  input_indices_t.device(d) =
+      input_indices_t.generate(ColumnIndexCreator(num_cols));
+
+  Tensor temp_values;
+  Tensor temp_indices;
+  T* sorted_values_ptr;
+  int* sorted_indices_ptr;
+  if (k == num_cols) {
+    // Doing a full sort, no intermediate values needed.
+    sorted_values_ptr = values.data();
+    sorted_indices_ptr = indices.data();
+  } else {
+    // Need to create intermediate values for sorting.
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DT_INT32, TensorShape({num_rows, num_cols}), &temp_indices));
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                          TensorShape({num_rows, num_cols}),
+                                          &temp_values));
+    sorted_indices_ptr = temp_indices.flat<int32>().data();
+    sorted_values_ptr = temp_values.flat<T>().data();
+  }
+
+  TF_RETURN_IF_ERROR(SegmentedSortPairsDescending(
+      ctx, input, sorted_values_ptr, input_indices_t.data(),
+      sorted_indices_ptr, num_rows, num_cols));
   if (k < num_cols) {
     // Need to copy subsets of sorted_indices and sorted_outputs to
     // indices and outputs.
@@ -548,6 +564,183 @@ Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
   return Status::OK();
 }
 
+// Maps values of type T to unsigned integers of the same width whose unsigned
+// order matches the order of the values, so that they can be compared one
+// radix digit at a time.
+template <typename T>
+struct RadixKey {
+  typedef typename std::make_unsigned<T>::type Bits;
+
+  static __device__ EIGEN_STRONG_INLINE Bits Encode(T value) {
+    constexpr Bits kSignBit = std::is_signed<T>::value
+                                  ? static_cast<Bits>(Bits(1)
+                                                      << (sizeof(T) * 8 - 1))
+                                  : Bits(0);
+    return static_cast<Bits>(value) ^ kSignBit;
+  }
+};
+
+// For floating point values the sign bit is flipped for positive values and
+// all bits are flipped for negative ones.
+template <typename T, typename Bits>
+__device__ EIGEN_STRONG_INLINE Bits EncodeFloatBits(Bits bits) {
+  constexpr Bits kSignBit = static_cast<Bits>(Bits(1) << (sizeof(T) * 8 - 1));
+  return (bits & kSignBit) ? static_cast<Bits>(~bits)
+                           : static_cast<Bits>(bits | kSignBit);
+}
+
+template <>
+struct RadixKey<Eigen::half> {
+  typedef uint16 Bits;
+  static __device__ EIGEN_STRONG_INLINE Bits Encode(Eigen::half value) {
+    return EncodeFloatBits<Eigen::half, Bits>(value.x);
+  }
+};
+
+template <>
+struct RadixKey<float> {
+  typedef uint32 Bits;
+  static __device__ EIGEN_STRONG_INLINE Bits Encode(float value) {
+    return EncodeFloatBits<float, Bits>(__float_as_uint(value));
+  }
+};
+
+template <>
+struct RadixKey<double> {
+  typedef uint64 Bits;
+  static __device__ EIGEN_STRONG_INLINE Bits Encode(double value) {
+    return EncodeFloatBits<double, Bits>(
+        static_cast<uint64>(__double_as_longlong(value)));
+  }
+};
+
+constexpr int kRadixSelectThreads = 256;
+constexpr int kRadixSelectBits = 8;
+constexpr int kRadixSelectBuckets = 1 << kRadixSelectBits;
+
+// Writes the top k entries of each row of 'input' to 'output' and 'indices',
+// in order of their index. Each block handles one row. The k-th largest value
+// is located with a most-significant-digit radix select, which takes one pass
+// over the row per radix digit, and the selected entries are then gathered in
+// a final pass. Of several entries equal to the k-th largest value, those with
+// the lower indices are selected.
+template <typename T>
+__global__ void __launch_bounds__(kRadixSelectThreads)
+    RadixSelectTopKKernel(const T* __restrict__ input, int length, int k,
+                          T* __restrict__ output, int* __restrict__ indices) {
+  typedef typename RadixKey<T>::Bits Bits;
+  typedef gpuprim::BlockScan<int, kRadixSelectThreads> BlockScan;
+  __shared__ typename BlockScan::TempStorage scan_storage;
+  __shared__ int histogram[kRadixSelectBuckets];
+  __shared__ Bits shared_desired;
+  __shared__ int shared_remaining;
+
+  const int batch_index = blockIdx.x;
+  const T* row = input + static_cast<int64>(batch_index) * length;
+  T* row_output = output + static_cast<int64>(batch_index) * k;
+  int* row_indices = indices + static_cast<int64>(batch_index) * k;
+
+  // 'desired' holds the digits of the k-th largest key found so far and
+  // 'mask' selects them. 'remaining' is the rank of the k-th largest key
+  // among the keys that match 'desired'.
+  Bits desired = 0;
+  Bits mask = 0;
+  int remaining = k;
+  for (int shift = sizeof(Bits) * 8 - kRadixSelectBits; shift >= 0;
+       shift -= kRadixSelectBits) {
+    for (int i = threadIdx.x; i < kRadixSelectBuckets; i += blockDim.x) {
+      histogram[i] = 0;
+    }
+    __syncthreads();
+    for (int i = threadIdx.x; i < length; i += blockDim.x) {
+      const Bits key = RadixKey<T>::Encode(row[i]);
+      if ((key & mask) == desired) {
+        atomicAdd(&histogram[(key >> shift) & (kRadixSelectBuckets - 1)], 1);
+      }
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      int digit = kRadixSelectBuckets - 1;
+      for (; digit > 0; --digit) {
+        if (histogram[digit] >= remaining) break;
+        remaining -= histogram[digit];
+      }
+      shared_desired = desired | static_cast<Bits>(Bits(digit) << shift);
+      shared_remaining = remaining;
+    }
+    __syncthreads();
+    desired = shared_desired;
+    remaining = shared_remaining;
+    mask |= static_cast<Bits>(Bits(kRadixSelectBuckets - 1) << shift);
+  }
+
+  // 'desired' is now the key of the k-th largest value. Gather every larger
+  // entry and the first 'remaining' entries equal to it, in index order.
+  int num_selected = 0;
+  int num_equal = 0;
+  for (int start = 0; start < length && num_selected < k;
+       start += blockDim.x) {
+    const int i = start + threadIdx.x;
+    T value = T();
+    int is_greater = 0;
+    int is_equal = 0;
+    if (i < length) {
+      value = row[i];
+      const Bits key = RadixKey<T>::Encode(value);
+      is_greater = key > desired;
+      is_equal = key == desired;
+    }
+    int equal_position;
+    int equal_total;
+    BlockScan(scan_storage).ExclusiveSum(is_equal, equal_position, equal_total);
+    __syncthreads();
+    const int is_selected =
+        is_greater || (is_equal && num_equal + equal_position < remaining);
+    int position;
+    int selected_total;
+    BlockScan(scan_storage)
+        .ExclusiveSum(is_selected, position, selected_total);
+    __syncthreads();
+    if (is_selected) {
+      row_output[num_selected + position] = value;
+      row_indices[num_selected + position] = i;
+    }
+    num_selected += selected_total;
+    num_equal += equal_total;
+  }
+}
+
+template <typename T>
+Status LaunchRadixSelectKernel(OpKernelContext* ctx, const T* input,
+                               int num_rows, int num_cols, int k, bool sorted,
+                               typename TTypes<T, 2>::Tensor values,
+                               TTypes<int, 2>::Tensor indices) {
+  const auto& cu_stream = GetGpuStream(ctx);
+  Tensor temp_values;
+  Tensor temp_indices;
+  T* selected_values_ptr = values.data();
+  int* selected_indices_ptr = indices.data();
+  if (sorted) {
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DT_INT32, TensorShape({num_rows, k}), &temp_indices));
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<T>::value, TensorShape({num_rows, k}), &temp_values));
+    selected_values_ptr = temp_values.flat<T>().data();
+    selected_indices_ptr = temp_indices.flat<int32>().data();
+  }
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      RadixSelectTopKKernel<T>, num_rows, kRadixSelectThreads, 0, cu_stream,
+      input, num_cols, k, selected_values_ptr, selected_indices_ptr));
+  if (!sorted) {
+    return Status::OK();
+  }
+  // The selected entries are in index order and the sort is stable, so ties
+  // keep preferring the lower index.
+  return SegmentedSortPairsDescending(ctx, selected_values_ptr, values.data(),
+                                      selected_indices_ptr, indices.data(),
+                                      num_rows, k);
+}
+
 }  // end namespace impl
 
 namespace functor {
@@ -559,13 +752,18 @@ struct TopKFunctor<GPUDevice, T> {
           const typename TTypes<T, 2>::ConstTensor& input, const int64 num_rows,
           const int64 num_cols, typename TTypes<T, 2>::Tensor values,
           typename TTypes<int, 2>::Tensor indices) {
-    // For small k, use the heap implementation.  For larger k, use
-    // the in-place gpuprim sort.  For k == num_cols, always use the
-    // in-place gpuprim sort.  The thresholds for n and k were determined
-    // empirically.
-    if (num_cols <= 1000 || k == num_cols || k >= 100) {
+    // For small k, use the heap implementation.  For larger k, select the
+    // top k with a radix select and only sort those.  For short rows, for
+    // k == num_cols and when k is more than a quarter of the row, sorting the
+    // whole row with the in-place gpuprim sort costs about the same, so always
+    // use that.  The heap thresholds for n and k were determined empirically.
+    if (num_cols <= 1000 || k == num_cols || (k >= 100 && 4 * k > num_cols)) {
       return impl::LaunchSortKernel(context, input.data(), num_rows, num_cols,
                                     k, values, indices);
+    } else if (k >= 100) {
+      return impl::LaunchRadixSelectKernel(context, input.data(), num_rows,
+                                           num_cols, k, sorted, values,
+                                           indices);
     } else {
       const auto& cu_stream = GetGpuStream(context);
       auto err = impl::LaunchTopKKernel(cu_stream, /* num_shards */ 0,
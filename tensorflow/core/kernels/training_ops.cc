@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -40,6 +42,66 @@ inline T sgn(const T x) {
   T one(1);
   return (x == zero ? zero : (x < zero ? -one : one));
 }
+
+// The updates of a sparse apply op grouped by the row of the variable they
+// touch. Sharding the work over distinct rows lets the update run in parallel
+// without two threads ever writing to the same row, even when the indices
+// contain hot keys, while repeated indices are still applied one after another
+// in their original order.
+template <typename Tindex>
+class SparseRowUpdates {
+ public:
+  // Validates 'indices' against 'first_dim_size' and groups them by row.
+  Status Init(typename TTypes<Tindex>::ConstVec indices,
+              Tindex first_dim_size) {
+    const Tindex N = static_cast<Tindex>(indices.dimension(0));
+    updates_.resize(N);
+    for (Tindex i = 0; i < N; ++i) {
+      const Tindex index = internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, first_dim_size)) {
+        return errors::InvalidArgument(
+            strings::StrCat("Index ", index, " at offset ", i,
+                            " in indices is out of range"));
+      }
+      updates_[i] = {index, i};
+    }
+    // Sorting the (row, offset) pairs keeps repeated rows in offset order.
+    if (!std::is_sorted(updates_.begin(), updates_.end())) {
+      std::sort(updates_.begin(), updates_.end());
+    }
+    row_starts_.clear();
+    for (Tindex k = 0; k < N; ++k) {
+      if (k == 0 || updates_[k].first != updates_[k - 1].first) {
+        row_starts_.push_back(k);
+      }
+    }
+    row_starts_.push_back(N);
+    return Status::OK();
+  }
+
+  // Number of distinct rows updated.
+  Tindex num_rows() const { return row_starts_.size() - 1; }
+
+  // Average number of updates applied to each distinct row.
+  double updates_per_row() const {
+    return num_rows() == 0 ? 0.0
+                           : static_cast<double>(updates_.size()) / num_rows();
+  }
+
+  // Calls fn(index, i) for every update to the distinct rows in
+  // [start_row, end_row), where 'index' is the row of the variable and 'i' the
+  // offset of the update in 'indices'.
+  template <typename Fn>
+  void ForEachUpdate(Tindex start_row, Tindex end_row, const Fn& fn) const {
+    for (Tindex k = row_starts_[start_row]; k < row_starts_[end_row]; ++k) {
+      fn(updates_[k].first, updates_[k].second);
+    }
+  }
+
+ private:
+  std::vector<std::pair<Tindex, Tindex>> updates_;
+  std::vector<Tindex> row_starts_;
+};
 }  // namespace
 
 namespace functor {
@@ -181,19 +243,12 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
                                     Eigen::TensorOpCost::MulCost<T>() * 2);
     const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
 
-    if (inner_dim > 1) {
-      for (Tindex i = 0; i < N; ++i) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-      }
+    SparseRowUpdates<Tindex> updates;
+    TF_RETURN_IF_ERROR(updates.Init(indices, first_dim_size));
 
-      const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
-        for (Tindex i = start_idx; i < end_idx; ++i) {
-          const Tindex index = internal::SubtleMustCopy(indices(i));
+    if (inner_dim > 1) {
+      const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+        updates.ForEachUpdate(start_row, end_row, [&](Tindex index, Tindex i) {
           auto a = accum.template chip<0>(index);
           auto g = grad.template chip<0>(i);
           auto v = var.template chip<0>(index);
@@ -205,23 +260,14 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
           } else {
             v -= g.constant(lr_scalar) * g * a.rsqrt();
           }
-        }
+        });
       };
 
-      d.parallelFor(N, cost, shard);
+      d.parallelFor(updates.num_rows(), cost * updates.updates_per_row(),
+                    shard);
     } else {
-      for (Tindex i = 0; i < N; ++i) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-      }
-
-      const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
-        for (Tindex i = start_idx; i < end_idx; ++i) {
-          const Tindex index = internal::SubtleMustCopy(indices(i));
+      const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+        updates.ForEachUpdate(start_row, end_row, [&](Tindex index, Tindex i) {
           T& a = accum(index);
           const T& g = grad(i);
           if (update_slots) {
@@ -232,10 +278,11 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
           } else {
             var(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
           }
-        }
+        });
       };
 
-      d.parallelFor(N, cost, shard);
+      d.parallelFor(updates.num_rows(), cost * updates.updates_per_row(),
+                    shard);
     }
 
     return Status::OK();
@@ -286,57 +333,65 @@ struct SparseApplyProximalAdagrad<CPUDevice, T, Tindex> {
     const T lr_scalar = lr();
     const T l1_scalar = l1();
     const T l2_scalar = l2();
+    const int in_bytes = inner_dim * sizeof(T) * 3;
+    const int out_bytes = inner_dim * sizeof(T) * 2;
+    const int cycles = inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 4 +
+                                    Eigen::TensorOpCost::MulCost<T>() * 4 +
+                                    Eigen::TensorOpCost::DivCost<T>());
+    const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
+
+    SparseRowUpdates<Tindex> updates;
+    TF_RETURN_IF_ERROR(updates.Init(indices, first_dim_size));
+
     if (inner_dim > 1) {
-      for (Tindex i = 0; i < N; i++) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-        auto a = accum.template chip<0>(index);
-        auto g = grad.template chip<0>(i);
-        auto v = var.template chip<0>(index);
-        a += g.square();
-        // compute learning_rate for current step.
-        auto learning_rate = a.constant(lr_scalar) * a.rsqrt();
-        auto prox_v = v;
-        // v = w - g * learning_rate.
-        prox_v -= g * learning_rate;
-        if (l1_scalar > 0) {
-          // compute sign(v) * max(|v|, 0)
-          v = prox_v.sign() *
-              (prox_v.abs() - learning_rate * prox_v.constant(l1_scalar))
-                  .cwiseMax(static_cast<T>(0.0)) /
-              (v.constant(1.0) + v.constant(l2_scalar) * learning_rate);
-        } else {
-          v = prox_v /
-              (v.constant(1.0) + v.constant(l2_scalar) * learning_rate);
-        }
-      }
+      const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+        updates.ForEachUpdate(start_row, end_row, [&](Tindex index, Tindex i) {
+          auto a = accum.template chip<0>(index);
+          auto g = grad.template chip<0>(i);
+          auto v = var.template chip<0>(index);
+          a += g.square();
+          // compute learning_rate for current step.
+          auto learning_rate = a.constant(lr_scalar) * a.rsqrt();
+          auto prox_v = v;
+          // v = w - g * learning_rate.
+          prox_v -= g * learning_rate;
+          if (l1_scalar > 0) {
+            // compute sign(v) * max(|v|, 0)
+            v = prox_v.sign() *
+                (prox_v.abs() - learning_rate * prox_v.constant(l1_scalar))
+                    .cwiseMax(static_cast<T>(0.0)) /
+                (v.constant(1.0) + v.constant(l2_scalar) * learning_rate);
+          } else {
+            v = prox_v /
+                (v.constant(1.0) + v.constant(l2_scalar) * learning_rate);
+          }
+        });
+      };
+
+      d.parallelFor(updates.num_rows(), cost * updates.updates_per_row(),
+                    shard);
     } else {
-      for (Tindex i = 0; i < N; i++) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-        T& a = accum(index);
-        const T& g = grad(i);
-        a += g * g;
-        auto learning_rate = lr_scalar / std::sqrt(a);
-        auto prox_v = var(index);
-        prox_v -= learning_rate * g;
-        if (l1_scalar > 0) {
-          var(index) = sgn(prox_v) *
-                       std::max(std::abs(prox_v) - learning_rate * l1_scalar,
-                                static_cast<T>(0.0)) /
-                       (1.0 + l2_scalar * learning_rate);
-        } else {
-          var(index) = prox_v / (1.0 + l2_scalar * learning_rate);
-        }
-      }
+      const auto shard = [&](Tindex start_row, Tindex end_row) -> void {
+        updates.ForEachUpdate(start_row, end_row, [&](Tindex index, Tindex i) {
+          T& a = accum(index);
+          const T& g = grad(i);
+          a += g * g;
+          auto learning_rate = lr_scalar / std::sqrt(a);
+          auto prox_v = var(index);
+          prox_v -= learning_rate * g;
+          if (l1_scalar > 0) {
+            var(index) = sgn(prox_v) *
+                         std::max(std::abs(prox_v) - learning_rate * l1_scalar,
+                                  static_cast<T>(0.0)) /
+                         (1.0 + l2_scalar * learning_rate);
+          } else {
+            var(index) = prox_v / (1.0 + l2_scalar * learning_rate);
+          }
+        });
+      };
+
+      d.parallelFor(updates.num_rows(), cost * updates.updates_per_row(),
+                    shard);
     }
     return Status::OK();
   }
@@ -608,17 +663,19 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
         l2_shrinkage_scalar = l2_shrinkage();
       }
       T lr_power_scalar = lr_power();
+      const int in_bytes = inner_dim * sizeof(T) * 4;
+      const int out_bytes = inner_dim * sizeof(T) * 3;
+      const int cycles = inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 6 +
+                                      Eigen::TensorOpCost::MulCost<T>() * 6 +
+                                      Eigen::TensorOpCost::DivCost<T>() * 2);
+      const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
+      SparseRowUpdates<Tindex> updates;
       if (inner_dim > 1) {
         const Tindex first_dim_size =
             static_cast<Tindex>(var_flat.dimension(0));
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
-          }
+        TF_RETURN_IF_ERROR(updates.Init(indices_vec, first_dim_size));
+        const auto update = [&](Tindex index, Tindex i) {
           auto accum = accum_flat.template chip<0>(index);
           auto linear = linear_flat.template chip<0>(index);
           auto grad = grad_flat.template chip<0>(i);
@@ -642,17 +699,16 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
                         /*lr_power_scalar=*/lr_power_scalar,
                         /*lr_scalar=*/lr_scalar);
           }
-        }
+        };
+        d.parallelFor(updates.num_rows(), cost * updates.updates_per_row(),
+                      [&](Tindex start_row, Tindex end_row) {
+                        updates.ForEachUpdate(start_row, end_row, update);
+                      });
       } else {
         const Tindex first_dim_size = accum_flat.size();
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
-          }
+        TF_RETURN_IF_ERROR(updates.Init(indices_vec, first_dim_size));
+        const auto update = [&](Tindex index, Tindex i) {
           T& a = accum_flat(index);
           T& l = linear_flat(index);
           T& v = var_flat(index);
@@ -676,7 +732,11 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
                           lr_power_scalar, multiply_linear_by_lr);
           a = updated_a;
           l = updated_l;
-        }
+        };
+        d.parallelFor(updates.num_rows(), cost * updates.updates_per_row(),
+                      [&](Tindex start_row, Tindex end_row) {
+                        updates.ForEachUpdate(start_row, end_row, update);
+                      });
       }
     }
     return Status::OK();
@@ -113,8 +113,10 @@ inline void ReduceTransposeDimensions(const TensorShape& shape,
   dim_idx = 0;
   for (int i = 0; i < new_dim_position.size(); ++i) {
     if (new_dim_position[i] >= 0) {
+      // The dim_idx-th combined input dimension moves to output position
+      // new_dim_position[i].
       int new_perm_idx = new_dim_position[i];
-      (*new_perm)[dim_idx] = new_perm_idx;
+      (*new_perm)[new_perm_idx] = dim_idx;
       (*new_dims)[dim_idx] = combined_dims[new_perm_idx];
       dim_idx++;
     }
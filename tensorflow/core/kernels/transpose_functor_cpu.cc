@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -65,13 +66,147 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// The side of the square tiles of TransposeBlocked. A tile row is one 64-byte
+// cache line for types of up to 8 bytes, and 8 elements for larger types.
+template <typename T>
+constexpr int TransposeTileSize() {
+  return sizeof(T) >= 8 ? 8 : 64 / sizeof(T);
+}
+
+// Copies the `rows` x `cols` tile at `src`, with rows `src_stride` elements
+// apart, to its transpose at `dst`, with rows `dst_stride` elements apart.
+template <typename T, bool conjugate>
+inline void TransposeTile(const T* src, int64 src_stride, T* dst,
+                          int64 dst_stride, int64 rows, int64 cols) {
+  for (int64 j = 0; j < cols; ++j) {
+    for (int64 i = 0; i < rows; ++i) {
+      if (conjugate) {
+        dst[j * dst_stride + i] = Eigen::numext::conj(src[i * src_stride + j]);
+      } else {
+        dst[j * dst_stride + i] = src[i * src_stride + j];
+      }
+    }
+  }
+}
+
+// Transposes permutations that move the innermost input dimension. The
+// innermost input dimension and the input dimension that becomes innermost in
+// the output are transposed in square tiles, so that both the reads and the
+// writes of a tile touch few cache lines. The tiles of all the other
+// dimensions are independent units of work.
+template <typename T, bool conjugate>
+void TransposeBlocked(const CPUDevice& device, const Tensor& in,
+                      const gtl::ArraySlice<int32> perm, Tensor* out) {
+  constexpr int kTile = TransposeTileSize<T>();
+  const int ndims = in.dims();
+  gtl::InlinedVector<int64, 8> in_strides = ComputeStride<int64>(in.shape());
+  gtl::InlinedVector<int64, 8> out_strides = ComputeStride<int64>(out->shape());
+
+  // The rows of a tile run along the input dimension that is innermost in the
+  // output, and its columns along the innermost input dimension, which is
+  // at output position `col_pos`.
+  const int row_dim = perm[ndims - 1];
+  const int col_pos =
+      std::find(perm.begin(), perm.end(), ndims - 1) - perm.begin();
+  const int64 rows = in.dim_size(row_dim);
+  const int64 cols = in.dim_size(ndims - 1);
+  const int64 src_stride = in_strides[row_dim];
+  const int64 dst_stride = out_strides[col_pos];
+
+  gtl::InlinedVector<int64, 8> outer_sizes;
+  gtl::InlinedVector<int64, 8> outer_in_strides;
+  gtl::InlinedVector<int64, 8> outer_out_strides;
+  int64 num_outer = 1;
+  for (int i = 0; i < ndims - 1; ++i) {
+    if (i == col_pos) continue;
+    outer_sizes.push_back(out->dim_size(i));
+    outer_in_strides.push_back(in_strides[perm[i]]);
+    outer_out_strides.push_back(out_strides[i]);
+    num_outer *= out->dim_size(i);
+  }
+  const int num_outer_dims = outer_sizes.size();
+  const int64 row_tiles = (rows + kTile - 1) / kTile;
+  const int64 col_tiles = (cols + kTile - 1) / kTile;
+
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+  auto transpose_fn = [=, &outer_sizes, &outer_in_strides,
+                       &outer_out_strides](int64 begin, int64 end) {
+    for (int64 unit = begin; unit < end; ++unit) {
+      int64 t = unit;
+      const int64 col = (t % col_tiles) * kTile;
+      t /= col_tiles;
+      const int64 row = (t % row_tiles) * kTile;
+      t /= row_tiles;
+      int64 in_offset = row * src_stride + col;
+      int64 out_offset = col * dst_stride + row;
+      for (int i = num_outer_dims - 1; i >= 0; --i) {
+        const int64 idx = t % outer_sizes[i];
+        t /= outer_sizes[i];
+        in_offset += idx * outer_in_strides[i];
+        out_offset += idx * outer_out_strides[i];
+      }
+      if (row + kTile <= rows && col + kTile <= cols) {
+        // Compile-time bounds let the compiler unroll full tiles into
+        // register transposes.
+        TransposeTile<T, conjugate>(p + in_offset, src_stride, q + out_offset,
+                                    dst_stride, kTile, kTile);
+      } else {
+        TransposeTile<T, conjugate>(
+            p + in_offset, src_stride, q + out_offset, dst_stride,
+            std::min<int64>(kTile, rows - row),
+            std::min<int64>(kTile, cols - col));
+      }
+    }
+  };
+  const double cycles_per_tile =
+      kTile * kTile * (conjugate ? 2 : 1) +
+      num_outer_dims * (Eigen::TensorOpCost::DivCost<int64>() +
+                        2 * Eigen::TensorOpCost::MulCost<int64>() +
+                        2 * Eigen::TensorOpCost::AddCost<int64>());
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/kTile * kTile * sizeof(T),
+                           /*bytes_stored=*/kTile * kTile * sizeof(T),
+                           cycles_per_tile);
+  device.parallelFor(num_outer * row_tiles * col_tiles, cost,
+                     std::move(transpose_fn));
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (in.NumElements() == 0) return;
+    // Merge the dimensions that stay adjacent, which gives fewer and larger
+    // dimensions to iterate over. E.g. NHWC to NCHW becomes a batch of
+    // [HW, C] matrix transposes.
+    internal::TransposePermsVec new_perm;
+    internal::TransposeDimsVec new_dims(in.dims());
+    internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm,
+                                        &new_dims);
+    const int ndims = new_perm.size();
+    Tensor in_reshaped;
+    Tensor out_reshaped;
+    CHECK(in_reshaped.CopyFrom(in, TensorShape(new_dims)));
+    TensorShape out_shape;
+    for (int i = 0; i < ndims; ++i) out_shape.AddDim(new_dims[new_perm[i]]);
+    CHECK(out_reshaped.CopyFrom(*out, out_shape));
+    if (ndims > 1 && new_perm[ndims - 1] != ndims - 1) {
+      TransposeBlocked<T, conjugate>(d, in_reshaped, new_perm, &out_reshaped);
+      return;
+    }
+    RunEigen(d, in_reshaped, new_perm, &out_reshaped);
+  }
+
+ private:
+  static void RunEigen(const CPUDevice& d, const Tensor& in,
+                       const gtl::ArraySlice<int32> perm, Tensor* out) {
     switch (in.dims()) {
+      case 1:
+        internal::TransposeUsingEigen<CPUDevice, T, 1>(d, in, perm, conjugate,
+                                                       out);
+        break;
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
                                                        out);
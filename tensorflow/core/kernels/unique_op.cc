@@ -26,12 +26,17 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+// Vectors with at least this many elements are uniquified by all the CPU
+// worker threads.
+constexpr int64 kParallelUniqueMinElements = 1 << 17;
+
 // `UniqueOpHashMap` defines the map type that is used when elements of type
 // `T` are to be uniquified. By default, we use `absl::flat_hash_map<T, TIndex>`
 // as the map type. Subsequent specializations are provided for
@@ -149,6 +154,12 @@ class UniqueOp : public OpKernel {
       // to them as in the general case.
       auto Tin = input.flat<T>();
       const int64 N = static_cast<int64>(Tin.size());
+      if (N >= kParallelUniqueMinElements &&
+          context->device()->tensorflow_cpu_worker_threads()->num_threads >
+              1) {
+        ComputeParallel(context, input, axis, idx_vec);
+        return;
+      }
 
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
@@ -237,6 +248,161 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Uniquifies the elements of the vector `input` with all the CPU worker
+  // threads. The elements are radix-partitioned by hash, so that equal
+  // elements land in the same partition, and every partition is uniquified
+  // on its own. The unique elements are then numbered with a prefix sum over
+  // the positions of their first occurrences, which gives the same outputs as
+  // the sequential implementation.
+  void ComputeParallel(OpKernelContext* context, const Tensor& input,
+                       int64 axis, typename TTypes<TIndex>::Vec idx_vec) {
+    using MapType = typename UniqueOpHashMap<T, TIndex>::map_type;
+    using KeyType = typename MapType::key_type;
+    auto Tin = input.flat<T>();
+    const int64 N = static_cast<int64>(Tin.size());
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+
+    // The input is split into as many contiguous chunks as there are
+    // partitions, and both are processed in parallel.
+    int log2_partitions = 1;
+    while ((1 << log2_partitions) < worker_threads.num_threads &&
+           log2_partitions < 6) {
+      ++log2_partitions;
+    }
+    const int num_partitions = 1 << log2_partitions;
+    const int64 chunk_size = (N + num_partitions - 1) / num_partitions;
+    auto for_each_part = [&worker_threads, num_partitions, chunk_size](
+                             int64 cost_per_element,
+                             const std::function<void(int)>& fn) {
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            num_partitions, chunk_size * cost_per_element,
+            [&fn](int64 start, int64 limit) {
+              for (int64 i = start; i < limit; ++i) fn(i);
+            });
+    };
+
+    // Assign every element to a partition, from the high bits of its hash so
+    // that the partitions don't skew the hashes seen by their own maps.
+    std::vector<uint8> partition_of(N);
+    std::vector<int64> offsets(num_partitions * num_partitions, 0);
+    for_each_part(20, [&](int chunk) {
+      const int64 begin = chunk * chunk_size;
+      const int64 end = std::min(N, begin + chunk_size);
+      typename MapType::hasher hasher;
+      int64* counts = &offsets[chunk * num_partitions];
+      for (int64 i = begin; i < end; ++i) {
+        const uint64 h = static_cast<uint64>(hasher(KeyType(Tin(i))));
+        const int partition =
+            (h * 0x9E3779B97F4A7C15ULL) >> (64 - log2_partitions);
+        partition_of[i] = partition;
+        ++counts[partition];
+      }
+    });
+
+    // Scatter the positions of the elements by partition. Every partition
+    // lists its positions in increasing order, so that the first insertion of
+    // an element into the map of its partition is its first occurrence.
+    std::vector<int64> partition_starts(num_partitions + 1);
+    int64 offset = 0;
+    for (int partition = 0; partition < num_partitions; ++partition) {
+      partition_starts[partition] = offset;
+      for (int chunk = 0; chunk < num_partitions; ++chunk) {
+        int64& chunk_offset = offsets[chunk * num_partitions + partition];
+        const int64 count = chunk_offset;
+        chunk_offset = offset;
+        offset += count;
+      }
+    }
+    partition_starts[num_partitions] = N;
+    std::vector<int32> positions(N);
+    for_each_part(5, [&](int chunk) {
+      const int64 begin = chunk * chunk_size;
+      const int64 end = std::min(N, begin + chunk_size);
+      int64* next = &offsets[chunk * num_partitions];
+      for (int64 i = begin; i < end; ++i) {
+        positions[next[partition_of[i]]++] = i;
+      }
+    });
+
+    // Uniquify every partition, leaving the index of every element within
+    // its partition in `idx_vec`, and flagging first occurrences in
+    // `first_ranks`.
+    std::vector<std::vector<int32>> first_positions(num_partitions);
+    std::vector<int32> first_ranks(N, 0);
+    for_each_part(50, [&](int partition) {
+      const int64 begin = partition_starts[partition];
+      const int64 end = partition_starts[partition + 1];
+      std::vector<int32>& firsts = first_positions[partition];
+      MapType uniq;
+      uniq.reserve(2 * (end - begin));
+      for (int64 k = begin; k < end; ++k) {
+        const int32 i = positions[k];
+        auto it = uniq.emplace(Tin(i), static_cast<TIndex>(firsts.size()));
+        idx_vec(i) = it.first->second;
+        if (it.second) {
+          firsts.push_back(i);
+          first_ranks[i] = 1;
+        }
+      }
+    });
+
+    // Number the first occurrences in order of position.
+    std::vector<int64> chunk_ranks(num_partitions + 1, 0);
+    for_each_part(1, [&](int chunk) {
+      const int64 begin = chunk * chunk_size;
+      const int64 end = std::min(N, begin + chunk_size);
+      int64 count = 0;
+      for (int64 i = begin; i < end; ++i) count += first_ranks[i];
+      chunk_ranks[chunk + 1] = count;
+    });
+    for (int chunk = 0; chunk < num_partitions; ++chunk) {
+      chunk_ranks[chunk + 1] += chunk_ranks[chunk];
+    }
+    for_each_part(1, [&](int chunk) {
+      const int64 begin = chunk * chunk_size;
+      const int64 end = std::min(N, begin + chunk_size);
+      int32 rank = chunk_ranks[chunk];
+      for (int64 i = begin; i < end; ++i) {
+        if (first_ranks[i]) first_ranks[i] = rank++;
+      }
+    });
+
+    const int64 uniq_size = chunk_ranks[num_partitions];
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    const bool with_counts = num_outputs() > 2;
+    TIndex* counts = nullptr;
+    if (with_counts) {
+      Tensor* count_output = nullptr;
+      OP_REQUIRES_OK(context, context->allocate_output(
+                                  2, TensorShape({uniq_size}), &count_output));
+      count_output->vec<TIndex>().setZero();
+      counts = count_output->vec<TIndex>().data();
+    }
+
+    // Translate the indices within partitions to output indices. Different
+    // partitions write disjoint unique elements and counts.
+    for_each_part(10, [&](int partition) {
+      const std::vector<int32>& firsts = first_positions[partition];
+      std::vector<TIndex> output_index(firsts.size());
+      for (size_t u = 0; u < firsts.size(); ++u) {
+        output_index[u] = first_ranks[firsts[u]];
+        Tout(output_index[u]) = Tin(firsts[u]);
+      }
+      for (int64 k = partition_starts[partition];
+           k < partition_starts[partition + 1]; ++k) {
+        const int32 i = positions[k];
+        idx_vec(i) = output_index[idx_vec(i)];
+        if (with_counts) ++counts[idx_vec(i)];
+      }
+    });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                    \
@@ -15,12 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/inputbuffer.h"
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 namespace io {
 
+// Buffers of at least this many bytes are filled through
+// RandomAccessFile::MultiRead(), which may keep several parts of the read in
+// flight at once.
+constexpr size_t kMinMultiReadBytes = 256 << 10;
+
 InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes)
     : file_(file),
       file_pos_(0),
@@ -33,7 +40,18 @@ InputBuffer::~InputBuffer() { delete[] buf_; }
 
 Status InputBuffer::FillBuffer() {
   StringPiece data;
-  Status s = file_->Read(file_pos_, size_, &data, buf_);
+  Status s;
+  if (size_ >= kMinMultiReadBytes) {
+    std::vector<RandomAccessFile::ReadRequest> requests(1);
+    requests[0].offset = file_pos_;
+    requests[0].n = size_;
+    requests[0].scratch = buf_;
+    file_->MultiRead(&requests);
+    data = requests[0].result;
+    s = requests[0].status;
+  } else {
+    s = file_->Read(file_pos_, size_, &data, buf_);
+  }
   if (data.data() != buf_) {
     memmove(buf_, data.data(), data.size());
   }
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include <memory>
+#include <vector>
 
 namespace tensorflow {
 namespace io {
 
+// Reads of at least this many bytes go through RandomAccessFile::MultiRead(),
+// which may keep several parts of them in flight at once.
+constexpr int64 kMinMultiReadBytes = 256 << 10;
+
 RandomAccessInputStream::RandomAccessInputStream(RandomAccessFile* file,
                                                  bool owns_file)
     : file_(file), owns_file_(owns_file) {}
@@ -38,7 +43,18 @@ Status RandomAccessInputStream::ReadNBytes(int64 bytes_to_read,
   result->resize_uninitialized(bytes_to_read);
   char* result_buffer = &(*result)[0];
   StringPiece data;
-  Status s = file_->Read(pos_, bytes_to_read, &data, result_buffer);
+  Status s;
+  if (bytes_to_read >= kMinMultiReadBytes) {
+    std::vector<RandomAccessFile::ReadRequest> requests(1);
+    requests[0].offset = pos_;
+    requests[0].n = bytes_to_read;
+    requests[0].scratch = result_buffer;
+    file_->MultiRead(&requests);
+    data = requests[0].result;
+    s = requests[0].status;
+  } else {
+    s = file_->Read(pos_, bytes_to_read, &data, result_buffer);
+  }
   if (data.data() != result_buffer) {
     memmove(result_buffer, data.data(), data.size());
   }
@@ -0,0 +1,106 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+
+namespace tensorflow {
+namespace io {
+
+ReadaheadInputStream::ReadaheadInputStream(InputStreamInterface* input_stream,
+                                           size_t chunk_bytes, Env* env,
+                                           bool owns_input_stream)
+    : input_stream_(input_stream),
+      chunk_bytes_(std::max<size_t>(chunk_bytes, 1)),
+      env_(env),
+      owns_input_stream_(owns_input_stream) {}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  if (readahead_started_) {
+    WaitForReadahead();
+  }
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+void ReadaheadInputStream::StartReadahead() {
+  {
+    mutex_lock l(mu_);
+    readahead_pending_ = true;
+  }
+  readahead_started_ = true;
+  env_->SchedClosure([this]() {
+    next_chunk_status_ = input_stream_->ReadNBytes(chunk_bytes_, &next_chunk_);
+    mutex_lock l(mu_);
+    readahead_pending_ = false;
+    readahead_done_.notify_all();
+  });
+}
+
+void ReadaheadInputStream::WaitForReadahead() {
+  {
+    mutex_lock l(mu_);
+    while (readahead_pending_) {
+      readahead_done_.wait(l);
+    }
+  }
+  readahead_started_ = false;
+  std::swap(chunk_, next_chunk_);
+  chunk_pos_ = 0;
+  chunk_status_ = next_chunk_status_;
+}
+
+Status ReadaheadInputStream::ReadNBytes(int64 bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  while (bytes_to_read > 0) {
+    const size_t num_bytes =
+        std::min<size_t>(bytes_to_read, chunk_.size() - chunk_pos_);
+    result->append(chunk_.data() + chunk_pos_, num_bytes);
+    chunk_pos_ += num_bytes;
+    bytes_to_read -= num_bytes;
+    bytes_read_ += num_bytes;
+    if (bytes_to_read == 0) break;
+
+    // `chunk_` is exhausted.  A short or failed read ends the stream.
+    if (!chunk_status_.ok()) return chunk_status_;
+    if (!readahead_started_) StartReadahead();
+    WaitForReadahead();
+    if (chunk_status_.ok()) StartReadahead();
+  }
+  return Status::OK();
+}
+
+int64 ReadaheadInputStream::Tell() const { return bytes_read_; }
+
+Status ReadaheadInputStream::Reset() {
+  if (readahead_started_) {
+    WaitForReadahead();
+  }
+  chunk_.clear();
+  chunk_pos_ = 0;
+  chunk_status_ = Status::OK();
+  bytes_read_ = 0;
+  return input_stream_->Reset();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Reads the next `chunk_bytes` bytes of an InputStreamInterface on a
+// background thread while the caller consumes the current chunk.
+//
+// This is useful on top of decompressing streams such as ZlibInputStream, so
+// that the decompression of a file overlaps with the processing of the data
+// already decompressed.  A single instance of ReadaheadInputStream is NOT
+// safe for concurrent use by multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of input_stream unless owns_input_stream is set
+  // to true. input_stream must outlive *this then.  The background reads are
+  // scheduled with `env->SchedClosure()`.
+  ReadaheadInputStream(InputStreamInterface* input_stream, size_t chunk_bytes,
+                       Env* env, bool owns_input_stream = false);
+
+  ~ReadaheadInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Starts reading the next chunk into `next_chunk_`.
+  void StartReadahead();
+
+  // Waits for the pending background read and makes its chunk current.
+  void WaitForReadahead();
+
+  InputStreamInterface* input_stream_;
+  const size_t chunk_bytes_;
+  Env* const env_;
+  const bool owns_input_stream_;
+
+  // The chunk being consumed by the caller, and the position of its first
+  // unread byte.
+  tstring chunk_;
+  size_t chunk_pos_ = 0;
+  // The status of the read that produced `chunk_`.  The caller gets it once
+  // `chunk_` is exhausted, unless it is OK.
+  Status chunk_status_;
+  // Whether a chunk is being read in the background, or is ready in
+  // `next_chunk_`.
+  bool readahead_started_ = false;
+
+  mutex mu_;
+  condition_variable readahead_done_;
+  bool readahead_pending_ TF_GUARDED_BY(mu_) = false;
+  // Only accessed by the background read while `readahead_pending_`.
+  tstring next_chunk_;
+  Status next_chunk_status_;
+
+  // Number of bytes returned to the caller so far.
+  int64 bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadaheadInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_READAHEAD_INPUTSTREAM_H_
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
 namespace io {
@@ -58,6 +59,7 @@ RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
+      region_(nullptr),
       last_read_failed_(false) {
   if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
@@ -72,11 +74,21 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(new ZlibInputStream(
         input_stream_.release(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
+    if (options.decompress_in_background) {
+      input_stream_.reset(new ReadaheadInputStream(
+          input_stream_.release(), options.zlib_options.output_buffer_size,
+          Env::Default(), true));
+    }
   } else if (options.compression_type ==
              RecordReaderOptions::SNAPPY_COMPRESSION) {
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+    if (options.decompress_in_background) {
+      input_stream_.reset(new ReadaheadInputStream(
+          input_stream_.release(), options.snappy_options.output_buffer_size,
+          Env::Default(), true));
+    }
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -85,12 +97,28 @@ RecordReader::RecordReader(RandomAccessFile* file,
 #endif
 }
 
+RecordReader::RecordReader(ReadOnlyMemoryRegion* region,
+                           const RecordReaderOptions& options)
+    : options_(options), region_(region), last_read_failed_(false) {
+  if (options.compression_type != RecordReaderOptions::NONE) {
+    LOG(FATAL) << "Compression is unsupported when reading from a "
+               << "memory-mapped file.";
+  }
+}
+
+bool RecordReader::ShouldVerifyDataChecksum() {
+  const int64 period = options_.checksum_sample_period;
+  return period > 0 && num_records_read_++ % period == 0;
+}
+
 // Read n+4 bytes from file, verify that checksum of first n bytes is
-// stored in the last 4 bytes and store the first n bytes in *result.
+// stored in the last 4 bytes (unless verify_checksum is false) and store the
+// first n bytes in *result.
 //
 // offset corresponds to the user-provided value to ReadRecord()
 // and is used only in error messages.
-Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result) {
+Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result,
+                                     bool verify_checksum) {
   if (n >= SIZE_MAX - sizeof(uint32)) {
     return errors::DataLoss("record size too large");
   }
@@ -106,14 +134,65 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result) {
     }
   }
 
-  const uint32 masked_crc = core::DecodeFixed32(result->data() + n);
-  if (crc32c::Unmask(masked_crc) != crc32c::Value(result->data(), n)) {
-    return errors::DataLoss("corrupted record at ", offset);
+  if (verify_checksum) {
+    const uint32 masked_crc = core::DecodeFixed32(result->data() + n);
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(result->data(), n)) {
+      return errors::DataLoss("corrupted record at ", offset);
+    }
   }
   result->resize(n);
   return Status::OK();
 }
 
+Status RecordReader::ReadMappedHeader(uint64 offset, uint64* length) {
+  const uint64 size = region_->length();
+  if (offset >= size) {
+    return errors::OutOfRange("eof");
+  }
+  if (size - offset < kHeaderSize) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  const char* header = static_cast<const char*>(region_->data()) + offset;
+  const uint32 masked_crc = core::DecodeFixed32(header + sizeof(uint64));
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(header, sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  *length = core::DecodeFixed64(header);
+  const uint64 remaining = size - offset - kHeaderSize;
+  if (*length > remaining || remaining - *length < kFooterSize) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  return Status::OK();
+}
+
+Status RecordReader::ReadMappedRecord(uint64* offset, tstring* record) {
+  uint64 length;
+  TF_RETURN_IF_ERROR(ReadMappedHeader(*offset, &length));
+  const char* data =
+      static_cast<const char*>(region_->data()) + *offset + kHeaderSize;
+  if (ShouldVerifyDataChecksum()) {
+    const uint32 masked_crc = core::DecodeFixed32(data + length);
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(data, length)) {
+      return errors::DataLoss("corrupted record at ", *offset);
+    }
+  }
+  record->assign_as_view(data, length);
+  *offset += kHeaderSize + length + kFooterSize;
+  return Status::OK();
+}
+
+Status RecordReader::SkipMappedRecords(uint64* offset, int num_to_skip,
+                                       int* num_skipped) {
+  *num_skipped = 0;
+  for (int i = 0; i < num_to_skip; ++i) {
+    uint64 length;
+    TF_RETURN_IF_ERROR(ReadMappedHeader(*offset, &length));
+    *offset += kHeaderSize + length + kFooterSize;
+    (*num_skipped)++;
+  }
+  return Status::OK();
+}
+
 Status RecordReader::GetMetadata(Metadata* md) {
   if (!md) {
     return errors::InvalidArgument(
@@ -121,6 +200,24 @@ Status RecordReader::GetMetadata(Metadata* md) {
   }
 
   // Compute the metadata of the TFRecord file if not cached.
+  if (!cached_metadata_ && region_ != nullptr) {
+    int64 data_size = 0;
+    int64 entries = 0;
+    uint64 offset = 0;
+    while (true) {
+      uint64 length;
+      Status s = ReadMappedHeader(offset, &length);
+      if (errors::IsOutOfRange(s)) break;
+      TF_RETURN_IF_ERROR(s);
+      offset += kHeaderSize + length + kFooterSize;
+      data_size += length;
+      ++entries;
+    }
+    cached_metadata_.reset(new Metadata());
+    cached_metadata_->stats.entries = entries;
+    cached_metadata_->stats.data_size = data_size;
+    cached_metadata_->stats.file_size = offset;
+  }
   if (!cached_metadata_) {
     TF_RETURN_IF_ERROR(input_stream_->Reset());
 
@@ -183,6 +280,9 @@ Status RecordReader::PositionInputStream(uint64 offset) {
 }
 
 Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
+  if (region_ != nullptr) {
+    return ReadMappedRecord(offset, record);
+  }
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
   // Read header data.
@@ -194,7 +294,8 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   const uint64 length = core::DecodeFixed64(record->data());
 
   // Read data
-  s = ReadChecksummed(*offset + kHeaderSize, length, record);
+  s = ReadChecksummed(*offset + kHeaderSize, length, record,
+                      ShouldVerifyDataChecksum());
   if (!s.ok()) {
     last_read_failed_ = true;
     if (errors::IsOutOfRange(s)) {
@@ -211,6 +312,9 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
 
 Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
                                  int* num_skipped) {
+  if (region_ != nullptr) {
+    return SkipMappedRecords(offset, num_to_skip, num_skipped);
+  }
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
   Status s;
@@ -245,5 +349,9 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+SequentialRecordReader::SequentialRecordReader(
+    ReadOnlyMemoryRegion* region, const RecordReaderOptions& options)
+    : underlying_(region, options), offset_(0) {}
+
 }  // namespace io
 }  // namespace tensorflow
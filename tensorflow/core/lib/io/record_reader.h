@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -31,6 +32,7 @@ limitations under the License.
 namespace tensorflow {
 
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
@@ -47,6 +49,18 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // The data of one in every `checksum_sample_period` records is verified
+  // against its checksum: 1 verifies every record, and 0 none of them. The
+  // checksum of the record headers, which hold the length of the data, is
+  // always verified.
+  int64 checksum_sample_period = 1;
+
+  // If true, compressed files are decompressed on a background thread, one
+  // output buffer ahead of the reader, so that decompression overlaps with
+  // the parsing and checksumming of the records.  Ignored without
+  // compression.
+  bool decompress_in_background = false;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -90,6 +104,16 @@ class RecordReader {
       RandomAccessFile* file,
       const RecordReaderOptions& options = RecordReaderOptions());
 
+  // Create a reader that will return log records from the memory-mapped file
+  // "*region", without copying them: ReadRecord() returns views (see
+  // tstring::assign_as_view) of the data in "*region". Compression is not
+  // supported and `options.buffer_size` is ignored.
+  // "*region" must remain live while this Reader or the records read by it
+  // are in use.
+  explicit RecordReader(
+      ReadOnlyMemoryRegion* region,
+      const RecordReaderOptions& options = RecordReaderOptions());
+
   virtual ~RecordReader() = default;
 
   // Read the record at "*offset" into *record and update *offset to
@@ -116,12 +140,25 @@ class RecordReader {
   Status GetMetadata(Metadata* md);
 
  private:
-  Status ReadChecksummed(uint64 offset, size_t n, tstring* result);
+  Status ReadChecksummed(uint64 offset, size_t n, tstring* result,
+                         bool verify_checksum = true);
   Status PositionInputStream(uint64 offset);
 
+  // Verifies the header of the record at "offset" in region_ and stores the
+  // length of its data in "*length".
+  Status ReadMappedHeader(uint64 offset, uint64* length);
+  Status ReadMappedRecord(uint64* offset, tstring* record);
+  Status SkipMappedRecords(uint64* offset, int num_to_skip, int* num_skipped);
+
+  // Returns true if the data of the next record should be verified against
+  // its checksum, according to `options_.checksum_sample_period`.
+  bool ShouldVerifyDataChecksum();
+
   RecordReaderOptions options_;
   std::unique_ptr<InputStreamInterface> input_stream_;
+  ReadOnlyMemoryRegion* const region_;  // Not owned; may be null.
   bool last_read_failed_;
+  int64 num_records_read_ = 0;
 
   std::unique_ptr<Metadata> cached_metadata_;
 
@@ -139,6 +176,13 @@ class SequentialRecordReader {
       RandomAccessFile* file,
       const RecordReaderOptions& options = RecordReaderOptions());
 
+  // Create a reader that will return views of the log records in the
+  // memory-mapped file "*region". "*region" must remain live while this
+  // Reader or the records read by it are in use.
+  explicit SequentialRecordReader(
+      ReadOnlyMemoryRegion* region,
+      const RecordReaderOptions& options = RecordReaderOptions());
+
   virtual ~SequentialRecordReader() = default;
 
   // Read the next record in the file into *record. Returns OK on success,
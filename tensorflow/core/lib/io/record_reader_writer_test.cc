@@ -229,6 +229,94 @@ TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestMemoryMapped) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_mmap_test";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_EXPECT_OK(writer.WriteRecord("hij"));
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::RecordReader reader(region.get());
+  uint64 offset = 0;
+  tstring record;
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("abc", record);
+  // The record is not copied out of the region.
+  EXPECT_EQ(tstring::VIEW, record.type());
+  EXPECT_EQ(static_cast<const char*>(region->data()) +
+                io::RecordReader::kHeaderSize,
+            record.data());
+  int num_skipped;
+  TF_CHECK_OK(reader.SkipRecords(&offset, 1, &num_skipped));
+  EXPECT_EQ(1, num_skipped);
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("hij", record);
+  EXPECT_EQ(error::OUT_OF_RANGE, reader.ReadRecord(&offset, &record).code());
+
+  io::RecordReader::Metadata md;
+  TF_ASSERT_OK(reader.GetMetadata(&md));
+  EXPECT_EQ(3, md.stats.entries);
+  EXPECT_EQ(10, md.stats.data_size);
+  EXPECT_EQ(58, md.stats.file_size);
+}
+
+TEST(RecordReaderWriterTest, TestChecksumSampling) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_checksum_test";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_CHECK_OK(writer.Flush());
+  }
+  // Corrupt the data of the second record.
+  string contents;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  contents[io::RecordReader::kHeaderSize * 2 + io::RecordReader::kFooterSize +
+           3] = 'x';
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+
+  for (bool use_mmap : {false, true}) {
+    for (int64 period : {0, 1, 2}) {
+      std::unique_ptr<RandomAccessFile> file;
+      std::unique_ptr<ReadOnlyMemoryRegion> region;
+      std::unique_ptr<io::RecordReader> reader;
+      io::RecordReaderOptions options;
+      options.checksum_sample_period = period;
+      if (use_mmap) {
+        TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+        reader.reset(new io::RecordReader(region.get(), options));
+      } else {
+        TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+        reader.reset(new io::RecordReader(file.get(), options));
+      }
+      uint64 offset = 0;
+      tstring record;
+      TF_CHECK_OK(reader->ReadRecord(&offset, &record));
+      EXPECT_EQ("abc", record);
+      Status s = reader->ReadRecord(&offset, &record);
+      if (period == 1) {
+        EXPECT_EQ(error::DATA_LOSS, s.code());
+      } else {
+        // The second record is not verified when checking none or one in two
+        // of the records.
+        TF_EXPECT_OK(s);
+        EXPECT_EQ("xefg", record);
+      }
+    }
+  }
+}
+
 TEST(RecordReaderWriterTest, TestSnappy) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
@@ -305,6 +393,50 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestZlibDecompressInBackground) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zlib_bg_test";
+
+  for (auto buf_size : BufferSizes()) {
+    // Zlib compression needs output buffer size > 1.
+    if (buf_size == 1) continue;
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options;
+      options.compression_type = io::RecordWriterOptions::ZLIB_COMPRESSION;
+      options.zlib_options.output_buffer_size = buf_size;
+      io::RecordWriter writer(file.get(), options);
+      TF_EXPECT_OK(writer.WriteRecord("abc"));
+      TF_EXPECT_OK(writer.WriteRecord("defg"));
+      TF_CHECK_OK(writer.Flush());
+    }
+
+    {
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options;
+      options.compression_type = io::RecordReaderOptions::ZLIB_COMPRESSION;
+      options.zlib_options.output_buffer_size = buf_size;
+      options.decompress_in_background = true;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      tstring record;
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("abc", record);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("defg", record);
+      EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+
+      // Seeking backwards resets the stream.
+      offset = 0;
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("abc", record);
+    }
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
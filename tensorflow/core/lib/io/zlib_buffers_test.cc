@@ -214,6 +214,29 @@ void WriteCompressedFile(Env* env, const string& fname, int input_buf_size,
   TF_ASSERT_OK(file_writer->Close());
 }
 
+TEST(ZlibInputStream, LargeReadPastEndOfStream) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string data = GenTestString(50);
+  WriteCompressedFile(env, fname, 200, 200, CompressionOptions::DEFAULT(),
+                      data);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  std::unique_ptr<RandomAccessInputStream> input_stream(
+      new RandomAccessInputStream(file_reader.get()));
+  ZlibInputStream in(input_stream.get(), 200, 200,
+                     CompressionOptions::DEFAULT());
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(10, &result));
+  EXPECT_EQ(result, data.substr(0, 10));
+  // Inflated straight into `result`, since it spans many output buffers.
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(data.size(), &result)));
+  EXPECT_EQ(result, data.substr(10));
+  EXPECT_EQ(in.Tell(), static_cast<int64>(data.size()));
+}
+
 void TestTell(CompressionOptions input_options,
               CompressionOptions output_options) {
   Env* env = Env::Default();
@@ -249,7 +272,7 @@ void TestTell(CompressionOptions input_options,
         tstring second_half;
         TF_ASSERT_OK(
             in.ReadNBytes(data.size() - first_half.size(), &second_half));
-        EXPECT_EQ(in.Tell(), data.size());
+        EXPECT_EQ(in.Tell(), static_cast<int64>(data.size()));
         bytes_read.append(second_half);
 
         // Expect that the file is correctly read.
@@ -293,7 +316,7 @@ void TestSkipNBytes(CompressionOptions input_options,
         tstring bytes_read;
         TF_ASSERT_OK(in.ReadNBytes(second_half.size(), &bytes_read));
         EXPECT_EQ(bytes_read, second_half);
-        EXPECT_EQ(in.Tell(), data.size());
+        EXPECT_EQ(in.Tell(), static_cast<int64>(data.size()));
       }
     }
   }
@@ -17,6 +17,9 @@ limitations under the License.
 
 #include <zlib.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/strcat.h"
 
@@ -208,6 +211,18 @@ Status ZlibInputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
 
     // Now that the cache is empty we need to inflate more data.
 
+    // Reads of at least a full output buffer are inflated directly into
+    // `result`, which saves copying them out of the output buffer.
+    if (bytes_to_read >= static_cast<int64>(output_buffer_capacity_)) {
+      size_t bytes_inflated;
+      TF_RETURN_IF_ERROR(InflateInto(bytes_to_read, result, &bytes_inflated));
+      if (bytes_inflated == 0) {
+        TF_RETURN_IF_ERROR(ReadFromStream());
+      }
+      bytes_to_read -= bytes_inflated;
+      continue;
+    }
+
     // Step 1. Setup output stream.
     z_stream_def_->stream->next_out = z_stream_def_->output.get();
     next_unread_byte_ = reinterpret_cast<char*>(z_stream_def_->output.get());
@@ -258,5 +273,27 @@ Status ZlibInputStream::Inflate() {
   return Status::OK();
 }
 
+Status ZlibInputStream::InflateInto(int64 bytes_to_read, tstring* result,
+                                    size_t* bytes_inflated) {
+  const size_t offset = result->size();
+  const uInt capacity = static_cast<uInt>(std::min<int64>(
+      bytes_to_read, std::numeric_limits<uInt>::max()));
+  result->resize_uninitialized(offset + capacity);
+  z_stream_def_->stream->next_out =
+      reinterpret_cast<Bytef*>(result->mdata() + offset);
+  z_stream_def_->stream->avail_out = capacity;
+
+  Status s = Inflate();
+  *bytes_inflated = capacity - z_stream_def_->stream->avail_out;
+  result->resize(offset + *bytes_inflated);
+  bytes_read_ += *bytes_inflated;
+
+  // Leave the output buffer empty, as if its contents had all been read.
+  z_stream_def_->stream->next_out = z_stream_def_->output.get();
+  next_unread_byte_ = reinterpret_cast<char*>(z_stream_def_->output.get());
+  z_stream_def_->stream->avail_out = output_buffer_capacity_;
+  return s;
+}
+
 }  // namespace io
 }  // namespace tensorflow
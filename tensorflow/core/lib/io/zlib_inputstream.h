@@ -108,6 +108,13 @@ class ZlibInputStream : public InputStreamInterface {
   // Calls `inflate()` and returns DataLoss Status if it failed.
   Status Inflate();
 
+  // Inflates up to `bytes_to_read` bytes straight into the end of `result`,
+  // bypassing the output buffer, and sets `*bytes_inflated` to the number of
+  // bytes produced.
+  // REQUIRES: NumUnreadBytes() == 0
+  Status InflateInto(int64 bytes_to_read, tstring* result,
+                     size_t* bytes_inflated);
+
   // Starts reading bytes at `next_unread_byte_` till either `bytes_to_read`
   // bytes have been read or `z_stream_->next_out` is reached.
   // Returns the number of bytes read and advances the `next_unread_byte_`
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -264,28 +265,110 @@ string NcclManager::GenerateCommunicatorKey() {
   return string(nccl_id.internal, NCCL_UNIQUE_ID_BYTES);
 }
 
+namespace {
+
+// Orders devices by device ID, executor, and global rank, which makes the
+// ordering of the members of communicators deterministic.
+bool CommunicatorDeviceLess(const NcclManager::CommunicatorDevice& a,
+                            const NcclManager::CommunicatorDevice& b) {
+  if (a.gpu_device_id != b.gpu_device_id) {
+    return a.gpu_device_id < b.gpu_device_id;
+  }
+  if (a.executor != b.executor) {
+    return a.executor < b.executor;
+  }
+  return a.global_rank < b.global_rank;
+}
+
+// Initializes the NCCL communicators of `devices` into `nccl_comms`.
+Status InitNcclComms(
+    const string& communicator_key, int num_global_devices,
+    const std::vector<NcclManager::CommunicatorDevice>& devices,
+    std::vector<ncclComm_t>* nccl_comms) {
+  const int num_local_devices = devices.size();
+  nccl_comms->resize(num_local_devices);
+#if NCCL_MAJOR >= 2
+  // For NCCL 2, we always initialize using ncclCommInitRank guarded by NCCL
+  // group primitives.
+  ncclUniqueId nccl_id;
+  if (num_local_devices == num_global_devices) {
+    NCCL_RETURN_IF_ERROR(ncclGetUniqueId(&nccl_id));
+  } else {
+    StringToNcclUniqueId(communicator_key, &nccl_id);
+  }
+  int saved_device = 0;
+  CUDA_RETURN_IF_ERROR(cudaGetDevice(&saved_device));
+  NCCL_RETURN_IF_ERROR(ncclGroupStart());
+  for (int i = 0; i < num_local_devices; ++i) {
+    // Set rank to `global_rank` if provided, else `i`.
+    const int rank = devices[i].global_rank >= 0 ? devices[i].global_rank : i;
+    CUDA_RETURN_IF_ERROR(cudaSetDevice(devices[i].gpu_device_id));
+    NCCL_RETURN_IF_ERROR(ncclCommInitRank(nccl_comms->data() + i,
+                                          num_global_devices, nccl_id, rank));
+  }
+  NCCL_RETURN_IF_ERROR(ncclGroupEnd());
+  CUDA_RETURN_IF_ERROR(cudaSetDevice(saved_device));
+#else
+  // Since NCCL 1 is single node only, we use ncclCommInitAll.  We could have
+  // used ncclCommInitRank with NCCL 1 as well, but then we would have to
+  // issue each init call from a different thread
+  // (https://docs.nvidia.com/deeplearning/sdk/nccl-developer-guide/docs/nccl1.html).
+  std::vector<int> device_ids(num_local_devices);
+  for (int i = 0; i < num_local_devices; ++i) {
+    device_ids[i] = devices[i].gpu_device_id;
+  }
+  NCCL_RETURN_IF_ERROR(ncclCommInitAll(nccl_comms->data(), num_local_devices,
+                                       device_ids.data()));
+#endif
+  return Status::OK();
+}
+
+}  // namespace
+
 Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
                                     NcclManager::Communicator** communicator) {
-  // Sort by device ID, executor, and global rank to make ordering of
-  // participants deterministic.
+  // Sort participants the same way as their devices, so that participant `i`
+  // runs on member `i` of the communicator.
   std::sort(collective->participants.begin(), collective->participants.end(),
             [](const std::unique_ptr<Participant>& a,
                const std::unique_ptr<Participant>& b) {
-              if (a->gpu_device_id != b->gpu_device_id) {
-                return a->gpu_device_id < b->gpu_device_id;
-              }
-              if (a->executor != b->executor) {
-                return a->executor < b->executor;
-              }
-              return a->global_rank < b->global_rank;
+              return CommunicatorDeviceLess(CommunicatorDevice(*a),
+                                            CommunicatorDevice(*b));
             });
+  std::vector<CommunicatorDevice> devices;
+  devices.reserve(collective->participants.size());
+  for (const std::unique_ptr<Participant>& participant :
+       collective->participants) {
+    devices.emplace_back(*participant);
+  }
+  return GetCommunicator(collective->communicator_key,
+                         collective->num_global_devices, devices,
+                         communicator);
+}
 
-  mutex_lock l(mu_);
-  if (!status_.ok()) {
-    return status_;
+Status NcclManager::WarmUpCommunicator(
+    const string& communicator_key, int num_global_devices,
+    std::vector<CommunicatorDevice> devices) {
+  const int num_local_devices = devices.size();
+  if (num_local_devices == 0 || num_local_devices > num_global_devices) {
+    return errors::InvalidArgument("Cannot warm up a communicator of ",
+                                   num_local_devices, " local devices out of ",
+                                   num_global_devices);
   }
+  if (num_local_devices < num_global_devices && communicator_key.empty()) {
+    return errors::InvalidArgument(
+        "Multi-node communicators need a communicator_key");
+  }
+  std::sort(devices.begin(), devices.end(), CommunicatorDeviceLess);
+  Communicator* communicator;
+  return GetCommunicator(communicator_key, num_global_devices, devices,
+                         &communicator);
+}
 
-  if (collective->communicator_key.empty()) {
+NcclManager::Communicator* NcclManager::FindCommunicator(
+    const string& communicator_key, int num_global_devices,
+    const std::vector<CommunicatorDevice>& devices) {
+  if (communicator_key.empty()) {
     // For single-node collectives, when the caller does not specify a
     // `communicator_key`, we identify a communicator uniquely by the set of
     // devices participating in the collective.  For example, if a collective is
@@ -307,124 +390,136 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     // guaranteed currently by a global mutex controlling additions of the
     // kernels to per-stream launch queues.  The launch queues are processed by
     // LoopKernelLaunches.
+    const int num_local_devices = devices.size();
     for (auto& comm : communicators_) {
-      if (comm->num_devices == collective->num_global_devices) {
+      if (comm->num_devices == num_global_devices) {
         int i;
-        for (i = 0; i < collective->num_local_devices; ++i) {
-          if (comm->members[i].nccl_stream->executor !=
-              collective->participants[i]->executor) {
+        for (i = 0; i < num_local_devices; ++i) {
+          if (comm->members[i].nccl_stream->executor != devices[i].executor) {
             break;
           }
         }
-        if (i == collective->num_local_devices) {
-          *communicator = comm.get();
-          return Status::OK();
+        if (i == num_local_devices) {
+          return comm.get();
         }
       }
     }
   } else {
+    // This is an instance of multi-node collective.  We have previously
+    // created a NCCL unique id and shared with all workers.  Now we find the
+    // `Communicator` corresponding to this id.
+    for (auto& comm : communicators_) {
+      if (comm->key == communicator_key) {
+        return comm.get();
+      }
+    }
+  }
+  return nullptr;
+}
+
+Status NcclManager::GetCommunicator(
+    const string& communicator_key, int num_global_devices,
+    const std::vector<CommunicatorDevice>& devices,
+    NcclManager::Communicator** communicator) {
+  if (!communicator_key.empty()) {
 #if NCCL_MAJOR < 2
     return errors::Internal(
         "Cannot use multi-node NCCL collectives with NCCL 1.x");
 #endif
-    if (collective->communicator_key.size() != NCCL_UNIQUE_ID_BYTES) {
+    if (communicator_key.size() != NCCL_UNIQUE_ID_BYTES) {
       return errors::Internal("Expected communicator_key of size ",
                               NCCL_UNIQUE_ID_BYTES, " but found size ",
-                              collective->communicator_key.size());
+                              communicator_key.size());
     }
-    // This is an instance of multi-node collective.  We have previously
-    // created a NCCL unique id and shared with all workers.  Now we find the
-    // `Communicator` corresponding to this id.
-    for (auto& comm : communicators_) {
-      if (comm->key == collective->communicator_key) {
-        *communicator = comm.get();
-        return Status::OK();
-      }
+  }
+
+  // Identifies the communicator while it is initialized.  Single-node
+  // communicators are identified by their executors.
+  string pending_key = communicator_key;
+  if (pending_key.empty()) {
+    for (const CommunicatorDevice& device : devices) {
+      strings::StrAppend(&pending_key,
+                         reinterpret_cast<uintptr_t>(device.executor), ",");
     }
   }
 
   auto* env = Env::Default();
   std::set<NcclStream*> used_streams;
-
-  // Create and initialize a new communicator.
-  // Note that this is done under the lock; performance is not expected to
-  // matter as this happens a very small number of times.
-  std::vector<CommunicatorMember> members(collective->num_local_devices);
-  std::vector<int> devices(collective->num_local_devices);
-  for (int i = 0; i < collective->num_local_devices; ++i) {
-    auto* executor = collective->participants[i]->executor;
-
-    // Find a communication stream to use for the device.
-    auto& streams = device_to_comm_streams_[executor];
-    NcclStream* nccl_stream = nullptr;
-    for (const auto& s : streams) {
-      if (used_streams.insert(s).second) {
-        nccl_stream = s;
+  std::vector<CommunicatorMember> members(devices.size());
+  {
+    mutex_lock l(mu_);
+    while (true) {
+      if (!status_.ok()) {
+        return status_;
+      }
+      *communicator =
+          FindCommunicator(communicator_key, num_global_devices, devices);
+      if (*communicator != nullptr) {
+        return Status::OK();
+      }
+      if (pending_communicators_.insert(pending_key).second) {
         break;
       }
+      communicator_cv_.wait(l);
     }
-    if (nccl_stream == nullptr) {
-      nccl_stream = new NcclStream();
-      nccl_stream->executor = executor;
+
+    for (int i = 0; i < members.size(); ++i) {
+      auto* executor = devices[i].executor;
+
+      // Find a communication stream to use for the device.
+      auto& streams = device_to_comm_streams_[executor];
+      NcclStream* nccl_stream = nullptr;
+      for (const auto& s : streams) {
+        if (used_streams.insert(s).second) {
+          nccl_stream = s;
+          break;
+        }
+      }
+      if (nccl_stream == nullptr) {
+        nccl_stream = new NcclStream();
+        nccl_stream->executor = executor;
 #if TENSORFLOW_USE_ROCM
-      nccl_stream->stream = collective->participants[i]->context->nccl_stream();
+        nccl_stream->stream = devices[i].context->nccl_stream();
 #else
-      nccl_stream->stream.reset(new se::Stream(executor));
-      nccl_stream->stream->Init();
+        nccl_stream->stream.reset(new se::Stream(executor));
+        nccl_stream->stream->Init();
 #endif
 
-      streams.emplace_back(nccl_stream);
-      used_streams.insert(nccl_stream);
+        streams.emplace_back(nccl_stream);
+        used_streams.insert(nccl_stream);
 
-      nccl_stream->Ref();
-      env->SchedClosure([this, nccl_stream]() {
-        LoopKernelLaunches(nccl_stream);
-        nccl_stream->Unref();
-      });
-    }
+        nccl_stream->Ref();
+        env->SchedClosure([this, nccl_stream]() {
+          LoopKernelLaunches(nccl_stream);
+          nccl_stream->Unref();
+        });
+      }
 
-    members[i].nccl_stream = nccl_stream;
-    devices[i] = collective->participants[i]->gpu_device_id;
+      members[i].nccl_stream = nccl_stream;
+    }
   }
 
-  std::vector<ncclComm_t> nccl_comms(collective->num_local_devices);
-#if NCCL_MAJOR >= 2
-  // For NCCL 2, we always initialize using ncclCommInitRank guarded by NCCL
-  // group primitives.
-  ncclUniqueId nccl_id;
-  if (collective->single_node) {
-    NCCL_RETURN_IF_ERROR(ncclGetUniqueId(&nccl_id));
-  } else {
-    StringToNcclUniqueId(collective->communicator_key, &nccl_id);
-  }
-  int saved_device = 0;
-  CUDA_RETURN_IF_ERROR(cudaGetDevice(&saved_device));
-  NCCL_RETURN_IF_ERROR(ncclGroupStart());
-  for (int i = 0; i < collective->num_local_devices; ++i) {
-    // Set rank to `participant->global_rank` if provided, else `i`.
-    const int rank = collective->participants[i]->global_rank >= 0
-                         ? collective->participants[i]->global_rank
-                         : i;
-    CUDA_RETURN_IF_ERROR(cudaSetDevice(devices[i]));
-    NCCL_RETURN_IF_ERROR(ncclCommInitRank(
-        nccl_comms.data() + i, collective->num_global_devices, nccl_id, rank));
-  }
-  NCCL_RETURN_IF_ERROR(ncclGroupEnd());
-  CUDA_RETURN_IF_ERROR(cudaSetDevice(saved_device));
-#else
-  // Since NCCL 1 is single node only, we use ncclCommInitAll.  We could have
-  // used ncclCommInitRank with NCCL 1 as well, but then we would have to
-  // issue each init call from a different thread
-  // (https://docs.nvidia.com/deeplearning/sdk/nccl-developer-guide/docs/nccl1.html).
-  NCCL_RETURN_IF_ERROR(ncclCommInitAll(
-      nccl_comms.data(), collective->num_local_devices, devices.data()));
-#endif
+  // Multi-node initializations block until all the ranks have joined, so they
+  // must not hold `mu_`, which would also keep other communicators from being
+  // initialized and collectives from being added.
+  std::vector<ncclComm_t> nccl_comms;
+  const Status init_status =
+      InitNcclComms(communicator_key, num_global_devices, devices, &nccl_comms);
 
-  for (int i = 0; i < collective->num_local_devices; ++i) {
+  mutex_lock l(mu_);
+  pending_communicators_.erase(pending_key);
+  communicator_cv_.notify_all();
+  TF_RETURN_IF_ERROR(init_status);
+  for (int i = 0; i < members.size(); ++i) {
     members[i].nccl_comm = nccl_comms[i];
   }
+  // The communicators are destroyed with `members` if the manager was aborted
+  // during their initialization.
+  if (!status_.ok()) {
+    return status_;
+  }
   communicators_.emplace_back(
-      new Communicator(std::move(members), collective->communicator_key));
+      new Communicator(std::move(members), communicator_key));
   *communicator = communicators_.back().get();
   return Status::OK();
 }
@@ -27,6 +27,7 @@ limitations under the License.
 #endif
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #if GOOGLE_CUDA
 #include "third_party/nccl/nccl.h"
 #elif TENSORFLOW_USE_ROCM
@@ -128,6 +129,33 @@ class NcclManager {
     bool root;
   };
 
+  // A device of this node that is part of a communicator.
+  struct CommunicatorDevice {
+    CommunicatorDevice(se::StreamExecutor* executor,
+                       const DeviceBase::GpuDeviceInfo* info, int global_rank)
+        : executor(executor),
+          gpu_device_id(info->gpu_id),
+#if TENSORFLOW_USE_ROCM
+          context(static_cast<GPUDeviceContext*>(info->default_context)),
+#endif
+          global_rank(global_rank) {}
+    explicit CommunicatorDevice(const Participant& participant)
+        : executor(participant.executor),
+          gpu_device_id(participant.gpu_device_id),
+#if TENSORFLOW_USE_ROCM
+          context(participant.context),
+#endif
+          global_rank(participant.global_rank) {}
+
+    se::StreamExecutor* executor;
+    int gpu_device_id;
+#if TENSORFLOW_USE_ROCM
+    GPUDeviceContext* context;
+#endif
+    // Rank across all devices and all nodes, as in `Participant`.
+    int global_rank;
+  };
+
   // Data that provides context for the collective operation, including the
   // operation key, number of participants, and communicator key.
   struct Context {
@@ -183,6 +211,20 @@ class NcclManager {
   void AddReduceRecv(std::unique_ptr<Participant> participant,
                      const Context& context, ncclRedOp_t reduction_op);
 
+  // Creates the communicator that collectives among `devices` will use, so
+  // that the NCCL initialization happens ahead of the first collective, e.g.
+  // while the model is loaded.  `communicator_key` and `num_global_devices` are
+  // the same as in the `Context` of those collectives.
+  //
+  // For multi-node communicators, every node must warm up its devices with the
+  // same `communicator_key`, since the initialization blocks until all the
+  // ranks have joined.  Communicators are initialized concurrently when this
+  // is called from several threads.  Returns OK without doing anything if the
+  // communicator already exists.
+  Status WarmUpCommunicator(const string& communicator_key,
+                            int num_global_devices,
+                            std::vector<CommunicatorDevice> devices);
+
   // Signals that the `Collective` corresponding to `key` is ready to launch
   // across all nodes participating in this multi-node collective operation.
   //
@@ -219,6 +261,23 @@ class NcclManager {
   // the corresponding NCCL/CUDA error string.
   Status GetCommunicator(Collective* collective, Communicator** communicator);
 
+  // Same as above, for the communicator of `devices`, which must be sorted by
+  // device ID, executor and global rank.
+  //
+  // The NCCL initialization runs without holding `mu_`, so that communicators
+  // for different sets of devices are initialized concurrently.  Concurrent
+  // callers for the same communicator wait for the first one to create it.
+  Status GetCommunicator(const string& communicator_key,
+                         int num_global_devices,
+                         const std::vector<CommunicatorDevice>& devices,
+                         Communicator** communicator);
+
+  // Returns the existing communicator of `devices`, or nullptr.
+  Communicator* FindCommunicator(const string& communicator_key,
+                                 int num_global_devices,
+                                 const std::vector<CommunicatorDevice>& devices)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Adds a participant device to the local `Collective` instance corresponding
   // to `collective_key`.  Launches the `Collective` if it is ready, which it
   // checks by calling `CheckReady()`.  Also performs consistency and sanity
@@ -254,6 +313,11 @@ class NcclManager {
 
   std::vector<std::unique_ptr<Communicator>> communicators_ TF_GUARDED_BY(mu_);
 
+  // Keys of the communicators being initialized by GetCommunicator, which
+  // signals `communicator_cv_` when it is done.
+  absl::flat_hash_set<string> pending_communicators_ TF_GUARDED_BY(mu_);
+  condition_variable communicator_cv_;
+
   Status status_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(NcclManager);
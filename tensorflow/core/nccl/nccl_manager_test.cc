@@ -632,6 +632,43 @@ TYPED_TEST(NcclManagerTest, BroadcastWithDifferentRanks) {
 
 // Multi-node NCCL tests.
 
+// Warms up the communicator of all the GPUs, and then runs an all-reduce that
+// uses it.
+TYPED_TEST(NcclManagerTest, WarmUpCommunicator) {
+  const int num_ranks = this->NumGPUs();
+  std::vector<NcclManager::CommunicatorDevice> devices;
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    auto* device = this->GetDevice(num_ranks, /*node=*/0, rank);
+    devices.emplace_back(device->executor(),
+                         device->tensorflow_gpu_device_info(),
+                         /*global_rank=*/-1);
+  }
+  TF_ASSERT_OK(NcclManager::instance()->WarmUpCommunicator(
+      /*communicator_key=*/"", /*num_global_devices=*/num_ranks, devices));
+  // Warming up an existing communicator does nothing.
+  TF_ASSERT_OK(NcclManager::instance()->WarmUpCommunicator(
+      /*communicator_key=*/"", /*num_global_devices=*/num_ranks, devices));
+
+  std::unique_ptr<typename TestFixture::TestCase> test_case(
+      this->MakeReductionTestCase(/*num_nodes=*/1, num_ranks, ncclSum,
+                                  TensorShape({2, 3}), 0.0f));
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    auto* device = this->GetDevice(num_ranks, /*node=*/0, rank);
+    auto* info = device->tensorflow_gpu_device_info();
+    auto participant = absl::make_unique<NcclManager::Participant>(
+        device->executor(), info->stream, info, &test_case->ins[rank],
+        &test_case->outs[rank], /*global_rank=*/-1,
+        this->CreateDoneCallback(test_case.get()));
+    NcclManager::instance()->AddToAllReduce(
+        std::move(participant),
+        {"allreduce", /*num_local_devices=*/num_ranks,
+         /*num_global_devices=*/num_ranks, /*communicator_key=*/"",
+         /*source_rank=*/-1},
+        ncclSum);
+  }
+  this->VerifyResults(test_case.get());
+}
+
 TEST(NcclManagerTest, CommunicatorKey) {
   const string communicator_key =
       NcclManager::instance()->GenerateCommunicatorKey();
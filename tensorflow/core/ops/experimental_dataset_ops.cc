@@ -133,6 +133,26 @@ REGISTER_OP("ExperimentalChooseFastestDataset")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("ColumnarDataset")
+    .Input("filenames: string")
+    .Input("columns: string")
+    .Input("filter_columns: string")
+    .Input("filter_min: float64")
+    .Input("filter_max: float64")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetDoNotOptimize()  // TODO(b/123753214): Source dataset ops must
+                         // disable constant folding.
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      for (int i = 0; i < 5; ++i) {
+        // Each input is a scalar or a vector.
+        TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(i), 1, &unused));
+      }
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("CompressElement")
     .Input("components: input_types")
     .Output("compressed: variant")
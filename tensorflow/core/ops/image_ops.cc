@@ -511,6 +511,36 @@ REGISTER_OP("DecodeAndCropJpeg")
       return Status::OK();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("BatchDecodeAndCropResizeJpeg")
+    .Input("contents: string")
+    .Input("boxes: float")
+    .Input("size: int32")
+    .Attr("channels: int = 3")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("dct_method: string = ''")
+    .Output("images: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      ShapeHandle boxes;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &boxes));
+      DimensionHandle batch_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(contents, 0), c->Dim(boxes, 0), &batch_dim));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 1), 4, &unused));
+
+      int32 channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 1 && channels != 3) {
+        return errors::InvalidArgument("channels must be 1 or 3, got ",
+                                       channels);
+      }
+      return SetOutputToSizedImage(c, batch_dim, 2 /* size_input_idx */,
+                                   c->MakeDim(channels));
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -907,6 +937,55 @@ REGISTER_OP("CropAndResize")
                                    c->Dim(input, 3));
     });
 
+REGISTER_OP("CropAndResizeNormalize")
+    .Input("image: T")
+    .Input("boxes: float")
+    .Input("box_ind: int32")
+    .Input("crop_size: int32")
+    .Input("mean: float")
+    .Input("scale: float")
+    .Output("crops: out_type")
+    .Attr("T: {uint8, uint16, int8, int16, int32, int64, half, float, double}")
+    .Attr("out_type: {half, float} = DT_FLOAT")
+    .Attr("method: {'bilinear', 'nearest'} = 'bilinear'")
+    .Attr("extrapolation_value: float = 0")
+    .Attr("data_format: {'NHWC', 'NCHW'} = 'NHWC'")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 4, &input));
+      ShapeHandle boxes;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &boxes));
+      ShapeHandle box_ind;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &box_ind));
+
+      DimensionHandle num_boxes_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 0), c->Dim(box_ind, 0), &num_boxes_dim));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 1), 4, &unused));
+
+      // mean and scale hold one value per channel.
+      ShapeHandle mean;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &mean));
+      ShapeHandle scale;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(5), 1, &scale));
+      DimensionHandle depth_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(input, 3), c->Dim(mean, 0), &depth_dim));
+      TF_RETURN_IF_ERROR(c->Merge(depth_dim, c->Dim(scale, 0), &depth_dim));
+
+      TF_RETURN_IF_ERROR(SetOutputToSizedImage(
+          c, num_boxes_dim, 3 /* size_input_idx */, depth_dim));
+      string data_format;
+      TF_RETURN_IF_ERROR(c->GetAttr("data_format", &data_format));
+      if (data_format == "NCHW") {
+        ShapeHandle out = c->output(0);
+        c->set_output(0, c->MakeShape({c->Dim(out, 0), c->Dim(out, 3),
+                                       c->Dim(out, 1), c->Dim(out, 2)}));
+      }
+      return Status::OK();
+    });
+
 REGISTER_OP("CropAndResizeGradImage")
     .Input("grads: float")
     .Input("boxes: float")
@@ -321,6 +321,29 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {half, float, double}")
+    .Attr("num_args: int >= 1")
+    .Attr("fused_ops: list(string)")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle out = c->input(0);
+      for (int i = 1; i < c->num_inputs(); ++i) {
+        TF_RETURN_IF_ERROR(c->Merge(out, c->input(i), &out));
+      }
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes a chain of elementwise ops on inputs of the same shape. The first op of
+`fused_ops` is applied to the leading inputs, and every following op to the
+result of the previous one and, for binary ops, to the next input.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
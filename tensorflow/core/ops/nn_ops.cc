@@ -1228,6 +1228,78 @@ REGISTER_OP("LogSoftmax")
 
 // --------------------------------------------------------------------------
 
+REGISTER_OP("FusedAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("bias: num_bias * T")
+    .Output("output: T")
+    .Output("logsumexp: T")
+    .Output("dropout_seed: int64")
+    .Attr("T: {float, double}")
+    .Attr("num_bias: int >= 0 = 0")
+    .Attr("scale: float = 1.0")
+    .Attr("dropout_rate: float = 0.0")
+    .Attr("seed: int = 0")
+    .Attr("seed2: int = 0")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      ShapeHandle key;
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 4, &query));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 4, &key));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 4, &value));
+
+      // query and key agree on [batch, heads, ..., depth], key and value on
+      // [batch, heads, key_len].
+      ShapeHandle key_prefix;
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(query, 0), c->Dim(key, 0), &unused));
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(query, 1), c->Dim(key, 1), &unused));
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(query, 3), c->Dim(key, 3), &unused));
+      TF_RETURN_IF_ERROR(c->Subshape(key, 0, 3, &key_prefix));
+      TF_RETURN_IF_ERROR(c->MergePrefix(value, key_prefix, &value,
+                                        &key_prefix));
+
+      ShapeHandle query_prefix;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, 3, &query_prefix));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          query_prefix, c->Vector(c->Dim(value, 3)), &output));
+      c->set_output(0, output);
+      c->set_output(1, query_prefix);
+      c->set_output(2, c->Scalar());
+      return Status::OK();
+    });
+
+REGISTER_OP("FusedAttentionGrad")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("bias: num_bias * T")
+    .Input("output: T")
+    .Input("logsumexp: T")
+    .Input("dropout_seed: int64")
+    .Input("output_backprop: T")
+    .Output("query_backprop: T")
+    .Output("key_backprop: T")
+    .Output("value_backprop: T")
+    .Attr("T: {float, double}")
+    .Attr("num_bias: int >= 0 = 0")
+    .Attr("scale: float = 1.0")
+    .Attr("dropout_rate: float = 0.0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      for (int i = 0; i < 3; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 4, &unused));
+        c->set_output(i, c->input(i));
+      }
+      return Status::OK();
+    });
+
+// --------------------------------------------------------------------------
+
 REGISTER_OP("SoftmaxCrossEntropyWithLogits")
     .Input("features: T")
     .Input("labels: T")
@@ -3373,6 +3445,76 @@ REGISTER_OP("_ROCmFusedAddNReluGrad")
     Supports only tensors of type {half, float}.
 )doc");
 
+namespace {
+
+// Shape function of the _ROCmFusedMatMulBias*Activation ops. The optional
+// side input (input 3) is added to the product and must have its shape.
+Status ROCmFusedMatMulShape(InferenceContext* c) {
+  TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+
+  ShapeHandle bias_shape;
+  // Bias should be a 1-D tensor, of the size of the product's last dimension.
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &bias_shape));
+  DimensionHandle unused;
+  TF_RETURN_IF_ERROR(
+      c->Merge(c->Dim(c->output(0), 1), c->Dim(bias_shape, 0), &unused));
+
+  if (c->num_inputs() > 3) {
+    ShapeHandle out;
+    TF_RETURN_IF_ERROR(c->Merge(c->output(0), c->input(3), &out));
+    c->set_output(0, out);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+REGISTER_OP("_ROCmFusedMatMulBiasActivation")
+
+    .Input("a: T")
+    .Input("b: T")
+    .Input("bias: T")
+
+    .Output("product: T")
+
+    .Attr("T: {half, float}")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("activation_mode: {'None','Sigmoid','Relu','Relu6','Tanh'} = 'None'")
+
+    .SetShapeFn(ROCmFusedMatMulShape)
+    .Doc(R"doc(
+    Computes a fused kernel which implements:
+      MatMul op, followed by
+      BiasAdd op, followed by
+      any activation op (None, Sigmoid, Relu, Relu6, Tanh)
+    Supports only tensors of type {half, float}.
+)doc");
+
+REGISTER_OP("_ROCmFusedMatMulBiasAddActivation")
+
+    .Input("a: T")
+    .Input("b: T")
+    .Input("bias: T")
+    .Input("side_input: T")  // added to the biased product
+
+    .Output("product: T")
+
+    .Attr("T: {half, float}")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("activation_mode: {'None','Sigmoid','Relu','Relu6','Tanh'} = 'None'")
+
+    .SetShapeFn(ROCmFusedMatMulShape)
+    .Doc(R"doc(
+    Computes a fused kernel which implements:
+      MatMul op, followed by
+      BiasAdd op, followed by
+      Add op (of a side input with the shape of the product), followed by
+      any activation op (None, Sigmoid, Relu, Relu6, Tanh)
+    Supports only tensors of type {half, float}.
+)doc");
+
 #endif  //  TENSORFLOW_USE_ROCM
 
 // Fusion of Quantized MatMul and BiasAdd.
@@ -117,6 +117,40 @@ REGISTER_OP("SparseTensorDenseMatMul")
       return Status::OK();
     });
 
+REGISTER_OP("BlockSparseMatMul")
+    .Input("a_block_values: T")
+    .Input("a_block_col_indices: Tindices")
+    .Input("a_block_row_ptr: Tindices")
+    .Input("b: T")
+    .Output("product: T")
+    .Attr("T: {float, double}")
+    .Attr("Tindices: {int32,int64} = DT_INT64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle a_block_values;
+      ShapeHandle a_block_row_ptr;
+      ShapeHandle b;
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &a_block_values));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &a_block_row_ptr));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 2, &b));
+
+      DimensionHandle num_blocks;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(a_block_values, 0), c->Dim(c->input(1), 0),
+                   &num_blocks));
+
+      // The product has one row per row of every block row of A.
+      DimensionHandle num_block_rows;
+      DimensionHandle output_left;
+      TF_RETURN_IF_ERROR(
+          c->Subtract(c->Dim(a_block_row_ptr, 0), 1, &num_block_rows));
+      TF_RETURN_IF_ERROR(c->Multiply(
+          num_block_rows, c->Dim(a_block_values, 1), &output_left));
+      c->set_output(0, c->Matrix(output_left, c->Dim(b, 1)));
+      return Status::OK();
+    });
+
 REGISTER_OP("SerializeSparse")
     .Input("sparse_indices: int64")
     .Input("sparse_values: T")
@@ -56,6 +56,12 @@ class FileBlockCacheStatsInterface {
   /// RecordBlockLoadRequest is called to record the size of a missed block.
   virtual void RecordCacheMissBlockSize(size_t bytes_transferred) = 0;
 
+  /// Called to record the size of a block fetched ahead of sequential reads,
+  /// and the size of such a block when it is first read. Their ratio measures
+  /// how much of the readahead is useful.
+  virtual void RecordPrefetchBlockSize(size_t bytes_transferred) {}
+  virtual void RecordPrefetchHitBlockSize(size_t bytes_transferred) {}
+
   virtual ~FileBlockCacheStatsInterface() = default;
 };
 
@@ -145,6 +145,18 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // objects.
 constexpr char kComposeAppend[] = "compose";
 
+// The size (in MB) of the parts in which large files are uploaded in parallel
+// and then composed into the final object. Parallel uploads are disabled if
+// this is 0 (the default). They make use of more network bandwidth than a
+// single resumable upload, at the cost of temporary objects that may be
+// stranded if the upload fails.
+constexpr char kParallelUploadPartSize[] = "GCS_PARALLEL_UPLOAD_PART_SIZE_MB";
+// The number of parts uploaded concurrently by a parallel upload.
+constexpr char kParallelUploadThreads[] = "GCS_PARALLEL_UPLOAD_THREADS";
+constexpr int kParallelUploadDefaultThreads = 8;
+// The maximum number of source objects of a single compose request.
+constexpr uint64 kMaxComposeComponents = 32;
+
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return Status::OK();
@@ -552,6 +564,14 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
+    if (filesystem_->parallel_upload_part_size() > 0 &&
+        !(compose_append_ && start_offset_ > 0)) {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+      if (file_size > filesystem_->parallel_upload_part_size()) {
+        return ParallelUpload(file_size);
+      }
+    }
     UploadSessionHandle session_handle;
     uint64 start_offset = 0;
     string object_to_upload = object_;
@@ -611,6 +631,158 @@ class GcsWritableFile : public WritableFile {
     return upload_status;
   }
 
+  /// Uploads the file as several parts in parallel, each to its own
+  /// temporary object, then composes the parts into the object and deletes
+  /// them.
+  Status ParallelUpload(uint64 file_size) {
+    const uint64 part_size =
+        std::max(filesystem_->parallel_upload_part_size(),
+                 (file_size + kMaxComposeComponents - 1) /
+                     kMaxComposeComponents);
+    const int num_parts = (file_size + part_size - 1) / part_size;
+    const int num_threads =
+        std::min(num_parts, filesystem_->parallel_upload_threads());
+    std::vector<string> part_objects(num_parts);
+    for (int i = 0; i < num_parts; ++i) {
+      part_objects[i] =
+          strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                          io::Basename(object_), ".part", i);
+    }
+
+    std::vector<Status> part_statuses(num_parts);
+    auto upload_parts = [&](int first_part) {
+      for (int i = first_part; i < num_parts; i += num_threads) {
+        const uint64 offset = i * part_size;
+        part_statuses[i] = UploadPart(part_objects[i], offset,
+                                      std::min(part_size, file_size - offset));
+      }
+    };
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back(Env::Default()->StartThread(
+            ThreadOptions(), "gcs_parallel_upload",
+            [&upload_parts, t]() { upload_parts(t); }));
+      }
+      upload_parts(0);
+    }
+    Status status;
+    for (const Status& part_status : part_statuses) {
+      status.Update(part_status);
+    }
+    if (status.ok()) {
+      status = ComposeParts(part_objects);
+    }
+    for (const string& part_object : part_objects) {
+      const string part_path = GetGcsPathWithObject(part_object);
+      RetryingUtils::DeleteWithRetries(
+          [&part_path, this]() {
+            return filesystem_->DeleteFile(part_path, nullptr);
+          },
+          retry_config_)
+          .IgnoreError();
+    }
+
+    if (status.code() == errors::Code::NOT_FOUND) {
+      // As in SyncImpl(), relies on the RetryingFileSystem to retry the whole
+      // upload.
+      return errors::Unavailable(
+          strings::StrCat("Upload to gs://", bucket_, "/", object_,
+                          " failed, caused by: ", status.ToString()));
+    }
+    if (status.ok()) {
+      file_cache_erase_();
+      start_offset_ = file_size;
+    }
+    return status;
+  }
+
+  /// Uploads file[offset, offset + size) to part_object.
+  Status UploadPart(const string& part_object, uint64 offset, uint64 size) {
+    string part_filename;
+    TF_RETURN_IF_ERROR(GetTmpFilename(&part_filename));
+    Status status = CopyToPartFile(offset, size, part_filename);
+    if (status.ok()) {
+      const string part_path = GetGcsPathWithObject(part_object);
+      UploadSessionHandle session_handle;
+      status = session_creator_(0, part_object, bucket_, size, part_path,
+                                &session_handle);
+      uint64 already_uploaded = 0;
+      bool first_attempt = true;
+      if (status.ok()) {
+        status = RetryingUtils::CallWithRetries(
+            [&]() {
+              if (session_handle.resumable && !first_attempt) {
+                bool completed;
+                TF_RETURN_IF_ERROR(
+                    status_poller_(session_handle.session_uri, size, part_path,
+                                   &completed, &already_uploaded));
+                if (completed) {
+                  return Status::OK();
+                }
+              }
+              first_attempt = false;
+              return object_uploader_(session_handle.session_uri, 0,
+                                      already_uploaded, part_filename, size,
+                                      part_path);
+            },
+            retry_config_);
+      }
+    }
+    std::remove(part_filename.c_str());
+    return status;
+  }
+
+  /// Copies file[offset, offset + size) to a new local file.
+  Status CopyToPartFile(uint64 offset, uint64 size, const string& filename) {
+    std::ifstream in(tmp_content_filename_, std::ifstream::binary);
+    std::ofstream out(filename, std::ofstream::binary);
+    in.seekg(offset);
+    std::vector<char> buffer(std::min<uint64>(size, 1 << 20));
+    for (uint64 copied = 0; copied < size && in.good() && out.good();) {
+      const uint64 n = std::min<uint64>(size - copied, buffer.size());
+      in.read(buffer.data(), n);
+      out.write(buffer.data(), n);
+      copied += n;
+    }
+    out.flush();
+    if (!in.good() || !out.good()) {
+      return errors::Internal(
+          "Could not copy a part of the internal temporary file.");
+    }
+    return Status::OK();
+  }
+
+  /// Composes part_objects, in order, into the object.
+  Status ComposeParts(const std::vector<string>& part_objects) {
+    VLOG(3) << "ComposeParts: " << part_objects.size() << " parts to "
+            << GetGcsPath();
+    return RetryingUtils::CallWithRetries(
+        [&part_objects, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(object_),
+                                          "/compose"));
+
+          string request_body = "{'sourceObjects': [";
+          for (size_t i = 0; i < part_objects.size(); ++i) {
+            strings::StrAppend(&request_body, i > 0 ? "," : "",
+                               "{'name': '", part_objects[i], "'}");
+          }
+          strings::StrAppend(&request_body, "]}");
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ", GetGcsPath());
+          return Status::OK();
+        },
+        retry_config_);
+  }
+
   Status CheckWritable() const {
     if (!outfile_.is_open()) {
       return errors::FailedPrecondition(
@@ -798,12 +970,17 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kReadaheadBlocks, strings::safe_strtou64, &value)) {
+    readahead_blocks_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "readahead blocks = " << readahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -924,6 +1101,15 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   } else {
     compose_append_ = false;
   }
+
+  if (GetEnvVar(kParallelUploadPartSize, strings::safe_strtou64, &value)) {
+    parallel_upload_part_size_ = value * 1024 * 1024;
+  }
+  parallel_upload_threads_ = kParallelUploadDefaultThreads;
+  if (GetEnvVar(kParallelUploadThreads, strings::safe_strtou64, &value) &&
+      value > 0) {
+    parallel_upload_threads_ = value;
+  }
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -1036,7 +1222,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), readahead_blocks_));
   return file_block_cache;
 }
 
@@ -50,6 +50,9 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the number of blocks fetched in parallel
+// ahead of sequential reads of a file. Readahead is disabled by default.
+constexpr char kReadaheadBlocks[] = "GCS_READ_CACHE_READAHEAD_BLOCKS";
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -203,6 +206,17 @@ class GcsFileSystem : public FileSystem {
   }
 
   bool compose_append() const { return compose_append_; }
+  uint64 parallel_upload_part_size() const {
+    return parallel_upload_part_size_;
+  }
+  int parallel_upload_threads() const { return parallel_upload_threads_; }
+
+  /// Overrides the GCS_PARALLEL_UPLOAD_PART_SIZE_MB (in bytes here) and
+  /// GCS_PARALLEL_UPLOAD_THREADS settings of the file system.
+  void SetParallelUpload(uint64 part_size, int num_threads) {
+    parallel_upload_part_size_ = part_size;
+    parallel_upload_threads_ = num_threads;
+  }
   string additional_header_name() const {
     return additional_header_ ? additional_header_->first : "";
   }
@@ -403,6 +417,9 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The number of blocks the block cache fetches ahead of sequential reads.
+  size_t readahead_blocks_ = 0;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -421,6 +438,8 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<BucketLocationCache> bucket_location_cache_;
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
+  uint64 parallel_upload_part_size_ = 0;
+  int parallel_upload_threads_ = 1;
 
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
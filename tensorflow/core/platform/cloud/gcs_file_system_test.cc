@@ -1004,6 +1004,106 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUpload) {
+  std::vector<HttpRequest*> requests(
+      {// Upload the parts.
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpcompose%2Fwriteable.part0\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 8\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location0"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location0\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-7/8\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: content1\n",
+                           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpcompose%2Fwriteable.part1\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 8\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location1"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location1\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-7/8\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: ,content\n",
+                           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpcompose%2Fwriteable.part2\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 1\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location2"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location2\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-0/1\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: 2\n",
+                           ""),
+       // Compose the parts into the object.
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+           "path%2Fwriteable/compose\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 10\n"
+           "Header content-type: application/json\n"
+           "Post body: {'sourceObjects': [{'name': "
+           "'path/.tmpcompose/writeable.part0'},{'name': "
+           "'path/.tmpcompose/writeable.part1'},{'name': "
+           "'path/.tmpcompose/writeable.part2'}]}\n",
+           ""),
+       // Delete the parts.
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+           "path%2F.tmpcompose%2Fwriteable.part0\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 10\n"
+           "Delete: yes\n",
+           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+           "path%2F.tmpcompose%2Fwriteable.part1\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 10\n"
+           "Delete: yes\n",
+           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+           "path%2F.tmpcompose%2Fwriteable.part2\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 10\n"
+           "Delete: yes\n",
+           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      8 /* max bytes */, 0 /* max staleness */, 3600 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // Upload the parts one at a time, so that the requests are ordered.
+  fs.SetParallelUpload(8 /* part size */, 1 /* threads */);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("content1,"));
+  TF_EXPECT_OK(wfile->Append("content2"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
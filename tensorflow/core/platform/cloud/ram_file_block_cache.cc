@@ -39,6 +39,13 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
       if (cache_stats_ != nullptr) {
         cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
       }
+      if (entry->second->prefetched) {
+        entry->second->prefetched = false;
+        if (cache_stats_ != nullptr) {
+          // The block may still be being fetched, so its size is not known.
+          cache_stats_->RecordPrefetchHitBlockSize(block_size_);
+        }
+      }
       return entry->second;
     } else {
       // Remove the stale block and continue.
@@ -46,6 +53,11 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
     }
   }
 
+  return Insert_Locked(key);
+}
+
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert_Locked(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -83,11 +95,16 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
   // in the cache, and our current block is not block size, this likely means
   // we have inconsistent state within the cache. Note: it's possible some
   // incomplete reads may still go undetected.
+  // Blocks that were prefetched but not read yet are not taken into account,
+  // since the prefetches may have gone past the end of the file.
   if (block->data.size() < block_size_) {
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
     auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    while (fcmp != block_map_.begin() && key < std::prev(fcmp)->first) {
+      --fcmp;
+      if (!fcmp->second->prefetched) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
     }
   }
 
@@ -97,7 +114,8 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
 }
 
 Status RamFileBlockCache::MaybeFetch(const Key& key,
-                                     const std::shared_ptr<Block>& block) {
+                                     const std::shared_ptr<Block>& block,
+                                     bool prefetch) {
   bool downloaded_block = false;
   auto reconcile_state =
       gtl::MakeCleanup([this, &downloaded_block, &key, &block] {
@@ -135,7 +153,11 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
         status.Update(block_fetcher_(key.first, key.second, block_size_,
                                      block->data.data(), &bytes_transferred));
         if (cache_stats_ != nullptr) {
-          cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+          if (prefetch) {
+            cache_stats_->RecordPrefetchBlockSize(bytes_transferred);
+          } else {
+            cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+          }
         }
         block->mu.lock();  // Reacquire the lock immediately afterwards
         if (status.ok()) {
@@ -182,6 +204,9 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  if (readahead_blocks_ > 0) {
+    MaybePrefetch(filename, start, finish);
+  }
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
@@ -227,6 +252,65 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   return Status::OK();
 }
 
+void RamFileBlockCache::MaybePrefetch(const string& filename, size_t start,
+                                      size_t finish) {
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> blocks;
+  {
+    mutex_lock lock(mu_);
+    // A read continues the previous one if it starts in its last block or
+    // right after it.
+    auto it = read_ends_.find(filename);
+    const bool sequential =
+        it != read_ends_.end() &&
+        (start == it->second || start + block_size_ == it->second);
+    read_ends_[filename] = finish;
+    if (!sequential) {
+      return;
+    }
+    for (size_t i = 0; i < readahead_blocks_; ++i) {
+      Key key = std::make_pair(filename, finish + i * block_size_);
+      if (block_map_.find(key) != block_map_.end()) {
+        continue;
+      }
+      std::shared_ptr<Block> block = Insert_Locked(key);
+      block->prefetched = true;
+      blocks.emplace_back(key, block);
+      ++num_pending_prefetches_;
+    }
+  }
+  for (const auto& key_and_block : blocks) {
+    env_->SchedClosure([this, key_and_block]() {
+      Prefetch(key_and_block.first, key_and_block.second);
+    });
+  }
+}
+
+void RamFileBlockCache::Prefetch(const Key& key,
+                                 const std::shared_ptr<Block>& block) {
+  const Status status = MaybeFetch(key, block, /*prefetch=*/true);
+  mutex_lock lock(mu_);
+  if (status.ok() && block->timestamp != 0 &&
+      block->data.size() < block_size_) {
+    // This is the last block of the file, so the blocks prefetched after it
+    // are empty, and so is this one if it is past the end of the file.
+    auto it = block_map_.upper_bound(key);
+    while (it != block_map_.end() && it->first.first == key.first) {
+      auto next = std::next(it);
+      if (it->second->prefetched) {
+        RemoveBlock(it);
+      }
+      it = next;
+    }
+    if (block->data.empty() && block->prefetched) {
+      RemoveBlock(block_map_.find(key));
+    }
+  }
+  Trim();
+  if (--num_pending_prefetches_ == 0) {
+    prefetches_done_.notify_all();
+  }
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64 file_signature) {
   mutex_lock lock(mu_);
@@ -268,7 +352,13 @@ void RamFileBlockCache::Prune() {
 
 void RamFileBlockCache::Flush() {
   mutex_lock lock(mu_);
+  // Signals to the reads and prefetches in progress that their blocks are
+  // removed, as in RemoveBlock().
+  for (auto& entry : block_map_) {
+    entry.second->timestamp = 0;
+  }
   block_map_.clear();
+  read_ends_.clear();
   lru_list_.clear();
   lra_list_.clear();
   cache_size_ = 0;
@@ -280,6 +370,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  read_ends_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -50,13 +51,22 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// If `readahead_blocks` is positive, reads that continue where the previous
+  /// read of the same file stopped start fetching the next `readahead_blocks`
+  /// blocks of the file in the background, in parallel. The prefetched blocks
+  /// share the cache, and its `max_bytes` budget, with the other blocks.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t readahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        readahead_blocks_(
+            block_size > 0 ? std::min(readahead_blocks,
+                                      max_bytes / 2 / block_size)
+                           : 0) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
@@ -72,6 +82,10 @@ class RamFileBlockCache : public FileBlockCache {
       // notification and returns.
       pruning_thread_.reset();
     }
+    mutex_lock lock(mu_);
+    while (num_pending_prefetches_ > 0) {
+      prefetches_done_.wait(lock);
+    }
   }
 
   /// Read `n` bytes from `filename` starting at `offset` into `out`. This
@@ -131,6 +145,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The number of blocks fetched ahead of sequential reads.
+  const size_t readahead_blocks_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -181,6 +197,9 @@ class RamFileBlockCache : public FileBlockCache {
     FetchState state TF_GUARDED_BY(mu) = FetchState::CREATED;
     /// Wait on cond_var if state is FETCHING.
     condition_variable cond_var;
+    /// Whether the block was fetched ahead of a sequential read, and has not
+    /// been read yet. Guarded by the block-cache-wide mu_.
+    bool prefetched = false;
   };
 
   /// \brief The block map type for the file block cache.
@@ -197,7 +216,20 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
 
-  Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
+  /// Insert a new empty block for `key`, which is not in the block cache.
+  std::shared_ptr<Block> Insert_Locked(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block,
+                    bool prefetch = false) TF_LOCKS_EXCLUDED(mu_);
+
+  /// If the read of the blocks [start, finish) of `filename` continues the
+  /// previous read of the file, starts fetching the blocks that follow it.
+  void MaybePrefetch(const string& filename, size_t start, size_t finish)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Fetches a block inserted by MaybePrefetch(), in the background.
+  void Prefetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
   /// Trim the block cache to make room for another entry.
@@ -243,6 +275,15 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The block-aligned end of the last read of each file, used to detect
+  /// sequential reads.
+  std::map<string, size_t> read_ends_ TF_GUARDED_BY(mu_);
+
+  /// The number of prefetches running in the background, and the condition
+  /// notified when one of them completes.
+  int num_pending_prefetches_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable prefetches_done_;
 };
 
 }  // namespace tensorflow
@@ -16,11 +16,13 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 
 #include <cstring>
+#include <map>
 
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cloud/now_seconds_env.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -566,5 +568,60 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+class PrefetchStats : public FileBlockCacheStatsInterface {
+ public:
+  void Configure(const FileBlockCache* block_cache) override {}
+  void RecordCacheHitBlockSize(size_t bytes_transferred) override {}
+  void RecordCacheMissBlockSize(size_t bytes_transferred) override {}
+  void RecordPrefetchHitBlockSize(size_t bytes_transferred) override {
+    mutex_lock l(mu);
+    prefetch_hit_bytes += bytes_transferred;
+  }
+
+  mutex mu;
+  size_t prefetch_hit_bytes = 0;
+};
+
+TEST(RamFileBlockCacheTest, Readahead) {
+  // A file of 4.5 blocks, read sequentially.
+  const size_t block_size = 8;
+  const string contents = "0123456789abcdefghijklmnopqrstuvwxyz";
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      ++fetches[offset];
+    }
+    *bytes_transferred = 0;
+    if (offset < contents.size()) {
+      *bytes_transferred = std::min(n, contents.size() - offset);
+      memcpy(buffer, contents.data() + offset, *bytes_transferred);
+    }
+    return Status::OK();
+  };
+  PrefetchStats stats;
+  string read_contents;
+  {
+    RamFileBlockCache cache(block_size, 1024, 0, fetcher, Env::Default(),
+                            2 /* readahead blocks */);
+    cache.SetStats(&stats);
+    std::vector<char> out;
+    for (size_t offset = 0; offset < contents.size(); offset += block_size) {
+      TF_EXPECT_OK(ReadCache(&cache, "", offset, block_size, &out));
+      read_contents.append(out.begin(), out.end());
+    }
+    // The cache waits for the prefetches in progress on destruction.
+  }
+  EXPECT_EQ(contents, read_contents);
+  // Each block of the file was fetched once, whether by a prefetch or a read.
+  for (size_t offset = 0; offset < contents.size(); offset += block_size) {
+    EXPECT_EQ(1, fetches[offset]) << "offset " << offset;
+  }
+  // The blocks read after the second read were all prefetched.
+  EXPECT_EQ(3 * block_size, stats.prefetch_hit_bytes);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -57,11 +57,12 @@ inline size_t TF_TString_GetCapacity(const TF_TString *str);
 //    heap allocations.
 // TF_TSTR_LARGE:
 //    Heap allocated string.
-// TF_TSTR_OFFSET: (currently unused)
+// TF_TSTR_OFFSET:
 //    An offset defined string.  The string buffer begins at an internally
-//    defined little-endian offset from `str'; i.e. GetDataPointer() = str +
-//    offset.  This type is useful for memory mapping or reading string tensors
-//    directly from file, without the need to deserialize the data.  For
+//    defined offset from `str'; i.e. GetDataPointer() = str + offset.  This
+//    type is useful for memory mapping or reading string tensors directly from
+//    file, without the need to deserialize the data, and for string tensors
+//    whose characters are stored in the tensor buffer after the strings.  For
 //    security reasons, it is imperative that OFFSET based string tensors are
 //    validated before use, or are from a trusted source.
 // TF_TSTR_VIEW:
@@ -89,6 +90,14 @@ inline char *TF_TString_GetMutableDataPointer(TF_TString *str);
 inline void TF_TString_AssignView(TF_TString *dst, const char *src,
                                   size_t size);
 
+// Sets `dst' as an OFFSET type to the `size' characters at `src', which must
+// be in the same buffer as `dst', after it and less than 4GB away, and `size'
+// must be less than 1GB.  The characters must stay at the same distance from
+// `dst' for the lifetime of `dst', so `dst' must not be relocated, e.g. with
+// memcpy.  Copies and moves of `dst' are owned (SMALL/LARGE) strings.
+inline void TF_TString_AssignOffset(TF_TString *dst, const char *src,
+                                    size_t size);
+
 // Appends `src' onto `dst'.  If `dst' is a VIEW or OFFSET type, it will first
 // be converted to an owned LARGE or SMALL type.  `dst' should not point to
 // memory owned by `src'.
@@ -100,21 +109,22 @@ inline void TF_TString_AppendN(TF_TString *dst, const char *src, size_t size);
 //        | src     | dst          | complexity
 // Copy   | *       |  SMALL/LARGE | fixed/O(size)
 // Assign | SMALL   |  SMALL       | fixed
-// Assign | OFFSET  |  VIEW        | fixed
+// Assign | OFFSET  |  SMALL/LARGE | fixed/O(size)
 // Assign | VIEW    |  VIEW        | fixed
 // Assign | LARGE   |  LARGE       | O(size)
+// Move   | OFFSET  |  SMALL/LARGE | fixed/O(size)
 // Move   | *       |  same as src | fixed
 
 // Copies `src' to `dst'. `dst' will be an owned type (SMALL/LARGE). `src'
 // should not point to memory owned by `dst'.
 inline void TF_TString_Copy(TF_TString *dst, const char *src, size_t size);
-// Assigns a `src' tstring to `dst'.  An OFFSET `src' type will yield a `VIEW'
-// `dst'.  LARGE `src' types will be copied to a new buffer; all other `src'
-// types will incur a fixed cost.
+// Assigns a `src' tstring to `dst'.  LARGE and OFFSET `src' types will be
+// copied to an owned type, since the characters of an OFFSET `src' belong to
+// the buffer that holds it; all other `src' types will incur a fixed cost.
 inline void TF_TString_Assign(TF_TString *dst, const TF_TString *src);
 // Moves a `src' tstring to `dst'.  Moving a LARGE `src' to `dst' will result in
-// a valid but unspecified `src'.  This function incurs a fixed cost for all
-// inputs.
+// a valid but unspecified `src'.  OFFSET `src' types are copied like in
+// Assign; this function incurs a fixed cost for all other inputs.
 inline void TF_TString_Move(TF_TString *dst, TF_TString *src);
 
 #endif  // TENSORFLOW_CORE_PLATFORM_CTSTRING_H_
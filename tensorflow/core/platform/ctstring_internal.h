@@ -63,9 +63,9 @@ static inline uint32_t TF_swap32(uint32_t host_int) {
 #endif
 
 #if TF_TSTRING_LITTLE_ENDIAN
-#define TF_le32toh(x) TF_swap32(x)
-#else  // TF_TSTRING_LITTLE_ENDIAN
 #define TF_le32toh(x) x
+#else  // TF_TSTRING_LITTLE_ENDIAN
+#define TF_le32toh(x) TF_swap32(x)
 #endif  // TF_TSTRING_LITTLE_ENDIAN
 
 static inline size_t TF_align16(size_t i) { return (i + 0xF) & ~0xF; }
@@ -366,6 +366,17 @@ static inline void TF_TString_AssignView(TF_TString *dst, const char *src,
   dst->u.view.ptr = src;
 }
 
+static inline void TF_TString_AssignOffset(TF_TString *dst, const char *src,
+                                           size_t size) {
+  TF_TString_Dealloc(dst);
+
+  // Like GetSize, the size is stored in little-endian byte order.
+  dst->u.offset.size =
+      TF_le32toh((uint32_t)((size << 2) | TF_TSTR_OFFSET));  // NOLINT
+  dst->u.offset.offset = (uint32_t)(src - (const char *)dst);  // NOLINT
+  dst->u.offset.count = 0;
+}
+
 static inline void TF_TString_AppendN(TF_TString *dst, const char *src,
                                       size_t src_size) {
   if (!src_size) return;
@@ -409,10 +420,13 @@ static inline void TF_TString_Assign(TF_TString *dst, const TF_TString *src) {
     }
       return;
     case TF_TSTR_OFFSET: {
+      // The characters of an OFFSET string belong to the buffer that holds
+      // `src`, which may not outlive `dst`, so they are copied.
       const char *src_c = TF_TString_GetDataPointer(src);
       size_t size = TF_TString_GetSize(src);
 
-      TF_TString_AssignView(dst, src_c, size);
+      TF_TString_Init(dst);
+      TF_TString_Copy(dst, src_c, size);
     }
       return;
     default:
@@ -438,7 +452,8 @@ static inline void TF_TString_Move(TF_TString *dst, TF_TString *src) {
       const char *src_c = TF_TString_GetDataPointer(src);
       size_t size = TF_TString_GetSize(src);
 
-      TF_TString_AssignView(dst, src_c, size);
+      TF_TString_Init(dst);
+      TF_TString_Copy(dst, src_c, size);
     }
       return;
     default:
@@ -29,6 +29,21 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TF_POSIX_USE_IO_URING 1
+#endif
+#endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/platform/default/posix_file_system.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
@@ -44,6 +59,164 @@ namespace tensorflow {
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if defined(TF_POSIX_USE_IO_URING)
+namespace {
+
+// Reads of MultiRead() are split into reads of at most this many bytes, which
+// are all kept in flight at once.
+constexpr size_t kIoUringReadChunkSize = 128 * 1024;
+
+// The number of reads that one IoUring keeps in flight at most.
+constexpr unsigned kIoUringEntries = 64;
+
+// A minimal io_uring instance, for submitting reads and reaping their
+// completions from a single thread.
+class IoUring {
+ public:
+  // Returns the instance of the calling thread, or nullptr if io_uring is not
+  // available (e.g. on kernels before 5.1, or when it is forbidden by a
+  // seccomp filter).
+  static IoUring* ForThisThread() {
+    static std::atomic<bool> unavailable{false};
+    thread_local std::unique_ptr<IoUring> ring;
+    if (ring == nullptr && !unavailable.load(std::memory_order_relaxed)) {
+      ring = Create(kIoUringEntries);
+      if (ring == nullptr) {
+        unavailable.store(true, std::memory_order_relaxed);
+      }
+    }
+    return ring.get();
+  }
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != MAP_FAILED) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+    close(fd_);
+  }
+
+  unsigned num_entries() const { return num_entries_; }
+
+  // Queues a read of `iov` from `fd` at `offset`. `iov` must stay alive until
+  // the read completes. Returns false if the submission queue is full.
+  bool PrepareRead(int fd, const struct iovec* iov, uint64 offset,
+                   uint64 user_data) {
+    const unsigned tail = *sq_tail_;
+    if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= num_entries_) {
+      return false;
+    }
+    const unsigned index = tail & *sq_mask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uint64>(iov);
+    sqe->len = 1;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++num_unsubmitted_;
+    return true;
+  }
+
+  // Submits the queued reads, and waits until at least `min_complete` reads
+  // have completed. Returns 0 on success and an errno value otherwise.
+  int SubmitAndWait(unsigned min_complete) {
+    while (true) {
+      int r = syscall(__NR_io_uring_enter, fd_, num_unsubmitted_, min_complete,
+                      IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (r >= 0) {
+        num_unsubmitted_ -= r;
+        return 0;
+      }
+      if (errno != EINTR) return errno;
+    }
+  }
+
+  // Takes the next completion, if there is one, and returns the `user_data`
+  // of its read and the result of the read (a byte count or -errno).
+  bool PopCompletion(uint64* user_data, int* res) {
+    const unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    const struct io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+    *user_data = cqe.user_data;
+    *res = cqe.res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+ private:
+  IoUring() = default;
+
+  static std::unique_ptr<IoUring> Create(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+      VLOG(1) << "io_uring is not available: " << strerror(errno);
+      return nullptr;
+    }
+    std::unique_ptr<IoUring> ring(new IoUring());
+    ring->fd_ = fd;
+    ring->num_entries_ = params.sq_entries;
+    ring->sq_ring_size_ =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->sq_ring_ = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    ring->cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->cq_ring_ = mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    ring->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    ring->sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+    if (ring->sq_ring_ == MAP_FAILED || ring->cq_ring_ == MAP_FAILED ||
+        sqes == MAP_FAILED) {
+      LOG(WARNING) << "Failed to map the io_uring queues: " << strerror(errno);
+      return nullptr;
+    }
+    char* sq = static_cast<char*>(ring->sq_ring_);
+    ring->sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(ring->cq_ring_);
+    ring->cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes_ =
+        reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    return ring;
+  }
+
+  int fd_ = -1;
+  unsigned num_entries_ = 0;
+  unsigned num_unsubmitted_ = 0;
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+  size_t sqes_size_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IoUring);
+};
+
+}  // namespace
+#endif  // TF_POSIX_USE_IO_URING
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -95,6 +268,80 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+#if defined(TF_POSIX_USE_IO_URING)
+  void MultiRead(std::vector<ReadRequest>* requests) const override {
+    IoUring* ring = IoUring::ForThisThread();
+    if (ring == nullptr) {
+      RandomAccessFile::MultiRead(requests);
+      return;
+    }
+    // Split the requests into chunks, each read by one entry of the ring.
+    struct Chunk {
+      size_t request;
+      struct iovec iov;
+      uint64 offset;
+    };
+    std::vector<Chunk> chunks;
+    for (size_t i = 0; i < requests->size(); ++i) {
+      ReadRequest& request = (*requests)[i];
+      request.status = Status::OK();
+      for (size_t pos = 0; pos < request.n; pos += kIoUringReadChunkSize) {
+        const size_t len = std::min(kIoUringReadChunkSize, request.n - pos);
+        chunks.push_back(
+            {i, {request.scratch + pos, len}, request.offset + pos});
+      }
+    }
+    // The number of bytes read into each chunk.
+    std::vector<size_t> bytes_read(chunks.size(), 0);
+    size_t num_submitted = 0;
+    size_t num_completed = 0;
+    while (num_completed < chunks.size()) {
+      while (num_submitted < chunks.size() &&
+             num_submitted - num_completed < ring->num_entries() &&
+             ring->PrepareRead(fd_, &chunks[num_submitted].iov,
+                               chunks[num_submitted].offset, num_submitted)) {
+        ++num_submitted;
+      }
+      const int err = ring->SubmitAndWait(1);
+      if (err != 0) {
+        // Reads may still be in flight into the buffers of the callers, so it
+        // is not safe to return.
+        LOG(FATAL) << "io_uring_enter() failed: " << strerror(err);
+      }
+      uint64 chunk;
+      int res;
+      while (ring->PopCompletion(&chunk, &res)) {
+        ++num_completed;
+        if (res >= 0) {
+          bytes_read[chunk] = res;
+        } else if (res != -EINTR && res != -EAGAIN) {
+          (*requests)[chunks[chunk].request].status = IOError(filename_, -res);
+        }
+      }
+    }
+    // Finish each request, reading the rest of a short chunk synchronously.
+    size_t chunk = 0;
+    for (size_t i = 0; i < requests->size(); ++i) {
+      ReadRequest& request = (*requests)[i];
+      size_t n = 0;
+      for (; chunk < chunks.size() && chunks[chunk].request == i; ++chunk) {
+        if (!request.status.ok() ||
+            n != chunks[chunk].offset - request.offset) {
+          continue;
+        }
+        n += bytes_read[chunk];
+        if (bytes_read[chunk] < chunks[chunk].iov.iov_len) {
+          StringPiece rest;
+          request.status = Read(request.offset + n, request.n - n, &rest,
+                                request.scratch + n);
+          n += rest.size();
+        }
+      }
+      request.result = StringPiece(request.scratch, n);
+    }
+  }
+#endif  // TF_POSIX_USE_IO_URING
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
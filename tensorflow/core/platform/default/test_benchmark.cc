@@ -233,6 +233,21 @@ void Benchmark::Run(const char* pattern) {
         LOG(ERROR) << s.ToString();
         exit(EXIT_FAILURE);
       }
+      if (!label.empty()) {
+        s.Update(reporter.SetProperty("label", label));
+      }
+      if (bytes_processed > 0) {
+        s.Update(reporter.AddMetric("bytes_per_second",
+                                    bytes_processed / seconds));
+      }
+      if (items_processed > 0) {
+        s.Update(reporter.AddMetric("items_per_second",
+                                    items_processed / seconds));
+      }
+      if (!s.ok()) {
+        LOG(ERROR) << s.ToString();
+        exit(EXIT_FAILURE);
+      }
       s = reporter.Close();
       if (!s.ok()) {
         LOG(ERROR) << s.ToString();
@@ -90,6 +90,34 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, MultiRead) {
+  const string filename = io::JoinPath(BaseDir(), "multi_read");
+  const int length = (1 << 20) + 100;
+  const string input = CreateTestFile(env_, filename, length);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // Reads of a few bytes, of several chunks, and past EOF.
+  const std::vector<std::pair<uint64, size_t>> reads = {
+      {0, 10}, {7, 1 << 20}, {length - 1000, 1000}, {length - 50, 100}};
+  std::vector<string> scratch;
+  std::vector<RandomAccessFile::ReadRequest> requests(reads.size());
+  for (size_t i = 0; i < reads.size(); ++i) {
+    scratch.emplace_back(reads[i].second, 0);
+    requests[i].offset = reads[i].first;
+    requests[i].n = reads[i].second;
+    requests[i].scratch = &scratch[i][0];
+  }
+  f->MultiRead(&requests);
+  for (size_t i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(requests[i].status);
+    EXPECT_EQ(input.substr(reads[i].first, reads[i].second),
+              requests[i].result);
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[3].status.code());
+  EXPECT_EQ(input.substr(length - 50), requests[3].result);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
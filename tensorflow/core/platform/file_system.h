@@ -751,6 +751,33 @@ class RandomAccessFile {
   virtual tensorflow::Status Read(uint64 offset, size_t n, StringPiece* result,
                                   char* scratch) const = 0;
 
+  /// \brief A read for `MultiRead()`, with the arguments and results of the
+  /// equivalent `Read()` call.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    char* scratch = nullptr;
+    StringPiece result;
+    tensorflow::Status status;
+  };
+
+  /// \brief Performs all the reads in `*requests`, and returns once all of
+  /// them are done.
+  ///
+  /// Sets the `result` and `status` of each request as `Read()` does.
+  /// Implementations may keep several reads in flight at once, including
+  /// parts of a single large read, so that one thread can keep a storage
+  /// device busy. The default implementation calls `Read()` for each request
+  /// in turn.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void MultiRead(std::vector<ReadRequest>* requests) const {
+    for (ReadRequest& request : *requests) {
+      request.status =
+          Read(request.offset, request.n, &request.result, request.scratch);
+    }
+  }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tensorflow::Status Read(uint64 offset, size_t n,
@@ -478,6 +478,19 @@ S3FileSystem::S3FileSystem()
     }
   }
 
+  // The parts of multi-part transfers are uploaded and downloaded by a pool of
+  // threads; more threads allow a single large file to use more of the
+  // network bandwidth.
+  const char* pool_size_str = getenv("S3_TRANSFER_MANAGER_THREADS");
+  executor_pool_size_ = kExecutorPoolSize;
+  if (pool_size_str) {
+    int32 pool_size_num;
+    if (strings::safe_strto32(pool_size_str, &pool_size_num) &&
+        pool_size_num > 0) {
+      executor_pool_size_ = pool_size_num;
+    }
+  }
+
   use_multi_part_download_ = true;
   const char* disable_transfer_mgr = getenv("S3_DISABLE_MULTI_PART_DOWNLOAD");
   if (disable_transfer_mgr) {
@@ -550,7 +563,7 @@ S3FileSystem::GetTransferManager(
     config.bufferSize = this->multi_part_chunk_size_[direction];
     // must be larger than pool size * multi part chunk size
     config.transferBufferMaxHeapSize =
-        (kExecutorPoolSize + 1) * this->multi_part_chunk_size_[direction];
+        (executor_pool_size_ + 1) * this->multi_part_chunk_size_[direction];
     this->transfer_managers_[direction] =
         Aws::Transfer::TransferManager::Create(config);
   }
@@ -562,7 +575,7 @@ S3FileSystem::GetExecutor() {
   if (this->executor_.get() == nullptr) {
     this->executor_ =
         Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(
-            kExecutorTag, kExecutorPoolSize);
+            kExecutorTag, executor_pool_size_);
   }
   return this->executor_;
 }
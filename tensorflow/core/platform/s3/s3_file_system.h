@@ -122,6 +122,9 @@ class S3FileSystem : public FileSystem {
   // Returns the member executor for transfer manager, initializing as-needed.
   std::shared_ptr<Aws::Utils::Threading::PooledThreadExecutor> GetExecutor();
   std::shared_ptr<Aws::Utils::Threading::PooledThreadExecutor> executor_;
+  // The number of threads of 'executor_', i.e. the number of parts uploaded
+  // or downloaded concurrently.
+  int executor_pool_size_;
 
   Status CopyFile(const Aws::String& source_bucket,
                   const Aws::String& source_key,
@@ -57,14 +57,14 @@ namespace tensorflow {
 // responsibility to ensure that the underlying buffer of a VIEW tstring exceeds
 // the lifetime of the associated tstring object.
 //
-// TODO(dero): Methods for creating OFFSET tensors are not currently
-// implemented.
-//
 // OFFSET tstrings are platform independent offset defined strings which can be
 // directly mmaped or copied into a tensor buffer without the need for
-// deserialization or processing.  For security reasons, it is imperative that
-// OFFSET based string tensors are validated before use, or are from a trusted
-// source.
+// deserialization or processing.  They also back string tensors whose
+// characters are stored in the tensor buffer after the tstrings, see
+// AllocateStringTensorWithArena().  Copies and moves of OFFSET tstrings are
+// owned tstrings, since the characters belong to the buffer holding the
+// original.  For security reasons, it is imperative that OFFSET based string
+// tensors are validated before use, or are from a trusted source.
 //
 // Underlying VIEW and OFFSET buffers are considered immutable, so l-value
 // assignment, mutation, or non-const access to data() of tstrings will result
@@ -206,6 +206,12 @@ class tstring {
   tstring& assign_as_view(const char* str, size_t len);
   tstring& assign_as_view(const char* str);
 
+  // Offset Assignment
+  // NOTE: `str' must be in the same buffer as this tstring, after it and less
+  // than 4GB away, and must not move relative to it; see
+  // TF_TString_AssignOffset.
+  tstring& assign_as_offset(const char* str, size_t len);
+
   // Modifiers
   // NOTE: Invalid input will result in undefined behavior.
   tstring& append(const tstring& str);
@@ -506,6 +512,14 @@ inline tstring& tstring::assign_as_view(const char* str) {
   return *this;
 }
 
+// Offset Assignment
+
+inline tstring& tstring::assign_as_offset(const char* str, size_t len) {
+  TF_TString_AssignOffset(&tstr_, str, len);
+
+  return *this;
+}
+
 // Modifiers
 
 inline tstring& tstring::append(const tstring& str) {
@@ -562,7 +576,13 @@ inline tstring& tstring::insert(size_t pos, size_t n, char c) {
 }
 
 inline void tstring::swap(tstring& str) {
-  // TODO(dero): Invalid for OFFSET (unimplemented).
+  if (type() == OFFSET || str.type() == OFFSET) {
+    // OFFSET tstrings can't be relocated, so swap through owned copies.
+    tstring tmp(std::move(str));
+    str = std::move(*this);
+    *this = std::move(tmp);
+    return;
+  }
   std::swap(tstr_, str.tstr_);
 }
 
@@ -193,6 +193,46 @@ TEST(TF_TStringTest, Assignment) {
 #endif  // PLATFORM_GOOGLE
 }
 
+TEST(TF_TStringTest, Offset) {
+  // Strings followed by their characters in the same buffer, like the
+  // elements of an arena-backed string tensor.
+  struct {
+    tstring strings[2];
+    char chars[sizeof(kLongString) + 6];
+  } buffer;
+  memcpy(buffer.chars, "hello", 6);
+  memcpy(buffer.chars + 6, kLongString, sizeof(kLongString));
+  buffer.strings[0].assign_as_offset(buffer.chars, 5);
+  buffer.strings[1].assign_as_offset(buffer.chars + 6, kLongStringLen);
+
+  EXPECT_EQ(tstring::Type::OFFSET, buffer.strings[0].type());
+  EXPECT_EQ(tstring::Type::OFFSET, buffer.strings[1].type());
+  EXPECT_EQ(5, buffer.strings[0].size());
+  EXPECT_EQ(kLongStringLen, buffer.strings[1].size());
+  EXPECT_STREQ("hello", buffer.strings[0].c_str());
+  EXPECT_STREQ(kLongString, buffer.strings[1].c_str());
+
+  // Copies and moves don't refer to the buffer.
+  tstring copy(buffer.strings[1]);
+  tstring moved(std::move(buffer.strings[0]));
+
+  EXPECT_EQ(tstring::Type::LARGE, copy.type());
+  EXPECT_EQ(kLongString, copy);
+  EXPECT_EQ(tstring::Type::SMALL, moved.type());
+  EXPECT_EQ("hello", moved);
+
+  buffer.strings[0].swap(buffer.strings[1]);
+
+  EXPECT_EQ(kLongString, buffer.strings[0]);
+  EXPECT_NE(tstring::Type::OFFSET, buffer.strings[0].type());
+
+  buffer.strings[1].mdata()[0] = 'j';
+
+  EXPECT_EQ("jello", buffer.strings[1]);
+  EXPECT_EQ(tstring::Type::SMALL, buffer.strings[1].type());
+  EXPECT_EQ('h', buffer.chars[0]);
+}
+
 TEST(TF_TStringTest, Comparison) {
   tstring empty("");
   tstring a("a");
@@ -99,6 +99,26 @@ inline void SetRooflineMetrics(const OpMetrics& metrics,
                            : ((metrics.flops() != 0) ? "Compute" : "Unknown"));
 }
 
+// Sets the predicted costs of the op and the fractions of the peak FLOP rate
+// and memory bandwidth of the device that it achieved.
+template <typename Record>
+inline void SetRooflineUtilization(const OpMetrics& metrics,
+                                   double peak_tera_flops_per_second,
+                                   double peak_hbm_bw_giga_bytes_per_second,
+                                   Record* record) {
+  record->set_flops(metrics.flops());
+  record->set_bytes_accessed(metrics.bytes_accessed());
+  // FLOPs per nanosecond are GFLOPs per second, and bytes per nanosecond are
+  // GB per second.
+  const double time_ns = PicosToNanos(metrics.time_ps());
+  record->set_flop_rate_utilization(
+      SafeDivide(SafeDivide(metrics.flops(), time_ns),
+                 peak_tera_flops_per_second * 1000));
+  record->set_memory_bw_utilization(
+      SafeDivide(SafeDivide(metrics.bytes_accessed(), time_ns),
+                 peak_hbm_bw_giga_bytes_per_second));
+}
+
 }  // namespace profiler
 }  // namespace tensorflow
 
@@ -23,12 +23,14 @@ namespace tensorflow {
 namespace profiler {
 namespace {
 
-// Merges XPlanes generated by TraceMe, CUPTI API trace and Python tracer.
+// Merges XPlanes generated by TraceMe, CUPTI API trace, roctracer HIP API trace
+// and Python tracer.
 void MergeHostPlanesAndSortLines(XSpace* space) {
   XPlane* host_plane =
       FindOrAddMutablePlaneWithName(space, kHostThreadsPlaneName);
   std::vector<const XPlane*> additional_host_planes = FindPlanesWithNames(
-      *space, {kCuptiDriverApiPlaneName, kPythonTracerPlaneName});
+      *space, {kCuptiDriverApiPlaneName, kRocmTracerPlaneName,
+               kPythonTracerPlaneName});
   if (!additional_host_planes.empty()) {
     MergePlanes(additional_host_planes, host_plane);
     RemovePlanes(space, additional_host_planes);
@@ -0,0 +1,289 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/run_metadata_to_critical_path.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/critical_path.pb.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// An executed op and the executed ops it depends on.
+struct OpNode {
+  const NodeDef* node_def = nullptr;
+  std::string device;
+  int64 start_us = kint64max;
+  int64 end_us = kint64min;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+  // Time at which the last input of the op became ready, or the start of the
+  // step if the op has no inputs.
+  int64 ready_us = 0;
+  // Time from which the op neither waited to be scheduled nor waited for its
+  // inputs.
+  int64 busy_start_us() const { return std::max(start_us, ready_us); }
+  int64 busy_us() const { return std::max<int64>(0, end_us - busy_start_us()); }
+};
+
+// Node names cannot contain ':', which the GPU tracers use to append the op
+// type to the node name of the kernels they record.
+absl::string_view StatsNodeName(absl::string_view node_name) {
+  return node_name.substr(0, node_name.find(':'));
+}
+
+// Returns the name of the node that produces `input`, an input of a NodeDef.
+absl::string_view InputNodeName(absl::string_view input) {
+  absl::ConsumePrefix(&input, "^");
+  return input.substr(0, input.find(':'));
+}
+
+const AttrValue* FindAttr(const NodeDef& node_def, const std::string& name) {
+  auto it = node_def.attr().find(name);
+  return it == node_def.attr().end() ? nullptr : &it->second;
+}
+
+bool IsSend(const NodeDef& node_def) {
+  return node_def.op() == "_Send" || node_def.op() == "_HostSend";
+}
+
+bool IsRecv(const NodeDef& node_def) {
+  return node_def.op() == "_Recv" || node_def.op() == "_HostRecv";
+}
+
+// Returns the key of the tensor transferred by a _Send or _Recv op.
+std::string TransferKey(const NodeDef& node_def) {
+  std::string key;
+  for (const char* name : {"send_device", "recv_device", "tensor_name"}) {
+    const AttrValue* attr = FindAttr(node_def, name);
+    absl::StrAppend(&key, attr == nullptr ? "" : attr->s(), ";");
+  }
+  return key;
+}
+
+// Returns the key of the collective that `node_def` is part of, or an empty
+// string if it is not part of a collective that can be matched.
+std::string CollectiveKey(const NodeDef& node_def) {
+  if (absl::StrContains(node_def.op(), "Nccl")) {
+    const AttrValue* shared_name = FindAttr(node_def, "shared_name");
+    if (shared_name != nullptr) return absl::StrCat("nccl;", shared_name->s());
+  } else if (absl::StartsWith(node_def.op(), "Collective")) {
+    const AttrValue* instance_key = FindAttr(node_def, "instance_key");
+    if (instance_key != nullptr) {
+      return absl::StrCat("collective;", instance_key->i());
+    }
+  }
+  return "";
+}
+
+// Adds the dependencies of every op on the other ops in `ops`.
+void AddDependencies(const absl::flat_hash_map<absl::string_view, int>& index,
+                     std::vector<OpNode>* ops) {
+  absl::flat_hash_map<std::string, int> sends;
+  for (int i = 0; i < ops->size(); ++i) {
+    if (IsSend(*(*ops)[i].node_def)) {
+      sends.emplace(TransferKey(*(*ops)[i].node_def), i);
+    }
+  }
+  absl::flat_hash_map<std::string, std::vector<int>> collectives;
+  for (int i = 0; i < ops->size(); ++i) {
+    OpNode& op = (*ops)[i];
+    for (const std::string& input : op.node_def->input()) {
+      auto it = index.find(InputNodeName(input));
+      if (it != index.end()) op.inputs.push_back(it->second);
+    }
+    if (IsRecv(*op.node_def)) {
+      auto it = sends.find(TransferKey(*op.node_def));
+      if (it != sends.end()) op.inputs.push_back(it->second);
+    }
+    std::string collective_key = CollectiveKey(*op.node_def);
+    if (!collective_key.empty()) collectives[collective_key].push_back(i);
+  }
+  for (const auto& collective : collectives) {
+    std::vector<int> inputs;
+    for (int member : collective.second) {
+      const std::vector<int>& member_inputs = (*ops)[member].inputs;
+      inputs.insert(inputs.end(), member_inputs.begin(), member_inputs.end());
+    }
+    for (int member : collective.second) {
+      std::vector<int>& member_inputs = (*ops)[member].inputs;
+      member_inputs.insert(member_inputs.end(), inputs.begin(), inputs.end());
+    }
+  }
+  for (int i = 0; i < ops->size(); ++i) {
+    std::vector<int>& inputs = (*ops)[i].inputs;
+    absl::c_sort(inputs);
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+    inputs.erase(std::remove(inputs.begin(), inputs.end(), i), inputs.end());
+    for (int input : inputs) (*ops)[input].outputs.push_back(i);
+  }
+}
+
+// Returns the ops in an order where every op comes after its inputs. Ops that
+// are part of a dependency cycle are left out.
+std::vector<int> TopologicalOrder(const std::vector<OpNode>& ops) {
+  std::vector<int> pending_inputs(ops.size());
+  std::vector<int> order;
+  order.reserve(ops.size());
+  for (int i = 0; i < ops.size(); ++i) {
+    pending_inputs[i] = ops[i].inputs.size();
+    if (pending_inputs[i] == 0) order.push_back(i);
+  }
+  for (int next = 0; next < order.size(); ++next) {
+    for (int output : ops[order[next]].outputs) {
+      if (--pending_inputs[output] == 0) order.push_back(output);
+    }
+  }
+  return order;
+}
+
+}  // namespace
+
+CriticalPath ConvertRunMetadataToCriticalPath(const RunMetadata& run_metadata) {
+  absl::flat_hash_map<absl::string_view, const NodeDef*> node_defs;
+  auto add_graph = [&node_defs](const GraphDef& graph) {
+    for (const NodeDef& node_def : graph.node()) {
+      node_defs.emplace(node_def.name(), &node_def);
+    }
+  };
+  for (const GraphDef& graph : run_metadata.partition_graphs()) {
+    add_graph(graph);
+  }
+  for (const auto& function_graphs : run_metadata.function_graphs()) {
+    for (const GraphDef& graph : function_graphs.partition_graphs()) {
+      add_graph(graph);
+    }
+  }
+
+  // An op may be recorded both by its executor and by the tracer of its
+  // device, in which case it runs until the last of its kernels is done.
+  std::vector<OpNode> ops;
+  absl::flat_hash_map<absl::string_view, int> index;
+  for (const auto& device_stats : run_metadata.step_stats().dev_stats()) {
+    for (const NodeExecStats& node_stats : device_stats.node_stats()) {
+      auto node_def = node_defs.find(StatsNodeName(node_stats.node_name()));
+      if (node_def == node_defs.end()) continue;
+      auto inserted = index.emplace(node_def->first, ops.size());
+      if (inserted.second) {
+        ops.emplace_back();
+        ops.back().node_def = node_def->second;
+        ops.back().device = node_def->second->device().empty()
+                                ? device_stats.device()
+                                : node_def->second->device();
+      }
+      OpNode& op = ops[inserted.first->second];
+      op.start_us = std::min<int64>(op.start_us, node_stats.all_start_micros());
+      op.end_us =
+          std::max<int64>(op.end_us, node_stats.all_start_micros() +
+                                         node_stats.all_end_rel_micros());
+    }
+  }
+  CriticalPath critical_path;
+  if (ops.empty()) return critical_path;
+  AddDependencies(index, &ops);
+
+  int64 step_start_us = kint64max;
+  int64 step_end_us = kint64min;
+  int last_op = 0;
+  for (int i = 0; i < ops.size(); ++i) {
+    step_start_us = std::min(step_start_us, ops[i].start_us);
+    if (ops[i].end_us > step_end_us) {
+      step_end_us = ops[i].end_us;
+      last_op = i;
+    }
+  }
+  for (OpNode& op : ops) {
+    op.ready_us = step_start_us;
+    for (int input : op.inputs) {
+      op.ready_us = std::max(op.ready_us, ops[input].end_us);
+    }
+  }
+
+  // The latest time at which every op can end without delaying the end of the
+  // step, if every op still runs for as long once it is ready.
+  std::vector<int64> latest_end_us(ops.size(), step_end_us);
+  std::vector<int> order = TopologicalOrder(ops);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    for (int output : ops[*it].outputs) {
+      latest_end_us[*it] = std::min(
+          latest_end_us[*it], latest_end_us[output] - ops[output].busy_us());
+    }
+  }
+
+  std::vector<int> by_start(ops.size());
+  for (int i = 0; i < ops.size(); ++i) by_start[i] = i;
+  absl::c_stable_sort(by_start, [&ops](int a, int b) {
+    return ops[a].start_us < ops[b].start_us;
+  });
+  std::vector<int> position(ops.size());
+  for (int i = 0; i < by_start.size(); ++i) {
+    const OpNode& op = ops[by_start[i]];
+    position[by_start[i]] = i;
+    CriticalPathOp* op_proto = critical_path.add_ops();
+    op_proto->set_name(op.node_def->name());
+    op_proto->set_op_type(op.node_def->op());
+    op_proto->set_device(op.device);
+    op_proto->set_start_time_us(op.start_us - step_start_us);
+    op_proto->set_duration_us(op.end_us - op.start_us);
+    op_proto->set_wait_us(std::max<int64>(0, op.start_us - op.ready_us));
+    op_proto->set_slack_us(
+        std::max<int64>(0, latest_end_us[by_start[i]] - op.end_us));
+  }
+  critical_path.set_step_time_us(step_end_us - step_start_us);
+
+  // Walks back from the op that ends last through the inputs that became
+  // ready last.
+  std::vector<int> path;
+  std::vector<bool> visited(ops.size());
+  for (int op = last_op; op >= 0 && !visited[op];) {
+    visited[op] = true;
+    path.push_back(op);
+    int last_input = -1;
+    for (int input : ops[op].inputs) {
+      if (last_input < 0 || ops[input].end_us > ops[last_input].end_us) {
+        last_input = input;
+      }
+    }
+    op = last_input;
+  }
+  int64 op_time_us = 0;
+  int64 wait_time_us = 0;
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    critical_path.add_critical_path(position[*it]);
+    op_time_us += ops[*it].busy_us();
+    wait_time_us += std::max<int64>(0, ops[*it].start_us - ops[*it].ready_us);
+  }
+  critical_path.set_critical_path_op_time_us(op_time_us);
+  critical_path.set_critical_path_wait_time_us(wait_time_us);
+  return critical_path;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,46 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_RUN_METADATA_TO_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_RUN_METADATA_TO_CRITICAL_PATH_H_
+
+#include "tensorflow/core/profiler/protobuf/critical_path.pb.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Computes the critical path of the step described by `run_metadata`, from the
+// execution times of its ops in the step stats and the dependencies between
+// them in the partition graphs. Both are only recorded for steps run with
+// RunOptions.trace_level = FULL_TRACE and output_partition_graphs = true.
+//
+// Besides the data and control edges of the partition graphs, a _Recv depends
+// on the _Send that feeds it from another device, and every op of a collective
+// depends on the inputs of all the ops of the collective, since none of them
+// can finish before all of them have started. The ops of a collective are
+// matched by their instance_key attribute, or by their shared_name attribute
+// for the NCCL ops. Collectives whose instance key is an input, as for the V2
+// collective ops, are not matched.
+//
+// Ops that wait for their inputs once started, such as _Recv or the
+// collectives, are considered to run only from the time their last input
+// became ready.
+CriticalPath ConvertRunMetadataToCriticalPath(const RunMetadata& run_metadata);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_RUN_METADATA_TO_CRITICAL_PATH_H_
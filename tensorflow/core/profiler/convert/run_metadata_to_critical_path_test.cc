@@ -0,0 +1,176 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/run_metadata_to_critical_path.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/critical_path.pb.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+constexpr char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+constexpr char kGpu[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+constexpr char kGpu1[] = "/job:localhost/replica:0/task:0/device:GPU:1";
+
+NodeDef* AddNode(GraphDef* graph, absl::string_view name, absl::string_view op,
+                 absl::string_view device,
+                 const std::vector<std::string>& inputs = {}) {
+  NodeDef* node_def = graph->add_node();
+  node_def->set_name(std::string(name));
+  node_def->set_op(std::string(op));
+  node_def->set_device(std::string(device));
+  for (const std::string& input : inputs) node_def->add_input(input);
+  return node_def;
+}
+
+void SetTransferAttrs(NodeDef* node_def) {
+  (*node_def->mutable_attr())["send_device"].set_s(kCpu);
+  (*node_def->mutable_attr())["recv_device"].set_s(kGpu);
+  (*node_def->mutable_attr())["tensor_name"].set_s("edge_1_a");
+}
+
+void AddStats(DeviceStepStats* device_stats, absl::string_view node_name,
+              int64 start_us, int64 end_us) {
+  NodeExecStats* node_stats = device_stats->add_node_stats();
+  node_stats->set_node_name(std::string(node_name));
+  node_stats->set_all_start_micros(1000 + start_us);
+  node_stats->set_all_end_rel_micros(end_us - start_us);
+}
+
+std::vector<std::string> CriticalPathNames(const CriticalPath& critical_path) {
+  std::vector<std::string> names;
+  for (int index : critical_path.critical_path()) {
+    names.push_back(critical_path.ops(index).name());
+  }
+  return names;
+}
+
+const CriticalPathOp& FindOp(const CriticalPath& critical_path,
+                             absl::string_view name) {
+  for (const CriticalPathOp& op : critical_path.ops()) {
+    if (op.name() == name) return op;
+  }
+  LOG(FATAL) << "Op not found: " << name;
+}
+
+TEST(ConvertRunMetadataToCriticalPath, FollowsRecvAcrossDevices) {
+  RunMetadata run_metadata;
+  GraphDef* cpu_graph = run_metadata.add_partition_graphs();
+  AddNode(cpu_graph, "a", "Const", kCpu);
+  SetTransferAttrs(AddNode(cpu_graph, "send", "_Send", kCpu, {"a"}));
+  GraphDef* gpu_graph = run_metadata.add_partition_graphs();
+  SetTransferAttrs(AddNode(gpu_graph, "recv", "_Recv", kGpu));
+  AddNode(gpu_graph, "b", "MatMul", kGpu, {"recv", "^c"});
+  AddNode(gpu_graph, "c", "Const", kGpu);
+  AddNode(gpu_graph, "d", "Relu", kGpu, {"c:0"});
+
+  DeviceStepStats* cpu_stats =
+      run_metadata.mutable_step_stats()->add_dev_stats();
+  cpu_stats->set_device(kCpu);
+  AddStats(cpu_stats, "a", 0, 10);
+  AddStats(cpu_stats, "send", 10, 11);
+  DeviceStepStats* gpu_stats =
+      run_metadata.mutable_step_stats()->add_dev_stats();
+  gpu_stats->set_device(kGpu);
+  // The _Recv is issued early and waits for the _Send.
+  AddStats(gpu_stats, "recv", 2, 15);
+  AddStats(gpu_stats, "b", 16, 20);
+  AddStats(gpu_stats, "c", 0, 5);
+  AddStats(gpu_stats, "d", 6, 8);
+  // The kernel of b recorded by the GPU tracer ends after its executor stats.
+  DeviceStepStats* stream_stats =
+      run_metadata.mutable_step_stats()->add_dev_stats();
+  stream_stats->set_device(absl::StrCat(kGpu, "/stream:all"));
+  AddStats(stream_stats, "b:MatMul", 18, 30);
+  AddStats(stream_stats, "volta_sgemm_128x64_nn", 18, 30);
+
+  CriticalPath critical_path = ConvertRunMetadataToCriticalPath(run_metadata);
+  EXPECT_EQ(critical_path.step_time_us(), 30);
+  ASSERT_EQ(critical_path.ops_size(), 6);
+  EXPECT_EQ(CriticalPathNames(critical_path),
+            std::vector<std::string>({"a", "send", "recv", "b"}));
+  EXPECT_EQ(critical_path.critical_path_op_time_us(), 29);
+  EXPECT_EQ(critical_path.critical_path_wait_time_us(), 1);
+
+  const CriticalPathOp& b = FindOp(critical_path, "b");
+  EXPECT_EQ(b.device(), kGpu);
+  EXPECT_EQ(b.start_time_us(), 16);
+  EXPECT_EQ(b.duration_us(), 14);
+  EXPECT_EQ(b.wait_us(), 1);
+  EXPECT_EQ(b.slack_us(), 0);
+  // The ops before b could have ended 1us later, when b started.
+  EXPECT_EQ(FindOp(critical_path, "recv").wait_us(), 0);
+  EXPECT_EQ(FindOp(critical_path, "recv").slack_us(), 1);
+  EXPECT_EQ(FindOp(critical_path, "a").slack_us(), 1);
+  EXPECT_EQ(FindOp(critical_path, "c").slack_us(), 11);
+  EXPECT_EQ(FindOp(critical_path, "d").slack_us(), 22);
+}
+
+TEST(ConvertRunMetadataToCriticalPath, CollectiveWaitsForAllMembers) {
+  RunMetadata run_metadata;
+  GraphDef* graph0 = run_metadata.add_partition_graphs();
+  AddNode(graph0, "x0", "MatMul", kGpu);
+  (*AddNode(graph0, "reduce0", "CollectiveReduce", kGpu, {"x0"})
+        ->mutable_attr())["instance_key"]
+      .set_i(1);
+  GraphDef* graph1 = run_metadata.add_partition_graphs();
+  AddNode(graph1, "x1", "MatMul", kGpu1);
+  (*AddNode(graph1, "reduce1", "CollectiveReduce", kGpu1, {"x1"})
+        ->mutable_attr())["instance_key"]
+      .set_i(1);
+
+  DeviceStepStats* stats0 = run_metadata.mutable_step_stats()->add_dev_stats();
+  stats0->set_device(kGpu);
+  AddStats(stats0, "x0", 0, 10);
+  AddStats(stats0, "reduce0", 10, 20);
+  DeviceStepStats* stats1 = run_metadata.mutable_step_stats()->add_dev_stats();
+  stats1->set_device(kGpu1);
+  AddStats(stats1, "x1", 0, 15);
+  AddStats(stats1, "reduce1", 15, 20);
+
+  CriticalPath critical_path = ConvertRunMetadataToCriticalPath(run_metadata);
+  EXPECT_EQ(critical_path.step_time_us(), 20);
+  // reduce0 could not finish before x1, on the other GPU, was done.
+  EXPECT_EQ(CriticalPathNames(critical_path),
+            std::vector<std::string>({"x1", "reduce0"}));
+  EXPECT_EQ(critical_path.critical_path_op_time_us(), 20);
+  EXPECT_EQ(critical_path.critical_path_wait_time_us(), 0);
+  EXPECT_EQ(FindOp(critical_path, "x0").slack_us(), 5);
+  EXPECT_EQ(FindOp(critical_path, "x1").slack_us(), 0);
+}
+
+TEST(ConvertRunMetadataToCriticalPath, EmptyRunMetadata) {
+  CriticalPath critical_path = ConvertRunMetadataToCriticalPath(RunMetadata());
+  EXPECT_EQ(critical_path.step_time_us(), 0);
+  EXPECT_EQ(critical_path.ops_size(), 0);
+  EXPECT_EQ(critical_path.critical_path_size(), 0);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
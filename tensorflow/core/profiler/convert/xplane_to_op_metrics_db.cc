@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -219,6 +220,21 @@ OpMetricsDb ConvertDeviceTraceXPlaneToOpMetricsDb(const XPlane& device_trace) {
 
   TfOpRoofLineCostEstimator op_level_cost_estimator;
   XPlaneVisitor plane = CreateTfXPlaneVisitor(&device_trace);
+
+  // A TF op may launch several kernels, but the cost estimator predicts the
+  // costs of the whole TF op. The costs are split evenly between the distinct
+  // kernels of the TF op, instead of being counted once per kernel.
+  absl::flat_hash_map<absl::string_view, absl::flat_hash_set<absl::string_view>>
+      kernels_per_tf_op;
+  plane.ForEachLine([&](const XLineVisitor& line) {
+    if (IsDerivedThreadId(line.Id())) return;
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      absl::optional<XStatVisitor> stat = event.GetStat(StatType::kTfOp);
+      if (!stat) stat = event.GetStat(StatType::kLevel0);
+      if (stat) kernels_per_tf_op[stat->StrOrRefValue()].insert(event.Name());
+    });
+  });
+
   plane.ForEachLine([&](const XLineVisitor& line) {
     if (IsDerivedThreadId(line.Id())) return;
     line.ForEachEvent([&](const XEventVisitor& event) {
@@ -240,6 +256,9 @@ OpMetricsDb ConvertDeviceTraceXPlaneToOpMetricsDb(const XPlane& device_trace) {
       TfOpRoofLineCostEstimator::OpRoofLineStats costs;
       if (tf_op.category != Category::kUnknown) {
         costs = op_level_cost_estimator.Predict(event);
+        const uint64 num_kernels = kernels_per_tf_op[tf_op_full_name].size();
+        costs.flops /= num_kernels;
+        costs.bytes_accessed /= num_kernels;
       }
       device_op_metrics_db_builder.EnterOp(
           /*program_id=*/0, absl::StrCat(tf_op.name, "/", event.Name()),
@@ -170,6 +170,47 @@ TEST(ConvertXPlaneToOpMetricsDb, DeviceOpMetricsDb) {
   EXPECT_EQ(NanosToPicos(0), idle.time_ps());
 }
 
+TEST(ConvertXPlaneToOpMetricsDb, DeviceOpCostsAreSplitAcrossKernels) {
+  // MatMul1 has kernel1 and kernel2; MatMul2 has kernel3. Both ops have the
+  // same shapes, hence the same costs.
+  static constexpr char kMatMul1[] = "MatMul1:MatMul";
+  static constexpr char kMatMul2[] = "MatMul2:MatMul";
+  static constexpr char kShapes[] = "(float[8,8];float[8,8])";
+
+  XSpace xspace;
+  XPlane* xplane = GetOrCreateGpuXPlane(&xspace, /*device_ordinal=*/0);
+  XPlaneBuilder device_plane(xplane);
+  XLineBuilder stream = device_plane.GetOrCreateLine(/*line_id=*/10);
+  auto add_kernel = [&](absl::string_view tf_op_fullname,
+                        absl::string_view kernel_name, int64 start_ns) {
+    XEventBuilder event = stream.AddEvent(
+        *device_plane.GetOrCreateEventMetadata(kernel_name));
+    event.SetTimestampNs(start_ns);
+    event.SetDurationNs(1000);
+    event.AddStatValue(
+        *device_plane.GetOrCreateStatMetadata("level 0"),
+        *device_plane.GetOrCreateStatMetadata(std::string(tf_op_fullname)));
+    event.AddStatValue(*device_plane.GetOrCreateStatMetadata("shape"),
+                       *device_plane.GetOrCreateStatMetadata(kShapes));
+  };
+  add_kernel(kMatMul1, "kernel1", 100000);
+  add_kernel(kMatMul1, "kernel2", 110000);
+  add_kernel(kMatMul2, "kernel3", 120000);
+
+  OpMetricsDb op_metrics = ConvertDeviceTraceXPlaneToOpMetricsDb(*xplane);
+
+  // kernel1, kernel2, kernel3, Idle.
+  ASSERT_EQ(4, op_metrics.metrics_db_size());
+  const OpMetrics& kernel1 = op_metrics.metrics_db().at(0);
+  const OpMetrics& kernel2 = op_metrics.metrics_db().at(1);
+  const OpMetrics& kernel3 = op_metrics.metrics_db().at(2);
+  EXPECT_GT(kernel3.flops(), 0);
+  EXPECT_EQ(kernel1.flops(), kernel2.flops());
+  EXPECT_EQ(kernel3.flops(), kernel1.flops() + kernel2.flops());
+  EXPECT_EQ(kernel3.bytes_accessed(),
+            kernel1.bytes_accessed() + kernel2.bytes_accessed());
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
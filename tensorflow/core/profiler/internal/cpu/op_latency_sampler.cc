@@ -0,0 +1,210 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/internal/cpu/op_latency_sampler.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace internal {
+
+std::atomic<int> g_op_sampling_period(0);
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
+
+}  // namespace internal
+
+namespace {
+
+struct Sample {
+  char op_type[OpLatencySampler::kMaxOpTypeLength];
+  uint8 op_type_length;
+  uint64 latency_ns;
+};
+
+}  // namespace
+
+// A single-producer single-consumer ring of samples.
+//
+// Push is only called by the owner thread, and Drain by the thread that
+// collects the aggregates while holding OpLatencySampler::mutex_. Both are
+// lock free: the producer only writes head_ and the consumer only writes tail_.
+// Push drops the sample instead of blocking when the ring is full.
+class OpLatencySampler::ThreadLocalRing {
+ public:
+  void Push(absl::string_view op_type, uint64 latency_ns) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (TF_PREDICT_FALSE(head - tail_.load(std::memory_order_acquire) ==
+                         kRingSize)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    Sample& sample = samples_[head % kRingSize];
+    const size_t length = std::min<size_t>(op_type.size(), kMaxOpTypeLength);
+    std::memcpy(sample.op_type, op_type.data(), length);
+    sample.op_type_length = length;
+    sample.latency_ns = latency_ns;
+    head_.store(head + 1, std::memory_order_release);  // Write after contents.
+  }
+
+  // Appends every sample in the ring at the time of invocation to `samples`,
+  // and removes them from the ring.
+  void Drain(std::vector<Sample>* samples) {
+    const size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+      samples->push_back(samples_[tail % kRingSize]);
+    }
+    tail_.store(tail, std::memory_order_release);  // Read before freeing.
+  }
+
+  int64 TakeDropped() {
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+  bool IsActive() const { return active_.load(std::memory_order_acquire); }
+  void SetInactive() { active_.store(false, std::memory_order_release); }
+
+ private:
+  Sample samples_[kRingSize];
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+  std::atomic<int64> dropped_{0};
+  std::atomic<bool> active_{true};
+};
+
+// An instance of this wrapper is allocated in thread_local storage. It creates
+// the ring of the thread and registers it with the sampler the first time an
+// op is sampled on the thread, and marks it inactive when the thread exits, so
+// that the sampler releases it once its samples are collected.
+class OpLatencySampler::ThreadLocalRingWrapper {
+ public:
+  ThreadLocalRingWrapper() : ring_(std::make_shared<ThreadLocalRing>()) {
+    OpLatencySampler::Get()->RegisterThread(ring_);
+  }
+
+  ~ThreadLocalRingWrapper() { ring_->SetInactive(); }
+
+  void Push(absl::string_view op_type, uint64 latency_ns) {
+    ring_->Push(op_type, latency_ns);
+  }
+
+ private:
+  std::shared_ptr<ThreadLocalRing> ring_;
+};
+
+/*static*/ OpLatencySampler* OpLatencySampler::Get() {
+  static OpLatencySampler* singleton = new OpLatencySampler;
+  return singleton;
+}
+
+OpLatencySampler::OpLatencySampler() {
+  int64 period;
+  Status status =
+      ReadInt64FromEnvVar("TF_OP_LATENCY_SAMPLING_PERIOD", 0, &period);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+    period = 0;
+  }
+  SetSamplingPeriod(static_cast<int>(std::min<int64>(period, kint32max)));
+}
+
+void OpLatencySampler::SetSamplingPeriod(int period) {
+  internal::g_op_sampling_period.store(std::max(0, period),
+                                       std::memory_order_relaxed);
+}
+
+/*static*/ uint64 OpLatencySampler::MaybeStartSampled() {
+  // Counts down the ops until the next sampled op of this thread. Threads
+  // start at different points of the period, since they start with the
+  // first op.
+  static thread_local int ops_until_sample = 0;
+  if (--ops_until_sample > 0) return 0;
+  ops_until_sample =
+      internal::g_op_sampling_period.load(std::memory_order_relaxed);
+  return EnvTime::NowNanos();
+}
+
+/*static*/ void OpLatencySampler::Record(absl::string_view op_type,
+                                         uint64 start_time_ns) {
+  const uint64 end_time_ns = EnvTime::NowNanos();
+  static thread_local ThreadLocalRingWrapper thread_local_ring;
+  thread_local_ring.Push(op_type, end_time_ns - start_time_ns);
+}
+
+void OpLatencySampler::RegisterThread(std::shared_ptr<ThreadLocalRing> ring) {
+  mutex_lock lock(mutex_);
+  rings_.push_back(std::move(ring));
+}
+
+std::vector<OpLatencySampler::OpStats> OpLatencySampler::Collect() {
+  mutex_lock lock(mutex_);
+  std::vector<Sample> samples;
+  for (auto iter = rings_.begin(); iter != rings_.end();) {
+    ThreadLocalRing* ring = iter->get();
+    // Read the state before draining, so that the last samples of a thread
+    // that exits concurrently are drained before its ring is released.
+    const bool active = ring->IsActive();
+    ring->Drain(&samples);
+    num_dropped_samples_ += ring->TakeDropped();
+    iter = active ? iter + 1 : rings_.erase(iter);
+  }
+  for (const Sample& sample : samples) {
+    OpAggregate& aggregate =
+        aggregates_[std::string(sample.op_type, sample.op_type_length)];
+    const double latency_us = sample.latency_ns / 1000.0;
+    aggregate.latency_us.Add(latency_us);
+    aggregate.max_us = std::max(aggregate.max_us, latency_us);
+    ++aggregate.count;
+  }
+
+  std::vector<OpStats> stats;
+  stats.reserve(aggregates_.size());
+  for (const auto& op_type_and_aggregate : aggregates_) {
+    const OpAggregate& aggregate = op_type_and_aggregate.second;
+    OpStats op_stats;
+    op_stats.op_type = op_type_and_aggregate.first;
+    op_stats.count = aggregate.count;
+    op_stats.mean_us = aggregate.latency_us.Average();
+    op_stats.p50_us = aggregate.latency_us.Median();
+    op_stats.p90_us = aggregate.latency_us.Percentile(90.0);
+    op_stats.p99_us = aggregate.latency_us.Percentile(99.0);
+    op_stats.max_us = aggregate.max_us;
+    stats.push_back(std::move(op_stats));
+  }
+  return stats;
+}
+
+int64 OpLatencySampler::NumDroppedSamples() const {
+  mutex_lock lock(mutex_);
+  return num_dropped_samples_;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,131 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_OP_LATENCY_SAMPLER_H_
+#define TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_OP_LATENCY_SAMPLER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace internal {
+
+// Current op sampling period, or 0 if sampling is disabled.
+// Static atomic so OpLatencySampler::MaybeStart can be fast and non-blocking.
+TF_EXPORT extern std::atomic<int> g_op_sampling_period;
+
+}  // namespace internal
+
+// OpLatencySampler is a singleton that continuously measures the latency of
+// one in every N ops executed on each thread, with a low enough overhead to
+// be left on in production servers.
+//
+// Unlike TraceMeRecorder, it does not keep a trace of the sampled ops: every
+// thread appends the latency of its sampled ops to a fixed-size lock-free
+// ring, and the rings are drained into per-op-type latency histograms when
+// the aggregates are collected. Samples are dropped if a ring fills up
+// between two collections.
+//
+// Sampling is disabled by default. The sampling period is read from the
+// TF_OP_LATENCY_SAMPLING_PERIOD environment variable when the sampler is first
+// created, which the profiler service does when it starts.
+class OpLatencySampler {
+ public:
+  // Latency statistics of the sampled ops of one type, in microseconds.
+  struct OpStats {
+    std::string op_type;
+    int64 count = 0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p90_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+  };
+
+  // Op types longer than this are truncated in the samples.
+  static constexpr int kMaxOpTypeLength = 47;
+
+  // Number of samples that each thread can hold between two collections.
+  static constexpr int kRingSize = 1024;
+
+  static OpLatencySampler* Get();
+
+  // Returns whether ops are being sampled.
+  static bool Enabled() {
+    return internal::g_op_sampling_period.load(std::memory_order_relaxed) > 0;
+  }
+
+  // Returns the start time of the op about to run on this thread if it is
+  // sampled, or 0 otherwise. Its latency must then be recorded with Record.
+  static uint64 MaybeStart() {
+    if (TF_PREDICT_TRUE(!Enabled())) return 0;
+    return MaybeStartSampled();
+  }
+
+  // Records the latency of an op of type `op_type` that started at
+  // `start_time_ns`, as returned by MaybeStart.
+  static void Record(absl::string_view op_type, uint64 start_time_ns);
+
+  // Samples one in every `period` ops on each thread, or disables sampling if
+  // `period` is not positive.
+  void SetSamplingPeriod(int period);
+
+  // Drains the samples recorded so far into the aggregates, and returns the
+  // latency statistics of all the ops sampled since the sampler was created,
+  // sorted by op type.
+  std::vector<OpStats> Collect();
+
+  // Returns the number of samples dropped because a ring was full.
+  int64 NumDroppedSamples() const;
+
+ private:
+  class ThreadLocalRing;
+  class ThreadLocalRingWrapper;
+
+  struct OpAggregate {
+    histogram::Histogram latency_us;
+    int64 count = 0;
+    double max_us = 0.0;
+  };
+
+  OpLatencySampler();
+
+  static uint64 MaybeStartSampled();
+
+  void RegisterThread(std::shared_ptr<ThreadLocalRing> ring);
+
+  mutable mutex mutex_;
+  std::vector<std::shared_ptr<ThreadLocalRing>> rings_ TF_GUARDED_BY(mutex_);
+  std::map<std::string, OpAggregate> aggregates_ TF_GUARDED_BY(mutex_);
+  int64 num_dropped_samples_ TF_GUARDED_BY(mutex_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OpLatencySampler);
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_OP_LATENCY_SAMPLER_H_
@@ -0,0 +1,110 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/internal/cpu/op_latency_sampler.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Returns the statistics of `op_type`, or null if no op of that type was
+// sampled.
+std::unique_ptr<OpLatencySampler::OpStats> FindOpStats(
+    absl::string_view op_type) {
+  for (auto& stats : OpLatencySampler::Get()->Collect()) {
+    if (stats.op_type == op_type) {
+      return absl::make_unique<OpLatencySampler::OpStats>(std::move(stats));
+    }
+  }
+  return nullptr;
+}
+
+// Runs `num_ops` ops of type `op_type` on a new thread, so that the thread
+// starts sampling at the beginning of the period.
+void RunOpsOnNewThread(absl::string_view op_type, int num_ops) {
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "sampled_ops", [op_type, num_ops] {
+        for (int i = 0; i < num_ops; ++i) {
+          const uint64 start_time_ns = OpLatencySampler::MaybeStart();
+          if (start_time_ns != 0) {
+            OpLatencySampler::Record(op_type, start_time_ns);
+          }
+        }
+      }));
+}
+
+class OpLatencySamplerTest : public ::testing::Test {
+ protected:
+  void TearDown() override { OpLatencySampler::Get()->SetSamplingPeriod(0); }
+};
+
+TEST_F(OpLatencySamplerTest, DisabledByDefault) {
+  EXPECT_FALSE(OpLatencySampler::Enabled());
+  EXPECT_EQ(0, OpLatencySampler::MaybeStart());
+}
+
+TEST_F(OpLatencySamplerTest, SamplesOneInEveryPeriodOps) {
+  OpLatencySampler::Get()->SetSamplingPeriod(4);
+  RunOpsOnNewThread("SampledOp", 10);
+  auto stats = FindOpStats("SampledOp");
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(3, stats->count);
+  EXPECT_LE(stats->p50_us, stats->max_us);
+  EXPECT_LE(stats->p99_us, stats->max_us);
+}
+
+TEST_F(OpLatencySamplerTest, AggregatesAcrossCollections) {
+  OpLatencySampler::Get()->SetSamplingPeriod(1);
+  RunOpsOnNewThread("AggregatedOp", 5);
+  ASSERT_NE(FindOpStats("AggregatedOp"), nullptr);
+  RunOpsOnNewThread("AggregatedOp", 5);
+  auto stats = FindOpStats("AggregatedOp");
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(10, stats->count);
+}
+
+TEST_F(OpLatencySamplerTest, DropsSamplesWhenRingIsFull) {
+  OpLatencySampler::Get()->SetSamplingPeriod(1);
+  OpLatencySampler::Get()->Collect();
+  const int64 num_dropped = OpLatencySampler::Get()->NumDroppedSamples();
+  RunOpsOnNewThread("DroppedOp", OpLatencySampler::kRingSize + 10);
+  auto stats = FindOpStats("DroppedOp");
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(OpLatencySampler::kRingSize, stats->count);
+  EXPECT_EQ(num_dropped + 10, OpLatencySampler::Get()->NumDroppedSamples());
+}
+
+TEST_F(OpLatencySamplerTest, TruncatesLongOpTypes) {
+  OpLatencySampler::Get()->SetSamplingPeriod(1);
+  const std::string op_type(OpLatencySampler::kMaxOpTypeLength + 5, 'x');
+  RunOpsOnNewThread(op_type, 1);
+  auto stats = FindOpStats(
+      op_type.substr(0, OpLatencySampler::kMaxOpTypeLength));
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(1, stats->count);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -60,7 +60,34 @@ static void NormalizeTimeStamps(XPlaneBuilder* plane,
 }
 
 void GetDeviceCapabilities(int32 device_ordinal, XPlaneBuilder* device_plane) {
-  // TODO(rocm)
+  hipDeviceProp_t props;
+  if (hipGetDeviceProperties(&props, device_ordinal) != hipSuccess) return;
+
+  device_plane->AddStatValue(*device_plane->GetOrCreateStatMetadata(
+                                 GetStatTypeStr(StatType::kDevCapClockRateKHz)),
+                             props.clockRate);
+  device_plane->AddStatValue(*device_plane->GetOrCreateStatMetadata(
+                                 GetStatTypeStr(StatType::kDevCapCoreCount)),
+                             props.multiProcessorCount);
+  // Times 2 because HBM is DDR memory; it gets two data bits per each data
+  // lane.
+  const uint64 memory_bandwidth = uint64{2} * props.memoryClockRate * 1000 *
+                                  props.memoryBusWidth / 8;
+  device_plane->AddStatValue(
+      *device_plane->GetOrCreateStatMetadata(
+          GetStatTypeStr(StatType::kDevCapMemoryBandwidth)),
+      memory_bandwidth);
+  device_plane->AddStatValue(*device_plane->GetOrCreateStatMetadata(
+                                 GetStatTypeStr(StatType::kDevCapMemorySize)),
+                             static_cast<uint64>(props.totalGlobalMem));
+  device_plane->AddStatValue(
+      *device_plane->GetOrCreateStatMetadata(
+          GetStatTypeStr(StatType::kDevCapComputeCapMajor)),
+      props.major);
+  device_plane->AddStatValue(
+      *device_plane->GetOrCreateStatMetadata(
+          GetStatTypeStr(StatType::kDevCapComputeCapMinor)),
+      props.minor);
 }
 
 bool IsHostEvent(const RocmTracerEvent& event) {
@@ -143,6 +170,10 @@ class RocmTraceCollectorImpl : public profiler::RocmTraceCollector {
                 iter->second.end_time_ns = event.end_time_ns;
               }
               iter->second.annotation = event.annotation;
+              // The HIP_API activity record times the API call on the host.
+              iter->second.api_name = event.name;
+              iter->second.api_start_time_ns = event.start_time_ns;
+              iter->second.api_end_time_ns = event.end_time_ns;
               break;
           }
           break;
@@ -201,11 +232,14 @@ class RocmTraceCollectorImpl : public profiler::RocmTraceCollector {
     for (auto& iter : aggregated_events_) {
       auto& event = iter.second;
 
-      // sliently drop events that we capture via roctracer
-      // but do not yet know how to export to either stepstats or xplane
+      // sliently drop memsets for which we did not receive an HCC activity
+      // record, since we do not know where they ran on the device.
       // sliently because we only want to use OnEventsDropped for cases
       // when we drop events because they are somehow invalid
-      if (event.type == RocmTracerEventType::Memset) continue;
+      if (event.type == RocmTracerEventType::Memset &&
+          event.stream_id == RocmTracerEvent::kInvalidStreamId) {
+        continue;
+      }
 
       // For some hip API events, we never get a corresponding HCC
       // activity record callback and hence we currently do not have a way
@@ -440,6 +474,25 @@ class RocmTraceCollectorImpl : public profiler::RocmTraceCollector {
             memcpy_dev_stats->add_node_stats()->Swap(ns);
 
           } break;
+          case RocmTracerEventType::Memset: {
+            std::string details = absl::StrCat(
+                event.name, " num_elements:", event.memset_info.num_elements);
+            if (event.memset_info.async) {
+              absl::StrAppend(&details, " async");
+            }
+            ns->set_timeline_label(std::move(details));
+
+            DeviceStepStats*& stream_dev_stats =
+                per_stream_dev_stats[std::make_pair(event.stream_id,
+                                                    event.type)];
+            if (stream_dev_stats == nullptr) {
+              stream_dev_stats = step_stats->add_dev_stats();
+              stream_dev_stats->set_device(absl::StrCat(
+                  "/device:GPU:", device_ordinal, "/stream:", event.stream_id,
+                  "<", GetRocmTracerEventTypeName(event.type), ">"));
+            }
+            stream_dev_stats->add_node_stats()->Swap(ns);
+          } break;
           case RocmTracerEventType::MemoryAlloc: {
             std::string details = absl::StrCat(
                 event.name, " bytes:", event.memalloc_info.num_bytes);
@@ -518,10 +571,14 @@ class RocmTraceCollectorImpl : public profiler::RocmTraceCollector {
       }
       switch (event.type) {
         case RocmTracerEventType::Kernel: {
+          // Uses the keys of the CUPTI kernel details, which are parsed by
+          // ParseKernelLaunchParams for the kernel stats.
           const std::string kernel_details = absl::StrFormat(
-              "regs:%u shm:%u grid:%u,%u,%u block:%u,%u,%u",
+              "regs:%u static_shared:%u dynamic_shared:%u grid:%u,%u,%u "
+              "block:%u,%u,%u",
               event.kernel_info.registers_per_thread,
               event.kernel_info.static_shared_memory_usage,
+              event.kernel_info.dynamic_shared_memory_usage,
               event.kernel_info.grid_x, event.kernel_info.grid_y,
               event.kernel_info.grid_z, event.kernel_info.block_x,
               event.kernel_info.block_y, event.kernel_info.block_z);
@@ -543,6 +600,15 @@ class RocmTraceCollectorImpl : public profiler::RocmTraceCollector {
                                   GetStatTypeStr(StatType::kMemcpyDetails)),
                               memcpy_details);
         } break;
+        case RocmTracerEventType::Memset: {
+          std::string memset_details =
+              absl::StrFormat("num_elements:%u async:%u",
+                              event.memset_info.num_elements,
+                              event.memset_info.async);
+          xevent.AddStatValue(*plane->GetOrCreateStatMetadata(
+                                  GetStatTypeStr(StatType::kMemsetDetails)),
+                              memset_details);
+        } break;
         case RocmTracerEventType::MemoryAlloc: {
           std::string memalloc_details =
               absl::StrFormat("num_bytes:%u", event.memalloc_info.num_bytes);
@@ -591,6 +657,31 @@ class RocmTraceCollectorImpl : public profiler::RocmTraceCollector {
       }
     }
 
+    // Adds the HIP API call that issued `event` to the line of its thread in
+    // the host plane, so that the call is connected to the device activity it
+    // issued by their correlation id.
+    void CreateApiXEvent(const RocmTracerEvent& event, XPlaneBuilder* plane,
+                         uint64 start_gpu_ns, uint64 end_gpu_ns) {
+      if (event.api_name.empty() ||
+          event.thread_id == RocmTracerEvent::kInvalidThreadId ||
+          event.api_start_time_ns < start_gpu_ns ||
+          event.api_end_time_ns > end_gpu_ns ||
+          event.api_start_time_ns > event.api_end_time_ns) {
+        return;
+      }
+      XLineBuilder line = plane->GetOrCreateLine(event.thread_id);
+      line.SetTimestampNs(start_gpu_ns);
+      XEventBuilder xevent =
+          line.AddEvent(*plane->GetOrCreateEventMetadata(event.api_name));
+      xevent.SetTimestampNs(event.api_start_time_ns);
+      xevent.SetEndTimestampNs(event.api_end_time_ns);
+      if (event.correlation_id != RocmTracerEvent::kInvalidCorrelationId) {
+        xevent.AddStatValue(*plane->GetOrCreateStatMetadata(
+                                GetStatTypeStr(StatType::kCorrelationId)),
+                            event.correlation_id);
+      }
+    }
+
     void Export(uint64 start_walltime_ns, uint64 start_gputime_ns,
                 uint64 end_gputime_ns, XPlaneBuilder* device_plane,
                 XPlaneBuilder* host_plane) {
@@ -611,11 +702,17 @@ class RocmTraceCollectorImpl : public profiler::RocmTraceCollector {
         line.SetTimestampNs(start_gputime_ns);
         CreateXEvent(event, plane, start_gputime_ns, end_gputime_ns, &line);
         events_types_per_line[line_id].emplace(event.type);
+        if (!is_host_event) {
+          CreateApiXEvent(event, host_plane, start_gputime_ns, end_gputime_ns);
+        }
       }
       device_plane->ForEachLine([&](tensorflow::profiler::XLineBuilder line) {
         line.SetName(
             GetDeviceXLineName(line.Id(), events_types_per_line[line.Id()]));
       });
+      host_plane->ForEachLine([&](tensorflow::profiler::XLineBuilder line) {
+        line.SetName(absl::StrCat("Host Threads/", line.Id()));
+      });
       events.clear();
     }
 
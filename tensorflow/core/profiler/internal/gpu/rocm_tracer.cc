@@ -218,6 +218,10 @@ const char* GetRocmTracerEventTypeName(const RocmTracerEventType& type) {
       return "Kernel";
     case RocmTracerEventType::MemoryAlloc:
       return "MemoryAlloc";
+    case RocmTracerEventType::Memset:
+      return "Memset";
+    case RocmTracerEventType::StreamSynchronize:
+      return "StreamSynchronize";
     case RocmTracerEventType::Generic:
       return "Generic";
     default:
@@ -293,6 +297,10 @@ void DumpRocmTracerEvent(const RocmTracerEvent& event, uint64 start_walltime_ns,
     case RocmTracerEventType::MemoryAlloc:
       oss << ",num_bytes=" << event.memalloc_info.num_bytes;
       break;
+    case RocmTracerEventType::Memset:
+      oss << ",num_elements=" << event.memset_info.num_elements;
+      oss << ",async=" << event.memset_info.async;
+      break;
     case RocmTracerEventType::StreamSynchronize:
       break;
     case RocmTracerEventType::Generic:
@@ -378,6 +386,10 @@ class RocmApiCallbackImpl {
     event.source = RocmTracerEventSource::ApiCallback;
     event.thread_id = GetCachedTID();
     event.correlation_id = data->correlation_id;
+    // The launch APIs do not report the register and static shared memory
+    // usage of the kernel.
+    event.kernel_info.registers_per_thread = 0;
+    event.kernel_info.static_shared_memory_usage = 0;
     switch (cbid) {
       case HIP_API_ID_hipModuleLaunchKernel: {
         const hipFunction_t kernelFunc = data->args.hipModuleLaunchKernel.f;
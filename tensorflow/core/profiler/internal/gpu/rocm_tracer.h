@@ -126,6 +126,11 @@ struct RocmTracerEvent {
   uint32 correlation_id = kInvalidCorrelationId;
   uint32 thread_id = kInvalidThreadId;
   int64 stream_id = kInvalidStreamId;
+  // The HIP API call that issued this event and its host timestamps, from the
+  // HIP_API activity record of the call. Empty if no such record was received.
+  std::string api_name;
+  uint64 api_start_time_ns = 0;
+  uint64 api_end_time_ns = 0;
   union {
     MemcpyDetails memcpy_info;      // If type == Memcpy*
     MemsetDetails memset_info;      // If type == Memset*
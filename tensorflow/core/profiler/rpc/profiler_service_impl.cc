@@ -20,7 +20,11 @@ limitations under the License.
 #include "grpcpp/support/status.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
@@ -28,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/profiler/internal/cpu/op_latency_sampler.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/profiler_service.pb.h"
@@ -69,11 +74,59 @@ Status CollectDataToRepository(const ProfileRequest& request,
   return WriteBinaryProto(Env::Default(), out_path, xspace);
 }
 
+// Fills `response` with the latencies of the ops sampled so far.
+void CollectOpLatencies(const MonitorRequest& request,
+                        OpLatencySampler* sampler, MonitorResponse* response) {
+  std::string& data = *response->mutable_data();
+  if (request.timestamp()) {
+    absl::StrAppend(&data, "Timestamp: ",
+                    absl::FormatTime(absl::Now(), absl::LocalTimeZone()),
+                    "\n");
+  }
+  absl::StrAppend(&data, absl::StrFormat("%-48s %10s %10s %10s %10s %10s\n",
+                                         "op_type", "count", "mean_us",
+                                         "p50_us", "p99_us", "max_us"));
+  for (const OpLatencySampler::OpStats& op : sampler->Collect()) {
+    OpLatencyStats* stats = response->add_op_latency_stats();
+    stats->set_op_type(op.op_type);
+    stats->set_count(op.count);
+    stats->set_mean_us(op.mean_us);
+    stats->set_p50_us(op.p50_us);
+    stats->set_p90_us(op.p90_us);
+    stats->set_p99_us(op.p99_us);
+    stats->set_max_us(op.max_us);
+    absl::StrAppend(&data, absl::StrFormat(
+                               "%-48s %10d %10.1f %10.1f %10.1f %10.1f\n",
+                               op.op_type, op.count, op.mean_us, op.p50_us,
+                               op.p99_us, op.max_us));
+  }
+  const int64 num_dropped = sampler->NumDroppedSamples();
+  if (num_dropped > 0) {
+    absl::StrAppend(&data, "Dropped samples: ", num_dropped, "\n");
+  }
+}
+
 class ProfilerServiceImpl : public grpc::ProfilerService::Service {
  public:
+  // Returns the latencies of the ops sampled by the OpLatencySampler, after
+  // waiting for `duration_ms` so that the ops of the coming steps are included.
+  // The monitoring level is ignored.
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    if (!OpLatencySampler::Enabled()) {
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED,
+                            "Op latency sampling is disabled. Set "
+                            "TF_OP_LATENCY_SAMPLING_PERIOD to enable it.");
+    }
+    Env* env = Env::Default();
+    for (uint64 i = 0; i < req->duration_ms(); ++i) {
+      env->SleepForMicroseconds(EnvTime::kMillisToMicros);
+      if (ctx->IsCancelled()) {
+        return ::grpc::Status::CANCELLED;
+      }
+    }
+    CollectOpLatencies(*req, OpLatencySampler::Get(), response);
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
@@ -132,6 +185,9 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
 }  // namespace
 
 std::unique_ptr<grpc::ProfilerService::Service> CreateProfilerService() {
+  // Creates the sampler, which reads the sampling period from the environment,
+  // so that ops are sampled for as long as the service runs.
+  OpLatencySampler::Get();
   return absl::make_unique<ProfilerServiceImpl>();
 }
 
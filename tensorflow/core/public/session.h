@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PUBLIC_SESSION_H_
 #define TENSORFLOW_CORE_PUBLIC_SESSION_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -282,6 +283,20 @@ class Session {
         "ReleaseCallable is not supported for this session.");
   }
 
+  /// \brief Calls `done` once the tensors that the earlier calls to
+  /// `RunCallable(handle, ...)` fetched into device memory have been
+  /// produced, without blocking the calling thread.
+  ///
+  /// This is the completion event of the fetches of callables created with
+  /// `CallableOptions::fetch_skip_sync` set to true. The fetched tensors can
+  /// be fed to another callable on the same device without waiting for it.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status NotifyWhenCallableFetchesReady(
+      CallableHandle handle, std::function<void(const Status&)> done) {
+    return errors::Unimplemented(
+        "NotifyWhenCallableFetchesReady is not supported for this session.");
+  }
+
   /// \brief Release global graph-related state in this session.
   ///
   /// After calling `this->Finalize()`, calls to `this->Run()` with previously
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -27,6 +29,14 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Writers block once the writer thread is this many batches of `max_queue`
+// events behind, so that a stalled file system cannot use unbounded memory.
+constexpr int kMaxPendingBatches = 8;
+
+// Events are serialized, written and flushed by a background thread, so that
+// the ops that write summaries only pay for building the events. The thread
+// writes a batch of events when more than `max_queue` are queued, when the
+// oldest queued event is `flush_millis` old, or when Flush is called.
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
@@ -34,6 +44,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
+        max_pending_(kMaxPendingBatches * std::max(max_queue, 1)),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -44,27 +55,46 @@ class SummaryFileWriter : public SummaryWriterInterface {
       }
       TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
     }
-    mutex_lock ml(mu_);
     events_writer_ =
         tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
     TF_RETURN_WITH_CONTEXT_IF_ERROR(
         events_writer_->InitWithSuffix(filename_suffix),
         "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
-    is_initialized_ = true;
+    {
+      mutex_lock ml(mu_);
+      last_flush_ = env_->NowMicros();
+      is_initialized_ = true;
+    }
+    writer_thread_.reset(env_->StartThread(ThreadOptions(),
+                                           "summary_file_writer",
+                                           [this] { WriterLoop(); }));
     return Status::OK();
   }
 
+  // Waits until the events written before the call are flushed.
   Status Flush() override {
     mutex_lock ml(mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    const int64 target = num_enqueued_;
+    flush_target_ = std::max(flush_target_, target);
+    write_cv_.notify_one();
+    while (num_flushed_ < target) {
+      flushed_cv_.wait(ml);
+    }
+    return ConsumeStatus();
   }
 
   ~SummaryFileWriter() override {
-    (void)Flush();  // Ignore errors.
+    if (writer_thread_ == nullptr) return;
+    {
+      mutex_lock ml(mu_);
+      shutdown_ = true;
+      write_cv_.notify_one();
+    }
+    // Joins the thread, which writes and flushes the queued events first.
+    writer_thread_.reset();
   }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
@@ -140,12 +170,17 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    while (queue_.size() >= max_pending_ && writer_thread_ != nullptr) {
+      flushed_cv_.wait(ml);
+    }
     queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+    ++num_enqueued_;
+    // The writer thread only needs to wake up to start the flush timer or to
+    // write a full batch.
+    if (queue_.size() == 1 || queue_.size() > max_queue_) {
+      write_cv_.notify_one();
     }
-    return Status::OK();
+    return ConsumeStatus();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -155,26 +190,93 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
-      events_writer_->WriteEvent(*e);
+  // Returns the error of the last batch written, if it was not returned yet.
+  Status ConsumeStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status status = status_;
+    status_ = Status::OK();
+    return status;
+  }
+
+  // Returns how long to wait before the queued events must be written, or
+  // 0 if they must be written now. Returns -1 if there is nothing to write.
+  int64 MillisUntilWrite() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (shutdown_ || num_flushed_ < flush_target_ ||
+        queue_.size() > max_queue_) {
+      return 0;
+    }
+    if (queue_.empty()) return -1;
+    const int64 elapsed_millis = (env_->NowMicros() - last_flush_) / 1000;
+    return std::max<int64>(flush_millis_ - elapsed_millis, 0);
+  }
+
+  void WriterLoop() {
+    for (;;) {
+      std::vector<std::unique_ptr<Event>> batch;
+      int64 batch_end;
+      bool shutdown;
+      {
+        mutex_lock ml(mu_);
+        for (int64 wait_millis = MillisUntilWrite(); wait_millis != 0;
+             wait_millis = MillisUntilWrite()) {
+          if (wait_millis < 0) {
+            write_cv_.wait(ml);
+          } else {
+            WaitForMilliseconds(&ml, &write_cv_, wait_millis);
+          }
+        }
+        batch.swap(queue_);
+        batch_end = num_enqueued_;
+        shutdown = shutdown_;
+        // Writers that wait for room in the queue can continue.
+        flushed_cv_.notify_all();
+      }
+
+      const Status status = WriteBatch(batch);
+
+      mutex_lock ml(mu_);
+      if (!status.ok()) status_ = status;
+      num_flushed_ = batch_end;
+      last_flush_ = env_->NowMicros();
+      flushed_cv_.notify_all();
+      if (shutdown) return;
+    }
+  }
+
+  // Serializes and writes `batch`, then flushes the events file once.
+  Status WriteBatch(const std::vector<std::unique_ptr<Event>>& batch) {
+    string record;
+    for (const std::unique_ptr<Event>& e : batch) {
+      e->AppendToString(&record);
+      events_writer_->WriteSerializedEvent(record);
+      record.clear();
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
-  bool is_initialized_;
+  bool is_initialized_ TF_GUARDED_BY(mu_);
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  const size_t max_pending_;
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
+  // Signaled when there may be events to write.
+  condition_variable write_cv_;
+  // Signaled when the writer thread takes or flushes a batch.
+  condition_variable flushed_cv_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  // Number of events enqueued, and flushed to the events file, so far.
+  int64 num_enqueued_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_flushed_ TF_GUARDED_BY(mu_) = 0;
+  // Flush waits until this many events are flushed.
+  int64 flush_target_ TF_GUARDED_BY(mu_) = 0;
+  bool shutdown_ TF_GUARDED_BY(mu_) = false;
+  Status status_ TF_GUARDED_BY(mu_);
+  // Only used by the writer thread after Initialize.
+  std::unique_ptr<EventsWriter> events_writer_;
+  std::unique_ptr<Thread> writer_thread_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -28,7 +28,10 @@ namespace tensorflow {
 /// makes this summary writer suitable for file systems like GCS.
 ///
 /// It will enqueue up to max_queue summaries, and flush at least every
-/// flush_millis milliseconds. The summaries will be written to the
+/// flush_millis milliseconds. Summaries are serialized and written by a
+/// background thread, so writing a summary does not wait for the file system
+/// unless the thread falls far behind; Flush() waits for the summaries
+/// written before it. The summaries will be written to the
 /// directory specified by logdir and with the filename suffixed by
 /// filename_suffix. The caller owns a reference to result if the
 /// returned status is ok. The Env object must not be destroyed until
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <cstring>
 #include <vector>
 
 #include "absl/base/casts.h"
@@ -113,6 +114,79 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// The continuation bits of eight consecutive varint bytes.
+constexpr uint64 kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns the number of varints in the packed field [begin, end), i.e. the
+// number of bytes without a continuation bit.
+inline int64 CountPackedVarints(const uint8* begin, const uint8* end) {
+  int64 num_continuation_bytes = 0;
+  const uint8* ptr = begin;
+  for (; end - ptr >= 8; ptr += 8) {
+    uint64 word;
+    std::memcpy(&word, ptr, sizeof(word));
+    // Gathers the continuation bits into the top byte to count them.
+    num_continuation_bytes +=
+        (((word & kVarintContinuationBits) >> 7) * 0x0101010101010101ULL) >>
+        56;
+  }
+  for (; ptr < end; ++ptr) {
+    num_continuation_bytes += *ptr >> 7;
+  }
+  return (end - begin) - num_continuation_bytes;
+}
+
+// Decodes the packed varints in [begin, end), calling `emit` with each of
+// them. Returns false if the field does not hold a sequence of valid varints.
+//
+// Eight bytes are checked at once, so the single byte varints which make up
+// most ids, labels and counts are decoded eight at a time without a branch
+// per value.
+template <typename Emit>
+inline bool DecodePackedVarints(const uint8* begin, const uint8* end,
+                                Emit emit) {
+  const uint8* ptr = begin;
+  while (ptr < end) {
+    if (end - ptr >= 8) {
+      uint64 word;
+      std::memcpy(&word, ptr, sizeof(word));
+      if ((word & kVarintContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) {
+          emit(static_cast<int64>(ptr[i]));
+        }
+        ptr += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    for (int shift = 0;; shift += 7) {
+      if (ptr == end || shift >= 64) return false;
+      const uint8 byte = *ptr++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if (byte < 0x80) break;
+    }
+    emit(static_cast<int64>(value));
+  }
+  return true;
+}
+
+// Points `*begin` and `*end` at the next `length` bytes of `stream` and skips
+// them. Returns false if fewer bytes are left. Requires a stream over a flat
+// array, like every stream in this file.
+inline bool ReadRawRange(protobuf::io::CodedInputStream* stream,
+                         uint32 length, const uint8** begin,
+                         const uint8** end) {
+  const void* ptr = nullptr;
+  int size = 0;
+  if (length > 0 && (!stream->GetDirectBufferPointer(&ptr, &size) ||
+                     static_cast<uint32>(size) < length)) {
+    return false;
+  }
+  *begin = static_cast<const uint8*>(ptr);
+  *end = *begin + length;
+  return stream->Skip(length);
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -299,15 +373,22 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
-        }
-
-        stream.PopLimit(packed_limit);
+        const uint8* begin;
+        const uint8* end;
+        if (!ReadRawRange(&stream, packed_length, &begin, &end)) return false;
+
+        // Resize the output "vector" once, as for packed floats. It may end
+        // up smaller than requested in case of a LimitedArraySlice.
+        const size_t initial_size = int64_list->size();
+        int64_list->resize(initial_size + CountPackedVarints(begin, end));
+        auto* data = int64_list->data();
+        const size_t size = int64_list->size();
+        size_t index = initial_size;
+        auto emit = [data, size, &index](int64 n) {
+          if (index < size) data[index] = n;
+          ++index;
+        };
+        if (!DecodePackedVarints(begin, end, emit)) return false;
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1955,18 +2036,26 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
+      const uint8* begin;
+      const uint8* end;
+      if (!ReadRawRange(stream, packed_length, &begin, &end)) {
+        return -1;
+      }
+      if (out == nullptr) {
+        // A valid field ends with the last byte of a varint.
+        if (begin != end && end[-1] >= 0x80) {
           return -1;
         }
-        if (out != nullptr) {
+        num_elements = CountPackedVarints(begin, end);
+      } else {
+        auto emit = [&out, &num_elements](int64 n) {
           *out++ = n;
+          num_elements++;
+        };
+        if (!DecodePackedVarints(begin, end, emit)) {
+          return -1;
         }
-        num_elements++;
       }
-      stream->PopLimit(packed_limit);
     } else if (peek_tag == kVarintTag(1)) {
       while (!stream->ExpectAtEnd()) {
         protobuf_uint64 n;  // There is no API for int64
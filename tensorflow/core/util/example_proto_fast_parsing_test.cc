@@ -170,6 +170,25 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedMultiByteVarints) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["ids"]
+          .mutable_int64_list();
+  // Runs of single byte varints interleaved with longer ones.
+  for (int i = 0; i < 20; ++i) {
+    int64_list->add_value(i);
+  }
+  int64_list->add_value(300);
+  int64_list->add_value(-1);
+  for (int i = 0; i < 9; ++i) {
+    int64_list->add_value(127 - i);
+  }
+  int64_list->add_value(int64{1} << 40);
+  int64_list->add_value(kint64min);
+  TestCorrectness(Serialize(example));
+}
+
 TEST(FastParse, EmptyFeatures) {
   Example example;
   example.mutable_features();
@@ -321,6 +340,36 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+TEST(FastParse, DensePackedMultiByteVarints) {
+  const std::vector<int64> values = {1, 2, 3, 4, 5, 6, 7, 8, 1000, -5, 9};
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["ids"]
+          .mutable_int64_list();
+  for (int64 value : values) {
+    int64_list->add_value(value);
+  }
+  std::vector<tstring> serialized(2, Serialize(example));
+
+  FastParseExampleConfig config;
+  AddDenseFeature("ids", DT_INT64, {static_cast<int64>(values.size())}, false,
+                  values.size(), &config);
+  Result result;
+  TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(1, result.dense_values.size());
+  auto ids = result.dense_values[0].matrix<int64>();
+  for (int i = 0; i < serialized.size(); ++i) {
+    for (int j = 0; j < values.size(); ++j) {
+      EXPECT_EQ(values[j], ids(i, j));
+    }
+  }
+
+  // A dense feature with too many values is still rejected.
+  config.dense.clear();
+  AddDenseFeature("ids", DT_INT64, {2}, false, 2, &config);
+  EXPECT_FALSE(FastParseExample(config, serialized, {}, nullptr, &result).ok());
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_MKL_UTIL_H_
 #ifdef INTEL_MKL
 
+#include <algorithm>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <string>
@@ -35,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/mkl_threadpool.h"
 #include "tensorflow/core/util/mkl_types.h"
@@ -1677,6 +1681,10 @@ class MklPrimitive {
   unsigned char* DummyData = nullptr;
   engine cpu_engine_ = engine(engine::kind::cpu, 0);
   const engine& GetEngine() { return cpu_engine_; }
+
+  // Estimate of the memory held by the primitive, including the code
+  // generated by oneDNN, used for the capacity of MklPrimitiveCache.
+  virtual int64 ApproximateSizeBytes() const { return 64 << 10; }
 };
 
 const mkldnn::memory::dims NONE_DIMS = {};
@@ -1695,7 +1703,9 @@ const mkldnn::memory::dims NONE_DIMS = {};
 //
 // This class is used to maintain an upper bound on the total number of
 // cached items. When the cache reaches its capacity, the LRU item will
-// be removed and replaced by a new one from SetOp call.
+// be removed and replaced by a new one from SetOp call. Objects are held
+// through shared pointers, so that they may also be referenced from the
+// process-wide MklPrimitiveCache.
 //
 template <typename T>
 class LRUCache {
@@ -1712,21 +1722,26 @@ class LRUCache {
     }
 
     // Move to the front of LRU list as the most recently accessed.
-    lru_list_.erase(it->second.lru_iterator);
-    lru_list_.push_front(it->first);
-    it->second.lru_iterator = lru_list_.begin();
-    return it->second.op;
+    lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_iterator);
+    return it->second.op.get();
   }
 
-  void SetOp(const string& key, T* op) {
+  void SetOp(const string& key, std::shared_ptr<T> op) {
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      // Another instance was created for the same key, e.g. because the
+      // cached one was evicted from the process-wide cache.  Keep the new one.
+      it->second.op = std::move(op);
+      lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_iterator);
+      return;
+    }
     if (lru_list_.size() >= capacity_) {
       Delete();
     }
 
     // Insert an entry to the front of the LRU list
     lru_list_.push_front(key);
-    Entry entry(op, lru_list_.begin());
-    cache_.emplace(std::make_pair(key, std::move(entry)));
+    cache_.emplace(key, Entry(std::move(op), lru_list_.begin()));
   }
 
   void Clear() {
@@ -1740,37 +1755,21 @@ class LRUCache {
  private:
   struct Entry {
     // The entry's value.
-    T* op;
+    std::shared_ptr<T> op;
 
     // A list iterator pointing to the entry's position in the LRU list.
     std::list<string>::iterator lru_iterator;
 
-    // Constructor
-    Entry(T* op, std::list<string>::iterator it) {
-      this->op = op;
-      this->lru_iterator = it;
-    }
-
-    // Move constructor
-    Entry(Entry&& source) noexcept
-        : lru_iterator(std::move(source.lru_iterator)) {
-      op = std::move(source.op);
-      source.op = std::forward<T*>(nullptr);
-    }
-
-    // Destructor
-    ~Entry() {
-      if (op != nullptr) delete op;
-    }
+    Entry(std::shared_ptr<T> op, std::list<string>::iterator it)
+        : op(std::move(op)), lru_iterator(it) {}
   };
 
   // Remove the least recently accessed entry from LRU list, which
   // is the tail of lru_list_. Update cache_ correspondingly.
   bool Delete() {
     if (lru_list_.empty()) return false;
-    string key = lru_list_.back();
+    cache_.erase(lru_list_.back());
     lru_list_.pop_back();
-    cache_.erase(key);
     return true;
   }
 
@@ -1786,6 +1785,105 @@ class LRUCache {
   std::list<string> lru_list_;
 };
 
+// Process-wide cache of MKL primitives, shared by the primitive factories of
+// all threads, with a capacity in bytes.
+//
+// Primitives keep the memory objects of their last execution, so a primitive
+// must not be used by two threads at once.  The cache hands out a primitive
+// to one thread at a time: a thread keeps the primitives it uses in its own
+// small LRUCache, and the process-wide cache only returns a primitive that is
+// not held by the LRUCache of any thread.  Several primitives may then be
+// cached under the same key when threads run the same shapes concurrently,
+// but a primitive that a thread stopped using is reused by the other threads
+// instead of being created again in every thread.
+//
+// The size of a primitive is estimated from its key and
+// MklPrimitive::ApproximateSizeBytes, since oneDNN does not report the size of
+// the generated code and descriptors of a primitive.
+class MklPrimitiveCache {
+ public:
+  explicit MklPrimitiveCache(int64 capacity_bytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  // Returns the cache of the process, whose capacity is read from the
+  // TF_MKL_PRIMITIVE_CACHE_BYTES environment variable (256MiB by default).
+  static MklPrimitiveCache* Global() {
+    static MklPrimitiveCache* cache = [] {
+      int64 capacity_bytes;
+      Status status = ReadInt64FromEnvVar("TF_MKL_PRIMITIVE_CACHE_BYTES",
+                                          kDefaultCapacityBytes,
+                                          &capacity_bytes);
+      if (!status.ok()) {
+        LOG(ERROR) << status.error_message();
+        capacity_bytes = kDefaultCapacityBytes;
+      }
+      return new MklPrimitiveCache(capacity_bytes);
+    }();
+    return cache;
+  }
+
+  // Returns a primitive cached under `key` that no thread holds, or null.
+  std::shared_ptr<MklPrimitive> Acquire(const string& key) {
+    mutex_lock l(mu_);
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    for (auto entry : it->second) {
+      // Only the cache and the LRUCaches of the threads reference cached
+      // primitives, and references are only added under mu_.
+      if (entry->op.use_count() == 1) {
+        lru_list_.splice(lru_list_.begin(), lru_list_, entry);
+        return entry->op;
+      }
+    }
+    return nullptr;
+  }
+
+  // Adds `op` under `key`, evicting the least recently used primitives when
+  // the cache is over capacity.  Evicted primitives are deleted once the
+  // threads holding them drop them.
+  void Insert(const string& key, std::shared_ptr<MklPrimitive> op) {
+    if (capacity_bytes_ <= 0) return;
+    const int64 bytes = key.size() + op->ApproximateSizeBytes();
+    mutex_lock l(mu_);
+    lru_list_.push_front({key, std::move(op), bytes});
+    index_[key].push_back(lru_list_.begin());
+    size_bytes_ += bytes;
+    while (size_bytes_ > capacity_bytes_ && lru_list_.size() > 1) {
+      auto lru = std::prev(lru_list_.end());
+      auto& entries = index_[lru->key];
+      entries.erase(std::find(entries.begin(), entries.end(), lru));
+      if (entries.empty()) index_.erase(lru->key);
+      size_bytes_ -= lru->bytes;
+      lru_list_.erase(lru);
+    }
+  }
+
+  int64 size_bytes() {
+    mutex_lock l(mu_);
+    return size_bytes_;
+  }
+
+ private:
+  static constexpr int64 kDefaultCapacityBytes = 256LL << 20;
+
+  struct Entry {
+    string key;
+    std::shared_ptr<MklPrimitive> op;
+    int64 bytes;
+  };
+
+  const int64 capacity_bytes_;
+
+  mutex mu_;
+  int64 size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // The front of the list is the most recently used primitive.
+  std::list<Entry> lru_list_ TF_GUARDED_BY(mu_);
+  std::unordered_map<string, std::vector<std::list<Entry>::iterator>> index_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MklPrimitiveCache);
+};
+
 template <typename T>
 class MklPrimitiveFactory {
  public:
@@ -1795,12 +1893,23 @@ class MklPrimitiveFactory {
 
   MklPrimitive* GetOp(const string& key) {
     auto& lru_cache = MklPrimitiveFactory<T>::GetLRUCache();
-    return lru_cache.GetOp(key);
+    const string cache_key = CacheKey(key);
+    MklPrimitive* op = lru_cache.GetOp(cache_key);
+    if (op != nullptr) return op;
+    std::shared_ptr<MklPrimitive> shared_op =
+        MklPrimitiveCache::Global()->Acquire(cache_key);
+    if (shared_op == nullptr) return nullptr;
+    op = shared_op.get();
+    lru_cache.SetOp(cache_key, std::move(shared_op));
+    return op;
   }
 
   void SetOp(const string& key, MklPrimitive* op) {
     auto& lru_cache = MklPrimitiveFactory<T>::GetLRUCache();
-    lru_cache.SetOp(key, op);
+    const string cache_key = CacheKey(key);
+    std::shared_ptr<MklPrimitive> shared_op(op);
+    lru_cache.SetOp(cache_key, shared_op);
+    MklPrimitiveCache::Global()->Insert(cache_key, std::move(shared_op));
   }
 
   /// Function to decide whether HW has AVX512 or AVX2
@@ -1820,8 +1929,21 @@ class MklPrimitiveFactory {
   }
 
  private:
+  // The process-wide cache is shared by the factories of all types, so keys
+  // are prefixed with an address that is unique to T.
+  static string CacheKey(const string& key) {
+    static const char type_tag = 0;
+    const char* tag = &type_tag;
+    string cache_key(reinterpret_cast<const char*>(&tag), sizeof(tag));
+    cache_key.append(key);
+    return cache_key;
+  }
+
+  // Primitives held by the thread.  The capacity only needs to cover the
+  // primitives used by one op, since the primitives that fall out of it are
+  // still shared through MklPrimitiveCache.
   static inline LRUCache<MklPrimitive>& GetLRUCache() {
-    static const int kCapacity = 1024;  // cache capacity
+    static const int kCapacity = 64;  // cache capacity
     static thread_local LRUCache<MklPrimitive> lru_cache_(kCapacity);
     return lru_cache_;
   }
@@ -1834,30 +1956,29 @@ class FactoryKeyCreator {
 
   ~FactoryKeyCreator() {}
 
-  void AddAsKey(const string& str) { Append(str); }
+  // Keys are binary: values are appended as their raw bytes, and strings and
+  // dims are prefixed with their length so that keys need no delimiters.
+  void AddAsKey(const string& str) {
+    AddAsKey<uint32>(str.size());
+    key_.append(str);
+  }
 
   void AddAsKey(const mkldnn::memory::dims& dims) {
-    for (unsigned int i = 0; i < dims.size(); i++) {
-      AddAsKey<int>(dims[i]);
-    }
+    AddAsKey<uint32>(dims.size());
+    key_.append(reinterpret_cast<const char*>(dims.data()),
+                dims.size() * sizeof(dims[0]));
   }
 
   template <typename T>
   void AddAsKey(const T data) {
-    auto buffer = reinterpret_cast<const char*>(&data);
-    Append(StringPiece(buffer, sizeof(T)));
+    key_.append(reinterpret_cast<const char*>(&data), sizeof(T));
   }
 
   string GetKey() { return key_; }
 
  private:
   string key_;
-  const char delimiter = 'x';
   const int kMaxKeyLength = 256;
-  void Append(StringPiece s) {
-    key_.append(string(s));
-    key_.append(1, delimiter);
-  }
 };
 
 class MklReorderPrimitive : public MklPrimitive {
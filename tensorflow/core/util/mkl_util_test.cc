@@ -89,7 +89,7 @@ TEST(MklUtilTest, LRUCacheTest) {
 
   // Test SetOp: be able to set more ops than the capacity
   for (int k = 0; k < num_objects; k++) {
-    lru_cache.SetOp(std::to_string(k), new int(k));
+    lru_cache.SetOp(std::to_string(k), std::make_shared<int>(k));
   }
 
   // Test GetOp and capacity:
@@ -115,6 +115,61 @@ TEST(MklUtilTest, LRUCacheTest) {
   }
 }
 
+TEST(MklUtilTest, MklPrimitiveCacheTest) {
+  const int64 kPrimitiveBytes = MklPrimitive().ApproximateSizeBytes();
+  MklPrimitiveCache cache(2 * (kPrimitiveBytes + 1));
+
+  // A primitive held by a thread is not handed out to other threads.
+  auto a = std::make_shared<MklPrimitive>();
+  cache.Insert("a", a);
+  EXPECT_EQ(nullptr, cache.Acquire("a").get());
+  MklPrimitive* a_ptr = a.get();
+  a.reset();
+  a = cache.Acquire("a");
+  EXPECT_EQ(a_ptr, a.get());
+  EXPECT_EQ(nullptr, cache.Acquire("a").get());
+
+  // Several primitives may be cached under the same key.
+  auto a2 = std::make_shared<MklPrimitive>();
+  cache.Insert("a", a2);
+  a2.reset();
+  a2 = cache.Acquire("a");
+  EXPECT_NE(nullptr, a2.get());
+  EXPECT_NE(a_ptr, a2.get());
+  EXPECT_EQ(2 * (kPrimitiveBytes + 1), cache.size_bytes());
+
+  // The least recently used primitive is evicted when over capacity.
+  a.reset();
+  a2.reset();
+  cache.Insert("b", std::make_shared<MklPrimitive>());
+  EXPECT_EQ(2 * (kPrimitiveBytes + 1), cache.size_bytes());
+  std::shared_ptr<MklPrimitive> held = cache.Acquire("a");
+  EXPECT_NE(nullptr, held.get());
+  EXPECT_NE(a_ptr, held.get());
+  EXPECT_EQ(nullptr, cache.Acquire("a").get());
+  EXPECT_NE(nullptr, cache.Acquire("b").get());
+}
+
+TEST(MklUtilTest, FactoryKeyCreatorTest) {
+  // Keys of different values must differ even when their bytes concatenate
+  // to the same string.
+  FactoryKeyCreator ab_c;
+  ab_c.AddAsKey(string("ab"));
+  ab_c.AddAsKey(string("c"));
+  FactoryKeyCreator a_bc;
+  a_bc.AddAsKey(string("a"));
+  a_bc.AddAsKey(string("bc"));
+  EXPECT_NE(ab_c.GetKey(), a_bc.GetKey());
+
+  FactoryKeyCreator dims1;
+  dims1.AddAsKey(memory::dims({1, 2}));
+  dims1.AddAsKey(memory::dims({3}));
+  FactoryKeyCreator dims2;
+  dims2.AddAsKey(memory::dims({1}));
+  dims2.AddAsKey(memory::dims({2, 3}));
+  EXPECT_NE(dims1.GetKey(), dims2.GetKey());
+}
+
 }  // namespace
 }  // namespace tensorflow
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/str_util.h"
 
 namespace tensorflow {
@@ -54,7 +55,7 @@ Status TestReportFile::Initialize() {
 }
 
 TestReporter::TestReporter(const string& fname, const string& test_name)
-    : report_file_(fname, test_name) {
+    : json_format_(UseJsonFormat()), report_file_(fname, test_name) {
   benchmark_entry_.set_name(test_name);
 }
 
@@ -63,7 +64,17 @@ Status TestReporter::Close() {
 
   BenchmarkEntries entries;
   *entries.add_entry() = benchmark_entry_;
-  TF_RETURN_IF_ERROR(report_file_.Append(entries.SerializeAsString()));
+  string content;
+  if (json_format_) {
+    auto status = protobuf::util::MessageToJsonString(entries, &content);
+    if (!status.ok()) {
+      return errors::Internal("Failed to convert BenchmarkEntries to JSON: ",
+                              status.ToString());
+    }
+  } else {
+    content = entries.SerializeAsString();
+  }
+  TF_RETURN_IF_ERROR(report_file_.Append(content));
   benchmark_entry_.Clear();
 
   return report_file_.Close();
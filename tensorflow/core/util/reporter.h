@@ -77,9 +77,15 @@ class TestReportFile {
 // with a single entry is written to file:
 //   /tmp/run_BM_Foo__1__2
 //
+// If the environment variable "TEST_REPORT_FILE_FORMAT" is set to "json", the
+// BenchmarkEntries are written in their JSON encoding instead, which is easier
+// to consume from regression tracking scripts.
+//
 class TestReporter {
  public:
   static constexpr const char* kTestReporterEnv = "TEST_REPORT_FILE_PREFIX";
+  static constexpr const char* kTestReporterFormatEnv =
+      "TEST_REPORT_FILE_FORMAT";
 
   // Create a TestReporter with the test name 'test_name'.
   explicit TestReporter(const string& test_name)
@@ -122,6 +128,11 @@ class TestReporter {
     const char* fname_ptr = getenv(kTestReporterEnv);
     return (fname_ptr != nullptr) ? fname_ptr : "";
   }
+  static bool UseJsonFormat() {
+    const char* format_ptr = getenv(kTestReporterFormatEnv);
+    return format_ptr != nullptr && string(format_ptr) == "json";
+  }
+  const bool json_format_;
   TestReportFile report_file_;
   BenchmarkEntry benchmark_entry_;
   TF_DISALLOW_COPY_AND_ASSIGN(TestReporter);
@@ -163,5 +163,35 @@ TEST(TestReporter, AddMetrics) {
   EXPECT_EQ(3.0, metrics.at(1).value());
 }
 
+TEST(TestReporter, JsonFormat) {
+  const char* old_env = std::getenv(TestReporter::kTestReporterFormatEnv);
+  setenv(TestReporter::kTestReporterFormatEnv, "json", 1);
+  string fname = strings::StrCat(testing::TmpDir(), "/test_reporter_json_");
+  TestReporter test_reporter(fname, "b4");
+  TF_EXPECT_OK(test_reporter.Initialize());
+  TF_EXPECT_OK(test_reporter.Benchmark(1, 1.0, 2.0, 3.0));
+  TF_EXPECT_OK(test_reporter.AddMetric("bytes_per_second", 4.0));
+  TF_EXPECT_OK(test_reporter.Close());
+  if (old_env == nullptr) {
+    unsetenv(TestReporter::kTestReporterFormatEnv);
+  } else {
+    setenv(TestReporter::kTestReporterFormatEnv, old_env, 1);
+  }
+
+  string read;
+  TF_EXPECT_OK(
+      ReadFileToString(Env::Default(), strings::StrCat(fname, "b4"), &read));
+  BenchmarkEntries benchmark_entries;
+  ASSERT_TRUE(
+      protobuf::util::JsonStringToMessage(read, &benchmark_entries).ok());
+  ASSERT_EQ(1, benchmark_entries.entry_size());
+  const BenchmarkEntry& benchmark_entry = benchmark_entries.entry(0);
+  EXPECT_EQ("b4", benchmark_entry.name());
+  EXPECT_EQ(2.0, benchmark_entry.wall_time());
+  ASSERT_EQ(1, benchmark_entry.metrics_size());
+  EXPECT_EQ("bytes_per_second", benchmark_entry.metrics(0).name());
+  EXPECT_EQ(4.0, benchmark_entry.metrics(0).value());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,7 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <numeric>
+
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/overflow.h"
 
 namespace tensorflow {
 namespace sparse {
@@ -36,6 +42,137 @@ Status GetDimsFromIx(const Tensor& ix, int* result) {
   return Status();
 }
 
+// Tensors with at least this many entries are reordered with a parallel radix
+// sort when a thread pool is available.
+constexpr int64 kMinRadixSortEntries = 1 << 16;
+
+// Number of bits of the linear index that each radix sort pass sorts by.
+constexpr int kRadixBits = 8;
+constexpr int kRadixBuckets = 1 << kRadixBits;
+
+// Calls `fn(block, first, last)` for `num_blocks` consecutive blocks of
+// `block_size` entries covering [0, total), on `pool` if there are several.
+void RunBlocks(thread::ThreadPool* pool, int64 total, int64 block_size,
+               int64 num_blocks,
+               const std::function<void(int64, int64, int64)>& fn) {
+  if (num_blocks == 1) {
+    fn(0, 0, total);
+    return;
+  }
+  pool->ParallelFor(
+      total,
+      thread::ThreadPool::SchedulingParams(
+          thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+          absl::nullopt /* cost_per_unit */, block_size),
+      [block_size, &fn](int64 first, int64 last) {
+        fn(first / block_size, first, last);
+      });
+}
+
+// Computes in `keys` the index of each row of `ix` in the row-major layout
+// of the dimensions of `shape` taken in `order`, and in `num_bits` the number
+// of bits these indices span.  Returns false if an index is out of bounds or
+// the layout has more than 2^63 elements.
+bool ComputeLinearIndices(const TTypes<int64>::Matrix& ix,
+                          const gtl::ArraySlice<int64>& order,
+                          const gtl::ArraySlice<int64>& shape,
+                          thread::ThreadPool* pool, int64 block_size,
+                          int64 num_blocks, std::vector<uint64>* keys,
+                          int* num_bits) {
+  const int num_dims = order.size();
+  std::vector<int64> strides(num_dims);
+  int64 num_elements = 1;
+  for (int di = num_dims - 1; di >= 0; --di) {
+    strides[di] = num_elements;
+    num_elements = MultiplyWithoutOverflow(num_elements, shape[order[di]]);
+    if (num_elements < 0) return false;
+  }
+  *num_bits = 0;
+  while (*num_bits < 64 && (uint64{1} << *num_bits) < num_elements) {
+    ++*num_bits;
+  }
+
+  keys->resize(ix.dimension(0));
+  std::atomic<bool> in_bounds(true);
+  RunBlocks(pool, ix.dimension(0), block_size, num_blocks,
+            [&](int64 block, int64 first, int64 last) {
+              for (int64 n = first; n < last; ++n) {
+                uint64 key = 0;
+                for (int di = 0; di < num_dims; ++di) {
+                  const int64 d = order[di];
+                  const int64 index = ix(n, d);
+                  if (index < 0 || index >= shape[d]) {
+                    in_bounds = false;
+                    return;
+                  }
+                  key += index * strides[di];
+                }
+                (*keys)[n] = key;
+              }
+            });
+  return in_bounds;
+}
+
+// Sorts `rows` by `keys` with a stable least-significant digit radix sort of
+// the lower `num_bits` bits of the keys.  Each pass counts the digits of each
+// block of entries, then scatters the blocks in parallel to the offsets
+// given by the counts.
+void RadixSort(thread::ThreadPool* pool, int64 block_size, int64 num_blocks,
+               int num_bits, std::vector<uint64>* keys,
+               std::vector<int64>* rows) {
+  const int64 num_entries = keys->size();
+  std::vector<uint64> sorted_keys(num_entries);
+  std::vector<int64> sorted_rows(num_entries);
+  std::vector<int64> offsets(num_blocks * kRadixBuckets);
+  for (int shift = 0; shift < num_bits; shift += kRadixBits) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    RunBlocks(pool, num_entries, block_size, num_blocks,
+              [&](int64 block, int64 first, int64 last) {
+                int64* counts = &offsets[block * kRadixBuckets];
+                for (int64 n = first; n < last; ++n) {
+                  ++counts[((*keys)[n] >> shift) & (kRadixBuckets - 1)];
+                }
+              });
+    // Bucket-major exclusive prefix sum, so that each block scatters its
+    // entries of a bucket after those of the previous blocks.
+    int64 offset = 0;
+    for (int bucket = 0; bucket < kRadixBuckets; ++bucket) {
+      for (int64 block = 0; block < num_blocks; ++block) {
+        int64& count = offsets[block * kRadixBuckets + bucket];
+        const int64 block_count = count;
+        count = offset;
+        offset += block_count;
+      }
+    }
+    RunBlocks(pool, num_entries, block_size, num_blocks,
+              [&](int64 block, int64 first, int64 last) {
+                int64* next = &offsets[block * kRadixBuckets];
+                for (int64 n = first; n < last; ++n) {
+                  const uint64 key = (*keys)[n];
+                  const int64 to = next[(key >> shift) & (kRadixBuckets - 1)]++;
+                  sorted_keys[to] = key;
+                  sorted_rows[to] = (*rows)[n];
+                }
+              });
+    keys->swap(sorted_keys);
+    rows->swap(sorted_rows);
+  }
+}
+
+// Sorts the rows compared by `sorter` into `reorder`, unless they are
+// already sorted.
+template <typename Comparator>
+bool SortRows(const Comparator& sorter, int64 num_entries,
+              std::vector<int64>* reorder) {
+  int64 n = 1;
+  while (n < num_entries && !sorter(n, n - 1)) ++n;
+  if (n >= num_entries) return false;
+  reorder->resize(num_entries);
+  std::iota(reorder->begin(), reorder->end(), 0);
+  std::sort(reorder->begin(), reorder->end(), sorter);
+  return true;
+}
+
 }  // namespace
 
 /* static */ Status SparseTensor::Create(Tensor ix, Tensor vals,
@@ -308,5 +445,47 @@ Status SparseTensor::IndicesValid() const {
   }
 }
 
+bool SparseTensor::ComputeReorder(const VarDimArray& order,
+                                  thread::ThreadPool* pool,
+                                  std::vector<int64>* reorder) {
+  const int64 num_entries = this->num_entries();
+  auto ix_t = ix_.matrix<int64>();
+
+  if (pool != nullptr && num_entries >= kMinRadixSortEntries) {
+    const int64 num_blocks =
+        std::min<int64>(pool->NumThreads(), num_entries / kMinRadixSortEntries);
+    const int64 block_size = (num_entries + num_blocks - 1) / num_blocks;
+    std::vector<uint64> keys;
+    int num_bits;
+    if (ComputeLinearIndices(ix_t, order, shape_, pool, block_size, num_blocks,
+                             &keys, &num_bits)) {
+      if (std::is_sorted(keys.begin(), keys.end())) return false;
+      reorder->resize(num_entries);
+      std::iota(reorder->begin(), reorder->end(), 0);
+      RadixSort(pool, block_size, num_blocks, num_bits, &keys, reorder);
+      return true;
+    }
+  }
+
+  switch (order.size()) {
+#define CASE_SORT(ORDER_SIZE)                                    \
+  case ORDER_SIZE: {                                             \
+    FixedDimComparator<ORDER_SIZE> sorter(ix_t, order, shape()); \
+    return SortRows(sorter, num_entries, reorder);               \
+  }
+    CASE_SORT(0);
+    CASE_SORT(1);
+    CASE_SORT(2);
+    CASE_SORT(3);
+    CASE_SORT(4);
+    CASE_SORT(5);
+#undef CASE_SORT
+    default: {
+      DimComparator sorter(ix_t, order, shape());
+      return SortRows(sorter, num_entries, reorder);
+    }
+  }
+}
+
 }  // namespace sparse
 }  // namespace tensorflow
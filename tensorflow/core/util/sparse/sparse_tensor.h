@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_SPARSE_SPARSE_TENSOR_H_
 #define TENSORFLOW_CORE_UTIL_SPARSE_SPARSE_TENSOR_H_
 
+#include <algorithm>
 #include <limits>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 #include "absl/base/macros.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/sparse/dim_comparator.h"
 #include "tensorflow/core/util/sparse/group_iterator.h"
@@ -119,8 +122,11 @@ class SparseTensor {
   VarDimArray order() const { return order_; }
 
   // Resorts the indices and values according to the dimensions in order.
+  // Entries that are already sorted are left in place.  If `pool` is not
+  // null, large tensors whose indices are in bounds are sorted on it with a
+  // radix sort of their linear index.
   template <typename T>
-  void Reorder(const VarDimArray& order);
+  void Reorder(const VarDimArray& order, thread::ThreadPool* pool = nullptr);
 
   // Returns a group iterable that can be used for clumping indices
   // and values according to the group indices of interest.
@@ -164,6 +170,16 @@ class SparseTensor {
   template <typename T>
   static SparseTensor Concat(const gtl::ArraySlice<SparseTensor>& tensors);
 
+  // MergeConcat() concatenates all the tensors along `concat_dim`, which
+  // need not be their first order dimension.  All tensors must have
+  // identical shape except for `concat_dim`, and identical order.
+  //
+  // The entries of the tensors are merged, so that the output has the order
+  // of the tensors without having to be reordered.
+  template <typename T>
+  static SparseTensor MergeConcat(const gtl::ArraySlice<SparseTensor>& tensors,
+                                  int concat_dim);
+
   // Split() will split the input SparseTensor into a list of num_split
   // SparseTensor given a splitting dimension. If the input dimension range
   // isn't an integer multiple of split_dim, we add one extra dimension for
@@ -213,6 +229,12 @@ class SparseTensor {
   template <bool standard_order>
   Status IndicesValidHelper() const;
 
+  // Helper for Reorder<T>().  Computes in `reorder` the rows of the entries
+  // sorted according to `order`.  Returns false, leaving `reorder` empty, if
+  // the entries are already sorted.
+  bool ComputeReorder(const VarDimArray& order, thread::ThreadPool* pool,
+                      std::vector<int64>* reorder);
+
   // Helper for ToDense<T>()
   template <typename T>
   bool ValidateAndInitializeToDense(Tensor* out, bool initialize);
@@ -269,35 +291,18 @@ class SparseTensor {
 // an in-place algorithm.  It requires O(N log N) time and O(N)
 // temporary space.
 template <typename T>
-inline void SparseTensor::Reorder(const VarDimArray& order) {
+inline void SparseTensor::Reorder(const VarDimArray& order,
+                                  thread::ThreadPool* pool) {
   DCHECK_EQ(DataTypeToEnum<T>::v(), dtype())
       << "Reorder requested with the wrong datatype";
   DCHECK_EQ(order.size(), dims_) << "Order length must be SparseTensor rank";
   auto ix_t = ix_.matrix<int64>();
   auto vals_t = vals_.vec<T>();
 
-  std::vector<int64> reorder(num_entries());
-  std::iota(reorder.begin(), reorder.end(), 0);
-
-  // Sort to get order of indices
-  switch (order.size()) {
-#define CASE_SORT(ORDER_SIZE)                                    \
-  case ORDER_SIZE: {                                             \
-    FixedDimComparator<ORDER_SIZE> sorter(ix_t, order, shape()); \
-    std::sort(reorder.begin(), reorder.end(), sorter);           \
-    break;                                                       \
-  }
-    CASE_SORT(0);
-    CASE_SORT(1);
-    CASE_SORT(2);
-    CASE_SORT(3);
-    CASE_SORT(4);
-    CASE_SORT(5);
-#undef CASE_SORT
-    default: {
-      DimComparator sorter(ix_t, order, shape());
-      std::sort(reorder.begin(), reorder.end(), sorter);
-    }
+  std::vector<int64> reorder;
+  if (!ComputeReorder(order, pool, &reorder)) {
+    order_ = ShapeArray(order.begin(), order.end());
+    return;
   }
 
   // We have a forward reordering, but what we'll need is a
@@ -491,6 +496,81 @@ inline SparseTensor SparseTensor::Concat(
   return SparseTensor(output_ix, output_vals, final_shape, final_order);
 }
 
+template <typename T>
+inline SparseTensor SparseTensor::MergeConcat(
+    const gtl::ArraySlice<SparseTensor>& tensors, const int concat_dim) {
+  DCHECK_GE(tensors.size(), size_t{1}) << "Cannot concat 0 SparseTensors";
+  const int dims = tensors[0].dims_;
+  DCHECK_GE(concat_dim, 0) << "Concat dim out of range";
+  DCHECK_LT(concat_dim, dims) << "Concat dim out of range";
+  const ShapeArray final_order(tensors[0].order().begin(),
+                               tensors[0].order().end());
+  ShapeArray final_shape(tensors[0].shape().begin(), tensors[0].shape().end());
+  final_shape[concat_dim] = 0;  // We'll build this up as we go along.
+  int64 num_entries = 0;
+
+  std::vector<TTypes<int64>::ConstMatrix> st_ix;
+  std::vector<typename TTypes<T>::ConstVec> st_vals;
+  std::vector<int64> shape_offsets;
+  for (const SparseTensor& st : tensors) {
+    DCHECK_EQ(st.dims_, dims) << "All SparseTensors must have the same rank.";
+    DCHECK_EQ(DataTypeToEnum<T>::v(), st.dtype())
+        << "Concat requested with the wrong data type";
+    DCHECK_GE(st.order()[0], 0) << "SparseTensor must be ordered";
+    DCHECK(st.order() == final_order)
+        << "All SparseTensors must have the same order.";
+    st_ix.push_back(st.ix_.matrix<int64>());
+    st_vals.push_back(st.vals_.vec<T>());
+    shape_offsets.push_back(final_shape[concat_dim]);
+    final_shape[concat_dim] += st.shape()[concat_dim];
+    num_entries += st.num_entries();
+  }
+
+  Tensor output_ix(DT_INT64, TensorShape({num_entries, dims}));
+  Tensor output_vals(DataTypeToEnum<T>::v(), TensorShape({num_entries}));
+
+  TTypes<int64>::Matrix ix_t = output_ix.matrix<int64>();
+  typename TTypes<T>::Vec vals_t = output_vals.vec<T>();
+
+  // The next entry of each tensor, as a (tensor, row) pair, in a heap whose
+  // top is the entry that comes first in the output.  Entries with the same
+  // index are taken in the order of the tensors.
+  using Entry = std::pair<int, int64>;
+  auto index = [&](const Entry& e, int d) {
+    return st_ix[e.first](e.second, d) +
+           (d == concat_dim ? shape_offsets[e.first] : 0);
+  };
+  auto after = [&](const Entry& a, const Entry& b) {
+    for (const int64 d : final_order) {
+      const int64 a_d = index(a, d);
+      const int64 b_d = index(b, d);
+      if (a_d != b_d) return a_d > b_d;
+    }
+    return a.first > b.first;
+  };
+  std::vector<Entry> heap;
+  for (int i = 0; i < tensors.size(); ++i) {
+    if (tensors[i].num_entries() > 0) heap.emplace_back(i, 0);
+  }
+  std::make_heap(heap.begin(), heap.end(), after);
+
+  for (Eigen::DenseIndex offset = 0; !heap.empty(); ++offset) {
+    std::pop_heap(heap.begin(), heap.end(), after);
+    Entry& next = heap.back();
+    for (int d = 0; d < dims; ++d) {
+      ix_t(offset, d) = index(next, d);
+    }
+    vals_t(offset) = st_vals[next.first](next.second);
+    if (++next.second < tensors[next.first].num_entries()) {
+      std::push_heap(heap.begin(), heap.end(), after);
+    } else {
+      heap.pop_back();
+    }
+  }
+
+  return SparseTensor(output_ix, output_vals, final_shape, final_order);
+}
+
 template <typename T>
 inline Status SparseTensor::Split(const SparseTensor& input_tensor,
                                   const int split_dim, const int num_split,
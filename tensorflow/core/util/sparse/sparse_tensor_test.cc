@@ -15,15 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -606,6 +611,105 @@ TEST(SparseTensorTest, ConcatEmptyN) {
   EXPECT_EQ(concatted.num_entries(), 0);
 }
 
+TEST(SparseTensorTest, ReorderWithThreadPool) {
+  // Large enough to be sorted with a radix sort.
+  const int N = 1 << 17;
+  const int NDIM = 3;
+  const std::vector<int64> shape{300, 300, 300};
+
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor ix(DT_INT64, TensorShape({N, NDIM}));
+  Tensor vals(DT_INT32, TensorShape({N}));
+  auto ix_t = ix.matrix<int64>();
+  for (int n = 0; n < N; ++n) {
+    for (int d = 0; d < NDIM; ++d) {
+      ix_t(n, d) = rnd.Uniform(shape[d]);
+    }
+    vals.vec<int32>()(n) = n;
+  }
+
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  for (const std::vector<int64>& order :
+       {std::vector<int64>{0, 1, 2}, std::vector<int64>{2, 0, 1}}) {
+    SparseTensor expected;
+    TF_ASSERT_OK(SparseTensor::Create(tensor::DeepCopy(ix),
+                                      tensor::DeepCopy(vals), shape, order,
+                                      &expected));
+    expected.Reorder<int32>(order);
+    SparseTensor st;
+    TF_ASSERT_OK(SparseTensor::Create(tensor::DeepCopy(ix),
+                                      tensor::DeepCopy(vals), shape, order,
+                                      &st));
+    st.Reorder<int32>(order, &pool);
+
+    // Entries with equal indices may be in any order, so compare the values
+    // only after checking that the indices match.
+    test::ExpectTensorEqual<int64>(st.indices(), expected.indices());
+    std::vector<int32> st_vals(N), expected_vals(N);
+    for (int n = 0; n < N; ++n) {
+      st_vals[n] = st.values().vec<int32>()(n);
+      expected_vals[n] = expected.values().vec<int32>()(n);
+    }
+    std::sort(st_vals.begin(), st_vals.end());
+    std::sort(expected_vals.begin(), expected_vals.end());
+    EXPECT_EQ(st_vals, expected_vals);
+    for (int n = 0; n < N; ++n) {
+      const int32 v = st.values().vec<int32>()(n);
+      for (int d = 0; d < NDIM; ++d) {
+        EXPECT_EQ(ix_t(v, d), st.indices().matrix<int64>()(n, d));
+      }
+    }
+
+    // Reordering sorted entries leaves them in place.
+    Tensor sorted_vals = tensor::DeepCopy(st.values());
+    st.Reorder<int32>(order, &pool);
+    test::ExpectTensorEqual<int32>(st.values(), sorted_vals);
+  }
+}
+
+TEST(SparseTensorTest, MergeConcat) {
+  int N = 5;
+  const int NDIM = 3;
+
+  Tensor ix(DT_INT64, TensorShape({N, NDIM}));
+  Tensor vals(DT_STRING, TensorShape({N}));
+  ix.matrix<int64>() = GetSimpleIndexTensor(N, NDIM);
+  auto vals_t = vals.vec<tstring>();
+  for (int n = 0; n < N; ++n) {
+    vals_t(n) = strings::StrCat(n);
+  }
+
+  TensorShape shape({10, 10, 10});
+  std::vector<int64> order{0, 1, 2};
+
+  SparseTensor st;
+  TF_ASSERT_OK(SparseTensor::Create(ix, vals, shape, order, &st));
+  st.Reorder<tstring>(order);
+  TF_EXPECT_OK(st.IndicesValid());
+
+  // Concatenating along a dimension other than the first order dimension
+  // interleaves the entries of the tensors.
+  SparseTensor concatted = SparseTensor::MergeConcat<tstring>({st, st}, 1);
+  EXPECT_EQ(concatted.order(), st.order());
+  gtl::InlinedVector<int64, 8> expected_shape{10, 20, 10};
+  EXPECT_EQ(concatted.shape(), expected_shape);
+  EXPECT_EQ(concatted.num_entries(), 2 * N);
+  TF_EXPECT_OK(concatted.IndicesValid());
+
+  // The same entries as reordering the tensors for Concat() and back.
+  std::vector<int64> concat_order{1, 0, 2};
+  SparseTensor st_1;
+  TF_ASSERT_OK(SparseTensor::Create(tensor::DeepCopy(st.indices()),
+                                    tensor::DeepCopy(st.values()), shape, order,
+                                    &st_1));
+  st_1.Reorder<tstring>(concat_order);
+  SparseTensor expected = SparseTensor::Concat<tstring>({st_1, st_1});
+  expected.Reorder<tstring>(order);
+  test::ExpectTensorEqual<int64>(concatted.indices(), expected.indices());
+  test::ExpectTensorEqual<tstring>(concatted.values(), expected.values());
+}
+
 // TODO(ebrevdo): ReduceToDense(R={dim1,dim2,...}, reduce_fn, &output)
 // reduce_fn sees slices of resorted values based on generator (dim: DDIMS), and
 // slices of resorted indices on generator.
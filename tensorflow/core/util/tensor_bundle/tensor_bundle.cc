@@ -31,8 +31,10 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -42,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -403,6 +406,74 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
   return status;
 }
 
+// Tensors larger than this are read with several concurrent reads of at most
+// this many bytes, since a single sequential read of a large tensor does not
+// saturate the bandwidth of fast local or remote storage.
+constexpr size_t kParallelReadChunkSize = 8 << 20;
+
+// Returns the pool issuing the concurrent reads of large tensors, or nullptr
+// if they are read sequentially. Its size is read from the
+// TF_TENSOR_BUNDLE_READ_THREADS environment variable.
+thread::ThreadPool* ParallelReadThreadPool() {
+  static thread::ThreadPool* pool = []() -> thread::ThreadPool* {
+    int64 num_threads;
+    Status status =
+        ReadInt64FromEnvVar("TF_TENSOR_BUNDLE_READ_THREADS", 8, &num_threads);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      num_threads = 8;
+    }
+    if (num_threads <= 1) return nullptr;
+    return new thread::ThreadPool(Env::Default(), "tensor_bundle_read",
+                                  num_threads);
+  }();
+  return pool;
+}
+
+// Reads file[offset, offset+size) into "destination".
+Status ReadFileRange(RandomAccessFile* file, uint64 offset, size_t size,
+                     char* destination) {
+  StringPiece sp;
+  TF_RETURN_IF_ERROR(file->Read(offset, size, &sp, destination));
+  if (sp.data() != destination) {
+    memmove(destination, sp.data(), size);
+  }
+  return Status::OK();
+}
+
+// Same as ReadFileRange, but splits the read into chunks that are read
+// concurrently when the range is large.
+Status ParallelReadFileRange(RandomAccessFile* file, uint64 offset,
+                             size_t size, char* destination) {
+  thread::ThreadPool* pool = ParallelReadThreadPool();
+  const size_t num_chunks =
+      (size + kParallelReadChunkSize - 1) / kParallelReadChunkSize;
+  if (pool == nullptr || num_chunks <= 1) {
+    return ReadFileRange(file, offset, size, destination);
+  }
+
+  mutex mu;
+  Status status;
+  BlockingCounter counter(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    const size_t chunk_offset = i * kParallelReadChunkSize;
+    const size_t chunk_size =
+        std::min(kParallelReadChunkSize, size - chunk_offset);
+    pool->Schedule([&, chunk_offset, chunk_size]() {
+      Status chunk_status =
+          ReadFileRange(file, offset + chunk_offset, chunk_size,
+                        destination + chunk_offset);
+      if (!chunk_status.ok()) {
+        mutex_lock l(mu);
+        status.Update(chunk_status);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  return status;
+}
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -823,6 +894,12 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
+  const string key_string(key);
+  auto cached = entry_cache_.find(key_string);
+  if (cached != entry_cache_.end()) {
+    *entry = cached->second;
+    return Status::OK();
+  }
   Seek(key);
   if (!iter_->Valid() || iter_->key() != key) {
     return errors::NotFound("Key ", key, " not found in checkpoint");
@@ -837,6 +914,7 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   }
 
   *entry = entry_copy;
+  entry_cache_.emplace(key_string, std::move(entry_copy));
   return Status::OK();
 }
 
@@ -888,12 +966,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
     if (entry.size() > kBufferSize) {
-      StringPiece sp;
-      TF_RETURN_IF_ERROR(buffered_file->file()->Read(
-          entry.offset(), entry.size(), &sp, backing_buffer));
-      if (sp.data() != backing_buffer) {
-        memmove(backing_buffer, sp.data(), entry.size());
-      }
+      TF_RETURN_IF_ERROR(ParallelReadFileRange(
+          buffered_file->file(), entry.offset(), entry.size(), backing_buffer));
     } else {
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
                                                    &unused_bytes_read));
@@ -1138,7 +1212,20 @@ string BundleReader::DebugString() {
   return shape_str;
 }
 
-FileOutputBuffer::~FileOutputBuffer() { delete file_; }
+FileOutputBuffer::FileOutputBuffer(WritableFile* file, size_t buffer_size)
+    : file_(file), position_(0), buffer_size_(buffer_size) {
+  DCHECK_GT(buffer_size, 0);
+  buffer_.resize(buffer_size);
+  pending_buffer_.resize(buffer_size);
+  write_thread_.reset(
+      new thread::ThreadPool(Env::Default(), "file_output_buffer", 1));
+}
+
+FileOutputBuffer::~FileOutputBuffer() {
+  // Joins the background append, if any, before the file goes away.
+  write_thread_.reset();
+  delete file_;
+}
 
 Status FileOutputBuffer::Append(StringPiece data) {
   // In the below, it is critical to calculate the checksum on the actually
@@ -1172,15 +1259,38 @@ Status FileOutputBuffer::Append(StringPiece data) {
 
 Status FileOutputBuffer::Close() {
   TF_RETURN_IF_ERROR(FlushBuffer());
+  TF_RETURN_IF_ERROR(WaitForPendingWrite());
   return file_->Close();
 }
 
 Status FileOutputBuffer::FlushBuffer() {
-  if (position_ > 0) {
-    TF_RETURN_IF_ERROR(file_->Append(StringPiece(&buffer_[0], position_)));
-    position_ = 0;
+  if (position_ == 0) {
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(WaitForPendingWrite());
+  buffer_.swap(pending_buffer_);
+  const size_t num_bytes = position_;
+  position_ = 0;
+  {
+    mutex_lock l(mu_);
+    write_pending_ = true;
   }
+  write_thread_->Schedule([this, num_bytes]() {
+    Status status = file_->Append(StringPiece(&pending_buffer_[0], num_bytes));
+    mutex_lock l(mu_);
+    write_status_.Update(status);
+    write_pending_ = false;
+    write_done_.notify_all();
+  });
   return Status::OK();
 }
 
+Status FileOutputBuffer::WaitForPendingWrite() {
+  mutex_lock l(mu_);
+  while (write_pending_) {
+    write_done_.wait(l);
+  }
+  return write_status_;
+}
+
 }  // namespace tensorflow
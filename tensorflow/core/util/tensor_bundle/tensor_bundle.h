@@ -76,6 +76,9 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
@@ -264,7 +267,9 @@ class BundleReader {
   string DebugString();
 
  private:
-  // Seeks for "key" and reads the metadata proto.
+  // Seeks for "key" and reads the metadata proto.  Parsed protos are cached,
+  // so that repeated lookups of the same key, e.g. of the stored slices of a
+  // partitioned tensor, do not go through the table again.
   // On non-OK return, clears "entry" for the caller.
   // REQUIRES: status().ok()
   Status GetBundleEntryProto(StringPiece key,
@@ -298,6 +303,9 @@ class BundleReader {
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
 
+  // Maps each key looked up so far to its parsed metadata proto.
+  std::unordered_map<string, BundleEntryProto> entry_cache_;
+
   // Expected number of data file shards in the bundle.  Extracted by reading
   // the header entry in the metadata table.
   int num_shards_;
@@ -314,13 +322,14 @@ class BundleReader {
 // A buffering wrapper for a WritableFile.  Useful if the caller wishes to issue
 // small writes to a file (e.g. writing out a list of small varints).
 // External synchronization must be used in the presence of concurrent callers.
+//
+// Full buffers are appended to the file on a background thread, while the
+// caller fills the next buffer, so that copying and checksumming the data
+// overlaps with the file writes.  Errors of the background writes are returned
+// by the next Append() or Close().
 class FileOutputBuffer {
  public:
-  FileOutputBuffer(WritableFile* file, size_t buffer_size)
-      : file_(file), position_(0), buffer_size_(buffer_size) {
-    DCHECK_GT(buffer_size, 0);
-    buffer_.resize(buffer_size);
-  }
+  FileOutputBuffer(WritableFile* file, size_t buffer_size);
   ~FileOutputBuffer();
 
   // Buffered append.
@@ -335,9 +344,14 @@ class FileOutputBuffer {
   Status Close();
 
  private:
-  // Appends the buffered data to the underlying file. Does NOT flush the file.
+  // Starts appending the buffered data to the underlying file, once the
+  // previous append is done. Does NOT flush the file.
   Status FlushBuffer();
 
+  // Waits until the append started by the last FlushBuffer() is done, and
+  // returns the status of the background appends.
+  Status WaitForPendingWrite();
+
   WritableFile* file_;  // Owned.
 
   // buffer_[0, position_) holds the buffered data not yet appended to the
@@ -346,6 +360,15 @@ class FileOutputBuffer {
   const size_t buffer_size_;
   std::vector<char> buffer_;
 
+  // The buffer being appended to the underlying file by 'write_thread_'.
+  std::vector<char> pending_buffer_;
+  std::unique_ptr<thread::ThreadPool> write_thread_;
+
+  mutex mu_;
+  condition_variable write_done_;
+  bool write_pending_ TF_GUARDED_BY(mu_) = false;
+  Status write_status_ TF_GUARDED_BY(mu_);
+
   // Checksum of all appended bytes since construction or last clear_crc32c().
   uint32 crc32c_ = 0;
 };
@@ -989,6 +989,47 @@ TEST(TensorBundleTest, TruncatedTensorContents) {
   EXPECT_TRUE(errors::IsOutOfRange(reader.Lookup("key", &val)));
 }
 
+TEST(TensorBundleTest, LargeTensor) {
+  // Large enough to be read in several concurrent chunks.
+  const int64 num_elements = 5 << 20;
+  Tensor expected(DT_FLOAT, TensorShape({num_elements}));
+  auto expected_flat = expected.flat<float>();
+  for (int64 i = 0; i < num_elements; ++i) {
+    expected_flat(i) = static_cast<float>(i);
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("large"));
+    TF_EXPECT_OK(writer.Add("foo", expected));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("large"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val(DT_FLOAT, TensorShape({num_elements}));
+  TF_ASSERT_OK(reader.Lookup("foo", &val));
+  test::ExpectTensorEqual<float>(expected, val);
+}
+
+TEST(TensorBundleTest, RepeatedLookups) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("repeated"));
+    TF_EXPECT_OK(writer.Add("bar", Constant_2x3(1.f)));
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3(2.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("repeated"));
+  TF_ASSERT_OK(reader.status());
+  for (int i = 0; i < 2; ++i) {
+    // Lookups of cached entries must not depend on the iterator position.
+    reader.Seek("foo");
+    Tensor val(DT_FLOAT, TensorShape({2, 3}));
+    TF_ASSERT_OK(reader.Lookup("bar", &val));
+    test::ExpectTensorEqual<float>(Constant_2x3(1.f), val);
+    TF_ASSERT_OK(reader.Lookup("foo", &val));
+    test::ExpectTensorEqual<float>(Constant_2x3(2.f), val);
+    EXPECT_TRUE(errors::IsNotFound(reader.Lookup("baz", &val)));
+  }
+}
+
 TEST(TensorBundleTest, HeaderEntry) {
   {
     BundleWriter writer(Env::Default(), Prefix("b"));
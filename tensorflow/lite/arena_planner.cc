@@ -25,6 +25,7 @@ namespace tflite {
 namespace {
 
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
+constexpr int32_t kNoSharedBuffer = -1;
 
 }  // namespace
 
@@ -176,6 +177,37 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
     }
   }
 
+  // Let the outputs of nodes that only change the shape of their input share
+  // the buffer of that input, when it is not used by later nodes. The buffer
+  // then lives until the last use of the output. Graph inputs are excluded,
+  // since callers overwrite them between invocations.
+  shared_buffer_tensor_.assign(graph_info_->num_tensors(), kNoSharedBuffer);
+  if (!preserve_intermediates_) {
+    std::vector<bool> is_graph_input(graph_info_->num_tensors(), false);
+    for (int tensor_index : graph_info_->inputs()) {
+      if (tensor_index != kTfLiteOptionalTensor) {
+        is_graph_input[tensor_index] = true;
+      }
+    }
+    for (size_t i = 0; i < graph_info_->num_execution_nodes(); ++i) {
+      if (!graph_info_->CanShareInputBuffer(i)) continue;
+      const TfLiteNode& node = graph_info_->node(i);
+      if (node.inputs->size < 1 || node.outputs->size < 1) continue;
+      const int input = node.inputs->data[0];
+      const int output = node.outputs->data[0];
+      if (input == kTfLiteOptionalTensor || is_graph_input[input] ||
+          dealloc_node_[input] != static_cast<int32_t>(i)) {
+        continue;
+      }
+      const int32_t owner = shared_buffer_tensor_[input] == kNoSharedBuffer
+                                ? input
+                                : shared_buffer_tensor_[input];
+      shared_buffer_tensor_[output] = owner;
+      dealloc_node_[owner] =
+          std::max(dealloc_node_[owner], dealloc_node_[output]);
+    }
+  }
+
   // Note that graph outputs will never be scheduled for deallocation. We
   // could do that here for completeness, but it won't have any effect.
   return kTfLiteOk;
@@ -187,6 +219,7 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   TF_LITE_ENSURE(context_, graph_info_->num_tensors() >= allocs_.size());
   alloc_node_.resize(graph_info_->num_tensors(), kNodeNotAssigned);
   dealloc_node_.resize(graph_info_->num_tensors(), kNodeNotAssigned);
+  shared_buffer_tensor_.resize(graph_info_->num_tensors(), kNoSharedBuffer);
   allocs_.resize(graph_info_->num_tensors());
   // Set allocation and deallocation for temporary tensors.
   for (size_t i = first_node; i <= static_cast<size_t>(last_node) &&
@@ -311,7 +344,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
-    if (tensor.allocation_type == kTfLiteArenaRw) {
+    if (tensor.allocation_type == kTfLiteArenaRw &&
+        !SharesBuffer(tensor_index)) {
       TF_LITE_ENSURE_STATUS(
           arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
                           tensor_index, alloc_node_[tensor_index],
@@ -327,9 +361,32 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
           &allocs_[tensor_index]));
     }
   }
+
+  // The tensors sharing a buffer reuse the allocation of its owner, which is
+  // allocated by now since it is allocated at an earlier node. Their
+  // allocations are not registered with the arena, which makes deallocating
+  // them a no-op.
+  for (const auto& tensor_index : tensor_order) {
+    if (SharesBuffer(tensor_index)) {
+      allocs_[tensor_index] = allocs_[shared_buffer_tensor_[tensor_index]];
+      allocs_[tensor_index].tensor = tensor_index;
+      allocs_[tensor_index].first_node = alloc_node_[tensor_index];
+      allocs_[tensor_index].last_node = dealloc_node_[tensor_index];
+    }
+  }
   return kTfLiteOk;
 }
 
+bool ArenaPlanner::SharesBuffer(int tensor_index) {
+  const int32_t owner = shared_buffer_tensor_[tensor_index];
+  if (owner == kNoSharedBuffer) return false;
+  const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+  const TfLiteTensor& owner_tensor = *graph_info_->tensor(owner);
+  return tensor.allocation_type == kTfLiteArenaRw &&
+         owner_tensor.allocation_type == kTfLiteArenaRw &&
+         tensor.bytes == owner_tensor.bytes;
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
@@ -90,6 +90,10 @@ class ArenaPlanner : public MemoryPlanner {
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
 
+  // Returns true if `tensor_index` shares the buffer of another tensor,
+  // instead of being allocated in the arena.
+  bool SharesBuffer(int tensor_index);
+
   // Register an allocation for all internal (temporary) tensors of
   // 'node_index'.
   TfLiteStatus CalculateAllocationOfInternalTensors(int node_index);
@@ -112,6 +116,11 @@ class ArenaPlanner : public MemoryPlanner {
   // the node's operation.
   std::vector<int32_t> dealloc_node_;
 
+  // For the outputs of nodes that can share the buffer of their input, the
+  // tensor whose buffer they share if they have the same size and are both
+  // arena-allocated. The lifetime of that tensor is extended to cover theirs.
+  std::vector<int32_t> shared_buffer_tensor_;
+
   // Raw memory buffer that is allocated for all temporary and graph outputs
   // that are declared kTfLiteArenaRw.
   SimpleMemoryArena arena_;
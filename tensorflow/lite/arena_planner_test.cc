@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <cstdarg>
 #include <cstdint>
+#include <set>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -109,12 +110,21 @@ class TestGraph {
     variables_ = variables;
   }
 
+  // Marks the nodes whose output may share the buffer of their input.
+  void SetBufferSharingNodes(const std::set<int>& nodes) {
+    buffer_sharing_nodes_ = nodes;
+  }
+  bool CanShareInputBuffer(int node) const {
+    return buffer_sharing_nodes_.count(node) > 0;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
     std::swap(inputs_, other->inputs_);
     std::swap(outputs_, other->outputs_);
     std::swap(variables_, other->variables_);
+    std::swap(buffer_sharing_nodes_, other->buffer_sharing_nodes_);
   }
 
  private:
@@ -123,6 +133,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::set<int> buffer_sharing_nodes_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -145,6 +156,9 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  bool CanShareInputBuffer(size_t index) const override {
+    return graph_->CanShareInputBuffer(index);
+  }
 
  private:
   TestGraph* graph_;
@@ -775,6 +789,64 @@ TEST_F(ArenaPlannerTest, DebugTensors) {
   EXPECT_EQ(tensorOffsets.size(), 8);
 }
 
+TEST_F(ArenaPlannerTest, SharedInputBuffer) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},  // First op
+                      {{1}, {2}, {}},  // Reshape
+                      {{2}, {3}, {}},  // Third op
+                      {{3}, {4}, {}},  // Fourth op
+                  },
+                  {4});
+  graph.SetBufferSharingNodes({1});
+  (*graph.tensors())[1].bytes = 16;
+  (*graph.tensors())[2].bytes = 16;
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // The reshape output shares the buffer of its input, which stays allocated
+  // until the reshape output is last used.
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), 0);
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(4), 0);
+}
+
+TEST_F(ArenaPlannerTest, SharedInputBufferStillUsed) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},     // First op
+                      {{1}, {2}, {}},     // Reshape
+                      {{1, 2}, {3}, {}},  // Third op, also reads 1
+                  },
+                  {3});
+  graph.SetBufferSharingNodes({1});
+  (*graph.tensors())[1].bytes = 16;
+  (*graph.tensors())[2].bytes = 16;
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  EXPECT_NE(GetOffset(2), GetOffset(1));
+}
+
+TEST_F(ArenaPlannerTest, SharedInputBufferSizeMismatch) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},  // First op
+                      {{1}, {2}, {}},  // Reshape, with a different size
+                      {{2}, {3}, {}},  // Third op
+                  },
+                  {3});
+  graph.SetBufferSharingNodes({1});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  EXPECT_NE(GetOffset(2), GetOffset(1));
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -186,6 +186,19 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  bool CanShareInputBuffer(size_t index) const override {
+    int node_index = subgraph_->execution_plan()[index];
+    const TfLiteRegistration& registration =
+        subgraph_->nodes_and_registration()[node_index].second;
+    switch (registration.builtin_code) {
+      case kTfLiteBuiltinExpandDims:
+      case kTfLiteBuiltinReshape:
+      case kTfLiteBuiltinSqueeze:
+        return true;
+      default:
+        return false;
+    }
+  }
 
  public:
   Subgraph* subgraph_;
@@ -681,7 +694,10 @@ TfLiteStatus Subgraph::AllocateTensors() {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
-  TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  const TfLiteStatus status = PrepareOpsAndTensors();
+  only_inputs_resized_ = false;
+  resized_tensors_.clear();
+  TF_LITE_ENSURE_STATUS(status);
 
   state_ = kStateInvokable;
 
@@ -728,6 +744,7 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
     return kTfLiteError;
   }
   state_ = kStateUninvokable;
+  only_inputs_resized_ = false;
 
   TF_LITE_ENSURE_OK(&context_, CheckTensorIndices("node inputs", inputs.data(),
                                                   inputs.size()));
@@ -820,6 +837,11 @@ TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
     // Undo delegation if it resulted in the graph being immutable.
     TF_LITE_ENSURE_STATUS(UndoAllDelegates());
   }
+  if (state_ == kStateInvokable) {
+    // Delegate kernels are always prepared again, since their Prepare may
+    // depend on more than the shapes of their inputs.
+    only_inputs_resized_ = pre_delegation_execution_plan_.empty();
+  }
   state_ = kStateUninvokable;
   return ResizeTensorImpl(tensor, ConvertVectorToTfLiteIntArray(dims));
 }
@@ -895,7 +917,8 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
     EnsureTensorsVectorCapacity();
-    if (OpPrepare(registration, &node) != kTfLiteOk) {
+    if (NodeNeedsPrepare(node) &&
+        OpPrepare(registration, &node) != kTfLiteOk) {
       return ReportOpError(&context_, node, registration, node_index,
                            "failed to prepare");
     }
@@ -913,6 +936,25 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
   return kTfLiteOk;
 }
 
+bool Subgraph::NodeNeedsPrepare(const TfLiteNode& node) const {
+  if (!only_inputs_resized_) return true;
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (resized_tensors_.count(tensor_index) != 0) return true;
+  }
+  for (const TfLiteIntArray* tensors :
+       {node.outputs, node.intermediates, node.temporaries}) {
+    if (tensors == nullptr) continue;
+    for (int tensor_index : TfLiteIntArrayView(tensors)) {
+      if (tensor_index != kTfLiteOptionalTensor &&
+          context_.tensors[tensor_index].allocation_type ==
+              kTfLiteArenaRwPersistent) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   if (!memory_planner_) {
     memory_planner_.reset(new ArenaPlanner(
@@ -991,7 +1033,12 @@ TfLiteStatus Subgraph::Invoke() {
     return kTfLiteError;
   }
 
-  // Invocations are always done in node order.
+  // Invocations are always done in node order. Independent nodes can't run
+  // concurrently: the memory planner lets tensors share arena memory based on
+  // this order, e.g. all the temporaries of different nodes overlap, and the
+  // kernels share the CPU backend contexts of the subgraph, which aren't
+  // thread-safe. Parallelism is instead available within ops, see
+  // Interpreter::SetNumThreads().
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
@@ -1214,6 +1261,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadOnly(
     tensor.allocation = allocation;
   } else {
     state_ = kStateUninvokable;
+    only_inputs_resized_ = false;
     TfLiteTensorReset(type, name, ConvertArrayToTfLiteIntArray(rank, dims),
                       GetLegacyQuantization(quantization),
                       const_cast<char*>(buffer), bytes, kTfLiteMmapRo,
@@ -1241,6 +1289,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadWrite(
         "SetTensorParametersReadWrite is disallowed when graph is immutable.");
     return kTfLiteError;
   }
+  only_inputs_resized_ = false;
   TF_LITE_ENSURE(&context_,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
   size_t required_bytes = 0;
@@ -1284,6 +1333,7 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  only_inputs_resized_ = false;
   return kTfLiteOk;
 }
 
@@ -1295,8 +1345,11 @@ TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
       tensor->allocation_type == kTfLiteArenaRwPersistent ||
       tensor->allocation_type == kTfLitePersistentRo ||
       tensor->allocation_type == kTfLiteCustom) {
-    tensor_resized_since_op_invoke_ |=
-        TfLiteIntArrayEqual(tensor->dims, new_size) == 0;
+    const bool dims_changed = TfLiteIntArrayEqual(tensor->dims, new_size) == 0;
+    tensor_resized_since_op_invoke_ |= dims_changed;
+    if (only_inputs_resized_ && dims_changed) {
+      resized_tensors_.insert(tensor - context_.tensors);
+    }
     if (tensor->type != kTfLiteString) {
       size_t bytesRequired;
       TfLiteStatus status = BytesRequired(tensor->type, new_size->data,
@@ -1433,6 +1486,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   nodes_and_registration_.resize(max_retained_node_index + 1);
   // After undoing delegates, the graph is uninvokable, but mutable.
   state_ = kStateUninvokable;
+  only_inputs_resized_ = false;
 
   delegates_undone_ = true;
   return kTfLiteOk;
@@ -1477,6 +1531,7 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    only_inputs_resized_ = false;
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -1547,6 +1602,7 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
   if (!(delegate->flags & kTfLiteDelegateFlagsAllowDynamicTensors)) {
     // Reset the state to force tensor/op reallocation.
     state_ = kStateUninvokable;
+    only_inputs_resized_ = false;
     TF_LITE_ENSURE_STATUS(
         reset_delegation_if_not_ok(EnsureMemoryAllocations()));
     // After using a delegate which doesn't support dynamic tensors, make the
@@ -1592,4 +1648,26 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::ResetCustomAllocationForTensor(int tensor_index) {
+  const auto alloc_it = std::find_if(
+      custom_allocations_.begin(), custom_allocations_.end(),
+      [tensor_index](
+          const std::pair<int, TfLiteCustomAllocation>& existing_alloc) {
+        return existing_alloc.first == tensor_index;
+      });
+  if (alloc_it == custom_allocations_.end()) return kTfLiteOk;
+  custom_allocations_.erase(alloc_it);
+
+  // Custom allocations are only accepted for arena tensors, which are
+  // persistent iff they are variables.
+  TfLiteTensor* tensor = &context_.tensors[tensor_index];
+  tensor->allocation_type =
+      tensor->is_variable ? kTfLiteArenaRwPersistent : kTfLiteArenaRw;
+  tensor->data.data = nullptr;
+  // The tensor was not part of the memory plan.
+  state_ = kStateUninvokable;
+
+  return kTfLiteOk;
+}
+
 }  // namespace tflite
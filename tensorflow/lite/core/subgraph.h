@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdint>
 #include <cstdlib>
 #include <map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -321,7 +322,8 @@ class Subgraph {
   // tensor byte length).
   // The runtime does NOT take ownership of the underlying memory.
   // Note that while this function can be called again to set a new allocation
-  // for the tensor, it can no longer be reset to the TFLite arena memory.
+  // for the tensor, returning the tensor to the TFLite arena memory requires
+  // ResetCustomAllocationForTensor().
   //
   // Parameters should satisfy the following conditions:
   // 1. tensor->allocation_type == kTfLiteArenaRw or kTfLiteArenaRwPersistent
@@ -337,6 +339,13 @@ class Subgraph {
   TfLiteStatus SetCustomAllocationForTensor(
       int tensor_index, const TfLiteCustomAllocation& allocation);
 
+  // Returns a tensor with a custom allocation to the TFLite arena memory. The
+  // tensor has no data until AllocateTensors() is called again. Does nothing
+  // if the tensor has no custom allocation.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus ResetCustomAllocationForTensor(int tensor_index);
+
  private:
   // SubgraphAwareProfiler wraps an actual TFLite profiler, such as a
   // BufferedProfiler instance, and takes care of event profiling/tracing in a
@@ -427,6 +436,13 @@ class Subgraph {
                                     const std::vector<int>& execution_plan,
                                     int* last_execution_plan_index_prepared);
 
+  // Returns true if PrepareOpsStartingAt() has to call OpPrepare() for `node`.
+  // When the graph was only changed by resizing its inputs, the nodes none of
+  // whose inputs were resized keep the output shapes of their last Prepare.
+  // Nodes with persistent arena tensors are always prepared again, since the
+  // persistent arena is re-planned and their contents are lost.
+  bool NodeNeedsPrepare(const TfLiteNode& node) const;
+
   // Tensors needed by the interpreter. Use `AddTensors` to add more blank
   // tensor entries. Note, `tensors_.data()` needs to be synchronized to the
   // `context_` whenever this std::vector is reallocated. Currently this
@@ -702,6 +718,14 @@ class Subgraph {
   // trigger downstream reallocation after op invocation.
   bool tensor_resized_since_op_invoke_ = false;
 
+  // True if the graph was invokable and has only been changed since by
+  // `ResizeInputTensor`. In that case `AllocateTensors` only prepares the
+  // nodes that read a tensor in `resized_tensors_`, which holds the input
+  // tensors that were resized and the outputs whose shape changed when their
+  // node was prepared again.
+  bool only_inputs_resized_ = false;
+  std::unordered_set<int> resized_tensors_;
+
   // Profiler for this interpreter instance.
   std::unique_ptr<SubgraphAwareProfiler> profiler_;
 
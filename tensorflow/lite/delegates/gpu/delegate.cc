@@ -16,12 +16,17 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/delegate.h"
 
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/common.h"
@@ -36,6 +41,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/common/status.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/minimal_logging.h"
+#include <farmhash.h>
 
 #ifndef CL_DELEGATE_NO_GL
 #include "tensorflow/lite/delegates/gpu/gl/api2.h"
@@ -69,6 +75,40 @@ InferenceUsage ToUsage(int32_t usage) {
   return InferenceUsage::UNKNOWN;
 }
 
+absl::Status ReadSerializedData(const std::string& path,
+                                std::vector<uint8_t>* data) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return absl::NotFoundError(absl::StrCat("Cannot open ", path));
+  }
+  data->assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  if (file.bad()) {
+    return absl::UnavailableError(absl::StrCat("Cannot read ", path));
+  }
+  return absl::OkStatus();
+}
+
+// Writes to a temporary file that is then renamed, so that concurrent readers
+// never see partially written data.
+absl::Status WriteSerializedData(const std::string& path,
+                                 absl::Span<const uint8_t> data) {
+  const std::string tmp_path = absl::StrCat(path, ".tmp");
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file) {
+      std::remove(tmp_path.c_str());
+      return absl::UnavailableError(absl::StrCat("Cannot write ", tmp_path));
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return absl::UnavailableError(absl::StrCat("Cannot rename ", tmp_path));
+  }
+  return absl::OkStatus();
+}
+
 // Forward declarations.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
 
@@ -92,6 +132,17 @@ class Delegate {
   int MaxDelegatedPartitions() const {
     return options_.max_delegated_partitions;
   }
+  bool IsSerializationEnabled() const {
+    return (options_.experimental_flags &
+            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION) &&
+           options_.serialization_dir != nullptr &&
+           options_.model_token != nullptr;
+  }
+  // Returns the path of the serialized data named `name` of the model.
+  std::string SerializationPath(const std::string& name) const {
+    return absl::StrCat(options_.serialization_dir, "/",
+                        options_.model_token, "_", name, ".bin");
+  }
   int num_delegate_kernels() const { return num_delegate_kernels_; }
 
  private:
@@ -134,14 +185,16 @@ class DelegateKernel {
     bool graph_is_destroyed;
     const int experimental_flags = delegate_->options().experimental_flags;
     if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY) {
-      RETURN_IF_ERROR(
-          InitializeOpenClApi(&graph, &builder, &graph_is_destroyed));
+      RETURN_IF_ERROR(InitializeOpenClApi(delegate_params, &graph, &builder,
+                                          &graph_is_destroyed, &input_refs,
+                                          &output_refs));
     } else if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY) {
       RETURN_IF_ERROR(InitializeOpenGlApi(&graph, &builder));
     } else {
       // By default, we try CL first & fall back to GL if that fails.
       absl::Status status =
-          InitializeOpenClApi(&graph, &builder, &graph_is_destroyed);
+          InitializeOpenClApi(delegate_params, &graph, &builder,
+                              &graph_is_destroyed, &input_refs, &output_refs);
       if (!status.ok()) {
         TF_LITE_KERNEL_LOG(context, std::string(status.message()).c_str());
         TF_LITE_KERNEL_LOG(context, "Falling back to OpenGL");
@@ -283,11 +336,23 @@ class DelegateKernel {
     return absl::OkStatus();
   }
 
-  absl::Status InitializeOpenClApi(GraphFloat32* graph,
+  absl::Status InitializeOpenClApi(const TfLiteDelegateParams* delegate_params,
+                                   GraphFloat32* graph,
                                    std::unique_ptr<InferenceBuilder>* builder,
-                                   bool* graph_is_destroyed) {
+                                   bool* graph_is_destroyed,
+                                   std::vector<uint32_t>* input_refs,
+                                   std::vector<uint32_t>* output_refs) {
     *graph_is_destroyed = false;
     cl::InferenceEnvironmentOptions env_options;
+    const bool serialization_enabled = delegate_->IsSerializationEnabled();
+    std::vector<uint8_t> serialized_binary_cache;
+    if (serialization_enabled) {
+      // A missing or invalid cache only means that programs are compiled.
+      ReadSerializedData(delegate_->SerializationPath("programs"),
+                         &serialized_binary_cache)
+          .IgnoreError();
+      env_options.serialized_binary_cache = serialized_binary_cache;
+    }
     cl::InferenceEnvironmentProperties properties;
     RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
                                                 &properties));
@@ -308,6 +373,11 @@ class DelegateKernel {
       }
     }
     options.usage = ToUsage(delegate_options.inference_preference);
+    if (serialization_enabled) {
+      return InitializeSerializedOpenClApi(delegate_params, options, graph,
+                                           builder, graph_is_destroyed,
+                                           input_refs, output_refs);
+    }
     *graph_is_destroyed = true;
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
         options, std::move(*graph), builder));
@@ -316,6 +386,73 @@ class DelegateKernel {
     return absl::OkStatus();
   }
 
+  // Restores the inference context of the partition from the serialization
+  // directory, or initializes it from `graph` and serializes it for the next
+  // initialization.
+  absl::Status InitializeSerializedOpenClApi(
+      const TfLiteDelegateParams* delegate_params,
+      const cl::InferenceOptions& options, GraphFloat32* graph,
+      std::unique_ptr<InferenceBuilder>* builder, bool* graph_is_destroyed,
+      std::vector<uint32_t>* input_refs, std::vector<uint32_t>* output_refs) {
+    // The serialized model is only valid for the same partition of the model
+    // and the same inference options.
+    std::string key;
+    const TfLiteIntArray* nodes = delegate_params->nodes_to_replace;
+    for (int i = 0; i < nodes->size; ++i) {
+      absl::StrAppend(&key, nodes->data[i], ",");
+    }
+    absl::StrAppend(&key, static_cast<int>(options.usage), ",",
+                    static_cast<int>(options.priority1), ",",
+                    static_cast<int>(options.priority2), ",",
+                    static_cast<int>(options.priority3), ",",
+                    delegate_->IsQuantOpsAllowed());
+    const std::string model_path = delegate_->SerializationPath(
+        absl::StrCat("model_", ::util::Fingerprint64(key)));
+
+    std::vector<uint8_t> serialized_model;
+    std::vector<int64_t> in_refs;
+    std::vector<int64_t> out_refs;
+    if (ReadSerializedData(model_path, &serialized_model).ok()) {
+      const absl::Status status = cl_environment_->NewInferenceBuilder(
+          serialized_model, builder, &in_refs, &out_refs);
+      if (status.ok()) {
+        input_refs->assign(in_refs.begin(), in_refs.end());
+        output_refs->assign(out_refs.begin(), out_refs.end());
+        TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
+                             "Initialized OpenCL-based API from serialized "
+                             "data.");
+        return absl::OkStatus();
+      }
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                      "Discarding serialized GPU delegate data: %s",
+                      std::string(status.message()).c_str());
+    }
+
+    *graph_is_destroyed = true;
+    serialized_model.clear();
+    RETURN_IF_ERROR(cl_environment_->BuildSerializedModel(
+        options, std::move(*graph), &serialized_model));
+    RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
+        serialized_model, builder, &in_refs, &out_refs));
+    input_refs->assign(in_refs.begin(), in_refs.end());
+    output_refs->assign(out_refs.begin(), out_refs.end());
+
+    // Failing to write only costs the initialization time of the next run.
+    absl::Status status = WriteSerializedData(model_path, serialized_model);
+    if (status.ok()) {
+      status = WriteSerializedData(delegate_->SerializationPath("programs"),
+                                   cl_environment_->GetSerializedBinaryCache());
+    }
+    if (!status.ok()) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                      "Failed to serialize GPU delegate data: %s",
+                      std::string(status.message()).c_str());
+    }
+    TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
+                         "Initialized OpenCL-based API.");
+    return absl::OkStatus();
+  }
+
   absl::Status InitializeOpenGlApi(GraphFloat32* graph,
                                    std::unique_ptr<InferenceBuilder>* builder) {
 #ifndef CL_DELEGATE_NO_GL
@@ -450,6 +587,8 @@ TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default() {
       .inference_priority3 = TFLITE_GPU_INFERENCE_PRIORITY_AUTO,
       .experimental_flags = TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT,
       .max_delegated_partitions = 1,
+      .serialization_dir = nullptr,
+      .model_token = nullptr,
   };
   return options;
 }
@@ -55,7 +55,9 @@ enum TfLiteGpuExperimentalFlags {
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT = 1 << 0,
   // Enforces execution with the provided backend.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY = 1 << 1,
-  TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY = 1 << 2
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY = 1 << 2,
+  // Enables serialization of the OpenCL backend to `serialization_dir`.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
@@ -101,6 +103,18 @@ typedef struct {
   // This limits the maximum number of partitions to be delegated. By default,
   // it's set to 1 in TfLiteGpuDelegateOptionsV2Default().
   int32_t max_delegated_partitions;
+
+  // Used when TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION is set.
+  // The OpenCL backend then stores in this directory the compiled programs and
+  // the initialized inference context of every delegated partition, which
+  // includes the tuned work group sizes, and restores them instead of
+  // compiling and tuning again on later initializations. Stale data, e.g. after
+  // a GPU driver update, is discarded and written again. The directory must
+  // exist, and should be private to the application.
+  const char* serialization_dir;
+  // Identifies the model in `serialization_dir`, e.g. a fingerprint of the
+  // model file. It must change whenever the model changes.
+  const char* model_token;
 } TfLiteGpuDelegateOptionsV2;
 
 // Populates TfLiteGpuDelegateOptionsV2 as follows:
@@ -111,6 +125,8 @@ typedef struct {
 //   priority3 = TFLITE_GPU_INFERENCE_PRIORITY_AUTO
 //   experimental_flags = TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT
 //   max_delegated_partitions = 1
+//   serialization_dir = nullptr
+//   model_token = nullptr
 TFL_CAPI_EXPORT TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default();
 
 // Creates a new delegate instance that need to be destroyed with
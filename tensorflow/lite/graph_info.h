@@ -59,6 +59,13 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns true if the first output of the node at execution-plan index
+  // `index` may share the buffer of its first input, which is the case for
+  // nodes that only change the shape of their input, e.g. RESHAPE.  Such nodes
+  // must accept being invoked with their output and input at the same
+  // address.
+  virtual bool CanShareInputBuffer(size_t index) const { return false; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -164,6 +164,10 @@ TfLiteStatus Interpreter::SetCustomAllocationForTensor(
                                                          allocation);
 }
 
+TfLiteStatus Interpreter::ResetCustomAllocationForTensor(int tensor_index) {
+  return primary_subgraph().ResetCustomAllocationForTensor(tensor_index);
+}
+
 TfLiteStatus Interpreter::SetInputs(std::vector<int> inputs) {
   return primary_subgraph().SetInputs(std::move(inputs));
 }
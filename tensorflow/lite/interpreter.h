@@ -596,7 +596,8 @@ class Interpreter {
   // tensor byte length).
   // The runtime does NOT take ownership of the underlying memory.
   // Note that while this function can be called again to set a new allocation
-  // for the tensor, it can no longer be reset to the TFLite arena memory.
+  // for the tensor, returning the tensor to the TFLite arena memory requires
+  // ResetCustomAllocationForTensor().
   //
   // Parameters should satisfy the following conditions:
   // 1. tensor->allocation_type == kTfLiteArenaRw or kTfLiteArenaRwPersistent
@@ -612,6 +613,13 @@ class Interpreter {
   TfLiteStatus SetCustomAllocationForTensor(
       int tensor_index, const TfLiteCustomAllocation& allocation);
 
+  // Returns a tensor with a custom allocation to the TFLite arena memory. The
+  // tensor has no data until AllocateTensors() is called again. Does nothing
+  // if the tensor has no custom allocation.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus ResetCustomAllocationForTensor(int tensor_index);
+
 #ifndef DOXYGEN_SKIP
   /// Adds `subgraphs_to_add` subgraphs, preserving pre-existing Subgraph
   /// entries. The value pointed to by `first_new_subgraph_index` will be set to
@@ -1077,6 +1077,71 @@ TEST(BasicInterpreter, DynamicTensorsResizeDescendants) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 10 * 14);
 }
 
+TEST(BasicInterpreter, ResizeInputOnlyPreparesAffectedNodes) {
+  // Each node copies the shape of its input to its output, and counts how many
+  // times it was prepared in the int pointed to by its init data.
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.init = [](TfLiteContext* context, const char* buffer, size_t length) {
+    return reinterpret_cast<void*>(const_cast<char*>(buffer));
+  };
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++*static_cast<int*>(node->user_data);
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+
+  // Assemble the graph 0 -> 1 -> 2 and 3 -> 4.
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0, 3}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2, 4}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {2}, quant),
+              kTfLiteOk);
+  }
+  int prepare_count[3] = {0, 0, 0};
+  ASSERT_EQ(interpreter.AddNodeWithParameters(
+                {0}, {1}, reinterpret_cast<const char*>(&prepare_count[0]),
+                sizeof(int), nullptr, &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters(
+                {1}, {2}, reinterpret_cast<const char*>(&prepare_count[1]),
+                sizeof(int), nullptr, &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters(
+                {3}, {4}, reinterpret_cast<const char*>(&prepare_count[2]),
+                sizeof(int), nullptr, &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count[0], 1);
+  EXPECT_EQ(prepare_count[1], 1);
+  EXPECT_EQ(prepare_count[2], 1);
+
+  // Only the nodes downstream of the resized input are prepared again.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {3}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count[0], 2);
+  EXPECT_EQ(prepare_count[1], 2);
+  EXPECT_EQ(prepare_count[2], 1);
+  EXPECT_EQ(interpreter.tensor(2)->bytes, 3 * sizeof(float));
+  EXPECT_EQ(interpreter.tensor(4)->bytes, 2 * sizeof(float));
+  EXPECT_NE(interpreter.tensor(2)->data.raw, nullptr);
+  EXPECT_NE(interpreter.tensor(4)->data.raw, nullptr);
+
+  // Any other change to the graph prepares all the nodes again.
+  ASSERT_EQ(interpreter.ResizeInputTensor(3, {4}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetExecutionPlan({0, 1, 2}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count[0], 3);
+  EXPECT_EQ(prepare_count[1], 3);
+  EXPECT_EQ(prepare_count[2], 2);
+  EXPECT_EQ(interpreter.tensor(4)->bytes, 4 * sizeof(float));
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -1690,6 +1755,37 @@ TEST_F(TestCustomAllocation, CustomInputAndOutputAllocs) {
   VerifyInvoke();
 }
 
+TEST_F(TestCustomAllocation, ResetCustomInputAndOutputAllocs) {
+  AssignCustomAllocForTensor(interpreter_->inputs()[0],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  AssignCustomAllocForTensor(interpreter_->outputs()[0],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  VerifyInvoke();
+  void* custom_output = interpreter_->typed_tensor<float>(
+      interpreter_->outputs()[0]);
+
+  ASSERT_EQ(
+      interpreter_->ResetCustomAllocationForTensor(interpreter_->inputs()[0]),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter_->ResetCustomAllocationForTensor(interpreter_->outputs()[0]),
+      kTfLiteOk);
+  // Resetting a tensor without a custom allocation is a no-op.
+  ASSERT_EQ(
+      interpreter_->ResetCustomAllocationForTensor(interpreter_->inputs()[1]),
+      kTfLiteOk);
+  EXPECT_EQ(interpreter_->tensor(interpreter_->inputs()[0])->allocation_type,
+            kTfLiteArenaRw);
+  // The tensors have to be planned in the arena again.
+  EXPECT_NE(interpreter_->Invoke(), kTfLiteOk);
+
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  EXPECT_NE(interpreter_->typed_tensor<float>(interpreter_->outputs()[0]),
+            custom_output);
+  VerifyInvoke();
+}
+
 // Ensure that custom allocs work for tensors on persistent arena as well.
 TEST_F(TestCustomAllocation, CustomAlloc_VariableTensor) {
   // Set custom allocation for one input tensor.
@@ -306,6 +306,11 @@ public final class Interpreter implements AutoCloseable {
    * Note that boolean types are only supported as arrays, not {@link java.nio.Buffer}s, or as
    * scalar inputs.
    *
+   * <p>Direct buffers at position 0 whose address is aligned to 64 bytes are used in place: inputs
+   * are read and outputs are written by the model without copies. The interpreter keeps using the
+   * memory of such a buffer until it is run with another object for the same input or output, an
+   * input is resized, or the interpreter is closed.
+   *
    * @param input an array or multidimensional array, or a {@link java.nio.Buffer} of primitive
    *     types including int, float, long, and byte. {@link java.nio.Buffer} is the preferred way to
    *     pass large input data for primitive types, whereas string types require using the
@@ -190,6 +190,8 @@ final class NativeInterpreterWrapper implements AutoCloseable {
       }
     }
 
+    bindBuffers(inputs, outputs);
+
     boolean needsAllocation = !isMemoryAllocated;
     if (needsAllocation) {
       allocateTensors(interpreterHandle, errorHandle);
@@ -222,6 +224,33 @@ final class NativeInterpreterWrapper implements AutoCloseable {
 
   private static native void run(long interpreterHandle, long errorHandle);
 
+  /**
+   * Binds the direct buffers among {@code inputs} and {@code outputs} as the memory of their
+   * tensors, so that they are read and written in place, and releases the buffers bound by
+   * previous runs to tensors that are given other objects.
+   */
+  private void bindBuffers(Object[] inputs, Map<Integer, Object> outputs) {
+    for (int i = 0; i < inputs.length; ++i) {
+      if (getInputTensor(i).bindBuffer(inputs[i], /*isOutput=*/ false)) {
+        isMemoryAllocated = false;
+      }
+    }
+    for (Map.Entry<Integer, Object> output : outputs.entrySet()) {
+      Tensor tensor = getOutputTensor(output.getKey());
+      Object dst = output.getValue();
+      // Outputs are not bound to the memory of inputs, nor are the tensors that are also inputs of
+      // the model, so that the inputs are not overwritten while the model runs.
+      for (int i = 0; i < inputs.length && dst != null; ++i) {
+        if (inputs[i] == dst || getInputTensor(i).index() == tensor.index()) {
+          dst = null;
+        }
+      }
+      if (tensor.bindBuffer(dst, /*isOutput=*/ true)) {
+        isMemoryAllocated = false;
+      }
+    }
+  }
+
   /** Resizes dimensions of a specific input. */
   void resizeInput(int idx, int[] dims) {
     resizeInput(idx, dims, false);
@@ -230,6 +259,9 @@ final class NativeInterpreterWrapper implements AutoCloseable {
   /** Resizes dimensions of a specific input. */
   void resizeInput(int idx, int[] dims, boolean strict) {
     if (resizeInput(interpreterHandle, errorHandle, idx, dims, strict)) {
+      // Bound buffers may be too small for the resized tensors, so release them before the
+      // tensors are allocated again.
+      unbindBuffers();
       // Tensor allocation is deferred until either an explicit `allocateTensors()` call or
       // `invoke()` avoiding redundant allocations if multiple tensors are simultaneosly resized.
       isMemoryAllocated = false;
@@ -239,6 +271,19 @@ final class NativeInterpreterWrapper implements AutoCloseable {
     }
   }
 
+  private void unbindBuffers() {
+    for (Tensor tensor : inputTensors) {
+      if (tensor != null && tensor.unbindBuffer()) {
+        isMemoryAllocated = false;
+      }
+    }
+    for (Tensor tensor : outputTensors) {
+      if (tensor != null && tensor.unbindBuffer()) {
+        isMemoryAllocated = false;
+      }
+    }
+  }
+
   private static native boolean resizeInput(
       long interpreterHandle, long errorHandle, int inputIdx, int[] dims, boolean strict);
 
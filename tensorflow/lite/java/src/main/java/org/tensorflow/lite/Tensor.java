@@ -90,6 +90,7 @@ public final class Tensor {
   void close() {
     delete(nativeHandle);
     nativeHandle = 0;
+    boundBuffer = null;
   }
 
   /** Returns the {@link DataType} of elements stored in the Tensor. */
@@ -197,6 +198,10 @@ public final class Tensor {
   }
 
   private void setTo(Buffer src) {
+    // The interpreter reads bound buffers in place.
+    if (src == boundBuffer) {
+      return;
+    }
     // Note that we attempt to use a direct memcpy optimization for direct, native-ordered buffers.
     // There are no base Buffer#order() or Buffer#put() methods, so again we have to ugly cast.
     if (src instanceof ByteBuffer) {
@@ -259,6 +264,12 @@ public final class Tensor {
   }
 
   private void copyTo(Buffer dst) {
+    // The interpreter writes bound buffers in place, so only advance the position as put() does.
+    if (dst == boundBuffer) {
+      int bytes = numBytes();
+      dst.position(dst.position() + (isByteBuffer(dst) ? bytes : bytes / dtype.byteSize()));
+      return;
+    }
     // There is no base Buffer#put() method, so we have to ugly cast.
     if (dst instanceof ByteBuffer) {
       ((ByteBuffer) dst).put(buffer());
@@ -273,6 +284,65 @@ public final class Tensor {
     }
   }
 
+  /**
+   * Binds {@code o} as the memory of the tensor if possible, so that the interpreter reads or
+   * writes it in place instead of copying it in {@link #setTo(Object)} or {@link #copyTo(Object)},
+   * and otherwise releases the buffer bound by a previous call.
+   *
+   * <p>Only direct buffers that start at their position 0, whose address is aligned to 64 bytes and
+   * that hold at least the bytes of the tensor can be bound, and typed buffers must be in native
+   * byte order. Output buffers must not be read-only.
+   *
+   * @return whether a bound buffer was released, in which case the tensors must be allocated again
+   *     before running the interpreter.
+   */
+  boolean bindBuffer(Object o, boolean isOutput) {
+    if (o == boundBuffer) {
+      return false;
+    }
+    if (isBuffer(o) && isBindable((Buffer) o, isOutput)) {
+      Buffer buffer = (Buffer) o;
+      int bufferBytes = isByteBuffer(o) ? buffer.capacity() : buffer.capacity() * dtype.byteSize();
+      if (bindDirectBuffer(nativeHandle, buffer, bufferBytes)) {
+        boundBuffer = buffer;
+        return false;
+      }
+    }
+    return unbindBuffer();
+  }
+
+  /**
+   * Releases the buffer bound by {@link #bindBuffer(Object, boolean)}, if any.
+   *
+   * @return whether a bound buffer was released, in which case the tensors must be allocated again
+   *     before running the interpreter.
+   */
+  boolean unbindBuffer() {
+    if (boundBuffer == null) {
+      return false;
+    }
+    unbindDirectBuffer(nativeHandle);
+    boundBuffer = null;
+    return true;
+  }
+
+  private boolean isBindable(Buffer buffer, boolean isOutput) {
+    if (!buffer.isDirect() || buffer.position() != 0 || (isOutput && buffer.isReadOnly())) {
+      return false;
+    }
+    // The bytes of a ByteBuffer are used as is, whatever its order.
+    if (buffer instanceof ByteBuffer) {
+      return true;
+    } else if (buffer instanceof FloatBuffer) {
+      return ((FloatBuffer) buffer).order() == ByteOrder.nativeOrder();
+    } else if (buffer instanceof IntBuffer) {
+      return ((IntBuffer) buffer).order() == ByteOrder.nativeOrder();
+    } else if (buffer instanceof LongBuffer) {
+      return ((LongBuffer) buffer).order() == ByteOrder.nativeOrder();
+    }
+    return false;
+  }
+
   /** Returns the provided buffer's shape if specified and different from this Tensor's shape. */
   // TODO(b/80431971): Remove this method after deprecating multi-dimensional array inputs.
   int[] getInputShapeIfDifferent(Object input) {
@@ -495,6 +565,9 @@ public final class Tensor {
   }
 
   private long nativeHandle;
+  // The buffer bound as the memory of the tensor, if any. The reference keeps the buffer alive
+  // while the interpreter uses its memory.
+  private Buffer boundBuffer;
   private final DataType dtype;
   private int[] shapeCopy;
   private final int[] shapeSignatureCopy;
@@ -522,6 +595,10 @@ public final class Tensor {
 
   private static native void writeDirectBuffer(long handle, Buffer src);
 
+  private static native boolean bindDirectBuffer(long handle, Buffer buffer, int numBytes);
+
+  private static native void unbindDirectBuffer(long handle);
+
   private static native int dtype(long handle);
 
   private static native int[] shape(long handle);
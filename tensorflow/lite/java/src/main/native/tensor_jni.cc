@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/core/shims/cc/interpreter.h"
 #include "tensorflow/lite/java/src/main/native/jni_utils.h"
 #include "tensorflow/lite/string_util.h"
+#include "tensorflow/lite/util.h"
 
 using tflite::jni::ThrowException;
 using tflite_shims::Interpreter;
@@ -44,6 +45,7 @@ class TensorHandle {
       : interpreter_(interpreter), tensor_index_(tensor_index) {}
 
   TfLiteTensor* tensor() const { return interpreter_->tensor(tensor_index_); }
+  Interpreter* interpreter() const { return interpreter_; }
   int index() const { return tensor_index_; }
 
  private:
@@ -448,6 +450,46 @@ JNIEXPORT void JNICALL Java_org_tensorflow_lite_Tensor_writeDirectBuffer(
   memcpy(tensor->data.data, src_data_raw, tensor->bytes);
 }
 
+JNIEXPORT jboolean JNICALL Java_org_tensorflow_lite_Tensor_bindDirectBuffer(
+    JNIEnv* env, jclass clazz, jlong handle, jobject buffer, jint num_bytes) {
+  TfLiteTensor* tensor = GetTensorFromHandle(env, handle);
+  if (tensor == nullptr) return JNI_FALSE;
+
+  // Buffers that the interpreter would reject are copied instead, so check
+  // them here rather than have the interpreter report errors.
+  void* data = env->GetDirectBufferAddress(buffer);
+  if (data == nullptr ||
+      reinterpret_cast<intptr_t>(data) % tflite::kDefaultTensorAlignment != 0 ||
+      num_bytes < 0 || static_cast<size_t>(num_bytes) < tensor->bytes) {
+    return JNI_FALSE;
+  }
+  if (tensor->allocation_type != kTfLiteArenaRw &&
+      tensor->allocation_type != kTfLiteArenaRwPersistent &&
+      tensor->allocation_type != kTfLiteCustom) {
+    return JNI_FALSE;
+  }
+  if (tensor->buffer_handle != kTfLiteNullBufferHandle) return JNI_FALSE;
+
+  TensorHandle* tensor_handle = reinterpret_cast<TensorHandle*>(handle);
+  TfLiteCustomAllocation allocation{data, static_cast<size_t>(num_bytes)};
+  return tensor_handle->interpreter()->SetCustomAllocationForTensor(
+             tensor_handle->index(), allocation) == kTfLiteOk
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_org_tensorflow_lite_Tensor_unbindDirectBuffer(
+    JNIEnv* env, jclass clazz, jlong handle) {
+  if (GetTensorFromHandle(env, handle) == nullptr) return;
+  TensorHandle* tensor_handle = reinterpret_cast<TensorHandle*>(handle);
+  if (tensor_handle->interpreter()->ResetCustomAllocationForTensor(
+          tensor_handle->index()) != kTfLiteOk) {
+    ThrowException(env, tflite::jni::kIllegalStateException,
+                   "Internal error: Failed to release the buffer of tensor %d",
+                   tensor_handle->index());
+  }
+}
+
 JNIEXPORT void JNICALL
 Java_org_tensorflow_lite_Tensor_readMultiDimensionalArray(JNIEnv* env,
                                                           jclass clazz,
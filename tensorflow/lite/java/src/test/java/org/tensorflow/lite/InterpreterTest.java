@@ -222,6 +222,40 @@ public final class InterpreterTest {
     assertThat(outputOneD).usingTolerance(0.1f).containsExactly(expected).inOrder();
   }
 
+  @Test
+  public void testRunWithDirectBuffersAcrossRuns() {
+    int numFloats = 2 * 8 * 8 * 3;
+    ByteBuffer input = ByteBuffer.allocateDirect(numFloats * 4).order(ByteOrder.nativeOrder());
+    ByteBuffer output = ByteBuffer.allocateDirect(numFloats * 4).order(ByteOrder.nativeOrder());
+    try (Interpreter interpreter = new Interpreter(MODEL_BUFFER)) {
+      for (int run = 1; run <= 3; ++run) {
+        for (int i = 0; i < numFloats; ++i) {
+          input.putFloat(i * 4, run);
+        }
+        output.rewind();
+        interpreter.run(input, output);
+        assertThat(output.position()).isEqualTo(numFloats * 4);
+        assertThat(output.getFloat(0)).isWithin(0.1f).of(3.0f * run);
+        assertThat(output.getFloat((numFloats - 1) * 4)).isWithin(0.1f).of(3.0f * run);
+      }
+
+      // Switching to arrays releases the buffers, which are left unchanged.
+      float[] oneD = {1.23f, 6.54f, 7.81f};
+      float[][] twoD = {oneD, oneD, oneD, oneD, oneD, oneD, oneD, oneD};
+      float[][][] threeD = {twoD, twoD, twoD, twoD, twoD, twoD, twoD, twoD};
+      float[][][][] fourD = {threeD, threeD};
+      float[][][][] parsedOutputs = new float[2][8][8][3];
+      interpreter.run(fourD, parsedOutputs);
+      float[] expected = {3.69f, 19.62f, 23.43f};
+      assertThat(parsedOutputs[0][0][0]).usingTolerance(0.1f).containsExactly(expected).inOrder();
+      assertThat(output.getFloat(0)).isWithin(0.1f).of(9.0f);
+
+      output.rewind();
+      interpreter.run(input, output);
+      assertThat(output.getFloat(0)).isWithin(0.1f).of(9.0f);
+    }
+  }
+
   @Test
   public void testRunWithScalarInput() {
     FloatBuffer parsedOutput = FloatBuffer.allocate(1);
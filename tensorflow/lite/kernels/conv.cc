@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
@@ -110,6 +111,16 @@ struct OpData {
   bool supports_multithreaded_kernel = false;
   bool is_hybrid_per_channel = false;
   bool compute_hybrid_row_sums = true;
+
+  // Block sparse filters are run natively, as a sparse fully connected layer
+  // over the im2col patches. `sparse_filter` describes the filter reshaped to
+  // [output_depth, filter_height * filter_width * input_depth] and points into
+  // `sparse_dim_metadata`, `sparse_segments` and `sparse_indices`.
+  bool has_sparse_filter = false;
+  TfLiteSparsity sparse_filter = {};
+  std::vector<TfLiteDimensionMetadata> sparse_dim_metadata;
+  TfLiteIntArray* sparse_segments = nullptr;
+  TfLiteIntArray* sparse_indices = nullptr;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -139,7 +150,97 @@ void Free(TfLiteContext* context, void* buffer) {
 #if defined(TFLITE_WITH_MULTITHREADED_EIGEN)
   eigen_support::DecrementUsageCounter(context);
 #endif
-  delete reinterpret_cast<OpData*>(buffer);
+  auto* data = reinterpret_cast<OpData*>(buffer);
+  TfLiteIntArrayFree(data->sparse_segments);
+  TfLiteIntArrayFree(data->sparse_indices);
+  delete data;
+}
+
+// Checks that the sparse `filter` is in one of the block sparse formats that
+// can be run natively, and converts its sparsity metadata to the format of
+// the 2D [output_depth, filter_height * filter_width * input_depth] matrix.
+//
+// The filter must be traversed in its natural order, with dense output,
+// height and width dimensions and a CSR input depth dimension, split in 1x4
+// blocks (along the input depth) or 4x4 blocks (along the output and input
+// depths). The values are then already laid out as the blocks of the 2D
+// matrix, and only the segments and indices of the CSR dimension change.
+TfLiteStatus PrepareSparseFilter(TfLiteContext* context,
+                                 const TfLiteTensor* input,
+                                 const TfLiteTensor* filter, OpData* data) {
+  const TfLiteSparsity& sparsity = *filter->sparsity;
+  if (input->type != kTfLiteFloat32 || filter->type != kTfLiteFloat32) {
+    TF_LITE_KERNEL_LOG(context,
+                       "Sparse conv filters are only supported for float32.");
+    return kTfLiteError;
+  }
+
+  const int out_depth = filter->dims->data[0];
+  const int filter_size = filter->dims->data[1] * filter->dims->data[2];
+  const int in_depth = filter->dims->data[3];
+  const bool is_1x4 = sparsity.dim_metadata_size == 5 &&
+                      sparsity.block_map != nullptr &&
+                      sparsity.block_map->size == 1 &&
+                      sparsity.block_map->data[0] == 3 &&
+                      sparsity.dim_metadata[4].dense_size == 4;
+  const bool is_4x4 = sparsity.dim_metadata_size == 6 &&
+                      sparsity.block_map != nullptr &&
+                      sparsity.block_map->size == 2 &&
+                      sparsity.block_map->data[0] == 0 &&
+                      sparsity.block_map->data[1] == 3 &&
+                      sparsity.dim_metadata[4].dense_size == 4 &&
+                      sparsity.dim_metadata[5].dense_size == 4;
+  bool supported = (is_1x4 || is_4x4) && sparsity.traversal_order != nullptr &&
+                   sparsity.traversal_order->size ==
+                       sparsity.dim_metadata_size &&
+                   sparsity.dim_metadata[0].format == kTfLiteDimDense &&
+                   sparsity.dim_metadata[1].format == kTfLiteDimDense &&
+                   sparsity.dim_metadata[2].format == kTfLiteDimDense &&
+                   sparsity.dim_metadata[3].format == kTfLiteDimSparseCSR &&
+                   in_depth % 4 == 0 && out_depth % (is_4x4 ? 4 : 1) == 0;
+  for (int i = 0; supported && i < sparsity.traversal_order->size; ++i) {
+    supported = sparsity.traversal_order->data[i] == i;
+  }
+  if (!supported) {
+    TF_LITE_KERNEL_LOG(context, "Unsupported sparse conv filter format.");
+    return kTfLiteError;
+  }
+
+  // Row r of the 2D matrix is made of the segments of its filter_size
+  // (height, width) positions, whose column blocks are offset by the position.
+  const int block_rows = is_4x4 ? out_depth / 4 : out_depth;
+  const int in_blocks = in_depth / 4;
+  const TfLiteIntArray* segments = sparsity.dim_metadata[3].array_segments;
+  const TfLiteIntArray* indices = sparsity.dim_metadata[3].array_indices;
+  TF_LITE_ENSURE_EQ(context, segments->size, block_rows * filter_size + 1);
+  TfLiteIntArrayFree(data->sparse_segments);
+  TfLiteIntArrayFree(data->sparse_indices);
+  data->sparse_segments = TfLiteIntArrayCreate(block_rows + 1);
+  data->sparse_indices = TfLiteIntArrayCreate(indices->size);
+  for (int r = 0; r <= block_rows; ++r) {
+    data->sparse_segments->data[r] = segments->data[r * filter_size];
+  }
+  for (int s = 0; s < block_rows * filter_size; ++s) {
+    for (int i = segments->data[s]; i < segments->data[s + 1]; ++i) {
+      data->sparse_indices->data[i] =
+          (s % filter_size) * in_blocks + indices->data[i];
+    }
+  }
+
+  TfLiteDimensionMetadata dense_4 = {};
+  dense_4.format = kTfLiteDimDense;
+  dense_4.dense_size = 4;
+  data->sparse_dim_metadata.assign(is_4x4 ? 4 : 3, dense_4);
+  data->sparse_dim_metadata[0].dense_size = block_rows;
+  data->sparse_dim_metadata[1].format = kTfLiteDimSparseCSR;
+  data->sparse_dim_metadata[1].dense_size = 0;
+  data->sparse_dim_metadata[1].array_segments = data->sparse_segments;
+  data->sparse_dim_metadata[1].array_indices = data->sparse_indices;
+  data->sparse_filter = {};
+  data->sparse_filter.dim_metadata = data->sparse_dim_metadata.data();
+  data->sparse_filter.dim_metadata_size = data->sparse_dim_metadata.size();
+  data->has_sparse_filter = true;
+  return kTfLiteOk;
 }
 
 // Naive implementation of transpose for floats. Could be optimized to be more
@@ -179,6 +280,9 @@ bool IsIm2ColRequired(const TfLiteTensor* input, TfLiteConvParams* params,
   // Return early as basic requirement is not met
   if (!need_im2col) return false;
 
+  // Sparse filters always run through im2col, whatever the kernel type.
+  if (filter->sparsity != nullptr) return true;
+
   // Special case for Hybrid, as it supports only non-dilated im2col currently
   const bool is_hybrid_non_dilated = is_hybrid && need_non_dilated_im2col;
   const bool is_quantized =
@@ -343,6 +447,10 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     TF_LITE_ENSURE_EQ(context, output->params.zero_point, 0);
   }
 
+  if (filter->sparsity != nullptr) {
+    TF_LITE_ENSURE_STATUS(PrepareSparseFilter(context, input, filter, data));
+  }
+
   const TfLiteTensor* bias = nullptr;
 
   // TODO(ahentz): At this point the optimized versions require 'bias'. We can
@@ -386,11 +494,13 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     }
   }
 
-  // The multi-threaded kernel supports neither dilation nor hybrid kernels, and
-  // is incompatible with mutable input filters that might change between evals.
+  // The multi-threaded kernel supports neither dilation, hybrid kernels nor
+  // sparse filters, and is incompatible with mutable input filters that might
+  // change between evals.
   data->supports_multithreaded_kernel =
       (kernel_type == kMultithreadOptimized) &&
       (context->recommended_num_threads != 1) && !is_hybrid &&
+      !data->has_sparse_filter &&
       (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
       (filter->allocation_type != kTfLiteArenaRw) &&
@@ -772,6 +882,17 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.dilation_height_factor = params->dilation_height_factor;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  if (data->has_sparse_filter) {
+    optimized_ops::ConvSparseWeight(
+        data->sparse_filter, op_params, GetTensorShape(input),
+        GetTensorData<float>(input), GetTensorShape(filter),
+        GetTensorData<float>(filter), GetTensorShape(bias),
+        GetTensorData<float>(bias), GetTensorShape(output),
+        GetTensorData<float>(output), GetTensorShape(im2col),
+        GetTensorData<float>(im2col),
+        CpuBackendContext::GetFromContext(context));
+    return;
+  }
   switch (effective_kernel_type) {
     case kReference: {
       reference_ops::Conv(op_params, GetTensorShape(input),
@@ -861,6 +861,168 @@ TEST_P(ConvolutionOpTest, SimpleTestFloatWithDilation) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({5, 5, 5, 5, 5, 5, 5, 5, 5}));
 }
 
+// Float convolution whose filter is a constant, either stored densely or in
+// the block sparse format described by `filter`.
+class SparseConvolutionOpModel : public SingleOpModel {
+ public:
+  SparseConvolutionOpModel(TfLiteRegistration* registration,
+                           const TensorData& input, const TensorData& filter,
+                           const std::vector<float>& filter_data,
+                           bool sparse_filter, int stride_width = 1,
+                           int stride_height = 1,
+                           enum Padding padding = Padding_VALID,
+                           int dilation_width_factor = 1,
+                           int dilation_height_factor = 1) {
+    input_ = AddInput(input);
+    if (sparse_filter) {
+      filter_ = AddConstSparseInput(filter, filter_data);
+    } else {
+      filter_ = AddInput({TensorType_FLOAT32, filter.shape});
+    }
+    bias_ = AddInput({TensorType_FLOAT32, {filter.shape[0]}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, padding, stride_width,
+                                     stride_height, ActivationFunctionType_NONE,
+                                     dilation_width_factor,
+                                     dilation_height_factor)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                    registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)},
+                     /*num_threads=*/-1, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+    if (!sparse_filter) {
+      PopulateTensor(filter_, filter_data);
+    }
+  }
+
+  void SetBias(const std::vector<float>& data) { PopulateTensor(bias_, data); }
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor(input_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(ConvolutionOpTest, SparseFilter1x4Float32) {
+  TensorData filter = {TensorType_FLOAT32, {4, 1, 1, 4}};
+  filter.traversal_order = {0, 1, 2, 3, 4};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {3};
+  filter.block_size = {4};
+  SparseConvolutionOpModel m(GetRegistration(),
+                             {TensorType_FLOAT32, {1, 2, 2, 4}}, filter,
+                             {
+                                 1, 2, 3, 4,    // first 1x1 filter
+                                 0, 0, 0, 0,    // second 1x1 filter
+                                 -1, 1, -1, 1,  // third 1x1 filter
+                                 0, 0, 0, 0,    // fourth 1x1 filter
+                             },
+                             /*sparse_filter=*/true);
+
+  m.SetInput({
+      1, 1, 1, 1,  // top left
+      1, 2, 3, 4,  // top right
+      0, 1, 0, 1,  // bottom left
+      2, 2, 2, 2,  // bottom right
+  });
+  m.SetBias({1, 2, 3, 4});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 11, 2, 3, 4,  // top left
+                                 31, 2, 5, 4,  // top right
+                                 7, 2, 5, 4,   // bottom left
+                                 21, 2, 3, 4,  // bottom right
+                             }));
+}
+
+// Runs a convolution with a block sparse filter, whose blocks are zeroed one
+// time out of three, and compares it against the same convolution with a
+// dense filter.
+void TestSparseFilterMatchesDense(TfLiteRegistration* registration,
+                                  const TensorData& filter, int stride,
+                                  enum Padding padding, int dilation) {
+  const int out_depth = filter.shape[0];
+  const int filter_height = filter.shape[1];
+  const int filter_width = filter.shape[2];
+  const int in_depth = filter.shape[3];
+  const int block_rows = filter.block_size.size() == 2 ? 4 : 1;
+  std::vector<float> filter_data;
+  for (int o = 0; o < out_depth; ++o) {
+    for (int y = 0; y < filter_height; ++y) {
+      for (int x = 0; x < filter_width; ++x) {
+        for (int c = 0; c < in_depth; ++c) {
+          const bool zero_block = (o / block_rows + y + x + c / 4) % 3 == 1;
+          filter_data.push_back(zero_block ? 0.f : ((o + 3 * c) % 7 - 3) / 3.f);
+        }
+      }
+    }
+  }
+
+  const TensorData input = {TensorType_FLOAT32, {2, 7, 6, in_depth}};
+  std::vector<float> input_data(2 * 7 * 6 * in_depth);
+  for (int i = 0; i < input_data.size(); ++i) {
+    input_data[i] = ((i * 5) % 9 - 4) / 4.f;
+  }
+  std::vector<float> bias(out_depth);
+  for (int i = 0; i < out_depth; ++i) bias[i] = 0.5f * i;
+
+  SparseConvolutionOpModel sparse(registration, input, filter, filter_data,
+                                  /*sparse_filter=*/true, stride, stride,
+                                  padding, dilation, dilation);
+  sparse.SetInput(input_data);
+  sparse.SetBias(bias);
+  sparse.Invoke();
+
+  SparseConvolutionOpModel dense(registration, input, filter, filter_data,
+                                 /*sparse_filter=*/false, stride, stride,
+                                 padding, dilation, dilation);
+  dense.SetInput(input_data);
+  dense.SetBias(bias);
+  dense.Invoke();
+
+  EXPECT_THAT(sparse.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(dense.GetOutput(), 1e-4)));
+}
+
+TEST_P(ConvolutionOpTest, SparseFilter1x4Float32MatchesDense) {
+  TensorData filter = {TensorType_FLOAT32, {6, 3, 3, 8}};
+  filter.traversal_order = {0, 1, 2, 3, 4};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {3};
+  filter.block_size = {4};
+  TestSparseFilterMatchesDense(GetRegistration(), filter, /*stride=*/1,
+                               Padding_SAME, /*dilation=*/1);
+  TestSparseFilterMatchesDense(GetRegistration(), filter, /*stride=*/2,
+                               Padding_VALID, /*dilation=*/1);
+  TestSparseFilterMatchesDense(GetRegistration(), filter, /*stride=*/1,
+                               Padding_VALID, /*dilation=*/2);
+}
+
+TEST_P(ConvolutionOpTest, SparseFilter4x4Float32MatchesDense) {
+  TensorData filter = {TensorType_FLOAT32, {8, 3, 3, 8}};
+  filter.traversal_order = {0, 1, 2, 3, 4, 5};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {0, 3};
+  filter.block_size = {4, 4};
+  TestSparseFilterMatchesDense(GetRegistration(), filter, /*stride=*/1,
+                               Padding_SAME, /*dilation=*/1);
+  TestSparseFilterMatchesDense(GetRegistration(), filter, /*stride=*/2,
+                               Padding_VALID, /*dilation=*/1);
+}
+
 class QuantizedConvolutionOpModel : public BaseConvolutionOpModel<uint8_t> {
  public:
   using BaseConvolutionOpModel::BaseConvolutionOpModel;
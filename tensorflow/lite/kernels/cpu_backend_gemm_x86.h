@@ -61,7 +61,13 @@ struct GemmImplX86 {
   }
 };
 
-// For float, defer to eigen for now.
+// Products with at least this many destination columns, i.e. batched inputs
+// of fully-connected layers, are large enough to be split between threads.
+constexpr int kMinColsForMultithreadedFloatGemm = 4;
+
+// For float, defer to eigen for now, except for batched products when several
+// threads are available: Eigen runs single-threaded here, while ruy splits the
+// destination between the threads of the context.
 template <>
 struct GemmImplX86<float, float, float, float,
                    QuantizationFlavor::kFloatingPoint> {
@@ -71,6 +77,15 @@ struct GemmImplX86<float, float, float, float,
                   const GemmParams<float, float,
                                    QuantizationFlavor::kFloatingPoint>& params,
                   CpuBackendContext* context) {
+    if (context->max_num_threads() > 1 &&
+        dst_params.cols >= kMinColsForMultithreadedFloatGemm &&
+        context->HasAvxOrAbove()) {
+      detail::GemmImplUsingRuy<float, float, float, float,
+                               QuantizationFlavor::kFloatingPoint>::
+          Run(lhs_params, lhs_data, rhs_params, rhs_data, dst_params, dst_data,
+              params, context);
+      return;
+    }
     GemmImplUsingEigen::Run(lhs_params, lhs_data, rhs_params, rhs_data,
                             dst_params, dst_data, params, context);
   }
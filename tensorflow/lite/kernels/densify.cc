@@ -17,10 +17,12 @@ limitations under the License.
 #include <stddef.h>
 
 #include <cstdint>
+#include <memory>
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/shared_constant_tensors.h"
 
 namespace tflite {
 namespace ops {
@@ -38,6 +40,8 @@ struct OpContext {
 
 struct OpData {
   bool dense_weights_initialized;
+  // The dense weights, shared with the other interpreters of the model.
+  std::shared_ptr<char> dense_weights;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -61,19 +65,15 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, op_context.input->sparsity != nullptr);
 
   op_context.output->type = op_context.input->type;
-  op_context.output->allocation_type = kTfLiteArenaRwPersistent;
+  // The dense weights live outside of the arena, so that they can be shared
+  // with other interpreters of the same model.
+  op_context.output->allocation_type = kTfLiteCustom;
 
   return context->ResizeTensor(context, op_context.output,
                                TfLiteIntArrayCopy(op_context.input->dims));
 }
 
-TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
-  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
-  OpContext op_context(context, node);
-  if (op_data->dense_weights_initialized) {
-    return kTfLiteOk;
-  }
-
+TfLiteStatus DensifyImpl(TfLiteContext* context, const OpContext& op_context) {
   switch (op_context.input->type) {
     case kTfLiteFloat32:
       reference_ops::Densify(op_context.input->sparsity,
@@ -102,7 +102,26 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                            op_context.input->type);
       return kTfLiteError;
   }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  OpContext op_context(context, node);
+  if (op_data->dense_weights_initialized) {
+    return kTfLiteOk;
+  }
 
+  TfLiteTensor* output = op_context.output;
+  TfLiteStatus status = SharedConstantTensors::Global()->Get(
+      *op_context.input, output->type, output->bytes,
+      [&](char* buffer) {
+        output->data.raw = buffer;
+        return DensifyImpl(context, op_context);
+      },
+      &op_data->dense_weights);
+  output->data.raw = op_data->dense_weights.get();
+  TF_LITE_ENSURE_OK(context, status);
   op_data->dense_weights_initialized = true;
   return kTfLiteOk;
 }
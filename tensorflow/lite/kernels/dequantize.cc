@@ -16,9 +16,12 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <memory>
+
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/shared_constant_tensors.h"
 
 namespace tflite {
 namespace ops {
@@ -37,6 +40,8 @@ struct OpContext {
 struct OpData {
   // This boolean value is only used when the input tensor is constant.
   bool float_dequantized_weights_initialized;
+  // The dequantized weights, shared with the other interpreters of the model.
+  std::shared_ptr<char> float_dequantized_weights;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -66,9 +71,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   op_context.output->type = kTfLiteFloat32;
   // If the input tensor is constant, we can persist the dequantized value in
-  // the output tensor. Otherwise we run dequantize upon each eval.
+  // the output tensor. Otherwise we run dequantize upon each eval. The
+  // persisted value lives outside of the arena, so that it can be shared with
+  // other interpreters of the same model.
   if (IsConstantTensor(op_context.input)) {
-    op_context.output->allocation_type = kTfLiteArenaRwPersistent;
+    op_context.output->allocation_type = kTfLiteCustom;
   }
   return context->ResizeTensor(context, op_context.output,
                                TfLiteIntArrayCopy(op_context.input->dims));
@@ -78,21 +85,27 @@ template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
   OpContext op_context(context, node);
-  if (IsConstantTensor(op_context.input) &&
-      op_data->float_dequantized_weights_initialized) {
-    return kTfLiteOk;
-  }
-
-  auto status = DequantizeImpl<kernel_type>(context, node, op_context.input,
-                                            op_context.output);
-  if (status != kTfLiteOk) {
-    return status;
-  }
-
   if (IsConstantTensor(op_context.input)) {
+    if (op_data->float_dequantized_weights_initialized) {
+      return kTfLiteOk;
+    }
+    TfLiteTensor* output = op_context.output;
+    TfLiteStatus status = SharedConstantTensors::Global()->Get(
+        *op_context.input, output->type, output->bytes,
+        [&](char* buffer) {
+          output->data.raw = buffer;
+          return DequantizeImpl<kernel_type>(context, node, op_context.input,
+                                             output);
+        },
+        &op_data->float_dequantized_weights);
+    output->data.raw = op_data->float_dequantized_weights.get();
+    TF_LITE_ENSURE_OK(context, status);
     op_data->float_dequantized_weights_initialized = true;
+    return kTfLiteOk;
   }
-  return kTfLiteOk;
+
+  return DequantizeImpl<kernel_type>(context, node, op_context.input,
+                                     op_context.output);
 }
 
 }  // namespace dequantize
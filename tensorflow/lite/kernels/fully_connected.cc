@@ -52,6 +52,7 @@ bool SupportedSparsityFormat(const TfLiteSparsity& sparsity) {
 
 static const int kDimMetadataSizeRandomSparse = 2;
 static const int kDimMetadataSizeBlockSparse = 3;
+static const int kDimMetadataSizeBlockSparse4x4 = 4;
 
 }  // namespace
 
@@ -694,6 +695,18 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             GetTensorData<float>(bias), GetTensorShape(output),
             GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse4x4 &&
+                 sparsity.dim_metadata[2].dense_size == 4 &&
+                 sparsity.dim_metadata[3].dense_size == 4 &&
+                 filter->dims->data[0] % 4 == 0) {
+        // Block sparse with block size of 4x4.
+        optimized_ops::FullyConnectedSparseWeight4x4(
+            sparsity, op_params, GetTensorShape(input),
+            GetTensorData<float>(input), GetTensorShape(filter),
+            GetTensorData<float>(filter), GetTensorShape(bias),
+            GetTensorData<float>(bias), GetTensorShape(output),
+            GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
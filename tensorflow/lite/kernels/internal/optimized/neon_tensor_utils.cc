@@ -1924,6 +1924,47 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate4x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  const int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_rows % kBlockSize, 0);
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    float* result_in_batch = result + batch * m_rows;
+    for (int row = 0; row < m_rows; row += kBlockSize) {
+      // One accumulator per row of the blocks.
+      float32x4_t acc0_32x4 = vmovq_n_f32(0.0);
+      float32x4_t acc1_32x4 = vmovq_n_f32(0.0);
+      float32x4_t acc2_32x4 = vmovq_n_f32(0.0);
+      float32x4_t acc3_32x4 = vmovq_n_f32(0.0);
+
+      for (int i = segments[row / kBlockSize];
+           i < segments[row / kBlockSize + 1]; i++) {
+        // The 4 vector values are shared by the 4 rows of the block.
+        const float32x4_t vector_f32x4 =
+            vld1q_f32(vector_in_batch + indices[i] * kBlockSize);
+        acc0_32x4 = vmlaq_f32(acc0_32x4, vld1q_f32(matrix_ptr), vector_f32x4);
+        acc1_32x4 =
+            vmlaq_f32(acc1_32x4, vld1q_f32(matrix_ptr + 4), vector_f32x4);
+        acc2_32x4 =
+            vmlaq_f32(acc2_32x4, vld1q_f32(matrix_ptr + 8), vector_f32x4);
+        acc3_32x4 =
+            vmlaq_f32(acc3_32x4, vld1q_f32(matrix_ptr + 12), vector_f32x4);
+        matrix_ptr += kBlockSize * kBlockSize;
+      }
+      result_in_batch[row] += AccumulateNeonLane(acc0_32x4);
+      result_in_batch[row + 1] += AccumulateNeonLane(acc1_32x4);
+      result_in_batch[row + 2] += AccumulateNeonLane(acc2_32x4);
+      result_in_batch[row + 3] += AccumulateNeonLane(acc3_32x4);
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
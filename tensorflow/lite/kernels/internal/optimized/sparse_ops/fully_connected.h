@@ -73,7 +73,9 @@ inline void FullyConnectedSparseWeight(
   }
 }
 
-inline void FullyConnectedSparseWeight1x4Impl(
+// Handles both the 1x4 and the 4x4 block sparse formats, which are told apart
+// by the number of dimensions in the sparsity metadata.
+inline void FullyConnectedSparseWeightBlockImpl(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
     const RuntimeShape& weights_shape, const float* weights_data,
@@ -81,7 +83,9 @@ inline void FullyConnectedSparseWeight1x4Impl(
     const RuntimeShape& output_shape, float* output_data, int thread_start,
     int thread_end, const CpuBackendContext& cpu_backend_context) {
   ruy::profiler::ScopeLabel label("FullyConnected");
-  ruy::profiler::ScopeLabel inner_label("1x4 Block Sparse");
+  const bool is_4x4 = sparsity.dim_metadata_size == 4;
+  ruy::profiler::ScopeLabel inner_label(is_4x4 ? "4x4 Block Sparse"
+                                               : "1x4 Block Sparse");
   const float output_activation_min = params.float_activation_min;
   const float output_activation_max = params.float_activation_max;
 
@@ -96,10 +100,17 @@ inline void FullyConnectedSparseWeight1x4Impl(
   const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
   const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
 
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
-      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
-      weights_shape.Dims(1), input_data + thread_start * input_depth, batches,
-      output_data + thread_start * output_depth);
+  if (is_4x4) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate4x4(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        batches, output_data + thread_start * output_depth);
+  } else {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        batches, output_data + thread_start * output_depth);
+  }
 
   ruy::profiler::ScopeLabel activation_label("activation function");
   for (int b = thread_start; b < thread_end; ++b) {
@@ -112,8 +123,8 @@ inline void FullyConnectedSparseWeight1x4Impl(
   }
 }
 
-struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
-  FullyConnectedSparseWeight1x4Task(
+struct FullyConnectedSparseWeightBlockTask : cpu_backend_threadpool::Task {
+  FullyConnectedSparseWeightBlockTask(
       const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
       const RuntimeShape& input_shape, const float* input_data,
       const RuntimeShape& weights_shape, const float* weights_data,
@@ -135,7 +146,7 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
         cpu_backend_context(cpu_backend_context_x) {}
 
   void Run() override {
-    FullyConnectedSparseWeight1x4Impl(
+    FullyConnectedSparseWeightBlockImpl(
         sparsity, params, input_shape, input_data, weights_shape, weights_data,
         bias_shape, bias_data, output_shape, output_data, thread_start,
         thread_end, cpu_backend_context);
@@ -161,7 +172,7 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
 // there's not enough batches of data, the number of threads used is equal to
 // the batch size. We can improve this later with slicing along the row
 // dimension of the weight.
-inline void FullyConnectedSparseWeight1x4(
+inline void FullyConnectedSparseWeightBlock(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
     const RuntimeShape& weights_shape, const float* weights_data,
@@ -176,12 +187,12 @@ inline void FullyConnectedSparseWeight1x4(
       FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
   const int thread_count = std::max(1, std::min(batches, max_threads));
   if (thread_count == 1) {
-    return FullyConnectedSparseWeight1x4Impl(
+    return FullyConnectedSparseWeightBlockImpl(
         sparsity, params, input_shape, input_data, weights_shape, weights_data,
         bias_shape, bias_data, output_shape, output_data, 0, batches,
         *cpu_backend_context);
   }
-  std::vector<FullyConnectedSparseWeight1x4Task> tasks;
+  std::vector<FullyConnectedSparseWeightBlockTask> tasks;
   tasks.reserve(thread_count);
   int thread_start = 0;
   for (int i = 0; i < thread_count; ++i) {
@@ -201,6 +212,34 @@ inline void FullyConnectedSparseWeight1x4(
                                   cpu_backend_context);
 }
 
+inline void FullyConnectedSparseWeight1x4(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeightBlock(sparsity, params, input_shape, input_data,
+                                  weights_shape, weights_data, bias_shape,
+                                  bias_data, output_shape, output_data,
+                                  cpu_backend_context);
+}
+
+// The weights are stored as 4x4 blocks in row major order, so the number of
+// rows of the weights must be a multiple of 4.
+inline void FullyConnectedSparseWeight4x4(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeightBlock(sparsity, params, input_shape, input_data,
+                                  weights_shape, weights_data, bias_shape,
+                                  bias_data, output_shape, output_data,
+                                  cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
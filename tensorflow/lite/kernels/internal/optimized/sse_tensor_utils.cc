@@ -17,6 +17,7 @@ limitations under the License.
 #ifdef __SSSE3__
 
 #include <emmintrin.h>  // SSE2
+#include <pmmintrin.h>  // SSE3
 #include <tmmintrin.h>  // SSSE3
 #ifdef __SSE4_1__
 #include <smmintrin.h>  // SSE4.1
@@ -414,6 +415,77 @@ void SseSparseMatrixBatchVectorMultiplyAccumulate(
   }  // for batch
 }
 
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  const int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      __m128 acc_f32x4 = _mm_setzero_ps();
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        const __m128 vector_f32x4 =
+            _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize);
+        acc_f32x4 = _mm_add_ps(
+            acc_f32x4, _mm_mul_ps(_mm_loadu_ps(matrix_ptr), vector_f32x4));
+        matrix_ptr += kBlockSize;
+      }
+      acc_f32x4 = _mm_hadd_ps(acc_f32x4, acc_f32x4);
+      acc_f32x4 = _mm_hadd_ps(acc_f32x4, acc_f32x4);
+      result[batch * m_rows + row] += _mm_cvtss_f32(acc_f32x4);
+    }
+  }
+}
+
+void SseSparseMatrixBatchVectorMultiplyAccumulate4x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  const int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_rows % kBlockSize, 0);
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    float* result_in_batch = result + batch * m_rows;
+    for (int row = 0; row < m_rows; row += kBlockSize) {
+      // One accumulator per row of the blocks.
+      __m128 acc0_f32x4 = _mm_setzero_ps();
+      __m128 acc1_f32x4 = _mm_setzero_ps();
+      __m128 acc2_f32x4 = _mm_setzero_ps();
+      __m128 acc3_f32x4 = _mm_setzero_ps();
+      for (int i = segments[row / kBlockSize];
+           i < segments[row / kBlockSize + 1]; i++) {
+        // The 4 vector values are shared by the 4 rows of the block.
+        const __m128 vector_f32x4 =
+            _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize);
+        acc0_f32x4 = _mm_add_ps(
+            acc0_f32x4, _mm_mul_ps(_mm_loadu_ps(matrix_ptr), vector_f32x4));
+        acc1_f32x4 = _mm_add_ps(
+            acc1_f32x4, _mm_mul_ps(_mm_loadu_ps(matrix_ptr + 4), vector_f32x4));
+        acc2_f32x4 = _mm_add_ps(
+            acc2_f32x4, _mm_mul_ps(_mm_loadu_ps(matrix_ptr + 8), vector_f32x4));
+        acc3_f32x4 =
+            _mm_add_ps(acc3_f32x4,
+                       _mm_mul_ps(_mm_loadu_ps(matrix_ptr + 12), vector_f32x4));
+        matrix_ptr += kBlockSize * kBlockSize;
+      }
+      // Reduces the 4 accumulators to [row0, row1, row2, row3].
+      const __m128 sums_f32x4 =
+          _mm_hadd_ps(_mm_hadd_ps(acc0_f32x4, acc1_f32x4),
+                      _mm_hadd_ps(acc2_f32x4, acc3_f32x4));
+      _mm_storeu_ps(
+          result_in_batch + row,
+          _mm_add_ps(_mm_loadu_ps(result_in_batch + row), sums_f32x4));
+    }
+  }
+}
+
 void SseReductionSumVector(const int8_t* input_vector, int32_t* output_vector,
                            const int output_size, const int reduction_size) {
   static constexpr std::intptr_t kBlockSize = 16;
@@ -106,6 +106,16 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result);
 
+// Same as the function above, but the matrix is a sparse tensor with block
+// pattern 4x4, whose blocks are stored in row major. `segments` has one entry
+// per group of 4 rows, plus one.
+// This function assumes that both m_rows and m_cols are multiples of the block
+// size (4 in this case) so that there's no incomplete block.
+void SparseMatrixBatchVectorMultiplyAccumulate4x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
 // Same as the function above, but the matrix is stored in block compressed
 // sparse row format with block pattern 1x16 which consists of two arrays:
 //   1. A matrix array stores non-zero blocks of the matrix in row major.
@@ -358,6 +358,69 @@ TEST(uKernels, MatrixBatchVectorMultiplyAccumulateTest) {
                                                        -1., 7., 23.})));
 }
 
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate1x4Test) {
+  constexpr int kRow = 3;
+  constexpr int kCol = 8;
+  constexpr int kBatch = 2;
+  // The dense matrix is
+  //   1.0,  2.0,  3.0,  4.0,  0.0,  0.0,  0.0,  0.0,
+  //   0.0,  0.0,  0.0,  0.0,  -1.0, -2.0, -3.0, -4.0,
+  //   1.0,  -2.0, 3.0,  -4.0, 2.0,  2.0,  2.0,  2.0.
+  static float matrix[] = {1.0,  2.0,  3.0,  4.0,   //
+                           -1.0, -2.0, -3.0, -4.0,  //
+                           1.0,  -2.0, 3.0,  -4.0,  //
+                           2.0,  2.0,  2.0,  2.0};
+  static int segments[kRow + 1] = {0, 1, 2, 4};
+  static int indices[] = {0, 1, 0, 1};
+  static float vector[kCol * kBatch] = {
+      1.0, -1.0, 1.0, -1.0, 1.0, 1.0, 1.0, 1.0,  //
+      2.0, -2.0, 2.0, -2.0, 1.0, 0.0, 1.0, 0.0};
+  std::vector<float> output(kRow * kBatch);
+  std::fill(output.begin(), output.end(), 3.0);
+  SparseMatrixBatchVectorMultiplyAccumulate1x4(
+      matrix, segments, indices, kRow, kCol, vector, kBatch, output.data());
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear({1., -7., 21.,  //
+                                                       -1., -1., 27.})));
+}
+
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate4x4Test) {
+  constexpr int kRow = 8;
+  constexpr int kCol = 12;
+  constexpr int kBatch = 3;
+  // Two rows of blocks, with the blocks at columns 2 and 0, 1 respectively.
+  static int segments[kRow / 4 + 1] = {0, 1, 3};
+  static int indices[] = {2, 0, 1};
+  float matrix[3 * 16];
+  for (int i = 0; i < 3 * 16; ++i) {
+    matrix[i] = 0.5f * (i % 7) - 1.0f;
+  }
+  float vector[kCol * kBatch];
+  for (int i = 0; i < kCol * kBatch; ++i) {
+    vector[i] = 0.25f * (i % 5) - 0.5f;
+  }
+
+  float dense_matrix[kRow * kCol] = {};
+  int value = 0;
+  for (int block_row = 0; block_row < kRow / 4; ++block_row) {
+    for (int i = segments[block_row]; i < segments[block_row + 1]; ++i) {
+      for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+          dense_matrix[(block_row * 4 + r) * kCol + indices[i] * 4 + c] =
+              matrix[value++];
+        }
+      }
+    }
+  }
+  std::vector<float> expected(kRow * kBatch, 1.0);
+  MatrixBatchVectorMultiplyAccumulate(dense_matrix, kRow, kCol, vector, kBatch,
+                                      expected.data());
+
+  std::vector<float> output(kRow * kBatch, 1.0);
+  SparseMatrixBatchVectorMultiplyAccumulate4x4(
+      matrix, segments, indices, kRow, kCol, vector, kBatch, output.data());
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(expected)));
+}
+
 // Quantized matmul with 2 * 30 input and 9 * 30 matrix.
 TEST(uKernels, QuantMatrixBatchVectorMultiplyAccumulate8x8_16Test) {
   CpuBackendContext context;
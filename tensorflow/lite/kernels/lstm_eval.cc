@@ -489,6 +489,9 @@ void CalculateLstmGateInteger8x8_16(
     const int8_t* input, const int8_t* input_to_gate_weights,
     const int32_t* input_to_gate_bias, const int32_t input_to_gate_scale_a,
     const int32_t input_to_gate_scale_b,
+    // input_weight * input if already computed, see
+    // PrecomputeInputContributionsInteger8x8_16
+    const int16_t* input_contribution,
     // Output state and weights
     const int8_t* output_state, const int8_t* recurrent_to_gate_weights,
     const int32_t* recurrent_to_gate_bias,
@@ -514,14 +517,18 @@ void CalculateLstmGateInteger8x8_16(
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
-  // Initialize scratch buffers with zeros. Note that unlike float and hybrid
-  // versions, bias is only used in layer normalization.
-  std::fill_n(gate, n_batch * n_cell, 0);
-  // For each batch and cell: compute input_weight * input.
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input, input_to_gate_bias, input_to_gate_weights, input_to_gate_scale_a,
-      input_to_gate_scale_b, n_batch, n_input, n_cell, 0, scratch5, gate,
-      context);
+  if (input_contribution != nullptr) {
+    std::copy_n(input_contribution, n_batch * n_cell, gate);
+  } else {
+    // Initialize scratch buffers with zeros. Note that unlike float and hybrid
+    // versions, bias is only used in layer normalization.
+    std::fill_n(gate, n_batch * n_cell, 0);
+    // For each batch and cell: compute input_weight * input.
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input, input_to_gate_bias, input_to_gate_weights, input_to_gate_scale_a,
+        input_to_gate_scale_b, n_batch, n_input, n_cell, 0, scratch5, gate,
+        context);
+  }
   // Note: no aux_input.
 
   // For each batch and cell: compute recurrent_weight * output_state.
@@ -1298,6 +1305,11 @@ inline void LstmStepHybrid(
 //   output_state_zp: zero point of output state
 //   hidden_zp: zero point for hidden state.
 //
+// Precomputed input_weight * input of the input, forget, cell and output
+// gates, in that order, each of size 'n_batch * n_cell' and
+// 'input_contributions_gate_stride' apart:
+//   input_contributions                 - optional
+//
 // Temporary pre-allocated storage for the calculation. Each is of size n_cell *
 // n_batch.
 //   scratch0
@@ -1372,11 +1384,13 @@ inline void LstmStepInteger8x8_16(
     const int32_t* recurrent_to_output_effective_bias,
     const int32_t* input_to_input_effective_bias,
     const int32_t* recurrent_to_input_effective_bias,
-    const int32_t* projection_effective_bias, int n_batch, int n_cell,
-    int n_input, int n_output, int8_t* output_state_ptr,
-    int32_t output_state_zp, int16_t* cell_state_ptr, int8_t* output_ptr,
-    int16_t* scratch0, int16_t* scratch1, int16_t* scratch2, int16_t* scratch3,
-    int8_t* scratch4, int32_t* scratch5, CpuBackendContext* context) {
+    const int32_t* projection_effective_bias,
+    const int16_t* input_contributions, int input_contributions_gate_stride,
+    int n_batch, int n_cell, int n_input, int n_output,
+    int8_t* output_state_ptr, int32_t output_state_zp, int16_t* cell_state_ptr,
+    int8_t* output_ptr, int16_t* scratch0, int16_t* scratch1,
+    int16_t* scratch2, int16_t* scratch3, int8_t* scratch4, int32_t* scratch5,
+    CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepInteger8x8_16");
   // Make named scratch buffers for the different gates.
   int16_t* input_gate_scratch = scratch0;
@@ -1403,12 +1417,17 @@ inline void LstmStepInteger8x8_16(
   if (use_projection) {
     TFLITE_DCHECK(projection_effective_bias);
   }
+  auto input_contribution = [&](int gate) -> const int16_t* {
+    return input_contributions != nullptr
+               ? input_contributions + gate * input_contributions_gate_stride
+               : nullptr;
+  };
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
     CalculateLstmGateInteger8x8_16(
         input_ptr, input_to_input_weight_ptr, input_to_input_effective_bias,
         effective_input_to_input_scale_a, effective_input_to_input_scale_b,
-        output_state_ptr, recurrent_to_input_weight_ptr,
+        input_contribution(0), output_state_ptr, recurrent_to_input_weight_ptr,
         recurrent_to_input_effective_bias, effective_recurrent_to_input_scale_a,
         effective_recurrent_to_input_scale_b, cell_state_ptr,
         cell_to_input_weight_ptr, effective_cell_to_input_scale_a,
@@ -1421,7 +1440,7 @@ inline void LstmStepInteger8x8_16(
   CalculateLstmGateInteger8x8_16(
       input_ptr, input_to_forget_weight_ptr, input_to_forget_effective_bias,
       effective_input_to_forget_scale_a, effective_input_to_forget_scale_b,
-      output_state_ptr, recurrent_to_forget_weight_ptr,
+      input_contribution(1), output_state_ptr, recurrent_to_forget_weight_ptr,
       recurrent_to_forget_effective_bias, effective_recurrent_to_forget_scale_a,
       effective_recurrent_to_forget_scale_b, cell_state_ptr,
       cell_to_forget_weight_ptr, effective_cell_to_forget_scale_a,
@@ -1434,7 +1453,7 @@ inline void LstmStepInteger8x8_16(
   CalculateLstmGateInteger8x8_16(
       input_ptr, input_to_cell_weight_ptr, input_to_cell_effective_bias,
       effective_input_to_cell_scale_a, effective_input_to_cell_scale_b,
-      output_state_ptr, recurrent_to_cell_weight_ptr,
+      input_contribution(2), output_state_ptr, recurrent_to_cell_weight_ptr,
       recurrent_to_cell_effective_bias, effective_recurrent_to_cell_scale_a,
       effective_recurrent_to_cell_scale_b, cell_state_ptr,
       /*cell_to_gate_weights=*/nullptr, /*cell_to_gate_scale_a=*/0,
@@ -1450,7 +1469,7 @@ inline void LstmStepInteger8x8_16(
   CalculateLstmGateInteger8x8_16(
       input_ptr, input_to_output_weight_ptr, input_to_output_effective_bias,
       effective_input_to_output_scale_a, effective_input_to_output_scale_b,
-      output_state_ptr, recurrent_to_output_weight_ptr,
+      input_contribution(3), output_state_ptr, recurrent_to_output_weight_ptr,
       recurrent_to_output_effective_bias, effective_recurrent_to_output_scale_a,
       effective_recurrent_to_output_scale_b, cell_state_ptr,
       cell_to_output_weight_ptr, effective_cell_to_output_scale_a,
@@ -1472,6 +1491,54 @@ inline void LstmStepInteger8x8_16(
   std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
 }
 
+// Computes input_weight * input of the input, forget, cell and output gates for
+// the 'n_rows' rows of 'input', i.e. for all the time steps of a sequence at
+// once, into 'input_contributions' of size '4 * n_rows * n_cell'. Only the
+// recurrent products depend on the previous step, so the input products are
+// computed with one matrix-matrix product per gate instead of one
+// matrix-vector product per gate and time step. The results are the same as
+// the per-step products of CalculateLstmGateInteger8x8_16.
+//
+// 'scratch' is of size 'n_rows * n_cell'.
+void PrecomputeInputContributionsInteger8x8_16(
+    const int8_t* input, const int8_t* input_to_input_weight_ptr,
+    const int8_t* input_to_forget_weight_ptr,
+    const int8_t* input_to_cell_weight_ptr,
+    const int8_t* input_to_output_weight_ptr,
+    const IntegerLstmParameter* integer_lstm_param, int n_rows, int n_input,
+    int n_cell, int16_t* input_contributions, int32_t* scratch,
+    CpuBackendContext* context) {
+  ruy::profiler::ScopeLabel label("PrecomputeInputContributionsInteger8x8_16");
+  const int8_t* weights[4] = {input_to_input_weight_ptr,
+                              input_to_forget_weight_ptr,
+                              input_to_cell_weight_ptr,
+                              input_to_output_weight_ptr};
+  const int32_t* biases[4] = {
+      integer_lstm_param->input_to_input_effective_bias.get(),
+      integer_lstm_param->input_to_forget_effective_bias.get(),
+      integer_lstm_param->input_to_cell_effective_bias.get(),
+      integer_lstm_param->input_to_output_effective_bias.get()};
+  const int32_t scales_a[4] = {
+      integer_lstm_param->effective_input_to_input_scale_a,
+      integer_lstm_param->effective_input_to_forget_scale_a,
+      integer_lstm_param->effective_input_to_cell_scale_a,
+      integer_lstm_param->effective_input_to_output_scale_a};
+  const int32_t scales_b[4] = {
+      integer_lstm_param->effective_input_to_input_scale_b,
+      integer_lstm_param->effective_input_to_forget_scale_b,
+      integer_lstm_param->effective_input_to_cell_scale_b,
+      integer_lstm_param->effective_input_to_output_scale_b};
+  for (int gate = 0; gate < 4; ++gate) {
+    // There are no input gate weights in CIFG LSTMs.
+    if (weights[gate] == nullptr) continue;
+    int16_t* contribution = input_contributions + gate * n_rows * n_cell;
+    std::fill_n(contribution, n_rows * n_cell, 0);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input, biases[gate], weights[gate], scales_a[gate], scales_b[gate],
+        n_rows, n_input, n_cell, 0, scratch, contribution, context);
+  }
+}
+
 // Fully quantized lstm kernel for 8 bit gate matmul output.
 //
 // Input tensor of size n_batch * n_input:
@@ -2171,7 +2238,8 @@ TfLiteStatus EvalInteger8x8_16(
     TfLiteTensor* output_state, TfLiteTensor* cell_state, TfLiteTensor* output,
     TfLiteTensor* scratch0, TfLiteTensor* scratch1, TfLiteTensor* scratch2,
     TfLiteTensor* scratch3, TfLiteTensor* scratch4, TfLiteTensor* scratch5,
-    CpuBackendContext* context) {
+    TfLiteTensor* input_contributions,
+    TfLiteTensor* input_contributions_scratch, CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   const int n_input = input->dims->data[input->dims->size - 1];
   int max_time, n_batch;
@@ -2190,6 +2258,23 @@ TfLiteStatus EvalInteger8x8_16(
   // Activation zero point
   int output_state_zp = output_state->params.zero_point;
 
+  // The rows of the input are in the same order as the steps below, so the
+  // input contributions of a step are at the offset of its input, in units of
+  // n_cell instead of n_input.
+  int16_t* input_contributions_ptr = nullptr;
+  const int input_contributions_gate_stride = max_time * n_batch * n_cell;
+  if (input_contributions != nullptr) {
+    input_contributions_ptr = GetTensorData<int16_t>(input_contributions);
+    PrecomputeInputContributionsInteger8x8_16(
+        GetTensorData<int8_t>(input),
+        GetTensorData<int8_t>(input_to_input_weights),
+        GetTensorData<int8_t>(input_to_forget_weights),
+        GetTensorData<int8_t>(input_to_cell_weights),
+        GetTensorData<int8_t>(input_to_output_weights), integer_lstm_param,
+        max_time * n_batch, n_input, n_cell, input_contributions_ptr,
+        GetTensorData<int32_t>(input_contributions_scratch), context);
+  }
+
   // Get params for time/batch/sequence.
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
@@ -2273,8 +2358,12 @@ TfLiteStatus EvalInteger8x8_16(
           integer_lstm_param->recurrent_to_output_effective_bias.get(),
           integer_lstm_param->input_to_input_effective_bias.get(),
           integer_lstm_param->recurrent_to_input_effective_bias.get(),
-          integer_lstm_param->projection_effective_bias.get(), n_batch, n_cell,
-          n_input, n_output, GetTensorData<int8_t>(output_state),
+          integer_lstm_param->projection_effective_bias.get(),
+          input_contributions_ptr != nullptr
+              ? input_contributions_ptr + t_rel * n_batch * n_cell
+              : nullptr,
+          input_contributions_gate_stride, n_batch, n_cell, n_input, n_output,
+          GetTensorData<int8_t>(output_state),
           output_state_zp, GetTensorData<int16_t>(cell_state), output_ptr,
           GetTensorData<int16_t>(scratch0), GetTensorData<int16_t>(scratch1),
           GetTensorData<int16_t>(scratch2), GetTensorData<int16_t>(scratch3),
@@ -2372,8 +2461,12 @@ TfLiteStatus EvalInteger8x8_16(
             integer_lstm_param->recurrent_to_output_effective_bias.get(),
             integer_lstm_param->input_to_input_effective_bias.get(),
             integer_lstm_param->recurrent_to_input_effective_bias.get(),
-            integer_lstm_param->projection_effective_bias.get(), /*n_batch=*/1,
-            n_cell, n_input, n_output, output_state_ptr, output_state_zp,
+            integer_lstm_param->projection_effective_bias.get(),
+            input_contributions_ptr != nullptr
+                ? input_contributions_ptr + time_offset * n_cell
+                : nullptr,
+            input_contributions_gate_stride, /*n_batch=*/1, n_cell, n_input,
+            n_output, output_state_ptr, output_state_zp,
             cell_state_ptr, output_ptr, GetTensorData<int16_t>(scratch0),
             GetTensorData<int16_t>(scratch1), GetTensorData<int16_t>(scratch2),
             GetTensorData<int16_t>(scratch3), GetTensorData<int8_t>(scratch4),
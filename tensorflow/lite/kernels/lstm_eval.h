@@ -169,6 +169,11 @@ TfLiteStatus EvalHybrid(
     TfLiteTensor* output_state_zp, TfLiteTensor* row_sums, int row_sums_size,
     bool* compute_row_sums, CpuBackendContext* context);
 
+// If 'input_contributions' is not null, the input_weight * input products of
+// all the time steps are computed before the time loop, into
+// 'input_contributions' of type int16 and size 4 * max_time * n_batch * n_cell,
+// using 'input_contributions_scratch' of type int32 and size
+// max_time * n_batch * n_cell.
 TfLiteStatus EvalInteger8x8_16(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -193,7 +198,8 @@ TfLiteStatus EvalInteger8x8_16(
     TfLiteTensor* output_state, TfLiteTensor* cell_state, TfLiteTensor* output,
     TfLiteTensor* scratch0, TfLiteTensor* scratch1, TfLiteTensor* scratch2,
     TfLiteTensor* scratch3, TfLiteTensor* scratch4, TfLiteTensor* scratch5,
-    CpuBackendContext* context);
+    TfLiteTensor* input_contributions,
+    TfLiteTensor* input_contributions_scratch, CpuBackendContext* context);
 
 TfLiteStatus EvalInteger8x8_8(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
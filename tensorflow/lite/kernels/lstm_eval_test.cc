@@ -493,6 +493,20 @@ class QuantizedLstmParam : public BaseLstmParam {
     scratch5_tensor_.data.i32 = scratch5_.data();
     return &scratch5_tensor_;
   }
+  TfLiteTensor* GetInputContributions() {
+    PackWeightToTensor(&input_contributions_tensor_, input_contributions_,
+                       input_contributions_size_);
+    input_contributions_tensor_.data.i16 = input_contributions_.data();
+    return &input_contributions_tensor_;
+  }
+  TfLiteTensor* GetInputContributionsScratch() {
+    PackWeightToTensor(&input_contributions_scratch_tensor_,
+                       input_contributions_scratch_,
+                       input_contributions_scratch_size_);
+    input_contributions_scratch_tensor_.data.i32 =
+        input_contributions_scratch_.data();
+    return &input_contributions_scratch_tensor_;
+  }
   TfLiteTensor* GetActivation() {
     PackWeightToTensor(&activation_tensor_, activation_, activation_size_);
     activation_tensor_.data.int8 = activation_.data();
@@ -516,6 +530,8 @@ class QuantizedLstmParam : public BaseLstmParam {
     TfLiteIntArrayFree(scratch3_tensor_.dims);
     TfLiteIntArrayFree(scratch4_tensor_.dims);
     TfLiteIntArrayFree(scratch5_tensor_.dims);
+    TfLiteIntArrayFree(input_contributions_tensor_.dims);
+    TfLiteIntArrayFree(input_contributions_scratch_tensor_.dims);
   }
 
  private:
@@ -599,9 +615,17 @@ class QuantizedLstmParam : public BaseLstmParam {
   std::vector<int32_t> scratch5_;
   std::vector<int32_t> scratch5_size_ = {n_batch_, n_cell_};
   TfLiteTensor scratch5_tensor_;
+
+  // Buffers for the precomputed input contributions.
+  std::vector<int16_t> input_contributions_;
+  std::vector<int32_t> input_contributions_size_ = {4 * n_batch_, n_cell_};
+  TfLiteTensor input_contributions_tensor_ = {};
+  std::vector<int32_t> input_contributions_scratch_;
+  std::vector<int32_t> input_contributions_scratch_size_ = {n_batch_, n_cell_};
+  TfLiteTensor input_contributions_scratch_tensor_ = {};
 };
 
-void TestOneFullyQuantizedLSTM() {
+void TestOneFullyQuantizedLSTM(bool precompute_input_contributions) {
   CpuBackendContext context;
   QuantizedLstmParam one_parameter;
   auto activation = one_parameter.GetActivation();
@@ -621,7 +645,13 @@ void TestOneFullyQuantizedLSTM() {
       /*time_major=*/true, param, activation, cell, output,
       one_parameter.GetScratch0(), one_parameter.GetScratch1(),
       one_parameter.GetScratch2(), one_parameter.GetScratch3(),
-      one_parameter.GetScratch4(), one_parameter.GetScratch5(), &context);
+      one_parameter.GetScratch4(), one_parameter.GetScratch5(),
+      precompute_input_contributions ? one_parameter.GetInputContributions()
+                                     : nullptr,
+      precompute_input_contributions
+          ? one_parameter.GetInputContributionsScratch()
+          : nullptr,
+      &context);
 
   // Verify results.
   const std::vector<int16_t> expected_cell = {
@@ -636,7 +666,11 @@ void TestOneFullyQuantizedLSTM() {
 }
 
 TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTM) {
-  TestOneFullyQuantizedLSTM();
+  TestOneFullyQuantizedLSTM(/*precompute_input_contributions=*/false);
+}
+
+TEST(TestOneFullyQuantizedLSTM, PrecomputedInputContributions) {
+  TestOneFullyQuantizedLSTM(/*precompute_input_contributions=*/true);
 }
 
 class HybridLstmParam : public BaseLstmParam {
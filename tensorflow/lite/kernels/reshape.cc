@@ -167,7 +167,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     output->bytes = bytes_required;
   }
 
-  memcpy(output->data.raw, input->data.raw, input->bytes);
+  // The memory planner may have placed the output in the buffer of the input.
+  if (output->data.raw != input->data.raw) {
+    memcpy(output->data.raw, input->data.raw, input->bytes);
+  }
 
   return kTfLiteOk;
 }
@@ -0,0 +1,114 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/shared_constant_tensors.h"
+
+#include <cstdint>
+
+namespace tflite {
+namespace {
+
+template <typename T>
+void AppendBytes(const T& value, std::string* key) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}  // namespace
+
+SharedConstantTensors* SharedConstantTensors::Global() {
+  static SharedConstantTensors* shared = new SharedConstantTensors;
+  return shared;
+}
+
+std::string SharedConstantTensors::Key(const TfLiteTensor& source,
+                                       TfLiteType type, size_t num_bytes) {
+  std::string key;
+  AppendBytes(source.data.raw_const, &key);
+  AppendBytes(source.bytes, &key);
+  AppendBytes(source.type, &key);
+  AppendBytes(type, &key);
+  AppendBytes(num_bytes, &key);
+  if (source.dims != nullptr) {
+    for (int i = 0; i < source.dims->size; ++i) {
+      AppendBytes(source.dims->data[i], &key);
+    }
+  }
+  // Tensors that share a buffer of the model may still have different
+  // quantization parameters.
+  AppendBytes(source.params.scale, &key);
+  AppendBytes(source.params.zero_point, &key);
+  if (source.quantization.type == kTfLiteAffineQuantization) {
+    const auto* params = reinterpret_cast<const TfLiteAffineQuantization*>(
+        source.quantization.params);
+    if (params != nullptr) {
+      AppendBytes(params->quantized_dimension, &key);
+      if (params->scale != nullptr) {
+        for (int i = 0; i < params->scale->size; ++i) {
+          AppendBytes(params->scale->data[i], &key);
+        }
+      }
+      if (params->zero_point != nullptr) {
+        for (int i = 0; i < params->zero_point->size; ++i) {
+          AppendBytes(params->zero_point->data[i], &key);
+        }
+      }
+    }
+  }
+  return key;
+}
+
+TfLiteStatus SharedConstantTensors::Get(
+    const TfLiteTensor& source, TfLiteType type, size_t num_bytes,
+    const std::function<TfLiteStatus(char*)>& fill,
+    std::shared_ptr<char>* buffer) {
+  const std::string key = Key(source, type, num_bytes);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = buffers_.find(key);
+    if (it != buffers_.end()) {
+      *buffer = it->second.lock();
+      if (*buffer != nullptr) return kTfLiteOk;
+    }
+  }
+
+  // Computes the buffer without holding the lock, since it may take a while
+  // for large tensors.  If several interpreters race to compute the same
+  // buffer, the first one to finish is shared.
+  char* raw = new char[num_bytes + kAlignment - 1];
+  char* aligned = reinterpret_cast<char*>(
+      (reinterpret_cast<std::uintptr_t>(raw) + kAlignment - 1) &
+      ~static_cast<std::uintptr_t>(kAlignment - 1));
+  std::shared_ptr<char> computed(aligned, [raw](char*) { delete[] raw; });
+  TfLiteStatus status = fill(aligned);
+  if (status != kTfLiteOk) return status;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::weak_ptr<char>& entry = buffers_[key];
+  *buffer = entry.lock();
+  if (*buffer == nullptr) {
+    entry = computed;
+    *buffer = std::move(computed);
+  }
+  // Forget the buffers that were freed since.
+  for (auto it = buffers_.begin(); it != buffers_.end();) {
+    if (it->second.expired()) {
+      it = buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,70 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_TENSORS_H_
+#define TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_TENSORS_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// Shares the buffers of the tensors that kernels compute once from constant
+// tensors, e.g. dequantized or densified weights, between all the
+// interpreters of a process.
+//
+// The constant tensors of the interpreters built from the same
+// FlatBufferModel all point into the buffer of the model, but the tensors
+// computed from them are allocated by every interpreter, and are often larger
+// than the constant tensors themselves.  Servers that run one interpreter of
+// a model per thread would otherwise hold one copy of them per interpreter.
+//
+// Buffers are identified by the data pointer, shape, type and quantization
+// parameters of the constant tensor they are computed from, so they are only
+// shared by interpreters built from the same model.  Shared buffers are
+// read-only once computed.
+class SharedConstantTensors {
+ public:
+  // Buffers are aligned like the tensors allocated by the arena planner.
+  static constexpr size_t kAlignment = 64;
+
+  // Returns the process-wide instance.
+  static SharedConstantTensors* Global();
+
+  // Sets `*buffer` to the `num_bytes` bytes buffer of a tensor of type `type`
+  // computed from the constant tensor `source`.  If no live buffer was
+  // computed from `source` yet, allocates one and calls `fill` to compute its
+  // contents, and only shares it if `fill` succeeds.  The buffer is freed once
+  // all the pointers to it are released.
+  TfLiteStatus Get(const TfLiteTensor& source, TfLiteType type,
+                   size_t num_bytes,
+                   const std::function<TfLiteStatus(char*)>& fill,
+                   std::shared_ptr<char>* buffer);
+
+ private:
+  static std::string Key(const TfLiteTensor& source, TfLiteType type,
+                         size_t num_bytes);
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<char>> buffers_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_SHARED_CONSTANT_TENSORS_H_
@@ -0,0 +1,131 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/shared_constant_tensors.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace {
+
+// Returns a constant int8 tensor of `num_elements` elements.
+TfLiteTensor ConstantTensor(const int8_t* data, int num_elements,
+                            float scale) {
+  TfLiteTensor tensor;
+  std::memset(&tensor, 0, sizeof(tensor));
+  tensor.type = kTfLiteInt8;
+  tensor.allocation_type = kTfLiteMmapRo;
+  tensor.data.raw_const = reinterpret_cast<const char*>(data);
+  tensor.bytes = num_elements;
+  tensor.params.scale = scale;
+  return tensor;
+}
+
+TfLiteStatus Dequantize(const TfLiteTensor& source, char* buffer,
+                        int* num_calls) {
+  ++*num_calls;
+  float* values = reinterpret_cast<float*>(buffer);
+  for (int i = 0; i < source.bytes; ++i) {
+    values[i] = source.data.int8[i] * source.params.scale;
+  }
+  return kTfLiteOk;
+}
+
+TEST(SharedConstantTensorsTest, SharesBuffers) {
+  const int8_t data[] = {1, 2, 3, 4};
+  TfLiteTensor source = ConstantTensor(data, 4, 0.5f);
+  SharedConstantTensors shared;
+  int num_calls = 0;
+  auto fill = [&](char* buffer) {
+    return Dequantize(source, buffer, &num_calls);
+  };
+
+  std::shared_ptr<char> first;
+  ASSERT_EQ(kTfLiteOk, shared.Get(source, kTfLiteFloat32, 4 * sizeof(float),
+                                  fill, &first));
+  EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(first.get()) %
+                   SharedConstantTensors::kAlignment);
+  EXPECT_EQ(2.f, reinterpret_cast<float*>(first.get())[3]);
+
+  std::shared_ptr<char> second;
+  ASSERT_EQ(kTfLiteOk, shared.Get(source, kTfLiteFloat32, 4 * sizeof(float),
+                                  fill, &second));
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(1, num_calls);
+
+  // Released buffers are computed again.
+  first.reset();
+  second.reset();
+  ASSERT_EQ(kTfLiteOk, shared.Get(source, kTfLiteFloat32, 4 * sizeof(float),
+                                  fill, &first));
+  EXPECT_EQ(2, num_calls);
+}
+
+TEST(SharedConstantTensorsTest, DifferentQuantizationParams) {
+  const int8_t data[] = {1, 2, 3, 4};
+  TfLiteTensor source = ConstantTensor(data, 4, 0.5f);
+  TfLiteTensor other_source = ConstantTensor(data, 4, 2.f);
+  SharedConstantTensors shared;
+  int num_calls = 0;
+
+  std::shared_ptr<char> first;
+  ASSERT_EQ(kTfLiteOk,
+            shared.Get(
+                source, kTfLiteFloat32, 4 * sizeof(float),
+                [&](char* buffer) {
+                  return Dequantize(source, buffer, &num_calls);
+                },
+                &first));
+  std::shared_ptr<char> second;
+  ASSERT_EQ(kTfLiteOk,
+            shared.Get(
+                other_source, kTfLiteFloat32, 4 * sizeof(float),
+                [&](char* buffer) {
+                  return Dequantize(other_source, buffer, &num_calls);
+                },
+                &second));
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_EQ(2, num_calls);
+  EXPECT_EQ(2.f, reinterpret_cast<float*>(first.get())[3]);
+  EXPECT_EQ(8.f, reinterpret_cast<float*>(second.get())[3]);
+}
+
+TEST(SharedConstantTensorsTest, FailedFillIsNotShared) {
+  const int8_t data[] = {1, 2, 3, 4};
+  TfLiteTensor source = ConstantTensor(data, 4, 0.5f);
+  SharedConstantTensors shared;
+
+  std::shared_ptr<char> buffer;
+  EXPECT_EQ(kTfLiteError,
+            shared.Get(
+                source, kTfLiteFloat32, 4 * sizeof(float),
+                [](char* buffer) { return kTfLiteError; }, &buffer));
+  EXPECT_EQ(nullptr, buffer);
+  int num_calls = 0;
+  ASSERT_EQ(kTfLiteOk,
+            shared.Get(
+                source, kTfLiteFloat32, 4 * sizeof(float),
+                [&](char* buffer) {
+                  return Dequantize(source, buffer, &num_calls);
+                },
+                &buffer));
+  EXPECT_EQ(1, num_calls);
+}
+
+}  // namespace
+}  // namespace tflite
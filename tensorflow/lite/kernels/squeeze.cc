@@ -91,8 +91,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   }
 
   TF_LITE_ENSURE_EQ(context, op_context.input->bytes, op_context.output->bytes);
-  memcpy(op_context.output->data.raw, op_context.input->data.raw,
-         op_context.input->bytes);
+  // The memory planner may have placed the output in the buffer of the input.
+  if (op_context.output->data.raw != op_context.input->data.raw) {
+    memcpy(op_context.output->data.raw, op_context.input->data.raw,
+           op_context.input->bytes);
+  }
   return kTfLiteOk;
 }
 
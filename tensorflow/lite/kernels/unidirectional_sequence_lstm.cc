@@ -882,6 +882,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       reinterpret_cast<TfLiteUnidirectionalSequenceLSTMParams*>(
           node->builtin_data);
   const bool time_major = params->time_major;
+  const int max_time = time_major ? input->dims->data[0] : input->dims->data[1];
   const int n_batch = time_major ? input->dims->data[1] : input->dims->data[0];
   const int n_input = input->dims->data[2];
 
@@ -942,7 +943,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   if (IsHybridOp(input, input_to_output_weights)) {
     node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors);
   } else if (is_integer) {
-    node->temporaries = TfLiteIntArrayCreate(6);
+    node->temporaries = TfLiteIntArrayCreate(max_time > 1 ? 8 : 6);
   } else {
     node->temporaries = TfLiteIntArrayCreate(1);
   }
@@ -1194,6 +1195,35 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       }
     }
 
+    // With more than one time step, the input_weight * input products of all
+    // the steps are computed before the time loop. This needs one 16bit buffer
+    // with size 4 * max_time * n_batch * n_cell for the products of the 4
+    // gates, and one 32bit buffer with size max_time * n_batch * n_cell.
+    if (max_time > 1) {
+      for (int scratch_index = 6; scratch_index < 8; ++scratch_index) {
+        node->temporaries->data[scratch_index] =
+            op_data->scratch_tensor_index + scratch_index;
+        TfLiteTensor* scratch_tensor;
+        TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                                    scratch_index,
+                                                    &scratch_tensor));
+        const bool is_contributions = scratch_index == 6;
+        scratch_tensor->type = is_contributions ? kTfLiteInt16 : kTfLiteInt32;
+        scratch_tensor->allocation_type = kTfLiteArenaRw;
+        const int scratch_dimension[2] = {
+            (is_contributions ? 4 : 1) * max_time * n_batch, n_cell};
+        if (!TfLiteIntArrayEqualsArray(scratch_tensor->dims, 2,
+                                       scratch_dimension)) {
+          TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
+          scratch_buffer_size->data[0] = scratch_dimension[0];
+          scratch_buffer_size->data[1] = scratch_dimension[1];
+          TF_LITE_ENSURE_OK(context,
+                            context->ResizeTensor(context, scratch_tensor,
+                                                  scratch_buffer_size));
+        }
+      }
+    }
+
     // Populate precomputed zp * weight.
     TF_LITE_ENSURE_OK(context, PopulatePrecomputedZPTimesWeightsWithBias(
                                    context, op_data, node));
@@ -1413,6 +1443,15 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         TfLiteTensor* scratch5;
         TF_LITE_ENSURE_OK(context,
                           GetTemporarySafe(context, node, 5, &scratch5));
+        TfLiteTensor* input_contributions = nullptr;
+        TfLiteTensor* input_contributions_scratch = nullptr;
+        if (node->temporaries->size == 8) {
+          TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, 6,
+                                                      &input_contributions));
+          TF_LITE_ENSURE_OK(
+              context,
+              GetTemporarySafe(context, node, 7, &input_contributions_scratch));
+        }
         return lstm_eval::EvalInteger8x8_16(
             input, input_to_input_weights, input_to_forget_weights,
             input_to_cell_weights, input_to_output_weights,
@@ -1426,6 +1465,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             projection_bias, &lstm_params, /*forward_sequence=*/true,
             time_major, &op_data->integer_lstm_param, output_state, cell_state,
             output, scratch0, scratch1, scratch2, scratch3, scratch4, scratch5,
+            input_contributions, input_contributions_scratch,
             CpuBackendContext::GetFromContext(context));
       }
     }
@@ -1077,6 +1077,17 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
   TF_LITE_ENSURE_STATUS(CreatePlan(error_reporter_, &planner, allocation_info,
                                    allocation_info_count));
 
+#ifdef TF_LITE_MICRO_VERIFY_OFFLINE_MEMORY_PLAN
+  // Offline planned offsets are used as is, so check that they don't overlap
+  // with each other or with the buffers planned at runtime.
+  if (offline_planner_offsets != nullptr &&
+      planner.DoAnyBuffersOverlap(error_reporter_)) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "The offline memory plan of the model is invalid.");
+    return kTfLiteError;
+  }
+#endif  // TF_LITE_MICRO_VERIFY_OFFLINE_MEMORY_PLAN
+
   // Reset all temp allocations used above:
   memory_allocator_->ResetTempAllocations();
 
@@ -105,6 +105,13 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  // Records the hardware counters read by |reader| for operator invocations.
+  // The reader must outlive the profiler.
+  void SetHardwareCounterReader(
+      const hardware_counters::HardwareCounterReader* reader) {
+    buffer_.SetHardwareCounterReader(reader);
+  }
+
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
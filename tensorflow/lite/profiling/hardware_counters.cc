@@ -0,0 +1,93 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace tflite {
+namespace profiling {
+namespace hardware_counters {
+
+namespace {
+
+#ifdef __linux__
+int OpenCounter(uint64_t config) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  // Count the events of the threads created after the counter as well.
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                 /*group_fd=*/-1, /*flags=*/0);
+}
+
+int64_t ReadCounter(int fd) {
+  uint64_t value = 0;
+  if (read(fd, &value, sizeof(value)) != sizeof(value)) return 0;
+  return static_cast<int64_t>(value);
+}
+
+void CloseCounter(int fd) {
+  if (fd >= 0) close(fd);
+}
+#endif
+
+}  // namespace
+
+HardwareCounterReader::HardwareCounterReader() {
+#ifdef __linux__
+  cycles_fd_ = OpenCounter(PERF_COUNT_HW_CPU_CYCLES);
+  instructions_fd_ = OpenCounter(PERF_COUNT_HW_INSTRUCTIONS);
+  llc_misses_fd_ = OpenCounter(PERF_COUNT_HW_CACHE_MISSES);
+#endif
+}
+
+HardwareCounterReader::~HardwareCounterReader() {
+#ifdef __linux__
+  CloseCounter(cycles_fd_);
+  CloseCounter(instructions_fd_);
+  CloseCounter(llc_misses_fd_);
+#endif
+}
+
+bool HardwareCounterReader::IsEnabled() const {
+  return cycles_fd_ >= 0 && instructions_fd_ >= 0 && llc_misses_fd_ >= 0;
+}
+
+HardwareCounters HardwareCounterReader::Read() const {
+  HardwareCounters result;
+#ifdef __linux__
+  if (IsEnabled()) {
+    result.cycles = ReadCounter(cycles_fd_);
+    result.instructions = ReadCounter(instructions_fd_);
+    result.llc_misses = ReadCounter(llc_misses_fd_);
+  }
+#endif
+  return result;
+}
+
+}  // namespace hardware_counters
+}  // namespace profiling
+}  // namespace tflite
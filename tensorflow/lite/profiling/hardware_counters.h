@@ -0,0 +1,83 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace profiling {
+namespace hardware_counters {
+
+// Values of the CPU hardware counters. All counts are 0 if the counters are
+// not supported.
+struct HardwareCounters {
+  // Number of CPU cycles.
+  int64_t cycles = 0;
+  // Number of retired instructions.
+  int64_t instructions = 0;
+  // Number of last-level cache misses, i.e. of cache lines transferred from or
+  // to memory.
+  int64_t llc_misses = 0;
+
+  HardwareCounters operator+(const HardwareCounters& obj) const {
+    HardwareCounters res;
+    res.cycles = cycles + obj.cycles;
+    res.instructions = instructions + obj.instructions;
+    res.llc_misses = llc_misses + obj.llc_misses;
+    return res;
+  }
+
+  HardwareCounters operator-(const HardwareCounters& obj) const {
+    HardwareCounters res;
+    res.cycles = cycles - obj.cycles;
+    res.instructions = instructions - obj.instructions;
+    res.llc_misses = llc_misses - obj.llc_misses;
+    return res;
+  }
+};
+
+// Reads the CPU hardware counters of the thread that created the reader, and
+// of the threads that it creates afterwards, e.g. the threads of the CPU
+// backend, in user space.
+// Note: this currently only works on Linux-based systems, through the
+// perf_event interface, and may be forbidden by the perf_event_paranoid
+// setting of the kernel.
+class HardwareCounterReader {
+ public:
+  HardwareCounterReader();
+  ~HardwareCounterReader();
+
+  // Returns whether all the counters could be opened.
+  bool IsEnabled() const;
+
+  // Returns the counts since the creation of the reader, or 0s if the reader
+  // is not enabled.
+  HardwareCounters Read() const;
+
+ private:
+  int cycles_fd_ = -1;
+  int instructions_fd_ = -1;
+  int llc_misses_fd_ = -1;
+
+  HardwareCounterReader(const HardwareCounterReader&) = delete;
+  HardwareCounterReader& operator=(const HardwareCounterReader&) = delete;
+};
+
+}  // namespace hardware_counters
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
@@ -0,0 +1,65 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace hardware_counters {
+
+TEST(HardwareCounters, AddAndSub) {
+  HardwareCounters counters1, counters2;
+  counters1.cycles = 500;
+  counters1.instructions = 700;
+  counters1.llc_misses = 20;
+
+  counters2.cycles = 300;
+  counters2.instructions = 700;
+  counters2.llc_misses = 40;
+
+  const auto add_counters = counters1 + counters2;
+  EXPECT_EQ(800, add_counters.cycles);
+  EXPECT_EQ(1400, add_counters.instructions);
+  EXPECT_EQ(60, add_counters.llc_misses);
+
+  const auto sub_counters = counters1 - counters2;
+  EXPECT_EQ(200, sub_counters.cycles);
+  EXPECT_EQ(0, sub_counters.instructions);
+  EXPECT_EQ(-20, sub_counters.llc_misses);
+}
+
+TEST(HardwareCounterReader, Read) {
+  HardwareCounterReader reader;
+  const HardwareCounters begin = reader.Read();
+  volatile int64_t sum = 0;
+  for (int i = 0; i < 100000; ++i) sum += i;
+  const HardwareCounters end = reader.Read();
+
+  if (!reader.IsEnabled()) {
+    // The counters are not available on this platform or to this process.
+    EXPECT_EQ(0, end.cycles);
+    EXPECT_EQ(0, end.instructions);
+    EXPECT_EQ(0, end.llc_misses);
+    return;
+  }
+  EXPECT_GT(end.instructions - begin.instructions, 100000);
+  EXPECT_GE(end.cycles, begin.cycles);
+  EXPECT_GE(end.llc_misses, begin.llc_misses);
+}
+
+}  // namespace hardware_counters
+}  // namespace profiling
+}  // namespace tflite
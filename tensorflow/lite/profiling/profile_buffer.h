@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 
@@ -48,6 +49,11 @@ struct ProfileEvent {
   // The memory usage when the event ends.
   memory::MemoryUsage end_mem_usage;
 
+  // The hardware counters when the event begins and ends. Only set for
+  // OPERATOR_INVOKE_EVENTs when the buffer has a hardware counter reader.
+  hardware_counters::HardwareCounters begin_hw_counters;
+  hardware_counters::HardwareCounters end_hw_counters;
+
   // The field containing the type of event. This must be one of the event types
   // in EventType.
   EventType event_type;
@@ -88,6 +94,10 @@ class ProfileBuffer {
     event_buffer_[index].end_timestamp_us = 0;
     if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
       event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
+    } else if (hw_counter_reader_ != nullptr) {
+      event_buffer_[index].begin_hw_counters = hw_counter_reader_->Read();
+      event_buffer_[index].end_hw_counters =
+          event_buffer_[index].begin_hw_counters;
     }
     current_index_++;
     return index;
@@ -96,6 +106,14 @@ class ProfileBuffer {
   // Sets the enabled state of buffer to |enabled|
   void SetEnabled(bool enabled) { enabled_ = enabled; }
 
+  // Sets the reader of the hardware counters recorded for operator invocation
+  // events, or stops recording them if |reader| is null. The reader must
+  // outlive the buffer.
+  void SetHardwareCounterReader(
+      const hardware_counters::HardwareCounterReader* reader) {
+    hw_counter_reader_ = reader;
+  }
+
   // Sets the end timestamp for event for the handle to current time.
   // If the buffer is disabled or previous event has been overwritten this
   // operation has not effect.
@@ -117,6 +135,8 @@ class ProfileBuffer {
     if (event_buffer_[event_index].event_type !=
         Profiler::EventType::OPERATOR_INVOKE_EVENT) {
       event_buffer_[event_index].end_mem_usage = memory::GetMemoryUsage();
+    } else if (hw_counter_reader_ != nullptr) {
+      event_buffer_[event_index].end_hw_counters = hw_counter_reader_->Read();
     }
     if (event_metadata1) {
       event_buffer_[event_index].event_metadata = *event_metadata1;
@@ -143,6 +163,8 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = start;
     event_buffer_[index].end_timestamp_us = end;
+    event_buffer_[index].begin_hw_counters = {};
+    event_buffer_[index].end_hw_counters = {};
     current_index_++;
   }
 
@@ -177,6 +199,7 @@ class ProfileBuffer {
   bool enabled_;
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
+  const hardware_counters::HardwareCounterReader* hw_counter_reader_ = nullptr;
 };
 
 }  // namespace profiling
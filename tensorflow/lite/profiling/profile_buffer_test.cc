@@ -117,6 +117,26 @@ TEST(ProfileBufferTest, Enable) {
   EXPECT_EQ(1, buffer.Size());
 }
 
+TEST(ProfileBufferTest, HardwareCounters) {
+  hardware_counters::HardwareCounterReader reader;
+  ProfileBuffer buffer(/*max_size*/ 10, /*enabled*/ true);
+  buffer.SetHardwareCounterReader(&reader);
+  auto event_handle = buffer.BeginEvent(
+      "hello", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT,
+      /*event_metadata1*/ 0, /*event_metadata2*/ 0);
+  volatile int64_t sum = 0;
+  for (int i = 0; i < 100000; ++i) sum += i;
+  buffer.EndEvent(event_handle);
+
+  auto event = buffer.At(0);
+  if (reader.IsEnabled()) {
+    EXPECT_GT(event->end_hw_counters.instructions,
+              event->begin_hw_counters.instructions);
+  } else {
+    EXPECT_EQ(0, event->end_hw_counters.instructions);
+  }
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
@@ -81,6 +81,11 @@ std::string MultiRunStatsRecorder::PerfOptionName(
     sstm << " (xnnpack)";
   }
 
+  if (params.HasParam("input_batch_size") &&
+      params.Get<int32_t>("input_batch_size") > 0) {
+    sstm << " batch " << params.Get<int32_t>("input_batch_size");
+  }
+
   return sstm.str();
 }
 
@@ -131,6 +136,7 @@ BenchmarkParams BenchmarkPerformanceOptions::DefaultParams() {
                   BenchmarkParam::Create<float>(-1.0f));
   params.AddParam("random_shuffle_benchmark_runs",
                   BenchmarkParam::Create<bool>(true));
+  params.AddParam("batch_sizes", BenchmarkParam::Create<std::string>(""));
   return params;
 }
 
@@ -149,6 +155,11 @@ std::vector<Flag> BenchmarkPerformanceOptions::GetFlags() {
           "random_shuffle_benchmark_runs", &params_,
           "Whether to perform all benchmark runs, each of which has different "
           "performance options, in a random order. It is enabled by default."),
+      CreateFlag<std::string>(
+          "batch_sizes", &params_,
+          "A comma-separated list of input batch sizes. If set, every "
+          "performance option is benchmarked with each of these batch sizes, "
+          "see the input_batch_size parameter of the model benchmark."),
   };
 }
 
@@ -164,7 +175,20 @@ bool BenchmarkPerformanceOptions::ParseFlags(int* argc, char** argv) {
 
   // Parse the value of --perf_options_list to find performance options to be
   // benchmarked.
-  return ParsePerfOptions();
+  return ParsePerfOptions() && ParseBatchSizes();
+}
+
+bool BenchmarkPerformanceOptions::ParseBatchSizes() {
+  const auto& batch_sizes = params_.Get<std::string>("batch_sizes");
+  if (!util::SplitAndParse(batch_sizes, ',', &batch_sizes_) ||
+      std::any_of(batch_sizes_.begin(), batch_sizes_.end(),
+                  [](int batch_size) { return batch_size <= 0; })) {
+    TFLITE_LOG(ERROR) << "Cannot parse --batch_sizes: '" << batch_sizes
+                      << "'. Please double-check its value.";
+    batch_sizes_.clear();
+    return false;
+  }
+  return true;
 }
 
 bool BenchmarkPerformanceOptions::ParsePerfOptions() {
@@ -324,8 +348,24 @@ void BenchmarkPerformanceOptions::CreatePerformanceOptions() {
 #endif
 }
 
+void BenchmarkPerformanceOptions::AddBatchSizesToRuns() {
+  if (batch_sizes_.empty()) return;
+  std::vector<BenchmarkParams> perf_options_params;
+  perf_options_params.swap(all_run_params_);
+  for (const auto& perf_option_params : perf_options_params) {
+    for (const int batch_size : batch_sizes_) {
+      BenchmarkParams params;
+      params.Merge(perf_option_params);
+      params.AddParam("input_batch_size",
+                      BenchmarkParam::Create<int32_t>(batch_size));
+      all_run_params_.emplace_back(std::move(params));
+    }
+  }
+}
+
 void BenchmarkPerformanceOptions::Run() {
   CreatePerformanceOptions();
+  AddBatchSizesToRuns();
 
   if (params_.Get<bool>("random_shuffle_benchmark_runs")) {
     std::random_shuffle(all_run_params_.begin(), all_run_params_.end());
@@ -339,13 +379,13 @@ void BenchmarkPerformanceOptions::Run() {
 
   // Now perform all runs, each with different performance-affecting parameters.
   for (const auto& run_params : all_run_params_) {
-    // If the run_params is empty, then it means "none" is set for
-    // --perf_options_list.
-    if (!run_params.Empty()) {
+    // If "none" is set for --perf_options_list, the run_params only has the
+    // batch size if --batch_sizes is set, and is empty otherwise.
+    if (!HasOption("none")) {
       // Reset all performance-related options before any runs.
       ResetPerformanceOptions();
-      single_option_run_params_->Set(run_params);
     }
+    single_option_run_params_->Set(run_params);
     util::SleepForSeconds(params_.Get<float>("option_benchmark_run_delay"));
 
     // Clear internally created listeners before each run but keep externally
@@ -107,8 +107,14 @@ class BenchmarkPerformanceOptions {
   virtual void ResetPerformanceOptions();
   virtual void CreatePerformanceOptions();
 
+  bool ParseBatchSizes();
+  // Replaces each run of all_run_params_ with one run per batch size of
+  // --batch_sizes.
+  void AddBatchSizesToRuns();
+
   BenchmarkParams params_;
   std::vector<std::string> perf_options_;
+  std::vector<int> batch_sizes_;
 
   // The object that drives a single-performance-option run.
   BenchmarkModel* const single_option_run_;          // Doesn't own the memory.
@@ -244,6 +244,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("input_layer_value_files",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("input_batch_size",
+                          BenchmarkParam::Create<int32_t>(0));
   default_params.AddParam("allow_fp16", BenchmarkParam::Create<bool>(false));
   default_params.AddParam("require_full_delegation",
                           BenchmarkParam::Create<bool>(false));
@@ -254,6 +256,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(1024));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("enable_op_hardware_counters",
+                          BenchmarkParam::Create<bool>(false));
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -305,6 +309,10 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "input_layer_value_range of the input_name will be ignored. The file "
           "format is binary and it should be array format or null separated "
           "strings format."),
+      CreateFlag<int32_t>(
+          "input_batch_size", &params_,
+          "If positive, the first (batch) dimension of every non-string input "
+          "is resized to this value, after applying input_layer_shape."),
       CreateFlag<bool>("allow_fp16", &params_, "allow fp16"),
       CreateFlag<bool>("require_full_delegation", &params_,
                        "require delegate to run the entire graph"),
@@ -314,7 +322,11 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<std::string>(
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
-          "prints to stdout.")};
+          "prints to stdout."),
+      CreateFlag<bool>(
+          "enable_op_hardware_counters", &params_,
+          "Also report the CPU hardware counters of each operator when op "
+          "profiling is enabled. Only supported on Linux.")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -339,6 +351,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Input value ranges", verbose);
   LOG_BENCHMARK_PARAM(std::string, "input_layer_value_files",
                       "Input value files", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "input_batch_size", "Input batch size",
+                      verbose);
 
   LOG_BENCHMARK_PARAM(bool, "allow_fp16", "Allow fp16", verbose);
   LOG_BENCHMARK_PARAM(bool, "require_full_delegation",
@@ -349,6 +363,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Max profiling buffer entries", verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(bool, "enable_op_hardware_counters",
+                      "Enable op hardware counters", verbose);
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -691,6 +707,17 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     }
   }
 
+  const int32_t batch_size = params_.Get<int32_t>("input_batch_size");
+  if (batch_size > 0) {
+    for (int i : interpreter_inputs) {
+      TfLiteTensor* t = interpreter_->tensor(i);
+      if (t->type == kTfLiteString || t->dims->size == 0) continue;
+      std::vector<int> shape(t->dims->data, t->dims->data + t->dims->size);
+      shape[0] = batch_size;
+      interpreter_->ResizeInputTensor(i, shape);
+    }
+  }
+
   if (interpreter_->AllocateTensors() != kTfLiteOk) {
     TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
     return kTfLiteError;
@@ -728,7 +755,8 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
       interpreter_.get(), params_.Get<int32_t>("max_profiling_buffer_entries"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()),
+      params_.Get<bool>("enable_op_hardware_counters")));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
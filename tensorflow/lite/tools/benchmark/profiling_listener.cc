@@ -16,16 +16,26 @@ limitations under the License.
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
 
 #include <fstream>
+#include <iomanip>
+#include <sstream>
 
 #include "tensorflow/lite/tools/logging.h"
 
 namespace tflite {
 namespace benchmark {
+namespace {
+
+// Size of the cache lines transferred on last-level cache misses, used to
+// estimate the memory traffic of operators.
+constexpr int64_t kCacheLineBytes = 64;
+
+}  // namespace
 
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_entries,
     const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    bool enable_hardware_counters)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
@@ -34,6 +44,18 @@ ProfilingListener::ProfilingListener(
   TFLITE_TOOLS_CHECK(interpreter);
   interpreter_->SetProfiler(&profiler_);
 
+  if (enable_hardware_counters) {
+    // The reader is created before the first run, so that the counters also
+    // cover the threads that the CPU backend creates lazily.
+    hw_counter_reader_.reset(
+        new profiling::hardware_counters::HardwareCounterReader());
+    if (!hw_counter_reader_->IsEnabled()) {
+      TFLITE_LOG(WARN) << "Hardware counters are not available, check the "
+                          "value of /proc/sys/kernel/perf_event_paranoid.";
+      hw_counter_reader_.reset();
+    }
+  }
+
   // We start profiling here in order to catch events that are recorded during
   // the benchmark run preparation stage where TFLite interpreter is
   // initialized and model graph is prepared.
@@ -54,6 +76,7 @@ void ProfilingListener::OnBenchmarkStart(const BenchmarkParams& params) {
 void ProfilingListener::OnSingleRunStart(RunType run_type) {
   if (run_type == REGULAR) {
     profiler_.Reset();
+    profiler_.SetHardwareCounterReader(hw_counter_reader_.get());
     profiler_.StartProfiling();
   }
 }
@@ -62,6 +85,58 @@ void ProfilingListener::OnSingleRunEnd() {
   profiler_.StopProfiling();
   auto profile_events = profiler_.GetProfileEvents();
   run_summarizer_.ProcessProfiles(profile_events, *interpreter_);
+  if (hw_counter_reader_) ProcessHardwareCounters(profile_events);
+}
+
+void ProfilingListener::ProcessHardwareCounters(
+    const std::vector<const profiling::ProfileEvent*>& profile_events) {
+  for (const auto* event : profile_events) {
+    if (event->event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT ||
+        event->end_timestamp_us < event->begin_timestamp_us) {
+      continue;
+    }
+    auto& op_counters = operator_counters_[{event->extra_event_metadata,
+                                            event->event_metadata}];
+    op_counters.op_name = event->tag;
+    op_counters.num_invocations++;
+    op_counters.counters = op_counters.counters + (event->end_hw_counters -
+                                                   event->begin_hw_counters);
+  }
+}
+
+std::string ProfilingListener::GetHardwareCountersString() const {
+  // Besides the raw counters, report where each operator sits on a roofline
+  // whose operational intensity is counted in instructions per byte of memory
+  // traffic: operators with a low intensity and a high bandwidth are memory
+  // bound, while those with a high intensity are compute bound.
+  std::stringstream stream;
+  stream << std::setw(16) << "[subgraph:node]" << std::setw(24) << "[op]"
+         << std::setw(16) << "[avg cycles]" << std::setw(16) << "[avg instrs]"
+         << std::setw(8) << "[IPC]" << std::setw(16) << "[avg LLC misses]"
+         << std::setw(16) << "[avg mem bytes]" << std::setw(14)
+         << "[instrs/byte]" << std::setw(14) << "[bytes/cycle]" << std::endl;
+  for (const auto& entry : operator_counters_) {
+    const OperatorCounters& op_counters = entry.second;
+    const int64_t n = op_counters.num_invocations;
+    const int64_t cycles = op_counters.counters.cycles / n;
+    const int64_t instructions = op_counters.counters.instructions / n;
+    const int64_t llc_misses = op_counters.counters.llc_misses / n;
+    const int64_t mem_bytes = llc_misses * kCacheLineBytes;
+    const std::string node = std::to_string(entry.first.first) + ":" +
+                             std::to_string(entry.first.second);
+    stream << std::setw(16) << node << std::setw(24) << op_counters.op_name
+           << std::setw(16) << cycles << std::setw(16) << instructions
+           << std::fixed << std::setprecision(3) << std::setw(8)
+           << (cycles > 0 ? static_cast<double>(instructions) / cycles : 0.0)
+           << std::setw(16) << llc_misses << std::setw(16) << mem_bytes
+           << std::setw(14)
+           << (mem_bytes > 0 ? static_cast<double>(instructions) / mem_bytes
+                             : 0.0)
+           << std::setw(14)
+           << (cycles > 0 ? static_cast<double>(mem_bytes) / cycles : 0.0)
+           << std::endl;
+  }
+  return stream.str();
 }
 
 void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
@@ -80,6 +155,11 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                 run_summarizer_.GetOutputString(),
                 output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
   }
+  if (!operator_counters_.empty()) {
+    WriteOutput("Operator-wise Hardware Counters for Regular Benchmark Runs:",
+                GetHardwareCountersString(),
+                output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
+  }
 }
 
 void ProfilingListener::WriteOutput(const std::string& header,
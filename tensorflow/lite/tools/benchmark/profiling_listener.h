@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_PROFILING_LISTENER_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_PROFILING_LISTENER_H_
 
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
 
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -27,13 +31,16 @@ namespace tflite {
 namespace benchmark {
 
 // Dumps profiling events if profiling is enabled.
+// If 'enable_hardware_counters' is set, the CPU hardware counters of each
+// operator are also collected in regular runs, when the platform supports it.
 class ProfilingListener : public BenchmarkListener {
  public:
   ProfilingListener(
       Interpreter* interpreter, uint32_t max_num_entries,
       const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      bool enable_hardware_counters = false);
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -49,10 +56,25 @@ class ProfilingListener : public BenchmarkListener {
   std::string csv_file_path_;
 
  private:
+  // Hardware counters of an operator, summed over regular runs.
+  struct OperatorCounters {
+    std::string op_name;
+    int64_t num_invocations = 0;
+    profiling::hardware_counters::HardwareCounters counters;
+  };
+
   void WriteOutput(const std::string& header, const string& data,
                    std::ostream* stream);
+  void ProcessHardwareCounters(
+      const std::vector<const profiling::ProfileEvent*>& profile_events);
+  std::string GetHardwareCountersString() const;
+
   Interpreter* interpreter_;
   profiling::BufferedProfiler profiler_;
+  std::unique_ptr<profiling::hardware_counters::HardwareCounterReader>
+      hw_counter_reader_;
+  // Keyed by subgraph and node indices.
+  std::map<std::pair<int64_t, int64_t>, OperatorCounters> operator_counters_;
 };
 
 }  // namespace benchmark
@@ -29,6 +29,7 @@ import copy
 import os
 import random
 import re
+import struct
 
 import flatbuffers
 from tensorflow.lite.python import schema_py_generated as schema_fb
@@ -36,6 +37,25 @@ from tensorflow.python.platform import gfile
 
 _TFLITE_FILE_IDENTIFIER = b'TFL3'
 
+# Name of the model metadata read by the TFLite Micro MicroAllocator.
+_OFFLINE_MEMORY_ALLOCATION_METADATA = 'OfflineMemoryAllocation'
+
+# Alignment of the tensor buffers planned by the TFLite Micro MicroAllocator.
+_MICRO_BUFFER_ALIGNMENT = 16
+
+_TENSOR_TYPE_BYTES = {
+    schema_fb.TensorType.FLOAT32: 4,
+    schema_fb.TensorType.FLOAT16: 2,
+    schema_fb.TensorType.FLOAT64: 8,
+    schema_fb.TensorType.INT32: 4,
+    schema_fb.TensorType.UINT8: 1,
+    schema_fb.TensorType.INT64: 8,
+    schema_fb.TensorType.BOOL: 1,
+    schema_fb.TensorType.INT16: 2,
+    schema_fb.TensorType.COMPLEX64: 8,
+    schema_fb.TensorType.INT8: 1,
+}
+
 
 def convert_bytearray_to_object(model_bytearray):
   """Converts a tflite model from a bytearray to an object for parsing."""
@@ -159,6 +179,104 @@ def randomize_weights(model, random_seed=0):
       buffer_i_data[j] = random.randint(0, 255)
 
 
+def add_offline_memory_plan(model):
+  """Plans the TFLite Micro tensor arena of the model ahead of time.
+
+  Places the non-constant tensors of the first subgraph in the arena with the
+  same greedy algorithm as the TFLite Micro GreedyMemoryPlanner, and stores
+  their offsets in the 'OfflineMemoryAllocation' metadata, which the
+  MicroAllocator then applies instead of planning these tensors at startup.
+  Scratch buffers requested by kernels are still planned at startup, in the
+  gaps of the offline plan.
+
+  Args:
+    model: The model to which to add the memory plan. An existing plan is
+      replaced.
+
+  Raises:
+    ValueError: If a tensor to plan has a type that TFLite Micro does not
+      support.
+
+  Returns:
+    The size in bytes of the planned part of the arena.
+  """
+  subgraph = model.subgraphs[0]
+  tensors = subgraph.tensors
+  operators = subgraph.operators or []
+
+  # Find the lifetime of each tensor the same way as the MicroAllocator.
+  first_created = [-1] * len(tensors)
+  last_used = [-1] * len(tensors)
+  for i in subgraph.inputs:
+    first_created[i] = 0
+  for i in subgraph.outputs:
+    last_used[i] = len(operators) - 1
+  for op_index, op in reversed(list(enumerate(operators))):
+    for i in op.inputs:
+      if i >= 0 and last_used[i] < op_index:
+        last_used[i] = op_index
+    for i in op.outputs:
+      if first_created[i] == -1 or first_created[i] > op_index:
+        first_created[i] = op_index
+
+  # Constant and variable tensors are not planned.
+  planned = []
+  for i, tensor in enumerate(tensors):
+    data = model.buffers[tensor.buffer].data
+    is_constant = data is not None and len(data) > 0
+    if is_constant or tensor.isVariable:
+      continue
+    if first_created[i] == -1 or last_used[i] == -1:
+      continue
+    if tensor.type not in _TENSOR_TYPE_BYTES:
+      raise ValueError('Tensor %d has an unsupported type %d' %
+                       (i, tensor.type))
+    num_elements = 1
+    for dim in tensor.shape if tensor.shape is not None else []:
+      num_elements *= dim
+    size = num_elements * _TENSOR_TYPE_BYTES[tensor.type]
+    size = ((size + _MICRO_BUFFER_ALIGNMENT - 1) // _MICRO_BUFFER_ALIGNMENT *
+            _MICRO_BUFFER_ALIGNMENT)
+    planned.append((size, i))
+
+  # Place the largest tensors first, each one in the first gap between the
+  # tensors it is simultaneously active with that is large enough.
+  offsets = [-1] * len(tensors)
+  placed = []
+  arena_size = 0
+  for size, i in sorted(planned, key=lambda entry: -entry[0]):
+    offset = 0
+    for other_offset, other_size, other in sorted(placed):
+      if (first_created[i] > last_used[other] or
+          first_created[other] > last_used[i]):
+        continue
+      if other_offset - offset >= size:
+        break
+      offset = max(offset, other_offset + other_size)
+    placed.append((offset, size, i))
+    offsets[i] = offset
+    arena_size = max(arena_size, offset + size)
+
+  # See GetOfflinePlannedOffsets in tensorflow/lite/micro/micro_allocator.cc
+  # for the format of the metadata.
+  plan = struct.pack('<%di' % (3 + len(offsets)), 0, 0, len(offsets),
+                     *offsets)
+  buffer = schema_fb.BufferT()
+  buffer.data = list(bytearray(plan))
+  metadata = None
+  for existing_metadata in model.metadata or []:
+    if existing_metadata.name in (_OFFLINE_MEMORY_ALLOCATION_METADATA,
+                                  _OFFLINE_MEMORY_ALLOCATION_METADATA.encode()):
+      metadata = existing_metadata
+  if metadata is None:
+    metadata = schema_fb.MetadataT()
+    metadata.name = _OFFLINE_MEMORY_ALLOCATION_METADATA
+    model.metadata = (model.metadata or []) + [metadata]
+  model.buffers.append(buffer)
+  metadata.buffer = len(model.buffers) - 1
+  return arena_size
+
+
 def xxd_output_to_bytes(input_cc_file):
   """Converts xxd output C++ source file to bytes (immutable).
 
@@ -19,6 +19,7 @@ from __future__ import print_function
 
 import copy
 import os
+import struct
 import subprocess
 
 from tensorflow.lite.tools import flatbuffer_utils
@@ -163,6 +164,40 @@ class RandomizeWeightsTest(test_util.TensorFlowTestCase):
       self.assertNotEqual(initial_buffer.data[j], final_buffer.data[j])
 
 
+class AddOfflineMemoryPlanTest(test_util.TensorFlowTestCase):
+
+  def testAddOfflineMemoryPlan(self):
+    # 1. SETUP
+    # Define the initial model
+    model = test_utils.build_mock_model()
+
+    # 2. INVOKE
+    # Invoke the add_offline_memory_plan function
+    arena_size = flatbuffer_utils.add_offline_memory_plan(model)
+
+    # 3. VALIDATE
+    # The input and output tensors of the single operator are both active at
+    # once, and need 40 bytes each, aligned to 16 bytes. The constant tensor is
+    # not planned.
+    self.assertEqual(96, arena_size)
+    self.assertLen(model.metadata, 1)
+    self.assertEqual(b'OfflineMemoryAllocation', model.metadata[0].name)
+    plan_buffer = model.buffers[model.metadata[0].buffer]
+    plan = struct.unpack('<6i', bytearray(plan_buffer.data))
+    self.assertEqual((0, 0, 3), plan[:3])
+    self.assertEqual(-1, plan[4])
+    self.assertCountEqual([0, 48], [plan[3], plan[5]])
+
+    # Planning again replaces the existing plan.
+    flatbuffer_utils.add_offline_memory_plan(model)
+    self.assertLen(model.metadata, 1)
+
+    # The plan is kept when the model is written.
+    model = flatbuffer_utils.convert_bytearray_to_object(
+        bytearray(flatbuffer_utils.convert_object_to_bytearray(model)))
+    self.assertEqual(b'OfflineMemoryAllocation', model.metadata[0].name)
+
+
 class XxdOutputToBytesTest(test_util.TensorFlowTestCase):
 
   def testXxdOutputToBytes(self):
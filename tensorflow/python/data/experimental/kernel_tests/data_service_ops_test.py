@@ -89,6 +89,24 @@ class DataServiceOpsTest(data_service_test_base.TestBase,
     self.assertAllEqual(results[1], [[0, 1, 2], [0, 1, 0]])
     self.assertAllEqual(results[2], [[0, 1, 2, 3, 4, 5, 6, 7]])
 
+  @combinations.generate(test_base.eager_only_combinations())
+  def testDistributeUncompressed(self):
+    cluster = self.create_cluster(num_workers=1)
+    num_elements = 10
+    ds = dataset_ops.Dataset.range(num_elements)
+    # String components can't be handed through shared memory and are sent
+    # over RPC.
+    ds = ds.map(lambda x: (x, string_ops.as_string(x)))
+    ds = ds.apply(
+        data_service_ops._distribute(  # pylint: disable=protected-access
+            "parallel_epochs",
+            cluster.target,
+            task_refresh_interval_hint_ms=20,
+            compression=None))
+    results = [(x.numpy(), y.numpy()) for x, y in ds]
+    self.assertEqual([(i, str(i).encode()) for i in range(num_elements)],
+                     results)
+
   @combinations.generate(test_base.eager_only_combinations())
   def testDifferentShuffleOrders(self):
     random_seed.set_random_seed(None)
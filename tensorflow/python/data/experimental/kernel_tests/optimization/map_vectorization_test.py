@@ -40,11 +40,13 @@ from tensorflow.python.ops import bitwise_ops
 from tensorflow.python.ops import check_ops
 from tensorflow.python.ops import clip_ops
 from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.ops import gen_string_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import nn
 from tensorflow.python.ops import parsing_ops
 from tensorflow.python.ops import script_ops
 from tensorflow.python.ops import special_math_ops
+from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 
 
@@ -189,6 +191,34 @@ def _binary_real_test_combinations():
 
 
 # TODO(rachelim): Consolidate tests with pfor when APIs are somewhat shared.
+def _string_test_combinations():
+  cases = [
+      ("AsString", lambda x: string_ops.as_string(string_ops.string_length(x))),
+      ("DecodeBase64",
+       lambda x: string_ops.decode_base64(string_ops.encode_base64(x))),
+      ("EncodeBase64", string_ops.encode_base64),
+      ("RegexFullMatch",
+       lambda x: gen_string_ops.regex_full_match(
+           x, constant_op.constant("a.*"))),
+      ("RegexReplace",
+       lambda x: gen_string_ops.regex_replace(
+           x, constant_op.constant("[aeiou]"), constant_op.constant("_"))),
+      ("StaticRegexFullMatch",
+       lambda x: gen_string_ops.static_regex_full_match(x, "a.*")),
+      ("StaticRegexReplace",
+       lambda x: gen_string_ops.static_regex_replace(x, "[aeiou]", "_")),
+      ("StringLength", string_ops.string_length),
+      ("StringLower", gen_string_ops.string_lower),
+      ("StringStrip", string_ops.string_strip),
+      ("StringToHashBucketFast",
+       lambda x: string_ops.string_to_hash_bucket_fast(x, 10)),
+      ("StringToHashBucketStrong",
+       lambda x: string_ops.string_to_hash_bucket_strong(x, 10, [1, 2])),
+      ("StringUpper", gen_string_ops.string_upper),
+  ]
+  return _generate_test_combinations(cases)
+
+
 class MapVectorizationTest(test_base.DatasetTestBase, parameterized.TestCase):
 
   def _enable_map_vectorization(self, dataset, use_choose=True):
@@ -393,6 +423,33 @@ class MapVectorizationTest(test_base.DatasetTestBase, parameterized.TestCase):
     dataset_factory = lambda: dataset_ops.Dataset.from_tensors((x, y))
     self._testOptimization(map_fn, dataset_factory, num_parallel_calls)
 
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         _string_test_combinations(),
+                         combinations.combine(num_parallel_calls=[None, 12])))
+  def testStringOperations(self, map_fn, num_parallel_calls):
+    x = [[" apple", "Banana "], ["cherry", "aubergine"], ["", "avocado"]]
+    dataset_factory = lambda: dataset_ops.Dataset.from_tensor_slices(x)
+    self._testOptimization(map_fn, dataset_factory, num_parallel_calls)
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(num_parallel_calls=[None, 12])))
+  def testStringToNumber(self, num_parallel_calls):
+    x = ["1.5", "2", "-3e2", "0"]
+    dataset_factory = lambda: dataset_ops.Dataset.from_tensor_slices(x)
+    map_fn = lambda x: string_ops.string_to_number(x, dtypes.float32)
+    self._testOptimization(map_fn, dataset_factory, num_parallel_calls)
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(num_parallel_calls=[None, 12])))
+  def testDecodeRaw(self, num_parallel_calls):
+    x = [np.arange(i, i + 4, dtype=np.int32).tobytes() for i in range(10)]
+    dataset_factory = lambda: dataset_ops.Dataset.from_tensor_slices(x)
+    map_fn = lambda x: parsing_ops.decode_raw(x, dtypes.int32)
+    self._testOptimization(map_fn, dataset_factory, num_parallel_calls)
+
   @combinations.generate(
       combinations.times(test_base.default_test_combinations(),
                          combinations.combine(num_parallel_calls=[None, 12])))
@@ -61,7 +61,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
                protocol,
                job_name=None,
                max_outstanding_requests=None,
-               task_refresh_interval_hint_ms=None):
+               task_refresh_interval_hint_ms=None,
+               element_spec=None):
     """Constructs a _DataServiceDatasetV2.
 
     Args:
@@ -83,6 +84,9 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         `element_size` * `max_outstanding_requests` of memory.
       task_refresh_interval_hint_ms: (Optional.) A hint for how often to query
         the dispatcher for task changes.
+      element_spec: (Optional.) The element spec of a dataset registered
+        without compression. Defaults to the scalar variant spec of compressed
+        elements.
     """
 
     if job_name is None:
@@ -106,9 +110,11 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         max_outstanding_requests,
         dtype=dtypes.int64,
         name="max_outstanding_requests")
-    # Datasets executed by the tf.data service produce compressed elements
-    # represented by scalar DT_VARIANTs.
-    self._element_spec = tensor_spec.TensorSpec(shape=(), dtype=dtypes.variant)
+    if element_spec is None:
+      # Datasets executed by the tf.data service produce compressed elements
+      # represented by scalar DT_VARIANTs.
+      element_spec = tensor_spec.TensorSpec(shape=(), dtype=dtypes.variant)
+    self._element_spec = element_spec
 
     variant_tensor = gen_experimental_dataset_ops.data_service_dataset(
         dataset_id=self._dataset_id,
@@ -133,7 +139,8 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
 
   @functools.wraps(_DataServiceDatasetV2.__init__)
   def __init__(self, dataset_id, processing_mode, address, protocol, job_name,
-               max_outstanding_requests, task_refresh_interval_hint_ms):
+               max_outstanding_requests, task_refresh_interval_hint_ms,
+               element_spec=None):
 
     self._wrapped = _DataServiceDatasetV2(
         dataset_id=dataset_id,
@@ -142,7 +149,8 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
         protocol=protocol,
         job_name=job_name,
         max_outstanding_requests=max_outstanding_requests,
-        task_refresh_interval_hint_ms=task_refresh_interval_hint_ms)
+        task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
+        element_spec=element_spec)
     super(_DataServiceDatasetV1, self).__init__(self._wrapped)
 
 
@@ -152,6 +160,13 @@ else:
   _DataServiceDataset = _DataServiceDatasetV1
 
 
+def _validate_compression(compression):
+  if compression not in ("AUTO", None):
+    raise ValueError(
+        "compression must be either 'AUTO' or None, but was {0}".format(
+            compression))
+
+
 def _parse_service(service):
   """Parses a tf.data service string into a (protocol, address) tuple.
 
@@ -185,7 +200,8 @@ def _from_dataset_id(processing_mode,
                      element_spec,
                      job_name=None,
                      max_outstanding_requests=None,
-                     task_refresh_interval_hint_ms=None):
+                     task_refresh_interval_hint_ms=None,
+                     compression="AUTO"):
   """Creates a dataset which reads data from the tf.data service.
 
   This transformation is similar to `from_dataset_id`, but supports additional
@@ -215,11 +231,15 @@ def _from_dataset_id(processing_mode,
       `max_outstanding_requests` of memory.
     task_refresh_interval_hint_ms: (Optional.) A hint for how often to query the
       dispatcher for task changes.
+    compression: (Optional.) How the dataset was registered, either "AUTO"
+      (compressed) or None (uncompressed). Must match the `compression` passed
+      to `_register_dataset`.
 
   Returns:
     A `tf.data.Dataset` which reads from the tf.data service.
   """
   ProcessingMode.validate(processing_mode)
+  _validate_compression(compression)
   if job_name is not None:
     if not isinstance(job_name, six.string_types):
       raise ValueError("job_name must be a string, but job_name was of type "
@@ -237,10 +257,12 @@ def _from_dataset_id(processing_mode,
       protocol=protocol,
       job_name=job_name,
       max_outstanding_requests=max_outstanding_requests,
-      task_refresh_interval_hint_ms=task_refresh_interval_hint_ms)
-  dataset = dataset.map(
-      lambda x: compression_ops.uncompress(x, output_spec=element_spec),
-      num_parallel_calls=dataset_ops.AUTOTUNE)
+      task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
+      element_spec=None if compression else element_spec)
+  if compression:
+    dataset = dataset.map(
+        lambda x: compression_ops.uncompress(x, output_spec=element_spec),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
 
   # Disable autosharding for shared jobs.
   if job_name:
@@ -254,7 +276,8 @@ def _distribute(processing_mode,
                 service,
                 job_name=None,
                 max_outstanding_requests=None,
-                task_refresh_interval_hint_ms=None):
+                task_refresh_interval_hint_ms=None,
+                compression="AUTO"):
   """A transformation that moves dataset processing to the tf.data service.
 
   This transformation is similar to `distribute`, but supports additional
@@ -278,14 +301,19 @@ def _distribute(processing_mode,
       `max_outstanding_requests` of memory.
     task_refresh_interval_hint_ms: (Optional.) A hint for how often to query the
       dispatcher for task changes.
+    compression: (Optional.) Either "AUTO" to compress elements before sending
+      them to the client, or None to send them uncompressed. Uncompressed
+      elements are read by clients on the same host as the worker through
+      shared memory when possible.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
   """
   ProcessingMode.validate(processing_mode)
+  _validate_compression(compression)
 
   def _apply_fn(dataset):  # pylint: disable=missing-docstring
-    dataset_id = register_dataset(service, dataset)
+    dataset_id = _register_dataset(service, dataset, compression=compression)
     return _from_dataset_id(
         processing_mode,
         service,
@@ -293,7 +321,8 @@ def _distribute(processing_mode,
         dataset.element_spec,
         job_name=job_name,
         max_outstanding_requests=max_outstanding_requests,
-        task_refresh_interval_hint_ms=task_refresh_interval_hint_ms)
+        task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
+        compression=compression)
 
   return _apply_fn
 
@@ -523,16 +552,38 @@ def register_dataset(service, dataset):
   Returns:
     A scalar int64 tensor of the registered dataset's id.
   """
+  return _register_dataset(service, dataset)
+
+
+def _register_dataset(service, dataset, compression="AUTO"):
+  """Registers a dataset with the tf.data service.
+
+  This is similar to `register_dataset`, but supports additional parameters
+  which we do not yet want to add to the public Python API.
+
+  Args:
+    service: A string indicating how to connect to the tf.data service. The
+      string should be in the format "protocol://address", e.g.
+      "grpc://localhost:5000".
+    dataset: A `tf.data.Dataset` to register with the tf.data service.
+    compression: (Optional.) Either "AUTO" to compress elements before sending
+      them to the client, or None to send them uncompressed.
+
+  Returns:
+    A scalar int64 tensor of the registered dataset's id.
+  """
+  _validate_compression(compression)
   protocol, address = _parse_service(service)
   external_state_policy = dataset.options().experimental_external_state_policy
   if external_state_policy is None:
     external_state_policy = ExternalStatePolicy.WARN
 
-  # Compress the dataset elements to reduce the amount of data that needs to
-  # be sent over the network.
-  dataset = dataset.map(
-      lambda *x: compression_ops.compress(x),
-      num_parallel_calls=dataset_ops.AUTOTUNE)
+  if compression:
+    # Compress the dataset elements to reduce the amount of data that needs to
+    # be sent over the network.
+    dataset = dataset.map(
+        lambda *x: compression_ops.compress(x),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
   # Apply options so that the dataset executed in the tf.data service will
   # be optimized and support autotuning.
@@ -1385,6 +1385,15 @@ class DatasetV2(collections_abc.Iterable, tracking_base.Trackable,
     >>> list(dataset.as_numpy_iterator())  # doctest: +SKIP
     [0, 1, 2, 3, 4]
 
+    If the filename contains `{fingerprint}`, it is replaced with a fingerprint
+    of the input pipeline, so that jobs running the same input pipeline share
+    the cache, and changing the pipeline starts a new cache. Such a cache can
+    be filled by several jobs at the same time: each job writes its own copy,
+    and the first job to finish publishes it atomically for all readers.
+
+    >>> dataset = tf.data.Dataset.range(5)
+    >>> dataset = dataset.cache("/path/to/dir/{fingerprint}")  # doctest: +SKIP
+
     Note: `cache` will produce exactly the same elements during each iteration
     through the dataset. If you wish to randomize the iteration order, make sure
     to call `shuffle` *after* calling `cache`.
@@ -35,7 +35,8 @@ int_dtypes = [
 ]
 float_dtypes = [np.float16, np.float32, np.float64]
 complex_dtypes = [np.complex64, np.complex128]
-dlpack_dtypes = int_dtypes + float_dtypes + [dtypes.bfloat16]
+dlpack_dtypes = (
+    int_dtypes + float_dtypes + complex_dtypes + [dtypes.bfloat16])
 
 testcase_shapes = [(), (1,), (2, 3), (2, 0), (0, 7), (4, 1, 2)]
 
@@ -98,14 +99,8 @@ class DLPackTest(parameterized.TestCase, test.TestCase):
       tf_tensor = constant_op.constant([[1, 4], [5, 2]], dtype=dtypes.qint16)
       _ = dlpack.to_dlpack(tf_tensor)
 
-    def UnsupportedComplex64():
-      tf_tensor = constant_op.constant([[1, 4], [5, 2]], dtype=dtypes.complex64)
-      _ = dlpack.to_dlpack(tf_tensor)
-
     self.assertRaisesRegex(Exception, ".* is not supported by dlpack",
                            UnsupportedQint16)
-    self.assertRaisesRegex(Exception, ".* is not supported by dlpack",
-                           UnsupportedComplex64)
 
   def testMustPassTensorArgumentToDLPack(self):
     with self.assertRaisesRegex(
@@ -1003,6 +1003,7 @@ class Context(object):
     rewriter_toggle("pin_to_host_optimization")
     rewriter_toggle("implementation_selector")
     rewriter_toggle("auto_mixed_precision")
+    rewriter_toggle("static_memory_planning")
     rewriter_bool("disable_meta_optimizer")
     nodes = self._optimizer_experimental_options.get("min_graph_nodes", None)
     if nodes is not None:
@@ -1580,6 +1581,7 @@ class Context(object):
     rewriter_toggle("pin_to_host_optimization")
     rewriter_toggle("implementation_selector")
     rewriter_toggle("auto_mixed_precision")
+    rewriter_toggle("static_memory_planning")
     rewriter_bool("disable_meta_optimizer")
 
     if rewrite_options.min_graph_nodes != 0:
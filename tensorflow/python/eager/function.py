@@ -2840,7 +2840,12 @@ def _convert_inputs_to_signature(inputs, input_signature, flat_input_signature):
         flat_sequence=flatten_inputs,
         expand_composites=True)
 
-  flat_inputs = nest.flatten(inputs, expand_composites=True)
+  # When every input is covered by the signature, `flatten_inputs` already is
+  # the flattened structure, so skip flattening it a second time.
+  if len(inputs) == len(input_signature):
+    flat_inputs = flatten_inputs
+  else:
+    flat_inputs = nest.flatten(inputs, expand_composites=True)
 
   return (inputs, flat_inputs, [
       t for t in flat_inputs
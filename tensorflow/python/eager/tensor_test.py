@@ -382,6 +382,19 @@ class TFETensorTest(test_util.TensorFlowTestCase):
     t._numpy()[0] = 42.0
     self.assertAllClose(t, constant_op.constant([42.0]))
 
+  def testAlignedNumpyArrayIsShared(self):
+    # Carve a read-only int64 array aligned for any Eigen build out of a larger
+    # buffer. Requesting an equivalent dtype must not copy it.
+    buf = np.zeros(16 * 8 + 64, dtype=np.uint8)
+    offset = -buf.ctypes.data % 64
+    value = buf[offset:offset + 16 * 8].view(np.longlong)
+    value.setflags(write=False)
+    t = _create_tensor(
+        value, device="/job:localhost/replica:0/task:0/device:CPU:0",
+        dtype=dtypes.int64)
+    buf[offset] = 42
+    self.assertEqual(t.numpy()[0], 42)
+
   def test_numpyFailsForResource(self):
     v = variables.Variable(42)
     with self.assertRaisesRegex(errors.InvalidArgumentError,
@@ -223,6 +223,9 @@ def set_optimizer_experimental_options(options):
         GPUs and above. Without the use of loss scaling, this can cause
         numerical underflow (see
         `keras.mixed_precision.experimental.LossScaleOptimizer`).
+      - static_memory_planning: Place the op outputs with static shapes at
+        fixed offsets in one buffer per step, reusing the memory of outputs
+        that are no longer needed. Meant for inference graphs.
       - disable_meta_optimizer: Disable the entire meta optimizer.
       - min_graph_nodes: The minimum number of nodes in a graph to optimizer.
         For smaller graphs, optimization is skipped.
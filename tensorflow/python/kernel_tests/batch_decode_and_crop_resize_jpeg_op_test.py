@@ -0,0 +1,113 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the BatchDecodeAndCropResizeJpeg op."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import math
+import os.path
+
+import numpy as np
+
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import gen_image_ops
+from tensorflow.python.ops import image_ops
+from tensorflow.python.ops import io_ops
+from tensorflow.python.platform import test
+
+prefix_path = "tensorflow/core/lib/jpeg/testdata"
+
+
+class BatchDecodeAndCropResizeJpegTest(test.TestCase):
+
+  def _reference(self, jpeg, box, size, channels):
+    """Decodes the whole image, then crops and resizes it."""
+    image = image_ops.decode_jpeg(jpeg, channels=channels)
+    image = self.evaluate(image)
+    height, width = image.shape[:2]
+    y_min, x_min, y_max, x_max = box
+    crop_y = min(int(y_min * height), height - 1)
+    crop_x = min(int(x_min * width), width - 1)
+    crop_y_end = max(crop_y + 1, min(int(math.ceil(y_max * height)), height))
+    crop_x_end = max(crop_x + 1, min(int(math.ceil(x_max * width)), width))
+    crop = image[crop_y:crop_y_end, crop_x:crop_x_end]
+    return self.evaluate(
+        image_ops.resize_bilinear([crop], size, half_pixel_centers=True))[0]
+
+  @test_util.run_in_graph_and_eager_modes
+  def testMatchesUnfusedOps(self):
+    # The image is 128 pixels wide and 256 pixels high.
+    jpeg = self.evaluate(
+        io_ops.read_file(os.path.join(prefix_path, "jpeg_merge_test1.jpg")))
+    boxes = [[0.1, 0.2, 0.6, 0.9], [0.5, 0.5, 0.52, 0.55],
+             [0.25, 0.0, 0.75, 1.0], [0.0, 0.0, 1.0, 1.0]]
+    size = [80, 60]
+    for channels in (1, 3):
+      images = self.evaluate(
+          gen_image_ops.batch_decode_and_crop_resize_jpeg(
+              [jpeg] * len(boxes), boxes, size, channels=channels))
+      self.assertEqual((len(boxes), 80, 60, channels), images.shape)
+      # Crops smaller than twice the output are decoded at full resolution,
+      # which gives the same pixels as decoding the whole image.
+      for image, box in zip(images[:3], boxes[:3]):
+        self.assertAllClose(
+            self._reference(jpeg, box, size, channels), image, atol=1e-3)
+      # The whole image is downscaled by libjpeg, which filters differently.
+      reference = self._reference(jpeg, boxes[3], size, channels)
+      self.assertLess(np.mean(np.abs(reference - images[3])), 10)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testUpscale(self):
+    # The image is 240 pixels wide and 180 pixels high.
+    jpeg = self.evaluate(
+        io_ops.read_file(os.path.join(prefix_path, "small.jpg")))
+    box = [0.0, 0.0, 1.0, 1.0]
+    image = self.evaluate(
+        gen_image_ops.batch_decode_and_crop_resize_jpeg([jpeg], [box],
+                                                        [200, 300]))
+    self.assertAllClose(
+        self._reference(jpeg, box, [200, 300], 3), image[0], atol=1e-3)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testEmptyBatch(self):
+    images = self.evaluate(
+        gen_image_ops.batch_decode_and_crop_resize_jpeg(
+            np.array([], dtype=object), np.zeros([0, 4], np.float32), [8, 8]))
+    self.assertEqual((0, 8, 8, 3), images.shape)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testInvalidInputs(self):
+    jpeg = self.evaluate(
+        io_ops.read_file(os.path.join(prefix_path, "small.jpg")))
+    with self.assertRaisesRegexp(errors.InvalidArgumentError, "crop box"):
+      self.evaluate(
+          gen_image_ops.batch_decode_and_crop_resize_jpeg(
+              [jpeg], [[0.5, 0.0, 0.4, 1.0]], [8, 8]))
+    with self.assertRaisesRegexp(errors.InvalidArgumentError, "JPEG"):
+      self.evaluate(
+          gen_image_ops.batch_decode_and_crop_resize_jpeg(
+              [jpeg, b"not a jpeg"], [[0.0, 0.0, 1.0, 1.0]] * 2, [8, 8]))
+    with self.assertRaisesRegexp((ValueError, errors.InvalidArgumentError),
+                                 "channels"):
+      self.evaluate(
+          gen_image_ops.batch_decode_and_crop_resize_jpeg(
+              [jpeg], [[0.0, 0.0, 1.0, 1.0]], [8, 8], channels=4))
+
+
+if __name__ == "__main__":
+  test.main()
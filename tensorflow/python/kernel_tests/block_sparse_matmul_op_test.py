@@ -0,0 +1,115 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the BlockSparseMatMul op."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import gen_sparse_ops
+from tensorflow.python.platform import test
+
+
+def _to_bsr(x, block_rows, block_cols, indices_dtype):
+  """Converts the dense matrix `x` to BSR, dropping all-zero blocks."""
+  num_block_rows = x.shape[0] // block_rows
+  num_block_cols = x.shape[1] // block_cols
+  values = []
+  col_indices = []
+  row_ptr = [0]
+  for i in range(num_block_rows):
+    for j in range(num_block_cols):
+      block = x[i * block_rows:(i + 1) * block_rows,
+                j * block_cols:(j + 1) * block_cols]
+      if np.any(block):
+        values.append(block)
+        col_indices.append(j)
+    row_ptr.append(len(values))
+  values = np.array(values, dtype=x.dtype).reshape(-1, block_rows, block_cols)
+  return (values, np.array(col_indices, dtype=indices_dtype),
+          np.array(row_ptr, dtype=indices_dtype))
+
+
+class BlockSparseMatMulTest(test.TestCase):
+
+  def _testMatMul(self, x, y, block_rows, block_cols, indices_dtype=np.int64):
+    values, col_indices, row_ptr = _to_bsr(x, block_rows, block_cols,
+                                           indices_dtype)
+    with test_util.use_gpu():
+      product = gen_sparse_ops.block_sparse_mat_mul(values, col_indices,
+                                                    row_ptr, y)
+      tol = 1e-4 if x.dtype == np.float32 else 1e-8
+      self.assertAllClose(np.matmul(x, y), self.evaluate(product), rtol=tol,
+                          atol=tol)
+
+  def _randomBlockSparse(self, rows, cols, block_rows, block_cols, density,
+                         dtype):
+    np.random.seed(127)
+    x = np.random.randn(rows, cols).astype(dtype)
+    mask = np.random.rand(rows // block_rows, cols // block_cols) < density
+    mask = np.kron(mask, np.ones((block_rows, block_cols)))
+    return x * mask.astype(dtype)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testBasic(self):
+    x = np.array([[1, 2, 0, 0], [3, 4, 0, 0], [0, 0, 0, 0], [0, 0, 0, 0],
+                  [5, 0, 0, 6], [0, 7, 8, 0]],
+                 dtype=np.float32)
+    y = np.arange(12, dtype=np.float32).reshape(4, 3)
+    self._testMatMul(x, y, 2, 2)
+    self._testMatMul(x, y, 2, 2, indices_dtype=np.int32)
+    self._testMatMul(x, y, 1, 4)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testRandom(self):
+    for dtype in (np.float32, np.float64):
+      for block_rows, block_cols in ((1, 1), (4, 8), (16, 16)):
+        x = self._randomBlockSparse(64, 128, block_rows, block_cols, 0.3,
+                                    dtype)
+        y = np.random.randn(128, 33).astype(dtype)
+        self._testMatMul(x, y, block_rows, block_cols)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testAllZero(self):
+    x = np.zeros((8, 8), dtype=np.float32)
+    y = np.ones((8, 5), dtype=np.float32)
+    self._testMatMul(x, y, 4, 4)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testInvalidIndices(self):
+    values = np.ones((2, 2, 2), dtype=np.float32)
+    y = np.ones((4, 3), dtype=np.float32)
+    # Only the CPU kernel validates the indices.
+    with test_util.force_cpu():
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "a_block_col_indices"):
+        self.evaluate(
+            gen_sparse_ops.block_sparse_mat_mul(values, [0, 2], [0, 1, 2], y))
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "a_block_row_ptr"):
+        self.evaluate(
+            gen_sparse_ops.block_sparse_mat_mul(values, [0, 1], [0, 2, 1], y))
+    with self.assertRaisesRegexp(errors.InvalidArgumentError, "multiple"):
+      self.evaluate(
+          gen_sparse_ops.block_sparse_mat_mul(values, [0, 1], [0, 1, 2],
+                                              np.ones((5, 3), np.float32)))
+
+
+if __name__ == "__main__":
+  test.main()
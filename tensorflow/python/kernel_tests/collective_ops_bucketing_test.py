@@ -0,0 +1,94 @@
+# Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the fusion of small collective reductions."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+# Read once by the runtime, before the first collective runs.
+os.environ['TF_COLLECTIVE_BUCKET_BYTES'] = '1024'
+
+# pylint: disable=g-import-not-at-top
+from tensorflow.python.compat import v2_compat
+from tensorflow.python.distribute import test_util
+from tensorflow.python.eager import context
+from tensorflow.python.eager import def_function
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import collective_ops
+from tensorflow.python.platform import test
+# pylint: enable=g-import-not-at-top
+
+
+class CollectiveBucketingTest(test.TestCase):
+
+  def setUp(self):
+    context._reset_context()  # pylint: disable=protected-access
+    test_util.set_logical_devices_to_at_least('CPU', 4)
+    context.ensure_initialized()
+    super().setUp()
+
+  def _all_reduce(self, devices, values, group_key, instance_keys, **kwargs):
+    results = []
+    for i, device in enumerate(devices):
+      with ops.device(device):
+        results.append([
+            collective_ops.all_reduce_v2(
+                array_ops.identity(value) * (i + 1), len(devices), group_key,
+                instance_key, **kwargs)
+            for value, instance_key in zip(values, instance_keys)
+        ])
+    return results
+
+  def testManySmallReductions(self):
+    devices = ['/device:CPU:%d' % i for i in range(4)]
+    values = [constant_op.constant([float(i)] * (i + 1)) for i in range(20)]
+
+    @def_function.function
+    def run():
+      return self._all_reduce(devices, values, 1, list(range(100, 120)))
+
+    # Each device contributes (rank + 1) * value.
+    for device_results in run():
+      for i, result in enumerate(device_results):
+        self.assertAllClose(result, [10. * i] * (i + 1))
+
+  def testMixedSizes(self):
+    devices = ['/device:CPU:%d' % i for i in range(2)]
+    # The second tensor is larger than a bucket and is reduced on its own.
+    values = [
+        constant_op.constant([1., 2.]),
+        array_ops.ones([1024]),
+        constant_op.constant([[3.], [4.]]),
+    ]
+
+    @def_function.function
+    def run():
+      return self._all_reduce(
+          devices, values, 2, [200, 201, 202], final_op='Div')
+
+    for device_results in run():
+      self.assertAllClose(device_results[0], [1.5, 3.])
+      self.assertAllClose(device_results[1], [1.5] * 1024)
+      self.assertAllClose(device_results[2], [[4.5], [6.]])
+
+
+if __name__ == '__main__':
+  v2_compat.enable_v2_behavior()
+  test.main()
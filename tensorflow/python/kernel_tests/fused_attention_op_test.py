@@ -0,0 +1,206 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the FusedAttention op."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.python.eager import backprop
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import gen_nn_ops
+from tensorflow.python.ops import gradient_checker_v2
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import nn_grad  # pylint: disable=unused-import
+from tensorflow.python.ops import nn_ops
+from tensorflow.python.platform import test
+
+
+def _attention(query, key, value, bias, scale):
+  """Unfused reference implementation built from TensorFlow ops."""
+  scores = math_ops.matmul(query, key, adjoint_b=True) * scale
+  if bias is not None:
+    scores += bias
+  return math_ops.matmul(nn_ops.softmax(scores), value)
+
+
+def _np_attention(query, key, value, bias, scale):
+  scores = np.matmul(query, np.swapaxes(key, -1, -2)) * scale
+  if bias is not None:
+    scores = scores + bias
+  scores -= np.max(scores, axis=-1, keepdims=True)
+  probs = np.exp(scores)
+  probs /= np.sum(probs, axis=-1, keepdims=True)
+  return np.matmul(probs, value)
+
+
+class FusedAttentionTest(test.TestCase):
+
+  def _inputs(self, shape, key_len, value_depth, dtype):
+    np.random.seed(7)
+    batch, heads, query_len, depth = shape
+    query = np.random.randn(batch, heads, query_len, depth).astype(dtype)
+    key = np.random.randn(batch, heads, key_len, depth).astype(dtype)
+    value = np.random.randn(batch, heads, key_len, value_depth).astype(dtype)
+    return query, key, value
+
+  def _testForward(self, shape, key_len, value_depth, bias_shape, dtype):
+    query, key, value = self._inputs(shape, key_len, value_depth, dtype)
+    bias = None
+    if bias_shape is not None:
+      bias = np.random.randn(*bias_shape).astype(dtype)
+    scale = 1.0 / np.sqrt(shape[-1])
+    with test_util.use_gpu():
+      output, logsumexp, _ = gen_nn_ops.fused_attention(
+          query, key, value, [] if bias is None else [bias], scale=scale)
+      output, logsumexp = self.evaluate([output, logsumexp])
+    tol = 1e-4 if dtype == np.float32 else 1e-10
+    self.assertAllClose(
+        _np_attention(query, key, value, bias, scale), output, rtol=tol,
+        atol=tol)
+    scores = np.matmul(query, np.swapaxes(key, -1, -2)) * scale
+    if bias is not None:
+      scores = scores + bias
+    self.assertAllClose(
+        np.log(np.sum(np.exp(scores), axis=-1)), logsumexp, rtol=tol, atol=tol)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testForward(self):
+    for dtype in (np.float32, np.float64):
+      self._testForward((2, 3, 5, 8), 7, 4, None, dtype)
+      # Spans several key tiles and CPU query tiles.
+      self._testForward((1, 2, 130, 16), 300, 16, None, dtype)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testForwardWithBias(self):
+    for bias_shape in ((2, 3, 5, 7), (1, 3, 5, 7), (2, 1, 5, 7), (2, 1, 1, 7),
+                       (1, 1, 1, 7)):
+      self._testForward((2, 3, 5, 8), 7, 4, bias_shape, np.float32)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testMaskedKeys(self):
+    query, key, value = self._inputs((1, 1, 4, 8), 6, 8, np.float32)
+    # A padding mask hides the last two keys.
+    mask = np.array([0, 0, 0, 0, -1e9, -1e9], np.float32).reshape(1, 1, 1, 6)
+    with test_util.use_gpu():
+      output, _, _ = gen_nn_ops.fused_attention(query, key, value, [mask])
+      output = self.evaluate(output)
+    self.assertAllClose(
+        _np_attention(query, key[:, :, :4], value[:, :, :4], None, 1.0),
+        output, rtol=1e-5, atol=1e-5)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testEmptyQuery(self):
+    query, key, value = self._inputs((2, 3, 0, 8), 7, 4, np.float32)
+    with test_util.use_gpu():
+      output, logsumexp, _ = gen_nn_ops.fused_attention(query, key, value, [])
+      self.assertEqual((2, 3, 0, 4), self.evaluate(output).shape)
+      self.assertEqual((2, 3, 0), self.evaluate(logsumexp).shape)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testInvalidShapes(self):
+    query, key, value = self._inputs((2, 3, 5, 8), 7, 4, np.float32)
+    with self.assertRaisesRegexp((ValueError, errors.InvalidArgumentError),
+                                 "bias"):
+      self.evaluate(
+          gen_nn_ops.fused_attention(query, key, value,
+                                     [np.zeros((2, 3, 5, 1), np.float32)]))
+    with self.assertRaises((ValueError, errors.InvalidArgumentError)):
+      self.evaluate(gen_nn_ops.fused_attention(query, key[:, :, :6], value,
+                                               []))
+    with self.assertRaises((ValueError, errors.InvalidArgumentError)):
+      self.evaluate(
+          gen_nn_ops.fused_attention(query, key, value, [], dropout_rate=1.0))
+
+  def _computeGradients(self, fn, inputs, output_grad):
+    inputs = [constant_op.constant(x) for x in inputs]
+    with backprop.GradientTape() as tape:
+      tape.watch(inputs)
+      output = fn(*inputs)
+    return self.evaluate(
+        tape.gradient(output, inputs, output_gradients=output_grad))
+
+  @test_util.run_in_graph_and_eager_modes
+  def testGradients(self):
+    for dtype in (np.float32, np.float64):
+      query, key, value = self._inputs((2, 2, 5, 4), 6, 3, dtype)
+      bias = np.random.randn(1, 2, 5, 6).astype(dtype)
+      output_grad = np.random.randn(2, 2, 5, 3).astype(dtype)
+
+      def fused(q, k, v):
+        return gen_nn_ops.fused_attention(q, k, v, [bias], scale=0.5)[0]
+
+      def unfused(q, k, v):
+        return _attention(q, k, v, bias, 0.5)
+
+      with test_util.use_gpu():
+        fused_grads = self._computeGradients(fused, [query, key, value],
+                                             output_grad)
+        unfused_grads = self._computeGradients(unfused, [query, key, value],
+                                               output_grad)
+      tol = 1e-4 if dtype == np.float32 else 1e-10
+      self.assertAllClose(unfused_grads, fused_grads, rtol=tol, atol=tol)
+
+  def testGradientsNumerically(self):
+    query, key, value = self._inputs((1, 2, 5, 4), 6, 3, np.float64)
+    with test_util.use_gpu():
+      theoretical, numerical = gradient_checker_v2.compute_gradient(
+          lambda q, k, v: gen_nn_ops.fused_attention(q, k, v, [])[0],
+          [query, key, value])
+    self.assertAllClose(theoretical, numerical, rtol=1e-6, atol=1e-6)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testDropout(self):
+    rate = 0.4
+    np.random.seed(11)
+    query = np.random.randn(2, 2, 9, 4)
+    key = np.random.randn(2, 2, 11, 4)
+    # With identity values the output is the attention matrix after dropout.
+    value = np.tile(np.eye(11), (2, 2, 1, 1))
+    output_grad = np.random.randn(2, 2, 9, 11)
+    with test_util.use_gpu():
+      output, logsumexp, seed = gen_nn_ops.fused_attention(
+          query, key, value, [], scale=0.5, dropout_rate=rate, seed=1,
+          seed2=2)
+      grads = gen_nn_ops.fused_attention_grad(
+          query, key, value, [], output, logsumexp, seed, output_grad,
+          scale=0.5, dropout_rate=rate)
+      attention, grads = self.evaluate([output, grads])
+
+    probs = _np_attention(query, key, value, None, 0.5)
+    keep = attention != 0
+    # Kept probabilities are scaled by 1 / (1 - rate).
+    self.assertAllClose(probs[keep] / (1 - rate), attention[keep])
+    self.assertGreater(np.mean(keep), 0.4)
+    self.assertLess(np.mean(keep), 0.8)
+
+    # Gradients of the forward pass with the same dropout mask.
+    grad_attention = np.matmul(output_grad, np.swapaxes(value, -1, -2))
+    grad_probs = grad_attention * keep / (1 - rate)
+    grad_scores = probs * (
+        grad_probs - np.sum(grad_probs * probs, axis=-1, keepdims=True))
+    self.assertAllClose(0.5 * np.matmul(grad_scores, key), grads[0])
+    self.assertAllClose(
+        0.5 * np.matmul(np.swapaxes(grad_scores, -1, -2), query), grads[1])
+    self.assertAllClose(
+        np.matmul(np.swapaxes(attention, -1, -2), output_grad), grads[2])
+
+
+if __name__ == "__main__":
+  test.main()
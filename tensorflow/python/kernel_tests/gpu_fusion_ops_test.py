@@ -233,7 +233,70 @@ class AddNReluGradTestSuite(FusionOpsTestCase):
         for dtype in [dtypes.float32, dtypes.float16]:
             self.runTest(self._test01, dtype)
 
-            
+
+
+class MatMulBiasActivationTestSuite(FusionOpsTestCase):
+
+    def _test01(self, dtype):
+        with test_util.device(True):
+            a = constant_op.constant([[-3,-2,-1],[0,1,2]], dtype=dtype)
+            b = constant_op.constant([[1,-1],[2,0],[0,3]], dtype=dtype)
+            offset = constant_op.constant([1,-2], dtype=dtype)
+
+            matmul = math_ops.matmul(a, b)
+            bias = nn_ops.bias_add(matmul, offset)
+            relu = nn_ops.relu(bias)
+
+            y1 = array_ops.identity(relu)
+
+            return (y1,)
+
+    def test01(self):
+        for dtype in [dtypes.float32, dtypes.float16]:
+            self.runTest(self._test01, dtype)
+
+
+    def _test02(self, dtype):
+        with test_util.device(True):
+            a = constant_op.constant([[-3,-2],[-1,0],[1,2]], dtype=dtype)
+            b = constant_op.constant([[1,-1,2],[0,3,1]], dtype=dtype)
+            offset = constant_op.constant([1,-2], dtype=dtype)
+            residual = constant_op.constant([[1,2],[3,4]], dtype=dtype)
+
+            matmul = math_ops.matmul(a, b, transpose_a=True, transpose_b=True)
+            bias = nn_ops.bias_add(matmul, offset)
+            add = math_ops.add_v2(residual, bias)
+            tanh = math_ops.tanh(add)
+
+            y1 = array_ops.identity(tanh)
+
+            return (y1,)
+
+    def test02(self):
+        for dtype in [dtypes.float32, dtypes.float16]:
+            self.runTest(self._test02, dtype)
+
+
+    def _test03(self, dtype):
+        with test_util.device(True):
+            a = constant_op.constant([[-3,-2,-1],[0,1,2]], dtype=dtype)
+            b = constant_op.constant([[1,-1],[2,0],[0,3]], dtype=dtype)
+            offset = constant_op.constant([1,-2], dtype=dtype)
+            residual = constant_op.constant([[1,2],[3,4]], dtype=dtype)
+
+            matmul = math_ops.matmul(a, b)
+            bias = nn_ops.bias_add(matmul, offset)
+            add = math_ops.add(bias, residual)
+
+            y1 = array_ops.identity(add)
+
+            return (y1,)
+
+    def test03(self):
+        for dtype in [dtypes.float32, dtypes.float16]:
+            self.runTest(self._test03, dtype)
+
+
 
 if __name__ == "__main__":
     test.main()
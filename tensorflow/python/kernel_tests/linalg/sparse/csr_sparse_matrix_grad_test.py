@@ -79,8 +79,6 @@ class CSRSparseMatrixGradTest(test.TestCase):
                         dense_shape)
         self.assertAllEqual(grad_vals, grad_out_value)
 
-  @test.disable_for_rocm(skip_message='sparse-matrix-add op '
-                                      'not supported on ROCm')
   @test_util.run_deprecated_v1
   def testLargeBatchSparseMatrixAddGrad(self):
     if not self._gpu_available:
@@ -427,8 +427,6 @@ class CSRSparseMatrixOpsTest(test.TestCase):
     for (mat, sm_rt_value) in zip(mats, sm_rt_values):
       self.assertAllEqual(mat, sm_rt_value)
 
-  @test.disable_for_rocm(skip_message='sparse-matrix-add op '
-                                      'not supported on ROCm')
   @test_util.run_in_graph_and_eager_modes
   def testSparseMatrixAdd(self):
     if not self._gpu_available:
@@ -466,8 +464,6 @@ class CSRSparseMatrixOpsTest(test.TestCase):
 
       self.assertAllClose(a_sum_b_sparse_mat.todense(), c_dense_value)
 
-  @test.disable_for_rocm(skip_message='sparse-matrix-add op '
-                                      'not supported on ROCm')
   @test_util.run_in_graph_and_eager_modes
   def testLargeBatchSparseMatrixAdd(self):
     if not self._gpu_available:
@@ -779,8 +775,6 @@ class CSRSparseMatrixOpsTest(test.TestCase):
 
         self.assertAllClose(c_sm_dense_value, c_dense_t_value)
 
-  @test.disable_for_rocm(skip_message='sparse-matrix-add op is not '
-                                      'yet supported on ROCm')
   @test_util.run_in_graph_and_eager_modes
   def testLargeBatchRegisteredAddN(self):
     if not self._gpu_available:
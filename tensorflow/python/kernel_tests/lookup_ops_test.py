@@ -42,6 +42,7 @@ from tensorflow.python.framework import tensor_spec
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.ops import gen_lookup_ops
 from tensorflow.python.ops import lookup_ops
 from tensorflow.python.ops import map_fn
 from tensorflow.python.ops import string_ops
@@ -1297,6 +1298,53 @@ class DenseHashTableOpTest(test.TestCase):
     result = self.evaluate(output)
     self.assertAllEqual([0, -1, -1], result)
 
+  def testBasicOnGpu(self):
+    if not test.is_gpu_available():
+      self.skipTest("No GPU available")
+    with ops.device(test.gpu_device_name()):
+      table = lookup_ops.DenseHashTable(
+          dtypes.int64,
+          dtypes.float32,
+          default_value=[-1.0, -1.0],
+          empty_key=0,
+          deleted_key=-1,
+          initial_num_buckets=4)
+      # Enough keys to make the table grow several times.
+      keys = constant_op.constant(np.arange(1, 101), dtypes.int64)
+      values = constant_op.constant(
+          np.stack([np.arange(1, 101), -np.arange(1, 101)], axis=1),
+          dtypes.float32)
+      self.evaluate(table.insert(keys, values))
+      self.assertAllEqual(100, self.evaluate(table.size()))
+
+      self.evaluate(
+          table.remove(constant_op.constant([12, 12, 200], dtypes.int64)))
+      self.assertAllEqual(99, self.evaluate(table.size()))
+
+      output = table.lookup(constant_op.constant([11, 12, 200], dtypes.int64))
+      self.assertAllEqual([[11, -11], [-1, -1], [-1, -1]],
+                          self.evaluate(output))
+
+      exported_keys, exported_values = self.evaluate(table.export())
+
+    # The exported buckets can be imported into a table on the CPU.
+    with ops.device("/cpu:0"):
+      cpu_table = lookup_ops.DenseHashTable(
+          dtypes.int64,
+          dtypes.float32,
+          default_value=[-1.0, -1.0],
+          empty_key=0,
+          deleted_key=-1)
+      self.evaluate(
+          gen_lookup_ops.lookup_table_import_v2(cpu_table.resource_handle,
+                                                exported_keys,
+                                                exported_values))
+      self.assertAllEqual(99, self.evaluate(cpu_table.size()))
+      output = cpu_table.lookup(
+          constant_op.constant([11, 12, 100], dtypes.int64))
+      self.assertAllEqual([[11, -11], [-1, -1], [100, -100]],
+                          self.evaluate(output))
+
   def testGetItem(self):
     keys = constant_op.constant([11, 12, 13, 14], dtypes.int64)
     values = constant_op.constant([0, 1, 2, 3], dtypes.int64)
@@ -3357,6 +3405,39 @@ class MutableHashTableOpTest(test.TestCase):
     result = self.evaluate(output)
     self.assertAllEqual([3, 1, -1], result)
 
+  def testMutableHashTableManyKeys(self):
+    # Enough keys to populate every internal shard of the table.
+    num_keys = 1000
+    default_val = -1
+    keys = constant_op.constant(np.arange(num_keys), dtypes.int64)
+    values = constant_op.constant(np.arange(num_keys) * 10, dtypes.int64)
+    table = lookup_ops.MutableHashTable(dtypes.int64, dtypes.int64,
+                                        default_val)
+    self.evaluate(table.insert(keys, values))
+    self.assertAllEqual(num_keys, self.evaluate(table.size()))
+
+    # Later duplicates win.
+    self.evaluate(
+        table.insert(
+            constant_op.constant([3, 7, 3], dtypes.int64),
+            constant_op.constant([1, 2, 5], dtypes.int64)))
+    self.evaluate(
+        table.remove(constant_op.constant(np.arange(0, num_keys, 2),
+                                          dtypes.int64)))
+    self.assertAllEqual(num_keys // 2, self.evaluate(table.size()))
+
+    query = np.arange(num_keys + 10)
+    expected = np.where(query % 2 == 1, query * 10, default_val)
+    expected[query >= num_keys] = default_val
+    expected[3] = 5
+    expected[7] = 2
+    output = table.lookup(constant_op.constant(query, dtypes.int64))
+    self.assertAllEqual(expected, self.evaluate(output))
+
+    exported_keys, exported_values = self.evaluate(table.export())
+    self.assertAllEqual(np.arange(1, num_keys, 2), np.sort(exported_keys))
+    self.assertAllEqual(expected[exported_keys], exported_values)
+
   def testMutableHashTableFindHighRank(self):
     default_val = -1
     keys = constant_op.constant(["brain", "salad", "surgery"])
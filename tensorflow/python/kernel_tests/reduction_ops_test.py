@@ -274,6 +274,17 @@ class SumReductionTest(BaseReductionTest):
       np_arr = self._makeIncremental((2,) * rank, dtypes.float64)
       self._compareAllAxes(np_arr)
 
+  @test_util.run_deprecated_v1
+  def testLargeReductions(self):
+    # Shapes that the CPU kernel splits along the reduced dimension, blocks
+    # along the inner dimension, or both.
+    for shape, axes in (([1 << 20], [0]), ([3, 5000, 7], [1]),
+                        ([5000, 300], [0]), ([300, 5000], [1]),
+                        ([2, 70000, 3], [0, 2])):
+      for dtype in (dtypes.int32, dtypes.int64, dtypes.float64):
+        np_arr = (self._makeIncremental(shape, dtype) % 101) - 50
+        self._compare(np_arr, axes, keepdims=False)
+
   @test_util.run_deprecated_v1
   def testComplex64(self):
     for rank in range(1, _MAX_RANK + 1):
@@ -487,6 +498,15 @@ class MeanReductionTest(BaseReductionTest):
       np_arr = self._makeIncremental((2,) * rank, dtypes.float64)
       self._compareAllAxes(np_arr)
 
+  @test_util.run_deprecated_v1
+  def testLargeReductions(self):
+    for shape, axes in (([1 << 20], [0]), ([3, 5000, 7], [1]),
+                        ([5000, 300], [0]), ([300, 5000], [1]),
+                        ([2, 70000, 3], [0, 2])):
+      for dtype in (dtypes.int32, dtypes.int64, dtypes.float64):
+        np_arr = (self._makeIncremental(shape, dtype) % 101) - 50
+        self._compare(np_arr, axes, keepdims=False)
+
   @test_util.run_deprecated_v1
   def testComplex64(self):
     for rank in range(1, _MAX_RANK + 1):
@@ -861,6 +881,15 @@ class MaxReductionTest(test.TestCase):
                                      repeat=size):
           self._compareAll(np.array(arr, dtype=dtype), None)
 
+  def testLargeReductionsWithNaN(self):
+    for dtype in [np.float32, np.float64]:
+      for shape, axes in (([1 << 20], [0]), ([3, 5000, 7], [1]),
+                          ([5000, 300], [0])):
+        np_arr = np.random.rand(*shape).astype(dtype)
+        self._compareAll(np_arr, axes)
+        np_arr.flat[np_arr.size // 3] = np.nan
+        self._compareAll(np_arr, axes)
+
   def testInt64Reduce3D(self):
     # Create a 3D array of int64s and reduce across all possible
     # dimensions
@@ -1001,6 +1030,14 @@ class AllReductionTest(test.TestCase):
     self._compareAll(np_arr, [0, 2])
     self._compareAll(np_arr, [0, 1, 2])
 
+  def testLarge(self):
+    for shape, axes in (([1 << 20], [0]), ([3, 5000, 7], [1]),
+                        ([5000, 300], [0]), ([300, 5000], [1])):
+      np_arr = np.ones(shape, dtype=np.bool_)
+      self._compareAll(np_arr, axes)
+      np_arr.flat[np_arr.size // 3] = not np_arr.flat[0]
+      self._compareAll(np_arr, axes)
+
   def testEmpty(self):
     self._compareAll([], [0])
 
@@ -1050,6 +1087,14 @@ class AnyReductionTest(test.TestCase):
     self._compareAll(np_arr, [0, 2])
     self._compareAll(np_arr, [0, 1, 2])
 
+  def testLarge(self):
+    for shape, axes in (([1 << 20], [0]), ([3, 5000, 7], [1]),
+                        ([5000, 300], [0]), ([300, 5000], [1])):
+      np_arr = np.zeros(shape, dtype=np.bool_)
+      self._compareAll(np_arr, axes)
+      np_arr.flat[np_arr.size // 3] = not np_arr.flat[0]
+      self._compareAll(np_arr, axes)
+
   def testEmpty(self):
     self._compareAll([], [0])
 
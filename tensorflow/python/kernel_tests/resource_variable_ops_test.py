@@ -908,6 +908,29 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
     value = self.evaluate(v.sparse_read([0, 3, 1, 2]))
     self.assertAllEqual(init_value[[0, 3, 1, 2], ...], value)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testDenseReadAfterGatherIsNotClobbered(self):
+    handle = resource_variable_ops.var_handle_op(
+        dtype=dtypes.int32, shape=[2])
+    self.evaluate(
+        resource_variable_ops.assign_variable_op(
+            handle, constant_op.constant([1, 2], dtype=dtypes.int32)))
+    gathered = resource_variable_ops.resource_gather(
+        handle, [1], dtype=dtypes.int32)
+    self.assertAllEqual([2], self.evaluate(gathered))
+    # The read aliases the variable, so the update below must not be visible
+    # through it.
+    read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32)
+    with ops.control_dependencies([read]):
+      update = resource_variable_ops.assign_add_variable_op(
+          handle, constant_op.constant([10, 10], dtype=dtypes.int32))
+    with ops.control_dependencies([update]):
+      read_after = resource_variable_ops.read_variable_op(
+          handle, dtype=dtypes.int32)
+    read_value, read_after_value = self.evaluate([read, read_after])
+    self.assertAllEqual([1, 2], read_value)
+    self.assertAllEqual([11, 12], read_after_value)
+
   @test_util.run_in_graph_and_eager_modes
   def testGatherNd(self):
     init_value = np.reshape(np.arange(np.power(4, 3)), (4, 4, 4))
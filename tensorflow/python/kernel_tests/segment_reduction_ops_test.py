@@ -570,6 +570,46 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
               # and may therefore vary dynamically.
               self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testValuesWithGpu(self):
+    # Each item is np_op1, np_op2, tf_op
+    ops_list = [(np.add, None, math_ops.sparse_segment_sum),
+                (self._mean_cum_op, self._mean_reduce_op,
+                 math_ops.sparse_segment_mean),
+                (self._mean_cum_op, self._sqrt_n_reduce_op,
+                 math_ops.sparse_segment_sqrt_n)]
+    n = 400
+    shape = [n, 3]
+    # Segment 1 is empty and the segments get longer than a GPU stripe.
+    segment_indices = [0] + [i for i in range(2, 20) for _ in range(i + 1)]
+    num_indices = len(segment_indices)
+    for dtype in [dtypes_lib.float32, dtypes_lib.float64]:
+      for index_dtype in [dtypes_lib.int32, dtypes_lib.int64]:
+        with self.cached_session(use_gpu=True):
+          tf_indices, np_indices, tf_x, np_x = self._sparse_input(
+              shape, num_indices, dtype=dtype)
+          for np_op1, np_op2, tf_op in ops_list:
+            np_ans = self._sparseSegmentReduce(np_x, np_indices,
+                                               segment_indices, np_op1, np_op2)
+            s = tf_op(
+                data=tf_x,
+                indices=math_ops.cast(tf_indices, index_dtype),
+                segment_ids=math_ops.cast(segment_indices, index_dtype))
+            self.assertAllClose(np_ans, self.evaluate(s))
+
+  def testGradientOpsWithGpu(self):
+    tf_x, _ = self._input([4, 5], dtype=dtypes_lib.float32)
+    segment_indices = [0, 1, 1, 3, 3, 3]
+    tf_indices = [8, 3, 0, 9, 3, 8]
+    for tf_op in [
+        math_ops.sparse_segment_mean_grad, math_ops.sparse_segment_sqrt_n_grad
+    ]:
+      with self.session(use_gpu=False):
+        expected = self.evaluate(
+            tf_op(tf_x, tf_indices, segment_indices, 10))
+      with self.session(use_gpu=True):
+        actual = self.evaluate(tf_op(tf_x, tf_indices, segment_indices, 10))
+      self.assertAllClose(expected, actual)
+
   def testSegmentIdsHole(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
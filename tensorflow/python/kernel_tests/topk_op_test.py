@@ -155,6 +155,34 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float32)
     self._testMediumTopK(np.float16)
 
+  def _testRadixSelectTopK(self, dtype):
+    # Long rows with a k that is large but small relative to the row.
+    b = 3
+    n = 20000
+    k = 1000
+    inputs = np.random.permutation(
+        np.linspace(-100, 100, b * n, dtype=dtype)).reshape(b, n)
+    indices = np.argsort(-inputs, axis=1)[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+    self._validateTopK(inputs, k, values, indices, sorted=False)
+
+  def testRadixSelectTopK(self):
+    self._testRadixSelectTopK(np.float32)
+    self._testRadixSelectTopK(np.float64)
+
+  def testRadixSelectStableTopK(self):
+    b = 3
+    n = 20000
+    k = 1000
+    # Lots of repeated integers taking values in [-5, 5], so that the k-th
+    # largest value is tied with many others.
+    inputs = np.random.permutation(
+        np.linspace(-5, 5, b * n, dtype=np.int32)).reshape(b, n)
+    indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
   def testStableSort(self):
     b = 5
     n = 500
@@ -433,6 +433,26 @@ class TransposeTest(test.TestCase):
     self._testBoth(
         np.arange(0, 1260).reshape([2, 3, 5, 7, 2, 3]).astype(np.int64))
 
+  def testBlockedCPU(self):
+    # Spans several tiles of every type, with partial tiles at the edges.
+    for dtype in [np.int8, np.int16, np.int32, np.int64, np.complex128]:
+      x = np.arange(0, 2 * 67 * 35 * 9).reshape([2, 67, 35, 9]).astype(dtype)
+      with self.cached_session(use_gpu=False):
+        for p in itertools.permutations(range(4)):
+          self.assertAllEqual(
+              np.transpose(x, p), self.evaluate(array_ops.transpose(x, p)))
+    x = (1 + 2j) * np.arange(0, 40 * 50).reshape([40, 50])
+    with self.cached_session(use_gpu=False):
+      self.assertAllEqual(
+          np.conj(x.T),
+          self.evaluate(array_ops.transpose(x, [1, 0], conjugate=True)))
+    # No dimensions can be merged, leaving more than 8 dimensions.
+    x = np.arange(0, 2**9).reshape([2] * 9).astype(np.float32)
+    p = list(range(8, -1, -1))
+    with self.cached_session(use_gpu=False):
+      self.assertAllEqual(
+          np.transpose(x, p), self.evaluate(array_ops.transpose(x, p)))
+
   @test_util.run_v1_only("b/120545219")
   def testTranspose2DAuto(self):
     x_np = [[1, 2, 3], [4, 5, 6]]
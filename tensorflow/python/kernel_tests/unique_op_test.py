@@ -27,6 +27,15 @@ from tensorflow.python.ops import gen_array_ops
 from tensorflow.python.platform import test
 
 
+def _unique_in_first_occurrence_order(x):
+  """Returns the expected outputs of `UniqueWithCounts` for `x`."""
+  values, first_index, inverse, counts = np.unique(
+      x, return_index=True, return_inverse=True, return_counts=True)
+  order = np.argsort(first_index)
+  rank = np.argsort(order)
+  return values[order], rank[inverse], counts[order]
+
+
 class UniqueTest(test.TestCase):
 
   def testInt32(self):
@@ -49,6 +58,16 @@ class UniqueTest(test.TestCase):
     for i in range(len(x)):
       self.assertEqual(x[i], tf_y[tf_idx[i]])
 
+  def testLargeInt64(self):
+    # Large enough to be uniquified in parallel.
+    x = np.random.randint(0, high=50000, size=1 << 20).astype(np.int64)
+    y, idx = array_ops.unique(x)
+    tf_y, tf_idx = self.evaluate([y, idx])
+
+    expected_y, expected_idx, _ = _unique_in_first_occurrence_order(x)
+    self.assertAllEqual(expected_y, tf_y)
+    self.assertAllEqual(expected_idx, tf_idx)
+
   def testString(self):
     indx = np.random.randint(65, high=122, size=7000)
     x = [chr(i) for i in indx]
@@ -179,6 +198,18 @@ class UniqueWithCountsTest(test.TestCase):
     for value, count in zip(tf_y, tf_count):
       self.assertEqual(count, np.sum(x == value))
 
+  def testLargeInt32(self):
+    # Large enough to be uniquified in parallel.
+    x = np.random.randint(0, high=50000, size=1 << 20).astype(np.int32)
+    y, idx, count = array_ops.unique_with_counts(x, out_idx=dtypes.int64)
+    tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+
+    expected_y, expected_idx, expected_count = (
+        _unique_in_first_occurrence_order(x))
+    self.assertAllEqual(expected_y, tf_y)
+    self.assertAllEqual(expected_idx, tf_idx)
+    self.assertAllEqual(expected_count, tf_count)
+
   def testString(self):
     indx = np.random.randint(65, high=122, size=7000)
     x = [chr(i) for i in indx]
@@ -746,9 +746,12 @@ TFE_TensorHandle* PySeqToTFE_TensorHandle(TFE_Context* ctx, PyObject* obj,
     int array_dtype = PyArray_TYPE(array);
 
     Safe_PyObjectPtr safe_value(nullptr);
-    // Use Numpy to convert between types if needed.
-    if ((desired_np_dtype >= 0 && desired_np_dtype != array_dtype) ||
-        !PyArray_ISCARRAY(array)) {
+    // Use Numpy to convert between types if needed. Equivalent types, e.g.
+    // NPY_LONGLONG and NPY_LONG on LP64 platforms, and read-only arrays are
+    // wrapped as they are, so that NdarrayToTensor can share their buffer.
+    if ((desired_np_dtype >= 0 &&
+         !PyArray_EquivTypenums(desired_np_dtype, array_dtype)) ||
+        !PyArray_ISCARRAY_RO(array)) {
       int new_dtype = desired_np_dtype >= 0 ? desired_np_dtype : array_dtype;
       safe_value = tensorflow::make_safe(
           PyArray_FromAny(obj, PyArray_DescrFromType(new_dtype), 0, 0,
@@ -46,7 +46,8 @@ def all_reduce(t,
       be done.
     communication_hint: preferred collective communication.  The implementation
       may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      `nccl`.  `ring_fp16` and `ring_bf16` select `ring` and cast float chunks
+      to half precision on the wire, while still reducing in float.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -95,7 +96,8 @@ def all_reduce_v2(t,
       value.  Can be 'Id' for no operation.
     communication_hint: preferred collective communication.  The implementation
       may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      `nccl`.  `ring_fp16` and `ring_bf16` select `ring` and cast float chunks
+      to half precision on the wire, while still reducing in float.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
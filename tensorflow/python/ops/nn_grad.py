@@ -324,6 +324,36 @@ def _LogSoftmaxGrad(op, grad):
   return grad - math_ops.reduce_sum(grad, -1, keepdims=True) * softmax
 
 
+@ops.RegisterGradient("FusedAttention")
+def _FusedAttentionGrad(op, grad, unused_grad_logsumexp, unused_grad_seed):
+  """The gradients for FusedAttention.
+
+  Args:
+    op: The FusedAttention op.
+    grad: The tensor representing the gradient w.r.t. the output.
+    unused_grad_logsumexp: The gradient w.r.t. the log-sum-exp output, which is
+      only consumed by the backward pass.
+    unused_grad_seed: The gradient w.r.t. the dropout seed output.
+
+  Returns:
+    The gradients w.r.t. query, key and value. The bias, if any, gets no
+    gradient.
+  """
+  num_bias = op.get_attr("num_bias")
+  query_grad, key_grad, value_grad = gen_nn_ops.fused_attention_grad(
+      query=op.inputs[0],
+      key=op.inputs[1],
+      value=op.inputs[2],
+      bias=op.inputs[3:3 + num_bias],
+      output=op.outputs[0],
+      logsumexp=op.outputs[1],
+      dropout_seed=op.outputs[2],
+      output_backprop=grad,
+      scale=op.get_attr("scale"),
+      dropout_rate=op.get_attr("dropout_rate"))
+  return [query_grad, key_grad, value_grad] + [None] * num_bias
+
+
 @ops.RegisterGradient("BiasAdd")
 def _BiasAddGrad(op, received_grad):
   """Return the gradients for the 2 inputs of bias_op.
@@ -339,6 +339,29 @@ class TrainingOpsTest(TensorFlowTestCase):
       indices = np.array([0, 2]).astype(index_type)
       self._testTypesForSparseAdagrad(x, y, lr, grad, indices)
 
+  @test_util.run_v1_only("SparseApplyAdagrad op returns a ref, so it is not "
+                         "supported in eager mode.")
+  def testSparseApplyAdagradDuplicateIndices(self):
+    # Repeated indices are applied one after another, in order.
+    x = np.arange(12, dtype=np.float64).reshape([4, 3])
+    y = np.ones([4, 3], dtype=np.float64)
+    lr = 0.5
+    grad = np.arange(1, 19, dtype=np.float64).reshape([6, 3])
+    indices = np.array([3, 1, 3, 3, 0, 1], dtype=np.int32)
+    expected_var = x.copy()
+    expected_accum = y.copy()
+    for i, index in enumerate(indices):
+      expected_accum[index] += grad[i] * grad[i]
+      expected_var[index] -= lr * grad[i] / np.sqrt(expected_accum[index])
+    with self.session(use_gpu=False):
+      var = variables.VariableV1(x)
+      accum = variables.VariableV1(y)
+      self.evaluate(variables.global_variables_initializer())
+      self.evaluate(
+          training_ops.sparse_apply_adagrad(var, accum, lr, grad, indices))
+      self.assertAllClose(expected_var, self.evaluate(var))
+      self.assertAllClose(expected_accum, self.evaluate(accum))
+
   @test_util.run_v1_only("SparseApplyAdagrad op returns a ref, so it is not "
                          "supported in eager mode.")
   def testSparseApplyAdagradDim1(self):
@@ -41,6 +41,7 @@ limitations under the License.
 #define TENSORFLOW_STREAM_EXECUTOR_BLAS_H_
 
 #include <complex>
+#include <type_traits>
 #include <vector>
 
 #include "tensorflow/stream_executor/dnn.h"  // For DataType, ToDataType
@@ -231,6 +232,29 @@ struct BlasLtMatmulPlanParams {
   int64 stride_c = 0;
 };
 
+// One matrix-matrix product c = alpha * op(a) * op(b) + beta * c of a grouped
+// gemm, see Stream::ThenBlasGemmGrouped. Like for DoBlasGemm, alpha and beta
+// are float for Eigen::half matrices.
+template <typename T>
+struct GemmProblem {
+  using Scalar = typename std::conditional<std::is_same<T, Eigen::half>::value,
+                                           float, T>::type;
+
+  Transpose transa;
+  Transpose transb;
+  uint64 m;
+  uint64 n;
+  uint64 k;
+  Scalar alpha;
+  DeviceMemory<T> *a;
+  int lda;
+  DeviceMemory<T> *b;
+  int ldb;
+  Scalar beta;
+  DeviceMemory<T> *c;
+  int ldc;
+};
+
 // BLAS support interface -- this can be derived from a GPU executor when the
 // underlying platform has an BLAS library implementation available. See
 // StreamExecutor::AsBlas().
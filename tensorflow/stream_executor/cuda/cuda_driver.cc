@@ -648,6 +648,24 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return port::Status::OK();
 }
 
+/* static */ port::Status GpuDriver::MemPrefetchAsync(GpuContext* context,
+                                                     CUdeviceptr location,
+                                                     uint64 size, bool to_host,
+                                                     CUstream stream) {
+  ScopedActivateContext activation(context);
+  CUdevice device = CU_DEVICE_CPU;
+  if (!to_host) {
+    auto context_device = DeviceFromContext(context);
+    if (!context_device.ok()) {
+      return context_device.status();
+    }
+    device = context_device.ValueOrDie();
+  }
+  RETURN_IF_CUDA_RES_ERROR(cuMemPrefetchAsync(location, size, device, stream),
+                           "Failed to enqueue memory prefetch operation");
+  return port::Status::OK();
+}
+
 /* static */ port::Status GpuDriver::AsynchronousMemsetUint32(
     GpuContext* context, CUdeviceptr location, uint32 value,
     size_t uint32_count, CUstream stream) {
@@ -1125,6 +1143,71 @@ GpuDriver::CreateMemoryHandle(GpuContext* context, uint64 bytes) {
   return false;
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  ScopedActivateContext activation(context);
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_RELAXED),
+      "Failed to begin stream capture");
+  return port::Status::OK();
+}
+
+/* static */ port::StatusOr<CUgraph> GpuDriver::StreamEndCapture(
+    GpuContext* context, CUstream stream) {
+  ScopedActivateContext activation(context);
+  CUgraph graph = nullptr;
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, &graph),
+                           "Failed to end stream capture");
+  return graph;
+}
+
+/* static */ port::StatusOr<bool> GpuDriver::StreamIsCapturing(
+    GpuContext* context, CUstream stream) {
+  ScopedActivateContext activation(context);
+  CUstreamCaptureStatus status;
+  RETURN_IF_CUDA_RES_ERROR(cuStreamIsCapturing(stream, &status),
+                           "Failed to query stream capture status");
+  return status == CU_STREAM_CAPTURE_STATUS_ACTIVE;
+}
+
+/* static */ port::StatusOr<CUgraphExec> GpuDriver::GraphInstantiate(
+    GpuContext* context, CUgraph graph) {
+  ScopedActivateContext activation(context);
+  CUgraphExec graph_exec = nullptr;
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(&graph_exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate graph");
+  return graph_exec;
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec graph_exec,
+                                                 CUstream stream) {
+  ScopedActivateContext activation(context);
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(graph_exec, stream),
+                           "Failed to launch graph");
+  return port::Status::OK();
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context,
+                                          CUgraph graph) {
+  ScopedActivateContext activation(context);
+  CUresult res = cuGraphDestroy(graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy graph: " << ToString(res);
+  }
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              CUgraphExec graph_exec) {
+  ScopedActivateContext activation(context);
+  CUresult res = cuGraphExecDestroy(graph_exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy executable graph: " << ToString(res);
+  }
+}
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(GpuContext* context,
                                                           void* host_dst,
                                                           CUdeviceptr gpu_src,
@@ -26,6 +26,10 @@ limitations under the License.
 #include "tensorflow/stream_executor/lib/statusor.h"
 #include "tensorflow/stream_executor/platform/port.h"
 
+#if TENSORFLOW_USE_ROCM
+#include "rocm/rocm_config.h"
+#endif
+
 namespace stream_executor {
 namespace gpu {
 
@@ -140,8 +144,8 @@ class GpuDriver {
   // previously registered.
   static bool HostUnregister(GpuContext* context, void* location);
 
-  // Virtual memory support was added to CUDA in 10.2
-#if CUDA_VERSION >= 10020
+  // Virtual memory support was added to CUDA in 10.2 and to ROCm in 5.2.
+#if CUDA_VERSION >= 10020 || TF_ROCM_VERSION >= 50200
 
   // Reserves a range of virtual device memory addresses via
   // cuMemAddressReserve. bytes must be a multiple of the host page size.
@@ -195,7 +199,7 @@ class GpuDriver {
   // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__VA.html#group__CUDA__VA_1gfb50aac00c848fd7087e858f59bf7e2a
   static void UnmapMemory(GpuContext* context, GpuDevicePtr va, uint64 bytes);
 
-#endif  // CUDA_VERSION >= 10200
+#endif  // CUDA_VERSION >= 10020 || TF_ROCM_VERSION >= 50200
 
   // Given a device ordinal, returns a device handle into the device outparam,
   // which must not be null.
@@ -323,6 +327,15 @@ class GpuDriver {
                                               uint8 value, size_t uint32_count,
                                               GpuStreamHandle stream);
 
+  // Enqueues a migration of the managed memory segment to the host if
+  // `to_host`, and to the device of the context otherwise, via
+  // cuMemPrefetchAsync.  The memory stays accessible from both sides; the
+  // migration only avoids page faults on the side it is moved to.
+  // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__UNIFIED.html#group__CUDA__UNIFIED_1gfe94f8b7fb56291ebcea44261aa4cb84
+  static port::Status MemPrefetchAsync(GpuContext* context,
+                                       GpuDevicePtr location, uint64 size,
+                                       bool to_host, GpuStreamHandle stream);
+
   // Performs an asynchronous memset of the device memory segment via
   // cuMemsetD32Async.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1g58229da5d30f1c0cdf667b320ec2c0f5
@@ -403,6 +416,47 @@ class GpuDriver {
   // the stream immediately after this returns).
   static bool IsStreamIdle(GpuContext* context, GpuStreamHandle stream);
 
+#if CUDA_VERSION >= 10000 || TF_ROCM_VERSION >= 40300
+  // Stream capture and graph execution.
+  //
+  // Work enqueued onto a capturing stream is recorded into a graph instead of
+  // being executed.  The graph can then be instantiated once and launched
+  // many times, at a fraction of the cost of launching its work one
+  // operation at a time.
+
+  // Puts stream into capture mode, via cuStreamBeginCapture.  The relaxed
+  // capture mode is used, so that calls such as memory allocation, which are
+  // unsafe while capturing, do not invalidate the capture.
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Ends the capture begun by StreamBeginCapture and returns the captured
+  // graph, via cuStreamEndCapture.  Fails if the capture was invalidated,
+  // e.g. by a synchronizing call on the stream.
+  static port::StatusOr<GpuGraphHandle> StreamEndCapture(
+      GpuContext* context, GpuStreamHandle stream);
+
+  // Returns whether stream is in capture mode, via cuStreamIsCapturing.
+  static port::StatusOr<bool> StreamIsCapturing(GpuContext* context,
+                                                GpuStreamHandle stream);
+
+  // Creates an executable graph from graph, via cuGraphInstantiate.
+  static port::StatusOr<GpuGraphExecHandle> GraphInstantiate(
+      GpuContext* context, GpuGraphHandle graph);
+
+  // Enqueues the work of graph_exec onto stream, via cuGraphLaunch.
+  static port::Status GraphLaunch(GpuContext* context,
+                                  GpuGraphExecHandle graph_exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys graph, via cuGraphDestroy.
+  static void DestroyGraph(GpuContext* context, GpuGraphHandle graph);
+
+  // Destroys graph_exec, via cuGraphExecDestroy.
+  static void DestroyGraphExec(GpuContext* context,
+                               GpuGraphExecHandle graph_exec);
+#endif  // CUDA_VERSION >= 10000 || TF_ROCM_VERSION >= 40300
+
   // Returns whether code in the from context can access memory in the to
   // context via cuDeviceCanAccessPeer.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__PEER__ACCESS.html#group__CUDA__PEER__ACCESS_1g496bdaae1f632ebfb695b99d2c40f19e
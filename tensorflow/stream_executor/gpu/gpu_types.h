@@ -59,6 +59,8 @@ using GpuSharedMemConfig = hipSharedMemConfig;
 using GpuComplexType = hipComplex;
 using GpuDoubleComplexType = hipDoubleComplex;
 using GpuRngHandle = hiprandGenerator_t;
+using GpuGraphHandle = hipGraph_t;
+using GpuGraphExecHandle = hipGraphExec_t;
 
 #else  // CUDA
 
@@ -77,6 +79,8 @@ using GpuSharedMemConfig = CUsharedconfig;
 using GpuComplexType = cuComplex;
 using GpuDoubleComplexType = cuDoubleComplex;
 using GpuRngHandle = curandGenerator_t;
+using GpuGraphHandle = CUgraph;
+using GpuGraphExecHandle = CUgraphExec;
 
 #endif
 
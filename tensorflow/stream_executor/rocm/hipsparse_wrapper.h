@@ -76,12 +76,16 @@ namespace wrap {
   __macro(hipsparseCreate)			\
   __macro(hipsparseCreateMatDescr)		\
   __macro(hipsparseDcsr2csc)			\
+  __macro(hipsparseDcsrgeam2)			\
+  __macro(hipsparseDcsrgeam2_bufferSizeExt)	\
   __macro(hipsparseDcsrgemm)			\
   __macro(hipsparseDcsrmm2)			\
   __macro(hipsparseDcsrmv)			\
   __macro(hipsparseDestroy)			\
   __macro(hipsparseDestroyMatDescr)		\
   __macro(hipsparseScsr2csc)			\
+  __macro(hipsparseScsrgeam2)			\
+  __macro(hipsparseScsrgeam2_bufferSizeExt)	\
   __macro(hipsparseScsrgemm)			\
   __macro(hipsparseScsrmm2)			\
   __macro(hipsparseScsrmv)			\
@@ -90,6 +94,7 @@ namespace wrap {
   __macro(hipsparseSetMatType)			\
   __macro(hipsparseXcoo2csr)			\
   __macro(hipsparseXcsr2coo)			\
+  __macro(hipsparseXcsrgeam2Nnz)		\
   __macro(hipsparseXcsrgemmNnz)
 
 // clang-format on
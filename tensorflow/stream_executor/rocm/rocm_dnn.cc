@@ -15,13 +15,24 @@ limitations under the License.
 
 #include "tensorflow/stream_executor/rocm/rocm_dnn.h"
 
+#include <atomic>
+#include <cstdlib>
 #include <functional>
+#include <list>
 #include <memory>
+#include <unordered_map>
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "third_party/eigen3/Eigen/Core"
 #include "rocm/include/miopen/miopen.h"
+#include "rocm/include/miopen/version.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/stream_executor/dnn.h"
 #include "tensorflow/stream_executor/gpu/gpu_activation.h"
@@ -426,7 +437,28 @@ uint64 GetHashValue(miopenConvolutionDescriptor_t conv_desc) {
   return hash_value;
 }
 
+// Reference to a MIOpen fusion plan, which destroys the plan when the last
+// reference to it is dropped.
+using FusionPlanRef =
+    std::shared_ptr<std::remove_pointer<miopenFusionPlanDescriptor_t>::type>;
+
+auto* fusion_plan_cache_events = tensorflow::monitoring::Counter<1>::New(
+    "/tensorflow/core/rocm/fusion_plan_cache_events",
+    "The number of hits, misses and evictions of the MIOpen fusion plan "
+    "cache.",
+    "event");
+
+auto* fusion_plan_cache_size = tensorflow::monitoring::Gauge<int64, 0>::New(
+    "/tensorflow/core/rocm/fusion_plan_cache_size",
+    "The number of compiled fusion plans in the MIOpen fusion plan cache.");
+
 // Class to implement a cache of compiled fusion plans
+//
+// Every plan holds compiled GPU code, so the cache keeps at most
+// TF_ROCM_FUSION_PLAN_CACHE_CAPACITY plans (1024 by default) and evicts the
+// least recently used ones beyond that. Evicted plans stay alive until the
+// ScopedFusionPlans using them are destroyed. The cache is split into shards
+// with a mutex each, so that lookups of different plans rarely contend.
 class CachedFusionPlans {
  public:
   // Check if we already have a fusion_plan corresponding to the given hash
@@ -437,77 +469,218 @@ class CachedFusionPlans {
   //   create a new fusion plan descriptor,
   //   associate it with the given hash value in the cache
   //   return false (+ newly created fusion plan via given pointer)
-  static bool FindOrCreate(uint64 hash,
-                           miopenFusionPlanDescriptor_t* fusion_plan,
+  static bool FindOrCreate(uint64 hash, FusionPlanRef* fusion_plan,
                            miopenFusionDirection_t fusion_direction,
                            miopenTensorDescriptor_t input_descriptor) {
-    absl::MutexLock lock{&cached_plans_mutex};
+    Shard& shard = GetShard(hash);
+    absl::MutexLock lock{&shard.mutex};
 
-    bool found_cached_plan = false;
+    auto it = shard.plans.find(hash);
+    if (it != shard.plans.end()) {
+      // Move the plan to the front of the LRU list.
+      shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+      *fusion_plan = it->second->second;
+      fusion_plan_cache_events->GetCell("hit")->IncrementBy(1);
+      return true;
+    }
 
-    auto it = cached_plans.find(hash);
-    if (it != cached_plans.end()) {
-      *fusion_plan = it->second;
-      found_cached_plan = true;
-    } else {
-      auto status = wrap::miopenCreateFusionPlan(fusion_plan, fusion_direction,
-                                                 input_descriptor);
+    miopenFusionPlanDescriptor_t new_plan;
+    auto status = wrap::miopenCreateFusionPlan(&new_plan, fusion_direction,
+                                               input_descriptor);
+    if (status != miopenStatusSuccess) {
+      LOG(FATAL) << "call to miopenCreateFusionPlan failed: "
+                 << ToString(status);
+    }
+    fusion_plan->reset(new_plan, [](miopenFusionPlanDescriptor_t plan) {
+      auto status = wrap::miopenDestroyFusionPlan(plan);
       if (status != miopenStatusSuccess) {
-        LOG(FATAL) << "call to miopenCreateFusionPlan failed: "
+        LOG(FATAL) << "call to miopenDestroyFusionPlan failed: "
                    << ToString(status);
-      } else {
-        cached_plans[hash] = *fusion_plan;
       }
-    }
-
-    return found_cached_plan;
+    });
+    shard.lru.emplace_front(hash, *fusion_plan);
+    shard.plans[hash] = shard.lru.begin();
+    fusion_plan_cache_events->GetCell("miss")->IncrementBy(1);
+    int64 num_evicted = 0;
+    while (shard.lru.size() > ShardCapacity()) {
+      shard.plans.erase(shard.lru.back().first);
+      shard.lru.pop_back();
+      ++num_evicted;
+    }
+    fusion_plan_cache_events->GetCell("eviction")->IncrementBy(num_evicted);
+    num_cached_plans += 1 - num_evicted;
+    fusion_plan_cache_size->GetCell()->Set(num_cached_plans);
+    return false;
   }
 
   // Need to figure out the right place to call this routine
   static void Clear() {
-    absl::MutexLock lock{&cached_plans_mutex};
-
-    for (auto it : cached_plans) {
-      auto status = wrap::miopenDestroyFusionPlan(it.second);
-      if (status != miopenStatusSuccess) {
-        LOG(FATAL) << "call to miopenDestroyFusionPlan failed: "
-                   << ToString(status);
-      }
+    for (int i = 0; i < kNumShards; ++i) {
+      Shard& shard = Shards()[i];
+      absl::MutexLock lock{&shard.mutex};
+      num_cached_plans -= shard.lru.size();
+      shard.plans.clear();
+      shard.lru.clear();
     }
+    fusion_plan_cache_size->GetCell()->Set(num_cached_plans);
 
-    cached_plans.clear();
-
+    absl::MutexLock lock{&unsupported_plans_mutex};
     unsupported_plans.clear();
   }
 
   // Is the Fusion plan corresponding to this hash unsupported
   static bool IsUnsupportedFusionPlan(uint64 hash) {
-    absl::MutexLock lock{&cached_plans_mutex};
+    absl::MutexLock lock{&unsupported_plans_mutex};
     return unsupported_plans.count(hash) > 0;
   }
 
   // Mark the given hash value as corresponding to an unsupported fusion plan
   static void MarkFusionPlanUnsupported(uint64 hash) {
-    absl::MutexLock lock{&cached_plans_mutex};
-    unsupported_plans.insert(hash);
+    absl::MutexLock lock{&unsupported_plans_mutex};
+    if (unsupported_plans.insert(hash).second &&
+        !unsupported_plans_path.empty()) {
+      // Record the plan for later processes, so that they don't have to try
+      // compiling it again.
+      std::unique_ptr<tensorflow::WritableFile> file;
+      tensorflow::Status status = tensorflow::Env::Default()->NewAppendableFile(
+          unsupported_plans_path, &file);
+      if (status.ok()) status = file->Append(absl::StrCat(hash, "\n"));
+      if (status.ok()) status = file->Close();
+      if (!status.ok()) {
+        LOG(WARNING) << "could not record unsupported fusion plan in "
+                     << unsupported_plans_path << ": " << status;
+      }
+    }
+  }
+
+  // Load the hash values of the fusion plans that earlier processes failed to
+  // compile from the file at the given path, one per line, and append the
+  // ones that fail from now on to it.
+  static void PersistUnsupportedFusionPlans(const std::string& path) {
+    absl::MutexLock lock{&unsupported_plans_mutex};
+    unsupported_plans_path = path;
+    std::string contents;
+    if (!tensorflow::ReadFileToString(tensorflow::Env::Default(), path,
+                                      &contents)
+             .ok()) {
+      return;
+    }
+    for (absl::string_view line :
+         absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
+      uint64 hash;
+      if (absl::SimpleAtoi(line, &hash)) unsupported_plans.insert(hash);
+    }
+    VLOG(1) << "loaded " << unsupported_plans.size()
+            << " unsupported fusion plans from " << path;
   }
 
  private:
-  // Mutex to guard access to all data within this class
-  static absl::Mutex cached_plans_mutex;
+  static constexpr int kNumShards = 16;
+
+  struct Shard {
+    // Mutex to guard access to the plans of this shard
+    absl::Mutex mutex;
+
+    // Hash-values and MIOpen Fusion plans, most recently used first
+    std::list<std::pair<uint64, FusionPlanRef>> lru TF_GUARDED_BY(mutex);
+
+    // Map of hash-value to the position of its plan in the lru list
+    std::unordered_map<
+        uint64, std::list<std::pair<uint64, FusionPlanRef>>::iterator>
+        plans TF_GUARDED_BY(mutex);
+  };
+
+  // Need to be able share the plans across more than one stream and hence
+  // static
+  static Shard* Shards() {
+    static Shard* shards = new Shard[kNumShards];
+    return shards;
+  }
+
+  static Shard& GetShard(uint64 hash) { return Shards()[hash % kNumShards]; }
+
+  static size_t ShardCapacity() {
+    static const size_t capacity = [] {
+      int64 capacity = 1024;
+      tensorflow::ReadInt64FromEnvVar("TF_ROCM_FUSION_PLAN_CACHE_CAPACITY",
+                                      capacity, &capacity);
+      return std::max<int64>(1, (capacity + kNumShards - 1) / kNumShards);
+    }();
+    return capacity;
+  }
 
-  // Map of hash-value to MIOpen Fusion plan descriptors
-  // Need to be able share this across more than one stream and hence static
-  static std::map<uint64, miopenFusionPlanDescriptor_t> cached_plans;
+  // The number of plans in all shards, for monitoring
+  static std::atomic<int64> num_cached_plans;
+
+  // Mutex to guard access to the unsupported plans
+  static absl::Mutex unsupported_plans_mutex;
 
   // Set of hash-values that correspond to MIOpen Fusion plans that will fail
   // compile and hence are not supported.
   static std::set<uint64> unsupported_plans;
+
+  // File that unsupported_plans is persisted to, empty if it is not.
+  static std::string unsupported_plans_path;
 };
 
-absl::Mutex CachedFusionPlans::cached_plans_mutex;
-std::map<uint64, miopenFusionPlanDescriptor_t> CachedFusionPlans::cached_plans;
+std::atomic<int64> CachedFusionPlans::num_cached_plans{0};
+absl::Mutex CachedFusionPlans::unsupported_plans_mutex;
 std::set<uint64> CachedFusionPlans::unsupported_plans;
+std::string CachedFusionPlans::unsupported_plans_path;
+
+// If the env var TF_ROCM_MIOPEN_CACHE_DIR is set, keeps the results of the
+// expensive MIOpen searches in a subdirectory of it for the GPU architecture
+// and MIOpen version, so that later processes start warm:
+//  - MIOpen's find-db, which holds the convolution algorithms picked by Find
+//    mode, and its cache of compiled kernels, which makes compiling fusion
+//    plans and convolution solutions cheap once they were compiled before.
+//  - The fusion plans that fail to compile (see CachedFusionPlans).
+// Running a model once with the env var set warms the cache for it. Only the
+// architecture of the first GPU configures the cache, since MIOpen reads its
+// paths once per process.
+void InitPersistentMIOpenCache(GpuExecutor* executor) {
+  static absl::Mutex mutex(absl::kConstInit);
+  static std::string* cache_arch = nullptr;
+
+  std::string cache_dir;
+  tensorflow::ReadStringFromEnvVar("TF_ROCM_MIOPEN_CACHE_DIR", "", &cache_dir);
+  if (cache_dir.empty()) return;
+  auto description = executor->CreateDeviceDescription();
+  if (!description.ok()) {
+    LOG(WARNING) << "not using the MIOpen cache in " << cache_dir << ": "
+                 << description.status();
+    return;
+  }
+  const std::string arch =
+      description.ValueOrDie()->rocm_amdgpu_gcn_arch_name();
+
+  absl::MutexLock lock(&mutex);
+  if (cache_arch != nullptr) {
+    if (*cache_arch != arch) {
+      LOG(WARNING) << "the MIOpen cache in " << cache_dir << " is kept for "
+                   << *cache_arch << ", not for " << arch;
+    }
+    return;
+  }
+  cache_arch = new std::string(arch);
+
+  // The architecture name may contain feature flags like gfx90a:xnack-.
+  const std::string dir = tensorflow::io::JoinPath(
+      cache_dir, absl::StrReplaceAll(arch, {{":", "_"}}),
+      absl::StrCat("miopen-", MIOPEN_VERSION_MAJOR, ".", MIOPEN_VERSION_MINOR,
+                   ".", MIOPEN_VERSION_PATCH));
+  auto status = tensorflow::Env::Default()->RecursivelyCreateDir(dir);
+  if (!status.ok()) {
+    LOG(WARNING) << "not using the MIOpen cache in " << dir << ": " << status;
+    return;
+  }
+  // Explicit settings of the MIOpen env vars take precedence.
+  setenv("MIOPEN_USER_DB_PATH", dir.c_str(), /*overwrite=*/0);
+  setenv("MIOPEN_CUSTOM_CACHE_DIR", dir.c_str(), /*overwrite=*/0);
+  CachedFusionPlans::PersistUnsupportedFusionPlans(
+      tensorflow::io::JoinPath(dir, "unsupported_fusion_plans.txt"));
+  LOG(INFO) << "using the MIOpen cache in " << dir;
+}
 
 dnn::ProfileResult GetProfileResultFromConvSolution(
     miopenConvSolution_t solution) {
@@ -615,6 +788,8 @@ MIOpenSupport::MIOpenSupport(GpuExecutor* parent) : parent_(parent) {
 }
 
 port::Status MIOpenSupport::Init() {
+  // Configure the cache before creating the first MIOpen handle.
+  InitPersistentMIOpenCache(parent_);
   ScopedActivateExecutorContext context(parent_);
   miopenHandle_t miopen_handle = nullptr;
   auto status = wrap::miopenCreateWithStream(
@@ -1134,6 +1309,17 @@ class ScopedFusionPlanBase {
   bool CompilationSucceeded() { return fusion_plan_compiled_; }
 
  protected:
+  // Looks up the fusion plan for the given hash value in CachedFusionPlans,
+  // or creates it there. Returns true if it was found.
+  bool FindOrCreateFusionPlan(uint64 hash,
+                              miopenFusionDirection_t fusion_direction,
+                              miopenTensorDescriptor_t input_descriptor) {
+    bool found = CachedFusionPlans::FindOrCreate(
+        hash, &fusion_plan_ref_, fusion_direction, input_descriptor);
+    fusion_plan_ = fusion_plan_ref_.get();
+    return found;
+  }
+
   miopenStatus_t SetConvolutionArgs(const int op_idx, const float* alpha,
                                     const float* beta, const void* data) {
     miopenFusionOpDescriptor_t conv_op;
@@ -1286,6 +1472,8 @@ class ScopedFusionPlanBase {
 
   miopenHandle_t miopen_handle_;
   miopenFusionPlanDescriptor_t fusion_plan_;
+  // Keeps fusion_plan_ alive even if it is evicted from CachedFusionPlans.
+  FusionPlanRef fusion_plan_ref_;
   miopenOperatorArgs_t fusion_args_;  // Owned.
   bool fusion_plan_compiled_;
 
@@ -1307,8 +1495,8 @@ class ScopedFusionPlanConvolutionBiasActivation : public ScopedFusionPlanBase {
                                        filter_descriptor, conv_descriptor,
                                        bias_descriptor, activation_descriptor);
 
-    bool is_compiled = CachedFusionPlans::FindOrCreate(
-        hash, &fusion_plan_, miopenVerticalFusion, input_descriptor);
+    bool is_compiled =
+        FindOrCreateFusionPlan(hash, miopenVerticalFusion, input_descriptor);
     if (!is_compiled) {
       miopenFusionOpDescriptor_t conv_op;
       auto status = wrap::miopenCreateOpConvForward(
@@ -1421,8 +1609,8 @@ class ScopedFusionPlanBatchNormActivationInference
                                        scale_offset_mean_variance_descriptor,
                                        activation_descriptor);
 
-    bool is_compiled = CachedFusionPlans::FindOrCreate(
-        hash, &fusion_plan_, miopenVerticalFusion, input_descriptor);
+    bool is_compiled =
+        FindOrCreateFusionPlan(hash, miopenVerticalFusion, input_descriptor);
 
     if (!is_compiled) {
       miopenFusionOpDescriptor_t batchnorm_op;
@@ -1521,8 +1709,8 @@ class ScopedFusionPlanBatchNormActivationForward : public ScopedFusionPlanBase {
                                        scale_offset_mean_variance_descriptor,
                                        activation_descriptor);
 
-    bool is_compiled = CachedFusionPlans::FindOrCreate(
-        hash, &fusion_plan_, miopenVerticalFusion, input_descriptor);
+    bool is_compiled =
+        FindOrCreateFusionPlan(hash, miopenVerticalFusion, input_descriptor);
 
     if (!is_compiled) {
       miopenFusionOpDescriptor_t batchnorm_op;
@@ -1622,8 +1810,8 @@ class ScopedFusionPlanBatchNormActivationBackward
                                        scale_offset_mean_variance_descriptor,
                                        activation_descriptor);
 
-    bool is_compiled = CachedFusionPlans::FindOrCreate(
-        hash, &fusion_plan_, miopenVerticalFusion, input_descriptor);
+    bool is_compiled =
+        FindOrCreateFusionPlan(hash, miopenVerticalFusion, input_descriptor);
 
     if (!is_compiled) {
       miopenFusionOpDescriptor_t batchnorm_op;
@@ -3510,6 +3698,9 @@ bool MIOpenSupport::GetMIOpenConvolveAlgorithmsFindMode(
     }
   }
   // allocate scratch memory
+  // Find only considers the algorithms whose workspace fits in the scratch
+  // memory it is given, so a smaller one than requested still yields an
+  // algorithm, just possibly a slower one.
   DeviceMemory<uint8> scratch_memory;
   if (scratch_memory_size != 0) {
     if (scratch_allocator == nullptr) {
@@ -3517,18 +3708,21 @@ bool MIOpenSupport::GetMIOpenConvolveAlgorithmsFindMode(
           << "An allocator must be specified when scratch memory is needed";
       return false;
     }
+    scratch_memory_size =
+        std::min<int64>(scratch_memory_size,
+                        std::max<int64>(
+                            0, scratch_allocator->GetMemoryLimitInBytes()));
     auto allocated = scratch_allocator->AllocateBytes(scratch_memory_size);
     if (allocated.ok()) {
       scratch_memory = allocated.ValueOrDie();
     } else {
-      LOG(FATAL)
+      LOG(WARNING)
           << "Failed to allocate scratch memory - "
           << allocated.status().error_message() << "\n"
-          << "\tYou can set the env var TF_CUDNN_WORKSPACE_LIMIT_IN_MB to a "
-             "larger number (e.g. 8192) to increase the max memory limit.\n"
-          << "\tIncreasing the max memory limit might help resolve this "
-             "error";
-      return false;
+          << "\tOnly algorithms without scratch memory are considered. You "
+             "can set the env var TF_CUDNN_WORKSPACE_LIMIT_IN_MB to a "
+             "larger number (e.g. 8192) to increase the max memory limit.";
+      scratch_memory_size = 0;
     }
   }
 
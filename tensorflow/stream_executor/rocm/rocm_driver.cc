@@ -484,6 +484,18 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return port::Status::OK();
 }
 
+/* static */ port::Status GpuDriver::MemPrefetchAsync(GpuContext* context,
+                                                     hipDeviceptr_t location,
+                                                     uint64 size, bool to_host,
+                                                     GpuStreamHandle stream) {
+  ScopedActivateContext activation{context};
+  const int device = to_host ? hipCpuDeviceId : context->device_ordinal();
+  RETURN_IF_ROCM_ERROR(
+      tensorflow::wrap::hipMemPrefetchAsync(location, size, device, stream),
+      "Failed to enqueue memory prefetch operation");
+  return port::Status::OK();
+}
+
 /* static */ port::Status GpuDriver::AsynchronousMemsetUint32(
     GpuContext* context, hipDeviceptr_t location, uint32 value,
     size_t uint32_count, GpuStreamHandle stream) {
@@ -693,6 +705,132 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return true;
 }
 
+#if TF_ROCM_VERSION >= 50200
+/* static */ port::StatusOr<GpuDriver::VmemSpan>
+GpuDriver::ReserveVirtualMemory(GpuContext* context, uint64 bytes) {
+  ScopedActivateContext activation{context};
+  hipDeviceptr_t base;
+  hipError_t res = tensorflow::wrap::hipMemAddressReserve(
+      &base, bytes, /*alignment=*/0, /*addr=*/nullptr, /*flags=*/0);
+  if (res != hipSuccess) {
+    return port::InternalError(
+        absl::StrFormat("error reserving %d bytes of virtual GPU memory: %s",
+                        bytes, ToString(res)));
+  }
+  return {{base, bytes}};
+}
+
+/* static */ void GpuDriver::FreeVirtualMemory(
+    GpuContext* context, GpuDriver::VmemSpan reservation) {
+  ScopedActivateContext activation{context};
+  hipError_t res =
+      tensorflow::wrap::hipMemAddressFree(reservation.base,
+                                          reservation.size_bytes);
+  if (res != hipSuccess) {
+    LOG(ERROR) << "error freeing vmem reservation of size "
+               << reservation.size_bytes << " at address " << reservation.base;
+  }
+}
+
+/* static */ port::StatusOr<uint64> GpuDriver::GetMinAllocationGranularity(
+    int device_ordinal) {
+  hipMemAllocationProp props = {};
+  props.type = hipMemAllocationTypePinned;
+  props.location.type = hipMemLocationTypeDevice;
+  props.location.id = device_ordinal;
+
+  size_t granularity;
+  hipError_t res = tensorflow::wrap::hipMemGetAllocationGranularity(
+      &granularity, &props, hipMemAllocationGranularityMinimum);
+  if (res != hipSuccess) {
+    return port::InternalError(absl::StrCat(
+        "failed to get min allocation granularity: ", ToString(res)));
+  }
+  return granularity;
+}
+
+/* static */ port::StatusOr<GpuDriver::GenericMemoryHandle>
+GpuDriver::CreateMemoryHandle(GpuContext* context, uint64 bytes) {
+  ScopedActivateContext activation{context};
+  hipMemAllocationProp props = {};
+  props.type = hipMemAllocationTypePinned;
+  props.location.type = hipMemLocationTypeDevice;
+  props.location.id = context->device_ordinal();
+
+  hipMemGenericAllocationHandle_t mem_handle;
+  hipError_t res = tensorflow::wrap::hipMemCreate(&mem_handle, bytes, &props,
+                                                  /*flags=*/0);
+  if (res != hipSuccess) {
+    return port::InternalError(
+        absl::StrFormat("failed to create memory allocation of size %d: %s",
+                        bytes, ToString(res)));
+  }
+  return GpuDriver::GenericMemoryHandle{
+      reinterpret_cast<uint64>(mem_handle), bytes};
+}
+
+/* static */ void GpuDriver::ReleaseMemoryHandle(
+    GpuContext* context, GpuDriver::GenericMemoryHandle handle) {
+  ScopedActivateContext activation{context};
+  hipError_t res = tensorflow::wrap::hipMemRelease(
+      reinterpret_cast<hipMemGenericAllocationHandle_t>(handle.handle));
+  if (res != hipSuccess) {
+    LOG(ERROR) << "Failed to release memory handle " << handle.handle
+               << " of size " << handle.bytes << ": " << ToString(res);
+  }
+}
+
+/* static */ port::Status GpuDriver::MapMemory(
+    GpuContext* context, hipDeviceptr_t va,
+    const GpuDriver::GenericMemoryHandle& handle,
+    const std::vector<int>& device_ordinals) {
+  ScopedActivateContext activation{context};
+
+  // NB: Zero is the only valid value for both flags and offset.
+  hipError_t res = tensorflow::wrap::hipMemMap(
+      va, handle.bytes, /*offset=*/0,
+      reinterpret_cast<hipMemGenericAllocationHandle_t>(handle.handle),
+      /*flags=*/0);
+  if (res != hipSuccess) {
+    return port::InternalError(absl::StrFormat(
+        "Failed to map %d bytes at %p: %s", handle.bytes, va, ToString(res)));
+  }
+
+  std::vector<hipMemAccessDesc> access_descriptors(device_ordinals.size());
+  for (int i = 0; i < access_descriptors.size(); ++i) {
+    access_descriptors[i].location.id = device_ordinals[i];
+    access_descriptors[i].location.type = hipMemLocationTypeDevice;
+    access_descriptors[i].flags = hipMemAccessFlagsProtReadWrite;
+  }
+
+  res = tensorflow::wrap::hipMemSetAccess(va, handle.bytes,
+                                          access_descriptors.data(),
+                                          access_descriptors.size());
+  if (res != hipSuccess) {
+    // Unmap the memory that we failed to set access for.
+    if (tensorflow::wrap::hipMemUnmap(va, handle.bytes) != hipSuccess) {
+      LOG(ERROR)
+          << "Failed to unmap memory in GpuDriver::MapMemory error path.";
+    }
+    return port::InternalError(absl::StrFormat(
+        "Failed to set read/write access on memory mapped at %p: %s", va,
+        ToString(res)));
+  }
+  return port::Status::OK();
+}
+
+/* static */ void GpuDriver::UnmapMemory(GpuContext* context,
+                                         hipDeviceptr_t va, uint64 bytes) {
+  ScopedActivateContext activation{context};
+
+  hipError_t res = tensorflow::wrap::hipMemUnmap(va, bytes);
+  if (res != hipSuccess) {
+    LOG(ERROR) << "Failed to unmap memory at " << va << " of size " << bytes
+               << ": " << ToString(res);
+  }
+}
+#endif  // TF_ROCM_VERSION >= 50200
+
 /* static */ port::Status GpuDriver::DestroyEvent(GpuContext* context,
                                                   GpuEventHandle* event) {
   if (*event == nullptr) {
@@ -831,6 +969,75 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return false;
 }
 
+#if TF_ROCM_VERSION >= 40300
+/* static */ port::Status GpuDriver::StreamBeginCapture(
+    GpuContext* context, GpuStreamHandle stream) {
+  ScopedActivateContext activation{context};
+  RETURN_IF_ROCM_ERROR(tensorflow::wrap::hipStreamBeginCapture(
+                           stream, hipStreamCaptureModeRelaxed),
+                       "failed to begin stream capture");
+  return port::Status::OK();
+}
+
+/* static */ port::StatusOr<GpuGraphHandle> GpuDriver::StreamEndCapture(
+    GpuContext* context, GpuStreamHandle stream) {
+  ScopedActivateContext activation{context};
+  hipGraph_t graph = nullptr;
+  RETURN_IF_ROCM_ERROR(tensorflow::wrap::hipStreamEndCapture(stream, &graph),
+                       "failed to end stream capture");
+  return graph;
+}
+
+/* static */ port::StatusOr<bool> GpuDriver::StreamIsCapturing(
+    GpuContext* context, GpuStreamHandle stream) {
+  ScopedActivateContext activation{context};
+  hipStreamCaptureStatus status;
+  RETURN_IF_ROCM_ERROR(tensorflow::wrap::hipStreamIsCapturing(stream, &status),
+                       "failed to query stream capture status");
+  return status == hipStreamCaptureStatusActive;
+}
+
+/* static */ port::StatusOr<GpuGraphExecHandle> GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph) {
+  ScopedActivateContext activation{context};
+  hipGraphExec_t graph_exec = nullptr;
+  RETURN_IF_ROCM_ERROR(
+      tensorflow::wrap::hipGraphInstantiate(&graph_exec, graph,
+                                            /*pErrorNode=*/nullptr,
+                                            /*pLogBuffer=*/nullptr,
+                                            /*bufferSize=*/0),
+      "failed to instantiate graph");
+  return graph_exec;
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle graph_exec,
+                                                 GpuStreamHandle stream) {
+  ScopedActivateContext activation{context};
+  RETURN_IF_ROCM_ERROR(tensorflow::wrap::hipGraphLaunch(graph_exec, stream),
+                       "failed to launch graph");
+  return port::Status::OK();
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context,
+                                          GpuGraphHandle graph) {
+  ScopedActivateContext activation{context};
+  hipError_t res = tensorflow::wrap::hipGraphDestroy(graph);
+  if (res != hipSuccess) {
+    LOG(ERROR) << "failed to destroy graph: " << ToString(res);
+  }
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              GpuGraphExecHandle graph_exec) {
+  ScopedActivateContext activation{context};
+  hipError_t res = tensorflow::wrap::hipGraphExecDestroy(graph_exec);
+  if (res != hipSuccess) {
+    LOG(ERROR) << "failed to destroy executable graph: " << ToString(res);
+  }
+}
+#endif  // TF_ROCM_VERSION >= 40300
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(
     GpuContext* context, void* host_dst, hipDeviceptr_t gpu_src, uint64 size) {
   ScopedActivateContext activation{context};
@@ -23,6 +23,7 @@ limitations under the License.
 #define __HIP_DISABLE_CPP_FUNCTIONS__
 
 #include "rocm/include/hip/hip_runtime.h"
+#include "rocm/rocm_config.h"
 #include "tensorflow/stream_executor/lib/env.h"
 #include "tensorflow/stream_executor/platform/dso_loader.h"
 #include "tensorflow/stream_executor/platform/port.h"
@@ -97,6 +98,7 @@ namespace wrap {
   __macro(hipMalloc)                                \
   __macro(hipMemGetAddressRange)                    \
   __macro(hipMemGetInfo)                            \
+  __macro(hipMemPrefetchAsync)                      \
   __macro(hipMemcpyDtoD)                            \
   __macro(hipMemcpyDtoDAsync)                       \
   __macro(hipMemcpyDtoH)                            \
@@ -125,6 +127,40 @@ namespace wrap {
 // clang-format on
 
 HIP_ROUTINE_EACH(STREAM_EXECUTOR_HIP_WRAP)
+
+#if TF_ROCM_VERSION >= 50200
+// clang-format off
+#define HIP_VMEM_ROUTINE_EACH(__macro)              \
+  __macro(hipMemAddressFree)                        \
+  __macro(hipMemAddressReserve)                     \
+  __macro(hipMemCreate)                             \
+  __macro(hipMemGetAllocationGranularity)           \
+  __macro(hipMemMap)                                \
+  __macro(hipMemRelease)                            \
+  __macro(hipMemSetAccess)                          \
+  __macro(hipMemUnmap)                              \
+// clang-format on
+
+HIP_VMEM_ROUTINE_EACH(STREAM_EXECUTOR_HIP_WRAP)
+#undef HIP_VMEM_ROUTINE_EACH
+#endif  // TF_ROCM_VERSION >= 50200
+
+#if TF_ROCM_VERSION >= 40300
+// clang-format off
+#define HIP_GRAPH_ROUTINE_EACH(__macro)             \
+  __macro(hipGraphDestroy)                          \
+  __macro(hipGraphExecDestroy)                      \
+  __macro(hipGraphInstantiate)                      \
+  __macro(hipGraphLaunch)                           \
+  __macro(hipStreamBeginCapture)                    \
+  __macro(hipStreamEndCapture)                      \
+  __macro(hipStreamIsCapturing)                     \
+// clang-format on
+
+HIP_GRAPH_ROUTINE_EACH(STREAM_EXECUTOR_HIP_WRAP)
+#undef HIP_GRAPH_ROUTINE_EACH
+#endif  // TF_ROCM_VERSION >= 40300
+
 #undef HIP_ROUTINE_EACH
 #undef STREAM_EXECUTOR_HIP_WRAP
 #undef TO_STR
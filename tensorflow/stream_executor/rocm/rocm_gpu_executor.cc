@@ -16,6 +16,7 @@ limitations under the License.
 #include <unistd.h>
 
 #include "absl/base/casts.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -293,6 +294,9 @@ port::Status GpuExecutor::GetKernelMetadata(GpuKernel* rocm_kernel,
   return port::Status::OK();
 }
 
+// Number of kernel arguments that are packed without a heap allocation.
+static constexpr int kInlineKernelArgs = 16;
+
 port::Status GpuExecutor::Launch(Stream* stream, const ThreadDim& thread_dims,
                                  const BlockDim& block_dims,
                                  const KernelBase& kernel,
@@ -315,25 +319,27 @@ port::Status GpuExecutor::Launch(Stream* stream, const ThreadDim& thread_dims,
     }
   }
 
-  if (rocm_kernel->GetPreferredCacheConfig() !=
-      KernelCacheConfig::kNoPreference) {
-    TF_RETURN_IF_ERROR(GpuDriver::FuncSetCacheConfig(
-        hipfunc, rocm_kernel->GetGpuCacheConfig()));
-  }
+  // AMD GPUs have no configurable split between L1 cache and shared memory,
+  // and hipFuncSetCacheConfig is a no-op there, so the preferred cache config
+  // of the kernel is not applied: it would only add a driver call per launch.
 
   // prepare kernargs
   // KernelArgsArrayBase keeps the pointer of arguments
-  // deference them here
-  std::vector<void*> kernargs;
+  // deference them here. Kernels rarely take more than a handful of
+  // arguments, so they are packed on the stack.
+  absl::InlinedVector<void*, kInlineKernelArgs> kernargs;
+  kernargs.reserve(args.number_of_arguments());
   KernelArgIterator iter = args.arg_iterator();
   while (iter.has_next()) {
     KernelArg arg = iter.next();
-    VLOG(2) << "*(arg.address): "
-            << reinterpret_cast<void*>(
-                   *static_cast<const uint64_t*>(arg.address));
     kernargs.push_back(
         reinterpret_cast<void*>(*static_cast<const uint64_t*>(arg.address)));
   }
+  if (VLOG_IS_ON(2)) {
+    for (void* kernarg : kernargs) {
+      VLOG(2) << "*(arg.address): " << kernarg;
+    }
+  }
 
   size_t size = sizeof(void*) * kernargs.size();
   void* config[] = {HIP_LAUNCH_PARAM_BUFFER_POINTER, kernargs.data(),
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/stream_executor/stream.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/strings/str_cat.h"
 #include "third_party/eigen3/Eigen/Core"
 #include "tensorflow/stream_executor/blas.h"
@@ -252,6 +255,7 @@ Stream::Stream(StreamExecutor *parent)
       implementation_(parent->implementation()->GetStreamImplementation()),
       allocated_(false),
       status_(port::InternalError("Uninitialized stream")),
+      in_error_state_(true),
       temporary_memory_manager_(this) {
   VLOG_CALL(PARAM(parent));
 }
@@ -262,6 +266,7 @@ Stream::Stream(StreamExecutor *parent,
       implementation_(implementation),
       allocated_(false),
       status_(port::InternalError("Uninitialized stream")),
+      in_error_state_(true),
       temporary_memory_manager_(this) {
   VLOG_CALL(PARAM(parent), PARAM(implementation));
 }
@@ -306,6 +311,7 @@ Stream &Stream::Init() {
     // Successful initialization!
     allocated_ = true;
     status_ = port::Status::OK();
+    in_error_state_.store(false, std::memory_order_release);
   } else {
     LOG(ERROR) << "failed to allocate stream during initialization";
   }
@@ -4402,6 +4408,73 @@ Stream &Stream::ThenBlasGemmStridedBatched(
               c, ldc, stride_c, batch_count);
 }
 
+template <typename T>
+Stream &Stream::ThenBlasGemmGrouped(
+    port::ArraySlice<blas::GemmProblem<T>> problems,
+    ScratchAllocator *scratch_allocator) {
+  const int num_problems = problems.size();
+  VLOG_CALL(PARAM(num_problems), PARAM(scratch_allocator));
+
+  // Group the problems by everything but their matrices, in the order in
+  // which each group first appears.
+  auto same_group = [](const blas::GemmProblem<T> &x,
+                       const blas::GemmProblem<T> &y) {
+    return x.transa == y.transa && x.transb == y.transb && x.m == y.m &&
+           x.n == y.n && x.k == y.k && x.alpha == y.alpha && x.lda == y.lda &&
+           x.ldb == y.ldb && x.beta == y.beta && x.ldc == y.ldc;
+  };
+  std::vector<std::vector<const blas::GemmProblem<T> *>> groups;
+  for (const blas::GemmProblem<T> &problem : problems) {
+    auto group = std::find_if(
+        groups.begin(), groups.end(),
+        [&](const std::vector<const blas::GemmProblem<T> *> &group) {
+          return same_group(*group.front(), problem);
+        });
+    if (group == groups.end()) {
+      groups.push_back({&problem});
+    } else {
+      group->push_back(&problem);
+    }
+  }
+
+  for (const auto &group : groups) {
+    const blas::GemmProblem<T> &first = *group.front();
+    if (group.size() == 1) {
+      ThenBlasGemm(first.transa, first.transb, first.m, first.n, first.k,
+                   first.alpha, *first.a, first.lda, *first.b, first.ldb,
+                   first.beta, first.c, first.ldc);
+      continue;
+    }
+    std::vector<DeviceMemory<T> *> a, b, c;
+    for (const blas::GemmProblem<T> *problem : group) {
+      a.push_back(problem->a);
+      b.push_back(problem->b);
+      c.push_back(problem->c);
+    }
+    ThenBlasGemmBatchedWithScratch(first.transa, first.transb, first.m,
+                                   first.n, first.k, first.alpha, a, first.lda,
+                                   b, first.ldb, first.beta, c, first.ldc,
+                                   group.size(), scratch_allocator);
+  }
+  return *this;
+}
+
+template Stream &Stream::ThenBlasGemmGrouped<Eigen::half>(
+    port::ArraySlice<blas::GemmProblem<Eigen::half>> problems,
+    ScratchAllocator *scratch_allocator);
+template Stream &Stream::ThenBlasGemmGrouped<float>(
+    port::ArraySlice<blas::GemmProblem<float>> problems,
+    ScratchAllocator *scratch_allocator);
+template Stream &Stream::ThenBlasGemmGrouped<double>(
+    port::ArraySlice<blas::GemmProblem<double>> problems,
+    ScratchAllocator *scratch_allocator);
+template Stream &Stream::ThenBlasGemmGrouped<std::complex<float>>(
+    port::ArraySlice<blas::GemmProblem<std::complex<float>>> problems,
+    ScratchAllocator *scratch_allocator);
+template Stream &Stream::ThenBlasGemmGrouped<std::complex<double>>(
+    port::ArraySlice<blas::GemmProblem<std::complex<double>>> problems,
+    ScratchAllocator *scratch_allocator);
+
 template <typename ABType, typename CType>
 Stream &Stream::ThenBlasLtMatmulImpl(
     const blas::IBlasLtMatmulPlan *plan, const HostOrDeviceScalar<CType> &alpha,
@@ -5311,6 +5384,7 @@ void Stream::CheckStatus(port::Status status) {
   LOG(ERROR) << status;
   absl::MutexLock lock(&mu_);
   status_ = status;
+  in_error_state_.store(true, std::memory_order_release);
 }
 
 }  // namespace stream_executor
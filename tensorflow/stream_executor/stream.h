@@ -21,6 +21,7 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_STREAM_H_
 #define TENSORFLOW_STREAM_EXECUTOR_STREAM_H_
 
+#include <atomic>
 #include <complex>
 #include <functional>
 #include <memory>
@@ -1535,6 +1536,16 @@ class Stream {
       std::complex<double> beta, DeviceMemory<std::complex<double>> *c, int ldc,
       int64 stride_c, int batch_count);
 
+  // Computes a group of matrix-matrix products that may differ in their
+  // shapes, e.g. the horizontally fused products of a model. The products
+  // that agree in everything but their matrices are computed by one
+  // DoBlasGemmBatched call, so that a group of a few distinct shapes takes a
+  // few launches rather than one per product. T is one of the types of
+  // DoBlasGemmBatched.
+  template <typename T>
+  Stream &ThenBlasGemmGrouped(port::ArraySlice<blas::GemmProblem<T>> problems,
+                              ScratchAllocator *scratch_allocator);
+
   // See BlasSupport::DoBlasHemm.
   Stream &ThenBlasHemm(blas::Side side, blas::UpperLower uplo, uint64 m,
                        uint64 n, std::complex<float> alpha,
@@ -2146,9 +2157,10 @@ class Stream {
   friend struct ThenBlasImpl;  // for implementing ThenBlasXXX.
   friend class ocl::CLBlas;    // for parent_.
 
+  // Reads the mirror of the error state rather than status_, so that the ok()
+  // check done before every enqueued operation does not take mu_.
   bool InErrorState() const TF_LOCKS_EXCLUDED(mu_) {
-    absl::ReaderMutexLock lock(&mu_);
-    return !status_.ok();
+    return in_error_state_.load(std::memory_order_acquire);
   }
 
   // Sets the error state if operation_retcode is false.
@@ -2159,6 +2171,7 @@ class Stream {
     }
     absl::MutexLock lock(&mu_);
     status_ = port::InternalError("Unknown error");
+    in_error_state_.store(true, std::memory_order_release);
   }
 
   // Checks the status and logs the error message, if any.
@@ -2195,6 +2208,9 @@ class Stream {
   // The last error (if any) of all method calls.
   port::Status status_ TF_GUARDED_BY(mu_);
 
+  // Whether status_ is not OK. Only written under mu_, together with status_.
+  std::atomic<bool> in_error_state_;
+
   // Sub-streams that are generated from this stream. Each element has a pointer
   // to sub-stream and a boolean value indicating if this substream is ready to
   // be reused.